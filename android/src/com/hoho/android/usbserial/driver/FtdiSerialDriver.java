@@ -280,7 +280,7 @@ public class FtdiSerialDriver extends CommonUsbSerialDriver {
         int bytesAvailable = m_ftDev.getQueueStatus();
 
         if (bytesAvailable > 0) {
-            bytesAvailable = Math.min(4096, bytesAvailable);
+            bytesAvailable = Math.min(dest.length, bytesAvailable);
             try {
                 totalBytesRead = m_ftDev.read(dest, bytesAvailable, timeoutMillis);
             } catch (NullPointerException e) {
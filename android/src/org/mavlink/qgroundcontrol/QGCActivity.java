@@ -38,6 +38,7 @@ import java.util.concurrent.Executors;
 import java.util.Timer;
 import java.util.TimerTask;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 
 import android.app.Activity;
 import android.app.PendingIntent;
@@ -94,9 +95,9 @@ public class QGCActivity extends QtActivity
                 }
 
                 @Override
-                public void onNewData(final byte[] dataA, long userData)
+                public void onNewData(final ByteBuffer dataA, int lengthA, long userData)
                 {
-                    nativeDeviceNewData(userData, dataA);
+                    nativeDeviceNewData(userData, dataA, lengthA);
                 }
             };
 
@@ -172,14 +173,23 @@ public class QGCActivity extends QtActivity
                 } catch(Exception e) {
                     Log.e(TAG, "Exception nativeUpdateAvailableJoysticks()");
                 }
+
+                if (UsbManager.ACTION_USB_DEVICE_ATTACHED.equals(action) || UsbManager.ACTION_USB_DEVICE_DETACHED.equals(action)) {
+                    try {
+                        nativeUpdateAvailableSerialPorts();
+                    } catch(Exception e) {
+                        Log.e(TAG, "Exception nativeUpdateAvailableSerialPorts()");
+                    }
+                }
             }
         };
 
     // Native C++ functions which connect back to QSerialPort code
     private static native void nativeDeviceHasDisconnected(long userData);
     private static native void nativeDeviceException(long userData, String messageA);
-    private static native void nativeDeviceNewData(long userData, byte[] dataA);
+    private static native void nativeDeviceNewData(long userData, ByteBuffer dataA, int lengthA);
     private static native void nativeUpdateAvailableJoysticks();
+    private static native void nativeUpdateAvailableSerialPorts();
 
     // Native C++ functions called to log output
     public static native void qgcLogDebug(String message);
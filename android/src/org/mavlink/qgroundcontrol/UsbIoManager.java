@@ -36,14 +36,21 @@ import android.util.Log;
 */
 public class UsbIoManager implements Runnable {
     private static final int READ_WAIT_MILLIS = 100;
+    private static final int BATCH_WAIT_MILLIS = 1;
     private static final int BUFSIZ = 4096;
+    private static final int READ_BUFSIZ = 16 * 1024;
+    private static final int BATCH_BUFSIZ = 4 * READ_BUFSIZ;
     private static final String TAG = "QGC_UsbIoManager";
 
     private final UsbSerialDriver mDriver;
     private long mUserData;
-    private final ByteBuffer mReadBuffer = ByteBuffer.allocate(BUFSIZ);
+    private final byte[] mReadBuffer = new byte[READ_BUFSIZ];
     private final ByteBuffer mWriteBuffer = ByteBuffer.allocate(BUFSIZ);
 
+    // Reads are collected here and handed to the native side in one call. The buffer is direct so native code reads
+    // it in place, it is only reused once the listener has returned.
+    private final ByteBuffer mBatchBuffer = ByteBuffer.allocateDirect(BATCH_BUFSIZ);
+
     private enum State
     {
         STOPPED,
@@ -60,9 +67,10 @@ public class UsbIoManager implements Runnable {
     public interface Listener
     {
         /**
-         * Called when new incoming data is available.
+         * Called when new incoming data is available. The first length bytes of the
+         * direct buffer are valid until the call returns.
          */
-        public void onNewData(byte[] data, long userData);
+        public void onNewData(ByteBuffer data, int length, long userData);
 
         /**
          * Called when {@link SerialInputOutputManager#run()} aborts due to an
@@ -182,19 +190,24 @@ public class UsbIoManager implements Runnable {
 
     private void step() throws IOException
     {
-        // Handle incoming data.
-        int len = mDriver.read(mReadBuffer.array(), READ_WAIT_MILLIS);
+        // Handle incoming data. Once data arrives, keep reading with a short timeout while the device has more
+        // so a burst at high baud rates is delivered in one go instead of one small call per USB transfer.
+        int len = mDriver.read(mReadBuffer, READ_WAIT_MILLIS);
+
+        while (len > 0)
+        {
+            mBatchBuffer.put(mReadBuffer, 0, len);
+            if (mBatchBuffer.remaining() < READ_BUFSIZ || mState != State.RUNNING)
+                break;
+            len = mDriver.read(mReadBuffer, BATCH_WAIT_MILLIS);
+        }
 
-        if (len > 0)
+        if (mBatchBuffer.position() > 0)
         {
             final Listener listener = getListener();
             if (listener != null)
-            {
-                final byte[] data = new byte[len];
-                mReadBuffer.get(data, 0, len);
-                listener.onNewData(data, mUserData);
-            }
-            mReadBuffer.clear();
+                listener.onNewData(mBatchBuffer, mBatchBuffer.position(), mUserData);
+            mBatchBuffer.clear();
         }
 /*
         // Handle outgoing data.
@@ -64,15 +64,19 @@ static void jniDeviceHasDisconnected(JNIEnv *envA, jobject thizA, jlong userData
         (reinterpret_cast<QSerialPortPrivate*>(userDataA))->q_ptr->close();
 }
 
-static void jniDeviceNewData(JNIEnv *envA, jobject thizA, jlong userDataA, jbyteArray dataA)
+// Data comes in a direct ByteBuffer which is read in place, it is reused by the Java side once this returns
+static void jniDeviceNewData(JNIEnv *envA, jobject thizA, jlong userDataA, jobject dataA, jint lengthA)
 {
     Q_UNUSED(thizA);
-    if (userDataA != 0)
+    if (userDataA != 0 && lengthA > 0)
     {
-        jbyte *bytesL = envA->GetByteArrayElements(dataA, nullptr);
-        jsize lenL = envA->GetArrayLength(dataA);
-        (reinterpret_cast<QSerialPortPrivate*>(userDataA))->newDataArrived(reinterpret_cast<char*>(bytesL), lenL);
-        envA->ReleaseByteArrayElements(dataA, bytesL, JNI_ABORT);
+        char *bytesL = static_cast<char*>(envA->GetDirectBufferAddress(dataA));
+        jlong capacityL = envA->GetDirectBufferCapacity(dataA);
+        if (bytesL == nullptr || capacityL < lengthA) {
+            qWarning() << "Serial data buffer is not a direct buffer of the expected size";
+            return;
+        }
+        (reinterpret_cast<QSerialPortPrivate*>(userDataA))->newDataArrived(bytesL, lengthA);
     }
 }
 
@@ -144,7 +148,7 @@ void QSerialPortPrivate::setNativeMethods(void)
     //  REGISTER THE C++ FUNCTION WITH JNI
     JNINativeMethod javaMethods[] {
         {"nativeDeviceHasDisconnected", "(J)V",                     reinterpret_cast<void *>(jniDeviceHasDisconnected)},
-        {"nativeDeviceNewData",         "(J[B)V",                   reinterpret_cast<void *>(jniDeviceNewData)},
+        {"nativeDeviceNewData",         "(JLjava/nio/ByteBuffer;I)V", reinterpret_cast<void *>(jniDeviceNewData)},
         {"nativeDeviceException",       "(JLjava/lang/String;)V",   reinterpret_cast<void *>(jniDeviceException)},
         {"qgcLogDebug",                 "(Ljava/lang/String;)V",    reinterpret_cast<void *>(jniLogDebug)},
         {"qgcLogWarning",               "(Ljava/lang/String;)V",    reinterpret_cast<void *>(jniLogWarning)}
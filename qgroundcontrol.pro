@@ -42,6 +42,7 @@ MacBuild {
     ICON                = $${SOURCE_DIR}/resources/icons/macx.icns
     OTHER_FILES        += Custom-Info.plist
     LIBS               += -framework ApplicationServices
+    LIBS               += -framework IOKit -framework CoreFoundation
 }
 
 LinuxBuild {
@@ -470,6 +471,7 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest
 
     HEADERS += \
+        src/AnalyzeView/ULogReaderTest.h \
         src/Audio/AudioOutputTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
@@ -488,6 +490,8 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/MissionManagerTest.h \
         src/MissionManager/MissionSettingsTest.h \
         src/MissionManager/PlanMasterControllerTest.h \
+        src/MissionManager/GeoFenceIndexTest.h \
+        src/MissionManager/MissionBoundsTreeTest.h \
         src/MissionManager/QGCMapPolygonTest.h \
         src/MissionManager/QGCMapPolylineTest.h \
         src/MissionManager/SectionTest.h \
@@ -501,12 +505,19 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest/ComponentInformationCacheTest.h \
         src/qgcunittest/ComponentInformationTranslationTest.h \
         src/qgcunittest/GeoTest.h \
+        src/qgcunittest/LinkReactorPoolTest.h \
         src/qgcunittest/MavlinkLogTest.h \
+        src/qgcunittest/MAVLinkSigningTest.h \
+        src/qgcunittest/MAVLinkMessageViewTest.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/MultiSignalSpyV2.h \
+        src/qgcunittest/PlanningBenchmark.h \
+        src/qgcunittest/QGCTimerWheelTest.h \
         src/qgcunittest/UnitTest.h \
         src/Vehicle/FTPManagerTest.h \
         src/Vehicle/InitialConnectTest.h \
+        src/Vehicle/MockLinkBenchmark.h \
+        src/Vehicle/PIDTuningRecorderTest.h \
         src/Vehicle/RequestMessageTest.h \
         src/Vehicle/SendMavCommandWithHandlerTest.h \
         src/Vehicle/SendMavCommandWithSignallingTest.h \
@@ -519,6 +530,7 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         #src/qgcunittest/MessageBoxTest.h \
 
     SOURCES += \
+        src/AnalyzeView/ULogReaderTest.cc \
         src/Audio/AudioOutputTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
@@ -537,6 +549,8 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/MissionManagerTest.cc \
         src/MissionManager/MissionSettingsTest.cc \
         src/MissionManager/PlanMasterControllerTest.cc \
+        src/MissionManager/GeoFenceIndexTest.cc \
+        src/MissionManager/MissionBoundsTreeTest.cc \
         src/MissionManager/QGCMapPolygonTest.cc \
         src/MissionManager/QGCMapPolylineTest.cc \
         src/MissionManager/SectionTest.cc \
@@ -550,13 +564,20 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/qgcunittest/ComponentInformationCacheTest.cc \
         src/qgcunittest/ComponentInformationTranslationTest.cc \
         src/qgcunittest/GeoTest.cc \
+        src/qgcunittest/LinkReactorPoolTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
+        src/qgcunittest/MAVLinkSigningTest.cc \
+        src/qgcunittest/MAVLinkMessageViewTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/MultiSignalSpyV2.cc \
+        src/qgcunittest/PlanningBenchmark.cc \
+        src/qgcunittest/QGCTimerWheelTest.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
         src/Vehicle/FTPManagerTest.cc \
         src/Vehicle/InitialConnectTest.cc \
+        src/Vehicle/MockLinkBenchmark.cc \
+        src/Vehicle/PIDTuningRecorderTest.cc \
         src/Vehicle/RequestMessageTest.cc \
         src/Vehicle/SendMavCommandWithHandlerTest.cc \
         src/Vehicle/SendMavCommandWithSignallingTest.cc \
@@ -573,11 +594,13 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
 # Main QGC Headers and Source files
 
 HEADERS += \
+    src/ADSB/ADSBConflictDetector.h \
     src/ADSB/ADSBVehicle.h \
     src/ADSB/ADSBVehicleManager.h \
     src/AnalyzeView/LogDownloadController.h \
     src/AnalyzeView/PX4LogParser.h \
     src/AnalyzeView/ULogParser.h \
+    src/AnalyzeView/ULogReader.h \
     src/AnalyzeView/MavlinkConsoleController.h \
     src/Audio/AudioOutput.h \
     src/Vehicle/Autotune.h \
@@ -587,8 +610,10 @@ HEADERS += \
     src/CmdLineOptParser.h \
     src/Compression/QGCLZMA.h \
     src/Compression/QGCZlib.h \
+    src/Compression/QGCZipWriter.h \
     src/FirmwarePlugin/PX4/px4_custom_mode.h \
     src/FollowMe/FollowMe.h \
+    src/FollowMe/FollowTargetEstimator.h \
     src/Joystick/Joystick.h \
     src/Joystick/JoystickManager.h \
     src/Joystick/JoystickMavCommand.h \
@@ -605,11 +630,15 @@ HEADERS += \
     src/MissionManager/BlankPlanCreator.h \
     src/MissionManager/FixedWingLandingComplexItem.h \
     src/MissionManager/GeoFenceController.h \
+    src/MissionManager/GeoFenceIndex.h \
     src/MissionManager/GeoFenceManager.h \
+    src/MissionManager/GeoFenceMonitor.h \
     src/MissionManager/ObstacleController.h \
     src/MissionManager/ObstacleManager.h \
     src/MissionManager/KMLPlanDomDocument.h \
+    src/MissionManager/KMLPlanStreamWriter.h \
     src/MissionManager/LandingComplexItem.h \
+    src/MissionManager/MissionBoundsTree.h \
     src/MissionManager/MissionCommandList.h \
     src/MissionManager/MissionCommandTree.h \
     src/MissionManager/MissionCommandUIInfo.h \
@@ -620,6 +649,7 @@ HEADERS += \
     src/MissionManager/PlanElementController.h \
     src/MissionManager/PlanCreator.h \
     src/MissionManager/PlanManager.h \
+    src/MissionManager/PlanFleetUploader.h \
     src/MissionManager/PlanMasterController.h \
     src/MissionManager/QGCFenceCircle.h \
     src/MissionManager/QGCFencePolygon.h \
@@ -641,6 +671,7 @@ HEADERS += \
     src/MissionManager/VisualMissionItem.h \
     src/MissionManager/VTOLLandingComplexItem.h \
     src/PositionManager/PositionManager.h \
+    src/PositionManager/QGCNmeaPositionSource.h \
     src/PositionManager/SimulatedPosition.h \
     src/Geo/QGCGeo.h \
     src/Geo/Constants.hpp \
@@ -655,16 +686,23 @@ HEADERS += \
     src/QGCCachedFileDownload.h \
     src/QGCComboBox.h \
     src/QGCConfig.h \
+    src/QGCDownloadScheduler.h \
     src/QGCFileDownload.h \
     src/QGCLoggingCategory.h \
     src/QGCMapPalette.h \
+    src/QGCMemoryAccounting.h \
     src/QGCPalette.h \
     src/QGCQGeoCoordinate.h \
+    src/QGCStartupProfiler.h \
     src/QGCTemporaryFile.h \
     src/QGCToolbox.h \
+    src/QGCTrace.h \
+    src/QGCTimerWheel.h \
     src/QmlControls/AppMessages.h \
     src/QmlControls/EditPositionDialogController.h \
     src/QmlControls/FlightPathSegment.h \
+    src/QmlControls/MapBatchItem.h \
+    src/QmlControls/ObstacleDistanceItem.h \
     src/QmlControls/HorizontalFactValueGrid.h \
     src/QmlControls/InstrumentValueData.h \
     src/QmlControls/FactValueGrid.h \
@@ -674,9 +712,11 @@ HEADERS += \
     src/QmlControls/QGroundControlQmlGlobal.h \
     src/QmlControls/QmlObjectListModel.h \
     src/QmlControls/QGCGeoBoundingCube.h \
+    src/QmlControls/QGCMapTransform.h \
     src/QmlControls/RCChannelMonitorController.h \
     src/QmlControls/RCToParamDialogController.h \
     src/QmlControls/ScreenToolsController.h \
+    src/QmlControls/TerrainOverlayItem.h \
     src/QmlControls/TerrainProfile.h \
     src/QmlControls/ToolStripAction.h \
     src/QmlControls/ToolStripActionList.h \
@@ -699,6 +739,7 @@ HEADERS += \
     src/ShapeFileHelper.h \
     src/SHPFileHelper.h \
     src/Terrain/TerrainQuery.h \
+    src/TerrainJsonReader.h \
     src/TerrainTile.h \
     src/Vehicle/Actuators/ActuatorActions.h \
     src/Vehicle/Actuators/Actuators.h \
@@ -721,14 +762,19 @@ HEADERS += \
     src/Vehicle/GPSRTKFactGroup.h \
     src/Vehicle/HealthAndArmingCheckReport.h \
     src/Vehicle/ImageProtocolManager.h \
+    src/Vehicle/InitialConnectScheduler.h \
     src/Vehicle/InitialConnectStateMachine.h \
     src/Vehicle/MAVLinkLogManager.h \
+    src/Vehicle/MAVLinkLogUploadDevice.h \
     src/Vehicle/MAVLinkStreamConfig.h \
     src/Vehicle/MultiVehicleManager.h \
+    src/Vehicle/PIDTuningRecorder.h \
     src/Vehicle/RemoteIDManager.h \
     src/Vehicle/StateMachine.h \
     src/Vehicle/SysStatusSensorInfo.h \
     src/Vehicle/TerrainFactGroup.h \
+    src/Vehicle/TelemetryArchive.h \
+    src/Vehicle/TelemetryStreamServer.h \
     src/Vehicle/TerrainProtocolHandler.h \
     src/Vehicle/TrajectoryPoints.h \
     src/Vehicle/Vehicle.h \
@@ -743,19 +789,33 @@ HEADERS += \
     src/Vehicle/VehicleGPS2FactGroup.h \
     src/Vehicle/VehicleLinkManager.h \
     src/Vehicle/VehicleSetpointFactGroup.h \
+    src/Vehicle/VehicleTelemetrySnapshot.h \
     src/Vehicle/VehicleTemperatureFactGroup.h \
     src/Vehicle/VehicleVibrationFactGroup.h \
     src/Vehicle/VehicleWindFactGroup.h \
+    src/Vehicle/VehicleGeoFenceFactGroup.h \
     src/Vehicle/VehicleHygrometerFactGroup.h \
     src/VehicleSetup/JoystickConfigController.h \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkReactorPool.h \
+    src/comm/LogReplayBenchmark.h \
+    src/comm/LogReplayIndex.h \
     src/comm/LogReplayLink.h \
+    src/comm/MAVLinkForwarder.h \
+    src/comm/MAVLinkFrameScanner.h \
+    src/comm/MAVLinkMessageView.h \
+    src/comm/MAVLinkLogWriter.h \
+    src/comm/MAVLinkMetrics.h \
+    src/comm/MAVLinkPeriodicSender.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkSequenceState.h \
+    src/comm/MAVLinkSigning.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
     src/comm/UDPLink.h \
+    src/comm/VideoSyncIndex.h \
     src/comm/UdpIODevice.h \
     src/uas/UAS.h \
     src/uas/UASInterface.h \
@@ -807,6 +867,7 @@ contains(DEFINES, NO_SERIAL_LINK) {
 HEADERS += \
     src/comm/QGCSerialPortInfo.h \
     src/comm/SerialLink.h \
+    src/comm/SerialPortWatcher.h \
 }
 
 !MobileBuild {
@@ -818,6 +879,7 @@ HEADERS += \
     src/GPS/Drivers/src/sbf.h \
     src/GPS/GPSManager.h \
     src/GPS/GPSPositionMessage.h \
+    src/GPS/GPSReportQueue.h \
     src/GPS/GPSProvider.h \
     src/GPS/RTCM/RTCMMavlink.h \
     src/GPS/definitions.h \
@@ -838,11 +900,13 @@ AndroidBuild {
 }
 
 SOURCES += \
+    src/ADSB/ADSBConflictDetector.cc \
     src/ADSB/ADSBVehicle.cc \
     src/ADSB/ADSBVehicleManager.cc \
     src/AnalyzeView/LogDownloadController.cc \
     src/AnalyzeView/PX4LogParser.cc \
     src/AnalyzeView/ULogParser.cc \
+    src/AnalyzeView/ULogReader.cc \
     src/AnalyzeView/MavlinkConsoleController.cc \
     src/Audio/AudioOutput.cc \
     src/Vehicle/Autotune.cpp \
@@ -852,7 +916,9 @@ SOURCES += \
     src/CmdLineOptParser.cc \
     src/Compression/QGCLZMA.cc \
     src/Compression/QGCZlib.cc \
+    src/Compression/QGCZipWriter.cc \
     src/FollowMe/FollowMe.cc \
+    src/FollowMe/FollowTargetEstimator.cc \
     src/Joystick/Joystick.cc \
     src/Joystick/JoystickManager.cc \
     src/Joystick/JoystickMavCommand.cc \
@@ -869,11 +935,15 @@ SOURCES += \
     src/MissionManager/BlankPlanCreator.cc \
     src/MissionManager/FixedWingLandingComplexItem.cc \
     src/MissionManager/GeoFenceController.cc \
+    src/MissionManager/GeoFenceIndex.cc \
     src/MissionManager/GeoFenceManager.cc \
+    src/MissionManager/GeoFenceMonitor.cc \
     src/MissionManager/ObstacleController.cc \
     src/MissionManager/ObstacleManager.cc \
     src/MissionManager/KMLPlanDomDocument.cc \
+    src/MissionManager/KMLPlanStreamWriter.cc \
     src/MissionManager/LandingComplexItem.cc \
+    src/MissionManager/MissionBoundsTree.cc \
     src/MissionManager/MissionCommandList.cc \
     src/MissionManager/MissionCommandTree.cc \
     src/MissionManager/MissionCommandUIInfo.cc \
@@ -884,6 +954,7 @@ SOURCES += \
     src/MissionManager/PlanElementController.cc \
     src/MissionManager/PlanCreator.cc \
     src/MissionManager/PlanManager.cc \
+    src/MissionManager/PlanFleetUploader.cc \
     src/MissionManager/PlanMasterController.cc \
     src/MissionManager/QGCFenceCircle.cc \
     src/MissionManager/QGCFencePolygon.cc \
@@ -904,6 +975,7 @@ SOURCES += \
     src/MissionManager/VisualMissionItem.cc \
     src/MissionManager/VTOLLandingComplexItem.cc \
     src/PositionManager/PositionManager.cpp \
+    src/PositionManager/QGCNmeaPositionSource.cc \
     src/PositionManager/SimulatedPosition.cc \
     src/Geo/QGCGeo.cc \
     src/Geo/Math.cpp \
@@ -916,16 +988,23 @@ SOURCES += \
     src/QGCApplication.cc \
     src/QGCCachedFileDownload.cc \
     src/QGCComboBox.cc \
+    src/QGCDownloadScheduler.cc \
     src/QGCFileDownload.cc \
     src/QGCLoggingCategory.cc \
     src/QGCMapPalette.cc \
+    src/QGCMemoryAccounting.cc \
     src/QGCPalette.cc \
     src/QGCQGeoCoordinate.cc \
+    src/QGCStartupProfiler.cc \
     src/QGCTemporaryFile.cc \
     src/QGCToolbox.cc \
+    src/QGCTrace.cc \
+    src/QGCTimerWheel.cc \
     src/QmlControls/AppMessages.cc \
     src/QmlControls/EditPositionDialogController.cc \
     src/QmlControls/FlightPathSegment.cc \
+    src/QmlControls/MapBatchItem.cc \
+    src/QmlControls/ObstacleDistanceItem.cc \
     src/QmlControls/HorizontalFactValueGrid.cc \
     src/QmlControls/InstrumentValueData.cc \
     src/QmlControls/FactValueGrid.cc \
@@ -935,9 +1014,11 @@ SOURCES += \
     src/QmlControls/QGroundControlQmlGlobal.cc \
     src/QmlControls/QmlObjectListModel.cc \
     src/QmlControls/QGCGeoBoundingCube.cc \
+    src/QmlControls/QGCMapTransform.cc \
     src/QmlControls/RCChannelMonitorController.cc \
     src/QmlControls/RCToParamDialogController.cc \
     src/QmlControls/ScreenToolsController.cc \
+    src/QmlControls/TerrainOverlayItem.cc \
     src/QmlControls/TerrainProfile.cc \
     src/QmlControls/ToolStripAction.cc \
     src/QmlControls/ToolStripActionList.cc \
@@ -960,6 +1041,7 @@ SOURCES += \
     src/ShapeFileHelper.cc \
     src/SHPFileHelper.cc \
     src/Terrain/TerrainQuery.cc \
+    src/TerrainJsonReader.cc \
     src/TerrainTile.cc\
     src/Vehicle/Actuators/ActuatorActions.cc \
     src/Vehicle/Actuators/Actuators.cc \
@@ -982,14 +1064,19 @@ SOURCES += \
     src/Vehicle/GPSRTKFactGroup.cc \
     src/Vehicle/HealthAndArmingCheckReport.cc \
     src/Vehicle/ImageProtocolManager.cc \
+    src/Vehicle/InitialConnectScheduler.cc \
     src/Vehicle/InitialConnectStateMachine.cc \
     src/Vehicle/MAVLinkLogManager.cc \
+    src/Vehicle/MAVLinkLogUploadDevice.cc \
     src/Vehicle/MAVLinkStreamConfig.cc \
     src/Vehicle/MultiVehicleManager.cc \
+    src/Vehicle/PIDTuningRecorder.cc \
     src/Vehicle/RemoteIDManager.cc \
     src/Vehicle/StateMachine.cc \
     src/Vehicle/SysStatusSensorInfo.cc \
     src/Vehicle/TerrainFactGroup.cc \
+    src/Vehicle/TelemetryArchive.cc \
+    src/Vehicle/TelemetryStreamServer.cc \
     src/Vehicle/TerrainProtocolHandler.cc \
     src/Vehicle/TrajectoryPoints.cc \
     src/Vehicle/Vehicle.cc \
@@ -1004,19 +1091,32 @@ SOURCES += \
     src/Vehicle/VehicleGPS2FactGroup.cc \
     src/Vehicle/VehicleLinkManager.cc \
     src/Vehicle/VehicleSetpointFactGroup.cc \
+    src/Vehicle/VehicleTelemetrySnapshot.cc \
     src/Vehicle/VehicleTemperatureFactGroup.cc \
     src/Vehicle/VehicleVibrationFactGroup.cc \
+    src/Vehicle/VehicleGeoFenceFactGroup.cc \
     src/Vehicle/VehicleHygrometerFactGroup.cc \
     src/Vehicle/VehicleWindFactGroup.cc \
     src/VehicleSetup/JoystickConfigController.cc \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkReactorPool.cc \
+    src/comm/LogReplayBenchmark.cc \
+    src/comm/LogReplayIndex.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/MAVLinkForwarder.cc \
+    src/comm/MAVLinkFrameScanner.cc \
+    src/comm/MAVLinkLogWriter.cc \
+    src/comm/MAVLinkMetrics.cc \
+    src/comm/MAVLinkPeriodicSender.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkSequenceState.cc \
+    src/comm/MAVLinkSigning.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
     src/comm/UDPLink.cc \
+    src/comm/VideoSyncIndex.cc \
     src/comm/UdpIODevice.cc \
     src/main.cc \
     src/uas/UAS.cc \
@@ -1040,6 +1140,7 @@ SOURCES += \
 SOURCES += \
     src/comm/QGCSerialPortInfo.cc \
     src/comm/SerialLink.cc \
+    src/comm/SerialPortWatcher.cc \
 }
 
 contains(DEFINES, QGC_ENABLE_BLUETOOTH) {
@@ -1095,7 +1196,9 @@ HEADERS+= \
     HEADERS += \
         src/VehicleSetup/Bootloader.h \
         src/VehicleSetup/FirmwareImage.h \
+        src/VehicleSetup/FirmwareImageCache.h \
         src/VehicleSetup/FirmwareUpgradeController.h \
+        src/VehicleSetup/ParallelFirmwareFlasher.h \
         src/VehicleSetup/PX4FirmwareUpgradeThread.h \
 }}
 
@@ -1117,7 +1220,9 @@ SOURCES += \
     SOURCES += \
         src/VehicleSetup/Bootloader.cc \
         src/VehicleSetup/FirmwareImage.cc \
+        src/VehicleSetup/FirmwareImageCache.cc \
         src/VehicleSetup/FirmwareUpgradeController.cc \
+        src/VehicleSetup/ParallelFirmwareFlasher.cc \
         src/VehicleSetup/PX4FirmwareUpgradeThread.cc \
 }}
 
@@ -1271,7 +1376,11 @@ HEADERS += \
     src/FactSystem/FactGroup.h \
     src/FactSystem/FactMetaData.h \
     src/FactSystem/FactSystem.h \
+    src/FactSystem/FactUpdateScheduler.h \
     src/FactSystem/FactValueSliderListModel.h \
+    src/FactSystem/ParamPackDecoder.h \
+    src/FactSystem/ParameterCacheFile.h \
+    src/FactSystem/ParameterFactMap.h \
     src/FactSystem/ParameterManager.h \
     src/FactSystem/SettingsFact.h \
 
@@ -1281,7 +1390,11 @@ SOURCES += \
     src/FactSystem/FactGroup.cc \
     src/FactSystem/FactMetaData.cc \
     src/FactSystem/FactSystem.cc \
+    src/FactSystem/FactUpdateScheduler.cc \
     src/FactSystem/FactValueSliderListModel.cc \
+    src/FactSystem/ParamPackDecoder.cc \
+    src/FactSystem/ParameterCacheFile.cc \
+    src/FactSystem/ParameterFactMap.cc \
     src/FactSystem/ParameterManager.cc \
     src/FactSystem/SettingsFact.cc \
 
@@ -1479,11 +1592,13 @@ INCLUDEPATH += \
 
 HEADERS += \
     src/VideoManager/SubtitleWriter.h \
-    src/VideoManager/VideoManager.h
+    src/VideoManager/VideoManager.h \
+    src/VideoManager/VideoQualityController.h
 
 SOURCES += \
     src/VideoManager/SubtitleWriter.cc \
-    src/VideoManager/VideoManager.cc
+    src/VideoManager/VideoManager.cc \
+    src/VideoManager/VideoQualityController.cc
 
 contains (CONFIG, DISABLE_VIDEOSTREAMING) {
     message("Skipping support for video streaming (manual override from command line)")
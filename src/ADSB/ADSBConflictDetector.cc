@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBConflictDetector.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+QVector<ADSBConflictDetector::Conflict_t> ADSBConflictDetector::detect(const QVector<Encounter_t>& encounters, const Thresholds_t& thresholds)
+{
+    QVector<Conflict_t> conflicts;
+    for (const Encounter_t& encounter: encounters) {
+        _detect(encounter, thresholds, conflicts);
+    }
+    return conflicts;
+}
+
+double ADSBConflictDetector::searchRadius(const Track_t& ownVehicle, const Thresholds_t& thresholds)
+{
+    const double ownSpeed = qSqrt((ownVehicle.velocityNorth * ownVehicle.velocityNorth) + (ownVehicle.velocityEast * ownVehicle.velocityEast));
+    return thresholds.horizontalSeparation + (thresholds.lookaheadSecs * (ownSpeed + _maxTrafficSpeed));
+}
+
+void ADSBConflictDetector::_detect(const Encounter_t& encounter, const Thresholds_t& thresholds, QVector<Conflict_t>& conflicts)
+{
+    const int count = encounter.traffic.count();
+    if (count == 0) {
+        return;
+    }
+
+    const Track_t&  own                 = encounter.ownVehicle;
+    const bool      ownAltitudeKnown    = !qIsNaN(own.altitude);
+    const double    metersPerDegree     = 111320.0;
+    const double    metersPerDegreeLon  = metersPerDegree * qCos(qDegreesToRadians(own.latitude));
+
+    // Traffic relative to our vehicle, one array per component
+    QVector<double> rx(count), ry(count), rz(count), vx(count), vy(count), vz(count);
+    for (int i=0; i<count; i++) {
+        const Track_t& traffic = encounter.traffic[i];
+
+        double lonDelta = traffic.longitude - own.longitude;
+        if (lonDelta > 180.0) {
+            lonDelta -= 360.0;
+        } else if (lonDelta < -180.0) {
+            lonDelta += 360.0;
+        }
+        const bool altitudeKnown = ownAltitudeKnown && !qIsNaN(traffic.altitude);
+
+        rx[i] = (traffic.latitude - own.latitude) * metersPerDegree;
+        ry[i] = lonDelta * metersPerDegreeLon;
+        vx[i] = traffic.velocityNorth - own.velocityNorth;
+        vy[i] = traffic.velocityEast - own.velocityEast;
+        // Without both altitudes the vertical separation counts as lost, so only the horizontal check decides
+        rz[i] = altitudeKnown ? traffic.altitude - own.altitude : 0;
+        vz[i] = altitudeKnown ? traffic.velocityUp - own.velocityUp : 0;
+    }
+
+    // Time of horizontal closest approach, clamped to [0, lookahead], and the separation at that time
+    QVector<double> t(count), horizontal2(count), vertical(count);
+    const double    lookahead   = thresholds.lookaheadSecs;
+    const double*   prx         = rx.constData();
+    const double*   pry         = ry.constData();
+    const double*   prz         = rz.constData();
+    const double*   pvx         = vx.constData();
+    const double*   pvy         = vy.constData();
+    const double*   pvz         = vz.constData();
+    double*         pt          = t.data();
+    double*         ph2         = horizontal2.data();
+    double*         pv          = vertical.data();
+    for (int i=0; i<count; i++) {
+        const double vv     = (pvx[i] * pvx[i]) + (pvy[i] * pvy[i]);
+        const double rv     = (prx[i] * pvx[i]) + (pry[i] * pvy[i]);
+        // With no relative motion the distance is constant and any time in range will do
+        const double tcpa   = std::min(lookahead, std::max(0.0, -rv / std::max(vv, 1e-6)));
+        const double hx     = prx[i] + (pvx[i] * tcpa);
+        const double hy     = pry[i] + (pvy[i] * tcpa);
+        pt[i]   = tcpa;
+        ph2[i]  = (hx * hx) + (hy * hy);
+        pv[i]   = std::fabs(prz[i] + (pvz[i] * tcpa));
+    }
+
+    const double horizontalLimit2 = thresholds.horizontalSeparation * thresholds.horizontalSeparation;
+    for (int i=0; i<count; i++) {
+        if (ph2[i] < horizontalLimit2 && pv[i] < thresholds.verticalSeparation) {
+            const Track_t& traffic = encounter.traffic[i];
+            Conflict_t conflict;
+            conflict.vehicleId      = own.id;
+            conflict.icaoAddress    = traffic.id;
+            conflict.timeToCPA      = pt[i];
+            conflict.horizontalCPA  = qSqrt(ph2[i]);
+            conflict.verticalCPA    = ownAltitudeKnown && !qIsNaN(traffic.altitude) ? pv[i] : qQNaN();
+            conflicts.append(conflict);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+
+/// Closest point of approach between our vehicles and ADSB traffic, assuming both keep their current velocity.
+///
+/// Positions are projected onto a flat local frame around each of our vehicles, which is accurate enough over the few
+/// tens of kilometers traffic is checked within. The traffic near one of our vehicles is laid out in plain arrays and
+/// run through a single branch free loop, which the compiler vectorizes. No Qt objects are touched, so detect can run
+/// on a worker thread with copies of the data.
+class ADSBConflictDetector
+{
+public:
+    /// Position and velocity of one of our vehicles or of a traffic aircraft
+    typedef struct {
+        quint32 id;                 ///< Vehicle id for our vehicles, ICAO address for traffic
+        double  latitude;
+        double  longitude;
+        double  altitude;           ///< Meters AMSL, NaN: not known, only the horizontal check applies
+        double  velocityNorth;      ///< Meters/second, 0 if not known
+        double  velocityEast;
+        double  velocityUp;
+    } Track_t;
+
+    /// Traffic to check against one of our vehicles, normally what the spatial index found near it
+    typedef struct {
+        Track_t             ownVehicle;
+        QVector<Track_t>    traffic;
+    } Encounter_t;
+
+    typedef struct {
+        quint32 vehicleId;
+        quint32 icaoAddress;
+        double  timeToCPA;          ///< Seconds, 0 if the separation is already lost
+        double  horizontalCPA;      ///< Meters
+        double  verticalCPA;        ///< Meters, NaN if either altitude is not known
+    } Conflict_t;
+
+    typedef struct {
+        double lookaheadSecs;
+        double horizontalSeparation;    ///< Meters
+        double verticalSeparation;      ///< Meters
+    } Thresholds_t;
+
+    /// @return Traffic which comes closer than the separation thresholds within the lookahead time
+    static QVector<Conflict_t> detect(const QVector<Encounter_t>& encounters, const Thresholds_t& thresholds);
+
+    /// @return Radius around one of our vehicles within which traffic needs to be checked
+    static double searchRadius(const Track_t& ownVehicle, const Thresholds_t& thresholds);
+
+private:
+    static void _detect(const Encounter_t& encounter, const Thresholds_t& thresholds, QVector<Conflict_t>& conflicts);
+
+    static constexpr double _maxTrafficSpeed = 150.0;   ///< Meters/second assumed for traffic when sizing the search radius
+};
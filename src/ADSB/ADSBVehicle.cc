@@ -21,6 +21,8 @@ ADSBVehicle::ADSBVehicle(const ADSBVehicleInfo_t & vehicleInfo, QObject* parent)
     , _altitude     (qQNaN())
     , _heading      (qQNaN())
     , _alert        (false)
+    , _horizontalVelocity   (qQNaN())
+    , _verticalVelocity     (qQNaN())
 {
     update(vehicleInfo);
 }
@@ -63,9 +65,21 @@ void ADSBVehicle::update(const ADSBVehicleInfo_t & vehicleInfo)
             emit alertChanged();
         }
     }
+    if (vehicleInfo.availableFlags & VelocityAvailable) {
+        _horizontalVelocity = vehicleInfo.horizontalVelocity;
+        _verticalVelocity   = vehicleInfo.verticalVelocity;
+    }
     _lastUpdateTimer.restart();
 }
 
+void ADSBVehicle::setConflict(bool conflict)
+{
+    if (conflict != _conflict) {
+        _conflict = conflict;
+        emit conflictChanged();
+    }
+}
+
 bool ADSBVehicle::expired()
 {
     return _lastUpdateTimer.hasExpired(expirationTimeoutMs);
@@ -26,6 +26,7 @@ public:
         AltitudeAvailable =     1 << 3,
         HeadingAvailable =      1 << 4,
         AlertAvailable =        1 << 5,
+        VelocityAvailable =     1 << 6,
     };
 
     typedef struct {
@@ -35,6 +36,8 @@ public:
         double          altitude;
         double          heading;
         bool            alert;
+        double          horizontalVelocity; ///< Meters/second, along heading
+        double          verticalVelocity;   ///< Meters/second, up
         uint32_t        availableFlags;
     } ADSBVehicleInfo_t;
 
@@ -46,6 +49,7 @@ public:
     Q_PROPERTY(double           altitude    READ altitude       NOTIFY altitudeChanged)     // NaN for not available
     Q_PROPERTY(double           heading     READ heading        NOTIFY headingChanged)      // NaN for not available
     Q_PROPERTY(bool             alert       READ alert          NOTIFY alertChanged)        // Collision path
+    Q_PROPERTY(bool             conflict    READ conflict       NOTIFY conflictChanged)     // Predicted loss of separation with one of our vehicles
 
     int             icaoAddress (void) const { return static_cast<int>(_icaoAddress); }
     QString         callsign    (void) const { return _callsign; }
@@ -53,6 +57,12 @@ public:
     double          altitude    (void) const { return _altitude; }
     double          heading     (void) const { return _heading; }
     bool            alert       (void) const { return _alert; }
+    bool            conflict    (void) const { return _conflict; }
+
+    double          horizontalVelocity  (void) const { return _horizontalVelocity; }  ///< NaN for not available
+    double          verticalVelocity    (void) const { return _verticalVelocity; }    ///< NaN for not available
+
+    void setConflict(bool conflict);
 
     void update(const ADSBVehicleInfo_t & vehicleInfo);
 
@@ -65,6 +75,7 @@ signals:
     void altitudeChanged    ();
     void headingChanged     ();
     void alertChanged       ();
+    void conflictChanged    ();
 
 private:
     uint32_t        _icaoAddress;
@@ -73,6 +84,9 @@ private:
     double          _altitude;
     double          _heading;
     bool            _alert;
+    bool            _conflict           = false;
+    double          _horizontalVelocity;
+    double          _verticalVelocity;
 
     QElapsedTimer   _lastUpdateTimer;
 
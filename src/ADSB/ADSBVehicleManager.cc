@@ -12,14 +12,26 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "ADSBVehicleManagerSettings.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+#include "LinkReactorPool.h"
 
 #include <QDebug>
+#include <QtConcurrent>
+
+#include <cstring>
 
 ADSBVehicleManager::ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
 {
 }
 
+ADSBVehicleManager::~ADSBVehicleManager()
+{
+    // Not a child, it lives on a reactor
+    delete _tcpLink;
+}
+
 void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
 {
     QGCTool::setToolbox(toolbox);
@@ -28,9 +40,15 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
     _adsbVehicleCleanupTimer.start(1000);
 
     ADSBVehicleManagerSettings* settings = qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings();
+    connect(settings->adsbDisplayRadius(),          &Fact::rawValueChanged, this, &ADSBVehicleManager::_updatePublishedVehicles);
+    connect(settings->adsbDisplayAltitudeBand(),    &Fact::rawValueChanged, this, &ADSBVehicleManager::_updatePublishedVehicles);
+
+    connect(&_conflictCheckTimer,   &QTimer::timeout,                   this, &ADSBVehicleManager::_startConflictCheck);
+    connect(&_conflictWatcher,      &QFutureWatcherBase::finished,      this, &ADSBVehicleManager::_conflictCheckComplete);
+    _conflictCheckTimer.start(_conflictCheckIntervalMs);
     if (settings->adsbServerConnectEnabled()->rawValue().toBool()) {
-        _tcpLink = new ADSBTCPLink(settings->adsbServerHostAddress()->rawValue().toString(), settings->adsbServerPort()->rawValue().toInt(), this);
-        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdate,  this, &ADSBVehicleManager::adsbVehicleUpdate,   Qt::QueuedConnection);
+        _tcpLink = new ADSBTCPLink(settings->adsbServerHostAddress()->rawValue().toString(), settings->adsbServerPort()->rawValue().toInt());
+        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdates, this, &ADSBVehicleManager::adsbVehicleUpdates,  Qt::QueuedConnection);
         connect(_tcpLink, &ADSBTCPLink::error,              this, &ADSBVehicleManager::_tcpError,           Qt::QueuedConnection);
     }
 }
@@ -38,31 +56,373 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
 void ADSBVehicleManager::_cleanupStaleVehicles()
 {
     // Remove all expired ADSB vehicles
-    for (int i=_adsbVehicles.count()-1; i>=0; i--) {
-        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
+    QList<ADSBVehicle*> expiredVehicles;
+    for (ADSBVehicle* adsbVehicle: _adsbICAOMap) {
         if (adsbVehicle->expired()) {
-            qCDebug(ADSBVehicleManagerLog) << "Expired " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
-            _adsbVehicles.removeAt(i);
-            _adsbICAOMap.remove(adsbVehicle->icaoAddress());
-            adsbVehicle->deleteLater();
+            expiredVehicles.append(adsbVehicle);
+        }
+    }
+    for (ADSBVehicle* adsbVehicle: expiredVehicles) {
+        qCDebug(ADSBVehicleManagerLog) << "Expired " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+        _removeVehicle(adsbVehicle);
+    }
+
+    // Our vehicles move as well, so what is in range is re-evaluated periodically
+    _updatePublishedVehicles();
+}
+
+void ADSBVehicleManager::_removeVehicle(ADSBVehicle* adsbVehicle)
+{
+    _conflictICAOs.remove(static_cast<uint32_t>(adsbVehicle->icaoAddress()));
+    if (_publishedVehicles.remove(adsbVehicle)) {
+        _adsbVehicles.removeOne(adsbVehicle);
+    }
+    auto it = _vehicleGridCell.find(adsbVehicle);
+    if (it != _vehicleGridCell.end()) {
+        _grid[it.value()].removeOne(adsbVehicle);
+        if (_grid[it.value()].isEmpty()) {
+            _grid.remove(it.value());
         }
+        _vehicleGridCell.erase(it);
     }
+    _adsbICAOMap.remove(static_cast<uint32_t>(adsbVehicle->icaoAddress()));
+    adsbVehicle->deleteLater();
+}
+
+/// Updates an existing vehicle or creates a new one
+/// @return The updated or new vehicle, nullptr if no vehicle was created
+ADSBVehicle* ADSBVehicleManager::_updateVehicle(const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo)
+{
+    uint32_t        icaoAddress = vehicleInfo.icaoAddress;
+    ADSBVehicle*    adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+
+    if (adsbVehicle) {
+        adsbVehicle->update(vehicleInfo);
+    } else {
+        if (!(vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable)) {
+            return nullptr;
+        }
+        adsbVehicle = new ADSBVehicle(vehicleInfo, this);
+        _adsbICAOMap[icaoAddress] = adsbVehicle;
+        qCDebug(ADSBVehicleManagerLog) << "Added " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+    }
+
+    if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
+        _updateGridCell(adsbVehicle);
+    }
+
+    return adsbVehicle;
 }
 
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSBVehicle::ADSBVehicleInfo_t vehicleInfo)
 {
-    uint32_t icaoAddress = vehicleInfo.icaoAddress;
+    ADSBVehicle* adsbVehicle = _updateVehicle(vehicleInfo);
+    if (adsbVehicle) {
+        _publishUpdatedVehicles({ adsbVehicle });
+    }
+}
+
+void ADSBVehicleManager::adsbVehicleUpdates(const QList<ADSBVehicle::ADSBVehicleInfo_t> vehicleInfos)
+{
+    QList<ADSBVehicle*> updatedVehicles;
+    for (const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo: vehicleInfos) {
+        ADSBVehicle* adsbVehicle = _updateVehicle(vehicleInfo);
+        if (adsbVehicle) {
+            updatedVehicles.append(adsbVehicle);
+        }
+    }
+    _publishUpdatedVehicles(updatedVehicles);
+}
+
+/// Adds updated vehicles which came into range to the model and removes the ones which left it
+void ADSBVehicleManager::_publishUpdatedVehicles(const QList<ADSBVehicle*>& updatedVehicles)
+{
+    // New vehicles are added to the model together so the map only sees a single insert
+    QList<QObject*> newVehicles;
+    for (ADSBVehicle* adsbVehicle: updatedVehicles) {
+        bool inRange = _inDisplayRange(adsbVehicle);
+        bool published = _publishedVehicles.contains(adsbVehicle);
+        if (inRange && !published) {
+            _publishedVehicles.insert(adsbVehicle);
+            newVehicles.append(adsbVehicle);
+        } else if (!inRange && published) {
+            _publishedVehicles.remove(adsbVehicle);
+            _adsbVehicles.removeOne(adsbVehicle);
+        }
+    }
+    if (!newVehicles.isEmpty()) {
+        _adsbVehicles.append(newVehicles);
+    }
+}
+
+void ADSBVehicleManager::_updatePublishedVehicles(void)
+{
+    QList<Vehicle*> ownVehicles = _ownVehicles();
+    double          radius      = _displayRadius();
+    double          band        = _displayAltitudeBand();
+
+    QSet<ADSBVehicle*> inRangeVehicles;
+    if (ownVehicles.isEmpty() || radius <= 0) {
+        // No spatial limit, only the altitude band check applies
+        for (ADSBVehicle* adsbVehicle: _adsbICAOMap) {
+            if (_inDisplayRange(adsbVehicle)) {
+                inRangeVehicles.insert(adsbVehicle);
+            }
+        }
+    } else {
+        for (Vehicle* vehicle: ownVehicles) {
+            const QList<ADSBVehicle*> rgInRange = vehiclesInRange(vehicle->coordinate(), radius, vehicle->altitudeAMSL()->rawValue().toDouble(), band);
+            for (ADSBVehicle* adsbVehicle: rgInRange) {
+                inRangeVehicles.insert(adsbVehicle);
+            }
+        }
+    }
+
+    // Vehicles which stay in range keep their place, so their map items are untouched
+    QList<QObject*> newList;
+    for (int i=0; i<_adsbVehicles.count(); i++) {
+        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
+        if (inRangeVehicles.remove(adsbVehicle)) {
+            newList.append(adsbVehicle);
+        }
+    }
+    for (ADSBVehicle* adsbVehicle: inRangeVehicles) {
+        newList.append(adsbVehicle);
+    }
+    _publishedVehicles.clear();
+    for (QObject* object: newList) {
+        _publishedVehicles.insert(qobject_cast<ADSBVehicle*>(object));
+    }
+    _adsbVehicles.applyChanges(newList);
+}
+
+bool ADSBVehicleManager::_inDisplayRange(ADSBVehicle* adsbVehicle) const
+{
+    QList<Vehicle*> ownVehicles = _ownVehicles();
+    if (ownVehicles.isEmpty()) {
+        return true;
+    }
+
+    double radius   = _displayRadius();
+    double band     = _displayAltitudeBand();
+    for (Vehicle* vehicle: ownVehicles) {
+        if (radius > 0 && vehicle->coordinate().distanceTo(adsbVehicle->coordinate()) > radius) {
+            continue;
+        }
+        double altitude = vehicle->altitudeAMSL()->rawValue().toDouble();
+        if (band > 0 && !qIsNaN(altitude) && !qIsNaN(adsbVehicle->altitude()) && qAbs(adsbVehicle->altitude() - altitude) > band) {
+            continue;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+QList<ADSBVehicle*> ADSBVehicleManager::vehiclesInRange(const QGeoCoordinate& center, double radiusMeters, double altitude, double altitudeBandMeters) const
+{
+    QList<ADSBVehicle*> rgInRange;
+
+    if (!center.isValid()) {
+        return rgInRange;
+    }
+
+    // Cells covering the bounding box of the circle, the longitude range wraps at the anti meridian
+    const double    metersPerDegree = 111320.0;
+    const double    latSpan         = radiusMeters / metersPerDegree;
+    const double    cosLat          = qCos(qDegreesToRadians(center.latitude()));
+    const double    lonSpan         = cosLat > 0.01 ? qMin(180.0, radiusMeters / (metersPerDegree * cosLat)) : 180.0;
+    const int       lonCellCount    = _lonIndex(180.0);
+    const int       minLatIndex     = _latIndex(qMax(-90.0, center.latitude() - latSpan));
+    const int       maxLatIndex     = _latIndex(qMin(90.0, center.latitude() + latSpan));
+    int             minLonIndex     = _lonIndex(center.longitude() - lonSpan);
+    int             maxLonIndex     = _lonIndex(center.longitude() + lonSpan);
+    if (maxLonIndex - minLonIndex >= lonCellCount) {
+        minLonIndex = 0;
+        maxLonIndex = lonCellCount - 1;
+    }
+
+    for (int latIndex=minLatIndex; latIndex<=maxLatIndex; latIndex++) {
+        for (int lonIndex=minLonIndex; lonIndex<=maxLonIndex; lonIndex++) {
+            auto it = _grid.constFind(_gridCell(latIndex, ((lonIndex % lonCellCount) + lonCellCount) % lonCellCount));
+            if (it == _grid.constEnd()) {
+                continue;
+            }
+            for (ADSBVehicle* adsbVehicle: it.value()) {
+                if (adsbVehicle->coordinate().distanceTo(center) > radiusMeters) {
+                    continue;
+                }
+                if (altitudeBandMeters > 0 && !qIsNaN(altitude) && !qIsNaN(adsbVehicle->altitude()) && qAbs(adsbVehicle->altitude() - altitude) > altitudeBandMeters) {
+                    continue;
+                }
+                rgInRange.append(adsbVehicle);
+            }
+        }
+    }
+
+    return rgInRange;
+}
+
+void ADSBVehicleManager::_updateGridCell(ADSBVehicle* adsbVehicle)
+{
+    const QGeoCoordinate coordinate = adsbVehicle->coordinate();
+    if (!coordinate.isValid()) {
+        return;
+    }
 
-    if (_adsbICAOMap.contains(icaoAddress)) {
-        _adsbICAOMap[icaoAddress]->update(vehicleInfo);
+    GridCell_t cell = _gridCell(_latIndex(coordinate.latitude()), _lonIndex(coordinate.longitude()));
+    auto it = _vehicleGridCell.find(adsbVehicle);
+    if (it != _vehicleGridCell.end()) {
+        if (it.value() == cell) {
+            return;
+        }
+        _grid[it.value()].removeOne(adsbVehicle);
+        if (_grid[it.value()].isEmpty()) {
+            _grid.remove(it.value());
+        }
+        it.value() = cell;
     } else {
-        if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
-            ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
-            _adsbICAOMap[icaoAddress] = adsbVehicle;
-            _adsbVehicles.append(adsbVehicle);
-            qCDebug(ADSBVehicleManagerLog) << "Added " << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
+        _vehicleGridCell.insert(adsbVehicle, cell);
+    }
+    _grid[cell].append(adsbVehicle);
+}
+
+ADSBVehicleManager::GridCell_t ADSBVehicleManager::_gridCell(int latIndex, int lonIndex)
+{
+    return (static_cast<GridCell_t>(static_cast<quint32>(latIndex)) << 32) | static_cast<quint32>(lonIndex);
+}
+
+int ADSBVehicleManager::_latIndex(double latitude)
+{
+    return static_cast<int>(qFloor((latitude + 90.0) / _gridCellDegrees));
+}
+
+int ADSBVehicleManager::_lonIndex(double longitude)
+{
+    return static_cast<int>(qFloor((longitude + 180.0) / _gridCellDegrees));
+}
+
+double ADSBVehicleManager::_displayRadius(void) const
+{
+    return qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings()->adsbDisplayRadius()->rawValue().toDouble() * 1000.0;
+}
+
+double ADSBVehicleManager::_displayAltitudeBand(void) const
+{
+    return qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings()->adsbDisplayAltitudeBand()->rawValue().toDouble();
+}
+
+/// @return Our vehicles which have a position
+QList<Vehicle*> ADSBVehicleManager::_ownVehicles(void) const
+{
+    QList<Vehicle*> rgVehicles;
+
+    QmlObjectListModel* vehicles = qgcApp()->toolbox()->multiVehicleManager()->vehicles();
+    for (int i=0; i<vehicles->count(); i++) {
+        Vehicle* vehicle = vehicles->value<Vehicle*>(i);
+        if (vehicle->coordinate().isValid()) {
+            rgVehicles.append(vehicle);
         }
     }
+
+    return rgVehicles;
+}
+
+ADSBConflictDetector::Thresholds_t ADSBVehicleManager::_conflictThresholds(void) const
+{
+    ADSBVehicleManagerSettings* settings = qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings();
+
+    ADSBConflictDetector::Thresholds_t thresholds;
+    thresholds.lookaheadSecs        = settings->adsbConflictLookahead()->rawValue().toDouble();
+    thresholds.horizontalSeparation = settings->adsbConflictHorizontalSeparation()->rawValue().toDouble();
+    thresholds.verticalSeparation   = settings->adsbConflictVerticalSeparation()->rawValue().toDouble();
+    return thresholds;
+}
+
+/// Copies our vehicles and the traffic near each of them out of the QObjects and runs the check on a worker
+void ADSBVehicleManager::_startConflictCheck(void)
+{
+    if (_conflictWatcher.isRunning()) {
+        // Still busy with the previous round, which shouldn't happen at this rate
+        return;
+    }
+
+    const ADSBConflictDetector::Thresholds_t thresholds = _conflictThresholds();
+    QVector<ADSBConflictDetector::Encounter_t> encounters;
+    if (thresholds.horizontalSeparation > 0 && thresholds.verticalSeparation > 0) {
+        for (Vehicle* vehicle: _ownVehicles()) {
+            const QGeoCoordinate    coordinate  = vehicle->coordinate();
+            const double            groundSpeed = vehicle->groundSpeed()->rawValue().toDouble();
+            const double            course      = qDegreesToRadians(vehicle->heading()->rawValue().toDouble());
+            const double            climbRate   = vehicle->climbRate()->rawValue().toDouble();
+
+            ADSBConflictDetector::Encounter_t encounter;
+            encounter.ownVehicle.id             = static_cast<quint32>(vehicle->id());
+            encounter.ownVehicle.latitude       = coordinate.latitude();
+            encounter.ownVehicle.longitude      = coordinate.longitude();
+            encounter.ownVehicle.altitude       = vehicle->altitudeAMSL()->rawValue().toDouble();
+            encounter.ownVehicle.velocityNorth  = qIsFinite(groundSpeed) && qIsFinite(course) ? groundSpeed * qCos(course) : 0;
+            encounter.ownVehicle.velocityEast   = qIsFinite(groundSpeed) && qIsFinite(course) ? groundSpeed * qSin(course) : 0;
+            encounter.ownVehicle.velocityUp     = qIsFinite(climbRate) ? climbRate : 0;
+
+            const QList<ADSBVehicle*> rgInRange = vehiclesInRange(coordinate, ADSBConflictDetector::searchRadius(encounter.ownVehicle, thresholds));
+            encounter.traffic.reserve(rgInRange.count());
+            for (ADSBVehicle* adsbVehicle: rgInRange) {
+                const double speed      = adsbVehicle->horizontalVelocity();
+                const double track      = qDegreesToRadians(adsbVehicle->heading());
+                const bool   moving     = qIsFinite(speed) && qIsFinite(track);
+
+                ADSBConflictDetector::Track_t traffic;
+                traffic.id              = static_cast<quint32>(adsbVehicle->icaoAddress());
+                traffic.latitude        = adsbVehicle->coordinate().latitude();
+                traffic.longitude       = adsbVehicle->coordinate().longitude();
+                traffic.altitude        = adsbVehicle->altitude();
+                traffic.velocityNorth   = moving ? speed * qCos(track) : 0;
+                traffic.velocityEast    = moving ? speed * qSin(track) : 0;
+                traffic.velocityUp      = qIsFinite(adsbVehicle->verticalVelocity()) ? adsbVehicle->verticalVelocity() : 0;
+                encounter.traffic.append(traffic);
+            }
+            if (!encounter.traffic.isEmpty()) {
+                encounters.append(encounter);
+            }
+        }
+    }
+
+    if (encounters.isEmpty() && _conflictICAOs.isEmpty()) {
+        return;
+    }
+    _conflictWatcher.setFuture(QtConcurrent::run(&ADSBConflictDetector::detect, encounters, thresholds));
+}
+
+/// Updates the traffic whose conflict state changed
+void ADSBVehicleManager::_conflictCheckComplete(void)
+{
+    QSet<uint32_t> conflictICAOs;
+    for (const ADSBConflictDetector::Conflict_t& conflict: _conflictWatcher.result()) {
+        if (!_conflictICAOs.contains(conflict.icaoAddress) && !conflictICAOs.contains(conflict.icaoAddress)) {
+            qCDebug(ADSBVehicleManagerLog) << "Conflict" << QStringLiteral("%1").arg(conflict.icaoAddress, 0, 16) << "vehicle" << conflict.vehicleId
+                                           << "time to CPA" << conflict.timeToCPA << "horizontal" << conflict.horizontalCPA << "vertical" << conflict.verticalCPA;
+        }
+        conflictICAOs.insert(conflict.icaoAddress);
+    }
+
+    for (uint32_t icaoAddress: conflictICAOs) {
+        if (!_conflictICAOs.contains(icaoAddress)) {
+            ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+            if (adsbVehicle) {
+                adsbVehicle->setConflict(true);
+            }
+        }
+    }
+    for (uint32_t icaoAddress: _conflictICAOs) {
+        if (!conflictICAOs.contains(icaoAddress)) {
+            ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+            if (adsbVehicle) {
+                adsbVehicle->setConflict(false);
+            }
+        }
+    }
+    _conflictICAOs = conflictICAOs;
 }
 
 void ADSBVehicleManager::_tcpError(const QString errorMsg)
@@ -71,158 +431,332 @@ void ADSBVehicleManager::_tcpError(const QString errorMsg)
 }
 
 
-ADSBTCPLink::ADSBTCPLink(const QString& hostAddress, int port, QObject* parent)
-    : QThread       (parent)
-    , _hostAddress  (hostAddress)
+ADSBTCPLink::ADSBTCPLink(const QString& hostAddress, int port)
+    : _hostAddress  (hostAddress)
     , _port         (port)
 {
-    moveToThread(this);
-    start();
+    if (qgcApp()->linkReactorPool()->pin(this)) {
+        QMetaObject::invokeMethod(this, &ADSBTCPLink::_startOnReactor, Qt::QueuedConnection);
+    }
 }
 
 ADSBTCPLink::~ADSBTCPLink(void)
 {
+    qgcApp()->linkReactorPool()->unpin(this, [this]() { _stopOnReactor(); });
+}
+
+void ADSBTCPLink::_startOnReactor(void)
+{
+    // Created here so the timers live on the reactor
+    _updateTimer = new QTimer(this);
+    connect(_updateTimer, &QTimer::timeout, this, &ADSBTCPLink::_sendPendingUpdates);
+    _updateTimer->start(_updateIntervalMs);
+
+    _hardwareConnect();
+}
+
+void ADSBTCPLink::_stopOnReactor(void)
+{
+    if (_updateTimer) {
+        _updateTimer->stop();
+    }
+    if (_connectTimer) {
+        _connectTimer->stop();
+    }
     if (_socket) {
         QObject::disconnect(_socket, &QTcpSocket::readyRead, this, &ADSBTCPLink::_readBytes);
         _socket->disconnectFromHost();
-        _socket->deleteLater();
+        delete _socket;
         _socket = nullptr;
     }
-    quit();
-    wait();
-}
-
-void ADSBTCPLink::run(void)
-{
-    _hardwareConnect();
-    exec();
 }
 
 void ADSBTCPLink::_hardwareConnect()
 {
-    _socket = new QTcpSocket();
+    _socket = new QTcpSocket(this);
     QObject::connect(_socket, &QTcpSocket::readyRead, this, &ADSBTCPLink::_readBytes);
+    QObject::connect(_socket, &QTcpSocket::connected, this, &ADSBTCPLink::_socketConnected);
+
+    // Give the socket a second to connect to the other side otherwise error out. This can't wait for the connection
+    // since that would hold up the other links on the reactor.
+    _connectTimer = new QTimer(this);
+    _connectTimer->setSingleShot(true);
+    connect(_connectTimer, &QTimer::timeout, this, &ADSBTCPLink::_connectTimeout);
+    _connectTimer->start(_connectTimeoutMs);
+
     _socket->connectToHost(_hostAddress, static_cast<quint16>(_port));
+}
 
-    // Give the socket a second to connect to the other side otherwise error out
-    if (!_socket->waitForConnected(1000)) {
+void ADSBTCPLink::_socketConnected(void)
+{
+    _connectTimer->stop();
+    qCDebug(ADSBVehicleManagerLog) << "ADSB Socket connected";
+}
+
+void ADSBTCPLink::_connectTimeout(void)
+{
+    if (_socket) {
         qCDebug(ADSBVehicleManagerLog) << "ADSB Socket failed to connect";
         emit error(_socket->errorString());
         delete _socket;
         _socket = nullptr;
-        return;
     }
-
-    qCDebug(ADSBVehicleManagerLog) << "ADSB Socket connected";
 }
 
 void ADSBTCPLink::_readBytes(void)
 {
     if (_socket) {
-        while(_socket->canReadLine()) {
-            QByteArray bytes = _socket->readLine();
-            _parseLine(QString::fromLocal8Bit(bytes));
+        _rxBuffer.append(_socket->readAll());
+
+        // Lines are parsed in place in the receive buffer, only the trailing partial line is kept for the next read
+        const char* data        = _rxBuffer.constData();
+        int         lineStart   = 0;
+        int         lineEnd;
+        while ((lineEnd = _rxBuffer.indexOf('\n', lineStart)) != -1) {
+            _parseLine(data + lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
         }
+        _rxBuffer.remove(0, lineStart);
     }
 }
 
-void ADSBTCPLink::_parseLine(const QString &line)
+void ADSBTCPLink::_parseLine(const char* line, int length)
 {
-    if (line.startsWith(QStringLiteral("MSG"))) {
-        bool icaoOk;
-        int msgType = line.at(4).digitValue();
-        if (msgType == -1) {
-            qCDebug(ADSBVehicleManagerLog) << "ADSB Invalid message type " << line.at(4);
+    while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == '\n')) {
+        length--;
+    }
+    if (length < 6 || memcmp(line, "MSG,", 4) != 0) {
+        return;
+    }
+
+    int msgType = line[4] - '0';
+    if (msgType < 0 || msgType > 9) {
+        qCDebug(ADSBVehicleManagerLog) << "ADSB Invalid message type " << line[4];
+        return;
+    }
+    // Skip unsupported mesg types to avoid parsing
+    if (msgType == 2 || msgType > 6) {
+        return;
+    }
+    qCDebug(ADSBVehicleManagerLog) << " ADSB SBS-1 " << QByteArray::fromRawData(line, length);
+
+    // Field start and length, without copying
+    const char* fields[_maxFields];
+    int         fieldLengths[_maxFields];
+    int         fieldCount  = 0;
+    const char* fieldStart  = line;
+    const char* lineEnd     = line + length;
+    for (const char* p=line; fieldCount<_maxFields; p++) {
+        if (p == lineEnd || *p == ',') {
+            fields[fieldCount]          = fieldStart;
+            fieldLengths[fieldCount]    = static_cast<int>(p - fieldStart);
+            fieldCount++;
+            fieldStart = p + 1;
+            if (p == lineEnd) {
+                break;
+            }
+        }
+    }
+
+    uint32_t icaoAddress;
+    if (fieldCount < 5 || !_parseHex(fields[4], fieldLengths[4], icaoAddress)) {
+        return;
+    }
+
+    ADSBVehicle::ADSBVehicleInfo_t adsbInfo = {};
+    adsbInfo.icaoAddress = icaoAddress;
+
+    switch (msgType) {
+    case 1:
+    case 5:
+    case 6:
+    {
+        if (fieldCount <= 10) {
             return;
         }
-        // Skip unsupported mesg types to avoid parsing
-        if (msgType == 2 || msgType > 6) {
+        QString callsign = QString::fromLatin1(fields[10], fieldLengths[10]).trimmed();
+        if (callsign.isEmpty()) {
+            return;
+        }
+        adsbInfo.callsign = callsign;
+        adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable;
+        break;
+    }
+    case 3:
+    {
+        if (fieldCount <= 19) {
             return;
         }
-        qCDebug(ADSBVehicleManagerLog) << " ADSB SBS-1 " << line;
-        QStringList values = line.split(QChar(','));
-        uint32_t icaoAddress = values[4].toUInt(&icaoOk, 16);
 
-        if (!icaoOk) {
+        // Altitude is either Barometric - based on pressure, in ft
+        // or HAE - as reported by GPS - based on WGS84 Ellipsoid, in ft
+        // If altitude ends with H, we have HAE
+        // There's a slight difference between Barometric alt and HAE, but it would require
+        // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
+        int altitudeLength = fieldLengths[11];
+        if (altitudeLength > 0 && fields[11][altitudeLength - 1] == 'H') {
+            altitudeLength--;
+        }
+        double modeCAltitude, lat, lon, alert;
+        if (!_parseDouble(fields[11], altitudeLength, modeCAltitude) ||
+                !_parseDouble(fields[14], fieldLengths[14], lat) ||
+                !_parseDouble(fields[15], fieldLengths[15], lon)) {
+            return;
+        }
+        if (lat == 0 && lon == 0) {
             return;
         }
+        if (!_parseDouble(fields[19], fieldLengths[19], alert)) {
+            alert = 0;
+        }
 
-        ADSBVehicle::ADSBVehicleInfo_t adsbInfo;
-        adsbInfo.icaoAddress = icaoAddress;
+        adsbInfo.location = QGeoCoordinate(lat, lon);
+        adsbInfo.altitude = static_cast<int>(modeCAltitude) * 0.3048;
+        adsbInfo.alert = static_cast<int>(alert) == 1;
+        adsbInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable;
+        break;
+    }
+    case 4:
+    {
+        double heading;
+        if (fieldCount <= 13 || !_parseDouble(fields[13], fieldLengths[13], heading)) {
+            return;
+        }
+        adsbInfo.heading = heading;
+        adsbInfo.availableFlags = ADSBVehicle::HeadingAvailable;
 
-        switch (msgType) {
-        case 1:
-        case 5:
-        case 6:
-            _parseAndEmitCallsign(adsbInfo, values);
-            break;
-        case 3:
-            _parseAndEmitLocation(adsbInfo, values);
-            break;
-        case 4:
-            _parseAndEmitHeading(adsbInfo, values);
-            break;
+        // Ground speed in knots, vertical rate in feet/minute
+        double groundSpeed, verticalRate;
+        if (_parseDouble(fields[12], fieldLengths[12], groundSpeed)) {
+            if (fieldCount <= 16 || !_parseDouble(fields[16], fieldLengths[16], verticalRate)) {
+                verticalRate = 0;
+            }
+            adsbInfo.horizontalVelocity = groundSpeed * 0.514444;
+            adsbInfo.verticalVelocity = verticalRate * 0.00508;
+            adsbInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
         }
+        break;
+    }
     }
+
+    _queueUpdate(adsbInfo);
 }
 
-void ADSBTCPLink::_parseAndEmitCallsign(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values)
+/// Merges the update into the pending update for the same aircraft
+void ADSBTCPLink::_queueUpdate(const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo)
 {
-    QString callsign = values[10].trimmed();
-    if (callsign.isEmpty()) {
+    auto it = _pendingUpdates.find(vehicleInfo.icaoAddress);
+    if (it == _pendingUpdates.end()) {
+        _pendingUpdates.insert(vehicleInfo.icaoAddress, vehicleInfo);
         return;
     }
 
-    adsbInfo.callsign = callsign;
-    adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable;
-    emit adsbVehicleUpdate(adsbInfo);
+    ADSBVehicle::ADSBVehicleInfo_t& pendingInfo = it.value();
+    if (vehicleInfo.availableFlags & ADSBVehicle::CallsignAvailable) {
+        pendingInfo.callsign = vehicleInfo.callsign;
+    }
+    if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
+        pendingInfo.location = vehicleInfo.location;
+    }
+    if (vehicleInfo.availableFlags & ADSBVehicle::AltitudeAvailable) {
+        pendingInfo.altitude = vehicleInfo.altitude;
+    }
+    if (vehicleInfo.availableFlags & ADSBVehicle::HeadingAvailable) {
+        pendingInfo.heading = vehicleInfo.heading;
+    }
+    if (vehicleInfo.availableFlags & ADSBVehicle::AlertAvailable) {
+        pendingInfo.alert = vehicleInfo.alert;
+    }
+    if (vehicleInfo.availableFlags & ADSBVehicle::VelocityAvailable) {
+        pendingInfo.horizontalVelocity  = vehicleInfo.horizontalVelocity;
+        pendingInfo.verticalVelocity    = vehicleInfo.verticalVelocity;
+    }
+    pendingInfo.availableFlags |= vehicleInfo.availableFlags;
+}
+
+void ADSBTCPLink::_sendPendingUpdates(void)
+{
+    if (!_pendingUpdates.isEmpty()) {
+        emit adsbVehicleUpdates(_pendingUpdates.values());
+        _pendingUpdates.clear();
+    }
 }
 
-void ADSBTCPLink::_parseAndEmitLocation(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values)
+/// Parses a plain decimal number such as those in SBS-1 messages. This doesn't depend on the C locale, unlike strtod,
+/// and doesn't allocate, unlike the QString/QByteArray conversions.
+bool ADSBTCPLink::_parseDouble(const char* field, int length, double& value)
 {
-    bool altOk, latOk, lonOk;
-    int modeCAltitude;
+    const char* p   = field;
+    const char* end = field + length;
 
-    QString altitudeStr = values[11];
-    // Altitude is either Barometric - based on pressure, in ft
-    // or HAE - as reported by GPS - based on WGS84 Ellipsoid, in ft
-    // If altitude ends with H, we have HAE
-    // There's a slight difference between Barometric alt and HAE, but it would require
-    // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
-    if (altitudeStr.endsWith('H')) {
-        altitudeStr.chop(1);
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    while (end > p && *(end - 1) == ' ') {
+        end--;
     }
-    modeCAltitude = altitudeStr.toInt(&altOk);
 
-    double lat = values[14].toDouble(&latOk);
-    double lon = values[15].toDouble(&lonOk);
-    int alert = values[19].toInt();
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
 
-    if (!altOk || !latOk || !lonOk) {
-        return;
+    quint64 mantissa        = 0;
+    int     fractionDigits  = 0;
+    int     digits          = 0;
+    bool    seenPoint       = false;
+    for (; p < end; p++) {
+        if (*p >= '0' && *p <= '9') {
+            if (digits < 18) {
+                mantissa = (mantissa * 10) + static_cast<quint64>(*p - '0');
+                digits++;
+                if (seenPoint) {
+                    fractionDigits++;
+                }
+            } else if (!seenPoint) {
+                return false;
+            }
+        } else if (*p == '.' && !seenPoint) {
+            seenPoint = true;
+        } else {
+            return false;
+        }
     }
-    if (lat == 0 && lon == 0) {
-        return;
+    if (digits == 0) {
+        return false;
+    }
+
+    static const double rgPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+    value = static_cast<double>(mantissa) / rgPow10[fractionDigits];
+    if (negative) {
+        value = -value;
     }
 
-    double altitude = modeCAltitude * 0.3048;
-    QGeoCoordinate location(lat, lon);
-    adsbInfo.location = location;
-    adsbInfo.altitude = altitude;
-    adsbInfo.alert = alert == 1;
-    adsbInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable | ADSBVehicle::AlertAvailable;
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
 
-void ADSBTCPLink::_parseAndEmitHeading(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values)
+bool ADSBTCPLink::_parseHex(const char* field, int length, uint32_t& value)
 {
-    bool headingOk;
-    double heading = values[13].toDouble(&headingOk);
-    if (!headingOk) {
-        return;
+    if (length <= 0 || length > 8) {
+        return false;
+    }
+
+    value = 0;
+    for (int i=0; i<length; i++) {
+        char c = field[i];
+        uint32_t nibble;
+        if (c >= '0' && c <= '9') {
+            nibble = static_cast<uint32_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = static_cast<uint32_t>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            nibble = static_cast<uint32_t>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        value = (value << 4) | nibble;
     }
 
-    adsbInfo.heading = heading;
-    adsbInfo.availableFlags = ADSBVehicle::HeadingAvailable;
-    emit adsbVehicleUpdate(adsbInfo);
-}
\ No newline at end of file
+    return true;
+}
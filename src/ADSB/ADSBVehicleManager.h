@@ -12,67 +12,130 @@
 #include "QGCToolbox.h"
 #include "QmlObjectListModel.h"
 #include "ADSBVehicle.h"
+#include "ADSBConflictDetector.h"
 
-#include <QThread>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QFutureWatcher>
 #include <QGeoCoordinate>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QtMath>
 
 class ADSBVehicleManagerSettings;
+class Vehicle;
 
-class ADSBTCPLink : public QThread
+/// Reads SBS-1 (BaseStation) messages from a TCP server such as dump1090.
+///
+/// Runs on a LinkReactorPool reactor, where lines are tokenized in place. Updates for the same aircraft are merged and
+/// all updates are delivered in one adsbVehicleUpdates signal every _updateIntervalMs.
+class ADSBTCPLink : public QObject
 {
     Q_OBJECT
 
 public:
-    ADSBTCPLink(const QString& hostAddress, int port, QObject* parent);
+    ADSBTCPLink(const QString& hostAddress, int port);
     ~ADSBTCPLink();
 
 signals:
-    void adsbVehicleUpdate(const ADSBVehicle::ADSBVehicleInfo_t vehicleInfo);
+    void adsbVehicleUpdates(const QList<ADSBVehicle::ADSBVehicleInfo_t> vehicleInfos);
     void error(const QString errorMsg);
 
-protected:
-    void run(void) final;
-
 private slots:
-    void _readBytes(void);
+    void _readBytes             (void);
+    void _sendPendingUpdates    (void);
+    void _socketConnected       (void);
+    void _connectTimeout        (void);
 
 private:
-    void _hardwareConnect(void);
-    void _parseLine(const QString& line);
+    void _startOnReactor    (void);
+    void _stopOnReactor     (void);
+    void _hardwareConnect   (void);
+    void _parseLine         (const char* line, int length);
+    void _queueUpdate       (const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo);
+
+    static bool _parseDouble    (const char* field, int length, double& value);
+    static bool _parseHex       (const char* field, int length, uint32_t& value);
 
     QString         _hostAddress;
     int             _port;
     QTcpSocket*     _socket =   nullptr;
-    void _parseAndEmitCallsign(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values);
-    void _parseAndEmitLocation(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values);
-    void _parseAndEmitHeading(ADSBVehicle::ADSBVehicleInfo_t &adsbInfo, QStringList values);
+    QTimer*         _updateTimer =  nullptr;
+    QTimer*         _connectTimer = nullptr;
+    QByteArray      _rxBuffer;                                              ///< Holds a partial line between reads
+    QHash<uint32_t, ADSBVehicle::ADSBVehicleInfo_t> _pendingUpdates;        ///< Merged updates by ICAO address since the last delivery
+
+    static constexpr int _updateIntervalMs  = 500;
+    static constexpr int _connectTimeoutMs  = 1000;
+    static constexpr int _maxFields         = 22;   ///< Number of fields in an SBS-1 MSG line
 };
 
+/// Keeps track of all ADSB traffic.
+///
+/// Traffic is stored by ICAO address, and by position in a grid of _gridCellDegrees cells so traffic near a position
+/// can be found without looking at all of it. Only traffic within the display radius and altitude band of one of our
+/// vehicles is published to the adsbVehicles model.
+///
+/// Conflicts between our vehicles and traffic are checked every _conflictCheckIntervalMs with ADSBConflictDetector on a
+/// worker thread. Only traffic whose conflict state changed is updated afterwards.
 class ADSBVehicleManager : public QGCTool {
     Q_OBJECT
     
 public:
     ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox);
+    ~ADSBVehicleManager();
 
-    Q_PROPERTY(QmlObjectListModel* adsbVehicles READ adsbVehicles CONSTANT)
+    Q_PROPERTY(QmlObjectListModel* adsbVehicles READ adsbVehicles CONSTANT)     ///< Traffic in display range of our vehicles
 
     QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
 
+    /// Returns the traffic within radiusMeters of center and, if altitudeBandMeters is not 0, within altitudeBandMeters
+    /// of altitude. Traffic without a known altitude is always included by the altitude check.
+    QList<ADSBVehicle*> vehiclesInRange(const QGeoCoordinate& center, double radiusMeters, double altitude = qQNaN(), double altitudeBandMeters = 0) const;
+
     // QGCTool overrides
     void setToolbox(QGCToolbox* toolbox) final;
 
 public slots:
     void adsbVehicleUpdate  (const ADSBVehicle::ADSBVehicleInfo_t vehicleInfo);
+    void adsbVehicleUpdates (const QList<ADSBVehicle::ADSBVehicleInfo_t> vehicleInfos);
     void _tcpError          (const QString errorMsg);
 
 private slots:
-    void _cleanupStaleVehicles(void);
+    void _cleanupStaleVehicles      (void);
+    void _updatePublishedVehicles   (void);
+    void _startConflictCheck        (void);
+    void _conflictCheckComplete     (void);
 
 private:
-    QmlObjectListModel              _adsbVehicles;
-    QMap<uint32_t, ADSBVehicle*>    _adsbICAOMap;
-    QTimer                          _adsbVehicleCleanupTimer;
-    ADSBTCPLink*                    _tcpLink = nullptr;
+    typedef quint64 GridCell_t;
+
+    ADSBVehicle*        _updateVehicle          (const ADSBVehicle::ADSBVehicleInfo_t& vehicleInfo);
+    void                _updateGridCell         (ADSBVehicle* adsbVehicle);
+    void                _removeVehicle          (ADSBVehicle* adsbVehicle);
+    bool                _inDisplayRange         (ADSBVehicle* adsbVehicle) const;
+    void                _publishUpdatedVehicles (const QList<ADSBVehicle*>& updatedVehicles);
+    double              _displayRadius          (void) const;
+    double              _displayAltitudeBand    (void) const;
+    QList<Vehicle*>     _ownVehicles            (void) const;
+    ADSBConflictDetector::Thresholds_t _conflictThresholds(void) const;
+
+    static GridCell_t   _gridCell               (int latIndex, int lonIndex);
+    static int          _latIndex               (double latitude);
+    static int          _lonIndex               (double longitude);
+
+    QmlObjectListModel                          _adsbVehicles;
+    QHash<uint32_t, ADSBVehicle*>               _adsbICAOMap;
+    QHash<GridCell_t, QList<ADSBVehicle*>>      _grid;
+    QHash<ADSBVehicle*, GridCell_t>             _vehicleGridCell;
+    QSet<ADSBVehicle*>                          _publishedVehicles;
+    QTimer                                      _adsbVehicleCleanupTimer;
+    ADSBTCPLink*                                _tcpLink = nullptr;
+    QTimer                                      _conflictCheckTimer;
+    QFutureWatcher<QVector<ADSBConflictDetector::Conflict_t>> _conflictWatcher;
+    QSet<uint32_t>                              _conflictICAOs;     ///< Traffic currently flagged as conflict
+
+    static constexpr double _gridCellDegrees            = 0.1;      ///< About 11km of latitude
+    static constexpr int    _conflictCheckIntervalMs    = 1000;
 };
@@ -59,6 +59,32 @@ adv_sort(QObject* a, QObject* b)
     return static_cast<int>(aa->color()) > static_cast<int>(bb->color());
 }
 
+//-----------------------------------------------------------------------------
+void
+AirMapAdvisoryManager::_setAdvisories(const QList<AdvisoryData_t>& advisories)
+{
+    _advisories.clearAndDeleteContents();
+    _airspaceColor = AirspaceAdvisoryProvider::Green;
+    for (const auto& advisory : advisories) {
+        AirMapAdvisory* pAdvisory = new AirMapAdvisory(this);
+        pAdvisory->_id          = advisory.id;
+        pAdvisory->_name        = advisory.name;
+        pAdvisory->_type        = advisory.type;
+        pAdvisory->_color       = advisory.color;
+        if(pAdvisory->_color > _airspaceColor) {
+            _airspaceColor = pAdvisory->_color;
+        }
+        _advisories.append(pAdvisory);
+        qCDebug(AirMapManagerLog) << "Adding advisory" << pAdvisory->name();
+    }
+    //-- Sort in order of color (priority)
+    _advisories.beginReset();
+    std::sort(_advisories.objectList()->begin(), _advisories.objectList()->end(), adv_sort);
+    _advisories.endReset();
+    _valid = true;
+    emit advisoryChanged();
+}
+
 //-----------------------------------------------------------------------------
 void
 AirMapAdvisoryManager::_requestAdvisories()
@@ -70,18 +96,24 @@ AirMapAdvisoryManager::_requestAdvisories()
         emit advisoryChanged();
         return;
     }
-    _valid = false;
-    _advisories.clearAndDeleteContents();
+    if (_searchInFlight) {
+        //-- Picked up with the latest ROI once the current search is done
+        _searchQueued = true;
+        return;
+    }
 
     Advisory::Search::Parameters params;
     //-- Geometry
     Geometry::Polygon polygon;
+    QString cacheKey;
     //-- Get ROI bounding box, clipping to max area of interest
     for (const auto& qcoord : _lastROI.polygon2D(qgcApp()->toolbox()->airspaceManager()->maxAreaOfInterest())) {
         Geometry::Coordinate coord;
         coord.latitude  = qcoord.latitude();
         coord.longitude = qcoord.longitude();
         polygon.outer_ring.coordinates.push_back(coord);
+        //-- Around 100m, well below ADVISORY_UPDATE_DISTANCE
+        cacheKey += QString::number(qcoord.latitude(), 'f', 3) + "," + QString::number(qcoord.longitude(), 'f', 3) + ";";
     }
     params.geometry = Geometry(polygon);
     //-- Rulesets
@@ -102,43 +134,65 @@ AirMapAdvisoryManager::_requestAdvisories()
     }
     if(ruleIDs.isEmpty()) {
         qCDebug(AirMapManagerLog) << "No rules defined. Not updating Advisories";
+        _advisories.clearAndDeleteContents();
         _valid = false;
         emit advisoryChanged();
         return;
     }
+    cacheKey += ruleIDs;
+    auto cacheIt = _searchCache.constFind(cacheKey);
+    if (cacheIt != _searchCache.constEnd() && !cacheIt->fetched.hasExpired(_searchTTLMsecs)) {
+        qCDebug(AirMapManagerLog) << "Advisories from cache";
+        _setAdvisories(cacheIt->advisories);
+        return;
+    }
     params.rulesets = ruleIDs.toStdString();
     //-- Time
     quint64 start   = static_cast<quint64>(QDateTime::currentDateTimeUtc().toMSecsSinceEpoch());
     quint64 end     = start + 60 * 30 * 1000;
     params.start    = airmap::from_milliseconds_since_epoch(airmap::milliseconds(static_cast<qint64>(start)));
     params.end      = airmap::from_milliseconds_since_epoch(airmap::milliseconds(static_cast<qint64>(end)));
+    _searchInFlight = true;
     std::weak_ptr<LifetimeChecker> isAlive(_instance);
-    _shared.client()->advisory().search(params, [this, isAlive](const Advisory::Search::Result& result) {
+    _shared.client()->advisory().search(params, [this, isAlive, cacheKey](const Advisory::Search::Result& result) {
         if (!isAlive.lock()) return;
+        _searchInFlight = false;
         if (result) {
             qCDebug(AirMapManagerLog) << "Successful advisory search. Items:" << result.value().size();
-            _airspaceColor = AirspaceAdvisoryProvider::Green;
+            QList<AdvisoryData_t> advisories;
             for (const auto& advisory : result.value()) {
-                AirMapAdvisory* pAdvisory = new AirMapAdvisory(this);
-                pAdvisory->_id          = QString::fromStdString(advisory.advisory.airspace.id());
-                pAdvisory->_name        = QString::fromStdString(advisory.advisory.airspace.name());
-                pAdvisory->_type        = static_cast<AirspaceAdvisory::AdvisoryType>(advisory.advisory.airspace.type());
-                pAdvisory->_color       = static_cast<AirspaceAdvisoryProvider::AdvisoryColor>(advisory.color);
-                if(pAdvisory->_color > _airspaceColor) {
-                    _airspaceColor = pAdvisory->_color;
+                AdvisoryData_t data;
+                data.id     = QString::fromStdString(advisory.advisory.airspace.id());
+                data.name   = QString::fromStdString(advisory.advisory.airspace.name());
+                data.type   = static_cast<AirspaceAdvisory::AdvisoryType>(advisory.advisory.airspace.type());
+                data.color  = static_cast<AirspaceAdvisoryProvider::AdvisoryColor>(advisory.color);
+                advisories.append(data);
+            }
+            if (_searchCache.count() >= _maxCachedSearches) {
+                for (auto it = _searchCache.begin(); it != _searchCache.end(); ) {
+                    it = it->fetched.hasExpired(_searchTTLMsecs) ? _searchCache.erase(it) : it + 1;
+                }
+                if (_searchCache.count() >= _maxCachedSearches) {
+                    _searchCache.clear();
                 }
-                _advisories.append(pAdvisory);
-                qCDebug(AirMapManagerLog) << "Adding advisory" << pAdvisory->name();
             }
-            //-- Sort in order of color (priority)
-            _advisories.beginReset();
-            std::sort(_advisories.objectList()->begin(), _advisories.objectList()->end(), adv_sort);
-            _advisories.endReset();
-            _valid = true;
+            CachedSearch_t& cached = _searchCache[cacheKey];
+            cached.advisories = advisories;
+            cached.fetched.start();
+            if (!_searchQueued) {
+                _setAdvisories(advisories);
+            }
         } else {
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
             qCDebug(AirMapManagerLog) << "Advisories Request Failed" << QString::fromStdString(result.error().message()) << description;
+            if (!_searchQueued) {
+                _valid = false;
+                emit advisoryChanged();
+            }
+        }
+        if (_searchQueued) {
+            _searchQueued = false;
+            _requestAdvisories();
         }
-        emit advisoryChanged();
     });
 }
@@ -20,9 +20,15 @@
 
 #include "airmap/status.h"
 
+#include <QHash>
+#include <QElapsedTimer>
+
 /**
  * @file AirMapAdvisoryManager.h
  * Advisory information provided by AirMap.
+ *
+ * Searches are cached for a few minutes by area and rulesets. Only one search is in flight at a time, ROI changes
+ * which happen while waiting for it only cause a single follow up search for the latest ROI.
  */
 
 //-----------------------------------------------------------------------------
@@ -61,11 +67,30 @@ public:
 signals:
     void                error               (const QString& what, const QString& airmapdMessage, const QString& airmapdDetails);
 private:
+    typedef struct {
+        QString         id;
+        QString         name;
+        AirspaceAdvisory::AdvisoryType          type;
+        AirspaceAdvisoryProvider::AdvisoryColor color;
+    } AdvisoryData_t;
+
+    typedef struct {
+        QElapsedTimer           fetched;
+        QList<AdvisoryData_t>   advisories;
+    } CachedSearch_t;
+
     void                _requestAdvisories  ();
+    void                _setAdvisories      (const QList<AdvisoryData_t>& advisories);
 private:
     bool                _valid;
+    bool                _searchInFlight     = false;
+    bool                _searchQueued       = false;
+    QHash<QString, CachedSearch_t> _searchCache;    ///< Keyed by rounded search area and ruleset ids
     AirMapSharedState&  _shared;
     QGCGeoBoundingCube  _lastROI;
     QmlObjectListModel  _advisories;
     AdvisoryColor       _airspaceColor;
+
+    static const qint64 _searchTTLMsecs     = 5 * 60 * 1000;
+    static const int    _maxCachedSearches  = 50;
 };
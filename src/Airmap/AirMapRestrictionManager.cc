@@ -14,7 +14,8 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 
-#define RESTRICTION_UPDATE_DISTANCE    500     //-- 500m threshold for updates
+#include <algorithm>
+#include <cmath>
 
 using namespace airmap;
 
@@ -28,24 +29,168 @@ AirMapRestrictionManager::AirMapRestrictionManager(AirMapSharedState& shared)
 void
 AirMapRestrictionManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
 {
-    if(qgcApp()->toolbox()->settingsManager()->airMapSettings()->enableAirspace()->rawValue().toBool()) {
-        //-- If first time or we've moved more than RESTRICTION_UPDATE_DISTANCE, ask for updates.
-        if(reset ||
-          (!_lastROI.isValid() || _lastROI.pointNW.distanceTo(roi.pointNW) > RESTRICTION_UPDATE_DISTANCE || _lastROI.pointSE.distanceTo(roi.pointSE) > RESTRICTION_UPDATE_DISTANCE) ||
-           (_polygons.count() == 0 && _circles.count() == 0)) {
-            //-- Limit area of interest
-            qCDebug(AirMapManagerLog) << "ROI Area:" << roi.area() << "km^2";
-            if(roi.area() < qgcApp()->toolbox()->airspaceManager()->maxAreaOfInterest()) {
-                _lastROI = roi;
-                _requestRestrictions(roi);
-            } else {
-                _polygons.clear();
-                _circles.clear();
+    if(!qgcApp()->toolbox()->settingsManager()->airMapSettings()->enableAirspace()->rawValue().toBool()) {
+        return;
+    }
+    //-- Limit area of interest
+    qCDebug(AirMapManagerLog) << "ROI Area:" << roi.area() << "km^2";
+    if(!roi.isValid() || roi.area() >= qgcApp()->toolbox()->airspaceManager()->maxAreaOfInterest()) {
+        _lastROI = QGCGeoBoundingCube();
+        _pendingTiles.clear();
+        _polygons.clear();
+        _circles.clear();
+        return;
+    }
+    _lastROI = roi;
+    if(reset) {
+        //-- Refetch everything in view, what we have is still shown until it arrives
+        for(auto& tile : _tiles) {
+            tile.fetched.invalidate();
+        }
+    }
+    _updateVisible();
+    //-- Only the tiles still in view are worth waiting for
+    _pendingTiles.clear();
+    for(quint64 tileKey : _tilesForROI(roi)) {
+        if(!_tileValid(tileKey)) {
+            _pendingTiles.append(tileKey);
+        }
+    }
+    _requestNextTile();
+}
+
+//-----------------------------------------------------------------------------
+QList<quint64>
+AirMapRestrictionManager::_tilesForROI(const QGCGeoBoundingCube& roi) const
+{
+    QList<quint64> tiles;
+    const quint32 rowTop    = static_cast<quint32>(std::floor((roi.pointNW.latitude()  +  90.0) / _tileSize));
+    const quint32 rowBottom = static_cast<quint32>(std::floor((roi.pointSE.latitude()  +  90.0) / _tileSize));
+    const quint32 colLeft   = static_cast<quint32>(std::floor((roi.pointNW.longitude() + 180.0) / _tileSize));
+    const quint32 colRight  = static_cast<quint32>(std::floor((roi.pointSE.longitude() + 180.0) / _tileSize));
+    for(quint32 row = qMin(rowTop, rowBottom); row <= qMax(rowTop, rowBottom); row++) {
+        for(quint32 col = qMin(colLeft, colRight); col <= qMax(colLeft, colRight); col++) {
+            tiles.append((static_cast<quint64>(row) << 32) | col);
+        }
+    }
+    return tiles;
+}
+
+//-----------------------------------------------------------------------------
+QGeoRectangle
+AirMapRestrictionManager::_tileBounds(quint64 tileKey) const
+{
+    const double south  = static_cast<double>(tileKey >> 32)         * _tileSize -  90.0;
+    const double west   = static_cast<double>(tileKey & 0xFFFFFFFF)  * _tileSize - 180.0;
+    return QGeoRectangle(QGeoCoordinate(qMin(south + _tileSize, 90.0), west), QGeoCoordinate(south, qMin(west + _tileSize, 180.0)));
+}
+
+//-----------------------------------------------------------------------------
+bool
+AirMapRestrictionManager::_tileValid(quint64 tileKey) const
+{
+    auto it = _tiles.constFind(tileKey);
+    return it != _tiles.constEnd() && it->fetched.isValid() && !it->fetched.hasExpired(_tileTTLMsecs);
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_updateVisible()
+{
+    QSet<QString> visibleIDs;
+    if(_lastROI.isValid()) {
+        const QGeoRectangle viewBounds(_lastROI.pointNW, _lastROI.pointSE);
+        for(quint64 tileKey : _tilesForROI(_lastROI)) {
+            auto tileIt = _tiles.constFind(tileKey);
+            if(tileIt == _tiles.constEnd()) {
+                continue;
+            }
+            for(const QString& id : tileIt->airspaceIDs) {
+                if(!visibleIDs.contains(id) && _airspaces[id].bounds.intersects(viewBounds)) {
+                    visibleIDs.insert(id);
+                }
+            }
+        }
+    }
+    //-- Remove what went out of view and add what came into view, without touching the rest of the models
+    for(QmlObjectListModel* model : { &_polygons, &_circles }) {
+        for(int i = model->count() - 1; i >= 0; i--) {
+            AirspaceRestriction* restriction = model->value<AirspaceRestriction*>(i);
+            if(!restriction || !visibleIDs.contains(restriction->advisoryID())) {
+                model->removeAt(i);
+            }
+        }
+    }
+    QList<QObject*> newPolygons;
+    QList<QObject*> newCircles;
+    for(const QString& id : visibleIDs) {
+        for(QObject* restriction : _airspaces[id].restrictions) {
+            if(qobject_cast<AirspaceCircularRestriction*>(restriction)) {
+                if(!_circles.contains(restriction)) {
+                    newCircles.append(restriction);
+                }
+            } else if(!_polygons.contains(restriction)) {
+                newPolygons.append(restriction);
+            }
+        }
+    }
+    if(newPolygons.count()) {
+        _polygons.append(newPolygons);
+    }
+    if(newCircles.count()) {
+        _circles.append(newCircles);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_releaseTile(quint64 tileKey)
+{
+    auto tileIt = _tiles.find(tileKey);
+    if(tileIt == _tiles.end()) {
+        return;
+    }
+    const QStringList ids = tileIt->airspaceIDs;
+    _tiles.erase(tileIt);
+    _releaseAirspaces(ids);
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_releaseAirspaces(const QStringList& ids)
+{
+    for(const QString& id : ids) {
+        auto airspaceIt = _airspaces.find(id);
+        if(airspaceIt != _airspaces.end() && --airspaceIt->tileCount <= 0) {
+            for(QObject* restriction : airspaceIt->restrictions) {
+                _polygons.removeOne(restriction);
+                _circles.removeOne(restriction);
+                restriction->deleteLater();
             }
+            _airspaces.erase(airspaceIt);
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_evictTiles()
+{
+    if(_tiles.count() <= _maxTiles) {
+        return;
+    }
+    //-- Drop the tiles furthest away from the current view first
+    QGeoCoordinate center = _lastROI.isValid() ? _lastROI.center() : QGeoCoordinate();
+    QList<QPair<double, quint64>> byDistance;
+    for(auto it = _tiles.constBegin(); it != _tiles.constEnd(); ++it) {
+        double distance = center.isValid() ? center.distanceTo(_tileBounds(it.key()).center()) : 0;
+        byDistance.append(qMakePair(distance, it.key()));
+    }
+    std::sort(byDistance.begin(), byDistance.end());
+    while(_tiles.count() > _maxTiles && byDistance.count()) {
+        _releaseTile(byDistance.takeLast().second);
+    }
+}
 
 //-----------------------------------------------------------------------------
 void
@@ -135,26 +280,32 @@ AirMapRestrictionManager::_getColor(const Airspace& airspace, QColor& color, QCo
 
 //-----------------------------------------------------------------------------
 void
-AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
+AirMapRestrictionManager::_requestNextTile()
 {
     if (!_shared.client()) {
         qCDebug(AirMapManagerLog) << "No AirMap client instance. Not updating Airspace";
         return;
     }
     if (_state != State::Idle) {
-        qCWarning(AirMapManagerLog) << "AirMapRestrictionManager::updateROI: state not idle";
+        //-- The queue is picked up again once the current request is done
         return;
     }
-    qCDebug(AirMapManagerLog) << "Restrictions Request (ROI Changed)";
-    _polygons.clear();
-    _circles.clear();
+    while (_pendingTiles.count() && _tileValid(_pendingTiles.first())) {
+        _pendingTiles.removeFirst();
+    }
+    if (_pendingTiles.isEmpty()) {
+        return;
+    }
+    _requestTileKey = _pendingTiles.takeFirst();
+    const QGeoRectangle tileBounds = _tileBounds(_requestTileKey);
+    qCDebug(AirMapManagerLog) << "Restrictions Request for tile" << tileBounds.topLeft() << tileBounds.bottomRight() << "Pending:" << _pendingTiles.count();
     _state = State::RetrieveItems;
     Airspaces::Search::Parameters params;
     params.full = false;
     params.date_time = Clock::universal_time();
     //-- Geometry: Polygon
     Geometry::Polygon polygon;
-    for (const auto& qcoord : roi.polygon2D()) {
+    for (const auto& qcoord : QGCGeoBoundingCube(tileBounds.topLeft(), tileBounds.bottomRight()).polygon2D()) {
         Geometry::Coordinate coord;
         coord.latitude  = qcoord.latitude();
         coord.longitude = qcoord.longitude();
@@ -166,55 +317,97 @@ AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
             [this, isAlive](const Airspaces::Search::Result& result) {
         if (!isAlive.lock()) return;
         if (_state != State::RetrieveItems) return;
+        _state = State::Idle;
         if (result) {
             const std::vector<Airspace>& airspaces = result.value();
             qCDebug(AirMapManagerLog)<<"Successful search. Items:" << airspaces.size();
+            //-- Replace whatever this tile had before, airspaces still in it are kept alive by the new references
+            QStringList previousIDs;
+            if (_tiles.contains(_requestTileKey)) {
+                previousIDs = _tiles[_requestTileKey].airspaceIDs;
+                _tiles[_requestTileKey].airspaceIDs.clear();
+            }
             for (const auto& airspace : airspaces) {
-                QColor color;
-                QColor lineColor;
-                float  lineWidth;
-                _getColor(airspace, color, lineColor, lineWidth);
-                const Geometry& geometry = airspace.geometry();
-                switch(geometry.type()) {
-                    case Geometry::Type::polygon: {
-                        const Geometry::Polygon& polygon = geometry.details_for_polygon();
-                        _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth);
-                    }
-                        break;
-                    case Geometry::Type::multi_polygon: {
-                        const Geometry::MultiPolygon& multiPolygon = geometry.details_for_multi_polygon();
-                        for (const auto& polygon : multiPolygon) {
-                            _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth);
-                        }
-                    }
-                        break;
-                    case Geometry::Type::point: {
-                        const Geometry::Point& point = geometry.details_for_point();
-                        _circles.append(new AirspaceCircularRestriction(QGeoCoordinate(point.latitude, point.longitude), 0., QString::fromStdString(airspace.id()), color, lineColor, lineWidth));
-                        // TODO: radius???
-                    }
-                        break;
-                    case Geometry::Type::invalid: {
-                        qWarning() << "Invalid geometry type";
-                    }
-                        break;
-                    default:
-                        qWarning() << "Unsupported geometry type: " << static_cast<int>(geometry.type());
-                        break;
-                }
+                _addAirspace(_requestTileKey, airspace);
             }
+            _tiles[_requestTileKey].fetched.start();
+            _releaseAirspaces(previousIDs);
+            _evictTiles();
+            _updateVisible();
         } else {
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
             emit error("Failed to retrieve Geofences",
                     QString::fromStdString(result.error().message()), description);
+            //-- Don't hammer the service after a failure, the next ROI change queues the tile again
+            _pendingTiles.clear();
+            return;
         }
-        _state = State::Idle;
+        _requestNextTile();
     });
 }
 
 //-----------------------------------------------------------------------------
 void
-AirMapRestrictionManager::_addPolygonToList(const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth)
+AirMapRestrictionManager::_addAirspace(quint64 tileKey, const Airspace& airspace)
+{
+    const QString id = QString::fromStdString(airspace.id());
+    QStringList& tileIDs = _tiles[tileKey].airspaceIDs;
+    if (tileIDs.contains(id)) {
+        return;
+    }
+    auto it = _airspaces.find(id);
+    if (it != _airspaces.end()) {
+        //-- Airspaces spanning several tiles are only built once
+        it->tileCount++;
+        tileIDs.append(id);
+        return;
+    }
+    CachedAirspace_t cached;
+    QColor color;
+    QColor lineColor;
+    float  lineWidth;
+    _getColor(airspace, color, lineColor, lineWidth);
+    const Geometry& geometry = airspace.geometry();
+    switch(geometry.type()) {
+        case Geometry::Type::polygon: {
+            const Geometry::Polygon& polygon = geometry.details_for_polygon();
+            cached.restrictions.append(_polygonRestriction(polygon, id, color, lineColor, lineWidth, cached.bounds));
+        }
+            break;
+        case Geometry::Type::multi_polygon: {
+            const Geometry::MultiPolygon& multiPolygon = geometry.details_for_multi_polygon();
+            for (const auto& polygon : multiPolygon) {
+                cached.restrictions.append(_polygonRestriction(polygon, id, color, lineColor, lineWidth, cached.bounds));
+            }
+        }
+            break;
+        case Geometry::Type::point: {
+            const Geometry::Point& point = geometry.details_for_point();
+            QGeoCoordinate center(point.latitude, point.longitude);
+            cached.restrictions.append(new AirspaceCircularRestriction(center, 0., id, color, lineColor, lineWidth, this));
+            cached.bounds = QGeoRectangle(center, center);
+            // TODO: radius???
+        }
+            break;
+        case Geometry::Type::invalid: {
+            qWarning() << "Invalid geometry type";
+        }
+            break;
+        default:
+            qWarning() << "Unsupported geometry type: " << static_cast<int>(geometry.type());
+            break;
+    }
+    if (cached.restrictions.isEmpty()) {
+        return;
+    }
+    cached.tileCount = 1;
+    _airspaces[id] = cached;
+    tileIDs.append(id);
+}
+
+//-----------------------------------------------------------------------------
+QObject*
+AirMapRestrictionManager::_polygonRestriction(const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth, QGeoRectangle& bounds)
 {
     QVariantList polygonArray;
     for (const auto& vertex : polygon.outer_ring.coordinates) {
@@ -224,11 +417,16 @@ AirMapRestrictionManager::_addPolygonToList(const airmap::Geometry::Polygon& pol
         } else {
             coord = QGeoCoordinate(vertex.latitude, vertex.longitude);
         }
+        if (bounds.isValid()) {
+            bounds.extendRectangle(coord);
+        } else {
+            bounds = QGeoRectangle(coord, coord);
+        }
         polygonArray.append(QVariant::fromValue(coord));
     }
-    _polygons.append(new AirspacePolygonRestriction(polygonArray, advisoryID, color, lineColor, lineWidth));
     if (polygon.inner_rings.size() > 0) {
         // no need to support those (they are rare, and in most cases, there's a more restrictive polygon filling the hole)
         qCDebug(AirMapManagerLog) << "Polygon with holes. Size: "<<polygon.inner_rings.size();
     }
+    return new AirspacePolygonRestriction(polygonArray, advisoryID, color, lineColor, lineWidth, this);
 }
@@ -15,7 +15,11 @@
 #include "QGCGeoBoundingCube.h"
 
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include <QGeoCoordinate>
+#include <QGeoRectangle>
 
 #include "airmap/geometry.h"
 #include "airmap/airspaces.h"
@@ -23,6 +27,11 @@
 /**
  * @file AirMapRestrictionManager.h
  * Class to download polygons from AirMap
+ *
+ * Airspaces are requested per fixed size lat/lon tile and cached with a TTL, so panning only requests the tiles
+ * which newly came into view. Tile requests are issued one at a time and tiles which leave the view before their
+ * turn are dropped from the queue. The tile grid doubles as the spatial index for finding the airspaces in view,
+ * the polygon and circle models are updated incrementally from it.
  */
 
 class AirMapRestrictionManager : public AirspaceRestrictionProvider, public LifetimeChecker
@@ -38,8 +47,27 @@ signals:
     void error                          (const QString& what, const QString& airmapdMessage, const QString& airmapdDetails);
 
 private:
-    void            _requestRestrictions(const QGCGeoBoundingCube& roi);
-    void            _addPolygonToList   (const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth);
+    typedef struct {
+        QElapsedTimer   fetched;
+        QStringList     airspaceIDs;
+    } Tile_t;
+
+    typedef struct {
+        QGeoRectangle   bounds;
+        QList<QObject*> restrictions;   ///< AirspacePolygonRestriction/AirspaceCircularRestriction, owned by this
+        int             tileCount = 0;  ///< Number of cached tiles which reference this airspace
+    } CachedAirspace_t;
+
+    void            _requestNextTile    ();
+    void            _addAirspace        (quint64 tileKey, const airmap::Airspace& airspace);
+    void            _releaseTile        (quint64 tileKey);
+    void            _releaseAirspaces   (const QStringList& ids);
+    void            _evictTiles         ();
+    void            _updateVisible      ();
+    QList<quint64>  _tilesForROI        (const QGCGeoBoundingCube& roi) const;
+    QGeoRectangle   _tileBounds         (quint64 tileKey) const;
+    bool            _tileValid          (quint64 tileKey) const;
+    QObject*        _polygonRestriction (const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth, QGeoRectangle& bounds);
     void            _getColor           (const airmap::Airspace& airspace, QColor &color, QColor &lineColor, float &lineWidth);
 
     enum class State {
@@ -52,5 +80,13 @@ private:
     State               _state = State::Idle;
     QmlObjectListModel  _polygons;
     QmlObjectListModel  _circles;
+    QHash<quint64, Tile_t>              _tiles;
+    QHash<QString, CachedAirspace_t>    _airspaces;
+    QList<quint64>                      _pendingTiles;
+    quint64                             _requestTileKey = 0;
+
+    static constexpr double _tileSize       = 0.1;                  ///< Degrees, around 11km
+    static const qint64     _tileTTLMsecs   = 15 * 60 * 1000;
+    static const int        _maxTiles       = 100;
 };
 
@@ -9,9 +9,13 @@
 
 #include "AirMapTelemetry.h"
 #include "AirMapManager.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
 
 #include "QGCMAVLink.h"
 
+#include <QtMath>
+
 #include "airmap/telemetry.h"
 #include "airmap/flights.h"
 
@@ -21,6 +25,8 @@ using namespace airmap;
 AirMapTelemetry::AirMapTelemetry(AirMapSharedState& shared)
     : _shared(shared)
 {
+    _sendTimer.setSingleShot(false);
+    connect(&_sendTimer, &QTimer::timeout, this, &AirMapTelemetry::_sendSample);
 }
 
 //-----------------------------------------------------------------------------
@@ -34,6 +40,9 @@ AirMapTelemetry::vehicleMessageReceived(const mavlink_message_t& message)
     case MAVLINK_MSG_ID_GPS_RAW_INT:
         _handleGPSRawInt(message);
         break;
+    case MAVLINK_MSG_ID_ATTITUDE:
+        _handleAttitude(message);
+        break;
     }
 }
 
@@ -67,34 +76,87 @@ AirMapTelemetry::_handleGlobalPositionInt(const mavlink_message_t& message)
     if (!isTelemetryStreaming()) {
         return;
     }
-    // rate-limit updates to 5 Hz
-    if (!_timerLastSent.hasExpired(200)) {
-        return;
-    }
-    _timerLastSent.restart();
-
     mavlink_global_position_int_t globalPosition;
     mavlink_msg_global_position_int_decode(&message, &globalPosition);
-    Telemetry::Position position{
-        milliseconds_since_epoch(Clock::universal_time()),
+    const auto timestamp = milliseconds_since_epoch(Clock::universal_time());
+    _position = Telemetry::Position{
+        timestamp,
         static_cast<double>(globalPosition.lat / 1e7),
         static_cast<double>(globalPosition.lon / 1e7),
         static_cast<double>(globalPosition.alt) / 1000.0,
         static_cast<double>(globalPosition.relative_alt) / 1000.0,
         static_cast<double>(_lastHdop)
     };
-    Telemetry::Speed speed{
-        milliseconds_since_epoch(Clock::universal_time()),
+    _speed = Telemetry::Speed{
+        timestamp,
         globalPosition.vx / 100.f,
         globalPosition.vy / 100.f,
         globalPosition.vz / 100.f
     };
+    _newPosition = true;
+}
 
-    //qCDebug(AirMapManagerLog) << "Telemetry:" << globalPosition.lat / 1e7 << globalPosition.lon / 1e7;
+//-----------------------------------------------------------------------------
+void
+AirMapTelemetry::_handleAttitude(const mavlink_message_t& message)
+{
+    if (!isTelemetryStreaming()) {
+        return;
+    }
+    mavlink_attitude_t attitude;
+    mavlink_msg_attitude_decode(&message, &attitude);
+    float yaw = qRadiansToDegrees(attitude.yaw);
+    if (yaw < 0.f) {
+        yaw += 360.f;
+    }
+    _attitude = Telemetry::Attitude{
+        milliseconds_since_epoch(Clock::universal_time()),
+        yaw,
+        qRadiansToDegrees(attitude.pitch),
+        qRadiansToDegrees(attitude.roll)
+    };
+    _newAttitude = true;
+}
+
+//-----------------------------------------------------------------------------
+int
+AirMapTelemetry::_sendInterval()
+{
+    uint32_t rate = qgcApp()->toolbox()->settingsManager()->airMapSettings()->telemetryRate()->rawValue().toUInt();
+    return static_cast<int>(1000 / qMax(rate, 1u)) * _backoff;
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapTelemetry::_sendSample()
+{
+    if (!isTelemetryStreaming()) {
+        return;
+    }
+    // Datagrams sent while offline are lost, so slow down until the connection comes back
+    int backoff = qgcApp()->isInternetAvailable() ? 1 : qMin(_backoff * 2, _maxBackoff);
+    if (backoff != _backoff) {
+        qCDebug(AirMapManagerLog) << "Telemetry send interval backoff" << backoff;
+        _backoff = backoff;
+        _sendTimer.setInterval(_sendInterval());
+    }
+    if (_backoff > 1 || !_newPosition) {
+        return;
+    }
+
+    //qCDebug(AirMapManagerLog) << "Telemetry:" << _position.latitude << _position.longitude;
     Flight flight;
     flight.id = _flightID.toStdString();
-    _shared.client()->telemetry().submit_updates(flight, _key,
-        {Telemetry::Update{position}, Telemetry::Update{speed}});
+    // Each submit is encrypted and sent as one datagram, so everything new goes out together
+    if (_newAttitude) {
+        _shared.client()->telemetry().submit_updates(flight, _key,
+            {Telemetry::Update{_position}, Telemetry::Update{_speed}, Telemetry::Update{_attitude}});
+    } else {
+        _shared.client()->telemetry().submit_updates(flight, _key,
+            {Telemetry::Update{_position}, Telemetry::Update{_speed}});
+    }
+    _newPosition = false;
+    _newAttitude = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -122,6 +184,10 @@ AirMapTelemetry::startTelemetryStream(const QString& flightID)
         if (result) {
             _key = result.value().key;
             _state = State::Streaming;
+            _backoff = 1;
+            _newPosition = false;
+            _newAttitude = false;
+            _sendTimer.start(_sendInterval());
         } else {
             _state = State::Idle;
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
@@ -129,7 +195,6 @@ AirMapTelemetry::startTelemetryStream(const QString& flightID)
                     QString::fromStdString(result.error().message()), description);
         }
     });
-    _timerLastSent.start();
 }
 
 //-----------------------------------------------------------------------------
@@ -141,6 +206,7 @@ AirMapTelemetry::stopTelemetryStream()
     }
     qCInfo(AirMapManagerLog) << "Stopping Telemetry stream with flightID" << _flightID;
     _state = State::EndCommunication;
+    _sendTimer.stop();
     Flights::EndFlightCommunications::Parameters params;
     params.authorization = _shared.loginToken().toStdString();
     params.id = _flightID.toStdString();
@@ -14,10 +14,16 @@
 
 #include <QGCMAVLink.h>
 
+#include "airmap/telemetry.h"
+
 #include <QObject>
-#include <QElapsedTimer>
+#include <QTimer>
 
 /// Class to send telemetry data to AirMap
+///
+/// Incoming vehicle messages only update the latest sample. The sample is sent from a timer at the configured
+/// telemetryRate with position, speed and attitude coalesced into a single encrypted datagram. Ticks without a new
+/// sample are skipped and the rate is backed off while the internet connection is down.
 class AirMapTelemetry : public QObject, public LifetimeChecker
 {
     Q_OBJECT
@@ -39,6 +45,9 @@ private:
 
     void _handleGlobalPositionInt   (const mavlink_message_t& message);
     void _handleGPSRawInt           (const mavlink_message_t& message);
+    void _handleAttitude            (const mavlink_message_t& message);
+    void _sendSample                ();
+    int  _sendInterval              ();
 
     enum class State {
         Idle,
@@ -52,6 +61,14 @@ private:
     std::string             _key; ///< key for AES encryption (16 bytes)
     QString                 _flightID;
     float                   _lastHdop = 1.f;
-    QElapsedTimer           _timerLastSent;
+    QTimer                  _sendTimer;
+    int                     _backoff = 1;           ///< Multiplier of the send interval
+    bool                    _newPosition = false;   ///< Position/speed received since the last send
+    bool                    _newAttitude = false;   ///< Attitude received since the last send
+    airmap::Telemetry::Position _position;
+    airmap::Telemetry::Speed    _speed;
+    airmap::Telemetry::Attitude _attitude;
+
+    static const int        _maxBackoff = 8;
 };
 
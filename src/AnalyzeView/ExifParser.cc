@@ -56,6 +56,49 @@ double ExifParser::readTime(QByteArray& buf)
     return tagTime.toMSecsSinceEpoch()/1000.0;
 }
 
+QByteArray ExifParser::readHeader(QIODevice& device)
+{
+    // JPEG segments start with 0xff, a marker byte and a big endian length which includes the length field
+    const uchar     startOfImage    = 0xd8;
+    const uchar     startOfScan     = 0xda;
+    const uchar     app1            = 0xe1;
+    QByteArray      segment;
+    qint64          headerSize      = 0;
+
+    if (!device.seek(0)) {
+        return QByteArray();
+    }
+    segment = device.read(2);
+    if (segment.size() != 2 || static_cast<uchar>(segment[0]) != 0xff || static_cast<uchar>(segment[1]) != startOfImage) {
+        return QByteArray();
+    }
+    while (true) {
+        segment = device.read(4);
+        if (segment.size() != 4 || static_cast<uchar>(segment[0]) != 0xff) {
+            return QByteArray();
+        }
+        uchar   marker          = static_cast<uchar>(segment[1]);
+        qint64  segmentStart    = device.pos() - 4;
+        qint64  segmentLength   = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(segment.constData() + 2));
+        if (marker == startOfScan || segmentLength < 2) {
+            return QByteArray();
+        }
+        if (marker == app1) {
+            headerSize = segmentStart + 2 + segmentLength;
+            break;
+        }
+        if (!device.seek(segmentStart + 2 + segmentLength)) {
+            return QByteArray();
+        }
+    }
+
+    if (!device.seek(0)) {
+        return QByteArray();
+    }
+    QByteArray header = device.read(headerSize);
+    return header.size() == headerSize ? header : QByteArray();
+}
+
 bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag)
 {
     QByteArray app1Header("\xff\xe1", 2);
@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -13,6 +14,11 @@ public:
     ~ExifParser();
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads a JPEG from the start up to the end of its EXIF (APP1) segment, which is all readTime and write
+    /// need. The device is left positioned at the first byte after the header.
+    ///     @return Empty if the image has no EXIF segment
+    static QByteArray readHeader(QIODevice& device);
 };
 
 #endif // EXIFPARSER_H
@@ -15,6 +15,7 @@
 #include <cfloat>
 #include <QDir>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
@@ -22,6 +23,9 @@
 
 static const char* kTagged = "/TAGGED";
 
+const int GeoTagWorker::_progressPollMSecs;
+const int GeoTagWorker::_copyChunkSize;
+
 GeoTagController::GeoTagController()
     : _progress(0)
     , _inProgress(false)
@@ -161,26 +165,18 @@ void GeoTagWorker::run()
     emit progressChanged((100/nSteps));
 
     // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
+    QFuture<double> timeFuture = QtConcurrent::mapped(_imageList, &GeoTagWorker::_readImageTime);
+    if (!_waitForJob(timeFuture, 100/nSteps, 2*(100/nSteps))) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    _imageTime = timeFuture.results();
+    for (double imageTime: _imageTime) {
+        if (qIsNaN(imageTime)) {
             emit error(tr("Geotagging failed. Couldn't open an image."));
             return;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
-        }
     }
 
     // Load log
@@ -190,8 +186,16 @@ void GeoTagWorker::run()
         emit error(tr("Geotagging failed. Couldn't open log file."));
         return;
     }
-    QByteArray log = file.readAll();
-    file.close();
+    // Logs can be several GB, map the file so only the pages being parsed need to be resident
+    qint64      logSize = file.size();
+    const char* log     = reinterpret_cast<const char*>(file.map(0, logSize));
+    QByteArray  logBuffer;
+    if (!log) {
+        qCDebug(GeotaggingLog) << "Unable to map log file, reading it instead" << file.errorString();
+        logBuffer = file.readAll();
+        log = logBuffer.constData();
+        logSize = logBuffer.size();
+    }
 
     // Instantiate appropriate parser
     _triggerList.clear();
@@ -199,13 +203,14 @@ void GeoTagWorker::run()
     QString errorString;
     if (isULog) {
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = parser.getTagsFromLog(log, logSize, _triggerList, errorString);
 
     } else {
         PX4LogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList);
+        parseComplete = parser.getTagsFromLog(log, logSize, _triggerList);
 
     }
+    file.close();
 
     if (!parseComplete) {
         if (_cancel) {
@@ -246,42 +251,33 @@ void GeoTagWorker::run()
     // Tag images
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    QList<TagJob_t> tagJobs;
     for(int i = 0; i < maxIndex; i++) {
         int imageIndex = _imageIndices[i];
         if (imageIndex >= _imageList.count()) {
             emit error(tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count()));
             return;
         }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
-        }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
-
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
-            return;
+        TagJob_t tagJob;
+        tagJob.imageFile = _imageList.at(imageIndex).absoluteFilePath();
+        if(_saveDirectory == "") {
+            tagJob.taggedFile = _imageDirectory + "/TAGGED/" + _imageList.at(imageIndex).fileName();
         } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
+            tagJob.taggedFile = _saveDirectory + "/" + _imageList.at(imageIndex).fileName();
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
+        tagJob.geotag = _triggerList[_triggerIndices[i]];
+        tagJobs.append(tagJob);
+    }
 
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
+    QFuture<QString> tagFuture = QtConcurrent::mapped(tagJobs, &GeoTagWorker::_tagImage);
+    if (!_waitForJob(tagFuture, 4*(100/nSteps), 100)) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    for (const QString& tagError: tagFuture.results()) {
+        if (!tagError.isEmpty()) {
+            emit error(tagError);
             return;
         }
     }
@@ -295,6 +291,67 @@ void GeoTagWorker::run()
     emit progressChanged(100);
 }
 
+template<typename T>
+bool GeoTagWorker::_waitForJob(QFuture<T>& future, double progressStart, double progressEnd)
+{
+    while (!future.isFinished()) {
+        if (_cancel) {
+            future.cancel();
+            future.waitForFinished();
+            return false;
+        }
+        if (future.progressMaximum() > 0) {
+            emit progressChanged(progressStart + ((progressEnd - progressStart) * future.progressValue()) / future.progressMaximum());
+        }
+        QThread::msleep(_progressPollMSecs);
+    }
+    return !_cancel;
+}
+
+double GeoTagWorker::_readImageTime(const QFileInfo& imageInfo)
+{
+    QFile file(imageInfo.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return qQNaN();
+    }
+    // Only the EXIF header is needed for the capture time, not the image data
+    QByteArray header = ExifParser::readHeader(file);
+    if (header.isEmpty()) {
+        qCWarning(GeotaggingLog) << "No EXIF data in" << imageInfo.fileName();
+        return -1.0;
+    }
+    ExifParser exifParser;
+    return exifParser.readTime(header);
+}
+
+QString GeoTagWorker::_tagImage(const TagJob_t& job)
+{
+    QFile fileRead(job.imageFile);
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        return tr("Geotagging failed. Couldn't open an image.");
+    }
+
+    // The geotag only changes the EXIF header, the image data which follows it is copied unchanged
+    QByteArray header = ExifParser::readHeader(fileRead);
+    cameraFeedbackPacket geotag = job.geotag;
+    ExifParser exifParser;
+    if (header.isEmpty() || !exifParser.write(header, geotag)) {
+        return tr("Geotagging failed. Couldn't write to image.");
+    }
+
+    QFile fileWrite(job.taggedFile);
+    if (!fileWrite.open(QFile::WriteOnly) || fileWrite.write(header) != header.size()) {
+        return tr("Geotagging failed. Couldn't write to an image.");
+    }
+    while (!fileRead.atEnd()) {
+        QByteArray chunk = fileRead.read(_copyChunkSize);
+        if (chunk.isEmpty() || fileWrite.write(chunk) != chunk.size()) {
+            return tr("Geotagging failed. Couldn't write to an image.");
+        }
+    }
+    return QString();
+}
+
 bool GeoTagWorker::triggerFiltering()
 {
     _imageIndices.clear();
@@ -20,6 +20,7 @@
 #include <QElapsedTimer>
 #include <QDebug>
 #include <QGeoCoordinate>
+#include <QFuture>
 
 class GeoTagWorker : public QThread
 {
@@ -59,8 +60,29 @@ signals:
     void progressChanged    (double progress);
 
 private:
+    typedef struct {
+        QString                 imageFile;
+        QString                 taggedFile;
+        cameraFeedbackPacket    geotag;
+    } TagJob_t;
+
     bool triggerFiltering();
 
+    /// Runs on the thread pool
+    ///     @return Image capture time, NaN if the image can't be opened
+    static double   _readImageTime  (const QFileInfo& imageInfo);
+    /// Runs on the thread pool
+    ///     @return Error message, empty on success
+    static QString  _tagImage       (const TagJob_t& job);
+
+    /// Waits for a thread pool job to finish while reporting progress from progressStart to progressEnd
+    ///     @return false: Tagging cancelled
+    template<typename T>
+    bool _waitForJob(QFuture<T>& future, double progressStart, double progressEnd);
+
+    static const int _progressPollMSecs = 100;
+    static const int _copyChunkSize     = 1024 * 1024;
+
     bool                    _cancel;
     QString                 _logFile;
     QString                 _imageDirectory;
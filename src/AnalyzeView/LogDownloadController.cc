@@ -22,55 +22,109 @@
 #include <QDebug>
 #include <QSettings>
 #include <QUrl>
-#include <QBitArray>
+#include <QMap>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
 #include <QtCore/qmath.h>
 
+#include <iterator>
+
 #define kTimeOutMilliseconds 500
 #define kGUIRateMilliseconds 17
 #define kTableBins           512
 #define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kMinWindowSize       kChunkSize                  ///< Request window before a data rate is known
+#define kMaxWindowSize       (kChunkSize * 96)           ///< About 4MB
+#define kWindowSeconds       1.0                         ///< Window is sized to keep this much data in flight
+#define kWriteBlockSize      (64 * 1024)                 ///< Contiguous data is written to disk in blocks up to this size
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
 //-----------------------------------------------------------------------------
 struct LogDownloadData {
     LogDownloadData(QGCLogEntry* entry);
-    QBitArray     chunk_table;
-    uint32_t      current_chunk;
+    ~LogDownloadData();
+
     QFile         file;
     QString       filename;
     uint          ID;
     QGCLogEntry*  entry;
-    uint          written;
+    uint          written;          ///< Bytes of the log received so far, duplicates are not counted
     size_t        rate_bytes;
     qreal         rate_avg;
     QElapsedTimer elapsed;
+    uint32_t      request_end;      ///< End offset of the outstanding LOG_REQUEST_DATA range
 
-    void advanceChunk()
-    {
-           current_chunk++;
-           chunk_table = QBitArray(chunkBins(), false);
-    }
+    /// Received byte ranges, start offset to end offset. Adjacent and overlapping ranges are merged.
+    QMap<uint32_t, uint32_t> received;
 
-    // The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const
+    // Marks [start, end) as received
+    // @return Number of bytes which were not received before
+    uint32_t addReceived(uint32_t start, uint32_t end)
     {
-        return qMin(qCeil((entry->size() - current_chunk*kChunkSize)/static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)),
-                    kTableBins);
+        uint32_t added = end - start;
+        auto iter = received.upperBound(start);
+        if (iter != received.begin() && std::prev(iter).value() >= start) {
+            iter = std::prev(iter);
+        }
+        while (iter != received.end() && iter.key() <= end) {
+            uint32_t overlapStart   = qMax(iter.key(), start);
+            uint32_t overlapEnd     = qMin(iter.value(), end);
+            if (overlapEnd > overlapStart) {
+                added -= overlapEnd - overlapStart;
+            }
+            start   = qMin(start, iter.key());
+            end     = qMax(end, iter.value());
+            iter    = received.erase(iter);
+        }
+        received.insert(start, end);
+        return added;
     }
 
-    // The number of kChunkSize chunks in the file
-    uint32_t numChunks() const
+    // Finds the first range not yet received, searching from offset and then from the start of the log
+    // @return false: Everything has been received
+    bool nextMissing(uint32_t offset, uint32_t& start, uint32_t& end) const
     {
-        return qCeil(entry->size() / static_cast<qreal>(kChunkSize));
+        for (uint32_t from: { offset, 0u }) {
+            start = from;
+            auto iter = received.upperBound(from);
+            if (iter != received.begin() && std::prev(iter).value() > from) {
+                start = std::prev(iter).value();
+            }
+            end = iter == received.end() ? entry->size() : iter.key();
+            if (start < end) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    // True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const
+    bool complete() const
     {
-        return chunk_table == QBitArray(chunk_table.size(), val);
-    }
-
+        return received.count() == 1 && received.firstKey() == 0 && received.first() >= entry->size();
+    }
+
+    // Writes are collected into contiguous blocks on the main thread and done on a writer thread, so a slow disk
+    // never holds up processing of incoming LOG_DATA.
+    void startWriter();
+    void queueWrite(uint32_t offset, const uint8_t* data, uint8_t count);
+    void stopWriter();
+    bool writeError() const { return _writeError.loadAcquire() != 0; }
+
+private:
+    void _flushWrite();
+    void _writeLoop();
+
+    QThread*                            _writerThread   = nullptr;
+    QMutex                              _writeLock;
+    QWaitCondition                      _writeWake;
+    QList<QPair<qint64, QByteArray>>    _writeQueue;
+    bool                                _writeStop      = false;
+    QAtomicInt                          _writeError     = 0;
+    QByteArray                          _pendingWrite;
+    qint64                              _pendingOffset  = 0;
 };
 
 //----------------------------------------------------------------------------------------
@@ -80,8 +134,93 @@ LogDownloadData::LogDownloadData(QGCLogEntry* entry_)
     , written(0)
     , rate_bytes(0)
     , rate_avg(0)
+    , request_end(0)
+{
+
+}
+
+//----------------------------------------------------------------------------------------
+LogDownloadData::~LogDownloadData()
+{
+    stopWriter();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadData::startWriter()
 {
+    _writeStop = false;
+    _writerThread = QThread::create([this]() { _writeLoop(); });
+    _writerThread->start();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadData::queueWrite(uint32_t offset, const uint8_t* data, uint8_t count)
+{
+    if (!_pendingWrite.isEmpty() && (_pendingOffset + _pendingWrite.size() != offset || _pendingWrite.size() >= kWriteBlockSize)) {
+        _flushWrite();
+    }
+    if (_pendingWrite.isEmpty()) {
+        _pendingOffset = offset;
+        _pendingWrite.reserve(kWriteBlockSize + MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+    }
+    _pendingWrite.append(reinterpret_cast<const char*>(data), count);
+}
 
+//----------------------------------------------------------------------------------------
+void
+LogDownloadData::_flushWrite()
+{
+    if (_pendingWrite.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&_writeLock);
+    _writeQueue.append(qMakePair(_pendingOffset, _pendingWrite));
+    _pendingWrite.clear();
+    _writeWake.wakeOne();
+}
+
+//----------------------------------------------------------------------------------------
+/// Writes all queued data and closes the file
+void
+LogDownloadData::stopWriter()
+{
+    if (!_writerThread) {
+        return;
+    }
+    _flushWrite();
+    _writeLock.lock();
+    _writeStop = true;
+    _writeWake.wakeOne();
+    _writeLock.unlock();
+    _writerThread->wait();
+    delete _writerThread;
+    _writerThread = nullptr;
+    file.close();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadData::_writeLoop()
+{
+    QMutexLocker locker(&_writeLock);
+    while (!_writeStop || !_writeQueue.isEmpty()) {
+        if (_writeQueue.isEmpty()) {
+            _writeWake.wait(&_writeLock);
+            continue;
+        }
+        QList<QPair<qint64, QByteArray>> writeQueue;
+        writeQueue.swap(_writeQueue);
+        locker.unlock();
+        for (const QPair<qint64, QByteArray>& write: writeQueue) {
+            if (!file.seek(write.first) || file.write(write.second) != write.second.size()) {
+                qWarning() << "Error while writing log file" << file.errorString();
+                _writeError.storeRelease(1);
+            }
+        }
+        locker.relock();
+    }
 }
 
 //----------------------------------------------------------------------------------------
@@ -296,7 +435,7 @@ LogDownloadController::_findMissingEntries()
 void LogDownloadController::_updateDataRate(void)
 {
     if (_downloadData->elapsed.elapsed() >= kGUIRateMilliseconds) {
-        //-- Update download rate
+        //-- Update download rate, only counting data which was not received before
         qreal rrate = _downloadData->rate_bytes / (_downloadData->elapsed.elapsed() / 1000.0);
         _downloadData->rate_avg = (_downloadData->rate_avg * 0.95) + (rrate * 0.05);
         _downloadData->rate_bytes = 0;
@@ -330,75 +469,77 @@ LogDownloadController::_logData(UASInterface* uas, uint32_t ofs, uint16_t id, ui
         return;
     }
 
-    bool result = false;
-    uint32_t timeout_time = kTimeOutMilliseconds;
-    if(ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / kChunkSize;
-        if (chunk != _downloadData->current_chunk) {
-            qWarning() << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
-            return;
-        }
-        const uint16_t bin = (ofs - chunk*kChunkSize) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qWarning() << "Out of range bin received";
-        } else
-            _downloadData->chunk_table.setBit(bin);
-        if (_downloadData->file.pos() != ofs) {
-            // Seek to correct position
-            if (!_downloadData->file.seek(ofs)) {
-                qWarning() << "Error while seeking log file offset";
-                return;
-            }
-        }
-
-        //-- Write chunk to file
-        if(_downloadData->file.write((const char*)data, count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            _updateDataRate();
-            result = true;
-            //-- reset retries
-            _retries = 0;
-            //-- Reset timer
-            _timer.start(timeout_time);
-            //-- Do we have it all?
-            if(_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
-                //-- Check for more
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk*kChunkSize,
-                                _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if (bin < _downloadData->chunk_table.size() - 1 && _downloadData->chunk_table.at(bin+1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
-            qWarning() << "Error while writing log file chunk";
-        }
-    } else {
+    if (ofs > _downloadData->entry->size() || count > _downloadData->entry->size() - ofs) {
         qWarning() << "Received log offset greater than expected";
+        _downloadData->entry->setStatus(tr("Error"));
+        return;
     }
-    if(!result) {
+
+    if (_downloadData->writeError()) {
         _downloadData->entry->setStatus(tr("Error"));
+        return;
+    }
+
+    const uint32_t end = ofs + count;
+    const uint32_t added = _downloadData->addReceived(ofs, end);
+    if (added) {
+        _downloadData->queueWrite(ofs, data, count);
+        _downloadData->written += added;
+        _downloadData->rate_bytes += added;
+    }
+    _updateDataRate();
+    //-- reset retries
+    _retries = 0;
+    //-- Reset timer
+    _timer.start(kTimeOutMilliseconds);
+    //-- Do we have it all?
+    if(_logComplete()) {
+        _downloadData->stopWriter();
+        _downloadData->entry->setStatus(_downloadData->writeError() ? tr("Error") : tr("Downloaded"));
+        //-- Check for more
+        _receivedAllData();
+        return;
+    }
+
+    //-- Keep the request window ahead of the data stream. A new request replaces the outstanding one, so it is only
+    //   sent once the stream is inside the last half of the window, and always continues from the stream position.
+    const uint32_t window = _windowSize();
+    if (end >= _downloadData->request_end || _downloadData->request_end - end < window / 2) {
+        _requestWindow(end, end >= _downloadData->request_end);
     }
 }
 
+//----------------------------------------------------------------------------------------
+uint32_t
+LogDownloadController::_windowSize() const
+{
+    // Sized to keep kWindowSeconds of data in flight at the measured goodput
+    uint32_t window = static_cast<uint32_t>(qBound(static_cast<qreal>(kMinWindowSize), _downloadData->rate_avg * kWindowSeconds, static_cast<qreal>(kMaxWindowSize)));
+    return window - (window % MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+}
 
 //----------------------------------------------------------------------------------------
-bool
-LogDownloadController::_chunkComplete() const
+/// Requests the next range which has not been received yet, starting at offset
+///     @param force Send the request even if it doesn't extend the outstanding one
+void
+LogDownloadController::_requestWindow(uint32_t offset, bool force)
 {
-    return _downloadData->chunkEquals(true);
+    uint32_t start = 0, end = 0;
+    if (!_downloadData->nextMissing(offset, start, end)) {
+        return;
+    }
+    end = qMin(end, start + _windowSize());
+    if (force || end > _downloadData->request_end) {
+        _downloadData->request_end = end;
+        _requestLogData(_downloadData->ID, start, end - start, _retries);
+    }
 }
 
 //----------------------------------------------------------------------------------------
 bool
 LogDownloadController::_logComplete() const
 {
-    return _chunkComplete() && (_downloadData->current_chunk+1) == _downloadData->numChunks();
+    return _downloadData->complete();
 }
 
 //----------------------------------------------------------------------------------------
@@ -409,7 +550,7 @@ LogDownloadController::_receivedAllData()
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
         //-- Request Log
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
+        _requestWindow(0, true);
         _timer.start(kTimeOutMilliseconds);
     } else {
         _resetSelection();
@@ -424,8 +565,6 @@ LogDownloadController::_findMissingData()
     if (_logComplete()) {
          _receivedAllData();
          return;
-    } else if (_chunkComplete()) {
-        _downloadData->advanceChunk();
     }
 
     _retries++;
@@ -443,23 +582,8 @@ LogDownloadController::_findMissingData()
 
     _updateDataRate();
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
-    }
-
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
-        }
-    }
-
-    const uint32_t pos = _downloadData->current_chunk*kChunkSize + start*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN,
-                   len = (end - start)*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    //-- Stream stalled, restart it at the first missing range
+    _requestWindow(0, true);
 }
 
 //----------------------------------------------------------------------------------------
@@ -633,8 +757,7 @@ LogDownloadController::_prepareLogDownload()
         if(!_downloadData->file.resize(entry->size())) {
             qWarning() << "Failed to allocate space for log file:" <<  _downloadData->filename;
         } else {
-            _downloadData->current_chunk = 0;
-            _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
+            _downloadData->startWriter();
             _downloadData->elapsed.start();
             result = true;
         }
@@ -703,6 +826,7 @@ LogDownloadController::cancel(void)
     }
     if(_downloadData) {
         _downloadData->entry->setStatus(tr("Canceled"));
+        _downloadData->stopWriter();
         if (_downloadData->file.exists()) {
             _downloadData->file.remove();
         }
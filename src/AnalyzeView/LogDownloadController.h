@@ -145,7 +145,6 @@ private slots:
 
 private:
     bool _entriesComplete   ();
-    bool _chunkComplete     () const;
     bool _logComplete       () const;
     void _findMissingEntries();
     void _receivedAllEntries();
@@ -154,6 +153,8 @@ private:
     void _findMissingData   ();
     void _requestLogList    (uint32_t start, uint32_t end);
     void _requestLogData    (uint16_t id, uint32_t offset, uint32_t count, int retryCount = 0);
+    void _requestWindow     (uint32_t offset, bool force);
+    uint32_t _windowSize    () const;
     bool _prepareLogDownload();
     void _setDownloading    (bool active);
     void _setListing        (bool active);
@@ -10,6 +10,7 @@
 #include "MAVLinkInspectorController.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
+#include "QGCMemoryAccounting.h"
 #include <QtCharts/QLineSeries>
 
 QGC_LOGGING_CATEGORY(MAVLinkInspectorLog, "MAVLinkInspectorLog")
@@ -39,6 +40,8 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
         _pSeries = series;
         emit seriesChanged();
         _dataIndex = 0;
+        _sampleCount = 0;
+        _values.resize(_maxSamples);
         _msg->updateFieldSelection();
     }
 }
@@ -49,8 +52,12 @@ QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
         _values.clear();
+        _values.squeeze();
+        _sampleCount = 0;
+        _plotValues.clear();
+        _plotValues.squeeze();
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->clear();
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -87,65 +94,130 @@ QGCMAVLinkMessageField::chartIndex()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
+QGCMAVLinkMessageField::updateValue(const QString& newValue)
 {
     if(_value != newValue) {
         _value = newValue;
         emit valueChanged();
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::addSample(qreal v)
+{
     if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
-        } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
-        }
-        //-- Auto Range
-        if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
-            }
-            bool changed = false;
-            if(std::abs(_rangeMin - vmin) > 0.000001) {
-                _rangeMin = vmin;
-                changed = true;
-            }
-            if(std::abs(_rangeMax - vmax) > 0.000001) {
-                _rangeMax = vmax;
-                changed = true;
-            }
-            if(changed) {
-                _chart->updateYRange();
-            }
-        }
+        _values[_dataIndex] = QPointF(QGC::bootTimeMilliseconds(), v);
+        if(++_dataIndex == _maxSamples) _dataIndex = 0;
+        if(_sampleCount < _maxSamples) _sampleCount++;
+        _newSamples = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::_updateRange(qreal vmin, qreal vmax)
+{
+    bool changed = false;
+    if(std::abs(_rangeMin - vmin) > 0.000001) {
+        _rangeMin = vmin;
+        changed = true;
+    }
+    if(std::abs(_rangeMax - vmax) > 0.000001) {
+        _rangeMax = vmax;
+        changed = true;
+    }
+    if(changed) {
+        _chart->updateYRange();
     }
 }
 
 //-----------------------------------------------------------------------------
+qint64
+QGCMAVLinkMessageField::memoryBytes() const
+{
+    return static_cast<qint64>(sizeof(*this))
+        + static_cast<qint64>(_values.capacity() + _plotValues.capacity()) * static_cast<qint64>(sizeof(QPointF))
+        + static_cast<qint64>(_name.capacity() + _type.capacity() + _value.capacity()) * static_cast<qint64>(sizeof(QChar));
+}
+
+//-----------------------------------------------------------------------------
+/// Hands the samples in the time window of the chart to the series. When there are more samples than fit the plot
+/// width they are decimated to the min and max of each pixel column, so the cost only depends on the plot width.
 void
 QGCMAVLinkMessageField::updateSeries()
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
+    if(!_newSamples || !_pSeries || !_chart) {
+        return;
+    }
+    _newSamples = false;
+
+    const qreal windowStart = static_cast<qreal>(_chart->rangeXMin().toMSecsSinceEpoch());
+    const qreal windowSpan  = qMax(static_cast<qreal>(_chart->rangeXMax().toMSecsSinceEpoch()) - windowStart, 1.0);
+    const int   columns     = qMax(_chart->plotWidth(), 1);
+
+    // Skip the samples which are older than the window
+    int first = _sampleCount < _maxSamples ? 0 : _dataIndex;
+    int count = _sampleCount;
+    while(count > 0 && _values[first].x() < windowStart) {
+        if(++first == _maxSamples) first = 0;
+        count--;
+    }
+
+    _plotValues.resize(0);
+    qreal vmin  = std::numeric_limits<qreal>::max();
+    qreal vmax  = std::numeric_limits<qreal>::min();
+    const bool decimate = count > (columns * 2);
+    int     column      = -1;
+    QPointF columnMin;
+    QPointF columnMax;
+    for(int i = 0, idx = first; i < count; i++) {
+        const QPointF& p = _values[idx];
+        if(++idx == _maxSamples) idx = 0;
+        if(vmax < p.y()) vmax = p.y();
+        if(vmin > p.y()) vmin = p.y();
+        if(!decimate) {
+            _plotValues.append(p);
+            continue;
         }
+        const int pointColumn = static_cast<int>((p.x() - windowStart) * columns / windowSpan);
+        if(pointColumn != column) {
+            if(column != -1) {
+                _appendColumn(columnMin, columnMax);
+            }
+            column      = pointColumn;
+            columnMin   = p;
+            columnMax   = p;
+        } else {
+            if(p.y() < columnMin.y()) columnMin = p;
+            if(p.y() > columnMax.y()) columnMax = p;
+        }
+    }
+    if(column != -1) {
+        _appendColumn(columnMin, columnMax);
+    }
+
+    //-- Auto Range
+    if(_chart->rangeYIndex() == 0 && count > 0) {
+        _updateRange(vmin, vmax);
+    }
+    if(_plotValues.count() > 1) {
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
+        lineSeries->replace(_plotValues);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::_appendColumn(const QPointF& columnMin, const QPointF& columnMax)
+{
+    // Keep the time order of the two points so the line does not step back
+    if(columnMin.x() <= columnMax.x()) {
+        _plotValues.append(columnMin);
+        if(columnMax != columnMin) _plotValues.append(columnMax);
+    } else {
+        _plotValues.append(columnMax);
+        _plotValues.append(columnMin);
     }
 }
 
@@ -177,8 +249,31 @@ QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message
             case MAVLINK_TYPE_INT64_T:  type = QString("int64_t");  break;
         }
         QGCMAVLinkMessageField* f = new QGCMAVLinkMessageField(this, msgInfo->fields[i].name, type);
+        if(msgInfo->fields[i].type == MAVLINK_TYPE_CHAR) {
+            f->setSelectable(false);
+        }
         _fields.append(f);
     }
+    _accessors = &_fieldAccessors(msgInfo, message->msgid);
+}
+
+//-----------------------------------------------------------------------------
+const QVector<QGCMAVLinkMessage::FieldAccessor_t>&
+QGCMAVLinkMessage::_fieldAccessors(const mavlink_message_info_t* msgInfo, uint32_t msgid)
+{
+    // Built once per message id and shared by the messages of all systems and components. Only used from the GUI thread.
+    static QHash<uint32_t, QVector<FieldAccessor_t>> accessorTables;
+
+    auto iter = accessorTables.find(msgid);
+    if(iter == accessorTables.end()) {
+        QVector<FieldAccessor_t> accessors;
+        accessors.reserve(static_cast<int>(msgInfo->num_fields));
+        for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
+            accessors.append({ msgInfo->fields[i].wire_offset, msgInfo->fields[i].type, msgInfo->fields[i].array_length });
+        }
+        iter = accessorTables.insert(msgid, accessors);
+    }
+    return iter.value();
 }
 
 //-----------------------------------------------------------------------------
@@ -187,6 +282,20 @@ QGCMAVLinkMessage::~QGCMAVLinkMessage()
     _fields.clearAndDeleteContents();
 }
 
+//-----------------------------------------------------------------------------
+qint64
+QGCMAVLinkMessage::memoryBytes()
+{
+    qint64 bytes = static_cast<qint64>(sizeof(*this));
+    for (int i = 0; i < _fields.count(); ++i) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
+        if(f) {
+            bytes += f->memoryBytes();
+        }
+    }
+    return bytes;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMAVLinkMessage::updateFieldSelection()
@@ -234,239 +343,147 @@ QGCMAVLinkMessage::update(mavlink_message_t* message)
     _message = *message;
 
     if (_selected) {
-        // Don't update field info unless selected to reduce perf hit of message processing
+        // Don't format field values unless selected to reduce perf hit of message processing
         _updateFields();
     }
+    if (_fieldSelected) {
+        _sampleFields();
+    }
     emit countChanged();
 }
 
-void QGCMAVLinkMessage::_updateFields(void)
+template<typename T>
+static QString _formatValues(const uint8_t* data, unsigned int count)
 {
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&_message);
-    if (!msgInfo) {
-        qWarning() << QStringLiteral("QGCMAVLinkMessage::update NULL msgInfo msgid(%1)").arg(_message.msgid);
-        return;
+    QString string;
+    for (unsigned int i = 0; i < count; ++i) {
+        T value;
+        memcpy(&value, data + (i * sizeof(T)), sizeof(T));
+        if (i > 0) {
+            string += QStringLiteral(", ");
+        }
+        string += QString::number(value);
     }
-    if(_fields.count() != static_cast<int>(msgInfo->num_fields)) {
+    return string;
+}
+
+template<typename T>
+static qreal _firstValue(const uint8_t* data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return static_cast<qreal>(value);
+}
+
+void QGCMAVLinkMessage::_updateFields(void)
+{
+    if (!_accessors || _fields.count() != _accessors->count()) {
         qWarning() << QStringLiteral("QGCMAVLinkMessage::update msgInfo field count mismatch msgid(%1)").arg(_message.msgid);
         return;
     }
-    uint8_t* m = reinterpret_cast<uint8_t*>(&_message.payload64[0]);
-    for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
-        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(static_cast<int>(i)));
+    for (int i = 0; i < _accessors->count(); ++i) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
         if(f) {
-            const unsigned int offset = msgInfo->fields[i].wire_offset;
-            const unsigned int array_length = msgInfo->fields[i].array_length;
-            static const unsigned int array_buffer_length = (MAVLINK_MAX_PAYLOAD_LEN + MAVLINK_NUM_CHECKSUM_BYTES + 7);
-            switch (msgInfo->fields[i].type) {
-            case MAVLINK_TYPE_CHAR:
-                f->setSelectable(false);
-                if (array_length > 0) {
-                    char* str = reinterpret_cast<char*>(m + offset);
-                    // Enforce null termination
-                    str[array_length - 1] = '\0';
-                    QString v(str);
-                    f->updateValue(v, 0);
-                } else {
-                    // Single char
-                    char b = *(reinterpret_cast<char*>(m + offset));
-                    QString v(b);
-                    f->updateValue(v, 0);
-                }
-                break;
-            case MAVLINK_TYPE_UINT8_T:
-                if (array_length > 0) {
-                    uint8_t* nums = m + offset;
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint8_t u = *(m + offset);
-                    f->updateValue(QString::number(u), static_cast<qreal>(u));
-                }
-                break;
-            case MAVLINK_TYPE_INT8_T:
-                if (array_length > 0) {
-                    int8_t* nums = reinterpret_cast<int8_t*>(m + offset);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int8_t n = *(reinterpret_cast<int8_t*>(m + offset));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_UINT16_T:
-                if (array_length > 0) {
-                    uint16_t nums[array_buffer_length / sizeof(uint16_t)];
-                    memcpy(nums, m + offset,  sizeof(uint16_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint16_t n;
-                    memcpy(&n, m + offset, sizeof(uint16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_INT16_T:
-                if (array_length > 0) {
-                    int16_t nums[array_buffer_length / sizeof(int16_t)];
-                    memcpy(nums, m + offset,  sizeof(int16_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int16_t n;
-                    memcpy(&n, m + offset, sizeof(int16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_UINT32_T:
-                if (array_length > 0) {
-                    uint32_t nums[array_buffer_length / sizeof(uint32_t)];
-                    memcpy(nums, m + offset,  sizeof(uint32_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint32_t n;
-                    memcpy(&n, m + offset, sizeof(uint32_t));
-                    //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
-                        QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n),Qt::UTC,0);
-                        f->updateValue(d.toString("HH:mm:ss"), static_cast<qreal>(n));
-                    } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
-                    }
-                }
-                break;
-            case MAVLINK_TYPE_INT32_T:
-                if (array_length > 0) {
-                    int32_t nums[array_buffer_length / sizeof(int32_t)];
-                    memcpy(nums, m + offset,  sizeof(int32_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int32_t n;
-                    memcpy(&n, m + offset, sizeof(int32_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_FLOAT:
-                if (array_length > 0) {
-                    float nums[array_buffer_length / sizeof(float)];
-                    memcpy(nums, m + offset,  sizeof(float) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                       string += tmp.arg(static_cast<double>(nums[j]));
-                    }
-                    string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    float fv;
-                    memcpy(&fv, m + offset, sizeof(float));
-                    f->updateValue(QString::number(static_cast<double>(fv)), static_cast<qreal>(fv));
-                }
-                break;
-            case MAVLINK_TYPE_DOUBLE:
-                if (array_length > 0) {
-                    double nums[array_buffer_length / sizeof(double)];
-                    memcpy(nums, m + offset,  sizeof(double) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    double d;
-                    memcpy(&d, m + offset, sizeof(double));
-                    f->updateValue(QString::number(d), static_cast<qreal>(d));
-                }
-                break;
-            case MAVLINK_TYPE_UINT64_T:
-                if (array_length > 0) {
-                    uint64_t nums[array_buffer_length / sizeof(uint64_t)];
-                    memcpy(nums, m + offset,  sizeof(uint64_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint64_t n;
-                    memcpy(&n, m + offset, sizeof(uint64_t));
-                    //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
-                        QDateTime d = QDateTime::fromMSecsSinceEpoch(n/1000,Qt::UTC,0);
-                        f->updateValue(d.toString("yyyy MM dd HH:mm:ss"), static_cast<qreal>(n));
-                    } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
-                    }
-                }
-                break;
-            case MAVLINK_TYPE_INT64_T:
-                if (array_length > 0) {
-                    int64_t nums[array_buffer_length / sizeof(int64_t)];
-                    memcpy(nums, m + offset,  sizeof(int64_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int64_t n;
-                    memcpy(&n, m + offset, sizeof(int64_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            }
+            f->updateValue(_formatField(_accessors->at(i)));
         }
     }
 }
 
+/// Adds the raw values of the charted fields to their series, no text formatting is done
+void QGCMAVLinkMessage::_sampleFields(void)
+{
+    if (!_accessors || _fields.count() != _accessors->count()) {
+        return;
+    }
+    for (int i = 0; i < _accessors->count(); ++i) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
+        if(f && f->selected()) {
+            f->addSample(_fieldValue(_accessors->at(i)));
+        }
+    }
+}
+
+QString QGCMAVLinkMessage::_formatField(const FieldAccessor_t& accessor)
+{
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(&_message.payload64[0]) + accessor.offset;
+    const unsigned int count = accessor.arrayLength > 0 ? accessor.arrayLength : 1;
+    switch (accessor.type) {
+    case MAVLINK_TYPE_CHAR:
+        if (accessor.arrayLength > 0) {
+            // String may not be null terminated
+            const char* str = reinterpret_cast<const char*>(m);
+            return QString::fromLatin1(str, static_cast<int>(qstrnlen(str, accessor.arrayLength)));
+        } else {
+            // Single char
+            return QString(QChar::fromLatin1(*reinterpret_cast<const char*>(m)));
+        }
+    case MAVLINK_TYPE_UINT8_T:
+        return _formatValues<uint8_t>(m, count);
+    case MAVLINK_TYPE_INT8_T:
+        return _formatValues<int8_t>(m, count);
+    case MAVLINK_TYPE_UINT16_T:
+        return _formatValues<uint16_t>(m, count);
+    case MAVLINK_TYPE_INT16_T:
+        return _formatValues<int16_t>(m, count);
+    case MAVLINK_TYPE_UINT32_T:
+        //-- Special case
+        if (accessor.arrayLength == 0 && _message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+            QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(_firstValue<uint32_t>(m)),Qt::UTC,0);
+            return d.toString("HH:mm:ss");
+        }
+        return _formatValues<uint32_t>(m, count);
+    case MAVLINK_TYPE_INT32_T:
+        return _formatValues<int32_t>(m, count);
+    case MAVLINK_TYPE_FLOAT:
+        return _formatValues<float>(m, count);
+    case MAVLINK_TYPE_DOUBLE:
+        return _formatValues<double>(m, count);
+    case MAVLINK_TYPE_UINT64_T:
+        //-- Special case
+        if (accessor.arrayLength == 0 && _message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
+            uint64_t n;
+            memcpy(&n, m, sizeof(n));
+            QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n/1000),Qt::UTC,0);
+            return d.toString("yyyy MM dd HH:mm:ss");
+        }
+        return _formatValues<uint64_t>(m, count);
+    case MAVLINK_TYPE_INT64_T:
+        return _formatValues<int64_t>(m, count);
+    }
+    return QString();
+}
+
+qreal QGCMAVLinkMessage::_fieldValue(const FieldAccessor_t& accessor) const
+{
+    // Arrays are charted by their first element
+    const uint8_t* m = reinterpret_cast<const uint8_t*>(&_message.payload64[0]) + accessor.offset;
+    switch (accessor.type) {
+    case MAVLINK_TYPE_CHAR:
+        return 0;
+    case MAVLINK_TYPE_UINT8_T:
+        return _firstValue<uint8_t>(m);
+    case MAVLINK_TYPE_INT8_T:
+        return _firstValue<int8_t>(m);
+    case MAVLINK_TYPE_UINT16_T:
+        return _firstValue<uint16_t>(m);
+    case MAVLINK_TYPE_INT16_T:
+        return _firstValue<int16_t>(m);
+    case MAVLINK_TYPE_UINT32_T:
+        return _firstValue<uint32_t>(m);
+    case MAVLINK_TYPE_INT32_T:
+        return _firstValue<int32_t>(m);
+    case MAVLINK_TYPE_FLOAT:
+        return _firstValue<float>(m);
+    case MAVLINK_TYPE_DOUBLE:
+        return _firstValue<double>(m);
+    case MAVLINK_TYPE_UINT64_T:
+        return _firstValue<uint64_t>(m);
+    case MAVLINK_TYPE_INT64_T:
+        return _firstValue<int64_t>(m);
+    }
+    return 0;
+}
+
 //-----------------------------------------------------------------------------
 QGCMAVLinkSystem::QGCMAVLinkSystem(QObject* parent, quint8 id)
     : QObject(parent)
@@ -485,15 +502,15 @@ QGCMAVLinkSystem::~QGCMAVLinkSystem()
 QGCMAVLinkMessage*
 QGCMAVLinkSystem::findMessage(uint32_t id, uint8_t cid)
 {
-    for(int i = 0; i < _messages.count(); i++) {
-        QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_messages.get(i));
-        if(m) {
-            if(m->id() == id && m->cid() == cid) {
-                return m;
-            }
-        }
-    }
-    return nullptr;
+    return _messageMap.value(_messageKey(id, cid), nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkSystem::clearMessages()
+{
+    _messageMap.clear();
+    _messages.clearAndDeleteContents();
 }
 
 //-----------------------------------------------------------------------------
@@ -562,6 +579,7 @@ QGCMAVLinkSystem::append(QGCMAVLinkMessage* message)
         message->setSelected(true);
     }
     _messages.append(message);
+    _messageMap.insert(_messageKey(message->id(), message->cid()), message);
     //-- Sort messages by id and then cid
     if (_messages.count() > 0) {
         _messages.beginReset();
@@ -622,6 +640,16 @@ MAVLinkChartController::setRangeYIndex(quint32 r)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkChartController::setPlotWidth(int width)
+{
+    if(_plotWidth != width) {
+        _plotWidth = width;
+        emit plotWidthChanged();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkChartController::setRangeXIndex(quint32 t)
@@ -730,7 +758,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &MAVLinkInspectorController::_vehicleAdded);
     connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkInspectorController::_vehicleRemoved);
     MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
-    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    mavlinkProtocol->subscribe(this, MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, MAVLinkProtocol::anyId,
+                               [this](LinkInterface* link, const mavlink_message_t& message) { _receiveMessage(link, message); });
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
@@ -751,6 +780,7 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     _rangeSt.append(new Range_st(this, tr("0.001"),   0.001));
     _rangeSt.append(new Range_st(this, tr("0.0001"),  0.0001));
     emit rangeListChanged();
+    qgcApp()->toolbox()->memoryAccounting()->addSource(this, QStringLiteral("Inspector"), [this](){ return _memoryBytes(); });
 }
 
 //-----------------------------------------------------------------------------
@@ -760,6 +790,25 @@ MAVLinkInspectorController::~MAVLinkInspectorController()
     _systems.clearAndDeleteContents();
 }
 
+//----------------------------------------------------------------------------------------
+qint64
+MAVLinkInspectorController::_memoryBytes()
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < _systems.count(); i++) {
+        QGCMAVLinkSystem* system = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
+        if (system) {
+            for (int j = 0; j < system->messages()->count(); j++) {
+                QGCMAVLinkMessage* message = qobject_cast<QGCMAVLinkMessage*>(system->messages()->get(j));
+                if (message) {
+                    bytes += message->memoryBytes();
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
 //----------------------------------------------------------------------------------------
 QStringList
 MAVLinkInspectorController::timeScales()
@@ -839,7 +888,7 @@ MAVLinkInspectorController::_vehicleAdded(Vehicle* vehicle)
 {
     QGCMAVLinkSystem* v = _findVehicle(static_cast<uint8_t>(vehicle->id()));
     if(v) {
-        v->messages()->clearAndDeleteContents();
+        v->clearMessages();
     } else {
         v = new QGCMAVLinkSystem(this, static_cast<uint8_t>(vehicle->id()));
         _systems.append(v);
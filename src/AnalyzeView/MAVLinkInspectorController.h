@@ -20,6 +20,8 @@
 #include <QString>
 #include <QDebug>
 #include <QVariantList>
+#include <QVector>
+#include <QHash>
 #include <QtCharts/QAbstractSeries>
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkInspectorLog)
@@ -53,17 +55,18 @@ public:
     bool            selectable      () const{ return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
     qreal           rangeMin        () const{ return _rangeMin; }
     qreal           rangeMax        () const{ return _rangeMax; }
     int             chartIndex      ();
 
     void            setSelectable   (bool sel);
-    void            updateValue     (QString newValue, qreal v);
+    void            updateValue     (const QString& newValue);
+    void            addSample       (qreal v);
 
     void            addSeries       (MAVLinkChartController* chart, QAbstractSeries* series);
     void            delSeries       ();
     void            updateSeries    ();
+    qint64          memoryBytes     () const;
 
 signals:
     void            seriesChanged       ();
@@ -71,18 +74,26 @@ signals:
     void            valueChanged        ();
 
 private:
+    void        _updateRange    (qreal vmin, qreal vmax);
+    void        _appendColumn   (const QPointF& columnMin, const QPointF& columnMax);
+
     QString     _type;
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
+    int         _dataIndex  = 0;        ///< Next sample is written here, oldest sample once _values is full
+    int         _sampleCount= 0;
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+    QVector<QPointF>    _values;        ///< Fixed size ring of _maxSamples samples while charted
+    QVector<QPointF>    _plotValues;    ///< Decimated samples of the chart window, reused for each series update
+    bool                _newSamples = false;
+
+    static const int    _maxSamples = 100 * 60; ///< Longest time scale (1 minute) at 100Hz
 };
 
 //-----------------------------------------------------------------------------
@@ -116,6 +127,7 @@ public:
     void                update          (mavlink_message_t* message);
     void                updateFreq      ();
     void                setSelected     (bool sel);
+    qint64              memoryBytes     ();
 
 signals:
     void countChanged                   ();
@@ -124,9 +136,22 @@ signals:
     void selectedChanged                ();
 
 private:
-    void _updateFields(void);
+    /// Location of a field in the payload, taken from the mavlink message info once per message id
+    typedef struct {
+        unsigned int            offset;
+        mavlink_message_type_t  type;
+        unsigned int            arrayLength;
+    } FieldAccessor_t;
+
+    static const QVector<FieldAccessor_t>& _fieldAccessors(const mavlink_message_info_t* msgInfo, uint32_t msgid);
+
+    void    _updateFields   (void);
+    void    _sampleFields   (void);
+    QString _formatField    (const FieldAccessor_t& accessor);
+    qreal   _fieldValue     (const FieldAccessor_t& accessor) const;
 
     QmlObjectListModel  _fields;
+    const QVector<FieldAccessor_t>* _accessors = nullptr;   ///< One per field, nullptr for unknown messages
     QString             _name;
     qreal               _messageHz      = 0.0;
     uint64_t            _count          = 1;
@@ -160,6 +185,7 @@ public:
     QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);
     int                 findMessage     (QGCMAVLinkMessage* message);
     void                append          (QGCMAVLinkMessage* message);
+    void                clearMessages   ();
 
 signals:
     void compIDsChanged                 ();
@@ -170,10 +196,13 @@ private:
     void _resetSelection                ();
 
 private:
+    static quint64 _messageKey(uint32_t id, uint8_t cid) { return (static_cast<quint64>(id) << 8) | cid; }
+
     quint8              _id;
     QList<int>          _compIDs;
     QStringList         _compIDsStr;
     QmlObjectListModel  _messages;      //-- List of QGCMAVLinkMessage
+    QHash<quint64, QGCMAVLinkMessage*> _messageMap;    //-- _messages by id and cid, for the lookup on each received message
     int                 _selected = 0;
 };
 
@@ -193,6 +222,7 @@ public:
 
     Q_PROPERTY(quint32      rangeYIndex         READ rangeYIndex            WRITE setRangeYIndex    NOTIFY rangeYIndexChanged)
     Q_PROPERTY(quint32      rangeXIndex         READ rangeXIndex            WRITE setRangeXIndex    NOTIFY rangeXIndexChanged)
+    Q_PROPERTY(int          plotWidth           READ plotWidth              WRITE setPlotWidth      NOTIFY plotWidthChanged)   ///< Pixels, samples are decimated to this
 
     Q_INVOKABLE void        addSeries           (QGCMAVLinkMessageField* field, QAbstractSeries* series);
     Q_INVOKABLE void        delSeries           (QGCMAVLinkMessageField* field);
@@ -207,9 +237,11 @@ public:
     quint32                 rangeXIndex         () const{ return _rangeXIndex; }
     quint32                 rangeYIndex         () const{ return _rangeYIndex; }
     int                     chartIndex          () const{ return _index; }
+    int                     plotWidth           () const{ return _plotWidth; }
 
     void                    setRangeXIndex      (quint32 t);
     void                    setRangeYIndex      (quint32 r);
+    void                    setPlotWidth        (int width);
     void                    updateXRange        ();
     void                    updateYRange        ();
 
@@ -221,6 +253,7 @@ signals:
     void rangeYMaxChanged   ();
     void rangeYIndexChanged ();
     void rangeXIndexChanged ();
+    void plotWidthChanged   ();
 
 private slots:
     void _refreshSeries     ();
@@ -234,6 +267,7 @@ private:
     qreal               _rangeYMax           = 1;
     quint32             _rangeXIndex         = 0;                    ///< 5 Seconds
     quint32             _rangeYIndex         = 0;                    ///< Auto Range
+    int                 _plotWidth           = 1000;
     QVariantList        _chartFields;
     MAVLinkInspectorController* _controller  = nullptr;
 };
@@ -298,6 +332,7 @@ private slots:
 
 private:
     QGCMAVLinkSystem* _findVehicle (uint8_t id);
+    qint64            _memoryBytes (void);
 
 private:
 
@@ -16,6 +16,19 @@
 MavlinkConsoleController::MavlinkConsoleController()
     : QStringListModel()
 {
+    _sendTimer.setSingleShot(true);
+    _sendTimer.setInterval(_sendIntervalMSecs);
+    connect(&_sendTimer, &QTimer::timeout, this, &MavlinkConsoleController::_sendPending);
+    _receiveTimer.setSingleShot(true);
+    _receiveTimer.setInterval(_receiveBatchMSecs);
+    connect(&_receiveTimer, &QTimer::timeout, this, &MavlinkConsoleController::_processIncoming);
+
+    // Keep the rich text cache in sync with the rows
+    connect(this, &QAbstractItemModel::rowsInserted, this, &MavlinkConsoleController::_rowsInserted);
+    connect(this, &QAbstractItemModel::rowsRemoved,  this, &MavlinkConsoleController::_rowsRemoved);
+    connect(this, &QAbstractItemModel::dataChanged,  this, &MavlinkConsoleController::_rowsChanged);
+    connect(this, &QAbstractItemModel::modelReset,   this, &MavlinkConsoleController::_modelReset);
+
     auto *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &MavlinkConsoleController::_setActiveVehicle);
     _setActiveVehicle(manager->activeVehicle());
@@ -77,6 +90,9 @@ MavlinkConsoleController::_setActiveVehicle(Vehicle* vehicle)
     _uas_connections.clear();
 
     _vehicle = vehicle;
+    _sendTimer.stop();
+    _receiveTimer.stop();
+    _outgoing_buffer.clear();
 
     if (_vehicle) {
         _incoming_buffer.clear();
@@ -95,8 +111,18 @@ MavlinkConsoleController::_receiveData(uint8_t device, uint8_t, uint16_t, uint32
     if (device != SERIAL_CONTROL_DEV_SHELL)
         return;
 
-    // Append incoming data and parse for ANSI codes
+    // Output arrives in many small packets, process them together
     _incoming_buffer.append(data);
+    if (!_receiveTimer.isActive()) {
+        _receiveTimer.start();
+    }
+}
+
+void
+MavlinkConsoleController::_processIncoming()
+{
+    // Parse for ANSI codes. A fragment which is incomplete stays in the buffer until more data arrives.
+    const int bufferSize = _incoming_buffer.size();
     while(!_incoming_buffer.isEmpty()) {
         bool newline = false;
         int idx = _incoming_buffer.indexOf('\n');
@@ -122,9 +148,12 @@ MavlinkConsoleController::_receiveData(uint8_t device, uint8_t, uint16_t, uint32
             _incoming_buffer.remove(0, idx + (newline ? 1 : 0));
         } else {
             // ANSI processing failed, need more data
-            return;
+            break;
         }
     }
+    if (_incoming_buffer.size() != bufferSize) {
+        emit textChanged();
+    }
 }
 
 void
@@ -135,37 +164,65 @@ MavlinkConsoleController::_sendSerialData(QByteArray data, bool close)
         return;
     }
 
+    if (close) {
+        _sendTimer.stop();
+        _outgoing_buffer.clear();
+        _sendSerialControl(QByteArray(), 0);
+        return;
+    }
+
+    // Data is sent in full sized packets, a few at a time so large pastes do not overrun the vehicle shell input
+    _outgoing_buffer.append(data);
+    if (!_sendTimer.isActive()) {
+        _sendPending();
+    }
+}
+
+void
+MavlinkConsoleController::_sendPending()
+{
+    if (!_vehicle) {
+        _outgoing_buffer.clear();
+        return;
+    }
+
+    for (int i = 0; i < _sendBurstPackets && !_outgoing_buffer.isEmpty(); i++) {
+        _sendSerialControl(_outgoing_buffer.left(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN),
+                           SERIAL_CONTROL_FLAG_EXCLUSIVE |  SERIAL_CONTROL_FLAG_RESPOND | SERIAL_CONTROL_FLAG_MULTI);
+        _outgoing_buffer.remove(0, MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN);
+    }
+    if (!_outgoing_buffer.isEmpty()) {
+        _sendTimer.start();
+    }
+}
+
+void
+MavlinkConsoleController::_sendSerialControl(const QByteArray& data, uint8_t flags)
+{
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (!sharedLink) {
         return;
     }
 
-    // Send maximum sized chunks until the complete buffer is transmitted
-    while(data.size()) {
-        QByteArray chunk{data.left(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN)};
-        int dataSize = chunk.size();
-        // Ensure the buffer is large enough, as the MAVLink parser expects MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN bytes
-        chunk.append(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN - chunk.size(), '\0');
-        uint8_t flags = SERIAL_CONTROL_FLAG_EXCLUSIVE |  SERIAL_CONTROL_FLAG_RESPOND | SERIAL_CONTROL_FLAG_MULTI;
-        if (close) flags = 0;
-        auto protocol = qgcApp()->toolbox()->mavlinkProtocol();
-        auto link = _vehicle->vehicleLinkManager()->primaryLink();
-        mavlink_message_t msg;
-        mavlink_msg_serial_control_pack_chan(
-                    protocol->getSystemId(),
-                    protocol->getComponentId(),
-                    sharedLink->mavlinkChannel(),
-                    &msg,
-                    SERIAL_CONTROL_DEV_SHELL,
-                    flags,
-                    0,
-                    0,
-                    dataSize,
-                    reinterpret_cast<uint8_t*>(chunk.data()),
-                    _vehicle->id(), _vehicle->defaultComponentId());
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-        data.remove(0, chunk.size());
-    }
+    QByteArray chunk{data};
+    int dataSize = chunk.size();
+    // Ensure the buffer is large enough, as the MAVLink parser expects MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN bytes
+    chunk.append(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN - chunk.size(), '\0');
+    auto protocol = qgcApp()->toolbox()->mavlinkProtocol();
+    mavlink_message_t msg;
+    mavlink_msg_serial_control_pack_chan(
+                protocol->getSystemId(),
+                protocol->getComponentId(),
+                sharedLink->mavlinkChannel(),
+                &msg,
+                SERIAL_CONTROL_DEV_SHELL,
+                flags,
+                0,
+                0,
+                dataSize,
+                reinterpret_cast<uint8_t*>(chunk.data()),
+                _vehicle->id(), _vehicle->defaultComponentId());
+    _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
 }
 
 bool
@@ -213,7 +270,7 @@ MavlinkConsoleController::_processANSItext(QByteArray &line)
                                 setData(index(j), "");
                             blockSignals(blocked);
                             QVector<int> roles({Qt::DisplayRole, Qt::EditRole});
-                            emit dataChanged(index(_cursorY), index(rowCount()), roles);
+                            emit dataChanged(index(_cursor_home_pos), index(rowCount() - 1), roles);
                         }
                         // Even if we didn't understand this ANSI code, remove the 4th char
                         line.remove(i+3,1);
@@ -249,17 +306,47 @@ MavlinkConsoleController::transformLineForRichText(const QString& line) const
 QString
 MavlinkConsoleController::getText() const
 {
+    // Only lines which changed since the last call are transformed again
     QString ret;
-    if (rowCount() > 0) {
-        ret = transformLineForRichText(data(index(0), Qt::DisplayRole).toString());
-    }
-    for (int i = 1; i < rowCount(); ++i) {
-        ret += "<br>" + transformLineForRichText(data(index(i), Qt::DisplayRole).toString());
+    for (int i = 0; i < rowCount() && i < _richTextLines.count(); ++i) {
+        if (_richTextLines[i].isNull()) {
+            _richTextLines[i] = transformLineForRichText(data(index(i), Qt::DisplayRole).toString());
+        }
+        if (i > 0) {
+            ret += "<br>";
+        }
+        ret += _richTextLines[i];
     }
 
     return ret;
 }
 
+void
+MavlinkConsoleController::_rowsInserted(const QModelIndex&, int first, int last)
+{
+    _richTextLines.insert(first, last - first + 1, QString());
+}
+
+void
+MavlinkConsoleController::_rowsRemoved(const QModelIndex&, int first, int last)
+{
+    _richTextLines.remove(first, last - first + 1);
+}
+
+void
+MavlinkConsoleController::_rowsChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    for (int i = topLeft.row(); i <= bottomRight.row() && i < _richTextLines.count(); i++) {
+        _richTextLines[i] = QString();
+    }
+}
+
+void
+MavlinkConsoleController::_modelReset()
+{
+    _richTextLines = QVector<QString>(rowCount());
+}
+
 void
 MavlinkConsoleController::writeLine(int line, const QByteArray &text)
 {
@@ -17,6 +17,8 @@
 #include <QString>
 #include <QMetaObject>
 #include <QStringListModel>
+#include <QTimer>
+#include <QVector>
 
 // Fordward decls
 class Vehicle;
@@ -42,15 +44,26 @@ public:
      */
     Q_INVOKABLE QString handleClipboard(const QString& command_pre);
 
-    Q_PROPERTY(QString text                     READ getText                    CONSTANT)
+    /// Console output as rich text. Signalled at most once per batch of received data.
+    Q_PROPERTY(QString text                     READ getText                    NOTIFY textChanged)
+
+signals:
+    void textChanged();
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
     void _receiveData(uint8_t device, uint8_t flags, uint16_t timeout, uint32_t baudrate, QByteArray data);
+    void _processIncoming   ();
+    void _sendPending       ();
+    void _rowsInserted      (const QModelIndex& parent, int first, int last);
+    void _rowsRemoved       (const QModelIndex& parent, int first, int last);
+    void _rowsChanged       (const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void _modelReset        ();
 
 private:
     bool _processANSItext(QByteArray &line);
     void _sendSerialData(QByteArray, bool close = false);
+    void _sendSerialControl(const QByteArray& chunk, uint8_t flags);
     void writeLine(int line, const QByteArray &text);
 
     QString transformLineForRichText(const QString& line) const;
@@ -70,11 +83,18 @@ private:
     };
 
     static constexpr int _max_num_lines = 500; ///< history size (affects CPU load)
+    static constexpr int _sendBurstPackets = 4;     ///< SERIAL_CONTROL packets sent at once, the rest waits for _sendTimer
+    static constexpr int _sendIntervalMSecs = 20;
+    static constexpr int _receiveBatchMSecs = 10;   ///< Received data is collected for this long and processed in one pass
 
     int           _cursor_home_pos{-1};
     int           _cursorY{0};
     int           _cursorX{0};
     QByteArray    _incoming_buffer;
+    QByteArray    _outgoing_buffer;
+    QTimer        _sendTimer;
+    QTimer        _receiveTimer;
+    mutable QVector<QString> _richTextLines;    ///< Cache of transformLineForRichText per row, null if not built yet
     Vehicle*      _vehicle{nullptr};
     QList<QMetaObject::Connection> _uas_connections;
     CommandHistory _history;
@@ -48,8 +48,8 @@ AnalyzePage {
             Connections {
                 target: conController
 
-                onDataChanged: {
-                    if (isLoaded) {
+                onTextChanged: {
+                    if (isLoaded && !updateTimer.running) {
                         // rate-limit updates to reduce CPU load
                         updateTimer.start();
                     }
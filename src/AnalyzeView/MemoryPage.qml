@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+import QtQuick                      2.11
+import QtQuick.Controls             2.4
+import QtQuick.Layouts              1.11
+
+import QGroundControl               1.0
+import QGroundControl.Palette       1.0
+import QGroundControl.Controls      1.0
+import QGroundControl.ScreenTools   1.0
+
+AnalyzePage {
+    id:                 memoryPage
+    pageComponent:      pageComponent
+    pageDescription:    qsTr("Memory held by each part of %1, to find out what grows during long operations.").arg(QGroundControl.appName)
+    allowPopout:        true
+
+    property var    _memoryAccounting:  QGroundControl.memoryAccounting
+    property real   _graphHeight:       ScreenTools.defaultFontPixelHeight * 10
+    property real   _graphWidth:        ScreenTools.defaultFontPixelWidth * 80
+
+    function _mb(bytes) {
+        return bytes < 0 ? qsTr("n/a") : (bytes / (1024 * 1024)).toFixed(1)
+    }
+
+    QGCPalette { id: qgcPal; colorGroupEnabled: true }
+
+    Component {
+        id: pageComponent
+
+        ColumnLayout {
+            width:      availableWidth
+            spacing:    ScreenTools.defaultFontPixelHeight
+
+            Component.onCompleted: _memoryAccounting.sampleNow()
+
+            GridLayout {
+                columns:        4
+                columnSpacing:  ScreenTools.defaultFontPixelWidth * 2
+
+                QGCLabel { text: qsTr("Subsystem") }
+                QGCLabel { text: qsTr("MB") }
+                QGCLabel { text: qsTr("Peak MB") }
+                QGCLabel { text: qsTr("Budget MB") }
+
+                Repeater {
+                    model: _memoryAccounting.subsystems
+
+                    Repeater {
+                        property var _subsystem: modelData
+                        model: [ _subsystem.name, _mb(_subsystem.bytes), _mb(_subsystem.peakBytes), _subsystem.budgetBytes > 0 ? _mb(_subsystem.budgetBytes) : "-" ]
+
+                        QGCLabel {
+                            text:   modelData
+                            color:  _subsystem.budgetBytes > 0 && _subsystem.bytes > _subsystem.budgetBytes ? qgcPal.warningText : qgcPal.text
+                        }
+                    }
+                }
+
+                QGCLabel { text: qsTr("Process") }
+                QGCLabel { text: _mb(_memoryAccounting.residentBytes) }
+                QGCLabel { text: "" }
+                QGCLabel { text: _mb(_memoryAccounting.physicalBytes) }
+            }
+
+            QGCLabel { text: qsTr("Process resident size over the last %1 samples").arg(_memoryAccounting.timeline.length) }
+
+            Canvas {
+                id:                     timelineCanvas
+                Layout.preferredWidth:  _graphWidth
+                Layout.preferredHeight: _graphHeight
+
+                property var _timeline: _memoryAccounting.timeline
+
+                on_TimelineChanged: requestPaint()
+
+                onPaint: {
+                    var ctx = getContext("2d")
+                    ctx.reset()
+                    ctx.strokeStyle = qgcPal.text
+                    ctx.strokeRect(0, 0, width, height)
+                    if (_timeline.length < 2) {
+                        return
+                    }
+                    var maxBytes = 1
+                    for (var i = 0; i < _timeline.length; i++) {
+                        maxBytes = Math.max(maxBytes, _timeline[i].residentBytes)
+                    }
+                    ctx.strokeStyle = qgcPal.colorGreen
+                    ctx.beginPath()
+                    for (var j = 0; j < _timeline.length; j++) {
+                        var x = width * j / (_timeline.length - 1)
+                        var y = height * (1 - Math.max(0, _timeline[j].residentBytes) / maxBytes)
+                        if (j === 0) {
+                            ctx.moveTo(x, y)
+                        } else {
+                            ctx.lineTo(x, y)
+                        }
+                    }
+                    ctx.stroke()
+                }
+            }
+
+            RowLayout {
+                spacing: ScreenTools.defaultFontPixelWidth
+
+                QGCButton {
+                    text:       qsTr("Sample Now")
+                    onClicked:  _memoryAccounting.sampleNow()
+                }
+
+                QGCButton {
+                    text:       qsTr("Export")
+                    onClicked: {
+                        var filename = QGroundControl.settingsManager.appSettings.telemetrySavePath + "/memory-" + new Date().toISOString().replace(/[:.]/g, "-") + ".csv"
+                        exportLabel.text = _memoryAccounting.exportTimeline(filename) ? qsTr("Saved to %1").arg(filename) : qsTr("Unable to save %1").arg(filename)
+                    }
+                }
+
+                QGCLabel { id: exportLabel }
+            }
+        }
+    }
+}
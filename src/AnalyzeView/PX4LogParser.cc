@@ -3,6 +3,9 @@
 #include <QtEndian>
 #include <QDateTime>
 
+#include <algorithm>
+#include <cstring>
+
 PX4LogParser::PX4LogParser()
 {
 
@@ -13,55 +16,69 @@ PX4LogParser::~PX4LogParser()
 
 }
 
-bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
+qint64 PX4LogParser::_indexOf(const char* log, qint64 logSize, const char* pattern, int patternSize, qint64 from)
+{
+    if (from < 0 || from >= logSize) {
+        return -1;
+    }
+    const char* end = log + logSize;
+    const char* found = std::search(log + from, end, pattern, pattern + patternSize);
+    return found == end ? -1 : found - log;
+}
+
+bool PX4LogParser::getTagsFromLog(const char* log, qint64 logSize, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback)
 {
 
      // general message header
-    char header[] = {(char)0xA3, (char)0x95, (char)0x00};
+    const char header[] = {(char)0xA3, (char)0x95};
     // header for GPOS message header
-    char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10, (char)0x00};
-    int gposHeaderOffset;
+    const char gposHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x10};
+    qint64 gposHeaderOffset;
     // header for GPOS message
-    char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10, (char)0x00};
+    const char gposHeader[] = {(char)0xA3, (char)0x95, (char)0x10};
     int gposOffsets[3] = {3, 7, 11};
     int gposLengths[3] = {4, 4, 4};
     // header for trigger message header
-    char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37, (char)0x00};
-    int triggerHeaderOffset;
+    const char triggerHeaderHeader[] = {(char)0xA3, (char)0x95, (char)0x80, (char)0x37};
+    qint64 triggerHeaderOffset;
     // header for trigger message
-    char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37, (char)0x00};
+    const char triggerHeader[] = {(char)0xA3, (char)0x95, (char)0x37};
     int triggerOffsets[2] = {3, 11};
     int triggerLengths[2] = {8, 4};
 
     // extract header information: message lengths
-    uint8_t* iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(gposHeaderHeader) + 4, 1).data());
-    gposHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
-    iptr = reinterpret_cast<uint8_t*>(log.mid(log.indexOf(triggerHeaderHeader) + 4, 1).data());
-    triggerHeaderOffset = static_cast<int>(qFromLittleEndian(*iptr));
+    qint64 formatIndex = _indexOf(log, logSize, gposHeaderHeader, sizeof(gposHeaderHeader), 0);
+    if (formatIndex < 0 || formatIndex + 4 >= logSize) {
+        return true;
+    }
+    gposHeaderOffset = static_cast<uint8_t>(log[formatIndex + 4]);
+    formatIndex = _indexOf(log, logSize, triggerHeaderHeader, sizeof(triggerHeaderHeader), 0);
+    if (formatIndex < 0 || formatIndex + 4 >= logSize) {
+        return true;
+    }
+    triggerHeaderOffset = static_cast<uint8_t>(log[formatIndex + 4]);
 
     // extract trigger data
-    int index = 1;
+    qint64 index = 1;
     int sequence = -1;
-    while(index < log.count() - 1) {
+    while(index < logSize - 1) {
 
         // first extract trigger
-        index = log.indexOf(triggerHeader, index + 1);
+        index = _indexOf(log, logSize, triggerHeader, sizeof(triggerHeader), index + 1);
         // check for whether last entry has been passed
-        if (index < 0) {
+        if (index < 0 || index + triggerOffsets[1] + triggerLengths[1] > logSize) {
             break;
         }
 
-        if (log.indexOf(header, index + 1) != index + triggerHeaderOffset) {
+        if (_indexOf(log, logSize, header, sizeof(header), index + 1) != index + triggerHeaderOffset) {
             continue;
         }
 
         GeoTagWorker::cameraFeedbackPacket feedback;
         memset(&feedback, 0, sizeof(feedback));
 
-        uint64_t* time = reinterpret_cast<uint64_t*>(log.mid(index + triggerOffsets[0], triggerLengths[0]).data());
-        double timeDouble = static_cast<double>(qFromLittleEndian(*time)) / 1.0e6;
-        uint32_t* seq = reinterpret_cast<uint32_t*>(log.mid(index + triggerOffsets[1], triggerLengths[1]).data());
-        int seqInt = static_cast<int>(qFromLittleEndian(*seq));
+        double timeDouble = static_cast<double>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(log + index + triggerOffsets[0]))) / 1.0e6;
+        int seqInt = static_cast<int>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(log + index + triggerOffsets[1])));
         if (sequence >= seqInt || sequence + 20 < seqInt) { // assume that logging has not skipped more than 20 triggers. this prevents wrong header detection
             continue;
         }
@@ -73,22 +90,22 @@ bool PX4LogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFee
         bool lookForGpos = true;
         while (lookForGpos) {
 
-            int gposIndex = log.indexOf(gposHeader, index + 1);
-            if (gposIndex < 0) {
+            qint64 gposIndex = _indexOf(log, logSize, gposHeader, sizeof(gposHeader), index + 1);
+            if (gposIndex < 0 || gposIndex + gposOffsets[2] + gposLengths[2] > logSize) {
                 cameraFeedback.append(feedback);
                 break;
             }
             index = gposIndex;
 
             // verify that at an offset of gposHeaderOffset the next log message starts
-            if (gposIndex + gposHeaderOffset == log.indexOf(header, gposIndex + 1)) {
-                int32_t* lat = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[0], gposLengths[0]).data());
-                feedback.latitude = static_cast<double>(qFromLittleEndian(*lat))/1.0e7;
-                int32_t* lon = reinterpret_cast<int32_t*>(log.mid(gposIndex + gposOffsets[1], gposLengths[1]).data());
-                feedback.longitude = static_cast<double>(qFromLittleEndian(*lon))/1.0e7;
+            if (gposIndex + gposHeaderOffset == _indexOf(log, logSize, header, sizeof(header), gposIndex + 1)) {
+                int32_t lat = qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(log + gposIndex + gposOffsets[0]));
+                feedback.latitude = static_cast<double>(lat)/1.0e7;
+                int32_t lon = qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(log + gposIndex + gposOffsets[1]));
+                feedback.longitude = static_cast<double>(lon)/1.0e7;
                 feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                float* alt = reinterpret_cast<float*>(log.mid(gposIndex + gposOffsets[2], gposLengths[2]).data());
-                feedback.altitude = qFromLittleEndian(*alt);
+                quint32 altBits = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(log + gposIndex + gposOffsets[2]));
+                memcpy(&feedback.altitude, &altBits, sizeof(feedback.altitude));
                 cameraFeedback.append(feedback);
                 break;
             }
@@ -11,9 +11,12 @@ class PX4LogParser
 public:
     PX4LogParser();
     ~PX4LogParser();
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
+    /// Extracts the camera trigger messages, with the position which follows each of them, in a single forward pass
+    /// over the log. The log data is only read, so it can be a memory mapped file.
+    bool getTagsFromLog(const char* log, qint64 logSize, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback);
 
 private:
+    static qint64 _indexOf(const char* log, qint64 logSize, const char* pattern, int patternSize, qint64 from);
 
 };
 
@@ -1,10 +1,18 @@
 #include "ULogParser.h"
 #include <math.h>
 #include <QDateTime>
+#include <QtEndian>
+
+#include <cstring>
+
+static const char* kCameraCaptureMsgName = "camera_capture";
 
 ULogParser::ULogParser()
+    : _cameraCaptureMsgID(-1)
 {
-
+    for (int i = 0; i < FieldCount; i++) {
+        _cameraCaptureOffsets[i] = -1;
+    }
 }
 
 ULogParser::~ULogParser()
@@ -63,6 +71,20 @@ QString ULogParser::extractArraySize(QString &typeNameFull, int &arraySize)
 
 bool ULogParser::parseFieldFormat(QString& fields)
 {
+    static const struct {
+        const char*         name;
+        CameraCaptureField  field;
+    } rgFieldNames[] = {
+        { "timestamp",          FieldTimestamp },
+        { "timestamp_utc",      FieldTimestampUTC },
+        { "seq",                FieldSequence },
+        { "lat",                FieldLatitude },
+        { "lon",                FieldLongitude },
+        { "alt",                FieldAltitude },
+        { "ground_distance",    FieldGroundDistance },
+        { "result",             FieldResult },
+    };
+
     int prevFieldEnd = 0;
     int fieldEnd = fields.indexOf(';');
     int offset = 0;
@@ -75,7 +97,12 @@ bool ULogParser::parseFieldFormat(QString& fields)
             QString fieldName = fields.mid(spacePos + 1, fieldEnd - spacePos - 1);
 
             if (!fieldName.contains(QLatin1String("_padding"))) {
-                _cameraCaptureOffsets.insert(fieldName, offset);
+                for (size_t i = 0; i < sizeof(rgFieldNames) / sizeof(rgFieldNames[0]); i++) {
+                    if (fieldName == QLatin1String(rgFieldNames[i].name)) {
+                        _cameraCaptureOffsets[rgFieldNames[i].field] = offset;
+                        break;
+                    }
+                }
                 offset += sizeOfFullType(typeNameFull);
             }
         }
@@ -86,38 +113,50 @@ bool ULogParser::parseFieldFormat(QString& fields)
     return false;
 }
 
-bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
+bool ULogParser::_readField(const char* msgData, int msgDataSize, CameraCaptureField field, void* value, int valueSize) const
+{
+    int offset = _cameraCaptureOffsets[field];
+    if (offset < 0 || offset + valueSize > msgDataSize) {
+        return false;
+    }
+    memcpy(value, msgData + offset, static_cast<size_t>(valueSize));
+    return true;
+}
+
+bool ULogParser::getTagsFromLog(const char* log, qint64 logSize, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage)
 {
     errorMessage.clear();
 
     //verify it's an ULog file
-    if(!log.contains(_ULogMagic)) {
+    if(logSize < ULOG_FILE_HEADER_LEN || memcmp(log, _ULogMagic, sizeof(_ULogMagic) - 1) != 0) {
         errorMessage = tr("Could not detect ULog file header magic");
         return false;
     }
 
-    int index = ULOG_FILE_HEADER_LEN;
-    bool geotagFound = false;
+    const size_t    cameraCaptureMsgNameLen = strlen(kCameraCaptureMsgName);
+    qint64          index                   = ULOG_FILE_HEADER_LEN;
+    bool            geotagFound             = false;
 
-    while(index < log.count() - 1) {
+    while(index + ULOG_MSG_HEADER_LEN <= logSize) {
+        const char* msg         = log + index;
+        int         msgSize     = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(msg));
+        uint8_t     msgType     = static_cast<uint8_t>(msg[2]);
+        const char* msgData     = msg + ULOG_MSG_HEADER_LEN;
 
-        ULogMessageHeader header;
-        memset(&header, 0, sizeof(header));
-        memcpy(&header, log.data() + index, ULOG_MSG_HEADER_LEN);
+        if (index + ULOG_MSG_HEADER_LEN + msgSize > logSize) {
+            // Truncated final message
+            break;
+        }
 
-        switch (header.msgType) {
+        switch (msgType) {
             case (int)ULogMessageType::FORMAT:
             {
-                ULogMessageFormat format_msg;
-                memset(&format_msg, 0, sizeof(format_msg));
-                memcpy(&format_msg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString fmt(format_msg.format);
-                int posSeparator = fmt.indexOf(':');
-                QString messageName = fmt.left(posSeparator);
-                QString messageFields = fmt.mid(posSeparator + 1, header.msgSize - posSeparator - 1);
-
-                if(messageName == QLatin1String("camera_capture")) {
+                // Only the camera_capture format is converted and parsed, all others are skipped by name
+                const char* separator = static_cast<const char*>(memchr(msgData, ':', static_cast<size_t>(msgSize)));
+                if(separator &&
+                        static_cast<size_t>(separator - msgData) == cameraCaptureMsgNameLen &&
+                        memcmp(msgData, kCameraCaptureMsgName, cameraCaptureMsgNameLen) == 0) {
+                    QString messageFields = QString::fromLatin1(separator + 1, msgSize - static_cast<int>(separator - msgData) - 1);
                     parseFieldFormat(messageFields);
                 }
                 break;
@@ -125,44 +164,47 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
 
             case (int)ULogMessageType::ADD_LOGGED_MSG:
             {
-                ULogMessageAddLogged addLoggedMsg;
-                memset(&addLoggedMsg, 0, sizeof(addLoggedMsg));
-                memcpy(&addLoggedMsg, log.data() + index, ULOG_MSG_HEADER_LEN + header.msgSize);
-
-                QString messageName(addLoggedMsg.msgName);
-
-                if(messageName.contains(QLatin1String("camera_capture"))) {
-                    _cameraCaptureMsgID = addLoggedMsg.msgID;
-                    geotagFound = true;
+                if (msgSize > ULOG_ADD_LOGGED_HEADER_LEN) {
+                    const char* msgName     = msgData + ULOG_ADD_LOGGED_HEADER_LEN;
+                    int         msgNameLen  = msgSize - ULOG_ADD_LOGGED_HEADER_LEN;
+
+                    if(QByteArray::fromRawData(msgName, msgNameLen).contains(kCameraCaptureMsgName)) {
+                        _cameraCaptureMsgID = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(msgData + 1));
+                        geotagFound = true;
+                    }
                 }
-
                 break;
             }
 
             case (int)ULogMessageType::DATA:
             {
-                uint16_t msgID = -1;
-                memcpy(&msgID, log.data() + index + ULOG_MSG_HEADER_LEN, 2);
+                if (!geotagFound || msgSize < ULOG_MSG_ID_LEN) {
+                    break;
+                }
+                int msgID = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(msgData));
 
-                if (geotagFound && msgID == _cameraCaptureMsgID) {
+                if (msgID == _cameraCaptureMsgID) {
+                    const char* fieldData       = msgData + ULOG_MSG_ID_LEN;
+                    int         fieldDataSize   = msgSize - ULOG_MSG_ID_LEN;
 
                     // Completely dynamic parsing, so that changing/reordering the message format will not break the parser
                     GeoTagWorker::cameraFeedbackPacket feedback;
                     memset(&feedback, 0, sizeof(feedback));
-                    memcpy(&feedback.timestamp, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp")), 8);
-                    feedback.timestamp /= 1.0e6; // to seconds
-                    memcpy(&feedback.timestampUTC, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("timestamp_utc")), 8);
-                    feedback.timestampUTC /= 1.0e6; // to seconds
-                    memcpy(&feedback.imageSequence, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("seq")), 4);
-                    memcpy(&feedback.latitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lat")), 8);
-                    memcpy(&feedback.longitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("lon")), 8);
+                    uint64_t timestamp = 0;
+                    _readField(fieldData, fieldDataSize, FieldTimestamp, &timestamp, sizeof(timestamp));
+                    feedback.timestamp = timestamp / 1.0e6; // to seconds
+                    uint64_t timestampUTC = 0;
+                    _readField(fieldData, fieldDataSize, FieldTimestampUTC, &timestampUTC, sizeof(timestampUTC));
+                    feedback.timestampUTC = timestampUTC / 1.0e6; // to seconds
+                    _readField(fieldData, fieldDataSize, FieldSequence, &feedback.imageSequence, sizeof(feedback.imageSequence));
+                    _readField(fieldData, fieldDataSize, FieldLatitude, &feedback.latitude, sizeof(feedback.latitude));
+                    _readField(fieldData, fieldDataSize, FieldLongitude, &feedback.longitude, sizeof(feedback.longitude));
                     feedback.longitude = fmod(180.0 + feedback.longitude, 360.0) - 180.0;
-                    memcpy(&feedback.altitude, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("alt")), 4);
-                    memcpy(&feedback.groundDistance, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("ground_distance")), 4);
-                    memcpy(&feedback.captureResult, log.data() + index + 5 + _cameraCaptureOffsets.value(QStringLiteral("result")), 1);
+                    _readField(fieldData, fieldDataSize, FieldAltitude, &feedback.altitude, sizeof(feedback.altitude));
+                    _readField(fieldData, fieldDataSize, FieldGroundDistance, &feedback.groundDistance, sizeof(feedback.groundDistance));
+                    _readField(fieldData, fieldDataSize, FieldResult, &feedback.captureResult, sizeof(feedback.captureResult));
 
                     cameraFeedback.append(feedback);
-
                 }
 
                 break;
@@ -172,8 +214,7 @@ bool ULogParser::getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedb
                 break;
         }
 
-        index += (3 + header.msgSize);
-
+        index += ULOG_MSG_HEADER_LEN + msgSize;
     }
 
     if (cameraFeedback.count() == 0) {
@@ -17,12 +17,27 @@ public:
     ULogParser();
     ~ULogParser();
 
-    /// @return true: failed, errorMessage set
-    bool getTagsFromLog(QByteArray& log, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
+    /// Extracts the camera_capture messages in a single forward pass over the log. The log data is only read, so it
+    /// can be a memory mapped file.
+    /// @return false: failed, errorMessage set
+    bool getTagsFromLog(const char* log, qint64 logSize, QList<GeoTagWorker::cameraFeedbackPacket>& cameraFeedback, QString& errorMessage);
 
 private:
+    /// camera_capture fields used for geotagging. Field names are resolved to these ids once, from the FORMAT
+    /// message, so decoding a DATA message is only offset lookups.
+    enum CameraCaptureField {
+        FieldTimestamp,
+        FieldTimestampUTC,
+        FieldSequence,
+        FieldLatitude,
+        FieldLongitude,
+        FieldAltitude,
+        FieldGroundDistance,
+        FieldResult,
+        FieldCount
+    };
 
-    QMap<QString, int> _cameraCaptureOffsets; // <fieldName, fieldOffset>
+    int _cameraCaptureOffsets[FieldCount];  ///< Offset of each field within the message data, -1 if not logged
     int _cameraCaptureMsgID;
 
     const char _ULogMagic[8] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
@@ -32,6 +47,7 @@ private:
     QString extractArraySize(QString& typeNameFull, int& arraySize);
 
     bool parseFieldFormat(QString& fields);
+    bool _readField(const char* msgData, int msgDataSize, CameraCaptureField field, void* value, int valueSize) const;
 
     enum class ULogMessageType : uint8_t {
         FORMAT = 'F',
@@ -46,27 +62,8 @@ private:
     };
 
     #define ULOG_MSG_HEADER_LEN 3
-    struct ULogMessageHeader {
-        uint16_t msgSize;
-        uint8_t msgType;
-    };
-
-    struct ULogMessageFormat {
-        uint16_t msgSize;
-        uint8_t msgType;
-
-        char format[2096];
-    };
-
-    struct ULogMessageAddLogged {
-	  uint16_t msgSize;
-      uint8_t msgType;
-
-	  uint8_t multiID;
-	  uint16_t msgID;
-	  char msgName[255];
-	};
-
+    #define ULOG_MSG_ID_LEN 2
+    #define ULOG_ADD_LOGGED_HEADER_LEN 3    // multi_id and msg_id ahead of message name
 };
 
 #endif // ULOGPARSER_H
@@ -0,0 +1,608 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReader.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(ULogReaderLog, "ULogReaderLog")
+
+const char* ULogReader::_magic = "QGCUIDX1";
+
+static const int    kFileHeaderLen      = 16;
+static const int    kMsgHeaderLen       = 3;    // uint16 msg_size, uint8 msg_type
+static const int    kMsgIdLen           = 2;
+static const int    kAddLoggedHeaderLen = 3;    // uint8 multi_id, uint16 msg_id
+static const char   kULogMagic[]        = { 'U', 'L', 'o', 'g', 0x01, 0x12, 0x35 };
+static const uchar  kMsgTypeFormat      = 'F';
+static const uchar  kMsgTypeAddLogged   = 'A';
+static const uchar  kMsgTypeData        = 'D';
+
+QString ULogReader::indexFilename(const QString& logFilename)
+{
+    return logFilename + QStringLiteral(".qgcuidx");
+}
+
+void ULogReader::close(void)
+{
+    if (_log) {
+        _logFile.unmap(const_cast<uchar*>(_log));
+        _log = nullptr;
+    }
+    if (_logFile.isOpen()) {
+        _logFile.close();
+    }
+    _logSize        = 0;
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+    _formatText.clear();
+    _formats.clear();
+    _subscriptions.clear();
+}
+
+bool ULogReader::open(const QString& logFilename, QString& errorMessage)
+{
+    close();
+    errorMessage.clear();
+
+    _logFile.setFileName(logFilename);
+    if (!_logFile.open(QFile::ReadOnly)) {
+        errorMessage = tr("Unable to open log file: %1").arg(_logFile.errorString());
+        return false;
+    }
+    _logSize = static_cast<quint64>(_logFile.size());
+    if (_logSize < kFileHeaderLen) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _log = _logFile.map(0, _logFile.size());
+    if (!_log) {
+        errorMessage = tr("Unable to map log file: %1").arg(_logFile.errorString());
+        close();
+        return false;
+    }
+    if (memcmp(_log, kULogMagic, sizeof(kULogMagic)) != 0) {
+        errorMessage = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+
+    qint64  logModifiedMSecs    = QFileInfo(logFilename).lastModified().toMSecsSinceEpoch();
+    QString indexFilename       = ULogReader::indexFilename(logFilename);
+
+    if (_loadIndexFile(indexFilename, logModifiedMSecs)) {
+        qCDebug(ULogReaderLog) << "Loaded index" << indexFilename << _subscriptions.count();
+    } else {
+        if (!_buildIndex(errorMessage)) {
+            close();
+            return false;
+        }
+        if (_saveIndexFile(indexFilename, logModifiedMSecs)) {
+            qCDebug(ULogReaderLog) << "Built index" << indexFilename << _subscriptions.count();
+        } else {
+            qCWarning(ULogReaderLog) << "Unable to save index, keeping it in memory" << indexFilename;
+        }
+    }
+
+    // Formats are resolved from the logged definitions instead of being saved in the index
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (!_formats.contains(subscription.topic)) {
+            Format_t format;
+            if (_resolveFormat(subscription.topic, format)) {
+                _formats[subscription.topic] = format;
+            } else {
+                qCWarning(ULogReaderLog) << "Unable to resolve format" << subscription.topic;
+            }
+        }
+    }
+    _updateTimeRange();
+
+    return true;
+}
+
+bool ULogReader::_buildIndex(QString& errorMessage)
+{
+    // Direct lookup by msg_id during the scan, a data message is looked up for every message in the log
+    std::vector<std::vector<quint64>*> offsetsById(std::numeric_limits<quint16>::max() + 1, nullptr);
+
+    quint64 index = kFileHeaderLen;
+    while (index + kMsgHeaderLen <= _logSize) {
+        const uchar*    msg         = _log + index;
+        int             msgSize     = qFromLittleEndian<quint16>(msg);
+        uchar           msgType     = msg[2];
+        const uchar*    msgData     = msg + kMsgHeaderLen;
+
+        if (index + kMsgHeaderLen + static_cast<quint64>(msgSize) > _logSize) {
+            qCDebug(ULogReaderLog) << "Truncated message at end of log" << index;
+            break;
+        }
+
+        if (msgType == kMsgTypeData) {
+            if (msgSize >= kMsgIdLen) {
+                std::vector<quint64>* offsets = offsetsById[qFromLittleEndian<quint16>(msgData)];
+                if (offsets) {
+                    offsets->push_back(index);
+                }
+            }
+        } else if (msgType == kMsgTypeFormat) {
+            const char* text        = reinterpret_cast<const char*>(msgData);
+            const char* separator   = static_cast<const char*>(memchr(text, ':', static_cast<size_t>(msgSize)));
+            if (separator) {
+                int nameLen = static_cast<int>(separator - text);
+                _formatText[QString::fromLatin1(text, nameLen)] = QString::fromLatin1(separator + 1, msgSize - nameLen - 1);
+            }
+        } else if (msgType == kMsgTypeAddLogged) {
+            if (msgSize > kAddLoggedHeaderLen) {
+                int     multiId = msgData[0];
+                quint16 msgId   = qFromLittleEndian<quint16>(msgData + 1);
+                QString topic   = QString::fromLatin1(reinterpret_cast<const char*>(msgData + kAddLoggedHeaderLen), msgSize - kAddLoggedHeaderLen);
+                if (_addSubscription(msgId, multiId, topic)) {
+                    offsetsById[msgId] = &_subscriptions[msgId].offsets;
+                }
+            }
+        }
+
+        index += kMsgHeaderLen + static_cast<quint64>(msgSize);
+    }
+
+    if (_subscriptions.isEmpty()) {
+        errorMessage = tr("No logged topics found in ULog");
+        return false;
+    }
+
+    return true;
+}
+
+bool ULogReader::_addSubscription(quint16 msgId, int multiId, const QString& topic)
+{
+    if (!_formatText.contains(topic)) {
+        qCWarning(ULogReaderLog) << "Topic logged without format" << topic;
+        return false;
+    }
+
+    // A msg_id re-used after REMOVE_LOGGED_MSG replaces the earlier subscription
+    Subscription_t& subscription = _subscriptions[msgId];
+    subscription.topic      = topic;
+    subscription.multiId    = multiId;
+    subscription.offsets.clear();
+
+    return true;
+}
+
+bool ULogReader::_loadIndexFile(const QString& indexFilename, qint64 logModifiedMSecs)
+{
+    QFile   file(indexFilename);
+    Header_t header;
+
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, _magic, sizeof(header.magic)) != 0 ||
+            header.version != _version ||
+            header.byteOrderMark != _byteOrderMark ||
+            header.logFileSize != _logSize ||
+            header.logModifiedMSecs != logModifiedMSecs) {
+        qCDebug(ULogReaderLog) << "Index missing or out of date" << indexFilename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 subscriptionCount = 0;
+    stream >> _formatText >> subscriptionCount;
+    for (quint32 i = 0; i < subscriptionCount && stream.status() == QDataStream::Ok; i++) {
+        quint16 msgId;
+        qint32  multiId;
+        QString topic;
+        quint64 offsetCount;
+
+        stream >> msgId >> multiId >> topic >> offsetCount;
+        if (stream.status() != QDataStream::Ok || offsetCount > _logSize / kMsgHeaderLen) {
+            break;
+        }
+
+        Subscription_t& subscription = _subscriptions[msgId];
+        subscription.topic      = topic;
+        subscription.multiId    = multiId;
+        subscription.offsets.resize(static_cast<size_t>(offsetCount));
+
+        int offsetBytes = static_cast<int>(offsetCount * sizeof(quint64));
+        if (offsetCount && stream.readRawData(reinterpret_cast<char*>(subscription.offsets.data()), offsetBytes) != offsetBytes) {
+            stream.setStatus(QDataStream::ReadPastEnd);
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || static_cast<quint32>(_subscriptions.count()) != subscriptionCount) {
+        qCWarning(ULogReaderLog) << "Invalid index" << indexFilename;
+        _formatText.clear();
+        _subscriptions.clear();
+        return false;
+    }
+
+    return true;
+}
+
+/// Writes to a temporary file which is moved into place once complete, so an interrupted write never leaves a
+/// partial index behind.
+bool ULogReader::_saveIndexFile(const QString& indexFilename, qint64 logModifiedMSecs) const
+{
+    QString tempFilename = indexFilename + QStringLiteral(".tmp");
+    QFile   file(tempFilename);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCDebug(ULogReaderLog) << "Unable to create index" << tempFilename << file.errorString();
+        return false;
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version          = _version;
+    header.byteOrderMark    = _byteOrderMark;
+    header.logFileSize      = _logSize;
+    header.logModifiedMSecs = logModifiedMSecs;
+
+    bool success = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << _formatText << static_cast<quint32>(_subscriptions.count());
+    for (auto iter = _subscriptions.cbegin(); iter != _subscriptions.cend(); iter++) {
+        const Subscription_t& subscription = iter.value();
+        int offsetBytes = static_cast<int>(subscription.offsets.size() * sizeof(quint64));
+
+        stream << iter.key() << static_cast<qint32>(subscription.multiId) << subscription.topic << static_cast<quint64>(subscription.offsets.size());
+        success = success && stream.writeRawData(reinterpret_cast<const char*>(subscription.offsets.data()), offsetBytes) == offsetBytes;
+    }
+    success = success && stream.status() == QDataStream::Ok;
+    file.close();
+
+    if (success) {
+        QFile::remove(indexFilename);
+        success = QFile::rename(tempFilename, indexFilename);
+    }
+    if (!success) {
+        QFile::remove(tempFilename);
+    }
+
+    return success;
+}
+
+bool ULogReader::_resolveFormat(const QString& name, Format_t& format, int depth) const
+{
+    format.fields.clear();
+    format.size             = 0;
+    format.timestampOffset  = -1;
+
+    if (depth > _maxFormatDepth || !_formatText.contains(name)) {
+        return false;
+    }
+
+    const QStringList definitions = _formatText[name].split(';', Qt::SkipEmptyParts);
+    for (const QString& definition: definitions) {
+        int spacePos = definition.indexOf(' ');
+        if (spacePos == -1) {
+            return false;
+        }
+        QString typeName    = definition.left(spacePos);
+        QString fieldName   = definition.mid(spacePos + 1);
+
+        int arraySize   = 1;
+        int startPos    = typeName.indexOf('[');
+        if (startPos != -1) {
+            int endPos = typeName.indexOf(']', startPos);
+            if (endPos == -1) {
+                return false;
+            }
+            arraySize = typeName.midRef(startPos + 1, endPos - startPos - 1).toInt();
+            typeName = typeName.left(startPos);
+        }
+
+        FieldType   type;
+        Format_t    nestedFormat;
+        int         elementSize;
+        bool        basicType = _typeFromName(typeName, type);
+        if (basicType) {
+            elementSize = _typeSize(type);
+        } else if (_resolveFormat(typeName, nestedFormat, depth + 1)) {
+            elementSize = nestedFormat.size;
+        } else {
+            qCWarning(ULogReaderLog) << "Unknown type" << typeName << "in format" << name;
+            return false;
+        }
+
+        if (!fieldName.startsWith(QLatin1String("_padding"))) {
+            for (int i = 0; i < arraySize; i++) {
+                QString elementName = arraySize > 1 ? QStringLiteral("%1[%2]").arg(fieldName).arg(i) : fieldName;
+                int     elementOffset = format.size + (i * elementSize);
+                if (basicType) {
+                    format.fields.append({ elementName, type, elementOffset });
+                    if (fieldName == QLatin1String("timestamp") && type == FieldTypeUInt64) {
+                        format.timestampOffset = elementOffset;
+                    }
+                } else {
+                    for (const Field_t& nestedField: nestedFormat.fields) {
+                        format.fields.append({ elementName + QStringLiteral(".") + nestedField.name, nestedField.type, elementOffset + nestedField.offset });
+                    }
+                }
+            }
+        }
+        format.size += elementSize * arraySize;
+    }
+
+    return true;
+}
+
+void ULogReader::_updateTimeRange(void)
+{
+    _startTimeUSecs = std::numeric_limits<quint64>::max();
+    _endTimeUSecs   = 0;
+
+    for (const Subscription_t& subscription: _subscriptions) {
+        auto formatIter = _formats.constFind(subscription.topic);
+        if (formatIter == _formats.cend() || formatIter->timestampOffset < 0 || subscription.offsets.empty()) {
+            continue;
+        }
+        _startTimeUSecs = qMin(_startTimeUSecs, _timestamp(subscription, *formatIter, 0));
+        _endTimeUSecs   = qMax(_endTimeUSecs, _timestamp(subscription, *formatIter, subscription.offsets.size() - 1));
+    }
+
+    if (_startTimeUSecs > _endTimeUSecs) {
+        _startTimeUSecs = _endTimeUSecs = 0;
+    }
+}
+
+quint64 ULogReader::_timestamp(const Subscription_t& subscription, const Format_t& format, size_t index) const
+{
+    quint64         offset  = subscription.offsets[index];
+    const uchar*    msg     = _log + offset;
+    int             msgSize = qFromLittleEndian<quint16>(msg);
+
+    if (format.timestampOffset < 0 || kMsgIdLen + format.timestampOffset + _typeSize(FieldTypeUInt64) > msgSize) {
+        return 0;
+    }
+    return qFromLittleEndian<quint64>(msg + kMsgHeaderLen + kMsgIdLen + format.timestampOffset);
+}
+
+QStringList ULogReader::topics(void) const
+{
+    QStringList topicList;
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (!subscription.offsets.empty() && !topicList.contains(subscription.topic)) {
+            topicList.append(subscription.topic);
+        }
+    }
+    topicList.sort();
+    return topicList;
+}
+
+int ULogReader::topicInstanceCount(const QString& topic) const
+{
+    int count = 0;
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (subscription.topic == topic) {
+            count = qMax(count, subscription.multiId + 1);
+        }
+    }
+    return count;
+}
+
+int ULogReader::messageCount(const QString& topic, int multiId) const
+{
+    const Subscription_t* subscription = _findSubscription(topic, multiId);
+    return subscription ? static_cast<int>(subscription->offsets.size()) : 0;
+}
+
+QList<ULogReader::Field_t> ULogReader::fields(const QString& topic) const
+{
+    return _formats.value(topic).fields;
+}
+
+const ULogReader::Subscription_t* ULogReader::_findSubscription(const QString& topic, int multiId) const
+{
+    // The same topic instance can be subscribed more than once, use the one with data
+    const Subscription_t* found = nullptr;
+    for (const Subscription_t& subscription: _subscriptions) {
+        if (subscription.topic == topic && subscription.multiId == multiId) {
+            if (!found || found->offsets.empty()) {
+                found = &subscription;
+            }
+        }
+    }
+    return found;
+}
+
+bool ULogReader::readTopic(const QString& topic, const QStringList& fieldNames, TopicData_t& data, int multiId, quint64 startUSecs, quint64 endUSecs) const
+{
+    data.timestampsUSecs.clear();
+    data.columns.clear();
+
+    const Subscription_t*   subscription    = _findSubscription(topic, multiId);
+    auto                    formatIter      = _formats.constFind(topic);
+    if (!subscription || formatIter == _formats.cend()) {
+        qCWarning(ULogReaderLog) << "Unknown topic" << topic << multiId;
+        return false;
+    }
+    const Format_t& format = *formatIter;
+
+    QList<Field_t> decodeFields;
+    if (fieldNames.isEmpty()) {
+        decodeFields = format.fields;
+    } else {
+        for (const QString& fieldName: fieldNames) {
+            auto fieldIter = std::find_if(format.fields.cbegin(), format.fields.cend(), [&fieldName](const Field_t& field) {
+                return field.name == fieldName;
+            });
+            if (fieldIter == format.fields.cend()) {
+                qCWarning(ULogReaderLog) << "Unknown field" << topic << fieldName;
+                return false;
+            }
+            decodeFields.append(*fieldIter);
+        }
+    }
+
+    // Data messages of a topic are logged in time order, so the range is found with a binary search
+    size_t first    = 0;
+    size_t last     = subscription->offsets.size();
+    if (format.timestampOffset >= 0) {
+        size_t low  = 0;
+        size_t high = last;
+        while (low < high) {
+            size_t mid = low + ((high - low) / 2);
+            if (_timestamp(*subscription, format, mid) < startUSecs) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        first   = low;
+        high    = last;
+        while (low < high) {
+            size_t mid = low + ((high - low) / 2);
+            if (_timestamp(*subscription, format, mid) <= endUSecs) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        last = low;
+    }
+
+    int count = static_cast<int>(last - first);
+    data.timestampsUSecs.reserve(count);
+    QVector<QVector<double>*> columns;
+    for (const Field_t& field: decodeFields) {
+        QVector<double>& column = data.columns[field.name];
+        column.reserve(count);
+        columns.append(&column);
+    }
+
+    for (size_t i = first; i < last; i++) {
+        const uchar*    msg         = _log + subscription->offsets[i];
+        int             dataSize    = qFromLittleEndian<quint16>(msg) - kMsgIdLen;
+        const uchar*    msgData     = msg + kMsgHeaderLen + kMsgIdLen;
+
+        data.timestampsUSecs.append(_timestamp(*subscription, format, i));
+        for (int j = 0; j < decodeFields.count(); j++) {
+            columns[j]->append(_fieldValue(msgData, dataSize, decodeFields[j]));
+        }
+    }
+
+    return true;
+}
+
+double ULogReader::_fieldValue(const uchar* data, int dataSize, const Field_t& field) const
+{
+    if (field.offset + _typeSize(field.type) > dataSize) {
+        return qQNaN();
+    }
+
+    const uchar* value = data + field.offset;
+    switch (field.type) {
+    case FieldTypeInt8:
+        return static_cast<qint8>(value[0]);
+    case FieldTypeUInt8:
+    case FieldTypeBool:
+    case FieldTypeChar:
+        return value[0];
+    case FieldTypeInt16:
+        return qFromLittleEndian<qint16>(value);
+    case FieldTypeUInt16:
+        return qFromLittleEndian<quint16>(value);
+    case FieldTypeInt32:
+        return qFromLittleEndian<qint32>(value);
+    case FieldTypeUInt32:
+        return qFromLittleEndian<quint32>(value);
+    case FieldTypeInt64:
+        return static_cast<double>(qFromLittleEndian<qint64>(value));
+    case FieldTypeUInt64:
+        return static_cast<double>(qFromLittleEndian<quint64>(value));
+    case FieldTypeFloat:
+    {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float   floatValue;
+        memcpy(&floatValue, &bits, sizeof(floatValue));
+        return static_cast<double>(floatValue);
+    }
+    case FieldTypeDouble:
+    {
+        quint64 bits = qFromLittleEndian<quint64>(value);
+        double  doubleValue;
+        memcpy(&doubleValue, &bits, sizeof(doubleValue));
+        return doubleValue;
+    }
+    }
+
+    return qQNaN();
+}
+
+int ULogReader::_typeSize(FieldType type)
+{
+    switch (type) {
+    case FieldTypeInt8:
+    case FieldTypeUInt8:
+    case FieldTypeBool:
+    case FieldTypeChar:
+        return 1;
+    case FieldTypeInt16:
+    case FieldTypeUInt16:
+        return 2;
+    case FieldTypeInt32:
+    case FieldTypeUInt32:
+    case FieldTypeFloat:
+        return 4;
+    case FieldTypeInt64:
+    case FieldTypeUInt64:
+    case FieldTypeDouble:
+        return 8;
+    }
+
+    return 0;
+}
+
+bool ULogReader::_typeFromName(const QString& name, FieldType& type)
+{
+    static const struct {
+        const char* name;
+        FieldType   type;
+    } rgTypes[] = {
+        { "int8_t",     FieldTypeInt8 },
+        { "uint8_t",    FieldTypeUInt8 },
+        { "int16_t",    FieldTypeInt16 },
+        { "uint16_t",   FieldTypeUInt16 },
+        { "int32_t",    FieldTypeInt32 },
+        { "uint32_t",   FieldTypeUInt32 },
+        { "int64_t",    FieldTypeInt64 },
+        { "uint64_t",   FieldTypeUInt64 },
+        { "float",      FieldTypeFloat },
+        { "double",     FieldTypeDouble },
+        { "bool",       FieldTypeBool },
+        { "char",       FieldTypeChar },
+    };
+
+    for (size_t i = 0; i < sizeof(rgTypes) / sizeof(rgTypes[0]); i++) {
+        if (name == QLatin1String(rgTypes[i].name)) {
+            type = rgTypes[i].type;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QMap>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QCoreApplication>
+#include <QLoggingCategory>
+
+#include <limits>
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(ULogReaderLog)
+
+/// Indexed reader for PX4 ULog files.
+///
+/// Opening a log maps it and loads its index: the message formats, the logged topics and the offset of every data
+/// message of each topic. The index is built with a single pass over the log the first time the log is opened and
+/// is saved next to the log as a sidecar file (<log>.qgcuidx), so opening the log again only reads the sidecar. If
+/// the sidecar can't be written the index is kept in memory.
+///
+/// Topic data is only decoded when asked for, into one array per field, for the whole log or a time range. Use a
+/// single reader for all consumers of a log (plots, overlays, geotagging) so the log is only scanned once.
+class ULogReader
+{
+    Q_DECLARE_TR_FUNCTIONS(ULogReader)
+
+public:
+    enum FieldType {
+        FieldTypeInt8,
+        FieldTypeUInt8,
+        FieldTypeInt16,
+        FieldTypeUInt16,
+        FieldTypeInt32,
+        FieldTypeUInt32,
+        FieldTypeInt64,
+        FieldTypeUInt64,
+        FieldTypeFloat,
+        FieldTypeDouble,
+        FieldTypeBool,
+        FieldTypeChar,
+    };
+
+    typedef struct {
+        QString     name;       ///< Nested fields are named "outer.inner", array elements "name[index]"
+        FieldType   type;
+        int         offset;     ///< Offset within the message data, which follows the msg_id
+    } Field_t;
+
+    /// Decoded topic data. All columns have one value per message, matching timestampsUSecs.
+    typedef struct {
+        QVector<quint64>                timestampsUSecs;
+        QMap<QString, QVector<double>>  columns;
+    } TopicData_t;
+
+    ULogReader(void) = default;
+    ~ULogReader() { close(); }
+
+    /// Maps the log and loads its index, building it first if it is missing or out of date
+    /// @return false: failed, errorMessage set
+    bool open(const QString& logFilename, QString& errorMessage);
+
+    void close(void);
+
+    bool        isOpen          (void) const { return _log != nullptr; }
+    quint64     startTimeUSecs  (void) const { return _startTimeUSecs; }
+    quint64     endTimeUSecs    (void) const { return _endTimeUSecs; }
+
+    /// @return Names of all topics which have data in the log
+    QStringList topics(void) const;
+
+    /// @return Number of instances (multi ids) logged for the topic
+    int topicInstanceCount(const QString& topic) const;
+
+    /// @return Number of data messages logged for the topic instance
+    int messageCount(const QString& topic, int multiId = 0) const;
+
+    /// @return Flattened fields of the topic, empty if the topic is unknown
+    QList<Field_t> fields(const QString& topic) const;
+
+    /// Decodes fields of a topic instance for messages with startUSecs <= timestamp <= endUSecs
+    ///     @param fieldNames Fields to decode, all fields if empty
+    /// @return false: unknown topic, instance or field
+    bool readTopic(const QString&       topic,
+                   const QStringList&   fieldNames,
+                   TopicData_t&         data,
+                   int                  multiId     = 0,
+                   quint64              startUSecs  = 0,
+                   quint64              endUSecs    = std::numeric_limits<quint64>::max()) const;
+
+    static QString indexFilename(const QString& logFilename);
+
+private:
+    typedef struct {
+        QList<Field_t>  fields;
+        int             size;               ///< Message data size, without the msg_id
+        int             timestampOffset;    ///< -1 if the format has no timestamp field
+    } Format_t;
+
+    typedef struct {
+        QString                 topic;
+        int                     multiId;
+        std::vector<quint64>    offsets;    ///< Log offset of each data message, in log order
+    } Subscription_t;
+
+    typedef struct {
+        char    magic[8];
+        quint32 version;
+        quint32 byteOrderMark;  ///< Rejects indices written by a machine with different byte order
+        quint64 logFileSize;
+        qint64  logModifiedMSecs;
+    } Header_t;
+
+    bool    _buildIndex         (QString& errorMessage);
+    bool    _loadIndexFile      (const QString& indexFilename, qint64 logModifiedMSecs);
+    bool    _saveIndexFile      (const QString& indexFilename, qint64 logModifiedMSecs) const;
+    bool    _resolveFormat      (const QString& name, Format_t& format, int depth = 0) const;
+    bool    _addSubscription    (quint16 msgId, int multiId, const QString& topic);
+    void    _updateTimeRange    (void);
+    quint64 _timestamp          (const Subscription_t& subscription, const Format_t& format, size_t index) const;
+    double  _fieldValue         (const uchar* data, int dataSize, const Field_t& field) const;
+    const Subscription_t* _findSubscription(const QString& topic, int multiId) const;
+
+    static int  _typeSize       (FieldType type);
+    static bool _typeFromName   (const QString& name, FieldType& type);
+
+    QFile                           _logFile;
+    const uchar*                    _log                = nullptr;
+    quint64                         _logSize            = 0;
+    quint64                         _startTimeUSecs     = 0;
+    quint64                         _endTimeUSecs       = 0;
+    QHash<QString, QString>         _formatText;        ///< Format name to its field definitions, as logged
+    QHash<QString, Format_t>        _formats;           ///< Resolved formats of subscribed topics
+    QMap<quint16, Subscription_t>   _subscriptions;     ///< By msg_id
+
+    static const quint32    _version            = 1;
+    static const quint32    _byteOrderMark      = 0x01020304;
+    static const int        _maxFormatDepth     = 8;
+    static const char*      _magic;
+};
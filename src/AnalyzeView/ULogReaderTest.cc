@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReaderTest.h"
+#include "ULogReader.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+const int ULogReaderTest::_messageCount;
+
+void ULogReaderTest::init(void)
+{
+    UnitTest::init();
+
+    _tempDir = new QTemporaryDir();
+    QVERIFY(_tempDir->isValid());
+    _logFilename = _tempDir->filePath(QStringLiteral("test.ulg"));
+    _writeLog(_logFilename, _messageCount);
+}
+
+void ULogReaderTest::cleanup(void)
+{
+    delete _tempDir;
+    _tempDir = nullptr;
+
+    UnitTest::cleanup();
+}
+
+void ULogReaderTest::_appendMessage(QByteArray& log, char msgType, const QByteArray& payload)
+{
+    uchar header[3];
+    qToLittleEndian<quint16>(static_cast<quint16>(payload.size()), header);
+    header[2] = static_cast<uchar>(msgType);
+    log.append(reinterpret_cast<const char*>(header), sizeof(header));
+    log.append(payload);
+}
+
+/// Writes a log with one topic which uses a nested type, an array and padding. Message i has timestamp 1000 * i.
+void ULogReaderTest::_writeLog(const QString& logFilename, int messageCount)
+{
+    QByteArray log("ULog\x01\x12\x35", 7);
+    log.append('\x01');                 // Version
+    log.append(QByteArray(8, '\0'));    // Start timestamp
+
+    _appendMessage(log, 'F', QByteArrayLiteral("test_point:float x;float y;"));
+    _appendMessage(log, 'F', QByteArrayLiteral("test_topic:uint64_t timestamp;int32_t value;test_point[2] points;uint8_t[3] _padding0;"));
+    _appendMessage(log, 'F', QByteArrayLiteral("unlogged_topic:uint64_t timestamp;"));
+
+    QByteArray addLogged;
+    addLogged.append('\0');             // multi_id
+    addLogged.append(QByteArray("\x07\x00", 2));
+    addLogged.append("test_topic");
+    _appendMessage(log, 'A', addLogged);
+
+    for (int i = 0; i < messageCount; i++) {
+        uchar data[2 + 8 + 4 + (4 * 4) + 3];
+        memset(data, 0, sizeof(data));
+        qToLittleEndian<quint16>(7, data);
+        qToLittleEndian<quint64>(static_cast<quint64>(1000 * i), data + 2);
+        qToLittleEndian<qint32>(-2 * i, data + 10);
+        for (int j = 0; j < 4; j++) {
+            float value = static_cast<float>(i + (j * 0.5));
+            memcpy(data + 14 + (j * 4), &value, sizeof(value));
+        }
+        _appendMessage(log, 'D', QByteArray(reinterpret_cast<const char*>(data), sizeof(data)));
+    }
+
+    QFile file(logFilename);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    QCOMPARE(file.write(log), static_cast<qint64>(log.size()));
+}
+
+void ULogReaderTest::_testTopics(void)
+{
+    ULogReader  reader;
+    QString     errorMessage;
+
+    QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+    QCOMPARE(reader.topics(), QStringList({ QStringLiteral("test_topic") }));
+    QCOMPARE(reader.topicInstanceCount(QStringLiteral("test_topic")), 1);
+    QCOMPARE(reader.messageCount(QStringLiteral("test_topic")), _messageCount);
+    QCOMPARE(reader.startTimeUSecs(), static_cast<quint64>(0));
+    QCOMPARE(reader.endTimeUSecs(), static_cast<quint64>(1000 * (_messageCount - 1)));
+
+    QStringList fieldNames;
+    for (const ULogReader::Field_t& field: reader.fields(QStringLiteral("test_topic"))) {
+        fieldNames.append(field.name);
+    }
+    QCOMPARE(fieldNames, QStringList({ "timestamp", "value", "points[0].x", "points[0].y", "points[1].x", "points[1].y" }));
+}
+
+void ULogReaderTest::_testReadTopic(void)
+{
+    ULogReader              reader;
+    ULogReader::TopicData_t data;
+    QString                 errorMessage;
+
+    QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+
+    QVERIFY(reader.readTopic(QStringLiteral("test_topic"), QStringList({ "value", "points[1].y" }), data));
+    QCOMPARE(data.timestampsUSecs.count(), _messageCount);
+    QCOMPARE(data.columns.count(), 2);
+    for (int i = 0; i < _messageCount; i++) {
+        QCOMPARE(data.timestampsUSecs[i], static_cast<quint64>(1000 * i));
+        QCOMPARE(data.columns["value"][i], -2.0 * i);
+        QCOMPARE(data.columns["points[1].y"][i], i + 1.5);
+    }
+
+    // All fields
+    QVERIFY(reader.readTopic(QStringLiteral("test_topic"), QStringList(), data));
+    QCOMPARE(data.columns.count(), 6);
+
+    QVERIFY(!reader.readTopic(QStringLiteral("test_topic"), QStringList({ "missing" }), data));
+    QVERIFY(!reader.readTopic(QStringLiteral("unlogged_topic"), QStringList(), data));
+    QVERIFY(!reader.readTopic(QStringLiteral("test_topic"), QStringList(), data, 1));
+}
+
+void ULogReaderTest::_testTimeRange(void)
+{
+    ULogReader              reader;
+    ULogReader::TopicData_t data;
+    QString                 errorMessage;
+
+    QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+
+    QVERIFY(reader.readTopic(QStringLiteral("test_topic"), QStringList({ "value" }), data, 0, 2500, 5000));
+    QCOMPARE(data.timestampsUSecs, QVector<quint64>({ 3000, 4000, 5000 }));
+    QCOMPARE(data.columns["value"], QVector<double>({ -6, -8, -10 }));
+
+    QVERIFY(reader.readTopic(QStringLiteral("test_topic"), QStringList({ "value" }), data, 0, 100000, 200000));
+    QCOMPARE(data.timestampsUSecs.count(), 0);
+    QCOMPARE(data.columns["value"].count(), 0);
+}
+
+void ULogReaderTest::_testIndexFile(void)
+{
+    QString errorMessage;
+
+    {
+        ULogReader reader;
+        QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+    }
+    QVERIFY(QFile::exists(ULogReader::indexFilename(_logFilename)));
+
+    // Loaded from the index
+    {
+        ULogReader              reader;
+        ULogReader::TopicData_t data;
+        QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+        QCOMPARE(reader.messageCount(QStringLiteral("test_topic")), _messageCount);
+        QVERIFY(reader.readTopic(QStringLiteral("test_topic"), QStringList({ "points[0].x" }), data));
+        QCOMPARE(data.columns["points[0].x"].last(), static_cast<double>(_messageCount - 1));
+    }
+
+    // A changed log makes the index out of date
+    _writeLog(_logFilename, _messageCount * 2);
+    {
+        ULogReader reader;
+        QVERIFY2(reader.open(_logFilename, errorMessage), qPrintable(errorMessage));
+        QCOMPARE(reader.messageCount(QStringLiteral("test_topic")), _messageCount * 2);
+    }
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTemporaryDir>
+
+class ULogReaderTest : public UnitTest
+{
+    Q_OBJECT
+
+protected:
+    void init(void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _testTopics    (void);
+    void _testReadTopic (void);
+    void _testTimeRange (void);
+    void _testIndexFile (void);
+
+private:
+    void _writeLog      (const QString& logFilename, int messageCount);
+
+    static void _appendMessage(QByteArray& log, char msgType, const QByteArray& payload);
+
+    QTemporaryDir*  _tempDir = nullptr;
+    QString         _logFilename;
+
+    static const int _messageCount = 10;
+};
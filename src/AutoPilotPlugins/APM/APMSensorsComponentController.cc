@@ -109,7 +109,7 @@ void APMSensorsComponentController::_startLogCalibration(void)
     }
     _cancelButton->setEnabled(_calTypeInProgress == CalTypeOnboardCompass);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeToCalMessages();
 }
 
 void APMSensorsComponentController::_startVisualCalibration(void)
@@ -122,7 +122,7 @@ void APMSensorsComponentController::_startVisualCalibration(void)
     
     _progressBar->setProperty("value", 0);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeToCalMessages();
 }
 
 void APMSensorsComponentController::_resetInternalState(void)
@@ -153,7 +153,7 @@ void APMSensorsComponentController::_resetInternalState(void)
 
 void APMSensorsComponentController::_stopCalibration(APMSensorsComponentController::StopCalibrationCode code)
 {
-    disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _unsubscribeFromCalMessages();
     _vehicle->vehicleLinkManager()->setCommunicationLostEnabled(true);
 
     disconnect(_vehicle, &Vehicle::textMessageReceived, this, &APMSensorsComponentController::_handleUASTextMessage);
@@ -717,6 +717,28 @@ void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link,
     }
 }
 
+void APMSensorsComponentController::_subscribeToCalMessages(void)
+{
+    if (!_calMessageSubscriptions.isEmpty()) {
+        return;
+    }
+
+    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+    auto handler = [this](LinkInterface* link, const mavlink_message_t& message) { _mavlinkMessageReceived(link, message); };
+    for (int msgId: { MAVLINK_MSG_ID_COMMAND_ACK, MAVLINK_MSG_ID_MAG_CAL_PROGRESS, MAVLINK_MSG_ID_MAG_CAL_REPORT, MAVLINK_MSG_ID_COMMAND_LONG }) {
+        _calMessageSubscriptions.append(mavlinkProtocol->subscribe(this, _vehicle->id(), MAVLinkProtocol::anyId, msgId, handler));
+    }
+}
+
+void APMSensorsComponentController::_unsubscribeFromCalMessages(void)
+{
+    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+    for (int subscriptionId: _calMessageSubscriptions) {
+        mavlinkProtocol->unsubscribe(subscriptionId);
+    }
+    _calMessageSubscriptions.clear();
+}
+
 void APMSensorsComponentController::_restorePreviousCompassCalFitness(void)
 {
     if (_restoreCompassCalFitness) {
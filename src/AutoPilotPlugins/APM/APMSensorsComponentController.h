@@ -150,6 +150,8 @@ private:
     void _handleMagCalReport                (mavlink_message_t& message);
     void _handleCommandLong                 (mavlink_message_t& message);
     void _restorePreviousCompassCalFitness  (void);
+    void _subscribeToCalMessages            (void);
+    void _unsubscribeFromCalMessages        (void);
 
     enum StopCalibrationCode {
         StopCalibrationSuccess,
@@ -174,6 +176,8 @@ private:
     
     CalType_t _calTypeInProgress;
 
+    QList<int> _calMessageSubscriptions;    ///< MAVLinkProtocol subscriptions active during calibration
+
     uint8_t _rgCompassCalProgress[3];
     bool    _rgCompassCalComplete[3];
     bool    _rgCompassCalSucceeded[3];
@@ -161,6 +161,7 @@ SetupPage {
                     sourceSize.height: imageSize
                     visible:           actuators.isMultirotor
                     cache:             false
+                    asynchronous:      true
                     MouseArea {
                         anchors.fill:  parent
                         onClicked: {
@@ -30,8 +30,8 @@ ColumnLayout {
         property var roll: QtObject {
             property string name: qsTr("Roll")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.roll.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.roll.value }
+                { name: "Response", channel: PIDTuningRecorder.Roll },
+                { name: "Setpoint", channel: PIDTuningRecorder.RollSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -47,8 +47,8 @@ ColumnLayout {
         property var pitch: QtObject {
             property string name: qsTr("Pitch")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.pitch.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.pitch.value }
+                { name: "Response", channel: PIDTuningRecorder.Pitch },
+                { name: "Setpoint", channel: PIDTuningRecorder.PitchSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -64,8 +64,8 @@ ColumnLayout {
         property var yaw: QtObject {
             property string name: qsTr("Yaw")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.heading.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.yaw.value }
+                { name: "Response", channel: PIDTuningRecorder.Yaw },
+                { name: "Setpoint", channel: PIDTuningRecorder.YawSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -30,8 +30,8 @@ ColumnLayout {
         property var roll: QtObject {
             property string name: qsTr("Roll")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.roll.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.roll.value }
+                { name: "Response", channel: PIDTuningRecorder.Roll },
+                { name: "Setpoint", channel: PIDTuningRecorder.RollSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -47,8 +47,8 @@ ColumnLayout {
         property var pitch: QtObject {
             property string name: qsTr("Pitch")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.pitch.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.pitch.value }
+                { name: "Response", channel: PIDTuningRecorder.Pitch },
+                { name: "Setpoint", channel: PIDTuningRecorder.PitchSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -33,8 +33,8 @@ ColumnLayout {
         property var roll: QtObject {
             property string name: qsTr("Roll")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.rollRate.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.rollRate.value }
+                { name: "Response", channel: PIDTuningRecorder.RollRate },
+                { name: "Setpoint", channel: PIDTuningRecorder.RollRateSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -74,8 +74,8 @@ ColumnLayout {
         property var pitch: QtObject {
             property string name: qsTr("Pitch")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.pitchRate.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.pitchRate.value }
+                { name: "Response", channel: PIDTuningRecorder.PitchRate },
+                { name: "Setpoint", channel: PIDTuningRecorder.PitchRateSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
@@ -115,8 +115,8 @@ ColumnLayout {
         property var yaw: QtObject {
             property string name: qsTr("Yaw")
             property var plot: [
-                { name: "Response", value: globals.activeVehicle.yawRate.value },
-                { name: "Setpoint", value: globals.activeVehicle.setpoint.yawRate.value }
+                { name: "Response", channel: PIDTuningRecorder.YawRate },
+                { name: "Setpoint", channel: PIDTuningRecorder.YawRateSetpoint }
             ]
             property var params: ListModel {
                 ListElement {
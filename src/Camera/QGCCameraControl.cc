@@ -18,10 +18,19 @@
 #include <QStandardPaths>
 #include <QDomDocument>
 #include <QDomNodeList>
+#include <QCryptographicHash>
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 QGC_LOGGING_CATEGORY(CameraControlLog, "CameraControlLog")
 QGC_LOGGING_CATEGORY(CameraControlVerboseLog, "CameraControlVerboseLog")
 
+QHash<QByteArray, QDomDocument>                     QGCCameraControl::_definitionCache;
+QMap<QString, QList<QPointer<QGCCameraControl>>>    QGCCameraControl::_definitionWaiters;
+const int                                           QGCCameraControl::_paramRequestBatchMSecs;
+const int                                           QGCCameraControl::_paramRequestWindow;
+
 static const char* kCondition       = "condition";
 static const char* kControl         = "control";
 static const char* kDefault         = "default";
@@ -72,6 +81,8 @@ const char* QGCCameraControl::kCAM_SHUTTERSPD  = "CAM_SHUTTERSPD";
 const char* QGCCameraControl::kCAM_APERTURE    = "CAM_APERTURE";
 const char* QGCCameraControl::kCAM_WBMODE      = "CAM_WBMODE";
 const char* QGCCameraControl::kCAM_MODE        = "CAM_MODE";
+const char* QGCCameraControl::kCAM_VIDRES      = "CAM_VIDRES";
+const char* QGCCameraControl::kCAM_VIDBITRATE  = "CAM_VIDBITRATE";
 
 //-----------------------------------------------------------------------------
 QGCCameraOptionExclusion::QGCCameraOptionExclusion(QObject* parent, QString param_, QString value_, QStringList exclusions_)
@@ -171,6 +182,11 @@ QGCCameraControl::QGCCameraControl(const mavlink_camera_information_t *info, Veh
         _vendor.toStdString().c_str(),
         _modelName.toStdString().c_str(),
         ver);
+    _paramCacheFile = QString::asprintf("%s/%s_%s_%08x_params.json",
+        qgcApp()->toolbox()->settingsManager()->appSettings()->parameterSavePath().toStdString().c_str(),
+        _vendor.toStdString().c_str(),
+        _modelName.toStdString().c_str(),
+        _info.firmware_version);
     if(info->cam_definition_uri[0] != 0) {
         //-- Process camera definition file
         _handleDefinitionFile(info->cam_definition_uri);
@@ -186,11 +202,27 @@ QGCCameraControl::QGCCameraControl(const mavlink_camera_information_t *info, Veh
     _recTimer.setSingleShot(false);
     _recTimer.setInterval(333);
     connect(&_recTimer, &QTimer::timeout, this, &QGCCameraControl::_recTimerHandler);
+    _paramRequestTimer.setSingleShot(true);
+    _paramRequestTimer.setInterval(_paramRequestBatchMSecs);
+    connect(&_paramRequestTimer, &QTimer::timeout, this, &QGCCameraControl::_sendParamRequests);
 }
 
 //-----------------------------------------------------------------------------
 QGCCameraControl::~QGCCameraControl()
 {
+    if(_paramComplete && !isBasic()) {
+        _saveParamCache();
+    }
+    if(_netManager) {
+        //-- Our definition download never finished, hand it over to a camera waiting on it
+        QList<QPointer<QGCCameraControl>> waiters = _definitionWaiters.take(_cacheFile);
+        for(const QPointer<QGCCameraControl>& waiter: waiters) {
+            if(waiter) {
+                waiter->_handleDefinitionFile(reinterpret_cast<const char*>(waiter->_info.cam_definition_uri));
+                break;
+            }
+        }
+    }
     delete _netManager;
     _netManager = nullptr;
 }
@@ -208,7 +240,12 @@ QGCCameraControl::_initWhenReady()
         _paramComplete = true;
         emit parametersReady();
     } else {
+        bool cached = _loadParamCache();
+        //-- Cached values are refreshed from the camera in the background
         _requestAllParameters();
+        if(cached) {
+            _paramDone();
+        }
         //-- Give some time to load the parameters before going after the camera settings
         QTimer::singleShot(2000, this, &QGCCameraControl::_requestCameraSettings);
     }
@@ -805,16 +842,8 @@ bool
 QGCCameraControl::_loadCameraDefinitionFile(QByteArray& bytes)
 {
     QByteArray originalData(bytes);
-    //-- Handle localization
-    if(!_handleLocalization(bytes)) {
-        return false;
-    }
-    int errorLine;
-    QString errorMsg;
     QDomDocument doc;
-    if(!doc.setContent(bytes, false, &errorMsg, &errorLine)) {
-        qCritical() << "Unable to parse camera definition file on line:" << errorLine;
-        qCritical() << errorMsg;
+    if(!_parseCameraDefinitionFile(bytes, doc)) {
         return false;
     }
     //-- Load camera constants
@@ -842,6 +871,32 @@ QGCCameraControl::_loadCameraDefinitionFile(QByteArray& bytes)
     return true;
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCameraControl::_parseCameraDefinitionFile(const QByteArray& bytes, QDomDocument& doc)
+{
+    QByteArray hash = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+    if(_definitionCache.contains(hash)) {
+        qCDebug(CameraControlLog) << "Camera definition already parsed" << hash.toHex();
+        doc = _definitionCache[hash];
+        return true;
+    }
+    //-- Handle localization
+    QByteArray localized(bytes);
+    if(!_handleLocalization(localized)) {
+        return false;
+    }
+    int errorLine;
+    QString errorMsg;
+    if(!doc.setContent(localized, false, &errorMsg, &errorLine)) {
+        qCritical() << "Unable to parse camera definition file on line:" << errorLine;
+        qCritical() << errorMsg;
+        return false;
+    }
+    _definitionCache[hash] = doc;
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCameraControl::_loadConstants(const QDomNodeList nodeList)
@@ -1177,6 +1232,75 @@ QGCCameraControl::_requestAllParameters()
             qCritical() << "QGCParamIO is NULL" << paramName;
         }
     }
+    _paramRequestQueue.clear();
+    _paramRequestsInFlight.clear();
+    _paramRequestTimer.stop();
+    _sendParamRequestList();
+    qCDebug(CameraControlVerboseLog) << "Request all parameters";
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraControl::_loadParamCache()
+{
+    QFile file(_paramCacheFile);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if(error.error != QJsonParseError::NoError || !doc.isObject()) {
+        qCWarning(CameraControlLog) << "Ignoring corrupt camera parameter cache" << _paramCacheFile << error.errorString();
+        return false;
+    }
+    QJsonObject values = doc.object();
+    //-- The cache is only used if it covers every readable parameter, otherwise the camera would show up with
+    //   default values for some of them
+    QMap<QString, QVariant> typedValues;
+    for(const QString& paramName: _paramIO.keys()) {
+        Fact* pFact = getFact(paramName);
+        if(!pFact || pFact->writeOnly()) {
+            continue;
+        }
+        QVariant typedValue;
+        QString  errorString;
+        if(!values.contains(paramName) || !pFact->metaData()->convertAndValidateRaw(values[paramName].toVariant(), true /* convertOnly */, typedValue, errorString)) {
+            qCDebug(CameraControlLog) << "Camera parameter cache incomplete, missing" << paramName;
+            return false;
+        }
+        typedValues[paramName] = typedValue;
+    }
+    for(const QString& paramName: typedValues.keys()) {
+        _paramIO[paramName]->setCachedValue(typedValues[paramName]);
+    }
+    qCDebug(CameraControlLog) << "Using cached camera parameters" << _paramCacheFile;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_saveParamCache()
+{
+    QJsonObject values;
+    for(const QString& paramName: _paramIO.keys()) {
+        Fact* pFact = getFact(paramName);
+        //-- Custom values are raw bytes which don't survive json, cameras using them are never served from the cache
+        if(pFact && !pFact->writeOnly() && pFact->type() != FactMetaData::valueTypeCustom) {
+            values[paramName] = QJsonValue::fromVariant(pFact->rawValue());
+        }
+    }
+    QFile file(_paramCacheFile);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(CameraControlLog) << "Could not save camera parameter cache" << _paramCacheFile << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(values).toJson(QJsonDocument::Compact));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_sendParamRequestList()
+{
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
@@ -1192,7 +1316,6 @@ QGCCameraControl::_requestAllParameters()
                     static_cast<uint8_t>(compID()));
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
-    qCDebug(CameraControlVerboseLog) << "Request all parameters";
 }
 
 //-----------------------------------------------------------------------------
@@ -1259,6 +1382,14 @@ QGCCameraControl::_updateActiveList()
     }
     if(active != _activeSettings) {
         qCDebug(CameraControlVerboseLog) << "Excluding" << exclusionList;
+        //-- Settings coming out of an exclusion may have changed on the camera while hidden, only those are read again
+        if(_paramComplete) {
+            for(const QString& key: active) {
+                if(!_activeSettings.contains(key) && _paramIO.contains(key)) {
+                    _paramIO[key]->paramRequest();
+                }
+            }
+        }
         _activeSettings = active;
         emit activeSettingsChanged();
         //-- Force validity of "Facts" based on active set
@@ -1439,6 +1570,53 @@ QGCCameraControl::_requestParamUpdates()
     _updatesToRequest.clear();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_queueParamRequest(const QString& paramName)
+{
+    //-- A retry replaces the outstanding read
+    _paramRequestsInFlight.removeOne(paramName);
+    if(!_paramRequestQueue.contains(paramName)) {
+        _paramRequestQueue << paramName;
+    }
+    if(!_paramRequestTimer.isActive()) {
+        _paramRequestTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_paramRequestAnswered(const QString& paramName)
+{
+    if(_paramRequestsInFlight.removeOne(paramName) && !_paramRequestQueue.isEmpty() && !_paramRequestTimer.isActive()) {
+        //-- Keep the window full
+        _sendParamRequests();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_sendParamRequests()
+{
+    //-- When most parameters need reading (update rules touching many settings, or request timeouts which fire
+    //   together after _requestAllParameters) one list request is cheaper than a read per parameter.
+    if(_paramRequestQueue.count() > 1 && _paramRequestQueue.count() * 2 > _paramIO.count()) {
+        qCDebug(CameraControlVerboseLog) << "Batch parameter request:" << _paramRequestQueue.count();
+        _sendParamRequestList();
+        _paramRequestQueue.clear();
+        return;
+    }
+    //-- Single reads are pipelined, the next ones go out as answers come back
+    while(!_paramRequestQueue.isEmpty() && _paramRequestsInFlight.count() < _paramRequestWindow) {
+        const QString paramName = _paramRequestQueue.takeFirst();
+        QGCCameraParamIO* pIO = _paramIO.value(paramName);
+        if(pIO) {
+            _paramRequestsInFlight << paramName;
+            pIO->sendParamRequest();
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCameraControl::_requestCameraSettings()
@@ -1969,10 +2147,7 @@ QGCCameraControl::_handleDefinitionFile(const QString &url)
             _modelName.toStdString().c_str(),
             ver,
             ext.toStdString().c_str());
-        connect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &QGCCameraControl::_ftpDownloadComplete);
-        _vehicle->ftpManager()->download(_compID, url,
-            qgcApp()->toolbox()->settingsManager()->appSettings()->parameterSavePath().toStdString().c_str(),
-            fileName);
+        _vehicle->cameraManager()->downloadDefinitionFile(this, url, fileName);
         return;
     }
 
@@ -1988,7 +2163,7 @@ QGCCameraControl::_handleDefinitionFile(const QString &url)
     }
     QByteArray bytes = xmlFile.readAll();
     QDomDocument doc;
-    if(!doc.setContent(bytes, false)) {
+    if(!_parseCameraDefinitionFile(bytes, doc)) {
         qWarning() << "Could not parse cached camera definition file:" << _cacheFile;
         _httpRequest(url);
         return;
@@ -2003,6 +2178,13 @@ QGCCameraControl::_handleDefinitionFile(const QString &url)
 void
 QGCCameraControl::_httpRequest(const QString &url)
 {
+    //-- Another camera of the same model is already downloading this definition
+    if(_definitionWaiters.contains(_cacheFile)) {
+        qCDebug(CameraControlLog) << "Waiting on camera definition download:" << url;
+        _definitionWaiters[_cacheFile].append(this);
+        return;
+    }
+    _definitionWaiters.insert(_cacheFile, QList<QPointer<QGCCameraControl>>());
     qCDebug(CameraControlLog) << "Request camera definition:" << url;
     if(!_netManager) {
         _netManager = new QNetworkAccessManager(this);
@@ -2042,26 +2224,42 @@ QGCCameraControl::_downloadFinished()
             reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toString()
         );
     }
+    QList<QPointer<QGCCameraControl>> waiters = _definitionWaiters.take(_cacheFile);
     emit dataReady(data);
     //reply->deleteLater();
+    //-- Cameras waiting on this download pick up the cache file we just saved (or try again themselves)
+    for(const QPointer<QGCCameraControl>& waiter: waiters) {
+        if(waiter) {
+            waiter->_handleDefinitionFile(reinterpret_cast<const char*>(waiter->_info.cam_definition_uri));
+        }
+    }
 }
 
 void QGCCameraControl::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
 {
     qCDebug(CameraControlLog) << "FTP Download completed: " << fileName << ", " << errorMsg;
 
-    disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &QGCCameraControl::_ftpDownloadComplete);
-
     QString outputFileName = fileName;
 
     if (fileName.endsWith(".lzma", Qt::CaseInsensitive) || fileName.endsWith(".xz", Qt::CaseInsensitive)) {
+        //-- Inflate in memory and parse from there, the inflated file is only written to serve as cache
         outputFileName = fileName.left(fileName.lastIndexOf("."));
-        if (QGCLZMA::inflateLZMAFile(fileName, outputFileName)) {
-            QFile(fileName).remove();
+        QFile       lzmaFile(fileName);
+        QByteArray  bytes;
+        QBuffer     xmlBuffer(&bytes);
+        xmlBuffer.open(QIODevice::WriteOnly);
+        if (lzmaFile.open(QIODevice::ReadOnly) && QGCLZMA::inflateLZMA(lzmaFile, xmlBuffer)) {
+            lzmaFile.remove();
+            QFile xmlFile(outputFileName);
+            if (!xmlFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || xmlFile.write(bytes) != bytes.size()) {
+                qCWarning(CameraControlLog) << "Could not save camera definition file" << outputFileName;
+            }
+            _cached = true;
+            emit dataReady(bytes);
         } else {
             qCWarning(CameraControlLog) << "Inflate of compressed xml failed" << fileName;
-            outputFileName.clear();
         }
+        return;
     }
 
     QFile xmlFile(outputFileName);
@@ -2104,6 +2302,7 @@ QGCCameraControl::_paramDone()
     }
     //-- All parameters loaded (or timed out)
     _paramComplete = true;
+    _saveParamCache();
     emit parametersReady();
     //-- Check for video streaming
     _checkForVideoStreams();
@@ -2202,6 +2401,20 @@ QGCCameraControl::mode()
     return _paramComplete && factExists(kCAM_MODE) ? getFact(kCAM_MODE) : nullptr;
 }
 
+//-----------------------------------------------------------------------------
+Fact*
+QGCCameraControl::videoResolution()
+{
+    return (_paramComplete && _activeSettings.contains(kCAM_VIDRES)) ? getFact(kCAM_VIDRES) : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+Fact*
+QGCCameraControl::videoBitrate()
+{
+    return (_paramComplete && _activeSettings.contains(kCAM_VIDBITRATE)) ? getFact(kCAM_VIDBITRATE) : nullptr;
+}
+
 //-----------------------------------------------------------------------------
 QGCVideoStreamInfo::QGCVideoStreamInfo(QObject* parent, const mavlink_video_stream_information_t *si)
     : QObject(parent)
@@ -13,7 +13,9 @@
 
 #include "QGCApplication.h"
 #include <QLoggingCategory>
+#include <QPointer>
 
+class QDomDocument;
 class QDomNode;
 class QDomNodeList;
 class QGCCameraParamIO;
@@ -87,6 +89,7 @@ class QGCCameraControl : public FactGroup
 {
     Q_OBJECT
     friend class QGCCameraParamIO;
+    friend class QGCCameraManager;
 public:
     QGCCameraControl(const mavlink_camera_information_t* info, Vehicle* vehicle, int compID, QObject* parent = nullptr);
     virtual ~QGCCameraControl();
@@ -265,6 +268,8 @@ public:
     virtual Fact*       aperture            ();
     virtual Fact*       wb                  ();
     virtual Fact*       mode                ();
+    virtual Fact*       videoResolution     ();
+    virtual Fact*       videoBitrate        ();
 
     /// Stream names to show the user (for selection)
     virtual QStringList streamLabels        () { return _streamLabels; }
@@ -305,6 +310,8 @@ public:
     static const char* kCAM_APERTURE;
     static const char* kCAM_WBMODE;
     static const char* kCAM_MODE;
+    static const char* kCAM_VIDRES;
+    static const char* kCAM_VIDBITRATE;
 
 signals:
     void    infoChanged                     ();
@@ -346,6 +353,7 @@ protected slots:
     virtual void    _requestCameraSettings  ();
     virtual void    _requestAllParameters   ();
     virtual void    _requestParamUpdates    ();
+    virtual void    _sendParamRequests      ();
     virtual void    _requestCaptureStatus   ();
     virtual void    _requestStorageInfo     ();
     virtual void    _downloadFinished       ();
@@ -361,6 +369,7 @@ private:
     bool    _handleLocalization             (QByteArray& bytes);
     bool    _replaceLocaleStrings           (const QDomNode node, QByteArray& bytes);
     bool    _loadCameraDefinitionFile       (QByteArray& bytes);
+    bool    _parseCameraDefinitionFile      (const QByteArray& bytes, QDomDocument& doc);
     bool    _loadConstants                  (const QDomNodeList nodeList);
     bool    _loadSettings                   (const QDomNodeList nodeList);
     void    _processRanges                  ();
@@ -371,6 +380,11 @@ private:
     void    _updateActiveList               ();
     void    _updateRanges                   (Fact* pFact);
     void    _httpRequest                    (const QString& url);
+    void    _queueParamRequest              (const QString& paramName);
+    void    _paramRequestAnswered           (const QString& paramName);
+    void    _sendParamRequestList           ();
+    bool    _loadParamCache                 ();
+    void    _saveParamCache                 ();
     void    _handleDefinitionFile           (const QString& url);
     void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg);
 
@@ -394,6 +408,7 @@ protected:
     QString                             _modelName;
     QString                             _vendor;
     QString                             _cacheFile;
+    QString                             _paramCacheFile;    ///< Last known parameter values for this model and firmware
     CameraMode                          _cameraMode         = CAM_MODE_UNDEFINED;
     StorageStatus                       _storageStatus      = STORAGE_NOT_SUPPORTED;
     PhotoMode                           _photoMode          = PHOTO_CAPTURE_SINGLE;
@@ -418,6 +433,10 @@ protected:
     //-- Parameters that require a full update
     QMap<QString, QStringList>          _requestUpdates;
     QStringList                         _updatesToRequest;
+    //-- Parameter reads waiting to be sent as a batch, at most _paramRequestWindow single reads are outstanding
+    QStringList                         _paramRequestQueue;
+    QStringList                         _paramRequestsInFlight;
+    QTimer                              _paramRequestTimer;
     //-- Video Streams
     int                                 _requestCount       = 0;
     int                                 _currentStream      = 0;
@@ -428,4 +447,13 @@ protected:
     QStringList                         _streamLabels;
     ThermalViewMode                     _thermalMode        = THERMAL_BLEND;
     double                              _thermalOpacity     = 85.0;
+
+    //-- Parsed (and localized) definition files by content hash. Cameras of the same model, or the same camera
+    //   reconnecting, share the parsed document instead of parsing the XML again.
+    static QHash<QByteArray, QDomDocument>                  _definitionCache;
+    //-- Cameras waiting on an http definition download already started by another camera, by cache file
+    static QMap<QString, QList<QPointer<QGCCameraControl>>> _definitionWaiters;
+
+    static const int                    _paramRequestBatchMSecs = 50;
+    static const int                    _paramRequestWindow     = 8;
 };
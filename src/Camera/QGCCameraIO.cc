@@ -257,6 +257,7 @@ void
 QGCCameraParamIO::handleParamValue(const mavlink_param_ext_value_t& value)
 {
     _paramRequestTimer.stop();
+    _control->_paramRequestAnswered(_fact->name());
     QVariant newValue = _valueFromMessage(value.param_value, value.param_type);
     if(_control->incomingParameter(_fact, newValue)) {
         _fact->_containerSetRawValue(newValue);
@@ -274,6 +275,17 @@ QGCCameraParamIO::handleParamValue(const mavlink_param_ext_value_t& value)
     qCDebug(CameraIOLog) << QString("handleParamValue() %1 %2").arg(_fact->name()).arg(_fact->rawValueString());
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCameraParamIO::setCachedValue(const QVariant& value)
+{
+    QVariant newValue = value;
+    if(_control->incomingParameter(_fact, newValue)) {
+        _fact->_containerSetRawValue(newValue);
+    }
+    _done = true;
+}
+
 //-----------------------------------------------------------------------------
 QVariant
 QGCCameraParamIO::_valueFromMessage(const char* value, uint8_t param_type)
@@ -325,6 +337,7 @@ QGCCameraParamIO::_paramRequestTimeout()
 {
     if(++_requestRetries > 3) {
         qCWarning(CameraIOLog) << "No response for param request:" << _fact->name();
+        _control->_paramRequestAnswered(_fact->name());
         if(!_done) {
             _done = true;
             _control->_paramDone();
@@ -354,6 +367,15 @@ QGCCameraParamIO::paramRequest(bool reset)
         _forceUIUpdate  = true;
     }
     qCDebug(CameraIOLog) << "Request parameter:" << _fact->name();
+    //-- Requests from all parameters are collected and sent together by the camera
+    _control->_queueParamRequest(_fact->name());
+    _paramRequestTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraParamIO::sendParamRequest()
+{
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
@@ -373,5 +395,4 @@ QGCCameraParamIO::paramRequest(bool reset)
                     -1);
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
-    _paramRequestTimer.start();
 }
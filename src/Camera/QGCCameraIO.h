@@ -49,7 +49,10 @@ public:
     void        setParamRequest             ();
     bool        paramDone                   () const { return _done; }
     void        paramRequest                (bool reset = true);
+    void        sendParamRequest            ();
     void        sendParameter               (bool updateUI = false);
+    /// Sets the value from the parameter cache. The parameter counts as done until the camera is heard from.
+    void        setCachedValue              (const QVariant& value);
 
     QStringList  optNames;
     QVariantList optVariants;
@@ -8,6 +8,11 @@
 #include "QGCApplication.h"
 #include "QGCCameraManager.h"
 #include "JoystickManager.h"
+#include "SettingsManager.h"
+#include "FTPManager.h"
+
+#include <QDir>
+#include <QFile>
 
 QGC_LOGGING_CATEGORY(CameraManagerLog, "CameraManagerLog")
 
@@ -523,3 +528,71 @@ QGCCameraManager::_stepStream(int direction)
 }
 
 
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraManager::downloadDefinitionFile(QGCCameraControl* camera, const QString& url, const QString& fileName)
+{
+    DefinitionDownload_t download;
+    download.camera     = camera;
+    download.url        = url;
+    download.fileName   = fileName;
+    _definitionDownloads.append(download);
+    if(_definitionDownloads.count() == 1) {
+        _startDefinitionDownload();
+    } else {
+        qCDebug(CameraManagerLog) << "Camera definition download queued" << fileName << _definitionDownloads.count() - 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraManager::_startDefinitionDownload()
+{
+    QString toDir = qgcApp()->toolbox()->settingsManager()->appSettings()->parameterSavePath();
+    while(_definitionDownloads.count()) {
+        DefinitionDownload_t& download = _definitionDownloads.first();
+        if(download.camera) {
+            //-- Cameras of the same model use the same file, which an earlier download may have already fetched
+            QString xmlFile = download.fileName;
+            if(xmlFile.endsWith(".lzma", Qt::CaseInsensitive) || xmlFile.endsWith(".xz", Qt::CaseInsensitive)) {
+                xmlFile = xmlFile.left(xmlFile.lastIndexOf("."));
+            }
+            xmlFile = QDir(toDir).absoluteFilePath(xmlFile);
+            if(!QFile::exists(xmlFile)) {
+                connect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &QGCCameraManager::_definitionDownloadComplete);
+                if(_vehicle->ftpManager()->download(static_cast<uint8_t>(download.camera->compID()), download.url, toDir, download.fileName, true, FTPManager::PriorityLow)) {
+                    return;
+                }
+                disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &QGCCameraManager::_definitionDownloadComplete);
+                qCWarning(CameraManagerLog) << "Unable to start camera definition download" << download.url;
+                xmlFile.clear();
+            }
+            QPointer<QGCCameraControl> camera = download.camera;
+            _definitionDownloads.removeFirst();
+            camera->_ftpDownloadComplete(xmlFile, QString());
+        } else {
+            _definitionDownloads.removeFirst();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraManager::_definitionDownloadComplete(const QString& file, const QString& errorMsg)
+{
+    QString toDir = qgcApp()->toolbox()->settingsManager()->appSettings()->parameterSavePath();
+    if(_definitionDownloads.count() && file != FTPManager::downloadFilePath(_definitionDownloads.first().url, toDir, _definitionDownloads.first().fileName)) {
+        //-- Some other queued download
+        return;
+    }
+    disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &QGCCameraManager::_definitionDownloadComplete);
+    if(_definitionDownloads.count()) {
+        QPointer<QGCCameraControl> camera = _definitionDownloads.first().camera;
+        _definitionDownloads.removeFirst();
+        if(camera) {
+            camera->_ftpDownloadComplete(file, errorMsg);
+        }
+    }
+    _startDefinitionDownload();
+}
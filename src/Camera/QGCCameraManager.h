@@ -51,6 +51,10 @@ public:
     //-- Current thermal stream
     virtual QGCVideoStreamInfo* thermalStreamInstance();
 
+    /// Downloads a camera definition file using MAVLink FTP. Downloads for all cameras on the vehicle are queued, at low
+    /// FTP priority so they don't hold up parameters or metadata, and each camera is told when its own file arrives.
+    void downloadDefinitionFile(QGCCameraControl* camera, const QString& url, const QString& fileName);
+
 signals:
     void    camerasChanged          ();
     void    cameraLabelsChanged     ();
@@ -71,6 +75,7 @@ protected slots:
     virtual void    _startVideoRecording    ();
     virtual void    _stopVideoRecording     ();
     virtual void    _toggleVideoRecording   ();
+    virtual void    _definitionDownloadComplete (const QString& file, const QString& errorMsg);
 
 protected:
     virtual QGCCameraControl* _findCamera   (int id);
@@ -85,6 +90,7 @@ protected:
     virtual void    _handleVideoStreamInfo  (const mavlink_message_t& message);
     virtual void    _handleVideoStreamStatus(const mavlink_message_t& message);
     virtual void    _handleBatteryStatus    (const mavlink_message_t& message);
+    void            _startDefinitionDownload();
 
 protected:
 
@@ -109,4 +115,12 @@ protected:
     QElapsedTimer       _lastCameraChange;
     QTimer              _cameraTimer;
     QMap<QString, CameraStruct*> _cameraInfoRequest;
+
+    typedef struct {
+        QPointer<QGCCameraControl>  camera;
+        QString                     url;
+        QString                     fileName;
+    } DefinitionDownload_t;
+
+    QList<DefinitionDownload_t> _definitionDownloads;   ///< First entry is the download in progress
 };
@@ -11,6 +11,7 @@
 
 #include <QFile>
 #include <QDir>
+#include <QBuffer>
 #include <QtDebug>
 
 #include <mutex>
@@ -34,7 +35,24 @@ bool QGCLZMA::inflateLZMAFile(const QString& lzmaFilename, const QString& decomp
         return false;
     }
 
+    return inflateLZMA(inputFile, outputFile);
+}
+
+bool QGCLZMA::inflateLZMAData(const QByteArray& lzmaData, QByteArray& decompressedData)
+{
+    QBuffer inputBuffer;
+    inputBuffer.setData(lzmaData);
+    inputBuffer.open(QIODevice::ReadOnly);
+
+    decompressedData.clear();
+    QBuffer outputBuffer(&decompressedData);
+    outputBuffer.open(QIODevice::WriteOnly);
 
+    return inflateLZMA(inputBuffer, outputBuffer);
+}
+
+bool QGCLZMA::inflateLZMA(QIODevice& input, QIODevice& output)
+{
     std::call_once(crc_init, []() {
         xz_crc32_init();
         xz_crc64_init();
@@ -43,7 +61,7 @@ bool QGCLZMA::inflateLZMAFile(const QString& lzmaFilename, const QString& decomp
 
     xz_dec *s = xz_dec_init(XZ_DYNALLOC, (uint32_t)-1);
     if (s == nullptr) {
-        qWarning() << "QGCLZMA::inflateLZMAFile: Memory allocation failed";
+        qWarning() << "QGCLZMA::inflateLZMA: Memory allocation failed";
         return false;
     }
 
@@ -61,16 +79,17 @@ bool QGCLZMA::inflateLZMAFile(const QString& lzmaFilename, const QString& decomp
 
     while (true) {
         if (b.in_pos == b.in_size) {
-            b.in_size = static_cast<size_t>(inputFile.read((char*)in, sizeof(in)));
+            qint64 cBytesRead = input.read((char*)in, sizeof(in));
+            b.in_size = cBytesRead > 0 ? static_cast<size_t>(cBytesRead) : 0;
             b.in_pos = 0;
         }
 
         xz_ret ret = xz_dec_run(s, &b);
 
         if (b.out_pos == sizeof(out)) {
-            size_t cBytesWritten = (size_t)outputFile.write((char*)out, static_cast<int>(b.out_pos));
+            size_t cBytesWritten = (size_t)output.write((char*)out, static_cast<int>(b.out_pos));
             if (cBytesWritten != b.out_pos) {
-                qWarning() << "QGCLZMA::inflateLZMAFile: output file write failed:" << outputFile.fileName() << outputFile.errorString();
+                qWarning() << "QGCLZMA::inflateLZMA: output write failed:" << output.errorString();
                 goto error;
             }
 
@@ -81,13 +100,13 @@ bool QGCLZMA::inflateLZMAFile(const QString& lzmaFilename, const QString& decomp
             continue;
 
         if (ret == XZ_UNSUPPORTED_CHECK) {
-            qWarning() << "QGCLZMA::inflateLZMAFile: Unsupported check; not verifying file integrity";
+            qWarning() << "QGCLZMA::inflateLZMA: Unsupported check; not verifying file integrity";
             continue;
         }
 
-        size_t cBytesWritten = (size_t)outputFile.write((char*)out, static_cast<int>(b.out_pos));
+        size_t cBytesWritten = (size_t)output.write((char*)out, static_cast<int>(b.out_pos));
         if (cBytesWritten != b.out_pos) {
-            qWarning() << "QGCLZMA::inflateLZMAFile: output file write failed:" << outputFile.fileName() << outputFile.errorString();
+            qWarning() << "QGCLZMA::inflateLZMA: output write failed:" << output.errorString();
             goto error;
         }
 
@@ -97,28 +116,28 @@ bool QGCLZMA::inflateLZMAFile(const QString& lzmaFilename, const QString& decomp
             return true;
 
         case XZ_MEM_ERROR:
-            qWarning() << "QGCLZMA::inflateLZMAFile: Memory allocation failed";
+            qWarning() << "QGCLZMA::inflateLZMA: Memory allocation failed";
             goto error;
 
         case XZ_MEMLIMIT_ERROR:
-            qWarning() << "QGCLZMA::inflateLZMAFile: Memory usage limit reached";
+            qWarning() << "QGCLZMA::inflateLZMA: Memory usage limit reached";
             goto error;
 
         case XZ_FORMAT_ERROR:
-            qWarning() << "QGCLZMA::inflateLZMAFile: Not a .xz file";
+            qWarning() << "QGCLZMA::inflateLZMA: Not a .xz file";
             goto error;
 
         case XZ_OPTIONS_ERROR:
-            qWarning() << "QGCLZMA::inflateLZMAFile: Unsupported options in the .xz headers";
+            qWarning() << "QGCLZMA::inflateLZMA: Unsupported options in the .xz headers";
             goto error;
 
         case XZ_DATA_ERROR:
         case XZ_BUF_ERROR:
-            qWarning() << "QGCLZMA::inflateLZMAFile: File is corrupt";
+            qWarning() << "QGCLZMA::inflateLZMA: File is corrupt";
             goto error;
 
         default:
-            qWarning() << "QGCLZMA::inflateLZMAFile: Bug!";
+            qWarning() << "QGCLZMA::inflateLZMA: Bug!";
             goto error;
         }
     }
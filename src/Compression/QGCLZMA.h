@@ -10,6 +10,9 @@
 #pragma once
 
 #include <QString>
+#include <QByteArray>
+
+class QIODevice;
 
 class QGCLZMA
 {
@@ -18,4 +21,14 @@ public:
     ///     @param lzmaFilename         Fully qualified path to lzma file
     ///     @param decompressedFilename Fully qualified path to for file to decompress to
     static bool inflateLZMAFile(const QString& lzmaFilename, const QString& decompressedFilename);
+
+    /// Decompresses xz/lzma data held in memory
+    ///     @param lzmaData         Compressed data
+    ///     @param decompressedData Set to the decompressed data
+    static bool inflateLZMAData(const QByteArray& lzmaData, QByteArray& decompressedData);
+
+    /// Decompresses from one device to another as the data is read, without staging it in temporary files
+    ///     @param input    Open for reading, positioned at the start of the compressed stream
+    ///     @param output   Open for writing
+    static bool inflateLZMA(QIODevice& input, QIODevice& output);
 };
@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCZipWriter.h"
+
+#include <QDateTime>
+#include <QtDebug>
+
+QGCZipWriter::QGCZipWriter(QIODevice* output, const QString& entryName, QObject* parent)
+    : QIODevice (parent)
+    , _output   (output)
+    , _entryName(entryName.toUtf8())
+{
+    _strm.zalloc    = nullptr;
+    _strm.zfree     = nullptr;
+    _strm.opaque    = nullptr;
+}
+
+QGCZipWriter::~QGCZipWriter()
+{
+    close();
+}
+
+bool QGCZipWriter::open(OpenMode mode)
+{
+    if ((mode & ReadOnly) || !(mode & WriteOnly)) {
+        setErrorString(tr("Zip archives can only be written"));
+        return false;
+    }
+    if (!_output || !_output->isWritable()) {
+        setErrorString(tr("Zip output is not open for writing"));
+        return false;
+    }
+
+    // Raw deflate, zip has its own header and checksum
+    int ret = deflateInit2(&_strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        qWarning() << "QGCZipWriter::open: deflateInit2 failed:" << ret;
+        setErrorString(tr("Compression setup failed"));
+        return false;
+    }
+    _deflateActive      = true;
+    _error              = false;
+    _crc                = static_cast<quint32>(crc32(0, nullptr, 0));
+    _uncompressedSize   = 0;
+    _compressedSize     = 0;
+    _outputSize         = 0;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    _dosTime = static_cast<quint16>((now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2));
+    _dosDate = static_cast<quint16>(((qMax(now.date().year(), 1980) - 1980) << 9) | (now.date().month() << 5) | now.date().day());
+
+    // Local file header, crc and sizes are zero since they are in the data descriptor
+    QByteArray header;
+    _appendUInt32(header, 0x04034b50);
+    _appendUInt16(header, _versionNeeded);
+    _appendUInt16(header, _flags);
+    _appendUInt16(header, _methodDeflate);
+    _appendUInt16(header, _dosTime);
+    _appendUInt16(header, _dosDate);
+    _appendUInt32(header, 0);
+    _appendUInt32(header, 0);
+    _appendUInt32(header, 0);
+    _appendUInt16(header, static_cast<quint16>(_entryName.size()));
+    _appendUInt16(header, 0);
+    header.append(_entryName);
+    if (!_writeOutput(header)) {
+        deflateEnd(&_strm);
+        _deflateActive = false;
+        return false;
+    }
+
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void QGCZipWriter::close(void)
+{
+    if (isOpen()) {
+        finish();
+    }
+}
+
+bool QGCZipWriter::finish(void)
+{
+    if (!isOpen()) {
+        return !_error;
+    }
+
+    if (!_error) {
+        _deflate(nullptr, 0, Z_FINISH);
+    }
+    if (_deflateActive) {
+        deflateEnd(&_strm);
+        _deflateActive = false;
+    }
+    if (!_error && (_uncompressedSize > 0xFFFFFFFFull || _compressedSize > 0xFFFFFFFFull)) {
+        setErrorString(tr("Zip entry is larger than 4GB"));
+        _error = true;
+    }
+
+    if (!_error) {
+        QByteArray trailer;
+
+        // Data descriptor
+        _appendUInt32(trailer, 0x08074b50);
+        _appendUInt32(trailer, _crc);
+        _appendUInt32(trailer, static_cast<quint32>(_compressedSize));
+        _appendUInt32(trailer, static_cast<quint32>(_uncompressedSize));
+
+        // Central directory with the one entry, whose local header is at the start of the archive
+        const quint64 centralDirectoryOffset = _outputSize + static_cast<quint64>(trailer.size());
+        const int     centralDirectoryStart  = trailer.size();
+        _appendUInt32(trailer, 0x02014b50);
+        _appendUInt16(trailer, _versionNeeded);     // Version made by
+        _appendUInt16(trailer, _versionNeeded);
+        _appendUInt16(trailer, _flags);
+        _appendUInt16(trailer, _methodDeflate);
+        _appendUInt16(trailer, _dosTime);
+        _appendUInt16(trailer, _dosDate);
+        _appendUInt32(trailer, _crc);
+        _appendUInt32(trailer, static_cast<quint32>(_compressedSize));
+        _appendUInt32(trailer, static_cast<quint32>(_uncompressedSize));
+        _appendUInt16(trailer, static_cast<quint16>(_entryName.size()));
+        _appendUInt16(trailer, 0);                  // Extra field length
+        _appendUInt16(trailer, 0);                  // Comment length
+        _appendUInt16(trailer, 0);                  // Disk number
+        _appendUInt16(trailer, 0);                  // Internal attributes
+        _appendUInt32(trailer, 0);                  // External attributes
+        _appendUInt32(trailer, 0);                  // Local header offset
+        trailer.append(_entryName);
+        const int centralDirectorySize = trailer.size() - centralDirectoryStart;
+
+        // End of central directory
+        _appendUInt32(trailer, 0x06054b50);
+        _appendUInt16(trailer, 0);
+        _appendUInt16(trailer, 0);
+        _appendUInt16(trailer, 1);
+        _appendUInt16(trailer, 1);
+        _appendUInt32(trailer, static_cast<quint32>(centralDirectorySize));
+        _appendUInt32(trailer, static_cast<quint32>(centralDirectoryOffset));
+        _appendUInt16(trailer, 0);
+
+        _writeOutput(trailer);
+    }
+
+    QIODevice::close();
+    return !_error;
+}
+
+qint64 QGCZipWriter::readData(char* /* data */, qint64 /* maxSize */)
+{
+    return -1;
+}
+
+qint64 QGCZipWriter::writeData(const char* data, qint64 maxSize)
+{
+    if (_error || !_deflate(data, maxSize, Z_NO_FLUSH)) {
+        return -1;
+    }
+    _crc = static_cast<quint32>(crc32(_crc, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(maxSize)));
+    _uncompressedSize += static_cast<quint64>(maxSize);
+    return maxSize;
+}
+
+bool QGCZipWriter::_deflate(const char* data, qint64 size, int flush)
+{
+    unsigned char outputBuffer[_cOutputBuffer];
+
+    _strm.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    _strm.avail_in  = static_cast<uInt>(size);
+
+    do {
+        _strm.next_out  = outputBuffer;
+        _strm.avail_out = _cOutputBuffer;
+
+        int ret = deflate(&_strm, flush);
+        if (ret == Z_STREAM_ERROR) {
+            qWarning() << "QGCZipWriter::_deflate: deflate failed:" << ret;
+            setErrorString(tr("Compression failed"));
+            _error = true;
+            return false;
+        }
+
+        const int cBytesDeflated = _cOutputBuffer - static_cast<int>(_strm.avail_out);
+        if (cBytesDeflated) {
+            if (!_writeOutput(QByteArray::fromRawData(reinterpret_cast<const char*>(outputBuffer), cBytesDeflated))) {
+                return false;
+            }
+            _compressedSize += static_cast<quint64>(cBytesDeflated);
+        }
+    } while (_strm.avail_out == 0);
+
+    return true;
+}
+
+bool QGCZipWriter::_writeOutput(const QByteArray& bytes)
+{
+    if (_output->write(bytes) != bytes.size()) {
+        setErrorString(_output->errorString());
+        _error = true;
+        return false;
+    }
+    _outputSize += static_cast<quint64>(bytes.size());
+    return true;
+}
+
+void QGCZipWriter::_appendUInt16(QByteArray& bytes, quint16 value)
+{
+    bytes.append(static_cast<char>(value & 0xFF));
+    bytes.append(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void QGCZipWriter::_appendUInt32(QByteArray& bytes, quint32 value)
+{
+    _appendUInt16(bytes, static_cast<quint16>(value & 0xFFFF));
+    _appendUInt16(bytes, static_cast<quint16>(value >> 16));
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QIODevice>
+#include <QByteArray>
+
+#include "zlib.h"
+
+/// Writes a zip archive holding a single deflated entry, such as the doc.kml of a KMZ file.
+///
+/// Data written to the device is compressed and passed on to the output as it arrives, so the entry is never held in
+/// memory. Since the sizes are not known up front they follow the entry in a data descriptor. Zip64 is not supported,
+/// entries are limited to 4GB.
+class QGCZipWriter : public QIODevice
+{
+public:
+    /// @param output       Open for writing, the archive is written from its current position
+    /// @param entryName    Name of the single entry within the archive
+    QGCZipWriter(QIODevice* output, const QString& entryName, QObject* parent = nullptr);
+    ~QGCZipWriter();
+
+    /// Writes the archive trailer and closes the device
+    ///     @return false: writing the archive failed, errorString has the reason
+    bool finish(void);
+
+    // Overrides from QIODevice
+    bool open           (OpenMode mode) override;
+    void close          (void) override;
+    bool isSequential   (void) const override { return true; }
+
+protected:
+    // Overrides from QIODevice
+    qint64 readData     (char* data, qint64 maxSize) override;
+    qint64 writeData    (const char* data, qint64 maxSize) override;
+
+private:
+    bool _deflate       (const char* data, qint64 size, int flush);
+    bool _writeOutput   (const QByteArray& bytes);
+    void _appendUInt16  (QByteArray& bytes, quint16 value);
+    void _appendUInt32  (QByteArray& bytes, quint32 value);
+
+    QIODevice*  _output;
+    QByteArray  _entryName;         ///< UTF-8
+    z_stream    _strm;
+    bool        _deflateActive      = false;
+    bool        _error              = false;
+    quint32     _crc                = 0;
+    quint64     _uncompressedSize   = 0;
+    quint64     _compressedSize     = 0;
+    quint64     _outputSize         = 0;    ///< Bytes written to the output so far
+    quint16     _dosTime            = 0;
+    quint16     _dosDate            = 0;
+
+    static const quint16 _flags             = 0x0808;   ///< Sizes in data descriptor, UTF-8 entry name
+    static const quint16 _methodDeflate     = 8;
+    static const quint16 _versionNeeded     = 20;
+    static const int     _cOutputBuffer     = 1024 * 64;
+};
@@ -11,19 +11,13 @@
 
 #include <QFile>
 #include <QDir>
+#include <QBuffer>
 #include <QtDebug>
 
 #include "zlib.h"
 
 bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& decompressedFilename)
 {
-    bool            success                 = true;
-    int             ret;
-    const int       cBuffer                 = 1024 * 5;
-    unsigned char   inputBuffer[cBuffer];
-    unsigned char   outputBuffer[cBuffer];
-    z_stream        strm;
-
     QFile inputFile(gzippedFileName);
     if (!inputFile.open(QIODevice::ReadOnly)) {
         qWarning() << "QGCZlib::inflateGzipFile: open input file failed" << gzippedFileName << inputFile.errorString();
@@ -36,6 +30,31 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
         return false;
     }
 
+    return inflateGzip(inputFile, outputFile);
+}
+
+bool QGCZlib::inflateGzipData(const QByteArray& gzippedData, QByteArray& decompressedData)
+{
+    QBuffer inputBuffer;
+    inputBuffer.setData(gzippedData);
+    inputBuffer.open(QIODevice::ReadOnly);
+
+    decompressedData.clear();
+    QBuffer outputBuffer(&decompressedData);
+    outputBuffer.open(QIODevice::WriteOnly);
+
+    return inflateGzip(inputBuffer, outputBuffer);
+}
+
+bool QGCZlib::inflateGzip(QIODevice& input, QIODevice& output)
+{
+    bool            success                 = true;
+    int             ret;
+    const int       cBuffer                 = 1024 * 5;
+    unsigned char   inputBuffer[cBuffer];
+    unsigned char   outputBuffer[cBuffer];
+    z_stream        strm;
+
     strm.zalloc     = nullptr;
     strm.zfree      = nullptr;
     strm.opaque     = nullptr;
@@ -44,12 +63,13 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
 
     ret = inflateInit2(&strm, 16+MAX_WBITS);
     if (ret != Z_OK) {
-        qWarning() << "QGCZlib::inflateGzipFile: inflateInit2 failed:" << ret;
+        qWarning() << "QGCZlib::inflateGzip: inflateInit2 failed:" << ret;
         goto Error;
     }
 
     do {
-        strm.avail_in = static_cast<unsigned>(inputFile.read((char*)inputBuffer, cBuffer));
+        qint64 cBytesRead = input.read((char*)inputBuffer, cBuffer);
+        strm.avail_in = cBytesRead > 0 ? static_cast<unsigned>(cBytesRead) : 0;
         if (strm.avail_in == 0) {
             break;
         }
@@ -61,14 +81,14 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
 
             ret = inflate(&strm, Z_NO_FLUSH);
             if (ret != Z_OK && ret != Z_STREAM_END) {
-                qWarning() << "QGCZlib::inflateGzipFile: inflate failed:" << ret;
+                qWarning() << "QGCZlib::inflateGzip: inflate failed:" << ret;
                 goto Error;
             }
 
             unsigned cBytesInflated = cBuffer - strm.avail_out;
-            qint64 cBytesWritten = outputFile.write((char*)outputBuffer, static_cast<int>(cBytesInflated));
+            qint64 cBytesWritten = output.write((char*)outputBuffer, static_cast<int>(cBytesInflated));
             if (cBytesWritten != cBytesInflated) {
-                qWarning() << "QGCZlib::inflateGzipFile: output file write failed:" << outputFile.fileName() << outputFile.errorString();
+                qWarning() << "QGCZlib::inflateGzip: output write failed:" << output.errorString();
                 goto Error;
 
             }
@@ -83,3 +103,78 @@ Error:
     success = false;
     goto Out;
 }
+
+bool QGCZlib::deflateGzipFile(const QString& fileName, const QString& gzippedFileName)
+{
+    bool            success                 = true;
+    int             ret;
+    int             flush;
+    const int       cBuffer                 = 1024 * 64;
+    unsigned char*  inputBuffer             = new unsigned char[cBuffer];
+    unsigned char*  outputBuffer            = new unsigned char[cBuffer];
+    z_stream        strm;
+
+    QFile inputFile(fileName);
+    QFile outputFile(gzippedFileName);
+
+    strm.zalloc     = nullptr;
+    strm.zfree      = nullptr;
+    strm.opaque     = nullptr;
+
+    ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16+MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK) {
+        qWarning() << "QGCZlib::deflateGzipFile: deflateInit2 failed:" << ret;
+        delete[] inputBuffer;
+        delete[] outputBuffer;
+        return false;
+    }
+
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "QGCZlib::deflateGzipFile: open input file failed" << fileName << inputFile.errorString();
+        goto Error;
+    }
+
+    if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "QGCZlib::deflateGzipFile: open output file failed" << outputFile.fileName() << outputFile.errorString();
+        goto Error;
+    }
+
+    do {
+        qint64 cBytesRead = inputFile.read((char*)inputBuffer, cBuffer);
+        if (cBytesRead < 0) {
+            qWarning() << "QGCZlib::deflateGzipFile: input file read failed:" << inputFile.fileName() << inputFile.errorString();
+            goto Error;
+        }
+        strm.avail_in   = static_cast<unsigned>(cBytesRead);
+        strm.next_in    = inputBuffer;
+        flush           = inputFile.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+
+        do {
+            strm.avail_out  = cBuffer;
+            strm.next_out   = outputBuffer;
+
+            ret = deflate(&strm, flush);
+            if (ret == Z_STREAM_ERROR) {
+                qWarning() << "QGCZlib::deflateGzipFile: deflate failed:" << ret;
+                goto Error;
+            }
+
+            unsigned cBytesDeflated = cBuffer - strm.avail_out;
+            qint64 cBytesWritten = outputFile.write((char*)outputBuffer, static_cast<int>(cBytesDeflated));
+            if (cBytesWritten != cBytesDeflated) {
+                qWarning() << "QGCZlib::deflateGzipFile: output file write failed:" << outputFile.fileName() << outputFile.errorString();
+                goto Error;
+            }
+        } while (strm.avail_out == 0);
+    } while (flush != Z_FINISH);
+
+Out:
+    deflateEnd(&strm);
+    delete[] inputBuffer;
+    delete[] outputBuffer;
+    return success;
+
+Error:
+    success = false;
+    goto Out;
+}
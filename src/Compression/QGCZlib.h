@@ -10,6 +10,9 @@
 #pragma once
 
 #include <QString>
+#include <QByteArray>
+
+class QIODevice;
 
 class QGCZlib
 {
@@ -18,4 +21,19 @@ public:
     ///     @param gzipFilename         Fully qualified path to gzip file
     ///     @param decompressedFilename Fully qualified path to for file to decompress to
     static bool inflateGzipFile(const QString& gzippedFileName, const QString& decompressedFilename);
+
+    /// Decompresses gzip data held in memory
+    ///     @param gzippedData      Compressed data
+    ///     @param decompressedData Set to the decompressed data
+    static bool inflateGzipData(const QByteArray& gzippedData, QByteArray& decompressedData);
+
+    /// Decompresses from one device to another as the data is read, without staging it in temporary files
+    ///     @param input    Open for reading, positioned at the start of the gzip stream
+    ///     @param output   Open for writing
+    static bool inflateGzip(QIODevice& input, QIODevice& output);
+
+    /// Compresses the specified file to a gzip file
+    ///     @param fileName         Fully qualified path to file to compress
+    ///     @param gzippedFileName  Fully qualified path to gzip file to create
+    static bool deflateGzipFile(const QString& fileName, const QString& gzippedFileName);
 };
@@ -9,15 +9,27 @@
 
 #include "Fact.h"
 #include "FactValueSliderListModel.h"
+#include "FactUpdateScheduler.h"
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
 
 #include <QtQml>
 #include <QQmlEngine>
+#include <QElapsedTimer>
 
 static const char* kMissingMetadata = "Meta data pointer missing";
 
+/// Shared clock for valueChanged rate limits, never returns 0 so 0 can mean never notified
+static qint64 notifyClockMSecs(void)
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) {
+        clock.start();
+    }
+    return clock.elapsed() + 1;
+}
+
 Fact::Fact(QObject* parent)
     : QObject                   (parent)
     , _componentId              (-1)
@@ -79,6 +91,13 @@ Fact::Fact(const Fact& other, QObject* parent)
     _init();
 }
 
+Fact::~Fact()
+{
+    if (_valueChangeScheduled) {
+        FactUpdateScheduler::instance()->cancel(this);
+    }
+}
+
 void Fact::_init(void)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
@@ -93,13 +112,16 @@ const Fact& Fact::operator=(const Fact& other)
     _type                       = other._type;
     _sendValueChangedSignals    = other._sendValueChangedSignals;
     _deferredValueChangeSignal  = other._deferredValueChangeSignal;
+    _deferredSignalRateMSecs    = other._deferredSignalRateMSecs;
     _valueSliderModel           = nullptr;
     _ignoreQGCRebootRequired    = other._ignoreQGCRebootRequired;
+    _defaultNotifyLimits        = other._defaultNotifyLimits;
     if (_metaData && other._metaData) {
         *_metaData = *other._metaData;
     } else {
         _metaData = nullptr;
     }
+    _updateNotifyLimits();
     
     return *this;
 }
@@ -112,7 +134,7 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
+            _sendValueChangedSignal();
             //-- Must be in this order
             emit _containerRawValueChanged(rawValue());
             emit rawValueChanged(_rawValue);
@@ -125,23 +147,34 @@ void Fact::forceSetRawValue(const QVariant& value)
 void Fact::setRawValue(const QVariant& value)
 {
     if (_metaData) {
+        if (value.userType() == FactMetaData::typeToMetaType(_metaData->type())) {
+            // Fast path for C++ telemetry updates which already supply the native type, conversion would be a no-op
+            _setTypedRawValue(value);
+            return;
+        }
+
         QVariant    typedValue;
         QString     errorString;
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            if (typedValue != _rawValue) {
-                _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
-                //-- Must be in this order
-                emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
-            }
+            _setTypedRawValue(typedValue);
         }
     } else {
         qWarning() << kMissingMetadata << name();
     }
 }
 
+void Fact::_setTypedRawValue(const QVariant& typedValue)
+{
+    if (typedValue != _rawValue) {
+        _rawValue = typedValue;
+        _sendValueChangedSignal();
+        //-- Must be in this order
+        emit _containerRawValueChanged(_rawValue);
+        emit rawValueChanged(_rawValue);
+    }
+}
+
 void Fact::setCookedValue(const QVariant& value)
 {
     if (_metaData) {
@@ -181,7 +214,7 @@ void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
+        _sendValueChangedSignal();
         emit rawValueChanged(_rawValue);
     }
 
@@ -580,10 +613,11 @@ QString Fact::group(void) const
 void Fact::setMetaData(FactMetaData* metaData, bool setDefaultFromMetaData)
 {
     _metaData = metaData;
+    _updateNotifyLimits();
     if (setDefaultFromMetaData && metaData->defaultValueAvailable()) {
         setRawValue(rawDefaultValue());
     }
-    emit valueChanged(cookedValue());
+    _emitValueChanged();
 }
 
 bool Fact::valueEqualsDefault(void) const
@@ -671,13 +705,84 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+void Fact::setDefaultNotifyLimits(bool defaultNotifyLimits)
+{
+    if (defaultNotifyLimits != _defaultNotifyLimits) {
+        _defaultNotifyLimits = defaultNotifyLimits;
+        _updateNotifyLimits();
+    }
+}
+
+void Fact::_updateNotifyLimits(void)
 {
+    _notifyRawDeadband      = 0;
+    _notifyMinIntervalMSecs = 0;
+
+    if (_metaData) {
+        double deadband = _metaData->rawNotifyDeadband();
+        if (qIsNaN(deadband)) {
+            // Parameters and settings must see every change, only telemetry gets a deadband without asking for one
+            deadband = _defaultNotifyLimits ? _metaData->rawDisplayPrecisionDeadband() : 0;
+        }
+        _notifyRawDeadband = deadband;
+        if (_metaData->maxNotifyRate() > 0) {
+            _notifyMinIntervalMSecs = qMax(1, qRound(1000.0 / _metaData->maxNotifyRate()));
+        }
+    }
+}
+
+/// @return true: value moved far enough from the last notified value to be worth a valueChanged signal
+bool Fact::_outsideNotifyDeadband(void) const
+{
+    if (_notifyRawDeadband <= 0) {
+        return true;
+    }
+
+    bool ok;
+    const double value = _rawValue.toDouble(&ok);
+    if (!ok) {
+        return true;
+    }
+    if (qIsNaN(value) || qIsNaN(_lastNotifiedRawValue)) {
+        return qIsNaN(value) != qIsNaN(_lastNotifiedRawValue);
+    }
+    return qAbs(value - _lastNotifiedRawValue) >= _notifyRawDeadband;
+}
+
+void Fact::_emitValueChanged(void)
+{
+    if (_notifyRawDeadband > 0) {
+        bool ok;
+        const double value = _rawValue.toDouble(&ok);
+        _lastNotifiedRawValue = ok ? value : std::numeric_limits<double>::quiet_NaN();
+    }
+    if (_notifyMinIntervalMSecs > 0) {
+        _lastNotifiedMSecs = notifyClockMSecs();
+    }
+    emit valueChanged(cookedValue());
+}
+
+/// The cooked value is only calculated when the signal is actually sent, deferred signals don't pay for it
+void Fact::_sendValueChangedSignal(void)
+{
+    if (!_outsideNotifyDeadband()) {
+        return;
+    }
+
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
+        if (_notifyMinIntervalMSecs > 0 && _lastNotifiedMSecs != 0 && notifyClockMSecs() - _lastNotifiedMSecs < _notifyMinIntervalMSecs) {
+            // Too soon after the last signal, the latest value goes out with the next scheduler batch
+            _deferredValueChangeSignal = true;
+            FactUpdateScheduler::instance()->schedule(this, _notifyMinIntervalMSecs);
+            return;
+        }
+        _emitValueChanged();
         _deferredValueChangeSignal = false;
     } else {
         _deferredValueChangeSignal = true;
+        if (_deferredSignalRateMSecs > 0) {
+            FactUpdateScheduler::instance()->schedule(this, _deferredSignalRateMSecs);
+        }
     }
 }
 
@@ -685,7 +790,10 @@ void Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        // The value may have wandered back to the last notified one since it was deferred
+        if (_outsideNotifyDeadband()) {
+            _emitValueChanged();
+        }
     }
 }
 
@@ -23,6 +23,8 @@ class FactValueSliderListModel;
 class Fact : public QObject
 {
     Q_OBJECT
+
+    friend class FactUpdateScheduler;
     
 public:
     Fact(QObject* parent = nullptr);
@@ -33,6 +35,8 @@ public:
     /// custom builds to override the metadata.
     Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent = nullptr);
 
+    ~Fact();
+
     const Fact& operator=(const Fact& other);
 
     Q_PROPERTY(int          componentId             READ componentId                                        CONSTANT)
@@ -151,6 +155,14 @@ public:
     void clearDeferredValueChangeSignal(void) { _deferredValueChangeSignal = false; }
     void sendDeferredValueChangedSignal(void);
 
+    /// Deferred signals are sent by FactUpdateScheduler at no more than this rate, 0: only sent by calling
+    /// sendDeferredValueChangedSignal
+    void setDeferredSignalRateMSecs (int rateMSecs) { _deferredSignalRateMSecs = rateMSecs; }
+
+    /// true: valueChanged is not sent for changes below display precision unless the meta data specifies its own
+    /// notifyDeadband. Meant for telemetry, used by FactGroup. Limits given in the meta data always apply.
+    void setDefaultNotifyLimits     (bool defaultNotifyLimits);
+
     // C++ methods
 
     /// Sets and sends new value to vehicle even if value is the same
@@ -200,7 +212,11 @@ private:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    void _setTypedRawValue      (const QVariant& typedValue);
+    void _updateNotifyLimits    (void);
+    bool _outsideNotifyDeadband (void) const;
+    void _emitValueChanged      (void);
 
     QString                     _name;
     int                         _componentId;
@@ -209,6 +225,13 @@ protected:
     FactMetaData*               _metaData;
     bool                        _sendValueChangedSignals;
     bool                        _deferredValueChangeSignal;
+    int                         _deferredSignalRateMSecs    = 0;
+    bool                        _valueChangeScheduled       = false;    ///< Fact is on a FactUpdateScheduler dirty list
+    bool                        _defaultNotifyLimits        = false;
+    double                      _notifyRawDeadband          = 0;        ///< valueChanged is not sent for smaller changes, 0: every change
+    int                         _notifyMinIntervalMSecs     = 0;        ///< valueChanged is sent at most this often, 0: no limit
+    double                      _lastNotifiedRawValue       = std::numeric_limits<double>::quiet_NaN();
+    qint64                      _lastNotifiedMSecs          = 0;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
 };
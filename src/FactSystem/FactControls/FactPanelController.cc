@@ -62,8 +62,9 @@ bool FactPanelController::_allParametersExists(int componentId, QStringList name
 
 Fact* FactPanelController::getParameterFact(int componentId, const QString& name, bool reportMissing)
 {
-    if (_vehicle && _vehicle->parameterManager()->parameterExists(componentId, name)) {
-        Fact* fact = _vehicle->parameterManager()->getParameter(componentId, name);
+    const int handle = _vehicle ? _vehicle->parameterManager()->parameterHandle(componentId, name) : -1;
+    if (handle != -1) {
+        Fact* fact = _vehicle->parameterManager()->parameterForHandle(handle);
         QQmlEngine::setObjectOwnership(fact, QQmlEngine::CppOwnership);
         return fact;
     } else {
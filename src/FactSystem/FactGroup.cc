@@ -10,6 +10,7 @@
 
 #include "FactGroup.h"
 #include "JsonHelper.h"
+#include "QGCTrace.h"
 
 #include <QJsonDocument>
 #include <QJsonParseError>
@@ -23,8 +24,8 @@ FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject*
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
-    _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
+    // Metadata is the same for each instance, for example the groups of each vehicle
+    _nameToFactMetaDataMap = FactMetaData::sharedMapFromJsonFile(metaDataFile);
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
@@ -33,7 +34,6 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
@@ -43,16 +43,6 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
 }
 
-void FactGroup::_setupTimer()
-{
-    if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
-    }
-}
-
 bool FactGroup::factExists(const QString& name)
 {
     if (name.contains(".")) {
@@ -129,7 +119,8 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
         return;
     }
 
-    fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    _setFactUpdateMode(fact);
+    fact->setDefaultNotifyLimits(true);
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -147,34 +138,64 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
     }
 
     _nameToFactGroupMap[name] = factGroup;
+    if (_parked) {
+        factGroup->setParked(true);
+    }
 
     emit factGroupNamesChanged();
 }
 
 void FactGroup::_updateAllValues(void)
 {
+    QGC_TRACE_SCOPE("FactGroup::_updateAllValues");
+
     for(Fact* fact: _nameToFactMap) {
         fact->sendDeferredValueChangedSignal();
     }
 }
 
+/// Rate limited Facts have their valueChanged signals batched by FactUpdateScheduler. Parked Facts only remember
+/// that they changed so they cost nothing until the group is unparked.
+void FactGroup::_setFactUpdateMode(Fact* fact)
+{
+    bool sendImmediately = !_parked && (_updateRateMSecs == 0 || _liveUpdates);
+
+    fact->setSendValueChangedSignals(sendImmediately);
+    fact->setDeferredSignalRateMSecs(_parked || sendImmediately ? 0 : _updateRateMSecs);
+}
+
+void FactGroup::_updateFactUpdateModes(void)
+{
+    for(Fact* fact: _nameToFactMap) {
+        _setFactUpdateMode(fact);
+    }
+    if (!_parked) {
+        // Bring the ui up to date with changes which happened while signals were held back
+        _updateAllValues();
+    }
+}
+
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0 || liveUpdates == _liveUpdates) {
         return;
     }
 
-    if (liveUpdates) {
-        _updateTimer.stop();
-    } else {
-        _updateTimer.start();
+    _liveUpdates = liveUpdates;
+    _updateFactUpdateModes();
+}
+
+void FactGroup::setParked(bool parked)
+{
+    if (parked != _parked) {
+        _parked = parked;
+        _updateFactUpdateModes();
     }
-    for(Fact* fact: _nameToFactMap) {
-        fact->setSendValueChangedSignals(liveUpdates);
+    for(FactGroup* factGroup: _nameToFactGroupMap) {
+        factGroup->setParked(parked);
     }
 }
 
-
 QString FactGroup::_camelCase(const QString& text)
 {
     return text[0].toLower() + text.right(text.length() - 1);
@@ -46,23 +46,30 @@ public:
     /// Turning on live updates will allow value changes to flow through as they are received.
     Q_INVOKABLE void setLiveUpdates(bool liveUpdates);
 
+    /// A parked group, and its child groups, keeps values up to date but sends no value changed signals until it
+    /// is unparked. Use while nothing in the ui is showing the group.
+    Q_INVOKABLE void setParked(bool parked);
+
     QStringList factNames           (void) const { return _factNames; }
     QStringList factGroupNames      (void) const { return _nameToFactGroupMap.keys(); }
     bool        telemetryAvailable  (void) const { return _telemetryAvailable; }
+    bool        parked              (void) const { return _parked; }
     const QMap<QString, FactGroup*>& factGroups() const { return _nameToFactGroupMap; }
 
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
+    /// @return Message ids which handleMessage consumes. Vehicle only routes these messages to the group, so a group
+    ///         which overrides handleMessage must also override this.
+    virtual QList<uint32_t> handledMessageIds(void) const { return QList<uint32_t>(); }
+
 signals:
     void factNamesChanged           (void);
     void factGroupNamesChanged      (void);
     void telemetryAvailableChanged  (bool telemetryAvailable);
 
-protected slots:
-    virtual void _updateAllValues(void);
-
 protected:
+    void _updateAllValues       (void);
     void _addFact               (Fact* fact, const QString& name);
     void _addFactGroup          (FactGroup* factGroup, const QString& name);
     void _loadFromJsonArray     (const QJsonArray jsonArray);
@@ -76,10 +83,12 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    void    _setFactUpdateMode      (Fact* fact);
+    void    _updateFactUpdateModes  (void);
+    QString _camelCase              (const QString& text);
 
     bool    _ignoreCamelCase    = false;
-    QTimer  _updateTimer;
+    bool    _liveUpdates        = false;
+    bool    _parked             = false;
     bool    _telemetryAvailable = false;
 };
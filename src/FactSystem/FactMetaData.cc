@@ -16,6 +16,7 @@
 #include <QtMath>
 #include <QJsonParseError>
 #include <QJsonArray>
+#include <QHash>
 
 #include <limits>
 #include <cmath>
@@ -145,6 +146,8 @@ const char* FactMetaData::_rebootRequiredJsonKey =      "rebootRequired";
 const char* FactMetaData::_categoryJsonKey =            "category";
 const char* FactMetaData::_groupJsonKey =               "group";
 const char* FactMetaData::_volatileJsonKey =            "volatile";
+const char* FactMetaData::_notifyDeadbandJsonKey =      "notifyDeadband";
+const char* FactMetaData::_maxNotifyRateJsonKey =       "maxNotifyRate";
 
 FactMetaData::FactMetaData(QObject* parent)
     : QObject               (parent)
@@ -255,6 +258,8 @@ const FactMetaData& FactMetaData::operator=(const FactMetaData& other)
     _readOnly               = other._readOnly;
     _writeOnly              = other._writeOnly;
     _volatile               = other._volatile;
+    _rawNotifyDeadband      = other._rawNotifyDeadband;
+    _maxNotifyRate          = other._maxNotifyRate;
     return *this;
 }
 
@@ -994,6 +999,38 @@ size_t FactMetaData::typeToSize(ValueType_t type)
     }
 }
 
+int FactMetaData::typeToMetaType(ValueType_t type)
+{
+    switch (type) {
+    case valueTypeInt8:
+    case valueTypeInt16:
+    case valueTypeInt32:
+        return QMetaType::Int;
+    case valueTypeInt64:
+        return QMetaType::LongLong;
+    case valueTypeUint8:
+    case valueTypeUint16:
+    case valueTypeUint32:
+        return QMetaType::UInt;
+    case valueTypeUint64:
+        return QMetaType::ULongLong;
+    case valueTypeFloat:
+        return QMetaType::Float;
+    case valueTypeElapsedTimeInSeconds:
+    case valueTypeDouble:
+        return QMetaType::Double;
+    case valueTypeString:
+        return QMetaType::QString;
+    case valueTypeBool:
+        return QMetaType::Bool;
+    case valueTypeCustom:
+        return QMetaType::QByteArray;
+    }
+
+    // Make windows compiler happy, even switch is full cased
+    return QMetaType::UnknownType;
+}
+
 /// Set translators according to app settings
 void FactMetaData::_setAppSettingsTranslators(void)
 {
@@ -1255,6 +1292,21 @@ int FactMetaData::decimalPlaces(void) const
     return actualDecimalPlaces;
 }
 
+double FactMetaData::rawDisplayPrecisionDeadband(void) const
+{
+    if ((_type != valueTypeFloat && _type != valueTypeDouble) || !_enumValues.isEmpty()) {
+        return 0;
+    }
+
+    // Half of the last displayed digit in cooked units, taken back to raw units through the slope of the translator
+    const double cookedDeadband = 0.5 * qPow(10.0, -decimalPlaces());
+    const double cookedPerRaw   = qAbs(_rawTranslator(1.0).toDouble() - _rawTranslator(0.0).toDouble());
+    if (qIsNaN(cookedPerRaw) || cookedPerRaw == 0) {
+        return 0;
+    }
+    return cookedDeadband / cookedPerRaw;
+}
+
 FactMetaData* FactMetaData::createFromJsonObject(const QJsonObject& json, QMap<QString, QString>& defineMap, QObject* metaDataParent)
 {
     QString         errorString;
@@ -1274,6 +1326,8 @@ FactMetaData* FactMetaData::createFromJsonObject(const QJsonObject& json, QMap<Q
         { _categoryJsonKey,             QJsonValue::String, false },
         { _groupJsonKey,                QJsonValue::String, false },
         { _volatileJsonKey,             QJsonValue::Bool,   false },
+        { _notifyDeadbandJsonKey,       QJsonValue::Double, false },
+        { _maxNotifyRateJsonKey,        QJsonValue::Double, false },
         { _enumBitmaskArrayJsonKey,     QJsonValue::Array,  false },
         { _enumValuesArrayJsonKey,      QJsonValue::Array,  false },
         { _enumValuesJsonKey,           QJsonValue::String, false },
@@ -1439,6 +1493,13 @@ FactMetaData* FactMetaData::createFromJsonObject(const QJsonObject& json, QMap<Q
     }
     metaData->setVolatileValue(volatileValue);
 
+    if (json.contains(_notifyDeadbandJsonKey)) {
+        metaData->setRawNotifyDeadband(qMax(0.0, json[_notifyDeadbandJsonKey].toDouble()));
+    }
+    if (json.contains(_maxNotifyRateJsonKey)) {
+        metaData->setMaxNotifyRate(qMax(0.0, json[_maxNotifyRateJsonKey].toDouble()));
+    }
+
     if (json.contains(_groupJsonKey)) {
         metaData->setGroup(json[_groupJsonKey].toString());
     }
@@ -1488,6 +1549,17 @@ QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonFile(const QString&
     return createMapFromJsonArray(factArray, defineMap, metaDataParent);
 }
 
+const QMap<QString, FactMetaData*>& FactMetaData::sharedMapFromJsonFile(const QString& jsonFilename)
+{
+    static QHash<QString, QMap<QString, FactMetaData*>> sharedMaps;
+
+    auto iter = sharedMaps.find(jsonFilename);
+    if (iter == sharedMaps.end()) {
+        iter = sharedMaps.insert(jsonFilename, createMapFromJsonFile(jsonFilename, nullptr /* metaDataParent */));
+    }
+    return iter.value();
+}
+
 QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonArray(const QJsonArray jsonArray, QMap<QString, QString>& defineMap, QObject* metaDataParent)
 {
     QMap<QString, FactMetaData*> metaDataMap;
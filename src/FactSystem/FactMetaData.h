@@ -14,6 +14,8 @@
 #include <QVariant>
 #include <QJsonObject>
 
+#include <limits>
+
 /// Holds the meta data associated with a Fact.
 ///
 /// Holds the meta data associated with a Fact. This is kept in a separate object from the Fact itself
@@ -57,6 +59,10 @@ public:
     typedef QMap<QString, QString> DefineMap_t;
 
     static QMap<QString, FactMetaData*> createMapFromJsonFile(const QString& jsonFilename, QObject* metaDataParent);
+
+    /// Same as createMapFromJsonFile except that the file is only parsed the first time. All callers share the same
+    /// FactMetaData objects, which live until the application exits. Must only be called from the gui thread.
+    static const QMap<QString, FactMetaData*>& sharedMapFromJsonFile(const QString& jsonFilename);
     static QMap<QString, FactMetaData*> createMapFromJsonArray(const QJsonArray jsonArray, DefineMap_t& defineMap, QObject* metaDataParent);
 
     static FactMetaData* createFromJsonObject(const QJsonObject& json, QMap<QString, QString>& defineMap, QObject* metaDataParent);
@@ -134,6 +140,15 @@ public:
     bool            writeOnly               (void) const { return _writeOnly; }
     bool            volatileValue           (void) const { return _volatile; }
 
+    /// Changes in raw value smaller than this do not send valueChanged. NaN: not specified, Fact derives it from
+    /// decimalPlaces where allowed (see Fact::setDefaultNotifyLimits).
+    double          rawNotifyDeadband       (void) const { return _rawNotifyDeadband; }
+    /// Maximum rate in Hz at which valueChanged is sent, 0: not limited
+    double          maxNotifyRate           (void) const { return _maxNotifyRate; }
+
+    /// @return Raw value change which is half of the least significant displayed digit, 0 for non floating point types
+    double          rawDisplayPrecisionDeadband(void) const;
+
     /// Amount to increment value when used in controls such as spin button or slider with detents.
     /// NaN for no increment available.
     double          rawIncrement            (void) const { return _rawIncrement; }
@@ -170,6 +185,8 @@ public:
     void setReadOnly                (bool bValue)                       { _readOnly = bValue; }
     void setWriteOnly               (bool bValue)                       { _writeOnly = bValue; }
     void setVolatileValue           (bool bValue);
+    void setRawNotifyDeadband       (double deadband)                   { _rawNotifyDeadband = deadband; }
+    void setMaxNotifyRate           (double rateHz)                     { _maxNotifyRate = rateHz; }
 
     void setTranslators(Translator rawTranslator, Translator cookedTranslator);
 
@@ -206,6 +223,9 @@ public:
     static QString typeToString(ValueType_t type);
     static size_t typeToSize(ValueType_t type);
 
+    /// @return QMetaType id of the QVariant produced by convertAndValidateRaw for this type
+    static int typeToMetaType(ValueType_t type);
+
     static const char* qgcFileType;
 
 private:
@@ -330,6 +350,8 @@ private:
     bool            _readOnly;
     bool            _writeOnly;
     bool            _volatile;
+    double          _rawNotifyDeadband  = std::numeric_limits<double>::quiet_NaN();
+    double          _maxNotifyRate      = 0;
     CustomCookedValidator _customCookedValidator = nullptr;
 
     // Exact conversion constants
@@ -375,6 +397,8 @@ private:
     static const char* _categoryJsonKey;
     static const char* _groupJsonKey;
     static const char* _volatileJsonKey;
+    static const char* _notifyDeadbandJsonKey;
+    static const char* _maxNotifyRateJsonKey;
     static const char* _enumStringsJsonKey;
     static const char* _enumValuesJsonKey;
     static const char* _enumValuesArrayJsonKey;
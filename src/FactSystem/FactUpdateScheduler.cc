@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactUpdateScheduler.h"
+#include "Fact.h"
+#include "QGCTrace.h"
+
+#include <limits>
+
+FactUpdateScheduler* FactUpdateScheduler::instance(void)
+{
+    static FactUpdateScheduler scheduler;
+    return &scheduler;
+}
+
+FactUpdateScheduler::FactUpdateScheduler(void)
+{
+    _timer.setSingleShot(true);
+    connect(&_timer, &QTimer::timeout, this, &FactUpdateScheduler::_flush);
+    _clock.start();
+}
+
+FactUpdateScheduler::~FactUpdateScheduler()
+{
+    // Facts which outlive the scheduler must not call back into it
+    for (const DirtyList_t& dirtyList: _dirtyLists) {
+        for (Fact* fact: dirtyList.facts) {
+            fact->_valueChangeScheduled = false;
+        }
+    }
+}
+
+void FactUpdateScheduler::schedule(Fact* fact, int updateRateMSecs)
+{
+    if (fact->_valueChangeScheduled) {
+        return;
+    }
+    fact->_valueChangeScheduled = true;
+
+    DirtyList_t& dirtyList = _dirtyLists[updateRateMSecs];
+    if (dirtyList.facts.isEmpty()) {
+        dirtyList.dueMSecs = _clock.elapsed() + updateRateMSecs;
+        _startTimer();
+    }
+    dirtyList.facts.append(fact);
+}
+
+void FactUpdateScheduler::cancel(Fact* fact)
+{
+    if (!fact->_valueChangeScheduled) {
+        return;
+    }
+    fact->_valueChangeScheduled = false;
+
+    for (DirtyList_t& dirtyList: _dirtyLists) {
+        if (dirtyList.facts.removeOne(fact)) {
+            return;
+        }
+    }
+    int index = _flushing.indexOf(fact);
+    if (index != -1) {
+        _flushing[index] = nullptr;
+    }
+}
+
+void FactUpdateScheduler::_flush(void)
+{
+    QGC_TRACE_SCOPE("FactUpdateScheduler::_flush");
+
+    qint64 nowMSecs = _clock.elapsed();
+
+    for (auto iter = _dirtyLists.begin(); iter != _dirtyLists.end(); iter++) {
+        DirtyList_t& dirtyList = iter.value();
+        if (dirtyList.facts.isEmpty() || dirtyList.dueMSecs > nowMSecs) {
+            continue;
+        }
+
+        // Signal handlers may change values, which schedules new signals, or destroy Facts which are still waiting.
+        // So the batch is moved out of the dirty list first and cancel clears destroyed entries from it.
+        _flushing.swap(dirtyList.facts);
+        for (int i=0; i<_flushing.count(); i++) {
+            Fact* fact = _flushing[i];
+            if (fact) {
+                fact->_valueChangeScheduled = false;
+                fact->sendDeferredValueChangedSignal();
+            }
+        }
+        _flushing.clear();
+    }
+
+    _startTimer();
+}
+
+/// Starts the timer for the earliest dirty list which is due
+void FactUpdateScheduler::_startTimer(void)
+{
+    qint64 dueMSecs = std::numeric_limits<qint64>::max();
+
+    for (const DirtyList_t& dirtyList: _dirtyLists) {
+        if (!dirtyList.facts.isEmpty()) {
+            dueMSecs = qMin(dueMSecs, dirtyList.dueMSecs);
+        }
+    }
+
+    if (dueMSecs == std::numeric_limits<qint64>::max()) {
+        _timer.stop();
+    } else {
+        _timer.start(static_cast<int>(qMax(0ll, dueMSecs - _clock.elapsed())));
+    }
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QMap>
+#include <QVector>
+#include <QElapsedTimer>
+
+class Fact;
+
+/// Sends the deferred valueChanged signals of rate limited Facts (FactGroup members for example).
+///
+/// Facts which changed are kept in a dirty list per update rate, and each list is flushed in a single batch once
+/// its rate interval has elapsed. A single timer is shared by all Facts of all vehicles and it only runs while
+/// something is waiting to be sent. Facts which did not change since the last batch are never visited. Main thread
+/// only.
+class FactUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static FactUpdateScheduler* instance(void);
+
+    /// Queues the deferred valueChanged signal for the Fact
+    ///     @param updateRateMSecs Maximum rate at which the signal is sent
+    void schedule(Fact* fact, int updateRateMSecs);
+
+    /// Removes the Fact from the dirty lists, for example because it is being destroyed
+    void cancel(Fact* fact);
+
+private slots:
+    void _flush(void);
+
+private:
+    FactUpdateScheduler(void);
+    ~FactUpdateScheduler();
+
+    void _startTimer(void);
+
+    typedef struct {
+        QVector<Fact*>  facts;
+        qint64          dueMSecs;
+    } DirtyList_t;
+
+    QMap<int, DirtyList_t>  _dirtyLists;    ///< Keyed by update rate
+    QVector<Fact*>          _flushing;      ///< Batch currently being sent
+    QTimer                  _timer;
+    QElapsedTimer           _clock;
+};
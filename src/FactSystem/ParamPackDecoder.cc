@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParamPackDecoder.h"
+#include "ParameterManager.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+ParamPackDecoder::ParamPackDecoder(void)
+{
+    reset();
+}
+
+void ParamPackDecoder::reset(void)
+{
+    _buffer.clear();
+    _position       = 0;
+    _headerReceived = false;
+    _error          = false;
+    _paramCount     = 0;
+    _decodedCount   = 0;
+    memset(_nameBuffer, 0, sizeof(_nameBuffer));
+}
+
+bool ParamPackDecoder::addData(const QByteArray& data, QList<Param_t>& params)
+{
+    if (_error) {
+        return false;
+    }
+
+    _buffer.append(data);
+
+    if (!_headerReceived && !_decodeHeader()) {
+        return !_error;
+    }
+
+    while (!_error && _decodedCount < _paramCount) {
+        Param_t param;
+        int     consumed = _decodeRecord(param);
+        if (consumed == 0) {
+            // Need more data
+            break;
+        }
+        if (consumed > 0) {
+            _position += consumed;
+            _decodedCount++;
+            params.append(param);
+        }
+    }
+
+    // Drop what has been decoded so the buffer only holds a partial record
+    _buffer.remove(0, _position);
+    _position = 0;
+
+    return !_error;
+}
+
+bool ParamPackDecoder::_decodeHeader(void)
+{
+    if (_buffer.size() < _headerSize) {
+        return false;
+    }
+
+    const uchar* bytes = reinterpret_cast<const uchar*>(_buffer.constData());
+    quint16 magic       = qFromLittleEndian<quint16>(&bytes[0]);
+    quint16 numParams   = qFromLittleEndian<quint16>(&bytes[2]);
+    quint16 totalParams = qFromLittleEndian<quint16>(&bytes[4]);
+
+    qCDebug(ParameterManagerVerbose2Log) << "ParamPackDecoder: magic: 0x" << Qt::hex << magic;
+    qCDebug(ParameterManagerVerbose2Log) << "ParamPackDecoder: num_params:" << numParams << " total_params:" << totalParams;
+
+    if (magic != _magicStandard && magic != _magicWithDefaults) {
+        qCDebug(ParameterManagerLog) << "ParamPackDecoder: Error: File does not start with Magic";
+        _error = true;
+        return false;
+    }
+    if (numParams != totalParams) {
+        /* We requested all parameters, so this is an error here */
+        qCDebug(ParameterManagerLog) << "ParamPackDecoder: Error: total_params != num_params";
+        _error = true;
+        return false;
+    }
+
+    _headerReceived = true;
+    _paramCount     = numParams;
+    _position       = _headerSize;
+
+    return true;
+}
+
+/// @return Number of bytes used by the record, 0: record is not complete yet, -1: error
+int ParamPackDecoder::_decodeRecord(Param_t& param)
+{
+    enum ap_var_type {
+        AP_PARAM_NONE    = 0,
+        AP_PARAM_INT8,
+        AP_PARAM_INT16,
+        AP_PARAM_INT32,
+        AP_PARAM_FLOAT,
+        AP_PARAM_VECTOR3F,
+        AP_PARAM_GROUP
+    };
+
+    const uchar*    bytes       = reinterpret_cast<const uchar*>(_buffer.constData()) + _position;
+    int             available   = _buffer.size() - _position;
+    int             index       = 0;
+
+    // Eat padding bytes
+    while (index < available && bytes[index] == 0) {
+        index++;
+    }
+    if (index + 2 > available) {
+        return 0;
+    }
+
+    quint8  ptype       = bytes[index] & 0x0F;
+    quint8  flags       = (bytes[index] >> 4) & 0x0F;
+    bool    withDefault = (flags & 0x01) == 0x01;
+    quint8  nameLen     = ((bytes[index + 1] >> 4) & 0x0F) + 1;
+    quint8  commonLen   = bytes[index + 1] & 0x0F;
+    index += 2;
+
+    if ((nameLen + commonLen) > 16) {
+        qCritical(ParameterManagerLog) << "ParamPackDecoder: Error: common_len + name_len > 16 "
+                                       << "name_len" << nameLen
+                                       << "common_len" << commonLen;
+        _error = true;
+        return -1;
+    }
+
+    int valueSize;
+    switch (static_cast<ap_var_type>(ptype)) {
+    case AP_PARAM_INT8:
+        valueSize = 1;
+        param.type = FactMetaData::valueTypeInt8;
+        break;
+    case AP_PARAM_INT16:
+        valueSize = 2;
+        param.type = FactMetaData::valueTypeInt16;
+        break;
+    case AP_PARAM_INT32:
+        valueSize = 4;
+        param.type = FactMetaData::valueTypeInt32;
+        break;
+    case AP_PARAM_FLOAT:
+        valueSize = 4;
+        param.type = FactMetaData::valueTypeFloat;
+        break;
+    default:
+        qCDebug(ParameterManagerLog) << "ParamPackDecoder: Error: type is out of range" << ptype;
+        _error = true;
+        return -1;
+    }
+
+    int recordEnd = index + nameLen + valueSize * (withDefault ? 2 : 1);
+    if (recordEnd > available) {
+        return 0;
+    }
+
+    memcpy(&_nameBuffer[commonLen], &bytes[index], nameLen);
+    _nameBuffer[commonLen + nameLen] = '\0';
+    param.name = QString(_nameBuffer);
+    index += nameLen;
+
+    // The default value which may follow is not used
+    switch (param.type) {
+    case FactMetaData::valueTypeInt8:
+        param.value = static_cast<qint8>(bytes[index]);
+        break;
+    case FactMetaData::valueTypeInt16:
+        param.value = qFromLittleEndian<qint16>(&bytes[index]);
+        break;
+    case FactMetaData::valueTypeInt32:
+        param.value = qFromLittleEndian<qint32>(&bytes[index]);
+        break;
+    default:
+    {
+        qint32  data32 = qFromLittleEndian<qint32>(&bytes[index]);
+        float   dfloat;
+        memcpy(&dfloat, &data32, 4);
+        param.value = dfloat;
+        break;
+    }
+    }
+
+    qCDebug(ParameterManagerVerbose2Log) << "ParamPackDecoder: parameter" << param.name
+                                         << "name_len" << nameLen
+                                         << "common_len" << commonLen
+                                         << "ptype" << ptype
+                                         << "flags" << flags
+                                         << "paramValue" << param.value;
+
+    return recordEnd;
+}
@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactMetaData.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QList>
+
+/// Incremental decoder for the ArduPilot @PARAM/param.pck parameter file.
+///
+/// Bytes are fed as they arrive from MAVLink FTP, in file order, and every complete record is decoded right away.
+/// That way parameters become available during the download rather than after the whole file has been received.
+class ParamPackDecoder
+{
+public:
+    ParamPackDecoder(void);
+
+    typedef struct {
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    value;
+    } Param_t;
+
+    void reset(void);
+
+    /// Decodes all complete records
+    ///     @param data     Next block of the file, must directly follow the previous block
+    ///     @param params   Decoded parameters are appended here
+    /// @return false: file is corrupt, no further data is accepted
+    bool addData(const QByteArray& data, QList<Param_t>& params);
+
+    bool    headerReceived  (void) const { return _headerReceived; }
+    bool    error           (void) const { return _error; }
+    int     paramCount      (void) const { return _paramCount; }    ///< Number of parameters in the file, once the header is received
+    int     decodedCount    (void) const { return _decodedCount; }
+    bool    complete        (void) const { return _headerReceived && _decodedCount == _paramCount; }
+
+private:
+    bool _decodeHeader(void);
+    int  _decodeRecord(Param_t& param);
+
+    QByteArray  _buffer;                ///< Received bytes which have not been decoded yet
+    int         _position;
+    bool        _headerReceived;
+    bool        _error;
+    int         _paramCount;
+    int         _decodedCount;
+    char        _nameBuffer[17];        ///< Names share a common prefix with the previous name
+
+    static const quint16 _magicStandard     = 0x671B;
+    static const quint16 _magicWithDefaults = 0x671C;
+    static const int     _headerSize        = 6;
+};
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheFile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QSaveFile>
+
+#include <cstring>
+
+const char* ParameterCacheFile::_magic = "QGCPCACH";
+
+bool ParameterCacheFile::typeSupported(FactMetaData::ValueType_t type)
+{
+    int metaType = FactMetaData::typeToMetaType(type);
+
+    switch (metaType) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+    case QMetaType::Bool:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ParameterCacheFile::write(const QString& filename, const QList<Param_t>& params, uint32_t hash)
+{
+    QVector<Entry_t>    entries;
+    QByteArray          namePool;
+
+    entries.reserve(params.count());
+    for (const Param_t& param: params) {
+        QByteArray  name        = param.name.toLatin1();
+        int         metaType    = FactMetaData::typeToMetaType(param.type);
+        QVariant    value       = param.value;
+
+        if (!typeSupported(param.type) || name.length() > 255 || !value.convert(metaType)) {
+            qCWarning(ParameterManagerLog) << "ParameterCacheFile::write unsupported parameter" << param.name << param.type;
+            return false;
+        }
+
+        Entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.nameOffset    = static_cast<quint32>(namePool.size());
+        entry.nameLength    = static_cast<quint8>(name.length());
+        entry.type          = static_cast<quint8>(param.type);
+        memcpy(entry.value, value.constData(), static_cast<size_t>(QMetaType::sizeOf(metaType)));
+        entries.append(entry);
+
+        namePool.append(name);
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version      = _version;
+    header.entryCount   = static_cast<quint32>(entries.count());
+    header.hash         = hash;
+    header.namePoolSize = static_cast<quint32>(namePool.size());
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(ParameterManagerLog) << "ParameterCacheFile::write open failed" << filename << file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.constData()), static_cast<qint64>(entries.count()) * static_cast<qint64>(sizeof(Entry_t)));
+    file.write(namePool);
+
+    return file.commit();
+}
+
+bool ParameterCacheFile::open(const QString& filename)
+{
+    close();
+
+    _file.setFileName(filename);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 fileSize = _file.size();
+    if (fileSize < static_cast<qint64>(sizeof(Header_t))) {
+        close();
+        return false;
+    }
+
+    _map = _file.map(0, fileSize);
+    if (!_map) {
+        qCWarning(ParameterManagerLog) << "ParameterCacheFile::open map failed" << filename << _file.errorString();
+        close();
+        return false;
+    }
+
+    const Header_t* header = reinterpret_cast<const Header_t*>(_map);
+    if (memcmp(header->magic, _magic, sizeof(header->magic)) != 0 || header->version != _version ||
+            fileSize != static_cast<qint64>(sizeof(Header_t) + (static_cast<quint64>(header->entryCount) * sizeof(Entry_t)) + header->namePoolSize)) {
+        qCDebug(ParameterManagerLog) << "ParameterCacheFile::open cache out of date or corrupt" << filename;
+        close();
+        return false;
+    }
+
+    const Entry_t* entries = reinterpret_cast<const Entry_t*>(_map + sizeof(Header_t));
+    for (quint32 i=0; i<header->entryCount; i++) {
+        if (static_cast<quint64>(entries[i].nameOffset) + entries[i].nameLength > header->namePoolSize ||
+                !typeSupported(static_cast<FactMetaData::ValueType_t>(entries[i].type))) {
+            qCDebug(ParameterManagerLog) << "ParameterCacheFile::open corrupt entry" << filename << i;
+            close();
+            return false;
+        }
+    }
+
+    _header     = header;
+    _entries    = entries;
+    _namePool   = reinterpret_cast<const char*>(_map + sizeof(Header_t) + (header->entryCount * sizeof(Entry_t)));
+
+    return true;
+}
+
+void ParameterCacheFile::close(void)
+{
+    if (_map) {
+        _file.unmap(_map);
+        _map = nullptr;
+    }
+    _file.close();
+    _header     = nullptr;
+    _entries    = nullptr;
+    _namePool   = nullptr;
+}
+
+QString ParameterCacheFile::name(int index) const
+{
+    const Entry_t& entry = _entries[index];
+    return QString::fromLatin1(_namePool + entry.nameOffset, entry.nameLength);
+}
+
+QVariant ParameterCacheFile::value(int index) const
+{
+    const Entry_t& entry = _entries[index];
+    return QVariant(FactMetaData::typeToMetaType(type(index)), entry.value);
+}
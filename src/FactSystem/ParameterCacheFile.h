@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactMetaData.h"
+
+#include <QFile>
+#include <QString>
+#include <QVariant>
+#include <QList>
+
+/// Binary parameter cache for a single vehicle component.
+///
+/// Layout: header (including the parameter set hash), entry table sorted by name with typed values, name pool. The
+/// file is memory mapped for reading, so checking the hash only touches the header and parameters are read straight
+/// out of the mapping.
+class ParameterCacheFile
+{
+public:
+    ParameterCacheFile(void) = default;
+    ~ParameterCacheFile() { close(); }
+
+    typedef struct {
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    value;
+    } Param_t;
+
+    /// Writes a cache file
+    ///     @param params   Parameters sorted by name
+    ///     @param hash     Parameter set hash, as reported by the vehicle in _HASH_CHECK
+    /// @return false: write failed
+    static bool write(const QString& filename, const QList<Param_t>& params, uint32_t hash);
+
+    /// Maps and validates a cache file
+    /// @return false: file is missing, out of date or corrupt
+    bool open(const QString& filename);
+    void close(void);
+
+    uint32_t                    hash    (void) const { return _header ? _header->hash : 0; }
+    int                         count   (void) const { return _header ? static_cast<int>(_header->entryCount) : 0; }
+    QString                     name    (int index) const;
+    FactMetaData::ValueType_t   type    (int index) const { return static_cast<FactMetaData::ValueType_t>(_entries[index].type); }
+    QVariant                    value   (int index) const;
+
+    /// Raw value bytes for the parameter, typeToSize(type) long. These are the bytes used for the parameter set hash.
+    const uchar* valueData(int index) const { return _entries[index].value; }
+
+    /// @return false: type can't be stored in the cache
+    static bool typeSupported(FactMetaData::ValueType_t type);
+
+private:
+    typedef struct {
+        char        magic[8];
+        quint32     version;
+        quint32     entryCount;
+        quint32     hash;
+        quint32     namePoolSize;
+    } Header_t;
+
+    typedef struct {
+        quint32     nameOffset;     ///< Offset into the name pool
+        quint8      nameLength;
+        quint8      type;           ///< FactMetaData::ValueType_t
+        quint16     reserved;
+        uchar       value[8];       ///< Storage of the QVariant type for the value type, native byte order
+    } Entry_t;
+
+    QFile           _file;
+    uchar*          _map        = nullptr;
+    const Header_t* _header     = nullptr;
+    const Entry_t*  _entries    = nullptr;
+    const char*     _namePool   = nullptr;
+
+    static const char*      _magic;
+    static const quint32    _version = 1;
+};
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterFactMap.h"
+
+#include <QHash>
+
+int ParameterFactMap::indexOf(const QString& name) const
+{
+    if (_slots.isEmpty()) {
+        return -1;
+    }
+
+    const uint  hash    = qHash(name);
+    const int   mask    = _slots.count() - 1;
+    for (int slot = static_cast<int>(hash) & mask; ; slot = (slot + 1) & mask) {
+        const int index = _slots[slot];
+        if (index == -1) {
+            return -1;
+        }
+        // Comparing the hash first skips nearly all string compares against other names
+        const Entry_t& entry = _entries[index];
+        if (entry.hash == hash && entry.name == name) {
+            return index;
+        }
+    }
+}
+
+Fact* ParameterFactMap::value(const QString& name) const
+{
+    const int index = indexOf(name);
+    return index == -1 ? nullptr : _entries[index].fact;
+}
+
+int ParameterFactMap::insert(const QString& name, Fact* fact, int handle)
+{
+    // Load factor is kept at or below one half so probe sequences stay short
+    if ((_entries.count() + 1) * 2 > _slots.count()) {
+        _rehash(qMax(_minCapacity, _slots.count() * 2));
+    }
+
+    const int index = _entries.count();
+    _entries.append({ name, fact, handle, qHash(name) });
+
+    const int mask = _slots.count() - 1;
+    int slot = static_cast<int>(_entries[index].hash) & mask;
+    while (_slots[slot] != -1) {
+        slot = (slot + 1) & mask;
+    }
+    _slots[slot] = index;
+
+    _sortedNamesValid = false;
+    return index;
+}
+
+void ParameterFactMap::_rehash(int capacity)
+{
+    _slots.fill(-1, capacity);
+
+    const int mask = capacity - 1;
+    for (int index=0; index<_entries.count(); index++) {
+        int slot = static_cast<int>(_entries[index].hash) & mask;
+        while (_slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        _slots[slot] = index;
+    }
+}
+
+const QStringList& ParameterFactMap::names(void) const
+{
+    if (!_sortedNamesValid) {
+        _sortedNames.clear();
+        _sortedNames.reserve(_entries.count());
+        for (const Entry_t& entry: _entries) {
+            _sortedNames.append(entry.name);
+        }
+        _sortedNames.sort();
+        _sortedNamesValid = true;
+    }
+    return _sortedNames;
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Fact;
+
+/// Parameter name to Fact lookup for a single component.
+///
+/// Names are stored once in a flat entry table, lookups go through an open addressed hash of the entries using linear
+/// probing. Entries are never removed, so an entry index stays valid for the life of the map.
+class ParameterFactMap
+{
+public:
+    /// @return Entry index for the name, -1 if not found
+    int             indexOf     (const QString& name) const;
+    bool            contains    (const QString& name) const { return indexOf(name) != -1; }
+    /// @return nullptr if not found
+    Fact*           value       (const QString& name) const;
+    Fact*           at          (int index) const { return _entries[index].fact; }
+    int             handleAt    (int index) const { return _entries[index].handle; }
+    const QString&  nameAt      (int index) const { return _entries[index].name; }
+    int             count       (void) const { return _entries.count(); }
+
+    /// Adds a new name, the name must not already be in the map
+    ///     @param handle Caller assigned handle which is returned by handleAt
+    /// @return Entry index of the name
+    int             insert      (const QString& name, Fact* fact, int handle);
+
+    /// @return All names in sorted order
+    const QStringList& names    (void) const;
+
+private:
+    typedef struct {
+        QString name;
+        Fact*   fact;
+        int     handle;
+        uint    hash;
+    } Entry_t;
+
+    void _rehash(int capacity);
+
+    QVector<Entry_t>    _entries;
+    QVector<int>        _slots;                     ///< Entry index, -1 for an empty slot. Size is a power of 2.
+    mutable QStringList _sortedNames;
+    mutable bool        _sortedNamesValid = false;
+
+    static const int _minCapacity = 64;
+};
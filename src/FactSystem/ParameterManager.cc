@@ -18,6 +18,7 @@
 #include "ComponentInformationManager.h"
 #include "CompInfoParam.h"
 #include "FTPManager.h"
+#include "ParameterCacheFile.h"
 
 #include <QEasingCurve>
 #include <QFile>
@@ -121,6 +122,7 @@ void ParameterManager::_updateProgressBar(void)
     for(int compId: _waitingWriteParamNameMap.keys()) {
         waitingWriteParamCount += _waitingWriteParamNameMap[compId].count();
     }
+    waitingWriteParamCount += _bulkWriteQueue.count();
 
     if (waitingReadParamIndexCount == 0) {
         if (_readParamIndexProgressActive) {
@@ -317,6 +319,15 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
     _waitingWriteParamNameMap[componentId].remove(parameterName);
+    BulkWriteKey bulkWriteKey(componentId, parameterName);
+    if (_bulkWriteInFlight.contains(bulkWriteKey)) {
+        // The vehicle may clamp or round the value, anything other than what was requested is a failed write
+        const bool success = parameterValue == _bulkWriteInFlight[bulkWriteKey].rawValue;
+        if (!success) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Bulk write value mismatch" << parameterName << "requested:" << _bulkWriteInFlight[bulkWriteKey].rawValue << "vehicle:" << parameterValue;
+        }
+        _bulkWriteParamDone(componentId, parameterName, success);
+    }
     if (_waitingReadParamIndexMap[componentId].count()) {
         qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
     }
@@ -372,17 +383,15 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 
     _updateProgressBar();
 
-    Fact* fact = nullptr;
-    if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
-        fact = _mapCompId2FactMap[componentId][parameterName];
-    } else {
+    Fact* fact = _mapCompId2FactMap[componentId].value(parameterName);
+    if (!fact) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
         fact = new Fact(componentId, parameterName, mavTypeToFactType(mavParamType), this);
         FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
         fact->setMetaData(factMetaData);
 
-        _mapCompId2FactMap[componentId][parameterName] = fact;
+        _addFact(componentId, parameterName, fact);
 
         // We need to know when the fact value changes so we can update the vehicle
         connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
@@ -445,21 +454,37 @@ void ParameterManager::_factRawValueUpdated(const QVariant& rawValue)
 
 void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
 {
+    if (fileName != _ftpDownloadFile) {
+        // Some other queued download
+        return;
+    }
+
     bool continueWithDefaultParameterdownload = true;
     bool immediateRetry = false;
 
     disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &ParameterManager::_ftpDownloadComplete);
-    disconnect(_vehicle->ftpManager(), &FTPManager::commandProgress, this, &ParameterManager::_ftpDownloadProgress);
+    disconnect(_vehicle->ftpManager(), &FTPManager::downloadDataReceived, this, &ParameterManager::_ftpDownloadData);
+
+    bool partialDownload = _ftpParamDecoder.headerReceived() && !_ftpParamDecoder.error() && _ftpParamDecoder.decodedCount() > 0;
 
     if (errorMsg.isEmpty()) {
         qCDebug(ParameterManagerLog) << "ParameterManager::_ftpDownloadComplete : Parameter file received:" << fileName;
-        if (_parseParamFile(fileName)) {
+        if (_ftpParamDecoder.complete()) {
             qCDebug(ParameterManagerLog) << "ParameterManager::_ftpDownloadComplete : Parsed!";
+            _ftpParamLoadComplete();
+            return;
+        } else if (partialDownload) {
+            qCDebug(ParameterManagerLog) << "ParameterManager::_ftpDownloadComplete : Parameter file incomplete";
+            _ftpLoadMissingParams();
             return;
         } else {
             qCDebug(ParameterManagerLog) << "ParameterManager::_ftpDownloadComplete : Error in parameter file";
             /* This should not happen... */
         }
+    } else if (partialDownload) {
+        qCDebug(ParameterManagerLog) << "ParameterManager-ftp: Download failed part way through -" << errorMsg;
+        _ftpLoadMissingParams();
+        return;
     } else {
         if (errorMsg.contains("File Not Found")) {
             qCDebug(ParameterManagerLog) << "ParameterManager-ftp: No Parameterfile on vehicle - Start Conventional Parameter Download";
@@ -492,14 +517,6 @@ void ParameterManager::_ftpDownloadComplete(const QString& fileName, const QStri
 }
 
 
-void ParameterManager::_ftpDownloadProgress(float progress)
-{
-    qCDebug(ParameterManagerVerbose1Log) << "ParameterManager::_ftpDownloadProgress: " << progress;
-    _setLoadProgress(static_cast<double>(progress));
-    if (progress > 0.001)
-        _initialRequestTimeoutTimer.stop();
-}
-
 void ParameterManager::refreshAllParameters(uint8_t componentId)
 {
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
@@ -524,15 +541,20 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
 
     if (_tryftp && (componentId == MAV_COMP_ID_ALL || componentId == MAV_COMP_ID_AUTOPILOT1)) {
         FTPManager* ftpManager = _vehicle->ftpManager();
-        connect(ftpManager, &FTPManager::downloadComplete, this, &ParameterManager::_ftpDownloadComplete);
+        _ftpParamDecoder.reset();
+        _ftpContiguousBytes = 0;
+        _ftpOutOfOrderData.clear();
+        connect(ftpManager, &FTPManager::downloadComplete,      this, &ParameterManager::_ftpDownloadComplete);
+        connect(ftpManager, &FTPManager::downloadDataReceived,  this, &ParameterManager::_ftpDownloadData);
         _waitingParamTimeoutTimer.stop();
-        if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, "@PARAM/param.pck",
-                                 QStandardPaths::writableLocation(QStandardPaths::TempLocation),
-                                 "", false /* No filesize check */)) {
-            connect(ftpManager, &FTPManager::commandProgress, this, &ParameterManager::_ftpDownloadProgress);
-        } else {
+        const QString paramFileURI(QStringLiteral("@PARAM/param.pck"));
+        _ftpDownloadFile = FTPManager::downloadFilePath(paramFileURI, QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+        if (!ftpManager->download(MAV_COMP_ID_AUTOPILOT1, paramFileURI,
+                                  QStandardPaths::writableLocation(QStandardPaths::TempLocation),
+                                  "", false /* No filesize check */, FTPManager::PriorityHigh)) {
             qCWarning(ParameterManagerLog) << "ParameterManager::refreshallParameters FTPManager::download returned failure";
-            disconnect(ftpManager, &FTPManager::downloadComplete, this, &ParameterManager::_ftpDownloadComplete);
+            disconnect(ftpManager, &FTPManager::downloadComplete,       this, &ParameterManager::_ftpDownloadComplete);
+            disconnect(ftpManager, &FTPManager::downloadDataReceived,   this, &ParameterManager::_ftpDownloadData);
         }
     } else {
         // Reset index wait lists
@@ -604,7 +626,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParametersPrefix - name:" << namePrefix << ")";
 
-    for (const QString &paramName: _mapCompId2FactMap[componentId].keys()) {
+    for (const QString &paramName: _mapCompId2FactMap[componentId].names()) {
         if (paramName.startsWith(namePrefix)) {
             refreshParameter(componentId, paramName);
         }
@@ -613,14 +635,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
 
 bool ParameterManager::parameterExists(int componentId, const QString& paramName)
 {
-    bool ret = false;
-
-    componentId = _actualComponentId(componentId);
-    if (_mapCompId2FactMap.contains(componentId)) {
-        ret = _mapCompId2FactMap[componentId].contains(_remapParamNameToVersion(paramName));
-    }
-
-    return ret;
+    return parameterHandle(componentId, paramName) != -1;
 }
 
 Fact* ParameterManager::getParameter(int componentId, const QString& paramName)
@@ -628,23 +643,39 @@ Fact* ParameterManager::getParameter(int componentId, const QString& paramName)
     componentId = _actualComponentId(componentId);
 
     QString mappedParamName = _remapParamNameToVersion(paramName);
-    if (!_mapCompId2FactMap.contains(componentId) || !_mapCompId2FactMap[componentId].contains(mappedParamName)) {
+    auto it = _mapCompId2FactMap.constFind(componentId);
+    Fact* fact = it == _mapCompId2FactMap.constEnd() ? nullptr : it.value().value(mappedParamName);
+    if (!fact) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapCompId2FactMap[componentId][mappedParamName];
+    return fact;
 }
 
-QStringList ParameterManager::parameterNames(int componentId)
+int ParameterManager::parameterHandle(int componentId, const QString& paramName)
 {
-    QStringList names;
-
-    for(const QString &paramName: _mapCompId2FactMap[_actualComponentId(componentId)].keys()) {
-        names << paramName;
+    auto it = _mapCompId2FactMap.constFind(_actualComponentId(componentId));
+    if (it == _mapCompId2FactMap.constEnd()) {
+        return -1;
     }
 
-    return names;
+    const int index = it.value().indexOf(_remapParamNameToVersion(paramName));
+    return index == -1 ? -1 : it.value().handleAt(index);
+}
+
+Fact* ParameterManager::_addFact(int componentId, const QString& paramName, Fact* fact)
+{
+    const int handle = _handleFacts.count();
+    _handleFacts.append(fact);
+    _mapCompId2FactMap[componentId].insert(paramName, fact, handle);
+    return fact;
+}
+
+QStringList ParameterManager::parameterNames(int componentId)
+{
+    auto it = _mapCompId2FactMap.constFind(_actualComponentId(componentId));
+    return it == _mapCompId2FactMap.constEnd() ? QStringList() : it.value().names();
 }
 
 /// Requests missing index based parameters from the vehicle.
@@ -735,9 +766,16 @@ void ParameterManager::_waitingParamTimeout(void)
             for(const QString &paramName: _waitingWriteParamNameMap[componentId].keys()) {
                 paramsRequested = true;
                 _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
+                BulkWriteKey bulkWriteKey(componentId, paramName);
                 if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
-                    Fact* fact = getParameter(componentId, paramName);
-                    _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
+                    if (_bulkWriteInFlight.contains(bulkWriteKey)) {
+                        // May not have a fact yet when it is new to the vehicle
+                        const BulkWriteParam_t& bulkParam = _bulkWriteInFlight[bulkWriteKey];
+                        _sendParamSetToVehicle(componentId, paramName, bulkParam.valueType, bulkParam.rawValue);
+                    } else {
+                        Fact* fact = getParameter(componentId, paramName);
+                        _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
+                    }
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
                     if (++batchCount > maxBatchSize) {
                         goto Out;
@@ -745,6 +783,11 @@ void ParameterManager::_waitingParamTimeout(void)
                 } else {
                     // Exceeded max retry count, notify user
                     _waitingWriteParamNameMap[componentId].remove(paramName);
+                    if (_bulkWriteInFlight.contains(bulkWriteKey)) {
+                        // Reported for the whole transaction once it completes
+                        _bulkWriteParamDone(componentId, paramName, false);
+                        continue;
+                    }
                     QString errorMsg = tr("Parameter write failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showAppMessage(errorMsg);
@@ -869,18 +912,28 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    QList<ParameterCacheFile::Param_t>  params;
+    uint32_t                            crc32_value = 0;
 
-    for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
-        const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
-    }
+    // The hash is calculated in name order
+    const ParameterFactMap& factMap = _mapCompId2FactMap[componentId];
+    for (const QString& paramName: factMap.names()) {
+        const Fact* fact = factMap.value(paramName);
+        params.append({ paramName, fact->type(), fact->rawValue() });
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(paramName, fact->type())->volatileValue()) {
+            // Does not take part in CRC
+            continue;
+        }
+        const void* vdat = fact->rawValue().constData();
+        crc32_value = QGC::crc32((const uint8_t *)qPrintable(paramName), paramName.length(),  crc32_value);
+        crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact->type()), crc32_value);
+    }
 
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+    QString cacheFile = parameterCacheFile(vehicleId, componentId);
+    if (!ParameterCacheFile::write(cacheFile, params, crc32_value)) {
+        QFile::remove(cacheFile);
+    }
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -891,55 +944,31 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    ParameterCacheFile  cacheFile;
+    QString             cacheFilename = parameterCacheFile(vehicleId, componentId);
+    if (!cacheFile.open(cacheFilename)) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
 
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
-
-    /* compute the crc of the local cache to check against the remote */
-
-    for (const QString& name: cacheMap.keys()) {
-        const ParamTypeVal&             paramTypeVal    = cacheMap[name];
-        const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, fact_type)->volatileValue()) {
-            // Does not take part in CRC
-            qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
-        }
-    }
+    /* The hash of the cached parameter set was calculated when the cache was written */
+    uint32_t crc32_value = cacheFile.hash();
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFilename).absoluteFilePath());
+
+        int count = cacheFile.count();
+        for (int index=0; index<count; index++) {
+            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(cacheFile.type(index));
+            _handleParamValue(componentId, cacheFile.name(index), count, index, mavParamType, cacheFile.value(index));
         }
 
         WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
@@ -986,11 +1015,12 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFilename).absoluteFilePath());
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString& name: cacheMap.keys()) {
+            for (int index=0; index<cacheFile.count(); index++) {
+                QString name = cacheFile.name(index);
+                _debugCacheMap[componentId][name] = ParamTypeVal(cacheFile.type(index), cacheFile.value(index));
                 _debugCacheParamSeen[componentId][name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
@@ -1000,8 +1030,9 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
-    QString missingErrors;
-    QString typeErrors;
+    QString                 missingErrors;
+    QString                 typeErrors;
+    QList<BulkWriteParam_t> bulkParams;
 
     while (!stream.atEnd()) {
         QString line = stream.readLine();
@@ -1036,11 +1067,13 @@ QString ParameterManager::readParametersFromStream(QTextStream& stream)
                 }
 
                 qCDebug(ParameterManagerLog) << "Updating parameter" << componentId << paramName << valStr;
-                fact->setRawValue(valStr);
+                bulkParams.append({ componentId, paramName, fact->type(), valStr });
             }
         }
     }
 
+    bulkWrite(bulkParams);
+
     QString errors;
 
     if (!missingErrors.isEmpty()) {
@@ -1072,8 +1105,9 @@ void ParameterManager::writeParametersToStream(QTextStream& stream)
     stream << "# Vehicle-Id Component-Id Name Value Type\n";
 
     for (int componentId: _mapCompId2FactMap.keys()) {
-        for (const QString &paramName: _mapCompId2FactMap[componentId].keys()) {
-            Fact* fact = _mapCompId2FactMap[componentId][paramName];
+        const ParameterFactMap& factMap = _mapCompId2FactMap[componentId];
+        for (const QString &paramName: factMap.names()) {
+            Fact* fact = factMap.value(paramName);
             if (fact) {
                 stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(factTypeToMavType(fact->type())) << "\n";
             } else {
@@ -1364,7 +1398,7 @@ void ParameterManager::_loadOfflineEditingParams(void)
         FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(defaultComponentId)->factMetaDataForName(paramName, fact->type());
         fact->setMetaData(factMetaData);
 
-        _mapCompId2FactMap[defaultComponentId][paramName] = fact;
+        _addFact(defaultComponentId, paramName, fact);
     }
 
     _parametersReady = true;
@@ -1414,6 +1448,9 @@ QList<int> ParameterManager::componentIds(void)
 
 bool ParameterManager::pendingWrites(void)
 {
+    if (_bulkWriteQueue.count()) {
+        return true;
+    }
     for (int compId: _waitingWriteParamNameMap.keys()) {
         if (_waitingWriteParamNameMap[compId].count()) {
             return true;
@@ -1423,6 +1460,161 @@ bool ParameterManager::pendingWrites(void)
     return false;
 }
 
+int ParameterManager::bulkWrite(const QList<BulkWriteParam_t>& params)
+{
+    int queued = 0;
+
+    for (const BulkWriteParam_t& param: params) {
+        BulkWriteParam_t bulkParam = param;
+        bulkParam.componentId = _actualComponentId(param.componentId);
+
+        bool alreadyQueued = false;
+        for (BulkWriteParam_t& queuedParam: _bulkWriteQueue) {
+            if (queuedParam.componentId == bulkParam.componentId && queuedParam.name == bulkParam.name) {
+                // Not sent yet, the latest value wins
+                queuedParam.rawValue = bulkParam.rawValue;
+                alreadyQueued = true;
+                break;
+            }
+        }
+        if (alreadyQueued) {
+            continue;
+        }
+
+        if (parameterExists(bulkParam.componentId, bulkParam.name)) {
+            Fact*   fact = getParameter(bulkParam.componentId, bulkParam.name);
+            QString errorString;
+
+            bulkParam.valueType = fact->type();
+            if (!fact->metaData() || !fact->metaData()->convertAndValidateRaw(param.rawValue, true /* convertOnly */, bulkParam.rawValue, errorString)) {
+                qCWarning(ParameterManagerLog) << _logVehiclePrefix(bulkParam.componentId) << "Bulk write skipping" << bulkParam.name << errorString;
+                continue;
+            }
+            if (bulkParam.rawValue == fact->rawValue() && !_bulkWriteInFlight.contains(BulkWriteKey(bulkParam.componentId, bulkParam.name))) {
+                // Most of a preset is usually already set on the vehicle
+                continue;
+            }
+        } else {
+            bulkParam.rawValue.convert(FactMetaData::typeToMetaType(bulkParam.valueType));
+        }
+
+        _bulkWriteQueue.append(bulkParam);
+        queued++;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Bulk write - requested:changed" << params.count() << queued;
+
+    if (queued) {
+        const bool starting = _bulkWriteTotal == 0;
+        if (starting) {
+            _bulkWriteElapsed.start();
+        }
+        _bulkWriteTotal += queued;
+        _waitingWriteParamBatchCount += queued;
+        if (starting) {
+            emit bulkWriteActiveChanged(true);
+        }
+        _bulkWriteSendNext();
+        _updateProgressBar();
+    }
+
+    return queued;
+}
+
+int ParameterManager::writeParameters(const QVariantMap& nameValues, int componentId)
+{
+    QList<BulkWriteParam_t> params;
+
+    componentId = _actualComponentId(componentId);
+    for (auto it = nameValues.constBegin(); it != nameValues.constEnd(); it++) {
+        if (!parameterExists(componentId, it.key())) {
+            qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "writeParameters: unknown parameter" << it.key();
+            return -1;
+        }
+
+        Fact*       fact = getParameter(componentId, it.key());
+        QVariant    typedValue;
+        QString     errorString;
+        if (!fact->metaData() || !fact->metaData()->convertAndValidateRaw(it.value(), false /* convertOnly */, typedValue, errorString)) {
+            qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "writeParameters: invalid value" << it.key() << it.value() << errorString;
+            return -1;
+        }
+        params.append({ componentId, it.key(), fact->type(), typedValue });
+    }
+
+    return bulkWrite(params);
+}
+
+/// Keeps up to _bulkWriteWindow PARAM_SETs outstanding and signals completion once nothing is left
+void ParameterManager::_bulkWriteSendNext(void)
+{
+    int i = 0;
+    while (_bulkWriteInFlight.count() < _bulkWriteWindow && i < _bulkWriteQueue.count()) {
+        const BulkWriteKey key(_bulkWriteQueue[i].componentId, _bulkWriteQueue[i].name);
+        if (_bulkWriteInFlight.contains(key)) {
+            // Written again while the previous value is still outstanding, wait for that response first
+            i++;
+            continue;
+        }
+
+        BulkWriteParam_t bulkParam = _bulkWriteQueue.takeAt(i);
+        if (!_waitingWriteParamNameMap.contains(bulkParam.componentId)) {
+            qWarning() << "Internal error ParameterManager::_bulkWriteSendNext: component id not found" << bulkParam.componentId;
+            _bulkWriteFailed++;
+            _bulkWriteFailedNames.append(QStringLiteral("%1:%2").arg(bulkParam.componentId).arg(bulkParam.name));
+            emit bulkWriteProgress(_bulkWriteWritten + _bulkWriteFailed, _bulkWriteTotal);
+            continue;
+        }
+
+        if (parameterExists(bulkParam.componentId, bulkParam.name)) {
+            // Same as an interactive edit the new value shows right away, the PARAM_VALUE response replaces it
+            getParameter(bulkParam.componentId, bulkParam.name)->_containerSetRawValue(bulkParam.rawValue);
+        }
+        _bulkWriteInFlight[key] = bulkParam;
+        _waitingWriteParamNameMap[bulkParam.componentId][bulkParam.name] = 0;
+        _sendParamSetToVehicle(bulkParam.componentId, bulkParam.name, bulkParam.valueType, bulkParam.rawValue);
+        _saveRequired = true;
+        _waitingParamTimeoutTimer.start();
+    }
+
+    if (_bulkWriteTotal && _bulkWriteQueue.isEmpty() && _bulkWriteInFlight.isEmpty()) {
+        const int       written         = _bulkWriteWritten;
+        const int       failed          = _bulkWriteFailed;
+        const int       elapsedMsecs    = static_cast<int>(_bulkWriteElapsed.elapsed());
+        const double    paramsPerSecond = elapsedMsecs > 0 ? (written * 1000.0) / elapsedMsecs : 0;
+
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Bulk write complete - written:failed:msecs:params/sec" << written << failed << elapsedMsecs << paramsPerSecond;
+        if (failed) {
+            QStringList failedNames = _bulkWriteFailedNames.mid(0, 10);
+            if (_bulkWriteFailedNames.count() > failedNames.count()) {
+                failedNames.append(QStringLiteral("..."));
+            }
+            qgcApp()->showAppMessage(tr("Parameter write failed for %1 of %2 parameters: veh:%3 %4").arg(failed).arg(_bulkWriteTotal).arg(_vehicle->id()).arg(failedNames.join(QStringLiteral(", "))));
+        }
+
+        _bulkWriteTotal     = 0;
+        _bulkWriteWritten   = 0;
+        _bulkWriteFailed    = 0;
+        _bulkWriteFailedNames.clear();
+        emit bulkWriteActiveChanged(false);
+        emit bulkWriteComplete(written, failed, elapsedMsecs, paramsPerSecond);
+    }
+}
+
+void ParameterManager::_bulkWriteParamDone(int componentId, const QString& name, bool success)
+{
+    _bulkWriteInFlight.remove(BulkWriteKey(componentId, name));
+    if (success) {
+        _bulkWriteWritten++;
+    } else {
+        _bulkWriteFailed++;
+        _bulkWriteFailedNames.append(QStringLiteral("%1:%2").arg(componentId).arg(name));
+    }
+    emit bulkWriteProgress(_bulkWriteWritten + _bulkWriteFailed, _bulkWriteTotal);
+
+    _bulkWriteSendNext();
+}
+
 
 /* Parse the binary parameter file and inject the parameters in the qgc
  * fact system.
@@ -1430,195 +1622,116 @@ bool ParameterManager::pendingWrites(void)
  * See: https://github.com/ArduPilot/ardupilot/tree/master/libraries/AP_Filesystem
  *
  */
-bool ParameterManager::_parseParamFile(const QString& filename)
+void ParameterManager::_ftpDownloadData(uint32_t offset, const QByteArray& data)
 {
-    const quint16 magic_standard = 0x671B;
-    const quint16 magic_withdefaults = 0x671C;
-    quint32 no_of_parameters_found = 0;
-    const int componentId = MAV_COMP_ID_AUTOPILOT1; /* Only main autopilot for the moment */
-    enum ap_var_type {
-        AP_PARAM_NONE    = 0,
-        AP_PARAM_INT8,
-        AP_PARAM_INT16,
-        AP_PARAM_INT32,
-        AP_PARAM_FLOAT,
-        AP_PARAM_VECTOR3F,
-        AP_PARAM_GROUP
-    };
-
-    qCDebug(ParameterManagerLog) << "_parseParamFile: " << filename;
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qCDebug(ParameterManagerLog) << "_parseParamFile: Error: Could not open downloaded parameter file.";
-        return false;
+    if (_vehicle->ftpManager()->currentDownloadFilePath() != _ftpDownloadFile) {
+        return;
+    }
+
+    uint32_t blockEnd = offset + static_cast<uint32_t>(data.size());
+
+    if (blockEnd <= _ftpContiguousBytes) {
+        // Already decoded this block
+        return;
+    }
+    if (offset > _ftpContiguousBytes) {
+        // There is a gap in front of this block which FTPManager will fill in later
+        _ftpOutOfOrderData[offset] = data;
+        return;
     }
-    QDataStream in(&file);
-    in.setByteOrder(QDataStream::LittleEndian);
-
-    quint16 magic, num_params, total_params;
-    in >> magic;
-    in >> num_params;
-    in >> total_params;
-
-    if (in.status() != QDataStream::Ok) {
-        qCDebug(ParameterManagerLog) << "_parseParamFile: Error: Could not read Header";
-        goto Error;
-    }
-
-    qCDebug(ParameterManagerVerbose2Log) << "_parseParamFile: magic: 0x" << Qt::hex << magic;
-    qCDebug(ParameterManagerVerbose2Log) << "_parseParamFile: num_params:" << num_params
-                                 << " total_params:" << total_params;
-
-    if ((magic != magic_standard) && (magic != magic_withdefaults)) {
-        qCDebug(ParameterManagerLog) << "_parseParamFile: Error: File does not start with Magic";
-        goto Error;
-    }
-    if (num_params > total_params) {
-        qCDebug(ParameterManagerLog) << "_parseParamFile: Error: total_params > num_params";
-        goto Error;
-    }
-    if (num_params != total_params) {
-        /* We requested all parameters, so this is an error here */
-        qCDebug(ParameterManagerLog) << "_parseParamFile: Error: total_params != num_params";
-        goto Error;
-    }
-
-    while (in.status() == QDataStream::Ok) {
-        quint8 byte = 0;
-        quint8 flags = 0;
-        quint8 ptype = 0;
-        quint8 name_len = 0;
-        quint8 common_len = 0;
-        bool withdefault = false;
-        int no_read = 0;
-        char name_buffer[17];
-
-        while (byte == 0x0) { // Eat padding bytes
-            in >> byte;
-            if (in.status() != QDataStream::Ok) {
-                if (no_of_parameters_found == num_params)
-                    goto Success;
-                else {
-                    qCDebug(ParameterManagerLog) << "_parseParamFile: Error: unexpected EOF"
-                                                 << "number of parameters expected:" << num_params
-                                                 << "actual:" << no_of_parameters_found;
-                    goto Error;
-                }
-            }
-        }
-        ptype = byte & 0x0F;
-        flags = (byte >> 4) & 0x0F;
-        withdefault = (flags & 0x01) == 0x01;
-        in >> byte;
-        if (in.status() != QDataStream::Ok) {
-            qCritical(ParameterManagerLog) << "_parseParamFile: Error: Unexpected EOF while reading flags";
-            goto Error;
-        }
-        name_len = ((byte >> 4) & 0x0F) + 1;
-        common_len = byte & 0x0F;
-        if ((name_len + common_len) > 16) {
-            qCritical(ParameterManagerLog) << "_parseParamFile: Error: common_len + name_len > 16 "
-                                         << "name_len" << name_len
-                                         << "common_len" << common_len;
-            goto Error;
-        }
-        no_read = in.readRawData(&name_buffer[common_len], (int) name_len);
-        if (no_read != name_len) {
-            qCritical(ParameterManagerLog) << "_parseParamFile: Error: Unexpected EOF while reading parameterName"
-                                         << "Expected:" << name_len
-                                         << "Actual:" << no_read;
-            goto Error;
-        }
-        name_buffer[common_len + name_len] = '\0';
-        QString parameterName(name_buffer);
-        qCDebug(ParameterManagerVerbose2Log) << "_parseParamFile: parameter" << parameterName
-                                     << "name_len" << name_len
-                                     << "common_len" << common_len
-                                     << "ptype" << ptype
-                                     << "flags" << flags;
-
-        QVariant parameterValue = 0;
-        switch ((enum ap_var_type) ptype) {
-        qint8 data8;
-        qint16 data16;
-        qint32 data32;
-        float dfloat;
-        case AP_PARAM_INT8:
-            in >> data8;
-            parameterValue = data8;
-            if (withdefault)
-                in >> data8;
-            break;
-        case AP_PARAM_INT16:
-            in >> data16;
-            parameterValue = data16;
-            if (withdefault)
-                in >> data16;
-            break;
-        case AP_PARAM_INT32:
-            in >> data32;
-            parameterValue = data32;
-            if (withdefault)
-                in >> data32;
-            break;
-        case AP_PARAM_FLOAT:
-            in >> data32;
-            memcpy(&dfloat, &data32, 4);
-            parameterValue = dfloat;
-            if (withdefault)
-                in >> data32;
-            break;
-        default:
-            qCDebug(ParameterManagerLog) << "_parseParamFile: Error: type is out of range" << ptype;
-            goto Error;
-            break;
-        }
-        qCDebug(ParameterManagerVerbose2Log) << "paramValue" << parameterValue;
 
-        if (++no_of_parameters_found > num_params){
-            qCDebug(ParameterManagerLog) << "_parseParamFile: Error: more parameters in file than expected."
-                                         << "Expected:" << num_params
-                                         << "Actual:" << no_of_parameters_found;
-            goto Error;
+    _ftpDecodeBlock(data.mid(static_cast<int>(_ftpContiguousBytes - offset)));
+
+    while (!_ftpOutOfOrderData.isEmpty() && _ftpOutOfOrderData.firstKey() <= _ftpContiguousBytes) {
+        uint32_t    pendingOffset   = _ftpOutOfOrderData.firstKey();
+        QByteArray  pendingData     = _ftpOutOfOrderData.take(pendingOffset);
+        if (pendingOffset + static_cast<uint32_t>(pendingData.size()) > _ftpContiguousBytes) {
+            _ftpDecodeBlock(pendingData.mid(static_cast<int>(_ftpContiguousBytes - pendingOffset)));
         }
+    }
+}
 
-        FactMetaData::ValueType_t factType = (ptype == AP_PARAM_INT8  ? FactMetaData::valueTypeInt8  :
-                                              ptype == AP_PARAM_INT16 ? FactMetaData::valueTypeInt16 :
-                                              ptype == AP_PARAM_INT32 ? FactMetaData::valueTypeInt32 :
-                                              FactMetaData::valueTypeFloat);
+/// Decodes the next block of param.pck and updates the Facts for all parameters contained in it
+void ParameterManager::_ftpDecodeBlock(const QByteArray& data)
+{
+    QList<ParamPackDecoder::Param_t> params;
 
-        Fact* fact = nullptr;
-        if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
-            fact = _mapCompId2FactMap[componentId][parameterName];
-        } else {
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
+    _ftpContiguousBytes += static_cast<uint32_t>(data.size());
+    if (!_ftpParamDecoder.addData(data, params)) {
+        qCDebug(ParameterManagerLog) << "ParameterManager::_ftpDecodeBlock : Error in parameter file";
+    }
 
-            fact = new Fact(componentId, parameterName, factType, this);
-            FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
-            fact->setMetaData(factMetaData);
+    if (!params.isEmpty()) {
+        // Download is making progress, FTPManager takes care of timeouts from here on
+        _initialRequestTimeoutTimer.stop();
+    }
+    for (const ParamPackDecoder::Param_t& param: params) {
+        _ftpParamReceived(param);
+    }
+
+    if (_ftpParamDecoder.paramCount()) {
+        _setLoadProgress(static_cast<double>(_ftpParamDecoder.decodedCount()) / _ftpParamDecoder.paramCount());
+    }
+}
+
+void ParameterManager::_ftpParamReceived(const ParamPackDecoder::Param_t& param)
+{
+    const int componentId = MAV_COMP_ID_AUTOPILOT1; /* Only main autopilot for the moment */
 
-            _mapCompId2FactMap[componentId][parameterName] = fact;
+    Fact* fact = _mapCompId2FactMap[componentId].value(param.name);
+    if (!fact) {
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << param.name;
 
-            // We need to know when the fact value changes so we can update the vehicle
-            connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
+        fact = new Fact(componentId, param.name, param.type, this);
+        FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(param.name, fact->type());
+        fact->setMetaData(factMetaData);
 
-            emit factAdded(componentId, fact);
-        }
-        fact->_containerSetRawValue(parameterValue);
+        _addFact(componentId, param.name, fact);
+
+        // We need to know when the fact value changes so we can update the vehicle
+        connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
+
+        emit factAdded(componentId, fact);
     }
-Success:
-    file.close();
+    fact->_containerSetRawValue(param.value);
+}
+
+void ParameterManager::_ftpParamLoadComplete(void)
+{
+    const int componentId   = MAV_COMP_ID_AUTOPILOT1;
+    int       paramCount    = _ftpParamDecoder.paramCount();
+
     /* Create empty waiting lists as we have all parameters */
-    _paramCountMap[componentId] = num_params;
-    _totalParamCount += num_params;
+    _paramCountMap[componentId] = paramCount;
+    _totalParamCount += paramCount;
     _waitingReadParamIndexMap[componentId] = QMap<int, int>();
     _waitingReadParamNameMap[componentId] = QMap<QString, int>();
     _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
     _checkInitialLoadComplete();
     _setLoadProgress(0.0);
-    return true;
+}
 
-Error:
-    file.close();
-    return false;
+/// The parameters in param.pck are in index order. So when the download stops part way through, the parameters
+/// which were not decoded are requested by index using PARAM_VALUE instead of starting over.
+void ParameterManager::_ftpLoadMissingParams(void)
+{
+    const int componentId   = MAV_COMP_ID_AUTOPILOT1;
+    int       paramCount    = _ftpParamDecoder.paramCount();
+
+    qCDebug(ParameterManagerLog) << "ParameterManager-ftp: Requesting missing parameters - decoded:count" << _ftpParamDecoder.decodedCount() << paramCount;
+
+    _tryftp = false;
+    _initialRequestRetryCount = 0;
+    _initialRequestTimeoutTimer.stop();
+
+    _paramCountMap[componentId] = paramCount;
+    _totalParamCount += paramCount;
+    _waitingReadParamIndexMap[componentId] = QMap<int, int>();
+    for (int waitingIndex=_ftpParamDecoder.decodedCount(); waitingIndex<paramCount; waitingIndex++) {
+        _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
+    }
+    _waitingReadParamNameMap[componentId] = QMap<QString, int>();
+    _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
+
+    _waitingParamTimeout();
 }
@@ -16,12 +16,15 @@
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
+#include "ParamPackDecoder.h"
+#include "ParameterFactMap.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
@@ -43,6 +46,7 @@ public:
     Q_PROPERTY(bool     missingParameters   READ missingParameters  NOTIFY missingParametersChanged)    ///< true: Parameters are missing from firmware response, false: all parameters received from firmware
     Q_PROPERTY(double   loadProgress        READ loadProgress       NOTIFY loadProgressChanged)
     Q_PROPERTY(bool     pendingWrites       READ pendingWrites      NOTIFY pendingWritesChanged)        ///< true: There are still pending write updates against the vehicle
+    Q_PROPERTY(bool     bulkWriteActive     READ bulkWriteActive    NOTIFY bulkWriteActiveChanged)      ///< true: A bulk write transaction is in progress
 
     bool parametersReady    (void) const { return _parametersReady; }
     bool missingParameters  (void) const { return _missingParameters; }
@@ -84,6 +88,16 @@ public:
     ///     @param name: Parameter name
     Fact* getParameter(int componentId, const QString& paramName);
 
+    /// Returns a handle for the specified parameter. Handles stay valid for the life of the ParameterManager, so C++
+    /// callers which access a parameter repeatedly can look it up once and use parameterForHandle after that.
+    ///     @param componentId: Component id or FactSystem::defaultComponentId
+    ///     @param name: Parameter name
+    /// @return -1 if the parameter does not exist
+    int parameterHandle(int componentId, const QString& paramName);
+
+    /// @return Parameter for a handle returned by parameterHandle
+    Fact* parameterForHandle(int handle) { return _handleFacts[handle]; }
+
     /// Returns error messages from loading
     QString readParametersFromStream(QTextStream& stream);
 
@@ -91,6 +105,28 @@ public:
 
     bool pendingWrites(void);
 
+    typedef struct {
+        int                         componentId;
+        QString                     name;
+        FactMetaData::ValueType_t   valueType;      ///< Only used for parameters which are not yet known to the vehicle
+        QVariant                    rawValue;
+    } BulkWriteParam_t;
+
+    /// Writes a set of parameters as a single transaction. Parameters which already have the requested value are skipped,
+    /// the rest are sent with at most _bulkWriteWindow PARAM_SETs outstanding and each PARAM_VALUE response is checked
+    /// against the requested value. Parameters added while a transaction is active join it. Failures are reported once
+    /// for the whole transaction through bulkWriteComplete instead of one message per parameter.
+    ///     @return Number of parameters which will be written
+    int bulkWrite(const QList<BulkWriteParam_t>& params);
+
+    /// QML version of bulkWrite. Nothing is written if any parameter does not exist or a value cannot be converted.
+    ///     @param nameValues: Key: Parameter name, Value: new raw value
+    ///     @param componentId: Component id or FactSystem::defaultComponentId
+    ///     @return Number of parameters which will be written, -1 if nothing was written due to an error
+    Q_INVOKABLE int writeParameters(const QVariantMap& nameValues, int componentId = FactSystem::defaultComponentId);
+
+    bool bulkWriteActive(void) const { return _bulkWriteTotal > 0; }
+
     Vehicle* vehicle(void) { return _vehicle; }
 
     static MAV_PARAM_TYPE               factTypeToMavType(FactMetaData::ValueType_t factType);
@@ -102,6 +138,11 @@ signals:
     void loadProgressChanged        (float value);
     void pendingWritesChanged       (bool pendingWrites);
     void factAdded                  (int componentId, Fact* fact);
+    void bulkWriteActiveChanged     (bool bulkWriteActive);
+    void bulkWriteProgress          (int completed, int total);
+    /// @param written Parameters acked with the requested value
+    /// @param failed Parameters which timed out or were acked with a different value
+    void bulkWriteComplete          (int written, int failed, int elapsedMsecs, double paramsPerSecond);
 
 private slots:
     void    _factRawValueUpdated                (const QVariant& rawValue);
@@ -127,15 +168,23 @@ private:
     void    _updateProgressBar                  (void);
     void    _checkInitialLoadComplete           (void);
     void    _ftpDownloadComplete                (const QString& fileName, const QString& errorMsg);
-    void    _ftpDownloadProgress                (float progress);
-    bool    _parseParamFile                     (const QString& filename);
+    void    _ftpDownloadData                    (uint32_t offset, const QByteArray& data);
+    void    _ftpDecodeBlock                     (const QByteArray& data);
+    void    _ftpParamReceived                   (const ParamPackDecoder::Param_t& param);
+    void    _ftpParamLoadComplete               (void);
+    void    _ftpLoadMissingParams               (void);
+    void    _bulkWriteSendNext                  (void);
+    void    _bulkWriteParamDone                 (int componentId, const QString& name, bool success);
+
+    Fact*   _addFact                            (int componentId, const QString& paramName, Fact* fact);
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
 
     Vehicle*            _vehicle;
     MAVLinkProtocol*    _mavlink;
 
-    QMap<int /* comp id */, QMap<QString /* parameter name */, Fact*>> _mapCompId2FactMap;
+    QMap<int /* comp id */, ParameterFactMap>   _mapCompId2FactMap;
+    QVector<Fact*>                              _handleFacts;           ///< Indexed by parameter handle
 
     double      _loadProgress;                  ///< Parameter load progess, [0.0,1.0]
     bool        _parametersReady;               ///< true: parameter load complete
@@ -187,5 +236,20 @@ private:
     Fact _defaultFact;   ///< Used to return default fact, when parameter not found
 
     /* MavFTP */
-    bool               _tryftp;
+    bool                        _tryftp;
+    ParamPackDecoder            _ftpParamDecoder;
+    QString                     _ftpDownloadFile;           ///< Local path of param.pck, FTPManager signals are shared with other downloads
+    uint32_t                    _ftpContiguousBytes = 0;    ///< Bytes of param.pck from the start of the file which have been decoded
+    QMap<uint32_t, QByteArray>  _ftpOutOfOrderData;         ///< Blocks received after a gap, keyed by file offset
+
+    /* Bulk write */
+    typedef QPair<int /* component id */, QString /* param name */> BulkWriteKey;
+    QList<BulkWriteParam_t>                 _bulkWriteQueue;            ///< Waiting for a free slot in the window
+    QMap<BulkWriteKey, BulkWriteParam_t>    _bulkWriteInFlight;         ///< Sent, waiting on PARAM_VALUE
+    int                                     _bulkWriteTotal     = 0;
+    int                                     _bulkWriteWritten   = 0;
+    int                                     _bulkWriteFailed    = 0;
+    QStringList                             _bulkWriteFailedNames;
+    QElapsedTimer                           _bulkWriteElapsed;
+    static const int                        _bulkWriteWindow    = 10;   ///< Maximum outstanding PARAM_SETs
 };
@@ -231,3 +231,70 @@ void ParameterManagerTest::_FTPChangeParam()
     QCOMPARE(arguments.count(), 1);
     QCOMPARE(arguments.at(0).toFloat(), 0.0f);
 }
+
+void ParameterManagerTest::_bulkWrite(void)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    ParameterManager* paramMgr = vehicle->parameterManager();
+
+    // Unknown parameters fail the whole transaction
+    QVariantMap nameValues;
+    nameValues["MPC_XY_CRUISE"] = 7.5;
+    nameValues["NOT_A_PARAM"]   = 1;
+    QCOMPARE(paramMgr->writeParameters(nameValues), -1);
+    QCOMPARE(paramMgr->bulkWriteActive(), false);
+
+    // Values which already match the vehicle are not sent
+    QSignalSpy spyComplete(paramMgr, &ParameterManager::bulkWriteComplete);
+    nameValues.remove("NOT_A_PARAM");
+    nameValues["MPC_Z_VEL_MAX_UP"] = paramMgr->getParameter(FactSystem::defaultComponentId, "MPC_Z_VEL_MAX_UP")->rawValue();
+    QCOMPARE(paramMgr->writeParameters(nameValues), 1);
+    QCOMPARE(paramMgr->bulkWriteActive(), true);
+    QCOMPARE(spyComplete.wait(5000), true);
+    QList<QVariant> arguments = spyComplete.takeFirst();
+    QCOMPARE(arguments.at(0).toInt(), 1);   // written
+    QCOMPARE(arguments.at(1).toInt(), 0);   // failed
+    QCOMPARE(paramMgr->bulkWriteActive(), false);
+    QCOMPARE(paramMgr->getParameter(FactSystem::defaultComponentId, "MPC_XY_CRUISE")->rawValue().toFloat(), 7.5f);
+
+    // Nothing changed, nothing to do
+    QCOMPARE(paramMgr->writeParameters(nameValues), 0);
+}
+
+void ParameterManagerTest::_parameterHandles(void)
+{
+    _noFailureWorker(MockConfiguration::FailNone);
+
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    QVERIFY(vehicle);
+    ParameterManager* paramMgr = vehicle->parameterManager();
+
+    // Names come back in sorted order, the same as they did from the old QMap storage
+    QStringList names = paramMgr->parameterNames(MAV_COMP_ID_AUTOPILOT1);
+    QVERIFY(names.count() > 0);
+    QStringList sortedNames = names;
+    sortedNames.sort();
+    QCOMPARE(names, sortedNames);
+
+    QSet<int> handles;
+    for (const QString& name: names) {
+        int handle = paramMgr->parameterHandle(MAV_COMP_ID_AUTOPILOT1, name);
+        QVERIFY(handle != -1);
+        QVERIFY(!handles.contains(handle));
+        handles.insert(handle);
+        QCOMPARE(paramMgr->parameterForHandle(handle), paramMgr->getParameter(MAV_COMP_ID_AUTOPILOT1, name));
+        QCOMPARE(paramMgr->parameterForHandle(handle)->name(), name);
+    }
+
+    QCOMPARE(paramMgr->parameterHandle(MAV_COMP_ID_AUTOPILOT1, QStringLiteral("NOT_A_PARAMETER")), -1);
+    QCOMPARE(paramMgr->parameterExists(MAV_COMP_ID_AUTOPILOT1, QStringLiteral("NOT_A_PARAMETER")), false);
+}
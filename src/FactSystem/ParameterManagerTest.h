@@ -27,6 +27,8 @@ private slots:
     void _requestListMissingParamFail(void);
     void _FTPnoFailure(void);
     void _FTPChangeParam(void);
+    void _bulkWrite(void);
+    void _parameterHandles(void);
 
 
 private:
@@ -13,6 +13,14 @@
 #include "QGCApplication.h"
 
 #include <QSettings>
+#include <QTimer>
+#include <QHash>
+
+namespace {
+    /// Pending values keyed by settings key, written by flushPendingWrites
+    QHash<QString, QVariant>    pendingWrites;
+    QTimer*                     pendingWriteTimer = nullptr;
+}
 
 SettingsFact::SettingsFact(QObject* parent)
     : Fact(parent)
@@ -74,11 +82,32 @@ const SettingsFact& SettingsFact::operator=(const SettingsFact& other)
 
 void SettingsFact::_rawValueChanged(QVariant value)
 {
-    QSettings settings;
+    pendingWrites[_settingsGroup.isEmpty() ? _name : QStringLiteral("%1/%2").arg(_settingsGroup, _name)] = value;
 
-    if (!_settingsGroup.isEmpty()) {
-        settings.beginGroup(_settingsGroup);
+    if (!pendingWriteTimer) {
+        pendingWriteTimer = new QTimer(qgcApp());
+        pendingWriteTimer->setSingleShot(true);
+        pendingWriteTimer->setInterval(_writeDelayMSecs);
+        connect(pendingWriteTimer, &QTimer::timeout, &SettingsFact::flushPendingWrites);
+    }
+    if (!pendingWriteTimer->isActive()) {
+        pendingWriteTimer->start();
     }
+}
 
-    settings.setValue(_name, value);
+void SettingsFact::flushPendingWrites(void)
+{
+    if (pendingWriteTimer) {
+        pendingWriteTimer->stop();
+    }
+    if (pendingWrites.isEmpty()) {
+        return;
+    }
+
+    // A single QSettings instance so all changes go to storage in one sync
+    QSettings settings;
+    for (auto iter = pendingWrites.constBegin(); iter != pendingWrites.constEnd(); iter++) {
+        settings.setValue(iter.key(), iter.value());
+    }
+    pendingWrites.clear();
 }
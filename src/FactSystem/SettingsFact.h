@@ -11,7 +11,12 @@
 
 #include "Fact.h"
 
+#include <atomic>
+
 /// @brief A SettingsFact is Fact which holds a QSettings value.
+///
+/// Changes are not written to QSettings immediately. They are collected and written together after
+/// _writeDelayMSecs, so a slider which changes a setting at every step only touches storage once.
 class SettingsFact : public Fact
 {
     Q_OBJECT
@@ -28,10 +33,37 @@ public:
     // Must be called before any references to fact
     void setVisible(bool visible) { _visible = visible; }
 
+    /// Writes all pending changes to QSettings now
+    static void flushPendingWrites(void);
+
 private slots:
     void _rawValueChanged(QVariant value);
 
 private:
     QString _settingsGroup;
     bool    _visible;
+
+    static const int _writeDelayMSecs = 1000;
+};
+
+/// @brief Native copy of a Fact raw value for reads in hot paths.
+///
+/// The value is updated through Fact::rawValueChanged, so a read does not go through QVariant or the settings manager.
+/// Reads are safe from any thread. Usage: _saveNotArmed.bind(appSettings->telemetrySaveNotArmed(), this);
+template<typename T>
+class SettingsFactValue
+{
+public:
+    /// @param context Destroying the context object stops the updates
+    void bind(Fact* fact, QObject* context)
+    {
+        _value = fact->rawValue().value<T>();
+        QObject::connect(fact, &Fact::rawValueChanged, context, [this](QVariant value) { _value = value.value<T>(); });
+    }
+
+    T value(void) const { return _value; }
+    operator T(void) const { return _value; }
+
+private:
+    std::atomic<T> _value { T() };
 };
@@ -418,6 +418,8 @@ void APMFirmwarePlugin::initializeStreamRates(Vehicle* vehicle)
         instanceData = new APMFirmwarePluginInstanceData(vehicle);
         instanceData->lastBatteryStatusTime = instanceData->lastHomePositionTime = QTime::currentTime();
         vehicle->setFirmwarePluginInstanceData(instanceData);
+        // Requested rates follow the capacity of the primary link
+        connect(vehicle->vehicleLinkManager(), &VehicleLinkManager::telemetryScaleChanged, instanceData, [this, vehicle]() { initializeStreamRates(vehicle); });
     }
 
     if (qgcApp()->toolbox()->settingsManager()->appSettings()->apmStartMavlinkStreams()->rawValue().toBool()) {
@@ -427,23 +429,29 @@ void APMFirmwarePlugin::initializeStreamRates(Vehicle* vehicle)
         struct StreamInfo_s {
             MAV_DATA_STREAM mavStream;
             int             streamRate;
+            bool            scaled;         ///< false: status and position are kept at the full rate on slow links
         };
 
         StreamInfo_s rgStreamInfo[] = {
-            { MAV_DATA_STREAM_RAW_SENSORS,      streamRates->streamRateRawSensors()->rawValue().toInt() },
-            { MAV_DATA_STREAM_EXTENDED_STATUS,  streamRates->streamRateExtendedStatus()->rawValue().toInt() },
-            { MAV_DATA_STREAM_RC_CHANNELS,      streamRates->streamRateRCChannels()->rawValue().toInt() },
-            { MAV_DATA_STREAM_POSITION,         streamRates->streamRatePosition()->rawValue().toInt() },
-            { MAV_DATA_STREAM_EXTRA1,           streamRates->streamRateExtra1()->rawValue().toInt() },
-            { MAV_DATA_STREAM_EXTRA2,           streamRates->streamRateExtra2()->rawValue().toInt() },
-            { MAV_DATA_STREAM_EXTRA3,           streamRates->streamRateExtra3()->rawValue().toInt() },
+            { MAV_DATA_STREAM_RAW_SENSORS,      streamRates->streamRateRawSensors()->rawValue().toInt(),        true },
+            { MAV_DATA_STREAM_EXTENDED_STATUS,  streamRates->streamRateExtendedStatus()->rawValue().toInt(),    false },
+            { MAV_DATA_STREAM_RC_CHANNELS,      streamRates->streamRateRCChannels()->rawValue().toInt(),        true },
+            { MAV_DATA_STREAM_POSITION,         streamRates->streamRatePosition()->rawValue().toInt(),          false },
+            { MAV_DATA_STREAM_EXTRA1,           streamRates->streamRateExtra1()->rawValue().toInt(),            true },
+            { MAV_DATA_STREAM_EXTRA2,           streamRates->streamRateExtra2()->rawValue().toInt(),            true },
+            { MAV_DATA_STREAM_EXTRA3,           streamRates->streamRateExtra3()->rawValue().toInt(),            true },
         };
 
+        const double telemetryScale = vehicle->vehicleLinkManager()->telemetryScale();
         for (size_t i=0; i<sizeof(rgStreamInfo)/sizeof(rgStreamInfo[0]); i++) {
             const StreamInfo_s& streamInfo = rgStreamInfo[i];
 
             if (streamInfo.streamRate >= 0) {
-                vehicle->requestDataStream(streamInfo.mavStream, static_cast<uint16_t>(streamInfo.streamRate));
+                int streamRate = streamInfo.streamRate;
+                if (streamInfo.scaled && streamRate > 0) {
+                    streamRate = qMax(1, qRound(streamRate * telemetryScale));
+                }
+                vehicle->requestDataStream(streamInfo.mavStream, static_cast<uint16_t>(streamRate));
             }
         }
     }
@@ -1025,7 +1033,7 @@ void APMFirmwarePlugin::_sendGCSMotionReport(Vehicle* vehicle, FollowMe::GCSMoti
                                                     sharedLink->mavlinkChannel(),
                                                     &message,
                                                     &globalPositionInt);
-        vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
+        vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message, LinkInterface::WritePriorityRealtime);
     }
 }
 
@@ -13,6 +13,18 @@
 
 #include "FirmwarePluginManager.h"
 #include "FirmwarePlugin.h"
+#include "QGCApplication.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtConcurrent>
+#include <QFile>
+#include <QSettings>
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(FirmwarePluginManagerLog, "FirmwarePluginManagerLog")
+
+const char* FirmwarePluginManager::_settingsGroup                   = "FirmwarePluginManager";
+const char* FirmwarePluginManager::_lastParameterMetaDataFileKey    = "LastParameterMetaDataFile%1";
 
 FirmwarePluginManager::FirmwarePluginManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
@@ -23,9 +35,40 @@ FirmwarePluginManager::FirmwarePluginManager(QGCApplication* app, QGCToolbox* to
 
 FirmwarePluginManager::~FirmwarePluginManager()
 {
+    // Background loads reference the plugins, so they must complete before the plugins go away
+    for (QFuture<QObject*>& future: _pendingParameterMetaData) {
+        future.waitForFinished();
+        delete future.result();
+    }
+    _pendingParameterMetaData.clear();
+
     delete _genericFirmwarePlugin;
 }
 
+void FirmwarePluginManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    if (qgcApp()->runningUnitTests()) {
+        return;
+    }
+
+    // Start loading the meta data used by the last vehicle of each firmware type so it is ready by the time a
+    // vehicle connects. Settings are already available at this point, which FactMetaData needs for unit translation.
+    QSettings settings;
+    settings.beginGroup(_settingsGroup);
+    for (QGCMAVLink::FirmwareClass_t firmwareClass: supportedFirmwareClasses()) {
+        MAV_AUTOPILOT   firmwareType    = QGCMAVLink::firmwareClassToAutopilot(firmwareClass);
+        QString         metaDataFile    = settings.value(QString(_lastParameterMetaDataFileKey).arg(firmwareType)).toString();
+        if (!metaDataFile.isEmpty() && (metaDataFile.startsWith(QStringLiteral(":/")) || QFile::exists(metaDataFile))) {
+            QList<QGCMAVLink::VehicleClass_t> vehicleClasses = supportedVehicleClasses(firmwareClass);
+            if (!vehicleClasses.isEmpty()) {
+                preloadParameterMetaData(firmwarePluginForAutopilot(firmwareType, QGCMAVLink::vehicleClassToMavType(vehicleClasses[0])), metaDataFile);
+            }
+        }
+    }
+}
+
 QList<QGCMAVLink::FirmwareClass_t> FirmwarePluginManager::supportedFirmwareClasses(void)
 {
     if (_supportedFirmwareClasses.isEmpty()) {
@@ -91,3 +134,55 @@ FirmwarePluginFactory* FirmwarePluginManager::_findPluginFactory(QGCMAVLink::Fir
 
     return nullptr;
 }
+
+/// Runs on a thread pool thread. The meta data objects are created on the pool thread, so the whole tree is moved
+/// over to the thread which will use it once loading completes.
+QObject* FirmwarePluginManager::_loadParameterMetaDataThread(FirmwarePlugin* plugin, const QString& metaDataFile, QThread* resultThread)
+{
+    QObject* metaData = plugin->_loadParameterMetaData(metaDataFile);
+    if (metaData) {
+        metaData->moveToThread(resultThread);
+    }
+    return metaData;
+}
+
+void FirmwarePluginManager::preloadParameterMetaData(FirmwarePlugin* plugin, const QString& metaDataFile)
+{
+    if (_pendingParameterMetaData.contains(metaDataFile)) {
+        return;
+    }
+
+    qCDebug(FirmwarePluginManagerLog) << "Background load of parameter meta data" << metaDataFile;
+    _pendingParameterMetaData[metaDataFile] = QtConcurrent::run(&FirmwarePluginManager::_loadParameterMetaDataThread, plugin, metaDataFile, thread());
+}
+
+QObject* FirmwarePluginManager::takeParameterMetaData(FirmwarePlugin* plugin, MAV_AUTOPILOT firmwareType, const QString& metaDataFile)
+{
+    QObject* metaData;
+
+    if (_pendingParameterMetaData.contains(metaDataFile)) {
+        QFuture<QObject*> future = _pendingParameterMetaData.take(metaDataFile);
+        if (!future.isFinished()) {
+            qCDebug(FirmwarePluginManagerLog) << "Waiting for background load of parameter meta data" << metaDataFile;
+        }
+        metaData = future.result();
+    } else {
+        metaData = plugin->_loadParameterMetaData(metaDataFile);
+    }
+
+    if (!qgcApp()->runningUnitTests()) {
+        QSettings settings;
+        settings.beginGroup(_settingsGroup);
+        settings.setValue(QString(_lastParameterMetaDataFileKey).arg(firmwareType), metaDataFile);
+    }
+
+    return metaData;
+}
+
+void FirmwarePluginManager::discardParameterMetaData(const QString& metaDataFile)
+{
+    if (_pendingParameterMetaData.contains(metaDataFile)) {
+        QFuture<QObject*> future = _pendingParameterMetaData.take(metaDataFile);
+        delete future.result();
+    }
+}
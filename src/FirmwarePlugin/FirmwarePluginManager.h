@@ -10,12 +10,18 @@
 #pragma once
 
 #include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QLoggingCategory>
 
 #include "FirmwarePlugin.h"
 #include "QGCMAVLink.h"
 #include "QGCToolbox.h"
 
 class QGCApplication;
+class QThread;
+
+Q_DECLARE_LOGGING_CATEGORY(FirmwarePluginManagerLog)
 
 /// FirmwarePluginManager is a singleton which is used to return the correct FirmwarePlugin for a MAV_AUTOPILOT type.
 
@@ -39,9 +45,32 @@ public:
     /// @return Singleton FirmwarePlugin instance for the specified MAV_AUTOPILOT.
     FirmwarePlugin* firmwarePluginForAutopilot(MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType);
 
+    /// Starts loading the parameter meta data file on a background thread. Does nothing if a load for the file is
+    /// already pending.
+    /// Important: Only CompInfoParam code should use this method
+    void preloadParameterMetaData(FirmwarePlugin* plugin, const QString& metaDataFile);
+
+    /// Returns the opaque parameter meta data for the file. Waits for a pending background load if there is one,
+    /// otherwise the file is loaded synchronously. The caller takes ownership of the returned object.
+    /// Important: Only CompInfoParam code should use this method
+    QObject* takeParameterMetaData(FirmwarePlugin* plugin, MAV_AUTOPILOT firmwareType, const QString& metaDataFile);
+
+    /// Throws away the result of a background load, used when the meta data file is replaced on disk
+    void discardParameterMetaData(const QString& metaDataFile);
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) override;
+
 private:
     FirmwarePluginFactory* _findPluginFactory(QGCMAVLink::FirmwareClass_t firmwareClass);
 
+    static QObject* _loadParameterMetaDataThread(FirmwarePlugin* plugin, const QString& metaDataFile, QThread* resultThread);
+
+    QHash<QString, QFuture<QObject*>>   _pendingParameterMetaData;  ///< Background loads keyed by meta data file
+
+    static const char* _settingsGroup;
+    static const char* _lastParameterMetaDataFileKey;
+
     FirmwarePlugin*                     _genericFirmwarePlugin;
     QList<QGCMAVLink::FirmwareClass_t>  _supportedFirmwareClasses;
 };
@@ -19,6 +19,7 @@ import QGroundControl.Controls          1.0
 import QGroundControl.Palette           1.0
 import QGroundControl.Vehicle           1.0
 import QGroundControl.Controllers       1.0
+import QGroundControl.VideoManager      1.0
 
 Item {
     id:     root
@@ -35,6 +36,7 @@ Item {
     property var    _camera:            _isCamera ? _dynamicCameras.cameras.get(_curCameraIndex) : null
     property bool   _hasZoom:           _camera && _camera.hasZoom
     property int    _fitMode:           QGroundControl.settingsManager.videoSettings.videoFit.rawValue
+    property var    _videoSettings:     QGroundControl.settingsManager.videoSettings
 
     property double _thermalHeightFactor: 0.85 //-- TODO
 
@@ -161,13 +163,32 @@ Item {
             }
             onVisibleChanged: {
                 thermalItem.pipOrNot()
+                QGroundControl.videoManager.setStreamVisibility(1, visible ? VideoManager.StreamVisible : VideoManager.StreamHidden)
             }
             QGCVideoBackground {
                 id:             thermalVideo
                 objectName:     "thermalVideo"
                 anchors.fill:   parent
                 receiver:       QGroundControl.videoManager.thermalVideoReceiver
-                opacity:        _camera ? (_camera.thermalMode === QGCCameraControl.THERMAL_BLEND ? _camera.thermalOpacity / 100 : 1.0) : 0
+                opacity:        _camera ? (_thermalBlend && !_thermalShader ? _camera.thermalOpacity / 100 : 1.0) : 0
+
+                //-- Palette, range and isotherm are applied on the GPU, blend opacity is per pixel so isotherms stay opaque
+                layer.enabled:  _thermalShader
+                layer.smooth:   true
+                layer.effect:   ThermalColormapEffect {
+                    palette:        _videoSettings.thermalPalette.rawValue
+                    spanMin:        _videoSettings.thermalSpanMin.rawValue
+                    spanMax:        _videoSettings.thermalSpanMax.rawValue
+                    rangeMin:       _videoSettings.thermalRangeMin.rawValue
+                    rangeMax:       _videoSettings.thermalRangeMax.rawValue
+                    isotherm:       _videoSettings.thermalIsotherm.rawValue
+                    isothermMin:    _videoSettings.thermalIsothermMin.rawValue
+                    isothermMax:    _videoSettings.thermalIsothermMax.rawValue
+                    blendOpacity:   _thermalBlend ? _camera.thermalOpacity / 100 : 1.0
+                }
+
+                property bool _thermalBlend:    _camera && _camera.thermalMode === QGCCameraControl.THERMAL_BLEND
+                property bool _thermalShader:   _videoSettings.thermalPalette.rawValue !== 0 || _videoSettings.thermalIsotherm.rawValue
             }
         }
         //-- Zoom
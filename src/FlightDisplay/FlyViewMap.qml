@@ -54,6 +54,14 @@ FlightMap {
     property bool   _airspaceEnabled:           QGroundControl.airmapSupported ? (QGroundControl.settingsManager.airMapSettings.enableAirMap.rawValue && QGroundControl.airspaceManager.connected): false
     property var    _flyViewSettings:           QGroundControl.settingsManager.flyViewSettings
     property bool   _keepMapCenteredOnVehicle:  _flyViewSettings.keepMapCenteredOnVehicle.rawValue
+    property var    _adsbVehicles:              QGroundControl.adsbVehicleManager.adsbVehicles
+    property bool   _batchAdsbVehicles:         _adsbVehicles.count > _adsbBatchThreshold   // Above this many vehicles they are drawn without labels
+
+    property var    _cameraTriggerPoints:       _activeVehicle ? _activeVehicle.cameraTriggerPoints : null
+    property bool   _batchCameraTriggers:       _cameraTriggerPoints ? _cameraTriggerPoints.count > _cameraTriggerBatchThreshold : false
+
+    readonly property int _adsbBatchThreshold:  50
+    readonly property int _cameraTriggerBatchThreshold: 100
 
     property bool   _disableVehicleTracking:    false
     property bool   _keepVehicleCentered:       pipMode ? true : false
@@ -229,26 +237,41 @@ FlightMap {
         showText: !pipMode
     }
 
-    // Add trajectory lines to the map
-    MapPolyline {
-        id:         trajectoryPolyline
-        line.width: 3
-        line.color: "red"
-        z:          QGroundControl.zOrderTrajectoryLines
-        visible:    !pipMode
+    // Add trajectory lines to the map. The trajectory can have many points, so it is drawn in a single scene graph node.
+    MapBatchItem {
+        id:             trajectoryPolyline
+        anchors.fill:   parent
+        map:            _root
+        lineWidth:      3
+        color:          "red"
+        z:              QGroundControl.zOrderTrajectoryLines
+        visible:        !pipMode
 
         Connections {
             target:                 QGroundControl.multiVehicleManager
             function onActiveVehicleChanged(activeVehicle) {
+                if (_activeVehicle) {
+                    _activeVehicle.trajectoryPoints.setDisplayZoom(_root.zoomLevel)
+                }
                 trajectoryPolyline.path = _activeVehicle ? _activeVehicle.trajectoryPoints.list() : []
             }
         }
 
+        Connections {
+            target:                 _root
+            function onZoomLevelChanged() {
+                if (_activeVehicle) {
+                    _activeVehicle.trajectoryPoints.setDisplayZoom(_root.zoomLevel)
+                }
+            }
+        }
+
         Connections {
             target:                 _activeVehicle ? _activeVehicle.trajectoryPoints : null
             onPointAdded:           trajectoryPolyline.addCoordinate(coordinate)
-            onUpdateLastPoint:      trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
+            onUpdateLastPoint:      trajectoryPolyline.replaceLastCoordinate(coordinate)
             onPointsCleared:        trajectoryPolyline.path = []
+            onPointsReset:          trajectoryPolyline.path = _activeVehicle.trajectoryPoints.list()
         }
     }
 
@@ -273,15 +296,26 @@ FlightMap {
             z:              QGroundControl.zOrderVehicles
         }
     }
-    // Add ADSB vehicles to the map
+    // Add ADSB vehicles to the map. Busy airspace is drawn as batched icons without callsign labels.
+    MapBatchItem {
+        anchors.fill:   parent
+        map:            _root
+        model:          _batchAdsbVehicles ? _adsbVehicles : null
+        iconSize:       ScreenTools.defaultFontPixelHeight * 1.5
+        color:          "white"
+        alertColor:     "red"
+        z:              QGroundControl.zOrderVehicles
+        visible:        _batchAdsbVehicles
+    }
+
     MapItemView {
-        model: QGroundControl.adsbVehicleManager.adsbVehicles
+        model: _batchAdsbVehicles ? null : _adsbVehicles
         delegate: VehicleMapItem {
             coordinate:     object.coordinate
             altitude:       object.altitude
             callsign:       object.callsign
             heading:        object.heading
-            alert:          object.alert
+            alert:          object.alert || object.conflict
             map:            _root
             z:              QGroundControl.zOrderVehicles
         }
@@ -349,9 +383,20 @@ FlightMap {
         }
     }
 
-    // Camera trigger points
+    // Camera trigger points. Large surveys are drawn as batched markers with overlapping markers culled.
+    MapBatchItem {
+        anchors.fill:   parent
+        map:            _root
+        model:          _batchCameraTriggers ? _cameraTriggerPoints : null
+        iconSize:       ScreenTools.defaultFontPixelHeight
+        minIconSpacing: ScreenTools.defaultFontPixelHeight * 0.5
+        color:          "white"
+        z:              QGroundControl.zOrderTopMost
+        visible:        _batchCameraTriggers
+    }
+
     MapItemView {
-        model: _activeVehicle ? _activeVehicle.cameraTriggerPoints : 0
+        model: _batchCameraTriggers ? null : (_cameraTriggerPoints ? _cameraTriggerPoints : 0)
 
         delegate: CameraTriggerIndicator {
             coordinate:     object.coordinate
@@ -13,12 +13,17 @@ import QGroundControl               1.0
 import QGroundControl.Controls      1.0
 import QGroundControl.Controllers   1.0
 import QGroundControl.ScreenTools   1.0
+import QGroundControl.VideoManager  1.0
 
 Item {
     id:         _root
     visible:    QGroundControl.videoManager.hasVideo
 
     property Item pipState: videoPipState
+
+    // Collapsing the pip stops decoding, streaming and recording carry on
+    onVisibleChanged: QGroundControl.videoManager.setStreamVisibility(0, visible ? VideoManager.StreamVisible : VideoManager.StreamHidden)
+
     QGCPipState {
         id:         videoPipState
         pipOverlay: _pipOverlay
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+import QtQuick 2.11
+
+/// Colormap, display range and isotherm for the thermal video, done in a fragment shader.
+/// Used as the layer.effect of the thermal video item so the decoded frame never leaves the GPU.
+/// The stream luminance is mapped linearly onto the camera span (spanMin at black, spanMax at white) to get a
+/// temperature, which is then windowed to rangeMin/rangeMax and colored with the selected palette.
+ShaderEffect {
+    property var    source
+    property int    palette:        paletteWhiteHot
+    property real   spanMin:        -20
+    property real   spanMax:        150
+    property real   rangeMin:       -20
+    property real   rangeMax:       150
+    property bool   isotherm:       false
+    property real   isothermMin:    60
+    property real   isothermMax:    150
+    property real   blendOpacity:   1.0     ///< Opacity of pixels outside the isotherm, isotherm pixels are always opaque
+
+    readonly property int paletteCamera:    0
+    readonly property int paletteWhiteHot:  1
+    readonly property int paletteBlackHot:  2
+    readonly property int paletteIronbow:   3
+    readonly property int paletteRainbow:   4
+
+    fragmentShader: "
+        varying highp vec2      qt_TexCoord0;
+        uniform sampler2D       source;
+        uniform lowp float      qt_Opacity;
+        uniform int             palette;
+        uniform highp float     spanMin;
+        uniform highp float     spanMax;
+        uniform highp float     rangeMin;
+        uniform highp float     rangeMax;
+        uniform bool            isotherm;
+        uniform highp float     isothermMin;
+        uniform highp float     isothermMax;
+        uniform lowp float      blendOpacity;
+
+        lowp vec3 ironbow(highp float t) {
+            lowp vec3 c = mix(vec3(0.0, 0.0, 0.0),  vec3(0.3, 0.0, 0.55),   clamp(t / 0.2, 0.0, 1.0));
+            c = mix(c, vec3(0.8, 0.1, 0.4),  clamp((t - 0.2) / 0.25, 0.0, 1.0));
+            c = mix(c, vec3(1.0, 0.55, 0.0), clamp((t - 0.45) / 0.25, 0.0, 1.0));
+            c = mix(c, vec3(1.0, 0.9, 0.2),  clamp((t - 0.7) / 0.2, 0.0, 1.0));
+            return mix(c, vec3(1.0, 1.0, 1.0), clamp((t - 0.9) / 0.1, 0.0, 1.0));
+        }
+
+        lowp vec3 rainbow(highp float t) {
+            // Hue from blue (cold) to red (hot)
+            highp float h = (1.0 - t) * 0.66;
+            return clamp(abs(fract(h + vec3(1.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0) - 1.0, 0.0, 1.0);
+        }
+
+        void main() {
+            lowp vec4  pixel = texture2D(source, qt_TexCoord0);
+            highp float level = dot(pixel.rgb, vec3(0.299, 0.587, 0.114));
+            highp float temp = mix(spanMin, spanMax, level);
+            highp float t = clamp((temp - rangeMin) / max(rangeMax - rangeMin, 0.001), 0.0, 1.0);
+            lowp vec3 color = pixel.rgb;
+            if (palette == 1) {
+                color = vec3(t);
+            } else if (palette == 2) {
+                color = vec3(1.0 - t);
+            } else if (palette == 3) {
+                color = ironbow(t);
+            } else if (palette == 4) {
+                color = rainbow(t);
+            }
+            lowp float alpha = blendOpacity;
+            if (isotherm && temp >= isothermMin && temp <= isothermMax) {
+                // Red to yellow across the isotherm band
+                color = mix(vec3(1.0, 0.0, 0.0), vec3(1.0, 1.0, 0.0), clamp((temp - isothermMin) / max(isothermMax - isothermMin, 0.001), 0.0, 1.0));
+                alpha = 1.0;
+            }
+            gl_FragColor = vec4(color * alpha, alpha) * pixel.a * qt_Opacity;
+        }"
+}
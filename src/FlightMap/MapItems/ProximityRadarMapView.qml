@@ -17,10 +17,11 @@ import QGroundControl.ScreenTools   1.0
 import QGroundControl.Vehicle       1.0
 import QGroundControl.Controls      1.0
 import QGroundControl.FlightDisplay 1.0
+import QGroundControl.FlightMap     1.0
 
 MapQuickItem {
     id:             _root
-    visible:        proximityValues.telemetryAvailable && coordinate.isValid
+    visible:        (proximityValues.telemetryAvailable || _obstaclesAvailable) && coordinate.isValid
 
     property var    vehicle                                                         /// Vehicle object, undefined for ADSB vehicle
     property var    map
@@ -30,7 +31,10 @@ MapQuickItem {
     anchorPoint.y:  vehicleItem.height / 2
 
     property real   _ratio: 1
-    property real   _maxDistance:   isNaN(proximityValues.maxDistance)
+    property var    _objectAvoidance:       vehicle ? vehicle.objectAvoidance : null
+    property bool   _obstaclesAvailable:    _objectAvoidance ? _objectAvoidance.available : false
+    property real   _maxDistance:           Math.max(isNaN(proximityValues.maxDistance) ? 0 : proximityValues.maxDistance,
+                                                     _obstaclesAvailable ? _objectAvoidance.maxDistance / 100 : 0)
 
     function calcSize() {
         var scaleLinePixelLength    = 100
@@ -103,10 +107,23 @@ MapQuickItem {
             }
         }
 
+        // OBSTACLE_DISTANCE sectors of all sensors, fused and drawn in C++
+        ObstacleDistanceItem {
+            anchors.fill:       detectionLimitCircle
+            objectAvoidance:    _obstaclesAvailable ? _objectAvoidance : null
+            pixelsPerMeter:     _ratio
+
+            transform: Rotation {
+                origin.x:       detectionLimitCircle.width  / 2
+                origin.y:       detectionLimitCircle.height / 2
+                angle:          isNaN(heading) ? 0 : heading
+            }
+        }
+
         Rectangle {
             id:                 detectionLimitCircle
-            width:              proximityValues.maxDistance * 2 *_ratio
-            height:             proximityValues.maxDistance * 2 *_ratio
+            width:              _maxDistance * 2 *_ratio
+            height:             _maxDistance * 2 *_ratio
             anchors.fill:       detectionLimitCircle
             color:              Qt.rgba(1,1,1,0)
             border.color:       Qt.rgba(1,1,1,1)
@@ -13,6 +13,7 @@
 #include "MultiVehicleManager.h"
 #include "FirmwarePlugin.h"
 #include "MAVLinkProtocol.h"
+#include "MAVLinkPeriodicSender.h"
 #include "FollowMe.h"
 #include "Vehicle.h"
 #include "PositionManager.h"
@@ -24,15 +25,16 @@ QGC_LOGGING_CATEGORY(FollowMeLog, "FollowMeLog")
 FollowMe::FollowMe(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
 {
-    _gcsMotionReportTimer.setSingleShot(false);
+    _clock.start();
 }
 
 void FollowMe::setToolbox(QGCToolbox* toolbox)
 {
     QGCTool::setToolbox(toolbox);
 
-    connect(&_gcsMotionReportTimer,                                     &QTimer::timeout,       this, &FollowMe::_sendGCSMotionReport);
     connect(toolbox->settingsManager()->appSettings()->followTarget(),  &Fact::rawValueChanged, this, &FollowMe::_settingsChanged);
+    connect(toolbox->settingsManager()->appSettings()->followTargetRate(), &Fact::rawValueChanged, this, &FollowMe::_rateChanged);
+    connect(toolbox->qgcPositionManager(),                              &QGCPositionManager::positionInfoUpdated, this, &FollowMe::_positionInfoUpdated);
 
     _settingsChanged();
 }
@@ -60,29 +62,77 @@ void FollowMe::_settingsChanged()
     }
 }
 
+int FollowMe::_reportIntervalMSecs(void)
+{
+    uint rateHz = _toolbox->settingsManager()->appSettings()->followTargetRate()->rawValue().toUInt();
+    return 1000 / static_cast<int>(qBound(1u, rateHz, 50u));
+}
+
+void FollowMe::_rateChanged(void)
+{
+    if (_gcsMotionReportSendId) {
+        MAVLinkPeriodicSender::instance()->setInterval(_gcsMotionReportSendId, _reportIntervalMSecs());
+    }
+}
+
 void FollowMe::_enableFollowSend()
 {
-    if (!_gcsMotionReportTimer.isActive()) {
-        _gcsMotionReportTimer.setInterval(qMin(_toolbox->qgcPositionManager()->updateInterval(), 250));
-        _gcsMotionReportTimer.start();
+    if (!_gcsMotionReportSendId) {
+        _gcsMotionReportSendId = MAVLinkPeriodicSender::instance()->add(this, _reportIntervalMSecs(), [this]() { _sendGCSMotionReport(); });
     }
 }
 
 void FollowMe::_disableFollowSend()
 {
-    if (_gcsMotionReportTimer.isActive()) {
-        _gcsMotionReportTimer.stop();
+    if (_gcsMotionReportSendId) {
+        MAVLinkPeriodicSender::instance()->remove(_gcsMotionReportSendId);
+        _gcsMotionReportSendId = 0;
     }
 }
 
+void FollowMe::_positionInfoUpdated(QGeoPositionInfo positionInfo)
+{
+    const qint64 nowMSecs = _clock.elapsed();
+
+    if (positionInfo.timestamp().isValid()) {
+        _addLatency(_fixLatency, positionInfo.timestamp().msecsTo(QDateTime::currentDateTimeUtc()));
+    }
+    _lastPositionInfo = positionInfo;
+    _estimator.update(positionInfo, nowMSecs);
+}
+
+void FollowMe::_addLatency(LatencyStats_t& stats, qint64 latencyMSecs)
+{
+    stats.count++;
+    stats.sumMSecs += latencyMSecs;
+    stats.maxMSecs = qMax(stats.maxMSecs, latencyMSecs);
+}
+
+void FollowMe::_logLatencyStats(void)
+{
+    qint64 nowMSecs = _clock.elapsed();
+    if (nowMSecs - _lastStatsLogMSecs < _statsLogIntervalMSecs) {
+        return;
+    }
+    _lastStatsLogMSecs = nowMSecs;
+
+    qCDebug(FollowMeLog) << "Fix latency avg:max ms" << (_fixLatency.count ? _fixLatency.sumMSecs / _fixLatency.count : 0) << _fixLatency.maxMSecs
+                         << "fixes" << _fixLatency.count
+                         << "extrapolation avg:max ms" << (_extrapolation.count ? _extrapolation.sumMSecs / _extrapolation.count : 0) << _extrapolation.maxMSecs
+                         << "reports" << _extrapolation.count;
+    _fixLatency     = {};
+    _extrapolation  = {};
+}
+
 void FollowMe::_sendGCSMotionReport()
 {
-    QGeoPositionInfo    geoPositionInfo =   _toolbox->qgcPositionManager()->geoPositionInfo();
-    QGeoCoordinate      gcsCoordinate =     geoPositionInfo.coordinate();
+    QGeoPositionInfo                    geoPositionInfo = _lastPositionInfo;
+    FollowTargetEstimator::Estimate_t   estimate;
 
-    if (!geoPositionInfo.isValid()) {
+    if (!geoPositionInfo.isValid() || !_estimator.predict(_clock.elapsed(), estimate)) {
         return;
     }
+    QGeoCoordinate gcsCoordinate = estimate.coordinate;
 
     // First check to see if any vehicles need follow me updates
     bool needFollowMe = false;
@@ -111,9 +161,9 @@ void FollowMe::_sendGCSMotionReport()
     motionReport.altMetersAMSL =    gcsCoordinate.altitude();
     estimatation_capabilities |=    (1 << POS);
 
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::Direction) == true) {
+    if (!qIsNaN(estimate.headingDegrees)) {
         estimatation_capabilities |= (1 << HEADING);
-        motionReport.headingDegrees = geoPositionInfo.attribute(QGeoPositionInfo::Direction);
+        motionReport.headingDegrees = estimate.headingDegrees;
     }
 
     // get the current eph and epv
@@ -126,25 +176,17 @@ void FollowMe::_sendGCSMotionReport()
         motionReport.pos_std_dev[2] = geoPositionInfo.attribute(QGeoPositionInfo::VerticalAccuracy);
     }
 
-    // calculate z velocity if it's available
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::VerticalSpeed)) {
-        motionReport.vzMetersPerSec = geoPositionInfo.attribute(QGeoPositionInfo::VerticalSpeed);
-    }
-
-    // calculate x,y velocity if it's available
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::Direction) && geoPositionInfo.hasAttribute(QGeoPositionInfo::GroundSpeed) == true) {
-        estimatation_capabilities |= (1 << VEL);
+    // velocity and acceleration from the motion model once there are multiple fixes
 
-        qreal direction = _degreesToRadian(geoPositionInfo.attribute(QGeoPositionInfo::Direction));
-        qreal velocity  = geoPositionInfo.attribute(QGeoPositionInfo::GroundSpeed);
+    if (estimate.hasVelocity) {
+        estimatation_capabilities |= (1 << VEL) | (1 << ACCEL);
 
-        motionReport.vxMetersPerSec = cos(direction)*velocity;
-        motionReport.vyMetersPerSec = sin(direction)*velocity;
-    } else {
-        motionReport.vxMetersPerSec = 0;
-        motionReport.vyMetersPerSec = 0;
+        motionReport.vxMetersPerSec     = estimate.velocityNED[0];
+        motionReport.vyMetersPerSec     = estimate.velocityNED[1];
+        motionReport.vzMetersPerSec     = estimate.velocityNED[2];
+        motionReport.axMetersPerSec2    = estimate.accelerationNED[0];
+        motionReport.ayMetersPerSec2    = estimate.accelerationNED[1];
+        motionReport.azMetersPerSec2    = estimate.accelerationNED[2];
     }
 
     QmlObjectListModel* vehicles = _toolbox->multiVehicleManager()->vehicles();
@@ -156,6 +198,9 @@ void FollowMe::_sendGCSMotionReport()
             vehicle->firmwarePlugin()->sendGCSMotionReport(vehicle, motionReport, estimatation_capabilities);
         }
     }
+
+    _addLatency(_extrapolation, estimate.fixAgeMSecs);
+    _logLatencyStats();
 }
 
 double FollowMe::_degreesToRadian(double deg)
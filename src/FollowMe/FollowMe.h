@@ -19,11 +19,18 @@
 
 #include "QGCToolbox.h"
 #include "MAVLinkProtocol.h"
+#include "FollowTargetEstimator.h"
 
 class Vehicle;
 
 Q_DECLARE_LOGGING_CATEGORY(FollowMeLog)
 
+/// Streams the GCS position to vehicles which follow it.
+///
+/// Reports are sent at the followTargetRate setting. Position updates from the position manager feed a motion model
+/// which extrapolates the GCS position to the time each report is sent, so the vehicle does not see the staleness
+/// and jitter of the position source. Latency of the source fixes and the extrapolation horizon are logged
+/// periodically to FollowMeLog.
 class FollowMe : public QGCTool
 {
     Q_OBJECT
@@ -39,6 +46,9 @@ public:
         double  vxMetersPerSec;     //	X velocity in NED frame in meter / s
         double  vyMetersPerSec;     //	Y velocity in NED frame in meter / s
         double  vzMetersPerSec;     //	Z velocity in NED frame in meter / s
+        double  axMetersPerSec2;    // X acceleration in NED frame in meter / s^2
+        double  ayMetersPerSec2;    // Y acceleration in NED frame in meter / s^2
+        double  azMetersPerSec2;    // Z acceleration in NED frame in meter / s^2
         double  pos_std_dev[3];     // -1 for unknown
     };
 
@@ -56,6 +66,8 @@ public:
 private slots:
     void _sendGCSMotionReport       (void);
     void _settingsChanged           (void);
+    void _rateChanged               (void);
+    void _positionInfoUpdated       (QGeoPositionInfo positionInfo);
     void _vehicleAdded              (Vehicle* vehicle);
     void _vehicleRemoved            (Vehicle* vehicle);
     void _enableIfVehicleInFollow   (void);
@@ -67,11 +79,28 @@ private:
         MODE_FOLLOWME
     };
 
+    typedef struct {
+        int     count;
+        double  sumMSecs;
+        qint64  maxMSecs;
+    } LatencyStats_t;
+
     void    _disableFollowSend  (void);
     void    _enableFollowSend   (void);
     double  _degreesToRadian    (double deg);
     bool    _isFollowFlightMode (Vehicle* vehicle, const QString& flightMode);
+    int     _reportIntervalMSecs(void);
+    void    _addLatency         (LatencyStats_t& stats, qint64 latencyMSecs);
+    void    _logLatencyStats    (void);
+
+    int                     _gcsMotionReportSendId = 0;    ///< MAVLinkPeriodicSender id of the report send, 0 while not sending
+    uint32_t                _currentMode;
+    FollowTargetEstimator   _estimator;
+    QElapsedTimer           _clock;                         ///< Time base for the estimator
+    QGeoPositionInfo        _lastPositionInfo;
+    LatencyStats_t          _fixLatency         = {};       ///< Source fix timestamp to reception
+    LatencyStats_t          _extrapolation      = {};       ///< Reception of the last fix to report send
+    qint64                  _lastStatsLogMSecs  = 0;
 
-    QTimer      _gcsMotionReportTimer;
-    uint32_t    _currentMode;
+    static const int _statsLogIntervalMSecs = 10000;
 };
@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FollowTargetEstimator.h"
+#include "QGCGeo.h"
+
+#include <QtMath>
+
+void FollowTargetEstimator::reset(void)
+{
+    _valid      = false;
+    _fixCount   = 0;
+    _headingDegrees = qQNaN();
+    for (int i=0; i<3; i++) {
+        _position[i] = _velocity[i] = _acceleration[i] = 0;
+    }
+}
+
+void FollowTargetEstimator::update(const QGeoPositionInfo& positionInfo, qint64 receivedMSecs)
+{
+    QGeoCoordinate coord = positionInfo.coordinate();
+    if (!positionInfo.isValid() || !coord.isValid()) {
+        return;
+    }
+    // Sources without altitude are filtered at a constant altitude and reported without one
+    _hasAltitude = !qIsNaN(coord.altitude());
+    if (!_hasAltitude) {
+        coord.setAltitude(_valid ? _origin.altitude() : 0);
+    }
+
+    if (!_valid || receivedMSecs - _lastFixMSecs > _maxFixIntervalMSecs) {
+        reset();
+    }
+    if (positionInfo.hasAttribute(QGeoPositionInfo::Direction)) {
+        _headingDegrees = positionInfo.attribute(QGeoPositionInfo::Direction);
+    }
+
+    if (!_valid) {
+        _origin         = coord;
+        _lastFixMSecs   = receivedMSecs;
+        _valid          = true;
+        _fixCount       = 1;
+        return;
+    }
+
+    const double dt = (receivedMSecs - _lastFixMSecs) / 1000.0;
+    if (dt <= 0) {
+        return;
+    }
+    _lastFixMSecs = receivedMSecs;
+    _fixCount++;
+
+    double measured[3];
+    convertGeoToNed(coord, _origin, &measured[0], &measured[1], &measured[2]);
+
+    for (int i=0; i<3; i++) {
+        const double predictedPosition = _position[i] + (_velocity[i] * dt) + (0.5 * _acceleration[i] * dt * dt);
+        const double predictedVelocity = _velocity[i] + (_acceleration[i] * dt);
+        const double residual          = measured[i] - predictedPosition;
+
+        _position[i]     = predictedPosition + (_alpha * residual);
+        _velocity[i]     = predictedVelocity + (_beta * residual / dt);
+        // The first update has no velocity history to derive an acceleration from
+        _acceleration[i] = _fixCount > 2 ? _acceleration[i] + (2 * _gamma * residual / (dt * dt)) : 0;
+        _acceleration[i] = qBound(-_maxAcceleration, _acceleration[i], _maxAcceleration);
+    }
+
+    if (positionInfo.hasAttribute(QGeoPositionInfo::Direction) && positionInfo.hasAttribute(QGeoPositionInfo::GroundSpeed)) {
+        const double direction  = qDegreesToRadians(positionInfo.attribute(QGeoPositionInfo::Direction));
+        const double speed      = positionInfo.attribute(QGeoPositionInfo::GroundSpeed);
+        _velocity[0] += _measuredVelocityWeight * ((qCos(direction) * speed) - _velocity[0]);
+        _velocity[1] += _measuredVelocityWeight * ((qSin(direction) * speed) - _velocity[1]);
+    }
+    if (positionInfo.hasAttribute(QGeoPositionInfo::VerticalSpeed)) {
+        // Vertical speed is positive up, NED is positive down
+        _velocity[2] += _measuredVelocityWeight * (-positionInfo.attribute(QGeoPositionInfo::VerticalSpeed) - _velocity[2]);
+    }
+}
+
+bool FollowTargetEstimator::predict(qint64 nowMSecs, Estimate_t& estimate) const
+{
+    if (!_valid) {
+        return false;
+    }
+
+    estimate.fixAgeMSecs = nowMSecs - _lastFixMSecs;
+    if (estimate.fixAgeMSecs > _maxExtrapolationMSecs) {
+        return false;
+    }
+
+    const double dt = qMax(0.0, estimate.fixAgeMSecs / 1000.0);
+    double position[3];
+    for (int i=0; i<3; i++) {
+        position[i]                 = _position[i] + (_velocity[i] * dt) + (0.5 * _acceleration[i] * dt * dt);
+        estimate.velocityNED[i]     = _velocity[i] + (_acceleration[i] * dt);
+        estimate.accelerationNED[i] = _acceleration[i];
+    }
+    convertNedToGeo(position[0], position[1], position[2], _origin, &estimate.coordinate);
+    if (!_hasAltitude) {
+        estimate.coordinate.setAltitude(qQNaN());
+    }
+
+    estimate.hasVelocity = _fixCount > 1;
+
+    // Heading follows the direction of motion when moving, otherwise the last reported direction
+    const double groundSpeed = qSqrt((estimate.velocityNED[0] * estimate.velocityNED[0]) + (estimate.velocityNED[1] * estimate.velocityNED[1]));
+    if (estimate.hasVelocity && groundSpeed > 1.0) {
+        double heading = qRadiansToDegrees(qAtan2(estimate.velocityNED[1], estimate.velocityNED[0]));
+        estimate.headingDegrees = heading < 0 ? heading + 360 : heading;
+    } else {
+        estimate.headingDegrees = _headingDegrees;
+    }
+
+    return true;
+}
@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoPositionInfo>
+#include <QGeoCoordinate>
+
+/// Motion model of the follow target (the GCS) used to send positions at a higher rate than the position source
+/// delivers them.
+///
+/// Position fixes are fused with an alpha-beta-gamma filter in a local NED frame, which gives smoothed position,
+/// velocity and acceleration. Speed and direction from the source are blended into the velocity when available.
+/// predict() extrapolates the state to the send time, limited to _maxExtrapolationMSecs after the last fix.
+class FollowTargetEstimator
+{
+public:
+    typedef struct {
+        QGeoCoordinate  coordinate;
+        double          headingDegrees;     ///< NaN if unknown
+        double          velocityNED[3];     ///< Meters per second
+        double          accelerationNED[3]; ///< Meters per second squared
+        bool            hasVelocity;        ///< false: only a single fix is available
+        qint64          fixAgeMSecs;        ///< Time since the last fix
+    } Estimate_t;
+
+    /// Adds a position fix
+    ///     @param receivedMSecs Time the fix was received in a monotonic msecs clock
+    void update(const QGeoPositionInfo& positionInfo, qint64 receivedMSecs);
+
+    /// Extrapolates the state to the specified time
+    ///     @return false: no fix available or last fix is too old
+    bool predict(qint64 nowMSecs, Estimate_t& estimate) const;
+
+    void reset(void);
+
+    bool valid  (void) const { return _valid; }
+    int  fixCount(void) const { return _fixCount; }
+
+private:
+    bool            _valid      = false;
+    bool            _hasAltitude = false;
+    int             _fixCount   = 0;
+    QGeoCoordinate  _origin;                            ///< Origin of the local frame, first fix after a reset
+    qint64          _lastFixMSecs = 0;
+    double          _headingDegrees = qQNaN();
+    double          _position[3]        = { 0, 0, 0 };
+    double          _velocity[3]        = { 0, 0, 0 };
+    double          _acceleration[3]    = { 0, 0, 0 };
+
+    static constexpr double _alpha                      = 0.5;
+    static constexpr double _beta                       = 0.3;
+    static constexpr double _gamma                      = 0.05;
+    static constexpr double _measuredVelocityWeight     = 0.5;  ///< Blend of source speed/direction into the velocity
+    static constexpr double _maxAcceleration            = 10;   ///< Meters per second squared
+    static constexpr qint64 _maxFixIntervalMSecs        = 5000; ///< Filter restarts after a longer gap
+    static constexpr qint64 _maxExtrapolationMSecs      = 2000;
+};
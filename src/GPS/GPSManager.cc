@@ -14,6 +14,8 @@
 #include "SettingsManager.h"
 #include "RTKSettings.h"
 
+#include <QtMath>
+
 GPSManager::GPSManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
 {
@@ -55,19 +57,19 @@ void GPSManager::connectGPS(const QString& device, const QString& gps_type)
                                    rtkSettings->fixedBasePositionAltitude()->rawValue().toFloat(),
                                    rtkSettings->fixedBasePositionAccuracy()->rawValue().toFloat(),
                                    _requestGpsStop);
-    _gpsProvider->start();
 
     //create RTCM device
     _rtcmMavlink = new RTCMMavlink(*_toolbox);
 
-    connect(_gpsProvider, &GPSProvider::RTCMDataUpdate, _rtcmMavlink, &RTCMMavlink::RTCMDataUpdate);
+    // Corrections are written to the links from the GPS thread so UI load does not delay them
+    connect(_gpsProvider, &GPSProvider::RTCMDataUpdate, _rtcmMavlink, &RTCMMavlink::RTCMDataUpdate, Qt::DirectConnection);
 
-    //test: connect to position update
-    connect(_gpsProvider, &GPSProvider::positionUpdate,         this, &GPSManager::GPSPositionUpdate);
-    connect(_gpsProvider, &GPSProvider::satelliteInfoUpdate,    this, &GPSManager::GPSSatelliteUpdate);
+    connect(_gpsProvider, &GPSProvider::reportsAvailable,       this, &GPSManager::_reportsAvailable, Qt::QueuedConnection);
     connect(_gpsProvider, &GPSProvider::finished,               this, &GPSManager::onDisconnect);
     connect(_gpsProvider, &GPSProvider::surveyInStatus,         this, &GPSManager::surveyInStatus);
 
+    _gpsProvider->start();
+
     emit onConnect();
 }
 
@@ -88,12 +90,51 @@ void GPSManager::disconnectGPS(void)
     _rtcmMavlink = nullptr;
 }
 
+void GPSManager::_reportsAvailable(void)
+{
+    if (!_gpsProvider) {
+        return;
+    }
+
+    _gpsProvider->clearReportsPending();
 
-void GPSManager::GPSPositionUpdate(GPSPositionMessage msg)
+    GPSPositionMessage position;
+    while (_gpsProvider->takePosition(position)) {
+        GPSPositionUpdate(position);
+    }
+    GPSSatelliteMessage satellite;
+    while (_gpsProvider->takeSatelliteInfo(satellite)) {
+        GPSSatelliteUpdate(satellite);
+    }
+}
+
+void GPSManager::GPSPositionUpdate(const GPSPositionMessage& msg)
 {
     qCDebug(RTKGPSLog) << QString("GPS: got position update: alt=%1, long=%2, lat=%3").arg(msg.position_data.alt).arg(msg.position_data.lon).arg(msg.position_data.lat);
+
+    const sensor_gps_s& gps = msg.position_data;
+    if (gps.fix_type < 2) {
+        return;
+    }
+
+    QGeoCoordinate coordinate(gps.lat * 1e-7, gps.lon * 1e-7);
+    if (gps.fix_type >= 3) {
+        coordinate.setAltitude(gps.alt * 1e-3);
+    }
+    QDateTime timestamp = gps.time_utc_usec ? QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(gps.time_utc_usec / 1000), Qt::UTC) : QDateTime::currentDateTimeUtc();
+
+    QGeoPositionInfo positionInfo(coordinate, timestamp);
+    positionInfo.setAttribute(QGeoPositionInfo::HorizontalAccuracy, static_cast<qreal>(gps.eph));
+    positionInfo.setAttribute(QGeoPositionInfo::VerticalAccuracy,   static_cast<qreal>(gps.epv));
+    if (gps.vel_ned_valid) {
+        positionInfo.setAttribute(QGeoPositionInfo::GroundSpeed,    static_cast<qreal>(gps.vel_m_s));
+        qreal direction = qRadiansToDegrees(static_cast<qreal>(gps.cog_rad));
+        positionInfo.setAttribute(QGeoPositionInfo::Direction,      direction < 0 ? direction + 360 : direction);
+        positionInfo.setAttribute(QGeoPositionInfo::VerticalSpeed,  static_cast<qreal>(-gps.vel_d_m_s));
+    }
+    emit positionInfoUpdated(positionInfo);
 }
-void GPSManager::GPSSatelliteUpdate(GPSSatelliteMessage msg)
+void GPSManager::GPSSatelliteUpdate(const GPSSatelliteMessage& msg)
 {
     qCDebug(RTKGPSLog) << QString("GPS: got satellite info update, %1 satellites").arg((int)msg.satellite_data.count);
     emit satelliteUpdate(msg.satellite_data.count);
@@ -16,6 +16,7 @@
 
 #include <QString>
 #include <QObject>
+#include <QGeoPositionInfo>
 
 /**
  ** class GPSManager
@@ -37,12 +38,15 @@ signals:
     void onDisconnect();
     void surveyInStatus(float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void satelliteUpdate(int numSats);
+    void positionInfoUpdated(QGeoPositionInfo positionInfo);   ///< Position of the GPS device
 
 private slots:
-    void GPSPositionUpdate(GPSPositionMessage msg);
-    void GPSSatelliteUpdate(GPSSatelliteMessage msg);
+    void _reportsAvailable(void);
 
 private:
+    void GPSPositionUpdate(const GPSPositionMessage& msg);
+    void GPSSatelliteUpdate(const GPSSatelliteMessage& msg);
+
     GPSProvider* _gpsProvider = nullptr;
     RTCMMavlink* _rtcmMavlink = nullptr;
 
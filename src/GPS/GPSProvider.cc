@@ -168,14 +168,26 @@ void GPSProvider::publishGPSPosition()
 {
     GPSPositionMessage msg;
     msg.position_data = _reportGpsPos;
-    emit positionUpdate(msg);
+    if (!_positionQueue.push(msg)) {
+        qCDebug(RTKGPSLog) << "Position report dropped, main thread is behind";
+    }
+    _signalReports();
 }
 
 void GPSProvider::publishGPSSatellite()
 {
     GPSSatelliteMessage msg;
     msg.satellite_data = *_pReportSatInfo;
-    emit satelliteInfoUpdate(msg);
+    _satelliteQueue.push(msg);
+    _signalReports();
+}
+
+void GPSProvider::_signalReports()
+{
+    // One queued signal at a time, the consumer takes everything queued until then
+    if (!_reportsPending.exchange(true)) {
+        emit reportsAvailable();
+    }
 }
 
 void GPSProvider::gotRTCMData(uint8_t* data, size_t len)
@@ -18,6 +18,7 @@
 #include <atomic>
 
 #include "GPSPositionMessage.h"
+#include "GPSReportQueue.h"
 #include "Drivers/src/gps_helper.h"
 
 
@@ -54,9 +55,16 @@ public:
      */
     void gotRTCMData(uint8_t *data, size_t len);
 
+    /// Called by the consumer of reportsAvailable, before taking the queued reports
+    void clearReportsPending(void) { _reportsPending = false; }
+    /// @return false: no more queued reports
+    bool takePosition       (GPSPositionMessage& message)   { return _positionQueue.pop(message); }
+    bool takeSatelliteInfo  (GPSSatelliteMessage& message)  { return _satelliteQueue.pop(message); }
+
 signals:
-    void positionUpdate(GPSPositionMessage message);
-    void satelliteInfoUpdate(GPSSatelliteMessage message);
+    /// Position and satellite reports were queued. Only signalled again once clearReportsPending has been called.
+    void reportsAvailable(void);
+    /// Emitted from the GPS thread, connect with Qt::DirectConnection to forward corrections without the main thread
     void RTCMDataUpdate(QByteArray message);
     void surveyInStatus(float duration, float accuracyMM, double latitude, double longitude, float altitude, bool valid, bool active);
 
@@ -66,6 +74,7 @@ protected:
 private:
     void publishGPSPosition();
     void publishGPSSatellite();
+    void _signalReports();
 
 	/**
 	 * callback from the driver for the platform specific stuff
@@ -90,4 +99,8 @@ private:
 	struct satellite_info_s    *_pReportSatInfo = nullptr;
 
 	QSerialPort *_serial = nullptr;
+
+    GPSReportQueue<GPSPositionMessage, 8>   _positionQueue;
+    GPSReportQueue<GPSSatelliteMessage, 2>  _satelliteQueue;
+    std::atomic_bool                        _reportsPending { false };
 };
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+
+/**
+ ** class GPSReportQueue
+ * Fixed size single producer/single consumer queue between the GPS thread and the main thread. Neither side takes
+ * a lock. When full, new reports are dropped since the consumer only needs the most recent ones.
+ */
+template<typename T, unsigned int Size>
+class GPSReportQueue
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of 2");
+
+public:
+    /// Producer only
+    /// @return false: queue full, report dropped
+    bool push(const T& report)
+    {
+        const unsigned int writeIndex = _writeIndex.load(std::memory_order_relaxed);
+        if (writeIndex - _readIndex.load(std::memory_order_acquire) == Size) {
+            return false;
+        }
+        _reports[writeIndex & (Size - 1)] = report;
+        _writeIndex.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer only
+    /// @return false: queue empty
+    bool pop(T& report)
+    {
+        const unsigned int readIndex = _readIndex.load(std::memory_order_relaxed);
+        if (readIndex == _writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        report = _reports[readIndex & (Size - 1)];
+        _readIndex.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T                           _reports[Size];
+    std::atomic<unsigned int>   _writeIndex { 0 };  ///< Only written by the producer
+    std::atomic<unsigned int>   _readIndex  { 0 };  ///< Only written by the consumer
+};
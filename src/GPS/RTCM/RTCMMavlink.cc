@@ -12,13 +12,70 @@
 
 #include "MultiVehicleManager.h"
 #include "Vehicle.h"
+#include "VehicleLinkManager.h"
 
-#include <cstdio>
+QGC_LOGGING_CATEGORY(RTCMMavlinkLog, "RTCMMavlinkLog")
 
 RTCMMavlink::RTCMMavlink(QGCToolbox& toolbox)
     : _toolbox(toolbox)
 {
     _bandwidthTimer.start();
+
+    MultiVehicleManager* multiVehicleManager = _toolbox.multiVehicleManager();
+    auto vehicleAdded = [this](Vehicle* vehicle) {
+        connect(vehicle->vehicleLinkManager(), &VehicleLinkManager::primaryLinkChanged, this, &RTCMMavlink::_updateLinks);
+        _updateLinks();
+    };
+    connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, vehicleAdded);
+    connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &RTCMMavlink::_updateLinks);
+    QmlObjectListModel& vehicles = *multiVehicleManager->vehicles();
+    for (int i = 0; i < vehicles.count(); i++) {
+        vehicleAdded(qobject_cast<Vehicle*>(vehicles[i]));
+    }
+    _updateLinks();
+}
+
+void RTCMMavlink::_updateLinks(void)
+{
+    QList<SharedLinkInterfacePtr> links;
+    QmlObjectListModel& vehicles = *_toolbox.multiVehicleManager()->vehicles();
+    for (int i = 0; i < vehicles.count(); i++) {
+        Vehicle* vehicle = qobject_cast<Vehicle*>(vehicles[i]);
+        SharedLinkInterfacePtr sharedLink = vehicle->vehicleLinkManager()->primaryLink().lock();
+        // GPS_RTCM_DATA has no target system, one send reaches every vehicle on a link
+        if (sharedLink && !links.contains(sharedLink)) {
+            links.append(sharedLink);
+        }
+    }
+
+    QMutexLocker locker(&_linksMutex);
+    _links = links;
+}
+
+RTCMMavlink::RTCMPriority_t RTCMMavlink::rtcmPriority(const QByteArray& message)
+{
+    // RTCM3 frame: 0xD3 preamble, 6 reserved bits and 10 bit length, then the 12 bit message type
+    if (message.size() < 5 || static_cast<uint8_t>(message[0]) != 0xD3) {
+        return RTCMPriorityEphemeris;
+    }
+    const int type = (static_cast<uint8_t>(message[3]) << 4) | (static_cast<uint8_t>(message[4]) >> 4);
+
+    switch (type) {
+    case 1005:
+    case 1006:
+    case 1007:
+    case 1008:
+    case 1033:
+    case 1230:
+        return RTCMPriorityStation;
+    default:
+        break;
+    }
+    if ((type >= 1001 && type <= 1004) || (type >= 1009 && type <= 1012) || (type >= 1071 && type <= 1137)) {
+        // Legacy GPS/GLONASS and MSM observations
+        return RTCMPriorityObservation;
+    }
+    return RTCMPriorityEphemeris;
 }
 
 void RTCMMavlink::RTCMDataUpdate(QByteArray message)
@@ -27,20 +84,22 @@ void RTCMMavlink::RTCMDataUpdate(QByteArray message)
     _bandwidthByteCounter += message.size();
     qint64 elapsed = _bandwidthTimer.elapsed();
     if (elapsed > 1000) {
-        printf("RTCM bandwidth: %.2f kB/s\n", (float) _bandwidthByteCounter / elapsed * 1000.f / 1024.f);
+        qCDebug(RTCMMavlinkLog) << QStringLiteral("RTCM bandwidth: %1 kB/s dropped: %2").arg((float) _bandwidthByteCounter / elapsed * 1000.f / 1024.f, 0, 'f', 2).arg(_droppedMessageCounter);
         _bandwidthTimer.restart();
         _bandwidthByteCounter = 0;
+        _droppedMessageCounter = 0;
     }
 
     const int maxMessageLength = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN;
     mavlink_gps_rtcm_data_t mavlinkRtcmData;
     memset(&mavlinkRtcmData, 0, sizeof(mavlink_gps_rtcm_data_t));
 
+    _fragments.clear();
     if (message.size() < maxMessageLength) {
         mavlinkRtcmData.len = message.size();
         mavlinkRtcmData.flags = (_sequenceId & 0x1F) << 3;
         memcpy(&mavlinkRtcmData.data, message.data(), message.size());
-        sendMessageToVehicle(mavlinkRtcmData);
+        _fragments.append(mavlinkRtcmData);
     } else {
         // We need to fragment
 
@@ -53,31 +112,48 @@ void RTCMMavlink::RTCMDataUpdate(QByteArray message)
             mavlinkRtcmData.flags |= (_sequenceId & 0x1F) << 3;     // Next 5 bits are sequence id
             mavlinkRtcmData.len = length;
             memcpy(&mavlinkRtcmData.data, message.data() + start, length);
-            sendMessageToVehicle(mavlinkRtcmData);
+            _fragments.append(mavlinkRtcmData);
             start += length;
         }
     }
+    _sendFragments(rtcmPriority(message));
     ++_sequenceId;
 }
 
-void RTCMMavlink::sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg)
+void RTCMMavlink::_sendFragments(RTCMPriority_t rtcmPriority)
 {
-    QmlObjectListModel& vehicles = *_toolbox.multiVehicleManager()->vehicles();
     MAVLinkProtocol* mavlinkProtocol = _toolbox.mavlinkProtocol();
-    for (int i = 0; i < vehicles.count(); i++) {
-        Vehicle*                vehicle     = qobject_cast<Vehicle*>(vehicles[i]);
-        WeakLinkInterfacePtr    weakLink    = vehicle->vehicleLinkManager()->primaryLink();
+    const LinkInterface::WritePriority_t writePriority = rtcmPriority == RTCMPriorityEphemeris ? LinkInterface::WritePriorityBulk : LinkInterface::WritePriorityNormal;
+
+    _linksMutex.lock();
+    const QList<SharedLinkInterfacePtr> links = _links;
+    _linksMutex.unlock();
+
+    for (const SharedLinkInterfacePtr& sharedLink: links) {
+        if (!sharedLink->isConnected()) {
+            continue;
+        }
+
+        if (rtcmPriority != RTCMPriorityStation) {
+            const QVector<LinkInterface::WriteQueueStats_t> stats = sharedLink->writeQueueStats();
+            const int queued = stats[LinkInterface::WritePriorityNormal].queuedMessages + stats[LinkInterface::WritePriorityBulk].queuedMessages;
+            if (queued > (rtcmPriority == RTCMPriorityObservation ? _maxQueuedObservation : _maxQueuedEphemeris)) {
+                _droppedMessageCounter++;
+                continue;
+            }
+        }
 
-        if (!weakLink.expired()) {
-            mavlink_message_t       message;
-            SharedLinkInterfacePtr  sharedLink = weakLink.lock();
+        for (const mavlink_gps_rtcm_data_t& fragment: _fragments) {
+            mavlink_message_t   message;
+            uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
 
             mavlink_msg_gps_rtcm_data_encode_chan(mavlinkProtocol->getSystemId(),
                                                   mavlinkProtocol->getComponentId(),
                                                   sharedLink->mavlinkChannel(),
                                                   &message,
-                                                  &msg);
-            vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
+                                                  &fragment);
+            const int len = mavlink_msg_to_send_buffer(buffer, &message);
+            sharedLink->writeBytesThreadSafe(reinterpret_cast<const char*>(buffer), len, writePriority);
         }
     }
 }
@@ -12,13 +12,25 @@
 
 #include <QObject>
 #include <QElapsedTimer>
+#include <QVector>
+#include <QMutex>
 
 #include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
 #include "MAVLinkProtocol.h"
+#include "LinkInterface.h"
+
+Q_DECLARE_LOGGING_CATEGORY(RTCMMavlinkLog)
 
 /**
  ** class RTCMMavlink
  * Receives RTCM updates and sends them via MAVLINK to the device
+ *
+ * Each RTCM message is fragmented into GPS_RTCM_DATA packets once. GPS_RTCM_DATA has no target system, so the packets
+ * are sent once per link and reach every vehicle on it. Messages are dropped for a link by priority of their RTCM
+ * message type when its write queue is backed up.
+ *
+ * RTCMDataUpdate is called on the GPS thread. The links are tracked on the main thread and only the list is shared.
  */
 class RTCMMavlink : public QObject
 {
@@ -27,14 +39,33 @@ public:
     RTCMMavlink(QGCToolbox& toolbox);
     //TODO: API to select device(s)?
 
+    typedef enum {
+        RTCMPriorityStation,        ///< Reference station position and antenna, needed for a fix, never dropped
+        RTCMPriorityObservation,    ///< Observations, dropped only when the link is badly backed up
+        RTCMPriorityEphemeris,      ///< Ephemeris and everything else, repeated so it is dropped first
+    } RTCMPriority_t;
+
+    /// @return Priority for an RTCM3 frame, from its message type
+    static RTCMPriority_t rtcmPriority(const QByteArray& message);
+
 public slots:
     void RTCMDataUpdate(QByteArray message);
 
+private slots:
+    void _updateLinks(void);
+
 private:
-    void sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg);
+    void _sendFragments(RTCMPriority_t rtcmPriority);
 
     QGCToolbox& _toolbox;
     QElapsedTimer _bandwidthTimer;
     int _bandwidthByteCounter = 0;
+    int _droppedMessageCounter = 0;
     uint8_t _sequenceId = 0;
+    QVector<mavlink_gps_rtcm_data_t> _fragments;   ///< Reused between messages
+    QMutex _linksMutex;
+    QList<SharedLinkInterfacePtr> _links;           ///< Primary links of all vehicles without duplicates, protected by _linksMutex
+
+    static const int _maxQueuedEphemeris    = 8;    ///< Queued link messages above which ephemeris is dropped
+    static const int _maxQueuedObservation  = 32;   ///< Queued link messages above which observations are dropped
 };
@@ -15,6 +15,7 @@
 
 #include "QGCGeo.h"
 #include "UTMUPS.hpp"
+#include "TransverseMercator.hpp"
 #include "MGRS.hpp"
 
 // These defines are private
@@ -24,65 +25,90 @@
 
 static const double epsilon = std::numeric_limits<double>::epsilon();
 
-void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, double* y, double* z)
+void convertGeoToNed(const QGeoCoordinate& coord, const QGeoCoordinate& origin, double* x, double* y, double* z)
 {
-    if (coord == origin) {
+    LocalTangentFrame(origin).toNed(coord, x, y, z);
+}
+
+void convertNedToGeo(double x, double y, double z, const QGeoCoordinate& origin, QGeoCoordinate *coord)
+{
+    *coord = LocalTangentFrame(origin).fromNed(x, y, z);
+}
+
+LocalTangentFrame::LocalTangentFrame(const QGeoCoordinate& origin)
+    : _origin   (origin)
+    , _refLatRad(origin.latitude() * M_DEG_TO_RAD)
+    , _refLonRad(origin.longitude() * M_DEG_TO_RAD)
+    , _refSinLat(sin(_refLatRad))
+    , _refCosLat(cos(_refLatRad))
+{
+
+}
+
+void LocalTangentFrame::toNed(const QGeoCoordinate& coord, double* x, double* y, double* z) const
+{
+    if (coord == _origin) {
         // Short circuit to prevent NaNs in calculation
-        *x = *y = *z = 0;
+        *x = *y = 0;
+        if (z) {
+            *z = 0;
+        }
         return;
     }
 
     double lat_rad = coord.latitude() * M_DEG_TO_RAD;
     double lon_rad = coord.longitude() * M_DEG_TO_RAD;
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
     double sin_lat = sin(lat_rad);
     double cos_lat = cos(lat_rad);
-    double cos_d_lon = cos(lon_rad - ref_lon_rad);
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
+    double cos_d_lon = cos(lon_rad - _refLonRad);
 
-    double c = acos(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon);
+    double c = acos(_refSinLat * sin_lat + _refCosLat * cos_lat * cos_d_lon);
     double k = (fabs(c) < epsilon) ? 1.0 : (c / sin(c));
 
-    *x = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
-    *y = k * cos_lat * sin(lon_rad - ref_lon_rad) * CONSTANTS_RADIUS_OF_EARTH;
+    *x = k * (_refCosLat * sin_lat - _refSinLat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+    *y = k * cos_lat * sin(lon_rad - _refLonRad) * CONSTANTS_RADIUS_OF_EARTH;
 
-    *z = -(coord.altitude() - origin.altitude());
+    if (z) {
+        *z = -(coord.altitude() - _origin.altitude());
+    }
 }
 
-void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+QGeoCoordinate LocalTangentFrame::fromNed(double x, double y, double z) const
+{
     double x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
     double y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
     double c = sqrt(x_rad * x_rad + y_rad * y_rad);
-    double sin_c = sin(c);
-    double cos_c = cos(c);
-
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
 
     double lat_rad;
     double lon_rad;
 
     if (fabs(c) > epsilon) {
-        lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
-        lon_rad = (ref_lon_rad + atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+        double sin_c = sin(c);
+        double cos_c = cos(c);
 
+        lat_rad = asin(cos_c * _refSinLat + (x_rad * sin_c * _refCosLat) / c);
+        lon_rad = (_refLonRad + atan2(y_rad * sin_c, c * _refCosLat * cos_c - x_rad * _refSinLat * sin_c));
     } else {
-        lat_rad = ref_lat_rad;
-        lon_rad = ref_lon_rad;
+        lat_rad = _refLatRad;
+        lon_rad = _refLonRad;
     }
 
-    coord->setLatitude(lat_rad * M_RAD_TO_DEG);
-    coord->setLongitude(lon_rad * M_RAD_TO_DEG);
+    return QGeoCoordinate(lat_rad * M_RAD_TO_DEG, lon_rad * M_RAD_TO_DEG, -z + _origin.altitude());
+}
+
+void LocalTangentFrame::toNed(const QGeoCoordinate* coords, int count, double* x, double* y, double* z) const
+{
+    for (int i=0; i<count; i++) {
+        toNed(coords[i], &x[i], &y[i], z ? &z[i] : nullptr);
+    }
+}
 
-    coord->setAltitude(-z + origin.altitude());
+void LocalTangentFrame::fromNed(const double* x, const double* y, const double* z, int count, QGeoCoordinate* coords) const
+{
+    for (int i=0; i<count; i++) {
+        coords[i] = fromNed(x[i], y[i], z ? z[i] : 0);
+    }
 }
 
 int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northing)
@@ -97,6 +123,28 @@ int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northi
     }
 }
 
+bool convertGeoToUTM(const QGeoCoordinate* coords, int count, int zone, bool southhemi, double* eastings, double* northings)
+{
+    if (zone < GeographicLib::UTMUPS::MINUTMZONE || zone > GeographicLib::UTMUPS::MAXUTMZONE) {
+        return false;
+    }
+
+    // Same as UTMUPS::Forward, without the per point zone selection and range checks
+    const GeographicLib::TransverseMercator& utm = GeographicLib::TransverseMercator::UTM();
+    const double centralMeridian    = (6.0 * zone) - 183.0;
+    const double falseEasting       = 500000.0;
+    const double falseNorthing      = southhemi ? 10000000.0 : 0.0;
+
+    for (int i=0; i<count; i++) {
+        double x, y;
+        utm.Forward(centralMeridian, coords[i].latitude(), coords[i].longitude(), x, y);
+        eastings[i]     = x + falseEasting;
+        northings[i]    = y + falseNorthing;
+    }
+
+    return true;
+}
+
 bool convertUTMToGeo(double easting, double northing, int zone, bool southhemi, QGeoCoordinate& coord)
 {
     double lat, lon;
@@ -111,6 +159,28 @@ bool convertUTMToGeo(double easting, double northing, int zone, bool southhemi,
     return true;
 }
 
+bool convertUTMToGeo(const double* eastings, const double* northings, int count, int zone, bool southhemi, QList<QGeoCoordinate>& coords)
+{
+    if (zone < GeographicLib::UTMUPS::MINUTMZONE || zone > GeographicLib::UTMUPS::MAXUTMZONE) {
+        return false;
+    }
+
+    // Same as UTMUPS::Reverse, without the per point zone and range checks
+    const GeographicLib::TransverseMercator& utm = GeographicLib::TransverseMercator::UTM();
+    const double centralMeridian    = (6.0 * zone) - 183.0;
+    const double falseEasting       = 500000.0;
+    const double falseNorthing      = southhemi ? 10000000.0 : 0.0;
+
+    coords.reserve(coords.count() + count);
+    for (int i=0; i<count; i++) {
+        double lat, lon;
+        utm.Reverse(centralMeridian, eastings[i] - falseEasting, northings[i] - falseNorthing, lat, lon);
+        coords.append(QGeoCoordinate(lat, lon));
+    }
+
+    return true;
+}
+
 QString convertGeoToMGRS(const QGeoCoordinate& coord)
 {
     int zone;
@@ -19,6 +19,7 @@
 #define QGCGEO_H
 
 #include <QGeoCoordinate>
+#include <QList>
 
 /**
  * @brief Project a geodetic coordinate on to local tangential plane (LTP) as coordinate with East,
@@ -29,7 +30,7 @@
  * @param[out] y East component of coordinate in local plane.
  * @param[out] z Down component of coordinate in local plane.
  */
-void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, double* y, double* z);
+void convertGeoToNed(const QGeoCoordinate& coord, const QGeoCoordinate& origin, double* x, double* y, double* z);
 
 /**
  * @brief Transform a local (East, North, and Down) coordinate into a geodetic coordinate.
@@ -39,7 +40,34 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
  * @param[in] origin Geoedetic origin for LTP.
  * @param[out] coord Geodetic coordinate to hold result.
  */
-void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord);
+void convertNedToGeo(double x, double y, double z, const QGeoCoordinate& origin, QGeoCoordinate *coord);
+
+/**
+ * @brief Local tangential plane (LTP) with the origin terms precomputed. Results are the same as
+ * convertGeoToNed/convertNedToGeo, use it when converting many coordinates against the same origin.
+ * The array versions convert count values in one pass, z may be nullptr in which case down is
+ * ignored (toNed) or taken as 0 (fromNed).
+ */
+class LocalTangentFrame
+{
+public:
+    LocalTangentFrame(const QGeoCoordinate& origin);
+
+    const QGeoCoordinate& origin(void) const { return _origin; }
+
+    void            toNed   (const QGeoCoordinate& coord, double* x, double* y, double* z) const;
+    QGeoCoordinate  fromNed (double x, double y, double z) const;
+
+    void toNed  (const QGeoCoordinate* coords, int count, double* x, double* y, double* z) const;
+    void fromNed(const double* x, const double* y, const double* z, int count, QGeoCoordinate* coords) const;
+
+private:
+    QGeoCoordinate  _origin;
+    double          _refLatRad;
+    double          _refLonRad;
+    double          _refSinLat;
+    double          _refCosLat;
+};
 
 // LatLonToUTMXY
 // Converts a latitude/longitude pair to x and y coordinates in the
@@ -61,6 +89,26 @@ void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCo
 //   If conversion failed the function returns 0
 int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northing);
 
+// Converts an array of latitude/longitude coordinates to x and y coordinates in the specified UTM zone.
+// The zone setup is done once for the whole array, which makes this much faster than converting each
+// point separately for large shapes. Points outside of the zone are projected into it, the same as
+// GeographicLib::UTMUPS::Forward with setzone set to the zone.
+//
+// Inputs:
+// coords - The coordinates to convert.
+// count - The number of coordinates.
+// zone - The UTM zone to use, in the range [1,60].
+// southhemi - True to use the southern hemisphere false northing;
+//               false otherwise.
+//
+// Outputs:
+// eastings - The eastings of the points, in meters. Must hold count values.
+// northings - The northings of the points, in meters. Must hold count values.
+//
+// Returns:
+// The function returns false if the zone is invalid, eastings and northings are not changed in that case.
+bool convertGeoToUTM(const QGeoCoordinate* coords, int count, int zone, bool southhemi, double* eastings, double* northings);
+
 // UTMXYToLatLon
 //
 // Converts x and y coordinates in the Universal Transverse Mercator//   The UTM zone parameter should be in the range [1,60].
@@ -82,6 +130,25 @@ int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northi
 // The function returns true if conversion succeeded.
 bool convertUTMToGeo(double easting, double northing, int zone, bool southhemi, QGeoCoordinate& coord);
 
+// Converts an array of UTM x and y coordinates which all lie in the same zone to latitude/longitude.
+// The zone setup is done once for the whole array, which makes this much faster than converting each
+// point separately for large shapes.
+//
+// Inputs:
+// eastings - The eastings of the points, in meters.
+// northings - The northings of the points, in meters.
+// count - The number of points in eastings and northings.
+// zone - The UTM zone in which the points lie.
+// southhemi - True if the points are in the southern hemisphere;
+//               false otherwise.
+//
+// Outputs:
+// coords - The converted coordinates, appended in order.
+//
+// Returns:
+// The function returns false if the zone is invalid, coords is not changed in that case.
+bool convertUTMToGeo(const double* eastings, const double* northings, int count, int zone, bool southhemi, QList<QGeoCoordinate>& coords);
+
 // Converts a latitude/longitude pair to MGRS string
 //
 // Inputs:
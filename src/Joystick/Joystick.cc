@@ -482,73 +482,125 @@ void Joystick::run()
     _open();
     //-- Reset timers
     _axisTime.start();
+    _nextAxisSendNsecs      = 0;
+    _lastAxisSendNsecs      = 0;
+    _axisChangeNsecs        = -1;
+    _axisStatsStartNsecs    = 0;
     for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
         if(_buttonActionArray[buttonIndex]) {
             _buttonActionArray[buttonIndex]->buttonTime.start();
         }
     }
+    //-- Poll at twice the max axis rate against fixed deadlines, so the poll period does not drift with the time spent handling input
+    const qint64 pollPeriodNsecs = static_cast<qint64>(1e9 / _maxAxisFrequencyHz / 2);
+    qint64 nextPollNsecs = 0;
     while (!_exitThread) {
         _update();
-        _handleButtons();
+        _handleButtons(this);
+        _handleAuxiliaryButtons();
         _handleAxis();
-        QGC::SLEEP::msleep(qMin(static_cast<int>(1000.0f / _maxAxisFrequencyHz), static_cast<int>(1000.0f / _maxButtonFrequencyHz)) / 2);
+        nextPollNsecs += pollPeriodNsecs;
+        const qint64 now = _axisTime.nsecsElapsed();
+        if (nextPollNsecs <= now) {
+            // Fell behind, don't try to catch up with a burst of polls
+            nextPollNsecs = now;
+        } else {
+            QThread::usleep(static_cast<unsigned long>((nextPollNsecs - now) / 1000));
+        }
+    }
+    {
+        QMutexLocker lock(&_auxiliaryMutex);
+        for (Joystick* auxiliary: _auxiliaryJoysticks) {
+            if (auxiliary->_auxiliaryOpen) {
+                auxiliary->_close();
+                auxiliary->_auxiliaryOpen = false;
+            }
+        }
     }
     _close();
 }
 
-void Joystick::_handleButtons()
+void Joystick::setAuxiliaryJoysticks(const QList<Joystick*>& joysticks)
+{
+    QMutexLocker lock(&_auxiliaryMutex);
+    for (Joystick* auxiliary: _auxiliaryJoysticks) {
+        if (!joysticks.contains(auxiliary)) {
+            // Most likely unplugged, nothing left to close
+            auxiliary->_auxiliaryOpen = false;
+        }
+    }
+    _auxiliaryJoysticks = joysticks;
+}
+
+/// Devices such as button boxes are read from this joystick's thread, with the input state already updated by _update.
+void Joystick::_handleAuxiliaryButtons()
+{
+    QMutexLocker lock(&_auxiliaryMutex);
+    for (Joystick* auxiliary: _auxiliaryJoysticks) {
+        if (!auxiliary->_auxiliaryOpen) {
+            auxiliary->_auxiliaryOpen = auxiliary->_open();
+        }
+        if (auxiliary->_auxiliaryOpen) {
+            _handleButtons(auxiliary);
+        }
+    }
+}
+
+/// Reads the buttons of source, which is this joystick or one of its auxiliary joysticks. Actions are always executed
+/// from this joystick as it is the one connected to the vehicle and the camera manager.
+void Joystick::_handleButtons(Joystick* source)
 {
     int lastBbuttonValues[256];
     //-- Update button states
-    for (int buttonIndex = 0; buttonIndex < _buttonCount; buttonIndex++) {
-        bool newButtonValue = _getButton(buttonIndex);
+    for (int buttonIndex = 0; buttonIndex < source->_buttonCount; buttonIndex++) {
+        bool newButtonValue = source->_getButton(buttonIndex);
         if(buttonIndex < 256)
-            lastBbuttonValues[buttonIndex] = _rgButtonValues[buttonIndex];
-        if (newButtonValue && _rgButtonValues[buttonIndex] == BUTTON_UP) {
-            _rgButtonValues[buttonIndex] = BUTTON_DOWN;
-            emit rawButtonPressedChanged(buttonIndex, newButtonValue);
-        } else if (!newButtonValue && _rgButtonValues[buttonIndex] != BUTTON_UP) {
-            _rgButtonValues[buttonIndex] = BUTTON_UP;
-            emit rawButtonPressedChanged(buttonIndex, newButtonValue);
+            lastBbuttonValues[buttonIndex] = source->_rgButtonValues[buttonIndex];
+        if (newButtonValue && source->_rgButtonValues[buttonIndex] == BUTTON_UP) {
+            source->_rgButtonValues[buttonIndex] = BUTTON_DOWN;
+            emit source->rawButtonPressedChanged(buttonIndex, newButtonValue);
+        } else if (!newButtonValue && source->_rgButtonValues[buttonIndex] != BUTTON_UP) {
+            source->_rgButtonValues[buttonIndex] = BUTTON_UP;
+            emit source->rawButtonPressedChanged(buttonIndex, newButtonValue);
         }
     }
     //-- Update hat - append hat buttons to the end of the normal button list
     int numHatButtons = 4;
-    for (int hatIndex = 0; hatIndex < _hatCount; hatIndex++) {
+    for (int hatIndex = 0; hatIndex < source->_hatCount; hatIndex++) {
         for (int hatButtonIndex = 0; hatButtonIndex<numHatButtons; hatButtonIndex++) {
             // Create new index value that includes the normal button list
-            int rgButtonValueIndex = hatIndex*numHatButtons + hatButtonIndex + _buttonCount;
+            int rgButtonValueIndex = hatIndex*numHatButtons + hatButtonIndex + source->_buttonCount;
             // Get hat value from joystick
-            bool newButtonValue = _getHat(hatIndex, hatButtonIndex);
+            bool newButtonValue = source->_getHat(hatIndex, hatButtonIndex);
             if(rgButtonValueIndex < 256)
-                lastBbuttonValues[rgButtonValueIndex] = _rgButtonValues[rgButtonValueIndex];
-            if (newButtonValue && _rgButtonValues[rgButtonValueIndex] == BUTTON_UP) {
-                _rgButtonValues[rgButtonValueIndex] = BUTTON_DOWN;
-                emit rawButtonPressedChanged(rgButtonValueIndex, newButtonValue);
-            } else if (!newButtonValue && _rgButtonValues[rgButtonValueIndex] != BUTTON_UP) {
-                _rgButtonValues[rgButtonValueIndex] = BUTTON_UP;
-                emit rawButtonPressedChanged(rgButtonValueIndex, newButtonValue);
+                lastBbuttonValues[rgButtonValueIndex] = source->_rgButtonValues[rgButtonValueIndex];
+            if (newButtonValue && source->_rgButtonValues[rgButtonValueIndex] == BUTTON_UP) {
+                source->_rgButtonValues[rgButtonValueIndex] = BUTTON_DOWN;
+                emit source->rawButtonPressedChanged(rgButtonValueIndex, newButtonValue);
+            } else if (!newButtonValue && source->_rgButtonValues[rgButtonValueIndex] != BUTTON_UP) {
+                source->_rgButtonValues[rgButtonValueIndex] = BUTTON_UP;
+                emit source->rawButtonPressedChanged(rgButtonValueIndex, newButtonValue);
             }
         }
     }
     //-- Process button press/release
-    for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
-        if(_rgButtonValues[buttonIndex] == BUTTON_DOWN || _rgButtonValues[buttonIndex] == BUTTON_REPEAT) {
-            if(_buttonActionArray[buttonIndex]) {
-                QString buttonAction = _buttonActionArray[buttonIndex]->action;
+    for (int buttonIndex = 0; buttonIndex < source->_totalButtonCount; buttonIndex++) {
+        if(source->_rgButtonValues[buttonIndex] == BUTTON_DOWN || source->_rgButtonValues[buttonIndex] == BUTTON_REPEAT) {
+            if(source->_buttonActionArray[buttonIndex]) {
+                QString buttonAction = source->_buttonActionArray[buttonIndex]->action;
                 if(buttonAction.isEmpty() || buttonAction == _buttonActionNone)
                     continue;
-                if(!_buttonActionArray[buttonIndex]->repeat) {
+                if(!source->_buttonActionArray[buttonIndex]->repeat) {
                     //-- This button just went down
-                    if(_rgButtonValues[buttonIndex] == BUTTON_DOWN) {
+                    if(source->_rgButtonValues[buttonIndex] == BUTTON_DOWN) {
                         // Check for a multi-button action
                         QList<int> rgButtons = { buttonIndex };
                         bool executeButtonAction = true;
-                        for (int multiIndex = 0; multiIndex < _totalButtonCount; multiIndex++) {
+                        for (int multiIndex = 0; multiIndex < source->_totalButtonCount; multiIndex++) {
                             if (multiIndex != buttonIndex) {
-                                if (_buttonActionArray[multiIndex] && _buttonActionArray[multiIndex]->action == buttonAction) {
+                                if (source->_buttonActionArray[multiIndex] && source->_buttonActionArray[multiIndex]->action == buttonAction) {
                                     // We found a multi-button action
-                                    if (_rgButtonValues[multiIndex] == BUTTON_DOWN || _rgButtonValues[multiIndex] == BUTTON_REPEAT) {
+                                    if (source->_rgButtonValues[multiIndex] == BUTTON_DOWN || source->_rgButtonValues[multiIndex] == BUTTON_REPEAT) {
                                         // So far so good
                                         rgButtons.append(multiIndex);
                                         continue;
@@ -567,22 +619,22 @@ void Joystick::_handleButtons()
                     }
                 } else {
                     //-- Process repeat buttons
-                    int buttonDelay = static_cast<int>(1000.0f / _buttonFrequencyHz);
-                    if(_buttonActionArray[buttonIndex]->buttonTime.elapsed() > buttonDelay) {
-                        _buttonActionArray[buttonIndex]->buttonTime.start();
+                    int buttonDelay = static_cast<int>(1000.0f / source->_buttonFrequencyHz);
+                    if(source->_buttonActionArray[buttonIndex]->buttonTime.elapsed() > buttonDelay) {
+                        source->_buttonActionArray[buttonIndex]->buttonTime.start();
                         qCDebug(JoystickLog) << "Repeat button triggered" << buttonIndex << buttonAction;
                         _executeButtonAction(buttonAction, true);
                     }
                 }
             }
             //-- Flag it as processed
-            _rgButtonValues[buttonIndex] = BUTTON_REPEAT;
-        } else if(_rgButtonValues[buttonIndex] == BUTTON_UP) {
+            source->_rgButtonValues[buttonIndex] = BUTTON_REPEAT;
+        } else if(source->_rgButtonValues[buttonIndex] == BUTTON_UP) {
             //-- Button up transition
             if(buttonIndex < 256) {
                 if(lastBbuttonValues[buttonIndex] == BUTTON_DOWN || lastBbuttonValues[buttonIndex] == BUTTON_REPEAT) {
-                    if(_buttonActionArray[buttonIndex]) {
-                        QString buttonAction = _buttonActionArray[buttonIndex]->action;
+                    if(source->_buttonActionArray[buttonIndex]) {
+                        QString buttonAction = source->_buttonActionArray[buttonIndex]->action;
                         if(buttonAction.isEmpty() || buttonAction == _buttonActionNone)
                             continue;
                         qCDebug(JoystickLog) << "Button up" << buttonIndex << buttonAction;
@@ -594,19 +646,70 @@ void Joystick::_handleButtons()
     }
 }
 
+void Joystick::_updateAxisStats(qint64 now, bool periodic)
+{
+    _axisStatsSendCount++;
+    if (periodic) {
+        const qint64 jitter = now - _nextAxisSendNsecs;
+        _axisStatsTotalJitter += jitter;
+        _axisStatsMaxJitter = qMax(_axisStatsMaxJitter, jitter);
+    }
+    if (_axisChangeNsecs >= 0) {
+        _axisStatsChangeCount++;
+        _axisStatsMaxLatency = qMax(_axisStatsMaxLatency, now - _axisChangeNsecs);
+    }
+
+    if (now - _axisStatsStartNsecs >= _axisStatsIntervalNsecs) {
+        const int periodicCount = _axisStatsSendCount - _axisStatsChangeCount;
+        qCDebug(JoystickLog) << "Axis send stats: sends" << _axisStatsSendCount
+                             << "on change" << _axisStatsChangeCount
+                             << "avg jitter(us)" << (periodicCount > 0 ? (_axisStatsTotalJitter / periodicCount) / 1000 : 0)
+                             << "max jitter(us)" << _axisStatsMaxJitter / 1000
+                             << "max latency(us)" << _axisStatsMaxLatency / 1000;
+        _axisStatsSendCount     = 0;
+        _axisStatsChangeCount   = 0;
+        _axisStatsTotalJitter   = 0;
+        _axisStatsMaxJitter     = 0;
+        _axisStatsMaxLatency    = 0;
+        _axisStatsStartNsecs    = now;
+    }
+}
+
 void Joystick::_handleAxis()
 {
-    //-- Get frequency
-    int axisDelay = static_cast<int>(1000.0f / _axisFrequencyHz);
-    //-- Check elapsed time since last run
-    if(_axisTime.elapsed() > axisDelay) {
-        _axisTime.start();
-        //-- Update axis
+    const qint64 now                = _axisTime.nsecsElapsed();
+    const qint64 sendPeriodNsecs    = static_cast<qint64>(1e9 / _axisFrequencyHz);
+
+    //-- Update axis
+    for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
+        int newAxisValue = _getAxis(axisIndex);
+        if (newAxisValue != _rgAxisValues[axisIndex]) {
+            _rgAxisValues[axisIndex] = newAxisValue;
+            if (_axisChangeNsecs < 0) {
+                _axisChangeNsecs = now;
+            }
+        }
+    }
+
+    //-- Send at the axis frequency, a change is sent right away as long as the last send was at least half a period ago.
+    //-- An early send restarts the period.
+    const bool periodic = now >= _nextAxisSendNsecs;
+    const bool onChange = _axisChangeNsecs >= 0 && now - _lastAxisSendNsecs >= sendPeriodNsecs / 2;
+    if (periodic || onChange) {
+        _updateAxisStats(now, periodic);
+        const float sinceLastSendSecs = qMin(static_cast<float>(now - _lastAxisSendNsecs) / 1e9f, 0.1f);
+        if (periodic) {
+            _nextAxisSendNsecs += sendPeriodNsecs;
+        }
+        if (!periodic || _nextAxisSendNsecs <= now) {
+            _nextAxisSendNsecs = now + sendPeriodNsecs;
+        }
+        _lastAxisSendNsecs  = now;
+        _axisChangeNsecs    = -1;
+
         for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
-            int newAxisValue = _getAxis(axisIndex);
             // Calibration code requires signal to be emitted even if value hasn't changed
-            _rgAxisValues[axisIndex] = newAxisValue;
-            emit rawAxisValueChanged(axisIndex, newAxisValue);
+            emit rawAxisValueChanged(axisIndex, _rgAxisValues[axisIndex]);
         }
         if (_activeVehicle->joystickEnabled() && !_calibrationMode && _calibrated) {
             int     axis = _rgFunctionAxis[rollFunction];
@@ -636,7 +739,7 @@ void Joystick::_handleAxis()
 
             if (_accumulator) {
                 static float throttle_accu = 0.f;
-                throttle_accu += throttle * (40 / 1000.f); //for throttle to change from min to max it will take 1000ms (40ms is a loop time)
+                throttle_accu += throttle * sinceLastSendSecs; //for throttle to change from min to max it will take 1000ms
                 throttle_accu = std::max(static_cast<float>(-1.f), std::min(throttle_accu, static_cast<float>(1.f)));
                 throttle = throttle_accu;
             }
@@ -14,6 +14,7 @@
 
 #include <QObject>
 #include <QThread>
+#include <QMutex>
 #include <atomic>
 
 #include "QGCLoggingCategory.h"
@@ -142,6 +143,10 @@ public:
 
     void stop();
 
+    /// Other connected devices whose buttons are read by this joystick's polling thread while it is the active one.
+    /// Their button actions are executed as if they were assigned to this joystick, axes are only taken from this one.
+    void setAuxiliaryJoysticks(const QList<Joystick*>& joysticks);
+
 /*
     // Joystick index used by sdl library
     // Settable because sdl library remaps indices after certain events
@@ -236,7 +241,9 @@ protected:
     bool    _validAxis              (int axis) const;
     bool    _validButton            (int button) const;
     void    _handleAxis             ();
-    void    _handleButtons          ();
+    void    _updateAxisStats        (qint64 now, bool periodic);
+    void    _handleButtons          (Joystick* source);
+    void    _handleAuxiliaryButtons ();
     void    _buildActionList        (Vehicle* activeVehicle);
 
     void    _pitchStep              (int direction);
@@ -289,6 +296,10 @@ protected:
 
     bool    _pollingStartedForCalibration = false;
 
+    QMutex              _auxiliaryMutex;            ///< Protects _auxiliaryJoysticks and their _auxiliaryOpen
+    QList<Joystick*>    _auxiliaryJoysticks;
+    bool                _auxiliaryOpen  = false;    ///< Opened by the polling thread of the joystick this one is an auxiliary of
+
     QString _name;
     bool    _calibrated;
     int     _axisCount;
@@ -299,7 +310,20 @@ protected:
 
     static int          _transmitterMode;
     int                 _rgFunctionAxis[maxFunction] = {};
-    QElapsedTimer       _axisTime;
+    QElapsedTimer       _axisTime;                      ///< Runs for the life of the joystick thread, all times below are relative to it
+    qint64              _nextAxisSendNsecs      = 0;    ///< Deadline of the next periodic MANUAL_CONTROL
+    qint64              _lastAxisSendNsecs      = 0;
+    qint64              _axisChangeNsecs        = -1;   ///< Poll time of the first axis change not sent yet, -1 if none
+
+    // MANUAL_CONTROL timing stats, logged to JoystickLog every _axisStatsIntervalNsecs
+    int                 _axisStatsSendCount     = 0;
+    int                 _axisStatsChangeCount   = 0;
+    qint64              _axisStatsTotalJitter   = 0;
+    qint64              _axisStatsMaxJitter     = 0;    ///< Largest lateness of a periodic send against its deadline
+    qint64              _axisStatsMaxLatency    = 0;    ///< Largest time from seeing an axis change to sending it
+    qint64              _axisStatsStartNsecs    = 0;
+
+    static const qint64 _axisStatsIntervalNsecs = 10000000000LL;
 
     QmlObjectListModel              _assignableButtonActions;
     QList<AssignedButtonAction*>    _buttonActionArray;
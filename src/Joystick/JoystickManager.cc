@@ -35,10 +35,13 @@ JoystickManager::JoystickManager(QGCApplication* app, QGCToolbox* toolbox)
 }
 
 JoystickManager::~JoystickManager() {
+    // Auxiliary joysticks are read by the active joystick thread, so all threads have to be stopped before any is deleted
+    for (Joystick* joystick: _name2JoystickMap) {
+        joystick->stop();
+    }
     QMap<QString, Joystick*>::iterator i;
     for (i = _name2JoystickMap.begin(); i != _name2JoystickMap.end(); ++i) {
         qCDebug(JoystickManagerLog) << "Releasing joystick:" << i.key();
-        i.value()->stop();
         delete i.value();
     }
     qDebug() << "Done";
@@ -99,6 +102,8 @@ void JoystickManager::_setActiveJoystickFromSettings(void)
     }
 
     _name2JoystickMap = newMap;
+    // Before the released joysticks are deleted
+    _updateAuxiliaryJoysticks();
     emit availableJoysticksChanged();
 
     if (!_name2JoystickMap.count()) {
@@ -139,9 +144,11 @@ void JoystickManager::setActiveJoystick(Joystick* joystick)
 
     if (_activeJoystick) {
         _activeJoystick->stopPolling();
+        _activeJoystick->setAuxiliaryJoysticks(QList<Joystick*>());
     }
 
     _activeJoystick = joystick;
+    _updateAuxiliaryJoysticks();
 
     if (_activeJoystick != nullptr) {
         qCDebug(JoystickManagerLog) << "Set active:" << _activeJoystick->name();
@@ -154,6 +161,22 @@ void JoystickManager::setActiveJoystick(Joystick* joystick)
     emit activeJoystickNameChanged(_activeJoystick?_activeJoystick->name():"");
 }
 
+/// All other connected devices are read along with the active joystick, for example a button box next to the stick
+void JoystickManager::_updateAuxiliaryJoysticks(void)
+{
+    if (!_activeJoystick) {
+        return;
+    }
+
+    QList<Joystick*> auxiliaryJoysticks;
+    for (Joystick* joystick: _name2JoystickMap) {
+        if (joystick != _activeJoystick) {
+            auxiliaryJoysticks.append(joystick);
+        }
+    }
+    _activeJoystick->setAuxiliaryJoysticks(auxiliaryJoysticks);
+}
+
 QVariantList JoystickManager::joysticks(void)
 {
     QVariantList list;
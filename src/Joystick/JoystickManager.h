@@ -68,6 +68,7 @@ private slots:
 
 private:
     void _setActiveJoystickFromSettings(void);
+    void _updateAuxiliaryJoysticks(void);
 
 private:
     Joystick*                   _activeJoystick;
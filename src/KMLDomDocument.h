@@ -26,10 +26,11 @@ public:
     void        appendChildToRoot   (const QDomNode& child);
     QDomElement addPlacemark        (const QString& name, bool visible);
     void        addTextElement      (QDomElement& parentElement, const QString& name, const QString& value);
-    QString     kmlColorString      (const QColor& color, double opacity = 1);
-    QString     kmlCoordString      (const QGeoCoordinate& coord);
     void        addLookAt           (QDomElement& parentElement, const QGeoCoordinate& coord);
 
+    static QString kmlColorString   (const QColor& color, double opacity = 1);
+    static QString kmlCoordString   (const QGeoCoordinate& coord);
+
     static const char* balloonStyleName;
 
 protected:
@@ -11,50 +11,67 @@
 
 #include <QFile>
 #include <QVariant>
+#include <QXmlStreamReader>
+
+#include <algorithm>
 
 const char* KMLHelper::_errorPrefix = QT_TR_NOOP("KML file load failed. %1");
 
-QDomDocument KMLHelper::_loadFile(const QString& kmlFile, QString& errorString)
+bool KMLHelper::_openFile(const QString& kmlFile, QFile& file, QString& errorString)
 {
-    QFile file(kmlFile);
-
     errorString.clear();
 
+    file.setFileName(kmlFile);
     if (!file.exists()) {
         errorString = QString(_errorPrefix).arg(tr("File not found: %1").arg(kmlFile));
-        return QDomDocument();
+        return false;
     }
 
     if (!file.open(QIODevice::ReadOnly)) {
         errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(kmlFile).arg(file.errorString()));
-        return QDomDocument();
+        return false;
     }
 
-    QDomDocument doc;
-    QString errorMessage;
-    int errorLine;
-    if (!doc.setContent(&file, &errorMessage, &errorLine)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(errorMessage).arg(errorLine));
-        return QDomDocument();
-    }
+    return true;
+}
 
-    return doc;
+/// Reads the rest of the file so that malformed XML is reported the same no matter where it is in the file
+bool KMLHelper::_readToEnd(const QString& kmlFile, QXmlStreamReader& xml, QString& errorString)
+{
+    while (!xml.atEnd()) {
+        xml.readNext();
+    }
+    if (xml.hasError()) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(xml.errorString()).arg(xml.lineNumber()));
+        return false;
+    }
+    return true;
 }
 
 ShapeFileHelper::ShapeType KMLHelper::determineShapeType(const QString& kmlFile, QString& errorString)
 {
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QFile file;
+    if (!_openFile(kmlFile, file, errorString)) {
         return ShapeFileHelper::Error;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count()) {
-        return ShapeFileHelper::Polygon;
+    // A Polygon anywhere in the file takes precedence over a LineString
+    bool                foundPolyline = false;
+    QXmlStreamReader    xml(&file);
+    while (!xml.atEnd()) {
+        if (xml.readNext() == QXmlStreamReader::StartElement) {
+            if (xml.name() == QLatin1String("Polygon")) {
+                return _readToEnd(kmlFile, xml, errorString) ? ShapeFileHelper::Polygon : ShapeFileHelper::Error;
+            } else if (xml.name() == QLatin1String("LineString")) {
+                foundPolyline = true;
+            }
+        }
+    }
+    if (!_readToEnd(kmlFile, xml, errorString)) {
+        return ShapeFileHelper::Error;
     }
 
-    rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count()) {
+    if (foundPolyline) {
         return ShapeFileHelper::Polyline;
     }
 
@@ -62,60 +79,122 @@ ShapeFileHelper::ShapeType KMLHelper::determineShapeType(const QString& kmlFile,
     return ShapeFileHelper::Error;
 }
 
-bool KMLHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+/// Loads the coordinates of the first shapeElement in the file
+///     @param coordinatesPath Element names from the shape element to its coordinates element
+bool KMLHelper::_loadCoordinates(const QString& kmlFile, const QString& shapeElement, const QStringList& coordinatesPath, QList<QGeoCoordinate>& coords, QString& errorString)
 {
-    errorString.clear();
-    vertices.clear();
+    coords.clear();
 
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QFile file;
+    if (!_openFile(kmlFile, file, errorString)) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find Polygon node in KML"));
+    QXmlStreamReader xml(&file);
+
+    bool foundShape = false;
+    while (!foundShape && !xml.atEnd()) {
+        foundShape = xml.readNext() == QXmlStreamReader::StartElement && xml.name() == shapeElement;
+    }
+    if (!foundShape) {
+        if (_readToEnd(kmlFile, xml, errorString)) {
+            errorString = QString(_errorPrefix).arg(tr("Unable to find %1 node in KML").arg(shapeElement));
+        }
         return false;
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("outerBoundaryIs").namedItem("LinearRing").namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
+    // Only direct children are matched at each level of the path
+    QString coordinatesText;
+    bool    foundCoordinates    = false;
+    int     depth               = 0;    // Element depth below the shape element
+    int     matched             = 0;    // Number of path elements matched by the current element chain
+    while (!foundCoordinates && !xml.atEnd()) {
+        QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            if (matched == depth++ && xml.name() == coordinatesPath[matched]) {
+                if (++matched == coordinatesPath.count()) {
+                    coordinatesText = xml.readElementText();
+                    foundCoordinates = true;
+                }
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (depth == 0) {
+                break;
+            }
+            if (matched == depth--) {
+                matched--;
+            }
+        }
+    }
+    if (!_readToEnd(kmlFile, xml, errorString)) {
+        return false;
+    }
+    if (!foundCoordinates) {
         errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
         return false;
     }
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
+    _parseCoordinates(coordinatesText, coords);
 
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
+    return true;
+}
 
-        QStringList rgValueStrings = coordinateString.split(",");
+void KMLHelper::_parseCoordinates(const QString& coordinatesText, QList<QGeoCoordinate>& coords)
+{
+    // Coordinates are whitespace separated lon,lat[,alt] tuples. They are parsed in place rather than split into a
+    // temporary string list since large boundaries can have hundreds of thousands of them.
+    QVector<QStringRef> tuples;
+    const int           length  = coordinatesText.length();
+    int                 i       = 0;
+    while (i < length) {
+        while (i < length && coordinatesText[i].isSpace()) {
+            i++;
+        }
+        int start = i;
+        while (i < length && !coordinatesText[i].isSpace()) {
+            i++;
+        }
+        if (i > start) {
+            tuples.append(coordinatesText.midRef(start, i - start));
+        }
+    }
+
+    // The last tuple is not loaded, for polygons it closes the ring by repeating the first one
+    coords.reserve(tuples.count());
+    for (int tupleIndex=0; tupleIndex<tuples.count()-1; tupleIndex++) {
+        const QStringRef&   tuple       = tuples[tupleIndex];
+        const int           lonEnd      = tuple.indexOf(QLatin1Char(','));
+        const QStringRef    latitude    = lonEnd < 0 ? QStringRef() : tuple.mid(lonEnd + 1);
 
         QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
+        coord.setLongitude(tuple.left(lonEnd).toDouble());
+        coord.setLatitude(latitude.left(latitude.indexOf(QLatin1Char(','))).toDouble());
 
-        rgCoords.append(coord);
+        coords.append(coord);
+    }
+}
+
+bool KMLHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+{
+    errorString.clear();
+    vertices.clear();
+
+    QList<QGeoCoordinate> rgCoords;
+    if (!_loadCoordinates(kmlFile, QStringLiteral("Polygon"), { QStringLiteral("outerBoundaryIs"), QStringLiteral("LinearRing"), QStringLiteral("coordinates") }, rgCoords, errorString)) {
+        return false;
     }
 
     // Determine winding, reverse if needed. QGC wants clockwise winding
     double sum = 0;
     for (int i=0; i<rgCoords.count(); i++) {
-        QGeoCoordinate coord1 = rgCoords[i];
-        QGeoCoordinate coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
+        const QGeoCoordinate& coord1 = rgCoords[i];
+        const QGeoCoordinate& coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
 
         sum += (coord2.longitude() - coord1.longitude()) * (coord2.latitude() + coord1.latitude());
     }
     bool reverse = sum < 0.0;
     if (reverse) {
-        QList<QGeoCoordinate> rgReversed;
-
-        for (int i=0; i<rgCoords.count(); i++) {
-            rgReversed.prepend(rgCoords[i]);
-        }
-        rgCoords = rgReversed;
+        std::reverse(rgCoords.begin(), rgCoords.end());
     }
 
     vertices = rgCoords;
@@ -128,40 +207,5 @@ bool KMLHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinat
     errorString.clear();
     coords.clear();
 
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
-        return false;
-    }
-
-    QDomNodeList rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find LineString node in KML"));
-        return false;
-    }
-
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
-        errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
-        return false;
-    }
-
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
-
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
-
-        QStringList rgValueStrings = coordinateString.split(",");
-
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
-
-        rgCoords.append(coord);
-    }
-
-    coords = rgCoords;
-
-    return true;
+    return _loadCoordinates(kmlFile, QStringLiteral("LineString"), { QStringLiteral("coordinates") }, coords, errorString);
 }
@@ -10,12 +10,17 @@
 #pragma once
 
 #include <QObject>
-#include <QDomDocument>
 #include <QList>
+#include <QStringList>
 #include <QGeoCoordinate>
 
 #include "ShapeFileHelper.h"
 
+class QFile;
+class QXmlStreamReader;
+
+/// Loads shapes from KML files. The file is parsed as a stream, so only the coordinates of the shape being loaded are
+/// kept in memory. All methods are safe to call from a background thread.
 class KMLHelper : public QObject
 {
     Q_OBJECT
@@ -26,7 +31,10 @@ public:
     static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString);
 
 private:
-    static QDomDocument _loadFile(const QString& kmlFile, QString& errorString);
+    static bool _openFile           (const QString& kmlFile, QFile& file, QString& errorString);
+    static bool _loadCoordinates    (const QString& kmlFile, const QString& shapeElement, const QStringList& coordinatesPath, QList<QGeoCoordinate>& coords, QString& errorString);
+    static bool _readToEnd          (const QString& kmlFile, QXmlStreamReader& xml, QString& errorString);
+    static void _parseCoordinates   (const QString& coordinatesText, QList<QGeoCoordinate>& coords);
 
     static const char* _errorPrefix;
 };
@@ -1,214 +1,302 @@
-/****************************************************************************
- *
- * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
- *
- * QGroundControl is licensed according to the terms in the file
- * COPYING.md in the root of the source code directory.
- *
- ****************************************************************************/
-
-
-/**
- * @file
- *   @brief Implementation of class LogCompressor.
- *          This class reads in a file containing messages and translates it into a tab-delimited CSV file.
- *   @author Lorenz Meier <mavteam@student.ethz.ch>
- */
-
-#include "LogCompressor.h"
-#include "QGCApplication.h"
-
-#include <QFile>
-#include <QFileInfo>
-#include <QDir>
-#include <QTextStream>
-#include <QStringList>
-#include <QFileInfo>
-#include <QList>
-#include <QDebug>
-
-/**
- * Initializes all the variables necessary for a compression run. This won't actually happen
- * until startCompression(...) is called.
- */
-LogCompressor::LogCompressor(QString logFileName, QString outFileName, QString delimiter) :
-	logFileName(logFileName),
-	outFileName(outFileName),
-	running(true),
-	currentDataLine(0),
-    delimiter(delimiter),
-    holeFillingEnabled(true)
-{
-    connect(this, &LogCompressor::logProcessingCriticalError, qgcApp(), &QGCApplication::criticalMessageBoxOnMainThread);
-}
-
-void LogCompressor::run()
-{
-	// Verify that the input file is useable
-	QFile infile(logFileName);
-	if (!infile.exists() || !infile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(infile.fileName()).absoluteFilePath()));
-		return;
-	}
-
-//    outFileName = logFileName;
-
-    QString outFileName;
-
-    QStringList parts = QFileInfo(infile.fileName()).absoluteFilePath().split(".", Qt::SkipEmptyParts);
-
-    parts.replace(0, parts.first() + "_compressed");
-    parts.replace(parts.size()-1, "txt");
-    outFileName = parts.join(".");
-
-	// Verify that the output file is useable
-    QFile outTmpFile(outFileName);
-    if (!outTmpFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since output file %1 is not writable").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath()));
-		return;
-	}
-
-
-	// First we search the input file through keySearchLimit number of lines
-	// looking for variables. This is necessary before CSV files require
-	// the same number of fields for every line.
-	const unsigned int keySearchLimit = 15000;
-	unsigned int keyCounter = 0;
-	QTextStream in(&infile);
-	QMap<QString, int> messageMap;
-
-	while (!in.atEnd() && keyCounter < keySearchLimit) {
-		QString messageName = in.readLine().split(delimiter).at(2);
-		messageMap.insert(messageName, 0);
-		++keyCounter;
-	}
-
-	// Now update each key with its index in the output string. These are
-	// all offset by one to account for the first field: timestamp_ms.
-    QMap<QString, int>::iterator i = messageMap.begin();
-	int j;
-	for (i = messageMap.begin(), j = 1; i != messageMap.end(); ++i, ++j) {
-		i.value() = j;
-	}
-
-	// Open the output file and write the header line to it
-	QStringList headerList(messageMap.keys());
-
-	QString headerLine = "timestamp_ms" + delimiter + headerList.join(delimiter) + "\n";
-    // Clean header names from symbols Matlab considers as Latex syntax
-    headerLine = headerLine.replace("timestamp", "TIMESTAMP");
-    headerLine = headerLine.replace(":", "");
-    headerLine = headerLine.replace("_", "");
-    headerLine = headerLine.replace(".", "");
-	outTmpFile.write(headerLine.toLocal8Bit());
-
-    _signalCriticalError(tr("Log compressor: Dataset contains dimensions: ") + headerLine);
-
-    // Template list stores a list for populating with data as it's parsed from messages.
-    QStringList templateList;
-    for (int i = 0; i < headerList.size() + 1; ++i) {
-        templateList << (holeFillingEnabled?"NaN":"");
-    }
-
-
-//	// Reset our position in the input file before we start the main processing loop.
-//    in.seek(0);
-
-//    // Search through all lines and build a list of unique timestamps
-//    QMap<quint64, QStringList> timestampMap;
-//    while (!in.atEnd()) {
-//        quint64 timestamp = in.readLine().split(delimiter).at(0).toULongLong();
-//        timestampMap.insert(timestamp, templateList);
-//    }
-
-    // Jump back to start of file
-    in.seek(0);
-
-    // Map of final output lines, key is time
-    QMap<quint64, QStringList> timestampMap;
-
-    // Run through the whole file and fill map of timestamps
-    while (!in.atEnd()) {
-        QStringList newLine = in.readLine().split(delimiter);
-        quint64 timestamp = newLine.at(0).toULongLong();
-
-        // Check if timestamp does exist - if not, add it
-        if (!timestampMap.contains(timestamp)) {
-            timestampMap.insert(timestamp, templateList);
-        }
-
-        QStringList list = timestampMap.value(timestamp);
-
-        QString currentDataName = newLine.at(2);
-        QString currentDataValue = newLine.at(3);
-        list.replace(messageMap.value(currentDataName), currentDataValue);
-        timestampMap.insert(timestamp, list);
-    }
-
-    int lineCounter = 0;
-
-    QStringList lastList = timestampMap.values().at(1);
-
-    foreach (QStringList list, timestampMap.values()) {
-        // Write this current time set out to the file
-        // only do so from the 2nd line on, since the first
-        // line could be incomplete
-        if (lineCounter > 1) {
-            // Set the timestamp
-            list.replace(0,QString("%1").arg(timestampMap.keys().at(lineCounter)));
-
-            // Fill holes if necessary
-            if (holeFillingEnabled) {
-                int index = 0;
-                foreach (const QString& str, list) {
-                    if (str == "" || str == "NaN") {
-                        list.replace(index, lastList.at(index));
-                    }
-                    index++;
-                }
-            }
-
-            // Set last list
-            lastList = list;
-
-            // Write data columns
-            QString output = list.join(delimiter) + "\n";
-            outTmpFile.write(output.toLocal8Bit());
-        }
-        lineCounter++;
-    }
-
-	// We're now done with the source file
-	infile.close();
-
-	// Clean up and update the status before we return.
-	currentDataLine = 0;
-	emit finishedFile(outFileName);
-	running = false;
-}
-
-/**
- * @param holeFilling If hole filling is enabled, the compressor tries to fill empty data fields with previous
- * values from the same variable (or NaN, if no previous value existed)
- */
-void LogCompressor::startCompression(bool holeFilling)
-{
-	holeFillingEnabled = holeFilling;
-	start();
-}
-
-bool LogCompressor::isFinished() const
-{
-	return !running;
-}
-
-int LogCompressor::getCurrentLine() const
-{
-	return currentDataLine;
-}
-
-
-void LogCompressor::_signalCriticalError(const QString& msg)
-{
-    emit logProcessingCriticalError(tr("Log Compressor"), msg);
-}
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file
+ *   @brief Implementation of class LogCompressor.
+ *          This class reads in a file containing messages and translates it into a tab-delimited CSV file.
+ *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ */
+
+#include "LogCompressor.h"
+#include "QGCApplication.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QStringList>
+#include <QFileInfo>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+
+const qint64    LogCompressor::_readBlockSize;
+const int       LogCompressor::_outputFlushSize;
+const int       LogCompressor::_maxPendingRows;
+
+/**
+ * Initializes all the variables necessary for a compression run. This won't actually happen
+ * until startCompression(...) is called.
+ */
+LogCompressor::LogCompressor(QString logFileName, QString outFileName, QString delimiter) :
+	logFileName(logFileName),
+	outFileName(outFileName),
+	running(true),
+	currentDataLine(0),
+    delimiter(delimiter),
+    holeFillingEnabled(true)
+{
+    connect(this, &LogCompressor::logProcessingCriticalError, qgcApp(), &QGCApplication::criticalMessageBoxOnMainThread);
+}
+
+/// Calls lineFn(begin, end) for each line of the file, reading it in large blocks. lineFn returns false to stop.
+template<typename LineFn>
+static void _forEachLine(QFile& file, qint64 blockSize, LineFn lineFn)
+{
+    QByteArray  buffer;
+    int         carry = 0;      ///< Bytes of a partial line at the start of buffer, left over from the previous block
+
+    while (true) {
+        buffer.resize(carry + static_cast<int>(blockSize));
+        qint64 cBytesRead = file.read(buffer.data() + carry, blockSize);
+        if (cBytesRead <= 0) {
+            break;
+        }
+
+        const char* lineStart   = buffer.constData();
+        const char* bufferEnd   = lineStart + carry + cBytesRead;
+        const char* lineEnd;
+        while ((lineEnd = static_cast<const char*>(memchr(lineStart, '\n', static_cast<size_t>(bufferEnd - lineStart)))) != nullptr) {
+            const char* contentEnd = (lineEnd > lineStart && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+            if (!lineFn(lineStart, contentEnd)) {
+                return;
+            }
+            lineStart = lineEnd + 1;
+        }
+
+        carry = static_cast<int>(bufferEnd - lineStart);
+        memmove(buffer.data(), lineStart, static_cast<size_t>(carry));
+    }
+
+    if (carry > 0) {
+        lineFn(buffer.constData(), buffer.constData() + carry);
+    }
+}
+
+/// Splits a line at delimiter into at most maxFields fields, without copying
+/// @return Number of fields found
+static int _splitFields(const char* begin, const char* end, const QByteArray& delimiter, QByteArray* fields, int maxFields)
+{
+    int count = 0;
+    while (count < maxFields) {
+        const char* fieldEnd = std::search(begin, end, delimiter.constData(), delimiter.constData() + delimiter.size());
+        fields[count++] = QByteArray::fromRawData(begin, static_cast<int>(fieldEnd - begin));
+        if (fieldEnd == end) {
+            break;
+        }
+        begin = fieldEnd + delimiter.size();
+    }
+    return count;
+}
+
+void LogCompressor::run()
+{
+	// Verify that the input file is useable
+	QFile infile(logFileName);
+	if (!infile.exists() || !infile.open(QIODevice::ReadOnly)) {
+		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(infile.fileName()).absoluteFilePath()));
+		return;
+	}
+
+    QString outFileName;
+
+    QStringList parts = QFileInfo(infile.fileName()).absoluteFilePath().split(".", Qt::SkipEmptyParts);
+
+    parts.replace(0, parts.first() + "_compressed");
+    parts.replace(parts.size()-1, "txt");
+    outFileName = parts.join(".");
+
+	// Verify that the output file is useable
+    QFile outTmpFile(outFileName);
+    if (!outTmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since output file %1 is not writable").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath()));
+		return;
+	}
+
+    const QByteArray    delimiterBytes = delimiter.toLocal8Bit();
+    QByteArray          fields[4];
+
+	// First we search the input file through keySearchLimit number of lines
+	// looking for variables. This is necessary before CSV files require
+	// the same number of fields for every line.
+	const unsigned int keySearchLimit = 15000;
+	unsigned int keyCounter = 0;
+	QMap<QString, int> messageMap;
+
+    _forEachLine(infile, _readBlockSize, [&](const char* begin, const char* end) {
+        if (_splitFields(begin, end, delimiterBytes, fields, 4) > 2) {
+            messageMap.insert(QString::fromLocal8Bit(fields[2]), 0);
+        }
+        return ++keyCounter < keySearchLimit;
+    });
+
+	// Now update each key with its index in the output string. These are
+	// all offset by one to account for the first field: timestamp_ms.
+    QHash<QByteArray, int> columnIndex;
+    int j = 1;
+    for (auto i = messageMap.begin(); i != messageMap.end(); ++i, ++j) {
+        i.value() = j;
+        columnIndex.insert(i.key().toLocal8Bit(), j);
+    }
+
+	// Open the output file and write the header line to it
+	QStringList headerList(messageMap.keys());
+
+	QString headerLine = "timestamp_ms" + delimiter + headerList.join(delimiter) + "\n";
+    // Clean header names from symbols Matlab considers as Latex syntax
+    headerLine = headerLine.replace("timestamp", "TIMESTAMP");
+    headerLine = headerLine.replace(":", "");
+    headerLine = headerLine.replace("_", "");
+    headerLine = headerLine.replace(".", "");
+	outTmpFile.write(headerLine.toLocal8Bit());
+
+    _signalCriticalError(tr("Log compressor: Dataset contains dimensions: ") + headerLine);
+
+    // Template row for populating with data as it's parsed from messages.
+    const QVector<QByteArray> templateRow(headerList.size() + 1, holeFillingEnabled ? QByteArray("NaN") : QByteArray());
+
+    // Rows are collected per timestamp and written out oldest first once more than _maxPendingRows timestamps are
+    // pending, so memory stays bounded. Logs are written in time order, the window only has to absorb reordering.
+    QMap<quint64, QVector<QByteArray>>  pendingRows;
+    QVector<QByteArray>                 lastRow;
+    int                                 rowCounter = 0;
+    QByteArray                          output;
+    QFuture<bool>                       pendingWrite;
+    bool                                writePending = false;
+    bool                                writeError = false;
+
+    auto flushOutput = [&](void) {
+        // The previous block is written while this one was being built
+        if (writePending) {
+            writeError |= !pendingWrite.result();
+        }
+        writePending = true;
+        QByteArray block;
+        block.swap(output);
+        pendingWrite = QtConcurrent::run([&outTmpFile, block]() {
+            return outTmpFile.write(block) == block.size();
+        });
+        output.reserve(_outputFlushSize + 4096);
+    };
+
+    auto writeRow = [&](quint64 timestamp, QVector<QByteArray>& row) {
+        // Only write from the 3rd row on, since the first rows could be incomplete
+        if (rowCounter == 1) {
+            lastRow = row;
+        } else if (rowCounter > 1) {
+            row[0] = QByteArray::number(timestamp);
+
+            // Fill holes from the previous row if necessary
+            if (holeFillingEnabled) {
+                for (int index=1; index<row.count(); index++) {
+                    const QByteArray& value = row[index];
+                    if (value.isEmpty() || value == "NaN") {
+                        row[index] = lastRow[index];
+                    }
+                }
+            }
+
+            for (int index=0; index<row.count(); index++) {
+                if (index) {
+                    output.append(delimiterBytes);
+                }
+                output.append(row[index]);
+            }
+            output.append('\n');
+            lastRow.swap(row);
+
+            if (output.size() >= _outputFlushSize) {
+                flushOutput();
+            }
+        }
+        rowCounter++;
+    };
+
+    // Jump back to start of file and run through the whole file
+    infile.seek(0);
+    output.reserve(_outputFlushSize + 4096);
+    _forEachLine(infile, _readBlockSize, [&](const char* begin, const char* end) {
+        currentDataLine++;
+        if (_splitFields(begin, end, delimiterBytes, fields, 4) < 4) {
+            return true;
+        }
+        int column = columnIndex.value(fields[2], 0);
+        if (column == 0) {
+            // Not one of the keys found at the start of the log
+            return true;
+        }
+
+        quint64 timestamp = fields[0].toULongLong();
+        auto iter = pendingRows.find(timestamp);
+        if (iter == pendingRows.end()) {
+            iter = pendingRows.insert(timestamp, templateRow);
+            if (pendingRows.count() > _maxPendingRows) {
+                auto oldest = pendingRows.begin();
+                writeRow(oldest.key(), oldest.value());
+                pendingRows.erase(oldest);
+                iter = pendingRows.find(timestamp);
+            }
+        }
+        // Deep copy, the field points into the read buffer
+        iter.value()[column] = QByteArray(fields[3].constData(), fields[3].size());
+        return true;
+    });
+
+    for (auto iter = pendingRows.begin(); iter != pendingRows.end(); ++iter) {
+        writeRow(iter.key(), iter.value());
+    }
+    flushOutput();
+    writeError |= !pendingWrite.result();
+    writePending = false;
+    if (writeError) {
+        _signalCriticalError(tr("Log Compressor: Writing output file %1 failed: %2").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath(), outTmpFile.errorString()));
+    }
+
+	// We're now done with the source file
+	infile.close();
+    outTmpFile.close();
+
+	// Clean up and update the status before we return.
+	currentDataLine = 0;
+	emit finishedFile(outFileName);
+	running = false;
+}
+
+/**
+ * @param holeFilling If hole filling is enabled, the compressor tries to fill empty data fields with previous
+ * values from the same variable (or NaN, if no previous value existed)
+ */
+void LogCompressor::startCompression(bool holeFilling)
+{
+	holeFillingEnabled = holeFilling;
+	start();
+}
+
+bool LogCompressor::isFinished() const
+{
+	return !running;
+}
+
+int LogCompressor::getCurrentLine() const
+{
+	return currentDataLine;
+}
+
+
+void LogCompressor::_signalCriticalError(const QString& msg)
+{
+    emit logProcessingCriticalError(tr("Log Compressor"), msg);
+}
@@ -50,5 +50,8 @@ signals:
     
 private:
     void _signalCriticalError(const QString& msg);
-    
+
+    static const qint64 _readBlockSize      = 1024 * 1024;  ///< Input is read in blocks of this size
+    static const int    _outputFlushSize    = 1024 * 1024;  ///< Output is written in blocks of about this size
+    static const int    _maxPendingRows     = 4096;         ///< Timestamps held back to put out of order lines in order
 };
@@ -12,6 +12,7 @@
 #include "SettingsManager.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#include "MAVLinkProtocol.h"
 
 #include <QSettings>
 
@@ -110,6 +111,12 @@ void
 MicrohardManager::setToolbox(QGCToolbox* toolbox)
 {
     QGCTool::setToolbox(toolbox);
+}
+
+//-----------------------------------------------------------------------------
+void
+MicrohardManager::initDeferred()
+{
     //-- Start it all
     _reset();
 }
@@ -238,6 +245,7 @@ void
 MicrohardManager::_rssiUpdatedLoc(int rssi)
 {
     _downlinkRSSI = rssi;
+    _toolbox->mavlinkProtocol()->logRadioStatus(_downlinkRSSI, _uplinkRSSI);
     _locTimer.stop();
     _locTimer.start(LONG_TIMEOUT);
     emit connectedChanged();
@@ -249,6 +257,7 @@ void
 MicrohardManager::_rssiUpdatedRem(int rssi)
 {
     _uplinkRSSI = rssi;
+    _toolbox->mavlinkProtocol()->logRadioStatus(_downlinkRSSI, _uplinkRSSI);
     _remTimer.stop();
     _remTimer.start(LONG_TIMEOUT);
     emit linkConnectedChanged();
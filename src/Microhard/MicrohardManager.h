@@ -43,6 +43,7 @@ public:
     ~MicrohardManager                           () override;
 
     void        setToolbox                      (QGCToolbox* toolbox) override;
+    void        initDeferred                    () override;
 
     int         connected                       () { return _connectedStatus; }
     int         linkConnected                   () { return _linkConnectedStatus; }
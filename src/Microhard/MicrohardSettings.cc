@@ -16,6 +16,8 @@
 //-----------------------------------------------------------------------------
 MicrohardSettings::MicrohardSettings(QString address_, QObject* parent, bool setEncryptionKey)
     : MicrohardHandler(parent)
+    , _loggedIn(false)
+    , _rssiVal(0)
 {
     _address = address_;
     _setEncryptionKey = setEncryptionKey;
@@ -27,6 +29,7 @@ MicrohardSettings::start()
 {
     qCDebug(MicrohardLog) << "Start Microhard Settings";
     _loggedIn = false;
+    _lineBuffer.clear();
     _start(MICROHARD_SETTINGS_PORT, QHostAddress(_address));
     return true;
 }
@@ -67,17 +70,17 @@ MicrohardSettings::_readBytes()
     //qCDebug(MicrohardLog) << "Read bytes: " << bytesIn;
 
     if (_loggedIn) {
-        int i1 = bytesIn.indexOf("RSSI (dBm)");
-        if (i1 > 0) {
-            int i2 = bytesIn.indexOf(": ", i1);
-            if (i2 > 0) {
-                i2 += 2;
-                int i3 = bytesIn.indexOf(" ", i2);
-                int val = bytesIn.mid(i2, i3 - i2).toInt();
-                if (val < 0) {
-                    _rssiVal = val;
-                }
-            }
+        //-- Status output can be split across reads, only complete lines are parsed
+        _lineBuffer.append(bytesIn);
+        int start = 0;
+        int end;
+        while ((end = _lineBuffer.indexOf('\n', start)) >= 0) {
+            _parseStatusLine(_lineBuffer.mid(start, end - start));
+            start = end + 1;
+        }
+        _lineBuffer.remove(0, start);
+        if (_lineBuffer.size() > 4096) {
+            _lineBuffer.clear();
         }
     } else if (bytesIn.contains("login:")) {
         std::string userName = qgcApp()->toolbox()->microhardManager()->configUserName().toStdString() + "\n";
@@ -98,3 +101,22 @@ MicrohardSettings::_readBytes()
     emit rssiUpdated(_rssiVal);
 }
 
+
+//-----------------------------------------------------------------------------
+void
+MicrohardSettings::_parseStatusLine(const QByteArray& line)
+{
+    int i1 = line.indexOf("RSSI (dBm)");
+    if (i1 < 0) {
+        return;
+    }
+    int i2 = line.indexOf(": ", i1);
+    if (i2 > 0) {
+        i2 += 2;
+        int i3 = line.indexOf(" ", i2);
+        int val = line.mid(i2, i3 < 0 ? -1 : i3 - i2).trimmed().toInt();
+        if (val < 0) {
+            _rssiVal = val;
+        }
+    }
+}
@@ -28,8 +28,11 @@ signals:
     void    updateRSSI                  (int rssi);
 
 private:
+    void    _parseStatusLine            (const QByteArray& line);
+
     bool    _loggedIn;
     int     _rssiVal;
+    QByteArray _lineBuffer;                 ///< Status output not yet terminated by a newline
     QString _address;
     bool    _setEncryptionKey;
 };
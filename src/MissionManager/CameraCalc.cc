@@ -12,6 +12,7 @@
 #include "Vehicle.h"
 #include "CameraMetaData.h"
 #include "PlanMasterController.h"
+#include "QGC.h"
 
 #include <QQmlEngine>
 
@@ -144,8 +145,6 @@ void CameraCalc::_recalcTriggerDistance(void)
         return;
     }
 
-    _disableRecalc = true;
-
     double focalLength =    this->focalLength()->rawValue().toDouble();
     double sensorWidth =    this->sensorWidth()->rawValue().toDouble();
     double sensorHeight =   this->sensorHeight()->rawValue().toDouble();
@@ -157,6 +156,8 @@ void CameraCalc::_recalcTriggerDistance(void)
         return;
     }
 
+    _disableRecalc = true;
+
     if (_valueSetIsDistanceFact.rawValue().toBool()) {
         _imageDensityFact.setRawValue((_distanceToSurfaceFact.rawValue().toDouble() * sensorWidth * 100.0) / (imageWidth * focalLength));
     } else {
@@ -165,18 +166,27 @@ void CameraCalc::_recalcTriggerDistance(void)
 
     imageDensity = _imageDensityFact.rawValue().toDouble();
 
+    double imageFootprintSide;
+    double imageFootprintFrontal;
     if (landscape()->rawValue().toBool()) {
-        _imageFootprintSide =       (imageWidth  * imageDensity) / 100.0;
-        _imageFootprintFrontal =    (imageHeight * imageDensity) / 100.0;
+        imageFootprintSide =    (imageWidth  * imageDensity) / 100.0;
+        imageFootprintFrontal = (imageHeight * imageDensity) / 100.0;
     } else {
-        _imageFootprintSide  =      (imageHeight * imageDensity) / 100.0;
-        _imageFootprintFrontal =    (imageWidth  * imageDensity) / 100.0;
+        imageFootprintSide =    (imageHeight * imageDensity) / 100.0;
+        imageFootprintFrontal = (imageWidth  * imageDensity) / 100.0;
     }
-    _adjustedFootprintSideFact.setRawValue      (_imageFootprintSide * ((100.0 - _sideOverlapFact.rawValue().toDouble()) / 100.0));
-    _adjustedFootprintFrontalFact.setRawValue   (_imageFootprintFrontal * ((100.0 - _frontalOverlapFact.rawValue().toDouble()) / 100.0));
+    // Facts only signal real changes, do the same for the footprints so dependent items are not recalculated needlessly
+    _adjustedFootprintSideFact.setRawValue      (imageFootprintSide * ((100.0 - _sideOverlapFact.rawValue().toDouble()) / 100.0));
+    _adjustedFootprintFrontalFact.setRawValue   (imageFootprintFrontal * ((100.0 - _frontalOverlapFact.rawValue().toDouble()) / 100.0));
 
-    emit imageFootprintSideChanged      (_imageFootprintSide);
-    emit imageFootprintFrontalChanged   (_imageFootprintFrontal);
+    if (!QGC::fuzzyCompare(_imageFootprintSide, imageFootprintSide)) {
+        _imageFootprintSide = imageFootprintSide;
+        emit imageFootprintSideChanged(_imageFootprintSide);
+    }
+    if (!QGC::fuzzyCompare(_imageFootprintFrontal, imageFootprintFrontal)) {
+        _imageFootprintFrontal = imageFootprintFrontal;
+        emit imageFootprintFrontalChanged(_imageFootprintFrontal);
+    }
 
     _disableRecalc = false;
 }
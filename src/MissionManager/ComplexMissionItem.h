@@ -14,6 +14,7 @@
 #include "QGCToolbox.h"
 #include "SettingsManager.h"
 #include "KMLPlanDomDocument.h"
+#include "KMLPlanStreamWriter.h"
 #include "QmlObjectListModel.h"
 #include "FlightPathSegment.h"
 
@@ -95,6 +96,7 @@ public:
     virtual QString presetsSettingsGroup(void) { return QString(); }
 
     virtual void addKMLVisuals(KMLPlanDomDocument& domDocument);
+    virtual void addKMLVisuals(KMLPlanStreamWriter& kmlWriter);
 
     bool presetsSupported   (void) { return !presetsSettingsGroup().isEmpty(); }
     bool isIncomplete       (void) const { return _isIncomplete; }
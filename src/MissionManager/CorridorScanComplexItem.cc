@@ -232,16 +232,57 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         _loadedMissionItemsParent = nullptr;
     }
 
-    double transectSpacing = _calcTransectSpacing();
-    double fullWidth = _corridorWidthFact.rawValue().toDouble();
+    _transects = _buildTransects(_transectParams(), []() { return false; });
+}
+
+CorridorScanComplexItem::TransectsJob_t CorridorScanComplexItem::_rebuildTransectsPhase1Job(void)
+{
+    TransectParams_t params = _transectParams();
+
+    return [params](const TransectsCanceled_t& canceled) {
+        return _buildTransects(params, canceled);
+    };
+}
+
+/// @return Snapshot of everything needed to build the transects
+CorridorScanComplexItem::TransectParams_t CorridorScanComplexItem::_transectParams(void) const
+{
+    TransectParams_t params;
+
+    params.polyline             = _corridorPolyline.coordinateList();
+    params.transectSpacing      = _calcTransectSpacing();
+    params.corridorWidth        = _corridorWidthFact.rawValue().toDouble();
+    params.transectCount        = _calcTransectCount();
+    params.entryPoint           = _entryPoint;
+    params.hasTurnaround        = _hasTurnaround();
+    params.turnAroundDistance   = _turnAroundDistanceFact.rawValue().toDouble();
+
+    return params;
+}
+
+/// Builds the transects by offsetting the corridor polyline. Safe to call from any thread.
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> CorridorScanComplexItem::_buildTransects(const TransectParams_t& params, const TransectsCanceled_t& canceled)
+{
+    QList<QList<TransectStyleComplexItem::CoordInfo_t>> transects;
+
+    double transectSpacing = params.transectSpacing;
+    double fullWidth = params.corridorWidth;
     double halfWidth = fullWidth / 2.0;
-    int transectCount = _calcTransectCount();
+    int transectCount = params.transectCount;
     double normalizedTransectPosition = transectSpacing / 2.0;
 
-    if (_corridorPolyline.count() >= 2) {
+    if (params.polyline.count() >= 2) {
+        // The polyline is only converted to NED once, each transect is an offset of it
+        QList<QPointF> nedPolyline = QGCMapPolyline::nedPolyline(params.polyline);
+
         // First build up the transects all going the same direction
         //qDebug() << "_rebuildTransectsPhase1";
+        transects.reserve(transectCount);
         for (int i=0; i<transectCount; i++) {
+            if (canceled()) {
+                return QList<QList<TransectStyleComplexItem::CoordInfo_t>>();
+            }
+
             //qDebug() << "start transect";
             double offsetDistance;
             if (transectCount == 1) {
@@ -254,7 +295,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
             // Turn transect into CoordInfo transect
             QList<TransectStyleComplexItem::CoordInfo_t> transect;
-            QList<QGeoCoordinate> transectCoords = _corridorPolyline.offsetPolyline(offsetDistance);
+            QList<QGeoCoordinate> transectCoords = QGCMapPolyline::offsetPolyline(nedPolyline, params.polyline[0], offsetDistance);
             for (int j=1; j<transectCoords.count() - 1; j++) {
                 TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords[j], CoordTypeInterior };
                 transect.append(coordInfo);
@@ -265,9 +306,9 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             transect.append(coordInfo);
 
             // Extend the transect ends for turnaround
-            if (_hasTurnaround()) {
+            if (params.hasTurnaround) {
                 QGeoCoordinate turnaroundCoord;
-                double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+                double turnAroundDistance = params.turnAroundDistance;
 
                 double azimuth = transectCoords[0].azimuthTo(transectCoords[1]);
                 turnaroundCoord = transectCoords[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -289,7 +330,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             }
 #endif
 
-            _transects.append(transect);
+            transects.append(transect);
             normalizedTransectPosition += transectSpacing;
         }
 
@@ -301,7 +342,7 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
 
         bool reverseTransects = false;
         bool reverseVertices = false;
-        switch (_entryPoint) {
+        switch (params.entryPoint) {
         case 0:
             reverseTransects = false;
             reverseVertices = false;
@@ -321,26 +362,26 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         }
         if (reverseTransects) {
             QList<QList<TransectStyleComplexItem::CoordInfo_t>> reversedTransects;
-            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: _transects) {
+            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: transects) {
                 reversedTransects.prepend(transect);
             }
-            _transects = reversedTransects;
+            transects = reversedTransects;
         }
         if (reverseVertices) {
-            for (int i=0; i<_transects.count(); i++) {
+            for (int i=0; i<transects.count(); i++) {
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
-                for (const TransectStyleComplexItem::CoordInfo_t& vertex: _transects[i]) {
+                for (const TransectStyleComplexItem::CoordInfo_t& vertex: transects[i]) {
                     reversedVertices.prepend(vertex);
                 }
-                _transects[i] = reversedVertices;
+                transects[i] = reversedVertices;
             }
         }
 
         // Adjust to lawnmower pattern
         reverseVertices = false;
-        for (int i=0; i<_transects.count(); i++) {
+        for (int i=0; i<transects.count(); i++) {
             // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = _transects[i];
+            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = transects[i];
             if (reverseVertices) {
                 reverseVertices = false;
                 QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
@@ -359,9 +400,11 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
             } else {
                 reverseVertices = true;
             }
-            _transects[i] = transectVertices;
+            transects[i] = transectVertices;
         }
     }
+
+    return transects;
 }
 
 void CorridorScanComplexItem::_recalcCameraShots(void)
@@ -72,8 +72,22 @@ private slots:
     void _recalcCameraShots         (void) final;
 
 private:
+    /// Snapshot of the settings used to build transects, so they can be built away from the gui thread
+    typedef struct {
+        QList<QGeoCoordinate>   polyline;
+        double                  transectSpacing;
+        double                  corridorWidth;
+        int                     transectCount;
+        int                     entryPoint;
+        bool                    hasTurnaround;
+        double                  turnAroundDistance;
+    } TransectParams_t;
+
     double  _calcTransectSpacing    (void) const;
     int     _calcTransectCount      (void) const;
+    TransectParams_t                    _transectParams             (void) const;
+    TransectsJob_t                      _rebuildTransectsPhase1Job  (void) final;
+    static QList<QList<CoordInfo_t>>    _buildTransects             (const TransectParams_t& params, const TransectsCanceled_t& canceled);
     void    _saveCommon             (QJsonObject& complexObject);
     bool    _loadWorker              (const QJsonObject& complexObject, int sequenceNumber, QString& errorString, bool forPresets);
 
@@ -370,6 +370,37 @@ void GeoFenceController::_managerRemoveAllComplete(bool error)
     }
 }
 
+bool GeoFenceController::containsCoordinate(const QGeoCoordinate& coordinate)
+{
+    bool hasInclusion   = false;
+    bool included       = false;
+
+    for (int i=0; i<_polygons.count(); i++) {
+        QGCFencePolygon* polygon = _polygons.value<QGCFencePolygon*>(i);
+        if (polygon->inclusion()) {
+            hasInclusion = true;
+            if (!included && polygon->containsCoordinate(coordinate)) {
+                included = true;
+            }
+        } else if (polygon->containsCoordinate(coordinate)) {
+            return false;
+        }
+    }
+
+    for (int i=0; i<_circles.count(); i++) {
+        QGCFenceCircle* circle = _circles.value<QGCFenceCircle*>(i);
+        const bool inside = circle->center().distanceTo(coordinate) <= circle->radius()->rawValue().toDouble();
+        if (circle->inclusion()) {
+            hasInclusion = true;
+            included |= inside;
+        } else if (inside) {
+            return false;
+        }
+    }
+
+    return !hasInclusion || included;
+}
+
 bool GeoFenceController::containsItems(void) const
 {
     return _polygons.count() > 0 || _circles.count() > 0;
@@ -59,6 +59,10 @@ public:
     /// Clears the interactive bit from all fence items
     Q_INVOKABLE void clearAllInteractive(void);
 
+    /// Returns true if the coordinate is inside at least one inclusion fence (if there are any) and outside all
+    /// exclusion fences
+    Q_INVOKABLE bool containsCoordinate(const QGeoCoordinate& coordinate);
+
     double  paramCircularFence  (void);
     Fact*   breachReturnAltitude(void) { return &_breachReturnAltitudeFact; }
 
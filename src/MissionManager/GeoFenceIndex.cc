@@ -0,0 +1,355 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceIndex.h"
+
+#include <QtMath>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+GeoFenceIndex::GeoFenceIndex(const QList<Polygon_t>& polygons, const QList<Circle_t>& circles)
+{
+    // The local frame is centered on the fence so the flat projection error is spread evenly
+    int     originCount = 0;
+    double  latitudeSum = 0;
+    double  longitudeSum = 0;
+    for (const Polygon_t& polygon: polygons) {
+        if (polygon.vertices.count() >= 3) {
+            for (const QGeoCoordinate& vertex: polygon.vertices) {
+                latitudeSum += vertex.latitude();
+                longitudeSum += vertex.longitude();
+                originCount++;
+            }
+        }
+    }
+    for (const Circle_t& circle: circles) {
+        latitudeSum += circle.center.latitude();
+        longitudeSum += circle.center.longitude();
+        originCount++;
+    }
+    if (originCount == 0) {
+        return;
+    }
+    _originLatitude     = latitudeSum / originCount;
+    _originLongitude    = longitudeSum / originCount;
+    _metersPerDegreeLon = _metersPerDegree * qCos(qDegreesToRadians(_originLatitude));
+
+    for (const Polygon_t& polygon: polygons) {
+        const int vertexCount = polygon.vertices.count();
+        if (vertexCount < 3) {
+            continue;
+        }
+        const int fence = _fences.count();
+        _fences.append({ polygon.inclusion });
+        for (int i=0; i<vertexCount; i++) {
+            const QGeoCoordinate& a = polygon.vertices[i];
+            const QGeoCoordinate& b = polygon.vertices[(i + 1) % vertexCount];
+            Edge_t edge;
+            _toLocal(a.latitude(), a.longitude(), edge.ax, edge.ay);
+            _toLocal(b.latitude(), b.longitude(), edge.bx, edge.by);
+            edge.fence = fence;
+            _edges.append(edge);
+        }
+    }
+
+    for (const Circle_t& circle: circles) {
+        LocalCircle_t localCircle;
+        _toLocal(circle.center.latitude(), circle.center.longitude(), localCircle.x, localCircle.y);
+        localCircle.radius  = circle.radius;
+        localCircle.fence   = _fences.count();
+        _fences.append({ circle.inclusion });
+        _circles.append(localCircle);
+    }
+
+    for (const Fence_t& fence: _fences) {
+        _haveInclusion |= fence.inclusion;
+    }
+
+    if (!_edges.isEmpty()) {
+        _nodes.reserve((2 * _edges.count() / _maxLeafEdges) + 1);
+        _nodes.append(Node_t());
+        _buildNode(0, 0, _edges.count());
+    }
+}
+
+void GeoFenceIndex::_toLocal(double latitude, double longitude, double& x, double& y) const
+{
+    double lonDelta = longitude - _originLongitude;
+    if (lonDelta > 180.0) {
+        lonDelta -= 360.0;
+    } else if (lonDelta < -180.0) {
+        lonDelta += 360.0;
+    }
+    x = (latitude - _originLatitude) * _metersPerDegree;
+    y = lonDelta * _metersPerDegreeLon;
+}
+
+/// Fills in the node for the count edges from first, splitting them at the median of the longer axis
+void GeoFenceIndex::_buildNode(int nodeIndex, int first, int count)
+{
+    Node_t node;
+    node.minX   = node.minY = std::numeric_limits<double>::max();
+    node.maxX   = node.maxY = std::numeric_limits<double>::lowest();
+    node.first  = first;
+    node.count  = count;
+    node.left   = -1;
+
+    double midMinX = std::numeric_limits<double>::max();
+    double midMinY = std::numeric_limits<double>::max();
+    double midMaxX = std::numeric_limits<double>::lowest();
+    double midMaxY = std::numeric_limits<double>::lowest();
+    for (int i=first; i<first+count; i++) {
+        const Edge_t& edge = _edges[i];
+        node.minX = std::min({ node.minX, edge.ax, edge.bx });
+        node.minY = std::min({ node.minY, edge.ay, edge.by });
+        node.maxX = std::max({ node.maxX, edge.ax, edge.bx });
+        node.maxY = std::max({ node.maxY, edge.ay, edge.by });
+        midMinX = std::min(midMinX, edge.ax + edge.bx);
+        midMinY = std::min(midMinY, edge.ay + edge.by);
+        midMaxX = std::max(midMaxX, edge.ax + edge.bx);
+        midMaxY = std::max(midMaxY, edge.ay + edge.by);
+    }
+
+    if (count > _maxLeafEdges) {
+        const bool  splitX  = (midMaxX - midMinX) >= (midMaxY - midMinY);
+        const int   half    = count / 2;
+        std::nth_element(_edges.begin() + first, _edges.begin() + first + half, _edges.begin() + first + count,
+                         [splitX](const Edge_t& a, const Edge_t& b) {
+            return splitX ? (a.ax + a.bx) < (b.ax + b.bx) : (a.ay + a.by) < (b.ay + b.by);
+        });
+
+        node.count  = 0;
+        node.left   = _nodes.count();
+        _nodes.append(Node_t());
+        _nodes.append(Node_t());
+        _nodes[nodeIndex] = node;
+        _buildNode(node.left,       first,          half);
+        _buildNode(node.left + 1,   first + half,   count - half);
+    } else {
+        _nodes[nodeIndex] = node;
+    }
+}
+
+GeoFenceIndex::Status_t GeoFenceIndex::check(const Track_t& track, double lookaheadSecs) const
+{
+    Status_t status;
+    status.distance     = qQNaN();
+    status.breached     = false;
+    status.breachSecs   = qQNaN();
+
+    if (_fences.isEmpty()) {
+        return status;
+    }
+
+    double px, py;
+    _toLocal(track.latitude, track.longitude, px, py);
+
+    QVector<bool> inside;
+    _insideFences(px, py, inside);
+
+    status.distance = _closestDistance(px, py);
+    status.breached = _breached(inside);
+
+    if (status.breached) {
+        status.breachSecs = 0;
+        return status;
+    }
+
+    const double speed = qSqrt((track.velocityNorth * track.velocityNorth) + (track.velocityEast * track.velocityEast));
+    if (speed < 0.1 || lookaheadSecs <= 0) {
+        return status;
+    }
+
+    // Each boundary crossed along the projected track flips being inside that fence, in the order they are reached
+    QVector<Crossing_t> crossings;
+    _crossings(px, py, px + (track.velocityNorth * lookaheadSecs), py + (track.velocityEast * lookaheadSecs), crossings);
+    std::sort(crossings.begin(), crossings.end(), [](const Crossing_t& a, const Crossing_t& b) { return a.t < b.t; });
+    for (const Crossing_t& crossing: crossings) {
+        inside[crossing.fence] = !inside[crossing.fence];
+        if (_breached(inside)) {
+            status.breachSecs = crossing.t * lookaheadSecs;
+            break;
+        }
+    }
+
+    return status;
+}
+
+bool GeoFenceIndex::_breached(const QVector<bool>& inside) const
+{
+    bool insideInclusion = false;
+    for (int i=0; i<_fences.count(); i++) {
+        if (inside[i]) {
+            if (!_fences[i].inclusion) {
+                return true;
+            }
+            insideInclusion = true;
+        }
+    }
+    // Same as the firmware: being inside any one of the inclusion fences is enough
+    return _haveInclusion && !insideInclusion;
+}
+
+/// Crossing number along a ray to the north, only through the nodes the ray passes
+void GeoFenceIndex::_insideFences(double px, double py, QVector<bool>& inside) const
+{
+    inside.fill(false, _fences.count());
+
+    if (!_nodes.isEmpty()) {
+        QVarLengthArray<int, 64> stack;
+        stack.append(0);
+        while (!stack.isEmpty()) {
+            const Node_t& node = _nodes[stack.takeLast()];
+            if (py < node.minY || py > node.maxY || node.maxX <= px) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack.append(node.left);
+                stack.append(node.left + 1);
+                continue;
+            }
+            for (int i=node.first; i<node.first+node.count; i++) {
+                const Edge_t& edge = _edges[i];
+                if ((edge.ay > py) != (edge.by > py)) {
+                    const double x = edge.ax + ((py - edge.ay) * (edge.bx - edge.ax) / (edge.by - edge.ay));
+                    if (x > px) {
+                        inside[edge.fence] = !inside[edge.fence];
+                    }
+                }
+            }
+        }
+    }
+
+    for (const LocalCircle_t& circle: _circles) {
+        const double dx = px - circle.x;
+        const double dy = py - circle.y;
+        inside[circle.fence] = ((dx * dx) + (dy * dy)) < (circle.radius * circle.radius);
+    }
+}
+
+/// Branch and bound over the nodes, nearest child first so most of the tree is pruned
+double GeoFenceIndex::_closestDistance(double px, double py) const
+{
+    double best2 = std::numeric_limits<double>::max();
+
+    if (!_nodes.isEmpty()) {
+        QVarLengthArray<int, 64> stack;
+        stack.append(0);
+        while (!stack.isEmpty()) {
+            const Node_t& node = _nodes[stack.takeLast()];
+            if (_boxDistance2(node, px, py) >= best2) {
+                continue;
+            }
+            if (node.count == 0) {
+                const bool leftNearer = _boxDistance2(_nodes[node.left], px, py) <= _boxDistance2(_nodes[node.left + 1], px, py);
+                stack.append(leftNearer ? node.left + 1 : node.left);
+                stack.append(leftNearer ? node.left : node.left + 1);
+                continue;
+            }
+            for (int i=node.first; i<node.first+node.count; i++) {
+                best2 = std::min(best2, _segmentDistance2(_edges[i], px, py));
+            }
+        }
+    }
+
+    double best = qSqrt(best2);
+    for (const LocalCircle_t& circle: _circles) {
+        const double dx = px - circle.x;
+        const double dy = py - circle.y;
+        best = std::min(best, std::fabs(qSqrt((dx * dx) + (dy * dy)) - circle.radius));
+    }
+
+    return best;
+}
+
+/// Boundary crossings of the segment p-q, as fractions of the way from p to q
+void GeoFenceIndex::_crossings(double px, double py, double qx, double qy, QVector<Crossing_t>& crossings) const
+{
+    const double dx = qx - px;
+    const double dy = qy - py;
+
+    if (!_nodes.isEmpty()) {
+        const double segMinX = std::min(px, qx);
+        const double segMaxX = std::max(px, qx);
+        const double segMinY = std::min(py, qy);
+        const double segMaxY = std::max(py, qy);
+
+        QVarLengthArray<int, 64> stack;
+        stack.append(0);
+        while (!stack.isEmpty()) {
+            const Node_t& node = _nodes[stack.takeLast()];
+            if (segMaxX < node.minX || segMinX > node.maxX || segMaxY < node.minY || segMinY > node.maxY) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack.append(node.left);
+                stack.append(node.left + 1);
+                continue;
+            }
+            for (int i=node.first; i<node.first+node.count; i++) {
+                const Edge_t&   edge    = _edges[i];
+                const double    ex      = edge.bx - edge.ax;
+                const double    ey      = edge.by - edge.ay;
+                const double    denom   = (dx * ey) - (dy * ex);
+                if (std::fabs(denom) < 1e-9) {
+                    // Parallel, running along an edge doesn't cross it
+                    continue;
+                }
+                const double wx = edge.ax - px;
+                const double wy = edge.ay - py;
+                const double t  = ((wx * ey) - (wy * ex)) / denom;
+                const double u  = ((wx * dy) - (wy * dx)) / denom;
+                // Half open on the edge so a track through a vertex crosses only one of its two edges
+                if (t > 0 && t <= 1 && u >= 0 && u < 1) {
+                    crossings.append({ t, edge.fence });
+                }
+            }
+        }
+    }
+
+    const double a = (dx * dx) + (dy * dy);
+    for (const LocalCircle_t& circle: _circles) {
+        const double fx     = px - circle.x;
+        const double fy     = py - circle.y;
+        const double b      = 2 * ((fx * dx) + (fy * dy));
+        const double c      = (fx * fx) + (fy * fy) - (circle.radius * circle.radius);
+        const double disc   = (b * b) - (4 * a * c);
+        if (disc <= 0) {
+            continue;
+        }
+        const double root = qSqrt(disc);
+        for (double t: { (-b - root) / (2 * a), (-b + root) / (2 * a) }) {
+            if (t > 0 && t <= 1) {
+                crossings.append({ t, circle.fence });
+            }
+        }
+    }
+}
+
+double GeoFenceIndex::_boxDistance2(const Node_t& node, double px, double py)
+{
+    const double dx = std::max({ node.minX - px, 0.0, px - node.maxX });
+    const double dy = std::max({ node.minY - py, 0.0, py - node.maxY });
+    return (dx * dx) + (dy * dy);
+}
+
+double GeoFenceIndex::_segmentDistance2(const Edge_t& edge, double px, double py)
+{
+    const double ex     = edge.bx - edge.ax;
+    const double ey     = edge.by - edge.ay;
+    const double length2 = (ex * ex) + (ey * ey);
+    double t = length2 > 0 ? (((px - edge.ax) * ex) + ((py - edge.ay) * ey)) / length2 : 0;
+    t = std::min(1.0, std::max(0.0, t));
+    const double dx = edge.ax + (t * ex) - px;
+    const double dy = edge.ay + (t * ey) - py;
+    return (dx * dx) + (dy * dy);
+}
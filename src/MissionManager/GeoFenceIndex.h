@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QList>
+#include <QGeoCoordinate>
+
+#include <memory>
+
+/// Edge index of a set of inclusion and exclusion fences, used to check vehicle positions against them at runtime.
+///
+/// Fence vertices are projected onto a flat local frame around the fence, which is accurate enough over the few tens
+/// of kilometers a fence covers. All polygon edges go into a single bounding volume hierarchy, so the distance to the
+/// closest edge, the point in polygon test and the crossings along a projected track only visit the edges near the
+/// vehicle: O(log edges) per check instead of O(edges). Circles are checked directly, there are only ever a handful.
+///
+/// The index is immutable once built and touches no Qt objects, so it can be shared with worker threads.
+class GeoFenceIndex
+{
+public:
+    typedef struct {
+        QList<QGeoCoordinate>   vertices;
+        bool                    inclusion;
+    } Polygon_t;
+
+    typedef struct {
+        QGeoCoordinate  center;
+        double          radius;         ///< Meters
+        bool            inclusion;
+    } Circle_t;
+
+    typedef struct {
+        double latitude;
+        double longitude;
+        double velocityNorth;           ///< Meters/second, 0 if not known
+        double velocityEast;
+    } Track_t;
+
+    typedef struct {
+        double  distance;               ///< Meters to the closest fence boundary
+        bool    breached;               ///< Outside all inclusion fences or inside an exclusion fence
+        double  breachSecs;             ///< Time until the track breaches the fence, 0 if breached, NaN if not within the lookahead
+    } Status_t;
+
+    GeoFenceIndex(const QList<Polygon_t>& polygons, const QList<Circle_t>& circles);
+
+    bool isEmpty(void) const { return _fences.isEmpty(); }
+
+    /// Thread safe
+    Status_t check(const Track_t& track, double lookaheadSecs) const;
+
+private:
+    typedef struct {
+        bool    inclusion;
+    } Fence_t;
+
+    /// Local frame: x north, y east, meters
+    typedef struct {
+        double  ax, ay, bx, by;
+        int     fence;
+    } Edge_t;
+
+    typedef struct {
+        double  x, y, radius;
+        int     fence;
+    } LocalCircle_t;
+
+    /// Leaves hold count edges from first, inner nodes have count 0 and their children at left and left + 1
+    typedef struct {
+        double  minX, minY, maxX, maxY;
+        int     first;
+        int     count;
+        int     left;
+    } Node_t;
+
+    typedef struct {
+        double  t;                      ///< Fraction of the projected track
+        int     fence;
+    } Crossing_t;
+
+    void    _toLocal            (double latitude, double longitude, double& x, double& y) const;
+    void    _buildNode          (int nodeIndex, int first, int count);
+    void    _insideFences       (double px, double py, QVector<bool>& inside) const;
+    double  _closestDistance    (double px, double py) const;
+    void    _crossings          (double px, double py, double qx, double qy, QVector<Crossing_t>& crossings) const;
+    bool    _breached           (const QVector<bool>& inside) const;
+
+    static double _boxDistance2     (const Node_t& node, double px, double py);
+    static double _segmentDistance2 (const Edge_t& edge, double px, double py);
+
+    QVector<Fence_t>        _fences;
+    QVector<Edge_t>         _edges;
+    QVector<Node_t>         _nodes;
+    QVector<LocalCircle_t>  _circles;
+    bool                    _haveInclusion      = false;
+    double                  _originLatitude     = 0;
+    double                  _originLongitude    = 0;
+    double                  _metersPerDegreeLon = 0;
+
+    static constexpr double _metersPerDegree    = 111195.08;    ///< Earth radius of QGeoCoordinate, so distances agree with distanceTo
+    static constexpr int    _maxLeafEdges       = 4;
+};
+
+typedef std::shared_ptr<const GeoFenceIndex> SharedGeoFenceIndexPtr;
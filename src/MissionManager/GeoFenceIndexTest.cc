@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceIndexTest.h"
+#include "GeoFenceIndex.h"
+
+#include <QtMath>
+
+static const QGeoCoordinate _center(47.3977, 8.5456);
+
+/// Square with sides of 2 * halfSide meters around center
+static GeoFenceIndex::Polygon_t _square(const QGeoCoordinate& center, double halfSide, bool inclusion)
+{
+    const double diagonal = halfSide * M_SQRT2;
+    GeoFenceIndex::Polygon_t polygon;
+    polygon.vertices = {
+        center.atDistanceAndAzimuth(diagonal, 45),
+        center.atDistanceAndAzimuth(diagonal, 135),
+        center.atDistanceAndAzimuth(diagonal, 225),
+        center.atDistanceAndAzimuth(diagonal, 315),
+    };
+    polygon.inclusion = inclusion;
+    return polygon;
+}
+
+static GeoFenceIndex::Track_t _track(const QGeoCoordinate& coordinate, double velocityNorth = 0, double velocityEast = 0)
+{
+    return { coordinate.latitude(), coordinate.longitude(), velocityNorth, velocityEast };
+}
+
+void GeoFenceIndexTest::_inclusionPolygon_test(void)
+{
+    GeoFenceIndex index({ _square(_center, 1000, true /* inclusion */) }, {});
+
+    // Inside, standing still
+    GeoFenceIndex::Status_t status = index.check(_track(_center), 30);
+    QVERIFY(!status.breached);
+    QVERIFY(qAbs(status.distance - 1000) < 1);
+    QVERIFY(qIsNaN(status.breachSecs));
+
+    // Flying north at 50m/s reaches the edge after 20 seconds
+    status = index.check(_track(_center, 50, 0), 30);
+    QVERIFY(!status.breached);
+    QVERIFY(qAbs(status.breachSecs - 20) < 0.1);
+
+    // Too slow to get there within the lookahead
+    status = index.check(_track(_center, 10, 0), 30);
+    QVERIFY(qIsNaN(status.breachSecs));
+
+    // Outside
+    status = index.check(_track(_center.atDistanceAndAzimuth(1500, 90)), 30);
+    QVERIFY(status.breached);
+    QVERIFY(qAbs(status.distance - 500) < 1);
+    QCOMPARE(status.breachSecs, 0.0);
+}
+
+void GeoFenceIndexTest::_exclusionPolygon_test(void)
+{
+    // Exclusion zone 500 to 700 meters east, inside a large inclusion fence
+    const QGeoCoordinate exclusionCenter = _center.atDistanceAndAzimuth(600, 90);
+    GeoFenceIndex index({ _square(_center, 5000, true /* inclusion */), _square(exclusionCenter, 100, false /* inclusion */) }, {});
+
+    GeoFenceIndex::Status_t status = index.check(_track(_center, 0, 25), 30);
+    QVERIFY(!status.breached);
+    QVERIFY(qAbs(status.distance - 500) < 1);
+    QVERIFY(qAbs(status.breachSecs - 20) < 0.1);
+
+    // Passing north of the exclusion zone
+    status = index.check(_track(_center.atDistanceAndAzimuth(200, 0), 0, 25), 30);
+    QVERIFY(qIsNaN(status.breachSecs));
+
+    status = index.check(_track(exclusionCenter), 30);
+    QVERIFY(status.breached);
+    QVERIFY(qAbs(status.distance - 100) < 1);
+}
+
+void GeoFenceIndexTest::_circle_test(void)
+{
+    GeoFenceIndex index({}, { { _center, 500, true /* inclusion */ } });
+
+    GeoFenceIndex::Status_t status = index.check(_track(_center.atDistanceAndAzimuth(100, 180), -10, 0), 60);
+    QVERIFY(!status.breached);
+    QVERIFY(qAbs(status.distance - 400) < 1);
+    QVERIFY(qAbs(status.breachSecs - 40) < 0.1);
+
+    status = index.check(_track(_center.atDistanceAndAzimuth(600, 0)), 60);
+    QVERIFY(status.breached);
+    QVERIFY(qAbs(status.distance - 100) < 1);
+}
+
+void GeoFenceIndexTest::_manyEdges_test(void)
+{
+    // Circle of 1000 meters approximated by enough vertices to need a deep edge tree. The closest edge, the inside
+    // test and the crossing must all still be found.
+    GeoFenceIndex::Polygon_t polygon;
+    polygon.inclusion = true;
+    const int vertexCount = 4000;
+    for (int i=0; i<vertexCount; i++) {
+        polygon.vertices.append(_center.atDistanceAndAzimuth(1000, 360.0 * i / vertexCount));
+    }
+    GeoFenceIndex index({ polygon }, {});
+
+    for (double azimuth = 0; azimuth < 360; azimuth += 17) {
+        const QGeoCoordinate    coordinate      = _center.atDistanceAndAzimuth(700, azimuth);
+        const double            azimuthRadians  = qDegreesToRadians(azimuth);
+
+        // Heading straight out at 30m/s crosses after 10 seconds
+        GeoFenceIndex::Status_t status = index.check(_track(coordinate, 30 * qCos(azimuthRadians), 30 * qSin(azimuthRadians)), 30);
+        QVERIFY(!status.breached);
+        QVERIFY(qAbs(status.distance - 300) < 2);
+        QVERIFY(qAbs(status.breachSecs - 10) < 0.2);
+
+        status = index.check(_track(_center.atDistanceAndAzimuth(1200, azimuth)), 30);
+        QVERIFY(status.breached);
+        QVERIFY(qAbs(status.distance - 200) < 2);
+    }
+}
+
+void GeoFenceIndexTest::_noFence_test(void)
+{
+    GeoFenceIndex index({}, {});
+    QVERIFY(index.isEmpty());
+
+    const GeoFenceIndex::Status_t status = index.check(_track(_center, 10, 10), 30);
+    QVERIFY(!status.breached);
+    QVERIFY(qIsNaN(status.distance));
+    QVERIFY(qIsNaN(status.breachSecs));
+}
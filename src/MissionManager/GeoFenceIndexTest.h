@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the GeoFenceIndex distance, breach and breach prediction checks
+class GeoFenceIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _inclusionPolygon_test (void);
+    void _exclusionPolygon_test (void);
+    void _circle_test           (void);
+    void _manyEdges_test        (void);
+    void _noFence_test          (void);
+};
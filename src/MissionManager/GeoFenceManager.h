@@ -79,7 +79,8 @@ private slots:
     void _planManagerLoadComplete   (bool removeAllRequested);
 
 private:
-    void _sendError(ErrorCode_t errorCode, const QString& errorMsg);
+    void _sendError         (ErrorCode_t errorCode, const QString& errorMsg);
+    void _simplifyPolygon   (QGCFencePolygon& polygon, double toleranceMeters);
 
     QList<QGCFencePolygon>  _polygons;
     QList<QGCFenceCircle>   _circles;
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoFenceMonitor.h"
+#include "GeoFenceManager.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+
+#include <QtConcurrent>
+#include <QtMath>
+
+QGC_LOGGING_CATEGORY(GeoFenceMonitorLog, "GeoFenceMonitorLog")
+
+GeoFenceMonitor::GeoFenceMonitor(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+}
+
+GeoFenceMonitor::~GeoFenceMonitor()
+{
+    _checkWatcher.waitForFinished();
+}
+
+void GeoFenceMonitor::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    MultiVehicleManager* multiVehicleManager = toolbox->multiVehicleManager();
+    connect(multiVehicleManager,    &MultiVehicleManager::vehicleAdded,     this, &GeoFenceMonitor::_vehicleAdded);
+    connect(multiVehicleManager,    &MultiVehicleManager::vehicleRemoved,   this, &GeoFenceMonitor::_vehicleRemoved);
+    connect(&_checkTimer,           &QTimer::timeout,                       this, &GeoFenceMonitor::_startCheck);
+    connect(&_checkWatcher,         &QFutureWatcherBase::finished,          this, &GeoFenceMonitor::_checkComplete);
+    _checkTimer.start(_checkIntervalMSecs);
+}
+
+void GeoFenceMonitor::_vehicleAdded(Vehicle* vehicle)
+{
+    GeoFenceManager* geoFenceManager = vehicle->geoFenceManager();
+
+    // The manager only holds the fence the vehicle has, so it changes with a load or a successful send
+    connect(geoFenceManager, &GeoFenceManager::loadComplete,        this, [this, vehicle]() { _updateIndex(vehicle); });
+    connect(geoFenceManager, &GeoFenceManager::sendComplete,        this, [this, vehicle]() { _updateIndex(vehicle); });
+    connect(geoFenceManager, &GeoFenceManager::removeAllComplete,   this, [this, vehicle]() { _updateIndex(vehicle); });
+    _updateIndex(vehicle);
+}
+
+void GeoFenceMonitor::_vehicleRemoved(Vehicle* vehicle)
+{
+    _indices.remove(vehicle->id());
+    _breachVehicleIds.remove(vehicle->id());
+}
+
+void GeoFenceMonitor::_updateIndex(Vehicle* vehicle)
+{
+    GeoFenceManager* geoFenceManager = vehicle->geoFenceManager();
+
+    QList<GeoFenceIndex::Polygon_t> polygons;
+    for (const QGCFencePolygon& fencePolygon: geoFenceManager->polygons()) {
+        polygons.append({ fencePolygon.coordinateList(), fencePolygon.inclusion() });
+    }
+    QList<GeoFenceIndex::Circle_t> circles;
+    QList<QGCFenceCircle> fenceCircles = geoFenceManager->circles();
+    for (QGCFenceCircle& fenceCircle: fenceCircles) {
+        circles.append({ fenceCircle.center(), fenceCircle.radius()->rawValue().toDouble(), fenceCircle.inclusion() });
+    }
+
+    SharedGeoFenceIndexPtr index = std::make_shared<const GeoFenceIndex>(polygons, circles);
+    qCDebug(GeoFenceMonitorLog) << "Fence updated vehicle" << vehicle->id() << "polygons" << polygons.count() << "circles" << circles.count();
+
+    if (index->isEmpty()) {
+        _indices.remove(vehicle->id());
+        _breachVehicleIds.remove(vehicle->id());
+        vehicle->geoFenceFactGroup()->clearStatus();
+    } else {
+        _indices[vehicle->id()] = index;
+    }
+}
+
+void GeoFenceMonitor::_startCheck(void)
+{
+    if (_indices.isEmpty() || _checkWatcher.isRunning()) {
+        return;
+    }
+
+    MultiVehicleManager* multiVehicleManager = _toolbox->multiVehicleManager();
+
+    QVector<Job_t> jobs;
+    jobs.reserve(_indices.count());
+    for (auto it = _indices.constBegin(); it != _indices.constEnd(); it++) {
+        Vehicle* vehicle = multiVehicleManager->getVehicleById(it.key());
+        if (vehicle) {
+            jobs.append({ it.key(), it.value(), vehicle->telemetrySnapshot() });
+        }
+    }
+
+    _checkWatcher.setFuture(QtConcurrent::run(&GeoFenceMonitor::_check, jobs));
+}
+
+/// Runs on a worker thread
+QVector<GeoFenceMonitor::Result_t> GeoFenceMonitor::_check(const QVector<Job_t>& jobs)
+{
+    QVector<Result_t> results;
+    results.reserve(jobs.count());
+
+    for (const Job_t& job: jobs) {
+        VehicleTelemetrySnapshot::Telemetry_t telemetry;
+        if (!job.snapshot->vehicleActive() || !job.snapshot->read(telemetry) || qIsNaN(telemetry.latitude) || qIsNaN(telemetry.longitude)) {
+            continue;
+        }
+
+        // Heading stands in for the course over ground, same as the ADSB conflict check
+        const double course = qDegreesToRadians(telemetry.heading);
+        const bool   moving = qIsFinite(telemetry.groundSpeed) && qIsFinite(course);
+
+        GeoFenceIndex::Track_t track;
+        track.latitude      = telemetry.latitude;
+        track.longitude     = telemetry.longitude;
+        track.velocityNorth = moving ? telemetry.groundSpeed * qCos(course) : 0;
+        track.velocityEast  = moving ? telemetry.groundSpeed * qSin(course) : 0;
+
+        results.append({ job.vehicleId, job.index->check(track, lookaheadSecs) });
+    }
+
+    return results;
+}
+
+void GeoFenceMonitor::_checkComplete(void)
+{
+    MultiVehicleManager* multiVehicleManager = _toolbox->multiVehicleManager();
+
+    for (const Result_t& result: _checkWatcher.result()) {
+        Vehicle* vehicle = multiVehicleManager->getVehicleById(result.vehicleId);
+        if (!vehicle || !_indices.contains(result.vehicleId)) {
+            // Gone or fence removed while the check was running
+            continue;
+        }
+
+        const GeoFenceIndex::Status_t& status = result.status;
+        vehicle->geoFenceFactGroup()->setStatus(status.distance, status.breached, status.breachSecs);
+
+        const bool breachPredicted = !qIsNaN(status.breachSecs);
+        if (breachPredicted && !_breachVehicleIds.contains(result.vehicleId)) {
+            _breachVehicleIds.insert(result.vehicleId);
+            qCDebug(GeoFenceMonitorLog) << "Breach predicted vehicle" << result.vehicleId << "secs" << status.breachSecs << "distance" << status.distance;
+            emit breachPredicted(result.vehicleId, status.breachSecs);
+        } else if (!breachPredicted) {
+            _breachVehicleIds.remove(result.vehicleId);
+        }
+    }
+}
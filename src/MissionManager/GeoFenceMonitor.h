@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
+#include "GeoFenceIndex.h"
+#include "VehicleTelemetrySnapshot.h"
+
+#include <QTimer>
+#include <QMap>
+#include <QSet>
+#include <QFutureWatcher>
+
+Q_DECLARE_LOGGING_CATEGORY(GeoFenceMonitorLog)
+
+class Vehicle;
+
+/// Checks all connected vehicles against the fence loaded on each of them and predicts breaches before the vehicle
+/// reports them.
+///
+/// A GeoFenceIndex is built whenever a vehicle's fence is loaded from or sent to it. Every _checkIntervalMSecs, the
+/// rate vehicles publish their telemetry snapshots at, all vehicles are checked together on a worker thread which
+/// reads their positions straight from the snapshots. The result goes to the geoFence fact group of each vehicle.
+class GeoFenceMonitor : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    GeoFenceMonitor(QGCApplication* app, QGCToolbox* toolbox);
+    ~GeoFenceMonitor();
+
+    // QGCTool overrides
+    void setToolbox(QGCToolbox* toolbox) final;
+
+    static constexpr double lookaheadSecs = 30;     ///< How far ahead breaches are predicted
+
+signals:
+    /// Signalled when a vehicle breaches its fence or a breach is first predicted within lookaheadSecs
+    ///     @param breachSecs 0: already breached
+    void breachPredicted(int vehicleId, double breachSecs);
+
+private slots:
+    void _vehicleAdded      (Vehicle* vehicle);
+    void _vehicleRemoved    (Vehicle* vehicle);
+    void _startCheck        (void);
+    void _checkComplete     (void);
+
+private:
+    typedef struct {
+        int                                 vehicleId;
+        SharedGeoFenceIndexPtr              index;
+        SharedVehicleTelemetrySnapshotPtr   snapshot;
+    } Job_t;
+
+    typedef struct {
+        int                     vehicleId;
+        GeoFenceIndex::Status_t status;
+    } Result_t;
+
+    void                        _updateIndex    (Vehicle* vehicle);
+    static QVector<Result_t>    _check          (const QVector<Job_t>& jobs);
+
+    QMap<int, SharedGeoFenceIndexPtr>   _indices;           ///< By vehicle id, only vehicles with a fence
+    QSet<int>                           _breachVehicleIds;  ///< Vehicles currently breached or predicted to
+    QTimer                              _checkTimer;
+    QFutureWatcher<QVector<Result_t>>   _checkWatcher;
+
+    static constexpr int _checkIntervalMSecs = 100;
+};
@@ -8,18 +8,16 @@
  ****************************************************************************/
 
 #include "KMLPlanDomDocument.h"
+#include "KMLPlanStreamWriter.h"
 #include "QGCPalette.h"
 #include "QGCApplication.h"
-#include "MissionCommandTree.h"
-#include "MissionCommandUIInfo.h"
-#include "FactMetaData.h"
 #include "ComplexMissionItem.h"
 #include "QmlObjectListModel.h"
 
 #include <QDomDocument>
 #include <QStringList>
 
-const char* KMLPlanDomDocument::_missionLineStyleName =     "MissionLineStyle";
+const char* KMLPlanDomDocument::missionLineStyleName =     "MissionLineStyle";
 const char* KMLPlanDomDocument::surveyPolygonStyleName =   "SurveyPolygonStyle";
 
 KMLPlanDomDocument::KMLPlanDomDocument()
@@ -42,60 +40,33 @@ void KMLPlanDomDocument::_addFlightPath(Vehicle* vehicle, QList<MissionItem*> rg
     QDomElement flightPathElement = createElement("Placemark");
     _rootDocumentElement.appendChild(flightPathElement);
 
-    addTextElement(flightPathElement, "styleUrl",     QStringLiteral("#%1").arg(_missionLineStyleName));
+    addTextElement(flightPathElement, "styleUrl",     QStringLiteral("#%1").arg(missionLineStyleName));
     addTextElement(flightPathElement, "name",         "Flight Path");
     addTextElement(flightPathElement, "visibility",   "1");
     addLookAt(flightPathElement, rgMissionItems[0]->coordinate());
 
-    // Build up the mission trajectory line coords
-    QList<QGeoCoordinate> rgFlightCoords;
-    QGeoCoordinate homeCoord = rgMissionItems[0]->coordinate();
-    for (const MissionItem* item : rgMissionItems) {
-        const MissionCommandUIInfo* uiInfo = qgcApp()->toolbox()->missionCommandTree()->getUIInfo(vehicle, QGCMAVLink::VehicleClassGeneric, item->command());
-        if (uiInfo) {
-            double altAdjustment = item->frame() == MAV_FRAME_GLOBAL ? 0 : homeCoord.altitude(); // Used to convert to amsl
-            if (uiInfo->isTakeoffCommand() && !vehicle->fixedWing()) {
-                // These takeoff items go straight up from home position to specified altitude
-                QGeoCoordinate coord = homeCoord;
-                coord.setAltitude(item->param7() + altAdjustment);
-                rgFlightCoords += coord;
-            }
-            if (uiInfo->specifiesCoordinate()) {
-                QGeoCoordinate coord = item->coordinate();
-                coord.setAltitude(coord.altitude() + altAdjustment); // convert to amsl
-
-                if (!uiInfo->isStandaloneCoordinate()) {
-                    // Flight path goes through this item
-                    rgFlightCoords += coord;
-                }
-
-                // Add a place mark for each WP
-
-                QDomElement wpPlacemarkElement = createElement("Placemark");
-                addTextElement(wpPlacemarkElement, "name",     QStringLiteral("%1 %2").arg(QString::number(item->sequenceNumber())).arg(item->command() == MAV_CMD_NAV_WAYPOINT ? "" : uiInfo->friendlyName()));
-                addTextElement(wpPlacemarkElement, "styleUrl", QStringLiteral("#%1").arg(balloonStyleName));
-
-                QDomElement wpPointElement = createElement("Point");
-                addTextElement(wpPointElement, "altitudeMode", "absolute");
-                addTextElement(wpPointElement, "coordinates",  kmlCoordString(coord));
-                addTextElement(wpPointElement, "extrude",      "1");
-
-                QDomElement descriptionElement = createElement("description");
-                QString htmlString;
-                htmlString += QStringLiteral("Index: %1\n").arg(item->sequenceNumber());
-                htmlString += uiInfo->friendlyName() + "\n";
-                htmlString += QStringLiteral("Alt AMSL: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
-                htmlString += QStringLiteral("Alt Rel: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude() - homeCoord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
-                htmlString += QStringLiteral("Lat: %1\n").arg(QString::number(coord.latitude(), 'f', 7));
-                htmlString += QStringLiteral("Lon: %1\n").arg(QString::number(coord.longitude(), 'f', 7));
-                QDomCDATASection cdataSection = createCDATASection(htmlString);
-                descriptionElement.appendChild(cdataSection);
-
-                wpPlacemarkElement.appendChild(descriptionElement);
-                wpPlacemarkElement.appendChild(wpPointElement);
-                itemFolderElement.appendChild(wpPlacemarkElement);
-            }
-        }
+    // Build up the mission trajectory line coords and a place mark for each WP
+    QList<KMLPlanStreamWriter::Waypoint_t>  rgWaypoints;
+    QList<QGeoCoordinate>                   rgFlightCoords;
+    KMLPlanStreamWriter::buildFlightPath(vehicle, rgMissionItems, rgWaypoints, rgFlightCoords);
+
+    for (const KMLPlanStreamWriter::Waypoint_t& waypoint : rgWaypoints) {
+        QDomElement wpPlacemarkElement = createElement("Placemark");
+        addTextElement(wpPlacemarkElement, "name",     waypoint.name);
+        addTextElement(wpPlacemarkElement, "styleUrl", QStringLiteral("#%1").arg(balloonStyleName));
+
+        QDomElement wpPointElement = createElement("Point");
+        addTextElement(wpPointElement, "altitudeMode", "absolute");
+        addTextElement(wpPointElement, "coordinates",  kmlCoordString(waypoint.coordinate));
+        addTextElement(wpPointElement, "extrude",      "1");
+
+        QDomElement descriptionElement = createElement("description");
+        QDomCDATASection cdataSection = createCDATASection(waypoint.description);
+        descriptionElement.appendChild(cdataSection);
+
+        wpPlacemarkElement.appendChild(descriptionElement);
+        wpPlacemarkElement.appendChild(wpPointElement);
+        itemFolderElement.appendChild(wpPlacemarkElement);
     }
 
     // Create a LineString element from the coords
@@ -135,7 +106,7 @@ void KMLPlanDomDocument::_addStyles(void)
     QGCPalette palette;
 
     QDomElement styleElement1 = createElement("Style");
-    styleElement1.setAttribute("id", _missionLineStyleName);
+    styleElement1.setAttribute("id", missionLineStyleName);
     QDomElement lineStyleElement = createElement("LineStyle");
     addTextElement(lineStyleElement, "color", kmlColorString(palette.mapMissionTrajectory()));
     addTextElement(lineStyleElement, "width", "4");
@@ -25,11 +25,10 @@ public:
     void addMission(Vehicle* vehicle, QmlObjectListModel* visualItems, QList<MissionItem*> rgMissionItems);
 
     static const char* surveyPolygonStyleName;
+    static const char* missionLineStyleName;
 
 private:
     void _addStyles         (void);
     void _addFlightPath     (Vehicle* vehicle, QList<MissionItem*> rgMissionItems);
     void _addComplexItems   (QmlObjectListModel* visualItems);
-
-    static const char* _missionLineStyleName;
 };
@@ -0,0 +1,266 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "KMLPlanStreamWriter.h"
+#include "KMLPlanDomDocument.h"
+#include "QGCPalette.h"
+#include "QGCApplication.h"
+#include "MissionCommandTree.h"
+#include "MissionCommandUIInfo.h"
+#include "FactMetaData.h"
+#include "ComplexMissionItem.h"
+#include "QmlObjectListModel.h"
+#include "AppSettings.h"
+#include "QGCZipWriter.h"
+
+#include <QXmlStreamWriter>
+#include <QSaveFile>
+#include <QFileInfo>
+
+const char* KMLPlanStreamWriter::_kmzEntryName = "doc.kml";
+
+KMLPlanStreamWriter::KMLPlanStreamWriter(void)
+    : _documentName(QStringLiteral("%1 Plan KML").arg(qgcApp()->applicationName()))
+{
+    QGCPalette palette;
+
+    _missionLineColor   = KMLDomDocument::kmlColorString(palette.mapMissionTrajectory());
+    _surveyPolygonColor = KMLDomDocument::kmlColorString(palette.surveyPolygonInterior(), 0.5 /* opacity */);
+}
+
+void KMLPlanStreamWriter::buildFlightPath(Vehicle* vehicle, const QList<MissionItem*>& rgMissionItems, QList<Waypoint_t>& rgWaypoints, QList<QGeoCoordinate>& rgFlightCoords)
+{
+    if (rgMissionItems.count() == 0) {
+        return;
+    }
+
+    QGeoCoordinate homeCoord = rgMissionItems[0]->coordinate();
+    for (const MissionItem* item : rgMissionItems) {
+        const MissionCommandUIInfo* uiInfo = qgcApp()->toolbox()->missionCommandTree()->getUIInfo(vehicle, QGCMAVLink::VehicleClassGeneric, item->command());
+        if (uiInfo) {
+            double altAdjustment = item->frame() == MAV_FRAME_GLOBAL ? 0 : homeCoord.altitude(); // Used to convert to amsl
+            if (uiInfo->isTakeoffCommand() && !vehicle->fixedWing()) {
+                // These takeoff items go straight up from home position to specified altitude
+                QGeoCoordinate coord = homeCoord;
+                coord.setAltitude(item->param7() + altAdjustment);
+                rgFlightCoords += coord;
+            }
+            if (uiInfo->specifiesCoordinate()) {
+                QGeoCoordinate coord = item->coordinate();
+                coord.setAltitude(coord.altitude() + altAdjustment); // convert to amsl
+
+                if (!uiInfo->isStandaloneCoordinate()) {
+                    // Flight path goes through this item
+                    rgFlightCoords += coord;
+                }
+
+                // Add a place mark for each WP
+
+                Waypoint_t waypoint;
+                waypoint.name       = QStringLiteral("%1 %2").arg(QString::number(item->sequenceNumber())).arg(item->command() == MAV_CMD_NAV_WAYPOINT ? "" : uiInfo->friendlyName());
+                waypoint.coordinate = coord;
+                waypoint.description += QStringLiteral("Index: %1\n").arg(item->sequenceNumber());
+                waypoint.description += uiInfo->friendlyName() + "\n";
+                waypoint.description += QStringLiteral("Alt AMSL: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
+                waypoint.description += QStringLiteral("Alt Rel: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude() - homeCoord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
+                waypoint.description += QStringLiteral("Lat: %1\n").arg(QString::number(coord.latitude(), 'f', 7));
+                waypoint.description += QStringLiteral("Lon: %1\n").arg(QString::number(coord.longitude(), 'f', 7));
+                rgWaypoints.append(waypoint);
+            }
+        }
+    }
+}
+
+void KMLPlanStreamWriter::addMission(Vehicle* vehicle, QmlObjectListModel* visualItems, QList<MissionItem*> rgMissionItems)
+{
+    if (rgMissionItems.count()) {
+        _hasFlightPath  = true;
+        _lookAtCoord    = rgMissionItems[0]->coordinate();
+        buildFlightPath(vehicle, rgMissionItems, _rgWaypoints, _rgFlightCoords);
+    }
+
+    for (int i=0; i<visualItems->count(); i++) {
+        ComplexMissionItem* complexItem = visualItems->value<ComplexMissionItem*>(i);
+        if (complexItem) {
+            complexItem->addKMLVisuals(*this);
+        }
+    }
+}
+
+void KMLPlanStreamWriter::addPolygonPlacemark(const QString& name, const QList<QGeoCoordinate>& vertices, const QString& styleName)
+{
+    Polygon_t polygon;
+    polygon.name        = name;
+    polygon.styleName   = styleName;
+    polygon.vertices    = vertices;
+    _rgPolygons.append(polygon);
+}
+
+bool KMLPlanStreamWriter::write(QIODevice& device) const
+{
+    QXmlStreamWriter xml(&device);
+
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(1);
+    xml.writeStartDocument();
+    xml.writeStartElement(QStringLiteral("kml"));
+    xml.writeDefaultNamespace(QStringLiteral("http://www.opengis.net/kml/2.2"));
+    xml.writeStartElement(QStringLiteral("Document"));
+    xml.writeTextElement(QStringLiteral("name"), _documentName);
+    xml.writeTextElement(QStringLiteral("open"), QStringLiteral("1"));
+
+    _writeStyles(xml);
+    _writeFlightPath(xml);
+    _writePolygons(xml);
+
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
+
+bool KMLPlanStreamWriter::writeFile(const QString& filename, QString& errorString) const
+{
+    // QSaveFile only replaces the file once it is complete, a failed export leaves any previous file in place
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    if (QFileInfo(filename).suffix().compare(AppSettings::kmzFileExtension, Qt::CaseInsensitive) == 0) {
+        QGCZipWriter zipWriter(&file, _kmzEntryName);
+        if (!zipWriter.open(QIODevice::WriteOnly)) {
+            errorString = zipWriter.errorString();
+            return false;
+        }
+        const bool written = write(zipWriter);
+        if (!zipWriter.finish() || !written) {
+            errorString = zipWriter.errorString();
+            return false;
+        }
+    } else if (!write(file)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    if (!file.commit()) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void KMLPlanStreamWriter::_writeStyles(QXmlStreamWriter& xml) const
+{
+    xml.writeStartElement(QStringLiteral("Style"));
+    xml.writeAttribute(QStringLiteral("id"), KMLDomDocument::balloonStyleName);
+    xml.writeStartElement(QStringLiteral("BalloonStyle"));
+    xml.writeTextElement(QStringLiteral("text"), QStringLiteral("$[description]"));
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    xml.writeStartElement(QStringLiteral("Style"));
+    xml.writeAttribute(QStringLiteral("id"), KMLPlanDomDocument::missionLineStyleName);
+    xml.writeStartElement(QStringLiteral("LineStyle"));
+    xml.writeTextElement(QStringLiteral("color"), _missionLineColor);
+    xml.writeTextElement(QStringLiteral("width"), QStringLiteral("4"));
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    xml.writeStartElement(QStringLiteral("Style"));
+    xml.writeAttribute(QStringLiteral("id"), KMLPlanDomDocument::surveyPolygonStyleName);
+    xml.writeStartElement(QStringLiteral("PolyStyle"));
+    xml.writeTextElement(QStringLiteral("color"), _surveyPolygonColor);
+    xml.writeEndElement();
+    xml.writeStartElement(QStringLiteral("LineStyle"));
+    xml.writeTextElement(QStringLiteral("color"), _surveyPolygonColor);
+    xml.writeEndElement();
+    xml.writeEndElement();
+}
+
+void KMLPlanStreamWriter::_writeFlightPath(QXmlStreamWriter& xml) const
+{
+    if (!_hasFlightPath) {
+        return;
+    }
+
+    xml.writeStartElement(QStringLiteral("Folder"));
+    xml.writeTextElement(QStringLiteral("name"), QStringLiteral("Items"));
+    for (const Waypoint_t& waypoint : _rgWaypoints) {
+        xml.writeStartElement(QStringLiteral("Placemark"));
+        xml.writeTextElement(QStringLiteral("name"),        waypoint.name);
+        xml.writeTextElement(QStringLiteral("styleUrl"),    QStringLiteral("#%1").arg(KMLDomDocument::balloonStyleName));
+        xml.writeStartElement(QStringLiteral("description"));
+        xml.writeCDATA(waypoint.description);
+        xml.writeEndElement();
+        xml.writeStartElement(QStringLiteral("Point"));
+        xml.writeTextElement(QStringLiteral("altitudeMode"),    QStringLiteral("absolute"));
+        xml.writeTextElement(QStringLiteral("coordinates"),     KMLDomDocument::kmlCoordString(waypoint.coordinate));
+        xml.writeTextElement(QStringLiteral("extrude"),         QStringLiteral("1"));
+        xml.writeEndElement();
+        xml.writeEndElement();
+    }
+    xml.writeEndElement();
+
+    xml.writeStartElement(QStringLiteral("Placemark"));
+    xml.writeTextElement(QStringLiteral("styleUrl"),    QStringLiteral("#%1").arg(KMLPlanDomDocument::missionLineStyleName));
+    xml.writeTextElement(QStringLiteral("name"),        QStringLiteral("Flight Path"));
+    xml.writeTextElement(QStringLiteral("visibility"),  QStringLiteral("1"));
+
+    // Same values as KMLDomDocument::addLookAt
+    xml.writeStartElement(QStringLiteral("LookAt"));
+    xml.writeTextElement(QStringLiteral("latitude"),    QString::number(_lookAtCoord.latitude(), 'f', 7));
+    xml.writeTextElement(QStringLiteral("longitude"),   QString::number(_lookAtCoord.longitude(), 'f', 7));
+    xml.writeTextElement(QStringLiteral("altitude"),    QString::number(_lookAtCoord.longitude(), 'f', 2));
+    xml.writeTextElement(QStringLiteral("heading"),     QStringLiteral("-100"));
+    xml.writeTextElement(QStringLiteral("tilt"),        QStringLiteral("45"));
+    xml.writeTextElement(QStringLiteral("range"),       QStringLiteral("2500"));
+    xml.writeEndElement();
+
+    xml.writeStartElement(QStringLiteral("LineString"));
+    xml.writeTextElement(QStringLiteral("extruder"),        QStringLiteral("1"));
+    xml.writeTextElement(QStringLiteral("tessellate"),      QStringLiteral("1"));
+    xml.writeTextElement(QStringLiteral("altitudeMode"),    QStringLiteral("absolute"));
+    _writeCoordinates(xml, _rgFlightCoords, false /* closeRing */);
+    xml.writeEndElement();
+    xml.writeEndElement();
+}
+
+void KMLPlanStreamWriter::_writePolygons(QXmlStreamWriter& xml) const
+{
+    for (const Polygon_t& polygon : _rgPolygons) {
+        xml.writeStartElement(QStringLiteral("Placemark"));
+        xml.writeTextElement(QStringLiteral("name"),        polygon.name);
+        xml.writeTextElement(QStringLiteral("visibility"),  QStringLiteral("1"));
+        xml.writeStartElement(QStringLiteral("Polygon"));
+        xml.writeTextElement(QStringLiteral("altitudeMode"), QStringLiteral("clampToGround"));
+        xml.writeStartElement(QStringLiteral("outerBoundaryIs"));
+        xml.writeStartElement(QStringLiteral("LinearRing"));
+        _writeCoordinates(xml, polygon.vertices, true /* closeRing */);
+        xml.writeEndElement();
+        xml.writeEndElement();
+        xml.writeEndElement();
+        xml.writeTextElement(QStringLiteral("styleUrl"), QStringLiteral("#%1").arg(polygon.styleName));
+        xml.writeEndElement();
+    }
+}
+
+/// Coordinates are written one at a time so the text for large paths is never built up in memory
+void KMLPlanStreamWriter::_writeCoordinates(QXmlStreamWriter& xml, const QList<QGeoCoordinate>& rgCoords, bool closeRing) const
+{
+    xml.writeStartElement(QStringLiteral("coordinates"));
+    for (const QGeoCoordinate& coord : rgCoords) {
+        xml.writeCharacters(QStringLiteral("%1\n").arg(KMLDomDocument::kmlCoordString(coord)));
+    }
+    if (closeRing && rgCoords.count()) {
+        xml.writeCharacters(QStringLiteral("%1\n").arg(KMLDomDocument::kmlCoordString(rgCoords.first())));
+    }
+    xml.writeEndElement();
+}
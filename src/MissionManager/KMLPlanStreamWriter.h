@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QGeoCoordinate>
+
+class MissionItem;
+class Vehicle;
+class QmlObjectListModel;
+class QIODevice;
+class QXmlStreamWriter;
+
+/// Used to write a Plan as KML without building a document in memory.
+///
+/// Produces the same document as KMLPlanDomDocument. The plan is captured from the gui thread into plain values with
+/// addMission, the xml is then streamed straight to the file from write or writeFile, which can run on a worker
+/// thread since no Qt objects from the plan are touched.
+class KMLPlanStreamWriter
+{
+public:
+    KMLPlanStreamWriter(void);
+
+    typedef struct {
+        QString         name;
+        QString         description;
+        QGeoCoordinate  coordinate;         ///< Altitude is AMSL
+    } Waypoint_t;
+
+    typedef struct {
+        QString                 name;
+        QString                 styleName;
+        QList<QGeoCoordinate>   vertices;   ///< Ring is closed when written
+    } Polygon_t;
+
+    /// Captures the mission items and the visuals of complex items. Must be called from the gui thread.
+    void addMission(Vehicle* vehicle, QmlObjectListModel* visualItems, QList<MissionItem*> rgMissionItems);
+
+    /// Adds a Placemark holding a polygon, used by complex items to add their visuals
+    void addPolygonPlacemark(const QString& name, const QList<QGeoCoordinate>& vertices, const QString& styleName);
+
+    /// Writes the document to the device
+    ///     @return false: write to device failed
+    bool write(QIODevice& device) const;
+
+    /// Writes the document to the file, as a KMZ archive if the file has a .kmz extension
+    ///     @param[out] errorString Set if the file could not be written
+    bool writeFile(const QString& filename, QString& errorString) const;
+
+    /// Builds the waypoint placemarks and the flight path through them
+    ///     @param[out] rgWaypoints     One entry for each item which specifies a coordinate
+    ///     @param[out] rgFlightCoords  Flight path with AMSL altitudes
+    static void buildFlightPath(Vehicle* vehicle, const QList<MissionItem*>& rgMissionItems, QList<Waypoint_t>& rgWaypoints, QList<QGeoCoordinate>& rgFlightCoords);
+
+private:
+    void _writeStyles       (QXmlStreamWriter& xml) const;
+    void _writeFlightPath   (QXmlStreamWriter& xml) const;
+    void _writePolygons     (QXmlStreamWriter& xml) const;
+    void _writeCoordinates  (QXmlStreamWriter& xml, const QList<QGeoCoordinate>& rgCoords, bool closeRing) const;
+
+    QString                 _documentName;
+    QString                 _missionLineColor;
+    QString                 _surveyPolygonColor;
+    bool                    _hasFlightPath = false;
+    QGeoCoordinate          _lookAtCoord;
+    QList<Waypoint_t>       _rgWaypoints;
+    QList<QGeoCoordinate>   _rgFlightCoords;
+    QList<Polygon_t>        _rgPolygons;
+
+    static const char* _kmzEntryName;
+};
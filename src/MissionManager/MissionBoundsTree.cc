@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MissionBoundsTree.h"
+#include "QGCGeoBoundingCube.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+MissionBoundsTree::MissionBoundsTree(void)
+{
+    build(QVector<Bounds_t>());
+}
+
+MissionBoundsTree::Bounds_t MissionBoundsTree::emptyBounds(void)
+{
+    // Matches a reset QGCGeoBoundingCube
+    Bounds_t bounds;
+    bounds.north    = QGCGeoBoundingCube::MaxSouth;
+    bounds.south    = QGCGeoBoundingCube::MaxNorth;
+    bounds.west     = QGCGeoBoundingCube::MaxEast;
+    bounds.east     = QGCGeoBoundingCube::MaxWest;
+    bounds.bottom   = QGCGeoBoundingCube::MaxAlt;
+    bounds.top      = QGCGeoBoundingCube::MinAlt;
+    return bounds;
+}
+
+MissionBoundsTree::Bounds_t MissionBoundsTree::merge(const Bounds_t& first, const Bounds_t& second)
+{
+    Bounds_t bounds;
+    bounds.north                = std::max(first.north,     second.north);
+    bounds.south                = std::min(first.south,     second.south);
+    bounds.west                 = std::min(first.west,      second.west);
+    bounds.east                 = std::max(first.east,      second.east);
+    bounds.bottom               = std::min(first.bottom,    second.bottom);
+    bounds.top                  = std::max(first.top,       second.top);
+    bounds.firstCoordinate      = first.firstCoordinate.isValid() ? first.firstCoordinate : second.firstCoordinate;
+    bounds.takeoffCoordinate    = second.takeoffCoordinate.isValid() ? second.takeoffCoordinate : first.takeoffCoordinate;
+    return bounds;
+}
+
+void MissionBoundsTree::build(const QVector<Bounds_t>& leaves)
+{
+    _count      = leaves.count();
+    _leafBase   = 1;
+    while (_leafBase < _count) {
+        _leafBase *= 2;
+    }
+
+    _nodes.fill(emptyBounds(), 2 * _leafBase);
+    std::copy(leaves.constBegin(), leaves.constEnd(), _nodes.begin() + _leafBase);
+    for (int i=_leafBase-1; i>=1; i--) {
+        _nodes[i] = merge(_nodes[2 * i], _nodes[(2 * i) + 1]);
+    }
+}
+
+void MissionBoundsTree::set(int index, const Bounds_t& bounds)
+{
+    if (index < 0 || index >= _count) {
+        qWarning() << "MissionBoundsTree::set bad index" << index << _count;
+        return;
+    }
+
+    int node = _leafBase + index;
+    _nodes[node] = bounds;
+    for (node /= 2; node >= 1; node /= 2) {
+        _nodes[node] = merge(_nodes[2 * node], _nodes[(2 * node) + 1]);
+    }
+}
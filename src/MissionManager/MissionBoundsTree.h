@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QGeoCoordinate>
+
+/// Bounds of the mission items, merged in a segment tree so that a change to one item updates the mission bounds in
+/// O(log items) instead of going through all of them again.
+///
+/// Besides the extent, the merge keeps what MissionController needs to find the takeoff position: the coordinate of
+/// the first item which isn't a takeoff and the coordinate of the last takeoff item. Leaves are in visual item order.
+class MissionBoundsTree
+{
+public:
+    /// Same layout as QGCGeoBoundingCube. An item without bounds has north < south, which merges as a no-op.
+    typedef struct {
+        double          north;
+        double          south;
+        double          west;
+        double          east;
+        double          bottom;
+        double          top;
+        QGeoCoordinate  firstCoordinate;    ///< First non-takeoff item with bounds
+        QGeoCoordinate  takeoffCoordinate;  ///< Last takeoff item
+    } Bounds_t;
+
+    MissionBoundsTree(void);
+
+    /// Replaces all leaves, O(items)
+    void build(const QVector<Bounds_t>& leaves);
+
+    /// Replaces one leaf, O(log items)
+    void set(int index, const Bounds_t& bounds);
+
+    int             count   (void) const { return _count; }
+    const Bounds_t& root    (void) const { return _nodes[1]; }
+
+    static Bounds_t emptyBounds (void);
+    static bool     isEmpty     (const Bounds_t& bounds) { return bounds.north < bounds.south; }
+    static Bounds_t merge       (const Bounds_t& first, const Bounds_t& second);
+
+private:
+    QVector<Bounds_t>   _nodes;         ///< Root at 1, children of n at 2n and 2n + 1, leaves from _leafBase
+    int                 _leafBase   = 1;
+    int                 _count      = 0;
+};
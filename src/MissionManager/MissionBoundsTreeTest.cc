@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MissionBoundsTreeTest.h"
+#include "MissionBoundsTree.h"
+
+/// Bounds of a single point, as a simple waypoint has
+static MissionBoundsTree::Bounds_t _point(double latitude, double longitude, double altitude)
+{
+    MissionBoundsTree::Bounds_t bounds = MissionBoundsTree::emptyBounds();
+    bounds.north = bounds.south = latitude;
+    bounds.west  = bounds.east  = longitude;
+    bounds.bottom = bounds.top  = altitude;
+    bounds.firstCoordinate = QGeoCoordinate(latitude, longitude, altitude);
+    return bounds;
+}
+
+/// Bounds computed the way MissionController did before the tree, by going through all of them
+static MissionBoundsTree::Bounds_t _linearMerge(const QVector<MissionBoundsTree::Bounds_t>& leaves)
+{
+    MissionBoundsTree::Bounds_t bounds = MissionBoundsTree::emptyBounds();
+    for (const MissionBoundsTree::Bounds_t& leaf: leaves) {
+        bounds = MissionBoundsTree::merge(bounds, leaf);
+    }
+    return bounds;
+}
+
+static bool _sameExtent(const MissionBoundsTree::Bounds_t& a, const MissionBoundsTree::Bounds_t& b)
+{
+    return a.north == b.north && a.south == b.south && a.west == b.west && a.east == b.east && a.bottom == b.bottom && a.top == b.top;
+}
+
+void MissionBoundsTreeTest::_empty_test(void)
+{
+    MissionBoundsTree tree;
+    QCOMPARE(tree.count(), 0);
+    QVERIFY(MissionBoundsTree::isEmpty(tree.root()));
+    QVERIFY(!tree.root().firstCoordinate.isValid());
+    QVERIFY(!tree.root().takeoffCoordinate.isValid());
+
+    // Items without bounds leave it empty
+    tree.build({ MissionBoundsTree::emptyBounds(), MissionBoundsTree::emptyBounds() });
+    QCOMPARE(tree.count(), 2);
+    QVERIFY(MissionBoundsTree::isEmpty(tree.root()));
+}
+
+void MissionBoundsTreeTest::_build_test(void)
+{
+    QVector<MissionBoundsTree::Bounds_t> leaves = {
+        _point(47.1, 8.1, 10),
+        MissionBoundsTree::emptyBounds(),
+        _point(47.3, 8.0, 50),
+        _point(46.9, 8.4, 20),
+        _point(47.0, 8.2, 5),
+    };
+
+    MissionBoundsTree tree;
+    tree.build(leaves);
+
+    const MissionBoundsTree::Bounds_t& root = tree.root();
+    QVERIFY(!MissionBoundsTree::isEmpty(root));
+    QCOMPARE(root.north,    47.3);
+    QCOMPARE(root.south,    46.9);
+    QCOMPARE(root.west,     8.0);
+    QCOMPARE(root.east,     8.4);
+    QCOMPARE(root.bottom,   5.0);
+    QCOMPARE(root.top,      50.0);
+}
+
+void MissionBoundsTreeTest::_set_test(void)
+{
+    // Odd count so the last leaves have padding next to them
+    QVector<MissionBoundsTree::Bounds_t> leaves;
+    for (int i=0; i<37; i++) {
+        leaves.append(_point(47 + ((i * 7) % 13) * 0.01, 8 + ((i * 5) % 11) * 0.01, (i * 3) % 17));
+    }
+
+    MissionBoundsTree tree;
+    tree.build(leaves);
+    QVERIFY(_sameExtent(tree.root(), _linearMerge(leaves)));
+
+    // Move items around one at a time, the root must always match a full merge
+    const int indices[] = { 0, 36, 18, 5, 36, 0 };
+    double offset = 0.5;
+    for (int index: indices) {
+        leaves[index] = _point(47 + offset, 8 - offset, 100 * offset);
+        tree.set(index, leaves[index]);
+        QVERIFY(_sameExtent(tree.root(), _linearMerge(leaves)));
+        offset = -offset * 0.8;
+    }
+
+    // Removing the bounds of an item shrinks the extent again
+    leaves[0] = MissionBoundsTree::emptyBounds();
+    tree.set(0, leaves[0]);
+    QVERIFY(_sameExtent(tree.root(), _linearMerge(leaves)));
+}
+
+void MissionBoundsTreeTest::_coordinates_test(void)
+{
+    MissionBoundsTree::Bounds_t takeoff1 = _point(47.0, 8.0, 30);
+    takeoff1.takeoffCoordinate = takeoff1.firstCoordinate;
+    takeoff1.firstCoordinate = QGeoCoordinate();
+    MissionBoundsTree::Bounds_t takeoff2 = _point(47.2, 8.2, 40);
+    takeoff2.takeoffCoordinate = takeoff2.firstCoordinate;
+    takeoff2.firstCoordinate = QGeoCoordinate();
+
+    MissionBoundsTree tree;
+    tree.build({ MissionBoundsTree::emptyBounds(), takeoff1, _point(47.1, 8.1, 10), _point(47.3, 8.3, 10), takeoff2 });
+
+    // First item which isn't a takeoff, last takeoff
+    QCOMPARE(tree.root().firstCoordinate,   QGeoCoordinate(47.1, 8.1, 10));
+    QCOMPARE(tree.root().takeoffCoordinate, QGeoCoordinate(47.2, 8.2, 40));
+
+    tree.set(4, MissionBoundsTree::emptyBounds());
+    QCOMPARE(tree.root().takeoffCoordinate, QGeoCoordinate(47.0, 8.0, 30));
+
+    tree.set(1, MissionBoundsTree::emptyBounds());
+    QVERIFY(!tree.root().takeoffCoordinate.isValid());
+
+    tree.set(0, _point(46.0, 7.0, 0));
+    QCOMPARE(tree.root().firstCoordinate,   QGeoCoordinate(46.0, 7.0, 0));
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the MissionBoundsTree merges and incremental updates
+class MissionBoundsTreeTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _empty_test        (void);
+    void _build_test        (void);
+    void _set_test          (void);
+    void _coordinates_test  (void);
+};
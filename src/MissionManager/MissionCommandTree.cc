@@ -35,22 +35,26 @@ void MissionCommandTree::setToolbox(QGCToolbox* toolbox)
 #ifdef UNITTEST_BUILD
     if (_unitTest) {
         // Load unit testing tree
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric]      = new MissionCommandList(":/unittest/UT-MavCmdInfoCommon.json", true, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassFixedWing]    = new MissionCommandList(":/unittest/UT-MavCmdInfoFixedWing.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassMultiRotor]   = new MissionCommandList(":/unittest/UT-MavCmdInfoMultiRotor.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassVTOL]         = new MissionCommandList(":/unittest/UT-MavCmdInfoVTOL.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassSub]          = new MissionCommandList(":/unittest/UT-MavCmdInfoSub.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassRoverBoat]    = new MissionCommandList(":/unittest/UT-MavCmdInfoRover.json", false, this);
+        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric]          = new MissionCommandList(":/unittest/UT-MavCmdInfoCommon.json", true, this);
+        _overrideFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassFixedWing]            = ":/unittest/UT-MavCmdInfoFixedWing.json";
+        _overrideFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassMultiRotor]           = ":/unittest/UT-MavCmdInfoMultiRotor.json";
+        _overrideFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassVTOL]                 = ":/unittest/UT-MavCmdInfoVTOL.json";
+        _overrideFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassSub]                  = ":/unittest/UT-MavCmdInfoSub.json";
+        _overrideFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassRoverBoat]            = ":/unittest/UT-MavCmdInfoRover.json";
     } else {
 #endif
-        // Load all levels of hierarchy
+        // Only the base of the hierarchy is loaded up front, override levels are loaded the first time a vehicle needs them
         for (const QGCMAVLink::FirmwareClass_t firmwareClass: _toolbox->firmwarePluginManager()->supportedFirmwareClasses()) {
             FirmwarePlugin* plugin = _toolbox->firmwarePluginManager()->firmwarePluginForAutopilot(QGCMAVLink::firmwareClassToAutopilot(firmwareClass), MAV_TYPE_QUADROTOR);
 
             for (const QGCMAVLink::VehicleClass_t vehicleClass: QGCMAVLink::allVehicleClasses()) {
                 QString overrideFile = plugin->missionCommandOverrides(vehicleClass);
                 if (!overrideFile.isEmpty()) {
-                    _staticCommandTree[firmwareClass][vehicleClass] = new MissionCommandList(overrideFile, firmwareClass == QGCMAVLink::FirmwareClassGeneric && vehicleClass == QGCMAVLink::VehicleClassGeneric /* baseCommandList */, this);
+                    if (firmwareClass == QGCMAVLink::FirmwareClassGeneric && vehicleClass == QGCMAVLink::VehicleClassGeneric) {
+                        _staticCommandTree[firmwareClass][vehicleClass] = new MissionCommandList(overrideFile, true /* baseCommandList */, this);
+                    } else {
+                        _overrideFiles[firmwareClass][vehicleClass] = overrideFile;
+                    }
                 }
             }
         }
@@ -59,6 +63,20 @@ void MissionCommandTree::setToolbox(QGCToolbox* toolbox)
 #endif
 }
 
+/// @return Command list for the level of the hierarchy, loaded from its override file on first use. nullptr if there is no such level.
+MissionCommandList* MissionCommandTree::_commandList(QGCMAVLink::FirmwareClass_t firmwareClass, QGCMAVLink::VehicleClass_t vehicleClass)
+{
+    MissionCommandList* commandList = _staticCommandTree.value(firmwareClass).value(vehicleClass, nullptr);
+    if (!commandList) {
+        const QString overrideFile = _overrideFiles.value(firmwareClass).value(vehicleClass);
+        if (!overrideFile.isEmpty()) {
+            commandList = new MissionCommandList(overrideFile, false /* baseCommandList */, this);
+            _staticCommandTree[firmwareClass][vehicleClass] = commandList;
+        }
+    }
+    return commandList;
+}
+
 /// Add the next level of the hierarchy to a collapsed tree.
 ///     @param cmdList          List of mission commands to collapse into ui info
 ///     @param collapsedTree    Tree we are collapsing into
@@ -96,20 +114,20 @@ void MissionCommandTree::_buildAllCommands(Vehicle* vehicle, QGCMAVLink::Vehicle
     QMap<MAV_CMD, MissionCommandUIInfo*>& collapsedTree = _allCommands[firmwareClass][vehicleClass];
 
     // Base of the tree is all commands
-    _collapseHierarchy(_staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric], collapsedTree);
+    _collapseHierarchy(_commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric), collapsedTree);
 
     // Add the overrides for specific vehicle types
     if (vehicleClass != QGCMAVLink::VehicleClassGeneric) {
-        _collapseHierarchy(_staticCommandTree[QGCMAVLink::FirmwareClassGeneric][vehicleClass], collapsedTree);
+        _collapseHierarchy(_commandList(QGCMAVLink::FirmwareClassGeneric, vehicleClass), collapsedTree);
     }
 
     // Add the overrides for specific firmware class, all vehicles
     if (firmwareClass != QGCMAVLink::FirmwareClassGeneric) {
-        _collapseHierarchy(_staticCommandTree[firmwareClass][QGCMAVLink::VehicleClassGeneric], collapsedTree);
+        _collapseHierarchy(_commandList(firmwareClass, QGCMAVLink::VehicleClassGeneric), collapsedTree);
 
         // Add overrides for specific vehicle class
         if (vehicleClass != QGCMAVLink::VehicleClassGeneric) {
-            _collapseHierarchy(_staticCommandTree[firmwareClass][vehicleClass], collapsedTree);
+            _collapseHierarchy(_commandList(firmwareClass, vehicleClass), collapsedTree);
         }
     }
 
@@ -190,12 +208,7 @@ const MissionCommandUIInfo* MissionCommandTree::getUIInfo(Vehicle* vehicle, QGCM
     _firmwareAndVehicleClassInfo(vehicle, vtolMode, firmwareClass, vehicleClass);
     _buildAllCommands(vehicle, vtolMode);
 
-    const QMap<MAV_CMD, MissionCommandUIInfo*>& infoMap = _allCommands[firmwareClass][vehicleClass];
-    if (infoMap.contains(command)) {
-        return infoMap[command];
-    } else {
-        return nullptr;
-    }
+    return _allCommands[firmwareClass][vehicleClass].value(command, nullptr);
 }
 
 QVariantList MissionCommandTree::getCommandsForCategory(Vehicle* vehicle, const QString& category, bool showFlyThroughCommands)
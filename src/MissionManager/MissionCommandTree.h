@@ -37,7 +37,8 @@ class MissionCommandTreeTest;
 ///             Known Firmware, Rover
 ///         Any Firmware, Sub
 ///             Known Firmware, Sub
-/// For known firmwares, the override files are requested from the FirmwarePlugin.
+/// For known firmwares, the override files are requested from the FirmwarePlugin. Only the base level is loaded at startup, the override
+/// levels are loaded when the first vehicle which uses them needs ui info.
 ///
 /// When ui info is requested for a specific vehicle the static hierarchy in _staticCommandTree is collapsed into the set of available commands in
 /// _allCommands taking into account the appropriate set of overrides for the MAV_AUTOPILOT/MAV_TYPE combination associated with the vehicle.
@@ -71,6 +72,7 @@ public:
     virtual void setToolbox(QGCToolbox* toolbox);
 
 private:
+    MissionCommandList*         _commandList                    (QGCMAVLink::FirmwareClass_t firmwareClass, QGCMAVLink::VehicleClass_t vehicleClass);
     void                        _collapseHierarchy              (const MissionCommandList* cmdList, QMap<MAV_CMD, MissionCommandUIInfo*>& collapsedTree);
     void                        _buildAllCommands               (Vehicle* vehicle, QGCMAVLink::VehicleClass_t vtolMode);
     QStringList                 _availableCategoriesForVehicle  (Vehicle* vehicle);
@@ -82,9 +84,12 @@ private:
     SettingsManager*    _settingsManager;
     bool                _unitTest;              ///< true: running in unit test mode
 
-    /// Full hierarchy
+    /// Full hierarchy, override levels are only present once loaded
     QMap<QGCMAVLink::FirmwareClass_t, QMap<QGCMAVLink::VehicleClass_t, MissionCommandList*>>                    _staticCommandTree;
 
+    /// Override files of the levels above the base
+    QMap<QGCMAVLink::FirmwareClass_t, QMap<QGCMAVLink::VehicleClass_t, QString>>                                _overrideFiles;
+
     /// Collapsed hierarchy for specific vehicle type
     QMap<QGCMAVLink::FirmwareClass_t, QMap<QGCMAVLink::VehicleClass_t, QMap<MAV_CMD, MissionCommandUIInfo*>>>   _allCommands;
 
@@ -197,6 +197,21 @@ void MissionCommandTreeTest::testOverride(void)
     delete vehicle;
 }
 
+void MissionCommandTreeTest::testLazyOverrideLoad(void)
+{
+    // Only the base level is loaded until a vehicle needs an override level
+    QVERIFY(_commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC].value(QGCMAVLink::VehicleClassGeneric));
+    QVERIFY(!_commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC].value(QGCMAVLink::VehicleClassFixedWing));
+    QVERIFY(!_commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC].value(QGCMAVLink::VehicleClassMultiRotor));
+
+    Vehicle* vehicle = new Vehicle(MAV_AUTOPILOT_GENERIC, MAV_TYPE_FIXED_WING, qgcApp()->toolbox()->firmwarePluginManager());
+    _checkOverrideValues(_commandTree->getUIInfo(vehicle, QGCMAVLink::VehicleClassGeneric, (MAV_CMD)4), 4);
+    delete vehicle;
+
+    QVERIFY(_commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC].value(QGCMAVLink::VehicleClassFixedWing));
+    QVERIFY(!_commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC].value(QGCMAVLink::VehicleClassMultiRotor));
+}
+
 void MissionCommandTreeTest::testAllTrees(void)
 {
     QList<MAV_AUTOPILOT>    firmwareList;
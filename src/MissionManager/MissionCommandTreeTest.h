@@ -27,6 +27,7 @@ private slots:
 
     void testJsonLoad(void);
     void testOverride(void);
+    void testLazyOverrideLoad(void);
     void testAllTrees(void);
 
 private:
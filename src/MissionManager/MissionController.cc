@@ -32,6 +32,8 @@
 #include "QGCCorePlugin.h"
 #include "TakeoffMissionItem.h"
 #include "PlanViewSettings.h"
+#include "TerrainQuery.h"
+#include "QGCTrace.h"
 
 #define UPDATE_TIMEOUT 5000 ///< How often we check for bounding box changes
 
@@ -125,6 +127,8 @@ void MissionController::_resetMissionFlightStatus(void)
     emit batteryChangePointChanged(_missionFlightStatus.batteryChangePoint);
     emit batteriesRequiredChanged(_missionFlightStatus.batteriesRequired);
 
+    // Saved per item state is no longer valid
+    _flightStatusFullRecalc = true;
 }
 
 void MissionController::start(bool flyView)
@@ -287,6 +291,16 @@ void MissionController::addMissionToKML(KMLPlanDomDocument& planKML)
     deleteParent->deleteLater();
 }
 
+void MissionController::addMissionToKML(KMLPlanStreamWriter& kmlWriter)
+{
+    QObject*            deleteParent = new QObject();
+    QList<MissionItem*> rgMissionItems;
+
+    _convertToMissionItems(_visualItems, rgMissionItems, deleteParent);
+    kmlWriter.addMission(_controllerVehicle, _visualItems, rgMissionItems);
+    deleteParent->deleteLater();
+}
+
 void MissionController::sendItemsToVehicle(Vehicle* vehicle, QmlObjectListModel* visualMissionItems)
 {
     if (vehicle) {
@@ -526,10 +540,6 @@ void MissionController::_insertComplexMissionItemWorker(const QGeoCoordinate& ma
         _visualItems->insert(visualItemIndex, complexItem);
     }
 
-    //-- Keep track of bounding box changes in complex items
-    if(!complexItem->isSimpleItem()) {
-        connect(complexItem, &ComplexMissionItem::boundingCubeChanged, this, &MissionController::_complexBoundingBoxChanged);
-    }
     _recalcAllWithCoordinate(mapCenterCoordinate);
 
     if (makeCurrentItem) {
@@ -782,14 +792,18 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
 
     // Read mission items
 
-    int nextSequenceNumber = 1; // Start with 1 since home is in 0
+    // Items are collected and added to the model in one batch so the model only signals a single insert
+    int             nextSequenceNumber  = 1; // Start with 1 since home is in 0
+    bool            loadFailed          = false;
+    QList<QObject*> rgLoadedItems;
     const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
     for (int i=0; i<rgMissionItems.count(); i++) {
         // Convert to QJsonObject
         const QJsonValue& itemValue = rgMissionItems[i];
         if (!itemValue.isObject()) {
             errorString = tr("Mission item %1 is not an object").arg(i);
-            return false;
+            loadFailed = true;
+            break;
         }
         const QJsonObject itemObject = itemValue.toObject();
 
@@ -799,7 +813,8 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
             { VisualMissionItem::jsonTypeKey,  QJsonValue::String, true },
         };
         if (!JsonHelper::validateKeys(itemObject, itemKeyInfoList, errorString)) {
-            return false;
+            loadFailed = true;
+            break;
         }
         QString itemType = itemObject[VisualMissionItem::jsonTypeKey].toString();
 
@@ -815,16 +830,18 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
                 nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
-                visualItems->append(simpleItem);
+                rgLoadedItems.append(simpleItem);
             } else {
-                return false;
+                loadFailed = true;
+                break;
             }
         } else if (itemType == VisualMissionItem::jsonTypeComplexItemValue) {
             QList<JsonHelper::KeyValidateInfo> complexItemKeyInfoList = {
                 { ComplexMissionItem::jsonComplexItemTypeKey,  QJsonValue::String, true },
             };
             if (!JsonHelper::validateKeys(itemObject, complexItemKeyInfoList, errorString)) {
-                return false;
+                loadFailed = true;
+                break;
             }
             QString complexItemType = itemObject[ComplexMissionItem::jsonComplexItemTypeKey].toString();
 
@@ -832,77 +849,87 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 qCDebug(MissionControllerLog) << "Loading Survey: nextSequenceNumber" << nextSequenceNumber;
                 SurveyComplexItem* surveyItem = new SurveyComplexItem(_masterController, _flyView, QString() /* kmlFile */);
                 if (!surveyItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
+                    loadFailed = true;
+                    break;
                 }
                 nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(surveyItem);
+                rgLoadedItems.append(surveyItem);
             } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_masterController, _flyView);
                 if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
+                    loadFailed = true;
+                    break;
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                rgLoadedItems.append(landingItem);
             } else if (complexItemType == VTOLLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading VTOL Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 VTOLLandingComplexItem* landingItem = new VTOLLandingComplexItem(_masterController, _flyView);
                 if (!landingItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
+                    loadFailed = true;
+                    break;
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "VTOL Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                rgLoadedItems.append(landingItem);
             } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
                 StructureScanComplexItem* structureItem = new StructureScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
                 if (!structureItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
+                    loadFailed = true;
+                    break;
                 }
                 nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(structureItem);
+                rgLoadedItems.append(structureItem);
             } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
                 CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
                 if (!corridorItem->load(itemObject, nextSequenceNumber++, errorString)) {
-                    return false;
+                    loadFailed = true;
+                    break;
                 }
                 nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(corridorItem);
+                rgLoadedItems.append(corridorItem);
             } else {
                 errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
             }
         } else {
             errorString = tr("Unknown item type: %1").arg(itemType);
-            return false;
+            loadFailed = true;
+            break;
         }
     }
+    visualItems->append(rgLoadedItems);
+    if (loadFailed) {
+        return false;
+    }
 
-    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
+    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId. The first item
+    // with a given doJumpId is the jump target.
+    QHash<int, int> doJumpIdToSequenceNumber;
+    for (int i=0; i<visualItems->count(); i++) {
+        if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
+            SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(i);
+            if (!doJumpIdToSequenceNumber.contains(targetItem->missionItem().doJumpId())) {
+                doJumpIdToSequenceNumber[targetItem->missionItem().doJumpId()] = targetItem->sequenceNumber();
+            }
+        }
+    }
     for (int i=0; i<visualItems->count(); i++) {
         if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
             SimpleMissionItem* doJumpItem = visualItems->value<SimpleMissionItem*>(i);
             if (doJumpItem->command() == MAV_CMD_DO_JUMP) {
-                bool found = false;
                 int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
-                for (int j=0; j<visualItems->count(); j++) {
-                    if (visualItems->value<VisualMissionItem*>(j)->isSimpleItem()) {
-                        SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(j);
-                        if (targetItem->missionItem().doJumpId() == findDoJumpId) {
-                            doJumpItem->missionItem().setParam1(targetItem->sequenceNumber());
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                if (!found) {
+                if (!doJumpIdToSequenceNumber.contains(findDoJumpId)) {
                     errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
                     return false;
                 }
+                doJumpItem->missionItem().setParam1(doJumpIdToSequenceNumber[findDoJumpId]);
             }
         }
     }
@@ -1038,7 +1065,7 @@ bool MissionController::load(const QJsonObject& json, QString& errorString)
     return true;
 }
 
-bool MissionController::loadJsonFile(QFile& file, QString& errorString)
+bool MissionController::loadJsonFile(QIODevice& file, QString& errorString)
 {
     QString         errorStr;
     QString         errorMessage = tr("Mission: %1");
@@ -1062,7 +1089,7 @@ bool MissionController::loadJsonFile(QFile& file, QString& errorString)
     return true;
 }
 
-bool MissionController::loadTextFile(QFile& file, QString& errorString)
+bool MissionController::loadTextFile(QIODevice& file, QString& errorString)
 {
     QString     errorStr;
     QString     errorMessage = tr("Mission: %1");
@@ -1164,6 +1191,16 @@ double MissionController::_calcDistanceToHome(VisualMissionItem* currentItem, Vi
     return distanceOk ? homeCoord.distanceTo(currentCoord) : 0.0;
 }
 
+static FlightPathSegment::SegmentType _flightPathSegmentType(const VisualItemPair& pair, bool mavlinkTerrainFrame)
+{
+    if (pair.second->isTakeoffItem()) {
+        return FlightPathSegment::SegmentTypeTakeoff;
+    } else if (pair.second->isLandCommand()) {
+        return FlightPathSegment::SegmentTypeLand;
+    }
+    return mavlinkTerrainFrame ? FlightPathSegment::SegmentTypeTerrainFrame : FlightPathSegment::SegmentTypeGeneric;
+}
+
 FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemPair& pair, bool mavlinkTerrainFrame)
 {
     // The takeoff goes straight up from ground to alt and then over to specified position at same alt. Which means
@@ -1175,14 +1212,7 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     double              coord2AMSLAlt       = pair.second->amslEntryAlt();
     double              coord1AMSLAlt       = takeoffStraightUp ? coord2AMSLAlt : pair.first->amslExitAlt();
 
-    FlightPathSegment::SegmentType segmentType = mavlinkTerrainFrame ? FlightPathSegment::SegmentTypeTerrainFrame : FlightPathSegment::SegmentTypeGeneric;
-    if (pair.second->isTakeoffItem()) {
-        segmentType = FlightPathSegment::SegmentTypeTakeoff;
-    } else if (pair.second->isLandCommand()) {
-        segmentType = FlightPathSegment::SegmentTypeLand;
-    }
-
-    FlightPathSegment* segment = new FlightPathSegment(segmentType, coord1, coord1AMSLAlt, coord2, coord2AMSLAlt, !_flyView /* queryTerrainData */,  this);
+    FlightPathSegment* segment = new FlightPathSegment(_flightPathSegmentType(pair, mavlinkTerrainFrame), coord1, coord1AMSLAlt, coord2, coord2AMSLAlt, !_flyView /* queryTerrainData */,  this);
 
     if (takeoffStraightUp) {
         connect(pair.second, &VisualMissionItem::amslEntryAltChanged, segment, &FlightPathSegment::setCoord1AMSLAlt);
@@ -1193,11 +1223,14 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     connect(pair.second, &VisualMissionItem::coordinateChanged,     segment,    &FlightPathSegment::setCoordinate2);
     connect(pair.second, &VisualMissionItem::amslEntryAltChanged,   segment,    &FlightPathSegment::setCoord2AMSLAlt);
 
-    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_visualItemFlightStatusChanged);
 
+    // Only the items at either end of the segment are affected by a change in segment altitudes
+    VisualMissionItem* firstItem    = pair.first;
+    VisualMissionItem* secondItem   = pair.second;
     connect(segment,    &FlightPathSegment::totalDistanceChanged,       this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       [this, firstItem]  { _setFlightStatusDirty(firstItem); });
+    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       [this, secondItem] { _setFlightStatusDirty(secondItem); });
     connect(segment,    &FlightPathSegment::amslTerrainHeightsChanged,  this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::terrainCollisionChanged,    this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
 
@@ -1208,8 +1241,8 @@ FlightPathSegment* MissionController::_addFlightPathSegment(FlightPathSegmentHas
 {
     FlightPathSegment* segment = nullptr;
 
-    if (prevItemPairHashTable.contains(pair) && (prevItemPairHashTable[pair]->segmentType() == FlightPathSegment::SegmentTypeTerrainFrame) != mavlinkTerrainFrame) {
-        // Pair already exists and connected, just re-use
+    if (prevItemPairHashTable.contains(pair) && prevItemPairHashTable[pair]->segmentType() == _flightPathSegmentType(pair, mavlinkTerrainFrame)) {
+        // Pair already exists and connected, just re-use. This also keeps the terrain data already queried for it.
         _flightPathSegmentHashTable[pair] = segment = prevItemPairHashTable.take(pair);
     } else {
         segment = _createFlightPathSegmentWorker(pair, mavlinkTerrainFrame);
@@ -1446,7 +1479,7 @@ void MissionController::_recalcFlightPathSegments(void)
     // Anything left in the old table is an obsolete line object that can go
     qDeleteAll(oldSegmentTable);
 
-    emit _recalcMissionFlightStatusSignal();
+    _setFlightStatusFullRecalc();
 
     if (_waypointPath.count() == 0) {
         // MapPolyLine has a bug where if you change from a path which has elements to an empty path the line drawn
@@ -1523,18 +1556,94 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
     }
 }
 
+void MissionController::_visualItemFlightStatusChanged(void)
+{
+    _setFlightStatusDirty(qobject_cast<VisualMissionItem*>(sender()));
+}
+
+/// Marks a single item as needing recalculation of its flight status values. Items after it are only recalculated
+/// if the change carries forward to them.
+void MissionController::_setFlightStatusDirty(VisualMissionItem* visualItem)
+{
+    int index = _visualItems ? _visualItems->indexOf(visualItem) : -1;
+
+    if (index <= 0) {
+        // Mission settings item or unknown item
+        _flightStatusFullRecalc = true;
+    } else if (_flightStatusDirtyFirst == -1) {
+        _flightStatusDirtyFirst = _flightStatusDirtyLast = index;
+    } else {
+        _flightStatusDirtyFirst = qMin(_flightStatusDirtyFirst, index);
+        _flightStatusDirtyLast  = qMax(_flightStatusDirtyLast, index);
+    }
+
+    emit _recalcMissionFlightStatusSignal();
+}
+
+void MissionController::_setFlightStatusFullRecalc(void)
+{
+    _flightStatusFullRecalc = true;
+    emit _recalcMissionFlightStatusSignal();
+}
+
+/// @return true: Loop state values which are not simple running totals are the same
+bool MissionController::_flightStatusLoopStateMatches(const FlightStatusLoopState_t& state1, const FlightStatusLoopState_t& state2)
+{
+    const MissionFlightStatus_t& status1 = state1.flightStatus;
+    const MissionFlightStatus_t& status2 = state2.flightStatus;
+
+    return state1.lastFlyThroughIndex == state2.lastFlyThroughIndex &&
+            state1.firstCoordinateItem == state2.firstCoordinateItem &&
+            state1.linkStartToHome == state2.linkStartToHome &&
+            state1.foundRTL == state2.foundRTL &&
+            status1.vtolMode == status2.vtolMode &&
+            status1.batteryChangePoint == status2.batteryChangePoint &&
+            QGC::fuzzyCompare(status1.vehicleYaw, status2.vehicleYaw) &&
+            QGC::fuzzyCompare(status1.gimbalYaw, status2.gimbalYaw) &&
+            QGC::fuzzyCompare(status1.gimbalPitch, status2.gimbalPitch) &&
+            QGC::fuzzyCompare(status1.cruiseSpeed, status2.cruiseSpeed) &&
+            QGC::fuzzyCompare(status1.hoverSpeed, status2.hoverSpeed) &&
+            QGC::fuzzyCompare(status1.vehicleSpeed, status2.vehicleSpeed);
+}
+
+/// Adjusts the running totals in state by the difference between the from and to states
+void MissionController::_shiftFlightStatusTotals(FlightStatusLoopState_t& state, const FlightStatusLoopState_t& from, const FlightStatusLoopState_t& to)
+{
+    state.totalHorizontalDistance           += to.totalHorizontalDistance - from.totalHorizontalDistance;
+    state.flightStatus.totalDistance        += to.flightStatus.totalDistance - from.flightStatus.totalDistance;
+    state.flightStatus.totalTime            += to.flightStatus.totalTime - from.flightStatus.totalTime;
+    state.flightStatus.hoverDistance        += to.flightStatus.hoverDistance - from.flightStatus.hoverDistance;
+    state.flightStatus.hoverTime            += to.flightStatus.hoverTime - from.flightStatus.hoverTime;
+    state.flightStatus.cruiseDistance       += to.flightStatus.cruiseDistance - from.flightStatus.cruiseDistance;
+    state.flightStatus.cruiseTime           += to.flightStatus.cruiseTime - from.flightStatus.cruiseTime;
+}
+
+/// Walks the visual items calculating distances, times and altitude ranges for the mission.
+///
+/// The loop state prior to each item is saved. When only some items have changed the walk restarts from the saved
+/// state of the first changed item and stops once it is past the changed items and the state matches what was saved
+/// from the previous walk. The remaining items are unaffected other than their running totals being offset.
 void MissionController::_recalcMissionFlightStatus()
 {
     if (!_visualItems->count()) {
         return;
     }
 
+    int itemCount = _visualItems->count();
+
+    bool partialRecalc = !_flightStatusFullRecalc && _flightStatusRecords.count() == itemCount;
+    if (partialRecalc && _flightStatusDirtyFirst == -1) {
+        // Nothing changed since the last recalc
+        return;
+    }
+
     bool                firstCoordinateItem =           true;
+    int                 lastFlyThroughIndex =           0;
     VisualMissionItem*  lastFlyThroughVI =   qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
     bool homePositionValid = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus partial" << partialRecalc << _flightStatusDirtyFirst << _flightStatusDirtyLast;
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
@@ -1546,19 +1655,54 @@ void MissionController::_recalcMissionFlightStatus()
     lastFlyThroughVI->setDistance(0);
     lastFlyThroughVI->setDistanceFromStart(0);
 
+    double previousMinAMSLAltitude = _minAMSLAltitude;
+    double previousMaxAMSLAltitude = _maxAMSLAltitude;
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
-    _resetMissionFlightStatus();
-
     bool   linkStartToHome =            false;
     bool   foundRTL =                   false;
     double totalHorizontalDistance =    0;
+    int    startIndex =                 0;
+    int    convergedIndex =             -1;
+
+    if (partialRecalc) {
+        const FlightStatusLoopState_t& state = _flightStatusRecords[_flightStatusDirtyFirst].stateBefore;
+
+        startIndex =                _flightStatusDirtyFirst;
+        _missionFlightStatus =      state.flightStatus;
+        totalHorizontalDistance =   state.totalHorizontalDistance;
+        lastFlyThroughIndex =       state.lastFlyThroughIndex;
+        lastFlyThroughVI =          qobject_cast<VisualMissionItem*>(_visualItems->get(lastFlyThroughIndex));
+        firstCoordinateItem =       state.firstCoordinateItem;
+        linkStartToHome =           state.linkStartToHome;
+        foundRTL =                  state.foundRTL;
+    } else {
+        _resetMissionFlightStatus();
+        _flightStatusRecords.resize(itemCount);
+    }
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem*  item =          qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem*  simpleItem =    qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem =   qobject_cast<ComplexMissionItem*>(item);
 
+        FlightStatusItemRecord_t&   record = _flightStatusRecords[i];
+        FlightStatusLoopState_t     stateBefore = { _missionFlightStatus, totalHorizontalDistance, lastFlyThroughIndex, firstCoordinateItem, linkStartToHome, foundRTL };
+
+        // Battery change point is determined from running totals, so it can't be carried forward from a previous walk
+        if (partialRecalc && i > _flightStatusDirtyLast && _missionFlightStatus.mAhBattery == 0 &&
+                (lastFlyThroughIndex < _flightStatusDirtyFirst || lastFlyThroughIndex > _flightStatusDirtyLast) &&
+                _flightStatusLoopStateMatches(stateBefore, record.stateBefore)) {
+            convergedIndex = i;
+            break;
+        }
+
+        record.stateBefore          = stateBefore;
+        record.maxTelemetryDistance = 0;
+        record.minAMSLAltitude      = qQNaN();
+        record.maxAMSLAltitude      = qQNaN();
+        record.distanceFromStart    = qQNaN();
+
         if (simpleItem && simpleItem->mavCommand() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
             foundRTL = true;
         }
@@ -1622,15 +1766,11 @@ void MissionController::_recalcMissionFlightStatus()
 
                 // Keep track of the min/max AMSL altitude for entire mission so we can calculate altitude percentages in terrain status display
                 if (simpleItem) {
-                    double amslAltitude = item->amslEntryAlt();
-                    _minAMSLAltitude = std::fmin(_minAMSLAltitude, amslAltitude);
-                    _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, amslAltitude);
+                    record.minAMSLAltitude = record.maxAMSLAltitude = item->amslEntryAlt();
                 } else {
                     // Complex item
-                    double complexMinAMSLAltitude = complexItem->minAMSLAltitude();
-                    double complexMaxAMSLAltitude = complexItem->maxAMSLAltitude();
-                    _minAMSLAltitude = std::fmin(_minAMSLAltitude, complexMinAMSLAltitude);
-                    _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, complexMaxAMSLAltitude);
+                    record.minAMSLAltitude = complexItem->minAMSLAltitude();
+                    record.maxAMSLAltitude = complexItem->maxAMSLAltitude();
                 }
 
                 if (!item->isStandaloneCoordinate()) {
@@ -1660,8 +1800,9 @@ void MissionController::_recalcMissionFlightStatus()
                         item->setAzimuth(azimuth);
                         item->setDistance(distance);
                         item->setDistanceFromStart(totalHorizontalDistance);
+                        record.distanceFromStart = totalHorizontalDistance;
 
-                        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
+                        record.maxTelemetryDistance = qMax(record.maxTelemetryDistance, _calcDistanceToHome(item, _settingsItem));
 
                         // Calculate time/distance
                         double hoverTime = distance / _missionFlightStatus.hoverSpeed;
@@ -1672,7 +1813,7 @@ void MissionController::_recalcMissionFlightStatus()
                     if (complexItem) {
                         // Add in distance/time inside complex items as well
                         double distance = complexItem->complexDistance();
-                        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
+                        record.maxTelemetryDistance = qMax(record.maxTelemetryDistance, complexItem->greatestDistanceTo(complexItem->exitCoordinate()));
 
                         double hoverTime = distance / _missionFlightStatus.hoverSpeed;
                         double cruiseTime = distance / _missionFlightStatus.cruiseSpeed;
@@ -1683,6 +1824,7 @@ void MissionController::_recalcMissionFlightStatus()
 
 
                     lastFlyThroughVI = item;
+                    lastFlyThroughIndex = i;
                 }
             }
         }
@@ -1731,6 +1873,34 @@ void MissionController::_recalcMissionFlightStatus()
             }
         }
     }
+
+    if (convergedIndex != -1) {
+        // The remaining items are unchanged other than being offset by the change in the running totals
+        const FlightStatusLoopState_t   previousState = _flightStatusRecords[convergedIndex].stateBefore;
+        FlightStatusLoopState_t         currentState = { _missionFlightStatus, totalHorizontalDistance, lastFlyThroughIndex, firstCoordinateItem, linkStartToHome, foundRTL };
+
+        for (int i=convergedIndex; i<itemCount; i++) {
+            FlightStatusItemRecord_t& record = _flightStatusRecords[i];
+
+            _shiftFlightStatusTotals(record.stateBefore, previousState, currentState);
+            if (!qIsNaN(record.distanceFromStart)) {
+                record.distanceFromStart += currentState.totalHorizontalDistance - previousState.totalHorizontalDistance;
+                qobject_cast<VisualMissionItem*>(_visualItems->get(i))->setDistanceFromStart(record.distanceFromStart);
+            }
+        }
+        _shiftFlightStatusTotals(_flightStatusEndState, previousState, currentState);
+
+        _missionFlightStatus =      _flightStatusEndState.flightStatus;
+        totalHorizontalDistance =   _flightStatusEndState.totalHorizontalDistance;
+        lastFlyThroughIndex =       _flightStatusEndState.lastFlyThroughIndex;
+        lastFlyThroughVI =          qobject_cast<VisualMissionItem*>(_visualItems->get(lastFlyThroughIndex));
+        firstCoordinateItem =       _flightStatusEndState.firstCoordinateItem;
+        linkStartToHome =           _flightStatusEndState.linkStartToHome;
+        foundRTL =                  _flightStatusEndState.foundRTL;
+    } else {
+        _flightStatusEndState = { _missionFlightStatus, totalHorizontalDistance, lastFlyThroughIndex, firstCoordinateItem, linkStartToHome, foundRTL };
+    }
+
     lastFlyThroughVI->setMissionVehicleYaw(_missionFlightStatus.vehicleYaw);
 
     // Add the information for the final segment back to home
@@ -1749,6 +1919,13 @@ void MissionController::_recalcMissionFlightStatus()
         _missionFlightStatus.batteryChangePoint = 0;
     }
 
+    _missionFlightStatus.maxTelemetryDistance = 0;
+    for (const FlightStatusItemRecord_t& record: _flightStatusRecords) {
+        _missionFlightStatus.maxTelemetryDistance = qMax(_missionFlightStatus.maxTelemetryDistance, record.maxTelemetryDistance);
+        _minAMSLAltitude = std::fmin(_minAMSLAltitude, record.minAMSLAltitude);
+        _maxAMSLAltitude = std::fmax(_maxAMSLAltitude, record.maxAMSLAltitude);
+    }
+
     if (linkStartToHome) {
         // Home position is taken into account for min/max values
         _minAMSLAltitude = std::fmin(_minAMSLAltitude, _settingsItem->plannedHomePositionAltitude()->rawValue().toDouble());
@@ -1767,9 +1944,17 @@ void MissionController::_recalcMissionFlightStatus()
     emit minAMSLAltitudeChanged         (_minAMSLAltitude);
     emit maxAMSLAltitudeChanged         (_maxAMSLAltitude);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. If the altitude range is the same only the recalculated items can change.
+    int percentStartIndex   = 0;
+    int percentEndIndex     = itemCount;
+    if (partialRecalc && QGC::fuzzyCompare(previousMinAMSLAltitude, _minAMSLAltitude) && QGC::fuzzyCompare(previousMaxAMSLAltitude, _maxAMSLAltitude)) {
+        percentStartIndex = startIndex;
+        if (convergedIndex != -1) {
+            percentEndIndex = convergedIndex;
+        }
+    }
     double altRange = _maxAMSLAltitude - _minAMSLAltitude;
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=percentStartIndex; i<percentEndIndex; i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1792,6 +1977,9 @@ void MissionController::_recalcMissionFlightStatus()
         }
     }
 
+    _flightStatusFullRecalc = false;
+    _flightStatusDirtyFirst = _flightStatusDirtyLast = -1;
+
     _updateTimer.start(UPDATE_TIMEOUT);
 
     emit recalcTerrainProfile();
@@ -1878,6 +2066,8 @@ void MissionController::_setPlannedHomePositionFromFirstCoordinate(const QGeoCoo
 
 void MissionController::_recalcAllWithCoordinate(const QGeoCoordinate& coordinate)
 {
+    QGC_TRACE_SCOPE("MissionController::_recalcAll");
+
     if (!_flyView) {
         _setPlannedHomePositionFromFirstCoordinate(coordinate);
     }
@@ -1919,10 +2109,15 @@ void MissionController::_initAllVisualItems(void)
         }
     }
 
+    _boundsTreeDirty = true;
     _recalcAll();
 
     connect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::_visualItemsDirtyChanged);
     connect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
+    connect(_visualItems, &QmlObjectListModel::rowsInserted, this, &MissionController::_visualItemsStructureChanged);
+    connect(_visualItems, &QmlObjectListModel::rowsRemoved,  this, &MissionController::_visualItemsStructureChanged);
+    connect(_visualItems, &QmlObjectListModel::rowsMoved,    this, &MissionController::_visualItemsStructureChanged);
+    connect(_visualItems, &QmlObjectListModel::modelReset,   this, &MissionController::_visualItemsStructureChanged);
 
     emit visualItemsChanged();
     emit containsItemsChanged(containsItems());
@@ -1946,6 +2141,10 @@ void MissionController::_deinitAllVisualItems(void)
 
     disconnect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::dirtyChanged);
     disconnect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
+    disconnect(_visualItems, &QmlObjectListModel::rowsInserted, this, &MissionController::_visualItemsStructureChanged);
+    disconnect(_visualItems, &QmlObjectListModel::rowsRemoved,  this, &MissionController::_visualItemsStructureChanged);
+    disconnect(_visualItems, &QmlObjectListModel::rowsMoved,    this, &MissionController::_visualItemsStructureChanged);
+    disconnect(_visualItems, &QmlObjectListModel::modelReset,   this, &MissionController::_visualItemsStructureChanged);
 }
 
 void MissionController::_initVisualItem(VisualMissionItem* visualItem)
@@ -1953,30 +2152,33 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     setDirty(false);
 
     connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_visualItemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_visualItemFlightStatusChanged);
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
+    connect(visualItem, &VisualMissionItem::boundingCubeChanged,                        this, &MissionController::_visualItemBoundingCubeChanged);
 
     if (visualItem->isSimpleItem()) {
         // We need to track commandChanged on simple item since recalc has special handling for takeoff command
         SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(visualItem);
         if (simpleItem) {
             connect(&simpleItem->missionItem()._commandFact, &Fact::valueChanged, this, &MissionController::_itemCommandChanged);
+            // Takeoff items are used for the takeoff coordinate, which can change without the bounding cube changing
+            connect(simpleItem, &SimpleMissionItem::commandChanged, this, [this, visualItem]() { _updateItemBounds(visualItem); });
         } else {
             qWarning() << "isSimpleItem == true, yet not SimpleMissionItem";
         }
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_visualItemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_visualItemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_visualItemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_visualItemFlightStatusChanged);
             connect(complexItem, &ComplexMissionItem::isIncompleteChanged,          this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
         } else {
             qWarning() << "ComplexMissionItem not found";
@@ -2021,8 +2223,8 @@ void MissionController::_managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::lastCurrentIndexChanged,  this, &MissionController::resumeMissionIndexChanged);
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_setFlightStatusFullRecalc);
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_setFlightStatusFullRecalc);
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     emit complexMissionItemNamesChanged();
@@ -2537,90 +2739,101 @@ void MissionController::setCurrentPlanViewSeqNum(int sequenceNumber, bool force)
 
 void MissionController::_updateTimeout()
 {
-    QGeoCoordinate firstCoordinate;
-    QGeoCoordinate takeoffCoordinate;
-    QGCGeoBoundingCube boundingCube;
-    double north = 0.0;
-    double south = 180.0;
-    double east  = 0.0;
-    double west  = 360.0;
-    double minAlt = QGCGeoBoundingCube::MaxAlt;
-    double maxAlt = QGCGeoBoundingCube::MinAlt;
-    for (int i = 1; i < _visualItems->count(); i++) {
-        VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
-        if(item->isSimpleItem()) {
-            SimpleMissionItem* pSimpleItem = qobject_cast<SimpleMissionItem*>(item);
-            if(pSimpleItem) {
-                switch(pSimpleItem->command()) {
-                case MAV_CMD_NAV_TAKEOFF:
-                case MAV_CMD_NAV_WAYPOINT:
-                case MAV_CMD_NAV_LAND:
-                    if(pSimpleItem->coordinate().isValid()) {
-                        double alt = 0.0;
-                        if (!pSimpleItem->altitude()->rawValue().isNull() && !qIsNaN(pSimpleItem->altitude()->rawValue().toDouble())) {
-                            alt = pSimpleItem->altitude()->rawValue().toDouble();
-                        }
-                        if((MAV_CMD)pSimpleItem->command() == MAV_CMD_NAV_TAKEOFF) {
-                            takeoffCoordinate = pSimpleItem->coordinate();
-                            takeoffCoordinate.setAltitude(alt);
-                            minAlt = maxAlt = alt;
-                        } else if(!firstCoordinate.isValid()) {
-                            firstCoordinate = pSimpleItem->coordinate();
-                        }
-                        double lat = pSimpleItem->coordinate().latitude()  + 90.0;
-                        double lon = pSimpleItem->coordinate().longitude() + 180.0;
-                        north  = fmax(north, lat);
-                        south  = fmin(south, lat);
-                        east   = fmax(east,  lon);
-                        west   = fmin(west,  lon);
-                        minAlt = fmin(minAlt, alt);
-                        maxAlt = fmax(maxAlt, alt);
-                    }
-                    break;
-                default:
-                    break;
-                }
-            }
-        } else {
-            ComplexMissionItem* pComplexItem = qobject_cast<ComplexMissionItem*>(item);
-            if(pComplexItem) {
-                QGCGeoBoundingCube bc = pComplexItem->boundingCube();
-                if(bc.isValid()) {
-                    if(!firstCoordinate.isValid() && pComplexItem->coordinate().isValid()) {
-                        firstCoordinate = pComplexItem->coordinate();
-                    }
-                    north  = fmax(north, bc.pointNW.latitude()  + 90.0);
-                    south  = fmin(south, bc.pointSE.latitude()  + 90.0);
-                    east   = fmax(east,  bc.pointNW.longitude() + 180.0);
-                    west   = fmin(west,  bc.pointSE.longitude() + 180.0);
-                    minAlt = fmin(minAlt, bc.pointNW.altitude());
-                    maxAlt = fmax(maxAlt, bc.pointSE.altitude());
-                }
-            }
-        }
+    if (_boundsTreeDirty) {
+        _rebuildBoundsTree();
     }
+    const MissionBoundsTree::Bounds_t& bounds = _boundsTree.root();
+
     //-- Figure out where this thing is taking off from
+    QGeoCoordinate takeoffCoordinate = bounds.takeoffCoordinate;
     if(!takeoffCoordinate.isValid()) {
-        if(firstCoordinate.isValid()) {
-            takeoffCoordinate = firstCoordinate;
+        if(bounds.firstCoordinate.isValid()) {
+            takeoffCoordinate = bounds.firstCoordinate;
         } else {
             takeoffCoordinate = plannedHomePosition();
         }
     }
     //-- Build bounding "cube"
-    boundingCube = QGCGeoBoundingCube(
-                QGeoCoordinate(north - 90.0, west - 180.0, minAlt),
-                QGeoCoordinate(south - 90.0, east - 180.0, maxAlt));
+    QGCGeoBoundingCube boundingCube(
+                QGeoCoordinate(bounds.north, bounds.west, bounds.bottom),
+                QGeoCoordinate(bounds.south, bounds.east, bounds.top));
     if(_travelBoundingCube != boundingCube || _takeoffCoordinate != takeoffCoordinate) {
         _takeoffCoordinate  = takeoffCoordinate;
         _travelBoundingCube = boundingCube;
         emit missionBoundingCubeChanged();
         qCDebug(MissionControllerLog) << "Bounding cube:" << _travelBoundingCube.pointNW << _travelBoundingCube.pointSE;
+        if (!_flyView && bounds.north >= bounds.south && bounds.east >= bounds.west) {
+            // Get terrain data for the mission area loaded ahead of the terrain queries which will need it
+            TerrainAtCoordinateQuery::prefetchArea(QGeoRectangle(_travelBoundingCube.pointNW, _travelBoundingCube.pointSE));
+        }
+    }
+}
+
+MissionBoundsTree::Bounds_t MissionController::_visualItemBounds(VisualMissionItem* visualItem)
+{
+    MissionBoundsTree::Bounds_t bounds = MissionBoundsTree::emptyBounds();
+
+    const QGCGeoBoundingCube& bc = *visualItem->boundingCube();
+    if (bc.isValid()) {
+        bounds.north    = bc.pointNW.latitude();
+        bounds.south    = bc.pointSE.latitude();
+        bounds.west     = bc.pointNW.longitude();
+        bounds.east     = bc.pointSE.longitude();
+        bounds.bottom   = bc.pointNW.altitude();
+        bounds.top      = bc.pointSE.altitude();
+
+        SimpleMissionItem* simpleItem = qobject_cast<SimpleMissionItem*>(visualItem);
+        if (simpleItem && (MAV_CMD)simpleItem->command() == MAV_CMD_NAV_TAKEOFF) {
+            // Point cube of the takeoff position, with the takeoff altitude
+            bounds.takeoffCoordinate = bc.pointNW;
+        } else if (visualItem->coordinate().isValid()) {
+            bounds.firstCoordinate = visualItem->coordinate();
+        }
+    }
+
+    return bounds;
+}
+
+void MissionController::_rebuildBoundsTree(void)
+{
+    QVector<MissionBoundsTree::Bounds_t> leaves;
+    leaves.reserve(_visualItems->count());
+    _boundsTreeIndices.clear();
+
+    // Skip the settings item at index 0
+    for (int i = 1; i < _visualItems->count(); i++) {
+        VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
+        _boundsTreeIndices[item] = leaves.count();
+        leaves.append(_visualItemBounds(item));
+    }
+
+    _boundsTree.build(leaves);
+    _boundsTreeDirty = false;
+}
+
+void MissionController::_updateItemBounds(VisualMissionItem* visualItem)
+{
+    if (!_boundsTreeDirty) {
+        auto it = _boundsTreeIndices.constFind(visualItem);
+        if (it != _boundsTreeIndices.constEnd()) {
+            _boundsTree.set(it.value(), _visualItemBounds(visualItem));
+        }
+    }
+    _updateTimer.start(UPDATE_TIMEOUT);
+}
+
+void MissionController::_visualItemBoundingCubeChanged(void)
+{
+    VisualMissionItem* visualItem = qobject_cast<VisualMissionItem*>(sender());
+    if (visualItem) {
+        _updateItemBounds(visualItem);
     }
 }
 
-void MissionController::_complexBoundingBoxChanged()
+void MissionController::_visualItemsStructureChanged(void)
 {
+    // Indices of the items after the change are off, the tree is rebuilt once on the next update
+    _boundsTreeDirty = true;
     _updateTimer.start(UPDATE_TIMEOUT);
 }
 
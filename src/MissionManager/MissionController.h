@@ -14,8 +14,10 @@
 #include "Vehicle.h"
 #include "QGCLoggingCategory.h"
 #include "KMLPlanDomDocument.h"
+#include "KMLPlanStreamWriter.h"
 #include "QGCGeoBoundingCube.h"
 #include "QGroundControlQmlGlobal.h"
+#include "MissionBoundsTree.h"
 
 #include <QHash>
 
@@ -192,8 +194,11 @@ public:
     /// Sends the mission items to the specified vehicle
     static void sendItemsToVehicle(Vehicle* vehicle, QmlObjectListModel* visualMissionItems);
 
-    bool loadJsonFile(QFile& file, QString& errorString);
-    bool loadTextFile(QFile& file, QString& errorString);
+    /// Converts the current visual items to the mission items which are sent to a vehicle
+    void convertToMissionItems(QList<MissionItem*>& rgMissionItems, QObject* missionItemParent) { _convertToMissionItems(_visualItems, rgMissionItems, missionItemParent); }
+
+    bool loadJsonFile(QIODevice& file, QString& errorString);
+    bool loadTextFile(QIODevice& file, QString& errorString);
 
     QGCGeoBoundingCube* travelBoundingCube  () { return &_travelBoundingCube; }
     QGeoCoordinate      takeoffCoordinate   () { return _takeoffCoordinate; }
@@ -215,6 +220,7 @@ public:
 
     // Create KML file
     void addMissionToKML(KMLPlanDomDocument& planKML);
+    void addMissionToKML(KMLPlanStreamWriter& kmlWriter);
 
     // Property accessors
 
@@ -306,13 +312,16 @@ private slots:
     void _currentMissionIndexChanged            (int sequenceNumber);
     void _recalcFlightPathSegments              (void);
     void _recalcMissionFlightStatus             (void);
+    void _visualItemFlightStatusChanged         (void);
+    void _setFlightStatusFullRecalc             (void);
     void _updateContainsItems                   (void);
     void _progressPctChanged                    (double progressPct);
     void _visualItemsDirtyChanged               (bool dirty);
     void _managerSendComplete                   (bool error);
     void _managerRemoveAllComplete              (bool error);
     void _updateTimeout                         (void);
-    void _complexBoundingBoxChanged             (void);
+    void _visualItemBoundingCubeChanged         (void);
+    void _visualItemsStructureChanged           (void);
     void _recalcAll                             (void);
     void _managerVehicleChanged                 (Vehicle* managerVehicle);
     void _takeoffItemNotRequiredChanged         (void);
@@ -354,6 +363,11 @@ private:
     FlightPathSegment*      _createFlightPathSegmentWorker      (VisualItemPair& pair, bool mavlinkTerrainFrame);
     void                    _allItemsRemoved                    (void);
     void                    _firstItemAdded                     (void);
+    void                    _setFlightStatusDirty               (VisualMissionItem* visualItem);
+    void                    _rebuildBoundsTree                  (void);
+    void                    _updateItemBounds                   (VisualMissionItem* visualItem);
+
+    static MissionBoundsTree::Bounds_t _visualItemBounds        (VisualMissionItem* visualItem);
 
     static double           _calcDistanceToHome                 (VisualMissionItem* currentItem, VisualMissionItem* homeItem);
     static double           _normalizeLat                       (double lat);
@@ -361,6 +375,27 @@ private:
     static bool             _convertToMissionItems              (QmlObjectListModel* visualMissionItems, QList<MissionItem*>& rgMissionItems, QObject* missionItemParent);
 
 private:
+    /// State of the _recalcMissionFlightStatus loop between items
+    typedef struct {
+        MissionFlightStatus_t   flightStatus;
+        double                  totalHorizontalDistance;
+        int                     lastFlyThroughIndex;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    foundRTL;
+    } FlightStatusLoopState_t;
+
+    typedef struct {
+        FlightStatusLoopState_t stateBefore;            ///< Loop state prior to processing the item
+        double                  maxTelemetryDistance;   ///< Values contributed by the item itself
+        double                  minAMSLAltitude;
+        double                  maxAMSLAltitude;
+        double                  distanceFromStart;      ///< NaN if the item has no distance from start
+    } FlightStatusItemRecord_t;
+
+    static bool             _flightStatusLoopStateMatches       (const FlightStatusLoopState_t& state1, const FlightStatusLoopState_t& state2);
+    static void             _shiftFlightStatusTotals            (FlightStatusLoopState_t& state, const FlightStatusLoopState_t& from, const FlightStatusLoopState_t& to);
+
     Vehicle*                    _controllerVehicle =            nullptr;
     Vehicle*                    _managerVehicle =               nullptr;
     MissionManager*             _missionManager =               nullptr;
@@ -385,6 +420,9 @@ private:
     TakeoffMissionItem*         _takeoffMissionItem =           nullptr;
     QTimer                      _updateTimer;
     QGCGeoBoundingCube          _travelBoundingCube;
+    MissionBoundsTree           _boundsTree;                                    ///< Leaf i - 1 is visual item i, the settings item has no leaf
+    QHash<VisualMissionItem*, int> _boundsTreeIndices;
+    bool                        _boundsTreeDirty =              true;           ///< Visual items were added, removed or moved since the tree was built
     QGeoCoordinate              _takeoffCoordinate;
     QGeoCoordinate              _previousCoordinate;
     FlightPathSegment*          _splitSegment =                 nullptr;
@@ -399,6 +437,13 @@ private:
     double                      _maxAMSLAltitude =              0;
     bool                        _missionContainsVTOLTakeoff =   false;
 
+    // Incremental flight status recalc. Changed items are tracked as a range of visual item indices.
+    QVector<FlightStatusItemRecord_t>   _flightStatusRecords;                   ///< Indexed by visual item index
+    FlightStatusLoopState_t             _flightStatusEndState;                  ///< Loop state after the last item
+    bool                                _flightStatusFullRecalc =   true;
+    int                                 _flightStatusDirtyFirst =   -1;
+    int                                 _flightStatusDirtyLast =    -1;
+
     QGroundControlQmlGlobal::AltMode _globalAltMode = QGroundControlQmlGlobal::AltitudeModeRelative;
 
     static const char*  _settingsGroup;
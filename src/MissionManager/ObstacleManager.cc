@@ -14,6 +14,9 @@
 #include "QGCApplication.h"
 #include "QGCMapPolygon.h"
 #include "QGCMapCircle.h"
+#include "SettingsManager.h"
+#include "PlanViewSettings.h"
+#include "ShapeFileHelper.h"
 
 QGC_LOGGING_CATEGORY(ObstacleManagerLog, "ObstacleManagerLog")
 
@@ -39,73 +42,78 @@ void ObstacleManager::sendToVehicle(const QGeoCoordinate&   breachReturn,
                                     QmlObjectListModel&     polygons,
                                     QmlObjectListModel&     circles)
 {
-    QList<MissionItem*> fenceItems;
-
     _sendPolygons.clear();
     _sendCircles.clear();
 
+    double simplifyTolerance = qgcApp()->toolbox()->settingsManager()->planViewSettings()->fenceUploadSimplification()->rawValue().toDouble();
+    int    vertexCount = 0;
     for (int i=0; i<polygons.count(); i++) {
         _sendPolygons.append(*polygons.value<QGCFencePolygon*>(i));
+        vertexCount += _sendPolygons.last().count();
+        _simplifyPolygon(_sendPolygons.last(), simplifyTolerance);
     }
     for (int i=0; i<circles.count(); i++) {
         _sendCircles.append(*circles.value<QGCFenceCircle*>(i));
     }
     _breachReturnPoint = breachReturn;
 
+    QVector<StreamItem_t> fenceItems;
+    fenceItems.reserve(vertexCount + _sendCircles.count() + 1);
+
     for (int i=0; i<_sendPolygons.count(); i++) {
         const QGCFencePolygon& polygon = _sendPolygons[i];
+        const QVariantList     path    = polygon.path();
+
+        for (int j=0; j<path.count(); j++) {
+            const QGeoCoordinate vertex = path[j].value<QGeoCoordinate>();
 
-        for (int j=0; j<polygon.count(); j++) {
-            const QGeoCoordinate& vertex = polygon.path()[j].value<QGeoCoordinate>();
-
-            MissionItem* item = new MissionItem(0,
-                                                polygon.inclusion() ? MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION : MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION,
-                                                MAV_FRAME_GLOBAL,
-                                                polygon.count(),    // vertex count
-                                                0, 0, 0,            // param 2-4 unused
-                                                vertex.latitude(),
-                                                vertex.longitude(),
-                                                0,                  // param 7 unused
-                                                false,              // autocontinue
-                                                false,              // isCurrentItem
-                                                this);              // parent
-            fenceItems.append(item);
+            fenceItems.append(streamItem(polygon.inclusion() ? MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION : MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION,
+                                         MAV_FRAME_GLOBAL,
+                                         path.count(),      // vertex count
+                                         vertex.latitude(),
+                                         vertex.longitude(),
+                                         0));               // param 7 unused
         }
     }
 
     for (int i=0; i<_sendCircles.count(); i++) {
         QGCFenceCircle& circle = _sendCircles[i];
 
-        MissionItem* item = new MissionItem(0,
-                                            circle.inclusion() ? MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION : MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION,
-                                            MAV_FRAME_GLOBAL,
-                                            circle.radius()->rawValue().toDouble(),
-                                            0, 0, 0,                    // param 2-4 unused
-                                            circle.center().latitude(),
-                                            circle.center().longitude(),
-                                            0,                          // param 7 unused
-                                            false,                      // autocontinue
-                                            false,                      // isCurrentItem
-                                            this);                      // parent
-        fenceItems.append(item);
+        fenceItems.append(streamItem(circle.inclusion() ? MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION : MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION,
+                                     MAV_FRAME_GLOBAL,
+                                     circle.radius()->rawValue().toDouble(),
+                                     circle.center().latitude(),
+                                     circle.center().longitude(),
+                                     0));                   // param 7 unused
     }
 
     if (_breachReturnPoint.isValid()) {
-        MissionItem* item = new MissionItem(0,
-                                            MAV_CMD_NAV_FENCE_RETURN_POINT,
-                                            MAV_FRAME_GLOBAL_RELATIVE_ALT,
-                                            0, 0, 0, 0,                    // param 1-4 unused
-                                            breachReturn.latitude(),
-                                            breachReturn.longitude(),
-                                            breachReturn.altitude(),
-                                            false,                      // autocontinue
-                                            false,                      // isCurrentItem
-                                            this);                      // parent
-        fenceItems.append(item);
+        fenceItems.append(streamItem(MAV_CMD_NAV_FENCE_RETURN_POINT,
+                                     MAV_FRAME_GLOBAL_RELATIVE_ALT,
+                                     0,                     // param 1 unused
+                                     breachReturn.latitude(),
+                                     breachReturn.longitude(),
+                                     breachReturn.altitude()));
+    }
+
+    qCDebug(ObstacleManagerLog) << "sendToVehicle vertices:simplified" << vertexCount << fenceItems.count() - _sendCircles.count() - (_breachReturnPoint.isValid() ? 1 : 0);
+
+    writeStreamItems(fenceItems);
+}
+
+/// Removes vertices which are closer than toleranceMeters to the simplified polygon. Polygons which would end up
+/// with fewer than three vertices are left alone.
+void ObstacleManager::_simplifyPolygon(QGCFencePolygon& polygon, double toleranceMeters)
+{
+    if (toleranceMeters <= 0 || polygon.count() <= 3) {
+        return;
     }
 
-    // Plan manager takes control of MissionItems, so no need to delete
-    writeMissionItems(fenceItems);
+    QList<QGeoCoordinate> vertices = polygon.coordinateList();
+    ShapeFileHelper::simplify(vertices, toleranceMeters);
+    if (vertices.count() >= 3 && vertices.count() < polygon.count()) {
+        polygon.setPath(vertices);
+    }
 }
 
 void ObstacleManager::removeAll(void)
@@ -0,0 +1,337 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PlanFleetUploader.h"
+#include "PlanMasterController.h"
+#include "MissionManager.h"
+#include "GeoFenceManager.h"
+#include "RallyPointManager.h"
+#include "RallyPoint.h"
+#include "MissionItem.h"
+#include "Vehicle.h"
+#include "LinkInterface.h"
+
+QGC_LOGGING_CATEGORY(PlanFleetUploaderLog, "PlanFleetUploaderLog")
+
+PlanFleetUploader::PlanFleetUploader(PlanMasterController* masterController, QObject* parent)
+    : QObject           (parent)
+    , _masterController (masterController)
+{
+
+}
+
+PlanFleetUploader::~PlanFleetUploader()
+{
+    _clear();
+}
+
+void PlanFleetUploader::sendToVehicles(const QVariantList& vehicles)
+{
+    QList<Vehicle*> rgVehicles;
+    for (const QVariant& vehicle: vehicles) {
+        Vehicle* pVehicle = qobject_cast<Vehicle*>(vehicle.value<QObject*>());
+        if (pVehicle) {
+            rgVehicles.append(pVehicle);
+        }
+    }
+    sendToVehicles(rgVehicles);
+}
+
+void PlanFleetUploader::sendToVehicles(const QList<Vehicle*>& vehicles)
+{
+    if (_inProgress) {
+        qCWarning(PlanFleetUploaderLog) << "sendToVehicles called while in progress";
+        return;
+    }
+
+    _clear();
+
+    // The conversion walks all visual items, complex ones generate their items from scratch, so it is only done once
+    _missionItemParent = new QObject(this);
+    _masterController->missionController()->convertToMissionItems(_missionItems, _missionItemParent);
+
+    QmlObjectListModel* points = _masterController->rallyPointController()->points();
+    for (int i=0; i<points->count(); i++) {
+        _rallyPoints.append(points->value<RallyPoint*>(i)->coordinate());
+    }
+
+    for (Vehicle* vehicle: vehicles) {
+        if (vehicle->isOfflineEditingVehicle()) {
+            continue;
+        }
+        Transfer_t* transfer = new Transfer_t;
+        transfer->vehicle       = vehicle;
+        transfer->vehicleId     = vehicle->id();
+        transfer->link          = nullptr;
+        transfer->state         = StateQueued;
+        transfer->stageProgress = 0;
+        _transfers.append(transfer);
+    }
+    qCDebug(PlanFleetUploaderLog) << "sendToVehicles vehicles:missionItems" << _transfers.count() << _missionItems.count();
+
+    if (_transfers.isEmpty()) {
+        emit sendComplete(0, 0);
+        return;
+    }
+
+    _inProgress = true;
+    emit inProgressChanged(true);
+    _updateProgress();
+    _startNext();
+}
+
+/// Starts queued transfers up to the overall and per link limits
+void PlanFleetUploader::_startNext(void)
+{
+    int                         activeCount = 0;
+    QHash<LinkInterface*, int>  activePerLink;
+    for (const Transfer_t* transfer: _transfers) {
+        if (transfer->state != StateQueued && transfer->state != StateDone && transfer->state != StateFailed) {
+            activeCount++;
+            activePerLink[transfer->link]++;
+        }
+    }
+
+    for (Transfer_t* transfer: _transfers) {
+        if (activeCount >= _maxTransfers) {
+            break;
+        }
+        if (transfer->state != StateQueued) {
+            continue;
+        }
+        if (!transfer->vehicle) {
+            _fail(transfer, tr("Vehicle disconnected"));
+            continue;
+        }
+
+        SharedLinkInterfacePtr sharedLink = transfer->vehicle->vehicleLinkManager()->primaryLink().lock();
+        if (!sharedLink) {
+            _fail(transfer, tr("No link"));
+            continue;
+        }
+        if (sharedLink->linkConfiguration()->isHighLatency()) {
+            _fail(transfer, tr("Upload not supported on high latency links"));
+            continue;
+        }
+        if (activePerLink.value(sharedLink.get()) >= _maxTransfersPerLink) {
+            continue;
+        }
+
+        transfer->link = sharedLink.get();
+        activePerLink[transfer->link]++;
+        activeCount++;
+        _startMission(transfer);
+    }
+
+    bool allFinished = true;
+    for (const Transfer_t* transfer: _transfers) {
+        if (transfer->state != StateDone && transfer->state != StateFailed) {
+            allFinished = false;
+            break;
+        }
+    }
+    if (allFinished && _inProgress) {
+        qCDebug(PlanFleetUploaderLog) << "Upload complete succeeded:failed" << _completedCount << _failedCount;
+        _inProgress = false;
+        emit inProgressChanged(false);
+        emit sendComplete(_completedCount, _failedCount);
+    }
+}
+
+void PlanFleetUploader::_startMission(Transfer_t* transfer)
+{
+    Vehicle*        vehicle         = transfer->vehicle;
+    MissionManager* missionManager  = vehicle->missionManager();
+
+    if (missionManager->inProgress()) {
+        _fail(transfer, tr("Mission transfer already in progress"));
+        return;
+    }
+
+    qCDebug(PlanFleetUploaderLog) << "Start mission upload vehicle" << transfer->vehicleId;
+    transfer->state         = StateMission;
+    transfer->stageProgress = 0;
+
+    // Vehicles are gone with their plan managers, which takes the connections with them
+    connect(vehicle, &QObject::destroyed, this, [this, transfer]() { _fail(transfer, tr("Vehicle disconnected")); });
+    connect(missionManager, &PlanManager::error,        this, [transfer](int, const QString& errorMsg) { transfer->lastError = errorMsg; });
+    connect(missionManager, &PlanManager::progressPct,  this, [this, transfer](double progressPct) { transfer->stageProgress = progressPct; _updateProgress(); });
+    connect(missionManager, &PlanManager::sendComplete, this, [this, transfer](bool error) { _stageComplete(transfer, error); });
+
+    // PlanManager takes control of MissionItems so each vehicle gets its own copies
+    QList<MissionItem*> rgMissionItems;
+    for (const MissionItem* missionItem: _missionItems) {
+        rgMissionItems.append(new MissionItem(*missionItem, vehicle));
+    }
+    missionManager->writeMissionItems(rgMissionItems);
+}
+
+void PlanFleetUploader::_startGeoFence(Transfer_t* transfer)
+{
+    Vehicle* vehicle = transfer->vehicle;
+
+    transfer->state         = StateGeoFence;
+    transfer->stageProgress = 0;
+
+    // Same check as GeoFenceController::supported, but for this vehicle instead of the manager vehicle
+    if (!(vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_MISSION_FENCE) || vehicle->maxProtoVersion() < 200) {
+        _stageComplete(transfer, false);
+        return;
+    }
+
+    qCDebug(PlanFleetUploaderLog) << "Start fence upload vehicle" << transfer->vehicleId;
+    GeoFenceManager*    geoFenceManager     = vehicle->geoFenceManager();
+    GeoFenceController* geoFenceController  = _masterController->geoFenceController();
+    connect(geoFenceManager, &GeoFenceManager::error,           this, [transfer](int, const QString& errorMsg) { transfer->lastError = errorMsg; });
+    connect(geoFenceManager, &GeoFenceManager::sendComplete,    this, [this, transfer](bool error) { _stageComplete(transfer, error); });
+    geoFenceManager->sendToVehicle(geoFenceController->breachReturnPoint(), *geoFenceController->polygons(), *geoFenceController->circles());
+}
+
+void PlanFleetUploader::_startRallyPoints(Transfer_t* transfer)
+{
+    Vehicle* vehicle = transfer->vehicle;
+
+    transfer->state         = StateRallyPoints;
+    transfer->stageProgress = 0;
+
+    if (!(vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_MISSION_RALLY) || vehicle->maxProtoVersion() < 200) {
+        _stageComplete(transfer, false);
+        return;
+    }
+
+    qCDebug(PlanFleetUploaderLog) << "Start rally point upload vehicle" << transfer->vehicleId;
+    RallyPointManager* rallyPointManager = vehicle->rallyPointManager();
+    connect(rallyPointManager, &RallyPointManager::error,           this, [transfer](int, const QString& errorMsg) { transfer->lastError = errorMsg; });
+    connect(rallyPointManager, &RallyPointManager::sendComplete,    this, [this, transfer](bool error) { _stageComplete(transfer, error); });
+    rallyPointManager->sendToVehicle(_rallyPoints);
+}
+
+void PlanFleetUploader::_stageComplete(Transfer_t* transfer, bool error)
+{
+    if (transfer->state == StateDone || transfer->state == StateFailed) {
+        return;
+    }
+    _disconnectManagers(transfer);
+
+    if (error) {
+        _fail(transfer, transfer->lastError.isEmpty() ? tr("Upload failed") : transfer->lastError);
+        return;
+    }
+
+    switch (transfer->state) {
+    case StateMission:
+        _startGeoFence(transfer);
+        break;
+    case StateGeoFence:
+        _startRallyPoints(transfer);
+        break;
+    case StateRallyPoints:
+        qCDebug(PlanFleetUploaderLog) << "Upload complete vehicle" << transfer->vehicleId;
+        _finish(transfer, StateDone);
+        break;
+    default:
+        break;
+    }
+}
+
+void PlanFleetUploader::_fail(Transfer_t* transfer, const QString& reason)
+{
+    if (transfer->state == StateDone || transfer->state == StateFailed) {
+        return;
+    }
+    qCDebug(PlanFleetUploaderLog) << "Upload failed vehicle" << transfer->vehicleId << reason;
+    _errors.append(tr("Vehicle %1: %2").arg(transfer->vehicleId).arg(reason));
+    _finish(transfer, StateFailed);
+}
+
+void PlanFleetUploader::_finish(Transfer_t* transfer, State_t state)
+{
+    const bool wasActive = transfer->state != StateQueued;
+
+    _disconnectVehicle(transfer);
+    transfer->state         = state;
+    transfer->stageProgress = 0;
+    if (state == StateDone) {
+        _completedCount++;
+    } else {
+        _failedCount++;
+    }
+    _updateProgress();
+
+    // Queued transfers which fail are found by _startNext itself. Plan managers may complete from within the call which
+    // started them, so the next transfer is started from the event loop rather than recursing into _startNext.
+    if (wasActive) {
+        QMetaObject::invokeMethod(this, &PlanFleetUploader::_startNext, Qt::QueuedConnection);
+    }
+}
+
+void PlanFleetUploader::_disconnectVehicle(Transfer_t* transfer)
+{
+    if (transfer->vehicle) {
+        disconnect(transfer->vehicle, nullptr, this, nullptr);
+    }
+    _disconnectManagers(transfer);
+}
+
+void PlanFleetUploader::_disconnectManagers(Transfer_t* transfer)
+{
+    Vehicle* vehicle = transfer->vehicle;
+    if (vehicle) {
+        disconnect(vehicle->missionManager(),       nullptr, this, nullptr);
+        disconnect(vehicle->geoFenceManager(),      nullptr, this, nullptr);
+        disconnect(vehicle->rallyPointManager(),    nullptr, this, nullptr);
+    }
+}
+
+void PlanFleetUploader::_updateProgress(void)
+{
+    if (_transfers.isEmpty()) {
+        return;
+    }
+
+    double total = 0;
+    for (const Transfer_t* transfer: _transfers) {
+        switch (transfer->state) {
+        case StateQueued:
+            break;
+        case StateMission:
+            total += transfer->stageProgress / _stageCount;
+            break;
+        case StateGeoFence:
+            total += 1.0 / _stageCount;
+            break;
+        case StateRallyPoints:
+            total += 2.0 / _stageCount;
+            break;
+        case StateDone:
+        case StateFailed:
+            total += 1;
+            break;
+        }
+    }
+    _progress = total / _transfers.count();
+    emit progressChanged();
+}
+
+void PlanFleetUploader::_clear(void)
+{
+    for (Transfer_t* transfer: _transfers) {
+        _disconnectVehicle(transfer);
+        delete transfer;
+    }
+    _transfers.clear();
+    _missionItems.clear();
+    _rallyPoints.clear();
+    delete _missionItemParent;
+    _missionItemParent  = nullptr;
+    _progress           = 0;
+    _completedCount     = 0;
+    _failedCount        = 0;
+    _errors.clear();
+}
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+#include <QStringList>
+#include <QVariantList>
+#include <QGeoCoordinate>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(PlanFleetUploaderLog)
+
+class PlanMasterController;
+class Vehicle;
+class MissionItem;
+class LinkInterface;
+
+/// Uploads the plan of a PlanMasterController to several vehicles at the same time.
+///
+/// The plan is converted to mission items once, each vehicle then gets its own copy. Each vehicle goes through
+/// mission, fence and rally points in turn like PlanMasterController::sendToVehicle, while the vehicles themselves are
+/// uploaded concurrently. Vehicles sharing a link, such as a single radio to a swarm, are limited to
+/// _maxTransfersPerLink transfers at a time so that they don't starve each other of bandwidth and hit retry timeouts.
+class PlanFleetUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    PlanFleetUploader(PlanMasterController* masterController, QObject* parent = nullptr);
+    ~PlanFleetUploader();
+
+    Q_PROPERTY(bool         inProgress      READ inProgress     NOTIFY inProgressChanged)
+    Q_PROPERTY(double       progress        READ progress       NOTIFY progressChanged)     ///< 0-1 over all vehicles
+    Q_PROPERTY(int          vehicleCount    READ vehicleCount   NOTIFY inProgressChanged)
+    Q_PROPERTY(int          completedCount  READ completedCount NOTIFY progressChanged)     ///< Vehicles uploaded successfully
+    Q_PROPERTY(int          failedCount     READ failedCount    NOTIFY progressChanged)
+    Q_PROPERTY(QStringList  errors          READ errors         NOTIFY progressChanged)     ///< One entry per failed vehicle
+
+    /// Starts uploading the current plan to the Vehicle objects in vehicles
+    Q_INVOKABLE void sendToVehicles(const QVariantList& vehicles);
+
+    bool        inProgress      (void) const { return _inProgress; }
+    double      progress        (void) const { return _progress; }
+    int         vehicleCount    (void) const { return _transfers.count(); }
+    int         completedCount  (void) const { return _completedCount; }
+    int         failedCount     (void) const { return _failedCount; }
+    QStringList errors          (void) const { return _errors; }
+
+    void sendToVehicles(const QList<Vehicle*>& vehicles);
+
+signals:
+    void inProgressChanged  (bool inProgress);
+    void progressChanged    (void);
+    void sendComplete       (int completedCount, int failedCount);
+
+private:
+    typedef enum {
+        StateQueued,
+        StateMission,
+        StateGeoFence,
+        StateRallyPoints,
+        StateDone,
+        StateFailed,
+    } State_t;
+
+    typedef struct {
+        QPointer<Vehicle>   vehicle;
+        int                 vehicleId;
+        LinkInterface*      link;               ///< Primary link when started, only used to count transfers per link
+        State_t             state;
+        double              stageProgress;      ///< 0-1 within the current state
+        QString             lastError;          ///< Last error reported by the plan manager
+    } Transfer_t;
+
+    void    _startNext          (void);
+    void    _startMission       (Transfer_t* transfer);
+    void    _startGeoFence      (Transfer_t* transfer);
+    void    _startRallyPoints   (Transfer_t* transfer);
+    void    _stageComplete      (Transfer_t* transfer, bool error);
+    void    _fail               (Transfer_t* transfer, const QString& reason);
+    void    _finish             (Transfer_t* transfer, State_t state);
+    void    _disconnectVehicle  (Transfer_t* transfer);
+    void    _disconnectManagers (Transfer_t* transfer);
+    void    _updateProgress     (void);
+    void    _clear              (void);
+
+    PlanMasterController*   _masterController;
+    QList<Transfer_t*>      _transfers;
+    QObject*                _missionItemParent  = nullptr;      ///< Owns _missionItems
+    QList<MissionItem*>     _missionItems;                      ///< Plan converted once for all vehicles
+    QList<QGeoCoordinate>   _rallyPoints;
+    bool                    _inProgress         = false;
+    double                  _progress           = 0;
+    int                     _completedCount     = 0;
+    int                     _failedCount        = 0;
+    QStringList             _errors;
+
+    static const int        _maxTransfers           = 8;
+    static const int        _maxTransfersPerLink    = 2;
+    static const int        _stageCount             = 3;        ///< Mission, fence, rally points
+};
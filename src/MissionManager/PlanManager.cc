@@ -14,9 +14,30 @@
 #include "QGCApplication.h"
 #include "MissionCommandTree.h"
 #include "MissionCommandUIInfo.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
+#include "ComponentInformationCache.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cmath>
 
 QGC_LOGGING_CATEGORY(PlanManagerLog, "PlanManagerLog")
 
+// Newer mavlink carries a checksum of the plan on the vehicle (opaque_id) in MISSION_COUNT and MISSION_ACK
+#define QGC_MISSION_OPAQUE_ID (MAVLINK_MSG_ID_MISSION_COUNT_LEN >= 9 && MAVLINK_MSG_ID_MISSION_ACK_LEN >= 8)
+
+static ComponentInformationCache& planCache(void)
+{
+    static ComponentInformationCache instance(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCPlanCache"), 30);
+    return instance;
+}
+
 PlanManager::PlanManager(Vehicle* vehicle, MAV_MISSION_TYPE planType)
     : _vehicle                  (vehicle)
     , _missionCommandTree       (qgcApp()->toolbox()->missionCommandTree())
@@ -47,17 +68,18 @@ void PlanManager::_writeMissionItemsWorker(void)
 
     emit progressPct(0);
 
-    qCDebug(PlanManagerLog) << QStringLiteral("writeMissionItems %1 count:").arg(_planTypeString()) << _writeMissionItems.count();
+    qCDebug(PlanManagerLog) << QStringLiteral("writeMissionItems %1 count:").arg(_planTypeString()) << _writeItemCount();
 
     // Prime write list
     _itemIndicesToWrite.clear();
-    for (int i=0; i<_writeMissionItems.count(); i++) {
+    for (int i=0; i<_writeItemCount(); i++) {
         _itemIndicesToWrite << i;
     }
 
     _retryCount = 0;
     _setTransactionInProgress(TransactionWrite);
     _connectToMavlink();
+    _startPipeline(_writeItemCount());
     _writeMissionCount();
 }
 
@@ -97,10 +119,75 @@ void PlanManager::writeMissionItems(const QList<MissionItem*>& missionItems)
     _writeMissionItemsWorker();
 }
 
+PlanManager::StreamItem_t PlanManager::streamItem(MAV_CMD command, MAV_FRAME frame, double param1, double latitude, double longitude, double altitude)
+{
+    StreamItem_t item;
+
+    item.command        = static_cast<uint16_t>(command);
+    item.frame          = static_cast<uint8_t>(frame);
+    item.autoContinue   = 0;
+    item.param1         = static_cast<float>(param1);
+    item.param2         = 0;
+    item.param3         = 0;
+    item.param4         = 0;
+    item.x              = frame == MAV_FRAME_MISSION ? static_cast<int32_t>(latitude) : static_cast<int32_t>(qRound64(latitude * 1e7));
+    item.y              = frame == MAV_FRAME_MISSION ? static_cast<int32_t>(longitude) : static_cast<int32_t>(qRound64(longitude * 1e7));
+    item.z              = static_cast<float>(altitude);
+
+    return item;
+}
+
+void PlanManager::writeStreamItems(const QVector<StreamItem_t>& streamItems)
+{
+    if (_vehicle->isOfflineEditingVehicle()) {
+        return;
+    }
+
+    if (inProgress()) {
+        qCDebug(PlanManagerLog) << QStringLiteral("writeStreamItems %1 called while transaction in progress").arg(_planTypeString());
+        return;
+    }
+
+    _clearAndDeleteWriteMissionItems();
+    _writeStreamItems = streamItems;
+
+    _writeMissionItemsWorker();
+}
+
+int PlanManager::_writeItemCount(void) const
+{
+    return _writeStreamItems.isEmpty() ? _writeMissionItems.count() : _writeStreamItems.count();
+}
+
+/// @return Item to send for the specified sequence number, the same as sent on the wire regardless of how the write was started
+PlanManager::StreamItem_t PlanManager::_writeItem(int seq) const
+{
+    if (!_writeStreamItems.isEmpty()) {
+        return _writeStreamItems[seq];
+    }
+
+    const MissionItem*  missionItem = _writeMissionItems[seq];
+    bool                missionFrame = missionItem->frame() == MAV_FRAME_MISSION;
+    StreamItem_t        item;
+
+    item.command        = static_cast<uint16_t>(missionItem->command());
+    item.frame          = static_cast<uint8_t>(missionItem->frame());
+    item.autoContinue   = missionItem->autoContinue();
+    item.param1         = static_cast<float>(missionItem->param1());
+    item.param2         = static_cast<float>(missionItem->param2());
+    item.param3         = static_cast<float>(missionItem->param3());
+    item.param4         = static_cast<float>(missionItem->param4());
+    item.x              = static_cast<int32_t>(missionFrame ? missionItem->param5() : missionItem->param5() * 1e7);
+    item.y              = static_cast<int32_t>(missionFrame ? missionItem->param6() : missionItem->param6() * 1e7);
+    item.z              = static_cast<float>(missionItem->param7());
+
+    return item;
+}
+
 /// This begins the write sequence with the vehicle. This may be called during a retry.
 void PlanManager::_writeMissionCount(void)
 {
-    qCDebug(PlanManagerLog) << QStringLiteral("_writeMissionCount %1 count:_retryCount").arg(_planTypeString()) << _writeMissionItems.count() << _retryCount;
+    qCDebug(PlanManagerLog) << QStringLiteral("_writeMissionCount %1 count:_retryCount").arg(_planTypeString()) << _writeItemCount() << _retryCount;
 
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
@@ -113,7 +200,7 @@ void PlanManager::_writeMissionCount(void)
                                             &message,
                                             _vehicle->id(),
                                             MAV_COMP_ID_AUTOPILOT1,
-                                            _writeMissionItems.count(),
+                                            _writeItemCount(),
                                             _planType);
 
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
@@ -147,6 +234,8 @@ void PlanManager::_requestList(void)
 
     _itemIndicesToRead.clear();
     _clearMissionItems();
+    _readOpaqueId   = 0;
+    _readFromCache  = false;
 
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
@@ -191,11 +280,19 @@ void PlanManager::_ackTimeout(void)
     case AckMissionItem:
         // MISSION_ITEM expected
         if (_retryCount > _maxRetryCount) {
-            _sendError(MaxRetryExceeded, tr("Mission read failed, maximum retries exceeded."));
-            _finishTransaction(false);
+            if (_pipelined) {
+                _fallbackToStrictProtocol(QStringLiteral("read retries exceeded"));
+            } else {
+                _sendError(MaxRetryExceeded, tr("Mission read failed, maximum retries exceeded."));
+                _finishTransaction(false);
+            }
         } else {
             _retryCount++;
             qCDebug(PlanManagerLog) << tr("Retrying %1 MISSION_REQUEST retry Count").arg(_planTypeString()) << _retryCount;
+            if (_pipelined) {
+                // Back off in case the window is overrunning the link or the vehicle
+                _pipelineWindow = qMax(1, _pipelineWindow / 2);
+            }
             _requestNextMissionItem();
         }
         break;
@@ -247,7 +344,7 @@ void PlanManager::_startAckTimeout(AckType_t ack)
     switch (ack) {
     case AckMissionItem:
         // We are actively trying to get the mission item, so we don't want to wait as long.
-        _ackTimeoutTimer->setInterval(_retryTimeoutMilliseconds);
+        _ackTimeoutTimer->setInterval(_pipelined ? _pipelineRetransmitMSecs() : _retryTimeoutMilliseconds);
         break;
     case AckNone:
         // FALLTHROUGH
@@ -290,6 +387,13 @@ bool PlanManager::_checkForExpectedAck(AckType_t receivedAck)
 void PlanManager::_readTransactionComplete(void)
 {
     qCDebug(PlanManagerLog) << "_readTransactionComplete read sequence complete";
+
+    if (_pipelined) {
+        // Pipelined items can arrive out of order
+        std::sort(_missionItems.begin(), _missionItems.end(), [](const MissionItem* item1, const MissionItem* item2) {
+            return item1->sequenceNumber() < item2->sequenceNumber();
+        });
+    }
     
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
@@ -308,6 +412,10 @@ void PlanManager::_readTransactionComplete(void)
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
 
+    if (!_readFromCache && !_missionItems.isEmpty()) {
+        _saveToCache(_readOpaqueId, _missionItems);
+    }
+
     _finishTransaction(true);
 }
 
@@ -332,7 +440,13 @@ void PlanManager::_handleMissionCount(const mavlink_message_t& message)
 
     _retryCount = 0;
 
-    if (missionCount.count == 0) {
+#if QGC_MISSION_OPAQUE_ID
+    _readOpaqueId = missionCount.opaque_id;
+#endif
+    if (missionCount.count != 0 && _loadFromCache(_readOpaqueId, missionCount.count)) {
+        // Plan on the vehicle is unchanged since we last had it
+        _readTransactionComplete();
+    } else if (missionCount.count == 0) {
         _readTransactionComplete();
     } else {
         // Prime read list
@@ -340,6 +454,7 @@ void PlanManager::_handleMissionCount(const mavlink_message_t& message)
             _itemIndicesToRead << i;
         }
         _missionItemCountToRead = missionCount.count;
+        _startPipeline(missionCount.count);
         _requestNextMissionItem();
     }
 }
@@ -351,8 +466,47 @@ void PlanManager::_requestNextMissionItem(void)
         return;
     }
 
+    if (_pipelined) {
+        _requestMissionItemsPipelined();
+        return;
+    }
+
     qCDebug(PlanManagerLog) << QStringLiteral("_requestNextMissionItem %1 sequenceNumber:retry").arg(_planTypeString()) << _itemIndicesToRead[0] << _retryCount;
 
+    _sendMissionRequest(_itemIndicesToRead[0]);
+    _startAckTimeout(AckMissionItem);
+}
+
+/// Keeps requests outstanding for the first _pipelineWindow items which are still missing. Requests which have been
+/// outstanding longer than the retransmit time are sent again, so only the gaps are re-requested.
+void PlanManager::_requestMissionItemsPipelined(void)
+{
+    qint64  nowMSecs        = _pipelineClock.elapsed();
+    int     retransmitMSecs = _pipelineRetransmitMSecs();
+    int     windowCount     = qMin(_pipelineWindow, _itemIndicesToRead.count());
+
+    for (int i=0; i<windowCount; i++) {
+        int     seq         = _itemIndicesToRead[i];
+        qint64  sentMSecs   = _pipelineSentMSecs[seq];
+
+        if (sentMSecs >= 0) {
+            if (nowMSecs - sentMSecs < retransmitMSecs) {
+                // Still in flight
+                continue;
+            }
+            _pipelineRetransmitted[seq] = true;
+        }
+
+        qCDebug(PlanManagerLog) << QStringLiteral("_requestMissionItemsPipelined %1 sequenceNumber:window:retransmit").arg(_planTypeString()) << seq << _pipelineWindow << (sentMSecs >= 0);
+        _sendMissionRequest(seq);
+        _pipelineSentMSecs[seq] = nowMSecs;
+    }
+
+    _startAckTimeout(AckMissionItem);
+}
+
+void PlanManager::_sendMissionRequest(int seq)
+{
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
         SharedLinkInterfacePtr  sharedLink = weakLink.lock();
@@ -364,11 +518,10 @@ void PlanManager::_requestNextMissionItem(void)
                                                   &message,
                                                   _vehicle->id(),
                                                   MAV_COMP_ID_AUTOPILOT1,
-                                                  _itemIndicesToRead[0],
+                                                  seq,
                                                   _planType);
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
-    _startAckTimeout(AckMissionItem);
 }
 
 void PlanManager::_handleMissionItem(const mavlink_message_t& message)
@@ -459,6 +612,10 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message)
         }
 
         _missionItems.append(item);
+
+        if (_pipelined) {
+            _pipelineResponse(seq, _pipelineClock.elapsed());
+        }
     } else {
         qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionItem %1 mission item received item index which was not requested, disregrarding:").arg(_planTypeString()) << seq;
         // We have to put the ack timeout back since it was removed above
@@ -466,7 +623,7 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message)
         return;
     }
 
-    emit progressPct((double)seq / (double)_missionItemCountToRead);
+    emit progressPct((double)(_missionItemCountToRead - _itemIndicesToRead.count()) / (double)_missionItemCountToRead);
     
     _retryCount = 0;
     if (_itemIndicesToRead.count() == 0) {
@@ -505,23 +662,75 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message)
 
     qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 sequenceNumber").arg(_planTypeString()) << missionRequestSeq;
 
-    if (missionRequestSeq > _writeMissionItems.count() - 1) {
-        _sendError(RequestRangeError, tr("Vehicle requested item outside range, count:request %1:%2. Send to Vehicle failed.").arg(_writeMissionItems.count()).arg(missionRequestSeq));
+    if (missionRequestSeq > _writeItemCount() - 1) {
+        _sendError(RequestRangeError, tr("Vehicle requested item outside range, count:request %1:%2. Send to Vehicle failed.").arg(_writeItemCount()).arg(missionRequestSeq));
         _finishTransaction(false);
         return;
     }
 
-    emit progressPct((double)missionRequestSeq / (double)_writeMissionItems.count());
+    emit progressPct((double)missionRequestSeq / (double)_writeItemCount());
 
     _lastMissionRequest = missionRequestSeq;
-    if (!_itemIndicesToWrite.contains(missionRequestSeq)) {
-        qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 sequence number requested which has already been sent, sending again:").arg(_planTypeString()) << missionRequestSeq;
+
+    if (_pipelined) {
+        qint64 nowMSecs = _pipelineClock.elapsed();
+
+        if (missionRequestSeq > _pipelineHighestRequest) {
+            // The vehicle requests the next item once it has the previous one
+            if (missionRequestSeq > 0) {
+                _pipelineResponse(missionRequestSeq - 1, nowMSecs);
+            }
+            _pipelineHighestRequest = missionRequestSeq;
+        } else if (++_pipelinePreSendMisses > _pipelineMaxPreSendMisses) {
+            // Vehicle is re-requesting items, it is either dropping items it did not ask for yet or the link is losing
+            // them. Either way sending ahead is not helping, so fall back to answering requests only.
+            qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 too many re-requests, using strict protocol").arg(_planTypeString());
+            _pipelined = false;
+            _pipelineUnsupported = true;
+        }
+    }
+
+    if (!_pipelined) {
+        if (!_itemIndicesToWrite.contains(missionRequestSeq)) {
+            qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 sequence number requested which has already been sent, sending again:").arg(_planTypeString()) << missionRequestSeq;
+        } else {
+            _itemIndicesToWrite.removeOne(missionRequestSeq);
+        }
+        _sendMissionItem(missionRequestSeq);
     } else {
-        _itemIndicesToWrite.removeOne(missionRequestSeq);
+        qint64 nowMSecs         = _pipelineClock.elapsed();
+        qint64 sentMSecs        = _pipelineSentMSecs[missionRequestSeq];
+        int    retransmitMSecs  = _pipelineRetransmitMSecs();
+
+        // An item sent ahead very recently is still in flight and is what the vehicle is asking for
+        if (sentMSecs < 0 || nowMSecs - sentMSecs >= retransmitMSecs) {
+            if (sentMSecs >= 0) {
+                _pipelineRetransmitted[missionRequestSeq] = true;
+            }
+            _sendMissionItem(missionRequestSeq);
+        }
+
+        // Send ahead to fill the window
+        int windowEnd = qMin(_writeItemCount(), missionRequestSeq + _pipelineWindow);
+        for (int seq=missionRequestSeq+1; seq<windowEnd; seq++) {
+            if (_pipelineSentMSecs[seq] < 0) {
+                _sendMissionItem(seq);
+            }
+        }
+    }
+
+    _startAckTimeout(AckMissionRequest);
+}
+
+void PlanManager::_sendMissionItem(int seq)
+{
+    const StreamItem_t item = _writeItem(seq);
+    qCDebug(PlanManagerLog) << QStringLiteral("_sendMissionItem %1 sequenceNumber:command").arg(_planTypeString()) << seq << item.command;
+
+    if (_pipelined) {
+        _pipelineSentMSecs[seq] = _pipelineClock.elapsed();
+        _itemIndicesToWrite.removeOne(seq);
     }
-    
-    MissionItem* item = _writeMissionItems[missionRequestSeq];
-    qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionRequest %1 sequenceNumber:command").arg(_planTypeString()) << missionRequestSeq << item->command();
 
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
@@ -534,22 +743,21 @@ void PlanManager::_handleMissionRequest(const mavlink_message_t& message)
                                                &messageOut,
                                                _vehicle->id(),
                                                MAV_COMP_ID_AUTOPILOT1,
-                                               missionRequestSeq,
-                                               item->frame(),
-                                               item->command(),
-                                               missionRequestSeq == 0,
-                                               item->autoContinue(),
-                                               item->param1(),
-                                               item->param2(),
-                                               item->param3(),
-                                               item->param4(),
-                                               item->frame() == MAV_FRAME_MISSION ? item->param5() : item->param5() * 1e7,
-                                               item->frame() == MAV_FRAME_MISSION ? item->param6() : item->param6() * 1e7,
-                                               item->param7(),
+                                               seq,
+                                               item.frame,
+                                               item.command,
+                                               seq == 0,
+                                               item.autoContinue,
+                                               item.param1,
+                                               item.param2,
+                                               item.param3,
+                                               item.param4,
+                                               item.x,
+                                               item.y,
+                                               item.z,
                                                _planType);
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), messageOut);
     }
-    _startAckTimeout(AckMissionRequest);
 }
 
 void PlanManager::_handleMissionAck(const mavlink_message_t& message)
@@ -598,6 +806,11 @@ void PlanManager::_handleMissionAck(const mavlink_message_t& message)
         break;
     case AckMissionItem:
         // MISSION_ITEM expected
+        if (_pipelined && _pipelineFallbackResult((MAV_MISSION_RESULT)missionAck.type)) {
+            // Vehicle does not accept more than one outstanding request
+            _fallbackToStrictProtocol(_missionResultToString((MAV_MISSION_RESULT)missionAck.type));
+            break;
+        }
         // FIXME: Protocol error
         _sendError(VehicleAckError, _missionResultToString((MAV_MISSION_RESULT)missionAck.type));
         _finishTransaction(false);
@@ -607,12 +820,18 @@ void PlanManager::_handleMissionAck(const mavlink_message_t& message)
         if (missionAck.type == MAV_MISSION_ACCEPTED) {
             if (_itemIndicesToWrite.count() == 0) {
                 qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionAck write sequence complete %1").arg(_planTypeString());
+#if QGC_MISSION_OPAQUE_ID
+                _saveWriteItemsToCache(missionAck.opaque_id);
+#endif
                 _finishTransaction(true);
             } else {
                 // FIXME: Protocol error
                 _sendError(VehicleAckError, _missionResultToString((MAV_MISSION_RESULT)missionAck.type));
                 _finishTransaction(false);
             }
+        } else if (_pipelined && _pipelineFallbackResult((MAV_MISSION_RESULT)missionAck.type)) {
+            // Vehicle does not accept items it has not requested yet
+            _fallbackToStrictProtocol(_missionResultToString((MAV_MISSION_RESULT)missionAck.type));
         } else {
             _sendError(VehicleAckError, _missionResultToString((MAV_MISSION_RESULT)missionAck.type));
             _finishTransaction(false);
@@ -693,14 +912,14 @@ QString PlanManager::_lastMissionReqestString(MAV_MISSION_RESULT result)
     QString prefix;
     QString postfix;
 
-    if (_lastMissionRequest >= 0 && _lastMissionRequest < _writeMissionItems.count()) {
-        MissionItem* item = _writeMissionItems[_lastMissionRequest];
+    if (_lastMissionRequest >= 0 && _lastMissionRequest < _writeItemCount()) {
+        const StreamItem_t item = _writeItem(_lastMissionRequest);
 
-        prefix = tr("Item #%1 Command: %2").arg(_lastMissionRequest).arg(_missionCommandTree->friendlyName(item->command()));
+        prefix = tr("Item #%1 Command: %2").arg(_lastMissionRequest).arg(_missionCommandTree->friendlyName(static_cast<MAV_CMD>(item.command)));
 
         switch (result) {
         case MAV_MISSION_UNSUPPORTED_FRAME:
-            postfix = tr("Frame: %1").arg(item->frame());
+            postfix = tr("Frame: %1").arg(item.frame);
             break;
         case MAV_MISSION_UNSUPPORTED:
             // All we need is the prefix
@@ -808,6 +1027,7 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
 
     _itemIndicesToRead.clear();
     _itemIndicesToWrite.clear();
+    _pipelined = false;
 
     // First thing we do is clear the transaction. This way inProgesss is off when we signal transaction complete.
     TransactionType_t currentTransactionType = _transactionInProgress;
@@ -837,6 +1057,7 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
                     _missionItems.append(_writeMissionItems[i]);
                 }
                 _writeMissionItems.clear();
+                _writeStreamItems.clear();
             } else {
                 // Write failed, throw out the write list
                 _clearAndDeleteWriteMissionItems();
@@ -931,6 +1152,7 @@ void PlanManager::_clearAndDeleteWriteMissionItems(void)
         delete _writeMissionItems[i];
     }
     _writeMissionItems.clear();
+    _writeStreamItems.clear();
 }
 
 void PlanManager::_connectToMavlink(void)
@@ -966,3 +1188,212 @@ void PlanManager::_setTransactionInProgress(TransactionType_t type)
         emit inProgressChanged(inProgress());
     }
 }
+
+/// Sets up pipelined transfer state for a new read or write sequence. Pipelining is only used if enabled in settings
+/// and the vehicle has not failed a pipelined transfer before.
+void PlanManager::_startPipeline(int itemCount)
+{
+    _pipelined = !_pipelineUnsupported && qgcApp()->toolbox()->settingsManager()->appSettings()->pipelinedPlanTransfer()->rawValue().toBool();
+    if (!_pipelined) {
+        return;
+    }
+
+    _pipelineSentMSecs.fill(-1, itemCount);
+    _pipelineRetransmitted.fill(false, itemCount);
+    _pipelineHighestRequest     = -1;
+    _pipelinePreSendMisses      = 0;
+    _pipelineLastResponseMSecs  = -1;
+    _pipelineIntervalMSecs      = -1;
+    _pipelineClock.start();
+
+    // Round trip estimates are kept from the previous transfer since they are a property of the link. The window
+    // starts from the previous estimate as well, but never above the initial window in case the link changed.
+    _pipelineWindow = qMin(_pipelineWindow, _pipelineInitialWindow);
+
+    qCDebug(PlanManagerLog) << QStringLiteral("_startPipeline %1 count:window:srtt").arg(_planTypeString()) << itemCount << _pipelineWindow << _pipelineSRttMSecs;
+}
+
+/// Updates round trip and response interval estimates from a vehicle response, then resizes the window
+///     @param sentSeq Sequence number of the request (read) or item (write) which triggered the response
+void PlanManager::_pipelineResponse(int sentSeq, qint64 nowMSecs)
+{
+    qint64 sentMSecs = _pipelineSentMSecs[sentSeq];
+
+    // Responses to retransmits are ambiguous, so they don't update the round trip time
+    if (sentMSecs >= 0 && !_pipelineRetransmitted[sentSeq]) {
+        double rttMSecs = nowMSecs - sentMSecs;
+        _pipelineSRttMSecs      = _pipelineSRttMSecs < 0 ? rttMSecs : (0.875 * _pipelineSRttMSecs) + (0.125 * rttMSecs);
+        _pipelineMinRttMSecs    = _pipelineMinRttMSecs < 0 ? rttMSecs : qMin(_pipelineMinRttMSecs, rttMSecs);
+    }
+
+    if (_pipelineLastResponseMSecs >= 0) {
+        double intervalMSecs = qMax(nowMSecs - _pipelineLastResponseMSecs, 1ll);
+        _pipelineIntervalMSecs = _pipelineIntervalMSecs < 0 ? intervalMSecs : (0.875 * _pipelineIntervalMSecs) + (0.125 * intervalMSecs);
+    }
+    _pipelineLastResponseMSecs = nowMSecs;
+
+    if (_pipelineMinRttMSecs >= 0 && _pipelineIntervalMSecs > 0) {
+        // Enough requests in flight to cover one round trip at the rate the vehicle is responding, plus one to keep
+        // probing for more throughput. Using the minimum round trip keeps queueing delay from inflating the window.
+        int window = static_cast<int>(std::ceil(_pipelineMinRttMSecs / _pipelineIntervalMSecs)) + 1;
+        _pipelineWindow = qBound(1, window, _pipelineMaxWindow);
+    }
+}
+
+int PlanManager::_pipelineRetransmitMSecs(void) const
+{
+    if (_pipelineSRttMSecs < 0) {
+        return _ackTimeoutMilliseconds;
+    }
+    return qBound(_retryTimeoutMilliseconds, static_cast<int>(2 * _pipelineSRttMSecs), _ackTimeoutMilliseconds);
+}
+
+/// @return true: Ack result is what firmware which only supports the strict protocol sends for out of order requests/items
+bool PlanManager::_pipelineFallbackResult(MAV_MISSION_RESULT result) const
+{
+    return result == MAV_MISSION_INVALID_SEQUENCE || result == MAV_MISSION_ERROR;
+}
+
+/// Restarts the current transaction using the strict one item at a time protocol. The vehicle is remembered as not
+/// supporting pipelined transfers.
+void PlanManager::_fallbackToStrictProtocol(const QString& reason)
+{
+    qCDebug(PlanManagerLog) << QStringLiteral("_fallbackToStrictProtocol %1").arg(_planTypeString()) << reason;
+
+    _pipelined              = false;
+    _pipelineUnsupported    = true;
+    _retryCount             = 0;
+
+    if (_transactionInProgress == TransactionRead) {
+        _requestList();
+    } else if (_transactionInProgress == TransactionWrite) {
+        _itemIndicesToWrite.clear();
+        for (int i=0; i<_writeItemCount(); i++) {
+            _itemIndicesToWrite << i;
+        }
+        _lastMissionRequest = -1;
+        emit progressPct(0);
+        _writeMissionCount();
+    }
+}
+
+/// @return Cache tag of the plan, empty if the plan can't be cached
+QString PlanManager::_cacheTag(quint32 opaqueId) const
+{
+    if (opaqueId == 0) {
+        return QString();
+    }
+
+    // The opaque id is only unique for a vehicle, which is identified by its uid if it has one
+    QString vehicleKey = _vehicle->vehicleUID() ? QString::number(_vehicle->vehicleUID(), 16) : QStringLiteral("sysid%1").arg(_vehicle->id());
+    return QStringLiteral("plan_%1_%2_%3").arg(vehicleKey).arg(_planType).arg(opaqueId, 8, 16, QLatin1Char('0'));
+}
+
+/// Loads the items of the current read from the plan cache
+/// @return true: items loaded, false: not cached or cache entry unusable
+bool PlanManager::_loadFromCache(quint32 opaqueId, int itemCount)
+{
+    QString tag = _cacheTag(opaqueId);
+    if (tag.isEmpty()) {
+        return false;
+    }
+    QString fileName = planCache().access(tag);
+    if (fileName.isEmpty()) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        qCWarning(PlanManagerLog) << "Unable to open cached plan" << fileName << file.errorString();
+        return false;
+    }
+    QJsonArray rgItems = QJsonDocument::fromJson(file.readAll()).array();
+    if (rgItems.count() != itemCount) {
+        qCWarning(PlanManagerLog) << "Cached plan item count mismatch" << tag << rgItems.count() << itemCount;
+        return false;
+    }
+
+    QList<MissionItem*> missionItems;
+    for (int i=0; i<rgItems.count(); i++) {
+        QString         errorString;
+        MissionItem*    item = new MissionItem(this);
+        if (!item->load(rgItems[i].toObject(), i, errorString)) {
+            qCWarning(PlanManagerLog) << "Cached plan item load failed" << tag << errorString;
+            delete item;
+            qDeleteAll(missionItems);
+            return false;
+        }
+        missionItems.append(item);
+    }
+
+    qCDebug(PlanManagerLog) << QStringLiteral("_loadFromCache %1 items loaded from cache:").arg(_planTypeString()) << missionItems.count();
+
+    _missionItems   = missionItems;
+    _readFromCache  = true;
+    return true;
+}
+
+void PlanManager::_saveToCache(quint32 opaqueId, const QList<MissionItem*>& missionItems)
+{
+    QString tag = _cacheTag(opaqueId);
+    if (tag.isEmpty()) {
+        return;
+    }
+
+    QJsonArray rgItems;
+    for (const MissionItem* item: missionItems) {
+        QJsonObject itemObject;
+        item->save(itemObject);
+        rgItems.append(itemObject);
+    }
+
+    _saveToCache(tag, rgItems);
+}
+
+void PlanManager::_saveToCache(const QString& tag, const QJsonArray& rgItems)
+{
+    QTemporaryFile file;
+    file.setAutoRemove(false);
+    if (!file.open() || file.write(QJsonDocument(rgItems).toJson(QJsonDocument::Compact)) == -1) {
+        qCWarning(PlanManagerLog) << "Unable to write plan cache file" << file.errorString();
+        file.remove();
+        return;
+    }
+    file.close();
+
+    planCache().insert(tag, file.fileName());
+}
+
+void PlanManager::_saveWriteItemsToCache(quint32 opaqueId)
+{
+    if (_writeStreamItems.isEmpty()) {
+        _saveToCache(opaqueId, _writeMissionItems);
+        return;
+    }
+
+    // Streamed writes are expanded one item at a time so the cache entry matches what a later read returns
+    QString tag = _cacheTag(opaqueId);
+    if (tag.isEmpty()) {
+        return;
+    }
+
+    QJsonArray rgItems;
+    for (int seq=0; seq<_writeStreamItems.count(); seq++) {
+        const StreamItem_t& item        = _writeStreamItems[seq];
+        bool                missionFrame = item.frame == MAV_FRAME_MISSION;
+        QJsonObject         itemObject;
+
+        MissionItem(seq,
+                    static_cast<MAV_CMD>(item.command),
+                    static_cast<MAV_FRAME>(item.frame),
+                    item.param1, item.param2, item.param3, item.param4,
+                    missionFrame ? item.x : item.x / 1e7,
+                    missionFrame ? item.y : item.y / 1e7,
+                    item.z,
+                    item.autoContinue,
+                    seq == 0).save(itemObject);
+        rgItems.append(itemObject);
+    }
+
+    _saveToCache(tag, rgItems);
+}
@@ -12,6 +12,9 @@
 #include <QObject>
 #include <QLoggingCategory>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QJsonArray>
 
 #include "MissionItem.h"
 #include "QGCMAVLink.h"
@@ -52,6 +55,28 @@ public:
     ///     Signals sendComplete when done
     void writeMissionItems(const QList<MissionItem*>& missionItems);
 
+    /// Compact form of a MISSION_ITEM_INT, used for large plans such as fence polygons where creating a MissionItem
+    /// object per vertex costs more than the transfer itself
+    typedef struct {
+        uint16_t    command;        ///< MAV_CMD
+        uint8_t     frame;          ///< MAV_FRAME
+        uint8_t     autoContinue;
+        float       param1;
+        float       param2;
+        float       param3;
+        float       param4;
+        int32_t     x;              ///< Latitude * 1e7, param5 for MAV_FRAME_MISSION
+        int32_t     y;              ///< Longitude * 1e7, param6 for MAV_FRAME_MISSION
+        float       z;
+    } StreamItem_t;
+
+    static StreamItem_t streamItem(MAV_CMD command, MAV_FRAME frame, double param1, double latitude, double longitude, double altitude);
+
+    /// Writes the specified items to the vehicle. Items are only expanded to mavlink messages as the vehicle requests
+    /// them. Unlike writeMissionItems, missionItems() is empty once the write completes, the caller keeps its own copy.
+    ///     Signals sendComplete when done
+    void writeStreamItems(const QVector<StreamItem_t>& streamItems);
+
     /// Removes all mission items from vehicle
     ///     Signals removeAllComplete when done
     void removeAll(void);
@@ -76,6 +101,11 @@ public:
     static const int _retryTimeoutMilliseconds = 250;
     static const int _maxRetryCount = 5;
 
+    // Pipelined transfers keep a window of outstanding requests/items in flight, sized from the measured round trip time
+    static const int _pipelineInitialWindow = 4;
+    static const int _pipelineMaxWindow = 32;
+    static const int _pipelineMaxPreSendMisses = 2;   ///< Re-requested pre-sent items before item pre-sending is turned off
+
 signals:
     void newMissionItemsAvailable   (bool removeAllRequested);
     void inProgressChanged          (bool inProgress);
@@ -117,6 +147,9 @@ protected:
     void _handleMissionRequest(const mavlink_message_t& message);
     void _handleMissionAck(const mavlink_message_t& message);
     void _requestNextMissionItem(void);
+    void _requestMissionItemsPipelined(void);
+    void _sendMissionRequest(int seq);
+    void _sendMissionItem(int seq);
     void _clearMissionItems(void);
     void _sendError(ErrorCode_t errorCode, const QString& errorMsg);
     QString _ackTypeToString(AckType_t ackType);
@@ -132,6 +165,18 @@ protected:
     void _connectToMavlink(void);
     void _disconnectFromMavlink(void);
     QString _planTypeString(void);
+    void _startPipeline(int itemCount);
+    void _pipelineResponse(int seq, qint64 nowMSecs);
+    int _pipelineRetransmitMSecs(void) const;
+    bool _pipelineFallbackResult(MAV_MISSION_RESULT result) const;
+    void _fallbackToStrictProtocol(const QString& reason);
+    QString _cacheTag(quint32 opaqueId) const;
+    bool _loadFromCache(quint32 opaqueId, int itemCount);
+    void _saveToCache(quint32 opaqueId, const QList<MissionItem*>& missionItems);
+    void _saveToCache(const QString& tag, const QJsonArray& rgItems);
+    void _saveWriteItemsToCache(quint32 opaqueId);
+    int _writeItemCount(void) const;
+    StreamItem_t _writeItem(int seq) const;
 
 protected:
     Vehicle*            _vehicle =              nullptr;
@@ -151,9 +196,26 @@ protected:
 
     QList<MissionItem*> _missionItems;          ///< Set of mission items on vehicle
     QList<MissionItem*> _writeMissionItems;     ///< Set of mission items currently being written to vehicle
+    QVector<StreamItem_t> _writeStreamItems;    ///< Used instead of _writeMissionItems for writeStreamItems
     int                 _currentMissionIndex;
     int                 _lastCurrentIndex;
 
+    bool                _pipelined =                false;  ///< true: Current transaction is using pipelined transfers
+    bool                _pipelineUnsupported =      false;  ///< true: Vehicle failed a pipelined transfer, only use strict protocol from now on
+    QElapsedTimer       _pipelineClock;
+    QVector<qint64>     _pipelineSentMSecs;                 ///< Time item was last requested (read) or sent (write), -1 for never
+    QVector<bool>       _pipelineRetransmitted;             ///< Round trip samples are not taken for retransmitted items
+    int                 _pipelineWindow =           _pipelineInitialWindow;
+    int                 _pipelineHighestRequest =   -1;     ///< Highest item sequence requested by vehicle during write
+    int                 _pipelinePreSendMisses =    0;
+    double              _pipelineSRttMSecs =        -1;     ///< Smoothed round trip time
+    double              _pipelineMinRttMSecs =      -1;
+    double              _pipelineIntervalMSecs =    -1;     ///< Smoothed time between responses from vehicle
+    qint64              _pipelineLastResponseMSecs = -1;
+
+    quint32             _readOpaqueId =             0;      ///< Plan checksum from MISSION_COUNT of the current read, 0 if not supported
+    bool                _readFromCache =            false;  ///< true: Items of the current read came from the plan cache
+
 private:
     void _setTransactionInProgress(TransactionType_t type);
 };
@@ -13,9 +13,12 @@
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "FlightMapSettings.h"
+#include "OfflineMapsSettings.h"
+#include "QGCMapEngineManager.h"
 #include "JsonHelper.h"
 #include "MissionManager.h"
-#include "KMLPlanDomDocument.h"
+#include "KMLPlanStreamWriter.h"
 #include "SurveyPlanCreator.h"
 #include "StructureScanPlanCreator.h"
 #include "CorridorScanPlanCreator.h"
@@ -27,6 +30,8 @@
 #include <QDomDocument>
 #include <QJsonDocument>
 #include <QFileInfo>
+#include <QBuffer>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(PlanMasterControllerLog, "PlanMasterControllerLog")
 
@@ -46,6 +51,7 @@ PlanMasterController::PlanMasterController(QObject* parent)
     , _geoFenceController   (this)
     , _obstacleController   (this)
     , _rallyPointController (this)
+    , _fleetUploader        (this)
 {
     _commonInit();
 }
@@ -60,6 +66,7 @@ PlanMasterController::PlanMasterController(MAV_AUTOPILOT firmwareType, MAV_TYPE
     , _geoFenceController   (this)
     , _obstacleController   (this)
     , _rallyPointController (this)
+    , _fleetUploader        (this)
 {
     _commonInit();
 }
@@ -84,12 +91,18 @@ void PlanMasterController::_commonInit(void)
 
     // Offline vehicle can change firmware/vehicle type
     connect(_controllerVehicle,     &Vehicle::vehicleTypeChanged,                   this, &PlanMasterController::_updatePlanCreatorsList);
+
+    connect(&_loadWatcher,          &QFutureWatcherBase::finished,                  this, &PlanMasterController::_loadFromFileReadComplete);
+    connect(&_saveWatcher,          &QFutureWatcherBase::finished,                  this, &PlanMasterController::_saveToFileWriteComplete);
+    connect(&_kmlSaveWatcher,       &QFutureWatcherBase::finished,                  this, &PlanMasterController::_saveToKmlWriteComplete);
 }
 
 
 PlanMasterController::~PlanMasterController()
 {
-
+    // Don't leave a partially written plan file behind
+    _saveWatcher.waitForFinished();
+    _kmlSaveWatcher.waitForFinished();
 }
 
 void PlanMasterController::start(void)
@@ -400,50 +413,127 @@ void PlanMasterController::sendToVehicle(void)
         _sendObstacle = true;
         _missionController.sendToVehicle();
         setDirty(false);
+        _prefetchMissionTiles();
     }
 }
 
-void PlanMasterController::loadFromFile(const QString& filename)
+/// Downloads the map and terrain tiles along the mission so they are available if the connection drops in the field
+void PlanMasterController::_prefetchMissionTiles(void)
 {
-    QString errorString;
-    QString errorMessage = tr("Error loading Plan file (%1). %2").arg(filename).arg("%1");
+    SettingsManager*        settingsManager = qgcApp()->toolbox()->settingsManager();
+    OfflineMapsSettings*    offlineSettings = settingsManager->offlineMapsSettings();
+    if (!offlineSettings->prefetchMissionCorridor()->rawValue().toBool()) {
+        return;
+    }
 
+    // Skip the placeholder path MissionController uses for an empty mission
+    QVariantList path;
+    for (const QVariant& coord: _missionController.waypointPath()) {
+        if (coord.value<QGeoCoordinate>() != QGeoCoordinate(0, 0)) {
+            path.append(coord);
+        }
+    }
+    if (path.count() < 2) {
+        return;
+    }
+
+    FlightMapSettings* mapSettings = settingsManager->flightMapSettings();
+    QString mapType = QStringLiteral("%1 %2").arg(mapSettings->mapProvider()->rawValue().toString(), mapSettings->mapType()->rawValue().toString());
+    QString name    = tr("Mission %1").arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd hh:mm")));
+
+    qCDebug(PlanMasterControllerLog) << "Prefetching tiles along mission" << mapType << path.count();
+    qgcApp()->toolbox()->mapEngineManager()->prefetchCorridor(name, mapType, path, offlineSettings->prefetchCorridorBuffer()->rawValue().toDouble());
+}
+
+void PlanMasterController::loadFromFile(const QString& filename)
+{
     if (filename.isEmpty()) {
         return;
     }
 
-    QFileInfo fileInfo(filename);
-    QFile file(filename);
+    _waitForSaveComplete();
+    _loadFromFileData(_readPlanFile(filename));
+}
+
+void PlanMasterController::loadFromFileAsync(const QString& filename)
+{
+    if (filename.isEmpty() || _loadInProgress) {
+        return;
+    }
+
+    _waitForSaveComplete();
+
+    _loadInProgress = true;
+    emit fileIOInProgressChanged(true);
+    _loadWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_readPlanFile, filename));
+}
 
+void PlanMasterController::_loadFromFileReadComplete(void)
+{
+    if (!_loadInProgress) {
+        return;
+    }
+
+    _loadInProgress = false;
+    emit fileIOInProgressChanged(fileIOInProgress());
+
+    _loadFromFileData(_loadWatcher.result());
+    emit loadFromFileAsyncComplete();
+}
+
+/// Reads the file and parses it if it is a .plan file. Called on a worker thread for loadFromFileAsync.
+PlanMasterController::PlanFileData_t PlanMasterController::_readPlanFile(const QString& filename)
+{
+    PlanFileData_t fileData;
+
+    fileData.filename = filename;
+
+    QFile file(filename);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        errorString = file.errorString() + QStringLiteral(" ") + filename;
-        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+        fileData.errorString = file.errorString() + QStringLiteral(" ") + filename;
+        return fileData;
+    }
+    fileData.bytes = file.readAll();
+
+    QString suffix = QFileInfo(filename).suffix();
+    if (suffix != AppSettings::missionFileExtension && suffix != AppSettings::waypointsFileExtension && suffix != QStringLiteral("txt")) {
+        JsonHelper::isJsonFile(fileData.bytes, fileData.jsonDoc, fileData.errorString);
+        fileData.bytes.clear();
+    }
+
+    return fileData;
+}
+
+void PlanMasterController::_loadFromFileData(const PlanFileData_t& fileData)
+{
+    QString errorString;
+    QString errorMessage = tr("Error loading Plan file (%1). %2").arg(fileData.filename).arg("%1");
+
+    if (!fileData.errorString.isEmpty()) {
+        qgcApp()->showAppMessage(errorMessage.arg(fileData.errorString));
         return;
     }
 
+    QFileInfo fileInfo(fileData.filename);
+    QBuffer buffer;
+    buffer.setData(fileData.bytes);
+    buffer.open(QIODevice::ReadOnly);
+
     bool success = false;
     if (fileInfo.suffix() == AppSettings::missionFileExtension) {
-        if (!_missionController.loadJsonFile(file, errorString)) {
+        if (!_missionController.loadJsonFile(buffer, errorString)) {
             qgcApp()->showAppMessage(errorMessage.arg(errorString));
         } else {
             success = true;
         }
     } else if (fileInfo.suffix() == AppSettings::waypointsFileExtension || fileInfo.suffix() == QStringLiteral("txt")) {
-        if (!_missionController.loadTextFile(file, errorString)) {
+        if (!_missionController.loadTextFile(buffer, errorString)) {
             qgcApp()->showAppMessage(errorMessage.arg(errorString));
         } else {
             success = true;
         }
     } else {
-        QJsonDocument   jsonDoc;
-        QByteArray      bytes = file.readAll();
-
-        if (!JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
-
-        QJsonObject json = jsonDoc.object();
+        QJsonObject json = fileData.jsonDoc.object();
         //-- Allow plugins to pre process the load
         qgcApp()->toolbox()->corePlugin()->preLoadFromJson(this, json);
 
@@ -531,19 +621,17 @@ void PlanMasterController::saveToFile(const QString& filename)
         planFilename += QString(".%1").arg(fileExtension());
     }
 
-    QFile file(planFilename);
+    // The json is built here since it comes from the plan items, turning it into text and writing it can be done in
+    // the background. Failures are reported once the write completes.
+    _waitForSaveComplete();
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(filename).arg(file.errorString()));
-        _currentPlanFile.clear();
+    _saveInProgress = true;
+    emit fileIOInProgressChanged(true);
+    _saveWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_writePlanFile, planFilename, saveToJson()));
+
+    if(_currentPlanFile != planFilename) {
+        _currentPlanFile = planFilename;
         emit currentPlanFileChanged();
-    } else {
-        QJsonDocument saveDoc = saveToJson();
-        file.write(saveDoc.toJson());
-        if(_currentPlanFile != planFilename) {
-            _currentPlanFile = planFilename;
-            emit currentPlanFileChanged();
-        }
     }
 
     // Only clear dirty bit if we are offline
@@ -552,6 +640,54 @@ void PlanMasterController::saveToFile(const QString& filename)
     }
 }
 
+/// Called on a worker thread
+PlanMasterController::PlanFileWriteResult_t PlanMasterController::_writePlanFile(const QString& filename, const QJsonDocument& jsonDoc)
+{
+    PlanFileWriteResult_t result;
+
+    result.filename = filename;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        result.errorString = file.errorString();
+    } else {
+        const QByteArray bytes = jsonDoc.toJson();
+        if (file.write(bytes) != bytes.size()) {
+            result.errorString = file.errorString();
+        }
+    }
+
+    return result;
+}
+
+void PlanMasterController::_saveToFileWriteComplete(void)
+{
+    if (!_saveInProgress) {
+        return;
+    }
+
+    _saveInProgress = false;
+    emit fileIOInProgressChanged(fileIOInProgress());
+
+    PlanFileWriteResult_t result = _saveWatcher.result();
+    if (!result.errorString.isEmpty()) {
+        qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(result.filename).arg(result.errorString));
+        if (_currentPlanFile == result.filename) {
+            _currentPlanFile.clear();
+            emit currentPlanFileChanged();
+        }
+    }
+}
+
+/// Makes sure a previous save has been written before the plan file is used again
+void PlanMasterController::_waitForSaveComplete(void)
+{
+    if (_saveInProgress) {
+        _saveWatcher.waitForFinished();
+        _saveToFileWriteComplete();
+    }
+}
+
 void PlanMasterController::saveToKml(const QString& filename)
 {
     if (filename.isEmpty()) {
@@ -563,16 +699,44 @@ void PlanMasterController::saveToKml(const QString& filename)
         kmlFilename += QString(".%1").arg(kmlFileExtension());
     }
 
-    QFile file(kmlFilename);
+    // The plan is captured here since it comes from the plan items. The xml is streamed to the file in the background
+    // so large survey plans neither block the ui nor build up the whole document in memory.
+    if (_kmlSaveInProgress) {
+        _kmlSaveWatcher.waitForFinished();
+        _saveToKmlWriteComplete();
+    }
+
+    KMLPlanStreamWriter kmlWriter;
+    _missionController.addMissionToKML(kmlWriter);
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qgcApp()->showAppMessage(tr("KML save error %1 : %2").arg(filename).arg(file.errorString()));
-    } else {
-        KMLPlanDomDocument planKML;
-        _missionController.addMissionToKML(planKML);
-        QTextStream stream(&file);
-        stream << planKML.toString();
-        file.close();
+    _kmlSaveInProgress = true;
+    emit fileIOInProgressChanged(true);
+    _kmlSaveWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_writeKmlFile, kmlFilename, kmlWriter));
+}
+
+/// Called on a worker thread
+PlanMasterController::PlanFileWriteResult_t PlanMasterController::_writeKmlFile(const QString& filename, const KMLPlanStreamWriter& kmlWriter)
+{
+    PlanFileWriteResult_t result;
+
+    result.filename = filename;
+    kmlWriter.writeFile(filename, result.errorString);
+
+    return result;
+}
+
+void PlanMasterController::_saveToKmlWriteComplete(void)
+{
+    if (!_kmlSaveInProgress) {
+        return;
+    }
+
+    _kmlSaveInProgress = false;
+    emit fileIOInProgressChanged(fileIOInProgress());
+
+    PlanFileWriteResult_t result = _kmlSaveWatcher.result();
+    if (!result.errorString.isEmpty()) {
+        qgcApp()->showAppMessage(tr("KML save error %1 : %2").arg(result.filename).arg(result.errorString));
     }
 }
 
@@ -10,11 +10,14 @@
 #pragma once
 
 #include <QObject>
+#include <QFutureWatcher>
+#include <QJsonDocument>
 
 #include "MissionController.h"
 #include "GeoFenceController.h"
 #include "ObstacleController.h"
 #include "RallyPointController.h"
+#include "PlanFleetUploader.h"
 #include "Vehicle.h"
 #include "MultiVehicleManager.h"
 #include "QGCLoggingCategory.h"
@@ -43,6 +46,7 @@ public:
     Q_PROPERTY(GeoFenceController*      geoFenceController      READ geoFenceController                     CONSTANT)
     Q_PROPERTY(ObstacleController*      obstacleController      READ obstacleController                     CONSTANT)
     Q_PROPERTY(RallyPointController*    rallyPointController    READ rallyPointController                   CONSTANT)
+    Q_PROPERTY(PlanFleetUploader*       fleetUploader           READ fleetUploader                          CONSTANT)                       ///< Uploads the plan to several vehicles at once
     Q_PROPERTY(bool                     offline                 READ offline                                NOTIFY offlineChanged)          ///< true: controller is not connected to an active vehicle
     Q_PROPERTY(bool                     containsItems           READ containsItems                          NOTIFY containsItemsChanged)    ///< true: Elemement is non-empty
     Q_PROPERTY(bool                     syncInProgress          READ syncInProgress                         NOTIFY syncInProgressChanged)   ///< true: Information is currently being saved/sent, false: no active save/send in progress
@@ -53,6 +57,7 @@ public:
     Q_PROPERTY(QStringList              loadNameFilters         READ loadNameFilters                        CONSTANT)                       ///< File filter list loading plan files
     Q_PROPERTY(QStringList              saveNameFilters         READ saveNameFilters                        CONSTANT)                       ///< File filter list saving plan files
     Q_PROPERTY(QmlObjectListModel*      planCreators            MEMBER _planCreators                        NOTIFY planCreatorsChanged)
+    Q_PROPERTY(bool                     fileIOInProgress        READ fileIOInProgress                       NOTIFY fileIOInProgressChanged) ///< true: A plan or KML file is being read or written in the background
 
     /// Should be called immediately upon Component.onCompleted.
     Q_INVOKABLE void start(void);
@@ -77,8 +82,16 @@ public:
     Q_INVOKABLE void loadFromVehicle(void);
     Q_INVOKABLE void sendToVehicle(void);
     Q_INVOKABLE void loadFromFile(const QString& filename);
+
+    /// Same as loadFromFile, but the file is read and parsed on a worker thread. Only creating the plan items from the
+    /// parsed file is done on the calling thread. Ignored if a load is already in progress.
+    Q_INVOKABLE void loadFromFileAsync(const QString& filename);
+
+    /// Saves the plan. The plan is converted to json immediately, formatting and writing the file is done on a worker
+    /// thread. A following save or load waits for the write to finish.
     Q_INVOKABLE void saveToCurrent();
     Q_INVOKABLE void saveToFile(const QString& filename);
+    /// Saves the plan as KML in the background, as a KMZ archive if the filename has a .kmz extension
     Q_INVOKABLE void saveToKml(const QString& filename);
     Q_INVOKABLE void removeAll(void);                       ///< Removes all from controller only, synce required to remove from vehicle
     Q_INVOKABLE void removeAllFromVehicle(void);            ///< Removes all from vehicle and controller
@@ -87,6 +100,7 @@ public:
     GeoFenceController*     geoFenceController(void)    { return &_geoFenceController; }
     ObstacleController*     obstacleController(void)    { return &_obstacleController; }
     RallyPointController*   rallyPointController(void)  { return &_rallyPointController; }
+    PlanFleetUploader*      fleetUploader       (void)  { return &_fleetUploader; }
 
     bool        offline         (void) const { return _offline; }
     bool        containsItems   (void) const;
@@ -99,6 +113,7 @@ public:
     QStringList loadNameFilters (void) const;
     QStringList saveNameFilters (void) const;
     bool        isEmpty         (void) const;
+    bool        fileIOInProgress(void) const { return _loadInProgress || _saveInProgress || _kmlSaveInProgress; }
 
     void        setFlyView(bool flyView) { _flyView = flyView; }
 
@@ -123,6 +138,8 @@ signals:
     void planCreatorsChanged                (QmlObjectListModel* planCreators);
     void managerVehicleChanged              (Vehicle* managerVehicle);
     void promptForPlanUsageOnVehicleChange  (void);
+    void fileIOInProgressChanged            (bool fileIOInProgress);
+    void loadFromFileAsyncComplete          (void);
 
 private slots:
     void _activeVehicleChanged      (Vehicle* activeVehicle);
@@ -135,13 +152,35 @@ private slots:
     void _sendObstacleComplete      (void);
     void _sendRallyPointsComplete   (void);
     void _updatePlanCreatorsList    (void);
+    void _loadFromFileReadComplete  (void);
+    void _saveToFileWriteComplete   (void);
+    void _saveToKmlWriteComplete    (void);
 #if defined(QGC_AIRMAP_ENABLED)
     void _startFlightPlanning       (void);
 #endif
 
 private:
+    typedef struct {
+        QString         filename;
+        QByteArray      bytes;
+        QJsonDocument   jsonDoc;        ///< Only set for .plan files
+        QString         errorString;    ///< Set if the file could not be read or parsed
+    } PlanFileData_t;
+
+    typedef struct {
+        QString filename;
+        QString errorString;            ///< Set if the file could not be written
+    } PlanFileWriteResult_t;
+
     void _commonInit                (void);
     void _showPlanFromManagerVehicle(void);
+    void _loadFromFileData          (const PlanFileData_t& fileData);
+    void _waitForSaveComplete       (void);
+    void _prefetchMissionTiles      (void);
+
+    static PlanFileData_t           _readPlanFile   (const QString& filename);
+    static PlanFileWriteResult_t    _writePlanFile  (const QString& filename, const QJsonDocument& jsonDoc);
+    static PlanFileWriteResult_t    _writeKmlFile   (const QString& filename, const KMLPlanStreamWriter& kmlWriter);
 
     MultiVehicleManager*    _multiVehicleMgr =          nullptr;
     Vehicle*                _controllerVehicle =        nullptr;    ///< Offline controller vehicle
@@ -152,6 +191,7 @@ private:
     GeoFenceController      _geoFenceController;
     ObstacleController      _obstacleController;
     RallyPointController    _rallyPointController;
+    PlanFleetUploader       _fleetUploader;
     bool                    _loadGeoFence =             false;
     bool                    _loadObstacle =             false;
     bool                    _loadRallyPoints =          false;
@@ -161,4 +201,11 @@ private:
     QString                 _currentPlanFile;
     bool                    _deleteWhenSendCompleted =  false;
     QmlObjectListModel*     _planCreators =             nullptr;
+    bool                    _loadInProgress =           false;
+    bool                    _saveInProgress =           false;
+    bool                    _kmlSaveInProgress =        false;
+
+    QFutureWatcher<PlanFileData_t>          _loadWatcher;
+    QFutureWatcher<PlanFileWriteResult_t>   _saveWatcher;
+    QFutureWatcher<PlanFileWriteResult_t>   _kmlSaveWatcher;
 };
@@ -52,6 +52,20 @@ void PlanMasterControllerTest::_testMissionPlannerFileLoad(void)
     QCOMPARE(_masterController->missionController()->visualItems()->count(), 6);
 }
 
+void PlanMasterControllerTest::_testPlanFileLoadAsync(void)
+{
+    _masterController->loadFromFile(":/unittest/SectionTest.plan");
+    int syncCount = _masterController->missionController()->visualItems()->count();
+    _masterController->removeAll();
+
+    QSignalSpy completeSpy(_masterController, &PlanMasterController::loadFromFileAsyncComplete);
+    _masterController->loadFromFileAsync(":/unittest/SectionTest.plan");
+    QVERIFY(_masterController->fileIOInProgress());
+    QVERIFY(completeSpy.wait(5000));
+    QVERIFY(!_masterController->fileIOInProgress());
+    QCOMPARE(_masterController->missionController()->visualItems()->count(), syncCount);
+}
+
 void PlanMasterControllerTest::_testActiveVehicleChanged(void) {
     // There was a defect where the PlanMasterController would, upon a new active vehicle,
     // overzelously disconnect all subscribers interested in the outgoing active vechicle.
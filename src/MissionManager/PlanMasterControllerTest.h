@@ -33,6 +33,7 @@ private slots:
 
     void _testMissionFileLoad(void);
     void _testMissionPlannerFileLoad(void);
+    void _testPlanFileLoadAsync(void);
     void _testActiveVehicleChanged(void);
 
 private:
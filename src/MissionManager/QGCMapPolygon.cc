@@ -14,6 +14,7 @@
 #include "QGCApplication.h"
 #include "ShapeFileHelper.h"
 #include "QGCLoggingCategory.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -21,6 +22,7 @@
 #include <QLineF>
 #include <QFile>
 #include <QDomDocument>
+#include <QFutureWatcher>
 
 const char* QGCMapPolygon::jsonPolygonKey = "polygon";
 
@@ -51,7 +53,6 @@ QGCMapPolygon::QGCMapPolygon(const QGCMapPolygon& other, QObject* parent)
 void QGCMapPolygon::_init(void)
 {
     connect(&_polygonModel, &QmlObjectListModel::dirtyChanged, this, &QGCMapPolygon::_polygonModelDirtyChanged);
-    connect(&_polygonModel, &QmlObjectListModel::countChanged, this, &QGCMapPolygon::_polygonModelCountChanged);
 
     connect(this, &QGCMapPolygon::pathChanged,  this, &QGCMapPolygon::_updateCenter);
     connect(this, &QGCMapPolygon::countChanged, this, &QGCMapPolygon::isValidChanged);
@@ -61,13 +62,7 @@ void QGCMapPolygon::_init(void)
 const QGCMapPolygon& QGCMapPolygon::operator=(const QGCMapPolygon& other)
 {
     clear();
-
-    QVariantList vertices = other.path();
-    QList<QGeoCoordinate> rgCoord;
-    for (const QVariant& vertexVar: vertices) {
-        rgCoord.append(vertexVar.value<QGeoCoordinate>());
-    }
-    appendVertices(rgCoord);
+    appendVertices(other.coordinateList());
 
     setDirty(true);
 
@@ -76,9 +71,12 @@ const QGCMapPolygon& QGCMapPolygon::operator=(const QGCMapPolygon& other)
 
 void QGCMapPolygon::clear(void)
 {
+    const int oldCount = _vertices.count();
+
     // Bug workaround, see below
-    while (_polygonPath.count() > 1) {
-        _polygonPath.takeLast();
+    if (_vertices.count() > 1) {
+        _vertices.resize(1);
+        _verticesChanged(_vertices.count());
     }
     emit pathChanged();
 
@@ -86,7 +84,8 @@ void QGCMapPolygon::clear(void)
     // to be a bug in QGCMapPolygon which causes it to not be redrawn if the list is empty. So
     // we work around it by using the code above to remove all but the last point which in turn
     // will cause the polygon to go away.
-    _polygonPath.clear();
+    _vertices.clear();
+    _verticesChanged(oldCount);
 
     _polygonModel.clearAndDeleteContents();
 
@@ -95,10 +94,82 @@ void QGCMapPolygon::clear(void)
     setDirty(true);
 }
 
+/// Drops everything derived from the vertices, must be called after each change to _vertices
+void QGCMapPolygon::_verticesChanged(int oldCount)
+{
+    _pathValid          = false;
+    _nedValid           = false;
+    _containsIndexValid = false;
+    if (_vertices.count() != oldCount) {
+        emit countChanged(_vertices.count());
+    }
+}
+
+void QGCMapPolygon::_activateModel(void)
+{
+    if (_modelActive) {
+        return;
+    }
+
+    QList<QObject*> objects;
+    objects.reserve(_vertices.count());
+    for (const QGeoCoordinate& coordinate: _vertices) {
+        objects.append(new QGCQGeoCoordinate(coordinate, this));
+    }
+    _polygonModel.append(objects);
+    _polygonModel.setDirty(false);
+    _modelActive = true;
+}
+
+void QGCMapPolygon::_deactivateModel(void)
+{
+    if (_modelActive) {
+        _modelActive = false;
+        _polygonModel.clearAndDeleteContents();
+        _polygonModel.setDirty(false);
+    }
+}
+
+QVariantList QGCMapPolygon::path(void) const
+{
+    if (!_pathValid) {
+        _path.clear();
+        _path.reserve(_vertices.count());
+        for (const QGeoCoordinate& coordinate: _vertices) {
+            _path.append(QVariant::fromValue(coordinate));
+        }
+        _pathValid = true;
+    }
+    return _path;
+}
+
+const QVector<QPointF>& QGCMapPolygon::_nedVertices(void) const
+{
+    if (!_nedValid) {
+        _ned.clear();
+        if (_vertices.count() > 0) {
+            LocalTangentFrame frame(_vertices[0]);
+            _ned.reserve(_vertices.count());
+            // First vertex is the origin, this also avoids a nan calculation that comes out of convertGeoToNed
+            _ned.append(QPointF(0, 0));
+            for (int i=1; i<_vertices.count(); i++) {
+                double y, x;
+                frame.toNed(_vertices[i], &y, &x, nullptr);
+                _ned.append(QPointF(x, y));
+            }
+        }
+        _nedValid = true;
+    }
+    return _ned;
+}
+
 void QGCMapPolygon::adjustVertex(int vertexIndex, const QGeoCoordinate coordinate)
 {
-    _polygonPath[vertexIndex] = QVariant::fromValue(coordinate);
-    _polygonModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
+    _vertices[vertexIndex] = coordinate;
+    _verticesChanged(_vertices.count());
+    if (_modelActive) {
+        _polygonModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
+    }
     if (!_centerDrag) {
         // When dragging center we don't signal path changed until all vertices are updated
         emit pathChanged();
@@ -110,7 +181,7 @@ void QGCMapPolygon::setDirty(bool dirty)
 {
     if (_dirty != dirty) {
         _dirty = dirty;
-        if (!dirty) {
+        if (!dirty && _modelActive) {
             _polygonModel.setDirty(false);
         }
         emit dirtyChanged(dirty);
@@ -121,9 +192,8 @@ QGeoCoordinate QGCMapPolygon::_coordFromPointF(const QPointF& point) const
 {
     QGeoCoordinate coord;
 
-    if (_polygonPath.count() > 0) {
-        QGeoCoordinate tangentOrigin = _polygonPath[0].value<QGeoCoordinate>();
-        convertNedToGeo(-point.y(), point.x(), 0, tangentOrigin, &coord);
+    if (_vertices.count() > 0) {
+        convertNedToGeo(-point.y(), point.x(), 0, _vertices[0], &coord);
     }
 
     return coord;
@@ -131,11 +201,10 @@ QGeoCoordinate QGCMapPolygon::_coordFromPointF(const QPointF& point) const
 
 QPointF QGCMapPolygon::_pointFFromCoord(const QGeoCoordinate& coordinate) const
 {
-    if (_polygonPath.count() > 0) {
+    if (_vertices.count() > 0) {
         double y, x, down;
-        QGeoCoordinate tangentOrigin = _polygonPath[0].value<QGeoCoordinate>();
 
-        convertGeoToNed(coordinate, tangentOrigin, &y, &x, &down);
+        convertGeoToNed(coordinate, _vertices[0], &y, &x, &down);
         return QPointF(x, -y);
     }
 
@@ -146,31 +215,94 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
 {
     QPolygonF polygon;
 
-    if (_polygonPath.count() > 2) {
-        for (int i=0; i<_polygonPath.count(); i++) {
-            polygon.append(_pointFFromCoord(_polygonPath[i].value<QGeoCoordinate>()));
+    if (_vertices.count() > 2) {
+        const QVector<QPointF>& ned = _nedVertices();
+        polygon.reserve(ned.count());
+        for (const QPointF& point: ned) {
+            polygon.append(QPointF(point.x(), -point.y()));
         }
     }
 
     return polygon;
 }
 
+void QGCMapPolygon::_buildContainsIndex(void) const
+{
+    const QPolygonF polygon = _toPolygonF();
+
+    _containsBounds = polygon.boundingRect();
+    _containsEdges.clear();
+    _containsEdges.reserve(polygon.count());
+    for (int i=0; i<polygon.count(); i++) {
+        const QPointF& p1 = polygon[i];
+        const QPointF& p2 = polygon[(i + 1) % polygon.count()];
+        if (p1.y() != p2.y()) {
+            // Horizontal edges never cross the ray
+            _containsEdges.append(QLineF(p1, p2));
+        }
+    }
+
+    const int bandCount = qBound(1, _containsEdges.count() / _containsEdgesPerBand, _containsMaxBands);
+    const double bandHeight = _containsBounds.height() / bandCount;
+    _containsBands = QVector<QVector<int>>(bandCount);
+    for (int i=0; i<_containsEdges.count(); i++) {
+        const QLineF& edge = _containsEdges[i];
+        const double minY = qMin(edge.y1(), edge.y2());
+        const double maxY = qMax(edge.y1(), edge.y2());
+        const int firstBand = qBound(0, static_cast<int>((minY - _containsBounds.top()) / bandHeight), bandCount - 1);
+        const int lastBand  = qBound(0, static_cast<int>((maxY - _containsBounds.top()) / bandHeight), bandCount - 1);
+        for (int band=firstBand; band<=lastBand; band++) {
+            _containsBands[band].append(i);
+        }
+    }
+
+    _containsIndexValid = true;
+}
+
 bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
 {
-    if (_polygonPath.count() > 2) {
-        return _toPolygonF().containsPoint(_pointFFromCoord(coordinate), Qt::OddEvenFill);
-    } else {
+    if (_vertices.count() <= 2) {
+        return false;
+    }
+
+    if (!_containsIndexValid) {
+        _buildContainsIndex();
+    }
+
+    const QPointF point = _pointFFromCoord(coordinate);
+    if (!_containsBounds.contains(point) || _containsBounds.height() <= 0) {
         return false;
     }
+
+    const int bandCount = _containsBands.count();
+    const int band = qBound(0, static_cast<int>((point.y() - _containsBounds.top()) / (_containsBounds.height() / bandCount)), bandCount - 1);
+
+    // Odd/even ray cast towards +x over the edges of the band
+    bool inside = false;
+    for (int edgeIndex: _containsBands[band]) {
+        const QLineF& edge = _containsEdges[edgeIndex];
+        if ((edge.y1() > point.y()) != (edge.y2() > point.y())) {
+            const double crossX = edge.x1() + ((point.y() - edge.y1()) * (edge.x2() - edge.x1()) / (edge.y2() - edge.y1()));
+            if (crossX > point.x()) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
 }
 
 void QGCMapPolygon::setPath(const QList<QGeoCoordinate>& path)
 {
-    _polygonPath.clear();
-    _polygonModel.clearAndDeleteContents();
-    for(const QGeoCoordinate& coord: path) {
-        _polygonPath.append(QVariant::fromValue(coord));
-        _polygonModel.append(new QGCQGeoCoordinate(coord, this));
+    const int oldCount = _vertices.count();
+
+    _vertices = path.toVector();
+    _verticesChanged(oldCount);
+    if (_modelActive) {
+        _polygonModel.clearAndDeleteContents();
+        for (const QGeoCoordinate& coord: path) {
+            _polygonModel.append(new QGCQGeoCoordinate(coord, this));
+        }
     }
 
     setDirty(true);
@@ -179,22 +311,19 @@ void QGCMapPolygon::setPath(const QList<QGeoCoordinate>& path)
 
 void QGCMapPolygon::setPath(const QVariantList& path)
 {
-    _polygonPath = path;
-
-    _polygonModel.clearAndDeleteContents();
-    for (int i=0; i<_polygonPath.count(); i++) {
-        _polygonModel.append(new QGCQGeoCoordinate(_polygonPath[i].value<QGeoCoordinate>(), this));
+    QList<QGeoCoordinate> coords;
+    coords.reserve(path.count());
+    for (const QVariant& varCoord: path) {
+        coords.append(varCoord.value<QGeoCoordinate>());
     }
-
-    setDirty(true);
-    emit pathChanged();
+    setPath(coords);
 }
 
 void QGCMapPolygon::saveToJson(QJsonObject& json)
 {
     QJsonValue jsonValue;
 
-    JsonHelper::saveGeoCoordinateArray(_polygonPath, false /* writeAltitude*/, jsonValue);
+    JsonHelper::saveGeoCoordinateArray(path(), false /* writeAltitude*/, jsonValue);
     json.insert(jsonPolygonKey, jsonValue);
     setDirty(false);
 }
@@ -212,12 +341,19 @@ bool QGCMapPolygon::loadFromJson(const QJsonObject& json, bool required, QString
         return true;
     }
 
-    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolygonKey], false /* altitudeRequired */, _polygonPath, errorString)) {
+    QVariantList jsonPath;
+    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolygonKey], false /* altitudeRequired */, jsonPath, errorString)) {
         return false;
     }
 
-    for (int i=0; i<_polygonPath.count(); i++) {
-        _polygonModel.append(new QGCQGeoCoordinate(_polygonPath[i].value<QGeoCoordinate>(), this));
+    for (const QVariant& varCoord: jsonPath) {
+        _vertices.append(varCoord.value<QGeoCoordinate>());
+    }
+    _verticesChanged(0);
+    if (_modelActive) {
+        for (const QGeoCoordinate& coord: _vertices) {
+            _polygonModel.append(new QGCQGeoCoordinate(coord, this));
+        }
     }
 
     setDirty(false);
@@ -228,24 +364,18 @@ bool QGCMapPolygon::loadFromJson(const QJsonObject& json, bool required, QString
 
 QList<QGeoCoordinate> QGCMapPolygon::coordinateList(void) const
 {
-    QList<QGeoCoordinate> coords;
-
-    for (int i=0; i<_polygonPath.count(); i++) {
-        coords.append(_polygonPath[i].value<QGeoCoordinate>());
-    }
-
-    return coords;
+    return _vertices.toList();
 }
 
 void QGCMapPolygon::splitPolygonSegment(int vertexIndex)
 {
     int nextIndex = vertexIndex + 1;
-    if (nextIndex > _polygonPath.length() - 1) {
+    if (nextIndex > _vertices.count() - 1) {
         nextIndex = 0;
     }
 
-    QGeoCoordinate firstVertex = _polygonPath[vertexIndex].value<QGeoCoordinate>();
-    QGeoCoordinate nextVertex = _polygonPath[nextIndex].value<QGeoCoordinate>();
+    QGeoCoordinate firstVertex = _vertices[vertexIndex];
+    QGeoCoordinate nextVertex = _vertices[nextIndex];
 
     double distance = firstVertex.distanceTo(nextVertex);
     double azimuth = firstVertex.azimuthTo(nextVertex);
@@ -254,8 +384,12 @@ void QGCMapPolygon::splitPolygonSegment(int vertexIndex)
     if (nextIndex == 0) {
         appendVertex(newVertex);
     } else {
-        _polygonModel.insert(nextIndex, new QGCQGeoCoordinate(newVertex, this));
-        _polygonPath.insert(nextIndex, QVariant::fromValue(newVertex));
+        _vertices.insert(nextIndex, newVertex);
+        _verticesChanged(_vertices.count() - 1);
+        if (_modelActive) {
+            _polygonModel.insert(nextIndex, new QGCQGeoCoordinate(newVertex, this));
+        }
+        setDirty(true);
         emit pathChanged();
         if (0 <= _selectedVertexIndex && vertexIndex < _selectedVertexIndex) {
             selectVertex(_selectedVertexIndex+1);
@@ -265,22 +399,39 @@ void QGCMapPolygon::splitPolygonSegment(int vertexIndex)
 
 void QGCMapPolygon::appendVertex(const QGeoCoordinate& coordinate)
 {
-    _polygonPath.append(QVariant::fromValue(coordinate));
-    _polygonModel.append(new QGCQGeoCoordinate(coordinate, this));
+    _vertices.append(coordinate);
+    _verticesChanged(_vertices.count() - 1);
+    if (_modelActive) {
+        _polygonModel.append(new QGCQGeoCoordinate(coordinate, this));
+    }
+    setDirty(true);
     emit pathChanged();
 }
 
 void QGCMapPolygon::appendVertices(const QList<QGeoCoordinate>& coordinates)
 {
-    QList<QObject*> objects;
+    if (coordinates.isEmpty()) {
+        emit pathChanged();
+        return;
+    }
+
+    const int oldCount = _vertices.count();
 
     _beginResetIfNotActive();
+    _vertices.reserve(_vertices.count() + coordinates.count());
     for (const QGeoCoordinate& coordinate: coordinates) {
-        objects.append(new QGCQGeoCoordinate(coordinate, this));
-        _polygonPath.append(QVariant::fromValue(coordinate));
+        _vertices.append(coordinate);
+    }
+    _verticesChanged(oldCount);
+    if (_modelActive) {
+        QList<QObject*> objects;
+        for (const QGeoCoordinate& coordinate: coordinates) {
+            objects.append(new QGCQGeoCoordinate(coordinate, this));
+        }
+        _polygonModel.append(objects);
     }
-    _polygonModel.append(objects);
     _endResetIfNotActive();
+    setDirty(true);
 
     emit pathChanged();
 }
@@ -296,46 +447,46 @@ void QGCMapPolygon::appendVertices(const QVariantList& varCoords)
 
 void QGCMapPolygon::_polygonModelDirtyChanged(bool dirty)
 {
-    if (dirty) {
+    // Populating the model is not a change to the polygon
+    if (dirty && _modelActive) {
         setDirty(true);
     }
 }
 
 void QGCMapPolygon::removeVertex(int vertexIndex)
 {
-    if (vertexIndex < 0 && vertexIndex > _polygonPath.length() - 1) {
-        qWarning() << "Call to removePolygonCoordinate with bad vertexIndex:count" << vertexIndex << _polygonPath.length();
+    if (vertexIndex < 0 && vertexIndex > _vertices.count() - 1) {
+        qWarning() << "Call to removePolygonCoordinate with bad vertexIndex:count" << vertexIndex << _vertices.count();
         return;
     }
 
-    if (_polygonPath.length() <= 3) {
+    if (_vertices.count() <= 3) {
         // Don't allow the user to trash the polygon
         return;
     }
 
-    QObject* coordObj = _polygonModel.removeAt(vertexIndex);
-    coordObj->deleteLater();
+    if (_modelActive) {
+        QObject* coordObj = _polygonModel.removeAt(vertexIndex);
+        coordObj->deleteLater();
+    }
+    _vertices.removeAt(vertexIndex);
+    _verticesChanged(_vertices.count() + 1);
     if(vertexIndex == _selectedVertexIndex) {
         selectVertex(-1);
     } else if (vertexIndex < _selectedVertexIndex) {
         selectVertex(_selectedVertexIndex - 1);
     } // else do nothing - keep current selected vertex
 
-    _polygonPath.removeAt(vertexIndex);
+    setDirty(true);
     emit pathChanged();
 }
 
-void QGCMapPolygon::_polygonModelCountChanged(int count)
-{
-    emit countChanged(count);
-}
-
 void QGCMapPolygon::_updateCenter(void)
 {
     if (!_ignoreCenterUpdates) {
         QGeoCoordinate center;
 
-        if (_polygonPath.count() > 2) {
+        if (_vertices.count() > 2) {
             QPointF centroid(0, 0);
             QPolygonF polygonF = _toPolygonF();
             for (int i=0; i<polygonF.count(); i++) {
@@ -360,8 +511,7 @@ void QGCMapPolygon::setCenter(QGeoCoordinate newCenter)
         double azimuth = _center.azimuthTo(newCenter);
 
         for (int i=0; i<count(); i++) {
-            QGeoCoordinate oldVertex = _polygonPath[i].value<QGeoCoordinate>();
-            QGeoCoordinate newVertex = oldVertex.atDistanceAndAzimuth(distance, azimuth);
+            QGeoCoordinate newVertex = _vertices[i].atDistanceAndAzimuth(distance, azimuth);
             adjustVertex(i, newVertex);
         }
 
@@ -390,40 +540,26 @@ void QGCMapPolygon::setInteractive(bool interactive)
     if (_interactive != interactive) {
         _interactive = interactive;
         emit interactiveChanged(interactive);
+        if (!interactive) {
+            // Drag handles are gone, the next pathModel user populates it again
+            _deactivateModel();
+        }
     }
 }
 
 QGeoCoordinate QGCMapPolygon::vertexCoordinate(int vertex) const
 {
-    if (vertex >= 0 && vertex < _polygonPath.count()) {
-        return _polygonPath[vertex].value<QGeoCoordinate>();
+    if (vertex >= 0 && vertex < _vertices.count()) {
+        return _vertices[vertex];
     } else {
-        qWarning() << "QGCMapPolygon::vertexCoordinate bad vertex requested:count" << vertex << _polygonPath.count();
+        qWarning() << "QGCMapPolygon::vertexCoordinate bad vertex requested:count" << vertex << _vertices.count();
         return QGeoCoordinate();
     }
 }
 
 QList<QPointF> QGCMapPolygon::nedPolygon(void) const
 {
-    QList<QPointF>  nedPolygon;
-
-    if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
-
-        for (int i=0; i<_polygonModel.count(); i++) {
-            double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
-            if (i == 0) {
-                // This avoids a nan calculation that comes out of convertGeoToNed
-                x = y = 0;
-            } else {
-                convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-            }
-            nedPolygon += QPointF(x, y);
-        }
-    }
-
-    return nedPolygon;
+    return _nedVertices().toList();
 }
 
 
@@ -434,8 +570,7 @@ void QGCMapPolygon::offset(double distance)
     // I'm sure there is some beautiful famous algorithm to do this, but here is a brute force method
 
     if (count() > 2) {
-        // Convert the polygon to NED
-        QList<QPointF> rgNedVertices = nedPolygon();
+        const QVector<QPointF>& rgNedVertices = _nedVertices();
 
         // Walk the edges, offsetting by the specified distance
         QList<QLineF> rgOffsetEdges;
@@ -459,7 +594,7 @@ void QGCMapPolygon::offset(double distance)
 
         // Intersect the offset edges to generate new vertices
         QPointF         newVertex;
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        LocalTangentFrame frame(vertexCoordinate(0));
         for (int i=0; i<rgOffsetEdges.count(); i++) {
             int prevIndex = i == 0 ? rgOffsetEdges.count() - 1 : i - 1;
             auto intersect = rgOffsetEdges[prevIndex].intersects(rgOffsetEdges[i], &newVertex);
@@ -468,9 +603,7 @@ void QGCMapPolygon::offset(double distance)
                 qWarning("Intersection failed");
                 return;
             }
-            QGeoCoordinate coord;
-            convertNedToGeo(newVertex.y(), newVertex.x(), 0, tangentOrigin, &coord);
-            rgNewPolygon.append(coord);
+            rgNewPolygon.append(frame.fromNed(newVertex.y(), newVertex.x(), 0));
         }
     }
 
@@ -485,14 +618,44 @@ bool QGCMapPolygon::loadKMLOrSHPFile(const QString& file)
 {
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!ShapeFileHelper::loadPolygonFromFile(file, rgCoords, errorString)) {
+    double simplifyToleranceMeters = qgcApp()->toolbox()->settingsManager()->planViewSettings()->shapeImportSimplification()->rawValue().toDouble();
+    bool success = ShapeFileHelper::loadPolygonFromFile(file, rgCoords, errorString, simplifyToleranceMeters);
+
+    return _setLoadedPath(success, rgCoords, errorString);
+}
+
+void QGCMapPolygon::loadKMLOrSHPFileAsync(const QString& file)
+{
+    if (_loading) {
+        return;
+    }
+    _loading = true;
+    emit loadingChanged(true);
+
+    QFutureWatcher<ShapeFileHelper::LoadResult_t>* watcher = new QFutureWatcher<ShapeFileHelper::LoadResult_t>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        const ShapeFileHelper::LoadResult_t result = watcher->result();
+        watcher->deleteLater();
+
+        _loading = false;
+        emit loadingChanged(false);
+        emit loadKMLOrSHPFileComplete(_setLoadedPath(result.success, result.coords, result.errorString));
+    });
+
+    double simplifyToleranceMeters = qgcApp()->toolbox()->settingsManager()->planViewSettings()->shapeImportSimplification()->rawValue().toDouble();
+    watcher->setFuture(ShapeFileHelper::loadPolygonFromFileAsync(file, simplifyToleranceMeters));
+}
+
+bool QGCMapPolygon::_setLoadedPath(bool success, const QList<QGeoCoordinate>& coords, const QString& errorString)
+{
+    if (!success) {
         qgcApp()->showAppMessage(errorString);
         return false;
     }
 
     _beginResetIfNotActive();
     clear();
-    appendVertices(rgCoords);
+    appendVertices(coords);
     _endResetIfNotActive();
 
     return true;
@@ -502,12 +665,12 @@ double QGCMapPolygon::area(void) const
 {
     // https://www.mathopenref.com/coordpolygonarea2.html
 
-    if (_polygonPath.count() < 3) {
+    if (_vertices.count() < 3) {
         return 0;
     }
 
     double coveredArea = 0.0;
-    QList<QPointF> nedVertices = nedPolygon();
+    const QVector<QPointF>& nedVertices = _nedVertices();
     for (int i=0; i<nedVertices.count(); i++) {
         if (i != 0) {
             coveredArea += nedVertices[i - 1].x() * nedVertices[i].y() - nedVertices[i].x() * nedVertices[i -1].y();
@@ -520,14 +683,14 @@ double QGCMapPolygon::area(void) const
 
 void QGCMapPolygon::verifyClockwiseWinding(void)
 {
-    if (_polygonPath.count() <= 2) {
+    if (_vertices.count() <= 2) {
         return;
     }
 
     double sum = 0;
-    for (int i=0; i<_polygonPath.count(); i++) {
-        QGeoCoordinate coord1 = _polygonPath[i].value<QGeoCoordinate>();
-        QGeoCoordinate coord2 = (i == _polygonPath.count() - 1) ? _polygonPath[0].value<QGeoCoordinate>() : _polygonPath[i+1].value<QGeoCoordinate>();
+    for (int i=0; i<_vertices.count(); i++) {
+        const QGeoCoordinate& coord1 = _vertices[i];
+        const QGeoCoordinate& coord2 = (i == _vertices.count() - 1) ? _vertices[0] : _vertices[i+1];
 
         sum += (coord2.longitude() - coord1.longitude()) * (coord2.latitude() + coord1.latitude());
     }
@@ -536,8 +699,9 @@ void QGCMapPolygon::verifyClockwiseWinding(void)
         // Winding is counter-clockwise and needs reversal
 
         QList<QGeoCoordinate> rgReversed;
-        for (const QVariant& varCoord: _polygonPath) {
-            rgReversed.prepend(varCoord.value<QGeoCoordinate>());
+        rgReversed.reserve(_vertices.count());
+        for (int i=_vertices.count() - 1; i>=0; i--) {
+            rgReversed.append(_vertices[i]);
         }
 
         _beginResetIfNotActive();
@@ -609,10 +773,10 @@ QDomElement QGCMapPolygon::kmlPolygonElement(KMLDomDocument& domDocument)
     polygonElement.appendChild(outerBoundaryIsElement);
 
     QString coordString;
-    for (const QVariant& varCoord : _polygonPath) {
-        coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(varCoord.value<QGeoCoordinate>()));
+    for (const QGeoCoordinate& coord : _vertices) {
+        coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(coord));
     }
-    coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(_polygonPath.first().value<QGeoCoordinate>()));
+    coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(_vertices.first()));
     domDocument.addTextElement(linearRingElement, "coordinates", coordString);
 
     return polygonElement;
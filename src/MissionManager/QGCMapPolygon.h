@@ -14,12 +14,20 @@
 #include <QGeoCoordinate>
 #include <QVariantList>
 #include <QPolygon>
+#include <QLineF>
+#include <QRectF>
+#include <QVector>
 
 #include "QmlObjectListModel.h"
 #include "KMLDomDocument.h"
 
 /// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
-/// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
+///
+/// The vertices are held once in a packed coordinate array. The QVariantList path for map items and the NED
+/// projection used by area, offset, winding and containment checks are derived from it on first use after a change.
+/// The QmlObjectListModel of QGCQGeoCoordinate objects used for vertex drag handles is only populated once pathModel
+/// is asked for and is emptied again when the polygon stops being interactive, so large polygons which are only
+/// displayed don't carry an object per vertex.
 class QGCMapPolygon : public QObject
 {
     Q_OBJECT
@@ -43,6 +51,7 @@ public:
     Q_PROPERTY(bool                 traceMode       READ traceMode      WRITE setTraceMode      NOTIFY traceModeChanged)
     Q_PROPERTY(bool                 showAltColor    READ showAltColor   WRITE setShowAltColor   NOTIFY showAltColorChanged)
     Q_PROPERTY(int                  selectedVertex  READ selectedVertex WRITE selectVertex      NOTIFY selectedVertexChanged)
+    Q_PROPERTY(bool                 loading         READ loading                                NOTIFY loadingChanged)         ///< true: loadKMLOrSHPFileAsync in progress
 
     Q_INVOKABLE void clear(void);
     Q_INVOKABLE void appendVertex(const QGeoCoordinate& coordinate);
@@ -59,7 +68,8 @@ public:
     /// Splits the segment comprised of vertextIndex -> vertexIndex + 1
     Q_INVOKABLE void splitPolygonSegment(int vertexIndex);
 
-    /// Returns true if the specified coordinate is within the polygon
+    /// Returns true if the specified coordinate is within the polygon. Uses an edge index which is rebuilt on the
+    /// first call after the path changes, so repeated checks are cheap even for polygons with many vertices.
     Q_INVOKABLE bool containsCoordinate(const QGeoCoordinate& coordinate) const;
 
     /// Offsets the current polygon edges by the specified distance in meters
@@ -69,6 +79,10 @@ public:
     /// @return true: success
     Q_INVOKABLE bool loadKMLOrSHPFile(const QString& file);
 
+    /// Loads a polygon from a KML/SHP file on a worker thread, signals loadKMLOrSHPFileComplete when done.
+    /// Ignored if a load is already in progress.
+    Q_INVOKABLE void loadKMLOrSHPFileAsync(const QString& file);
+
     /// Returns the path in a list of QGeoCoordinate's format
     QList<QGeoCoordinate> coordinateList(void) const;
 
@@ -102,21 +116,22 @@ public:
 
     // Property methods
 
-    int             count       (void) const { return _polygonPath.count(); }
+    int             count       (void) const { return _vertices.count(); }
     bool            dirty       (void) const { return _dirty; }
     void            setDirty    (bool dirty);
     QGeoCoordinate  center      (void) const { return _center; }
     bool            centerDrag  (void) const { return _centerDrag; }
     bool            interactive (void) const { return _interactive; }
-    bool            isValid     (void) const { return _polygonModel.count() >= 3; }
-    bool            empty       (void) const { return _polygonModel.count() == 0; }
+    bool            isValid     (void) const { return _vertices.count() >= 3; }
+    bool            empty       (void) const { return _vertices.count() == 0; }
     bool            traceMode   (void) const { return _traceMode; }
     bool            showAltColor(void) const { return _showAltColor; }
     int             selectedVertex()   const { return _selectedVertexIndex; }
+    bool            loading     (void) const { return _loading; }
 
-    QVariantList        path        (void) const { return _polygonPath; }
-    QmlObjectListModel* qmlPathModel(void) { return &_polygonModel; }
-    QmlObjectListModel& pathModel   (void) { return _polygonModel; }
+    QVariantList        path        (void) const;
+    QmlObjectListModel* qmlPathModel(void) { _activateModel(); return &_polygonModel; }
+    QmlObjectListModel& pathModel   (void) { _activateModel(); return _polygonModel; }
 
     void setPath        (const QList<QGeoCoordinate>& path);
     void setPath        (const QVariantList& path);
@@ -142,22 +157,30 @@ signals:
     void traceModeChanged   (bool traceMode);
     void showAltColorChanged(bool showAltColor);
     void selectedVertexChanged(int index);
+    void loadingChanged     (bool loading);
+    void loadKMLOrSHPFileComplete(bool success);
 
 private slots:
-    void _polygonModelCountChanged(int count);
     void _polygonModelDirtyChanged(bool dirty);
     void _updateCenter(void);
 
 private:
     void            _init                   (void);
+    void            _verticesChanged        (int oldCount);
+    void            _activateModel          (void);
+    void            _deactivateModel        (void);
+    const QVector<QPointF>& _nedVertices    (void) const;
+    void            _buildContainsIndex     (void) const;
     QPolygonF       _toPolygonF             (void) const;
     QGeoCoordinate  _coordFromPointF        (const QPointF& point) const;
     QPointF         _pointFFromCoord        (const QGeoCoordinate& coordinate) const;
     void            _beginResetIfNotActive  (void);
     void            _endResetIfNotActive    (void);
+    bool            _setLoadedPath          (bool success, const QList<QGeoCoordinate>& coords, const QString& errorString);
 
-    QVariantList        _polygonPath;
-    QmlObjectListModel  _polygonModel;
+    QVector<QGeoCoordinate> _vertices;
+    QmlObjectListModel  _polygonModel;              ///< Only populated while _modelActive
+    bool                _modelActive =          false;
     bool                _dirty =                false;
     QGeoCoordinate      _center;
     bool                _centerDrag =           false;
@@ -167,6 +190,23 @@ private:
     bool                _traceMode =            false;
     bool                _showAltColor =         false;
     int                 _selectedVertexIndex =  -1;
+    bool                _loading =              false;
+
+    // Derived from _vertices on first use after a change
+    mutable bool                    _pathValid =            false;
+    mutable QVariantList            _path;
+    mutable bool                    _nedValid =             false;
+    mutable QVector<QPointF>        _ned;                   ///< x: east, y: north relative to the first vertex
+
+    // Edge index for containsCoordinate. Edges are bucketed into horizontal bands over the bounding rectangle so
+    // a point is only ray cast against the edges which span its band.
+    mutable bool                    _containsIndexValid =   false;
+    mutable QRectF                  _containsBounds;
+    mutable QVector<QLineF>         _containsEdges;
+    mutable QVector<QVector<int>>   _containsBands;
+
+    static const int _containsEdgesPerBand = 4;
+    static const int _containsMaxBands =     1024;
 };
 
 #endif
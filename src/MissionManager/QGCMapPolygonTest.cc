@@ -10,6 +10,7 @@
 #include "QGCMapPolygonTest.h"
 #include "QGCApplication.h"
 #include "QGCQGeoCoordinate.h"
+#include "QGCGeo.h"
 
 QGCMapPolygonTest::QGCMapPolygonTest(void)
 {
@@ -220,6 +221,28 @@ void QGCMapPolygonTest::_testKMLLoad(void)
     checkExpectedMessageBox();
 }
 
+void QGCMapPolygonTest::_testKMLLoadAsync(void)
+{
+    QSignalSpy completeSpy(_mapPolygon, &QGCMapPolygon::loadKMLOrSHPFileComplete);
+
+    _mapPolygon->loadKMLOrSHPFileAsync(QStringLiteral(":/unittest/PolygonGood.kml"));
+    QVERIFY(_mapPolygon->loading());
+    QVERIFY(completeSpy.wait(5000));
+    QVERIFY(!_mapPolygon->loading());
+    QCOMPARE(completeSpy.takeFirst().at(0).toBool(), true);
+
+    QList<QGeoCoordinate> syncCoords = _mapPolygon->coordinateList();
+    QVERIFY(syncCoords.count() >= 3);
+    QVERIFY(_mapPolygon->loadKMLOrSHPFile(QStringLiteral(":/unittest/PolygonGood.kml")));
+    QCOMPARE(_mapPolygon->coordinateList(), syncCoords);
+
+    setExpectedMessageBox(QMessageBox::Ok);
+    _mapPolygon->loadKMLOrSHPFileAsync(QStringLiteral(":/unittest/PolygonBadXml.kml"));
+    QVERIFY(completeSpy.wait(5000));
+    QCOMPARE(completeSpy.takeFirst().at(0).toBool(), false);
+    checkExpectedMessageBox();
+}
+
 void QGCMapPolygonTest::_testSelectVertex(void)
 {
     // Create polygon
@@ -334,3 +357,72 @@ void QGCMapPolygonTest::_testSegmentSplit(void)
     QVERIFY(_mapPolygon->count() == 14);
     QVERIFY(_mapPolygon->selectedVertex() == _mapPolygon->count()-2);
 }
+
+void QGCMapPolygonTest::_testContainsCoordinate(void)
+{
+    QGeoCoordinate inside   = QGeoCoordinate(47.633, -122.089);
+    QGeoCoordinate outside  = QGeoCoordinate(47.640, -122.089);
+
+    QVERIFY(!_mapPolygon->containsCoordinate(inside));
+
+    foreach (auto vertex, _polyPoints) {
+        _mapPolygon->appendVertex(vertex);
+    }
+    QVERIFY(_mapPolygon->containsCoordinate(inside));
+    QVERIFY(!_mapPolygon->containsCoordinate(outside));
+
+    // Edits must be picked up by the edge index
+    _mapPolygon->adjustVertex(0, QGeoCoordinate(47.641, -122.09269407980834));
+    _mapPolygon->adjustVertex(1, QGeoCoordinate(47.641, -122.08545246602667));
+    QVERIFY(_mapPolygon->containsCoordinate(outside));
+    _mapPolygon->removeVertex(0);
+    QVERIFY(!_mapPolygon->containsCoordinate(QGeoCoordinate(47.640, -122.092)));
+
+    // Star with many vertices, checked against the plain polygon test
+    QList<QGeoCoordinate> starPoints;
+    QGeoCoordinate center(47.633, -122.089);
+    for (int i=0; i<1000; i++) {
+        starPoints.append(center.atDistanceAndAzimuth(i % 2 ? 500 : 200, i * 360.0 / 1000));
+    }
+    _mapPolygon->setPath(starPoints);
+
+    QPolygonF starPolygon;
+    for (const QGeoCoordinate& vertex: starPoints) {
+        double y, x, down;
+        convertGeoToNed(vertex, starPoints[0], &y, &x, &down);
+        starPolygon.append(QPointF(x, -y));
+    }
+    for (int i=0; i<500; i++) {
+        QGeoCoordinate coordinate = center.atDistanceAndAzimuth((i * 7) % 600, i * 13.7);
+        double y, x, down;
+        convertGeoToNed(coordinate, starPoints[0], &y, &x, &down);
+        QCOMPARE(_mapPolygon->containsCoordinate(coordinate), starPolygon.containsPoint(QPointF(x, -y), Qt::OddEvenFill));
+    }
+}
+
+void QGCMapPolygonTest::_testPathModelOnDemand(void)
+{
+    QGCMapPolygon polygon;
+    polygon.setInteractive(true);
+    polygon.setPath(_polyPoints);
+    polygon.setDirty(false);
+
+    // Populating the vertex objects is not a change to the polygon
+    QmlObjectListModel* pathModel = polygon.qmlPathModel();
+    QCOMPARE(pathModel->count(), _polyPoints.count());
+    QCOMPARE(pathModel->value<QGCQGeoCoordinate*>(2)->coordinate(), _polyPoints[2]);
+    QVERIFY(!polygon.dirty());
+    QVERIFY(!pathModel->dirty());
+
+    // Kept in sync while in use
+    QGeoCoordinate adjustCoord(_polyPoints[1].latitude() + 1, _polyPoints[1].longitude() + 1);
+    polygon.adjustVertex(1, adjustCoord);
+    QCOMPARE(pathModel->value<QGCQGeoCoordinate*>(1)->coordinate(), adjustCoord);
+
+    // Released when editing ends, path is unaffected
+    polygon.setInteractive(false);
+    QCOMPARE(pathModel->count(), 0);
+    QCOMPARE(polygon.count(), _polyPoints.count());
+    QCOMPARE(polygon.path()[1].value<QGeoCoordinate>(), adjustCoord);
+    QCOMPARE(polygon.qmlPathModel()->count(), _polyPoints.count());
+}
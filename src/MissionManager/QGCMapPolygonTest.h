@@ -29,8 +29,11 @@ private slots:
     void _testDirty(void);
     void _testVertexManipulation(void);
     void _testKMLLoad(void);
+    void _testKMLLoadAsync(void);
     void _testSelectVertex(void);
     void _testSegmentSplit(void);
+    void _testContainsCoordinate(void);
+    void _testPathModelOnDemand(void);
 
 private:
     enum {
@@ -221,12 +221,20 @@ Item {
         selectExisting: true
 
         onAcceptedForLoad: {
-            mapPolygon.loadKMLOrSHPFile(file)
-            mapFitFunctions.fitMapViewportToMissionItems()
+            mapPolygon.loadKMLOrSHPFileAsync(file)
             close()
         }
     }
 
+    Connections {
+        target:                     mapPolygon
+        onLoadKMLOrSHPFileComplete: {
+            if (success) {
+                mapFitFunctions.fitMapViewportToMissionItems()
+            }
+        }
+    }
+
     QGCMenu {
         id: menu
 
@@ -13,6 +13,8 @@
 #include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
 #include "KMLHelper.h"
+#include "ShapeFileHelper.h"
+#include "SettingsManager.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -20,6 +22,7 @@
 #include <QLineF>
 #include <QFile>
 #include <QDomDocument>
+#include <QFutureWatcher>
 
 const char* QGCMapPolyline::jsonPolylineKey = "polyline";
 
@@ -46,10 +49,8 @@ QGCMapPolyline::QGCMapPolyline(const QGCMapPolyline& other, QObject* parent)
 const QGCMapPolyline& QGCMapPolyline::operator=(const QGCMapPolyline& other)
 {
     clear();
-
-    QVariantList vertices = other.path();
-    for (int i=0; i<vertices.count(); i++) {
-        appendVertex(vertices[i].value<QGeoCoordinate>());
+    for (const QGeoCoordinate& coord: other._vertices) {
+        appendVertex(coord);
     }
 
     setDirty(true);
@@ -60,7 +61,6 @@ const QGCMapPolyline& QGCMapPolyline::operator=(const QGCMapPolyline& other)
 void QGCMapPolyline::_init(void)
 {
     connect(&_polylineModel, &QmlObjectListModel::dirtyChanged, this, &QGCMapPolyline::_polylineModelDirtyChanged);
-    connect(&_polylineModel, &QmlObjectListModel::countChanged, this, &QGCMapPolyline::_polylineModelCountChanged);
 
     connect(this, &QGCMapPolyline::countChanged, this, &QGCMapPolyline::isValidChanged);
     connect(this, &QGCMapPolyline::countChanged, this, &QGCMapPolyline::isEmptyChanged);
@@ -68,7 +68,10 @@ void QGCMapPolyline::_init(void)
 
 void QGCMapPolyline::clear(void)
 {
-    _polylinePath.clear();
+    const int oldCount = _vertices.count();
+
+    _vertices.clear();
+    _verticesChanged(oldCount);
     emit pathChanged();
 
     _polylineModel.clearAndDeleteContents();
@@ -78,11 +81,62 @@ void QGCMapPolyline::clear(void)
     setDirty(true);
 }
 
+/// Drops everything derived from the vertices, must be called after each change to _vertices
+void QGCMapPolyline::_verticesChanged(int oldCount)
+{
+    _pathValid  = false;
+    _nedValid   = false;
+    if (_vertices.count() != oldCount) {
+        emit countChanged(_vertices.count());
+    }
+}
+
+void QGCMapPolyline::_activateModel(void)
+{
+    if (_modelActive) {
+        return;
+    }
+
+    QList<QObject*> objects;
+    objects.reserve(_vertices.count());
+    for (const QGeoCoordinate& coordinate: _vertices) {
+        objects.append(new QGCQGeoCoordinate(coordinate, this));
+    }
+    _polylineModel.append(objects);
+    _polylineModel.setDirty(false);
+    _modelActive = true;
+}
+
+void QGCMapPolyline::_deactivateModel(void)
+{
+    if (_modelActive) {
+        _modelActive = false;
+        _polylineModel.clearAndDeleteContents();
+        _polylineModel.setDirty(false);
+    }
+}
+
+QVariantList QGCMapPolyline::path(void) const
+{
+    if (!_pathValid) {
+        _path.clear();
+        _path.reserve(_vertices.count());
+        for (const QGeoCoordinate& coordinate: _vertices) {
+            _path.append(QVariant::fromValue(coordinate));
+        }
+        _pathValid = true;
+    }
+    return _path;
+}
+
 void QGCMapPolyline::adjustVertex(int vertexIndex, const QGeoCoordinate coordinate)
 {
-    _polylinePath[vertexIndex] = QVariant::fromValue(coordinate);
+    _vertices[vertexIndex] = coordinate;
+    _verticesChanged(_vertices.count());
     emit pathChanged();
-    _polylineModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
+    if (_modelActive) {
+        _polylineModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
+    }
     setDirty(true);
 }
 
@@ -90,7 +144,7 @@ void QGCMapPolyline::setDirty(bool dirty)
 {
     if (_dirty != dirty) {
         _dirty = dirty;
-        if (!dirty) {
+        if (!dirty && _modelActive) {
             _polylineModel.setDirty(false);
         }
         emit dirtyChanged(dirty);
@@ -100,9 +154,8 @@ QGeoCoordinate QGCMapPolyline::_coordFromPointF(const QPointF& point) const
 {
     QGeoCoordinate coord;
 
-    if (_polylinePath.count() > 0) {
-        QGeoCoordinate tangentOrigin = _polylinePath[0].value<QGeoCoordinate>();
-        convertNedToGeo(-point.y(), point.x(), 0, tangentOrigin, &coord);
+    if (_vertices.count() > 0) {
+        convertNedToGeo(-point.y(), point.x(), 0, _vertices[0], &coord);
     }
 
     return coord;
@@ -110,11 +163,10 @@ QGeoCoordinate QGCMapPolyline::_coordFromPointF(const QPointF& point) const
 
 QPointF QGCMapPolyline::_pointFFromCoord(const QGeoCoordinate& coordinate) const
 {
-    if (_polylinePath.count() > 0) {
+    if (_vertices.count() > 0) {
         double y, x, down;
-        QGeoCoordinate tangentOrigin = _polylinePath[0].value<QGeoCoordinate>();
 
-        convertGeoToNed(coordinate, tangentOrigin, &y, &x, &down);
+        convertGeoToNed(coordinate, _vertices[0], &y, &x, &down);
         return QPointF(x, -y);
     }
 
@@ -125,11 +177,14 @@ void QGCMapPolyline::setPath(const QList<QGeoCoordinate>& path)
 {
     _beginResetIfNotActive();
 
-    _polylinePath.clear();
-    _polylineModel.clearAndDeleteContents();
-    for (const QGeoCoordinate& coord: path) {
-        _polylinePath.append(QVariant::fromValue(coord));
-        _polylineModel.append(new QGCQGeoCoordinate(coord, this));
+    const int oldCount = _vertices.count();
+    _vertices = path.toVector();
+    _verticesChanged(oldCount);
+    if (_modelActive) {
+        _polylineModel.clearAndDeleteContents();
+        for (const QGeoCoordinate& coord: path) {
+            _polylineModel.append(new QGCQGeoCoordinate(coord, this));
+        }
     }
 
     setDirty(true);
@@ -139,16 +194,12 @@ void QGCMapPolyline::setPath(const QList<QGeoCoordinate>& path)
 
 void QGCMapPolyline::setPath(const QVariantList& path)
 {
-    _beginResetIfNotActive();
-
-    _polylinePath = path;
-    _polylineModel.clearAndDeleteContents();
-    for (int i=0; i<_polylinePath.count(); i++) {
-        _polylineModel.append(new QGCQGeoCoordinate(_polylinePath[i].value<QGeoCoordinate>(), this));
+    QList<QGeoCoordinate> coords;
+    coords.reserve(path.count());
+    for (const QVariant& varCoord: path) {
+        coords.append(varCoord.value<QGeoCoordinate>());
     }
-    setDirty(true);
-
-    _endResetIfNotActive();
+    setPath(coords);
 }
 
 
@@ -156,7 +207,7 @@ void QGCMapPolyline::saveToJson(QJsonObject& json)
 {
     QJsonValue jsonValue;
 
-    JsonHelper::saveGeoCoordinateArray(_polylinePath, false /* writeAltitude*/, jsonValue);
+    JsonHelper::saveGeoCoordinateArray(path(), false /* writeAltitude*/, jsonValue);
     json.insert(jsonPolylineKey, jsonValue);
     setDirty(false);
 }
@@ -174,12 +225,19 @@ bool QGCMapPolyline::loadFromJson(const QJsonObject& json, bool required, QStrin
         return true;
     }
 
-    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolylineKey], false /* altitudeRequired */, _polylinePath, errorString)) {
+    QVariantList jsonPath;
+    if (!JsonHelper::loadGeoCoordinateArray(json[jsonPolylineKey], false /* altitudeRequired */, jsonPath, errorString)) {
         return false;
     }
 
-    for (int i=0; i<_polylinePath.count(); i++) {
-        _polylineModel.append(new QGCQGeoCoordinate(_polylinePath[i].value<QGeoCoordinate>(), this));
+    for (const QVariant& varCoord: jsonPath) {
+        _vertices.append(varCoord.value<QGeoCoordinate>());
+    }
+    _verticesChanged(0);
+    if (_modelActive) {
+        for (const QGeoCoordinate& coord: _vertices) {
+            _polylineModel.append(new QGCQGeoCoordinate(coord, this));
+        }
     }
 
     setDirty(false);
@@ -190,24 +248,18 @@ bool QGCMapPolyline::loadFromJson(const QJsonObject& json, bool required, QStrin
 
 QList<QGeoCoordinate> QGCMapPolyline::coordinateList(void) const
 {
-    QList<QGeoCoordinate> coords;
-
-    for (int i=0; i<_polylinePath.count(); i++) {
-        coords.append(_polylinePath[i].value<QGeoCoordinate>());
-    }
-
-    return coords;
+    return _vertices.toList();
 }
 
 void QGCMapPolyline::splitSegment(int vertexIndex)
 {
     int nextIndex = vertexIndex + 1;
-    if (nextIndex > _polylinePath.length() - 1) {
+    if (nextIndex > _vertices.count() - 1) {
         return;
     }
 
-    QGeoCoordinate firstVertex = _polylinePath[vertexIndex].value<QGeoCoordinate>();
-    QGeoCoordinate nextVertex = _polylinePath[nextIndex].value<QGeoCoordinate>();
+    QGeoCoordinate firstVertex = _vertices[vertexIndex];
+    QGeoCoordinate nextVertex = _vertices[nextIndex];
 
     double distance = firstVertex.distanceTo(nextVertex);
     double azimuth = firstVertex.azimuthTo(nextVertex);
@@ -216,40 +268,52 @@ void QGCMapPolyline::splitSegment(int vertexIndex)
     if (nextIndex == 0) {
         appendVertex(newVertex);
     } else {
-        _polylineModel.insert(nextIndex, new QGCQGeoCoordinate(newVertex, this));
-        _polylinePath.insert(nextIndex, QVariant::fromValue(newVertex));
+        _vertices.insert(nextIndex, newVertex);
+        _verticesChanged(_vertices.count() - 1);
+        if (_modelActive) {
+            _polylineModel.insert(nextIndex, new QGCQGeoCoordinate(newVertex, this));
+        }
+        setDirty(true);
         emit pathChanged();
     }
 }
 
 void QGCMapPolyline::appendVertex(const QGeoCoordinate& coordinate)
 {
-    _polylinePath.append(QVariant::fromValue(coordinate));
-    _polylineModel.append(new QGCQGeoCoordinate(coordinate, this));
+    _vertices.append(coordinate);
+    _verticesChanged(_vertices.count() - 1);
+    if (_modelActive) {
+        _polylineModel.append(new QGCQGeoCoordinate(coordinate, this));
+    }
+    setDirty(true);
     emit pathChanged();
 }
 
 void QGCMapPolyline::removeVertex(int vertexIndex)
 {
-    if (vertexIndex < 0 || vertexIndex > _polylinePath.length() - 1) {
-        qWarning() << "Call to removeVertex with bad vertexIndex:count" << vertexIndex << _polylinePath.length();
+    if (vertexIndex < 0 || vertexIndex > _vertices.count() - 1) {
+        qWarning() << "Call to removeVertex with bad vertexIndex:count" << vertexIndex << _vertices.count();
         return;
     }
 
-    if (_polylinePath.length() <= 2) {
+    if (_vertices.count() <= 2) {
         // Don't allow the user to trash the polyline
         return;
     }
 
-    QObject* coordObj = _polylineModel.removeAt(vertexIndex);
-    coordObj->deleteLater();
+    if (_modelActive) {
+        QObject* coordObj = _polylineModel.removeAt(vertexIndex);
+        coordObj->deleteLater();
+    }
+    _vertices.removeAt(vertexIndex);
+    _verticesChanged(_vertices.count() + 1);
     if(vertexIndex == _selectedVertexIndex) {
         selectVertex(-1);
     } else if (vertexIndex < _selectedVertexIndex) {
         selectVertex(_selectedVertexIndex - 1);
     } // else do nothing - keep current selected vertex
 
-    _polylinePath.removeAt(vertexIndex);
+    setDirty(true);
     emit pathChanged();
 }
 
@@ -258,13 +322,17 @@ void QGCMapPolyline::setInteractive(bool interactive)
     if (_interactive != interactive) {
         _interactive = interactive;
         emit interactiveChanged(interactive);
+        if (!interactive) {
+            // Drag handles are gone, the next pathModel user populates it again
+            _deactivateModel();
+        }
     }
 }
 
 QGeoCoordinate QGCMapPolyline::vertexCoordinate(int vertex) const
 {
-    if (vertex >= 0 && vertex < _polylinePath.count()) {
-        return _polylinePath[vertex].value<QGeoCoordinate>();
+    if (vertex >= 0 && vertex < _vertices.count()) {
+        return _vertices[vertex];
     } else {
         qWarning() << "QGCMapPolyline::vertexCoordinate bad vertex requested";
         return QGeoCoordinate();
@@ -272,20 +340,29 @@ QGeoCoordinate QGCMapPolyline::vertexCoordinate(int vertex) const
 }
 
 QList<QPointF> QGCMapPolyline::nedPolyline(void)
+{
+    if (!_nedValid) {
+        _ned = nedPolyline(coordinateList());
+        _nedValid = true;
+    }
+    return _ned;
+}
+
+QList<QPointF> QGCMapPolyline::nedPolyline(const QList<QGeoCoordinate>& polyline)
 {
     QList<QPointF>  nedPolyline;
 
-    if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+    if (polyline.count() > 0) {
+        LocalTangentFrame frame(polyline[0]);
 
-        for (int i=0; i<_polylinePath.count(); i++) {
-            double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
+        nedPolyline.reserve(polyline.count());
+        for (int i=0; i<polyline.count(); i++) {
+            double y, x;
             if (i == 0) {
                 // This avoids a nan calculation that comes out of convertGeoToNed
                 x = y = 0;
             } else {
-                convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
+                frame.toNed(polyline[i], &y, &x, nullptr);
             }
             nedPolyline += QPointF(x, y);
         }
@@ -294,19 +371,26 @@ QList<QPointF> QGCMapPolyline::nedPolyline(void)
     return nedPolyline;
 }
 
-
 QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
+{
+    if (count() > 1) {
+        return offsetPolyline(nedPolyline(), vertexCoordinate(0), distance);
+    }
+    return QList<QGeoCoordinate>();
+}
+
+QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(const QList<QPointF>& nedPolyline, const QGeoCoordinate& tangentOrigin, double distance)
 {
     QList<QGeoCoordinate> rgNewPolyline;
 
     // I'm sure there is some beautiful famous algorithm to do this, but here is a brute force method
 
-    if (count() > 1) {
-        // Convert the polygon to NED
-        QList<QPointF> rgNedVertices = nedPolyline();
+    if (nedPolyline.count() > 1) {
+        const QList<QPointF>& rgNedVertices = nedPolyline;
 
         // Walk the edges, offsetting by the specified distance
         QList<QLineF> rgOffsetEdges;
+        rgOffsetEdges.reserve(rgNedVertices.count() - 1);
         for (int i=0; i<rgNedVertices.count() - 1; i++) {
             QLineF  offsetEdge;
             QLineF  originalEdge(rgNedVertices[i], rgNedVertices[i + 1]);
@@ -324,12 +408,11 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
             rgOffsetEdges.append(offsetEdge);
         }
 
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        rgNewPolyline.reserve(rgOffsetEdges.count() + 1);
 
         // Add first vertex
-        QGeoCoordinate coord;
-        convertNedToGeo(rgOffsetEdges[0].p1().y(), rgOffsetEdges[0].p1().x(), 0, tangentOrigin, &coord);
-        rgNewPolyline.append(coord);
+        LocalTangentFrame frame(tangentOrigin);
+        rgNewPolyline.append(frame.fromNed(rgOffsetEdges[0].p1().y(), rgOffsetEdges[0].p1().x(), 0));
 
         // Intersect the offset edges to generate new central vertices
         QPointF  newVertex;
@@ -339,14 +422,12 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
                 // Two lines are colinear
                 newVertex = rgOffsetEdges[i].p2();
             }
-            convertNedToGeo(newVertex.y(), newVertex.x(), 0, tangentOrigin, &coord);
-            rgNewPolyline.append(coord);
+            rgNewPolyline.append(frame.fromNed(newVertex.y(), newVertex.x(), 0));
         }
 
         // Add last vertex
         int lastIndex = rgOffsetEdges.count() - 1;
-        convertNedToGeo(rgOffsetEdges[lastIndex].p2().y(), rgOffsetEdges[lastIndex].p2().x(), 0, tangentOrigin, &coord);
-        rgNewPolyline.append(coord);
+        rgNewPolyline.append(frame.fromNed(rgOffsetEdges[lastIndex].p2().y(), rgOffsetEdges[lastIndex].p2().x(), 0));
     }
 
     return rgNewPolyline;
@@ -354,18 +435,48 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
 
 bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
 {
-    _beginResetIfNotActive();
-
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!KMLHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString)) {
+    bool success = KMLHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString);
+    if (success) {
+        ShapeFileHelper::simplify(rgCoords, qgcApp()->toolbox()->settingsManager()->planViewSettings()->shapeImportSimplification()->rawValue().toDouble());
+    }
+
+    return _setLoadedPath(success, rgCoords, errorString);
+}
+
+void QGCMapPolyline::loadKMLFileAsync(const QString& kmlFile)
+{
+    if (_loading) {
+        return;
+    }
+    _loading = true;
+    emit loadingChanged(true);
+
+    QFutureWatcher<ShapeFileHelper::LoadResult_t>* watcher = new QFutureWatcher<ShapeFileHelper::LoadResult_t>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        const ShapeFileHelper::LoadResult_t result = watcher->result();
+        watcher->deleteLater();
+
+        _loading = false;
+        emit loadingChanged(false);
+        emit loadKMLFileComplete(_setLoadedPath(result.success, result.coords, result.errorString));
+    });
+
+    double simplifyToleranceMeters = qgcApp()->toolbox()->settingsManager()->planViewSettings()->shapeImportSimplification()->rawValue().toDouble();
+    watcher->setFuture(ShapeFileHelper::loadPolylineFromFileAsync(kmlFile, simplifyToleranceMeters));
+}
+
+bool QGCMapPolyline::_setLoadedPath(bool success, const QList<QGeoCoordinate>& coords, const QString& errorString)
+{
+    if (!success) {
         qgcApp()->showAppMessage(errorString);
         return false;
     }
 
+    _beginResetIfNotActive();
     clear();
-    appendVertices(rgCoords);
-
+    appendVertices(coords);
     _endResetIfNotActive();
 
     return true;
@@ -373,25 +484,19 @@ bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
 
 void QGCMapPolyline::_polylineModelDirtyChanged(bool dirty)
 {
-    if (dirty) {
+    // Populating the model is not a change to the polyline
+    if (dirty && _modelActive) {
         setDirty(true);
     }
 }
 
-void QGCMapPolyline::_polylineModelCountChanged(int count)
-{
-    emit countChanged(count);
-}
-
 
 double QGCMapPolyline::length(void) const
 {
     double length = 0;
 
-    for (int i=0; i<_polylinePath.count() - 1; i++) {
-        QGeoCoordinate from = _polylinePath[i].value<QGeoCoordinate>();
-        QGeoCoordinate to = _polylinePath[i+1].value<QGeoCoordinate>();
-        length += from.distanceTo(to);
+    for (int i=0; i<_vertices.count() - 1; i++) {
+        length += _vertices[i].distanceTo(_vertices[i+1]);
     }
 
     return length;
@@ -401,12 +506,22 @@ void QGCMapPolyline::appendVertices(const QList<QGeoCoordinate>& coordinates)
 {
     _beginResetIfNotActive();
 
-    QList<QObject*> objects;
+    const int oldCount = _vertices.count();
+    _vertices.reserve(_vertices.count() + coordinates.count());
     for (const QGeoCoordinate& coordinate: coordinates) {
-        objects.append(new QGCQGeoCoordinate(coordinate, this));
-        _polylinePath.append(QVariant::fromValue(coordinate));
+        _vertices.append(coordinate);
+    }
+    _verticesChanged(oldCount);
+    if (_modelActive) {
+        QList<QObject*> objects;
+        for (const QGeoCoordinate& coordinate: coordinates) {
+            objects.append(new QGCQGeoCoordinate(coordinate, this));
+        }
+        _polylineModel.append(objects);
+    }
+    if (!coordinates.isEmpty()) {
+        setDirty(true);
     }
-    _polylineModel.append(objects);
 
     _endResetIfNotActive();
 }
@@ -12,9 +12,14 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QVariantList>
+#include <QPointF>
+#include <QVector>
 
 #include "QmlObjectListModel.h"
 
+/// Polyline which can be displayed on a map using a map visuals control. Storage is the same as QGCMapPolygon: a packed
+/// coordinate array with the QVariantList path and NED projection derived on demand, and a pathModel which is only
+/// populated while it is in use.
 class QGCMapPolyline : public QObject
 {
     Q_OBJECT
@@ -34,6 +39,7 @@ public:
     Q_PROPERTY(bool                 empty       READ empty                                  NOTIFY isEmptyChanged)
     Q_PROPERTY(bool                 traceMode   READ traceMode      WRITE setTraceMode      NOTIFY traceModeChanged)
     Q_PROPERTY(int              selectedVertex  READ selectedVertex WRITE selectVertex      NOTIFY selectedVertexChanged)
+    Q_PROPERTY(bool                 loading     READ loading                                NOTIFY loadingChanged)         ///< true: loadKMLFileAsync in progress
 
     Q_INVOKABLE void clear(void);
     Q_INVOKABLE void appendVertex(const QGeoCoordinate& coordinate);
@@ -52,10 +58,20 @@ public:
     /// @return Offset set of vertices
     QList<QGeoCoordinate> offsetPolyline(double distance);
 
+    /// Offsets the polyline edges by the specified distance in meters. Usable from any thread.
+    ///     @param nedPolyline      Polyline vertices from nedPolyline
+    ///     @param tangentOrigin    Coordinate of the first vertex
+    /// @return Offset set of vertices
+    static QList<QGeoCoordinate> offsetPolyline(const QList<QPointF>& nedPolyline, const QGeoCoordinate& tangentOrigin, double distance);
+
     /// Loads a polyline from a KML file
     /// @return true: success
     Q_INVOKABLE bool loadKMLFile(const QString& kmlFile);
 
+    /// Loads a polyline from a KML file on a worker thread, signals loadKMLFileComplete when done.
+    /// Ignored if a load is already in progress.
+    Q_INVOKABLE void loadKMLFileAsync(const QString& kmlFile);
+
     Q_INVOKABLE void beginReset (void);
     Q_INVOKABLE void endReset   (void);
 
@@ -79,22 +95,26 @@ public:
     /// Convert polyline to NED and return (D is ignored)
     QList<QPointF> nedPolyline(void);
 
+    /// Convert the specified vertices to NED relative to the first vertex. Usable from any thread.
+    static QList<QPointF> nedPolyline(const QList<QGeoCoordinate>& polyline);
+
     /// Returns the length of the polyline in meters
     double length(void) const;
 
     // Property methods
-    int             count       (void) const { return _polylinePath.count(); }
+    int             count       (void) const { return _vertices.count(); }
     bool            dirty       (void) const { return _dirty; }
     void            setDirty    (bool dirty);
     bool            interactive (void) const { return _interactive; }
-    QVariantList    path        (void) const { return _polylinePath; }
-    bool            isValid     (void) const { return _polylineModel.count() >= 2; }
-    bool            empty       (void) const { return _polylineModel.count() == 0; }
+    QVariantList    path        (void) const;
+    bool            isValid     (void) const { return _vertices.count() >= 2; }
+    bool            empty       (void) const { return _vertices.count() == 0; }
     bool            traceMode   (void) const { return _traceMode; }
     int             selectedVertex()   const { return _selectedVertexIndex; }
+    bool            loading     (void) const { return _loading; }
 
-    QmlObjectListModel* qmlPathModel(void) { return &_polylineModel; }
-    QmlObjectListModel& pathModel   (void) { return _polylineModel; }
+    QmlObjectListModel* qmlPathModel(void) { _activateModel(); return &_polylineModel; }
+    QmlObjectListModel& pathModel   (void) { _activateModel(); return _polylineModel; }
 
     void setPath        (const QList<QGeoCoordinate>& path);
     void setPath        (const QVariantList& path);
@@ -114,23 +134,36 @@ signals:
     void isEmptyChanged     (void);
     void traceModeChanged   (bool traceMode);
     void selectedVertexChanged(int index);
+    void loadingChanged     (bool loading);
+    void loadKMLFileComplete(bool success);
 
 private slots:
-    void _polylineModelCountChanged(int count);
     void _polylineModelDirtyChanged(bool dirty);
 
 private:
     void            _init                   (void);
+    void            _verticesChanged        (int oldCount);
+    void            _activateModel          (void);
+    void            _deactivateModel        (void);
     QGeoCoordinate  _coordFromPointF        (const QPointF& point) const;
     QPointF         _pointFFromCoord        (const QGeoCoordinate& coordinate) const;
     void            _beginResetIfNotActive  (void);
     void            _endResetIfNotActive    (void);
+    bool            _setLoadedPath          (bool success, const QList<QGeoCoordinate>& coords, const QString& errorString);
 
-    QVariantList        _polylinePath;
-    QmlObjectListModel  _polylineModel;
+    QVector<QGeoCoordinate> _vertices;
+    QmlObjectListModel  _polylineModel;             ///< Only populated while _modelActive
+    bool                _modelActive = false;
     bool                _dirty;
     bool                _interactive;
     bool                _resetActive;
     bool                _traceMode = false;
     int                 _selectedVertexIndex = -1;
+    bool                _loading = false;
+
+    // Derived from _vertices on first use after a change
+    mutable bool            _pathValid = false;
+    mutable QVariantList    _path;
+    bool                    _nedValid = false;
+    QList<QPointF>          _ned;
 };
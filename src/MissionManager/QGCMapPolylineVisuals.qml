@@ -130,7 +130,7 @@ Item {
         nameFilters:    ShapeFileHelper.fileDialogKMLFilters
 
         onAcceptedForLoad: {
-            mapPolyline.loadKMLFile(file)
+            mapPolyline.loadKMLFileAsync(file)
             close()
         }
     }
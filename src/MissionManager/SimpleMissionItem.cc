@@ -215,6 +215,12 @@ void SimpleMissionItem::_connectSignals(void)
 
     connect(_missionController,                 &MissionController::plannedHomePositionChanged, this, &SimpleMissionItem::_amslEntryAltChanged);
     connect(_missionController,                 &MissionController::plannedHomePositionChanged, this, &SimpleMissionItem::_amslExitAltChanged);
+
+    // The bounding cube is kept up to date so MissionController can merge it in without looking at the item again
+    connect(this,                               &SimpleMissionItem::coordinateChanged,      this, &SimpleMissionItem::_updateBoundingCube);
+    connect(this,                               &SimpleMissionItem::commandChanged,         this, &SimpleMissionItem::_updateBoundingCube);
+    connect(&_altitudeFact,                     &Fact::valueChanged,                        this, &SimpleMissionItem::_updateBoundingCube);
+    _updateBoundingCube();
 }
 
 void SimpleMissionItem::_setupMetaData(void)
@@ -606,11 +612,23 @@ void SimpleMissionItem::_rebuildComboBoxFacts(void)
 
 void SimpleMissionItem::_rebuildFacts(void)
 {
+    if (!_factsMaterialized) {
+        return;
+    }
+
     _rebuildTextFieldFacts();
     _rebuildNaNFacts();
     _rebuildComboBoxFacts();
 }
 
+void SimpleMissionItem::_materializeFacts(void)
+{
+    if (!_factsMaterialized) {
+        _factsMaterialized = true;
+        _rebuildFacts();
+    }
+}
+
 bool SimpleMissionItem::friendlyEditAllowed(void) const
 {
     const MissionCommandUIInfo* uiInfo = _commandTree->getUIInfo(_controllerVehicle, _previousVTOLMode, static_cast<MAV_CMD>(command()));
@@ -705,6 +723,31 @@ void SimpleMissionItem::_altitudeModeChanged(void)
     _altitudeChanged();
 }
 
+/// Only the items the vehicle flies through make up the mission travel bounds
+void SimpleMissionItem::_updateBoundingCube(void)
+{
+    QGCGeoBoundingCube boundingCube;
+
+    switch (command()) {
+    case MAV_CMD_NAV_TAKEOFF:
+    case MAV_CMD_NAV_WAYPOINT:
+    case MAV_CMD_NAV_LAND:
+        if (coordinate().isValid()) {
+            double altitude = 0.0;
+            if (!_altitudeFact.rawValue().isNull() && !qIsNaN(_altitudeFact.rawValue().toDouble())) {
+                altitude = _altitudeFact.rawValue().toDouble();
+            }
+            const QGeoCoordinate point(coordinate().latitude(), coordinate().longitude(), altitude);
+            boundingCube = QGCGeoBoundingCube(point, point);
+        }
+        break;
+    default:
+        break;
+    }
+
+    _setBoundingCube(boundingCube);
+}
+
 void SimpleMissionItem::_altitudeChanged(void)
 {
     if (!specifiesAltitude()) {
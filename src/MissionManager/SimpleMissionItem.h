@@ -80,9 +80,11 @@ public:
     CameraSection*  cameraSection       (void) { return _cameraSection; }
     SpeedSection*   speedSection        (void) { return _speedSection; }
 
-    QmlObjectListModel* textFieldFacts  (void) { return &_textFieldFacts; }
-    QmlObjectListModel* nanFacts        (void) { return &_nanFacts; }
-    QmlObjectListModel* comboboxFacts   (void) { return &_comboboxFacts; }
+    // The editor fact lists are built the first time they are asked for, items of a large plan which are never
+    // shown in the editor skip the command ui info lookups and list building.
+    QmlObjectListModel* textFieldFacts  (void) { _materializeFacts(); return &_textFieldFacts; }
+    QmlObjectListModel* nanFacts        (void) { _materializeFacts(); return &_nanFacts; }
+    QmlObjectListModel* comboboxFacts   (void) { _materializeFacts(); return &_comboboxFacts; }
 
     void setRawEdit(bool rawEdit);
     void setAltitudeMode(QGroundControlQmlGlobal::AltMode altitudeMode);
@@ -165,6 +167,7 @@ private slots:
     void _possibleVehicleYawChanged             (void);
     void _signalIfVTOLTransitionCommand         (void);
     void _possibleRadiusChanged                 (void);
+    void _updateBoundingCube                    (void);
 
 private:
     void _connectSignals        (void);
@@ -172,11 +175,13 @@ private:
     void _updateOptionalSections(void);
     void _rebuildNaNFacts       (void);
     void _rebuildComboBoxFacts  (void);
+    void _materializeFacts      (void);
 
     MissionItem     _missionItem;
     bool            _rawEdit =                  false;
     bool            _dirty =                    false;
     bool            _ignoreDirtyChangeSignals = false;
+    bool            _factsMaterialized =        false;  ///< true: editor fact lists have been requested and are kept up to date
     QGeoCoordinate  _mapCenterHint;
     SpeedSection*   _speedSection =             nullptr;
     CameraSection*  _cameraSection =             nullptr;
@@ -84,14 +84,15 @@ StructureScanComplexItem::StructureScanComplexItem(PlanMasterController* masterC
 
     connect(_cameraCalc.distanceToSurface(),    &Fact::valueChanged,                this, &StructureScanComplexItem::_rebuildFlightPolygon);
 
-    connect(&_flightPolygon,                        &QGCMapPolygon::pathChanged,    this, &StructureScanComplexItem::_recalcCameraShots);
-    connect(_cameraCalc.adjustedFootprintSide(),    &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShots);
-    connect(&_layersFact,                           &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShots);
+    connect(&_flightPolygon,                        &QGCMapPolygon::pathChanged,    this, &StructureScanComplexItem::_invalidateFlightPerimeter);
 
-    connect(&_cameraCalc, &CameraCalc::isManualCameraChanged, this, &StructureScanComplexItem::_updateGimbalPitch);
+    connect(&_flightPolygon,                        &QGCMapPolygon::pathChanged,    this, &StructureScanComplexItem::_recalcCameraShotsSignal);
+    connect(_cameraCalc.adjustedFootprintSide(),    &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShotsSignal);
+    connect(&_layersFact,                           &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShotsSignal);
+    connect(&_structureHeightFact,                  &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShotsSignal);
+    connect(&_scanBottomAltFact,                    &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcCameraShotsSignal);
 
-    connect(&_layersFact,                           &Fact::valueChanged,            this, &StructureScanComplexItem::_recalcScanDistance);
-    connect(&_flightPolygon,                        &QGCMapPolygon::pathChanged,    this, &StructureScanComplexItem::_recalcScanDistance);
+    connect(&_cameraCalc, &CameraCalc::isManualCameraChanged, this, &StructureScanComplexItem::_updateGimbalPitch);
 
     connect(this, &StructureScanComplexItem::wizardModeChanged, this, &StructureScanComplexItem::readyForSaveStateChanged);
 
@@ -117,6 +118,8 @@ StructureScanComplexItem::StructureScanComplexItem(PlanMasterController* masterC
     // The follow is used to compress multiple recalc calls in a row to into a single call.
     connect(this, &StructureScanComplexItem::_updateFlightPathSegmentsSignal, this, &StructureScanComplexItem::_updateFlightPathSegmentsDontCallDirectly,   Qt::QueuedConnection);
     qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&StructureScanComplexItem::_updateFlightPathSegmentsSignal));
+    connect(this, &StructureScanComplexItem::_recalcCameraShotsSignal, this, &StructureScanComplexItem::_recalcCameraShotsDontCallDirectly, Qt::QueuedConnection);
+    qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&StructureScanComplexItem::_recalcCameraShotsSignal));
 
     _recalcLayerInfo();
 
@@ -545,33 +548,61 @@ void StructureScanComplexItem::_rebuildFlightPolygon(void)
     emit exitCoordinateChanged(exitCoordinate());
 }
 
-void StructureScanComplexItem::_recalcCameraShots(void)
+void StructureScanComplexItem::_invalidateFlightPerimeter(void)
 {
-    double triggerDistance = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
-    if (triggerDistance == 0) {
-        _setCameraShots(0);
-        return;
+    _flightPerimeterValid = false;
+}
+
+double StructureScanComplexItem::_cachedFlightPerimeter(void)
+{
+    if (!_flightPerimeterValid) {
+        _flightPerimeter = 0;
+        if (_flightPolygon.count() > 2) {
+            const QList<QGeoCoordinate> vertices = _flightPolygon.coordinateList();
+            for (int i=0; i<vertices.count(); i++) {
+                _flightPerimeter += vertices[i].distanceTo(vertices[i + 1 == vertices.count() ? 0 : i + 1]);
+            }
+        }
+        _flightPerimeterValid = true;
     }
+    return _flightPerimeter;
+}
 
-    if (_flightPolygon.count() < 3) {
+// Never call this method directly. If you want to update camera shots and scan distance you emit _recalcCameraShotsSignal()
+void StructureScanComplexItem::_recalcCameraShotsDontCallDirectly(void)
+{
+    // Camera shots and scan distance depend on the following values:
+    //  _flightPolygon (through the cached perimeter)
+    //  _cameraCalc.adjustedFootprintSide()
+    //  _layersFact
+    //  _structureHeightFact
+    //  _scanBottomAltFact
+    // Any changes to these values must emit _recalcCameraShotsSignal
+
+    double  perimeter       = _cachedFlightPerimeter();
+    int     layers          = _layersFact.rawValue().toInt();
+    double  triggerDistance = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+
+    if (triggerDistance == 0 || perimeter == 0.0) {
         _setCameraShots(0);
-        return;
+    } else {
+        _setCameraShots(static_cast<int>(perimeter / triggerDistance) * layers);
     }
 
-    // Determine the distance for each polygon traverse
-    double distance = 0;
-    for (int i=0; i<_flightPolygon.count(); i++) {
-        QGeoCoordinate coord1 = _flightPolygon.vertexCoordinate(i);
-        QGeoCoordinate coord2 = _flightPolygon.vertexCoordinate(i + 1 == _flightPolygon.count() ? 0 : i + 1);
-        distance += coord1.distanceTo(coord2);
-    }
-    if (distance == 0.0) {
-        _setCameraShots(0);
-        return;
+    double scanDistance = 0;
+    if (perimeter != 0.0) {
+        double surfaceHeight = qMax(_structureHeightFact.rawValue().toDouble() - _scanBottomAltFact.rawValue().toDouble(), 0.0);
+        scanDistance = (perimeter * layers) + surfaceHeight;
+
+        qCDebug(StructureScanComplexItemLog) << "StructureScanComplexItem--_recalcCameraShotsDontCallDirectly layers: "
+                                             << layers << " structure height: " << surfaceHeight
+                                             << " scanDistance: " << scanDistance;
     }
 
-    int cameraShots = static_cast<int>(distance / triggerDistance);
-    _setCameraShots(cameraShots * _layersFact.rawValue().toInt());
+    if (!QGC::fuzzyCompare(_scanDistance, scanDistance)) {
+        _scanDistance = scanDistance;
+        emit complexDistanceChanged();
+    }
 }
 
 void StructureScanComplexItem::_recalcLayerInfo(void)
@@ -621,34 +652,6 @@ void StructureScanComplexItem::_signalTopBottomAltChanged(void)
     emit bottomFlightAltChanged();
 }
 
-void StructureScanComplexItem::_recalcScanDistance()
-{
-    double scanDistance = 0;
-
-    if (_flightPolygon.count() > 2) {
-        QList<QGeoCoordinate> vertices = _flightPolygon.coordinateList();
-        for (int i=0; i<vertices.count() - 1; i++) {
-            scanDistance += vertices[i].distanceTo(vertices[i+1]);
-        }
-        scanDistance += vertices.last().distanceTo(vertices.first());
-
-        scanDistance *= _layersFact.rawValue().toInt();
-
-        double surfaceHeight = qMax(_structureHeightFact.rawValue().toDouble() - _scanBottomAltFact.rawValue().toDouble(), 0.0);
-        scanDistance += surfaceHeight;
-
-        qCDebug(StructureScanComplexItemLog) << "StructureScanComplexItem--_recalcScanDistance layers: "
-                                             << _layersFact.rawValue().toInt() << " structure height: " << surfaceHeight
-                                             << " scanDistance: " << _scanDistance;
-    }
-
-    if (!QGC::fuzzyCompare(_scanDistance, scanDistance)) {
-        _scanDistance = scanDistance;
-        emit complexDistanceChanged();
-    }
-
-}
-
 StructureScanComplexItem::ReadyForSaveState StructureScanComplexItem::readyForSaveState(void) const
 {
     return _structurePolygon.isValid() && !_wizardMode ? ReadyForSave : NotReadyForSaveData;
@@ -117,6 +117,7 @@ signals:
     void bottomFlightAltChanged         (void);
     void topFlightAltChanged            (void);
     void _updateFlightPathSegmentsSignal(void);
+    void _recalcCameraShotsSignal       (void);
 
 private slots:
     void _segmentTerrainCollisionChanged            (bool terrainCollision) final;
@@ -126,18 +127,19 @@ private slots:
     void _clearInternal                             (void);
     void _updateCoordinateAltitudes                 (void);
     void _rebuildFlightPolygon                      (void);
-    void _recalcCameraShots                         (void);
+    void _invalidateFlightPerimeter                 (void);
     void _recalcLayerInfo                           (void);
     void _updateLastSequenceNumber                  (void);
     void _updateGimbalPitch                         (void);
     void _signalTopBottomAltChanged                 (void);
-    void _recalcScanDistance                        (void);
     void _updateWizardMode                          (void);
     void _updateFlightPathSegmentsDontCallDirectly  (void);
+    void _recalcCameraShotsDontCallDirectly         (void);
 
 private:
     void    _setCameraShots                 (int cameraShots);
     double  _triggerDistance                (void) const;
+    double  _cachedFlightPerimeter          (void);
 
     QMap<QString, FactMetaData*> _metaDataMap;
 
@@ -147,6 +149,8 @@ private:
     int             _entryVertex;       // Polygon vertex which is used as the mission entry point
     bool            _ignoreRecalc;
     double          _scanDistance;
+    double          _flightPerimeter        = 0;        ///< Cached length of one layer traverse of _flightPolygon
+    bool            _flightPerimeterValid   = false;
     int             _cameraShots;
     double          _timeBetweenShots;
     double          _vehicleSpeed;
@@ -136,3 +136,30 @@ void StructureScanComplexItemTest::_testItemCount(void)
     QCOMPARE(items.count() - 1, _structureScanItem->lastSequenceNumber());
 
 }
+
+void StructureScanComplexItemTest::_testRecalcCoalesced(void)
+{
+    _initItem();
+    _structureScanItem->cameraCalc()->adjustedFootprintSide()->setRawValue(5);
+    QCoreApplication::processEvents();
+
+    double  scanDistance    = _structureScanItem->complexDistance();
+    int     cameraShots     = _structureScanItem->cameraShots();
+    QVERIFY(scanDistance > 0);
+    QVERIFY(cameraShots > 0);
+
+    // Several edits in a row must only be recalculated once, after control returns to the event loop
+    QSignalSpy distanceSpy(_structureScanItem, &StructureScanComplexItem::complexDistanceChanged);
+    QSignalSpy shotsSpy(_structureScanItem, &StructureScanComplexItem::cameraShotsChanged);
+    _structureScanItem->layers()->setRawValue(3);
+    _structureScanItem->cameraCalc()->distanceToSurface()->setRawValue(_structureScanItem->cameraCalc()->distanceToSurface()->rawValue().toDouble() + 5);
+    _structureScanItem->cameraCalc()->adjustedFootprintSide()->setRawValue(4);
+    QCOMPARE(distanceSpy.count(), 0);
+    QCOMPARE(shotsSpy.count(), 0);
+
+    QCoreApplication::processEvents();
+    QCOMPARE(distanceSpy.count(), 1);
+    QCOMPARE(shotsSpy.count(), 1);
+    QVERIFY(_structureScanItem->complexDistance() > scanDistance);
+    QVERIFY(_structureScanItem->cameraShots() > cameraShots);
+}
@@ -29,6 +29,7 @@ private slots:
     void _testDirty(void);
     void _testSaveLoad(void);
     void _testItemCount(void);
+    void _testRecalcCoalesced(void);
 
 private:
     void _initItem(void);
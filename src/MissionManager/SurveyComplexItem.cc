@@ -19,6 +19,7 @@
 #include "QGCApplication.h"
 
 #include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(SurveyComplexItemLog, "SurveyComplexItemLog")
 
@@ -469,7 +470,7 @@ bool SurveyComplexItem::_gridAngleIsNorthSouthTransects()
     return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
 }
 
-void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+void SurveyComplexItem::_adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects)
 {
     if (transects.count() == 0) {
         return;
@@ -478,10 +479,10 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
     bool reversePoints = false;
     bool reverseTransects = false;
 
-    if (_entryPoint == EntryLocationBottomLeft || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationBottomLeft || entryPoint == EntryLocationBottomRight) {
         reversePoints = true;
     }
-    if (_entryPoint == EntryLocationTopRight || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationTopRight || entryPoint == EntryLocationBottomRight) {
         reverseTransects = true;
     }
 
@@ -494,7 +495,7 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
         _reverseTransectOrder(transects);
     }
 
-    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << _entryPoint;
+    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << entryPoint;
 }
 
 QPointF SurveyComplexItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
@@ -671,23 +672,6 @@ double SurveyComplexItem::_turnaroundDistance(void) const
 }
 
 void SurveyComplexItem::_rebuildTransectsPhase1(void)
-{
-    bool split = splitConcavePolygons()->rawValue().toBool();
-	if (split) {
-		_rebuildTransectsPhase1WorkerSplitPolygons(false /* refly */);
-	} else {
-		_rebuildTransectsPhase1WorkerSinglePolygon(false /* refly */);
-	}
-    if (_refly90DegreesFact.rawValue().toBool()) {
-    	if (split) {
-    		_rebuildTransectsPhase1WorkerSplitPolygons(true /* refly */);
-    	} else {
-    		_rebuildTransectsPhase1WorkerSinglePolygon(true /* refly */);
-    	}
-    }
-}
-
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
 {
     if (_ignoreRecalc) {
         return;
@@ -700,282 +684,131 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         _loadedMissionItemsParent = nullptr;
     }
 
-    if (_surveyAreaPolygon.count() < 3) {
-        return;
-    }
-
-    // Convert polygon to NED
-
-    QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
-        if (i == 0) {
-            // This avoids a nan calculation that comes out of convertGeoToNed
-            x = y = 0;
-        } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-        }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
-    }
-
-    // Generate transects
-
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
-    if (gridSpacing < 0.5) {
-        // We can't let gridSpacing get too small otherwise we will end up with too many transects.
-        // So we limit to 0.5 meter spacing as min and set to huge value which will cause a single
-        // transect to be added.
-        gridSpacing = 100000;
-    }
-
-    gridAngle = _clampGridAngle90(gridAngle);
-    gridAngle += refly ? 90 : 0;
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Clamped grid angle" << gridAngle;
-
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
-
-    // Convert polygon to bounding rect
-
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Polygon";
-    QPolygonF polygon;
-    for (int i=0; i<polygonPoints.count(); i++) {
-        qCDebug(SurveyComplexItemLog) << "Vertex" << polygonPoints[i];
-        polygon << polygonPoints[i];
-    }
-    polygon << polygonPoints[0];
-    QRectF boundingRect = polygon.boundingRect();
-    QPointF boundingCenter = boundingRect.center();
-    qCDebug(SurveyComplexItemLog) << "Bounding rect" << boundingRect.topLeft().x() << boundingRect.topLeft().y() << boundingRect.bottomRight().x() << boundingRect.bottomRight().y();
-
-    // Create set of rotated parallel lines within the expanded bounding rect. Make the lines larger than the
-    // bounding box to guarantee intersection.
-
-    QList<QLineF> lineList;
-
-    // Transects are generated to be as long as the largest width/height of the bounding rect plus some fudge factor.
-    // This way they will always be guaranteed to intersect with a polygon edge no matter what angle they are rotated to.
-    // They are initially generated with the transects flowing from west to east and then points within the transect north to south.
-    double maxWidth = qMax(boundingRect.width(), boundingRect.height()) + 2000.0;
-    double halfWidth = maxWidth / 2.0;
-    double transectX = boundingCenter.x() - halfWidth;
-    double transectXMax = transectX + maxWidth;
-    while (transectX < transectXMax) {
-        double transectYTop = boundingCenter.y() - halfWidth;
-        double transectYBottom = boundingCenter.y() + halfWidth;
-
-        lineList += QLineF(_rotatePoint(QPointF(transectX, transectYTop), boundingCenter, gridAngle), _rotatePoint(QPointF(transectX, transectYBottom), boundingCenter, gridAngle));
-        transectX += gridSpacing;
-    }
-
-    // Now intersect the lines with the polygon
-    QList<QLineF> intersectLines;
-#if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-#else
-    // This is handy for debugging grid problems, not for release
-    intersectLines = lineList;
-#endif
-
-    // Less than two transects intersected with the polygon:
-    //      Create a single transect which goes through the center of the polygon
-    //      Intersect it with the polygon
-    if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
-        QLineF firstLine = lineList.first();
-        QPointF lineCenter = firstLine.pointAt(0.5);
-        QPointF centerOffset = boundingCenter - lineCenter;
-        firstLine.translate(centerOffset);
-        lineList.clear();
-        lineList.append(firstLine);
-        intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
-    }
-
-    // Make sure all lines are going the same direction. Polygon intersection leads to lines which
-    // can be in varied directions depending on the order of the intesecting sides.
-    QList<QLineF> resultLines;
-    _adjustLineDirection(intersectLines, resultLines);
-
-    // Convert from NED to Geo
-    QList<QList<QGeoCoordinate>> transects;
-    for (const QLineF& line : resultLines) {
-        QGeoCoordinate          coord;
-        QList<QGeoCoordinate>   transect;
-
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-
-        transects.append(transect);
-    }
-
-    _adjustTransectsToEntryPointLocation(transects);
-
-    if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
-    }
-
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
-        QList<QList<QGeoCoordinate>> alternatingTransects;
-        for (int i=0; i<transects.count(); i++) {
-            if (!(i & 1)) {
-                alternatingTransects.append(transects[i]);
-            }
-        }
-        for (int i=transects.count()-1; i>0; i--) {
-            if (i & 1) {
-                alternatingTransects.append(transects[i]);
-            }
-        }
-        transects = alternatingTransects;
-    }
-
-    // Adjust to lawnmower pattern
-    bool reverseVertices = false;
-    for (int i=0; i<transects.count(); i++) {
-        // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-        QList<QGeoCoordinate> transectVertices = transects[i];
-        if (reverseVertices) {
-            reverseVertices = false;
-            QList<QGeoCoordinate> reversedVertices;
-            for (int j=transectVertices.count()-1; j>=0; j--) {
-                reversedVertices.append(transectVertices[j]);
-            }
-            transectVertices = reversedVertices;
-        } else {
-            reverseVertices = true;
-        }
-        transects[i] = transectVertices;
-    }
-
-    // Convert to CoordInfo transects and append to _transects
-    for (const QList<QGeoCoordinate>& transect : transects) {
-        QGeoCoordinate                                  coord;
-        QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
-        TransectStyleComplexItem::CoordInfo_t           coordInfo;
-
-        coordInfo = { transect[0], CoordTypeSurveyEntry };
-        coordInfoTransect.append(coordInfo);
-        coordInfo = { transect[1], CoordTypeSurveyExit };
-        coordInfoTransect.append(coordInfo);
-
-        // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
-            double transectLength = transect[0].distanceTo(transect[1]);
-            double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
-                qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
-                for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
-                    TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
-                    coordInfoTransect.insert(1 + i, coordInfo);
-                }
-            }
-        }
-
-        // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
-            QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
-
-            double azimuth = transect[0].azimuthTo(transect[1]);
-            turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
-            turnaroundCoord.setAltitude(qQNaN());
-            TransectStyleComplexItem::CoordInfo_t coordInfo = { turnaroundCoord, CoordTypeTurnaround };
-            coordInfoTransect.prepend(coordInfo);
+    _transects = _buildTransects(_transectParams(), []() { return false; });
+}
 
-            azimuth = transect.last().azimuthTo(transect[transect.count() - 2]);
-            turnaroundCoord = transect.last().atDistanceAndAzimuth(-turnAroundDistance, azimuth);
-            turnaroundCoord.setAltitude(qQNaN());
-            coordInfo = { turnaroundCoord, CoordTypeTurnaround };
-            coordInfoTransect.append(coordInfo);
-        }
+SurveyComplexItem::TransectsJob_t SurveyComplexItem::_rebuildTransectsPhase1Job(void)
+{
+    TransectParams_t params = _transectParams();
 
-        _transects.append(coordInfoTransect);
-    }
+    return [params](const TransectsCanceled_t& canceled) {
+        return _buildTransects(params, canceled);
+    };
 }
 
-
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
+/// @return Snapshot of everything needed to build the transects
+SurveyComplexItem::TransectParams_t SurveyComplexItem::_transectParams(void) const
 {
-    if (_ignoreRecalc) {
-        return;
-    }
+    TransectParams_t params;
+
+    params.polygon                  = _surveyAreaPolygon.coordinateList();
+    params.gridAngle                = _gridAngleFact.rawValue().toDouble();
+    params.gridSpacing              = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    params.entryPoint               = _entryPoint;
+    params.flyAlternateTransects    = _flyAlternateTransectsFact.rawValue().toBool();
+    params.splitConcavePolygons     = _splitConcavePolygonsFact.rawValue().toBool();
+    params.refly90Degrees           = _refly90DegreesFact.rawValue().toBool();
+    params.hoverAndCapture          = triggerCamera() && hoverAndCaptureEnabled();
+    params.triggerDistance          = triggerDistance();
+    params.hasTurnaround            = _hasTurnaround();
+    params.turnAroundDistance       = _turnAroundDistanceFact.rawValue().toDouble();
+
+    return params;
+}
 
-    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
-    if (_loadedMissionItemsParent) {
-        _loadedMissionItems.clear();
-        _loadedMissionItemsParent->deleteLater();
-        _loadedMissionItemsParent = nullptr;
-    }
+/// Builds the full set of transects, including the refly transects if needed. Safe to call from any thread.
+///
+/// If concave polygons are split, the transect lines for each convex sub polygon are generated in parallel. Ordering
+/// the transects depends on where the previous polygon ended so that part is done in sequence afterwards.
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> SurveyComplexItem::_buildTransects(const TransectParams_t& params, const TransectsCanceled_t& canceled)
+{
+    QList<QList<CoordInfo_t>> transects;
 
-    if (_surveyAreaPolygon.count() < 3) {
-        return;
+    if (params.polygon.count() < 3) {
+        return transects;
     }
 
     // Convert polygon to NED
 
-    QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
+    QPolygonF       polygon;
+    QGeoCoordinate  tangentOrigin = params.polygon[0];
+    qCDebug(SurveyComplexItemLog) << "_buildTransects Convert polygon to NED - count:tangentOrigin" << params.polygon.count() << tangentOrigin;
+    polygon.reserve(params.polygon.count() + 1);
+    LocalTangentFrame frame(tangentOrigin);
+    for (int i=0; i<params.polygon.count(); i++) {
+        double y, x;
         if (i == 0) {
             // This avoids a nan calculation that comes out of convertGeoToNed
             x = y = 0;
         } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
+            frame.toNed(params.polygon[i], &y, &x, nullptr);
         }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
-    }
+        polygon << QPointF(x, y);
+        qCDebug(SurveyComplexItemLog) << "_buildTransects vertex:x:y" << params.polygon[i] << x << y;
+    }
+
+    QList<PolygonInfo_t> polygonInfos;
+    if (params.splitConcavePolygons) {
+        // Create list of separate polygons
+        QList<QPolygonF> polygons;
+        _PolygonDecomposeConvex(polygon, polygons);
+
+        for (int i=0; i<polygons.count(); i++) {
+            PolygonInfo_t polygonInfo = { polygons[i], false, QPointF() };
+
+            // find matching vertex in previous polygon
+            if (i != 0) {
+                for (const QPointF& vertex: polygons[i]) {
+                    for (const QPointF& previousVertex: polygons[i - 1]) {
+                        if (vertex == previousVertex) {
+                            polygonInfo.hasTransitionPoint  = true;
+                            polygonInfo.transitionPoint     = vertex;
+                            break;
+                        }
+                        if (polygonInfo.hasTransitionPoint) {
+                            break;
+                        }
+                    }
+                }
+            }
 
-    // convert into QPolygonF
-    QPolygonF polygon;
-    for (int i=0; i<polygonPoints.count(); i++) {
-        qCDebug(SurveyComplexItemLog) << "Vertex" << polygonPoints[i];
-        polygon << polygonPoints[i];
+            // close polygon
+            polygonInfo.polygon << polygonInfo.polygon.front();
+            polygonInfos.append(polygonInfo);
+        }
+    } else {
+        polygon << polygon.front();
+        polygonInfos.append({ polygon, false, QPointF() });
     }
 
-    // Create list of separate polygons
-    QList<QPolygonF> polygons{};
-    _PolygonDecomposeConvex(polygon, polygons);
-
-    // iterate over polygons
-    for (auto p = polygons.begin(); p != polygons.end(); ++p) {
-        QPointF* vMatch = nullptr;
-        // find matching vertex in previous polygon
-        if (p != polygons.begin()) {
-            auto pLast = p - 1;
-            for (auto& i : *p) {
-                for (auto& j : *pLast) {
-                   if (i == j) {
-                       vMatch = &i;
-                       break;
-                   }
-                   if (vMatch) break;
-                }
-            }
+    for (int pass=0; pass<(params.refly90Degrees ? 2 : 1); pass++) {
+        bool                                refly = pass == 1;
+        QList<QList<QList<QGeoCoordinate>>> polygonTransectLines;
 
+        if (polygonInfos.count() == 1) {
+            polygonTransectLines.append(_buildPolygonTransectLines(params, refly, polygonInfos[0], tangentOrigin));
+        } else {
+            QList<QFuture<QList<QList<QGeoCoordinate>>>> futures;
+            for (const PolygonInfo_t& polygonInfo: polygonInfos) {
+                futures.append(QtConcurrent::run(&SurveyComplexItem::_buildPolygonTransectLines, params, refly, polygonInfo, tangentOrigin));
+            }
+            for (QFuture<QList<QList<QGeoCoordinate>>>& future: futures) {
+                polygonTransectLines.append(future.result());
+            }
         }
 
+        if (canceled()) {
+            return QList<QList<CoordInfo_t>>();
+        }
 
-        // close polygon
-        *p << p->front();
-        // build transects for this polygon
-        // TODO figure out tangent origin
-        // TODO improve selection of entry points
-//        qCDebug(SurveyComplexItemLog) << "Transects from polynom p " << p;
-        _rebuildTransectsFromPolygon(refly, *p, tangentOrigin, vMatch);
+        for (QList<QList<QGeoCoordinate>>& transectLines: polygonTransectLines) {
+            _appendPolygonTransects(params, refly, transectLines, transects);
+        }
     }
+
+    qCDebug(SurveyComplexItemLog) << "_buildTransects transects.size()" << transects.size();
+
+    return transects;
 }
 
 void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons)
@@ -1126,22 +959,32 @@ bool SurveyComplexItem::_VertexIsReflex(const QPolygonF& polygon, const QPointF*
 }
 
 
-void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint)
+/// Generates the transect lines which cover a single convex polygon
+///     @param polygon Closed polygon in NED relative to tangentOrigin
+/// @return Transect lines in geo coordinates, each with an entry and exit point
+QList<QList<QGeoCoordinate>> SurveyComplexItem::_buildPolygonTransectLines(const TransectParams_t& params, bool refly, const PolygonInfo_t& polygonInfo, const QGeoCoordinate& tangentOrigin)
 {
+    const QPolygonF& polygon = polygonInfo.polygon;
+
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = params.gridAngle;
+    double gridSpacing = params.gridSpacing;
+    if (gridSpacing < 0.5) {
+        // We can't let gridSpacing get too small otherwise we will end up with too many transects.
+        // So we limit to 0.5 meter spacing as min and set to huge value which will cause a single
+        // transect to be added.
+        gridSpacing = 100000;
+    }
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Clamped grid angle" << gridAngle;
+    qCDebug(SurveyComplexItemLog) << "_buildPolygonTransectLines Clamped grid angle" << gridAngle;
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
+    qCDebug(SurveyComplexItemLog) << "_buildPolygonTransectLines gridSpacing:gridAngle:refly" << gridSpacing << gridAngle << refly;
 
     // Convert polygon to bounding rect
 
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Polygon";
     QRectF boundingRect = polygon.boundingRect();
     QPointF boundingCenter = boundingRect.center();
     qCDebug(SurveyComplexItemLog) << "Bounding rect" << boundingRect.topLeft().x() << boundingRect.topLeft().y() << boundingRect.bottomRight().x() << boundingRect.bottomRight().y();
@@ -1158,6 +1001,7 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     double halfWidth = maxWidth / 2.0;
     double transectX = boundingCenter.x() - halfWidth;
     double transectXMax = transectX + maxWidth;
+    lineList.reserve(static_cast<int>(maxWidth / gridSpacing) + 1);
     while (transectX < transectXMax) {
         double transectYTop = boundingCenter.y() - halfWidth;
         double transectYBottom = boundingCenter.y() + halfWidth;
@@ -1179,7 +1023,6 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     //      Create a single transect which goes through the center of the polygon
     //      Intersect it with the polygon
     if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
         QLineF firstLine = lineList.first();
         QPointF lineCenter = firstLine.pointAt(0.5);
         QPointF centerOffset = boundingCenter - lineCenter;
@@ -1197,54 +1040,63 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
 
     // Convert from NED to Geo
     QList<QList<QGeoCoordinate>> transects;
+    transects.reserve(resultLines.count() + 1);
+
+    LocalTangentFrame frame(tangentOrigin);
 
-    if (transitionPoint != nullptr) {
+    if (polygonInfo.hasTransitionPoint) {
         QList<QGeoCoordinate>   transect;
-        QGeoCoordinate          coord;
-        convertNedToGeo(transitionPoint->y(), transitionPoint->x(), 0, tangentOrigin, &coord);
+        QGeoCoordinate          coord = frame.fromNed(polygonInfo.transitionPoint.y(), polygonInfo.transitionPoint.x(), 0);
         transect.append(coord);
         transect.append(coord); //TODO
         transects.append(transect);
     }
 
     for (const QLineF& line: resultLines) {
-        QList<QGeoCoordinate>   transect;
-        QGeoCoordinate          coord;
+        QList<QGeoCoordinate> transect;
 
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
+        transect.append(frame.fromNed(line.p1().y(), line.p1().x(), 0));
+        transect.append(frame.fromNed(line.p2().y(), line.p2().x(), 0));
 
         transects.append(transect);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
+    return transects;
+}
+
+/// Orders the transect lines for a single polygon and appends them to transects as CoordInfo transects
+void SurveyComplexItem::_appendPolygonTransects(const TransectParams_t& params, bool refly, QList<QList<QGeoCoordinate>>& transectLines, QList<QList<CoordInfo_t>>& transects)
+{
+    if (transectLines.isEmpty()) {
+        return;
+    }
+
+    _adjustTransectsToEntryPointLocation(params.entryPoint, transectLines);
 
-    if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+    if (refly && !transects.isEmpty()) {
+        _optimizeTransectsForShortestDistance(transects.last().last().coord, transectLines);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (params.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
-        for (int i=0; i<transects.count(); i++) {
+        for (int i=0; i<transectLines.count(); i++) {
             if (!(i & 1)) {
-                alternatingTransects.append(transects[i]);
+                alternatingTransects.append(transectLines[i]);
             }
         }
-        for (int i=transects.count()-1; i>0; i--) {
+        for (int i=transectLines.count()-1; i>0; i--) {
             if (i & 1) {
-                alternatingTransects.append(transects[i]);
+                alternatingTransects.append(transectLines[i]);
             }
         }
-        transects = alternatingTransects;
+        transectLines = alternatingTransects;
     }
 
     // Adjust to lawnmower pattern
     bool reverseVertices = false;
-    for (int i=0; i<transects.count(); i++) {
+    for (int i=0; i<transectLines.count(); i++) {
         // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-        QList<QGeoCoordinate> transectVertices = transects[i];
+        QList<QGeoCoordinate> transectVertices = transectLines[i];
         if (reverseVertices) {
             reverseVertices = false;
             QList<QGeoCoordinate> reversedVertices;
@@ -1255,12 +1107,11 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         } else {
             reverseVertices = true;
         }
-        transects[i] = transectVertices;
+        transectLines[i] = transectVertices;
     }
 
-    // Convert to CoordInfo transects and append to _transects
-    for (const QList<QGeoCoordinate>& transect: transects) {
-        QGeoCoordinate                                  coord;
+    // Convert to CoordInfo transects and append to transects
+    for (const QList<QGeoCoordinate>& transect: transectLines) {
         QList<TransectStyleComplexItem::CoordInfo_t>    coordInfoTransect;
         TransectStyleComplexItem::CoordInfo_t           coordInfo;
 
@@ -1270,14 +1121,14 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (params.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (params.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / params.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(params.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -1285,9 +1136,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (params.hasTurnaround) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = params.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -1302,9 +1153,8 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        transects.append(coordInfoTransect);
     }
-    qCDebug(SurveyComplexItemLog) << "_transects.size() " << _transects.size();
 }
 
 void SurveyComplexItem::_recalcCameraShots(void)
@@ -14,6 +14,8 @@
 #include "SettingsFact.h"
 #include "QGCLoggingCategory.h"
 
+#include <QPolygonF>
+
 Q_DECLARE_LOGGING_CATEGORY(SurveyComplexItemLog)
 
 class PlanMasterController;
@@ -100,21 +102,42 @@ private:
         CameraTriggerHoverAndCapture
     };
 
-    QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
-    void _intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines);
-    void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
-    void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
+    /// Snapshot of the settings used to build transects, so they can be built away from the gui thread
+    typedef struct {
+        QList<QGeoCoordinate>   polygon;
+        double                  gridAngle;
+        double                  gridSpacing;
+        int                     entryPoint;
+        bool                    flyAlternateTransects;
+        bool                    splitConcavePolygons;
+        bool                    refly90Degrees;
+        bool                    hoverAndCapture;        ///< true: add hover and capture points within each transect
+        double                  triggerDistance;
+        bool                    hasTurnaround;
+        double                  turnAroundDistance;
+    } TransectParams_t;
+
+    typedef struct {
+        QPolygonF   polygon;
+        bool        hasTransitionPoint;
+        QPointF     transitionPoint;    ///< Vertex shared with the previous polygon from a split
+    } PolygonInfo_t;
+
+    static QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
+    static void _intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines);
+    static void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
+    static void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
     bool _nextTransectCoord(const QList<QGeoCoordinate>& transectPoints, int pointIndex, QGeoCoordinate& coord);
     bool _appendMissionItemsWorker(QList<MissionItem*>& items, QObject* missionItemParent, int& seqNum, bool hasRefly, bool buildRefly);
-    void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
-    qreal _ccw(QPointF pt1, QPointF pt2, QPointF pt3);
-    qreal _dp(QPointF pt1, QPointF pt2);
-    void _swapPoints(QList<QPointF>& points, int index1, int index2);
-    void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
-    void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
-    void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects);
+    static void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
+    static qreal _ccw(QPointF pt1, QPointF pt2, QPointF pt3);
+    static qreal _dp(QPointF pt1, QPointF pt2);
+    static void _swapPoints(QList<QPointF>& points, int index1, int index2);
+    static void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
+    static void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
+    static void _adjustTransectsToEntryPointLocation(int entryPoint, QList<QList<QGeoCoordinate>>& transects);
     bool _gridAngleIsNorthSouthTransects();
-    double _clampGridAngle90(double gridAngle);
+    static double _clampGridAngle90(double gridAngle);
     bool _imagesEverywhere(void) const;
     bool _triggerCamera(void) const;
     bool _hasTurnaround(void) const;
@@ -123,16 +146,16 @@ private:
     bool _loadV3(const QJsonObject& complexObject, int sequenceNumber, QString& errorString);
     bool _loadV4V5(const QJsonObject& complexObject, int sequenceNumber, QString& errorString, int version, bool forPresets);
     void _saveCommon(QJsonObject& complexObject);
-    void _rebuildTransectsPhase1Worker(bool refly);
-    void _rebuildTransectsPhase1WorkerSinglePolygon(bool refly);
-    void _rebuildTransectsPhase1WorkerSplitPolygons(bool refly);
-    /// Adds to the _transects array from one polygon
-    void _rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint);
+    TransectParams_t _transectParams(void) const;
+    TransectsJob_t _rebuildTransectsPhase1Job(void) final;
+    static QList<QList<CoordInfo_t>> _buildTransects(const TransectParams_t& params, const TransectsCanceled_t& canceled);
+    static QList<QList<QGeoCoordinate>> _buildPolygonTransectLines(const TransectParams_t& params, bool refly, const PolygonInfo_t& polygonInfo, const QGeoCoordinate& tangentOrigin);
+    static void _appendPolygonTransects(const TransectParams_t& params, bool refly, QList<QList<QGeoCoordinate>>& transectLines, QList<QList<CoordInfo_t>>& transects);
     // Decompose polygon into list of convex sub polygons
-    void _PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons);
+    static void _PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons);
     // return true if vertex a can see vertex b
-    bool _VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB);
-    bool _VertexIsReflex(const QPolygonF& polygon, const QPointF* vertex);
+    static bool _VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB);
+    static bool _VertexIsReflex(const QPolygonF& polygon, const QPointF* vertex);
 
     QMap<QString, FactMetaData*> _metaDataMap;
 
@@ -22,6 +22,7 @@
 #include "MissionCommandUIInfo.h"
 
 #include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(TransectStyleComplexItemLog, "TransectStyleComplexItemLog")
 
@@ -121,9 +122,18 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
 
     connect(&_surveyAreaPolygon,                        &QGCMapPolygon::isValidChanged, this, &TransectStyleComplexItem::readyForSaveStateChanged);
 
+    connect(&_transectsJobWatcher,                      &QFutureWatcherBase::finished,  this, &TransectStyleComplexItem::_transectsJobFinished);
+
     setDirty(false);
 }
 
+TransectStyleComplexItem::~TransectStyleComplexItem()
+{
+    // Cancel and wait for any background job, its results are no longer needed
+    (*_transectsGeneration)++;
+    _transectsJobWatcher.waitForFinished();
+}
+
 void TransectStyleComplexItem::_setCameraShots(int cameraShots)
 {
     if (_cameraShots != cameraShots) {
@@ -407,12 +417,72 @@ void TransectStyleComplexItem::_rebuildTransects(void)
         return;
     }
 
+    // Any job still running is now out of date
+    int generation = ++(*_transectsGeneration);
+
+    // Interactive edits of an existing item build the transects in the background so the ui doesn't block on large
+    // areas. The first build, loads and unit tests stay synchronous so the results are available immediately.
+    TransectsJob_t job;
+    if (!_flyView && !qgcApp()->runningUnitTests() && !_transects.isEmpty()) {
+        job = _rebuildTransectsPhase1Job();
+    }
+
+    if (job) {
+        // If the transects are getting rebuilt then any previously loaded mission items are now invalid
+        if (_loadedMissionItemsParent) {
+            _loadedMissionItems.clear();
+            _loadedMissionItemsParent->deleteLater();
+            _loadedMissionItemsParent = nullptr;
+        }
+
+        std::shared_ptr<std::atomic<int>> generationCounter = _transectsGeneration;
+        TransectsCanceled_t canceled = [generationCounter, generation]() { return generationCounter->load() != generation; };
+
+        qCDebug(TransectStyleComplexItemLog) << "_rebuildTransects starting background job" << generation;
+        bool wasPending = _transectsJobPending();
+        _transectsJobGeneration = generation;
+        _transectsJobWatcher.setFuture(QtConcurrent::run([job, canceled]() { return job(canceled); }));
+        if (!wasPending) {
+            emit readyForSaveStateChanged();
+        }
+        return;
+    }
+
+    if (_transectsJobPending()) {
+        _transectsJobGeneration = -1;
+        emit readyForSaveStateChanged();
+    }
+
     _transects.clear();
     _rgPathHeightInfo.clear();
     _rgFlightPathCoordInfo.clear();
 
     _rebuildTransectsPhase1();
+    _rebuildTransectsPhase2();
+}
+
+void TransectStyleComplexItem::_transectsJobFinished(void)
+{
+    if (_transectsJobGeneration == -1 || _transectsJobGeneration != _transectsGeneration->load()) {
+        // Superseded by a later rebuild
+        return;
+    }
+
+    qCDebug(TransectStyleComplexItemLog) << "_transectsJobFinished" << _transectsJobGeneration;
+
+    // The new transects replace the old ones all at once
+    _transectsJobGeneration = -1;
+    _transects = _transectsJobWatcher.result();
+    _rgPathHeightInfo.clear();
+    _rgFlightPathCoordInfo.clear();
+
+    _rebuildTransectsPhase2();
+    emit readyForSaveStateChanged();
+}
 
+/// Updates everything which is calculated from the transects
+void TransectStyleComplexItem::_rebuildTransectsPhase2(void)
+{
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
     switch (_cameraCalc.distanceMode()) {
@@ -574,6 +644,7 @@ void TransectStyleComplexItem::_queryTransectsPathHeightInfo(void)
     if (_transects.count()) {
         // We don't actually send the query until this timer times out. This way we only send
         // the latest request if we get a bunch in a row.
+        _setTerrainQueryProgress(0);
         _terrainPolyPathQueryTimer.start();
     }
 }
@@ -592,7 +663,8 @@ void TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo(void)
         _currentTerrainAtCoordinateQuery = nullptr;
     }
 
-    // Append all transects into a single PolyPath query
+    // Append all transects into a single PolyPath query. The query is sent as one batch, which only fetches each
+    // needed terrain tile once no matter how many transects pass through it.
     QList<QGeoCoordinate> transectPoints;
     for (const QList<CoordInfo_t>& transect: _transects) {
         for (const CoordInfo_t& coordInfo: transect) {
@@ -601,9 +673,21 @@ void TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo(void)
     }
 
     if (transectPoints.count() > 1) {
+        _setTerrainQueryProgress(0);
         _currentTerrainPolyPathQuery = new TerrainPolyPathQuery(true /* autoDelete */);
-        connect(_currentTerrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, &TransectStyleComplexItem::_polyPathTerrainData);
+        connect(_currentTerrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived,  this, &TransectStyleComplexItem::_polyPathTerrainData);
+        connect(_currentTerrainPolyPathQuery, &TerrainPolyPathQuery::progressChanged,      this, &TransectStyleComplexItem::_setTerrainQueryProgress);
         _currentTerrainPolyPathQuery->requestData(transectPoints);
+    } else {
+        _setTerrainQueryProgress(1);
+    }
+}
+
+void TransectStyleComplexItem::_setTerrainQueryProgress(double progress)
+{
+    if (!QGC::fuzzyCompare(progress, _terrainQueryProgress)) {
+        _terrainQueryProgress = progress;
+        emit terrainQueryProgressChanged();
     }
 }
 
@@ -652,6 +736,7 @@ void TransectStyleComplexItem::_polyPathTerrainData(bool success, const QList<Te
         emit readyForSaveStateChanged();
     }
     _currentTerrainPolyPathQuery = nullptr;
+    _setTerrainQueryProgress(1);
 }
 
 void TransectStyleComplexItem::_missionItemCoordTerrainData(bool success, QList<double> heights)
@@ -686,7 +771,7 @@ TransectStyleComplexItem::ReadyForSaveState TransectStyleComplexItem::readyForSa
         terrainReady = true;
     }
     bool polygonNotReady = !_surveyAreaPolygon.isValid();
-    return (polygonNotReady || _wizardMode) ?
+    return (polygonNotReady || _wizardMode || _transectsJobPending()) ?
                 NotReadyForSaveData :
                 (terrainReady ? ReadyForSave : NotReadyForSaveTerrain);
 }
@@ -1337,6 +1422,11 @@ void TransectStyleComplexItem::addKMLVisuals(KMLPlanDomDocument& domDocument)
     domDocument.appendChildToRoot(placemarkElement);
 }
 
+void TransectStyleComplexItem::addKMLVisuals(KMLPlanStreamWriter& kmlWriter)
+{
+    kmlWriter.addPolygonPlacemark(QStringLiteral("Survey Area"), _surveyAreaPolygon.coordinateList(), KMLPlanDomDocument::surveyPolygonStyleName);
+}
+
 void TransectStyleComplexItem::_recalcComplexDistance(void)
 {
     _complexDistance = 0;
@@ -18,6 +18,12 @@
 #include "CameraCalc.h"
 #include "TerrainQuery.h"
 
+#include <QFutureWatcher>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
 Q_DECLARE_LOGGING_CATEGORY(TransectStyleComplexItemLog)
 
 class PlanMasterController;
@@ -28,6 +34,7 @@ class TransectStyleComplexItem : public ComplexMissionItem
 
 public:
     TransectStyleComplexItem(PlanMasterController* masterController, bool flyView, QString settignsGroup);
+    ~TransectStyleComplexItem();
 
     Q_PROPERTY(QGCMapPolygon*   surveyAreaPolygon           READ surveyAreaPolygon                                  CONSTANT)
     Q_PROPERTY(CameraCalc*      cameraCalc                  READ cameraCalc                                         CONSTANT)
@@ -41,6 +48,7 @@ public:
     Q_PROPERTY(double           coveredArea                 READ coveredArea                                        NOTIFY coveredAreaChanged)
     Q_PROPERTY(bool             hoverAndCaptureAllowed      READ hoverAndCaptureAllowed                             CONSTANT)
     Q_PROPERTY(QVariantList     visualTransectPoints        READ visualTransectPoints                               NOTIFY visualTransectPointsChanged)
+    Q_PROPERTY(double           terrainQueryProgress        READ terrainQueryProgress                               NOTIFY terrainQueryProgressChanged)     ///< 0-1, 1 when no terrain query is outstanding
 
     Q_PROPERTY(Fact*            terrainAdjustTolerance      READ terrainAdjustTolerance                             CONSTANT)
     Q_PROPERTY(Fact*            terrainAdjustMaxDescentRate READ terrainAdjustMaxDescentRate                        CONSTANT)
@@ -62,6 +70,7 @@ public:
 
     int             cameraShots             (void) const { return _cameraShots; }
     double          coveredArea             (void) const;
+    double          terrainQueryProgress    (void) const { return _terrainQueryProgress; }
     bool            hoverAndCaptureAllowed  (void) const;
 
     virtual double  timeBetweenShots        (void) { return 0; } // Most be overridden. Implementation here is needed for unit testing.
@@ -78,6 +87,7 @@ public:
     QString mapVisualQML        (void) const override = 0;
     bool    load                (const QJsonObject& complexObject, int sequenceNumber, QString& errorString) override = 0;
     void    addKMLVisuals       (KMLPlanDomDocument& domDocument) final;
+    void    addKMLVisuals       (KMLPlanStreamWriter& kmlWriter) final;
     double  complexDistance     (void) const final { return _complexDistance; }
     double  greatestDistanceTo  (const QGeoCoordinate &other) const final;
 
@@ -124,6 +134,7 @@ signals:
     void timeBetweenShotsChanged        (void);
     void visualTransectPointsChanged    (void);
     void coveredAreaChanged             (void);
+    void terrainQueryProgressChanged    (void);
     void _updateFlightPathSegmentsSignal(void);
 
 protected slots:
@@ -173,6 +184,13 @@ protected:
         CoordType       coordType;
     } CoordInfo_t;
 
+    typedef std::function<bool(void)>                                                       TransectsCanceled_t;    ///< true: a newer rebuild has superseded the job
+    typedef std::function<QList<QList<CoordInfo_t>>(const TransectsCanceled_t& canceled)>   TransectsJob_t;
+
+    /// Returns a job which builds the transects from a snapshot of the current settings. The job is run on a
+    /// background thread so it must not reference the item. No job means _rebuildTransectsPhase1 is used instead.
+    virtual TransectsJob_t _rebuildTransectsPhase1Job(void) { return TransectsJob_t(); }
+
     QVariantList                                _visualTransectPoints;                          ///< Used to draw the flight path visuals on the screen
     QList<QList<CoordInfo_t>>                   _transects;
     QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;                              ///< Path height for each segment includes turn segments
@@ -218,6 +236,8 @@ private slots:
     void _updateFlightPathSegmentsDontCallDirectly  (void);
     void _segmentTerrainCollisionChanged            (bool terrainCollision) final;
     void _distanceModeChanged                       (int distanceMode);
+    void _transectsJobFinished                      (void);
+    void _setTerrainQueryProgress                   (double progress);
 
 private:
     typedef struct {
@@ -239,10 +259,18 @@ private:
     double  _altitudeBetweenCoords                                          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
     int     _maxPathHeight                                                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
     BuildMissionItemsState_t _buildMissionItemsState                        (void) const;
+    void    _rebuildTransectsPhase2                                         (void);
+    bool    _transectsJobPending                                            (void) const { return _transectsJobGeneration != -1; }
 
     TerrainPolyPathQuery*       _currentTerrainPolyPathQuery        = nullptr;
     TerrainAtCoordinateQuery*   _currentTerrainAtCoordinateQuery    = nullptr;
     QTimer                      _terrainPolyPathQueryTimer;
+    double                      _terrainQueryProgress               = 1;
+
+    // Background transect rebuilds. Each rebuild bumps the generation, which cancels any job already running.
+    QFutureWatcher<QList<QList<CoordInfo_t>>>   _transectsJobWatcher;
+    std::shared_ptr<std::atomic<int>>           _transectsGeneration    = std::make_shared<std::atomic<int>>(0);
+    int                                         _transectsJobGeneration = -1;   ///< Generation of the pending job, -1 for none
 
     // Deprecated json keys
     static const char* _jsonTerrainFollowKeyDeprecated;
@@ -273,7 +273,7 @@ Item {
             fileDialog.title =          qsTr("Save KML")
             fileDialog.planFiles =      false
             fileDialog.selectExisting = false
-            fileDialog.nameFilters =    ShapeFileHelper.fileDialogKMLFilters
+            fileDialog.nameFilters =    ShapeFileHelper.fileDialogKMLSaveFilters
             fileDialog.openForSave()
         }
     }
@@ -347,10 +347,17 @@ Item {
         }
 
         onAcceptedForLoad: {
-            _planMasterController.loadFromFile(file)
+            _planMasterController.loadFromFileAsync(file)
+            close()
+        }
+    }
+
+    Connections {
+        target: _planMasterController
+
+        function onLoadFromFileAsyncComplete() {
             _planMasterController.fitViewportToItems()
             _missionController.setCurrentPlanViewSeqNum(0, true)
-            close()
         }
     }
 
@@ -431,6 +438,17 @@ Item {
                 }
             }
 
+            // Terrain shading and flight path terrain clearance
+            TerrainOverlayItem {
+                anchors.fill:       parent
+                map:                editorMap
+                segments:           _missionController.simpleFlightPathSegments
+                clearanceWarning:   QGroundControl.settingsManager.planViewSettings.terrainClearanceWarning.rawValue
+                opacity:            _editingLayer == _layerMission ? 1 : editorMap._nonInteractiveOpacity
+                z:                  QGroundControl.zOrderWaypointLines - 1
+                visible:            QGroundControl.settingsManager.planViewSettings.showTerrainOverlay.rawValue
+            }
+
             // Add lines between waypoints
             MissionLineView {
                 showSpecialVisual:  _missionController.isROIBeginCurrentItem
@@ -108,7 +108,7 @@ TransectStyleComplexItemEditor {
         selectExisting: true
 
         onAcceptedForLoad: {
-            missionItem.surveyAreaPolygon.loadKMLOrSHPFile(file)
+            missionItem.surveyAreaPolygon.loadKMLOrSHPFileAsync(file)
             missionItem.resetState = false
             //editorMap.mapFitFunctions.fitMapViewportTomissionItems()
             close()
@@ -71,4 +71,11 @@ ColumnLayout {
             Layout.fillWidth:   true
         }
     }
+
+    QGCLabel {
+        Layout.fillWidth:   true
+        text:               qsTr("Loading terrain data: %1%").arg(Math.round(missionItem.terrainQueryProgress * 100))
+        wrapMode:           Text.WordWrap
+        visible:            missionItem.cameraCalc.distanceMode === QGroundControl.AltitudeModeCalcAboveTerrain && missionItem.terrainQueryProgress < 1
+    }
 }
@@ -10,6 +10,9 @@
 #include "PositionManager.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#ifndef __mobile__
+#include "GPSManager.h"
+#endif
 
 #if !defined(NO_SERIAL_LINK) && !defined(__android__)
 #include <QSerialPortInfo>
@@ -76,6 +79,11 @@ void QGCPositionManager::setToolbox(QGCToolbox *toolbox)
    }
    _simulatedSource = new SimulatedPosition();
 
+#ifndef __mobile__
+   // Positions parsed from the RTK GPS stream by the GPS driver are used while it is connected
+   connect(toolbox->gpsManager(), &GPSManager::positionInfoUpdated, this, &QGCPositionManager::_gpsManagerPositionUpdated);
+#endif
+
 #if 1
    setPositionSource(QGCPositionSource::InternalGPS);
 #else
@@ -99,13 +107,32 @@ void QGCPositionManager::setNmeaSourceDevice(QIODevice* device)
         _nmeaSource = nullptr;
 
     }
-    _nmeaSource = new QNmeaPositionInfoSource(QNmeaPositionInfoSource::RealTimeMode, this);
+    _nmeaSource = new QGCNmeaPositionSource(this);
     _nmeaSource->setDevice(device);
     // set equivalent range error to enable position accuracy reporting
     _nmeaSource->setUserEquivalentRangeError(5.1);
     setPositionSource(QGCPositionManager::NmeaGPS);
 }
 
+void QGCPositionManager::_sourcePositionUpdated(const QGeoPositionInfo &update)
+{
+    // The RTK GPS is usually located at the GCS and is more accurate, so it takes precedence over other sources
+    // other than a plugin source
+    if (!_usingPluginSource && _gpsManagerPositionTimer.isValid() && _gpsManagerPositionTimer.elapsed() < _gpsManagerPositionTimeoutMsecs) {
+        return;
+    }
+    _positionUpdated(update);
+}
+
+void QGCPositionManager::_gpsManagerPositionUpdated(const QGeoPositionInfo &update)
+{
+    if (_usingPluginSource || !update.isValid()) {
+        return;
+    }
+    _gpsManagerPositionTimer.start();
+    _positionUpdated(update);
+}
+
 void QGCPositionManager::_positionUpdated(const QGeoPositionInfo &update)
 {
     _geoPositionInfo = update;
@@ -179,7 +206,7 @@ void QGCPositionManager::setPositionSource(QGCPositionManager::QGCPositionSource
         _updateInterval = _currentSource->minimumUpdateInterval();
         _currentSource->setPreferredPositioningMethods(QGeoPositionInfoSource::SatellitePositioningMethods);
         _currentSource->setUpdateInterval(_updateInterval);
-        connect(_currentSource, &QGeoPositionInfoSource::positionUpdated,       this, &QGCPositionManager::_positionUpdated);
+        connect(_currentSource, &QGeoPositionInfoSource::positionUpdated,       this, &QGCPositionManager::_sourcePositionUpdated);
         connect(_currentSource, SIGNAL(error(QGeoPositionInfoSource::Error)),   this, SLOT(_error(QGeoPositionInfoSource::Error)));
         _currentSource->startUpdates();
     }
@@ -10,12 +10,13 @@
 #pragma once
 
 #include <QGeoPositionInfoSource>
-#include <QNmeaPositionInfoSource>
+#include <QElapsedTimer>
 
 #include <QVariant>
 
 #include "QGCToolbox.h"
 #include "SimulatedPosition.h"
+#include "QGCNmeaPositionSource.h"
 
 class QGCPositionManager : public QGCTool {
     Q_OBJECT
@@ -51,6 +52,8 @@ public:
 
 private slots:
     void _positionUpdated(const QGeoPositionInfo &update);
+    void _sourcePositionUpdated(const QGeoPositionInfo &update);
+    void _gpsManagerPositionUpdated(const QGeoPositionInfo &update);
     void _error(QGeoPositionInfoSource::Error positioningError);
 
 signals:
@@ -68,7 +71,10 @@ private:
 
     QGeoPositionInfoSource*     _currentSource =        nullptr;
     QGeoPositionInfoSource*     _defaultSource =        nullptr;
-    QNmeaPositionInfoSource*    _nmeaSource =           nullptr;
+    QGCNmeaPositionSource*      _nmeaSource =           nullptr;
     QGeoPositionInfoSource*     _simulatedSource =      nullptr;
     bool                        _usingPluginSource =    false;
+    QElapsedTimer               _gpsManagerPositionTimer;       ///< Time since the last RTK GPS position
+
+    static constexpr int _gpsManagerPositionTimeoutMsecs = 2000;
 };
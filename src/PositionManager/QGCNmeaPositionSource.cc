@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCNmeaPositionSource.h"
+
+#include <QIODevice>
+#include <QtMath>
+
+#include <cstdlib>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(QGCNmeaPositionSourceLog, "QGCNmeaPositionSourceLog")
+
+QGCNmeaPositionSource::QGCNmeaPositionSource(QObject* parent)
+    : QGeoPositionInfoSource(parent)
+{
+    _lineBuffer.reserve(_maxLineLength);
+}
+
+void QGCNmeaPositionSource::setDevice(QIODevice* device)
+{
+    if (_device) {
+        disconnect(_device, nullptr, this, nullptr);
+    }
+    _device = device;
+    if (_running) {
+        startUpdates();
+    }
+}
+
+QGeoPositionInfo QGCNmeaPositionSource::lastKnownPosition(bool /*fromSatellitePositioningMethodsOnly*/) const
+{
+    return _lastPosition;
+}
+
+void QGCNmeaPositionSource::startUpdates(void)
+{
+    _running = true;
+    if (!_device) {
+        return;
+    }
+    if (!_device->isOpen() && !_device->open(QIODevice::ReadOnly)) {
+        qCWarning(QGCNmeaPositionSourceLog) << "Unable to open NMEA device" << _device->errorString();
+        _error = AccessError;
+        emit QGeoPositionInfoSource::error(_error);
+        return;
+    }
+    connect(_device, &QIODevice::readyRead, this, &QGCNmeaPositionSource::_readyRead, Qt::UniqueConnection);
+    _readyRead();
+}
+
+void QGCNmeaPositionSource::stopUpdates(void)
+{
+    _running = false;
+    if (_device) {
+        disconnect(_device, &QIODevice::readyRead, this, &QGCNmeaPositionSource::_readyRead);
+    }
+}
+
+void QGCNmeaPositionSource::requestUpdate(int /*timeout*/)
+{
+    if (_lastPosition.isValid()) {
+        emit positionUpdated(_lastPosition);
+    } else {
+        emit updateTimeout();
+    }
+}
+
+void QGCNmeaPositionSource::_readyRead(void)
+{
+    char buffer[1024];
+
+    while (_device && _device->bytesAvailable() > 0) {
+        const qint64 count = _device->read(buffer, sizeof(buffer));
+        if (count <= 0) {
+            break;
+        }
+        for (qint64 i=0; i<count; i++) {
+            const char c = buffer[i];
+            if (c == '$') {
+                // Start of sentence, drops any partial sentence
+                _lineBuffer.resize(0);
+                _lineBuffer.append(c);
+            } else if (c == '\n' || c == '\r') {
+                if (_lineBuffer.length() > 1) {
+                    parseSentence(_lineBuffer.constData(), _lineBuffer.length());
+                }
+                _lineBuffer.resize(0);
+            } else if (!_lineBuffer.isEmpty() && _lineBuffer.length() < _maxLineLength) {
+                _lineBuffer.append(c);
+            }
+        }
+    }
+}
+
+bool QGCNmeaPositionSource::_checksumValid(const char* sentence, int length)
+{
+    const char* star = static_cast<const char*>(memchr(sentence, '*', static_cast<size_t>(length)));
+    if (!star) {
+        // Checksum is optional
+        return true;
+    }
+    if (star + 2 >= sentence + length) {
+        return false;
+    }
+
+    uint8_t checksum = 0;
+    for (const char* p = sentence + 1; p < star; p++) {
+        checksum ^= static_cast<uint8_t>(*p);
+    }
+    const char hex[3] = { star[1], star[2], 0 };
+    return checksum == static_cast<uint8_t>(strtoul(hex, nullptr, 16));
+}
+
+void QGCNmeaPositionSource::parseSentence(const char* sentence, int length)
+{
+    // Strip line terminators
+    while (length > 0 && (sentence[length - 1] == '\n' || sentence[length - 1] == '\r')) {
+        length--;
+    }
+    if (length < 7 || length >= _maxLineLength || sentence[0] != '$' || !_checksumValid(sentence, length)) {
+        return;
+    }
+
+    // Split in place in a local copy, fields point into it
+    char        line[_maxLineLength];
+    const char* fields[_maxFields];
+    int         fieldCount = 0;
+
+    memcpy(line, sentence, static_cast<size_t>(length));
+    line[length] = 0;
+    if (char* star = strchr(line, '*')) {
+        *star = 0;
+    }
+    fields[fieldCount++] = line + 1;
+    for (char* p = line + 1; *p && fieldCount < _maxFields; p++) {
+        if (*p == ',') {
+            *p = 0;
+            fields[fieldCount++] = p + 1;
+        }
+    }
+
+    // Sentence type without the talker id, so GP/GN/GL... are all handled
+    const char* type = fields[0];
+    if (strlen(type) != 5) {
+        return;
+    }
+    type += 2;
+
+    if (strcmp(type, "GGA") == 0) {
+        _parseGGA(fields, fieldCount);
+    } else if (strcmp(type, "RMC") == 0) {
+        _parseRMC(fields, fieldCount);
+    } else if (strcmp(type, "VTG") == 0) {
+        _parseVTG(fields, fieldCount);
+    } else if (strcmp(type, "GST") == 0) {
+        _parseGST(fields, fieldCount);
+    }
+}
+
+double QGCNmeaPositionSource::_parseLatLon(const char* value, const char* hemisphere)
+{
+    if (!_hasValue(value) || !_hasValue(hemisphere)) {
+        return qQNaN();
+    }
+
+    // [d]ddmm.mmmm
+    const double raw        = strtod(value, nullptr);
+    const double degrees    = qFloor(raw / 100.0);
+    double result = degrees + ((raw - (degrees * 100.0)) / 60.0);
+    if (*hemisphere == 'S' || *hemisphere == 'W') {
+        result = -result;
+    }
+    return result;
+}
+
+QTime QGCNmeaPositionSource::_parseTime(const char* value)
+{
+    // hhmmss[.sss]
+    if (!_hasValue(value) || strlen(value) < 6) {
+        return QTime();
+    }
+    const int       hms     = atoi(value);
+    const double    seconds = strtod(value + 4, nullptr);
+    return QTime(hms / 10000, (hms / 100) % 100, static_cast<int>(seconds), qRound((seconds - qFloor(seconds)) * 1000) % 1000);
+}
+
+bool QGCNmeaPositionSource::_velocityCurrent(void) const
+{
+    return _velocityTimer.isValid() && _velocityTimer.elapsed() < _maxEpochAgeMsecs;
+}
+
+void QGCNmeaPositionSource::_parseGGA(const char* const* fields, int fieldCount)
+{
+    // $GPGGA,time,lat,N,lon,E,quality,numSats,hdop,alt,M,geoidSeparation,M,...
+    if (fieldCount < 10) {
+        return;
+    }
+    _ggaTimer.start();
+
+    const int quality = atoi(fields[6]);
+    if (quality == 0) {
+        return;
+    }
+
+    QGeoCoordinate coordinate(_parseLatLon(fields[2], fields[3]), _parseLatLon(fields[4], fields[5]));
+    if (_hasValue(fields[9])) {
+        coordinate.setAltitude(strtod(fields[9], nullptr));
+    }
+    _hdop = _hasValue(fields[8]) ? strtod(fields[8], nullptr) : qQNaN();
+
+    _emitPosition(coordinate, _parseTime(fields[1]));
+}
+
+void QGCNmeaPositionSource::_parseRMC(const char* const* fields, int fieldCount)
+{
+    // $GPRMC,time,status,lat,N,lon,E,speedKnots,course,ddmmyy,...
+    if (fieldCount < 10) {
+        return;
+    }
+    if (fields[2][0] != 'A') {
+        return;
+    }
+
+    if (strlen(fields[9]) == 6) {
+        const int dmy = atoi(fields[9]);
+        _date = QDate(2000 + (dmy % 100), (dmy / 100) % 100, dmy / 10000);
+    }
+    _groundSpeed    = _hasValue(fields[7]) ? strtod(fields[7], nullptr) * 0.514444 : qQNaN();
+    _direction      = _hasValue(fields[8]) ? strtod(fields[8], nullptr) : qQNaN();
+    _velocityTimer.start();
+
+    // Receivers without GGA only provide the position here
+    if (!_ggaTimer.isValid() || _ggaTimer.elapsed() > _maxEpochAgeMsecs) {
+        _emitPosition(QGeoCoordinate(_parseLatLon(fields[3], fields[4]), _parseLatLon(fields[5], fields[6])), _parseTime(fields[1]));
+    }
+}
+
+void QGCNmeaPositionSource::_parseVTG(const char* const* fields, int fieldCount)
+{
+    // $GPVTG,courseTrue,T,courseMagnetic,M,speedKnots,N,speedKmh,K,...
+    if (fieldCount < 8) {
+        return;
+    }
+    if (_hasValue(fields[1])) {
+        _direction = strtod(fields[1], nullptr);
+    }
+    if (_hasValue(fields[7])) {
+        _groundSpeed = strtod(fields[7], nullptr) / 3.6;
+    }
+    _velocityTimer.start();
+}
+
+void QGCNmeaPositionSource::_parseGST(const char* const* fields, int fieldCount)
+{
+    // $GPGST,time,rms,semiMajor,semiMinor,orientation,latStdDev,lonStdDev,altStdDev
+    if (fieldCount < 9 || !_hasValue(fields[6]) || !_hasValue(fields[7])) {
+        return;
+    }
+    const double latStdDev = strtod(fields[6], nullptr);
+    const double lonStdDev = strtod(fields[7], nullptr);
+    _horizontalAccuracy = qSqrt((latStdDev * latStdDev) + (lonStdDev * lonStdDev));
+    _verticalAccuracy   = _hasValue(fields[8]) ? strtod(fields[8], nullptr) : qQNaN();
+    _accuracyTimer.start();
+}
+
+void QGCNmeaPositionSource::_emitPosition(const QGeoCoordinate& coordinate, const QTime& time)
+{
+    if (!coordinate.isValid()) {
+        return;
+    }
+
+    QDateTime timestamp = QDateTime::currentDateTimeUtc();
+    if (time.isValid()) {
+        timestamp = QDateTime(_date.isValid() ? _date : timestamp.date(), time, Qt::UTC);
+    }
+
+    QGeoPositionInfo info(coordinate, timestamp);
+    if (_velocityCurrent()) {
+        if (!qIsNaN(_groundSpeed)) {
+            info.setAttribute(QGeoPositionInfo::GroundSpeed, _groundSpeed);
+        }
+        if (!qIsNaN(_direction)) {
+            info.setAttribute(QGeoPositionInfo::Direction, _direction);
+        }
+    }
+    if (_accuracyTimer.isValid() && _accuracyTimer.elapsed() < _maxEpochAgeMsecs) {
+        info.setAttribute(QGeoPositionInfo::HorizontalAccuracy, _horizontalAccuracy);
+        if (!qIsNaN(_verticalAccuracy)) {
+            info.setAttribute(QGeoPositionInfo::VerticalAccuracy, _verticalAccuracy);
+        }
+    } else if (!qIsNaN(_hdop)) {
+        info.setAttribute(QGeoPositionInfo::HorizontalAccuracy, _hdop * _uere);
+    }
+
+    _lastPosition = info;
+    if (_running) {
+        emit positionUpdated(info);
+    }
+}
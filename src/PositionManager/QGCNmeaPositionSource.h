@@ -0,0 +1,92 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtPositioning/qgeopositioninfosource.h>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QDate>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCNmeaPositionSourceLog)
+
+class QIODevice;
+
+/// Position source for an NMEA stream (serial port or udp).
+///
+/// Replacement for QNmeaPositionInfoSource which parses each sentence without allocations and emits a position as
+/// soon as the GGA (or RMC if the receiver sends no GGA) sentence of an epoch is received, instead of on an update
+/// interval timer. Speed and course come from RMC/VTG, accuracy from GST if available and from HDOP otherwise.
+class QGCNmeaPositionSource : public QGeoPositionInfoSource
+{
+    Q_OBJECT
+
+public:
+    QGCNmeaPositionSource(QObject* parent = nullptr);
+
+    void setDevice(QIODevice* device);
+
+    /// Used to convert HDOP/VDOP to accuracy in meters when the receiver does not send GST
+    void setUserEquivalentRangeError(double uere) { _uere = uere; }
+
+    /// Parses a single sentence, with or without line terminator. Public for testing.
+    void parseSentence(const char* sentence, int length);
+
+    QGeoPositionInfo lastKnownPosition(bool fromSatellitePositioningMethodsOnly = false) const override;
+
+    PositioningMethods  supportedPositioningMethods (void) const override { return SatellitePositioningMethods; }
+    int                 minimumUpdateInterval       (void) const override { return _minimumUpdateIntervalMsecs; }
+    Error               error                       (void) const override { return _error; }
+
+public slots:
+    void startUpdates   (void) override;
+    void stopUpdates    (void) override;
+    void requestUpdate  (int timeout = 5000) override;
+
+private slots:
+    void _readyRead(void);
+
+private:
+    static const int _maxFields = 24;
+
+    void            _parseGGA           (const char* const* fields, int fieldCount);
+    void            _parseRMC           (const char* const* fields, int fieldCount);
+    void            _parseVTG           (const char* const* fields, int fieldCount);
+    void            _parseGST           (const char* const* fields, int fieldCount);
+    void            _emitPosition       (const QGeoCoordinate& coordinate, const QTime& time);
+    bool            _velocityCurrent    (void) const;
+    static bool     _checksumValid      (const char* sentence, int length);
+    static double   _parseLatLon        (const char* value, const char* hemisphere);
+    static QTime    _parseTime          (const char* value);
+    static bool     _hasValue           (const char* value) { return value && *value; }
+
+    QPointer<QIODevice> _device;
+    bool                _running            = false;
+    Error               _error              = NoError;
+    QByteArray          _lineBuffer;
+    QGeoPositionInfo    _lastPosition;
+    double              _uere               = 5.1;
+
+    // Values from the other sentences of the current epoch
+    QDate               _date;                                  ///< From RMC
+    double              _groundSpeed        = qQNaN();          ///< Meters per second
+    double              _direction          = qQNaN();          ///< Degrees
+    double              _horizontalAccuracy = qQNaN();          ///< From GST, meters
+    double              _verticalAccuracy   = qQNaN();
+    double              _hdop               = qQNaN();
+    QElapsedTimer       _velocityTimer;                         ///< Age of _groundSpeed/_direction
+    QElapsedTimer       _accuracyTimer;                         ///< Age of the GST accuracy
+    QElapsedTimer       _ggaTimer;                              ///< Time since the last GGA, invalid if none seen
+
+    static const int _minimumUpdateIntervalMsecs    = 50;
+    static const int _maxLineLength                 = 256;      ///< NMEA limits sentences to 82 characters
+    static const int _maxEpochAgeMsecs              = 1500;     ///< Older velocity/accuracy values are not used
+};
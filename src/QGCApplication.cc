@@ -38,8 +38,11 @@
 #include "CmdLineOptParser.h"
 #include "UDPLink.h"
 #include "LinkManager.h"
+#include "LinkReactorPool.h"
 #include "UASMessageHandler.h"
 #include "QGCTemporaryFile.h"
+#include "QGCStartupProfiler.h"
+#include "QGCTrace.h"
 #include "QGCPalette.h"
 #include "QGCMapPalette.h"
 #include "QGCLoggingCategory.h"
@@ -97,11 +100,15 @@
 #include "RCToParamDialogController.h"
 #include "QGCImageProvider.h"
 #include "TerrainProfile.h"
+#include "MapBatchItem.h"
+#include "TerrainOverlayItem.h"
+#include "ObstacleDistanceItem.h"
 #include "ToolStripAction.h"
 #include "ToolStripActionList.h"
 #include "QGCMAVLink.h"
 #include "VehicleLinkManager.h"
 #include "Autotune.h"
+#include "PIDTuningRecorder.h"
 #include "RemoteIDManager.h"
 #include "CustomAction.h"
 #include "CustomActionManager.h"
@@ -192,6 +199,7 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
 {
     _app = this;
     _msecsElapsedTime.start();
+    QGCStartupProfiler::start();
 
 #ifdef Q_OS_LINUX
 #ifndef __mobile__
@@ -353,8 +361,17 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     // We need to set language as early as possible prior to loading on JSON files.
     setLanguage();
 
-    _toolbox = new QGCToolbox(this);
-    _toolbox->setChildToolboxes();
+    // Links may be created by any tool, so the reactors must exist before the toolbox
+    _linkReactorPool = new LinkReactorPool();
+
+    {
+        QGCStartupProfiler::Scope scope(QStringLiteral("Create toolbox"));
+        _toolbox = new QGCToolbox(this);
+    }
+    {
+        QGCStartupProfiler::Scope scope(QStringLiteral("Set child toolboxes"));
+        _toolbox->setChildToolboxes();
+    }
 
 #ifndef __mobile__
     _gpsRtkFactGroup = new GPSRTKFactGroup(this);
@@ -429,10 +446,20 @@ void QGCApplication::setLanguage()
 
 void QGCApplication::_shutdown()
 {
+    if (QGCTraceLog().isDebugEnabled()) {
+        QGCTrace::writeChromeTrace(QDir(_toolbox->settingsManager()->appSettings()->logSavePath()).absoluteFilePath(QStringLiteral("Trace.json")));
+    }
+
     // Close out all Qml before we delete toolbox. This way we don't get all sorts of null reference complaints from Qml.
     delete _qmlAppEngine;
     delete _toolbox;
     delete _gpsRtkFactGroup;
+    // Only after the toolbox, the links it deletes leave their reactors
+    delete _linkReactorPool;
+    _linkReactorPool = nullptr;
+
+    // Settings changed during shutdown must not be lost with the write timer
+    SettingsFact::flushPendingWrites();
 }
 
 QGCApplication::~QGCApplication()
@@ -464,8 +491,10 @@ void QGCApplication::_initCommon()
     qmlRegisterUncreatableType<QGCCameraControl>        (kQGCVehicle,                       1, 0, "QGCCameraControl",           kRefOnly);
     qmlRegisterUncreatableType<QGCVideoStreamInfo>      (kQGCVehicle,                       1, 0, "QGCVideoStreamInfo",         kRefOnly);
     qmlRegisterUncreatableType<LinkInterface>           (kQGCVehicle,                       1, 0, "LinkInterface",              kRefOnly);
+    qmlRegisterUncreatableType<MAVLinkMetrics>          (kQGCVehicle,                       1, 0, "MAVLinkMetrics",             kRefOnly);
     qmlRegisterUncreatableType<VehicleLinkManager>      (kQGCVehicle,                       1, 0, "VehicleLinkManager",         kRefOnly);
     qmlRegisterUncreatableType<Autotune>                (kQGCVehicle,                       1, 0, "Autotune",                   kRefOnly);
+    qmlRegisterUncreatableType<PIDTuningRecorder>       (kQGCVehicle,                       1, 0, "PIDTuningRecorder",          kRefOnly);
     qmlRegisterUncreatableType<RemoteIDManager>         (kQGCVehicle,                       1, 0, "RemoteIDManager",            kRefOnly);
 
     qmlRegisterUncreatableType<MissionController>       (kQGCControllers,                   1, 0, "MissionController",          kRefOnly);
@@ -519,6 +548,9 @@ void QGCApplication::_initCommon()
     qmlRegisterType<CustomActionManager>            (kQGCControllers,                       1, 0, "CustomActionManager");
 
     qmlRegisterType<TerrainProfile>                 ("QGroundControl.Controls",             1, 0, "TerrainProfile");
+    qmlRegisterType<MapBatchItem>                   ("QGroundControl.FlightMap",            1, 0, "MapBatchItem");
+    qmlRegisterType<TerrainOverlayItem>             ("QGroundControl.FlightMap",            1, 0, "TerrainOverlayItem");
+    qmlRegisterType<ObstacleDistanceItem>           ("QGroundControl.FlightMap",            1, 0, "ObstacleDistanceItem");
     qmlRegisterType<ToolStripAction>                ("QGroundControl.Controls",             1, 0, "ToolStripAction");
     qmlRegisterType<ToolStripActionList>            ("QGroundControl.Controls",             1, 0, "ToolStripActionList");
 
@@ -552,8 +584,14 @@ bool QGCApplication::_initForNormalAppBoot()
 {
     QSettings settings;
 
-    _qmlAppEngine = toolbox()->corePlugin()->createQmlApplicationEngine(this);
-    toolbox()->corePlugin()->createRootWindow(_qmlAppEngine);
+    {
+        QGCStartupProfiler::Scope scope(QStringLiteral("Create qml engine"));
+        _qmlAppEngine = toolbox()->corePlugin()->createQmlApplicationEngine(this);
+    }
+    {
+        QGCStartupProfiler::Scope scope(QStringLiteral("Create root window"));
+        toolbox()->corePlugin()->createRootWindow(_qmlAppEngine);
+    }
 
     // Image provider for PX4 Flow
     QQuickImageProvider* pImgProvider = dynamic_cast<QQuickImageProvider*>(qgcApp()->toolbox()->imageProvider());
@@ -564,6 +602,12 @@ bool QGCApplication::_initForNormalAppBoot()
     if (rootWindow) {
         rootWindow->scheduleRenderJob (new FinishVideoInitialization (toolbox()->videoManager()),
                 QQuickWindow::BeforeSynchronizingStage);
+        // frameSwapped is signalled from the render thread, the connection is queued to us
+        _firstFrameConnection = connect(rootWindow, &QQuickWindow::frameSwapped, this, &QGCApplication::_firstFrameShown);
+        // In case no frame is ever rendered (minimized, no gpu, ...) deferred initialization still happens
+        QTimer::singleShot(_firstFrameTimeoutMSecs, this, &QGCApplication::_firstFrameShown);
+    } else {
+        QTimer::singleShot(0, this, &QGCApplication::_firstFrameShown);
     }
 
     // Safe to show popup error messages now that main window is created
@@ -579,9 +623,6 @@ bool QGCApplication::_initForNormalAppBoot()
     // Load known link configurations
     toolbox()->linkManager()->loadLinkConfigurationList();
 
-    // Probe for joysticks
-    toolbox()->joystickManager()->init();
-
     if (_settingsUpgraded) {
         showAppMessage(QString(tr("The format for %1 saved settings has been modified. "
                     "Your saved settings have been reset to defaults.")).arg(applicationName()));
@@ -601,9 +642,30 @@ bool QGCApplication::_initForNormalAppBoot()
 
 bool QGCApplication::_initForUnitTests()
 {
+    _toolbox->initDeferredTools();
     return true;
 }
 
+void QGCApplication::_firstFrameShown(void)
+{
+    if (QGCStartupProfiler::finished()) {
+        return;
+    }
+    disconnect(_firstFrameConnection);
+    QGCStartupProfiler::mark(QStringLiteral("First frame"));
+
+    // Startup work which is not needed to show the ui is done once the user sees the main window
+    _toolbox->initDeferredTools();
+
+    // Probe for joysticks
+    {
+        QGCStartupProfiler::Scope scope(QStringLiteral("Joystick init"));
+        toolbox()->joystickManager()->init();
+    }
+
+    QGCStartupProfiler::finish(toolbox()->settingsManager()->appSettings()->logSavePath());
+}
+
 void QGCApplication::deleteAllSettingsNextBoot(void)
 {
     QSettings settings;
@@ -831,6 +893,7 @@ void QGCApplication::_checkForNewVersion()
             QString versionCheckFile = toolbox()->corePlugin()->stableVersionCheckFileUrl();
             if (!versionCheckFile.isEmpty()) {
                 QGCFileDownload* download = new QGCFileDownload(this);
+                download->setPriority(QGCDownloadScheduler::PriorityMetadata);
                 connect(download, &QGCFileDownload::downloadComplete, this, &QGCApplication::_qgcCurrentStableVersionDownloadComplete);
                 download->download(versionCheckFile);
             }
@@ -40,6 +40,7 @@
 class QQmlApplicationEngine;
 class QGCSingleton;
 class QGCToolbox;
+class LinkReactorPool;
 
 /**
  * @brief The main application and management class.
@@ -90,6 +91,9 @@ public:
 
     FactGroup* gpsRtkFactGroup(void)  { return _gpsRtkFactGroup; }
 
+    /// Threads the socket links run on, outlives the toolbox
+    LinkReactorPool* linkReactorPool(void) { return _linkReactorPool; }
+
     QTranslator& qgcJSONTranslator(void) { return _qgcTranslatorJSON; }
 
     void            setLanguage();
@@ -184,6 +188,7 @@ private slots:
     void _gpsSurveyInStatus                         (float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void _gpsNumSatellites                          (int numSatellites);
     void _showDelayedAppMessages                    (void);
+    void _firstFrameShown                           (void);
 
 private:
     QObject*    _rootQmlObject          ();
@@ -195,6 +200,7 @@ private:
 
     bool                        _runningUnitTests;                                  ///< true: running unit tests, false: normal app
     static const int            _missingParamsDelayedDisplayTimerTimeout = 1000;    ///< Timeout to wait for next missing fact to come in before display
+    static const int            _firstFrameTimeoutMSecs = 5000;                     ///< Deferred tool initialization happens after this even if no frame was rendered
     QTimer                      _missingParamsDelayedDisplayTimer;                  ///< Timer use to delay missing fact display
     QList<QPair<int,QString>>   _missingParams;                                     ///< List of missing parameter component id:name
 
@@ -207,6 +213,7 @@ private:
     int                 _buildVersion           = 0;
     GPSRTKFactGroup*    _gpsRtkFactGroup        = nullptr;
     QGCToolbox*         _toolbox                = nullptr;
+    LinkReactorPool*    _linkReactorPool        = nullptr;
     QQuickWindow*       _mainRootWindow         = nullptr;
     bool                _bluetoothAvailable     = false;
     QTranslator         _qgcTranslatorSourceCode;           ///< translations for source code C++/Qml
@@ -215,6 +222,7 @@ private:
     QLocale             _locale;
     bool                _error                  = false;
     QElapsedTimer       _msecsElapsedTime;
+    QMetaObject::Connection _firstFrameConnection;
 
     QList<QPair<QString /* title */, QString /* message */>> _delayedAppMessages;
 
@@ -10,11 +10,11 @@
 
 #include "QGCCachedFileDownload.h"
 
-QGCCachedFileDownload::QGCCachedFileDownload(QObject* parent, const QString& cacheDirectory)
-    : QObject(parent), _fileDownload(new QGCFileDownload(this)), _diskCache(new QNetworkDiskCache(this))
+QGCCachedFileDownload::QGCCachedFileDownload(QObject* parent)
+    : QObject(parent), _fileDownload(new QGCFileDownload(this)), _diskCache(QGCDownloadScheduler::instance()->diskCache())
 {
-    _diskCache->setCacheDirectory(cacheDirectory);
-    _fileDownload->setCache(_diskCache);
+    _fileDownload->setCacheEnabled(true);
+    _fileDownload->setPriority(QGCDownloadScheduler::PriorityMetadata);
 
     connect(_fileDownload, &QGCFileDownload::downloadProgress, this, &QGCCachedFileDownload::downloadProgress);
     connect(_fileDownload, &QGCFileDownload::downloadComplete, this, &QGCCachedFileDownload::onDownloadCompleted);
@@ -13,12 +13,16 @@
 
 #include <QNetworkDiskCache>
 
+/// Downloads files through the shared HTTP cache of QGCDownloadScheduler. Defaults to
+/// QGCDownloadScheduler::PriorityMetadata.
 class QGCCachedFileDownload : public QObject
 {
     Q_OBJECT
     
 public:
-    QGCCachedFileDownload(QObject* parent, const QString& cacheDirectory);
+    QGCCachedFileDownload(QObject* parent);
+
+    void setPriority(QGCDownloadScheduler::Priority priority) { _fileDownload->setPriority(priority); }
 
     /// Download the specified remote file.
     ///     @param url   File to download
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCDownloadScheduler.h"
+
+#include <QCoreApplication>
+#include <QNetworkDiskCache>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QStandardPaths>
+
+#include <limits>
+
+QGCDownloadScheduler* QGCDownloadScheduler::instance(void)
+{
+    // Parented to the application so the network manager goes away before Qt does
+    static QGCDownloadScheduler* scheduler = new QGCDownloadScheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+QGCDownloadScheduler::QGCDownloadScheduler(QObject* parent)
+    : QObject   (parent)
+    , _diskCache(new QNetworkDiskCache(this))
+{
+    _diskCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/QGCDownloadCache"));
+    _diskCache->setMaximumCacheSize(_maxDiskCacheSize);
+    _networkManager.setCache(_diskCache);
+
+    QNetworkProxy proxy;
+    proxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager.setProxy(proxy);
+}
+
+void QGCDownloadScheduler::schedule(QObject* owner, Priority priority, std::function<QNetworkReply*(void)> start)
+{
+    Request_t request = { owner, start };
+
+    if (priority == PriorityInteractive) {
+        _start(priority, request);
+    } else {
+        _queues[priority].enqueue(request);
+        _startQueued();
+    }
+}
+
+int QGCDownloadScheduler::bulkSlots(void) const
+{
+    for (int priority=PriorityInteractive; priority<PriorityBulk; priority++) {
+        if (_activeCount[priority] || !_queues[priority].isEmpty()) {
+            return _throttledBulkSlots;
+        }
+    }
+    return std::numeric_limits<int>::max();
+}
+
+void QGCDownloadScheduler::_start(Priority priority, const Request_t& request)
+{
+    if (!request.owner) {
+        return;
+    }
+
+    QNetworkReply* reply = request.start();
+    if (!reply) {
+        return;
+    }
+
+    _activeReplies[reply] = priority;
+    _activeCount[priority]++;
+    // Whichever comes first, _replyDone only counts the reply once
+    connect(reply, &QNetworkReply::finished,  this, [this, reply]() { _replyDone(reply); });
+    connect(reply, &QObject::destroyed,       this, &QGCDownloadScheduler::_replyDone);
+}
+
+void QGCDownloadScheduler::_replyDone(QObject* reply)
+{
+    auto it = _activeReplies.find(reply);
+    if (it == _activeReplies.end()) {
+        return;
+    }
+    Priority priority = it.value();
+    _activeReplies.erase(it);
+    _activeCount[priority]--;
+
+    _startQueued();
+
+    if (priority != PriorityBulk && bulkSlots() != _throttledBulkSlots) {
+        emit bulkSlotsChanged();
+    }
+}
+
+void QGCDownloadScheduler::_startQueued(void)
+{
+    while (true) {
+        int active = _activeCount[PriorityMetadata] + _activeCount[PriorityBulk];
+        if (active >= _maxActive) {
+            return;
+        }
+        if (!_queues[PriorityMetadata].isEmpty()) {
+            _start(PriorityMetadata, _queues[PriorityMetadata].dequeue());
+        } else if (!_queues[PriorityBulk].isEmpty() && _activeCount[PriorityBulk] < _maxActiveBulk) {
+            _start(PriorityBulk, _queues[PriorityBulk].dequeue());
+        } else {
+            return;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QQueue>
+#include <QNetworkAccessManager>
+
+#include <functional>
+
+class QNetworkDiskCache;
+class QNetworkReply;
+
+/// Starts the HTTP downloads of QGCFileDownload and QGCCachedFileDownload.
+///
+/// All downloads share one QNetworkAccessManager, so connections to the same host are pooled, and one on-disk HTTP
+/// cache. Requests are started according to their priority class: interactive downloads start right away, meta data
+/// downloads share a limited number of slots and bulk downloads only get what is left. Offline map tile downloads use
+/// their own network manager and ask bulkSlots() how many transfers they may run, which drops to a trickle while
+/// higher priority downloads are waiting or running. Main thread only.
+class QGCDownloadScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        PriorityInteractive,    ///< The user is waiting for it, never queued
+        PriorityMetadata,       ///< Vehicle and application meta data
+        PriorityBulk,           ///< Large background transfers
+    };
+
+    static QGCDownloadScheduler* instance(void);
+
+    QNetworkAccessManager*  networkManager  (void) { return &_networkManager; }
+    QNetworkDiskCache*      diskCache       (void) { return _diskCache; }
+
+    /// Calls start once a slot for the priority class is free. start creates the request on networkManager() and returns
+    /// the reply, the slot is held until the reply finishes. Nothing is called if owner is destroyed while queued.
+    void schedule(QObject* owner, Priority priority, std::function<QNetworkReply*(void)> start);
+
+    /// @return Number of transfers a bulk client outside of the scheduler may run at the moment
+    int bulkSlots(void) const;
+
+signals:
+    /// bulkSlots() went back up
+    void bulkSlotsChanged(void);
+
+private:
+    QGCDownloadScheduler(QObject* parent);
+
+    typedef struct {
+        QPointer<QObject>                   owner;
+        std::function<QNetworkReply*(void)> start;
+    } Request_t;
+
+    void _start         (Priority priority, const Request_t& request);
+    void _replyDone     (QObject* reply);
+    void _startQueued   (void);
+
+    QNetworkAccessManager       _networkManager;
+    QNetworkDiskCache*          _diskCache;
+    QQueue<Request_t>           _queues[PriorityBulk + 1];
+    QHash<QObject*, Priority>   _activeReplies;
+    int                         _activeCount[PriorityBulk + 1] = { 0, 0, 0 };
+
+    static const int    _maxActive              = 6;    ///< Metadata and bulk slots, interactive downloads are not limited
+    static const int    _maxActiveBulk          = 4;    ///< Always leaves slots free for meta data
+    static const int    _throttledBulkSlots     = 1;
+    static const qint64 _maxDiskCacheSize       = 200 * 1024 * 1024;
+};
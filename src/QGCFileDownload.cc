@@ -12,19 +12,32 @@
 
 #include <QFileInfo>
 #include <QStandardPaths>
-#include <QNetworkProxy>
 
 QGCFileDownload::QGCFileDownload(QObject* parent)
-    : QNetworkAccessManager(parent)
+    : QObject(parent)
 {
 
 }
 
+QGCFileDownload::~QGCFileDownload()
+{
+    if (_reply) {
+        _reply->disconnect(this);
+        _reply->abort();
+        _reply->deleteLater();
+    }
+    if (_partFile.isOpen()) {
+        _partFile.close();
+        _partFile.remove();
+    }
+}
+
 bool QGCFileDownload::download(const QString& remoteFile, const QVector<QPair<QNetworkRequest::Attribute, QVariant>>& requestAttributes, bool redirect)
 {
     if (!redirect) {
         _requestAttributes = requestAttributes;
         _originalRemoteFile = remoteFile;
+        _resumeCount = 0;
     }
 
     if (remoteFile.isEmpty()) {
@@ -43,108 +56,203 @@ bool QGCFileDownload::download(const QString& remoteFile, const QVector<QPair<QN
         qWarning() << "Remote URL is invalid" << remoteFile;
         return false;
     }
-    
-    QNetworkRequest networkRequest(remoteUrl);
 
-    for (const auto& attribute : requestAttributes) {
+    // Split out filename from path
+    QString remoteFileName = QFileInfo(remoteUrl.toString()).fileName();
+    if (remoteFileName.isEmpty()) {
+        qWarning() << "Unabled to parse filename from remote url" << remoteUrl.toString();
+        remoteFileName = "DownloadedFile";
+    }
+
+    // Strip out http parameters from remote filename
+    int parameterIndex = remoteFileName.indexOf("?");
+    if (parameterIndex != -1) {
+        remoteFileName  = remoteFileName.left(parameterIndex);
+    }
+
+    // Determine location to download file to
+    QString downloadFilename = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    if (downloadFilename.isEmpty()) {
+        downloadFilename = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
+        if (downloadFilename.isEmpty()) {
+            qWarning() << "Unabled to find writable download location. Tried downloads and temp directory.";
+            return false;
+        }
+    }
+    _downloadFilename = downloadFilename + "/" + remoteFileName;
+
+    _partFile.close();
+    _partFile.setFileName(_downloadFilename + ".part");
+    if (!_partFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not open download file" << _partFile.fileName() << _partFile.errorString();
+        return false;
+    }
+
+    _remoteUrl      = remoteUrl;
+    _resumeOffset   = 0;
+
+    // Local files are not worth a slot
+    bool http = remoteUrl.scheme().startsWith("http");
+    QGCDownloadScheduler::instance()->schedule(this, http ? _priority : QGCDownloadScheduler::PriorityInteractive, [this]() { return _startRequest(); });
+    return true;
+}
+
+QNetworkReply* QGCFileDownload::_startRequest(void)
+{
+    QNetworkRequest networkRequest(_remoteUrl);
+
+    if (!_cacheEnabled || _resumeOffset) {
+        networkRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+        networkRequest.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+    }
+    for (const auto& attribute : _requestAttributes) {
+        if (_resumeOffset && (attribute.first == QNetworkRequest::CacheLoadControlAttribute || attribute.first == QNetworkRequest::CacheSaveControlAttribute)) {
+            // The cache does not know about partial content
+            continue;
+        }
         networkRequest.setAttribute(attribute.first, attribute.second);
     }
+    if (_resumeOffset) {
+        networkRequest.setRawHeader("Range", QStringLiteral("bytes=%1-").arg(_resumeOffset).toLatin1());
+    }
 
-    QNetworkProxy tProxy;
-    tProxy.setType(QNetworkProxy::DefaultProxy);
-    setProxy(tProxy);
-    
-    QNetworkReply* networkReply = get(networkRequest);
+    switch (_priority) {
+    case QGCDownloadScheduler::PriorityInteractive:
+        networkRequest.setPriority(QNetworkRequest::HighPriority);
+        break;
+    case QGCDownloadScheduler::PriorityMetadata:
+        networkRequest.setPriority(QNetworkRequest::NormalPriority);
+        break;
+    case QGCDownloadScheduler::PriorityBulk:
+        networkRequest.setPriority(QNetworkRequest::LowPriority);
+        break;
+    }
+
+    QNetworkReply* networkReply = QGCDownloadScheduler::instance()->networkManager()->get(networkRequest);
     if (!networkReply) {
         qWarning() << "QNetworkAccessManager::get failed";
-        return false;
+        emit downloadComplete(_originalRemoteFile, QString(), tr("Download failed"));
+        return nullptr;
     }
 
-    connect(networkReply, &QNetworkReply::downloadProgress, this, &QGCFileDownload::downloadProgress);
+    _reply          = networkReply;
+    _replyChecked   = false;
+    _acceptRanges   = false;
+
+    connect(networkReply, &QNetworkReply::downloadProgress, this, [this](qint64 curr, qint64 total) {
+        emit downloadProgress(_resumeOffset + curr, total < 0 ? total : _resumeOffset + total);
+    });
+    connect(networkReply, &QNetworkReply::readyRead, this, &QGCFileDownload::_readyRead);
     connect(networkReply, &QNetworkReply::finished, this, &QGCFileDownload::_downloadFinished);
-    connect(networkReply, &QNetworkReply::errorOccurred, this, &QGCFileDownload::_downloadError);
-    return true;
+    return networkReply;
+}
+
+void QGCFileDownload::_readyRead(void)
+{
+    if (!_reply) {
+        return;
+    }
+
+    if (!_replyChecked) {
+        if (!_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).isNull()) {
+            // Body of a redirect, the real file comes from the next request
+            return;
+        }
+        _replyChecked = true;
+        _acceptRanges = _reply->rawHeader("Accept-Ranges") == "bytes";
+        if (_resumeOffset && _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+            // Server ignored the range and sends the whole file again
+            _partFile.resize(0);
+            _partFile.seek(0);
+            _resumeOffset = 0;
+        }
+    }
+
+    _partFile.write(_reply->readAll());
 }
 
 void QGCFileDownload::_downloadFinished(void)
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
+    reply->deleteLater();
+    if (reply != _reply) {
+        return;
+    }
 
-    // When an error occurs or the user cancels the download, we still end up here. So bail out in
-    // those cases.
     if (reply->error() != QNetworkReply::NoError) {
-        reply->deleteLater();
+        // Keep what arrived so far before deciding if the rest can be requested
+        _readyRead();
+        _reply = nullptr;
+        if (_resume(reply)) {
+            return;
+        }
+        _partFile.close();
+        _partFile.remove();
+        emit downloadComplete(_originalRemoteFile, QString(), _errorString(reply->error()));
         return;
     }
 
     // Check for redirection
     QVariant redirectionTarget = reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
     if (!redirectionTarget.isNull()) {
+        _reply = nullptr;
         QUrl redirectUrl = reply->url().resolved(redirectionTarget.toUrl());
-        download(redirectUrl.toString(), _requestAttributes, true /* redirect */);
-        reply->deleteLater();
+        if (!download(redirectUrl.toString(), _requestAttributes, true /* redirect */)) {
+            emit downloadComplete(_originalRemoteFile, QString(), tr("Redirect to %1 failed").arg(redirectUrl.toString()));
+        }
         return;
     }
 
-    // Split out filename from path
-    QString remoteFileName = QFileInfo(reply->url().toString()).fileName();
-    if (remoteFileName.isEmpty()) {
-        qWarning() << "Unabled to parse filename from remote url" << reply->url().toString();
-        remoteFileName = "DownloadedFile";
-    }
-
-    // Strip out http parameters from remote filename
-    int parameterIndex = remoteFileName.indexOf("?");
-    if (parameterIndex != -1) {
-        remoteFileName  = remoteFileName.left(parameterIndex);
-    }
+    _readyRead();
+    _reply = nullptr;
+    _partFile.close();
 
-    // Determine location to download file to
-    QString downloadFilename = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    if (downloadFilename.isEmpty()) {
-        downloadFilename = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
-        if (downloadFilename.isEmpty()) {
-            emit downloadComplete(_originalRemoteFile, QString(), tr("Unabled to find writable download location. Tried downloads and temp directory."));
-            return;
-        }
+    // Store downloaded file in download location
+    QFile::remove(_downloadFilename);
+    if (_partFile.error() != QFileDevice::NoError || !_partFile.rename(_downloadFilename)) {
+        QString errorString = _partFile.errorString();
+        _partFile.remove();
+        emit downloadComplete(_originalRemoteFile, _downloadFilename, tr("Could not save downloaded file to %1. Error: %2").arg(_downloadFilename).arg(errorString));
+        return;
     }
-    downloadFilename += "/"  + remoteFileName;
-
-    if (!downloadFilename.isEmpty()) {
-        // Store downloaded file in download location
-        QFile file(downloadFilename);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            emit downloadComplete(_originalRemoteFile, downloadFilename, tr("Could not save downloaded file to %1. Error: %2").arg(downloadFilename).arg(file.errorString()));
-            return;
-        }
 
-        file.write(reply->readAll());
-        file.close();
+    emit downloadComplete(_originalRemoteFile, _downloadFilename, QString());
+}
 
-        emit downloadComplete(_originalRemoteFile, downloadFilename, QString());
-    } else {
-        QString errorMsg = "Internal error";
-        qWarning() << errorMsg;
-        emit downloadComplete(_originalRemoteFile, downloadFilename, errorMsg);
+/// @brief Requests the rest of the file after the transfer was cut off
+/// @return true: Resume request was started
+bool QGCFileDownload::_resume(QNetworkReply* reply)
+{
+    switch (reply->error()) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::UnknownNetworkError:
+        break;
+    default:
+        return false;
+    }
+    if (!_acceptRanges || _partFile.size() == 0 || _resumeCount >= _maxResumeCount) {
+        return false;
     }
 
-    reply->deleteLater();
+    _resumeCount++;
+    _resumeOffset = _partFile.size();
+    qWarning() << "Download interrupted, resuming" << _originalRemoteFile << "at" << _resumeOffset << reply->errorString();
+
+    QGCDownloadScheduler::instance()->schedule(this, _priority, [this]() { return _startRequest(); });
+    return true;
 }
 
-/// @brief Called when an error occurs during download
-void QGCFileDownload::_downloadError(QNetworkReply::NetworkError code)
+QString QGCFileDownload::_errorString(QNetworkReply::NetworkError code)
 {
-    QString errorMsg;
-    
     if (code == QNetworkReply::OperationCanceledError) {
-        errorMsg = tr("Download cancelled");
-
+        return tr("Download cancelled");
     } else if (code == QNetworkReply::ContentNotFoundError) {
-        errorMsg = tr("Error: File Not Found");
-
+        return tr("Error: File Not Found");
     } else {
-        errorMsg = tr("Error during download. Error: %1").arg(code);
+        return tr("Error during download. Error: %1").arg(code);
     }
-
-    emit downloadComplete(_originalRemoteFile, QString(), errorMsg);
 }
@@ -9,15 +9,28 @@
 
 #pragma once
 
+#include "QGCDownloadScheduler.h"
+
 #include <QNetworkReply>
+#include <QPointer>
+#include <QFile>
 
-class QGCFileDownload : public QNetworkAccessManager
+/// Downloads a file to the temp directory. Requests go through QGCDownloadScheduler. The file is written as it arrives
+/// and a transfer which is cut off is resumed with a range request if the server supports it.
+class QGCFileDownload : public QObject
 {
     Q_OBJECT
-    
+
 public:
     QGCFileDownload(QObject* parent = nullptr);
-    
+    ~QGCFileDownload();
+
+    /// Priority class used for the downloads, defaults to QGCDownloadScheduler::PriorityInteractive
+    void setPriority(QGCDownloadScheduler::Priority priority) { _priority = priority; }
+
+    /// true: Responses are stored in the shared HTTP cache, defaults to false
+    void setCacheEnabled(bool cacheEnabled) { _cacheEnabled = cacheEnabled; }
+
     /// Download the specified remote file.
     ///     @param remoteFile   File to download. Can be http address or file system path.
     ///     @param requestAttributes   Optional request attributes to set
@@ -30,9 +43,24 @@ signals:
     void downloadComplete(QString remoteFile, QString localFile, QString errorMsg);
 
 private:
-    void _downloadFinished(void);
-    void _downloadError(QNetworkReply::NetworkError code);
+    QNetworkReply*  _startRequest       (void);
+    void            _readyRead          (void);
+    void            _downloadFinished   (void);
+    bool            _resume             (QNetworkReply* reply);
+    QString         _errorString        (QNetworkReply::NetworkError code);
 
-    QString _originalRemoteFile;
+    QString                 _originalRemoteFile;
     QVector<QPair<QNetworkRequest::Attribute, QVariant>> _requestAttributes;
+    QGCDownloadScheduler::Priority _priority = QGCDownloadScheduler::PriorityInteractive;
+    bool                    _cacheEnabled   = false;
+    QUrl                    _remoteUrl;
+    QString                 _downloadFilename;
+    QFile                   _partFile;          ///< Download in progress, renamed to _downloadFilename once complete
+    QPointer<QNetworkReply> _reply;
+    qint64                  _resumeOffset   = 0;    ///< Bytes already in _partFile when the current request started
+    bool                    _replyChecked   = false;
+    bool                    _acceptRanges   = false;
+    int                     _resumeCount    = 0;
+
+    static const int _maxResumeCount = 3;
 };
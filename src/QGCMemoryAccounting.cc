@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCMemoryAccounting.h"
+#include "QGCApplication.h"
+#include "QGCLoggingCategory.h"
+#include "MAVLinkProtocol.h"
+#include "TerrainQuery.h"
+#include "QGCMapEngine.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QQmlEngine>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#endif
+
+QGC_LOGGING_CATEGORY(MemoryAccountingLog, "MemoryAccountingLog")
+
+const char* QGCMemoryAccounting::_processSubsystemName = "RSS";
+
+QGCMemoryAccounting::QGCMemoryAccounting(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _physicalBytes = systemPhysicalBytes();
+}
+
+void QGCMemoryAccounting::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    qmlRegisterUncreatableType<QGCMemoryAccounting>("QGroundControl", 1, 0, "QGCMemoryAccounting", "Reference only");
+
+    // Caches which are singletons are accounted for here, everything else adds itself
+    addSource(this, QStringLiteral("Terrain"),  [](){ return TerrainAtCoordinateQuery::tileCacheStats().bytes; });
+    addSource(this, QStringLiteral("MapCache"), [](){ return getQGCMapEngine()->memoryCache()->bytes(); });
+
+    // The map cache is bounded by its own setting, the others only by how long QGC runs
+    setBudget(QStringLiteral("Trajectory"), 32ll * 1024 * 1024);
+    setBudget(QStringLiteral("Messages"),   16ll * 1024 * 1024);
+    setBudget(QStringLiteral("Terrain"),    64ll * 1024 * 1024);
+    setBudget(QStringLiteral("Inspector"),  64ll * 1024 * 1024);
+    setBudget(QStringLiteral("Video"),      256ll * 1024 * 1024);
+
+    connect(&_sampleTimer, &QTimer::timeout, this, &QGCMemoryAccounting::_sample);
+    _sampleTimer.start(_sampleIntervalMSecs);
+}
+
+void QGCMemoryAccounting::addSource(QObject* owner, const QString& subsystem, SizeFunction size)
+{
+    if (subsystem.length() > 10) {
+        qCWarning(MemoryAccountingLog) << "Subsystem name is cut in the telemetry log" << subsystem;
+    }
+
+    bool ownerKnown = false;
+    for (const Source_t& source: _sources) {
+        if (source.owner == owner) {
+            ownerKnown = true;
+            break;
+        }
+    }
+    if (!ownerKnown && owner != this) {
+        connect(owner, &QObject::destroyed, this, &QGCMemoryAccounting::_ownerDestroyed);
+    }
+
+    _sources.append({ owner, _subsystemIndex(subsystem), size });
+}
+
+void QGCMemoryAccounting::setBudget(const QString& subsystem, qint64 budgetBytes)
+{
+    SubsystemState_t& state = _subsystemStates[_subsystemIndex(subsystem)];
+    state.budgetBytes = budgetBytes;
+    state.overBudget = false;
+}
+
+void QGCMemoryAccounting::_ownerDestroyed(QObject* owner)
+{
+    for (int i = _sources.count() - 1; i >= 0; i--) {
+        if (_sources[i].owner == owner) {
+            _sources.removeAt(i);
+        }
+    }
+}
+
+int QGCMemoryAccounting::_subsystemIndex(const QString& subsystem)
+{
+    int index = _subsystemNames.indexOf(subsystem);
+    if (index == -1) {
+        index = _subsystemNames.count();
+        _subsystemNames.append(subsystem);
+        _subsystemStates.append({ 0, 0, false });
+    }
+    return index;
+}
+
+void QGCMemoryAccounting::sampleNow(void)
+{
+    _sample();
+}
+
+void QGCMemoryAccounting::_sample(void)
+{
+    Sample_t sample;
+    sample.msecs            = QDateTime::currentMSecsSinceEpoch();
+    sample.residentBytes    = processResidentBytes();
+    sample.bytes.fill(0, _subsystemNames.count());
+
+    for (const Source_t& source: _sources) {
+        sample.bytes[source.subsystemIndex] += source.size();
+    }
+
+    _residentBytes = sample.residentBytes;
+
+    MAVLinkProtocol* mavlinkProtocol = _toolbox->mavlinkProtocol();
+    QStringList logValues;
+    for (int i = 0; i < sample.bytes.count(); i++) {
+        const qint64 bytes = sample.bytes[i];
+        SubsystemState_t& state = _subsystemStates[i];
+        state.peakBytes = qMax(state.peakBytes, bytes);
+        _checkBudget(i, bytes);
+        mavlinkProtocol->logNamedValueInt(_subsystemNames[i], static_cast<int32_t>(qMin(bytes / 1024, static_cast<qint64>(INT32_MAX))));
+        logValues.append(QStringLiteral("%1:%2").arg(_subsystemNames[i]).arg(bytes / 1024));
+    }
+
+    if (_residentBytes >= 0) {
+        mavlinkProtocol->logNamedValueInt(_processSubsystemName, static_cast<int32_t>(qMin(_residentBytes / 1024, static_cast<qint64>(INT32_MAX))));
+
+        if (_physicalBytes > 0) {
+            const qint64 processBudget = static_cast<qint64>(_physicalBytes * _processBudgetFraction);
+            if (!_processOverBudget && _residentBytes > processBudget) {
+                _processOverBudget = true;
+                qCWarning(MemoryAccountingLog) << "Process over memory budget" << _residentBytes << processBudget;
+                qgcApp()->showAppMessage(tr("%1 is using %2 MB of the %3 MB of memory on this device. Restart it when possible to avoid running out of memory.")
+                                         .arg(qgcApp()->applicationName()).arg(_residentBytes / (1024 * 1024)).arg(_physicalBytes / (1024 * 1024)));
+                emit budgetExceeded(_processSubsystemName, _residentBytes, processBudget);
+            } else if (_processOverBudget && _residentBytes < processBudget * 0.9) {
+                _processOverBudget = false;
+            }
+        }
+    }
+
+    qCDebug(MemoryAccountingLog) << "RSS KB" << (_residentBytes >= 0 ? _residentBytes / 1024 : -1) << logValues.join(QStringLiteral(" "));
+
+    _timeline.append(sample);
+    while (_timeline.count() > _maxTimelineSamples) {
+        _timeline.removeFirst();
+    }
+
+    emit sampled();
+}
+
+void QGCMemoryAccounting::_checkBudget(int subsystemIndex, qint64 bytes)
+{
+    SubsystemState_t& state = _subsystemStates[subsystemIndex];
+
+    if (state.budgetBytes <= 0) {
+        return;
+    }
+
+    if (!state.overBudget && bytes > state.budgetBytes) {
+        state.overBudget = true;
+        const QString& subsystem = _subsystemNames[subsystemIndex];
+        qCWarning(MemoryAccountingLog) << "Subsystem over memory budget" << subsystem << bytes << state.budgetBytes;
+        qgcApp()->showAppMessage(tr("%1 memory use has grown to %2 MB, above its budget of %3 MB.")
+                                 .arg(subsystem).arg(bytes / (1024 * 1024)).arg(state.budgetBytes / (1024 * 1024)));
+        emit budgetExceeded(subsystem, bytes, state.budgetBytes);
+    } else if (state.overBudget && bytes < state.budgetBytes * 0.9) {
+        state.overBudget = false;
+    }
+}
+
+QVariantList QGCMemoryAccounting::subsystems(void) const
+{
+    QVariantList list;
+
+    const QVector<qint64> lastBytes = _timeline.isEmpty() ? QVector<qint64>() : _timeline.last().bytes;
+    for (int i = 0; i < _subsystemNames.count(); i++) {
+        QVariantMap subsystem;
+        subsystem[QStringLiteral("name")]           = _subsystemNames[i];
+        subsystem[QStringLiteral("bytes")]          = i < lastBytes.count() ? lastBytes[i] : 0;
+        subsystem[QStringLiteral("peakBytes")]      = _subsystemStates[i].peakBytes;
+        subsystem[QStringLiteral("budgetBytes")]    = _subsystemStates[i].budgetBytes;
+        list.append(subsystem);
+    }
+
+    return list;
+}
+
+QVariantList QGCMemoryAccounting::timeline(void) const
+{
+    QVariantList list;
+
+    for (const Sample_t& sample: _timeline) {
+        QVariantList bytes;
+        for (qint64 subsystemBytes: sample.bytes) {
+            bytes.append(subsystemBytes);
+        }
+
+        QVariantMap entry;
+        entry[QStringLiteral("msecs")]          = sample.msecs;
+        entry[QStringLiteral("residentBytes")]  = sample.residentBytes;
+        entry[QStringLiteral("bytes")]          = bytes;
+        list.append(entry);
+    }
+
+    return list;
+}
+
+bool QGCMemoryAccounting::exportTimeline(const QString& filename)
+{
+    QFile file(filename);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
+        qCWarning(MemoryAccountingLog) << "Unable to export memory timeline" << filename << file.errorString();
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream << "time," << _processSubsystemName;
+    for (const QString& subsystem: _subsystemNames) {
+        stream << "," << subsystem;
+    }
+    stream << "\n";
+
+    for (const Sample_t& sample: _timeline) {
+        stream << QDateTime::fromMSecsSinceEpoch(sample.msecs).toString(Qt::ISODate) << "," << sample.residentBytes;
+        for (int i = 0; i < _subsystemNames.count(); i++) {
+            stream << "," << (i < sample.bytes.count() ? sample.bytes[i] : 0);
+        }
+        stream << "\n";
+    }
+
+    return true;
+}
+
+qint64 QGCMemoryAccounting::processResidentBytes(void)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    // Second field of statm is the resident set in pages
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QFile::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.count() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+    return -1;
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.WorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<qint64>(info.resident_size);
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+qint64 QGCMemoryAccounting::systemPhysicalBytes(void)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    return pages > 0 ? static_cast<qint64>(pages) * sysconf(_SC_PAGESIZE) : -1;
+#elif defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? static_cast<qint64>(status.ullTotalPhys) : -1;
+#elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
+    int64_t memSize = 0;
+    size_t length = sizeof(memSize);
+    return sysctlbyname("hw.memsize", &memSize, &length, nullptr, 0) == 0 ? static_cast<qint64>(memSize) : -1;
+#else
+    return -1;
+#endif
+}
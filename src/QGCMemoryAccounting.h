@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+
+#include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include <QVariantList>
+#include <QLoggingCategory>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(MemoryAccountingLog)
+
+/// Memory held by the major containers of each subsystem, to track down growth during long operations.
+///
+/// Subsystems add a source which returns the bytes held by one of their containers. Sources of the same subsystem,
+/// e.g. one per vehicle, are summed. Every _sampleIntervalMSecs all subsystems and the process resident size are
+/// sampled into a timeline covering the last _timelineHours. Each sample is written to the telemetry log as
+/// NAMED_VALUE_INT in KB, which is why subsystem names must be at most 10 characters, and logged to
+/// MemoryAccountingLog. A subsystem going over its budget shows a warning, once until it drops below 90% of the
+/// budget again. Sources are added and called on the gui thread.
+class QGCMemoryAccounting : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    QGCMemoryAccounting(QGCApplication* app, QGCToolbox* toolbox);
+
+    typedef std::function<qint64(void)> SizeFunction;
+
+    Q_PROPERTY(QVariantList subsystems      READ subsystems     NOTIFY sampled)     ///< { name, bytes, peakBytes, budgetBytes } for the last sample
+    Q_PROPERTY(QVariantList timeline        READ timeline       NOTIFY sampled)     ///< { msecs, residentBytes, bytes: [] in subsystems order }
+    Q_PROPERTY(qint64       residentBytes   READ residentBytes  NOTIFY sampled)     ///< -1 if not available on this platform
+    Q_PROPERTY(qint64       physicalBytes   READ physicalBytes  CONSTANT)           ///< -1 if not available on this platform
+
+    /// Adds a source to the subsystem. It is removed when owner is destroyed.
+    void addSource(QObject* owner, const QString& subsystem, SizeFunction size);
+
+    /// Sets the size above which the subsystem raises a warning, 0 for none
+    void setBudget(const QString& subsystem, qint64 budgetBytes);
+
+    /// Takes a sample right away instead of waiting for the next one
+    Q_INVOKABLE void sampleNow(void);
+
+    /// Saves the timeline as CSV
+    Q_INVOKABLE bool exportTimeline(const QString& filename);
+
+    QVariantList    subsystems      (void) const;
+    QVariantList    timeline        (void) const;
+    qint64          residentBytes   (void) const { return _residentBytes; }
+    qint64          physicalBytes   (void) const { return _physicalBytes; }
+
+    static qint64   processResidentBytes(void);
+    static qint64   systemPhysicalBytes (void);
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) override;
+
+signals:
+    void sampled        (void);
+    void budgetExceeded (const QString& subsystem, qint64 bytes, qint64 budgetBytes);
+
+private slots:
+    void _sample        (void);
+    void _ownerDestroyed(QObject* owner);
+
+private:
+    typedef struct {
+        QObject*        owner;
+        int             subsystemIndex;
+        SizeFunction    size;
+    } Source_t;
+
+    typedef struct {
+        qint64          msecs;          ///< Since epoch
+        qint64          residentBytes;
+        QVector<qint64> bytes;          ///< By subsystem index, shorter than _subsystemNames if subsystems were added later
+    } Sample_t;
+
+    typedef struct {
+        qint64  peakBytes;
+        qint64  budgetBytes;
+        bool    overBudget;
+    } SubsystemState_t;
+
+    int     _subsystemIndex (const QString& subsystem);
+    void    _checkBudget    (int subsystemIndex, qint64 bytes);
+
+    QTimer                      _sampleTimer;
+    QList<Source_t>             _sources;
+    QStringList                 _subsystemNames;
+    QVector<SubsystemState_t>   _subsystemStates;
+    QList<Sample_t>             _timeline;
+    qint64                      _residentBytes  = -1;
+    qint64                      _physicalBytes  = -1;
+    bool                        _processOverBudget = false;
+
+    static const char*          _processSubsystemName;
+    static const int            _sampleIntervalMSecs    = 60 * 1000;
+    static const int            _timelineHours          = 12;
+    static const int            _maxTimelineSamples     = _timelineHours * 60 * 60 * 1000 / _sampleIntervalMSecs;
+    static constexpr double     _processBudgetFraction  = 0.75;     ///< Of physical memory
+};
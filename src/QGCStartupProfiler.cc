@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCStartupProfiler.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+
+QGC_LOGGING_CATEGORY(StartupProfilerLog, "StartupProfilerLog")
+
+namespace {
+    typedef struct {
+        QString name;
+        qint64  startUSecs;
+        qint64  durationUSecs;  ///< -1 for instant events
+    } Event_t;
+
+    QElapsedTimer       startTimer;
+    QVector<Event_t>    events;
+    bool                isFinished = false;
+}
+
+QGCStartupProfiler::Scope::Scope(const QString& name)
+    : _name         (name)
+    , _startUSecs   (_nowUSecs())
+{
+}
+
+QGCStartupProfiler::Scope::~Scope()
+{
+    _addEvent(_name, _startUSecs, _nowUSecs() - _startUSecs);
+}
+
+void QGCStartupProfiler::start(void)
+{
+    if (!startTimer.isValid()) {
+        startTimer.start();
+    }
+}
+
+qint64 QGCStartupProfiler::_nowUSecs(void)
+{
+    start();
+    return startTimer.nsecsElapsed() / 1000;
+}
+
+void QGCStartupProfiler::mark(const QString& name)
+{
+    _addEvent(name, _nowUSecs(), -1);
+}
+
+bool QGCStartupProfiler::finished(void)
+{
+    return isFinished;
+}
+
+void QGCStartupProfiler::_addEvent(const QString& name, qint64 startUSecs, qint64 durationUSecs)
+{
+    if (isFinished) {
+        return;
+    }
+    events.append({ name, startUSecs, durationUSecs });
+    if (durationUSecs < 0) {
+        qCDebug(StartupProfilerLog) << name << "at" << startUSecs / 1000 << "ms";
+    } else {
+        qCDebug(StartupProfilerLog) << name << durationUSecs / 1000.0 << "ms";
+    }
+}
+
+void QGCStartupProfiler::finish(const QString& saveDirPath)
+{
+    if (isFinished) {
+        return;
+    }
+    mark(QStringLiteral("Startup complete"));
+    isFinished = true;
+
+    if (StartupProfilerLog().isDebugEnabled() && !saveDirPath.isEmpty()) {
+        QJsonArray traceEvents;
+        for (const Event_t& event: events) {
+            QJsonObject traceEvent;
+            traceEvent[QStringLiteral("name")]  = event.name;
+            traceEvent[QStringLiteral("ts")]    = event.startUSecs;
+            traceEvent[QStringLiteral("pid")]   = 1;
+            traceEvent[QStringLiteral("tid")]   = 1;
+            if (event.durationUSecs < 0) {
+                traceEvent[QStringLiteral("ph")]    = QStringLiteral("i");
+                traceEvent[QStringLiteral("s")]     = QStringLiteral("g");
+            } else {
+                traceEvent[QStringLiteral("ph")]    = QStringLiteral("X");
+                traceEvent[QStringLiteral("dur")]   = event.durationUSecs;
+            }
+            traceEvents.append(traceEvent);
+        }
+        QJsonObject trace;
+        trace[QStringLiteral("traceEvents")] = traceEvents;
+
+        QFile traceFile(QDir(saveDirPath).absoluteFilePath(QStringLiteral("StartupTrace.json")));
+        if (traceFile.open(QFile::WriteOnly | QFile::Truncate)) {
+            traceFile.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+            qCDebug(StartupProfilerLog) << "Startup trace written to" << traceFile.fileName();
+        } else {
+            qCWarning(StartupProfilerLog) << "Unable to write startup trace" << traceFile.fileName() << traceFile.errorString();
+        }
+    }
+
+    events.clear();
+    events.squeeze();
+}
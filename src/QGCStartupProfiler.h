@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(StartupProfilerLog)
+
+/// Timeline of application startup.
+///
+/// Spans (tool construction, setToolbox, qml load, ...) and instant events are recorded from the first call until
+/// finish() is called after the first frame. If StartupProfilerLog is enabled each span is logged and finish() writes
+/// the timeline in Chrome trace event format (chrome://tracing, Perfetto) to StartupTrace.json in the log save
+/// directory. Only to be used from the gui thread.
+class QGCStartupProfiler
+{
+public:
+    /// Records the time from construction to destruction as a span
+    class Scope
+    {
+    public:
+        Scope(const QString& name);
+        ~Scope();
+
+    private:
+        QString _name;
+        qint64  _startUSecs;
+
+        Q_DISABLE_COPY(Scope)
+    };
+
+    /// Starts the timeline, zero time of all events
+    static void start   (void);
+
+    /// Records an instant event
+    static void mark    (const QString& name);
+
+    /// Ends recording and writes the trace
+    static void finish  (const QString& saveDirPath);
+
+    static bool finished(void);
+
+private:
+    static void _addEvent(const QString& name, qint64 startUSecs, qint64 durationUSecs);
+    static qint64 _nowUSecs(void);
+};
@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTimerWheel.h"
+
+#include <QCoreApplication>
+
+QGCWheelTimer::QGCWheelTimer(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+QGCWheelTimer::~QGCWheelTimer()
+{
+    stop();
+}
+
+void QGCWheelTimer::start(void)
+{
+    QGCTimerWheel* wheel = QGCTimerWheel::instance();
+
+    // First tick at or after the interval has fully elapsed, so timers never fire early
+    const qint64 dueMSecs = wheel->_clock.elapsed() + _intervalMSecs;
+    _deadlineTick = ((dueMSecs + QGCTimerWheel::tickMSecs - 1) / QGCTimerWheel::tickMSecs) + 1;
+    wheel->_add(this);
+}
+
+void QGCWheelTimer::start(int msecs)
+{
+    setInterval(msecs);
+    start();
+}
+
+void QGCWheelTimer::stop(void)
+{
+    if (_active) {
+        QGCTimerWheel::instance()->_remove(this);
+    }
+}
+
+int QGCWheelTimer::remainingTime(void) const
+{
+    if (!_active) {
+        return -1;
+    }
+    const qint64 remaining = ((_deadlineTick - 1) * QGCTimerWheel::tickMSecs) - QGCTimerWheel::instance()->_clock.elapsed();
+    return static_cast<int>(qMax(static_cast<qint64>(0), remaining));
+}
+
+QGCTimerWheel* QGCTimerWheel::instance(void)
+{
+    static QGCTimerWheel* wheel = new QGCTimerWheel(QCoreApplication::instance());
+    return wheel;
+}
+
+QGCTimerWheel::QGCTimerWheel(QObject* parent)
+    : QObject(parent)
+{
+    _clock.start();
+    _tickTimer.setSingleShot(true);
+    _tickTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_tickTimer, &QTimer::timeout, this, &QGCTimerWheel::_tick);
+}
+
+void QGCTimerWheel::_add(QGCWheelTimer* timer)
+{
+    if (_activeCount == 0) {
+        // Nothing to catch up on, the wheel picks up from now
+        _nextTick = _nowTick();
+    }
+
+    if (timer->_active) {
+        // A restart to a later deadline leaves the timer where it is, it is moved along once its slot comes up
+        if (timer->_deadlineTick >= timer->_slotTick) {
+            return;
+        }
+        _unlink(timer);
+    } else {
+        timer->_active = true;
+        _activeCount++;
+    }
+    _link(timer);
+
+    if (!_tickTimer.isActive() || timer->_slotTick < _wakeTick) {
+        _startTickTimer();
+    }
+}
+
+void QGCTimerWheel::_remove(QGCWheelTimer* timer)
+{
+    _unlink(timer);
+    timer->_active = false;
+    _activeCount--;
+
+    if (_activeCount == 0) {
+        _tickTimer.stop();
+    }
+}
+
+void QGCTimerWheel::_link(QGCWheelTimer* timer)
+{
+    const qint64 target = qMax(timer->_deadlineTick, _nextTick);
+    qint64       delta  = target - _nextTick;
+
+    int level = 0;
+    while (level < _levels - 1 && delta >= (static_cast<qint64>(1) << (_levelBits * (level + 1)))) {
+        level++;
+    }
+    // Beyond the top level the timer waits a full top level turn and is checked again
+    const qint64 slotTarget = delta >= (static_cast<qint64>(1) << (_levelBits * _levels)) ? _nextTick + (static_cast<qint64>(1) << (_levelBits * _levels)) - 1 : target;
+    const int    shift      = _levelBits * level;
+
+    timer->_level       = level;
+    timer->_slot        = static_cast<int>((slotTarget >> shift) & _slotMask);
+    timer->_slotTick    = (slotTarget >> shift) << shift;
+    timer->_prev        = nullptr;
+    timer->_next        = _slots[level][timer->_slot];
+    if (timer->_next) {
+        timer->_next->_prev = timer;
+    }
+    _slots[level][timer->_slot] = timer;
+
+    if (level == 0) {
+        _level0Count++;
+    }
+}
+
+void QGCTimerWheel::_unlink(QGCWheelTimer* timer)
+{
+    if (timer->_level == -1) {
+        return;
+    }
+
+    if (timer->_prev) {
+        timer->_prev->_next = timer->_next;
+    } else if (timer->_level == _levels) {
+        _expiring = timer->_next;
+    } else {
+        _slots[timer->_level][timer->_slot] = timer->_next;
+    }
+    if (timer->_next) {
+        timer->_next->_prev = timer->_prev;
+    }
+    if (timer->_level == 0) {
+        _level0Count--;
+    }
+
+    timer->_level   = -1;
+    timer->_slot    = -1;
+    timer->_prev    = nullptr;
+    timer->_next    = nullptr;
+}
+
+/// Moves the timers of a higher level slot down to the levels below now that the wheel has come round to them
+void QGCTimerWheel::_cascade(int level)
+{
+    const int slot = static_cast<int>((_nextTick >> (_levelBits * level)) & _slotMask);
+
+    QGCWheelTimer* timer;
+    while ((timer = _slots[level][slot])) {
+        _unlink(timer);
+        _link(timer);
+    }
+}
+
+void QGCTimerWheel::_expire(int slot)
+{
+    const qint64 tick = _nextTick - 1;
+
+    // The slot is moved to its own list first so timers relinked a full turn ahead don't land back in the list being
+    // expired. Timers are then taken off one at a time since a timeout signal may stop or delete any other timer.
+    _expiring = _slots[0][slot];
+    _slots[0][slot] = nullptr;
+    for (QGCWheelTimer* timer=_expiring; timer; timer=timer->_next) {
+        timer->_level = _levels;
+        timer->_slot = 0;
+        _level0Count--;
+    }
+
+    QGCWheelTimer* timer;
+    while ((timer = _expiring)) {
+        _unlink(timer);
+
+        if (timer->_deadlineTick > tick) {
+            // Restarted since it was linked
+            _link(timer);
+            continue;
+        }
+
+        if (timer->_singleShot) {
+            timer->_active = false;
+            _activeCount--;
+        } else {
+            const qint64 intervalTicks = qMax(static_cast<qint64>(1), (static_cast<qint64>(timer->_intervalMSecs) + tickMSecs - 1) / tickMSecs);
+            timer->_deadlineTick = qMax(timer->_deadlineTick + intervalTicks, _nextTick);
+            _link(timer);
+        }
+        emit timer->timeout();
+    }
+}
+
+void QGCTimerWheel::_tick(void)
+{
+    const qint64 nowTick = _nowTick();
+
+    while (_activeCount > 0 && _nextTick <= nowTick) {
+        const qint64 tick = _nextTick;
+        if ((tick & _slotMask) == 0) {
+            for (int level=1; level<_levels; level++) {
+                _cascade(level);
+                if (((tick >> (_levelBits * level)) & _slotMask) != 0) {
+                    break;
+                }
+            }
+        }
+        _nextTick = tick + 1;
+        _expire(static_cast<int>(tick & _slotMask));
+
+        if (_level0Count == 0) {
+            // Nothing due before the next level 0 turn, skip straight to it
+            _nextTick = qMin(((tick >> _levelBits) + 1) << _levelBits, nowTick + 1);
+        }
+    }
+
+    if (_activeCount > 0) {
+        _startTickTimer();
+    }
+}
+
+void QGCTimerWheel::_startTickTimer(void)
+{
+    // Wake for the next level 0 slot with timers in it, or the next level 0 turn to cascade the level above
+    const qint64 turnTick = ((_nextTick >> _levelBits) + 1) << _levelBits;
+    _wakeTick = turnTick;
+    if (_level0Count > 0) {
+        for (qint64 tick=_nextTick; tick<turnTick; tick++) {
+            if (_slots[0][tick & _slotMask]) {
+                _wakeTick = tick;
+                break;
+            }
+        }
+    }
+    if ((_nextTick & _slotMask) == 0) {
+        // A cascade is due on _nextTick itself
+        _wakeTick = _nextTick;
+    }
+
+    const qint64 wakeMSecs = ((_wakeTick - 1) * tickMSecs) - _clock.elapsed();
+    _tickTimer.start(static_cast<int>(qMax(static_cast<qint64>(0), wakeMSecs)));
+}
@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/// Timer which is driven by the shared QGCTimerWheel instead of owning a QTimer. Drop in replacement for QTimer in
+/// liveness and timeout checks where a resolution of QGCTimerWheel::tickMSecs is good enough. Restarting an active
+/// timer only records the new deadline, so it is cheap enough to do for every received message. Main thread only.
+class QGCWheelTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    QGCWheelTimer(QObject* parent = nullptr);
+    ~QGCWheelTimer();
+
+    void    setInterval     (int msecs)         { _intervalMSecs = qMax(0, msecs); }
+    int     interval        (void) const        { return _intervalMSecs; }
+    void    setSingleShot   (bool singleShot)   { _singleShot = singleShot; }
+    bool    isSingleShot    (void) const        { return _singleShot; }
+    bool    isActive        (void) const        { return _active; }
+    /// @return Milliseconds until the timer fires, -1 if not active
+    int     remainingTime   (void) const;
+
+    /// (Re)starts the timer with the current interval
+    void    start           (void);
+    void    start           (int msecs);
+    void    stop            (void);
+
+signals:
+    void timeout(void);
+
+private:
+    bool            _active         = false;
+    bool            _singleShot     = false;
+    int             _intervalMSecs  = 0;
+    qint64          _deadlineTick   = 0;        ///< Tick the timer is due at
+    qint64          _slotTick       = 0;        ///< Tick at which the slot holding the timer is processed, <= _deadlineTick
+    int             _level          = -1;       ///< Wheel level holding the timer, -1 if not linked
+    int             _slot           = -1;
+    QGCWheelTimer*  _prev           = nullptr;  ///< Slot list links
+    QGCWheelTimer*  _next           = nullptr;
+
+    friend class QGCTimerWheel;
+};
+
+/// Hierarchical timer wheel behind QGCWheelTimer, replacing a QTimer per vehicle and subsystem with one shared tick.
+///
+/// Level 0 has a slot for each of the next _slotsPerLevel ticks, each higher level slot covers a whole turn of the
+/// level below. Timers far in the future sit in a coarse slot and move down a level each time the lower wheel comes
+/// round to them, so every timer is touched a handful of times at most regardless of how many there are. Restarted
+/// timers stay in their old slot and are moved once that slot comes up. The tick only runs while timers are active and
+/// skips ahead to the next level 0 turn while level 0 is empty.
+class QGCTimerWheel : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QGCTimerWheel* instance(void);
+
+    int activeCount(void) const { return _activeCount; }
+
+    static const int tickMSecs = 10;
+
+private slots:
+    void _tick(void);
+
+private:
+    QGCTimerWheel(QObject* parent);
+
+    void    _add            (QGCWheelTimer* timer);
+    void    _remove         (QGCWheelTimer* timer);
+    void    _link           (QGCWheelTimer* timer);
+    void    _unlink         (QGCWheelTimer* timer);
+    void    _cascade        (int level);
+    void    _expire         (int slot);
+    void    _startTickTimer (void);
+    /// Tick n is due once (n - 1) * tickMSecs have elapsed
+    qint64  _nowTick        (void) const { return (_clock.elapsed() / tickMSecs) + 1; }
+
+    static const int _levelBits     = 6;
+    static const int _slotsPerLevel = 1 << _levelBits;
+    static const int _slotMask      = _slotsPerLevel - 1;
+    static const int _levels        = 4;                    ///< 2^24 ticks, a little less than two days at 10ms
+
+    QGCWheelTimer*  _slots[_levels][_slotsPerLevel] = {};
+    QGCWheelTimer*  _expiring       = nullptr;              ///< Timers of the level 0 slot being expired, linked as level _levels
+    int             _level0Count    = 0;
+    int             _activeCount    = 0;
+    qint64          _nextTick       = 0;                    ///< Next tick to process, timers are linked relative to it
+    qint64          _wakeTick       = 0;                    ///< Tick _tickTimer is set to wake for
+    QElapsedTimer   _clock;
+    QTimer          _tickTimer;
+
+    friend class QGCWheelTimer;
+};
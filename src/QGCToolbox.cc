@@ -31,6 +31,8 @@
 #include "SettingsManager.h"
 #include "QGCApplication.h"
 #include "ADSBVehicleManager.h"
+#include "GeoFenceMonitor.h"
+#include "QGCMemoryAccounting.h"
 #if defined(QGC_ENABLE_PAIRING)
 #include "PairingManager.h"
 #endif
@@ -46,91 +48,120 @@
 #include "MicrohardManager.h"
 #endif
 
+#include "QGCStartupProfiler.h"
+
 #if defined(QGC_CUSTOM_BUILD)
 #include CUSTOMHEADER
 #endif
 
+/// Creates the tool, recording the time spent in its constructor in the startup timeline
+template<class T>
+static T* _createTool(QGCApplication* app, QGCToolbox* toolbox)
+{
+    QGCStartupProfiler::Scope scope(QStringLiteral("Create %1").arg(T::staticMetaObject.className()));
+    return new T(app, toolbox);
+}
+
 QGCToolbox::QGCToolbox(QGCApplication* app)
 {
     // SettingsManager must be first so settings are available to any subsequent tools
-    _settingsManager        = new SettingsManager           (app, this);
+    _settingsManager        = _createTool<SettingsManager>       (app, this);
     //-- Scan and load plugins
     _scanAndLoadPlugins(app);
-    _audioOutput            = new AudioOutput               (app, this);
-    _factSystem             = new FactSystem                (app, this);
-    _firmwarePluginManager  = new FirmwarePluginManager     (app, this);
+    _memoryAccounting       = _createTool<QGCMemoryAccounting>   (app, this);
+    _audioOutput            = _createTool<AudioOutput>           (app, this);
+    _factSystem             = _createTool<FactSystem>            (app, this);
+    _firmwarePluginManager  = _createTool<FirmwarePluginManager> (app, this);
 #ifndef __mobile__
-    _gpsManager             = new GPSManager                (app, this);
-#endif
-    _imageProvider          = new QGCImageProvider          (app, this);
-    _joystickManager        = new JoystickManager           (app, this);
-    _linkManager            = new LinkManager               (app, this);
-    _mavlinkProtocol        = new MAVLinkProtocol           (app, this);
-    _missionCommandTree     = new MissionCommandTree        (app, this);
-    _multiVehicleManager    = new MultiVehicleManager       (app, this);
-    _mapEngineManager       = new QGCMapEngineManager       (app, this);
-    _uasMessageHandler      = new UASMessageHandler         (app, this);
-    _qgcPositionManager     = new QGCPositionManager        (app, this);
-    _followMe               = new FollowMe                  (app, this);
-    _videoManager           = new VideoManager              (app, this);
-    _mavlinkLogManager      = new MAVLinkLogManager         (app, this);
-    _adsbVehicleManager     = new ADSBVehicleManager        (app, this);
+    _gpsManager             = _createTool<GPSManager>            (app, this);
+#endif
+    _imageProvider          = _createTool<QGCImageProvider>      (app, this);
+    _joystickManager        = _createTool<JoystickManager>       (app, this);
+    _linkManager            = _createTool<LinkManager>           (app, this);
+    _mavlinkProtocol        = _createTool<MAVLinkProtocol>       (app, this);
+    _missionCommandTree     = _createTool<MissionCommandTree>    (app, this);
+    _multiVehicleManager    = _createTool<MultiVehicleManager>   (app, this);
+    _mapEngineManager       = _createTool<QGCMapEngineManager>   (app, this);
+    _uasMessageHandler      = _createTool<UASMessageHandler>     (app, this);
+    _qgcPositionManager     = _createTool<QGCPositionManager>    (app, this);
+    _followMe               = _createTool<FollowMe>              (app, this);
+    _videoManager           = _createTool<VideoManager>          (app, this);
+    _mavlinkLogManager      = _createTool<MAVLinkLogManager>     (app, this);
+    _adsbVehicleManager     = _createTool<ADSBVehicleManager>    (app, this);
+    _geoFenceMonitor        = _createTool<GeoFenceMonitor>       (app, this);
 #if defined(QGC_ENABLE_PAIRING)
-    _pairingManager         = new PairingManager            (app, this);
+    _pairingManager         = _createTool<PairingManager>        (app, this);
 #endif
     //-- Airmap Manager
     //-- This should be "pluggable" so an arbitrary AirSpace manager can be used
     //-- For now, we instantiate the one and only AirMap provider
 #if defined(QGC_AIRMAP_ENABLED)
-    _airspaceManager        = new AirMapManager             (app, this);
+    _airspaceManager        = _createTool<AirMapManager>         (app, this);
 #else
-    _airspaceManager        = new AirspaceManager           (app, this);
+    _airspaceManager        = _createTool<AirspaceManager>       (app, this);
 #endif
 #if defined(QGC_GST_TAISYNC_ENABLED)
-    _taisyncManager         = new TaisyncManager            (app, this);
+    _taisyncManager         = _createTool<TaisyncManager>        (app, this);
 #endif
 #if defined(QGC_GST_MICROHARD_ENABLED)
-    _microhardManager       = new MicrohardManager          (app, this);
+    _microhardManager       = _createTool<MicrohardManager>      (app, this);
 #endif
 }
 
 void QGCToolbox::setChildToolboxes(void)
 {
     // SettingsManager must be first so settings are available to any subsequent tools
-    _settingsManager->setToolbox(this);
+    _setChildToolbox(_settingsManager);
+    // Before the tools which add memory sources
+    _setChildToolbox(_memoryAccounting);
 
-    _corePlugin->setToolbox(this);
-    _audioOutput->setToolbox(this);
-    _factSystem->setToolbox(this);
-    _firmwarePluginManager->setToolbox(this);
+    _setChildToolbox(_corePlugin);
+    _setChildToolbox(_audioOutput);
+    _setChildToolbox(_factSystem);
+    _setChildToolbox(_firmwarePluginManager);
 #ifndef __mobile__
-    _gpsManager->setToolbox(this);
-#endif
-    _imageProvider->setToolbox(this);
-    _joystickManager->setToolbox(this);
-    _linkManager->setToolbox(this);
-    _mavlinkProtocol->setToolbox(this);
-    _missionCommandTree->setToolbox(this);
-    _multiVehicleManager->setToolbox(this);
-    _mapEngineManager->setToolbox(this);
-    _uasMessageHandler->setToolbox(this);
-    _followMe->setToolbox(this);
-    _qgcPositionManager->setToolbox(this);
-    _videoManager->setToolbox(this);
-    _mavlinkLogManager->setToolbox(this);
-    _airspaceManager->setToolbox(this);
-    _adsbVehicleManager->setToolbox(this);
+    _setChildToolbox(_gpsManager);
+#endif
+    _setChildToolbox(_imageProvider);
+    _setChildToolbox(_joystickManager);
+    _setChildToolbox(_linkManager);
+    _setChildToolbox(_mavlinkProtocol);
+    _setChildToolbox(_missionCommandTree);
+    _setChildToolbox(_multiVehicleManager);
+    _setChildToolbox(_mapEngineManager);
+    _setChildToolbox(_uasMessageHandler);
+    _setChildToolbox(_followMe);
+    _setChildToolbox(_qgcPositionManager);
+    _setChildToolbox(_videoManager);
+    _setChildToolbox(_mavlinkLogManager);
+    _setChildToolbox(_airspaceManager);
+    _setChildToolbox(_adsbVehicleManager);
+    _setChildToolbox(_geoFenceMonitor);
 #if defined(QGC_GST_TAISYNC_ENABLED)
-    _taisyncManager->setToolbox(this);
+    _setChildToolbox(_taisyncManager);
 #endif
 #if defined(QGC_GST_MICROHARD_ENABLED)
-    _microhardManager->setToolbox(this);
+    _setChildToolbox(_microhardManager);
 #endif
 #if defined(QGC_ENABLE_PAIRING)
-    _pairingManager->setToolbox(this);
+    _setChildToolbox(_pairingManager);
 #endif
 }
 
+void QGCToolbox::_setChildToolbox(QGCTool* tool)
+{
+    QGCStartupProfiler::Scope scope(QStringLiteral("setToolbox %1").arg(tool->metaObject()->className()));
+    tool->setToolbox(this);
+}
+
+void QGCToolbox::initDeferredTools(void)
+{
+    for (QGCTool* tool: findChildren<QGCTool*>(QString(), Qt::FindDirectChildrenOnly)) {
+        QGCStartupProfiler::Scope scope(QStringLiteral("initDeferred %1").arg(tool->metaObject()->className()));
+        tool->initDeferred();
+    }
+}
+
 void QGCToolbox::_scanAndLoadPlugins(QGCApplication* app)
 {
 #if defined (QGC_CUSTOM_BUILD)
@@ -155,3 +186,7 @@ void QGCTool::setToolbox(QGCToolbox* toolbox)
 {
     _toolbox = toolbox;
 }
+
+void QGCTool::initDeferred(void)
+{
+}
@@ -34,6 +34,9 @@ class QGCCorePlugin;
 class SettingsManager;
 class AirspaceManager;
 class ADSBVehicleManager;
+class GeoFenceMonitor;
+class QGCMemoryAccounting;
+class QGCTool;
 #if defined(QGC_ENABLE_PAIRING)
 class PairingManager;
 #endif
@@ -69,6 +72,8 @@ public:
     SettingsManager*            settingsManager         () { return _settingsManager; }
     AirspaceManager*            airspaceManager         () { return _airspaceManager; }
     ADSBVehicleManager*         adsbVehicleManager      () { return _adsbVehicleManager; }
+    GeoFenceMonitor*            geoFenceMonitor         () { return _geoFenceMonitor; }
+    QGCMemoryAccounting*        memoryAccounting        () { return _memoryAccounting; }
 #if defined(QGC_ENABLE_PAIRING)
     PairingManager*             pairingManager          () { return _pairingManager; }
 #endif
@@ -82,8 +87,12 @@ public:
     MicrohardManager*           microhardManager        () { return _microhardManager; }
 #endif
 
+    /// Calls initDeferred on all tools. Called once the first frame of the main window is shown.
+    void initDeferredTools(void);
+
 private:
     void setChildToolboxes(void);
+    void _setChildToolbox(QGCTool* tool);
     void _scanAndLoadPlugins(QGCApplication *app);
 
 
@@ -109,6 +118,8 @@ private:
     SettingsManager*            _settingsManager        = nullptr;
     AirspaceManager*            _airspaceManager        = nullptr;
     ADSBVehicleManager*         _adsbVehicleManager     = nullptr;
+    GeoFenceMonitor*            _geoFenceMonitor        = nullptr;
+    QGCMemoryAccounting*        _memoryAccounting       = nullptr;
 #if defined(QGC_ENABLE_PAIRING)
     PairingManager*             _pairingManager         = nullptr;
 #endif
@@ -134,6 +145,10 @@ public:
     // If you override this method, you must call the base class.
     virtual void setToolbox(QGCToolbox* toolbox);
 
+    // Third phase, called once the main window has shown its first frame. Startup work which is not needed to
+    // show the ui (device probing, network connections, ...) should be done here instead of in setToolbox.
+    virtual void initDeferred(void);
+
 protected:
     QGCApplication* _app;
     QGCToolbox*     _toolbox;
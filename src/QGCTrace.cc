@@ -0,0 +1,227 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTrace.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <chrono>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(QGCTraceLog, "QGCTraceLog")
+
+namespace {
+    const int _bufferEventCount = 16384;    ///< Spans kept per thread
+
+    typedef struct {
+        const char* name;
+        quint64     threadId;
+        qint64      startNSecs;
+        qint64      durationNSecs;
+    } TraceEvent_t;
+
+    typedef struct {
+        qint64  count;
+        qint64  totalNSecs;
+        qint64  maxNSecs;
+    } TraceTotal_t;
+
+    /// Ring buffer owned by one thread at a time. The mutex is only contended while a trace is being written.
+    class ThreadBuffer {
+    public:
+        ThreadBuffer(void) { events.resize(_bufferEventCount); }
+
+        QMutex                  mutex;
+        QVector<TraceEvent_t>   events;
+        QHash<const char*, TraceTotal_t> totals;    ///< Keyed by name literal, merged by string when reported
+        int                     nextIndex   = 0;
+        int                     eventCount  = 0;
+        bool                    inUse       = true;
+    };
+
+    /// Buffers are never freed, the buffer of a finished thread is reused by the next new thread and keeps its spans
+    /// until they are overwritten. These are leaked so they outlive thread local destruction at exit.
+    QMutex&                     buffersMutex(void) { static QMutex* mutex = new QMutex; return *mutex; }
+    QList<ThreadBuffer*>&       buffers     (void) { static QList<ThreadBuffer*>* list = new QList<ThreadBuffer*>; return *list; }
+    QHash<quint64, QString>&    threadNames (void) { static QHash<quint64, QString>* hash = new QHash<quint64, QString>; return *hash; }
+
+    quint64 currentThreadId(void)
+    {
+        return static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    }
+
+    ThreadBuffer* acquireBuffer(void)
+    {
+        QMutexLocker lock(&buffersMutex());
+
+        quint64 threadId    = currentThreadId();
+        QString threadName  = QThread::currentThread() ? QThread::currentThread()->objectName() : QString();
+        threadNames()[threadId] = threadName.isEmpty() ? QStringLiteral("Thread %1").arg(threadId) : threadName;
+
+        for (ThreadBuffer* buffer: buffers()) {
+            QMutexLocker bufferLock(&buffer->mutex);
+            if (!buffer->inUse) {
+                buffer->inUse = true;
+                return buffer;
+            }
+        }
+
+        ThreadBuffer* buffer = new ThreadBuffer;
+        buffers().append(buffer);
+        return buffer;
+    }
+
+    struct ThreadBufferHolder {
+        ~ThreadBufferHolder()
+        {
+            if (buffer) {
+                QMutexLocker lock(&buffer->mutex);
+                buffer->inUse = false;
+            }
+        }
+
+        ThreadBuffer*   buffer      = nullptr;
+        quint64         threadId    = 0;
+    };
+
+    thread_local ThreadBufferHolder threadBuffer;
+}
+
+qint64 QGCTrace::_nowNSecs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void QGCTrace::_addEvent(const char* name, qint64 startNSecs, qint64 durationNSecs)
+{
+    if (!threadBuffer.buffer) {
+        threadBuffer.buffer     = acquireBuffer();
+        threadBuffer.threadId   = currentThreadId();
+    }
+
+    ThreadBuffer* buffer = threadBuffer.buffer;
+    QMutexLocker lock(&buffer->mutex);
+    buffer->events[buffer->nextIndex] = { name, threadBuffer.threadId, startNSecs, durationNSecs };
+    buffer->nextIndex = (buffer->nextIndex + 1) % _bufferEventCount;
+    buffer->eventCount = qMin(buffer->eventCount + 1, _bufferEventCount);
+
+    TraceTotal_t& total = buffer->totals[name];
+    total.count++;
+    total.totalNSecs += durationNSecs;
+    total.maxNSecs = qMax(total.maxNSecs, durationNSecs);
+}
+
+void QGCTrace::clear(void)
+{
+    QMutexLocker lock(&buffersMutex());
+
+    for (ThreadBuffer* buffer: buffers()) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        buffer->nextIndex   = 0;
+        buffer->eventCount  = 0;
+        buffer->totals.clear();
+    }
+}
+
+QJsonObject QGCTrace::totals(void)
+{
+    QHash<QString, TraceTotal_t> merged;
+    {
+        QMutexLocker lock(&buffersMutex());
+
+        for (ThreadBuffer* buffer: buffers()) {
+            QMutexLocker bufferLock(&buffer->mutex);
+            for (auto iter = buffer->totals.constBegin(); iter != buffer->totals.constEnd(); iter++) {
+                TraceTotal_t& total = merged[QString::fromLatin1(iter.key())];
+                total.count        += iter.value().count;
+                total.totalNSecs   += iter.value().totalNSecs;
+                total.maxNSecs      = qMax(total.maxNSecs, iter.value().maxNSecs);
+            }
+        }
+    }
+
+    QJsonObject result;
+    for (auto iter = merged.constBegin(); iter != merged.constEnd(); iter++) {
+        QJsonObject total;
+        total[QStringLiteral("count")]      = iter.value().count;
+        total[QStringLiteral("totalMSecs")] = iter.value().totalNSecs / 1000000.0;
+        total[QStringLiteral("maxMSecs")]   = iter.value().maxNSecs / 1000000.0;
+        result[iter.key()] = total;
+    }
+    return result;
+}
+
+bool QGCTrace::writeChromeTrace(const QString& fileName)
+{
+    QVector<TraceEvent_t>   events;
+    QHash<quint64, QString> names;
+    {
+        QMutexLocker lock(&buffersMutex());
+
+        names = threadNames();
+        for (ThreadBuffer* buffer: buffers()) {
+            QMutexLocker bufferLock(&buffer->mutex);
+            int firstIndex = (buffer->nextIndex - buffer->eventCount + _bufferEventCount) % _bufferEventCount;
+            for (int i=0; i<buffer->eventCount; i++) {
+                events.append(buffer->events[(firstIndex + i) % _bufferEventCount]);
+            }
+        }
+    }
+
+    qint64 zeroNSecs = std::numeric_limits<qint64>::max();
+    for (const TraceEvent_t& event: events) {
+        zeroNSecs = qMin(zeroNSecs, event.startNSecs);
+    }
+
+    QJsonArray traceEvents;
+    for (auto iter = names.constBegin(); iter != names.constEnd(); iter++) {
+        QJsonObject args;
+        args[QStringLiteral("name")] = iter.value();
+
+        QJsonObject metadataEvent;
+        metadataEvent[QStringLiteral("name")]   = QStringLiteral("thread_name");
+        metadataEvent[QStringLiteral("ph")]     = QStringLiteral("M");
+        metadataEvent[QStringLiteral("pid")]    = 1;
+        metadataEvent[QStringLiteral("tid")]    = static_cast<qint64>(iter.key());
+        metadataEvent[QStringLiteral("args")]   = args;
+        traceEvents.append(metadataEvent);
+    }
+    for (const TraceEvent_t& event: events) {
+        QJsonObject traceEvent;
+        traceEvent[QStringLiteral("name")]  = QString::fromLatin1(event.name);
+        traceEvent[QStringLiteral("ph")]    = QStringLiteral("X");
+        traceEvent[QStringLiteral("pid")]   = 1;
+        traceEvent[QStringLiteral("tid")]   = static_cast<qint64>(event.threadId);
+        traceEvent[QStringLiteral("ts")]    = (event.startNSecs - zeroNSecs) / 1000.0;
+        traceEvent[QStringLiteral("dur")]   = event.durationNSecs / 1000.0;
+        traceEvents.append(traceEvent);
+    }
+
+    QJsonObject trace;
+    trace[QStringLiteral("traceEvents")] = traceEvents;
+
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCWarning(QGCTraceLog) << "Unable to write trace" << fileName << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    qCDebug(QGCTraceLog) << "Trace written to" << fileName << events.count() << "spans";
+    return true;
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QJsonObject>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTraceLog)
+
+/// Low overhead scoped tracing for hot paths.
+///
+/// Tracing is compiled into all builds and is turned on at runtime by enabling the QGCTraceLog logging category. When
+/// it is off a trace scope costs a single flag check. Each thread records into its own ring buffer which keeps the
+/// last _bufferEventCount spans, so a trace written after a stall shows what led up to it. The trace is written in
+/// Chrome trace event format which can be opened with chrome://tracing or Perfetto.
+///
+/// Usage: QGC_TRACE_SCOPE("MAVLinkProtocol::receiveBytes"); Names must be string literals.
+class QGCTrace
+{
+public:
+    class Scope
+    {
+    public:
+        Scope(const char* name)
+            : _name(QGCTraceLog().isDebugEnabled() ? name : nullptr)
+        {
+            if (_name) {
+                _startNSecs = QGCTrace::_nowNSecs();
+            }
+        }
+
+        ~Scope()
+        {
+            if (_name) {
+                QGCTrace::_addEvent(_name, _startNSecs, QGCTrace::_nowNSecs() - _startNSecs);
+            }
+        }
+
+    private:
+        const char* _name;
+        qint64      _startNSecs = 0;
+
+        Q_DISABLE_COPY(Scope)
+    };
+
+    /// Writes the spans currently held by all thread buffers
+    ///     @return false: file could not be written
+    static bool writeChromeTrace(const QString& fileName);
+
+    /// Per span name totals since the last clear, unlike the ring buffers these cover every span recorded
+    ///     @return name: { count, totalMSecs, maxMSecs }
+    static QJsonObject totals(void);
+
+    /// Discards all recorded spans and totals
+    static void clear(void);
+
+private:
+    static qint64   _nowNSecs   (void);
+    static void     _addEvent   (const char* name, qint64 startNSecs, qint64 durationNSecs);
+};
+
+#define QGC_TRACE_CONCAT_(a, b) a##b
+#define QGC_TRACE_CONCAT(a, b)  QGC_TRACE_CONCAT_(a, b)
+#define QGC_TRACE_SCOPE(name)   QGCTrace::Scope QGC_TRACE_CONCAT(_qgcTraceScope, __LINE__)(name)
@@ -20,6 +20,9 @@
 #include <QStringListModel>
 #include <QtConcurrent>
 #include <QTextStream>
+#include <QThread>
+
+#include <cstring>
 
 Q_GLOBAL_STATIC(AppLogModel, debug_model)
 
@@ -27,18 +30,21 @@ static QtMessageHandler old_handler;
 
 static void msgHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    const char symbols[] = { 'D', 'E', '!', 'X', 'I' };
-    QString output = QString("[%1] at %2:%3 - \"%4\"").arg(symbols[type]).arg(context.file).arg(context.line).arg(msg);
-
     // Avoid recursion
-    if (!QString(context.category).startsWith("qt.quick")) {
-        debug_model->log(output);
+    if (!context.category || strncmp(context.category, "qt.quick", 8) != 0) {
+        AppLogModel::log(type, context, msg);
     }
 
     if (old_handler != nullptr) {
         old_handler(type, context, msg);
     }
-    if( type == QtFatalMsg ) abort();
+    if( type == QtFatalMsg ) {
+        // Get the queued messages into the console log before going down
+        if (QThread::currentThread() == debug_model->thread()) {
+            AppLogModel::flush();
+        }
+        abort();
+    }
 }
 
 void AppMessages::installHandler()
@@ -56,24 +62,29 @@ AppLogModel *AppMessages::getModel()
 
 AppLogModel::AppLogModel() : QStringListModel()
 {
-#ifdef __mobile__
-    Qt::ConnectionType contype = Qt::QueuedConnection;
-#else
-    Qt::ConnectionType contype = Qt::AutoConnection;
-#endif
-    connect(this, &AppLogModel::emitLog, this, &AppLogModel::threadsafeLog, contype);
+    _rateTimer.start();
 }
 
 void AppLogModel::writeMessages(const QString dest_file)
 {
     const QString writebuffer(stringList().join('\n').append('\n'));
 
-    QtConcurrent::run([dest_file, writebuffer] {
+    // Lines which are added to the history from now on are also in writebuffer
+    const QString historyFileName(_historyFile.isOpen() ? _historyFile.fileName() : QString());
+    const qint64  historySize = _historyFile.isOpen() ? _historyFile.size() : 0;
+
+    QtConcurrent::run([dest_file, writebuffer, historyFileName, historySize] {
         emit debug_model->writeStarted();
         bool success = false;
         QFile file(dest_file);
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&file);
+            if (!historyFileName.isEmpty()) {
+                QFile history(historyFileName);
+                if (history.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                    out << QString::fromUtf8(history.read(historySize));
+                }
+            }
             out << writebuffer;
             success = out.status() == QTextStream::Ok;
         } else {
@@ -83,17 +94,133 @@ void AppLogModel::writeMessages(const QString dest_file)
     });
 }
 
-void AppLogModel::log(const QString message)
+void AppLogModel::log(QtMsgType type, const QMessageLogContext& context, const QString& message)
 {
-    emit debug_model->emitLog(message);
+    AppLogModel* model = debug_model;
+    bool wasEmpty;
+
+    {
+        QMutexLocker lock(&model->_pendingMutex);
+        wasEmpty = model->_pending.isEmpty();
+        if (model->_rateLimit(type, context.category)) {
+            return;
+        }
+        model->_queueMessage(type, context.file, context.line, message);
+    }
+
+    // A single queued call processes everything which arrives before it runs
+    if (wasEmpty) {
+        QMetaObject::invokeMethod(model, "_processPending", Qt::QueuedConnection);
+    }
+}
+
+void AppLogModel::flush(void)
+{
+    debug_model->_processPending();
 }
 
-void AppLogModel::threadsafeLog(const QString message)
+/// Must be called with _pendingMutex held
+void AppLogModel::_queueMessage(QtMsgType type, const char* file, int line, const QString& message)
 {
-    const int line = rowCount();
-    insertRows(line, 1);
-    setData(index(line), message, Qt::DisplayRole);
+    _pending.append({ type, file, line, message });
+}
 
+/// Must be called with _pendingMutex held. Queues a summary for the previous window when messages were dropped.
+///     @return true: message should be dropped
+bool AppLogModel::_rateLimit(QtMsgType type, const char* category)
+{
+    if ((type != QtDebugMsg && type != QtInfoMsg) || !category) {
+        return false;
+    }
+
+    const qint64    nowMSecs    = _rateTimer.elapsed();
+    CategoryRate_t& rate        = _categoryRates[category];
+
+    if (nowMSecs - rate.windowStartMSecs >= 1000) {
+        if (rate.suppressedCount) {
+            _queueMessage(QtWarningMsg, nullptr, 0, QStringLiteral("%1 messages from %2 suppressed").arg(rate.suppressedCount).arg(QLatin1String(category)));
+        }
+        rate.windowStartMSecs   = nowMSecs;
+        rate.count              = 0;
+        rate.suppressedCount    = 0;
+    }
+
+    if (++rate.count > _maxCategoryMessagesPerSec) {
+        rate.suppressedCount++;
+        return true;
+    }
+    return false;
+}
+
+QString AppLogModel::_formatMessage(const PendingMessage_t& message)
+{
+    const char symbols[] = { 'D', 'E', '!', 'X', 'I' };
+    return QString("[%1] at %2:%3 - \"%4\"").arg(symbols[message.type]).arg(message.file).arg(message.line).arg(message.message);
+}
+
+void AppLogModel::_processPending(void)
+{
+    QVector<PendingMessage_t> pending;
+    {
+        QMutexLocker lock(&_pendingMutex);
+        pending.swap(_pending);
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    QStringList newRows;
+    QString     logLines;
+    for (const PendingMessage_t& message: pending) {
+        const QString line = _formatMessage(message);
+        logLines.append(line).append('\n');
+
+        if (line == _lastMessage && (rowCount() || !newRows.isEmpty())) {
+            _lastMessageRepeatCount++;
+            const QString repeatedLine = QStringLiteral("%1 (x%2)").arg(line).arg(_lastMessageRepeatCount);
+            if (newRows.isEmpty()) {
+                setData(index(rowCount() - 1), repeatedLine, Qt::DisplayRole);
+            } else {
+                newRows.last() = repeatedLine;
+            }
+        } else {
+            _lastMessage            = line;
+            _lastMessageRepeatCount = 1;
+            newRows.append(line);
+        }
+    }
+
+    _appendRows(newRows);
+    _openLogFile();
+    _writeLogFile(logLines);
+}
+
+void AppLogModel::_appendRows(const QStringList& lines)
+{
+    QStringList rows = lines;
+
+    while (rowCount() && rowCount() + rows.count() > _maxLines) {
+        _dropOldLines();
+    }
+    if (rows.count() > _maxLines) {
+        // Burst larger than the model goes straight to the history
+        const int overflowCount = rows.count() - _maxLines;
+        _appendHistory(rows.mid(0, overflowCount));
+        rows = rows.mid(overflowCount);
+    }
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    const int firstRow = rowCount();
+    insertRows(firstRow, rows.count());
+    for (int i=0; i<rows.count(); i++) {
+        setData(index(firstRow + i), rows[i], Qt::DisplayRole);
+    }
+}
+
+void AppLogModel::_openLogFile(void)
+{
     if (qgcApp() && qgcApp()->logOutput() && _logFile.fileName().isEmpty()) {
         qDebug() << _logFile.fileName().isEmpty() << qgcApp()->logOutput();
         QGCToolbox* toolbox = qgcApp()->toolbox();
@@ -109,10 +236,40 @@ void AppLogModel::threadsafeLog(const QString message)
             }
         }
     }
+}
 
+/// Writes a batch of newline terminated lines to the console log with a single flush
+void AppLogModel::_writeLogFile(const QString& lines)
+{
     if (_logFile.isOpen()) {
         QTextStream out(&_logFile);
-        out << message << "\n";
+        out << lines;
+        out.flush();
         _logFile.flush();
     }
 }
+
+void AppLogModel::_dropOldLines(void)
+{
+    const int dropCount = qMin(_maxLines / 2, rowCount());
+
+    QStringList lines;
+    for (int row=0; row<dropCount; row++) {
+        lines.append(data(index(row), Qt::DisplayRole).toString());
+    }
+    _appendHistory(lines);
+
+    removeRows(0, dropCount);
+}
+
+void AppLogModel::_appendHistory(const QStringList& lines)
+{
+    // No warning on failure, it would be logged back into this model
+    if (_historyFile.isOpen() || _historyFile.open()) {
+        QTextStream out(&_historyFile);
+        for (const QString& line: lines) {
+            out << line << "\n";
+        }
+        out.flush();
+    }
+}
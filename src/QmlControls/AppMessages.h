@@ -14,29 +14,79 @@
 #include <QStringListModel>
 #include <QUrl>
 #include <QFile>
+#include <QTemporaryFile>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QElapsedTimer>
 
 // Hackish way to force only this translation unit to have public ctor access
 #ifndef _LOG_CTOR_ACCESS_
 #define _LOG_CTOR_ACCESS_ private
 #endif
 
+/// Console log shown in the application messages page.
+///
+/// Only the last _maxLines lines are kept in the model. When it is full the older half is moved to a temporary
+/// history file, writeMessages() writes the history followed by the lines in the model. A line which repeats the
+/// last line is collapsed into it with a repeat count.
+///
+/// Messages are queued by the message handler without formatting and processed in batches on the gui thread, so
+/// logging from a busy thread only costs a short locked append. Debug and info messages are rate limited per
+/// category, messages over _maxCategoryMessagesPerSec are dropped and counted.
 class AppLogModel : public QStringListModel
 {
     Q_OBJECT
 public:
     Q_INVOKABLE void writeMessages(const QString dest_file);
-    static void log(const QString message);
+
+    /// Queues a message from the message handler. Thread safe.
+    static void log(QtMsgType type, const QMessageLogContext& context, const QString& message);
+
+    /// Processes the queued messages immediately. Must be called on the gui thread.
+    static void flush(void);
 
 signals:
-    void emitLog(const QString message);
     void writeStarted();
     void writeFinished(bool success);
 
 private slots:
-    void threadsafeLog(const QString message);
+    void _processPending(void);
 
 private:
-    QFile _logFile;
+    typedef struct {
+        QtMsgType   type;
+        const char* file;       ///< __FILE__ literal from the message context, may be null
+        int         line;
+        QString     message;
+    } PendingMessage_t;
+
+    typedef struct {
+        qint64  windowStartMSecs;
+        int     count;
+        int     suppressedCount;
+    } CategoryRate_t;
+
+    void            _queueMessage       (QtMsgType type, const char* file, int line, const QString& message);
+    bool            _rateLimit          (QtMsgType type, const char* category);
+    void            _openLogFile        (void);
+    void            _writeLogFile       (const QString& lines);
+    void            _appendRows         (const QStringList& lines);
+    void            _dropOldLines       (void);
+    void            _appendHistory      (const QStringList& lines);
+    static QString  _formatMessage      (const PendingMessage_t& message);
+
+    QMutex                          _pendingMutex;      ///< Protects _pending and _categoryRates
+    QVector<PendingMessage_t>       _pending;
+    QHash<const char*, CategoryRate_t> _categoryRates;  ///< Keyed by category name, which outlives its messages
+    QElapsedTimer                   _rateTimer;
+    QFile                           _logFile;
+    QTemporaryFile                  _historyFile;
+    QString                         _lastMessage;
+    int                             _lastMessageRepeatCount = 0;
+
+    static const int _maxLines                  = 5000;
+    static const int _maxCategoryMessagesPerSec = 200;
 
 _LOG_CTOR_ACCESS_:
     AppLogModel();
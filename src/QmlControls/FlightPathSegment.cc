@@ -12,6 +12,8 @@
 
 QGC_LOGGING_CATEGORY(FlightPathSegmentLog, "FlightPathSegmentLog")
 
+QCache<QString, TerrainPathQuery::PathHeightInfo_t> FlightPathSegment::_terrainHeightCache(FlightPathSegment::_maxCachedTerrainHeights);
+
 FlightPathSegment::FlightPathSegment(SegmentType segmentType, const QGeoCoordinate& coord1, double amslCoord1Alt, const QGeoCoordinate& coord2, double amslCoord2Alt, bool queryTerrainData, QObject* parent)
     : QObject           (parent)
     , _coord1           (coord1)
@@ -77,9 +79,25 @@ void FlightPathSegment::setSpecialVisual(bool specialVisual)
     }
 }
 
+QString FlightPathSegment::_terrainCacheKey(const QGeoCoordinate& coord1, const QGeoCoordinate& coord2)
+{
+    return QString::asprintf("%.7f,%.7f,%.7f,%.7f", coord1.latitude(), coord1.longitude(), coord2.latitude(), coord2.longitude());
+}
+
 void FlightPathSegment::_sendTerrainPathQuery(void)
 {
     if (_queryTerrainData && _coord1.isValid() && _coord2.isValid()) {
+        QString cacheKey = _terrainCacheKey(_coord1, _coord2);
+
+        if (_currentTerrainPathQuery && cacheKey == _currentTerrainCacheKey) {
+            // Already waiting on the results for these endpoints
+            return;
+        }
+        if (!_currentTerrainPathQuery && cacheKey == _terrainCacheKey && _amslTerrainHeights.count()) {
+            // Endpoints moved and then moved back, current heights are still correct
+            return;
+        }
+
         qCDebug(FlightPathSegmentLog) << this << "_sendTerrainPathQuery";
         // Clear any previous query
         if (_currentTerrainPathQuery) {
@@ -88,14 +106,25 @@ void FlightPathSegment::_sendTerrainPathQuery(void)
             _currentTerrainPathQuery = nullptr;
         }
 
+        TerrainPathQuery::PathHeightInfo_t* cachedPathHeightInfo = _terrainHeightCache.object(cacheKey);
+        if (cachedPathHeightInfo) {
+            qCDebug(FlightPathSegmentLog) << this << "_sendTerrainPathQuery cache hit";
+            _terrainCacheKey = cacheKey;
+            _setTerrainHeights(*cachedPathHeightInfo);
+            _updateTerrainCollision();
+            return;
+        }
+
         // Clear old terrain data
         _amslTerrainHeights.clear();
+        _terrainCacheKey.clear();
         _distanceBetween = 0;
         _finalDistanceBetween = 0;
         emit distanceBetweenChanged(0);
         emit finalDistanceBetweenChanged(0);
         emit amslTerrainHeightsChanged();
 
+        _currentTerrainCacheKey = cacheKey;
         _currentTerrainPathQuery = new TerrainPathQuery(true /* autoDelete */);
         connect(_currentTerrainPathQuery, &TerrainPathQuery::terrainDataReceived, this, &FlightPathSegment::_terrainDataReceived);
         _currentTerrainPathQuery->requestData(_coord1, _coord2);
@@ -106,28 +135,37 @@ void FlightPathSegment::_terrainDataReceived(bool success, const TerrainPathQuer
 {
     qCDebug(FlightPathSegmentLog) << this << "_terrainDataReceived" << success << pathHeightInfo.heights.count();
     if (success) {
-        if (!QGC::fuzzyCompare(pathHeightInfo.distanceBetween, _distanceBetween)) {
-            _distanceBetween = pathHeightInfo.distanceBetween;
-            emit distanceBetweenChanged(_distanceBetween);
-        }
-        if (!QGC::fuzzyCompare(pathHeightInfo.finalDistanceBetween, _finalDistanceBetween)) {
-            _finalDistanceBetween = pathHeightInfo.finalDistanceBetween;
-            emit finalDistanceBetweenChanged(_finalDistanceBetween);
-        }
-
-        _amslTerrainHeights.clear();
-        for (const double& amslTerrainHeight: pathHeightInfo.heights) {
-            _amslTerrainHeights.append(amslTerrainHeight);
-        }
-        emit amslTerrainHeightsChanged();
+        _terrainHeightCache.insert(_currentTerrainCacheKey, new TerrainPathQuery::PathHeightInfo_t(pathHeightInfo), qMax(1, pathHeightInfo.heights.count()));
+        _terrainCacheKey = _currentTerrainCacheKey;
+        _setTerrainHeights(pathHeightInfo);
     }
 
     _currentTerrainPathQuery->deleteLater();
     _currentTerrainPathQuery = nullptr;
+    _currentTerrainCacheKey.clear();
 
     _updateTerrainCollision();
 }
 
+void FlightPathSegment::_setTerrainHeights(const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    if (!QGC::fuzzyCompare(pathHeightInfo.distanceBetween, _distanceBetween)) {
+        _distanceBetween = pathHeightInfo.distanceBetween;
+        emit distanceBetweenChanged(_distanceBetween);
+    }
+    if (!QGC::fuzzyCompare(pathHeightInfo.finalDistanceBetween, _finalDistanceBetween)) {
+        _finalDistanceBetween = pathHeightInfo.finalDistanceBetween;
+        emit finalDistanceBetweenChanged(_finalDistanceBetween);
+    }
+
+    _amslTerrainHeights.clear();
+    _amslTerrainHeights.reserve(pathHeightInfo.heights.count());
+    for (const double& amslTerrainHeight: pathHeightInfo.heights) {
+        _amslTerrainHeights.append(amslTerrainHeight);
+    }
+    emit amslTerrainHeightsChanged();
+}
+
 void FlightPathSegment::_updateTotalDistance(void)
 {
     double newTotalDistance = 0;
@@ -141,11 +179,44 @@ void FlightPathSegment::_updateTotalDistance(void)
     }
 }
 
+/// Checks the path against the min/max pyramids of the cached terrain tiles, which is exact and fast enough to run on every
+/// altitude change. Takeoff and land segments are shortened by the ignored distance first.
+bool FlightPathSegment::_cachedTerrainCollision(bool& terrainCollision)
+{
+    if (!_coord1.isValid() || !_coord2.isValid() || qIsNaN(_coord1AMSLAlt) || qIsNaN(_coord2AMSLAlt)) {
+        return false;
+    }
+
+    double tStart   = 0;
+    double tEnd     = 1;
+    if (_totalDistance > 0) {
+        if (_segmentType == SegmentTypeTakeoff) {
+            tStart = _collisionIgnoreMeters / _totalDistance;
+        } else if (_segmentType == SegmentTypeLand) {
+            tEnd = 1 - (_collisionIgnoreMeters / _totalDistance);
+        }
+    }
+    if (tStart >= tEnd) {
+        terrainCollision = false;
+        return true;
+    }
+
+    auto pointAlong = [this](double t) {
+        return QGeoCoordinate(_coord1.latitude() + ((_coord2.latitude() - _coord1.latitude()) * t), _coord1.longitude() + ((_coord2.longitude() - _coord1.longitude()) * t));
+    };
+    auto altAlong = [this](double t) {
+        return _coord1AMSLAlt + ((_coord2AMSLAlt - _coord1AMSLAlt) * t);
+    };
+
+    return TerrainPathQuery::pathCollision(pointAlong(tStart), altAlong(tStart), pointAlong(tEnd), altAlong(tEnd), terrainCollision);
+}
+
 void FlightPathSegment::_updateTerrainCollision(void)
 {
     bool newTerrainCollision = false;
 
-    if (_segmentType != SegmentTypeTerrainFrame) {
+    if (_segmentType != SegmentTypeTerrainFrame && !_cachedTerrainCollision(newTerrainCollision)) {
+        // Terrain tiles are not cached, fall back to the heights queried along the path
         double slope =      (_coord2AMSLAlt - _coord1AMSLAlt) / _totalDistance;
         double yIntercept = _coord1AMSLAlt;
 
@@ -12,6 +12,7 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QTimer>
+#include <QCache>
 
 #include "TerrainQuery.h"
 #include "QGCLoggingCategory.h"
@@ -85,6 +86,10 @@ private slots:
     void _updateTerrainCollision    (void);
 
 private:
+    void            _setTerrainHeights  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    bool            _cachedTerrainCollision(bool& terrainCollision);
+    static QString  _terrainCacheKey    (const QGeoCoordinate& coord1, const QGeoCoordinate& coord2);
+
     QGeoCoordinate      _coord1;
     QGeoCoordinate      _coord2;
     double              _coord1AMSLAlt =                qQNaN();
@@ -94,6 +99,8 @@ private:
     bool                _specialVisual =                false;
     QTimer              _delayedTerrainPathQueryTimer;
     TerrainPathQuery*   _currentTerrainPathQuery =      nullptr;
+    QString             _currentTerrainCacheKey;        ///< Endpoints of the outstanding terrain query
+    QString             _terrainCacheKey;               ///< Endpoints which _amslTerrainHeights belong to
     QVariantList        _amslTerrainHeights;
     double              _distanceBetween =              0;
     double              _finalDistanceBetween =         0;
@@ -101,4 +108,9 @@ private:
     SegmentType         _segmentType =                  SegmentTypeGeneric;
 
     static constexpr double _collisionIgnoreMeters =    10; // Distance to ignore for takeoff/land segments
+
+    // Terrain heights are shared across segments by endpoints. Complex items recreate all of their segments on each
+    // rebuild, so without this every edit would re-query terrain for segments which didn't move.
+    static QCache<QString, TerrainPathQuery::PathHeightInfo_t> _terrainHeightCache;
+    static const int _maxCachedTerrainHeights = 1000000;  ///< Cache cost is the number of heights
 };
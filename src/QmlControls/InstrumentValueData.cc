@@ -38,6 +38,9 @@ InstrumentValueData::InstrumentValueData(FactValueGrid* factValueGrid, QObject*
     connect(this, &InstrumentValueData::rangeColorsChanged,     this, &InstrumentValueData::_updateRanges);
     connect(this, &InstrumentValueData::rangeOpacitiesChanged,  this, &InstrumentValueData::_updateRanges);
     connect(this, &InstrumentValueData::rangeIconsChanged,      this, &InstrumentValueData::_updateRanges);
+    connect(this, &InstrumentValueData::showUnitsChanged,       this, &InstrumentValueData::_updateValueText);
+
+    _updateValueText();
 }
 
 void InstrumentValueData::_activeVehicleChanged(Vehicle* activeVehicle)
@@ -84,12 +87,14 @@ void InstrumentValueData::clearFact(void)
     emit textChanged            (_text);
     emit iconChanged            (_icon);
     emit showUnitsChanged       (_showUnits);
+
+    _updateValueText();
 }
 
 void InstrumentValueData::_setFactWorker(void)
 {
     if (_fact) {
-        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        disconnect(_fact, &Fact::valueChanged, this, &InstrumentValueData::_factValueChanged);
         _fact = nullptr;
     }
 
@@ -112,7 +117,8 @@ void InstrumentValueData::_setFactWorker(void)
 
     if (_fact) {
         _factName = nonEmptyFactName;
-        connect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        // valueChanged is deferred to the FactGroup update rate, rawValueChanged fires for every message
+        connect(_fact, &Fact::valueChanged, this, &InstrumentValueData::_factValueChanged);
     }
 
     emit factValueNamesChanged  ();
@@ -120,7 +126,7 @@ void InstrumentValueData::_setFactWorker(void)
     emit factNameChanged        (_factName);
     emit factGroupNameChanged   (_factGroupName);
 
-    _updateRanges();
+    _factValueChanged();
 }
 void InstrumentValueData::setFact(const QString& factGroupName, const QString& factName)
 {
@@ -270,6 +276,31 @@ void InstrumentValueData::removeRangeValue(int index)
     emit rangeIconsChanged      (_rangeIcons);
 }
 
+void InstrumentValueData::_factValueChanged(void)
+{
+    _updateValueText();
+    _updateRanges();
+}
+
+void InstrumentValueData::_updateValueText(void)
+{
+    QString newValueText;
+
+    if (_fact) {
+        newValueText = _fact->enumOrValueString();
+        if (_showUnits && !_fact->cookedUnits().isEmpty()) {
+            newValueText += QStringLiteral(" ") + _fact->cookedUnits();
+        }
+    } else {
+        newValueText = tr("--.--");
+    }
+
+    if (newValueText != _valueText) {
+        _valueText = newValueText;
+        emit valueTextChanged(_valueText);
+    }
+}
+
 void InstrumentValueData::_updateRanges(void)
 {
     _updateColor();
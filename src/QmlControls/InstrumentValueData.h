@@ -50,6 +50,7 @@ public:
     Q_PROPERTY(QColor               currentColor        MEMBER _currentColor                                NOTIFY currentColorChanged)
     Q_PROPERTY(double               currentOpacity      MEMBER _currentOpacity                              NOTIFY currentOpacityChanged)
     Q_PROPERTY(QString              currentIcon         MEMBER _currentIcon                                 NOTIFY currentIconChanged)
+    Q_PROPERTY(QString              valueText           READ    valueText                                   NOTIFY valueTextChanged)        ///< Formatted value with units, only changes when the displayed string does
 
     Q_INVOKABLE void    setFact         (const QString& factGroupName, const QString& factName);
     Q_INVOKABLE void    clearFact       (void);
@@ -71,6 +72,7 @@ public:
     QVariantList    rangeColors             (void) const { return _rangeColors; }
     QVariantList    rangeIcons              (void) const { return _rangeIcons; }
     QVariantList    rangeOpacities          (void) const { return _rangeOpacities; }
+    QString         valueText               (void) const { return _valueText; }
     void            setText                 (const QString& text);
     void            setShowUnits            (bool showUnits);
     void            setIcon                 (const QString& icon);
@@ -100,12 +102,15 @@ signals:
     void currentColorChanged    (const QColor& currentColor);
     void currentOpacityChanged  (double currentOpacity);
     void currentIconChanged     (const QString& currentIcon);
+    void valueTextChanged       (const QString& valueText);
 
 private slots:
     void _resetRangeInfo        (void);
     void _updateRanges          (void);
     void _activeVehicleChanged  (Vehicle* activeVehicle);
     void _lookForMissingFact    (void);
+    void _factValueChanged      (void);
+    void _updateValueText       (void);
 
 private:
     int  _currentRangeIndex     (const QVariant& value);
@@ -126,6 +131,7 @@ private:
     QColor                  _currentColor;
     double                  _currentOpacity =       1.0;
     QString                 _currentIcon;
+    QString                 _valueText;
 
     // Ranges allow you to specifiy semantics to apply when a value is within a certain range.
     // The limits for each section of the range are specified in _rangeValues. With the first
@@ -38,14 +38,6 @@ ColumnLayout {
         id:                 label
         Layout.alignment:   Qt.AlignVCenter
         font.pointSize:     _fontSize
-        text:               valueText()
-
-        function valueText() {
-            if (instrumentValueData.fact) {
-                return instrumentValueData.fact.enumOrValueString + (instrumentValueData.showUnits ? " " + instrumentValueData.fact.units : "")
-            } else {
-                return qsTr("--.--")
-            }
-        }
+        text:               instrumentValueData.valueText
     }
 }
@@ -70,6 +70,7 @@ Rectangle {
                 ListElement { text: "2x";   value: 2 }
                 ListElement { text: "5x";   value: 5 }
                 ListElement { text: "10x";  value: 10 }
+                ListElement { text: qsTr("Max"); value: 0 }
             }
 
             onActivated: controller.playbackSpeed = model.get(currentIndex).value
@@ -77,6 +78,11 @@ Rectangle {
 
         QGCLabel { text: controller.playheadTime }
 
+        QGCLabel {
+            text:       qsTr("%1 msg/s").arg(controller.messagesPerSecond.toFixed(0))
+            visible:    controller.playbackSpeed === 0 && controller.isPlaying
+        }
+
         Slider {
             id:                 slider
             Layout.fillWidth:   true
@@ -23,6 +23,13 @@ ChartView {
     property var chartController:   null
     property var seriesColors:      ["#00E04B","#DE8500","#F32836","#BFBFBF","#536DFF","#EECC44"]
 
+    Binding {
+        target:     chartController
+        property:   "plotWidth"
+        value:      Math.round(chartView.plotArea.width)
+        when:       chartController !== null
+    }
+
     function addDimension(field) {
         if(!chartController) {
             chartController = controller.createChart()
@@ -0,0 +1,305 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MapBatchItem.h"
+#include "QmlObjectListModel.h"
+
+#include <QSGFlatColorMaterial>
+#include <QSGVertexColorMaterial>
+#include <QMetaProperty>
+#include <QtMath>
+#include <QSet>
+
+QGC_LOGGING_CATEGORY(MapBatchItemLog, "MapBatchItemLog")
+
+MapBatchItem::MapBatchItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(QQuickItem::ItemHasContents, true);
+
+    connect(this, &MapBatchItem::colorChanged,      this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &MapBatchItem::alertColorChanged, this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &MapBatchItem::iconSizeChanged,   this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &MapBatchItem::lineWidthChanged,  this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &MapBatchItem::minIconSpacingChanged, this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &QQuickItem::widthChanged,        this, &MapBatchItem::_scheduleUpdate);
+    connect(this, &QQuickItem::heightChanged,       this, &MapBatchItem::_scheduleUpdate);
+}
+
+void MapBatchItem::setMap(QQuickItem* map)
+{
+    if (map != _map) {
+        if (_map) {
+            disconnect(_map, nullptr, this, nullptr);
+        }
+        _map = map;
+        if (_map) {
+            // The map type is not public api, so its signals are connected by name
+            connect(_map, SIGNAL(centerChanged(QGeoCoordinate)),    this, SLOT(_scheduleUpdate()));
+            connect(_map, SIGNAL(zoomLevelChanged(qreal)),          this, SLOT(_scheduleUpdate()));
+            connect(_map, SIGNAL(bearingChanged(qreal)),            this, SLOT(_scheduleUpdate()));
+            connect(_map, &QQuickItem::widthChanged,                this, &MapBatchItem::_scheduleUpdate);
+            connect(_map, &QQuickItem::heightChanged,               this, &MapBatchItem::_scheduleUpdate);
+        }
+        emit mapChanged();
+        _scheduleUpdate();
+    }
+}
+
+void MapBatchItem::setModel(QmlObjectListModel* model)
+{
+    if (model != _model) {
+        if (_model) {
+            disconnect(_model, nullptr, this, nullptr);
+            for (int i=0; i<_model->count(); i++) {
+                disconnect(_model->get(i), nullptr, this, nullptr);
+            }
+        }
+        _model = model;
+        if (_model) {
+            connect(_model, &QAbstractItemModel::rowsInserted,  this, &MapBatchItem::_modelRowsChanged);
+            connect(_model, &QAbstractItemModel::rowsRemoved,   this, &MapBatchItem::_modelRowsChanged);
+            connect(_model, &QAbstractItemModel::rowsMoved,     this, &MapBatchItem::_scheduleUpdate);
+            connect(_model, &QAbstractItemModel::modelReset,    this, &MapBatchItem::_modelRowsChanged);
+            _modelRowsChanged();
+        }
+        emit modelChanged();
+        _scheduleUpdate();
+    }
+}
+
+QVariantList MapBatchItem::path(void) const
+{
+    QVariantList list;
+    list.reserve(_path.count());
+    for (const QGeoCoordinate& coordinate: _path) {
+        list.append(QVariant::fromValue(coordinate));
+    }
+    return list;
+}
+
+void MapBatchItem::setPath(const QVariantList& path)
+{
+    _path.clear();
+    _pathMercator.clear();
+    _path.reserve(path.count());
+    _pathMercator.reserve(path.count());
+    for (const QVariant& variant: path) {
+        QGeoCoordinate coordinate = variant.value<QGeoCoordinate>();
+        _path.append(coordinate);
+        _pathMercator.append(QGCMapTransform::toMercator(coordinate));
+    }
+    emit pathChanged();
+    _scheduleUpdate();
+}
+
+void MapBatchItem::addCoordinate(const QGeoCoordinate& coordinate)
+{
+    _path.append(coordinate);
+    _pathMercator.append(QGCMapTransform::toMercator(coordinate));
+    emit pathChanged();
+    _scheduleUpdate();
+}
+
+void MapBatchItem::replaceLastCoordinate(const QGeoCoordinate& coordinate)
+{
+    if (_path.isEmpty()) {
+        addCoordinate(coordinate);
+        return;
+    }
+    _path.last() = coordinate;
+    _pathMercator.last() = QGCMapTransform::toMercator(coordinate);
+    emit pathChanged();
+    _scheduleUpdate();
+}
+
+void MapBatchItem::_modelRowsChanged(void)
+{
+    // Connections are unique, so objects which were already in the model are not connected twice
+    for (int i=0; i<_model->count(); i++) {
+        _connectObject(_model->get(i));
+    }
+    _scheduleUpdate();
+}
+
+void MapBatchItem::_connectObject(QObject* object)
+{
+    static const char* rgProperties[] = { "coordinate", "heading", "alert", "conflict" };
+
+    const QMetaObject*  metaObject  = object->metaObject();
+    QMetaMethod         updateSlot  = staticMetaObject.method(staticMetaObject.indexOfSlot("_scheduleUpdate()"));
+    for (const char* propertyName: rgProperties) {
+        int propertyIndex = metaObject->indexOfProperty(propertyName);
+        if (propertyIndex != -1 && metaObject->property(propertyIndex).hasNotifySignal()) {
+            connect(object, metaObject->property(propertyIndex).notifySignal(), this, updateSlot, Qt::UniqueConnection);
+        }
+    }
+}
+
+void MapBatchItem::_scheduleUpdate(void)
+{
+    // Multiple changes within a frame only build the vertices once
+    polish();
+}
+
+void MapBatchItem::updatePolish(void)
+{
+    _iconVertices.clear();
+    _lineVertices.clear();
+
+    QGCMapTransform transform;
+    if (!isVisible() || !transform.update(_map, this)) {
+        update();
+        return;
+    }
+
+    const QRectF bounds     = boundingRect().adjusted(-_iconMargin, -_iconMargin, _iconMargin, _iconMargin);
+    const double rotation   = transform.rotation();
+
+    if (_model) {
+        QSet<quint64> usedCells;
+        _iconVertices.reserve(_model->count() * 6);
+        for (int i=0; i<_model->count(); i++) {
+            QObject*        object      = _model->get(i);
+            QGeoCoordinate  coordinate  = object->property("coordinate").value<QGeoCoordinate>();
+            if (!coordinate.isValid()) {
+                continue;
+            }
+            QPointF center = transform.toItem(QGCMapTransform::toMercator(coordinate));
+            if (!bounds.contains(center)) {
+                continue;
+            }
+            if (_minIconSpacing > 0) {
+                quint32 cellX = static_cast<quint32>(qFloor((center.x() - bounds.left()) / _minIconSpacing));
+                quint32 cellY = static_cast<quint32>(qFloor((center.y() - bounds.top()) / _minIconSpacing));
+                quint64 cell = (static_cast<quint64>(cellX) << 32) | cellY;
+                if (usedCells.contains(cell)) {
+                    continue;
+                }
+                usedCells.insert(cell);
+            }
+            QVariant    headingVariant  = object->property("heading");
+            double      heading         = headingVariant.isValid() ? headingVariant.toDouble() : qQNaN();
+            bool        alert           = object->property("alert").toBool() || object->property("conflict").toBool();
+            _addIcon(center, heading, rotation, alert ? _alertColor : _color);
+        }
+    }
+
+    if (_pathMercator.count() > 1) {
+        _lineVertices.reserve((_pathMercator.count() - 1) * 6);
+        QPointF from = transform.toItem(_pathMercator[0]);
+        for (int i=1; i<_pathMercator.count(); i++) {
+            QPointF to = transform.toItem(_pathMercator[i]);
+            QPointF delta = to - from;
+            if (i != _pathMercator.count() - 1 && QPointF::dotProduct(delta, delta) < _minSegmentLength * _minSegmentLength) {
+                // Not distinguishable from the previous vertex at this zoom
+                continue;
+            }
+            if (bounds.contains(from) || bounds.contains(to) || bounds.intersects(QRectF(from, to).normalized())) {
+                _addLineSegment(from, to);
+            }
+            from = to;
+        }
+    }
+
+    qCDebug(MapBatchItemLog) << "updatePolish icon vertices:line vertices" << _iconVertices.count() << _lineVertices.count();
+
+    update();
+}
+
+QSGNode* MapBatchItem::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
+{
+    QSGNode* rootNode = oldNode;
+
+    if (!rootNode) {
+        rootNode = new QSGNode;
+
+        QSGGeometryNode* lineNode = new QSGGeometryNode;
+        QSGGeometry* lineGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        lineGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        lineNode->setFlag(QSGNode::OwnsGeometry);
+        lineNode->setFlag(QSGNode::OwnsMaterial);
+        lineNode->setFlag(QSGNode::OwnedByParent);
+        lineNode->setGeometry(lineGeometry);
+        lineNode->setMaterial(new QSGFlatColorMaterial);
+
+        QSGGeometryNode* iconNode = new QSGGeometryNode;
+        QSGGeometry* iconGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        iconGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        iconNode->setFlag(QSGNode::OwnsGeometry);
+        iconNode->setFlag(QSGNode::OwnsMaterial);
+        iconNode->setFlag(QSGNode::OwnedByParent);
+        iconNode->setGeometry(iconGeometry);
+        iconNode->setMaterial(new QSGVertexColorMaterial);
+
+        // Icons are drawn over the path
+        rootNode->appendChildNode(lineNode);
+        rootNode->appendChildNode(iconNode);
+    }
+
+    QSGGeometryNode* lineNode = static_cast<QSGGeometryNode*>(rootNode->childAtIndex(0));
+    static_cast<QSGFlatColorMaterial*>(lineNode->material())->setColor(_color);
+    lineNode->geometry()->allocate(_lineVertices.count());
+    memcpy(lineNode->geometry()->vertexDataAsPoint2D(), _lineVertices.constData(), static_cast<size_t>(_lineVertices.count()) * sizeof(QSGGeometry::Point2D));
+    lineNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+
+    QSGGeometryNode* iconNode = static_cast<QSGGeometryNode*>(rootNode->childAtIndex(1));
+    iconNode->geometry()->allocate(_iconVertices.count());
+    memcpy(iconNode->geometry()->vertexDataAsColoredPoint2D(), _iconVertices.constData(), static_cast<size_t>(_iconVertices.count()) * sizeof(QSGGeometry::ColoredPoint2D));
+    iconNode->markDirty(QSGNode::DirtyGeometry);
+
+    return rootNode;
+}
+
+void MapBatchItem::_addIcon(const QPointF& center, double heading, double rotation, const QColor& color)
+{
+    QPointF tip, left, right, back;
+    if (qIsNaN(heading)) {
+        // Diamond
+        double halfSize = _iconSize * 0.35;
+        tip     = center + QPointF(0, -halfSize);
+        back    = center + QPointF(0, halfSize);
+        left    = center + QPointF(-halfSize, 0);
+        right   = center + QPointF(halfSize, 0);
+    } else {
+        // Arrow with a notch at the back. Heading is relative to north, which the map bearing may have rotated.
+        double  angle       = qDegreesToRadians(heading) + rotation;
+        QPointF direction   = QPointF(qSin(angle), -qCos(angle));
+        QPointF perpendicular(-direction.y(), direction.x());
+        tip     = center + (direction * (_iconSize * 0.5));
+        back    = center - (direction * (_iconSize * 0.2));
+        left    = center - (direction * (_iconSize * 0.5)) - (perpendicular * (_iconSize * 0.4));
+        right   = center - (direction * (_iconSize * 0.5)) + (perpendicular * (_iconSize * 0.4));
+    }
+
+    const QPointF rgVertices[] = { tip, left, back, tip, back, right };
+    for (const QPointF& vertex: rgVertices) {
+        QSGGeometry::ColoredPoint2D point;
+        point.set(static_cast<float>(vertex.x()), static_cast<float>(vertex.y()),
+                  static_cast<uchar>(color.red() * color.alphaF()), static_cast<uchar>(color.green() * color.alphaF()), static_cast<uchar>(color.blue() * color.alphaF()), static_cast<uchar>(color.alpha()));
+        _iconVertices.append(point);
+    }
+}
+
+void MapBatchItem::_addLineSegment(const QPointF& from, const QPointF& to)
+{
+    QPointF direction   = to - from;
+    double  length      = qSqrt(QPointF::dotProduct(direction, direction));
+    if (qFuzzyIsNull(length)) {
+        return;
+    }
+    QPointF offset = QPointF(-direction.y(), direction.x()) * ((_lineWidth / 2.0) / length);
+
+    const QPointF rgVertices[] = { from + offset, from - offset, to + offset, to + offset, from - offset, to - offset };
+    for (const QPointF& vertex: rgVertices) {
+        QSGGeometry::Point2D point;
+        point.set(static_cast<float>(vertex.x()), static_cast<float>(vertex.y()));
+        _lineVertices.append(point);
+    }
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QQuickItem>
+#include <QSGGeometryNode>
+#include <QSGGeometry>
+#include <QGeoCoordinate>
+#include <QColor>
+#include <QVector>
+#include <QPointF>
+#include <QPointer>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMapTransform.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MapBatchItemLog)
+
+class QmlObjectListModel;
+
+/// Draws large sets of map objects with a single scene graph node per set instead of a QML map item per object.
+///
+/// Each object of model is drawn as an arrow pointing along its heading property (a diamond if the heading is NaN)
+/// at its coordinate property, in alertColor if its alert or conflict property is true. The path is drawn as a line. The item
+/// must fill the map it draws on. Vertices are built on the GUI thread in updatePolish and only copied into the nodes
+/// on the render thread. Mercator positions of the path are only calculated once, each frame only applies the map
+/// transform, see QGCMapTransform.
+///
+/// Level of detail: path vertices closer than _minSegmentLength pixels to the previous drawn vertex are skipped, and
+/// when minIconSpacing is set only the first icon within each minIconSpacing square of the item is drawn. Zoomed out
+/// views of dense sets, such as thousands of camera trigger points, therefore only build as many vertices as are
+/// distinguishable on screen.
+class MapBatchItem : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    MapBatchItem(QQuickItem* parent = nullptr);
+
+    Q_PROPERTY(QQuickItem*          map         READ map        WRITE setMap        NOTIFY mapChanged)
+    Q_PROPERTY(QmlObjectListModel*  model       READ model      WRITE setModel      NOTIFY modelChanged)
+    Q_PROPERTY(QVariantList         path        READ path       WRITE setPath       NOTIFY pathChanged)
+    Q_PROPERTY(QColor               color       MEMBER _color                       NOTIFY colorChanged)
+    Q_PROPERTY(QColor               alertColor  MEMBER _alertColor                  NOTIFY alertColorChanged)
+    Q_PROPERTY(double               iconSize    MEMBER _iconSize                    NOTIFY iconSizeChanged)
+    Q_PROPERTY(double               lineWidth   MEMBER _lineWidth                   NOTIFY lineWidthChanged)
+    Q_PROPERTY(double               minIconSpacing MEMBER _minIconSpacing           NOTIFY minIconSpacingChanged)   ///< Pixels, 0 draws all icons
+
+    QQuickItem*         map     (void) { return _map; }
+    QmlObjectListModel* model   (void) { return _model; }
+    QVariantList        path    (void) const;
+
+    void setMap     (QQuickItem* map);
+    void setModel   (QmlObjectListModel* model);
+    void setPath    (const QVariantList& path);
+
+    /// Same as the MapPolyline methods, for a path which is extended as the vehicle moves
+    Q_INVOKABLE void addCoordinate          (const QGeoCoordinate& coordinate);
+    Q_INVOKABLE void replaceLastCoordinate  (const QGeoCoordinate& coordinate);
+
+    // Overrides from QQuickItem
+    void     updatePolish   (void) override;
+    QSGNode* updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* updatePaintNodeData) override;
+
+signals:
+    void mapChanged         (void);
+    void modelChanged       (void);
+    void pathChanged        (void);
+    void colorChanged       (void);
+    void alertColorChanged  (void);
+    void iconSizeChanged    (void);
+    void lineWidthChanged   (void);
+    void minIconSpacingChanged(void);
+
+private slots:
+    void _modelRowsChanged  (void);
+    void _scheduleUpdate    (void);
+
+private:
+    void        _connectObject      (QObject* object);
+    void        _addIcon            (const QPointF& center, double heading, double rotation, const QColor& color);
+    void        _addLineSegment     (const QPointF& from, const QPointF& to);
+
+    QPointer<QQuickItem>            _map;
+    QPointer<QmlObjectListModel>    _model;
+    QVector<QGeoCoordinate>         _path;
+    QVector<QPointF>                _pathMercator;      ///< Kept in sync with _path
+    QColor                          _color              = Qt::white;
+    QColor                          _alertColor         = Qt::red;
+    double                          _iconSize           = 20;
+    double                          _lineWidth          = 3;
+    double                          _minIconSpacing     = 0;
+    QVector<QSGGeometry::ColoredPoint2D>    _iconVertices;  ///< Two triangles per icon
+    QVector<QSGGeometry::Point2D>           _lineVertices;  ///< Two triangles per path segment
+
+    static const int    _iconMargin = 50;                   ///< Pixels outside of the item in which objects are still drawn
+    static constexpr double _minSegmentLength = 1.0;        ///< Pixels
+
+    Q_DISABLE_COPY(MapBatchItem)
+};
+
+QML_DECLARE_TYPE(MapBatchItem)
@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ObstacleDistanceItem.h"
+
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+#include <QColor>
+#include <QtMath>
+
+ObstacleDistanceItem::ObstacleDistanceItem(QQuickItem* parent)
+    : QQuickItem    (parent)
+    , _dirtySectors (VehicleObjectAvoidance::kSectorCount, true)
+{
+    setFlag(QQuickItem::ItemHasContents, true);
+    _sectors.fill(VehicleObjectAvoidance::kUnknownDistance);
+
+    connect(this, &QQuickItem::widthChanged,    this, &ObstacleDistanceItem::_invalidateAll);
+    connect(this, &QQuickItem::heightChanged,   this, &ObstacleDistanceItem::_invalidateAll);
+}
+
+void ObstacleDistanceItem::setObjectAvoidance(VehicleObjectAvoidance* objectAvoidance)
+{
+    if (objectAvoidance != _objectAvoidance) {
+        if (_objectAvoidance) {
+            disconnect(_objectAvoidance, nullptr, this, nullptr);
+        }
+        _objectAvoidance = objectAvoidance;
+        if (_objectAvoidance) {
+            connect(_objectAvoidance, &VehicleObjectAvoidance::objectAvoidanceChanged, this, &ObstacleDistanceItem::_sectorsChanged);
+        }
+        _sectorsChanged();
+        emit objectAvoidanceChanged();
+    }
+}
+
+void ObstacleDistanceItem::setPixelsPerMeter(double pixelsPerMeter)
+{
+    if (!qFuzzyCompare(pixelsPerMeter, _pixelsPerMeter)) {
+        _pixelsPerMeter = pixelsPerMeter;
+        _invalidateAll();
+        emit pixelsPerMeterChanged();
+    }
+}
+
+void ObstacleDistanceItem::setLineWidth(double lineWidth)
+{
+    if (!qFuzzyCompare(lineWidth, _lineWidth)) {
+        _lineWidth = lineWidth;
+        _invalidateAll();
+        emit lineWidthChanged();
+    }
+}
+
+void ObstacleDistanceItem::_invalidateAll(void)
+{
+    _dirtySectors.fill(true);
+    update();
+}
+
+void ObstacleDistanceItem::_sectorsChanged(void)
+{
+    VehicleObjectAvoidance::Sectors_t sectors;
+    int                               maxDistance = 0;
+
+    if (_objectAvoidance && _objectAvoidance->available()) {
+        sectors     = _objectAvoidance->sectors();
+        maxDistance = _objectAvoidance->maxDistance();
+    } else {
+        sectors.fill(VehicleObjectAvoidance::kUnknownDistance);
+    }
+
+    if (maxDistance != _maxDistance) {
+        // Colors are relative to the range
+        _maxDistance = maxDistance;
+        _dirtySectors.fill(true);
+    }
+    for (int i = 0; i < VehicleObjectAvoidance::kSectorCount; i++) {
+        if (sectors[i] != _sectors[i]) {
+            _dirtySectors.setBit(i);
+        }
+    }
+    _sectors = sectors;
+
+    if (_dirtySectors.count(true)) {
+        update();
+    }
+}
+
+QSGNode* ObstacleDistanceItem::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
+{
+    QSGGeometryNode* node = static_cast<QSGGeometryNode*>(oldNode);
+
+    if (!node) {
+        node = new QSGGeometryNode;
+        QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), VehicleObjectAvoidance::kSectorCount * _verticesPerSector);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        node->setGeometry(geometry);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setFlag(QSGNode::OwnsMaterial);
+        _dirtySectors.fill(true);
+    }
+
+    const float centerX     = static_cast<float>(width() / 2);
+    const float centerY     = static_cast<float>(height() / 2);
+    const float halfWidth   = static_cast<float>(_lineWidth / 2);
+
+    QSGGeometry::ColoredPoint2D* vertices = node->geometry()->vertexDataAsColoredPoint2D();
+    for (int sector = 0; sector < VehicleObjectAvoidance::kSectorCount; sector++) {
+        if (!_dirtySectors.testBit(sector)) {
+            continue;
+        }
+        QSGGeometry::ColoredPoint2D* sectorVertices = &vertices[sector * _verticesPerSector];
+
+        const uint16_t distance = _sectors[sector];
+        if (_maxDistance <= 0 || distance > _maxDistance) {
+            // Unknown or no obstacle, degenerate triangles draw nothing
+            for (int i = 0; i < _verticesPerSector; i++) {
+                sectorVertices[i].set(centerX, centerY, 0, 0, 0, 0);
+            }
+            continue;
+        }
+
+        // Red when touching, orange at half the range, green at the end of the range
+        const double    ratio   = static_cast<double>(distance) / _maxDistance;
+        const QColor    color   = ratio < 0.5 ? QColor::fromRgbF(1, 1.3 * ratio, 0) : QColor::fromRgbF(2 * (1 - ratio), 0.65 + 0.7 * (ratio - 0.5), 0);
+        const uchar     r       = static_cast<uchar>(color.red());
+        const uchar     g       = static_cast<uchar>(color.green());
+        const uchar     b       = static_cast<uchar>(color.blue());
+
+        const float radius      = static_cast<float>(distance / 100.0 * _pixelsPerMeter);
+        const float inner       = qMax(0.0f, radius - halfWidth);
+        const float outer       = radius + halfWidth;
+        const double startAngle = qDegreesToRadians((sector - 0.5) * VehicleObjectAvoidance::kSectorDegrees);
+        const double stepAngle  = qDegreesToRadians(VehicleObjectAvoidance::kSectorDegrees) / _arcSegments;
+
+        // Heading is up and angles go clockwise
+        for (int segment = 0; segment < _arcSegments; segment++) {
+            const double a0 = startAngle + (segment * stepAngle);
+            const double a1 = a0 + stepAngle;
+            const float  s0 = static_cast<float>(qSin(a0));
+            const float  c0 = static_cast<float>(qCos(a0));
+            const float  s1 = static_cast<float>(qSin(a1));
+            const float  c1 = static_cast<float>(qCos(a1));
+
+            QSGGeometry::ColoredPoint2D* v = &sectorVertices[segment * 6];
+            v[0].set(centerX + inner * s0, centerY - inner * c0, r, g, b, 255);
+            v[1].set(centerX + outer * s0, centerY - outer * c0, r, g, b, 255);
+            v[2].set(centerX + outer * s1, centerY - outer * c1, r, g, b, 255);
+            v[3].set(centerX + inner * s0, centerY - inner * c0, r, g, b, 255);
+            v[4].set(centerX + outer * s1, centerY - outer * c1, r, g, b, 255);
+            v[5].set(centerX + inner * s1, centerY - inner * c1, r, g, b, 255);
+        }
+    }
+    _dirtySectors.fill(false);
+
+    node->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
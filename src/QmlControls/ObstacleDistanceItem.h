@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QQuickItem>
+#include <QPointer>
+#include <QBitArray>
+
+#include "VehicleObjectAvoidance.h"
+
+/// Draws the fused obstacle sectors of a VehicleObjectAvoidance as arcs around the item center, vehicle heading up.
+///
+/// Every sector owns a fixed range of vertices in a single geometry node, an update only rewrites the vertices of the
+/// sectors whose distance changed. Sectors without an obstacle collapse to the center. Arcs are colored from red
+/// (close) to green (at maxDistance).
+class ObstacleDistanceItem : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    ObstacleDistanceItem(QQuickItem* parent = nullptr);
+
+    Q_PROPERTY(VehicleObjectAvoidance*  objectAvoidance READ objectAvoidance    WRITE setObjectAvoidance    NOTIFY objectAvoidanceChanged)
+    Q_PROPERTY(double                   pixelsPerMeter  READ pixelsPerMeter     WRITE setPixelsPerMeter     NOTIFY pixelsPerMeterChanged)
+    Q_PROPERTY(double                   lineWidth       READ lineWidth          WRITE setLineWidth          NOTIFY lineWidthChanged)
+
+    VehicleObjectAvoidance* objectAvoidance (void) { return _objectAvoidance; }
+    double                  pixelsPerMeter  (void) const { return _pixelsPerMeter; }
+    double                  lineWidth       (void) const { return _lineWidth; }
+
+    void setObjectAvoidance (VehicleObjectAvoidance* objectAvoidance);
+    void setPixelsPerMeter  (double pixelsPerMeter);
+    void setLineWidth       (double lineWidth);
+
+    // Overrides from QQuickItem
+    QSGNode* updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* updatePaintNodeData) override;
+
+signals:
+    void objectAvoidanceChanged (void);
+    void pixelsPerMeterChanged  (void);
+    void lineWidthChanged       (void);
+
+private slots:
+    void _sectorsChanged    (void);
+    void _invalidateAll     (void);
+
+private:
+    QPointer<VehicleObjectAvoidance>    _objectAvoidance;
+    double                              _pixelsPerMeter = 1;
+    double                              _lineWidth      = 5;
+    VehicleObjectAvoidance::Sectors_t   _sectors;
+    int                                 _maxDistance    = 0;
+    QBitArray                           _dirtySectors;      ///< Sectors whose vertices need to be rewritten
+
+    static const int _arcSegments       = 4;
+    static const int _verticesPerSector = _arcSegments * 6;
+
+    Q_DISABLE_COPY(ObstacleDistanceItem)
+};
+
+QML_DECLARE_TYPE(ObstacleDistanceItem)
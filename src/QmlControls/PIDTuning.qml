@@ -39,6 +39,9 @@ RowLayout {
     property double _last_t:            0
     property var    _savedTuningParamValues:    [ ]
     property bool   _showCharts: !ScreenTools.isMobile // TODO: test and enable on mobile
+    property var    _recorder:          globals.activeVehicle.pidTuningRecorder
+    property bool   _useRecorder:       axis[_currentAxis].plot.every(function(e) { return e.channel !== undefined })
+    property int    _stepResponseTicks: 0
 
     readonly property int _tickSeparation:      5
     readonly property int _maxTickSections:     10
@@ -65,6 +68,7 @@ RowLayout {
         for (var i = 0; i < chart.count; ++i) {
             chart.series(i).removePoints(0, chart.series(i).count)
         }
+        _recorder.clear()
         _xAxis.min = 0
         _xAxis.max = 0
         _yAxis.min = 0
@@ -73,6 +77,42 @@ RowLayout {
         _last_t = 0
     }
 
+    // Replaces the series with the recorded samples of the last windowSecs, spread over as many pixels
+    // as the window takes at the current zoom
+    function updateRecorderSeries(windowSecs) {
+        var plotWidth = Math.min(chart.plotArea.width * windowSecs / chartDisplaySec, chart.plotArea.width * 20)
+        var firstRange = true
+        var plot = axis[_currentAxis].plot
+        for (var i = 0; i < plot.length; ++i) {
+            var range = _recorder.updateSeries(plot[i].channel, chart.series(i), windowSecs, plotWidth)
+            if (range.count > 0) {
+                if (firstRange) {
+                    _yAxis.min = range.min
+                    _yAxis.max = range.max
+                    firstRange = false
+                }
+                adjustYAxisMin(_yAxis, range.min)
+                adjustYAxisMax(_yAxis, range.max)
+            }
+        }
+        _xAxis.max = _recorder.durationSecs
+        _xAxis.min = _xAxis.max - chartDisplaySec
+    }
+
+    function plotChannel(name) {
+        var plot = axis[_currentAxis].plot
+        for (var i = 0; i < plot.length; ++i) {
+            if (plot[i].name === name) {
+                return plot[i].channel
+            }
+        }
+        return -1
+    }
+
+    function formatStepValue(value, decimals, suffix) {
+        return isNaN(value) ? "-" : value.toFixed(decimals) + suffix
+    }
+
     // Save the current set of tuning values so we can reset to them
     function saveTuningParamValues() {
         _savedTuningParamValues = [ ]
@@ -111,7 +151,10 @@ RowLayout {
         saveTuningParamValues()
     }
 
-    Component.onDestruction: globals.activeVehicle.setPIDTuningTelemetryMode(Vehicle.ModeDisabled)
+    Component.onDestruction: {
+        _recorder.running = false
+        globals.activeVehicle.setPIDTuningTelemetryMode(Vehicle.ModeDisabled)
+    }
     on_CurrentAxisChanged: axisIndexChanged()
 
     ValueAxis {
@@ -131,13 +174,40 @@ RowLayout {
         tickCount:  Math.min(((max - min) / _tickSeparation), _maxTickSections) + 1
     }
 
+    // Samples come from the vehicle messages when every plot has a recorder channel, the timer only redraws
+    Binding {
+        target:     _recorder
+        property:   "running"
+        value:      dataTimer.running && _useRecorder
+    }
+
     Timer {
         id:         dataTimer
-        interval:   10
+        interval:   _useRecorder ? 50 : 10
         running:    true
         repeat:     true
 
+        onRunningChanged: {
+            if (!running && _useRecorder) {
+                // Load the whole history so it can be dragged into view
+                updateRecorderSeries(_recorder.durationSecs)
+            }
+        }
+
         onTriggered: {
+            if (_useRecorder) {
+                updateRecorderSeries(chartDisplaySec)
+                if (++_stepResponseTicks * interval >= 1000) {
+                    _stepResponseTicks = 0
+                    var setpointChannel = plotChannel("Setpoint")
+                    var responseChannel = plotChannel("Response")
+                    if (setpointChannel !== -1 && responseChannel !== -1) {
+                        _recorder.computeStepResponse(setpointChannel, responseChannel, chartDisplaySec)
+                    }
+                }
+                return
+            }
+
             _xAxis.max = _msecs / 1000
             _xAxis.min = _msecs / 1000 - chartDisplaySec
 
@@ -336,6 +406,15 @@ RowLayout {
             }
         }
 
+        QGCLabel {
+            visible:    _useRecorder && _recorder.stepResponse.steps > 0
+            text:       qsTr("Rise: %1  Overshoot: %2  Settling: %3  RMS error: %4")
+                            .arg(formatStepValue(_recorder.stepResponse.riseTimeMSecs, 0, qsTr(" ms")))
+                            .arg(formatStepValue(_recorder.stepResponse.overshootPercent, 1, "%"))
+                            .arg(formatStepValue(_recorder.stepResponse.settlingTimeMSecs, 0, qsTr(" ms")))
+                            .arg(formatStepValue(_recorder.stepResponse.rmsError, 2, " " + unit))
+        }
+
         Item { width: 1; height: 1 }
 
         RowLayout {
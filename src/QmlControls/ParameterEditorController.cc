@@ -15,10 +15,209 @@
 
 #include <QStandardPaths>
 
+#include <algorithm>
+#include <numeric>
+
+void ParameterEditorSearchIndex::clear(void)
+{
+    _entries.clear();
+    _trigrams.clear();
+    _lastSearchItems.clear();
+    _lastMatches.clear();
+}
+
+void ParameterEditorSearchIndex::addFact(Fact* fact)
+{
+    Entry_t entry = { fact, fact->name().toLower(), fact->shortDescription().toLower(), fact->longDescription().toLower() };
+
+    const int entryIndex = _entries.count();
+    _entries.append(entry);
+    _addTrigrams(entry.name,             entryIndex);
+    _addTrigrams(entry.shortDescription, entryIndex);
+    _addTrigrams(entry.longDescription,  entryIndex);
+
+    // Previous matches don't include the new fact
+    _lastSearchItems.clear();
+    _lastMatches.clear();
+}
+
+void ParameterEditorSearchIndex::_addTrigrams(const QString& text, int entryIndex)
+{
+    for (int i=0; i<=text.length() - _trigramLength; i++) {
+        QVector<int>& entryIndices = _trigrams[_trigramKey(&text.constData()[i])];
+        // Entries are added in index order, so a duplicate can only be the last one
+        if (entryIndices.isEmpty() || entryIndices.last() != entryIndex) {
+            entryIndices.append(entryIndex);
+        }
+    }
+}
+
+bool ParameterEditorSearchIndex::_isLiteral(const QString& searchItem)
+{
+    static const QString metaChars = QStringLiteral("\\^$.|?*+()[]{}");
+
+    for (const QChar& c: searchItem) {
+        if (metaChars.contains(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QVector<int> ParameterEditorSearchIndex::_candidates(const QString& literal) const
+{
+    // Every entry containing the literal contains all of its trigrams
+    QVector<int> candidates;
+    bool first = true;
+    for (int i=0; i<=literal.length() - _trigramLength; i++) {
+        auto it = _trigrams.constFind(_trigramKey(&literal.constData()[i]));
+        if (it == _trigrams.constEnd()) {
+            return QVector<int>();
+        }
+        if (first) {
+            candidates = it.value();
+            first = false;
+        } else {
+            QVector<int> intersection;
+            std::set_intersection(candidates.constBegin(), candidates.constEnd(), it.value().constBegin(), it.value().constEnd(), std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+        if (candidates.isEmpty()) {
+            break;
+        }
+    }
+    return candidates;
+}
+
+int ParameterEditorSearchIndex::_rank(const Entry_t& entry, const QStringList& searchItems) const
+{
+    // Lower is better: exact name, name prefix, name contains, short description, long description
+    int rank = 0;
+    for (const QString& searchItem: searchItems) {
+        if (entry.name == searchItem) {
+            rank += 0;
+        } else if (entry.name.startsWith(searchItem)) {
+            rank += 1;
+        } else if (entry.name.contains(searchItem)) {
+            rank += 2;
+        } else if (entry.shortDescription.contains(searchItem)) {
+            rank += 3;
+        } else {
+            rank += 4;
+        }
+    }
+    return rank;
+}
+
+QList<Fact*> ParameterEditorSearchIndex::search(const QStringList& searchItems)
+{
+    QStringList lowerItems;
+    for (const QString& searchItem: searchItems) {
+        lowerItems.append(searchItem.toLower());
+    }
+
+    // Typing more characters only narrows the results if each previous item is contained in the new one and all are plain text
+    bool refines = !_lastSearchItems.isEmpty() && lowerItems.count() >= _lastSearchItems.count();
+    for (int i=0; refines && i<_lastSearchItems.count(); i++) {
+        refines = _isLiteral(_lastSearchItems[i]) && _isLiteral(lowerItems[i]) && lowerItems[i].contains(_lastSearchItems[i]);
+    }
+
+    QVector<int> candidates;
+    bool haveCandidates = false;
+    if (refines) {
+        candidates = _lastMatches;
+        haveCandidates = true;
+    }
+    for (const QString& searchItem: lowerItems) {
+        if (searchItem.length() >= _trigramLength && _isLiteral(searchItem)) {
+            QVector<int> itemCandidates = _candidates(searchItem);
+            if (haveCandidates) {
+                QVector<int> intersection;
+                std::set_intersection(candidates.constBegin(), candidates.constEnd(), itemCandidates.constBegin(), itemCandidates.constEnd(), std::back_inserter(intersection));
+                candidates.swap(intersection);
+            } else {
+                candidates.swap(itemCandidates);
+                haveCandidates = true;
+            }
+        }
+    }
+    if (!haveCandidates) {
+        // Only short items or expressions, every entry has to be checked
+        candidates.resize(_entries.count());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
+    // Candidates only contain the trigrams, the full items still need checking
+    QList<QRegularExpression> rgRegExp;
+    for (const QString& searchItem: searchItems) {
+        rgRegExp.append(_isLiteral(searchItem) ? QRegularExpression() : QRegularExpression(searchItem, QRegularExpression::CaseInsensitiveOption));
+    }
+    QVector<int> matches;
+    for (int entryIndex: candidates) {
+        const Entry_t& entry = _entries[entryIndex];
+        bool matched = true;
+        for (int i=0; matched && i<lowerItems.count(); i++) {
+            const QRegularExpression& re = rgRegExp[i];
+            if (re.isValid() && !re.pattern().isEmpty()) {
+                matched = entry.name.contains(re) || entry.shortDescription.contains(re) || entry.longDescription.contains(re);
+            } else {
+                const QString& searchItem = lowerItems[i];
+                matched = entry.name.contains(searchItem) || entry.shortDescription.contains(searchItem) || entry.longDescription.contains(searchItem);
+            }
+        }
+        if (matched) {
+            matches.append(entryIndex);
+        }
+    }
+    _lastSearchItems    = lowerItems;
+    _lastMatches        = matches;
+
+    QVector<QPair<int, int>> rankedMatches;
+    rankedMatches.reserve(matches.count());
+    for (int entryIndex: matches) {
+        rankedMatches.append(qMakePair(_rank(_entries[entryIndex], lowerItems), entryIndex));
+    }
+    std::stable_sort(rankedMatches.begin(), rankedMatches.end(), [this](const QPair<int, int>& a, const QPair<int, int>& b) {
+        return a.first != b.first ? a.first < b.first : _entries[a.second].name < _entries[b.second].name;
+    });
+
+    QList<Fact*> facts;
+    facts.reserve(rankedMatches.count());
+    for (const QPair<int, int>& rankedMatch: rankedMatches) {
+        facts.append(_entries[rankedMatch.second].fact);
+    }
+    return facts;
+}
+
+QList<Fact*> ParameterEditorSearchIndex::searchText(const QString& searchText, bool searchInName, bool searchInDescriptions) const
+{
+    const QString lowerText = searchText.toLower();
+
+    QVector<int> candidates;
+    if (lowerText.length() >= _trigramLength) {
+        candidates = _candidates(lowerText);
+    } else {
+        candidates.resize(_entries.count());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
+    QList<Fact*> facts;
+    for (int entryIndex: candidates) {
+        const Entry_t& entry = _entries[entryIndex];
+        if ((searchInName && entry.name.contains(lowerText)) ||
+                (searchInDescriptions && (entry.shortDescription.contains(lowerText) || entry.longDescription.contains(lowerText)))) {
+            facts.append(entry.fact);
+        }
+    }
+    std::sort(facts.begin(), facts.end(), [](Fact* a, Fact* b) { return a->name() < b->name(); });
+    return facts;
+}
+
 ParameterEditorController::ParameterEditorController(void)
     : _parameterMgr(_vehicle->parameterManager())
 {
     _buildLists();
+    _buildSearchIndex();
 
     connect(this, &ParameterEditorController::currentCategoryChanged,   this, &ParameterEditorController::_currentCategoryChanged);
     connect(this, &ParameterEditorController::currentGroupChanged,      this, &ParameterEditorController::_currentGroupChanged);
@@ -116,8 +315,20 @@ void ParameterEditorController::_buildLists(void)
     }
 }
 
+void ParameterEditorController::_buildSearchIndex(void)
+{
+    _searchIndex.clear();
+    for (const QString& factName: _parameterMgr->parameterNames(_vehicle->defaultComponentId())) {
+        _searchIndex.addFact(_parameterMgr->getParameter(_vehicle->defaultComponentId(), factName));
+    }
+}
+
 void ParameterEditorController::_factAdded(int compId, Fact* fact)
 {
+    if (compId == _vehicle->defaultComponentId()) {
+        _searchIndex.addFact(fact);
+    }
+
     bool                        inserted = false;
     ParameterEditorCategory*    category = nullptr;
 
@@ -185,20 +396,14 @@ QStringList ParameterEditorController::searchParameters(const QString& searchTex
 {
     QStringList list;
 
-    for(const QString &paramName: _parameterMgr->parameterNames(_vehicle->defaultComponentId())) {
-        if (searchText.isEmpty()) {
-            list += paramName;
-        } else {
-            Fact* fact = _parameterMgr->getParameter(_vehicle->defaultComponentId(), paramName);
-
-            if (searchInName && fact->name().contains(searchText, Qt::CaseInsensitive)) {
-                list += paramName;
-            } else if (searchInDescriptions && (fact->shortDescription().contains(searchText, Qt::CaseInsensitive) || fact->longDescription().contains(searchText, Qt::CaseInsensitive))) {
-                list += paramName;
-            }
+    if (searchText.isEmpty()) {
+        list = _parameterMgr->parameterNames(_vehicle->defaultComponentId());
+        list.sort();
+    } else {
+        for (const Fact* fact: _searchIndex.searchText(searchText, searchInName, searchInDescriptions)) {
+            list += fact->name();
         }
     }
-    list.sort();
 
     return list;
 }
@@ -236,18 +441,17 @@ void ParameterEditorController::clearDiff(void)
 
 void ParameterEditorController::sendDiff(void)
 {
+    QList<ParameterManager::BulkWriteParam_t> bulkParams;
+
     for (int i=0; i<_diffList.count(); i++) {
         ParameterEditorDiff* paramDiff = _diffList.value<ParameterEditorDiff*>(i);
 
         if (paramDiff->load) {
-            if (paramDiff->noVehicleValue) {
-                _parameterMgr->_factRawValueUpdateWorker(paramDiff->componentId, paramDiff->name, paramDiff->valueType, paramDiff->fileValueVar);
-            } else {
-                Fact* fact = _parameterMgr->getParameter(paramDiff->componentId, paramDiff->name);
-                fact->setRawValue(paramDiff->fileValueVar);
-            }
+            bulkParams.append({ paramDiff->componentId, paramDiff->name, paramDiff->valueType, paramDiff->fileValueVar });
         }
     }
+
+    _parameterMgr->bulkWrite(bulkParams);
 }
 
 bool ParameterEditorController::buildDiffFromFile(const QString& filename)
@@ -379,29 +583,10 @@ void ParameterEditorController::_searchTextChanged(void)
         _searchParameters.beginReset();
         _searchParameters.clear();
 
-        for (const QString &paraName: _parameterMgr->parameterNames(_vehicle->defaultComponentId())) {
-            Fact* fact = _parameterMgr->getParameter(_vehicle->defaultComponentId(), paraName);
-            bool matched = _shouldShow(fact);
-            // All of the search items must match in order for the parameter to be added to the list
-            if (matched) {
-                for (const auto& searchItem : rgSearchStrings) {
-                    QRegularExpression re = QRegularExpression(searchItem, QRegularExpression::CaseInsensitiveOption);
-                    if (re.isValid()) {
-                        if (!fact->name().contains(re) &&
-                                !fact->shortDescription().contains(re) &&
-                                !fact->longDescription().contains(re)) {
-                            matched = false;
-                        }
-                    } else {
-                        if (!fact->name().contains(searchItem, Qt::CaseInsensitive) &&
-                                !fact->shortDescription().contains(searchItem, Qt::CaseInsensitive) &&
-                                !fact->longDescription().contains(searchItem, Qt::CaseInsensitive)) {
-                            matched = false;
-                        }
-                    }
-                }
-            }
-            if (matched) {
+        // Without search items the modified parameters are listed in name order
+        const QList<Fact*> facts = rgSearchStrings.isEmpty() ? _searchIndex.searchText(QString(), true, true) : _searchIndex.search(rgSearchStrings);
+        for (Fact* fact: facts) {
+            if (_shouldShow(fact)) {
                 _searchParameters.append(fact);
             }
         }
@@ -11,6 +11,8 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QVector>
 
 #include "AutoPilotPlugin.h"
 #include "UASInterface.h"
@@ -81,6 +83,47 @@ signals:
     void loadChanged(bool load);
 };
 
+/// Trigram index over the names and descriptions of a component's parameters. Built once when the parameters are
+/// ready so searches only need to check the parameters which contain every trigram of a search item.
+class ParameterEditorSearchIndex
+{
+public:
+    void clear  (void);
+    void addFact(Fact* fact);
+
+    /// Finds the parameters matching all search items. Items are regular expressions matched case insensitive against
+    /// name and descriptions, invalid expressions are matched as plain text. When the items refine the previous search
+    /// (e.g. another character typed) only the previous matches are checked.
+    /// @return Matching parameters, best match first: name matches before description matches
+    QList<Fact*> search(const QStringList& searchItems);
+
+    /// Plain text search, used by searchParameters
+    /// @return Matching parameters in name order
+    QList<Fact*> searchText(const QString& searchText, bool searchInName, bool searchInDescriptions) const;
+
+private:
+    typedef struct {
+        Fact*   fact;
+        QString name;               ///< Lower case
+        QString shortDescription;   ///< Lower case
+        QString longDescription;    ///< Lower case
+    } Entry_t;
+
+    QVector<int>    _candidates     (const QString& literal) const;
+    int             _rank           (const Entry_t& entry, const QStringList& searchItems) const;
+    void            _addTrigrams    (const QString& text, int entryIndex);
+
+    static bool     _isLiteral      (const QString& searchItem);
+    static quint64  _trigramKey     (const QChar* chars) { return (static_cast<quint64>(chars[0].unicode()) << 32) | (static_cast<quint64>(chars[1].unicode()) << 16) | chars[2].unicode(); }
+
+    QVector<Entry_t>                _entries;
+    QHash<quint64, QVector<int>>    _trigrams;      ///< Trigram to ascending entry indices
+    QStringList                     _lastSearchItems;
+    QVector<int>                    _lastMatches;
+
+    static const int _trigramLength = 3;
+};
+
 class ParameterEditorController : public FactPanelController
 {
     Q_OBJECT
@@ -136,7 +179,8 @@ private slots:
     void _factAdded             (int compId, Fact* fact);
 
 private:
-    bool _shouldShow(Fact *fact) const;
+    bool _shouldShow        (Fact *fact) const;
+    void _buildSearchIndex  (void);
 
 private:
     ParameterManager*           _parameterMgr           = nullptr;
@@ -152,4 +196,5 @@ private:
     QmlObjectListModel          _searchParameters;
     QmlObjectListModel*         _parameters             = nullptr;
     QMap<QString, ParameterEditorCategory*> _mapCategoryName2Category;
+    ParameterEditorSearchIndex  _searchIndex;
 };
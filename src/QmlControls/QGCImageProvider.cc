@@ -14,7 +14,7 @@
 
 QGCImageProvider::QGCImageProvider(QGCApplication *app, QGCToolbox* toolbox)
     : QGCTool               (app, toolbox)
-    , QQuickImageProvider   (QQmlImageProviderBase::Image)
+    , QQuickImageProvider   (QQmlImageProviderBase::Texture)
 {
 }
 
@@ -27,9 +27,9 @@ void QGCImageProvider::setToolbox(QGCToolbox *toolbox)
 {
    QGCTool::setToolbox(toolbox);
    //-- Dummy temporary image until something comes along
-   _image = QImage(320, 240, QImage::Format_RGBA8888);
-   _image.fill(Qt::black);
-   QPainter painter(&_image);
+   _waitingImage = QImage(320, 240, QImage::Format_RGBA8888);
+   _waitingImage.fill(Qt::black);
+   QPainter painter(&_waitingImage);
    QFont f = painter.font();
    f.setPixelSize(20);
    painter.setFont(f);
@@ -37,7 +37,7 @@ void QGCImageProvider::setToolbox(QGCToolbox *toolbox)
    painter.drawText(QRectF(0, 0, 320, 240), Qt::AlignCenter, "Waiting...");
 }
 
-QImage QGCImageProvider::requestImage(const QString & /* image url with vehicle id*/, QSize *, const QSize &)
+QQuickTextureFactory* QGCImageProvider::requestTexture(const QString& id, QSize* size, const QSize& /* requestedSize */)
 {
 /*
     The QML side will request an image using a special URL, which we've registered as QGCImages.
@@ -61,14 +61,32 @@ QImage QGCImageProvider::requestImage(const QString & /* image url with vehicle
             fillMode: Image.PreserveAspectFit
         }
 
-    For now, we don't even look at the URL. This will have to be fixed if we're to support multiple
-    vehicles transmitting flow images.
+    The requested size is ignored, scaling is left to the Image item so the image is never resampled here.
 */
-    return _image;
+    bool    ok;
+    int     vehicleId = id.section(QLatin1Char('/'), 0, 0).toInt(&ok);
+    QImage  image;
+
+    {
+        QMutexLocker lock(&_imagesLock);
+        image = ok ? _images.value(vehicleId, _waitingImage) : _waitingImage;
+    }
+
+    if (size) {
+        *size = image.size();
+    }
+
+    return QQuickTextureFactory::textureFactoryForImage(image);
 }
 
-void QGCImageProvider::setImage(QImage* pImage, int /* vehicle id*/)
+void QGCImageProvider::setImage(const QImage& image, int id)
 {
-    _image = pImage->mirrored();
+    QMutexLocker lock(&_imagesLock);
+    _images[id] = image;
 }
 
+void QGCImageProvider::clearImage(int id)
+{
+    QMutexLocker lock(&_imagesLock);
+    _images.remove(id);
+}
@@ -11,28 +11,33 @@
 #include <QObject>
 #include <QQmlListProperty>
 #include <QQuickImageProvider>
+#include <QHash>
+#include <QMutex>
 
 #include "QGCToolbox.h"
 
 // This is used to expose images from ImageProtocolHandler
+//
+// Images are held per vehicle id. QImage is implicitly shared, so storing and serving an image only takes a
+// reference, and QML gets it as a texture factory which uploads the pixels once without converting to a QImage
+// copy on the QML side.
 class QGCImageProvider : public QGCTool, public QQuickImageProvider
 {
 public:
     QGCImageProvider        (QGCApplication* app, QGCToolbox* toolbox);
     ~QGCImageProvider       ();
 
-    void    setImage        (QImage* pImage, int id = 0);
+    void    setImage        (const QImage& image, int id = 0);
+    void    clearImage      (int id);
 
     // Overrdies from QQuickImageProvider
-    QImage  requestImage    (const QString& id, QSize* size, const QSize& requestedSize) override;
+    QQuickTextureFactory* requestTexture(const QString& id, QSize* size, const QSize& requestedSize) override;
 
     // Overrides from QGCTool
     void    setToolbox      (QGCToolbox *toolbox) override;
 
 private:
-    //-- TODO: For now this is holding a single image. If you happen to have two
-    //   or more vehicles with flow, it will not work. To properly manage that condition
-    //   this should be a map between each vehicle and its image. The URL provided
-    //   for the image request would contain the vehicle identification.
-    QImage _image;
+    QMutex              _imagesLock;    ///< requestTexture can be called from the QML image loader thread
+    QHash<int, QImage>  _images;
+    QImage              _waitingImage;  ///< Placeholder until a vehicle sends its first image
 };
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCMapTransform.h"
+
+#include <QQuickItem>
+#include <QtMath>
+
+#include <cmath>
+
+bool QGCMapTransform::update(QQuickItem* map, QQuickItem* item)
+{
+    if (!map) {
+        return false;
+    }
+
+    QGeoCoordinate center = map->property("center").value<QGeoCoordinate>();
+    if (!center.isValid()) {
+        return false;
+    }
+    QGeoCoordinate other = center.atDistanceAndAzimuth(1000, 90);
+
+    QPointF centerPoint;
+    QPointF otherPoint;
+    if (!QMetaObject::invokeMethod(map, "fromCoordinate", Qt::DirectConnection, Q_RETURN_ARG(QPointF, centerPoint), Q_ARG(QGeoCoordinate, center), Q_ARG(bool, false)) ||
+            !QMetaObject::invokeMethod(map, "fromCoordinate", Qt::DirectConnection, Q_RETURN_ARG(QPointF, otherPoint), Q_ARG(QGeoCoordinate, other), Q_ARG(bool, false))) {
+        qWarning() << "QGCMapTransform map has no fromCoordinate method";
+        return false;
+    }
+    if (qIsNaN(centerPoint.x()) || qIsNaN(otherPoint.x())) {
+        return false;
+    }
+    centerPoint = item->mapFromItem(map, centerPoint);
+    otherPoint  = item->mapFromItem(map, otherPoint);
+
+    // scale = (otherPoint - centerPoint) / (otherMercator - centerMercator), as complex numbers
+    QPointF centerMercator  = toMercator(center);
+    QPointF deltaMercator   = toMercator(other) - centerMercator;
+    QPointF deltaPoint      = otherPoint - centerPoint;
+    double  divisor         = (deltaMercator.x() * deltaMercator.x()) + (deltaMercator.y() * deltaMercator.y());
+    if (qFuzzyIsNull(divisor)) {
+        return false;
+    }
+    _scaleReal      = ((deltaPoint.x() * deltaMercator.x()) + (deltaPoint.y() * deltaMercator.y())) / divisor;
+    _scaleImaginary = ((deltaPoint.y() * deltaMercator.x()) - (deltaPoint.x() * deltaMercator.y())) / divisor;
+    _offsetX        = 0;
+    _offsetY        = 0;
+    QPointF scaledCenter = toItem(centerMercator);
+    _offsetX        = centerPoint.x() - scaledCenter.x();
+    _offsetY        = centerPoint.y() - scaledCenter.y();
+
+    return true;
+}
+
+QPointF QGCMapTransform::toItem(const QPointF& mercator) const
+{
+    return QPointF((_scaleReal * mercator.x()) - (_scaleImaginary * mercator.y()) + _offsetX,
+                   (_scaleImaginary * mercator.x()) + (_scaleReal * mercator.y()) + _offsetY);
+}
+
+QPointF QGCMapTransform::fromItem(const QPointF& itemPoint) const
+{
+    // mercator = (item - offset) / scale
+    double x        = itemPoint.x() - _offsetX;
+    double y        = itemPoint.y() - _offsetY;
+    double divisor  = (_scaleReal * _scaleReal) + (_scaleImaginary * _scaleImaginary);
+    return QPointF(((x * _scaleReal) + (y * _scaleImaginary)) / divisor,
+                   ((y * _scaleReal) - (x * _scaleImaginary)) / divisor);
+}
+
+double QGCMapTransform::rotation(void) const
+{
+    return qAtan2(_scaleImaginary, _scaleReal);
+}
+
+QPointF QGCMapTransform::toMercator(const QGeoCoordinate& coordinate)
+{
+    double latitude = qDegreesToRadians(qBound(-85.05112878, coordinate.latitude(), 85.05112878));
+    return QPointF((coordinate.longitude() + 180.0) / 360.0,
+                   (1.0 - (qLn(qTan(latitude) + (1.0 / qCos(latitude))) / M_PI)) / 2.0);
+}
+
+QGeoCoordinate QGCMapTransform::fromMercator(const QPointF& mercator)
+{
+    double latitude = qRadiansToDegrees(qAtan(std::sinh(M_PI * (1.0 - (2.0 * mercator.y())))));
+    return QGeoCoordinate(latitude, (mercator.x() * 360.0) - 180.0);
+}
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QPointF>
+
+class QQuickItem;
+
+/// Similarity transform (scale and map bearing) from web mercator to the coordinates of an item over a map:
+/// item = scale * mercator + offset, with all values as complex numbers. Used by scene graph items which draw on the
+/// map so that each frame only applies the transform instead of calling fromCoordinate per point. Map tilt is not supported.
+class QGCMapTransform
+{
+public:
+    /// Takes the transform from the current map view with two fromCoordinate calls
+    ///     @return false: map has no valid view
+    bool update(QQuickItem* map, QQuickItem* item);
+
+    QPointF toItem      (const QPointF& mercator) const;
+    QPointF fromItem    (const QPointF& itemPoint) const;   ///< @return mercator position
+    double  rotation    (void) const;                       ///< Map bearing in radians
+
+    /// @return Web mercator position, x and y from 0 to 1 with y increasing to the south
+    static QPointF          toMercator  (const QGeoCoordinate& coordinate);
+    static QGeoCoordinate   fromMercator(const QPointF& mercator);
+
+private:
+    double  _scaleReal      = 1;
+    double  _scaleImaginary = 0;
+    double  _offsetX        = 0;
+    double  _offsetY        = 0;
+};
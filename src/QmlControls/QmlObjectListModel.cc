@@ -15,6 +15,8 @@
 
 #include <QDebug>
 #include <QQmlEngine>
+#include <QSet>
+#include <QHash>
 
 const int QmlObjectListModel::ObjectRole = Qt::UserRole;
 const int QmlObjectListModel::TextRole = Qt::UserRole + 1;
@@ -141,6 +143,201 @@ void QmlObjectListModel::move(int from, int to)
     }
 }
 
+void QmlObjectListModel::moveRange(int from, int count, int to)
+{
+    if (count <= 0 || from < 0 || from + count > _objectList.count() || to < 0 || to + count > _objectList.count()) {
+        qWarning() << "Invalid range from:count:to:listCount" << from << count << to << _objectList.count();
+        return;
+    }
+    _moveRun(from, count, to);
+}
+
+QList<QObject*> QmlObjectListModel::removeRange(int first, int count)
+{
+    if (count <= 0 || first < 0 || first + count > _objectList.count()) {
+        qWarning() << "Invalid range first:count:listCount" << first << count << _objectList.count();
+        return QList<QObject*>();
+    }
+
+    QList<QObject*> removedObjects = _objectList.mid(first, count);
+    _removeRun(first, count);
+    emit countChanged(this->count());
+    setDirty(true);
+    return removedObjects;
+}
+
+void QmlObjectListModel::applyChanges(const QList<QObject*>& newList)
+{
+    const int       oldCount    = _objectList.count();
+    const QSet<QObject*> oldSet(_objectList.begin(), _objectList.end());
+    const QSet<QObject*> newSet(newList.begin(), newList.end());
+    bool            rowsChanged = false;
+
+    // Remove runs of items which are not in the new list, from the end so the indices in front stay valid
+    int i = _objectList.count() - 1;
+    while (i >= 0) {
+        if (newSet.contains(_objectList[i])) {
+            i--;
+            continue;
+        }
+        int last = i;
+        while (i >= 0 && !newSet.contains(_objectList[i])) {
+            i--;
+        }
+        _removeRun(i + 1, last - i);
+        rowsChanged = true;
+    }
+
+    // The kept items in their new order
+    QList<QObject*>     keptList;
+    QHash<QObject*, int> keptIndex;
+    for (QObject* object: newList) {
+        if (oldSet.contains(object)) {
+            keptIndex[object] = keptList.count();
+            keptList.append(object);
+        }
+    }
+
+    // Items on the longest run which is already in the new order stay where they are, all others are moved. The run is
+    // the longest increasing subsequence of the new indices of the current items.
+    QSet<QObject*> stableItems;
+    {
+        QVector<int> tails;                                     // Current index of the last item of the best run of each length
+        QVector<int> predecessor(_objectList.count(), -1);
+        for (int j=0; j<_objectList.count(); j++) {
+            const int newIndex = keptIndex[_objectList[j]];
+            int low = 0;
+            int high = tails.count();
+            while (low < high) {
+                int mid = (low + high) / 2;
+                if (keptIndex[_objectList[tails[mid]]] < newIndex) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            predecessor[j] = low > 0 ? tails[low - 1] : -1;
+            if (low == tails.count()) {
+                tails.append(j);
+            } else {
+                tails[low] = j;
+            }
+        }
+        for (int j=tails.isEmpty() ? -1 : tails.last(); j != -1; j=predecessor[j]) {
+            stableItems.insert(_objectList[j]);
+        }
+    }
+
+    // Move each other item (or run of items which are together in both lists) behind the item which precedes it in
+    // the new order. Everything in front of it in the new order is already in place at that point.
+    for (int k=0; k<keptList.count(); k++) {
+        if (stableItems.contains(keptList[k])) {
+            continue;
+        }
+        const int from = _objectList.indexOf(keptList[k]);
+        int count = 1;
+        while (k + count < keptList.count() && !stableItems.contains(keptList[k + count]) && _objectList.value(from + count) == keptList[k + count]) {
+            count++;
+        }
+        int to = 0;
+        if (k > 0) {
+            const int predecessorIndex = _objectList.indexOf(keptList[k - 1]);
+            to = from > predecessorIndex ? predecessorIndex + 1 : predecessorIndex - count + 1;
+        }
+        _moveRun(from, count, to);
+        k += count - 1;
+    }
+
+    // Insert runs of new items
+    int k = 0;
+    while (k < newList.count()) {
+        if (k < _objectList.count() && _objectList[k] == newList[k]) {
+            k++;
+            continue;
+        }
+        int runEnd = k;
+        while (runEnd < newList.count() && !oldSet.contains(newList[runEnd])) {
+            runEnd++;
+        }
+        if (runEnd == k) {
+            qWarning() << "QmlObjectListModel::applyChanges newList contains duplicate items";
+            break;
+        }
+        _insertRun(k, newList.mid(k, runEnd - k));
+        rowsChanged = true;
+        k = runEnd;
+    }
+
+    if (_objectList.count() != oldCount) {
+        emit countChanged(count());
+    }
+    if (rowsChanged) {
+        setDirty(true);
+    }
+}
+
+void QmlObjectListModel::_connectChild(QObject* object, int index)
+{
+    if (object) {
+        QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
+        // Look for a dirtyChanged signal on the object
+        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+            if (!_skipDirtyFirstItem || index != 0) {
+                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+            }
+        }
+    }
+}
+
+void QmlObjectListModel::_disconnectChild(QObject* object, int index)
+{
+    if (object) {
+        // Look for a dirtyChanged signal on the object
+        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+            if (!_skipDirtyFirstItem || index != 0) {
+                QObject::disconnect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+            }
+        }
+    }
+}
+
+void QmlObjectListModel::_removeRun(int first, int count)
+{
+    for (int i=first; i<first + count; i++) {
+        _disconnectChild(_objectList[i], i);
+    }
+    beginRemoveRows(QModelIndex(), first, first + count - 1);
+    _objectList.erase(_objectList.begin() + first, _objectList.begin() + first + count);
+    endRemoveRows();
+}
+
+void QmlObjectListModel::_moveRun(int from, int count, int to)
+{
+    if (from == to) {
+        return;
+    }
+    // beginMoveRows wants the destination as an index in the list before the move
+    beginMoveRows(QModelIndex(), from, from + count - 1, QModelIndex(), to > from ? to + count : to);
+    QList<QObject*> run = _objectList.mid(from, count);
+    _objectList.erase(_objectList.begin() + from, _objectList.begin() + from + count);
+    for (int i=0; i<count; i++) {
+        _objectList.insert(to + i, run[i]);
+    }
+    endMoveRows();
+}
+
+void QmlObjectListModel::_insertRun(int i, const QList<QObject*>& objects)
+{
+    for (int j=0; j<objects.count(); j++) {
+        _connectChild(objects[j], i + j);
+    }
+    beginInsertRows(QModelIndex(), i, i + objects.count() - 1);
+    for (int j=0; j<objects.count(); j++) {
+        _objectList.insert(i + j, objects[j]);
+    }
+    endInsertRows();
+}
+
 QObject* QmlObjectListModel::operator[](int index)
 {
     if (index < 0 || index >= _objectList.count()) {
@@ -172,14 +369,7 @@ void QmlObjectListModel::clear()
 QObject* QmlObjectListModel::removeAt(int i)
 {
     QObject* removedObject = _objectList[i];
-    if(removedObject) {
-        // Look for a dirtyChanged signal on the object
-        if (_objectList[i]->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::disconnect(_objectList[i], SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-    }
+    _disconnectChild(removedObject, i);
     removeRows(i, 1);
     setDirty(true);
     return removedObject;
@@ -190,15 +380,7 @@ void QmlObjectListModel::insert(int i, QObject* object)
     if (i < 0 || i > _objectList.count()) {
         qWarning() << "Invalid index index:count" << i << _objectList.count();
     }
-    if(object) {
-        QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-    }
+    _connectChild(object, i);
     _objectList.insert(i, object);
     insertRows(i, 1);
     setDirty(true);
@@ -210,23 +392,12 @@ void QmlObjectListModel::insert(int i, QList<QObject*> objects)
         qWarning() << "Invalid index index:count" << i << _objectList.count();
     }
 
-    int j = i;
-    for (QObject* object: objects) {
-        QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || j != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-
-        _objectList.insert(j, object);
-        j++;
+    if (objects.isEmpty()) {
+        return;
     }
 
-    insertRows(i, objects.count());
-
+    _insertRun(i, objects);
+    emit countChanged(count());
     setDirty(true);
 }
 
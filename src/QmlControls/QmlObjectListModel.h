@@ -46,9 +46,22 @@ public:
     bool        contains            (QObject* object) { return _objectList.indexOf(object) != -1; }
     int         indexOf             (QObject* object) { return _objectList.indexOf(object); }
 
+    /// Removes count items starting at index first with a single set of row change signals
+    /// @return Removed items
+    QList<QObject*> removeRange(int first, int count);
+
     /// Moves an item to a new position
     void move(int from, int to);
 
+    /// Moves count items starting at index from such that the first of them ends up at index to
+    void moveRange(int from, int count, int to);
+
+    /// Changes the list to match newList with as few row changes as possible: runs of removed items are removed
+    /// together, items which changed position are moved and runs of new items are inserted together. Items which
+    /// are kept keep their delegates in QML. countChanged is signalled once. Items removed from the list are not
+    /// deleted. Items must only be in each list once.
+    void applyChanges(const QList<QObject*>& newList);
+
     QObject*    operator[]          (int i);
     const QObject* operator[]       (int i) const;
     template<class T> T value       (int index) { return qobject_cast<T>(_objectList[index]); }
@@ -71,6 +84,12 @@ private slots:
     void _childDirtyChanged         (bool dirty);
     
 private:
+    void _connectChild      (QObject* object, int index);
+    void _disconnectChild   (QObject* object, int index);
+    void _removeRun         (int first, int count);
+    void _moveRun           (int from, int count, int to);
+    void _insertRun         (int i, const QList<QObject*>& objects);
+
     // Overrides from QAbstractListModel
     int         rowCount    (const QModelIndex & parent = QModelIndex()) const override;
     QVariant    data        (const QModelIndex & index, int role = Qt::DisplayRole) const override;
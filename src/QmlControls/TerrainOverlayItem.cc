@@ -0,0 +1,361 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainOverlayItem.h"
+#include "TerrainQuery.h"
+#include "QmlObjectListModel.h"
+
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+#include <QSGVertexColorMaterial>
+#include <QMetaProperty>
+#include <QSet>
+#include <QtMath>
+
+QGC_LOGGING_CATEGORY(TerrainOverlayItemLog, "TerrainOverlayItemLog")
+
+namespace {
+    /// Textured quad for one terrain tile, owns its texture
+    class TileNode : public QSGGeometryNode
+    {
+    public:
+        TileNode(QSGTexture* texture)
+            : _texture(texture)
+        {
+            QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4);
+            geometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+            setGeometry(geometry);
+            setFlag(QSGNode::OwnsGeometry);
+
+            _texture->setFiltering(QSGTexture::Linear);
+            _material.setTexture(_texture);
+            _material.setFiltering(QSGTexture::Linear);
+            _material.setFlag(QSGMaterial::Blending, true);
+            setMaterial(&_material);
+        }
+
+        ~TileNode() { delete _texture; }
+
+    private:
+        QSGTexture*         _texture;
+        QSGTextureMaterial  _material;
+    };
+
+    class OverlayNode : public QSGNode
+    {
+    public:
+        QSGNode*                    tilesNode   = nullptr;
+        QSGGeometryNode*            pathNode    = nullptr;
+        QHash<quint64, TileNode*>   tileNodes;
+    };
+}
+
+TerrainOverlayItem::TerrainOverlayItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(QQuickItem::ItemHasContents, true);
+
+    connect(this, &TerrainOverlayItem::showHillshadeChanged,    this, &TerrainOverlayItem::_scheduleUpdate);
+    connect(this, &TerrainOverlayItem::clearanceWarningChanged, this, &TerrainOverlayItem::_rebuildPath);
+    connect(this, &TerrainOverlayItem::lineWidthChanged,        this, &TerrainOverlayItem::_scheduleUpdate);
+    connect(this, &QQuickItem::widthChanged,                    this, &TerrainOverlayItem::_scheduleUpdate);
+    connect(this, &QQuickItem::heightChanged,                   this, &TerrainOverlayItem::_scheduleUpdate);
+    connect(this, &QQuickItem::visibleChanged,                  this, &TerrainOverlayItem::_scheduleUpdate);
+    connect(TerrainTileManager::instance(), &TerrainTileManager::tileAdded, this, &TerrainOverlayItem::_scheduleUpdate);
+}
+
+void TerrainOverlayItem::setMap(QQuickItem* map)
+{
+    if (map != _map) {
+        if (_map) {
+            disconnect(_map, nullptr, this, nullptr);
+        }
+        _map = map;
+        if (_map) {
+            // The map type is not public api, so its signals are connected by name
+            connect(_map, SIGNAL(centerChanged(QGeoCoordinate)),    this, SLOT(_scheduleUpdate()));
+            connect(_map, SIGNAL(zoomLevelChanged(qreal)),          this, SLOT(_scheduleUpdate()));
+            connect(_map, SIGNAL(bearingChanged(qreal)),            this, SLOT(_scheduleUpdate()));
+            connect(_map, &QQuickItem::widthChanged,                this, &TerrainOverlayItem::_scheduleUpdate);
+            connect(_map, &QQuickItem::heightChanged,               this, &TerrainOverlayItem::_scheduleUpdate);
+        }
+        emit mapChanged();
+        _scheduleUpdate();
+    }
+}
+
+void TerrainOverlayItem::setSegments(QmlObjectListModel* segments)
+{
+    if (segments != _segments) {
+        if (_segments) {
+            disconnect(_segments, nullptr, this, nullptr);
+            for (int i=0; i<_segments->count(); i++) {
+                disconnect(_segments->get(i), nullptr, this, nullptr);
+            }
+        }
+        _segments = segments;
+        if (_segments) {
+            connect(_segments, &QAbstractItemModel::rowsInserted,   this, &TerrainOverlayItem::_segmentRowsChanged);
+            connect(_segments, &QAbstractItemModel::rowsRemoved,    this, &TerrainOverlayItem::_segmentRowsChanged);
+            connect(_segments, &QAbstractItemModel::modelReset,     this, &TerrainOverlayItem::_segmentRowsChanged);
+        }
+        emit segmentsChanged();
+        _segmentRowsChanged();
+    }
+}
+
+void TerrainOverlayItem::_segmentRowsChanged(void)
+{
+    if (_segments) {
+        // Connections are unique, so segments which were already in the model are not connected twice
+        for (int i=0; i<_segments->count(); i++) {
+            _connectSegment(_segments->get(i));
+        }
+    }
+    _rebuildPath();
+}
+
+void TerrainOverlayItem::_connectSegment(QObject* segment)
+{
+    static const char* rgProperties[] = { "coordinate1", "coordinate2", "coord1AMSLAlt", "coord2AMSLAlt", "amslTerrainHeights" };
+
+    const QMetaObject*  metaObject  = segment->metaObject();
+    QMetaMethod         rebuildSlot = staticMetaObject.method(staticMetaObject.indexOfSlot("_rebuildPath()"));
+    for (const char* propertyName: rgProperties) {
+        int propertyIndex = metaObject->indexOfProperty(propertyName);
+        if (propertyIndex != -1 && metaObject->property(propertyIndex).hasNotifySignal()) {
+            connect(segment, metaObject->property(propertyIndex).notifySignal(), this, rebuildSlot, Qt::UniqueConnection);
+        }
+    }
+}
+
+/// Builds the mercator positions and clearance colors of the path. Only done when the segments change, not per frame.
+void TerrainOverlayItem::_rebuildPath(void)
+{
+    _paths.clear();
+
+    for (int i=0; _segments && i<_segments->count(); i++) {
+        QObject*        segment             = _segments->get(i);
+        QGeoCoordinate  coord1              = segment->property("coordinate1").value<QGeoCoordinate>();
+        QGeoCoordinate  coord2              = segment->property("coordinate2").value<QGeoCoordinate>();
+        double          amslAlt1            = segment->property("coord1AMSLAlt").toDouble();
+        double          amslAlt2            = segment->property("coord2AMSLAlt").toDouble();
+        QVariantList    terrainHeights      = segment->property("amslTerrainHeights").toList();
+        double          distanceBetween     = segment->property("distanceBetween").toDouble();
+        double          finalDistanceBetween = segment->property("finalDistanceBetween").toDouble();
+        if (!coord1.isValid() || !coord2.isValid()) {
+            continue;
+        }
+
+        QVector<PathPoint_t> path;
+        if (terrainHeights.count() < 2 || qIsNaN(amslAlt1) || qIsNaN(amslAlt2)) {
+            // Terrain is not known yet
+            path.append({ QGCMapTransform::toMercator(coord1), Qt::white });
+            path.append({ QGCMapTransform::toMercator(coord2), Qt::white });
+        } else {
+            double totalDistance    = coord1.distanceTo(coord2);
+            double azimuth          = coord1.azimuthTo(coord2);
+            for (int j=0; j<terrainHeights.count(); j++) {
+                double distance = j < terrainHeights.count() - 1 ? j * distanceBetween : ((j - 1) * distanceBetween) + finalDistanceBetween;
+                distance = qMin(distance, totalDistance);
+                double fraction     = totalDistance > 0 ? distance / totalDistance : 0;
+                double amslAlt      = amslAlt1 + ((amslAlt2 - amslAlt1) * fraction);
+                double clearance    = amslAlt - terrainHeights[j].toDouble();
+                path.append({ QGCMapTransform::toMercator(coord1.atDistanceAndAzimuth(distance, azimuth)), _clearanceColor(clearance) });
+            }
+        }
+        _paths.append(path);
+    }
+
+    _scheduleUpdate();
+}
+
+QColor TerrainOverlayItem::_clearanceColor(double clearance) const
+{
+    if (clearance < 0) {
+        return Qt::red;
+    } else if (clearance < _clearanceWarning) {
+        return QColor(255, 165, 0);
+    }
+    return QColor(0, 200, 0);
+}
+
+void TerrainOverlayItem::_scheduleUpdate(void)
+{
+    // Multiple changes within a frame only build the vertices once
+    polish();
+}
+
+void TerrainOverlayItem::updatePolish(void)
+{
+    _tileQuads.clear();
+    _pathVertices.clear();
+
+    QGCMapTransform transform;
+    if (!isVisible() || !transform.update(_map, this)) {
+        update();
+        return;
+    }
+
+    _updateTiles(transform);
+
+    const QRectF bounds = boundingRect();
+    for (const QVector<PathPoint_t>& path: _paths) {
+        QPointF from = transform.toItem(path[0].mercator);
+        for (int i=1; i<path.count(); i++) {
+            QPointF to = transform.toItem(path[i].mercator);
+            if (bounds.contains(from) || bounds.contains(to) || bounds.intersects(QRectF(from, to).normalized())) {
+                _addLineSegment(from, to, path[i - 1].color, path[i].color);
+            }
+            from = to;
+        }
+    }
+
+    qCDebug(TerrainOverlayItemLog) << "updatePolish tiles:path vertices" << _tileQuads.count() << _pathVertices.count();
+
+    update();
+}
+
+void TerrainOverlayItem::_updateTiles(const QGCMapTransform& transform)
+{
+    if (!_showHillshade) {
+        return;
+    }
+
+    // Visible area from the item corners, which may be rotated by the map bearing
+    const QRectF    rect = boundingRect();
+    const QPointF   rgCorners[] = { rect.topLeft(), rect.topRight(), rect.bottomLeft(), rect.bottomRight() };
+    double north = -90, south = 90, west = 180, east = -180;
+    for (const QPointF& corner: rgCorners) {
+        QGeoCoordinate coord = QGCMapTransform::fromMercator(transform.fromItem(corner));
+        north   = qMax(north, coord.latitude());
+        south   = qMin(south, coord.latitude());
+        west    = qMin(west, coord.longitude());
+        east    = qMax(east, coord.longitude());
+    }
+    QGeoRectangle area(QGeoCoordinate(north, west), QGeoCoordinate(south, east));
+
+    TerrainTileManager* tileManager = TerrainTileManager::instance();
+    QList<quint64> tileKeys = TerrainTileManager::tileKeysForArea(area, _maxVisibleTiles);
+
+    bool missingTiles = false;
+    for (quint64 tileKey: tileKeys) {
+        if (!_tileImages.contains(tileKey)) {
+            TileImage_t tileImage;
+            if (!tileManager->tileHillshade(tileKey, tileImage.image, tileImage.bounds)) {
+                missingTiles = true;
+                continue;
+            }
+            _tileImages[tileKey] = tileImage;
+        }
+
+        const QGeoRectangle& tileBounds = _tileImages[tileKey].bounds;
+        _tileQuads.append({ tileKey,
+                            transform.toItem(QGCMapTransform::toMercator(tileBounds.topLeft())),
+                            transform.toItem(QGCMapTransform::toMercator(tileBounds.bottomLeft())),
+                            transform.toItem(QGCMapTransform::toMercator(tileBounds.topRight())),
+                            transform.toItem(QGCMapTransform::toMercator(tileBounds.bottomRight())) });
+    }
+
+    // Tiles show up through tileAdded once they are loaded
+    if (missingTiles && !(_prefetchedArea.isValid() && _prefetchedArea.contains(area))) {
+        _prefetchedArea = area;
+        tileManager->prefetchArea(area);
+    }
+
+    if (_tileImages.count() > _maxTileImages) {
+        const QSet<quint64> visibleKeys(tileKeys.begin(), tileKeys.end());
+        for (auto iter = _tileImages.begin(); iter != _tileImages.end();) {
+            iter = visibleKeys.contains(iter.key()) ? iter + 1 : _tileImages.erase(iter);
+        }
+    }
+}
+
+QSGNode* TerrainOverlayItem::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
+{
+    OverlayNode* rootNode = static_cast<OverlayNode*>(oldNode);
+
+    if (!rootNode) {
+        rootNode = new OverlayNode;
+
+        rootNode->tilesNode = new QSGNode;
+        rootNode->tilesNode->setFlag(QSGNode::OwnedByParent);
+
+        rootNode->pathNode = new QSGGeometryNode;
+        QSGGeometry* pathGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        pathGeometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        rootNode->pathNode->setFlag(QSGNode::OwnsGeometry);
+        rootNode->pathNode->setFlag(QSGNode::OwnsMaterial);
+        rootNode->pathNode->setFlag(QSGNode::OwnedByParent);
+        rootNode->pathNode->setGeometry(pathGeometry);
+        rootNode->pathNode->setMaterial(new QSGVertexColorMaterial);
+
+        // Path is drawn over the terrain
+        rootNode->appendChildNode(rootNode->tilesNode);
+        rootNode->appendChildNode(rootNode->pathNode);
+    }
+
+    // Textures are only created for tiles which come into view and are released when they leave it
+    QSet<quint64> visibleKeys;
+    for (const TileQuad_t& quad: _tileQuads) {
+        visibleKeys.insert(quad.tileKey);
+
+        TileNode* tileNode = rootNode->tileNodes.value(quad.tileKey);
+        if (!tileNode) {
+            QSGTexture* texture = window()->createTextureFromImage(_tileImages[quad.tileKey].image);
+            tileNode = new TileNode(texture);
+            rootNode->tilesNode->appendChildNode(tileNode);
+            rootNode->tileNodes[quad.tileKey] = tileNode;
+        }
+
+        // Triangle strip: top left, bottom left, top right, bottom right
+        QSGGeometry::TexturedPoint2D* vertices = tileNode->geometry()->vertexDataAsTexturedPoint2D();
+        vertices[0].set(static_cast<float>(quad.topLeft.x()),       static_cast<float>(quad.topLeft.y()),       0, 0);
+        vertices[1].set(static_cast<float>(quad.bottomLeft.x()),    static_cast<float>(quad.bottomLeft.y()),    0, 1);
+        vertices[2].set(static_cast<float>(quad.topRight.x()),      static_cast<float>(quad.topRight.y()),      1, 0);
+        vertices[3].set(static_cast<float>(quad.bottomRight.x()),   static_cast<float>(quad.bottomRight.y()),   1, 1);
+        tileNode->markDirty(QSGNode::DirtyGeometry);
+    }
+    for (auto iter = rootNode->tileNodes.begin(); iter != rootNode->tileNodes.end();) {
+        if (visibleKeys.contains(iter.key())) {
+            iter++;
+        } else {
+            rootNode->tilesNode->removeChildNode(iter.value());
+            delete iter.value();
+            iter = rootNode->tileNodes.erase(iter);
+        }
+    }
+
+    rootNode->pathNode->geometry()->allocate(_pathVertices.count());
+    memcpy(rootNode->pathNode->geometry()->vertexDataAsColoredPoint2D(), _pathVertices.constData(), static_cast<size_t>(_pathVertices.count()) * sizeof(QSGGeometry::ColoredPoint2D));
+    rootNode->pathNode->markDirty(QSGNode::DirtyGeometry);
+
+    return rootNode;
+}
+
+void TerrainOverlayItem::_addLineSegment(const QPointF& from, const QPointF& to, const QColor& fromColor, const QColor& toColor)
+{
+    QPointF direction   = to - from;
+    double  length      = qSqrt(QPointF::dotProduct(direction, direction));
+    if (qFuzzyIsNull(length)) {
+        return;
+    }
+    QPointF offset = QPointF(-direction.y(), direction.x()) * ((_lineWidth / 2.0) / length);
+
+    const QPointF   rgVertices[]    = { from + offset, from - offset, to + offset, to + offset, from - offset, to - offset };
+    const QColor*   rgColors[]      = { &fromColor, &fromColor, &toColor, &toColor, &fromColor, &toColor };
+    for (int i=0; i<6; i++) {
+        const QColor& color = *rgColors[i];
+        QSGGeometry::ColoredPoint2D point;
+        point.set(static_cast<float>(rgVertices[i].x()), static_cast<float>(rgVertices[i].y()),
+                  static_cast<uchar>(color.red() * color.alphaF()), static_cast<uchar>(color.green() * color.alphaF()), static_cast<uchar>(color.blue() * color.alphaF()), static_cast<uchar>(color.alpha()));
+        _pathVertices.append(point);
+    }
+}
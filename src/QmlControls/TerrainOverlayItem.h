@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QQuickItem>
+#include <QSGGeometry>
+#include <QGeoRectangle>
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QVector>
+#include <QPointer>
+
+#include "QGCLoggingCategory.h"
+#include "QGCMapTransform.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainOverlayItemLog)
+
+class QmlObjectListModel;
+
+/// Terrain overlay for a map: hillshade of the terrain tiles in view and the flight path colored by terrain clearance.
+///
+/// Hillshade images are built once per tile from the TerrainTileManager cache and uploaded as textures, each frame
+/// only positions one textured quad per visible tile. Tiles which are not cached yet are prefetched and shown when they
+/// arrive. Clearance comes from the amslTerrainHeights already queried for each FlightPathSegment of segments, so no
+/// additional terrain lookups are done for the path. The item must fill the map it draws on.
+class TerrainOverlayItem : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    TerrainOverlayItem(QQuickItem* parent = nullptr);
+
+    Q_PROPERTY(QQuickItem*          map                 READ map        WRITE setMap        NOTIFY mapChanged)
+    Q_PROPERTY(QmlObjectListModel*  segments            READ segments   WRITE setSegments   NOTIFY segmentsChanged)     ///< FlightPathSegment objects
+    Q_PROPERTY(bool                 showHillshade       MEMBER _showHillshade               NOTIFY showHillshadeChanged)
+    Q_PROPERTY(double               clearanceWarning    MEMBER _clearanceWarning            NOTIFY clearanceWarningChanged) ///< Meters
+    Q_PROPERTY(double               lineWidth           MEMBER _lineWidth                   NOTIFY lineWidthChanged)
+
+    QQuickItem*         map     (void) { return _map; }
+    QmlObjectListModel* segments(void) { return _segments; }
+
+    void setMap         (QQuickItem* map);
+    void setSegments    (QmlObjectListModel* segments);
+
+    // Overrides from QQuickItem
+    void     updatePolish   (void) override;
+    QSGNode* updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* updatePaintNodeData) override;
+
+signals:
+    void mapChanged             (void);
+    void segmentsChanged        (void);
+    void showHillshadeChanged   (void);
+    void clearanceWarningChanged(void);
+    void lineWidthChanged       (void);
+
+private slots:
+    void _segmentRowsChanged    (void);
+    void _rebuildPath           (void);
+    void _scheduleUpdate        (void);
+
+private:
+    typedef struct {
+        QImage          image;
+        QGeoRectangle   bounds;
+    } TileImage_t;
+
+    typedef struct {
+        quint64 tileKey;
+        QPointF topLeft;
+        QPointF bottomLeft;
+        QPointF topRight;
+        QPointF bottomRight;
+    } TileQuad_t;
+
+    typedef struct {
+        QPointF mercator;
+        QColor  color;
+    } PathPoint_t;
+
+    void    _updateTiles        (const QGCMapTransform& transform);
+    void    _connectSegment     (QObject* segment);
+    QColor  _clearanceColor     (double clearance) const;
+    void    _addLineSegment     (const QPointF& from, const QPointF& to, const QColor& fromColor, const QColor& toColor);
+
+    QPointer<QQuickItem>            _map;
+    QPointer<QmlObjectListModel>    _segments;
+    bool                            _showHillshade      = true;
+    double                          _clearanceWarning   = 30;
+    double                          _lineWidth          = 4;
+
+    QHash<quint64, TileImage_t>     _tileImages;        ///< Hillshades built so far, keyed by terrain tile
+    QVector<TileQuad_t>             _tileQuads;         ///< Visible tiles in item coordinates
+    QGeoRectangle                   _prefetchedArea;
+    QVector<QVector<PathPoint_t>>   _paths;             ///< One per segment, with a point per terrain height
+    QVector<QSGGeometry::ColoredPoint2D> _pathVertices; ///< Two triangles per path piece
+
+    static const int _maxVisibleTiles   = 400;          ///< Hillshade is not drawn when zoomed out further
+    static const int _maxTileImages     = 2000;         ///< Around 10MB of images
+
+    Q_DISABLE_COPY(TerrainOverlayItem)
+};
+
+QML_DECLARE_TYPE(TerrainOverlayItem)
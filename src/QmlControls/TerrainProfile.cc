@@ -15,6 +15,7 @@
 #include "ComplexMissionItem.h"
 
 #include <QSGSimpleRectNode>
+#include <QtMath>
 
 QGC_LOGGING_CATEGORY(TerrainProfileLog, "TerrainProfileLog")
 
@@ -57,6 +58,110 @@ void TerrainProfile::_newVisualItems(void)
     emit _updateSignal();
 }
 
+void TerrainProfile::_segmentTerrainChanged(void)
+{
+    _segmentProfiles.remove(qobject_cast<FlightPathSegment*>(sender()));
+}
+
+void TerrainProfile::_segmentDestroyed(QObject* segment)
+{
+    // The object is already partially destroyed so only the pointer value can be used
+    _segmentProfiles.remove(static_cast<FlightPathSegment*>(segment));
+}
+
+TerrainProfile::SegmentProfile_t TerrainProfile::_segmentProfile(FlightPathSegment* segment)
+{
+    int     cHeights    = segment->amslTerrainHeights().count();
+    double  pixelWidth  = segment->totalDistance() * _pixelsPerMeter;
+    int     columnCount = qIsFinite(pixelWidth) && pixelWidth < cHeights ? qMax(1, qCeil(pixelWidth)) : cHeights;
+
+    auto iter = _segmentProfiles.find(segment);
+    if (iter == _segmentProfiles.end()) {
+        connect(segment, &FlightPathSegment::amslTerrainHeightsChanged, this, &TerrainProfile::_segmentTerrainChanged);
+        connect(segment, &QObject::destroyed,                           this, &TerrainProfile::_segmentDestroyed);
+        iter = _segmentProfiles.insert(segment, SegmentProfile_t());
+        iter->columnCount = -1;
+    }
+    if (iter->columnCount != columnCount) {
+        _decimateTerrainHeights(segment, columnCount, *iter);
+    }
+
+    return *iter;
+}
+
+/// Reduces the terrain heights to at most a min and max height per pixel column. Keeping both extremes means peaks
+/// which cause terrain collisions are never dropped from the profile.
+void TerrainProfile::_decimateTerrainHeights(FlightPathSegment* segment, int columnCount, SegmentProfile_t& profile)
+{
+    const QVariantList& amslTerrainHeights  = segment->amslTerrainHeights();
+    int                 cHeights            = amslTerrainHeights.count();
+
+    profile.terrainPoints.clear();
+    profile.minTerrainHeight    = qQNaN();
+    profile.maxTerrainHeight    = qQNaN();
+    profile.columnCount         = columnCount;
+
+    if (cHeights == 0) {
+        return;
+    }
+
+    QVector<double> heights(cHeights);
+    for (int i=0; i<cHeights; i++) {
+        heights[i] = amslTerrainHeights[i].value<double>();
+        profile.minTerrainHeight = std::fmin(profile.minTerrainHeight, heights[i]);
+        profile.maxTerrainHeight = std::fmax(profile.maxTerrainHeight, heights[i]);
+    }
+
+    // The distance between all terrain heights except for the last is the same
+    auto distance = [segment, cHeights](int index) {
+        return index < cHeights - 1 ? index * segment->distanceBetween() : ((cHeights - 2) * segment->distanceBetween()) + segment->finalDistanceBetween();
+    };
+
+    if (cHeights <= (columnCount * 2) + 2) {
+        profile.terrainPoints.reserve(cHeights);
+        for (int i=0; i<cHeights; i++) {
+            profile.terrainPoints.append(QPointF(distance(i), heights[i]));
+        }
+        return;
+    }
+
+    profile.terrainPoints.reserve((columnCount * 2) + 2);
+    profile.terrainPoints.append(QPointF(0, heights[0]));
+
+    double  columnWidth     = segment->totalDistance() / columnCount;
+    int     currentColumn   = -1;
+    int     minIndex        = -1;
+    int     maxIndex        = -1;
+
+    auto addColumn = [&]() {
+        if (currentColumn != -1) {
+            int firstIndex  = qMin(minIndex, maxIndex);
+            int secondIndex = qMax(minIndex, maxIndex);
+            profile.terrainPoints.append(QPointF(distance(firstIndex), heights[firstIndex]));
+            if (secondIndex != firstIndex) {
+                profile.terrainPoints.append(QPointF(distance(secondIndex), heights[secondIndex]));
+            }
+        }
+    };
+
+    for (int i=1; i<cHeights-1; i++) {
+        int column = static_cast<int>(distance(i) / columnWidth);
+        if (column != currentColumn) {
+            addColumn();
+            currentColumn   = column;
+            minIndex        = i;
+            maxIndex        = i;
+        } else if (heights[i] < heights[minIndex]) {
+            minIndex = i;
+        } else if (heights[i] > heights[maxIndex]) {
+            maxIndex = i;
+        }
+    }
+    addColumn();
+
+    profile.terrainPoints.append(QPointF(distance(cHeights - 1), heights[cHeights - 1]));
+}
+
 void TerrainProfile::_createGeometry(QSGGeometryNode*& geometryNode, QSGGeometry*& geometry, QSGGeometry::DrawingMode drawingMode, const QColor& color)
 {
     QSGFlatColorMaterial* terrainMaterial = new QSGFlatColorMaterial;
@@ -76,10 +181,12 @@ void TerrainProfile::_createGeometry(QSGGeometryNode*& geometryNode, QSGGeometry
 
 void TerrainProfile::_updateSegmentCounts(FlightPathSegment* segment, int& cFlightProfileSegments, int& cTerrainProfilePoints, int& cMissingTerrainSegments, int& cTerrainCollisionSegments, double& minTerrainHeight, double& maxTerrainHeight)
 {
+    SegmentProfile_t profile = _segmentProfile(segment);
+
     if (_shouldAddFlightProfileSegment(segment)) {
         if (segment->segmentType() == FlightPathSegment::SegmentTypeTerrainFrame) {
             // We show a full above terrain profile for flight segment
-            cFlightProfileSegments += segment->amslTerrainHeights().count() - 1;
+            cFlightProfileSegments += profile.terrainPoints.count() - 1;
         } else {
             cFlightProfileSegments++;
         }
@@ -88,11 +195,9 @@ void TerrainProfile::_updateSegmentCounts(FlightPathSegment* segment, int& cFlig
     if (_shouldAddMissingTerrainSegment(segment)) {
         cMissingTerrainSegments += 1;
     } else {
-        cTerrainProfilePoints += segment->amslTerrainHeights().count();
-        for (int i=0; i<segment->amslTerrainHeights().count(); i++) {
-            minTerrainHeight = std::fmin(minTerrainHeight, segment->amslTerrainHeights()[i].value<double>());
-            maxTerrainHeight = std::fmax(maxTerrainHeight, segment->amslTerrainHeights()[i].value<double>());
-        }
+        cTerrainProfilePoints += profile.terrainPoints.count();
+        minTerrainHeight = std::fmin(minTerrainHeight, profile.minTerrainHeight);
+        maxTerrainHeight = std::fmax(maxTerrainHeight, profile.maxTerrainHeight);
     }
     if (segment->terrainCollision()) {
         cTerrainCollisionSegments++;
@@ -101,24 +206,13 @@ void TerrainProfile::_updateSegmentCounts(FlightPathSegment* segment, int& cFlig
 
 void TerrainProfile::_addTerrainProfileSegment(FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainVertices, int& terrainProfileVertexIndex)
 {
-    double terrainDistance = 0;
-    for (int heightIndex=0; heightIndex<segment->amslTerrainHeights().count(); heightIndex++) {
-        // Move along the x axis which is distance
-        if (heightIndex == 0) {
-            // The first point in the segment is at the position of the last point. So nothing to do here.
-        } else if (heightIndex == segment->amslTerrainHeights().count() - 2) {
-            // The distance between the last two heights differs with each terrain query
-            terrainDistance += segment->finalDistanceBetween();
-        } else {
-            // The distance between all terrain heights except for the last is the same
-            terrainDistance += segment->distanceBetween();
-        }
+    SegmentProfile_t profile = _segmentProfile(segment);
 
+    for (const QPointF& terrainPoint: profile.terrainPoints) {
         // Move along the y axis which is a view or terrain height as a percentage between the min/max AMSL altitude for all segments
-        double amslTerrainHeight    = segment->amslTerrainHeights()[heightIndex].value<double>();
-        double terrainHeightPercent = (amslTerrainHeight - _minAMSLAlt) / amslAltRange;
+        double terrainHeightPercent = (terrainPoint.y() - _minAMSLAlt) / amslAltRange;
 
-        float x = (currentDistance + terrainDistance) * _pixelsPerMeter;
+        float x = (currentDistance + terrainPoint.x()) * _pixelsPerMeter;
         float y = height() - (terrainHeightPercent * height());
         terrainVertices[terrainProfileVertexIndex++].set(x, y);
     }
@@ -161,34 +255,23 @@ void TerrainProfile::_addFlightProfileSegment(FlightPathSegment* segment, double
     }
 
     if (segment->segmentType() == FlightPathSegment::SegmentTypeTerrainFrame) {
-        double terrainDistance = 0;
-        double distanceToSurface = segment->coord1AMSLAlt() - segment->amslTerrainHeights().first().value<double>();
-        for (int heightIndex=0; heightIndex<segment->amslTerrainHeights().count(); heightIndex++) {
-            // Move along the x axis which is distance
-            if (heightIndex == 0) {
-                // The first point in the segment is at the position of the last point. So nothing to do here.
-            } else if (heightIndex == segment->amslTerrainHeights().count() - 2) {
-                // The distance between the last two heights differs with each terrain query
-                terrainDistance += segment->finalDistanceBetween();
-            } else {
-                // The distance between all terrain heights except for the last is the same
-                terrainDistance += segment->distanceBetween();
-            }
-
-            if (heightIndex > 1) {
+        SegmentProfile_t    profile             = _segmentProfile(segment);
+        double              distanceToSurface   = segment->coord1AMSLAlt() - segment->amslTerrainHeights().first().value<double>();
+        for (int pointIndex=0; pointIndex<profile.terrainPoints.count(); pointIndex++) {
+            if (pointIndex > 1) {
                 // Add first coord of segment
                 auto previousVertex = flightProfileVertices[flightProfileVertexIndex-1];
                 flightProfileVertices[flightProfileVertexIndex++].set(previousVertex.x, previousVertex.y);
             }
 
             // Add second coord of segment (or very first one)
-            double amslTerrainHeight    = segment->amslTerrainHeights()[heightIndex].value<double>() + distanceToSurface;
-            double terrainHeightPercent = (amslTerrainHeight - _minAMSLAlt) / amslAltRange;
+            const QPointF&  terrainPoint            = profile.terrainPoints[pointIndex];
+            double          amslTerrainHeight       = terrainPoint.y() + distanceToSurface;
+            double          terrainHeightPercent    = (amslTerrainHeight - _minAMSLAlt) / amslAltRange;
 
-            float x = (currentDistance + terrainDistance) * _pixelsPerMeter;
+            float x = (currentDistance + terrainPoint.x()) * _pixelsPerMeter;
             float y = height() - (terrainHeightPercent * height());
             flightProfileVertices[flightProfileVertexIndex++].set(x, y);
-
         }
     } else {
         double amslCoord1Height =       segment->coord1AMSLAlt();
@@ -229,6 +312,9 @@ QSGNode* TerrainProfile::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePai
     //  - how many terrain collision segments there are
     //  - what is the total distance so we can calculate pixels per meter
 
+    // Segment profiles are decimated to the pixel width of the segment, so pixels per meter must be known up front
+    _pixelsPerMeter = _visibleWidth / _missionController->missionDistance();
+
     for (int viIndex=0; viIndex<_visualItems->count(); viIndex++) {
         VisualMissionItem*  visualItem =    _visualItems->value<VisualMissionItem*>(viIndex);
         ComplexMissionItem* complexItem =   _visualItems->value<ComplexMissionItem*>(viIndex);
@@ -265,8 +351,6 @@ QSGNode* TerrainProfile::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePai
     qCDebug(TerrainProfileLog) << QStringLiteral("updatePaintNode counter:%1 cFlightProfileSegments:%2 cTerrainProfilePoints:%3 cMissingTerrainSegments:%4 cTerrainCollisionSegments:%5 _minAMSLAlt:%6 _maxAMSLAlt:%7 maxTerrainHeight:%8")
                                   .arg(counter++).arg(cFlightProfileSegments).arg(cTerrainProfilePoints).arg(cMissingTerrainSegments).arg(cTerrainCollisionSegments).arg(_minAMSLAlt).arg(_maxAMSLAlt).arg(maxTerrainHeight);
 
-    _pixelsPerMeter = _visibleWidth / _missionController->missionDistance();
-
     // Instantiate nodes
     if (!rootNode) {
         rootNode = new QSGNode;
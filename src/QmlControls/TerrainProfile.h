@@ -13,6 +13,9 @@
 #include <QTimer>
 #include <QSGGeometryNode>
 #include <QSGGeometry>
+#include <QHash>
+#include <QVector>
+#include <QPointF>
 
 #include "QGCLoggingCategory.h"
 
@@ -55,8 +58,20 @@ signals:
 
 private slots:
     void _newVisualItems            (void);
+    void _segmentTerrainChanged     (void);
+    void _segmentDestroyed          (QObject* segment);
 
 private:
+    /// Terrain profile for a single segment, decimated to the on-screen width of the segment
+    typedef struct {
+        QVector<QPointF>    terrainPoints;      ///< x: distance from segment start in meters, y: AMSL terrain height
+        double              minTerrainHeight;
+        double              maxTerrainHeight;
+        int                 columnCount;        ///< Pixel width the points were decimated to
+    } SegmentProfile_t;
+
+    const SegmentProfile_t& _segmentProfile (FlightPathSegment* segment);
+    static void _decimateTerrainHeights     (FlightPathSegment* segment, int columnCount, SegmentProfile_t& profile);
     void    _createGeometry                 (QSGGeometryNode*& geometryNode, QSGGeometry*& geometry, QSGGeometry::DrawingMode drawingMode, const QColor& color);
     void    _updateSegmentCounts            (FlightPathSegment* segment, int& cFlightProfileSegments, int& cTerrainPoints, int& cMissingTerrainSegments, int& cTerrainCollisionSegments, double& minTerrainHeight, double& maxTerrainHeight);
     void    _addTerrainProfileSegment       (FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainProfileVertices, int& terrainVertexIndex);
@@ -73,6 +88,8 @@ private:
     double              _minAMSLAlt =           0;
     double              _maxAMSLAlt =           0;
 
+    QHash<FlightPathSegment*, SegmentProfile_t> _segmentProfiles;   ///< Only recalculated when segment terrain or pixel width changes
+
     static const int _lineWidth =       7;
 
     Q_DISABLE_COPY(TerrainProfile)
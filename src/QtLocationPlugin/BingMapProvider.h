@@ -22,6 +22,10 @@ public:
 
     bool _isBingProvider() const override { return true; }
 
+    QString downloadGroup       () const override { return QStringLiteral("Bing"); }
+    int     concurrentDownloads () const override { return 8; }
+    double  maxRequestsPerSecond() const override { return 20; }
+
 
 protected:
     const QString _versionBingMaps = QStringLiteral("563");
@@ -9,6 +9,13 @@
 ElevationProvider::ElevationProvider(const QString& imageFormat, quint32 averageSize, QGeoMapType::MapStyle mapType, QObject* parent)
     : MapProvider(QStringLiteral("https://api.airmap.com/"), imageFormat, averageSize, mapType, parent) {}
 
+QByteArray ElevationProvider::serializeTile(const QByteArray& response) const {
+    if (TerrainTile::isSerializedTile(response)) {
+        return response;
+    }
+    return TerrainTile::serializeFromAirMapJson(response);
+}
+
 //-----------------------------------------------------------------------------
 int AirmapElevationProvider::long2tileX(const double lon, const int z) const {
     Q_UNUSED(z)
@@ -19,6 +19,15 @@ class ElevationProvider : public MapProvider {
                       QGeoMapType::MapStyle mapType, QObject* parent = nullptr);
 
     virtual bool _isElevationProvider() const override { return true; }
+
+    /// Converts a downloaded response to the TerrainTile binary layout which is cached. The default reads AirMap carpet
+    /// json and passes responses which already are in the binary layout straight through. Providers whose backend
+    /// offers a binary elevation format override this to convert it without going through json.
+    virtual QByteArray serializeTile(const QByteArray& response) const;
+
+    QString downloadGroup       () const override { return QStringLiteral("Elevation"); }
+    int     concurrentDownloads () const override { return 4; }
+    double  maxRequestsPerSecond() const override { return 5; }
 };
 
 // -----------------------------------------------------------
@@ -18,6 +18,9 @@ class EsriMapProvider : public MapProvider {
     EsriMapProvider(const quint32 averageSize, const QGeoMapType::MapStyle mapType, QObject* parent = nullptr);
 
     QNetworkRequest getTileURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) override;
+
+    QString downloadGroup       () const override { return QStringLiteral("Esri"); }
+    double  maxRequestsPerSecond() const override { return 30; }
 };
 
 class EsriWorldStreetMapProvider : public EsriMapProvider {
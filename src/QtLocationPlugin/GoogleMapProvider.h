@@ -23,6 +23,10 @@ public:
 
     ~GoogleMapProvider();
 
+    QString downloadGroup       () const override { return QStringLiteral("Google"); }
+    int     concurrentDownloads () const override { return 6; }
+    double  maxRequestsPerSecond() const override { return 10; }
+
     // Google Specific private slots
 private slots:
     void _networkReplyError(QNetworkReply::NetworkError error);
@@ -25,6 +25,7 @@ static const quint32 AVERAGE_TILE_SIZE = 13652;
 
 class QNetworkRequest;
 class QNetworkAccessManager;
+class QGCTileArchive;
 
 class MapProvider : public QObject {
     Q_OBJECT
@@ -47,6 +48,14 @@ public:
 
     virtual bool _isElevationProvider() const { return false; }
     virtual bool _isBingProvider() const { return false; }
+    // Tiles of providers with an archive are read from it, never downloaded or cached
+    virtual QGCTileArchive* tileArchive() const { return nullptr; }
+
+    // Offline download limits. Providers in the same download group share their
+    // servers, so they also share one rate limit.
+    virtual QString downloadGroup       () const { return QStringLiteral("Generic"); }
+    virtual int     concurrentDownloads () const { return 12; }
+    virtual double  maxRequestsPerSecond() const { return 0; }  ///< 0: No limit
 
     virtual QGCTileSet getTileCount(const int zoom, const double topleftLon,
                                      const double topleftLat, const double bottomRightLon,
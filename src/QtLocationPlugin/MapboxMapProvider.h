@@ -20,6 +20,9 @@ class MapboxMapProvider : public MapProvider {
 public:
     MapboxMapProvider(const QString& mapName, const quint32 averageSize, const QGeoMapType::MapStyle mapType, QObject* parent = nullptr);
 
+    QString downloadGroup       () const override { return QStringLiteral("Mapbox"); }
+    int     concurrentDownloads () const override { return 16; }
+
 protected:
     QString _getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) override;
 
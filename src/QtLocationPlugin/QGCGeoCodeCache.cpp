@@ -0,0 +1,438 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCGeoCodeCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtPositioning/QGeoAddress>
+#include <QtPositioning/QGeoRectangle>
+#include <QDebug>
+
+#include <cmath>
+
+static const int        kCacheVersion   = 1;
+static const char*      kVersionKey     = "version";
+static const char*      kPlacesKey      = "places";
+static const char*      kQueriesKey     = "queries";
+static const char*      kReverseKey     = "reverse";
+static const char*      kGazetteersKey  = "gazetteers";
+
+//-----------------------------------------------------------------------------
+static QJsonObject
+placeToJson(const QGeoLocation& location)
+{
+    const QGeoAddress& address = location.address();
+    QJsonObject json;
+    json["text"]        = address.text();
+    json["street"]      = address.street();
+    json["district"]    = address.district();
+    json["city"]        = address.city();
+    json["county"]      = address.county();
+    json["state"]       = address.state();
+    json["country"]     = address.country();
+    json["countryCode"] = address.countryCode();
+    json["postalCode"]  = address.postalCode();
+    json["lat"]         = location.coordinate().latitude();
+    json["lon"]         = location.coordinate().longitude();
+    const QGeoRectangle& bounds = location.boundingBox();
+    if(bounds.isValid()) {
+        json["bounds"] = QJsonArray({ bounds.topLeft().latitude(), bounds.topLeft().longitude(), bounds.bottomRight().latitude(), bounds.bottomRight().longitude() });
+    }
+    return json;
+}
+
+//-----------------------------------------------------------------------------
+static QGeoLocation
+placeFromJson(const QJsonObject& json)
+{
+    QGeoAddress address;
+    address.setText         (json["text"].toString());
+    address.setStreet       (json["street"].toString());
+    address.setDistrict     (json["district"].toString());
+    address.setCity         (json["city"].toString());
+    address.setCounty       (json["county"].toString());
+    address.setState        (json["state"].toString());
+    address.setCountry      (json["country"].toString());
+    address.setCountryCode  (json["countryCode"].toString());
+    address.setPostalCode   (json["postalCode"].toString());
+    QGeoLocation location;
+    location.setAddress(address);
+    location.setCoordinate(QGeoCoordinate(json["lat"].toDouble(), json["lon"].toDouble()));
+    const QJsonArray bounds = json["bounds"].toArray();
+    if(bounds.count() == 4) {
+        location.setBoundingBox(QGeoRectangle(QGeoCoordinate(bounds[0].toDouble(), bounds[1].toDouble()), QGeoCoordinate(bounds[2].toDouble(), bounds[3].toDouble())));
+    }
+    return location;
+}
+
+//-----------------------------------------------------------------------------
+static QJsonArray
+indicesToJson(const QVector<int>& indices)
+{
+    QJsonArray json;
+    for(int index: indices) {
+        json.append(index);
+    }
+    return json;
+}
+
+//-----------------------------------------------------------------------------
+static QVector<int>
+indicesFromJson(const QJsonArray& json, const QVector<int>& remap)
+{
+    QVector<int> indices;
+    for(const QJsonValue& value: json) {
+        const int index = value.toInt(-1);
+        if(index >= 0 && index < remap.count() && remap[index] >= 0) {
+            indices.append(remap[index]);
+        }
+    }
+    return indices;
+}
+
+//-----------------------------------------------------------------------------
+QGCGeoCodeCache::QGCGeoCodeCache(const QString& fileName, QObject* parent)
+    : QObject(parent)
+    , _fileName(fileName)
+{
+    _saveTimer.setSingleShot(true);
+    _saveTimer.setInterval(_saveDelayMSecs);
+    connect(&_saveTimer, &QTimer::timeout, this, &QGCGeoCodeCache::_save);
+    _load();
+}
+
+//-----------------------------------------------------------------------------
+QGCGeoCodeCache::~QGCGeoCodeCache()
+{
+    if(_saveTimer.isActive()) {
+        _save();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCGeoCodeCache::_normalize(const QString& text)
+{
+    QString normalized = text.toLower();
+    for(QChar& c: normalized) {
+        if(!c.isLetterOrNumber()) {
+            c = QLatin1Char(' ');
+        }
+    }
+    return normalized.simplified();
+}
+
+//-----------------------------------------------------------------------------
+quint64
+QGCGeoCodeCache::_gridCell(double latitude, double longitude)
+{
+    const quint64 row = static_cast<quint64>(std::floor((latitude  + 90.0)  / _gridCellDegrees));
+    const quint64 col = static_cast<quint64>(std::floor((longitude + 180.0) / _gridCellDegrees));
+    return (row << 32) | col;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCGeoCodeCache::find(const QString& query, int limit, QList<QGeoLocation>& locations)
+{
+    const QString key = _normalize(query);
+    if(key.isEmpty()) {
+        return false;
+    }
+    auto it = _queries.constFind(key);
+    if(it != _queries.constEnd()) {
+        locations = _locations(it.value(), limit);
+        return !locations.isEmpty();
+    }
+    if(key.length() < _minPrefixLength) {
+        return false;
+    }
+    QVector<int> places;
+    for(auto name = _nameIndex.lowerBound(key); name != _nameIndex.end() && name.key().startsWith(key); ++name) {
+        if(!places.contains(name.value())) {
+            places.append(name.value());
+        }
+        if(limit > 0 && places.count() >= limit) {
+            break;
+        }
+    }
+    locations = _locations(places, limit);
+    return !locations.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCGeoCodeCache::findReverse(const QGeoCoordinate& coordinate, QList<QGeoLocation>& locations)
+{
+    const ReverseEntry_t* closest = nullptr;
+    double closestDistance = _reverseRadiusMeters;
+    for(int dLat = -1; dLat <= 1; dLat++) {
+        for(int dLon = -1; dLon <= 1; dLon++) {
+            const quint64 cell = _gridCell(coordinate.latitude() + dLat * _gridCellDegrees, coordinate.longitude() + dLon * _gridCellDegrees);
+            for(int index: _reverseGrid.value(cell)) {
+                const double distance = _reverse[index].coordinate.distanceTo(coordinate);
+                if(distance <= closestDistance) {
+                    closest         = &_reverse[index];
+                    closestDistance = distance;
+                }
+            }
+        }
+    }
+    if(!closest) {
+        return false;
+    }
+    locations = _locations(closest->places, -1);
+    return !locations.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::insert(const QString& query, const QList<QGeoLocation>& locations)
+{
+    const QString key = _normalize(query);
+    if(key.isEmpty() || locations.isEmpty()) {
+        return;
+    }
+    if(!_queries.contains(key) && _queries.count() >= _maxQueries) {
+        _queries.erase(_queries.begin());
+    }
+    _queries[key] = _addPlaces(locations);
+    _setDirty();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::insertReverse(const QGeoCoordinate& coordinate, const QList<QGeoLocation>& locations)
+{
+    if(!coordinate.isValid() || locations.isEmpty()) {
+        return;
+    }
+    if(_reverse.count() >= _maxQueries) {
+        qWarning() << "Geocode cache: reverse lookup limit reached";
+        return;
+    }
+    _addReverse({ coordinate, _addPlaces(locations) });
+    _setDirty();
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCGeoCodeCache::importGazetteer(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Geocode cache: unable to open gazetteer" << fileName << file.errorString();
+        return 0;
+    }
+    const QString path      = QFileInfo(fileName).absoluteFilePath();
+    const qint64  modified  = QFileInfo(fileName).lastModified().toMSecsSinceEpoch();
+    if(_gazetteers.value(path, -1) == modified) {
+        return 0;
+    }
+
+    int count = 0;
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while(!stream.atEnd()) {
+        const QStringList columns = stream.readLine().split(QLatin1Char('\t'));
+        QString name;
+        QString countryCode;
+        bool    latOk = false;
+        bool    lonOk = false;
+        double  lat = 0;
+        double  lon = 0;
+        if(columns.count() >= 9) {
+            //-- GeoNames: id, name, ascii name, alternate names, lat, lon, feature class, feature code, country code, ...
+            name        = columns[1];
+            lat         = columns[4].toDouble(&latOk);
+            lon         = columns[5].toDouble(&lonOk);
+            countryCode = columns[8];
+        } else if(columns.count() >= 3) {
+            name        = columns[0];
+            lat         = columns[1].toDouble(&latOk);
+            lon         = columns[2].toDouble(&lonOk);
+        }
+        if(name.isEmpty() || !latOk || !lonOk) {
+            continue;
+        }
+        QGeoAddress address;
+        address.setText(countryCode.isEmpty() ? name : QStringLiteral("%1, %2").arg(name, countryCode));
+        address.setCity(name);
+        address.setCountryCode(countryCode);
+        QGeoLocation location;
+        location.setAddress(address);
+        location.setCoordinate(QGeoCoordinate(lat, lon));
+        if(_addPlace(location) < 0) {
+            break;
+        }
+        count++;
+    }
+    _gazetteers[path] = modified;
+    _setDirty();
+    qDebug() << "Geocode cache: imported" << count << "places from" << fileName;
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCGeoCodeCache::_addPlace(const QGeoLocation& location)
+{
+    const QString name = _normalize(location.address().text());
+    const QString key  = QStringLiteral("%1|%2|%3").arg(name).arg(location.coordinate().latitude(), 0, 'f', 4).arg(location.coordinate().longitude(), 0, 'f', 4);
+    auto it = _placeKeys.constFind(key);
+    if(it != _placeKeys.constEnd()) {
+        return it.value();
+    }
+    if(_places.count() >= _maxPlaces) {
+        qWarning() << "Geocode cache: place limit reached";
+        return -1;
+    }
+    const int index = _places.count();
+    _places.append(location);
+    _placeKeys[key] = index;
+    if(!name.isEmpty()) {
+        _nameIndex.insert(name, index);
+    }
+    return index;
+}
+
+//-----------------------------------------------------------------------------
+QVector<int>
+QGCGeoCodeCache::_addPlaces(const QList<QGeoLocation>& locations)
+{
+    QVector<int> places;
+    for(const QGeoLocation& location: locations) {
+        const int index = _addPlace(location);
+        if(index >= 0) {
+            places.append(index);
+        }
+    }
+    return places;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::_addReverse(const ReverseEntry_t& entry)
+{
+    _reverseGrid[_gridCell(entry.coordinate.latitude(), entry.coordinate.longitude())].append(_reverse.count());
+    _reverse.append(entry);
+}
+
+//-----------------------------------------------------------------------------
+QList<QGeoLocation>
+QGCGeoCodeCache::_locations(const QVector<int>& places, int limit) const
+{
+    QList<QGeoLocation> locations;
+    for(int index: places) {
+        if(limit > 0 && locations.count() >= limit) {
+            break;
+        }
+        locations.append(_places[index]);
+    }
+    return locations;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::_setDirty()
+{
+    if(!_saveTimer.isActive()) {
+        _saveTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::_load()
+{
+    QFile file(_fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if(json[kVersionKey].toInt() != kCacheVersion) {
+        qDebug() << "Geocode cache: ignoring" << _fileName;
+        return;
+    }
+
+    //-- Indices are stored, they only change if the file was edited
+    const QJsonArray jsonPlaces = json[kPlacesKey].toArray();
+    QVector<int> remap;
+    remap.reserve(jsonPlaces.count());
+    for(const QJsonValue& place: jsonPlaces) {
+        remap.append(_addPlace(placeFromJson(place.toObject())));
+    }
+    const QJsonObject queries = json[kQueriesKey].toObject();
+    for(auto it = queries.constBegin(); it != queries.constEnd(); ++it) {
+        _queries[it.key()] = indicesFromJson(it.value().toArray(), remap);
+    }
+    for(const QJsonValue& value: json[kReverseKey].toArray()) {
+        const QJsonObject reverse = value.toObject();
+        _addReverse({ QGeoCoordinate(reverse["lat"].toDouble(), reverse["lon"].toDouble()), indicesFromJson(reverse[kPlacesKey].toArray(), remap) });
+    }
+    const QJsonObject gazetteers = json[kGazetteersKey].toObject();
+    for(auto it = gazetteers.constBegin(); it != gazetteers.constEnd(); ++it) {
+        _gazetteers[it.key()] = static_cast<qint64>(it.value().toDouble());
+    }
+    qDebug() << "Geocode cache:" << _places.count() << "places" << _queries.count() << "queries" << _reverse.count() << "reverse lookups";
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCGeoCodeCache::_save()
+{
+    _saveTimer.stop();
+    if(_fileName.isEmpty()) {
+        return;
+    }
+
+    QJsonArray places;
+    for(const QGeoLocation& location: _places) {
+        places.append(placeToJson(location));
+    }
+    QJsonObject queries;
+    for(auto it = _queries.constBegin(); it != _queries.constEnd(); ++it) {
+        queries[it.key()] = indicesToJson(it.value());
+    }
+    QJsonArray reverse;
+    for(const ReverseEntry_t& entry: _reverse) {
+        QJsonObject json;
+        json["lat"]         = entry.coordinate.latitude();
+        json["lon"]         = entry.coordinate.longitude();
+        json[kPlacesKey]    = indicesToJson(entry.places);
+        reverse.append(json);
+    }
+    QJsonObject gazetteers;
+    for(auto it = _gazetteers.constBegin(); it != _gazetteers.constEnd(); ++it) {
+        gazetteers[it.key()] = static_cast<double>(it.value());
+    }
+
+    QJsonObject json;
+    json[kVersionKey]       = kCacheVersion;
+    json[kPlacesKey]        = places;
+    json[kQueriesKey]       = queries;
+    json[kReverseKey]       = reverse;
+    json[kGazetteersKey]    = gazetteers;
+
+    QSaveFile file(_fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Geocode cache: unable to save" << _fileName << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    if(!file.commit()) {
+        qWarning() << "Geocode cache: unable to save" << _fileName << file.errorString();
+    }
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMultiMap>
+#include <QVector>
+#include <QTimer>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtPositioning/QGeoLocation>
+
+//-----------------------------------------------------------------------------
+// Persistent cache of geocoding results, so places which were looked up once are
+// found again instantly and without a network connection.
+// Forward queries are answered from the exact query first, then from a sorted
+// index of place names which is searched by prefix. Reverse queries are answered
+// from a grid of previous reverse lookups. Places can also be imported from a
+// gazetteer file (GeoNames dump or "name<TAB>lat<TAB>lon" lines). Main thread only.
+class QGCGeoCodeCache : public QObject
+{
+    Q_OBJECT
+public:
+    QGCGeoCodeCache     (const QString& fileName, QObject* parent = nullptr);
+    ~QGCGeoCodeCache    ();
+
+    /// @return true if cached places match the query
+    bool    find            (const QString& query, int limit, QList<QGeoLocation>& locations);
+    /// @return true if a reverse lookup close to the coordinate is cached
+    bool    findReverse     (const QGeoCoordinate& coordinate, QList<QGeoLocation>& locations);
+
+    void    insert          (const QString& query, const QList<QGeoLocation>& locations);
+    void    insertReverse   (const QGeoCoordinate& coordinate, const QList<QGeoLocation>& locations);
+
+    /// Adds the places of a gazetteer file, a file which was already imported is skipped unless it changed
+    /// @return Number of places imported
+    int     importGazetteer (const QString& fileName);
+
+private slots:
+    void    _save           ();
+
+private:
+    typedef struct {
+        QGeoCoordinate  coordinate;
+        QVector<int>    places;
+    } ReverseEntry_t;
+
+    void            _load           ();
+    int             _addPlace       (const QGeoLocation& location);
+    QVector<int>    _addPlaces      (const QList<QGeoLocation>& locations);
+    void            _addReverse     (const ReverseEntry_t& entry);
+    void            _setDirty       ();
+    QList<QGeoLocation> _locations  (const QVector<int>& places, int limit) const;
+
+    static QString  _normalize      (const QString& text);
+    static quint64  _gridCell       (double latitude, double longitude);
+
+    QString                         _fileName;
+    QVector<QGeoLocation>           _places;
+    QHash<QString, int>             _placeKeys;     ///< Name and rounded position, to store each place once
+    QHash<QString, QVector<int>>    _queries;       ///< Normalized forward query to places
+    QMultiMap<QString, int>         _nameIndex;     ///< Normalized place name to place, sorted for prefix search
+    QVector<ReverseEntry_t>         _reverse;
+    QHash<quint64, QVector<int>>    _reverseGrid;   ///< Grid cell to _reverse entries
+    QHash<QString, qint64>          _gazetteers;    ///< Imported file to its modification time
+    QTimer                          _saveTimer;
+
+    static const int    _maxPlaces          = 200000;
+    static const int    _maxQueries         = 5000;
+    static const int    _minPrefixLength    = 3;
+    static const int    _saveDelayMSecs     = 5000;
+    static constexpr double _gridCellDegrees        = 0.01;     ///< About 1km
+    static constexpr double _reverseRadiusMeters    = 100.0;
+};
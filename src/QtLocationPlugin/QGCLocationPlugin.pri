@@ -12,11 +12,15 @@ QT  += location-private positioning-private network
 INCLUDEPATH += $$QT.location.includes
 
 HEADERS += \
+    $$PWD/QGCGeoCodeCache.h \
     $$PWD/QGCMapEngine.h \
     $$PWD/QGCMapEngineData.h \
     $$PWD/QGCMapTileSet.h \
     $$PWD/QGCMapUrlEngine.h \
     $$PWD/QGCTileCacheWorker.h \
+    $$PWD/QGCTileMemoryCache.h \
+    $$PWD/QGCTileArchive.h \
+    $$PWD/QGCTileTranscoder.h \
     $$PWD/QGeoCodeReplyQGC.h \
     $$PWD/QGeoCodingManagerEngineQGC.h \
     $$PWD/QGeoMapReplyQGC.h \
@@ -30,14 +34,19 @@ HEADERS += \
     $$PWD/GenericMapProvider.h \
     $$PWD/EsriMapProvider.h \
     $$PWD/MapboxMapProvider.h \
+    $$PWD/TileArchiveMapProvider.h \
     $$PWD/QGCTileSet.h \
 
 
 SOURCES += \
+    $$PWD/QGCGeoCodeCache.cpp \
     $$PWD/QGCMapEngine.cpp \
     $$PWD/QGCMapTileSet.cpp \
     $$PWD/QGCMapUrlEngine.cpp \
     $$PWD/QGCTileCacheWorker.cpp \
+    $$PWD/QGCTileMemoryCache.cpp \
+    $$PWD/QGCTileArchive.cpp \
+    $$PWD/QGCTileTranscoder.cpp \
     $$PWD/QGeoCodeReplyQGC.cpp \
     $$PWD/QGeoCodingManagerEngineQGC.cpp \
     $$PWD/QGeoMapReplyQGC.cpp \
@@ -51,6 +60,7 @@ SOURCES += \
     $$PWD/GenericMapProvider.cpp \
     $$PWD/EsriMapProvider.cpp \
     $$PWD/MapboxMapProvider.cpp \
+    $$PWD/TileArchiveMapProvider.cpp \
 
 OTHER_FILES += \
     $$PWD/qgc_maps_plugin.json
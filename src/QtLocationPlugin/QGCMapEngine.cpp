@@ -23,10 +23,15 @@
 #include <QSettings>
 #include <QStandardPaths>
 #include <QDir>
+#include <QDateTime>
+#include <QSet>
+#include <QtAlgorithms>
+#include <QtConcurrent>
 #include <stdio.h>
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTileTranscoder.h"
 
 Q_DECLARE_METATYPE(QGCMapTask::TaskType)
 Q_DECLARE_METATYPE(QGCTile)
@@ -44,6 +49,10 @@ struct stQGeoTileCacheQGCMapTypes {
 
 static const char* kMaxDiskCacheKey = "MaxDiskCache";
 static const char* kMaxMemCacheKey  = "MaxMemoryCache";
+static const char* kTerrainRetentionDaysKey = "TerrainRetentionDays";
+static const char* kTileStorageFormatKey = "TileStorageFormat";
+static const char* kTileStorageQualityKey = "TileStorageQuality";
+static const char* kOfflineDownloadsGroup = "OfflineDownloads";
 
 //-----------------------------------------------------------------------------
 // Singleton
@@ -86,6 +95,9 @@ QGCMapEngine::QGCMapEngine()
     #endif
 #endif
     , _maxDiskCache(0)
+    , _terrainRetentionDays(UINT32_MAX)
+    , _tileStorageFormatLoaded(false)
+    , _tileStorageQuality(0)
     , _maxMemCache(0)
     , _prunning(false)
     , _cacheWasReset(false)
@@ -96,11 +108,14 @@ QGCMapEngine::QGCMapEngine()
     qRegisterMetaType<QList<QGCTile*>>();
     connect(&_worker, &QGCCacheWorker::updateTotals,   this, &QGCMapEngine::_updateTotals);
     connect(&_worker, &QGCCacheWorker::internetStatus, this, &QGCMapEngine::_internetStatus);
+    _updateMemoryCacheSize();
+    _downloadClock.start();
 }
 
 //-----------------------------------------------------------------------------
 QGCMapEngine::~QGCMapEngine()
 {
+    _transcodePool.waitForDone();
     _worker.quit();
     _worker.wait();
     delete _urlFactory;
@@ -167,6 +182,8 @@ QGCMapEngine::init()
     }
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
+    //-- Basemap files are picked up at start, before any map asks for the list of map types
+    _urlFactory->registerTileArchives(qgcApp()->toolbox()->settingsManager()->appSettings()->basemapSavePath());
 }
 
 //-----------------------------------------------------------------------------
@@ -195,6 +212,13 @@ QGCMapEngine::_wipeDirectory(const QString& dirPath)
 void
 QGCMapEngine::addTask(QGCMapTask* task)
 {
+    //-- Tiles served from memory must not outlive the database they came from
+    if(task->type() == QGCMapTask::taskReset || task->type() == QGCMapTask::taskImport) {
+        _memoryCache.clear();
+    }
+    if(task->type() == QGCMapTask::taskImport) {
+        static_cast<QGCImportTileTask*>(task)->setTileStorage(getTileStorageFormat(), static_cast<int>(getTileStorageQuality()));
+    }
     _worker.enqueueTask(task);
 }
 
@@ -202,44 +226,125 @@ QGCMapEngine::addTask(QGCMapTask* task)
 void
 QGCMapEngine::cacheTile(QString type, int x, int y, int z, const QByteArray& image, const QString &format, qulonglong set)
 {
-    QString hash = getTileHash(type, x, y, z);
-    cacheTile(type, hash, image, format, set);
+    cacheTile(type, getTileKey(type, x, y, z), image, format, set);
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCMapEngine::cacheTile(QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set)
+QGCMapEngine::cacheTile(QString type, quint64 key, const QByteArray& image, const QString& format, qulonglong set, QGCMapTask* afterSave)
 {
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
     //-- If we are allowed to persist data, save tile to cache
-    if(!appSettings->disableAllPersistence()->rawValue().toBool()) {
-        QGCSaveTileTask* task = new QGCSaveTileTask(new QGCCacheTile(hash, image, format, type, set));
-        _worker.enqueueTask(task);
+    if(appSettings->disableAllPersistence()->rawValue().toBool()) {
+        if(afterSave) {
+            _worker.enqueueTask(afterSave);
+        }
+        return;
     }
+    QString storageFormat = getTileStorageFormat();
+    if(storageFormat.isEmpty() || urlFactory()->isElevation(urlFactory()->getIdFromType(type))) {
+        _worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(key, image, format, type, set)));
+        if(afterSave) {
+            _worker.enqueueTask(afterSave);
+        }
+        return;
+    }
+    //-- Encoding is too slow for the main thread and would hold up the cache worker, so it runs on its own pool.
+    //   The tasks are queued from the main thread again, in order, once the tile is ready.
+    int quality = static_cast<int>(getTileStorageQuality());
+    QGCMapTask* after = afterSave;
+    QtConcurrent::run(&_transcodePool, [this, type, key, image, format, set, after, storageFormat, quality]() {
+        QByteArray  storedImage  = image;
+        QString     storedFormat = format;
+        QGCTileTranscoder::transcode(storedImage, storedFormat, storageFormat, quality);
+        QMetaObject::invokeMethod(this, [this, type, key, storedImage, storedFormat, set, after]() {
+            _worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(key, storedImage, storedFormat, type, set)));
+            if(after) {
+                _worker.enqueueTask(after);
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
 //-----------------------------------------------------------------------------
-QString
-QGCMapEngine::getTileHash(QString type, int x, int y, int z)
+//-- A tile key packs the map type and tile position in 63 bits, so it is also a
+//   valid SQLite INTEGER PRIMARY KEY. Bits 0 to 46 hold the position as
+//   1 << 2z | y << z | x: the highest bit set gives the zoom and x and y take z
+//   bits each, which fits up to MAX_MAP_ZOOM. Bits 47 to 62 hold the map type id
+//   folded to 16 bits, the UrlFactory makes sure registered types don't share one.
+quint64
+QGCMapEngine::getTileKey(QString type, int x, int y, int z)
 {
-    return QString::asprintf("%010d%08d%08d%03d", getQGCMapEngine()->urlFactory()->getIdFromType(type), x, y, z);
+    return getTileKey(getQGCMapEngine()->urlFactory()->getIdFromType(type), x, y, z);
 }
 
 //-----------------------------------------------------------------------------
-QString
-QGCMapEngine::hashToType(const QString& hash)
+quint64
+QGCMapEngine::getTileKey(int mapId, int x, int y, int z)
+{
+    const quint64 mask = (Q_UINT64_C(1) << z) - 1;
+    return (static_cast<quint64>(tileKeyType(mapId)) << _tileKeyTypeShift) |
+           (Q_UINT64_C(1) << (2 * z)) |
+           ((static_cast<quint64>(y) & mask) << z) |
+           (static_cast<quint64>(x) & mask);
+}
+
+//-----------------------------------------------------------------------------
+quint32
+QGCMapEngine::tileKeyType(int mapId)
+{
+    const quint32 id = static_cast<quint32>(mapId);
+    return (id ^ (id >> 16)) & 0xFFFF;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::tileKeyZ(quint64 key)
+{
+    const quint64 position = key & ((Q_UINT64_C(1) << _tileKeyTypeShift) - 1);
+    return position ? (63 - static_cast<int>(qCountLeadingZeroBits(position))) / 2 : 0;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::tileKeyX(quint64 key)
+{
+    return static_cast<int>(key & ((Q_UINT64_C(1) << tileKeyZ(key)) - 1));
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::tileKeyY(quint64 key)
 {
-    QString type = hash.mid(0,10);
-    return urlFactory()->getTypeFromId(type.toInt());
+    const int z = tileKeyZ(key);
+    return static_cast<int>((key >> z) & ((Q_UINT64_C(1) << z) - 1));
 }
 
 //-----------------------------------------------------------------------------
-	QGCFetchTileTask*
+//-- Hash layout is: type (10) x (8) y (8) z (3)
+bool
+QGCMapEngine::legacyHashToKey(const QString& hash, quint64& key, int& mapId)
+{
+    if(hash.length() != 29) {
+        return false;
+    }
+    bool okId, okX, okY, okZ;
+    mapId = hash.midRef(0, 10).toInt(&okId);
+    int x = hash.midRef(10, 8).toInt(&okX);
+    int y = hash.midRef(18, 8).toInt(&okY);
+    int z = hash.midRef(26, 3).toInt(&okZ);
+    if(!okId || !okX || !okY || !okZ || z < 0 || z > MAX_MAP_ZOOM || x < 0 || y < 0 || x >= (1 << z) || y >= (1 << z)) {
+        return false;
+    }
+    key = getTileKey(mapId, x, y, z);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+QGCFetchTileTask*
 QGCMapEngine::createFetchTileTask(QString type, int x, int y, int z)
 {
-	QString hash = getTileHash(type, x, y, z);
-	QGCFetchTileTask* task = new QGCFetchTileTask(hash);
-	return task;
+    return new QGCFetchTileTask(getTileKey(type, x, y, z), type);
 }
 
 //-----------------------------------------------------------------------------
@@ -252,6 +357,54 @@ QGCMapEngine::getTileCount(int zoom, double topleftLon, double topleftLat, doubl
     return getQGCMapEngine()->urlFactory()->getTileCount(zoom, topleftLon, topleftLat, bottomRightLon, bottomRightLat, mapType);
 }
 
+//-----------------------------------------------------------------------------
+QList<QPoint>
+QGCMapEngine::getCorridorTiles(int zoom, const QList<QGeoCoordinate>& path, double bufferMeters, QString mapType)
+{
+    if(zoom <  1) zoom = 1;
+    if(zoom > MAX_MAP_ZOOM) zoom = MAX_MAP_ZOOM;
+
+    UrlFactory*     urlFactory = getQGCMapEngine()->urlFactory();
+    QList<QPoint>   tiles;
+    QSet<quint64>   tileKeys;
+
+    //-- Add the tiles covering a square of bufferMeters around the coordinate
+    auto addTilesAround = [&](const QGeoCoordinate& coord) {
+        QGeoCoordinate topLeft      = coord.atDistanceAndAzimuth(bufferMeters, 0).atDistanceAndAzimuth(bufferMeters, 270);
+        QGeoCoordinate bottomRight  = coord.atDistanceAndAzimuth(bufferMeters, 180).atDistanceAndAzimuth(bufferMeters, 90);
+        int x0 = urlFactory->long2tileX(mapType, topLeft.longitude(), zoom);
+        int x1 = urlFactory->long2tileX(mapType, bottomRight.longitude(), zoom);
+        int y0 = urlFactory->lat2tileY(mapType, topLeft.latitude(), zoom);
+        int y1 = urlFactory->lat2tileY(mapType, bottomRight.latitude(), zoom);
+        for(int x = qMin(x0, x1); x <= qMax(x0, x1); x++) {
+            for(int y = qMin(y0, y1); y <= qMax(y0, y1); y++) {
+                quint64 key = (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+                if(!tileKeys.contains(key)) {
+                    tileKeys.insert(key);
+                    tiles.append(QPoint(x, y));
+                }
+            }
+        }
+    };
+
+    //-- Squares spaced at no more than the buffer overlap, so the whole corridor is covered
+    const double stepMeters = qMax(bufferMeters, 10.0);
+    for(int i = 0; i < path.count(); i++) {
+        if(i == 0) {
+            addTilesAround(path[0]);
+            continue;
+        }
+        const QGeoCoordinate& from = path[i - 1];
+        double distance = from.distanceTo(path[i]);
+        double azimuth  = from.azimuthTo(path[i]);
+        int steps = qMax(1, static_cast<int>(ceil(distance / stepMeters)));
+        for(int step = 1; step <= steps; step++) {
+            addTilesAround(from.atDistanceAndAzimuth(distance * step / steps, azimuth));
+        }
+    }
+    return tiles;
+}
+
 
 //-----------------------------------------------------------------------------
 QStringList
@@ -280,6 +433,74 @@ QGCMapEngine::setMaxDiskCache(quint32 size)
     _maxDiskCache = size;
 }
 
+//-----------------------------------------------------------------------------
+/// Terrain tiles in the default set are only pruned once they are older than this. 0 prunes them along with map tiles.
+quint32
+QGCMapEngine::getTerrainRetentionDays()
+{
+    if(_terrainRetentionDays == UINT32_MAX) {
+        QSettings settings;
+        _terrainRetentionDays = settings.value(kTerrainRetentionDaysKey, 365).toUInt();
+    }
+    return _terrainRetentionDays;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::setTerrainRetentionDays(quint32 days)
+{
+    QSettings settings;
+    settings.setValue(kTerrainRetentionDaysKey, days);
+    _terrainRetentionDays = days;
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCMapEngine::getTileStorageFormat()
+{
+    if(!_tileStorageFormatLoaded) {
+        QSettings settings;
+        _tileStorageFormat = settings.value(kTileStorageFormatKey).toString();
+        //-- The image format plugin may be gone since the setting was made
+        if(!QGCTileTranscoder::availableFormats().contains(_tileStorageFormat)) {
+            _tileStorageFormat.clear();
+        }
+        _tileStorageFormatLoaded = true;
+    }
+    return _tileStorageFormat;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::setTileStorageFormat(const QString& format)
+{
+    QSettings settings;
+    settings.setValue(kTileStorageFormatKey, format);
+    _tileStorageFormat = QGCTileTranscoder::availableFormats().contains(format) ? format : QString();
+    _tileStorageFormatLoaded = true;
+}
+
+//-----------------------------------------------------------------------------
+quint32
+QGCMapEngine::getTileStorageQuality()
+{
+    if(!_tileStorageQuality) {
+        QSettings settings;
+        _tileStorageQuality = qBound(1u, settings.value(kTileStorageQualityKey, 75).toUInt(), 100u);
+    }
+    return _tileStorageQuality;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::setTileStorageQuality(quint32 quality)
+{
+    quality = qBound(1u, quality, 100u);
+    QSettings settings;
+    settings.setValue(kTileStorageQualityKey, quality);
+    _tileStorageQuality = quality;
+}
+
 //-----------------------------------------------------------------------------
 quint32
 QGCMapEngine::getMaxMemCache()
@@ -308,6 +529,16 @@ QGCMapEngine::setMaxMemCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxMemCacheKey, size);
     _maxMemCache = size;
+    _updateMemoryCacheSize();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::_updateMemoryCacheSize()
+{
+    //-- The encoded tile cache gets a quarter of the memory cache budget, the rest
+    //   is used by QtLocation for decoded tiles.
+    _memoryCache.setMaxBytes(static_cast<int>(getMaxMemCache() * (1024 * 1024) / 4));
 }
 
 //-----------------------------------------------------------------------------
@@ -350,11 +581,19 @@ void
 QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
     emit updateTotals(totaltiles, totalsize, defaulttiles, defaultsize);
+    qCDebug(QGCTileCacheLog) << "Memory cache hits:misses" << _memoryCache.hits() << _memoryCache.misses();
     quint64 maxSize = static_cast<quint64>(getMaxDiskCache()) * 1024L * 1024L;
     if(!_prunning && defaultsize > maxSize) {
         //-- Prune Disk Cache
         _prunning = true;
-        QGCPruneCacheTask* task = new QGCPruneCacheTask(defaultsize - maxSize);
+        QGCPruneCacheTask* task;
+        quint32 retentionDays = getTerrainRetentionDays();
+        if(retentionDays) {
+            qint64 retainedSince = QDateTime::currentDateTime().toSecsSinceEpoch() - (static_cast<qint64>(retentionDays) * 24 * 60 * 60);
+            task = new QGCPruneCacheTask(defaultsize - maxSize, "Airmap Elevation", retainedSince);
+        } else {
+            task = new QGCPruneCacheTask(defaultsize - maxSize);
+        }
         connect(task, &QGCPruneCacheTask::pruned, this, &QGCMapEngine::_pruned);
         getQGCMapEngine()->addTask(task);
     }
@@ -370,11 +609,60 @@ QGCMapEngine::_pruned()
 int
 QGCMapEngine::concurrentDownloads(QString type)
 {
-    Q_UNUSED(type);
-    // TODO : We may want different values depending on
-    // the provider here, let it like this as all provider are set to 12
-    // at the moment
-    return 12;
+    return getQGCMapEngine()->_downloadLimiter(type).concurrent;
+}
+
+//-----------------------------------------------------------------------------
+//-- Provider defaults can be overridden per download group, for example
+//   OfflineDownloads/BingConcurrent or OfflineDownloads/BingRequestsPerSecond
+QGCMapEngine::DownloadLimiter_t&
+QGCMapEngine::_downloadLimiter(const QString& type)
+{
+    MapProvider*    provider    = _urlFactory->getMapProviderFromId(_urlFactory->getIdFromType(type));
+    QString         group       = provider ? provider->downloadGroup() : QStringLiteral("Generic");
+    auto iter = _downloadLimiters.find(group);
+    if(iter == _downloadLimiters.end()) {
+        QSettings settings;
+        settings.beginGroup(kOfflineDownloadsGroup);
+        DownloadLimiter_t limiter;
+        limiter.concurrent          = qMax(1, settings.value(group + "Concurrent", provider ? provider->concurrentDownloads() : 12).toInt());
+        limiter.requestsPerSecond   = qMax(0.0, settings.value(group + "RequestsPerSecond", provider ? provider->maxRequestsPerSecond() : 0.0).toDouble());
+        limiter.tokens              = qMax(1.0, limiter.requestsPerSecond);
+        limiter.lastRefillMSecs     = _downloadClock.elapsed();
+        limiter.pausedUntilMSecs    = 0;
+        qCDebug(QGCTileCacheLog) << "Download limits" << group << limiter.concurrent << limiter.requestsPerSecond;
+        iter = _downloadLimiters.insert(group, limiter);
+    }
+    return *iter;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngine::takeDownloadToken(const QString& type)
+{
+    DownloadLimiter_t&  limiter = _downloadLimiter(type);
+    qint64              now     = _downloadClock.elapsed();
+    if(now < limiter.pausedUntilMSecs) {
+        return static_cast<int>(limiter.pausedUntilMSecs - now);
+    }
+    if(limiter.requestsPerSecond <= 0) {
+        return 0;
+    }
+    limiter.tokens          = qMin(qMax(1.0, limiter.requestsPerSecond), limiter.tokens + ((now - limiter.lastRefillMSecs) * limiter.requestsPerSecond / 1000.0));
+    limiter.lastRefillMSecs = now;
+    if(limiter.tokens >= 1.0) {
+        limiter.tokens -= 1.0;
+        return 0;
+    }
+    return qMax(1, static_cast<int>(ceil((1.0 - limiter.tokens) * 1000.0 / limiter.requestsPerSecond)));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::pauseDownloads(const QString& type, int msecs)
+{
+    DownloadLimiter_t& limiter = _downloadLimiter(type);
+    limiter.pausedUntilMSecs = qMax(limiter.pausedUntilMSecs, _downloadClock.elapsed() + msecs);
 }
 
 //-----------------------------------------------------------------------------
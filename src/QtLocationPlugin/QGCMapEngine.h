@@ -20,10 +20,16 @@
 #define QGC_MAP_ENGINE_H
 
 #include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QGeoCoordinate>
+#include <QPoint>
 
 #include "QGCMapUrlEngine.h"
 #include "QGCMapEngineData.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
 
 
 //-----------------------------------------------------------------------------
@@ -37,16 +43,23 @@ public:
     void                        init                ();
     void                        addTask             (QGCMapTask *task);
     void                        cacheTile           (QString type, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
-    void                        cacheTile           (QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
+    /// @param afterSave Optional task queued right after the tile is saved, tiles may be transcoded in the background first
+    void                        cacheTile           (QString type, quint64 key, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX, QGCMapTask* afterSave = nullptr);
     QGCFetchTileTask*           createFetchTileTask (QString type, int x, int y, int z);
     QStringList                 getMapNameList      ();
     const QString               userAgent           () { return _userAgent; }
     void                        setUserAgent        (const QString& ua) { _userAgent = ua; }
-    QString         hashToType          (const QString& hash);
     quint32                     getMaxDiskCache     ();
     void                        setMaxDiskCache     (quint32 size);
     quint32                     getMaxMemCache      ();
     void                        setMaxMemCache      (quint32 size);
+    quint32                     getTerrainRetentionDays();
+    void                        setTerrainRetentionDays(quint32 days);
+    /// Format map tiles are transcoded to before they are stored, empty to store them as downloaded
+    QString                     getTileStorageFormat();
+    void                        setTileStorageFormat(const QString& format);
+    quint32                     getTileStorageQuality();
+    void                        setTileStorageQuality(quint32 quality);
     const QString               getCachePath        () { return _cachePath; }
     const QString               getCacheFilename    () { return _cacheFile; }
     void                        testInternet        ();
@@ -54,10 +67,28 @@ public:
     bool                        isInternetActive    () const{ return _isInternetActive; }
 
     UrlFactory*                 urlFactory          () { return _urlFactory; }
+    QGCTileMemoryCache*         memoryCache         () { return &_memoryCache; }
+
+    //-- Offline download rate limiting. Only used from the main thread.
+    /// @return 0 if a download for the map type can be sent now, otherwise msecs until it can
+    int                         takeDownloadToken   (const QString& type);
+    /// Holds off all downloads from the same provider, for example after the server asked us to back off
+    void                        pauseDownloads      (const QString& type, int msecs);
 
     //-- Tile Math
     static QGCTileSet           getTileCount        (int zoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat, QString mapType);
-    static QString              getTileHash         (QString type, int x, int y, int z);
+    /// @return Tiles at zoom which are within bufferMeters of the path, in path order
+    static QList<QPoint>        getCorridorTiles    (int zoom, const QList<QGeoCoordinate>& path, double bufferMeters, QString mapType);
+    //-- Tile keys, see getTileKey
+    static quint64              getTileKey          (QString type, int x, int y, int z);
+    static quint64              getTileKey          (int mapId, int x, int y, int z);
+    static quint32              tileKeyType         (int mapId);
+    static int                  tileKeyX            (quint64 key);
+    static int                  tileKeyY            (quint64 key);
+    static int                  tileKeyZ            (quint64 key);
+    /// Converts the text tile hash caches used before tile keys
+    /// @return false if hash is not a valid tile hash
+    static bool                 legacyHashToKey     (const QString& hash, quint64& key, int& mapId);
     static QString              getTypeFromName     (const QString &name);
     static QString              bigSizeToString     (quint64 size);
     static QString              storageFreeSizeToString(quint64 size_MB);
@@ -77,18 +108,39 @@ private:
     void _wipeOldCaches         ();
     void _checkWipeDirectory    (const QString& dirPath);
     bool _wipeDirectory         (const QString& dirPath);
+    void _updateMemoryCacheSize ();
+
+    typedef struct {
+        int     concurrent;
+        double  requestsPerSecond;  ///< 0: No limit
+        double  tokens;             ///< Token bucket, holds up to one second worth of requests
+        qint64  lastRefillMSecs;
+        qint64  pausedUntilMSecs;
+    } DownloadLimiter_t;
+
+    DownloadLimiter_t& _downloadLimiter(const QString& type);
 
 private:
     QGCCacheWorker          _worker;
+    QGCTileMemoryCache      _memoryCache;
+    QThreadPool             _transcodePool;     ///< Re-encodes tiles for storage, see QGCTileTranscoder
+    QHash<QString, DownloadLimiter_t> _downloadLimiters;    ///< Keyed by provider download group
+    QElapsedTimer           _downloadClock;
     QString                 _cachePath;
     QString                 _cacheFile;
     UrlFactory*             _urlFactory;
     QString                 _userAgent;
     quint32                 _maxDiskCache;
     quint32                 _maxMemCache;
+    quint32                 _terrainRetentionDays;
+    QString                 _tileStorageFormat;
+    bool                    _tileStorageFormatLoaded;
+    quint32                 _tileStorageQuality;
     bool                    _prunning;
     bool                    _cacheWasReset;
     bool                    _isInternetActive;
+
+    static const int        _tileKeyTypeShift = 47;
 };
 
 extern QGCMapEngine*    getQGCMapEngine();
@@ -37,6 +37,7 @@ public:
         , _y(0)
         , _z(0)
         , _set(UINT64_MAX)
+        , _key(0)
         , _type("Invalid")
     {
     }
@@ -52,14 +53,14 @@ public:
     int                 y           () const { return _y; }
     int                 z           () const { return _z; }
     qulonglong          set         () const { return _set;  }
-    const QString       hash        () const { return _hash; }
+    quint64             key         () const { return _key; }
     QString type        () const { return _type; }
 
     void                setX        (int x) { _x = x; }
     void                setY        (int y) { _y = y; }
     void                setZ        (int z) { _z = z; }
     void                setTileSet  (qulonglong set) { _set = set;  }
-    void                setHash     (const QString& hash) { _hash = hash; }
+    void                setKey      (quint64 key) { _key = key; }
     void                setType     (QString type) { _type = type; }
 
 private:
@@ -67,7 +68,7 @@ private:
     int         _y;
     int         _z;
     qulonglong  _set;
-    QString     _hash;
+    quint64     _key;
     QString _type;
 };
 
@@ -76,27 +77,27 @@ class QGCCacheTile : public QObject
 {
     Q_OBJECT
 public:
-    QGCCacheTile    (const QString hash, const QByteArray img, const QString format, QString type, qulonglong set = UINT64_MAX)
+    QGCCacheTile    (quint64 key, const QByteArray img, const QString format, QString type, qulonglong set = UINT64_MAX)
         : _set(set)
-        , _hash(hash)
+        , _key(key)
         , _img(img)
         , _format(format)
         , _type(type)
     {
     }
-    QGCCacheTile    (const QString hash, qulonglong set)
+    QGCCacheTile    (quint64 key, qulonglong set)
         : _set(set)
-        , _hash(hash)
+        , _key(key)
     {
     }
     qulonglong          set     () const{ return _set;   }
-    QString             hash    () { return _hash;  }
+    quint64             key     () const{ return _key;   }
     QByteArray          img     () { return _img;   }
     QString             format  () { return _format;}
     QString type    () { return _type; }
 private:
     qulonglong  _set;
-    QString     _hash;
+    quint64     _key;
     QByteArray  _img;
     QString     _format;
     QString _type;
@@ -122,7 +123,8 @@ public:
         taskPruneCache,
         taskReset,
         taskExport,
-        taskImport
+        taskImport,
+        taskRepairStats
     };
 
     QGCMapTask(TaskType type)
@@ -208,9 +210,10 @@ class QGCFetchTileTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCFetchTileTask(const QString hash)
+    QGCFetchTileTask(quint64 key, const QString& type)
         : QGCMapTask(QGCMapTask::taskFetchTile)
-        , _hash(hash)
+        , _key(key)
+        , _type(type)
     {}
 
     ~QGCFetchTileTask()
@@ -222,13 +225,15 @@ public:
         emit tileFetched(tile);
     }
 
-    QString         hash() { return _hash; }
+    quint64         key () const{ return _key; }
+    QString         type() const{ return _type; }
 
 signals:
     void            tileFetched     (QGCCacheTile* tile);
 
 private:
-    QString         _hash;
+    quint64         _key;
+    QString         _type;
 };
 
 //-----------------------------------------------------------------------------
@@ -285,21 +290,24 @@ class QGCUpdateTileDownloadStateTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QString& hash)
+    /// @param key Tile to update, allTiles to update every tile of the set
+    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, quint64 key)
         : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
         , _setID(setID)
         , _state(state)
-        , _hash(hash)
+        , _key(key)
     {}
 
-    QString             hash    () { return _hash; }
+    static const quint64 allTiles = UINT64_MAX;
+
+    quint64             key     () const{ return _key; }
     qulonglong          setID   () const{ return _setID; }
     QGCTile::TyleState  state   () { return _state; }
 
 private:
     qulonglong          _setID;
     QGCTile::TyleState  _state;
-    QString             _hash;
+    quint64             _key;
 };
 
 //-----------------------------------------------------------------------------
@@ -350,12 +358,19 @@ class QGCPruneCacheTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCPruneCacheTask(quint64 amount)
+    /// @param amount           Number of bytes to prune
+    /// @param retainedType     Tiles of this type saved after retainedSince are not pruned
+    /// @param retainedSince    Seconds since epoch
+    QGCPruneCacheTask(quint64 amount, const QString& retainedType = QString(), qint64 retainedSince = 0)
         : QGCMapTask(QGCMapTask::taskPruneCache)
         , _amount(amount)
+        , _retainedType(retainedType)
+        , _retainedSince(retainedSince)
     {}
 
     quint64  amount() const{ return _amount; }
+    QString  retainedType() const{ return _retainedType; }
+    qint64   retainedSince() const{ return _retainedSince; }
 
     void setPruned()
     {
@@ -367,6 +382,8 @@ signals:
 
 private:
     quint64  _amount;
+    QString  _retainedType;
+    qint64   _retainedSince;
 };
 
 //-----------------------------------------------------------------------------
@@ -442,6 +459,10 @@ public:
 
     QString                    path     () { return _path; }
     bool                       replace  () const{ return _replace; }
+    //-- Merged tiles are transcoded to the storage format, see QGCMapEngine::getTileStorageFormat
+    void                       setTileStorage   (const QString& format, int quality) { _storageFormat = format; _storageQuality = quality; }
+    QString                    storageFormat    () const{ return _storageFormat; }
+    int                        storageQuality   () const{ return _storageQuality; }
 
     void setImportCompleted()
     {
@@ -456,6 +477,8 @@ public:
 private:
     QString                     _path;
     bool                        _replace;
+    QString                     _storageFormat;
+    int                         _storageQuality = 0;
 
 signals:
     void actionCompleted        ();
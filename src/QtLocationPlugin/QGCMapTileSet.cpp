@@ -20,6 +20,7 @@
 #include "QGCMapTileSet.h"
 #include "QGCMapEngineManager.h"
 #include "TerrainTile.h"
+#include "QGCDownloadScheduler.h"
 
 #include <QSettings>
 #include <math.h>
@@ -54,8 +55,15 @@ QGCCachedTileSet::QGCCachedTileSet(const QString& name)
     , _batchRequested(false)
     , _manager(nullptr)
     , _selected(false)
+    , _corridorBuffer(0)
+    , _lowPriority(false)
 {
-
+    _rateLimitTimer.setSingleShot(true);
+    connect(&_rateLimitTimer, &QTimer::timeout, this, [this]() {
+        if(_downloading) {
+            _prepareDownload();
+        }
+    });
 }
 
 //-----------------------------------------------------------------------------
@@ -154,7 +162,7 @@ void
 QGCCachedTileSet::resumeDownloadTask()
 {
     //-- Reset and download error flag (for all tiles)
-    QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, "*");
+    QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, QGCUpdateTileDownloadStateTask::allTiles);
     getQGCMapEngine()->addTask(task);
     //-- Start download
     createDownloadTask();
@@ -166,6 +174,7 @@ QGCCachedTileSet::cancelDownloadTask()
 {
     if(_downloading) {
         _downloading = false;
+        _rateLimitTimer.stop();
         emit downloadingChanged();
     }
 }
@@ -186,6 +195,12 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
     //-- If this is the first time, create Network Manager
     if (!_networkManager) {
         _networkManager = new QNetworkAccessManager(this);
+        //-- Resume at full rate once other downloads are done
+        connect(QGCDownloadScheduler::instance(), &QGCDownloadScheduler::bulkSlotsChanged, this, [this]() {
+            if(_downloading) {
+                _prepareDownload();
+            }
+        });
     }
     //-- Add tiles to the list
     _tilesToDownload += tiles;
@@ -235,12 +250,31 @@ void QGCCachedTileSet::_prepareDownload()
         return;
     }
     //-- Prepare queue (QNetworkAccessManager has a limit for concurrent downloads)
-    for(int i = _replies.count(); i < QGCMapEngine::concurrentDownloads(_type); i++) {
+    int concurrentDownloads = QGCMapEngine::concurrentDownloads(_type);
+    if(_lowPriority) {
+        concurrentDownloads = qMax(1, concurrentDownloads / 2);
+    }
+    //-- Give way to application and vehicle downloads
+    concurrentDownloads = qMin(concurrentDownloads, QGCDownloadScheduler::instance()->bulkSlots());
+    for(int i = _replies.count(); i < concurrentDownloads; i++) {
         if(_tilesToDownload.count()) {
             QGCTile* tile = _tilesToDownload.first();
+            //-- Stay within the provider rate limit
+            int waitMSecs = getQGCMapEngine()->takeDownloadToken(tile->type());
+            if(waitMSecs > 0) {
+                if(!_rateLimitTimer.isActive()) {
+                    _rateLimitTimer.start(waitMSecs);
+                }
+                break;
+            }
             _tilesToDownload.removeFirst();
             QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
-            request.setAttribute(QNetworkRequest::User, tile->hash());
+            request.setAttribute(QNetworkRequest::User, tile->key());
+            //-- Multiplex all requests to the same server over one connection where supported
+            request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+            if(_lowPriority) {
+                request.setPriority(QNetworkRequest::LowPriority);
+            }
 #if !defined(__mobile__)
             QNetworkProxy proxy = _networkManager->proxy();
             QNetworkProxy tProxy;
@@ -251,13 +285,13 @@ void QGCCachedTileSet::_prepareDownload()
             reply->setParent(0);
             connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
             connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
-            _replies.insert(tile->hash(), reply);
+            _replies.insert(tile->key(), reply);
 #if !defined(__mobile__)
             _networkManager->setProxy(proxy);
 #endif
             delete tile;
             //-- Refill queue if running low
-            if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
+            if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (concurrentDownloads * 10)) {
                 //-- Request new batch of tiles
                 createDownloadTask();
             }
@@ -276,26 +310,27 @@ QGCCachedTileSet::_networkReplyFinished()
         return;
     }
     if (reply->error() == QNetworkReply::NoError) {
-        //-- Get tile hash
-        const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-        if(!hash.isEmpty()) {
-            if(_replies.contains(hash)) {
-                _replies.remove(hash);
+        //-- Get tile key
+        const quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+        if(key) {
+            if(_replies.contains(key)) {
+                _replies.remove(key);
             } else {
-                qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << hash;
+                qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << key;
             }
-            qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
+            qCDebug(QGCCachedTileSetLog) << "Tile fetched" << key;
             QByteArray image = reply->readAll();
-            QString type = getQGCMapEngine()->hashToType(hash);
-            if (type == "Airmap Elevation" ) {
-                image = TerrainTile::serializeFromAirMapJson(image);
+            //-- All tiles of a set are of the set's type
+            ElevationProvider* elevationProvider = qobject_cast<ElevationProvider*>(getQGCMapEngine()->urlFactory()->getMapProviderFromId(getQGCMapEngine()->urlFactory()->getIdFromType(_type)));
+            if (elevationProvider) {
+                image = elevationProvider->serializeTile(image);
             }
-            QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
+            QString format = getQGCMapEngine()->urlFactory()->getImageFormat(_type, image);
             if(!format.isEmpty()) {
                 //-- Cache tile
-                getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
-                QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-                getQGCMapEngine()->addTask(task);
+                //-- The tile is only marked complete once it is saved
+                QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, key);
+                getQGCMapEngine()->cacheTile(_type, key, image, format, _id, task);
                 //-- Updated cached (downloaded) data
                 _savedTileSize += image.size();
                 _savedTileCount++;
@@ -313,7 +348,7 @@ QGCCachedTileSet::_networkReplyFinished()
             //-- Setup a new download
             _prepareDownload();
         } else {
-            qWarning() << "QGCMapEngineManager::networkReplyFinished() Empty Hash";
+            qWarning() << "QGCMapEngineManager::networkReplyFinished() No tile key";
         }
     }
     reply->deleteLater();
@@ -328,31 +363,64 @@ QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
     if (!reply) {
         return;
     }
+    //-- Get tile key
+    const quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+    if(key && _retryLater(reply, key)) {
+        _prepareDownload();
+        reply->deleteLater();
+        return;
+    }
     //-- Update error count
     _errorCount++;
     emit errorCountChanged();
-    //-- Get tile hash
-    QString hash = reply->request().attribute(QNetworkRequest::User).toString();
     qCDebug(QGCCachedTileSetLog) << "Error fetching tile" << reply->errorString();
-    if(!hash.isEmpty()) {
-        if(_replies.contains(hash)) {
-            _replies.remove(hash);
+    if(key) {
+        if(_replies.contains(key)) {
+            _replies.remove(key);
         } else {
-            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << hash;
+            qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << key;
         }
         if (error != QNetworkReply::OperationCanceledError) {
             qWarning() << "QGCMapEngineManager::networkReplyError() Error:" << reply->errorString();
         }
-        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
+        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, key);
         getQGCMapEngine()->addTask(task);
     } else {
-        qWarning() << "QGCMapEngineManager::networkReplyError() Empty Hash";
+        qWarning() << "QGCMapEngineManager::networkReplyError() No tile key";
     }
     //-- Setup a new download
     _prepareDownload();
     reply->deleteLater();
 }
 
+//-----------------------------------------------------------------------------
+//-- When the server says it is overloaded or we are going too fast, the tile is
+//   put back in the queue and the whole provider backs off instead of the tile
+//   being marked as an error.
+bool
+QGCCachedTileSet::_retryLater(QNetworkReply* reply, quint64 key)
+{
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if(status != 429 && status != 503) {
+        return false;
+    }
+    int retryAfterSecs = reply->rawHeader("Retry-After").toInt();
+    if(retryAfterSecs <= 0) {
+        retryAfterSecs = 5;
+    }
+    qCDebug(QGCCachedTileSetLog) << "Server asked to back off" << _type << status << retryAfterSecs;
+    getQGCMapEngine()->pauseDownloads(_type, retryAfterSecs * 1000);
+    _replies.remove(key);
+    QGCTile* tile = new QGCTile;
+    tile->setKey(key);
+    tile->setType(_type);
+    tile->setX(QGCMapEngine::tileKeyX(key));
+    tile->setY(QGCMapEngine::tileKeyY(key));
+    tile->setZ(QGCMapEngine::tileKeyZ(key));
+    _tilesToDownload.prepend(tile);
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCachedTileSet::setManager(QGCMapEngineManager* mgr)
@@ -24,6 +24,8 @@
 #include <QHash>
 #include <QDateTime>
 #include <QImage>
+#include <QTimer>
+#include <QGeoCoordinate>
 
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngineData.h"
@@ -112,6 +114,10 @@ public:
     quint32     errorCount              () const{ return _errorCount; }
     QString     errorCountStr           () const;
     bool        selected                () const{ return _selected; }
+    //-- Corridor sets only hold the tiles within corridorBuffer of corridorPath. The bounds are the corridor bounding box.
+    const QList<QGeoCoordinate>& corridorPath() const{ return _corridorPath; }
+    double      corridorBuffer          () const{ return _corridorBuffer; }
+    bool        lowPriority             () const{ return _lowPriority; }
 
     void        setSelected             (bool sel);
     void        setName                 (QString name)              { _name = name; }
@@ -134,6 +140,8 @@ public:
     void        setDefaultSet           (bool def)                  { _defaultSet = def; }
     void        setDeleting             (bool del)                  { _deleting = del; emit deletingChanged(); }
     void        setDownloading          (bool down)                 { _downloading = down; }
+    void        setCorridor             (const QList<QGeoCoordinate>& path, double bufferMeters) { _corridorPath = path; _corridorBuffer = bufferMeters; }
+    void        setLowPriority          (bool low)                  { _lowPriority = low; }
 
 signals:
     void        deletingChanged         ();
@@ -157,6 +165,7 @@ private slots:
 private:
     void        _prepareDownload        ();
     void        _doneWithDownload       ();
+    bool        _retryLater             (QNetworkReply* reply, quint64 key);
 
 private:
     QString     _name;
@@ -180,7 +189,8 @@ private:
     quint64     _id;
     QString _type;
     QNetworkAccessManager*  _networkManager;
-    QHash<QString, QNetworkReply*> _replies;
+    QHash<quint64, QNetworkReply*> _replies;
+    QTimer      _rateLimitTimer;            ///< Restarts downloads once the provider rate limit allows it
     quint32     _errorCount;
     //-- Tile download
     QList<QGCTile *> _tilesToDownload;
@@ -188,6 +198,9 @@ private:
     bool        _batchRequested;
     QGCMapEngineManager* _manager;
     bool        _selected;
+    QList<QGeoCoordinate> _corridorPath;
+    double      _corridorBuffer;
+    bool        _lowPriority;               ///< Background prefetch, uses fewer connections so it does not compete with the map view
 };
 
 #endif // QGC_MAP_TILE_SET_H
@@ -26,6 +26,7 @@ QGC_LOGGING_CATEGORY(QGCMapUrlEngineLog, "QGCMapUrlEngineLog")
 
 
 #include <QByteArray>
+#include <QDir>
 #include <QEventLoop>
 #include <QNetworkReply>
 #include <QRegExp>
@@ -86,12 +87,61 @@ UrlFactory::UrlFactory() : _timeout(5 * 1000) {
     _providersTable["LINZ Basemap"] = new LINZBasemapMapProvider(this);
     
     _providersTable["CustomURL Custom"] = new CustomURLMapProvider(this);
+
+    //-- A new map type must not share its tile key type with another one, see QGCMapEngine::getTileKey
+    for (auto it = _providersTable.constBegin(); it != _providersTable.constEnd(); ++it) {
+        const QString keyTypeUser = _tileKeyTypeUser(it.key());
+        if (!keyTypeUser.isEmpty()) {
+            qWarning() << "Map types share a tile key type:" << it.key() << keyTypeUser;
+        }
+    }
 }
 
 void UrlFactory::registerProvider(QString name, MapProvider* provider) {
     _providersTable[name] = provider;
 }
 
+//-----------------------------------------------------------------------------
+void UrlFactory::registerTileArchives(const QString& directory) {
+    if (directory.isEmpty()) {
+        return;
+    }
+    const QFileInfoList files = QDir(directory).entryInfoList(QStringList({ "*.mbtiles", "*.pmtiles" }), QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files) {
+        QGCTileArchive* archive = new QGCTileArchive(file.absoluteFilePath());
+        if (!archive->open()) {
+            delete archive;
+            continue;
+        }
+        QString name = QStringLiteral("Basemap ") + archive->name();
+        if (_providersTable.contains(name)) {
+            qWarning() << "Basemap name used twice, ignoring" << file.absoluteFilePath();
+            delete archive;
+            continue;
+        }
+        //-- Cached tiles are keyed by a 16 bit fold of the map type, which must not be shared
+        const QString keyTypeUser = _tileKeyTypeUser(name);
+        if (!keyTypeUser.isEmpty()) {
+            qWarning() << "Basemap name collides with" << keyTypeUser << "in the tile cache, ignoring" << file.absoluteFilePath();
+            delete archive;
+            continue;
+        }
+        qCDebug(QGCMapUrlEngineLog) << "Registered basemap" << name << file.absoluteFilePath();
+        registerProvider(name, new TileArchiveMapProvider(archive, this));
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString UrlFactory::_tileKeyTypeUser(const QString& type) {
+    const quint32 keyType = QGCMapEngine::tileKeyType(getIdFromType(type));
+    for (auto it = _providersTable.constBegin(); it != _providersTable.constEnd(); ++it) {
+        if (it.key() != type && QGCMapEngine::tileKeyType(getIdFromType(it.key())) == keyType) {
+            return it.key();
+        }
+    }
+    return QString();
+}
+
 //-----------------------------------------------------------------------------
 UrlFactory::~UrlFactory() {}
 
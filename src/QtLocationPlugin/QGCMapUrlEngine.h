@@ -23,6 +23,7 @@
 #include "EsriMapProvider.h"
 #include "MapboxMapProvider.h"
 #include "ElevationMapProvider.h"
+#include "TileArchiveMapProvider.h"
 
 #define MAX_MAP_ZOOM (23.0)
 
@@ -56,10 +57,15 @@ public:
 
     bool isElevation(int mapId);
 
+    /// Adds a "Basemap <name>" map type for each MBTiles and PMTiles file in the directory
+    void registerTileArchives(const QString& directory);
+
   private:
     int             _timeout;
     QHash<QString, MapProvider*> _providersTable;
     void registerProvider(QString Name, MapProvider* provider);
+    /// @return Registered map type sharing the tile key type of type, empty if none
+    QString _tileKeyTypeUser(const QString& type);
 
 };
 
@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileArchive.h"
+#include "QGCZlib.h"
+
+#include <QFileInfo>
+#include <QThread>
+#include <QtEndian>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QSqlError>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+QGC_LOGGING_CATEGORY(QGCTileArchiveLog, "QGCTileArchiveLog")
+
+//-- PMTiles version 3 header, see https://github.com/protomaps/PMTiles/blob/main/spec/v3/spec.md
+static const int        kPMTilesHeaderSize      = 127;
+static const int        kPMTilesMaxDepth        = 4;
+static const quint64    kPMTilesMaxDirectory    = 16 * 1024 * 1024;
+
+enum {
+    PMTilesCompressionNone  = 1,
+    PMTilesCompressionGzip  = 2,
+};
+
+enum {
+    PMTilesTypePng          = 2,
+    PMTilesTypeJpeg         = 3,
+    PMTilesTypeWebp         = 4,
+};
+
+//-----------------------------------------------------------------------------
+static bool
+readVarint(const uchar*& p, const uchar* end, quint64& value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if(p >= end) {
+            return false;
+        }
+        uchar byte = *p++;
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+QGCTileArchive::QGCTileArchive(const QString& fileName, QObject* parent)
+    : QObject(parent)
+    , _fileName(fileName)
+    , _name(QFileInfo(fileName).completeBaseName())
+    , _minZoom(0)
+    , _maxZoom(0)
+    , _pmtiles(fileName.endsWith(".pmtiles", Qt::CaseInsensitive))
+    , _file(fileName)
+    , _data(nullptr)
+    , _size(0)
+    , _leafDirectoryOffset(0)
+    , _tileDataOffset(0)
+    , _internalCompression(0)
+    , _tileCompression(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCTileArchive::~QGCTileArchive()
+{
+    if(_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    QMutexLocker lock(&_connectionMutex);
+    for(const QString& name : _connectionNames) {
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::open()
+{
+    bool success = _pmtiles ? _openPMTiles() : _openMBTiles();
+    if(success) {
+        qCDebug(QGCTileArchiveLog) << "Opened basemap" << _fileName << _format << _minZoom << _maxZoom;
+    } else {
+        qWarning() << "Basemap not usable:" << _fileName;
+    }
+    return success;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::tile(int x, int y, int zoom, QByteArray& image)
+{
+    if(zoom < _minZoom || zoom > _maxZoom) {
+        return false;
+    }
+    return _pmtiles ? _tilePMTiles(x, y, zoom, image) : _tileMBTiles(x, y, zoom, image);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_openPMTiles()
+{
+    if(!_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open basemap" << _fileName << _file.errorString();
+        return false;
+    }
+    _size = static_cast<quint64>(_file.size());
+    if(_size < kPMTilesHeaderSize) {
+        return false;
+    }
+    _data = _file.map(0, _file.size());
+    if(!_data) {
+        qWarning() << "Could not map basemap" << _fileName << _file.errorString();
+        return false;
+    }
+    if(memcmp(_data, "PMTiles", 7) != 0 || _data[7] != 3) {
+        qWarning() << "Basemap is not a version 3 PMTiles file" << _fileName;
+        return false;
+    }
+    quint64 rootOffset      = qFromLittleEndian<quint64>(_data + 8);
+    quint64 rootLength      = qFromLittleEndian<quint64>(_data + 16);
+    _leafDirectoryOffset    = qFromLittleEndian<quint64>(_data + 40);
+    _tileDataOffset         = qFromLittleEndian<quint64>(_data + 56);
+    _internalCompression    = _data[97];
+    _tileCompression        = _data[98];
+    _minZoom                = _data[100];
+    _maxZoom                = _data[101];
+    switch(_data[99]) {
+    case PMTilesTypePng:
+        _format = QStringLiteral("png");
+        break;
+    case PMTilesTypeJpeg:
+        _format = QStringLiteral("jpg");
+        break;
+    case PMTilesTypeWebp:
+        _format = QStringLiteral("webp");
+        break;
+    default:
+        qWarning() << "Basemap does not hold raster tiles" << _fileName << _data[99];
+        return false;
+    }
+    if(_internalCompression != PMTilesCompressionNone && _internalCompression != PMTilesCompressionGzip) {
+        qWarning() << "Basemap directory compression not supported" << _fileName << _internalCompression;
+        return false;
+    }
+    return _readDirectory(rootOffset, rootLength, _rootDirectory);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_readDirectory(quint64 offset, quint64 length, Directory_t& directory)
+{
+    if(offset > _size || length > _size - offset || length > kPMTilesMaxDirectory) {
+        return false;
+    }
+    QByteArray decompressed;
+    const uchar* p = _data + offset;
+    const uchar* end = p + length;
+    if(_internalCompression == PMTilesCompressionGzip) {
+        //-- fromRawData doesn't copy, the directory is read straight out of the mapped file
+        if(!QGCZlib::inflateGzipData(QByteArray::fromRawData(reinterpret_cast<const char*>(p), static_cast<int>(length)), decompressed)) {
+            return false;
+        }
+        p   = reinterpret_cast<const uchar*>(decompressed.constData());
+        end = p + decompressed.size();
+    }
+    quint64 count = 0;
+    if(!readVarint(p, end, count) || count > static_cast<quint64>(end - p)) {
+        return false;
+    }
+    directory.resize(static_cast<int>(count));
+    quint64 value  = 0;
+    quint64 tileId = 0;
+    for(DirectoryEntry_t& entry : directory) {
+        if(!readVarint(p, end, value)) {
+            return false;
+        }
+        tileId += value;
+        entry.tileId = tileId;
+    }
+    for(DirectoryEntry_t& entry : directory) {
+        if(!readVarint(p, end, value)) {
+            return false;
+        }
+        entry.runLength = static_cast<quint32>(value);
+    }
+    for(DirectoryEntry_t& entry : directory) {
+        if(!readVarint(p, end, value)) {
+            return false;
+        }
+        entry.length = static_cast<quint32>(value);
+    }
+    for(int i = 0; i < directory.count(); i++) {
+        if(!readVarint(p, end, value)) {
+            return false;
+        }
+        //-- 0 means the data follows right after the previous entry
+        if(value == 0 && i > 0) {
+            directory[i].offset = directory[i - 1].offset + directory[i - 1].length;
+        } else {
+            directory[i].offset = value - 1;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_leafDirectory(quint64 offset, quint64 length, Directory_t& directory)
+{
+    QMutexLocker lock(&_leafMutex);
+    auto it = _leafDirectories.constFind(offset);
+    if(it != _leafDirectories.constEnd()) {
+        directory = it.value();
+        return true;
+    }
+    lock.unlock();
+    if(!_readDirectory(_leafDirectoryOffset + offset, length, directory)) {
+        return false;
+    }
+    lock.relock();
+    if(_leafDirectories.count() >= _maxLeafDirectories) {
+        _leafDirectories.clear();
+    }
+    _leafDirectories.insert(offset, directory);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+const QGCTileArchive::DirectoryEntry_t*
+QGCTileArchive::_findEntry(const Directory_t& directory, quint64 tileId)
+{
+    //-- Last entry at or before the tile
+    auto it = std::upper_bound(directory.constBegin(), directory.constEnd(), tileId,
+                               [](quint64 id, const DirectoryEntry_t& entry) { return id < entry.tileId; });
+    if(it == directory.constBegin()) {
+        return nullptr;
+    }
+    --it;
+    if(it->tileId == tileId || it->runLength == 0 || tileId - it->tileId < it->runLength) {
+        return &(*it);
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//-- Tiles are numbered along a Hilbert curve within each zoom level, after all tiles of the lower levels
+quint64
+QGCTileArchive::_tileId(int x, int y, int zoom)
+{
+    quint64 id = 0;
+    for(int z = 0; z < zoom; z++) {
+        id += (1ULL << z) * (1ULL << z);
+    }
+    quint64 n  = 1ULL << zoom;
+    quint64 tx = static_cast<quint64>(x);
+    quint64 ty = static_cast<quint64>(y);
+    quint64 d  = 0;
+    for(quint64 s = n / 2; s > 0; s /= 2) {
+        quint64 rx = (tx & s) ? 1 : 0;
+        quint64 ry = (ty & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if(ry == 0) {
+            if(rx == 1) {
+                tx = n - 1 - tx;
+                ty = n - 1 - ty;
+            }
+            std::swap(tx, ty);
+        }
+    }
+    return id + d;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_tilePMTiles(int x, int y, int zoom, QByteArray& image)
+{
+    if(!_data || x < 0 || y < 0 || x >= (1 << zoom) || y >= (1 << zoom)) {
+        return false;
+    }
+    quint64 tileId = _tileId(x, y, zoom);
+    const DirectoryEntry_t* entry = _findEntry(_rootDirectory, tileId);
+    Directory_t leaf;
+    for(int depth = 0; entry && depth < kPMTilesMaxDepth; depth++) {
+        if(entry->runLength > 0) {
+            quint64 offset = _tileDataOffset + entry->offset;
+            if(offset > _size || entry->length > _size - offset) {
+                return false;
+            }
+            QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(_data + offset), static_cast<int>(entry->length));
+            if(_tileCompression == PMTilesCompressionGzip) {
+                return QGCZlib::inflateGzipData(data, image);
+            }
+            //-- Deep copy, the reply may outlive the mapping
+            image = QByteArray(data.constData(), data.size());
+            return true;
+        }
+        if(!_leafDirectory(entry->offset, entry->length, leaf)) {
+            return false;
+        }
+        entry = _findEntry(leaf, tileId);
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCTileArchive::_connectionName()
+{
+    QString name = QString("QGCTileArchive_%1_%2").arg(reinterpret_cast<quintptr>(this)).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    if(!QSqlDatabase::contains(name)) {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(_fileName);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if(db.open()) {
+            //-- Let SQLite memory map the file instead of copying pages into its own cache
+            QSqlQuery query(db);
+            query.exec("PRAGMA mmap_size = 1073741824");
+        } else {
+            qWarning() << "Could not open basemap" << _fileName << db.lastError().text();
+        }
+        QMutexLocker lock(&_connectionMutex);
+        _connectionNames.append(name);
+    }
+    return name;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_openMBTiles()
+{
+    QSqlDatabase db = QSqlDatabase::database(_connectionName());
+    if(!db.isOpen()) {
+        return false;
+    }
+    QString format;
+    QSqlQuery query(db);
+    _minZoom = 0;
+    _maxZoom = 22;
+    if(query.exec("SELECT name, value FROM metadata")) {
+        while(query.next()) {
+            QString name = query.value(0).toString();
+            if(name == "format") {
+                format = query.value(1).toString().toLower();
+            } else if(name == "minzoom") {
+                _minZoom = query.value(1).toInt();
+            } else if(name == "maxzoom") {
+                _maxZoom = query.value(1).toInt();
+            } else if(name == "name" && !query.value(1).toString().isEmpty()) {
+                _name = query.value(1).toString();
+            }
+        }
+    } else {
+        qWarning() << "Basemap has no MBTiles metadata" << _fileName << query.lastError().text();
+        return false;
+    }
+    if(format == "png" || format == "webp") {
+        _format = format;
+    } else if(format == "jpg" || format == "jpeg") {
+        _format = QStringLiteral("jpg");
+    } else {
+        qWarning() << "Basemap does not hold raster tiles" << _fileName << format;
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileArchive::_tileMBTiles(int x, int y, int zoom, QByteArray& image)
+{
+    QSqlDatabase db = QSqlDatabase::database(_connectionName());
+    if(!db.isOpen()) {
+        return false;
+    }
+    QSqlQuery query(db);
+    query.prepare("SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?");
+    query.addBindValue(zoom);
+    query.addBindValue(x);
+    //-- MBTiles rows count up from the south
+    query.addBindValue((1 << zoom) - 1 - y);
+    if(query.exec() && query.next()) {
+        image = query.value(0).toByteArray();
+        return !image.isEmpty();
+    }
+    return false;
+}
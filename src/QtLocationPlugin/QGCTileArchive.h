@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QStringList>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileArchiveLog)
+
+//-----------------------------------------------------------------------------
+// Read only basemap in an MBTiles or PMTiles (version 3) file. Tiles are served
+// straight out of the file, without going through the tile cache database.
+// PMTiles files are memory mapped and looked up through their directories, the
+// root directory is decoded when the file is opened and leaf directories as
+// they are needed. MBTiles are SQLite databases and are opened read only with
+// SQLite memory mapping turned on. Only raster tiles are supported. Reentrant,
+// tile() is called from the tile fetcher threads.
+class QGCTileArchive : public QObject
+{
+    Q_OBJECT
+public:
+    QGCTileArchive              (const QString& fileName, QObject* parent = nullptr);
+    ~QGCTileArchive             ();
+
+    /// @return true if the file was opened and holds raster tiles
+    bool        open            ();
+    /// @return true if the tile is in the archive, image is set to the tile data
+    bool        tile            (int x, int y, int zoom, QByteArray& image);
+
+    QString     fileName        () const { return _fileName; }
+    QString     name            () const { return _name; }
+    QString     format          () const { return _format; }    ///< "png", "jpg" or "webp"
+    int         minZoom         () const { return _minZoom; }
+    int         maxZoom         () const { return _maxZoom; }
+
+private:
+    typedef struct {
+        quint64 tileId;
+        quint64 offset;
+        quint32 length;
+        quint32 runLength;      ///< 0: Entry points to a leaf directory
+    } DirectoryEntry_t;
+
+    typedef QVector<DirectoryEntry_t> Directory_t;
+
+    bool        _openPMTiles    ();
+    bool        _openMBTiles    ();
+    bool        _tilePMTiles    (int x, int y, int zoom, QByteArray& image);
+    bool        _tileMBTiles    (int x, int y, int zoom, QByteArray& image);
+    bool        _readDirectory  (quint64 offset, quint64 length, Directory_t& directory);
+    bool        _leafDirectory  (quint64 offset, quint64 length, Directory_t& directory);
+    QString     _connectionName ();
+
+    static const DirectoryEntry_t* _findEntry(const Directory_t& directory, quint64 tileId);
+    static quint64  _tileId     (int x, int y, int zoom);
+
+    QString             _fileName;
+    QString             _name;
+    QString             _format;
+    int                 _minZoom;
+    int                 _maxZoom;
+    bool                _pmtiles;
+
+    //-- PMTiles
+    QFile               _file;
+    const uchar*        _data;
+    quint64             _size;
+    quint64             _leafDirectoryOffset;
+    quint64             _tileDataOffset;
+    int                 _internalCompression;
+    int                 _tileCompression;
+    Directory_t         _rootDirectory;
+    QMutex              _leafMutex;
+    QHash<quint64, Directory_t> _leafDirectories;   ///< Keyed by offset
+
+    //-- MBTiles, QSqlDatabase connections can only be used by the thread which opened them
+    QMutex              _connectionMutex;
+    QStringList         _connectionNames;
+
+    static const int    _maxLeafDirectories = 64;
+};
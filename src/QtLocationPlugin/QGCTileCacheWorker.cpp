@@ -18,6 +18,10 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTileTranscoder.h"
+#include "QGCZlib.h"
+#include "QGCLZMA.h"
+#include "QGCTrace.h"
 
 #include <QVariant>
 #include <QtSql/QSqlQuery>
@@ -27,20 +31,78 @@
 #include <QApplication>
 #include <QFile>
 #include <QSettings>
+#include <QThreadStorage>
+#include <QRunnable>
+#include <QPoint>
 
 #include "time.h"
 
 static const char*      kDefaultSet     = "Default Tile Set";
 static const QString    kSession        = QStringLiteral("QGeoTileWorkerSession");
 static const QString    kExportSession  = QStringLiteral("QGeoTileExportSession");
+static const QString    kReadSession    = QStringLiteral("QGeoTileReadSession");
+static const char*      kImportSuffix   = ".import";
+static const char*      kExportSuffix   = ".export";
 
 QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 
+//-- Tiles and downloads are keyed by QGCMapEngine::getTileKey. %1 is the table name.
+static const char*      kCreateTiles    =
+    "CREATE TABLE IF NOT EXISTS %1 ("
+    "tileID INTEGER PRIMARY KEY NOT NULL, "
+    "format TEXT NOT NULL, "
+    "tile BLOB NULL, "
+    "size INTEGER, "
+    "type INTEGER, "
+    "date INTEGER DEFAULT 0)";
+static const char*      kCreateTilesDownload =
+    "CREATE TABLE IF NOT EXISTS %1 ("
+    "setID INTEGER, "
+    "tileID INTEGER NOT NULL UNIQUE, "
+    "type INTEGER, "
+    "x INTEGER, "
+    "y INTEGER, "
+    "z INTEGER, "
+    "state INTEGER DEFAULT 0)";
+
 //-- Update intervals
 
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-----------------------------------------------------------------------------
+//-- Read only connection owned by a read pool thread. It is removed when the
+//   thread exits or when the database is replaced.
+struct QGCCacheReadConnection {
+    QString name;
+    int     generation;
+    ~QGCCacheReadConnection() {
+        QSqlDatabase::database(name, false).close();
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+static QThreadStorage<QGCCacheReadConnection*> readConnections;
+
+//-----------------------------------------------------------------------------
+class QGCCacheReadTask : public QRunnable
+{
+public:
+    QGCCacheReadTask(QGCCacheWorker* worker, QGCMapTask* task)
+        : _worker(worker)
+        , _task(task)
+    {
+    }
+    void run() override
+    {
+        _worker->_getTile(_task);
+        _task->deleteLater();
+    }
+private:
+    QGCCacheWorker* _worker;
+    QGCMapTask*     _task;
+};
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -54,7 +116,11 @@ QGCCacheWorker::QGCCacheWorker()
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
     , _hostLookupID(0)
+    , _dbGeneration(0)
 {
+    _readPool.setMaxThreadCount(_readConnectionCount);
+    //-- Pool threads hold on to their connection, so keep them around
+    _readPool.setExpiryTimeout(-1);
 }
 
 //-----------------------------------------------------------------------------
@@ -85,6 +151,8 @@ QGCCacheWorker::quit()
     if(this->isRunning()) {
         _waitc.wakeAll();
     }
+    //-- Tile fetches already handed to the read pool are short, let them finish
+    _readPool.waitForDone();
 }
 
 //-----------------------------------------------------------------------------
@@ -97,6 +165,11 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    //-- Tile fetches don't need to wait behind writes
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        _readPool.start(new QGCCacheReadTask(this, task));
+        return true;
+    }
     QMutexLocker lock(&_taskQueueMutex);
     _taskQueue.enqueue(task);
     lock.unlock(); // don't need to hold the mutex any more
@@ -121,13 +194,12 @@ QGCCacheWorker::run()
     _deleteBingNoTileTiles();
     QMutexLocker lock(&_taskQueueMutex);
     while(true) {
-        QGCMapTask* task;
         if(_taskQueue.count()) {
-            task = _taskQueue.dequeue();
+            QGCMapTask* task = _taskQueue.dequeue();
 
             // Don't need the lock while running the task.
             lock.unlock();
-            _runTask(task);
+            _runBatchedTask(task);
             lock.relock();
             task->deleteLater();
             //-- Check for update timeout
@@ -146,6 +218,17 @@ QGCCacheWorker::run()
                     lock.relock();
                 }
             }
+        } else if(_batchOpen) {
+            //-- Give more saves a chance to join the open transaction before committing it
+            qint64 remainingMSecs = _maxBatchMSecs - _batchTimer.elapsed();
+            if(remainingMSecs > 0) {
+                _waitc.wait(lock.mutex(), static_cast<unsigned long>(remainingMSecs));
+            }
+            if(!_taskQueue.count()) {
+                lock.unlock();
+                _commitBatch();
+                lock.relock();
+            }
         } else {
             //-- Wait a bit before shutting things down
             unsigned long timeoutMilliseconds = 5000;
@@ -160,10 +243,50 @@ QGCCacheWorker::run()
     _disconnectDB();
 }
 
+//-----------------------------------------------------------------------------
+//-- Tile saves and download state updates share one open transaction, which is
+//   committed once it holds _maxBatchTasks tasks, is _maxBatchMSecs old, the
+//   queue runs dry or any other task comes along. A tile and the download state
+//   change which marks it complete always land in the same commit, so after a
+//   crash either both are there or the tile is still pending download.
+void
+QGCCacheWorker::_runBatchedTask(QGCMapTask* task)
+{
+    bool batched = task->type() == QGCMapTask::taskCacheTile || task->type() == QGCMapTask::taskUpdateTileDownloadState;
+    if(!batched) {
+        _commitBatch();
+    } else if(!_batchOpen && _valid && _db) {
+        _batchOpen = _db->transaction();
+        _batchTaskCount = 0;
+        _batchTimer.start();
+    }
+    _runTask(task);
+    if(_batchOpen && (++_batchTaskCount >= _maxBatchTasks || _batchTimer.elapsed() >= _maxBatchMSecs)) {
+        _commitBatch();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_commitBatch()
+{
+    if(!_batchOpen) {
+        return;
+    }
+    _batchOpen = false;
+    qCDebug(QGCTileCacheLog) << "_commitBatch() tasks:" << _batchTaskCount << "msecs:" << _batchTimer.elapsed();
+    if(_db && !_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit batch):" << _db->lastError().text();
+        _db->rollback();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_runTask(QGCMapTask *task)
 {
+    QGC_TRACE_SCOPE("QGCCacheWorker::_runTask");
+
     switch(task->type()) {
         case QGCMapTask::taskInit:
             return;
@@ -206,6 +329,9 @@ QGCCacheWorker::_runTask(QGCMapTask *task)
         case QGCMapTask::taskTestInternet:
             _testInternet();
             return;
+        case QGCMapTask::taskRepairStats:
+            _repairStats(task);
+            return;
     }
     qCWarning(QGCTileCacheLog) << "_runTask given unhandled task type" << task->type();
 }
@@ -232,13 +358,13 @@ QGCCacheWorker::_deleteBingNoTileTiles()
     QSqlQuery query(*_db);
     QString s;
     //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, tile, hash FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.count());
+    s = QString("SELECT tileID, tile FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.count());
     QList<quint64> idsToDelete;
     if (query.exec(s)) {
         while(query.next()) {
             if (query.value(1).toByteArray() == noTileBytes) {
                 idsToDelete.append(query.value(0).toULongLong());
-                qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles HASH:" << query.value(2).toString();
+                qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles KEY:" << query.value(0).toULongLong();
             }
         }
         for (const quint64 tileId: idsToDelete) {
@@ -290,23 +416,22 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 {
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
+        _prepareInsertQueries();
+        QSqlQuery& query = *_insertTileQuery;
+        query.addBindValue(static_cast<qint64>(task->tile()->key()));
         query.addBindValue(task->tile()->format());
         query.addBindValue(task->tile()->img());
         query.addBindValue(task->tile()->img().size());
         query.addBindValue(task->tile()->type());
         query.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
         if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
             quint64 setID = task->tile()->set() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->set();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+            _insertSetTileQuery->addBindValue(static_cast<qint64>(task->tile()->key()));
+            _insertSetTileQuery->addBindValue(setID);
+            if(!_insertSetTileQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << _insertSetTileQuery->lastError().text();
             }
-            qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
+            qCDebug(QGCTileCacheLog) << "_saveTile() KEY:" << task->tile()->key();
         } else {
             //-- Tile was already there.
             //   QtLocation some times requests the same tile twice in a row. The first is saved, the second is already there.
@@ -325,21 +450,23 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     }
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
+    //-- Runs on a read pool thread
+    QReadLocker lock(&_dbLock);
+    QSqlQuery query(_readConnection());
+    QString s = QString("SELECT tile, format, type FROM Tiles WHERE tileID = %1").arg(task->key());
     if(query.exec(s)) {
-        if(query.next()) {
+        //-- The key only holds a folded map type, the type column makes sure it is the right map
+        if(query.next() && query.value(2).toString() == task->type()) {
             QByteArray ar   = query.value(0).toByteArray();
             QString format  = query.value(1).toString();
-            QString type = getQGCMapEngine()->urlFactory()->getTypeFromId(query.value(2).toInt());
-            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
+            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) KEY:" << task->key();
+            QGCCacheTile* tile = new QGCCacheTile(task->key(), ar, format, task->type());
             task->setTileFetched(tile);
             found = true;
         }
     }
     if(!found) {
-        qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
+        qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) KEY:" << task->key();
         task->setError("Tile not in cache database");
     }
 }
@@ -394,46 +521,39 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         return;
     }
     QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
+    QString sq = QString("SELECT tileCount, tileSize, uniqueCount, uniqueSize FROM SetStats WHERE setID = %1").arg(set->id());
     qCDebug(QGCTileCacheLog) << "_updateSetTotals(): " << sq;
     if(subquery.exec(sq)) {
-        if(subquery.next()) {
-            set->setSavedTileCount(subquery.value(0).toUInt());
-            set->setSavedTileSize(subquery.value(1).toULongLong());
-            qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
-            //-- Update (estimated) size
-            quint64 avg = getQGCMapEngine()->urlFactory()->averageSizeForType(set->type());
-            if(set->totalTileCount() <= set->savedTileCount()) {
-                //-- We're done so the saved size is the total size
-                set->setTotalTileSize(set->savedTileSize());
-            } else {
-                //-- Otherwise we need to estimate it.
-                if(set->savedTileCount() > 10 && set->savedTileSize()) {
-                    avg = set->savedTileSize() / set->savedTileCount();
-                }
-                set->setTotalTileSize(avg * set->totalTileCount());
-            }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
-            //-- If we haven't downloaded it all, estimate size of unique tiles
-            quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
-            if(!ucount) {
-                usize = expectedUcount * avg;
-            } else {
-                expectedUcount = ucount;
+        //-- No stats row means nothing has been saved for this set yet
+        bool found = subquery.next();
+        set->setSavedTileCount(found ? subquery.value(0).toUInt() : 0);
+        set->setSavedTileSize(found ? subquery.value(1).toULongLong() : 0);
+        qCDebug(QGCTileCacheLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
+        //-- Update (estimated) size
+        quint64 avg = getQGCMapEngine()->urlFactory()->averageSizeForType(set->type());
+        if(set->totalTileCount() <= set->savedTileCount()) {
+            //-- We're done so the saved size is the total size
+            set->setTotalTileSize(set->savedTileSize());
+        } else {
+            //-- Otherwise we need to estimate it.
+            if(set->savedTileCount() > 10 && set->savedTileSize()) {
+                avg = set->savedTileSize() / set->savedTileCount();
             }
-            set->setUniqueTileCount(expectedUcount);
-            set->setUniqueTileSize(usize);
+            set->setTotalTileSize(avg * set->totalTileCount());
+        }
+        //-- Now figure out the count for tiles unique to this set
+        //   This is only accurate when all tiles are downloaded
+        quint32 ucount = found ? subquery.value(2).toUInt() : 0;
+        quint64 usize  = found ? subquery.value(3).toULongLong() : 0;
+        //-- If we haven't downloaded it all, estimate size of unique tiles
+        quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
+        if(!ucount) {
+            usize = expectedUcount * avg;
+        } else {
+            expectedUcount = ucount;
         }
+        set->setUniqueTileCount(expectedUcount);
+        set->setUniqueTileSize(usize);
     }
 }
 
@@ -441,22 +561,24 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
 void
 QGCCacheWorker::_updateTotals()
 {
+    //-- Totals are kept up to date by triggers, see _createStats
     QSqlQuery query(*_db);
     QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+    s = QString("SELECT tileCount, tileSize FROM CacheStats WHERE id = 0");
     if(query.exec(s)) {
         if(query.next()) {
             _totalCount = query.value(0).toUInt();
             _totalSize  = query.value(1).toULongLong();
         }
     }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
+    s = QString("SELECT uniqueCount, uniqueSize FROM SetStats WHERE setID = %1").arg(_getDefaultTileSet());
     if(query.exec(s)) {
         if(query.next()) {
             _defaultCount = query.value(0).toUInt();
             _defaultSize  = query.value(1).toULongLong();
+        } else {
+            _defaultCount = 0;
+            _defaultSize  = 0;
         }
     }
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
@@ -464,17 +586,16 @@ QGCCacheWorker::_updateTotals()
 }
 
 //-----------------------------------------------------------------------------
-quint64 QGCCacheWorker::_findTile(const QString hash)
+bool QGCCacheWorker::_findTile(quint64 key, const QString& type)
 {
-    quint64 tileID = 0;
     QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
+    QString s = QString("SELECT type FROM Tiles WHERE tileID = %1").arg(key);
     if(query.exec(s)) {
         if(query.next()) {
-            tileID = query.value(0).toULongLong();
+            return query.value(0).toString() == type;
         }
     }
-    return tileID;
+    return false;
 }
 
 //-----------------------------------------------------------------------------
@@ -509,40 +630,49 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
             //-- Prepare Download List
             _db->transaction();
             for(int z = task->tileSet()->minZoom(); z <= task->tileSet()->maxZoom(); z++) {
-                QGCTileSet set = QGCMapEngine::getTileCount(z,
-                    task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
-                    task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), task->tileSet()->type());
                 QString type = task->tileSet()->type();
-                for(int x = set.tileX0; x <= set.tileX1; x++) {
-                    for(int y = set.tileY0; y <= set.tileY1; y++) {
-                        //-- See if tile is already downloaded
-                        QString hash = QGCMapEngine::getTileHash(type, x, y, z);
-                        quint64 tileID = _findTile(hash);
-                        if(!tileID) {
-                            //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(type));
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
-                                mtask->setError("Error creating tile set download list");
-                                return;
-                            } else
-                                actual_count++;
-                        } else {
-                            //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-                            }
-                            qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached HASH:" << hash;
+                QList<QPoint> tiles;
+                if(task->tileSet()->corridorPath().count()) {
+                    tiles = QGCMapEngine::getCorridorTiles(z, task->tileSet()->corridorPath(), task->tileSet()->corridorBuffer(), type);
+                } else {
+                    QGCTileSet set = QGCMapEngine::getTileCount(z,
+                        task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
+                        task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), type);
+                    for(int x = set.tileX0; x <= set.tileX1; x++) {
+                        for(int y = set.tileY0; y <= set.tileY1; y++) {
+                            tiles.append(QPoint(x, y));
+                        }
+                    }
+                }
+                for(const QPoint& tile: tiles) {
+                    const int x = tile.x();
+                    const int y = tile.y();
+                    //-- See if tile is already downloaded
+                    quint64 key = QGCMapEngine::getTileKey(type, x, y, z);
+                    if(!_findTile(key, type)) {
+                        //-- Set to download
+                        query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, tileID, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
+                        query.addBindValue(setID);
+                        query.addBindValue(static_cast<qint64>(key));
+                        query.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(type));
+                        query.addBindValue(x);
+                        query.addBindValue(y);
+                        query.addBindValue(z);
+                        query.addBindValue(0);
+                        if(!query.exec()) {
+                            qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
+                            mtask->setError("Error creating tile set download list");
+                            return;
+                        } else
+                            actual_count++;
+                    } else {
+                        //-- Tile already in the database. No need to dowload.
+                        QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(key).arg(setID);
+                        query.prepare(s);
+                        if(!query.exec()) {
+                            qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
                         }
+                        qCDebug(QGCTileCacheLog) << "_createTileSet() Already Cached KEY:" << key;
                     }
                 }
             }
@@ -566,11 +696,11 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     QList<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
+    QString s = QString("SELECT tileID, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
     if(query.exec(s)) {
         while(query.next()) {
             QGCTile* tile = new QGCTile;
-            tile->setHash(query.value("hash").toString());
+            tile->setKey(query.value("tileID").toULongLong());
             tile->setType(getQGCMapEngine()->urlFactory()->getTypeFromId(query.value("type").toInt()));
             tile->setX(query.value("x").toInt());
             tile->setY(query.value("y").toInt());
@@ -578,7 +708,7 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
             tiles.append(tile);
         }
         for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
+            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and tileID = %3").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->key());
             if(!query.exec(s)) {
                 qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
             }
@@ -598,12 +728,12 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
     QSqlQuery query(*_db);
     QString s;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
+        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND tileID = %2").arg(task->setID()).arg(task->key());
     } else {
-        if(task->hash() == "*") {
+        if(task->key() == QGCUpdateTileDownloadStateTask::allTiles) {
             s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
         } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND tileID = %3").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->key());
         }
     }
     if(!query.exec(s)) {
@@ -622,14 +752,19 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
     QSqlQuery query(*_db);
     QString s;
     //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
+    s = QString("SELECT tileID, size FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
+    //-- Tiles of the retained type (terrain) are kept until they are older than the retention period
+    if(!task->retainedType().isEmpty()) {
+        s += QString(" AND NOT (type = \"%1\" AND date > %2)").arg(task->retainedType()).arg(task->retainedSince());
+    }
+    s += " ORDER BY DATE ASC LIMIT 128";
     qint64 amount = (qint64)task->amount();
     QList<quint64> tlist;
     if(query.exec(s)) {
         while(query.next() && amount >= 0) {
             tlist << query.value(0).toULongLong();
             amount -= query.value(1).toULongLong();
-            qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
+            qCDebug(QGCTileCacheLog) << "_pruneCache() KEY:" << query.value(0).toULongLong();
         }
         while(tlist.count()) {
             s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
@@ -695,6 +830,9 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    QWriteLocker lock(&_dbLock);
+    _insertTileQuery.reset();
+    _insertSetTileQuery.reset();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -705,11 +843,19 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     query.exec(s);
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
+    s = QString("DROP TABLE CacheStats");
+    query.exec(s);
+    s = QString("DROP TABLE SetStats");
+    query.exec(s);
     _valid = _createDB(*_db);
     task->setResetCompleted();
 }
 
 //-----------------------------------------------------------------------------
+//-- Import and export stream tiles one row at a time (forward only queries) and
+//   commit every _maxBatchTasks tiles, so memory use does not depend on the size
+//   of the database and tile reads from the read pool keep seeing a consistent
+//   cache while a large import runs.
 void
 QGCCacheWorker::_importSets(QGCMapTask* mtask)
 {
@@ -719,24 +865,53 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
     QGCImportTileTask* task = static_cast<QGCImportTileTask*>(mtask);
     //-- If replacing, simply copy over it
     if(task->replace()) {
-        //-- Close and delete old database
-        _disconnectDB();
-        QFile file(_databasePath);
-        file.remove();
-        //-- Copy given database
-        QFile::copy(task->path(), _databasePath);
+        //-- Stage the new database next to the current one without holding the
+        //   lock, so tiles are still served while a large file is copied.
+        QString stagedPath = _databasePath + kImportSuffix;
+        QFile::remove(stagedPath);
+        if(!_stageImport(task->path(), stagedPath)) {
+            QFile::remove(stagedPath);
+            task->setError("Error reading import database");
+            task->setImportCompleted();
+            return;
+        }
         task->setProgress(25);
-        _init();
-        if(_valid) {
+        {
+            //-- Close and delete old database
+            QWriteLocker lock(&_dbLock);
+            _dbGeneration++;
+            _disconnectDB();
+            QFile::remove(_databasePath);
+            QFile::remove(_databasePath + "-wal");
+            QFile::remove(_databasePath + "-shm");
+            QFile::rename(stagedPath, _databasePath);
             task->setProgress(50);
-            _connectDB();
+            _init();
+            if(_valid) {
+                task->setProgress(75);
+                _connectDB();
+            }
         }
         task->setProgress(100);
     } else {
+        //-- Compressed imports are inflated to a temporary file first
+        QString importPath = task->path();
+        QString stagedPath;
+        if(_isCompressed(importPath)) {
+            stagedPath = _databasePath + kImportSuffix;
+            QFile::remove(stagedPath);
+            if(!_stageImport(importPath, stagedPath)) {
+                QFile::remove(stagedPath);
+                task->setError("Error reading import database");
+                task->setImportCompleted();
+                return;
+            }
+            importPath = stagedPath;
+        }
         //-- Open imported set
         QSqlDatabase* dbImport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-        dbImport->setDatabaseName(task->path());
-        dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+        dbImport->setDatabaseName(importPath);
+        dbImport->setConnectOptions("QSQLITE_OPEN_READONLY");
         if (dbImport->open()) {
             QSqlQuery query(*dbImport);
             //-- Prepare progress report
@@ -751,10 +926,14 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                     tileCount  = query.value(0).toULongLong();
                 }
             }
+            //-- Databases exported before tile keys still have the text tile hashes
+            const bool legacyHashes = _hasTileHashes(*dbImport);
+            QHash<int, QString> legacyTypes;
             if(tileCount) {
                 //-- Iterate Tile Sets
                 s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
                 if(query.exec(s)) {
+                    _prepareInsertQueries();
                     while(query.next()) {
                         QString name            = query.value("name").toString();
                         quint64 setID           = query.value("setID").toULongLong();
@@ -809,33 +988,38 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                             }
                         }
                         //-- Find set tiles
-                        QSqlQuery cQuery(*_db);
                         QSqlQuery subQuery(*dbImport);
-                        QString sb = QString("SELECT * FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
+                        subQuery.setForwardOnly(true);
+                        QString sb = QString("SELECT %1, format, tile, type FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %2 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(legacyHashes ? "hash" : "tileID").arg(setID);
                         if(subQuery.exec(sb)) {
                             quint64 tilesFound = 0;
                             quint64 tilesSaved = 0;
+                            int     batchCount = 0;
+                            qint64  date       = QDateTime::currentDateTime().toSecsSinceEpoch();
                             _db->transaction();
                             while(subQuery.next()) {
                                 tilesFound++;
-                                QString hash    = subQuery.value("hash").toString();
-                                QString format  = subQuery.value("format").toString();
-                                QByteArray img  = subQuery.value("tile").toByteArray();
-                                int type        = subQuery.value("type").toInt();
+                                quint64 key     = subQuery.value(0).toULongLong();
+                                QVariant type   = subQuery.value(3);
+                                if(legacyHashes && !_legacyTileKey(subQuery.value(0).toString(), key, type, legacyTypes)) {
+                                    continue;
+                                }
+                                QByteArray img  = subQuery.value(2).toByteArray();
+                                QString format  = subQuery.value(1).toString();
+                                QGCTileTranscoder::transcode(img, format, task->storageFormat(), task->storageQuality());
                                 //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
+                                QSqlQuery& cQuery = *_insertTileQuery;
+                                cQuery.addBindValue(static_cast<qint64>(key));
                                 cQuery.addBindValue(format);
                                 cQuery.addBindValue(img);
                                 cQuery.addBindValue(img.size());
                                 cQuery.addBindValue(type);
-                                cQuery.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
+                                cQuery.addBindValue(date);
                                 if(cQuery.exec()) {
                                     tilesSaved++;
-                                    quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                    QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                    cQuery.prepare(s);
-                                    cQuery.exec();
+                                    _insertSetTileQuery->addBindValue(static_cast<qint64>(key));
+                                    _insertSetTileQuery->addBindValue(insertSetID);
+                                    _insertSetTileQuery->exec();
                                     currentCount++;
                                     if(tileCount) {
                                         int progress = (int)((double)currentCount / (double)tileCount * 100.0);
@@ -846,10 +1030,17 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                                         }
                                     }
                                 }
+                                //-- Keep transactions (and the WAL) bounded
+                                if(++batchCount >= _maxBatchTasks) {
+                                    batchCount = 0;
+                                    _db->commit();
+                                    _db->transaction();
+                                }
                             }
                             _db->commit();
                             if(tilesSaved) {
                                 //-- Update tile count (if any added)
+                                QSqlQuery cQuery(*_db);
                                 s = QString("SELECT COUNT(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(insertSetID);
                                 if(cQuery.exec(s)) {
                                     if(cQuery.next()) {
@@ -882,8 +1073,13 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                 task->setError("No unique tiles in imported database");
             }
         } else {
+            delete dbImport;
+            QSqlDatabase::removeDatabase(kExportSession);
             task->setError("Error opening import database");
         }
+        if(!stagedPath.isEmpty()) {
+            QFile::remove(stagedPath);
+        }
     }
     task->setImportCompleted();
 }
@@ -896,18 +1092,27 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
         return;
     }
     QGCExportTileTask* task = static_cast<QGCExportTileTask*>(mtask);
+    //-- Compressed exports are written to a temporary database first
+    bool    compress    = _isCompressed(task->path());
+    QString exportPath  = compress ? task->path() + kExportSuffix : task->path();
     //-- Delete target if it exists
-    QFile file(task->path());
-    file.remove();
+    QFile::remove(task->path());
+    QFile::remove(exportPath);
     //-- Create exported database
     QScopedPointer<QSqlDatabase> dbExport(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession)));
-    dbExport->setDatabaseName(task->path());
-    dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+    dbExport->setDatabaseName(exportPath);
+    bool success = false;
     if (dbExport->open()) {
+        //-- The export is thrown away on failure, so there is no need for a journal
+        QSqlQuery pragma(*dbExport);
+        pragma.exec("PRAGMA journal_mode=OFF");
+        pragma.exec("PRAGMA synchronous=OFF");
         if(_createDB(*dbExport, false)) {
+            success = true;
             //-- Prepare progress report
             quint64 tileCount = 0;
             quint64 currentCount = 0;
+            int lastProgress = -1;
             for(int i = 0; i < task->sets().count(); i++) {
                 QGCCachedTileSet* set = task->sets()[i];
                 //-- Default set has no unique tiles
@@ -920,6 +1125,10 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
             if(!tileCount) {
                 tileCount = 1;
             }
+            QSqlQuery tileQuery(*dbExport);
+            tileQuery.prepare("INSERT INTO Tiles(tileID, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+            QSqlQuery setTileQuery(*dbExport);
+            setTileQuery.prepare("INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
             //-- Iterate sets to save
             for(int i = 0; i < task->sets().count(); i++) {
                 QGCCachedTileSet* set = task->sets()[i];
@@ -942,47 +1151,47 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
                 exportQuery.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
                 if(!exportQuery.exec()) {
                     task->setError("Error adding tile set to exported database");
+                    success = false;
                     break;
                 } else {
                     //-- Get just created (auto-incremented) setID
                     quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
                     //-- Find set tiles
-                    QString s = QString("SELECT * FROM SetTiles WHERE setID = %1").arg(set->id());
+                    QString s = QString("SELECT A.tileID, A.format, A.tile, A.type FROM Tiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
                     QSqlQuery query(*_db);
+                    query.setForwardOnly(true);
                     if(query.exec(s)) {
+                        int     batchCount  = 0;
+                        qint64  date        = QDateTime::currentDateTime().toSecsSinceEpoch();
                         dbExport->transaction();
                         while(query.next()) {
-                            quint64 tileID = query.value("tileID").toULongLong();
-                            //-- Get tile
-                            QString s = QString("SELECT * FROM Tiles WHERE tileID = \"%1\"").arg(tileID);
-                            QSqlQuery subQuery(*_db);
-                            if(subQuery.exec(s)) {
-                                if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
-                                    QString format  = subQuery.value("format").toString();
-                                    QByteArray img  = subQuery.value("tile").toByteArray();
-                                    int type        = subQuery.value("type").toInt();
-                                    //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
-                                    exportQuery.addBindValue(format);
-                                    exportQuery.addBindValue(img);
-                                    exportQuery.addBindValue(img.size());
-                                    exportQuery.addBindValue(type);
-                                    exportQuery.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
-                                    if(exportQuery.exec()) {
-                                        quint64 exportTileID = exportQuery.lastInsertId().toULongLong();
-                                        QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(exportTileID).arg(exportSetID);
-                                        exportQuery.prepare(s);
-                                        exportQuery.exec();
-                                        currentCount++;
-                                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
-                                    }
+                            QByteArray img  = query.value(2).toByteArray();
+                            //-- Save tile
+                            tileQuery.addBindValue(query.value(0));
+                            tileQuery.addBindValue(query.value(1).toString());
+                            tileQuery.addBindValue(img);
+                            tileQuery.addBindValue(img.size());
+                            tileQuery.addBindValue(query.value(3));
+                            tileQuery.addBindValue(date);
+                            if(tileQuery.exec()) {
+                                setTileQuery.addBindValue(query.value(0));
+                                setTileQuery.addBindValue(exportSetID);
+                                setTileQuery.exec();
+                                currentCount++;
+                                int progress = (int)((double)currentCount / (double)tileCount * 100.0);
+                                if(lastProgress != progress) {
+                                    lastProgress = progress;
+                                    task->setProgress(compress ? progress * 9 / 10 : progress);
                                 }
                             }
+                            if(++batchCount >= _maxBatchTasks) {
+                                batchCount = 0;
+                                dbExport->commit();
+                                dbExport->transaction();
+                            }
                         }
+                        dbExport->commit();
                     }
-                    dbExport->commit();
                 }
             }
         } else {
@@ -994,9 +1203,52 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
     }
     dbExport.reset();
     QSqlDatabase::removeDatabase(kExportSession);
+    if(compress) {
+        if(success && !QGCZlib::deflateGzipFile(exportPath, task->path())) {
+            QFile::remove(task->path());
+            task->setError("Error compressing export database");
+        }
+        QFile::remove(exportPath);
+    }
     task->setExportCompleted();
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_isCompressed(const QString& path)
+{
+    return path.endsWith(".gz", Qt::CaseInsensitive) ||
+           path.endsWith(".xz", Qt::CaseInsensitive) ||
+           path.endsWith(".lzma", Qt::CaseInsensitive);
+}
+
+//-----------------------------------------------------------------------------
+//-- Copies (or inflates) an import database to the given path
+bool
+QGCCacheWorker::_stageImport(const QString& path, const QString& stagedPath)
+{
+    if(path.endsWith(".gz", Qt::CaseInsensitive)) {
+        return QGCZlib::inflateGzipFile(path, stagedPath);
+    }
+    if(path.endsWith(".xz", Qt::CaseInsensitive) || path.endsWith(".lzma", Qt::CaseInsensitive)) {
+        return QGCLZMA::inflateLZMAFile(path, stagedPath);
+    }
+    return QFile::copy(path, stagedPath);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_prepareInsertQueries()
+{
+    //-- The statements are prepared once per connection and reused for every tile
+    if(!_insertTileQuery) {
+        _insertTileQuery.reset(new QSqlQuery(*_db));
+        _insertTileQuery->prepare("INSERT INTO Tiles(tileID, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+        _insertSetTileQuery.reset(new QSqlQuery(*_db));
+        _insertSetTileQuery->prepare("INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
+    }
+}
+
 //-----------------------------------------------------------------------------
 bool QGCCacheWorker::_testTask(QGCMapTask* mtask)
 {
@@ -1041,29 +1293,52 @@ QGCCacheWorker::_connectDB()
     _db->setDatabaseName(_databasePath);
     _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
     _valid = _db->open();
+    if(_valid) {
+        //-- WAL lets the read connections run while the worker is writing
+        QSqlQuery query(*_db);
+        if(!query.exec("PRAGMA journal_mode=WAL") || !query.exec("PRAGMA synchronous=NORMAL")) {
+            qCWarning(QGCTileCacheLog) << "Unable to enable WAL:" << query.lastError().text();
+        }
+    }
     return _valid;
 }
 
+//-----------------------------------------------------------------------------
+QSqlDatabase
+QGCCacheWorker::_readConnection()
+{
+    QGCCacheReadConnection* connection = readConnections.localData();
+    if(connection && connection->generation != _dbGeneration) {
+        //-- Database file was replaced, this deletes the old connection
+        readConnections.setLocalData(nullptr);
+        connection = nullptr;
+    }
+    if(!connection) {
+        connection = new QGCCacheReadConnection;
+        connection->name       = kReadSession + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        connection->generation = _dbGeneration;
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection->name);
+        db.setDatabaseName(_databasePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+        if(!db.open()) {
+            qWarning() << "Map Cache SQL error (open read connection):" << db.lastError();
+        }
+        readConnections.setLocalData(connection);
+    }
+    return QSqlDatabase::database(connection->name, false);
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
 {
     bool res = false;
     QSqlQuery query(db);
-    if(!query.exec(
-        "CREATE TABLE IF NOT EXISTS Tiles ("
-        "tileID INTEGER PRIMARY KEY NOT NULL, "
-        "hash TEXT NOT NULL UNIQUE, "
-        "format TEXT NOT NULL, "
-        "tile BLOB NULL, "
-        "size INTEGER, "
-        "type INTEGER, "
-        "date INTEGER DEFAULT 0)"))
-    {
+    if(!_migrateTileKeys(db)) {
+        qWarning() << "Map Cache SQL error (convert tile hashes)";
+    } else if(!query.exec(QString(kCreateTiles).arg("Tiles"))) {
         qWarning() << "Map Cache SQL error (create Tiles db):" << query.lastError().text();
     } else {
-        query.exec("CREATE INDEX IF NOT EXISTS hash ON Tiles ( hash, size, type ) ");
-             
         if(!query.exec(
             "CREATE TABLE IF NOT EXISTS TileSets ("
             "setID INTEGER PRIMARY KEY NOT NULL, "
@@ -1089,20 +1364,11 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
             {
                 qWarning() << "Map Cache SQL error (create SetTiles db):" << query.lastError().text();
             } else {
-                if(!query.exec(
-                    "CREATE TABLE IF NOT EXISTS TilesDownload ("
-                    "setID INTEGER, "
-                    "hash TEXT NOT NULL UNIQUE, "
-                    "type INTEGER, "
-                    "x INTEGER, "
-                    "y INTEGER, "
-                    "z INTEGER, "
-                    "state INTEGER DEFAULT 0)"))
-                {
+                if(!query.exec(QString(kCreateTilesDownload).arg("TilesDownload"))) {
                     qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
                 } else {
                     //-- Database it ready for use
-                    res = true;
+                    res = _createStats(db);
                 }
             }
         }
@@ -1132,10 +1398,275 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
     return res;
 }
 
+//-----------------------------------------------------------------------------
+//-- True for caches from before tile keys, which look tiles up by a text hash
+bool
+QGCCacheWorker::_hasTileHashes(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    if(query.exec("PRAGMA table_info(Tiles)")) {
+        while(query.next()) {
+            if(query.value("name").toString() == "hash") {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//-- Key of a tile from a cache from before tile keys. Older exports did not keep
+//   the map type name, so type is replaced by the one the hash was made for.
+//   types holds the names already looked up, by map id.
+bool
+QGCCacheWorker::_legacyTileKey(const QString& hash, quint64& key, QVariant& type, QHash<int, QString>& types)
+{
+    int mapId;
+    if(!QGCMapEngine::legacyHashToKey(hash, key, mapId)) {
+        qCDebug(QGCTileCacheLog) << "Dropping tile with invalid hash" << hash;
+        return false;
+    }
+    auto it = types.find(mapId);
+    if(it == types.end()) {
+        it = types.insert(mapId, getQGCMapEngine()->urlFactory()->getTypeFromId(mapId));
+    }
+    if(!it->isEmpty()) {
+        type = *it;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//-- Caches from before tile keys are converted in place, in one transaction.
+//   Tiles are copied with their key as tileID and SetTiles and TilesDownload
+//   follow. The stats triggers refer to the tables being replaced, so they are
+//   dropped here and _createStats puts them back along with a full recount.
+bool
+QGCCacheWorker::_migrateTileKeys(QSqlDatabase& db)
+{
+    if(!_hasTileHashes(db)) {
+        return true;
+    }
+    static const char* prepareStatements[] = {
+        "DROP TRIGGER IF EXISTS TilesInsertStats",
+        "DROP TRIGGER IF EXISTS TilesDeleteStats",
+        "DROP TRIGGER IF EXISTS SetTilesInsertStats",
+        "DROP TRIGGER IF EXISTS SetTilesDeleteStats",
+        "DROP TABLE IF EXISTS CacheStats",
+        "DROP TABLE IF EXISTS TileKeys",
+        "DROP TABLE IF EXISTS TilesKeyed",
+        "DROP TABLE IF EXISTS TilesDownloadKeyed",
+        "CREATE TABLE TileKeys (tileID INTEGER PRIMARY KEY NOT NULL, tileKey INTEGER NOT NULL, type INTEGER)",
+    };
+    static const char* replaceStatements[] = {
+        "INSERT OR IGNORE INTO TilesKeyed(tileID, format, tile, size, type, date) "
+            "SELECT K.tileKey, T.format, T.tile, T.size, K.type, T.date FROM Tiles T INNER JOIN TileKeys K ON T.tileID = K.tileID",
+        "UPDATE SetTiles SET tileID = (SELECT tileKey FROM TileKeys WHERE TileKeys.tileID = SetTiles.tileID)",
+        "DELETE FROM SetTiles WHERE tileID IS NULL",
+        "DROP TABLE Tiles",
+        "ALTER TABLE TilesKeyed RENAME TO Tiles",
+        "DROP TABLE TilesDownload",
+        "ALTER TABLE TilesDownloadKeyed RENAME TO TilesDownload",
+        "DROP TABLE TileKeys",
+    };
+    qCDebug(QGCTileCacheLog) << "_migrateTileKeys()";
+    bool transaction = db.transaction();
+    bool res = true;
+    QSqlQuery query(db);
+    for(const char* statement: prepareStatements) {
+        if(!query.exec(statement)) {
+            res = false;
+            break;
+        }
+    }
+    //-- Keys are worked out here, there is no xor in SQLite
+    if(res) {
+        QHash<int, QString> types;
+        QSqlQuery keyQuery(db);
+        res = keyQuery.prepare("INSERT INTO TileKeys(tileID, tileKey, type) VALUES(?, ?, ?)") && query.exec("SELECT tileID, hash, type FROM Tiles");
+        while(res && query.next()) {
+            quint64  key;
+            QVariant type = query.value(2);
+            if(!_legacyTileKey(query.value(1).toString(), key, type, types)) {
+                continue;
+            }
+            keyQuery.addBindValue(query.value(0));
+            keyQuery.addBindValue(static_cast<qint64>(key));
+            keyQuery.addBindValue(type);
+            res = keyQuery.exec();
+        }
+    }
+    if(res) {
+        QSqlQuery downloadQuery(db);
+        res = query.exec(QString(kCreateTilesDownload).arg("TilesDownloadKeyed")) &&
+              downloadQuery.prepare("INSERT OR IGNORE INTO TilesDownloadKeyed(setID, tileID, type, x, y, z, state) VALUES(?, ?, ?, ?, ?, ?, ?)") &&
+              query.exec("SELECT setID, type, x, y, z, state FROM TilesDownload");
+        while(res && query.next()) {
+            const int x = query.value(2).toInt();
+            const int y = query.value(3).toInt();
+            const int z = query.value(4).toInt();
+            downloadQuery.addBindValue(query.value(0));
+            downloadQuery.addBindValue(static_cast<qint64>(QGCMapEngine::getTileKey(query.value(1).toInt(), x, y, z)));
+            downloadQuery.addBindValue(query.value(1));
+            downloadQuery.addBindValue(x);
+            downloadQuery.addBindValue(y);
+            downloadQuery.addBindValue(z);
+            downloadQuery.addBindValue(query.value(5));
+            res = downloadQuery.exec();
+        }
+    }
+    if(res) {
+        res = query.exec(QString(kCreateTiles).arg("TilesKeyed"));
+    }
+    if(res) {
+        for(const char* statement: replaceStatements) {
+            if(!query.exec(statement)) {
+                res = false;
+                break;
+            }
+        }
+    }
+    if(!res) {
+        qWarning() << "Map Cache SQL error (convert tile hashes):" << query.lastError().text();
+        if(transaction) {
+            db.rollback();
+        }
+        return false;
+    }
+    if(transaction && !db.commit()) {
+        qWarning() << "Map Cache SQL error (convert tile hashes commit):" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//-- Tile counts and sizes are kept in CacheStats (whole cache) and SetStats (per
+//   set) by triggers, so they change in the same transaction as the tiles and
+//   never need a scan of the Tiles table. A tile is unique to a set if it has a
+//   single SetTiles row. Deleting a tile removes its SetTiles rows first, while
+//   its size can still be looked up.
+bool
+QGCCacheWorker::_createStats(QSqlDatabase& db)
+{
+    static const char* statements[] = {
+        "CREATE INDEX IF NOT EXISTS SetTilesTileID ON SetTiles ( tileID )",
+        "CREATE TABLE IF NOT EXISTS CacheStats ("
+            "id INTEGER PRIMARY KEY NOT NULL, "
+            "tileCount INTEGER DEFAULT 0, "
+            "tileSize INTEGER DEFAULT 0)",
+        "CREATE TABLE IF NOT EXISTS SetStats ("
+            "setID INTEGER PRIMARY KEY NOT NULL, "
+            "tileCount INTEGER DEFAULT 0, "
+            "tileSize INTEGER DEFAULT 0, "
+            "uniqueCount INTEGER DEFAULT 0, "
+            "uniqueSize INTEGER DEFAULT 0)",
+        "CREATE TRIGGER IF NOT EXISTS TilesInsertStats AFTER INSERT ON Tiles BEGIN "
+            "UPDATE CacheStats SET tileCount = tileCount + 1, tileSize = tileSize + IFNULL(NEW.size, 0) WHERE id = 0; "
+            "END",
+        "CREATE TRIGGER IF NOT EXISTS TilesDeleteStats BEFORE DELETE ON Tiles BEGIN "
+            "DELETE FROM SetTiles WHERE tileID = OLD.tileID; "
+            "UPDATE CacheStats SET tileCount = tileCount - 1, tileSize = tileSize - IFNULL(OLD.size, 0) WHERE id = 0; "
+            "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesInsertStats AFTER INSERT ON SetTiles BEGIN "
+            "INSERT OR IGNORE INTO SetStats(setID) VALUES(NEW.setID); "
+            "UPDATE SetStats SET tileCount = tileCount + 1, tileSize = tileSize + IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+                "WHERE setID = NEW.setID; "
+            //-- Tile is now unique to this set
+            "UPDATE SetStats SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+                "WHERE setID = NEW.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 1; "
+            //-- Tile is no longer unique to the set which already had it
+            "UPDATE SetStats SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+                "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = NEW.tileID AND rowid != NEW.rowid) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 2; "
+            "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesDeleteStats AFTER DELETE ON SetTiles BEGIN "
+            "UPDATE SetStats SET tileCount = tileCount - 1, tileSize = tileSize - IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+                "WHERE setID = OLD.setID; "
+            //-- Tile was unique to this set
+            "UPDATE SetStats SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+                "WHERE setID = OLD.setID AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 0; "
+            //-- Tile is now unique to the set which still has it
+            "UPDATE SetStats SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+                "WHERE setID = (SELECT setID FROM SetTiles WHERE tileID = OLD.tileID) AND (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 1; "
+            "END",
+        "CREATE TRIGGER IF NOT EXISTS TileSetsDeleteStats AFTER DELETE ON TileSets BEGIN "
+            "DELETE FROM SetStats WHERE setID = OLD.setID; "
+            "END",
+    };
+    QSqlQuery query(db);
+    for(const char* statement: statements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create stats):" << query.lastError().text();
+            return false;
+        }
+    }
+    //-- Databases created before the stats existed need a one time count
+    if(query.exec("SELECT COUNT(*) FROM CacheStats") && query.next() && query.value(0).toInt() == 0) {
+        return _recountStats(db);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//-- Full recount of the stats tables. This scans the whole cache so it is only
+//   done for databases which don't have stats yet or on explicit repair.
+bool
+QGCCacheWorker::_recountStats(QSqlDatabase& db)
+{
+    static const char* statements[] = {
+        //-- Older versions left SetTiles rows behind when pruning tiles, those would throw off the triggers
+        "DELETE FROM SetTiles WHERE tileID NOT IN (SELECT tileID FROM Tiles)",
+        "DELETE FROM CacheStats",
+        "INSERT INTO CacheStats(id, tileCount, tileSize) SELECT 0, COUNT(*), IFNULL(SUM(size), 0) FROM Tiles",
+        "DELETE FROM SetStats",
+        "INSERT INTO SetStats(setID, tileCount, tileSize) "
+            "SELECT B.setID, COUNT(*), IFNULL(SUM(A.size), 0) FROM Tiles A INNER JOIN SetTiles B ON A.tileID = B.tileID GROUP BY B.setID",
+        "UPDATE SetStats SET "
+            "uniqueCount = (SELECT COUNT(*) FROM Tiles A INNER JOIN SetTiles B ON A.tileID = B.tileID "
+                "WHERE B.setID = SetStats.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = B.tileID) = 1), "
+            "uniqueSize = (SELECT IFNULL(SUM(A.size), 0) FROM Tiles A INNER JOIN SetTiles B ON A.tileID = B.tileID "
+                "WHERE B.setID = SetStats.setID AND (SELECT COUNT(*) FROM SetTiles C WHERE C.tileID = B.tileID) = 1)",
+    };
+    qCDebug(QGCTileCacheLog) << "_recountStats()";
+    bool transaction = db.transaction();
+    QSqlQuery query(db);
+    for(const char* statement: statements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (recount stats):" << query.lastError().text();
+            if(transaction) {
+                db.rollback();
+            }
+            return false;
+        }
+    }
+    if(transaction && !db.commit()) {
+        qWarning() << "Map Cache SQL error (recount stats commit):" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_repairStats(QGCMapTask* mtask)
+{
+    if(!_testTask(mtask)) {
+        return;
+    }
+    if(!_recountStats(*_db)) {
+        mtask->setError("Error recounting cache totals");
+        return;
+    }
+    _updateTotals();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_disconnectDB()
 {
+    _commitBatch();
+    _insertTileQuery.reset();
+    _insertSetTileQuery.reset();
     if (_db) {
         _db.reset();
         QSqlDatabase::removeDatabase(kSession);
@@ -20,11 +20,17 @@
 #define QGC_TILE_CACHE_WORKER_H
 
 #include <QString>
+#include <QHash>
+#include <QVariant>
 #include <QThread>
 #include <QQueue>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QMutexLocker>
+#include <QThreadPool>
+#include <QReadWriteLock>
+#include <QElapsedTimer>
+#include <QtSql/QSqlQuery>
 #include <QtSql/QSqlDatabase>
 #include <QHostInfo>
 
@@ -36,9 +42,13 @@ class QGCMapTask;
 class QGCCachedTileSet;
 
 //-----------------------------------------------------------------------------
+// The database is opened in WAL mode. All writes and maintenance go through the
+// worker thread's connection, while tile fetches are served in parallel by a
+// pool of read-only connections so map panning doesn't wait behind downloads.
 class QGCCacheWorker : public QThread
 {
     Q_OBJECT
+    friend class QGCCacheReadTask;
 public:
     QGCCacheWorker  ();
     ~QGCCacheWorker ();
@@ -55,6 +65,8 @@ private slots:
 
 private:
     void        _runTask                (QGCMapTask* task);
+    void        _runBatchedTask         (QGCMapTask* task);
+    void        _commitBatch            ();
 
     void        _saveTile               (QGCMapTask* mtask);
     void        _getTile                (QGCMapTask* mtask);
@@ -68,21 +80,32 @@ private:
     void        _pruneCache             (QGCMapTask* mtask);
     void        _exportSets             (QGCMapTask* mtask);
     void        _importSets             (QGCMapTask* mtask);
+    bool        _stageImport            (const QString& path, const QString& stagedPath);
+    void        _prepareInsertQueries   ();
     bool        _testTask               (QGCMapTask* mtask);
     void        _testInternet           ();
     void        _deleteBingNoTileTiles  ();
 
-    quint64     _findTile               (const QString hash);
+    bool        _findTile               (quint64 key, const QString& type);
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
     bool        _connectDB              ();
+    QSqlDatabase _readConnection        ();
     bool        _createDB               (QSqlDatabase& db, bool createDefault = true);
+    bool        _migrateTileKeys        (QSqlDatabase& db);
+    bool        _createStats            (QSqlDatabase& db);
+    bool        _recountStats           (QSqlDatabase& db);
+    void        _repairStats            (QGCMapTask* mtask);
     void        _disconnectDB           ();
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
     void        _deleteTileSet          (qulonglong id);
 
+    static bool _isCompressed           (const QString& path);
+    static bool _hasTileHashes          (QSqlDatabase& db);
+    static bool _legacyTileKey          (const QString& hash, quint64& key, QVariant& type, QHash<int, QString>& types);
+
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void        internetStatus          (bool active);
@@ -103,6 +126,19 @@ private:
     time_t                          _lastUpdate;
     int                             _updateTimeout;
     int                             _hostLookupID;
+    QThreadPool                     _readPool;
+    QReadWriteLock                  _dbLock;            ///< Held for write while the database file or schema is replaced
+    std::atomic_int                 _dbGeneration;      ///< Incremented when read connections must be reopened
+
+    bool                            _batchOpen          = false;
+    int                             _batchTaskCount     = 0;
+    QElapsedTimer                   _batchTimer;
+    QScopedPointer<QSqlQuery>       _insertTileQuery;
+    QScopedPointer<QSqlQuery>       _insertSetTileQuery;
+
+    static const int                _readConnectionCount    = 4;
+    static const int                _maxBatchTasks          = 1000; ///< Max tile saves/state updates committed in one transaction
+    static const int                _maxBatchMSecs          = 500;  ///< Max time a transaction is kept open
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
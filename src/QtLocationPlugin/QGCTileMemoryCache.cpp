@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileMemoryCache.h"
+
+#include <QMutexLocker>
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::QGCTileMemoryCache()
+    : _hits(0)
+    , _misses(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileMemoryCache::find(quint64 key, QByteArray& image, QString& format)
+{
+    Shard_t& shard = _shard(key);
+    QMutexLocker lock(&shard.mutex);
+    Tile_t* tile = shard.tiles.object(key);
+    if(!tile) {
+        _misses++;
+        return false;
+    }
+    image  = tile->image;
+    format = tile->format;
+    _hits++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::insert(quint64 key, const QByteArray& image, const QString& format)
+{
+    if(image.isEmpty()) {
+        return;
+    }
+    Shard_t& shard = _shard(key);
+    QMutexLocker lock(&shard.mutex);
+    shard.tiles.insert(key, new Tile_t{ image, format }, image.size());
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::clear()
+{
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::setMaxBytes(int maxBytes)
+{
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.setMaxCost(maxBytes / _shardCount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+qint64
+QGCTileMemoryCache::bytes()
+{
+    qint64 total = 0;
+    for(Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        total += shard.tiles.totalCost();
+    }
+    return total;
+}
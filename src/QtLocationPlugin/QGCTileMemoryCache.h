@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Size bounded LRU of recently used map tiles, keyed by QGCMapEngine::getTileKey.
+// It sits in front of the cache database so tiles which were just shown never go
+// through the worker queue or SQLite again. Tile replies are created on several
+// threads, so the cache is split into shards with their own lock to keep
+// contention down.
+class QGCTileMemoryCache
+{
+public:
+    QGCTileMemoryCache  ();
+
+    /// @return true if the tile was found, image and format are filled in
+    bool    find        (quint64 key, QByteArray& image, QString& format);
+    void    insert      (quint64 key, const QByteArray& image, const QString& format);
+    void    clear       ();
+
+    void    setMaxBytes (int maxBytes);
+    qint64  bytes       ();
+    quint64 hits        () const { return _hits; }
+    quint64 misses      () const { return _misses; }
+
+private:
+    typedef struct {
+        QByteArray  image;
+        QString     format;
+    } Tile_t;
+
+    typedef struct {
+        QMutex                  mutex;
+        QCache<quint64, Tile_t> tiles;  ///< Cost is the image size in bytes
+    } Shard_t;
+
+    Shard_t& _shard(quint64 key) { return _shards[qHash(key) % _shardCount]; }
+
+    static const int        _shardCount = 8;
+    Shard_t                 _shards[_shardCount];
+    std::atomic<quint64>    _hits;
+    std::atomic<quint64>    _misses;
+};
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileTranscoder.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+
+//-----------------------------------------------------------------------------
+QStringList
+QGCTileTranscoder::availableFormats()
+{
+    static const QStringList formats = []() {
+        QStringList list;
+        const QList<QByteArray> supported = QImageWriter::supportedImageFormats();
+        if(supported.contains("webp")) {
+            list << QStringLiteral("webp");
+        }
+        if(supported.contains("jpg")) {
+            list << QStringLiteral("jpg");
+        }
+        return list;
+    }();
+    return formats;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileTranscoder::transcode(QByteArray& image, QString& format, const QString& targetFormat, int quality)
+{
+    if(image.isEmpty() || targetFormat.isEmpty() || !availableFormats().contains(targetFormat)) {
+        return false;
+    }
+    //-- Only raster map tiles, elevation tiles are binary data
+    if(format != "png" && format != "jpg" && format != "jpeg" && format != "gif" && format != "webp") {
+        return false;
+    }
+    if(format == targetFormat || (format == "jpeg" && targetFormat == "jpg")) {
+        return false;
+    }
+    QImage decoded;
+    if(!decoded.loadFromData(image)) {
+        return false;
+    }
+    //-- JPEG has no alpha channel, overlays and partially covered tiles would turn black
+    if(targetFormat == "jpg" && decoded.hasAlphaChannel()) {
+        return false;
+    }
+    QByteArray encoded;
+    QBuffer buffer(&encoded);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, targetFormat.toLatin1());
+    writer.setQuality(quality);
+    if(!writer.write(decoded)) {
+        return false;
+    }
+    //-- Palette PNGs of street maps are often already smaller than anything lossy
+    if(encoded.size() >= image.size()) {
+        return false;
+    }
+    image  = encoded;
+    format = targetFormat;
+    return true;
+}
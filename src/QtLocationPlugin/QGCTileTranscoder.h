@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+//-----------------------------------------------------------------------------
+// Re-encodes map tiles into a denser format before they go into the cache
+// database. WebP is used when the Qt image format plugin for it is there,
+// otherwise JPEG. Tiles already in the storage format, tiles which are not
+// images (elevation data) and tiles with transparency which the storage
+// format can't hold are left alone. Reentrant, used from worker threads.
+class QGCTileTranscoder
+{
+public:
+    /// @return Storage formats which can be written, best first
+    static QStringList  availableFormats    ();
+
+    /// Re-encodes image to targetFormat. On success image and format are replaced with the result.
+    /// @return true if the tile was transcoded, false if it is kept as it is
+    static bool         transcode           (QByteArray& image, QString& format, const QString& targetFormat, int quality);
+};
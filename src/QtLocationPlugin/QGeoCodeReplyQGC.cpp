@@ -54,6 +54,7 @@
 #include <QtPositioning/QGeoLocation>
 #include <QtPositioning/QGeoRectangle>
 #include <QSet>
+#include <QTimer>
 #include <QDebug>
 
 enum QGCGeoCodeType {
@@ -166,6 +167,16 @@ QGeoCodeReplyQGC::QGeoCodeReplyQGC(QNetworkReply *reply, QObject *parent)
     setOffset(0);
 }
 
+QGeoCodeReplyQGC::QGeoCodeReplyQGC(const QList<QGeoLocation> &locations, QObject *parent)
+:   QGeoCodeReply(parent), m_reply(0)
+{
+    setLimit(locations.count());
+    setOffset(0);
+    setLocations(locations);
+    // Callers connect to finished after the reply is returned
+    QTimer::singleShot(0, this, [this]() { setFinished(true); });
+}
+
 QGeoCodeReplyQGC::~QGeoCodeReplyQGC()
 {
     if (m_reply)
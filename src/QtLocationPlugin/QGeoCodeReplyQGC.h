@@ -56,6 +56,8 @@ class QGeoCodeReplyQGC : public QGeoCodeReply
 
 public:
     explicit QGeoCodeReplyQGC(QNetworkReply *reply, QObject *parent = 0);
+    /// Reply for locations which are already known, finishes once the event loop runs
+    explicit QGeoCodeReplyQGC(const QList<QGeoLocation> &locations, QObject *parent = 0);
     ~QGeoCodeReplyQGC();
 
     void abort();
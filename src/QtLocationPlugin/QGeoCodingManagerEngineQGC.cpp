@@ -46,11 +46,14 @@
 
 #include "QGeoCodingManagerEngineQGC.h"
 #include "QGeoCodeReplyQGC.h"
+#include "QGCGeoCodeCache.h"
+#include "QGCMapEngine.h"
 
 #include <QtCore/QVariantMap>
 #include <QtCore/QUrl>
 #include <QtCore/QUrlQuery>
 #include <QtCore/QLocale>
+#include <QtCore/QFile>
 #include <QDebug>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkRequest>
@@ -59,6 +62,9 @@
 #include <QtPositioning/QGeoShape>
 #include <QtPositioning/QGeoRectangle>
 
+static const char* kForwardQueryProperty = "qgcGeoCodeQuery";
+static const char* kReverseQueryProperty = "qgcReverseGeoCodeQuery";
+
 static QString addressToQuery(const QGeoAddress &address)
 {
     return address.street()     + QStringLiteral(", ") +
@@ -86,6 +92,14 @@ QGeoCodingManagerEngineQGC::QGeoCodingManagerEngineQGC(
         m_userAgent = parameters.value(QStringLiteral("useragent")).toString().toLatin1();
     else
         m_userAgent = "Qt Location based application";
+
+    const QString cachePath = getQGCMapEngine()->getCachePath();
+    m_cache = new QGCGeoCodeCache(cachePath.isEmpty() ? QString() : cachePath + QStringLiteral("/QGCGeoCodeCache.json"), this);
+    // Custom builds can bundle a gazetteer, it can also be passed as a plugin parameter
+    if (QFile::exists(QStringLiteral(":/res/gazetteer.txt")))
+        m_cache->importGazetteer(QStringLiteral(":/res/gazetteer.txt"));
+    if (parameters.contains(QStringLiteral("qgc.gazetteer")))
+        m_cache->importGazetteer(parameters.value(QStringLiteral("qgc.gazetteer")).toString());
     *error = QGeoServiceProvider::NoError;
     errorString->clear();
 }
@@ -101,9 +115,15 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::geocode(const QGeoAddress &address, c
 
 QGeoCodeReply *QGeoCodingManagerEngineQGC::geocode(const QString &address, int limit, int offset, const QGeoShape &bounds)
 {
-    Q_UNUSED(limit);
     Q_UNUSED(offset);
 
+    QList<QGeoLocation> locations;
+    if (m_cache->find(address, limit, locations)) {
+        QGeoCodeReply *cachedReply = new QGeoCodeReplyQGC(locations);
+        connectReply(cachedReply);
+        return cachedReply;
+    }
+
     QNetworkRequest request;
     request.setRawHeader("User-Agent", m_userAgent);
 
@@ -124,10 +144,8 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::geocode(const QString &address, int l
     reply->setParent(0);
 
     QGeoCodeReplyQGC *geocodeReply = new QGeoCodeReplyQGC(reply);
-
-    connect(geocodeReply, &QGeoCodeReply::finished, this, &QGeoCodingManagerEngineQGC::replyFinished);
-    connect(geocodeReply, SIGNAL(error(QGeoCodeReply::Error,QString)),
-            this, SLOT(replyError(QGeoCodeReply::Error,QString)));
+    geocodeReply->setProperty(kForwardQueryProperty, address);
+    connectReply(geocodeReply);
 
     return geocodeReply;
 }
@@ -136,6 +154,13 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::reverseGeocode(const QGeoCoordinate &
 {
     Q_UNUSED(bounds)
 
+    QList<QGeoLocation> locations;
+    if (m_cache->findReverse(coordinate, locations)) {
+        QGeoCodeReply *cachedReply = new QGeoCodeReplyQGC(locations);
+        connectReply(cachedReply);
+        return cachedReply;
+    }
+
     QNetworkRequest request;
     request.setRawHeader("User-Agent", m_userAgent);
 
@@ -155,19 +180,32 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::reverseGeocode(const QGeoCoordinate &
     reply->setParent(0);
 
     QGeoCodeReplyQGC *geocodeReply = new QGeoCodeReplyQGC(reply);
-
-    connect(geocodeReply, &QGeoCodeReply::finished, this, &QGeoCodingManagerEngineQGC::replyFinished);
-    connect(geocodeReply, SIGNAL(error(QGeoCodeReply::Error,QString)),
-            this, SLOT(replyError(QGeoCodeReply::Error,QString)));
+    geocodeReply->setProperty(kReverseQueryProperty, QVariant::fromValue(coordinate));
+    connectReply(geocodeReply);
 
     return geocodeReply;
 }
 
+void QGeoCodingManagerEngineQGC::connectReply(QGeoCodeReply *reply)
+{
+    connect(reply, &QGeoCodeReply::finished, this, &QGeoCodingManagerEngineQGC::replyFinished);
+    connect(reply, SIGNAL(error(QGeoCodeReply::Error,QString)),
+            this, SLOT(replyError(QGeoCodeReply::Error,QString)));
+}
+
 void QGeoCodingManagerEngineQGC::replyFinished()
 {
     QGeoCodeReply *reply = qobject_cast<QGeoCodeReply *>(sender());
-    if (reply)
+    if (reply) {
+        // Only network replies carry the query, cached ones are already known
+        const QVariant forwardQuery = reply->property(kForwardQueryProperty);
+        const QVariant reverseQuery = reply->property(kReverseQueryProperty);
+        if (forwardQuery.isValid())
+            m_cache->insert(forwardQuery.toString(), reply->locations());
+        else if (reverseQuery.isValid())
+            m_cache->insertReverse(reverseQuery.value<QGeoCoordinate>(), reply->locations());
         emit finished(reply);
+    }
 }
 
 void QGeoCodingManagerEngineQGC::replyError(QGeoCodeReply::Error errorCode, const QString &errorString)
@@ -54,6 +54,7 @@
 QT_BEGIN_NAMESPACE
 
 class QNetworkAccessManager;
+class QGCGeoCodeCache;
 
 class QGeoCodingManagerEngineQGC : public QGeoCodingManagerEngine
 {
@@ -72,8 +73,11 @@ private Q_SLOTS:
     void replyError     (QGeoCodeReply::Error errorCode, const QString &errorString);
 
 private:
+    void connectReply(QGeoCodeReply *reply);
+
     QNetworkAccessManager *m_networkManager;
     QByteArray m_userAgent;
+    QGCGeoCodeCache *m_cache;
 };
 
 QT_END_NAMESPACE
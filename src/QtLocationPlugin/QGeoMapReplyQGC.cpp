@@ -47,6 +47,7 @@
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGeoTileFetcherQGC.h"
+#include "QGCTileArchive.h"
 
 #include <QtLocation/private/qgeotilespec_p.h>
 #include <QtNetwork/QNetworkAccessManager>
@@ -55,13 +56,17 @@
 
 int         QGeoTiledMapReplyQGC::_requestCount = 0;
 QByteArray  QGeoTiledMapReplyQGC::_bingNoTileImage;
+QHash<quint64, QList<QGeoTiledMapReplyQGC*>> QGeoTiledMapReplyQGC::_cacheLookups;
 
 //-----------------------------------------------------------------------------
-QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager, const QNetworkRequest &request, const QGeoTileSpec &spec, QObject *parent)
+QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager, const QNetworkRequest &request, const QGeoTileSpec &spec, QGeoTileFetcherQGC* fetcher, QObject *parent)
     : QGeoTiledMapReply(spec, parent)
     , _reply(nullptr)
+    , _key(0)
     , _request(request)
     , _networkManager(networkManager)
+    , _fetcher(fetcher)
+    , _aborted(false)
 {
     if (_bingNoTileImage.count() == 0) {
         QFile file(":/res/BingNoTileBytes.dat");
@@ -80,17 +85,89 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
         setFinished(true);
         setCached(false);
     } else {
-        QGCFetchTileTask* task = getQGCMapEngine()->createFetchTileTask(getQGCMapEngine()->urlFactory()->getTypeFromId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
-        connect(task, &QGCFetchTileTask::tileFetched, this, &QGeoTiledMapReplyQGC::cacheReply);
-        connect(task, &QGCMapTask::error, this, &QGeoTiledMapReplyQGC::cacheError);
-        getQGCMapEngine()->addTask(task);
+        QByteArray  image;
+        QString     format;
+        _key = QGCMapEngine::getTileKey(spec.mapId(), spec.x(), spec.y(), spec.zoom());
+        //-- Elevation tiles are kept decoded by the terrain tile manager, so only map tiles go through the memory cache
+        if(!getQGCMapEngine()->urlFactory()->isElevation(spec.mapId()) && getQGCMapEngine()->memoryCache()->find(_key, image, format)) {
+            setMapImageData(image);
+            setMapImageFormat(format);
+            setFinished(true);
+            setCached(true);
+        } else {
+            _lookupCache();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QGCTileArchive* archive, const QGeoTileSpec &spec, QObject *parent)
+    : QGeoTiledMapReply(spec, parent)
+    , _reply(nullptr)
+    , _key(0)
+    , _networkManager(nullptr)
+    , _aborted(false)
+{
+    QByteArray image;
+    if(archive->tile(spec.x(), spec.y(), spec.zoom(), image)) {
+        setMapImageData(image);
+        setMapImageFormat(archive->format());
+        setCached(true);
+    } else {
+        //-- Outside of the basemap. As with Bing, an error lets Qt fall back to the tiles it has.
+        setError(QGeoTiledMapReply::CommunicationError, "Tile not in basemap");
     }
+    setFinished(true);
 }
 
 //-----------------------------------------------------------------------------
 QGeoTiledMapReplyQGC::~QGeoTiledMapReplyQGC()
 {
+    _removeCacheLookup();
     _clearReply();
+    if (_fetcher) {
+        _fetcher->removeNetworkRequest(this);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_lookupCache()
+{
+    //-- Another reply is already waiting for this tile, share its lookup
+    auto it = _cacheLookups.find(_key);
+    if (it != _cacheLookups.end()) {
+        it->append(this);
+        return;
+    }
+    _cacheLookups[_key].append(this);
+    const quint64 key = _key;
+    QGCFetchTileTask* task = new QGCFetchTileTask(_key, getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()));
+    connect(task, &QGCFetchTileTask::tileFetched, getQGCMapEngine(), [key](QGCCacheTile* tile) {
+        const QList<QGeoTiledMapReplyQGC*> replies = _cacheLookups.take(key);
+        for (QGeoTiledMapReplyQGC* reply : replies) {
+            reply->cacheReply(tile);
+        }
+        tile->deleteLater();
+    });
+    connect(task, &QGCMapTask::error, getQGCMapEngine(), [key](QGCMapTask::TaskType type, QString errorString) {
+        const QList<QGeoTiledMapReplyQGC*> replies = _cacheLookups.take(key);
+        for (QGeoTiledMapReplyQGC* reply : replies) {
+            reply->cacheError(type, errorString);
+        }
+    });
+    getQGCMapEngine()->addTask(task);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_removeCacheLookup()
+{
+    //-- The entry stays until the lookup is done so new requests for the tile still join it
+    auto it = _cacheLookups.find(_key);
+    if (it != _cacheLookups.end()) {
+        it->removeAll(this);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -102,6 +179,9 @@ QGeoTiledMapReplyQGC::_clearReply()
         _reply->deleteLater();
         _reply = nullptr;
         _requestCount--;
+        if (_fetcher) {
+            _fetcher->removeNetworkRequest(this);
+        }
     }
 }
 
@@ -109,10 +189,20 @@ QGeoTiledMapReplyQGC::_clearReply()
 void
 QGeoTiledMapReplyQGC::abort()
 {
+    //-- The tile left the view. Drop it from the cache lookup and the network queue as well, not just the transfer.
+    _aborted = true;
     _timer.stop();
+    _removeCacheLookup();
+    if (_fetcher) {
+        _fetcher->removeNetworkRequest(this);
+    }
     if (_reply)
         _reply->abort();
     emit aborted();
+    //-- The fetcher only deletes finished replies
+    if (!isFinished()) {
+        setFinished(true);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -133,7 +223,8 @@ QGeoTiledMapReplyQGC::networkReplyFinished()
     QString format = urlFactory->getImageFormat(tileSpec().mapId(), a);
     //-- Test for a specialized, elevation data (not map tile)
     if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
-        a = TerrainTile::serializeFromAirMapJson(a);
+        ElevationProvider* elevationProvider = qobject_cast<ElevationProvider*>(urlFactory->getMapProviderFromId(tileSpec().mapId()));
+        a = elevationProvider ? elevationProvider->serializeTile(a) : QByteArray();
         //-- Cache it if valid
         if(!a.isEmpty()) {
             getQGCMapEngine()->cacheTile(
@@ -155,6 +246,7 @@ QGeoTiledMapReplyQGC::networkReplyFinished()
             setMapImageData(a);
             if(!format.isEmpty()) {
                 setMapImageFormat(format);
+                getQGCMapEngine()->memoryCache()->insert(_key, a, format);
                 getQGCMapEngine()->cacheTile(getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), a, format);
             }
         }
@@ -189,6 +281,9 @@ QGeoTiledMapReplyQGC::networkReplyError(QNetworkReply::NetworkError error)
 void
 QGeoTiledMapReplyQGC::cacheError(QGCMapTask::TaskType type, QString /*errorString*/)
 {
+    if(_aborted) {
+        return;
+    }
     if(!getQGCMapEngine()->isInternetActive()) {
         if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
             emit terrainDone(QByteArray(), QNetworkReply::NetworkSessionFailedError);
@@ -201,42 +296,59 @@ QGeoTiledMapReplyQGC::cacheError(QGCMapTask::TaskType type, QString /*errorStrin
             qWarning() << "QGeoTiledMapReplyQGC::cacheError() for wrong task";
         }
         //-- Tile not in cache. Get it off the Internet.
+        if(_fetcher) {
+            _fetcher->queueNetworkRequest(this);
+        } else {
+            startNetworkRequest();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::startNetworkRequest()
+{
+    if(_aborted || _reply) {
+        return;
+    }
 #if !defined(__mobile__)
-        QNetworkProxy proxy = _networkManager->proxy();
-        QNetworkProxy tProxy;
-        tProxy.setType(QNetworkProxy::DefaultProxy);
-        _networkManager->setProxy(tProxy);
+    QNetworkProxy proxy = _networkManager->proxy();
+    QNetworkProxy tProxy;
+    tProxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager->setProxy(tProxy);
 #endif
-        _reply = _networkManager->get(_request);
-        _reply->setParent(nullptr);
-        connect(_reply, &QNetworkReply::finished, this, &QGeoTiledMapReplyQGC::networkReplyFinished);
-        connect(_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(networkReplyError(QNetworkReply::NetworkError)));
+    _reply = _networkManager->get(_request);
+    _reply->setParent(nullptr);
+    connect(_reply, &QNetworkReply::finished, this, &QGeoTiledMapReplyQGC::networkReplyFinished);
+    connect(_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(networkReplyError(QNetworkReply::NetworkError)));
 #if !defined(__mobile__)
-        _networkManager->setProxy(proxy);
+    _networkManager->setProxy(proxy);
 #endif
-        //- Wait for an answer up to 10 seconds
-        connect(&_timer, &QTimer::timeout, this, &QGeoTiledMapReplyQGC::timeout);
-        _timer.setSingleShot(true);
-        _timer.start(10000);
-        _requestCount++;
-    }
+    //- Wait for an answer up to 10 seconds
+    connect(&_timer, &QTimer::timeout, this, &QGeoTiledMapReplyQGC::timeout);
+    _timer.setSingleShot(true);
+    _timer.start(10000);
+    _requestCount++;
 }
 
 //-----------------------------------------------------------------------------
 void
 QGeoTiledMapReplyQGC::cacheReply(QGCCacheTile* tile)
 {
+    if(_aborted) {
+        return;
+    }
     //-- Test for a specialized, elevation data (not map tile)
     if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
         emit terrainDone(tile->img(), QNetworkReply::NoError);
     } else {
         //-- Regular map tile
+        getQGCMapEngine()->memoryCache()->insert(_key, tile->img(), tile->format());
         setMapImageData(tile->img());
         setMapImageFormat(tile->format());
         setFinished(true);
         setCached(true);
     }
-    tile->deleteLater();
 }
 
 //-----------------------------------------------------------------------------
@@ -50,16 +50,26 @@
 #include <QtNetwork/QNetworkReply>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 #include <QTimer>
+#include <QPointer>
+#include <QHash>
 
 #include "QGCMapEngineData.h"
 
+class QGeoTileFetcherQGC;
+class QGCTileArchive;
+
 class QGeoTiledMapReplyQGC : public QGeoTiledMapReply
 {
     Q_OBJECT
 public:
-    QGeoTiledMapReplyQGC(QNetworkAccessManager*  networkManager, const QNetworkRequest& request, const QGeoTileSpec &spec, QObject *parent = 0);
+    //-- Without a fetcher the network request is sent as soon as the tile is known not to be in the cache
+    QGeoTiledMapReplyQGC(QNetworkAccessManager*  networkManager, const QNetworkRequest& request, const QGeoTileSpec &spec, QGeoTileFetcherQGC* fetcher = nullptr, QObject *parent = 0);
+    //-- Finished right away with the tile from a basemap file
+    QGeoTiledMapReplyQGC(QGCTileArchive* archive, const QGeoTileSpec &spec, QObject *parent = 0);
     ~QGeoTiledMapReplyQGC();
     void abort();
+    //-- Called by the fetcher once a network slot is free
+    void startNetworkRequest    ();
 
 signals:
     void terrainDone            (QByteArray responseBytes, QNetworkReply::NetworkError error);
@@ -73,16 +83,23 @@ private slots:
 
 private:
     void _clearReply            ();
+    void _lookupCache           ();
+    void _removeCacheLookup     ();
 
 private:
     QNetworkReply*          _reply;
+    quint64                 _key;
     QNetworkRequest         _request;
     QNetworkAccessManager*  _networkManager;
+    QPointer<QGeoTileFetcherQGC> _fetcher;
+    bool                    _aborted;
     QByteArray              _badMapbox;
     QByteArray              _badTile;
     QTimer                  _timer;
     static QByteArray       _bingNoTileImage;
     static int              _requestCount;
+    //-- Replies waiting for the cache worker to look up a tile, so the same tile is only looked up once at a time
+    static QHash<quint64, QList<QGeoTiledMapReplyQGC*>> _cacheLookups;
 };
 
 #endif // QGEOMAPREPLYQGC_H
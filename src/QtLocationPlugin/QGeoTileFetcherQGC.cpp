@@ -49,13 +49,17 @@
 #include "QGeoMapReplyQGC.h"
 
 #include <QtCore/QLocale>
+#include <QtCore/QtMath>
 #include <QtNetwork/QNetworkRequest>
 #include <QtLocation/private/qgeotilespec_p.h>
 
+#include <limits>
+
 //-----------------------------------------------------------------------------
 QGeoTileFetcherQGC::QGeoTileFetcherQGC(QGeoTiledMappingManagerEngine *parent)
     : QGeoTileFetcher(parent)
     , _networkManager(new QNetworkAccessManager(this))
+    , _currentZoom(-1)
 {
     //-- Check internet status every 30 seconds or so
     connect(&_timer, &QTimer::timeout, this, &QGeoTileFetcherQGC::timeout);
@@ -66,17 +70,25 @@ QGeoTileFetcherQGC::QGeoTileFetcherQGC(QGeoTiledMappingManagerEngine *parent)
 //-----------------------------------------------------------------------------
 QGeoTileFetcherQGC::~QGeoTileFetcherQGC()
 {
-
+    _networkQueue.clear();
+    _activeRequests.clear();
 }
 
 //-----------------------------------------------------------------------------
 QGeoTiledMapReply*
 QGeoTileFetcherQGC::getTileImage(const QGeoTileSpec &spec)
 {
+    //-- Basemap files are read directly
+    MapProvider* provider = getQGCMapEngine()->urlFactory()->getMapProviderFromId(spec.mapId());
+    if (provider && provider->tileArchive()) {
+        return new QGeoTiledMapReplyQGC(provider->tileArchive(), spec);
+    }
     //-- Build URL
     QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(spec.mapId(), spec.x(), spec.y(), spec.zoom(), _networkManager);
     if ( ! request.url().isEmpty() ) {
-        return new QGeoTiledMapReplyQGC(_networkManager, request, spec);
+        //-- Qt asks for the tiles of the zoom level being shown last
+        _currentZoom = spec.zoom();
+        return new QGeoTiledMapReplyQGC(_networkManager, request, spec, this);
     }
     else {
         return nullptr;
@@ -89,3 +101,67 @@ QGeoTileFetcherQGC::timeout()
 {
     getQGCMapEngine()->testInternet();
 }
+
+//-----------------------------------------------------------------------------
+void
+QGeoTileFetcherQGC::queueNetworkRequest(QGeoTiledMapReplyQGC* reply)
+{
+    if(!_networkQueue.contains(reply)) {
+        _networkQueue.append(reply);
+    }
+    _startNetworkRequests();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTileFetcherQGC::removeNetworkRequest(QGeoTiledMapReplyQGC* reply)
+{
+    _networkQueue.removeAll(reply);
+    if(_activeRequests.remove(reply)) {
+        _startNetworkRequests();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTileFetcherQGC::_startNetworkRequests()
+{
+    while(_activeRequests.count() < _maxNetworkRequests && !_networkQueue.isEmpty()) {
+        //-- The middle of the tiles waiting at the current zoom level stands in for the center of the view
+        double centerX = 0.0;
+        double centerY = 0.0;
+        int    centerCount = 0;
+        for(QGeoTiledMapReplyQGC* reply : _networkQueue) {
+            const QGeoTileSpec spec = reply->tileSpec();
+            if(spec.zoom() == _currentZoom) {
+                centerX += spec.x() + 0.5;
+                centerY += spec.y() + 0.5;
+                centerCount++;
+            }
+        }
+        if(centerCount) {
+            centerX /= centerCount;
+            centerY /= centerCount;
+        }
+        //-- Closest zoom level first, then closest to the center
+        int    next         = 0;
+        int    nextZoomDiff = std::numeric_limits<int>::max();
+        double nextDistance = 0.0;
+        for(int i = 0; i < _networkQueue.count(); i++) {
+            const QGeoTileSpec spec = _networkQueue[i]->tileSpec();
+            int zoomDiff = qAbs(spec.zoom() - _currentZoom);
+            double scale = qPow(2.0, spec.zoom() - _currentZoom);
+            double dx = spec.x() + 0.5 - centerX * scale;
+            double dy = spec.y() + 0.5 - centerY * scale;
+            double distance = centerCount ? (dx * dx + dy * dy) : static_cast<double>(i);
+            if(zoomDiff < nextZoomDiff || (zoomDiff == nextZoomDiff && distance < nextDistance)) {
+                next         = i;
+                nextZoomDiff = zoomDiff;
+                nextDistance = distance;
+            }
+        }
+        QGeoTiledMapReplyQGC* reply = _networkQueue.takeAt(next);
+        _activeRequests.insert(reply);
+        reply->startNetworkRequest();
+    }
+}
@@ -49,9 +49,12 @@
 
 #include <QtLocation/private/qgeotilefetcher_p.h>
 #include <QTimer>
+#include <QList>
+#include <QSet>
 #include "QGCMapUrlEngine.h"
 
 class QGeoTiledMappingManagerEngine;
+class QGeoTiledMapReplyQGC;
 class QNetworkAccessManager;
 
 class QGeoTileFetcherQGC : public QGeoTileFetcher
@@ -60,13 +63,23 @@ class QGeoTileFetcherQGC : public QGeoTileFetcher
 public:
     explicit QGeoTileFetcherQGC             (QGeoTiledMappingManagerEngine *parent = 0);
     ~QGeoTileFetcherQGC();
+    //-- Tiles not found in the cache wait here for a network slot, the ones nearest to the current view go first
+    void                    queueNetworkRequest     (QGeoTiledMapReplyQGC* reply);
+    //-- The reply was aborted or its network request is done, frees its slot
+    void                    removeNetworkRequest    (QGeoTiledMapReplyQGC* reply);
 public slots:
     void                    timeout         ();
 private:
     QGeoTiledMapReply*      getTileImage    (const QGeoTileSpec &spec);
+    void                    _startNetworkRequests   ();
 private:
     QNetworkAccessManager*  _networkManager;
     QTimer                  _timer;
+    QList<QGeoTiledMapReplyQGC*> _networkQueue;
+    QSet<QGeoTiledMapReplyQGC*>  _activeRequests;
+    int                     _currentZoom;
+    //-- Same as the connections per host of QNetworkAccessManager, more would only queue up where they can't be reordered
+    static const int        _maxNetworkRequests = 6;
 };
 
 #endif // QGEOTILEFETCHERQGC_H
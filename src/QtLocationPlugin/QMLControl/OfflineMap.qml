@@ -213,7 +213,7 @@ Item {
     QGCFileDialog {
         id:             fileDialog
         folder:         QGroundControl.settingsManager.appSettings.missionSavePath
-        nameFilters:    ["Tile Sets (*.qgctiledb)"]
+        nameFilters:    ["Tile Sets (*.qgctiledb)", "Compressed Tile Sets (*.qgctiledb.gz)"]
 
         onAcceptedForSave: {
             if (QGroundControl.mapEngineManager.exportSets(file)) {
@@ -254,6 +254,9 @@ Item {
             onAccepted: {
                 QGroundControl.mapEngineManager.maxDiskCache = parseInt(maxCacheSize.text)
                 QGroundControl.mapEngineManager.maxMemCache  = parseInt(maxCacheMemSize.text)
+                QGroundControl.mapEngineManager.terrainRetentionDays = parseInt(terrainRetentionDays.text)
+                QGroundControl.mapEngineManager.tileStorageFormat = tileStorageFormat.currentIndex
+                QGroundControl.mapEngineManager.tileStorageQuality = parseInt(tileStorageQuality.text)
             }
 
             Column {
@@ -294,6 +297,64 @@ Item {
                     text:           qsTr("Memory cache changes require a restart to take effect.")
                 }
 
+                Item { width: 1; height: 1 }
+
+                QGCLabel {
+                    anchors.left:   parent.left
+                    anchors.right:  parent.right
+                    wrapMode:       Text.WordWrap
+                    text:           qsTr("Keep Terrain Data For (days):")
+                }
+
+                QGCTextField {
+                    id:                 terrainRetentionDays
+                    maximumLength:      5
+                    inputMethodHints:   Qt.ImhDigitsOnly
+                    validator:          IntValidator {bottom: 0; top: 36500;}
+                    text:               QGroundControl.mapEngineManager.terrainRetentionDays
+                }
+
+                QGCLabel {
+                    anchors.left:   parent.left
+                    anchors.right:  parent.right
+                    wrapMode:       Text.WordWrap
+                    font.pointSize: _adjustableFontPointSize
+                    text:           qsTr("Terrain data is not removed to make room in the disk cache until it is older than this. 0 removes it along with map tiles.")
+                }
+
+                Item { width: 1; height: 1 }
+
+                QGCLabel { text: qsTr("Store Map Tiles As:") }
+
+                QGCComboBox {
+                    id:                 tileStorageFormat
+                    width:              ScreenTools.defaultFontPixelWidth * 20
+                    model:              QGroundControl.mapEngineManager.tileStorageFormatList
+                    currentIndex:       QGroundControl.mapEngineManager.tileStorageFormat
+                }
+
+                QGCLabel {
+                    text:               qsTr("Storage Quality (1-100):")
+                    visible:            tileStorageFormat.currentIndex > 0
+                }
+
+                QGCTextField {
+                    id:                 tileStorageQuality
+                    maximumLength:      3
+                    inputMethodHints:   Qt.ImhDigitsOnly
+                    validator:          IntValidator {bottom: 1; top: 100;}
+                    text:               QGroundControl.mapEngineManager.tileStorageQuality
+                    visible:            tileStorageFormat.currentIndex > 0
+                }
+
+                QGCLabel {
+                    anchors.left:   parent.left
+                    anchors.right:  parent.right
+                    wrapMode:       Text.WordWrap
+                    font.pointSize: _adjustableFontPointSize
+                    text:           qsTr("Tiles are re-encoded before they are saved, which takes less disk space at some loss of detail. Tiles already in the cache are not changed.")
+                }
+
                 Item { width: 1; height: 1; visible: _mapboxFact ? _mapboxFact.visible : false }
                 QGCLabel { text: qsTr("Mapbox Access Token"); visible: _mapboxFact ? _mapboxFact.visible : false }
                 FactTextField {
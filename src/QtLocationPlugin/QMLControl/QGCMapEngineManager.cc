@@ -19,6 +19,9 @@
 #include "QGCApplication.h"
 #include "QGCMapTileSet.h"
 #include "QGCMapUrlEngine.h"
+#include "SettingsManager.h"
+#include "OfflineMapsSettings.h"
+#include "QGCTileTranscoder.h"
 
 #include <QSettings>
 #include <QStorageInfo>
@@ -181,6 +184,85 @@ QGCMapEngineManager::startDownload(const QString& name, const QString& mapType)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::prefetchCorridor(const QString& name, const QString& mapType, const QVariantList& path, double bufferMeters)
+{
+    QList<QGeoCoordinate> coords;
+    for(const QVariant& coord: path) {
+        QGeoCoordinate geoCoord = coord.value<QGeoCoordinate>();
+        if(geoCoord.isValid()) {
+            coords.append(geoCoord);
+        }
+    }
+    if(coords.isEmpty()) {
+        qWarning() << "QGCMapEngineManager::prefetchCorridor() Empty path";
+        return;
+    }
+
+    OfflineMapsSettings* settings = _toolbox->settingsManager()->offlineMapsSettings();
+    const int       minZoom     = settings->minZoomLevelDownload()->rawValue().toInt();
+    const int       maxZoom     = settings->maxZoomLevelDownload()->rawValue().toInt();
+    const quint64   maxTiles    = settings->maxTilesForDownload()->rawValue().toULongLong();
+
+    //-- Add zoom levels from the lowest up until the tile limit is reached
+    quint64 tileCount   = 0;
+    int     fitZoom     = minZoom - 1;
+    for(int z = minZoom; z <= maxZoom; z++) {
+        quint64 zoomCount = static_cast<quint64>(QGCMapEngine::getCorridorTiles(z, coords, bufferMeters, mapType).count());
+        if(tileCount + zoomCount > maxTiles) {
+            break;
+        }
+        tileCount += zoomCount;
+        fitZoom = z;
+    }
+    if(fitZoom < minZoom) {
+        qWarning() << "QGCMapEngineManager::prefetchCorridor() Corridor exceeds max tile count" << maxTiles;
+        return;
+    }
+    if(fitZoom < maxZoom) {
+        qCDebug(QGCMapEngineManagerLog) << "prefetchCorridor max zoom lowered to" << fitZoom << "to stay within" << maxTiles << "tiles";
+    }
+
+    _startCorridorSet(name, mapType, coords, bufferMeters, minZoom, fitZoom, tileCount);
+    if(mapType != "Airmap Elevation") {
+        quint64 elevationCount = static_cast<quint64>(QGCMapEngine::getCorridorTiles(1, coords, bufferMeters, "Airmap Elevation").count());
+        _startCorridorSet(name + " Elevation", "Airmap Elevation", coords, bufferMeters, 1, 1, elevationCount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::_startCorridorSet(const QString& name, const QString& mapType, const QList<QGeoCoordinate>& path, double bufferMeters, int minZoom, int maxZoom, quint64 tileCount)
+{
+    //-- Bounds are only informative for corridor sets
+    double north = -90, south = 90, west = 180, east = -180;
+    for(const QGeoCoordinate& coord: path) {
+        north   = qMax(north, coord.atDistanceAndAzimuth(bufferMeters, 0).latitude());
+        south   = qMin(south, coord.atDistanceAndAzimuth(bufferMeters, 180).latitude());
+        west    = qMin(west,  coord.atDistanceAndAzimuth(bufferMeters, 270).longitude());
+        east    = qMax(east,  coord.atDistanceAndAzimuth(bufferMeters, 90).longitude());
+    }
+
+    QGCCachedTileSet* set = new QGCCachedTileSet(name);
+    set->setMapTypeStr(mapType);
+    set->setTopleftLat(north);
+    set->setTopleftLon(west);
+    set->setBottomRightLat(south);
+    set->setBottomRightLon(east);
+    set->setMinZoom(minZoom);
+    set->setMaxZoom(maxZoom);
+    set->setTotalTileSize(tileCount * getQGCMapEngine()->urlFactory()->averageSizeForType(mapType));
+    set->setTotalTileCount(static_cast<quint32>(tileCount));
+    set->setType(mapType);
+    set->setCorridor(path, bufferMeters);
+    set->setLowPriority(true);
+    QGCCreateTileSetTask* task = new QGCCreateTileSetTask(set);
+    connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
+    connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+    getQGCMapEngine()->addTask(task);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMapEngineManager::_tileSetSaved(QGCCachedTileSet *set)
@@ -214,7 +296,15 @@ QGCMapEngineManager::loadSetting (const QString& key, const QString& defaultValu
 QStringList
 QGCMapEngineManager::mapList()
 {
-    return getQGCMapEngine()->getMapNameList();
+    //-- Offline downloads, basemap files have nothing to download
+    QStringList mapList;
+    const QHash<QString, MapProvider*> providers = getQGCMapEngine()->urlFactory()->getProviderTable();
+    for(auto it = providers.constBegin(); it != providers.constEnd(); ++it) {
+        if(!it.value()->tileArchive()) {
+            mapList.append(it.key());
+        }
+    }
+    return mapList;
 }
 //-----------------------------------------------------------------------------
 QStringList
@@ -267,6 +357,63 @@ QGCMapEngineManager::setMaxDiskCache(quint32 size)
     getQGCMapEngine()->setMaxDiskCache(size);
 }
 
+//-----------------------------------------------------------------------------
+quint32
+QGCMapEngineManager::terrainRetentionDays()
+{
+    return getQGCMapEngine()->getTerrainRetentionDays();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::setTerrainRetentionDays(quint32 days)
+{
+    getQGCMapEngine()->setTerrainRetentionDays(days);
+    emit terrainRetentionDaysChanged();
+}
+
+//-----------------------------------------------------------------------------
+QStringList
+QGCMapEngineManager::tileStorageFormatList()
+{
+    QStringList list(tr("As Downloaded"));
+    for(const QString& format : QGCTileTranscoder::availableFormats()) {
+        list << (format == "webp" ? QStringLiteral("WebP") : format.toUpper());
+    }
+    return list;
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCMapEngineManager::tileStorageFormat()
+{
+    return QGCTileTranscoder::availableFormats().indexOf(getQGCMapEngine()->getTileStorageFormat()) + 1;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::setTileStorageFormat(int index)
+{
+    QStringList formats = QGCTileTranscoder::availableFormats();
+    getQGCMapEngine()->setTileStorageFormat(index > 0 && index <= formats.count() ? formats[index - 1] : QString());
+    emit tileStorageFormatChanged();
+}
+
+//-----------------------------------------------------------------------------
+quint32
+QGCMapEngineManager::tileStorageQuality()
+{
+    return getQGCMapEngine()->getTileStorageQuality();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::setTileStorageQuality(quint32 quality)
+{
+    getQGCMapEngine()->setTileStorageQuality(quality);
+    emit tileStorageQualityChanged();
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMapEngineManager::deleteTileSet(QGCCachedTileSet* tileSet)
@@ -544,6 +691,17 @@ QGCMapEngineManager::resetAction()
     emit importActionChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::repairCacheTotals()
+{
+    QGCMapTask* task = new QGCMapTask(QGCMapTask::taskRepairStats);
+    connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+    getQGCMapEngine()->addTask(task);
+    //-- Set totals are refreshed from the recounted stats
+    loadTileSets();
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCMapEngineManager::getUniqueName()
@@ -46,6 +46,11 @@ public:
     Q_PROPERTY(QStringList          mapProviderList READ    mapProviderList CONSTANT)
     Q_PROPERTY(quint32              maxMemCache     READ    maxMemCache     WRITE   setMaxMemCache  NOTIFY  maxMemCacheChanged)
     Q_PROPERTY(quint32              maxDiskCache    READ    maxDiskCache    WRITE   setMaxDiskCache NOTIFY  maxDiskCacheChanged)
+    Q_PROPERTY(quint32              terrainRetentionDays READ terrainRetentionDays WRITE setTerrainRetentionDays NOTIFY terrainRetentionDaysChanged)
+    //-- Index into tileStorageFormatList, 0 stores tiles as downloaded
+    Q_PROPERTY(QStringList          tileStorageFormatList READ tileStorageFormatList CONSTANT)
+    Q_PROPERTY(int                  tileStorageFormat READ tileStorageFormat WRITE setTileStorageFormat NOTIFY tileStorageFormatChanged)
+    Q_PROPERTY(quint32              tileStorageQuality READ tileStorageQuality WRITE setTileStorageQuality NOTIFY tileStorageQualityChanged)
     Q_PROPERTY(QString              errorMessage    READ    errorMessage    NOTIFY  errorMessageChanged)
     Q_PROPERTY(bool                 fetchElevation  READ    fetchElevation  WRITE   setFetchElevation   NOTIFY  fetchElevationChanged)
     //-- Disk Space in MB
@@ -61,6 +66,9 @@ public:
     Q_INVOKABLE void                loadTileSets            ();
     Q_INVOKABLE void                updateForCurrentView    (double lon0, double lat0, double lon1, double lat1, int minZoom, int maxZoom, const QString& mapName);
     Q_INVOKABLE void                startDownload           (const QString& name, const QString& mapType);
+    /// Creates low priority tile sets covering bufferMeters around the path, plus elevation tiles for the same corridor.
+    /// Uses the offline maps zoom range, lowering the max zoom when the set would exceed the max tile count.
+    Q_INVOKABLE void                prefetchCorridor        (const QString& name, const QString& mapType, const QVariantList& path, double bufferMeters);
     Q_INVOKABLE void                saveSetting             (const QString& key,  const QString& value);
     Q_INVOKABLE QString             loadSetting             (const QString& key,  const QString& defaultValue);
     Q_INVOKABLE void                deleteTileSet           (QGCCachedTileSet* tileSet);
@@ -72,6 +80,7 @@ public:
     Q_INVOKABLE bool                exportSets              (QString path = QString());
     Q_INVOKABLE bool                importSets              (QString path = QString());
     Q_INVOKABLE void                resetAction             ();
+    Q_INVOKABLE void                repairCacheTotals       ();     ///< Recounts cached tile totals from scratch
 
     quint64                         tileCount               () const{ return _imageSet.tileCount + _elevationSet.tileCount; }
     QString                         tileCountStr            () const;
@@ -83,6 +92,10 @@ public:
     QmlObjectListModel*             tileSets                () { return &_tileSets; }
     quint32                         maxMemCache             ();
     quint32                         maxDiskCache            ();
+    quint32                         terrainRetentionDays    ();
+    QStringList                     tileStorageFormatList   ();
+    int                             tileStorageFormat       ();
+    quint32                         tileStorageQuality      ();
     QString                         errorMessage            () { return _errorMessage; }
     bool                            fetchElevation          () const{ return _fetchElevation; }
     quint64                         freeDiskSpace           () const{ return _freeDiskSpace; }
@@ -94,6 +107,9 @@ public:
 
     void                            setMaxMemCache          (quint32 size);
     void                            setMaxDiskCache         (quint32 size);
+    void                            setTerrainRetentionDays (quint32 days);
+    void                            setTileStorageFormat    (int index);
+    void                            setTileStorageQuality   (quint32 quality);
     void                            setImportReplace        (bool replace) { _importReplace = replace; emit importReplaceChanged(); }
     void                            setImportAction         (ImportAction action)  {_importAction = action; emit importActionChanged(); }
     void                            setErrorMessage         (const QString& error) { _errorMessage = error; emit errorMessageChanged(); }
@@ -108,6 +124,9 @@ signals:
     void tileSetsChanged        ();
     void maxMemCacheChanged     ();
     void maxDiskCacheChanged    ();
+    void terrainRetentionDaysChanged();
+    void tileStorageFormatChanged();
+    void tileStorageQualityChanged();
     void errorMessageChanged    ();
     void fetchElevationChanged  ();
     void freeDiskSpaceChanged   ();
@@ -130,6 +149,7 @@ private slots:
 
 private:
     void _updateDiskFreeSpace   ();
+    void _startCorridorSet      (const QString& name, const QString& mapType, const QList<QGeoCoordinate>& path, double bufferMeters, int minZoom, int maxZoom, quint64 tileCount);
 
 private:
     QGCTileSet  _imageSet;
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TileArchiveMapProvider.h"
+
+TileArchiveMapProvider::TileArchiveMapProvider(QGCTileArchive* archive, QObject* parent)
+    : MapProvider(QString(), archive->format(), AVERAGE_TILE_SIZE, QGeoMapType::CustomMap, parent)
+    , _archive(archive)
+{
+    _archive->setParent(this);
+}
+
+QString TileArchiveMapProvider::_getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) {
+    Q_UNUSED(x)
+    Q_UNUSED(y)
+    Q_UNUSED(zoom)
+    Q_UNUSED(networkManager)
+    return QString();
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "MapProvider.h"
+#include "QGCTileArchive.h"
+
+// Basemap served from an MBTiles or PMTiles file, see QGCTileArchive
+class TileArchiveMapProvider : public MapProvider {
+    Q_OBJECT
+
+  public:
+    /// Takes ownership of archive
+    TileArchiveMapProvider(QGCTileArchive* archive, QObject* parent = nullptr);
+
+    QGCTileArchive* tileArchive() const override { return _archive; }
+
+  protected:
+    //-- Nothing to download
+    QString _getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) override;
+
+  private:
+    QGCTileArchive* _archive;
+};
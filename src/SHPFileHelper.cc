@@ -140,13 +140,15 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
         goto Error;
     }
 
-    for (int i=0; i<shpObject->nVertices; i++) {
-        QGeoCoordinate coord;
-        if (!utmZone || !convertUTMToGeo(shpObject->padfX[i], shpObject->padfY[i], utmZone, utmSouthernHemisphere, coord)) {
-            coord.setLatitude(shpObject->padfY[i]);
-            coord.setLongitude(shpObject->padfX[i]);
+    if (!utmZone || !convertUTMToGeo(shpObject->padfX, shpObject->padfY, shpObject->nVertices, utmZone, utmSouthernHemisphere, vertices)) {
+        vertices.reserve(shpObject->nVertices);
+        for (int i=0; i<shpObject->nVertices; i++) {
+            vertices.append(QGeoCoordinate(shpObject->padfY[i], shpObject->padfX[i]));
         }
-        vertices.append(coord);
+    }
+    if (vertices.isEmpty()) {
+        errorString = QString(_errorPrefix).arg(tr("Polygon has no vertices."));
+        goto Error;
     }
 
     // Filter last vertex such that it differs from first
@@ -158,16 +160,19 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
         }
     }
 
-    // Filter vertex distances to be larger than 1 meter apart
-    {
-        int i = 0;
-        while (i < vertices.count() - 2) {
-            if (vertices[i].distanceTo(vertices[i+1]) < vertexFilterMeters) {
-                vertices.removeAt(i+1);
-            } else {
-                i++;
+    // Filter vertex distances to be larger than 1 meter apart. The last vertex is always kept. This is done in a single
+    // pass since removing from the middle of the list one vertex at a time is far too slow for large shapes.
+    if (vertices.count() > 2) {
+        QList<QGeoCoordinate> filtered;
+        filtered.reserve(vertices.count());
+        filtered.append(vertices.first());
+        for (int i=1; i<vertices.count() - 1; i++) {
+            if (filtered.last().distanceTo(vertices[i]) >= vertexFilterMeters) {
+                filtered.append(vertices[i]);
             }
         }
+        filtered.append(vertices.last());
+        vertices = filtered;
     }
 
 Error:
@@ -20,3 +20,8 @@ DECLARE_SETTINGGROUP(ADSBVehicleManager, "ADSBVehicleManager")
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerConnectEnabled)
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerHostAddress)
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerPort)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbDisplayRadius)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbDisplayAltitudeBand)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbConflictLookahead)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbConflictHorizontalSeparation)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbConflictVerticalSeparation)
@@ -21,4 +21,9 @@ public:
     DEFINE_SETTINGFACT(adsbServerConnectEnabled)
     DEFINE_SETTINGFACT(adsbServerHostAddress)
     DEFINE_SETTINGFACT(adsbServerPort)
+    DEFINE_SETTINGFACT(adsbDisplayRadius)
+    DEFINE_SETTINGFACT(adsbDisplayAltitudeBand)
+    DEFINE_SETTINGFACT(adsbConflictLookahead)
+    DEFINE_SETTINGFACT(adsbConflictHorizontalSeparation)
+    DEFINE_SETTINGFACT(adsbConflictVerticalSeparation)
 };
@@ -24,6 +24,7 @@ const char* AppSettings::fenceFileExtension =       "fence";
 const char* AppSettings::rallyPointFileExtension =  "rally";
 const char* AppSettings::telemetryFileExtension =   "tlog";
 const char* AppSettings::kmlFileExtension =         "kml";
+const char* AppSettings::kmzFileExtension =         "kmz";
 const char* AppSettings::shpFileExtension =         "shp";
 const char* AppSettings::logFileExtension =         "ulg";
 
@@ -35,6 +36,7 @@ const char* AppSettings::videoDirectory =           QT_TRANSLATE_NOOP("AppSettin
 const char* AppSettings::photoDirectory =           QT_TRANSLATE_NOOP("AppSettings", "Photo");
 const char* AppSettings::crashDirectory =           QT_TRANSLATE_NOOP("AppSettings", "CrashLogs");
 const char* AppSettings::customActionsDirectory =   QT_TRANSLATE_NOOP("AppSettings", "CustomActions");
+const char* AppSettings::basemapDirectory =         QT_TRANSLATE_NOOP("AppSettings", "Basemaps");
 
 // Release languages are 90%+ complete
 QList<int> AppSettings::_rgReleaseLanguages = {
@@ -146,9 +148,18 @@ DECLARE_SETTINGSFACT(AppSettings, enableMicrohard)
 DECLARE_SETTINGSFACT(AppSettings, disableAllPersistence)
 DECLARE_SETTINGSFACT(AppSettings, usePairing)
 DECLARE_SETTINGSFACT(AppSettings, saveCsvTelemetry)
+DECLARE_SETTINGSFACT(AppSettings, csvTelemetryRate)
 DECLARE_SETTINGSFACT(AppSettings, firstRunPromptIdsShown)
 DECLARE_SETTINGSFACT(AppSettings, forwardMavlink)
 DECLARE_SETTINGSFACT(AppSettings, forwardMavlinkHostName)
+DECLARE_SETTINGSFACT(AppSettings, forwardMavlinkAllowedMsgIds)
+DECLARE_SETTINGSFACT(AppSettings, forwardMavlinkDeniedMsgIds)
+DECLARE_SETTINGSFACT(AppSettings, forwardMavlinkMaxRate)
+DECLARE_SETTINGSFACT(AppSettings, mavlinkDecodeOnLinkThread)
+DECLARE_SETTINGSFACT(AppSettings, pipelinedPlanTransfer)
+DECLARE_SETTINGSFACT(AppSettings, followTargetRate)
+DECLARE_SETTINGSFACT(AppSettings, telemetryStreamServer)
+DECLARE_SETTINGSFACT(AppSettings, telemetryStreamServerPort)
 
 DECLARE_SETTINGSFACT_NO_FUNC(AppSettings, indoorPalette)
 {
@@ -219,6 +230,7 @@ void AppSettings::_checkSavePathDirectories(void)
         savePathDir.mkdir(photoDirectory);
         savePathDir.mkdir(crashDirectory);
         savePathDir.mkdir(customActionsDirectory);
+        savePathDir.mkdir(basemapDirectory);
     }
 }
 
@@ -307,6 +319,16 @@ QString AppSettings::customActionsSavePath(void)
     return QString();
 }
 
+QString AppSettings::basemapSavePath(void)
+{
+    QString path = savePath()->rawValue().toString();
+    if (!path.isEmpty() && QDir(path).exists()) {
+        QDir dir(path);
+        return dir.filePath(basemapDirectory);
+    }
+    return QString();
+}
+
 QList<int> AppSettings::firstRunPromptsIdsVariantToList(const QVariant& firstRunPromptIds)
 {
     QList<int> rgIds;
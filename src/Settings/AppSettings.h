@@ -62,9 +62,18 @@ public:
     DEFINE_SETTINGFACT(disableAllPersistence)
     DEFINE_SETTINGFACT(usePairing)
     DEFINE_SETTINGFACT(saveCsvTelemetry)
+    DEFINE_SETTINGFACT(csvTelemetryRate)
     DEFINE_SETTINGFACT(firstRunPromptIdsShown)
     DEFINE_SETTINGFACT(forwardMavlink)
     DEFINE_SETTINGFACT(forwardMavlinkHostName)
+    DEFINE_SETTINGFACT(forwardMavlinkAllowedMsgIds)
+    DEFINE_SETTINGFACT(forwardMavlinkDeniedMsgIds)
+    DEFINE_SETTINGFACT(forwardMavlinkMaxRate)
+    DEFINE_SETTINGFACT(mavlinkDecodeOnLinkThread)
+    DEFINE_SETTINGFACT(pipelinedPlanTransfer)
+    DEFINE_SETTINGFACT(followTargetRate)
+    DEFINE_SETTINGFACT(telemetryStreamServer)
+    DEFINE_SETTINGFACT(telemetryStreamServerPort)
 
 
     // Although this is a global setting it only affects ArduPilot vehicle since PX4 automatically starts the stream from the vehicle side
@@ -78,6 +87,7 @@ public:
     Q_PROPERTY(QString photoSavePath            READ photoSavePath              NOTIFY savePathsChanged)
     Q_PROPERTY(QString crashSavePath            READ crashSavePath              NOTIFY savePathsChanged)
     Q_PROPERTY(QString customActionsSavePath    READ customActionsSavePath      NOTIFY savePathsChanged)
+    Q_PROPERTY(QString basemapSavePath          READ basemapSavePath            NOTIFY savePathsChanged)
 
     Q_PROPERTY(QString planFileExtension        MEMBER planFileExtension        CONSTANT)
     Q_PROPERTY(QString missionFileExtension     MEMBER missionFileExtension     CONSTANT)
@@ -85,6 +95,7 @@ public:
     Q_PROPERTY(QString parameterFileExtension   MEMBER parameterFileExtension   CONSTANT)
     Q_PROPERTY(QString telemetryFileExtension   MEMBER telemetryFileExtension   CONSTANT)
     Q_PROPERTY(QString kmlFileExtension         MEMBER kmlFileExtension         CONSTANT)
+    Q_PROPERTY(QString kmzFileExtension         MEMBER kmzFileExtension         CONSTANT)
     Q_PROPERTY(QString shpFileExtension         MEMBER shpFileExtension         CONSTANT)
     Q_PROPERTY(QString logFileExtension         MEMBER logFileExtension         CONSTANT)
 
@@ -96,6 +107,7 @@ public:
     QString photoSavePath         ();
     QString crashSavePath         ();
     QString customActionsSavePath ();
+    QString basemapSavePath       ();
 
     // Helper methods for working with firstRunPromptIds QVariant settings string list
     static QList<int> firstRunPromptsIdsVariantToList   (const QVariant& firstRunPromptIds);
@@ -111,6 +123,7 @@ public:
     static const char* rallyPointFileExtension;
     static const char* telemetryFileExtension;
     static const char* kmlFileExtension;
+    static const char* kmzFileExtension;
     static const char* shpFileExtension;
     static const char* logFileExtension;
 
@@ -123,6 +136,7 @@ public:
     static const char* photoDirectory;
     static const char* crashDirectory;
     static const char* customActionsDirectory;
+    static const char* basemapDirectory;
 
     // Returns the current qLocaleLanguage setting bypassing the standard SettingsGroup path. This should only be used
     // by QGCApplication::setLanguage to query the language setting as early in the boot process as possible.
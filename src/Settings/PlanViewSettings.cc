@@ -23,3 +23,7 @@ DECLARE_SETTINGSFACT(PlanViewSettings, useConditionGate)
 DECLARE_SETTINGSFACT(PlanViewSettings, takeoffItemNotRequired)
 DECLARE_SETTINGSFACT(PlanViewSettings, showGimbalOnlyWhenSet)
 DECLARE_SETTINGSFACT(PlanViewSettings, vtolTransitionDistance)
+DECLARE_SETTINGSFACT(PlanViewSettings, shapeImportSimplification)
+DECLARE_SETTINGSFACT(PlanViewSettings, fenceUploadSimplification)
+DECLARE_SETTINGSFACT(PlanViewSettings, showTerrainOverlay)
+DECLARE_SETTINGSFACT(PlanViewSettings, terrainClearanceWarning)
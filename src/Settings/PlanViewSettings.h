@@ -26,4 +26,8 @@ public:
     DEFINE_SETTINGFACT(takeoffItemNotRequired)
     DEFINE_SETTINGFACT(showGimbalOnlyWhenSet)
     DEFINE_SETTINGFACT(vtolTransitionDistance)
+    DEFINE_SETTINGFACT(shapeImportSimplification)
+    DEFINE_SETTINGFACT(fenceUploadSimplification)
+    DEFINE_SETTINGFACT(showTerrainOverlay)
+    DEFINE_SETTINGFACT(terrainClearanceWarning)
 };
@@ -74,13 +74,18 @@ DECLARE_SETTINGGROUP(Video, "Video")
         VideoDecoderOptions::ForceVideoDecoderDirectX3D,
         VideoDecoderOptions::ForceVideoDecoderVideoToolbox,
 #endif
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+        VideoDecoderOptions::ForceVideoDecoderMediaCodec,
+#endif
 #ifdef Q_OS_WIN
         VideoDecoderOptions::ForceVideoDecoderVAAPI,
         VideoDecoderOptions::ForceVideoDecoderVideoToolbox,
+        VideoDecoderOptions::ForceVideoDecoderMediaCodec,
 #endif
 #ifdef Q_OS_MAC
         VideoDecoderOptions::ForceVideoDecoderDirectX3D,
         VideoDecoderOptions::ForceVideoDecoderVAAPI,
+        VideoDecoderOptions::ForceVideoDecoderMediaCodec,
 #endif
 #ifdef Q_OS_ANDROID
         VideoDecoderOptions::ForceVideoDecoderDirectX3D,
@@ -112,12 +117,24 @@ DECLARE_SETTINGSFACT(VideoSettings, videoFit)
 DECLARE_SETTINGSFACT(VideoSettings, gridLines)
 DECLARE_SETTINGSFACT(VideoSettings, showRecControl)
 DECLARE_SETTINGSFACT(VideoSettings, recordingFormat)
+DECLARE_SETTINGSFACT(VideoSettings, recordingSegmentLength)
+DECLARE_SETTINGSFACT(VideoSettings, subtitleSampleRate)
 DECLARE_SETTINGSFACT(VideoSettings, maxVideoSize)
 DECLARE_SETTINGSFACT(VideoSettings, enableStorageLimit)
 DECLARE_SETTINGSFACT(VideoSettings, rtspTimeout)
 DECLARE_SETTINGSFACT(VideoSettings, streamEnabled)
 DECLARE_SETTINGSFACT(VideoSettings, disableWhenDisarmed)
 DECLARE_SETTINGSFACT(VideoSettings, lowLatencyMode)
+DECLARE_SETTINGSFACT(VideoSettings, warmRestart)
+DECLARE_SETTINGSFACT(VideoSettings, adaptiveVideoQuality)
+DECLARE_SETTINGSFACT(VideoSettings, thermalPalette)
+DECLARE_SETTINGSFACT(VideoSettings, thermalSpanMin)
+DECLARE_SETTINGSFACT(VideoSettings, thermalSpanMax)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRangeMin)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRangeMax)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsotherm)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsothermMin)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsothermMax)
 
 DECLARE_SETTINGSFACT_NO_FUNC(VideoSettings, videoSource)
 {
@@ -29,13 +29,25 @@ public:
     DEFINE_SETTINGFACT(gridLines)
     DEFINE_SETTINGFACT(showRecControl)
     DEFINE_SETTINGFACT(recordingFormat)
+    DEFINE_SETTINGFACT(recordingSegmentLength)
+    DEFINE_SETTINGFACT(subtitleSampleRate)
     DEFINE_SETTINGFACT(maxVideoSize)
     DEFINE_SETTINGFACT(enableStorageLimit)
     DEFINE_SETTINGFACT(rtspTimeout)
     DEFINE_SETTINGFACT(streamEnabled)
     DEFINE_SETTINGFACT(disableWhenDisarmed)
     DEFINE_SETTINGFACT(lowLatencyMode)
+    DEFINE_SETTINGFACT(warmRestart)
+    DEFINE_SETTINGFACT(adaptiveVideoQuality)
     DEFINE_SETTINGFACT(forceVideoDecoder)
+    DEFINE_SETTINGFACT(thermalPalette)
+    DEFINE_SETTINGFACT(thermalSpanMin)
+    DEFINE_SETTINGFACT(thermalSpanMax)
+    DEFINE_SETTINGFACT(thermalRangeMin)
+    DEFINE_SETTINGFACT(thermalRangeMax)
+    DEFINE_SETTINGFACT(thermalIsotherm)
+    DEFINE_SETTINGFACT(thermalIsothermMin)
+    DEFINE_SETTINGFACT(thermalIsothermMax)
 
     enum VideoDecoderOptions {
         ForceVideoDecoderDefault = 0,
@@ -44,6 +56,7 @@ public:
         ForceVideoDecoderVAAPI,
         ForceVideoDecoderDirectX3D,
         ForceVideoDecoderVideoToolbox,
+        ForceVideoDecoderMediaCodec,
     };
     Q_ENUM(VideoDecoderOptions)
 
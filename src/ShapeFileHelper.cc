@@ -11,8 +11,13 @@
 #include "AppSettings.h"
 #include "KMLHelper.h"
 #include "SHPFileHelper.h"
+#include "QGCGeo.h"
 
 #include <QFile>
+#include <QLineF>
+#include <QPointF>
+#include <QVector>
+#include <QtConcurrent>
 
 const char* ShapeFileHelper::_errorPrefix = QT_TR_NOOP("Shape file load failed. %1");
 
@@ -61,7 +66,7 @@ ShapeFileHelper::ShapeType ShapeFileHelper::determineShapeType(const QString& fi
     return shapeType;
 }
 
-bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, double simplifyToleranceMeters)
 {
     bool success = false;
 
@@ -77,10 +82,18 @@ bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordin
         }
     }
 
+    if (success && simplifyToleranceMeters > 0) {
+        QList<QGeoCoordinate> simplified = vertices;
+        simplify(simplified, simplifyToleranceMeters);
+        if (simplified.count() >= 3) {
+            vertices = simplified;
+        }
+    }
+
     return success;
 }
 
-bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString)
+bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, double simplifyToleranceMeters)
 {
     errorString.clear();
     coords.clear();
@@ -94,9 +107,85 @@ bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordi
         }
     }
 
+    if (errorString.isEmpty() && simplifyToleranceMeters > 0) {
+        simplify(coords, simplifyToleranceMeters);
+    }
+
     return errorString.isEmpty();
 }
 
+QFuture<ShapeFileHelper::LoadResult_t> ShapeFileHelper::loadPolygonFromFileAsync(const QString& file, double simplifyToleranceMeters)
+{
+    return QtConcurrent::run([file, simplifyToleranceMeters]() {
+        LoadResult_t result;
+        result.success = loadPolygonFromFile(file, result.coords, result.errorString, simplifyToleranceMeters);
+        return result;
+    });
+}
+
+QFuture<ShapeFileHelper::LoadResult_t> ShapeFileHelper::loadPolylineFromFileAsync(const QString& file, double simplifyToleranceMeters)
+{
+    return QtConcurrent::run([file, simplifyToleranceMeters]() {
+        LoadResult_t result;
+        result.success = loadPolylineFromFile(file, result.coords, result.errorString, simplifyToleranceMeters);
+        return result;
+    });
+}
+
+void ShapeFileHelper::simplify(QList<QGeoCoordinate>& coords, double toleranceMeters)
+{
+    if (coords.count() < 3 || toleranceMeters <= 0) {
+        return;
+    }
+
+    // Work in a local tangent plane, which is accurate enough at the tolerances used for shapes
+    QVector<QPointF> points;
+    points.reserve(coords.count());
+    for (const QGeoCoordinate& coord: coords) {
+        double y, x, down;
+        convertGeoToNed(coord, coords.first(), &y, &x, &down);
+        points.append(QPointF(x, y));
+    }
+
+    // Iterative rather than recursive so that long boundaries can't overflow the stack
+    QVector<bool>           keep(points.count(), false);
+    QVector<QPair<int,int>> segments;
+    keep.first() = keep.last() = true;
+    segments.append(qMakePair(0, points.count() - 1));
+    while (!segments.isEmpty()) {
+        const QPair<int,int> segment = segments.takeLast();
+        const QPointF&  start   = points[segment.first];
+        const QPointF&  end     = points[segment.second];
+        const QPointF   delta   = end - start;
+        const double    length  = QLineF(start, end).length();
+
+        double  maxDistance = 0;
+        int     maxIndex    = -1;
+        for (int i=segment.first+1; i<segment.second; i++) {
+            const QPointF   offset = points[i] - start;
+            const double    distance = length > 0 ? qAbs((delta.x() * offset.y()) - (delta.y() * offset.x())) / length : QLineF(start, points[i]).length();
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxIndex    = i;
+            }
+        }
+
+        if (maxIndex != -1 && maxDistance > toleranceMeters) {
+            keep[maxIndex] = true;
+            segments.append(qMakePair(segment.first, maxIndex));
+            segments.append(qMakePair(maxIndex, segment.second));
+        }
+    }
+
+    QList<QGeoCoordinate> simplified;
+    for (int i=0; i<coords.count(); i++) {
+        if (keep[i]) {
+            simplified.append(coords[i]);
+        }
+    }
+    coords = simplified;
+}
+
 QStringList ShapeFileHelper::fileDialogKMLFilters(void) const
 {
     return QStringList(tr("KML Files (*.%1)").arg(AppSettings::kmlFileExtension));
@@ -106,3 +195,8 @@ QStringList ShapeFileHelper::fileDialogKMLOrSHPFilters(void) const
 {
     return QStringList(tr("KML/SHP Files (*.%1 *.%2)").arg(AppSettings::kmlFileExtension).arg(AppSettings::shpFileExtension));
 }
+
+QStringList ShapeFileHelper::fileDialogKMLSaveFilters(void) const
+{
+    return QStringList({ tr("KML Files (*.%1)").arg(AppSettings::kmlFileExtension), tr("KMZ Files (*.%1)").arg(AppSettings::kmzFileExtension) });
+}
@@ -13,6 +13,7 @@
 #include <QList>
 #include <QGeoCoordinate>
 #include <QVariant>
+#include <QFuture>
 
 /// Routines for loading polygons or polylines from KML or SHP files.
 class ShapeFileHelper : public QObject
@@ -27,8 +28,15 @@ public:
     };
     Q_ENUM(ShapeType)
 
+    typedef struct {
+        bool                    success = false;
+        QList<QGeoCoordinate>   coords;
+        QString                 errorString;
+    } LoadResult_t;
+
     Q_PROPERTY(QStringList fileDialogKMLFilters         READ fileDialogKMLFilters       CONSTANT) ///< File filter list for load/save KML file dialogs
     Q_PROPERTY(QStringList fileDialogKMLOrSHPFilters    READ fileDialogKMLOrSHPFilters  CONSTANT) ///< File filter list for load/save shape file dialogs
+    Q_PROPERTY(QStringList fileDialogKMLSaveFilters     READ fileDialogKMLSaveFilters   CONSTANT) ///< File filter list for plan KML/KMZ export dialogs
 
     /// Loads the file and returns shape type and error string in a variant array.
     /// ShapeType is in index 0, error string is in index 1.
@@ -36,10 +44,22 @@ public:
 
     QStringList fileDialogKMLFilters        (void) const;
     QStringList fileDialogKMLOrSHPFilters   (void) const;
+    QStringList fileDialogKMLSaveFilters    (void) const;
 
     static ShapeType determineShapeType(const QString& file, QString& errorString);
-    static bool loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString);
+
+    /// Loads a shape from the file
+    ///     @param simplifyToleranceMeters Vertices closer than this to the simplified shape are removed, 0 to load all vertices
+    static bool loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, double simplifyToleranceMeters = 0);
+    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, double simplifyToleranceMeters = 0);
+
+    /// Loads a shape from the file on a worker thread. Use for files picked by the user, which can be large.
+    static QFuture<LoadResult_t> loadPolygonFromFileAsync   (const QString& file, double simplifyToleranceMeters = 0);
+    static QFuture<LoadResult_t> loadPolylineFromFileAsync  (const QString& file, double simplifyToleranceMeters = 0);
+
+    /// Simplifies a polyline or polygon boundary using the Douglas-Peucker algorithm. The first and last coordinates
+    /// are always kept.
+    static void simplify(QList<QGeoCoordinate>& coords, double toleranceMeters);
 
 private:
     static bool _fileIsKML(const QString& file, QString& errorString);
@@ -13,6 +13,7 @@
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
 #include "VideoManager.h"
+#include "MAVLinkProtocol.h"
 
 #include <QSettings>
 
@@ -180,6 +181,12 @@ TaisyncManager::setToolbox(QGCToolbox* toolbox)
         _videoRateList.append("high");
         connect(_videoRate, &Fact::_containerRawValueChanged, this, &TaisyncManager::_videoSettingsChanged);
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+TaisyncManager::initDeferred()
+{
     //-- Start it all
     _reset();
 }
@@ -512,6 +519,7 @@ TaisyncManager::_updateSettings(QByteArray jSonData)
             _uplinkRSSI     = tuplinkRSSI;
             emit linkChanged();
         }
+        _toolbox->mavlinkProtocol()->logRadioStatus(_downlinkRSSI, _uplinkRSSI);
     //-- Device Info?
     } else if(jSonData.contains("\"firmwareversion\":")) {
         _reqMask &= ~static_cast<uint32_t>(REQ_DEV_INFO);
@@ -57,6 +57,7 @@ public:
     ~TaisyncManager                         () override;
 
     void        setToolbox                      (QGCToolbox* toolbox) override;
+    void        initDeferred                    () override;
 
     bool        connected                       () { return _isConnected; }
     bool        linkConnected                   () { return _linkConnected; }
@@ -157,19 +157,34 @@ TaisyncSettings::setIPSettings(const QString& localIP, const QString& remoteIP,
 void
 TaisyncSettings::_readBytes()
 {
-    QByteArray bytesIn = _tcpSocket->read(_tcpSocket->bytesAvailable());
-    //-- Go straight to Json payload
-    int idx = bytesIn.indexOf('{');
-    //-- We may receive more than one response within one TCP packet.
-    while(idx >= 0) {
-        bytesIn = bytesIn.mid(idx);
-        idx = bytesIn.indexOf('}');
-        if(idx > 0) {
-            QByteArray data = bytesIn.left(idx + 1);
-            emit updateSettings(data);
-            bytesIn = bytesIn.mid(idx+1);
-            idx = bytesIn.indexOf('{');
+    _rxBuffer.append(_tcpSocket->read(_tcpSocket->bytesAvailable()));
+    //-- Responses may be split across TCP packets or several may arrive in one, only
+    //   complete Json payloads are passed on and the rest waits for the next read.
+    int consumed = 0;
+    int start    = -1;
+    int depth    = 0;
+    for(int i = 0; i < _rxBuffer.size(); i++) {
+        const char c = _rxBuffer.at(i);
+        if(c == '{') {
+            if(depth++ == 0) {
+                start = i;
+            }
+        } else if(c == '}' && depth > 0) {
+            if(--depth == 0) {
+                emit updateSettings(_rxBuffer.mid(start, i - start + 1));
+                consumed = i + 1;
+            }
         }
     }
+    //-- Headers in front of an incomplete payload are not needed any more
+    if(depth > 0) {
+        consumed = start;
+    } else {
+        consumed = _rxBuffer.size();
+    }
+    _rxBuffer.remove(0, consumed);
+    if(_rxBuffer.size() > _maxRxBufferSize) {
+        qCWarning(TaisyncLog) << "Dropping unterminated Taisync response";
+        _rxBuffer.clear();
+    }
 }
-
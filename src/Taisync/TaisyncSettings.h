@@ -38,4 +38,7 @@ protected slots:
 private:
     bool    _request                    (const QString& request);
     bool    _post                       (const QString& post, const QString& postPayload);
+
+    QByteArray  _rxBuffer;                          ///< Response bytes not yet part of a complete Json payload
+    static const int _maxRxBufferSize = 64 * 1024;
 };
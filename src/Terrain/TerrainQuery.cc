@@ -18,12 +18,11 @@
 #include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QSslConfiguration>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QTimer>
+#include <QMutexLocker>
 #include <QtLocation/private/qgeotilespec_p.h>
 
+#include <algorithm>
 #include <cmath>
 
 QGC_LOGGING_CATEGORY(TerrainQueryLog, "TerrainQueryLog")
@@ -167,36 +166,72 @@ void TerrainAirMapQuery::_requestFinished(void)
     QByteArray responseBytes = reply->readAll();
     reply->deleteLater();
 
-    // Convert the response to Json
-    QJsonParseError parseError;
-    QJsonDocument responseJson = QJsonDocument::fromJson(responseBytes, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
-        qCWarning(TerrainQueryLog) << "_requestFinished unable to parse json:" << parseError.errorString();
+    // The response is read in a single pass without building a QJsonDocument. The data is only sent back once the
+    // status is known to be success, it can come before or after the data.
+    TerrainJsonReader       reader(responseBytes);
+    QByteArray              key;
+    QString                 status;
+    bool                    dataParsed = false;
+    double                  latStep = qQNaN();
+    double                  lonStep = qQNaN();
+    double                  minHeight = qQNaN();
+    double                  maxHeight = qQNaN();
+    QList<double>           heights;
+    QList<QList<double>>    carpet;
+
+    if (reader.beginObject()) {
+        while (reader.nextKey(key)) {
+            if (key == "status") {
+                QByteArray statusBytes;
+                if (reader.readString(statusBytes)) {
+                    status = QString::fromUtf8(statusBytes);
+                }
+            } else if (key == "data") {
+                switch (_queryMode) {
+                case QueryModeCoordinates:
+                    dataParsed = _parseCoordinateData(reader, heights);
+                    break;
+                case QueryModePath:
+                    dataParsed = _parsePathData(reader, latStep, lonStep, heights);
+                    break;
+                case QueryModeCarpet:
+                    dataParsed = _parseCarpetData(reader, minHeight, maxHeight, carpet);
+                    break;
+                }
+            } else {
+                reader.skipValue();
+            }
+        }
+    }
+    if (reader.error()) {
+        qCWarning(TerrainQueryLog) << "_requestFinished unable to parse json";
         _requestFailed();
         return;
     }
 
     // Check airmap reponse status
-    QJsonObject rootObject = responseJson.object();
-    QString status = rootObject["status"].toString();
     if (status != "success") {
         qCWarning(TerrainQueryLog) << "_requestFinished status != success:" << status;
         _requestFailed();
         return;
     }
+    if (!dataParsed) {
+        qCWarning(TerrainQueryLog) << "_requestFinished data missing";
+        _requestFailed();
+        return;
+    }
 
     // Send back data
-    const QJsonValue& jsonData = rootObject["data"];
     qCDebug(TerrainQueryLog) << "_requestFinished success";
     switch (_queryMode) {
     case QueryModeCoordinates:
-        emit _parseCoordinateData(jsonData);
+        emit coordinateHeightsReceived(true /* success */, heights);
         break;
     case QueryModePath:
-        emit _parsePathData(jsonData);
+        emit pathHeightsReceived(true /* success */, latStep, lonStep, heights);
         break;
     case QueryModeCarpet:
-        emit _parseCarpetData(jsonData);
+        emit carpetHeightsReceived(true /*success*/, minHeight, maxHeight, carpet);
         break;
     }
 }
@@ -216,58 +251,92 @@ void TerrainAirMapQuery::_requestFailed(void)
     }
 }
 
-void TerrainAirMapQuery::_parseCoordinateData(const QJsonValue& coordinateJson)
+bool TerrainAirMapQuery::_parseCoordinateData(TerrainJsonReader& reader, QList<double>& heights)
 {
-    QList<double> heights;
-    const QJsonArray& dataArray = coordinateJson.toArray();
-    for (int i = 0; i < dataArray.count(); i++) {
-        heights.append(dataArray[i].toDouble());
+    if (!reader.beginArray()) {
+        return false;
+    }
+    while (reader.nextElement()) {
+        double height;
+        if (!reader.readNumber(height)) {
+            return false;
+        }
+        heights.append(height);
     }
 
-    emit coordinateHeightsReceived(true /* success */, heights);
+    return !reader.error();
 }
 
-void TerrainAirMapQuery::_parsePathData(const QJsonValue& pathJson)
+bool TerrainAirMapQuery::_parsePathData(TerrainJsonReader& reader, double& latStep, double& lonStep, QList<double>& heights)
 {
-    QJsonObject jsonObject =    pathJson.toArray()[0].toObject();
-    QJsonArray stepArray =      jsonObject["step"].toArray();
-    QJsonArray profileArray =   jsonObject["profile"].toArray();
-
-    double latStep = stepArray[0].toDouble();
-    double lonStep = stepArray[1].toDouble();
-
-    QList<double> heights;
-    for (QJsonValue profileValue: profileArray) {
-        heights.append(profileValue.toDouble());
+    // Only the first path is used
+    if (!reader.beginArray() || !reader.nextElement() || !reader.beginObject()) {
+        return false;
+    }
+    QByteArray key;
+    while (reader.nextKey(key)) {
+        if (key == "step") {
+            double step[2] = { qQNaN(), qQNaN() };
+            if (reader.readNumberArray(step, 2) < 0) {
+                return false;
+            }
+            latStep = step[0];
+            lonStep = step[1];
+        } else if (key == "profile") {
+            if (!_parseCoordinateData(reader, heights)) {
+                return false;
+            }
+        } else {
+            reader.skipValue();
+        }
+    }
+    while (reader.nextElement()) {
+        reader.skipValue();
     }
 
-    emit pathHeightsReceived(true /* success */, latStep, lonStep, heights);
+    return !reader.error();
 }
 
-void TerrainAirMapQuery::_parseCarpetData(const QJsonValue& carpetJson)
+bool TerrainAirMapQuery::_parseCarpetData(TerrainJsonReader& reader, double& minHeight, double& maxHeight, QList<QList<double>>& carpet)
 {
-    QJsonObject jsonObject =    carpetJson.toArray()[0].toObject();
-
-    QJsonObject statsObject =   jsonObject["stats"].toObject();
-    double      minHeight =     statsObject["min"].toDouble();
-    double      maxHeight =     statsObject["max"].toDouble();
-
-    QList<QList<double>> carpet;
-    if (!_carpetStatsOnly) {
-        QJsonArray carpetArray =   jsonObject["carpet"].toArray();
-
-        for (int i=0; i<carpetArray.count(); i++) {
-            QJsonArray rowArray = carpetArray[i].toArray();
-            carpet.append(QList<double>());
-
-            for (int j=0; j<rowArray.count(); j++) {
-                double height = rowArray[j].toDouble();
-                carpet.last().append(height);
+    // Only the first carpet is used
+    if (!reader.beginArray() || !reader.nextElement() || !reader.beginObject()) {
+        return false;
+    }
+    QByteArray key;
+    while (reader.nextKey(key)) {
+        if (key == "stats") {
+            if (!reader.beginObject()) {
+                return false;
+            }
+            while (reader.nextKey(key)) {
+                if (key == "min") {
+                    reader.readNumber(minHeight);
+                } else if (key == "max") {
+                    reader.readNumber(maxHeight);
+                } else {
+                    reader.skipValue();
+                }
+            }
+        } else if (key == "carpet" && !_carpetStatsOnly) {
+            if (!reader.beginArray()) {
+                return false;
+            }
+            while (reader.nextElement()) {
+                carpet.append(QList<double>());
+                if (!_parseCoordinateData(reader, carpet.last())) {
+                    return false;
+                }
             }
+        } else {
+            reader.skipValue();
         }
     }
+    while (reader.nextElement()) {
+        reader.skipValue();
+    }
 
-    emit carpetHeightsReceived(true /*success*/, minHeight, maxHeight, carpet);
+    return !reader.error();
 }
 
 TerrainOfflineAirMapQuery::TerrainOfflineAirMapQuery(QObject* parent)
@@ -300,6 +369,16 @@ void TerrainOfflineAirMapQuery::requestPathHeights(const QGeoCoordinate& fromCoo
     _terrainTileManager->addPathQuery(this, fromCoord, toCoord);
 }
 
+void TerrainOfflineAirMapQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath)
+{
+    if (qgcApp()->runningUnitTests()) {
+        UnitTestTerrainQuery(this).requestPolyPathHeights(polyPath);
+        return;
+    }
+
+    _terrainTileManager->addPolyPathQuery(this, polyPath);
+}
+
 void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
 {
     if (qgcApp()->runningUnitTests()) {
@@ -329,11 +408,40 @@ void TerrainOfflineAirMapQuery::_signalCarpetHeights(bool success, double minHei
     emit carpetHeightsReceived(success, minHeight, maxHeight, carpet);
 }
 
+void TerrainOfflineAirMapQuery::_signalPolyPathHeights(bool success, const QList<TerrainPathHeightInfo_t>& rgPathHeightInfo)
+{
+    emit polyPathHeightsReceived(success, rgPathHeightInfo);
+}
+
+void TerrainOfflineAirMapQuery::_signalPolyPathProgress(double progress)
+{
+    emit polyPathProgress(progress);
+}
+
 TerrainTileManager::TerrainTileManager(void)
+    : _tiles(_maxCachedTiles)
 {
 
 }
 
+TerrainTileManager::TileCacheStats_t TerrainTileManager::tileCacheStats(void)
+{
+    QMutexLocker tilesLock(&_tilesMutex);
+
+    // QCache evicts without telling, contains() does not touch the LRU order
+    qint64 bytes = 0;
+    for (auto it = _tileBytes.begin(); it != _tileBytes.end(); ) {
+        if (_tiles.contains(it.key())) {
+            bytes += it.value();
+            it++;
+        } else {
+            it = _tileBytes.erase(it);
+        }
+    }
+
+    return { _tiles.count(), _tiles.maxCost(), _cacheHits, _cacheMisses, _cacheEvictions, bytes };
+}
+
 void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates)
 {
     qCDebug(TerrainQueryLog) << "TerrainTileManager::addCoordinateQuery count" << coordinates.count();
@@ -344,7 +452,7 @@ void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQu
 
         if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
             qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-            QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCoordinates, 0, 0, coordinates };
+            QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCoordinates, 0, 0, coordinates, {}, {}, {} };
             _requestQueue.append(queuedRequestInfo);
             return;
         }
@@ -404,7 +512,7 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
     QList<double> altitudes;
     if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
         qCDebug(TerrainQueryLog) << "TerrainTileManager::addPathQuery queue count" << _requestQueue.count();
-        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePath, distanceBetween, finalDistanceBetween, coordinates };
+        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModePath, distanceBetween, finalDistanceBetween, coordinates, {}, {}, {} };
         _requestQueue.append(queuedRequestInfo);
         return;
     }
@@ -419,59 +527,270 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
     }
 }
 
-/// Either returns altitudes from cache or queues database request
+/// Queues a single request for terrain heights along all segments of the poly path. The coordinates for all segments
+/// are collected into one list so the tiles they need are only looked up and fetched once.
+void TerrainTileManager::addPolyPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath)
+{
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery count" << polyPath.count();
+
+    QueuedRequestInfo_t requestInfo = { terrainQueryInterface, QueryMode::QueryModePolyPath, 0, 0, {}, {}, {}, {} };
+
+    for (int i=0; i<polyPath.count() - 1; i++) {
+        TerrainPathHeightInfo_t pathHeightInfo;
+
+        QList<QGeoCoordinate> segmentCoords = pathQueryToCoords(polyPath[i], polyPath[i+1], pathHeightInfo.distanceBetween, pathHeightInfo.finalDistanceBetween);
+        requestInfo.coordinates.append(segmentCoords);
+        requestInfo.rgSegmentCoordCount.append(segmentCoords.count());
+        requestInfo.rgPathHeightInfo.append(pathHeightInfo);
+    }
+    for (const QGeoCoordinate& coordinate: requestInfo.coordinates) {
+        requestInfo.tileKeys.insert(_getTileKey(coordinate));
+    }
+
+    if (requestInfo.tileKeys.count() > _maxCachedTiles) {
+        // The tiles would be evicted again before the request could complete
+        qCWarning(TerrainQueryLog) << "addPolyPathQuery: request needs more tiles than the cache can hold" << requestInfo.tileKeys.count();
+        _signalPolyPathHeights(requestInfo, QList<double>());
+        return;
+    }
+
+    bool error;
+    QList<double> altitudes;
+    if (!getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::addPolyPathQuery queue count:tileCount" << _requestQueue.count() << requestInfo.tileKeys.count();
+        _requestQueue.append(requestInfo);
+        return;
+    }
+
+    if (error) {
+        qCWarning(TerrainQueryLog) << "addPolyPathQuery: signalling failure due to internal error";
+        altitudes.clear();
+    } else {
+        qCDebug(TerrainQueryLog) << "addPolyPathQuery: All altitudes taken from cached data";
+    }
+    _signalPolyPathHeights(requestInfo, altitudes);
+}
+
+/// Splits the altitudes for a poly path request back up into segments and signals the results
+void TerrainTileManager::_signalPolyPathHeights(const QueuedRequestInfo_t& requestInfo, const QList<double>& altitudes)
+{
+    QList<TerrainPathHeightInfo_t> rgPathHeightInfo;
+
+    if (altitudes.count() != requestInfo.coordinates.count()) {
+        requestInfo.terrainQueryInterface->_signalPolyPathHeights(false, rgPathHeightInfo);
+        return;
+    }
+
+    rgPathHeightInfo = requestInfo.rgPathHeightInfo;
+
+    int altitudeIndex = 0;
+    for (int i=0; i<rgPathHeightInfo.count(); i++) {
+        rgPathHeightInfo[i].heights = altitudes.mid(altitudeIndex, requestInfo.rgSegmentCoordCount[i]);
+        altitudeIndex += requestInfo.rgSegmentCoordCount[i];
+    }
+
+    requestInfo.terrainQueryInterface->_signalPolyPathProgress(1.0);
+    requestInfo.terrainQueryInterface->_signalPolyPathHeights(true, rgPathHeightInfo);
+}
+
+/// Either returns altitudes from cache or queues database request. Download requests are sent for every missing tile
+/// at once, tiles which are already being downloaded are not requested again.
 ///     @param[out] error true: altitude not returned due to error, false: altitudes returned
 /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
 bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
 {
+    bool allTilesAvailable = true;
+    int  cCoords           = coordinates.count();
+
     error = false;
 
-    for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
+    // Split the coordinates into lat/lon arrays so runs of coordinates within the same tile can be evaluated as a batch
+    QVector<double>     latitudes   (cCoords);
+    QVector<double>     longitudes  (cCoords);
+    QVector<double>     elevations  (cCoords);
+    QVector<quint64>    tileKeys    (cCoords);
+    for (int i=0; i<cCoords; i++) {
+        latitudes[i]    = coordinates[i].latitude();
+        longitudes[i]   = coordinates[i].longitude();
+        tileKeys[i]     = _getTileKey(coordinates[i]);
+    }
 
-        _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            double elevation = _tiles[tileHash].elevation(coordinate);
+    QMutexLocker tilesLock(&_tilesMutex);
+
+    int runStart = 0;
+    while (runStart < cCoords) {
+        quint64 tileKey = tileKeys[runStart];
+        int     runEnd  = runStart + 1;
+        while (runEnd < cCoords && tileKeys[runEnd] == tileKey) {
+            runEnd++;
+        }
+        qCDebug(TerrainQueryVerboseLog) << "TerrainTileManager::getAltitudesForCoordinates key:firstCoordinate:count" << tileKey << coordinates[runStart] << runEnd - runStart;
+
+        const TerrainTile* tile = _tiles.object(tileKey);
+        if (tile) {
+            _cacheHits++;
+            if (allTilesAvailable) {
+                tile->elevations(&latitudes.constData()[runStart], &longitudes.constData()[runStart], runEnd - runStart, &elevations.data()[runStart]);
+            }
+        } else {
+            _cacheMisses++;
+            allTilesAvailable = false;
+            _queueTileFetch(tileKey, FetchPriority::Interactive);
+        }
+
+        runStart = runEnd;
+    }
+
+    if (allTilesAvailable) {
+        altitudes.reserve(altitudes.count() + cCoords);
+        for (double elevation: elevations) {
             if (qIsNaN(elevation)) {
                 error = true;
-                qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates returning elevation from tile cache" << elevation;
             }
             altitudes.push_back(elevation);
-        } else {
-            if (_state != State::Downloading) {
-                QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation",coordinate.longitude(), 1), getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1), 1, &_networkManager);
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates query from database" << request.url();
-                QGeoTileSpec spec;
-                spec.setX(getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1));
-                spec.setY(getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1));
-                spec.setZoom(1);
-                spec.setMapId(getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"));
-                QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
-                connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
-                _state = State::Downloading;
-            }
-            _tilesMutex.unlock();
+        }
+        if (error) {
+            qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
+        }
+    }
+
+    if (!allTilesAvailable) {
+        _startTileFetches();
+    }
+
+    return allTilesAvailable;
+}
 
+bool TerrainTileManager::pathCollision(const QGeoCoordinate& fromCoord, double fromAMSLAlt, const QGeoCoordinate& toCoord, double toAMSLAlt, bool& collision)
+{
+    const double lat1 = fromCoord.latitude();
+    const double lon1 = fromCoord.longitude();
+    const double dLat = toCoord.latitude() - lat1;
+    const double dLon = toCoord.longitude() - lon1;
+    const double dAlt = toAMSLAlt - fromAMSLAlt;
+
+    // Split the path where it crosses tile edges, each piece is then checked against the pyramid of its tile
+    QVector<double> rgSplit = { 0.0, 1.0 };
+    auto addTileEdges = [&rgSplit](double from, double delta, double origin) {
+        double fromTile = (from - origin) / TerrainTile::tileSizeDegrees;
+        double toTile   = (from + delta - origin) / TerrainTile::tileSizeDegrees;
+        if (qFuzzyCompare(fromTile, toTile)) {
+            return;
+        }
+        int firstEdge   = static_cast<int>(std::floor(qMin(fromTile, toTile))) + 1;
+        int lastEdge    = static_cast<int>(std::ceil(qMax(fromTile, toTile))) - 1;
+        for (int edge = firstEdge; edge <= lastEdge; edge++) {
+            rgSplit.append((edge - fromTile) / (toTile - fromTile));
+        }
+    };
+    addTileEdges(lat1, dLat, -90.0);
+    addTileEdges(lon1, dLon, -180.0);
+    std::sort(rgSplit.begin(), rgSplit.end());
+
+    QMutexLocker tilesLock(&_tilesMutex);
+
+    bool pathCollision = false;
+    for (int i = 0; i < rgSplit.count() - 1 && !pathCollision; i++) {
+        double t0 = rgSplit[i];
+        double t1 = rgSplit[i + 1];
+        if (t1 - t0 < 1e-12) {
+            continue;
+        }
+
+        double tMid = (t0 + t1) / 2.0;
+        const TerrainTile* tile = _tiles.object(_getTileKey(_getTileX(lon1 + (dLon * tMid)), _getTileY(lat1 + (dLat * tMid))));
+        if (!tile) {
+            _cacheMisses++;
             return false;
         }
-        _tilesMutex.unlock();
+        _cacheHits++;
+
+        pathCollision = tile->pathCollision(lat1 + (dLat * t0), lon1 + (dLon * t0), fromAMSLAlt + (dAlt * t0),
+                                            lat1 + (dLat * t1), lon1 + (dLon * t1), fromAMSLAlt + (dAlt * t1));
     }
 
+    collision = pathCollision;
     return true;
 }
 
+/// Queues a tile to be fetched. A tile which is already queued or being fetched is not fetched again, all queries
+/// waiting on it are served by the one response. Must be called with _tilesMutex locked.
+void TerrainTileManager::_queueTileFetch(quint64 tileKey, FetchPriority priority)
+{
+    if (_pendingTiles.contains(tileKey)) {
+        // A query is now waiting on a tile which was only being prefetched, so move it ahead of the prefetch work
+        if (priority == FetchPriority::Interactive && _prefetchFetchQueue.removeOne(tileKey)) {
+            _interactiveFetchQueue.append(tileKey);
+        }
+        return;
+    }
+
+    _pendingTiles.insert(tileKey);
+    if (priority == FetchPriority::Interactive) {
+        _interactiveFetchQueue.append(tileKey);
+    } else {
+        _prefetchFetchQueue.append(tileKey);
+    }
+}
+
+/// Starts queued fetches, interactive ones first, up to the concurrent fetch limit. Must be called with _tilesMutex locked.
+void TerrainTileManager::_startTileFetches(void)
+{
+    while (_cFetchesInFlight < _maxConcurrentFetches) {
+        if (!_interactiveFetchQueue.isEmpty()) {
+            _sendTileRequest(_interactiveFetchQueue.takeFirst());
+        } else if (!_prefetchFetchQueue.isEmpty()) {
+            _sendTileRequest(_prefetchFetchQueue.takeFirst());
+        } else {
+            break;
+        }
+    }
+}
+
+/// Removes the tiles waiting to be prefetched. Must be called with _tilesMutex locked.
+void TerrainTileManager::_clearPrefetchQueue(void)
+{
+    for (quint64 tileKey: _prefetchFetchQueue) {
+        _pendingTiles.remove(tileKey);
+    }
+    _prefetchFetchQueue.clear();
+}
+
+/// Sends the request for the tile, which is answered from the map engine cache if available, otherwise from the network.
+/// Must be called with _tilesMutex locked.
+void TerrainTileManager::_sendTileRequest(quint64 tileKey)
+{
+    int x = static_cast<int>(static_cast<qint32>(tileKey >> 32));
+    int y = static_cast<int>(static_cast<qint32>(tileKey & 0xFFFFFFFF));
+
+    QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", x, y, 1, &_networkManager);
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::_sendTileRequest query from database" << request.url() << _cFetchesInFlight;
+    QGeoTileSpec spec;
+    spec.setX(x);
+    spec.setY(y);
+    spec.setZoom(1);
+    spec.setMapId(getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"));
+    QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
+    connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
+    _cFetchesInFlight++;
+}
+
 void TerrainTileManager::_tileFailed(void)
 {
     QList<double>    noAltitudes;
 
+    // Further prefetch requests are likely to fail the same way
+    _tilesMutex.lock();
+    _clearPrefetchQueue();
+    _tilesMutex.unlock();
+
     for (const QueuedRequestInfo_t& requestInfo: _requestQueue) {
         if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
             requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
         } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
             requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
+        } else if (requestInfo.queryMode == QueryMode::QueryModePolyPath) {
+            _signalPolyPathHeights(requestInfo, noAltitudes);
         }
     }
     _requestQueue.clear();
@@ -480,7 +799,6 @@ void TerrainTileManager::_tileFailed(void)
 void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error)
 {
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    _state = State::Idle;
 
     if (!reply) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetched but invalid reply data type.";
@@ -489,7 +807,12 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
 
     // remove from download queue
     QGeoTileSpec spec = reply->tileSpec();
-    QString hash = QGCMapEngine::getTileHash("Airmap Elevation", spec.x(), spec.y(), spec.zoom());
+    quint64 tileKey = _getTileKey(spec.x(), spec.y());
+    _tilesMutex.lock();
+    _pendingTiles.remove(tileKey);
+    _cFetchesInFlight--;
+    _startTileFetches();
+    _tilesMutex.unlock();
 
     // handle potential errors
     if (error != QNetworkReply::NoError) {
@@ -510,12 +833,21 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     TerrainTile* terrainTile = new TerrainTile(responseBytes);
     if (terrainTile->isValid()) {
         _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
+        if (!_tiles.contains(tileKey)) {
+            // The cache takes ownership of the tile and evicts the least recently used tiles to stay within its bounds
+            int cTilesBefore = _tiles.count();
+            _tileBytes[tileKey] = terrainTile->memoryBytes();
+            _tiles.insert(tileKey, terrainTile);
+            int cEvicted = cTilesBefore + 1 - _tiles.count();
+            if (cEvicted > 0) {
+                _cacheEvictions += static_cast<quint64>(cEvicted);
+                qCDebug(TerrainQueryLog) << "Terrain tile cache full, evicted:totalEvictions" << cEvicted << _cacheEvictions;
+            }
         } else {
             delete terrainTile;
         }
         _tilesMutex.unlock();
+        emit tileAdded();
     } else {
         delete terrainTile;
         qCWarning(TerrainQueryLog) << "Received invalid tile";
@@ -547,91 +879,215 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
                     qCDebug(TerrainQueryLog) << "_terrainDone(coordinateQuery): All altitudes taken from cached data";
                     requestInfo.terrainQueryInterface->_signalPathHeights(requestInfo.coordinates.count() == altitudes.count(), requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
                 }
+            } else if (requestInfo.queryMode == QueryMode::QueryModePolyPath) {
+                if (error) {
+                    qCWarning(TerrainQueryLog) << "_terrainDone(polyPathQuery): signalling failure due to internal error";
+                    altitudes.clear();
+                } else {
+                    qCDebug(TerrainQueryLog) << "_terrainDone(polyPathQuery): All altitudes taken from cached data";
+                }
+                _signalPolyPathHeights(requestInfo, altitudes);
             }
             _requestQueue.removeAt(i);
+        } else if (requestInfo.queryMode == QueryMode::QueryModePolyPath && requestInfo.tileKeys.contains(tileKey)) {
+            int readyCount = 0;
+            _tilesMutex.lock();
+            for (quint64 requestTileKey: requestInfo.tileKeys) {
+                if (_tiles.contains(requestTileKey)) {
+                    readyCount++;
+                }
+            }
+            _tilesMutex.unlock();
+            requestInfo.terrainQueryInterface->_signalPolyPathProgress(static_cast<double>(readyCount) / requestInfo.tileKeys.count());
+        }
+    }
+}
+
+/// Computes the same tile x/y as AirmapElevationProvider without going through the url factory, since this is done for
+/// every coordinate looked up.
+int TerrainTileManager::_getTileX(double longitude)
+{
+    return static_cast<int>(floor((longitude + 180.0) / TerrainTile::tileSizeDegrees));
+}
+
+int TerrainTileManager::_getTileY(double latitude)
+{
+    return static_cast<int>(floor((latitude + 90.0) / TerrainTile::tileSizeDegrees));
+}
+
+quint64 TerrainTileManager::_getTileKey(const QGeoCoordinate& coordinate)
+{
+    return _getTileKey(_getTileX(coordinate.longitude()), _getTileY(coordinate.latitude()));
+}
+
+void TerrainTileManager::prefetchArea(const QGeoRectangle& area)
+{
+    if (!area.isValid()) {
+        return;
+    }
+
+    int x0 = _getTileX(area.topLeft().longitude());
+    int x1 = _getTileX(area.bottomRight().longitude());
+    int y0 = _getTileY(area.bottomRight().latitude());
+    int y1 = _getTileY(area.topLeft().latitude());
+
+    qint64 cTiles = (static_cast<qint64>(x1) - x0 + 1) * (static_cast<qint64>(y1) - y0 + 1);
+    if (cTiles > _maxPrefetchTiles) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::prefetchArea area too large to prefetch, tile count" << cTiles;
+        return;
+    }
+
+    QMutexLocker tilesLock(&_tilesMutex);
+
+    _clearPrefetchQueue();
+    for (int x=x0; x<=x1; x++) {
+        for (int y=y0; y<=y1; y++) {
+            quint64 tileKey = _getTileKey(x, y);
+            if (!_tiles.contains(tileKey)) {
+                _queueTileFetch(tileKey, FetchPriority::Prefetch);
+            }
         }
     }
+
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::prefetchArea area:tileCount:prefetchCount" << area << cTiles << _prefetchFetchQueue.count();
+
+    _startTileFetches();
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
+QList<quint64> TerrainTileManager::tileKeysForArea(const QGeoRectangle& area, int maxCount)
 {
-    QString ret = QGCMapEngine::getTileHash(
-        "Airmap Elevation",
-        getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1),
-        getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1),
-        1);
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for " << coordinate << ret;
+    QList<quint64> tileKeys;
+    if (!area.isValid()) {
+        return tileKeys;
+    }
 
-    return ret;
+    int x0 = _getTileX(area.topLeft().longitude());
+    int x1 = _getTileX(area.bottomRight().longitude());
+    int y0 = _getTileY(area.bottomRight().latitude());
+    int y1 = _getTileY(area.topLeft().latitude());
+
+    qint64 cTiles = (static_cast<qint64>(x1) - x0 + 1) * (static_cast<qint64>(y1) - y0 + 1);
+    if (cTiles > maxCount) {
+        return tileKeys;
+    }
+    for (int x=x0; x<=x1; x++) {
+        for (int y=y0; y<=y1; y++) {
+            tileKeys.append(_getTileKey(x, y));
+        }
+    }
+    return tileKeys;
+}
+
+bool TerrainTileManager::tileHillshade(quint64 tileKey, QImage& image, QGeoRectangle& bounds)
+{
+    QMutexLocker tilesLock(&_tilesMutex);
+
+    const TerrainTile* tile = _tiles.object(tileKey);
+    if (!tile) {
+        return false;
+    }
+    image   = tile->hillshade();
+    bounds  = QGeoRectangle(QGeoCoordinate(tile->northEast().latitude(), tile->southWest().longitude()),
+                            QGeoCoordinate(tile->southWest().latitude(), tile->northEast().longitude()));
+    return !image.isNull();
+}
+
+TerrainTileManager* TerrainTileManager::instance(void)
+{
+    return _terrainTileManager;
 }
 
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(void)
 {
     _batchTimer.setSingleShot(true);
-    _batchTimer.setInterval(_batchTimeout);
     connect(&_batchTimer, &QTimer::timeout, this, &TerrainAtCoordinateBatchManager::_sendNextBatch);
-    connect(&_terrainQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, &TerrainAtCoordinateBatchManager::_coordinateHeights);
+    _clock.start();
 }
 
 void TerrainAtCoordinateBatchManager::addQuery(TerrainAtCoordinateQuery* terrainAtCoordinateQuery, const QList<QGeoCoordinate>& coordinates)
 {
     if (coordinates.length() > 0) {
         connect(terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
-        QueuedRequestInfo_t queuedRequestInfo = { terrainAtCoordinateQuery, coordinates };
+        QueuedRequestInfo_t queuedRequestInfo = { terrainAtCoordinateQuery, coordinates, TerrainTileManager::tileKey(coordinates.first()) };
+        const bool interactive = _requestQueue.isEmpty() && coordinates.count() <= _interactiveMaxCoords;
         _requestQueue.append(queuedRequestInfo);
-        if (!_batchTimer.isActive()) {
-            _batchTimer.start();
+        if (interactive) {
+            // Nothing to batch it with, send on the next event loop pass once the caller is done setting up
+            _batchTimer.start(0);
+        } else if (!_batchTimer.isActive()) {
+            _batchTimer.start(_batchWindowMSecs);
         }
     }
 }
 
 void TerrainAtCoordinateBatchManager::_sendNextBatch(void)
 {
-    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
+    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch _requestQueue.count:_sentBatches.count:_batchWindowMSecs" << _requestQueue.count() << _sentBatches.count() << _batchWindowMSecs;
 
-    if (_state != State::Idle) {
-        // Waiting for last download the complete, wait some more
-        qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch waiting for current batch, restarting timer";
-        _batchTimer.start();
+    if (_requestQueue.count() == 0) {
         return;
     }
 
-    if (_requestQueue.count() == 0) {
+    if (_sentBatches.count() >= _maxBatchesInFlight) {
+        // Sent again as batches complete
+        qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch waiting for batches in flight";
         return;
     }
 
-    _sentRequests.clear();
+    // More than one request arriving within the window means load, give the next batch longer to fill up
+    if (_requestQueue.count() > 1 || !_sentBatches.isEmpty()) {
+        _batchWindowMSecs = qMin(_batchWindowMSecs * 2, _maxBatchWindowMSecs);
+    } else {
+        _batchWindowMSecs = qMax(_batchWindowMSecs / 2, _minBatchWindowMSecs);
+    }
 
-    // Convert coordinates to point strings for json query
-    QList<QGeoCoordinate> coords;
-    int requestQueueAdded = 0;
-    for (const QueuedRequestInfo_t& requestInfo: _requestQueue) {
-        SentRequestInfo_t sentRequestInfo = { requestInfo.terrainAtCoordinateQuery, false, requestInfo.coordinates.count() };
-        _sentRequests.append(sentRequestInfo);
-        coords += requestInfo.coordinates;
-        requestQueueAdded++;
-        if (coords.count() > 50) {
-            break;
+    // The batch is made up of the requests which start in the same tile as the oldest request. A batch is only answered
+    // once all of its tiles are available, keeping tiles apart stops requests on cached tiles waiting for downloads.
+    const quint64           batchTileKey = _requestQueue.first().tileKey;
+    SentBatchInfo_t         sentBatchInfo;
+    QList<QGeoCoordinate>   coords;
+    int i = 0;
+    while (i < _requestQueue.count() && coords.count() < _maxBatchCoords) {
+        const QueuedRequestInfo_t& requestInfo = _requestQueue[i];
+        if (requestInfo.tileKey == batchTileKey) {
+            SentRequestInfo_t sentRequestInfo = { requestInfo.terrainAtCoordinateQuery, false, requestInfo.coordinates.count() };
+            sentBatchInfo.sentRequests.append(sentRequestInfo);
+            coords += requestInfo.coordinates;
+            _requestQueue.removeAt(i);
+        } else {
+            i++;
         }
     }
-    _requestQueue = _requestQueue.mid(requestQueueAdded);
-    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch requesting next batch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
-
-    _state = State::Downloading;
-    _terrainQuery.requestCoordinateHeights(coords);
+    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch requesting next batch tileKey:requests:coords:_requestQueue.count" << batchTileKey << sentBatchInfo.sentRequests.count() << coords.count() << _requestQueue.count();
+
+    // Each batch gets its own query object so batches on different tiles can complete in any order
+    TerrainOfflineAirMapQuery* terrainQuery = new TerrainOfflineAirMapQuery(this);
+    sentBatchInfo.terrainQuery  = terrainQuery;
+    sentBatchInfo.sentMSecs     = _clock.elapsed();
+    _sentBatches.append(sentBatchInfo);
+    connect(terrainQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, [this, terrainQuery](bool success, QList<double> heights) {
+        _coordinateHeights(terrainQuery, success, heights);
+    });
+
+    // Heights from cached tiles are signalled before this returns
+    terrainQuery->requestCoordinateHeights(coords);
+
+    if (_requestQueue.count() && !_batchTimer.isActive()) {
+        // The remaining requests are on other tiles, they are ready to go
+        _batchTimer.start(0);
+    }
 }
 
-void TerrainAtCoordinateBatchManager::_batchFailed(void)
+void TerrainAtCoordinateBatchManager::_batchFailed(const QList<SentRequestInfo_t>& sentRequests)
 {
     QList<double> noHeights;
 
-    for (const SentRequestInfo_t& sentRequestInfo: _sentRequests) {
+    for (const SentRequestInfo_t& sentRequestInfo: sentRequests) {
         if (!sentRequestInfo.queryObjectDestroyed) {
             disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
             sentRequestInfo.terrainAtCoordinateQuery->_signalTerrainData(false, noHeights);
         }
     }
-    _sentRequests.clear();
 }
 
 void TerrainAtCoordinateBatchManager::_queryObjectDestroyed(QObject* terrainAtCoordinateQuery)
@@ -651,52 +1107,54 @@ void TerrainAtCoordinateBatchManager::_queryObjectDestroyed(QObject* terrainAtCo
         }
     }
 
-    for (int i=0; i<_sentRequests.count(); i++) {
-        SentRequestInfo_t& sentRequestInfo = _sentRequests[i];
-        if (sentRequestInfo.terrainAtCoordinateQuery == terrainAtCoordinateQuery) {
-            qCDebug(TerrainQueryLog) << "Zombieing deleted provider from _sentRequests index:terrainAtCoordinateQuery" << sentRequestInfo.terrainAtCoordinateQuery;
-            sentRequestInfo.queryObjectDestroyed = true;
+    for (SentBatchInfo_t& sentBatchInfo: _sentBatches) {
+        for (SentRequestInfo_t& sentRequestInfo: sentBatchInfo.sentRequests) {
+            if (sentRequestInfo.terrainAtCoordinateQuery == terrainAtCoordinateQuery) {
+                qCDebug(TerrainQueryLog) << "Zombieing deleted provider from _sentBatches terrainAtCoordinateQuery" << sentRequestInfo.terrainAtCoordinateQuery;
+                sentRequestInfo.queryObjectDestroyed = true;
+            }
         }
     }
 }
 
-QString TerrainAtCoordinateBatchManager::_stateToString(State state)
+void TerrainAtCoordinateBatchManager::_coordinateHeights(TerrainOfflineAirMapQuery* terrainQuery, bool success, QList<double> heights)
 {
-    switch (state) {
-    case State::Idle:
-        return QStringLiteral("Idle");
-    case State::Downloading:
-        return QStringLiteral("Downloading");
+    int batchIndex = -1;
+    for (int i=0; i<_sentBatches.count(); i++) {
+        if (_sentBatches[i].terrainQuery == terrainQuery) {
+            batchIndex = i;
+            break;
+        }
     }
-
-    return QStringLiteral("State unknown");
-}
-
-void TerrainAtCoordinateBatchManager::_coordinateHeights(bool success, QList<double> heights)
-{
-    _state = State::Idle;
-
-    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_coordinateHeights signalled success:count" << success << heights.count();
-
-    if (!success) {
-        _batchFailed();
+    if (batchIndex == -1) {
+        qCWarning(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_coordinateHeights unknown batch";
         return;
     }
+    SentBatchInfo_t sentBatchInfo = _sentBatches.takeAt(batchIndex);
+    terrainQuery->deleteLater();
 
-    int currentIndex = 0;
-    for (const SentRequestInfo_t& sentRequestInfo: _sentRequests) {
-        if (!sentRequestInfo.queryObjectDestroyed) {
-            qCDebug(TerrainQueryVerboseLog) << "TerrainAtCoordinateBatchManager::_coordinateHeights returned TerrainCoordinateQuery:count" <<  sentRequestInfo.terrainAtCoordinateQuery << sentRequestInfo.cCoord;
-            disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
-            QList<double> requestAltitudes = heights.mid(currentIndex, sentRequestInfo.cCoord);
-            sentRequestInfo.terrainAtCoordinateQuery->_signalTerrainData(true, requestAltitudes);
+    const qint64 latencyMSecs = _clock.elapsed() - sentBatchInfo.sentMSecs;
+    _averageLatencyMSecs = _averageLatencyMSecs == 0 ? latencyMSecs : (_latencySmoothing * latencyMSecs) + ((1.0 - _latencySmoothing) * _averageLatencyMSecs);
+    qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_coordinateHeights signalled success:count:latencyMSecs:averageLatencyMSecs" << success << heights.count() << latencyMSecs << _averageLatencyMSecs;
+
+    if (!success) {
+        _batchFailed(sentBatchInfo.sentRequests);
+    } else {
+        int currentIndex = 0;
+        for (const SentRequestInfo_t& sentRequestInfo: sentBatchInfo.sentRequests) {
+            if (!sentRequestInfo.queryObjectDestroyed) {
+                qCDebug(TerrainQueryVerboseLog) << "TerrainAtCoordinateBatchManager::_coordinateHeights returned TerrainCoordinateQuery:count" <<  sentRequestInfo.terrainAtCoordinateQuery << sentRequestInfo.cCoord;
+                disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
+                QList<double> requestAltitudes = heights.mid(currentIndex, sentRequestInfo.cCoord);
+                sentRequestInfo.terrainAtCoordinateQuery->_signalTerrainData(true, requestAltitudes);
+            }
+            // Zombied requests still occupy their slice of the heights
             currentIndex += sentRequestInfo.cCoord;
         }
     }
-    _sentRequests.clear();
 
-    if (_requestQueue.count()) {
-        _batchTimer.start();
+    if (_requestQueue.count() && !_batchTimer.isActive()) {
+        _batchTimer.start(_batchWindowMSecs);
     }
 }
 
@@ -719,6 +1177,20 @@ bool TerrainAtCoordinateQuery::getAltitudesForCoordinates(const QList<QGeoCoordi
     return _terrainTileManager->getAltitudesForCoordinates(coordinates, altitudes, error);
 }
 
+TerrainTileManager::TileCacheStats_t TerrainAtCoordinateQuery::tileCacheStats(void)
+{
+    return _terrainTileManager->tileCacheStats();
+}
+
+void TerrainAtCoordinateQuery::prefetchArea(const QGeoRectangle& area)
+{
+    if (qgcApp()->runningUnitTests()) {
+        return;
+    }
+
+    _terrainTileManager->prefetchArea(area);
+}
+
 void TerrainAtCoordinateQuery::_signalTerrainData(bool success, QList<double>& heights)
 {
     emit terrainDataReceived(success, heights);
@@ -739,6 +1211,16 @@ void TerrainPathQuery::requestData(const QGeoCoordinate& fromCoord, const QGeoCo
     _terrainQuery.requestPathHeights(fromCoord, toCoord);
 }
 
+bool TerrainPathQuery::pathCollision(const QGeoCoordinate& fromCoord, double fromAMSLAlt, const QGeoCoordinate& toCoord, double toAMSLAlt, bool& collision)
+{
+    if (qgcApp()->runningUnitTests()) {
+        // Unit tests use the emulated terrain from UnitTestTerrainQuery, which is not in the tile cache
+        return false;
+    }
+
+    return _terrainTileManager->pathCollision(fromCoord, fromAMSLAlt, toCoord, toAMSLAlt, collision);
+}
+
 void TerrainPathQuery::_pathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights)
 {
     PathHeightInfo_t pathHeightInfo;
@@ -753,9 +1235,9 @@ void TerrainPathQuery::_pathHeights(bool success, double distanceBetween, double
 
 TerrainPolyPathQuery::TerrainPolyPathQuery(bool autoDelete)
     : _autoDelete   (autoDelete)
-    , _pathQuery    (false /* autoDelete */)
 {
-    connect(&_pathQuery, &TerrainPathQuery::terrainDataReceived, this, &TerrainPolyPathQuery::_terrainDataReceived);
+    connect(&_terrainQuery, &TerrainQueryInterface::polyPathHeightsReceived,  this, &TerrainPolyPathQuery::_polyPathHeights);
+    connect(&_terrainQuery, &TerrainQueryInterface::polyPathProgress,         this, &TerrainPolyPathQuery::progressChanged);
 }
 
 void TerrainPolyPathQuery::requestData(const QVariantList& polyPath)
@@ -773,33 +1255,22 @@ void TerrainPolyPathQuery::requestData(const QList<QGeoCoordinate>& polyPath)
 {
     qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::requestData count" << polyPath.count();
 
-    // Kick off first request
-    _rgCoords = polyPath;
-    _curIndex = 0;
-    _pathQuery.requestData(_rgCoords[0], _rgCoords[1]);
-}
-
-void TerrainPolyPathQuery::_terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
-{
-    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived success:_curIndex" << success << _curIndex;
-
-    if (!success) {
-        _rgPathHeightInfo.clear();
-        emit terrainDataReceived(false /* success */, _rgPathHeightInfo);
+    if (polyPath.count() < 2) {
+        qCWarning(TerrainQueryLog) << "TerrainPolyPathQuery::requestData Internal Error: poly path must have at least two coordinates";
+        _polyPathHeights(false /* success */, QList<TerrainPathHeightInfo_t>());
         return;
     }
 
-    _rgPathHeightInfo.append(pathHeightInfo);
+    _terrainQuery.requestPolyPathHeights(polyPath);
+}
 
-    if (++_curIndex >= _rgCoords.count() - 1) {
-        // We've finished all requests
-        qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_terrainDataReceived complete";
-        emit terrainDataReceived(true /* success */, _rgPathHeightInfo);
-        if (_autoDelete) {
-            deleteLater();
-        }
-    } else {
-        _pathQuery.requestData(_rgCoords[_curIndex], _rgCoords[_curIndex+1]);
+void TerrainPolyPathQuery::_polyPathHeights(bool success, const QList<TerrainPathHeightInfo_t>& rgPathHeightInfo)
+{
+    qCDebug(TerrainQueryLog) << "TerrainPolyPathQuery::_polyPathHeights success:count" << success << rgPathHeightInfo.count();
+
+    emit terrainDataReceived(success, rgPathHeightInfo);
+    if (_autoDelete) {
+        deleteLater();
     }
 }
 
@@ -854,6 +1325,22 @@ void UnitTestTerrainQuery::requestPathHeights(const QGeoCoordinate& fromCoord, c
     );
 }
 
+void UnitTestTerrainQuery::requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath) {
+    QList<TerrainPathHeightInfo_t> rgPathHeightInfo;
+
+    for (int i=0; i<polyPath.count() - 1; i++) {
+        auto unitTestPathHeightInfo = _requestPathHeights(polyPath[i], polyPath[i+1]);
+
+        TerrainPathHeightInfo_t pathHeightInfo;
+        pathHeightInfo.distanceBetween      = unitTestPathHeightInfo.distanceBetween;
+        pathHeightInfo.finalDistanceBetween = unitTestPathHeightInfo.finalDistanceBetween;
+        pathHeightInfo.heights              = unitTestPathHeightInfo.rgHeights;
+        rgPathHeightInfo.append(pathHeightInfo);
+    }
+
+    emit qobject_cast<TerrainQueryInterface*>(parent())->polyPathHeightsReceived(rgPathHeightInfo.count() > 0, rgPathHeightInfo);
+}
+
 void UnitTestTerrainQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool) {
     QList<QList<double>> carpet;
 
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "TerrainTile.h"
+#include "TerrainJsonReader.h"
 #include "QGCMapEngineData.h"
 #include "QGCLoggingCategory.h"
 
@@ -19,6 +20,10 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QHash>
+#include <QCache>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainQueryLog)
@@ -26,6 +31,13 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainQueryVerboseLog)
 
 class TerrainAtCoordinateQuery;
 
+/// Terrain heights along the path between two coordinates
+typedef struct {
+    double          distanceBetween;        ///< Distance between each height value
+    double          finalDistanceBetween;   ///< Distance between final two height values
+    QList<double>   heights;                ///< Terrain heights along path
+} TerrainPathHeightInfo_t;
+
 /// Base class for offline/online terrain queries
 class TerrainQueryInterface : public QObject
 {
@@ -54,6 +66,8 @@ signals:
     void coordinateHeightsReceived(bool success, QList<double> heights);
     void pathHeightsReceived(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
     void carpetHeightsReceived(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+    void polyPathHeightsReceived(bool success, const QList<TerrainPathHeightInfo_t>& rgPathHeightInfo);
+    void polyPathProgress(double progress);
 };
 
 /// AirMap online implementation of terrain queries
@@ -76,9 +90,9 @@ private slots:
 private:
     void _sendQuery                 (const QString& path, const QUrlQuery& urlQuery);
     void _requestFailed             (void);
-    void _parseCoordinateData       (const QJsonValue& coordinateJson);
-    void _parsePathData             (const QJsonValue& pathJson);
-    void _parseCarpetData           (const QJsonValue& carpetJson);
+    bool _parseCoordinateData       (TerrainJsonReader& reader, QList<double>& heights);
+    bool _parsePathData             (TerrainJsonReader& reader, double& latStep, double& lonStep, QList<double>& heights);
+    bool _parseCarpetData           (TerrainJsonReader& reader, double& minHeight, double& maxHeight, QList<QList<double>>& carpet);
 
     enum QueryMode {
         QueryModeCoordinates,
@@ -103,10 +117,17 @@ public:
     void requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
     void requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
 
+    /// Requests terrain heights along each segment of the poly path as a single batch. Tiles needed by the batch are
+    /// fetched concurrently.
+    /// Signals: polyPathProgress as tiles arrive, polyPathHeights when data for all segments is available
+    void requestPolyPathHeights(const QList<QGeoCoordinate>& polyPath);
+
     // Internal methods
     void _signalCoordinateHeights(bool success, QList<double> heights);
     void _signalPathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
     void _signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+    void _signalPolyPathHeights(bool success, const QList<TerrainPathHeightInfo_t>& rgPathHeightInfo);
+    void _signalPolyPathProgress(double progress);
 };
 
 /// Used internally by TerrainOfflineAirMapQuery to manage terrain tiles
@@ -118,45 +139,112 @@ public:
 
     void addCoordinateQuery         (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates);
     void addPathQuery               (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
+    void addPolyPathQuery           (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& polyPath);
     bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
 
+    /// Checks the straight path between two coordinates against the cached tiles. Does not fetch tiles.
+    ///     @param[out] collision true: terrain is above the path somewhere along it
+    /// @return false: not all tiles along the path are in the cache, collision is not set
+    bool pathCollision              (const QGeoCoordinate& fromCoord, double fromAMSLAlt, const QGeoCoordinate& toCoord, double toAMSLAlt, bool& collision);
+
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween);
 
+    typedef struct {
+        int     tileCount;
+        int     maxTileCount;
+        quint64 hits;           ///< Tile lookups satisfied from the cache
+        quint64 misses;         ///< Tile lookups which required a download
+        quint64 evictions;      ///< Least recently used tiles removed to make room for new ones
+        qint64  bytes;          ///< Memory held by the cached tiles
+    } TileCacheStats_t;
+
+    TileCacheStats_t tileCacheStats(void);
+
+    /// Loads the tiles for the area into the cache in the background. Tiles come from the map engine disk cache if
+    /// available, otherwise from the network, which also saves them to the disk cache. Only the latest area is
+    /// prefetched, previous areas which have not completed yet are dropped.
+    void prefetchArea(const QGeoRectangle& area);
+
+    /// @return Keys of the tiles covering the area, empty if more than maxCount tiles are needed
+    static QList<quint64> tileKeysForArea(const QGeoRectangle& area, int maxCount);
+
+    /// @return Key of the tile containing the coordinate
+    static quint64 tileKey(const QGeoCoordinate& coordinate) { return _getTileKey(coordinate); }
+
+    /// Hillshade of a cached tile for display. Does not fetch the tile.
+    ///     @return false: tile is not in the cache
+    bool tileHillshade(quint64 tileKey, QImage& image, QGeoRectangle& bounds);
+
+    static TerrainTileManager* instance(void);
+
+signals:
+    void tileAdded(void);
+
 private slots:
     void _terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error);
 
 private:
-    enum class State {
-        Idle,
-        Downloading,
-    };
-
     enum QueryMode {
         QueryModeCoordinates,
         QueryModePath,
-        QueryModeCarpet
+        QueryModeCarpet,
+        QueryModePolyPath
     };
 
     typedef struct {
-        TerrainOfflineAirMapQuery*  terrainQueryInterface;
-        QueryMode                   queryMode;
-        double                      distanceBetween;        // Distance between each returned height
-        double                      finalDistanceBetween;   // Distance between for final height
-        QList<QGeoCoordinate>       coordinates;
+        TerrainOfflineAirMapQuery*      terrainQueryInterface;
+        QueryMode                       queryMode;
+        double                          distanceBetween;        // Distance between each returned height
+        double                          finalDistanceBetween;   // Distance between for final height
+        QList<QGeoCoordinate>           coordinates;
+        QList<TerrainPathHeightInfo_t>  rgPathHeightInfo;       // QueryModePolyPath: Segment distances, heights are filled in on completion
+        QList<int>                      rgSegmentCoordCount;    // QueryModePolyPath: Number of coordinates for each segment
+        QSet<quint64>                   tileKeys;               // QueryModePolyPath: Tiles needed by the request, used for progress
     } QueuedRequestInfo_t;
 
+    enum class FetchPriority {
+        Interactive,    ///< Needed by a query which is waiting on it
+        Prefetch,
+    };
+
     void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    void    _queueTileFetch                     (quint64 tileKey, FetchPriority priority);
+    void    _startTileFetches                   (void);
+    void    _sendTileRequest                    (quint64 tileKey);
+    void    _clearPrefetchQueue                 (void);
+    void    _signalPolyPathHeights              (const QueuedRequestInfo_t& requestInfo, const QList<double>& altitudes);
+
+    static quint64          _getTileKey         (int x, int y) { return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y); }
+    static quint64          _getTileKey         (const QGeoCoordinate& coordinate);
+    static int              _getTileX           (double longitude);
+    static int              _getTileY           (double latitude);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
-    State                       _state = State::Idle;
     QNetworkAccessManager       _networkManager;
 
-    QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    // All of the following are protected by _tilesMutex. Tiles are keyed by their packed x/y tile coordinates.
+    QMutex                          _tilesMutex;
+    QCache<quint64, TerrainTile>    _tiles;
+    QHash<quint64, qint64>          _tileBytes;         ///< Size of each tile added to _tiles, evicted tiles are pruned when the stats are read
+    QSet<quint64>                   _pendingTiles;      ///< Tiles queued for fetch or being fetched, each tile is only fetched once
+    QList<quint64>                  _interactiveFetchQueue;
+    QList<quint64>                  _prefetchFetchQueue;
+    int                             _cFetchesInFlight   = 0;
+    quint64                         _cacheHits      = 0;
+    quint64                         _cacheMisses    = 0;
+    quint64                         _cacheEvictions = 0;
+
+    static const int _maxCachedTiles        = 10000;    ///< Around 45MB of elevation data and min/max pyramids
+    static const int _maxPrefetchTiles      = 2500;     ///< Larger areas are not prefetched
+    static const int _maxConcurrentFetches  = 8;
+
+    friend class PlanningBenchmark;
 };
 
-/// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
+/// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together.
+/// A lone small request is sent right away so interactive readouts are not delayed. Under load the batching window
+/// grows so more requests share a batch. Requests are batched by tile, so requests on cached tiles are not held up
+/// by ones waiting for a download.
 class TerrainAtCoordinateBatchManager : public QObject {
     Q_OBJECT
 
@@ -165,15 +253,18 @@ public:
 
     void addQuery(TerrainAtCoordinateQuery* terrainAtCoordinateQuery, const QList<QGeoCoordinate>& coordinates);
 
+    /// @return Smoothed time from a batch being sent to its heights being returned
+    double averageBatchLatencyMSecs(void) const { return _averageLatencyMSecs; }
+
 private slots:
     void _sendNextBatch         (void);
     void _queryObjectDestroyed  (QObject* elevationProvider);
-    void _coordinateHeights     (bool success, QList<double> heights);
 
 private:
     typedef struct {
         TerrainAtCoordinateQuery*   terrainAtCoordinateQuery;
         QList<QGeoCoordinate>       coordinates;
+        quint64                     tileKey;                ///< Tile of the first coordinate
     } QueuedRequestInfo_t;
 
     typedef struct {
@@ -182,21 +273,28 @@ private:
         int                         cCoord;
     } SentRequestInfo_t;
 
+    typedef struct {
+        TerrainOfflineAirMapQuery*  terrainQuery;
+        QList<SentRequestInfo_t>    sentRequests;
+        qint64                      sentMSecs;
+    } SentBatchInfo_t;
 
-    enum class State {
-        Idle,
-        Downloading,
-    };
-
-    void _batchFailed(void);
-    QString _stateToString(State state);
+    void _coordinateHeights (TerrainOfflineAirMapQuery* terrainQuery, bool success, QList<double> heights);
+    void _batchFailed       (const QList<SentRequestInfo_t>& sentRequests);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
-    QList<SentRequestInfo_t>    _sentRequests;
-    State                       _state = State::Idle;
-    const int                   _batchTimeout = 500;
+    QList<SentBatchInfo_t>      _sentBatches;
+    int                         _batchWindowMSecs       = _minBatchWindowMSecs;
+    double                      _averageLatencyMSecs    = 0;
     QTimer                      _batchTimer;
-    TerrainOfflineAirMapQuery   _terrainQuery;
+    QElapsedTimer               _clock;
+
+    static const int _minBatchWindowMSecs       = 10;
+    static const int _maxBatchWindowMSecs       = 500;
+    static const int _interactiveMaxCoords      = 4;    ///< Requests this small are sent without waiting when nothing else is queued
+    static const int _maxBatchCoords            = 2000;
+    static const int _maxBatchesInFlight        = 8;
+    static constexpr double _latencySmoothing   = 0.2;
 };
 
 // IMPORTANT NOTE: The terrain query objects below must continue to live until the the terrain system signals data back through them.
@@ -226,6 +324,12 @@ public:
     /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
     static bool getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
 
+    /// @return Statistics for the terrain tile cache shared by all queries
+    static TerrainTileManager::TileCacheStats_t tileCacheStats(void);
+
+    /// Loads terrain data for the area into the cache in the background
+    static void prefetchArea(const QGeoRectangle& area);
+
     // Internal method
     void _signalTerrainData(bool success, QList<double>& heights);
 
@@ -249,11 +353,13 @@ public:
     ///     @param coordinates to query
     void requestData(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
 
-    typedef struct {
-        double          distanceBetween;        ///< Distance between each height value
-        double          finalDistanceBetween;   ///< Distance between final two height values
-        QList<double>   heights;                ///< Terrain heights along path
-    } PathHeightInfo_t;
+    typedef TerrainPathHeightInfo_t PathHeightInfo_t;
+
+    /// Synchronous collision check of the straight path between two coordinates, using only terrain tiles which are
+    /// already cached
+    ///     @param[out] collision true: terrain is above the path somewhere along it
+    /// @return false: terrain data for the path is not cached, collision is not set
+    static bool pathCollision(const QGeoCoordinate& fromCoord, double fromAMSLAlt, const QGeoCoordinate& toCoord, double toAMSLAlt, bool& collision);
 
 signals:
     /// Signalled when terrain data comes back from server
@@ -277,8 +383,8 @@ public:
     /// @param autoDelete true: object will delete itself after it signals results
     TerrainPolyPathQuery(bool autoDelete);
 
-    /// Async terrain query for terrain heights for the paths between each specified QGeoCoordinate.
-    /// When the query is done, the terrainData() signal is emitted.
+    /// Async terrain query for terrain heights for the paths between each specified QGeoCoordinate. All segments are
+    /// requested as a single batch. When the query is done, the terrainData() signal is emitted.
     ///     @param polyPath List of QGeoCoordinate
     void requestData(const QVariantList& polyPath);
     void requestData(const QList<QGeoCoordinate>& polyPath);
@@ -287,15 +393,16 @@ signals:
     /// Signalled when terrain data comes back from server
     void terrainDataReceived(bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
 
+    /// Signalled as terrain tiles needed by the query become available
+    ///     @param progress 0-1
+    void progressChanged(double progress);
+
 private slots:
-    void _terrainDataReceived(bool success, const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void _polyPathHeights(bool success, const QList<TerrainPathHeightInfo_t>& rgPathHeightInfo);
 
 private:
-    bool                                        _autoDelete;
-    int                                         _curIndex = 0;
-    QList<QGeoCoordinate>                       _rgCoords;
-    QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;
-    TerrainPathQuery                            _pathQuery;
+    bool                        _autoDelete;
+    TerrainOfflineAirMapQuery   _terrainQuery;
 };
 
 /// @brief Provides unit test terrain query responses.
@@ -359,6 +466,8 @@ public:
     void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) override;
     void requestCarpetHeights       (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) override;
 
+    void requestPolyPathHeights     (const QList<QGeoCoordinate>& polyPath);
+
 private:
     typedef struct {
         QList<QGeoCoordinate>   rgCoords;
@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainJsonReader.h"
+
+TerrainJsonReader::TerrainJsonReader(const QByteArray& bytes)
+    : _current          (bytes.constData())
+    , _end              (bytes.constData() + bytes.size())
+    , _error            (false)
+    , _firstInContainer (false)
+{
+
+}
+
+bool TerrainJsonReader::_fail(void)
+{
+    _error = true;
+    return false;
+}
+
+bool TerrainJsonReader::_skipWhitespace(void)
+{
+    while (_current < _end && (*_current == ' ' || *_current == '\n' || *_current == '\r' || *_current == '\t')) {
+        _current++;
+    }
+    return _current < _end;
+}
+
+bool TerrainJsonReader::_expect(char c)
+{
+    if (_error || !_skipWhitespace() || *_current != c) {
+        return _fail();
+    }
+    _current++;
+    return true;
+}
+
+bool TerrainJsonReader::atEnd(void)
+{
+    return !_skipWhitespace();
+}
+
+bool TerrainJsonReader::beginObject(void)
+{
+    if (!_expect('{')) {
+        return false;
+    }
+    _firstInContainer = true;
+    return true;
+}
+
+bool TerrainJsonReader::beginArray(void)
+{
+    if (!_expect('[')) {
+        return false;
+    }
+    _firstInContainer = true;
+    return true;
+}
+
+bool TerrainJsonReader::nextKey(QByteArray& key)
+{
+    if (_error || !_skipWhitespace()) {
+        return _fail();
+    }
+    if (*_current == '}') {
+        _current++;
+        _firstInContainer = false;
+        return false;
+    }
+    if (!_firstInContainer && !_expect(',')) {
+        return false;
+    }
+    _firstInContainer = false;
+
+    return readString(key) && _expect(':');
+}
+
+bool TerrainJsonReader::nextElement(void)
+{
+    if (_error || !_skipWhitespace()) {
+        return _fail();
+    }
+    if (*_current == ']') {
+        _current++;
+        _firstInContainer = false;
+        return false;
+    }
+    if (!_firstInContainer && !_expect(',')) {
+        return false;
+    }
+    _firstInContainer = false;
+
+    return true;
+}
+
+bool TerrainJsonReader::readNumber(double& value)
+{
+    if (_error || !_skipWhitespace()) {
+        return _fail();
+    }
+
+    // Elevations are integers, which are converted here without going through strtod
+    const char* start = _current;
+    bool negative = false;
+    if (*_current == '-') {
+        negative = true;
+        _current++;
+    }
+    qint64 integer = 0;
+    const char* digits = _current;
+    while (_current < _end && *_current >= '0' && *_current <= '9' && _current - digits < 18) {
+        integer = (integer * 10) + (*_current - '0');
+        _current++;
+    }
+    if (_current == digits) {
+        return _fail();
+    }
+    if (_current == _end || (*_current != '.' && *_current != 'e' && *_current != 'E' && (*_current < '0' || *_current > '9'))) {
+        value = static_cast<double>(negative ? -integer : integer);
+        return true;
+    }
+
+    // Fractions, exponents and very long numbers use the full conversion
+    while (_current < _end && ((*_current >= '0' && *_current <= '9') || *_current == '.' || *_current == 'e' || *_current == 'E' || *_current == '+' || *_current == '-')) {
+        _current++;
+    }
+    bool ok;
+    value = QByteArray::fromRawData(start, static_cast<int>(_current - start)).toDouble(&ok);
+    return ok ? true : _fail();
+}
+
+bool TerrainJsonReader::readString(QByteArray& value)
+{
+    if (!_expect('"')) {
+        return false;
+    }
+
+    value.clear();
+    const char* start = _current;
+    while (_current < _end && *_current != '"') {
+        if (*_current == '\\') {
+            // Escapes are rare in these responses, only the simple ones are decoded
+            value.append(start, static_cast<int>(_current - start));
+            if (++_current == _end) {
+                return _fail();
+            }
+            switch (*_current) {
+            case 'n':   value.append('\n'); break;
+            case 't':   value.append('\t'); break;
+            case 'r':   value.append('\r'); break;
+            case 'b':   value.append('\b'); break;
+            case 'f':   value.append('\f'); break;
+            case 'u':
+                if (_end - _current < 5) {
+                    return _fail();
+                }
+                value.append('?');
+                _current += 4;
+                break;
+            default:    value.append(*_current); break;
+            }
+            start = ++_current;
+        } else {
+            _current++;
+        }
+    }
+    if (_current == _end) {
+        return _fail();
+    }
+    value.append(start, static_cast<int>(_current - start));
+    _current++;
+
+    return true;
+}
+
+bool TerrainJsonReader::skipValue(void)
+{
+    if (_error || !_skipWhitespace()) {
+        return _fail();
+    }
+
+    switch (*_current) {
+    case '"':
+    {
+        QByteArray dummy;
+        return readString(dummy);
+    }
+    case '{':
+    case '[':
+    {
+        // Containers are skipped by matching brackets, strings are stepped over so brackets inside them don't count
+        int depth = 0;
+        while (_current < _end) {
+            char c = *_current++;
+            if (c == '"') {
+                while (_current < _end && *_current != '"') {
+                    if (*_current == '\\') {
+                        _current++;
+                    }
+                    _current++;
+                }
+                if (_current >= _end) {
+                    return _fail();
+                }
+                _current++;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    _firstInContainer = false;
+                    return true;
+                }
+            }
+        }
+        return _fail();
+    }
+    case 't':
+    case 'f':
+    case 'n':
+        while (_current < _end && *_current >= 'a' && *_current <= 'z') {
+            _current++;
+        }
+        return true;
+    default:
+    {
+        double dummy;
+        return readNumber(dummy);
+    }
+    }
+}
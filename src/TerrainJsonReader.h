@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+
+/// Forward only reader for json elevation responses. Values are read straight out of the response bytes, which avoids
+/// building a QJsonDocument with a QJsonValue for each of the thousands of values in a carpet.
+///
+/// Usage: beginObject() then nextKey() until it returns false, beginArray() then nextElement() until it returns false.
+/// Each key and element must be followed by reading or skipping its value. Once an error is hit all calls return false.
+class TerrainJsonReader
+{
+public:
+    /// The bytes must stay valid for the lifetime of the reader
+    TerrainJsonReader(const QByteArray& bytes);
+
+    bool    beginObject (void);
+    /// @return true: key is set and the value follows, false: end of object or error
+    bool    nextKey     (QByteArray& key);
+    bool    beginArray  (void);
+    /// @return true: an element follows, false: end of array or error
+    bool    nextElement (void);
+
+    bool    readNumber  (double& value);
+    bool    readString  (QByteArray& value);
+    bool    skipValue   (void);
+
+    /// Reads an array of numbers, e.g. a carpet row
+    ///     @param values  Values are written here
+    ///     @param maxValues Additional values in the array are skipped
+    /// @return Number of values in the array, -1 on error
+    template<typename T>
+    int readNumberArray(T* values, int maxValues)
+    {
+        if (!beginArray()) {
+            return -1;
+        }
+        int count = 0;
+        while (nextElement()) {
+            double value;
+            if (!readNumber(value)) {
+                return -1;
+            }
+            if (count < maxValues) {
+                values[count] = static_cast<T>(value);
+            }
+            count++;
+        }
+        return _error ? -1 : count;
+    }
+
+    bool    error       (void) const { return _error; }
+    bool    atEnd       (void);
+
+private:
+    bool    _skipWhitespace (void);
+    bool    _expect         (char c);
+    bool    _fail           (void);
+
+    const char* _current;
+    const char* _end;
+    bool        _error;
+    bool        _firstInContainer;  ///< true: no separator expected before the next key or element
+};
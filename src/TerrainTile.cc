@@ -8,16 +8,18 @@
  ****************************************************************************/
 
 #include "TerrainTile.h"
-#include "JsonHelper.h"
 #include "QGCMapEngine.h"
 #include "QGC.h"
+#include "TerrainJsonReader.h"
 
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QDataStream>
 #include <QtMath>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog");
 
 const char*  TerrainTile::_jsonStatusKey        = "status";
@@ -35,7 +37,6 @@ TerrainTile::TerrainTile()
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
@@ -43,22 +44,17 @@ TerrainTile::TerrainTile()
 
 }
 
-TerrainTile::~TerrainTile()
+qint64 TerrainTile::memoryBytes(void) const
 {
-    if (_data) {
-        for (int i = 0; i < _gridSizeLat; i++) {
-            delete[] _data[i];
-        }
-        delete[] _data;
-        _data = nullptr;
-    }
+    return static_cast<qint64>(sizeof(*this))
+            + static_cast<qint64>(_data.capacity() + _pyramidMin.capacity() + _pyramidMax.capacity()) * static_cast<qint64>(sizeof(int16_t))
+            + static_cast<qint64>(_pyramidLevels.capacity()) * static_cast<qint64>(sizeof(PyramidLevel_t));
 }
 
 TerrainTile::TerrainTile(QByteArray byteArray)
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
@@ -85,24 +81,22 @@ TerrainTile::TerrainTile(QByteArray byteArray)
     qCDebug(TerrainTileLog) << "Loading terrain tile: " << _southWest << " - " << _northEast;
     qCDebug(TerrainTileLog) << "min:max:avg:sizeLat:sizeLon" << _minElevation << _maxElevation << _avgElevation << _gridSizeLat << _gridSizeLon;
 
+    if (_gridSizeLat < 2 || _gridSizeLon < 2) {
+        qWarning() << "Terrain tile grid size invalid" << _gridSizeLat << _gridSizeLon;
+        return;
+    }
+
     int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _gridSizeLat * _gridSizeLon;
     if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
         qWarning() << "Terrain tile binary data too small for tile data";
         return;
     }
 
-    _data = new int16_t*[_gridSizeLat];
-    for (int k = 0; k < _gridSizeLat; k++) {
-        _data[k] = new int16_t[_gridSizeLon];
-    }
+    // The serialized data is already row major, so it is copied across as a single block
+    _data.resize(_gridSizeLat * _gridSizeLon);
+    memcpy(_data.data(), &byteArray.constData()[cTileHeaderBytes], static_cast<size_t>(cTileDataBytes));
 
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _gridSizeLat; i++) {
-        for (int j = 0; j < _gridSizeLon; j++) {
-            _data[i][j] = pTileData[valueIndex++];
-        }
-    }
+    _buildPyramid();
 
     _isValid = true;
 
@@ -111,40 +105,275 @@ TerrainTile::TerrainTile(QByteArray byteArray)
 
 double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
 {
-    if (_isValid && _southWest.isValid() && _northEast.isValid()) {
-        qCDebug(TerrainTileLog) << "elevation: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast;
+    double latitude     = coordinate.latitude();
+    double longitude    = coordinate.longitude();
+    double elevation;
+
+    elevations(&latitude, &longitude, 1, &elevation);
+
+    return elevation;
+}
+
+QImage TerrainTile::hillshade(void) const
+{
+    if (!_isValid) {
+        return QImage();
+    }
+
+    // Sun from the north west at 45 degrees elevation
+    static const double sunAzimuth  = qDegreesToRadians(315.0);
+    static const double sunZenith   = qDegreesToRadians(45.0);
+    static const int    maxAlpha    = 160;
+
+    const double spacingLat = tileValueSpacingMeters;
+    const double spacingLon = tileValueSpacingMeters * qCos(qDegreesToRadians(_southWest.latitude()));
+
+    QImage image(_gridSizeLon, _gridSizeLat, QImage::Format_ARGB32_Premultiplied);
+    for (int latIndex = 0; latIndex < _gridSizeLat; latIndex++) {
+        // Data rows run south to north, image rows north to south
+        QRgb* imageRow = reinterpret_cast<QRgb*>(image.scanLine(_gridSizeLat - 1 - latIndex));
+        int north = qMin(latIndex + 1, _gridSizeLat - 1);
+        int south = qMax(latIndex - 1, 0);
+        for (int lonIndex = 0; lonIndex < _gridSizeLon; lonIndex++) {
+            int east = qMin(lonIndex + 1, _gridSizeLon - 1);
+            int west = qMax(lonIndex - 1, 0);
+
+            double dzdx = (_data[latIndex * _gridSizeLon + east] - _data[latIndex * _gridSizeLon + west]) / ((east - west) * spacingLon);
+            double dzdy = (_data[north * _gridSizeLon + lonIndex] - _data[south * _gridSizeLon + lonIndex]) / ((north - south) * spacingLat);
+            double slope    = qAtan(qSqrt((dzdx * dzdx) + (dzdy * dzdy)));
+            double aspect   = qAtan2(-dzdx, -dzdy);
+            double shade    = (qCos(sunZenith) * qCos(slope)) + (qSin(sunZenith) * qSin(slope) * qCos(sunAzimuth - aspect));
+            double flatShade = qCos(sunZenith);
+
+            int alpha = qBound(0, static_cast<int>((flatShade - shade) / flatShade * maxAlpha), maxAlpha);
+            imageRow[lonIndex] = qRgba(0, 0, 0, alpha);
+        }
+    }
+    return image;
+}
+
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, int count, double* elevations) const
+{
+    if (!_isValid || !_southWest.isValid() || !_northEast.isValid()) {
+        qCWarning(TerrainTileLog) << "elevations: Internal error - invalid tile";
+        std::fill(elevations, elevations + count, qQNaN());
+        return;
+    }
 
+    const double    swLat       = _southWest.latitude();
+    const double    swLon       = _southWest.longitude();
+    const int       gridSizeLon = _gridSizeLon;
+    const int16_t*  data        = _data.constData();
+
+    for (int i = 0; i < count; i++) {
         // The lat/lon values in _northEast and _southWest coordinates can have rounding errors such that the coordinate
         // request may be slightly outside the tile box specified by these values. So we clamp the incoming values to the
         // edges of the tile if needed.
-
-        double clampedLon = qMax(coordinate.longitude(), _southWest.longitude());
-        double clampedLat = qMax(coordinate.latitude(), _southWest.latitude());
+        double clampedLon = qMax(longitudes[i], swLon);
+        double clampedLat = qMax(latitudes[i], swLat);
 
         // Calc the index of the southernmost and westernmost index data value
-        int lonIndex = qFloor((clampedLon - _southWest.longitude()) / tileValueSpacingDegrees);
-        int latIndex = qFloor((clampedLat - _southWest.latitude()) / tileValueSpacingDegrees);
+        int lonIndex = static_cast<int>(std::floor((clampedLon - swLon) / tileValueSpacingDegrees));
+        int latIndex = static_cast<int>(std::floor((clampedLat - swLat) / tileValueSpacingDegrees));
 
         // Calc how far along in between the known values the requested lat/lon is fractionally
-        double lonIndexLongitude    = _southWest.longitude() + (static_cast<double>(lonIndex) * tileValueSpacingDegrees);
-        double lonFraction          = (clampedLon - lonIndexLongitude) / tileValueSpacingDegrees;
-        double latIndexLatitude     = _southWest.latitude() + (static_cast<double>(latIndex) * tileValueSpacingDegrees);
-        double latFraction          = (clampedLat - latIndexLatitude) / tileValueSpacingDegrees;
-
-        // Calc the elevation as the average across the four known points
-        double known00      = _data[latIndex][lonIndex];
-        double known01      = _data[latIndex][lonIndex+1];
-        double known10      = _data[latIndex+1][lonIndex];
-        double known11      = _data[latIndex+1][lonIndex+1];
-        double lonValue1    = known00 + ((known01 - known00) * lonFraction);
-        double lonValue2    = known10 + ((known11 - known10) * lonFraction);
-        double latValue     = lonValue1 + ((lonValue2 - lonValue1) * latFraction);
-
-        return latValue;
+        double lonFraction = (clampedLon - (swLon + (static_cast<double>(lonIndex) * tileValueSpacingDegrees))) / tileValueSpacingDegrees;
+        double latFraction = (clampedLat - (swLat + (static_cast<double>(latIndex) * tileValueSpacingDegrees))) / tileValueSpacingDegrees;
+
+        // Bilinear interpolation across the four known points
+        const int16_t* row0 = &data[latIndex * gridSizeLon + lonIndex];
+        const int16_t* row1 = row0 + gridSizeLon;
+        double lonValue1    = row0[0] + ((row0[1] - row0[0]) * lonFraction);
+        double lonValue2    = row1[0] + ((row1[1] - row1[0]) * lonFraction);
+        elevations[i]       = lonValue1 + ((lonValue2 - lonValue1) * latFraction);
+    }
+}
+
+void TerrainTile::_cellMinMax(int latIndex, int lonIndex, int16_t& min, int16_t& max) const
+{
+    const int16_t* row0 = &_data.constData()[latIndex * _gridSizeLon + lonIndex];
+    const int16_t* row1 = row0 + _gridSizeLon;
+    min = qMin(qMin(row0[0], row0[1]), qMin(row1[0], row1[1]));
+    max = qMax(qMax(row0[0], row0[1]), qMax(row1[0], row1[1]));
+}
+
+void TerrainTile::_buildPyramid(void)
+{
+    int cellRows = _gridSizeLat - 1;
+    int cellCols = _gridSizeLon - 1;
+
+    _pyramidLevels.clear();
+    _pyramidMin.clear();
+    _pyramidMax.clear();
+
+    int childRows = cellRows;
+    int childCols = cellCols;
+    while (childRows > 1 || childCols > 1) {
+        PyramidLevel_t level;
+        level.rows      = (childRows + 1) / 2;
+        level.cols      = (childCols + 1) / 2;
+        level.offset    = _pyramidMin.count();
+
+        int childOffset = _pyramidLevels.isEmpty() ? 0 : _pyramidLevels.last().offset;
+        _pyramidMin.resize(level.offset + (level.rows * level.cols));
+        _pyramidMax.resize(level.offset + (level.rows * level.cols));
+
+        for (int row = 0; row < level.rows; row++) {
+            for (int col = 0; col < level.cols; col++) {
+                int16_t blockMin = std::numeric_limits<int16_t>::max();
+                int16_t blockMax = std::numeric_limits<int16_t>::min();
+                for (int childRow = row * 2; childRow < qMin(row * 2 + 2, childRows); childRow++) {
+                    for (int childCol = col * 2; childCol < qMin(col * 2 + 2, childCols); childCol++) {
+                        int16_t childMin, childMax;
+                        if (_pyramidLevels.isEmpty()) {
+                            _cellMinMax(childRow, childCol, childMin, childMax);
+                        } else {
+                            childMin = _pyramidMin[childOffset + (childRow * childCols) + childCol];
+                            childMax = _pyramidMax[childOffset + (childRow * childCols) + childCol];
+                        }
+                        blockMin = qMin(blockMin, childMin);
+                        blockMax = qMax(blockMax, childMax);
+                    }
+                }
+                _pyramidMin[level.offset + (row * level.cols) + col] = blockMin;
+                _pyramidMax[level.offset + (row * level.cols) + col] = blockMax;
+            }
+        }
+
+        _pyramidLevels.append(level);
+        childRows = level.rows;
+        childCols = level.cols;
+    }
+}
+
+bool TerrainTile::pathCollision(double lat1, double lon1, double alt1, double lat2, double lon2, double alt2) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << "pathCollision: Internal error - invalid tile";
+        return false;
+    }
+
+    // Work in grid index units, clamped to the tile the same way elevations() does
+    const double maxLatIndex = _gridSizeLat - 1;
+    const double maxLonIndex = _gridSizeLon - 1;
+    double latIndex1 = qBound(0.0, (lat1 - _southWest.latitude()) / tileValueSpacingDegrees, maxLatIndex);
+    double lonIndex1 = qBound(0.0, (lon1 - _southWest.longitude()) / tileValueSpacingDegrees, maxLonIndex);
+    double latIndex2 = qBound(0.0, (lat2 - _southWest.latitude()) / tileValueSpacingDegrees, maxLatIndex);
+    double lonIndex2 = qBound(0.0, (lon2 - _southWest.longitude()) / tileValueSpacingDegrees, maxLonIndex);
+
+    GridPath_t path;
+    path.lat    = latIndex1;
+    path.lon    = lonIndex1;
+    path.alt    = alt1;
+    path.dLat   = latIndex2 - latIndex1;
+    path.dLon   = lonIndex2 - lonIndex1;
+    path.dAlt   = alt2 - alt1;
+
+    return _blockCollision(_pyramidLevels.count(), 0, 0, path, 0.0, 1.0);
+}
+
+/// Clips the path span t0-t1 to the block and then decides from the block min/max whether the span is clear, collides,
+/// or needs to be checked against the smaller blocks within it.
+bool TerrainTile::_blockCollision(int level, int latBlock, int lonBlock, const GridPath_t& path, double t0, double t1) const
+{
+    int blockCells  = 1 << level;
+    int latIndex0   = latBlock * blockCells;
+    int lonIndex0   = lonBlock * blockCells;
+    int latIndex1   = qMin(latIndex0 + blockCells, _gridSizeLat - 1);
+    int lonIndex1   = qMin(lonIndex0 + blockCells, _gridSizeLon - 1);
+
+    // Clip the span to the block
+    const double bounds[2][2] = { { static_cast<double>(latIndex0), static_cast<double>(latIndex1) }, { static_cast<double>(lonIndex0), static_cast<double>(lonIndex1) } };
+    const double start[2]   = { path.lat, path.lon };
+    const double delta[2]   = { path.dLat, path.dLon };
+    for (int axis = 0; axis < 2; axis++) {
+        if (qFuzzyIsNull(delta[axis])) {
+            if (start[axis] < bounds[axis][0] || start[axis] > bounds[axis][1]) {
+                return false;
+            }
+        } else {
+            double tA = (bounds[axis][0] - start[axis]) / delta[axis];
+            double tB = (bounds[axis][1] - start[axis]) / delta[axis];
+            t0 = qMax(t0, qMin(tA, tB));
+            t1 = qMin(t1, qMax(tA, tB));
+        }
+    }
+    if (t0 > t1) {
+        return false;
+    }
+
+    int16_t blockMin, blockMax;
+    if (level == 0) {
+        _cellMinMax(latIndex0, lonIndex0, blockMin, blockMax);
     } else {
-        qCWarning(TerrainTileLog) << "elevation: Internal error - invalid tile";
-        return qQNaN();
+        const PyramidLevel_t& pyramidLevel = _pyramidLevels[level - 1];
+        int index = pyramidLevel.offset + (latBlock * pyramidLevel.cols) + lonBlock;
+        blockMin = _pyramidMin[index];
+        blockMax = _pyramidMax[index];
+    }
+
+    double alt0 = path.alt + (path.dAlt * t0);
+    double alt1 = path.alt + (path.dAlt * t1);
+    if (qMin(alt0, alt1) >= blockMax) {
+        // The path is above all terrain in the block
+        return false;
+    }
+    if (qMax(alt0, alt1) < blockMin) {
+        // The path is below all terrain in the block
+        return true;
+    }
+
+    if (level == 0) {
+        return _cellCollision(latIndex0, lonIndex0, path, t0, t1);
+    }
+
+    int childCells = blockCells / 2;
+    for (int childLat = latBlock * 2; childLat < latBlock * 2 + 2; childLat++) {
+        for (int childLon = lonBlock * 2; childLon < lonBlock * 2 + 2; childLon++) {
+            if (childLat * childCells < _gridSizeLat - 1 && childLon * childCells < _gridSizeLon - 1 && _blockCollision(level - 1, childLat, childLon, path, t0, t1)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/// Exact check within a single cell. Along a straight line the bilinear terrain is a quadratic in t, so the largest
+/// terrain height above the path is found at the span ends or at the vertex of the quadratic.
+bool TerrainTile::_cellCollision(int latIndex, int lonIndex, const GridPath_t& path, double t0, double t1) const
+{
+    const int16_t*  row0    = &_data.constData()[latIndex * _gridSizeLon + lonIndex];
+    const int16_t*  row1    = row0 + _gridSizeLon;
+    const double    z00     = row0[0];
+    const double    dzLon   = row0[1] - z00;
+    const double    dzLat   = row1[0] - z00;
+    const double    dzTwist = row1[1] - row0[1] - row1[0] + z00;
+
+    // Fractions within the cell: latFraction = aLat + (bLat * t), lonFraction = aLon + (bLon * t)
+    const double aLat = path.lat - latIndex;
+    const double aLon = path.lon - lonIndex;
+    const double bLat = path.dLat;
+    const double bLon = path.dLon;
+
+    // terrain - path altitude = (a * t^2) + (b * t) + c
+    const double a = dzTwist * bLat * bLon;
+    const double b = (dzLon * bLon) + (dzLat * bLat) + (dzTwist * ((aLat * bLon) + (aLon * bLat))) - path.dAlt;
+    const double c = z00 + (dzLon * aLon) + (dzLat * aLat) + (dzTwist * aLat * aLon) - path.alt;
+
+    auto heightAbovePath = [a, b, c](double t) { return (((a * t) + b) * t) + c; };
+
+    if (heightAbovePath(t0) > 0 || heightAbovePath(t1) > 0) {
+        return true;
+    }
+    if (a < 0) {
+        double tVertex = -b / (2 * a);
+        if (tVertex > t0 && tVertex < t1 && heightAbovePath(tVertex) > 0) {
+            return true;
+        }
     }
+
+    return false;
 }
 
 QGeoCoordinate TerrainTile::centerCoordinate(void) const
@@ -154,94 +383,125 @@ QGeoCoordinate TerrainTile::centerCoordinate(void) const
 
 QByteArray TerrainTile::serializeFromAirMapJson(QByteArray input)
 {
-    QJsonParseError parseError;
-    QJsonDocument document = QJsonDocument::fromJson(input, &parseError);
-    if (parseError.error != QJsonParseError::NoError) {
+    // The response is read in a single forward pass with the carpet values written straight into the serialized tile,
+    // keys are accepted in any order so the header is only filled in at the end.
+    int         cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    QByteArray  byteArray;
+    byteArray.reserve(cTileHeaderBytes + (static_cast<int>(sizeof(int16_t)) * _expectedGridSize * _expectedGridSize));
+    byteArray.resize(cTileHeaderBytes);
+
+    TileInfo_t  tileInfo;
+    double      sw[2];
+    double      ne[2];
+    double      stats[3];                   // min, max, avg
+    bool        statusSuccess = false;
+    bool        haveBounds[2] = { false, false };
+    bool        haveStats[3] = { false, false, false };
+    int         gridSizeLat = 0;
+    int         gridSizeLon = -1;
+
+    TerrainJsonReader reader(input);
+    QByteArray key;
+    if (!reader.beginObject()) {
         QByteArray emptyArray;
         return emptyArray;
     }
-
-    if (!document.isObject()) {
-        qCDebug(TerrainTileLog) << "Terrain tile json doc is no object";
-        QByteArray emptyArray;
-        return emptyArray;
+    while (reader.nextKey(key)) {
+        if (key == _jsonStatusKey) {
+            QByteArray status;
+            if (!reader.readString(status)) {
+                break;
+            }
+            statusSuccess = status == "success";
+        } else if (key == _jsonDataKey) {
+            if (!reader.beginObject()) {
+                break;
+            }
+            while (reader.nextKey(key)) {
+                if (key == _jsonBoundsKey) {
+                    if (!reader.beginObject()) {
+                        break;
+                    }
+                    while (reader.nextKey(key)) {
+                        int cornerIndex = key == _jsonSouthWestKey ? 0 : (key == _jsonNorthEastKey ? 1 : -1);
+                        if (cornerIndex == -1) {
+                            reader.skipValue();
+                        } else {
+                            haveBounds[cornerIndex] = reader.readNumberArray(cornerIndex == 0 ? sw : ne, 2) >= 2;
+                        }
+                    }
+                } else if (key == _jsonStatsKey) {
+                    if (!reader.beginObject()) {
+                        break;
+                    }
+                    while (reader.nextKey(key)) {
+                        int statIndex = key == _jsonMinElevationKey ? 0 : (key == _jsonMaxElevationKey ? 1 : (key == _jsonAvgElevationKey ? 2 : -1));
+                        if (statIndex == -1) {
+                            reader.skipValue();
+                        } else {
+                            haveStats[statIndex] = reader.readNumber(stats[statIndex]);
+                        }
+                    }
+                } else if (key == _jsonCarpetKey) {
+                    if (!reader.beginArray()) {
+                        break;
+                    }
+                    while (reader.nextElement()) {
+                        // The first row sets the row length, longer rows are cut to it
+                        int maxValues = gridSizeLon == -1 ? _maxGridSize : gridSizeLon;
+                        int rowStart = byteArray.size();
+                        byteArray.resize(rowStart + (static_cast<int>(sizeof(int16_t)) * maxValues));
+                        int rowCount = reader.readNumberArray(reinterpret_cast<int16_t*>(byteArray.data() + rowStart), maxValues);
+                        if (rowCount < 0) {
+                            break;
+                        }
+                        if (gridSizeLon == -1) {
+                            gridSizeLon = qMin(rowCount, maxValues);
+                        } else if (rowCount < gridSizeLon) {
+                            qCDebug(TerrainTileLog) << "Expected row array of " << gridSizeLon << ", instead got " << rowCount;
+                            QByteArray emptyArray;
+                            return emptyArray;
+                        }
+                        byteArray.resize(rowStart + (static_cast<int>(sizeof(int16_t)) * gridSizeLon));
+                        gridSizeLat++;
+                    }
+                } else {
+                    reader.skipValue();
+                }
+            }
+        } else {
+            reader.skipValue();
+        }
     }
-    QJsonObject rootObject = document.object();
-
-    QString errorString;
-    QList<JsonHelper::KeyValidateInfo> rootVersionKeyInfoList = {
-        { _jsonStatusKey, QJsonValue::String, true },
-        { _jsonDataKey,   QJsonValue::Object, true },
-    };
-    if (!JsonHelper::validateKeys(rootObject, rootVersionKeyInfoList, errorString)) {
-        qCDebug(TerrainTileLog) << "Error in reading json: " << errorString;
+    if (reader.error()) {
+        qCDebug(TerrainTileLog) << "Error in reading json";
         QByteArray emptyArray;
         return emptyArray;
     }
 
-    if (rootObject[_jsonStatusKey].toString() != "success") {
+    if (!statusSuccess) {
         qCDebug(TerrainTileLog) << "Invalid terrain tile.";
         QByteArray emptyArray;
         return emptyArray;
     }
-    const QJsonObject& dataObject = rootObject[_jsonDataKey].toObject();
-    QList<JsonHelper::KeyValidateInfo> dataVersionKeyInfoList = {
-        { _jsonBoundsKey, QJsonValue::Object, true },
-        { _jsonStatsKey,  QJsonValue::Object, true },
-        { _jsonCarpetKey, QJsonValue::Array, true },
-    };
-    if (!JsonHelper::validateKeys(dataObject, dataVersionKeyInfoList, errorString)) {
-        qCDebug(TerrainTileLog) << "Error in reading json: " << errorString;
-        QByteArray emptyArray;
-        return emptyArray;
-    }
-
-    // Bounds
-    const QJsonObject& boundsObject = dataObject[_jsonBoundsKey].toObject();
-    QList<JsonHelper::KeyValidateInfo> boundsVersionKeyInfoList = {
-        { _jsonSouthWestKey, QJsonValue::Array, true },
-        { _jsonNorthEastKey, QJsonValue::Array, true },
-    };
-    if (!JsonHelper::validateKeys(boundsObject, boundsVersionKeyInfoList, errorString)) {
-        qCDebug(TerrainTileLog) << "Error in reading json: " << errorString;
-        QByteArray emptyArray;
-        return emptyArray;
-    }
-    const QJsonArray& swArray = boundsObject[_jsonSouthWestKey].toArray();
-    const QJsonArray& neArray = boundsObject[_jsonNorthEastKey].toArray();
-    if (swArray.count() < 2 || neArray.count() < 2 ) {
+    if (!haveBounds[0] || !haveBounds[1]) {
         qCDebug(TerrainTileLog) << "Incomplete bounding location";
         QByteArray emptyArray;
         return emptyArray;
     }
-
-    // Stats
-    const QJsonObject& statsObject = dataObject[_jsonStatsKey].toObject();
-    QList<JsonHelper::KeyValidateInfo> statsVersionKeyInfoList = {
-        { _jsonMinElevationKey, QJsonValue::Double, true },
-        { _jsonMaxElevationKey, QJsonValue::Double, true },
-        { _jsonAvgElevationKey, QJsonValue::Double, true },
-    };
-    if (!JsonHelper::validateKeys(statsObject, statsVersionKeyInfoList, errorString)) {
-        qCDebug(TerrainTileLog) << "Error in reading json: " << errorString;
+    if (!haveStats[0] || !haveStats[1] || !haveStats[2] || gridSizeLon == -1) {
+        qCDebug(TerrainTileLog) << "Error in reading json: stats or carpet missing";
         QByteArray emptyArray;
         return emptyArray;
     }
 
-    // Carpet
-    const QJsonArray& carpetArray = dataObject[_jsonCarpetKey].toArray();
-    int gridSizeLat = carpetArray.count();
-    int gridSizeLon = carpetArray[0].toArray().count();
-
-    TileInfo_t tileInfo;
-
-    tileInfo.swLat = swArray[0].toDouble();
-    tileInfo.swLon = swArray[1].toDouble();
-    tileInfo.neLat = neArray[0].toDouble();
-    tileInfo.neLon = neArray[1].toDouble();
-    tileInfo.minElevation = static_cast<int16_t>(statsObject[_jsonMinElevationKey].toInt());
-    tileInfo.maxElevation = static_cast<int16_t>(statsObject[_jsonMaxElevationKey].toInt());
-    tileInfo.avgElevation = statsObject[_jsonAvgElevationKey].toDouble();
+    tileInfo.swLat = sw[0];
+    tileInfo.swLon = sw[1];
+    tileInfo.neLat = ne[0];
+    tileInfo.neLon = ne[1];
+    tileInfo.minElevation = static_cast<int16_t>(stats[0]);
+    tileInfo.maxElevation = static_cast<int16_t>(stats[1]);
+    tileInfo.avgElevation = stats[2];
     tileInfo.gridSizeLat = static_cast<int16_t>(gridSizeLat);
     tileInfo.gridSizeLon = static_cast<int16_t>(gridSizeLon);
 
@@ -255,28 +515,26 @@ QByteArray TerrainTile::serializeFromAirMapJson(QByteArray input)
         return emptyArray;
     }
 
-    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * gridSizeLat * gridSizeLon;
-
-    QByteArray byteArray(cTileHeaderBytes + cTileDataBytes, 0);
+    *reinterpret_cast<TileInfo_t*>(byteArray.data()) = tileInfo;
 
-    TileInfo_t* pTileInfo = reinterpret_cast<TileInfo_t*>(byteArray.data());
-    int16_t*    pTileData = reinterpret_cast<int16_t*>(&reinterpret_cast<uint8_t*>(byteArray.data())[cTileHeaderBytes]);
+    return byteArray;
+}
 
-    *pTileInfo = tileInfo;
+bool TerrainTile::isSerializedTile(const QByteArray& input)
+{
+    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    if (input.size() < cTileHeaderBytes) {
+        return false;
+    }
 
-    int valueIndex = 0;
-    for (int i = 0; i < gridSizeLat; i++) {
-        const QJsonArray& row = carpetArray[i].toArray();
-        if (row.count() < gridSizeLon) {
-            qCDebug(TerrainTileLog) << "Expected row array of " << gridSizeLon << ", instead got " << row.count();
-            QByteArray emptyArray;
-            return emptyArray;
-        }
-        for (int j = 0; j < gridSizeLon; j++) {
-            pTileData[valueIndex++] = static_cast<int16_t>(row[j].toDouble());
-        }
+    TileInfo_t tileInfo;
+    memcpy(&tileInfo, input.constData(), sizeof(TileInfo_t));
+    if (tileInfo.gridSizeLat < 2 || tileInfo.gridSizeLon < 2) {
+        return false;
     }
+    int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * tileInfo.gridSizeLat * tileInfo.gridSizeLon;
 
-    return byteArray;
+    return input.size() == cTileHeaderBytes + cTileDataBytes
+            && qAbs(tileInfo.swLat) <= 90.0 && qAbs(tileInfo.neLat) <= 90.0
+            && qAbs(tileInfo.swLon) <= 180.0 && qAbs(tileInfo.neLon) <= 180.0;
 }
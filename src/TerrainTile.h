@@ -4,6 +4,8 @@
 #include "QGCLoggingCategory.h"
 
 #include <QGeoCoordinate>
+#include <QVector>
+#include <QImage>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
 
@@ -17,7 +19,6 @@ class TerrainTile
 {
 public:
     TerrainTile();
-    ~TerrainTile();
 
     /**
     * Constructor from serialized elevation data (either from file or web)
@@ -33,6 +34,11 @@ public:
     */
     bool isValid(void) const { return _isValid; }
 
+    /**
+    * @return Approximate memory held by the tile, including the elevation data and pyramid
+    */
+    qint64 memoryBytes(void) const;
+
     /**
     * Evaluates the elevation at the given coordinate
     *
@@ -41,6 +47,29 @@ public:
     */
     double elevation(const QGeoCoordinate& coordinate) const;
 
+    /**
+    * Evaluates the elevation at a batch of coordinates within the tile. The coordinates are passed as separate lat/lon
+    * arrays so the interpolation runs as one tight loop over the contiguous tile data.
+    *
+    * @param latitudes
+    * @param longitudes
+    * @param count number of coordinates
+    * @param[out] elevations count elevations, NaN if the tile is invalid
+    */
+    void elevations(const double* latitudes, const double* longitudes, int count, double* elevations) const;
+
+    /**
+    * Checks whether the straight path between two points collides with the terrain of the tile. The path altitude changes
+    * linearly between the points and terrain is the same bilinear interpolation used by elevations(). Whole spans of the
+    * path are confirmed clear or colliding from the min/max pyramid of the tile, only the cells where the path comes close
+    * to the terrain are evaluated exactly.
+    *
+    * @param lat1 lon1 alt1 start of the path, must be within the tile
+    * @param lat2 lon2 alt2 end of the path, must be within the tile
+    * @return true if the terrain is above the path anywhere along it
+    */
+    bool pathCollision(double lat1, double lon1, double alt1, double lat2, double lon2, double alt2) const;
+
     /**
     * Accessor for the minimum elevation of the tile
     *
@@ -69,8 +98,33 @@ public:
     */
     QGeoCoordinate centerCoordinate(void) const;
 
+    QGeoCoordinate southWest(void) const { return _southWest; }
+    QGeoCoordinate northEast(void) const { return _northEast; }
+
+    /**
+    * Shaded relief of the tile, one pixel per elevation value with north at the top. Slopes facing away from a north
+    * west sun are darkened through the alpha channel, flat terrain is transparent.
+    *
+    * @return hillshade image, null if the tile is invalid
+    */
+    QImage hillshade(void) const;
+
+    /**
+    * Converts an AirMap carpet response to the binary tile layout used by the tile cache and the constructor
+    *
+    * @param input json response
+    * @return serialized tile, empty on error
+    */
     static QByteArray serializeFromAirMapJson(QByteArray input);
 
+    /**
+    * Checks whether the data is already in the binary tile layout, e.g. delivered that way by the elevation backend
+    *
+    * @param input response or cached data
+    * @return true if the header and the grid size match the data
+    */
+    static bool isSerializedTile(const QByteArray& input);
+
     static constexpr double tileSizeDegrees         = 0.01;         ///< Each terrain tile represents a square area .01 degrees in lat/lon
     static constexpr double tileValueSpacingDegrees = 1.0 / 3600;   ///< 1 Arc-Second spacing of elevation values
     static constexpr double tileValueSpacingMeters  = 30.0;
@@ -85,6 +139,22 @@ private:
         int16_t gridSizeLon;
     } TileInfo_t;
 
+    typedef struct {
+        int     rows;
+        int     cols;
+        int     offset;                                                 ///< Index of the first block of the level in _pyramidMin/Max
+    } PyramidLevel_t;
+
+    typedef struct {
+        double  lat, lon, alt;                                          ///< Start of the path, lat/lon as grid index
+        double  dLat, dLon, dAlt;                                       ///< Change over the path
+    } GridPath_t;
+
+    void    _buildPyramid       (void);
+    void    _cellMinMax         (int latIndex, int lonIndex, int16_t& min, int16_t& max) const;
+    bool    _blockCollision     (int level, int latBlock, int lonBlock, const GridPath_t& path, double t0, double t1) const;
+    bool    _cellCollision      (int latIndex, int lonIndex, const GridPath_t& path, double t0, double t1) const;
+
     QGeoCoordinate      _southWest;                                     /// South west corner of the tile
     QGeoCoordinate      _northEast;                                     /// North east corner of the tile
 
@@ -92,11 +162,17 @@ private:
     int16_t             _maxElevation;                                  /// Maximum elevation in tile
     double              _avgElevation;                                  /// Average elevation of the tile
 
-    int16_t**           _data;                                          /// 2D elevation data array
+    QVector<int16_t>    _data;                                          /// Elevation data, row major by latitude index
     int16_t             _gridSizeLat;                                   /// data grid size in latitude direction
     int16_t             _gridSizeLon;                                   /// data grid size in longitude direction
     bool                _isValid;                                       /// data loaded is valid
 
+    // Min/max pyramid over the grid cells. Level 1 blocks cover 2x2 cells, each level above halves the block count until a
+    // single block covers the tile. Level 0 are the cells themselves, which are not stored.
+    QVector<PyramidLevel_t> _pyramidLevels;                             /// Levels 1 and up
+    QVector<int16_t>    _pyramidMin;
+    QVector<int16_t>    _pyramidMax;
+
     // Json keys
     static const char*  _jsonStatusKey;
     static const char*  _jsonDataKey;
@@ -108,6 +184,9 @@ private:
     static const char*  _jsonMinElevationKey;
     static const char*  _jsonAvgElevationKey;
     static const char*  _jsonCarpetKey;
+
+    static const int    _expectedGridSize   = 37;                       ///< Values per row and column of a .01 degree tile at 1 arc second spacing
+    static const int    _maxGridSize        = 1024;                     ///< Longer rows are cut, they can't have the required spacing anyway
 };
 
 #endif // TERRAINTILE_H
@@ -29,6 +29,13 @@ Actuators::Actuators(QObject* parent, Vehicle* vehicle)
     connect(&_motorAssignment, &MotorAssignment::activeChanged, this, &Actuators::motorAssignmentActiveChanged);
     connect(&_motorAssignment, &MotorAssignment::messageChanged, this, &Actuators::motorAssignmentMessageChanged);
     connect(&_motorAssignment, &MotorAssignment::onAbort, this, [this]() { highlightActuators(false); });
+
+    _imageRefreshTimer.setSingleShot(true);
+    _imageRefreshTimer.setInterval(16);
+    connect(&_imageRefreshTimer, &QTimer::timeout, this, [this]() {
+        _imageRefreshFlag = !_imageRefreshFlag;
+        emit imageRefreshFlagChanged();
+    });
 }
 
 void Actuators::imageClicked(float x, float y)
@@ -38,7 +45,7 @@ void Actuators::imageClicked(float x, float y)
     qCDebug(ActuatorsConfigLog) << "Image clicked:" << x << "," << y << "motor index:" << motorIndex;
 
     if (_motorAssignment.active()) {
-        QList<ActuatorGeometry>& actuators = provider->actuators();
+        QList<ActuatorGeometry> actuators = provider->actuators();
         bool found = false;
         for (auto& actuator : actuators) {
             if (actuator.type == ActuatorGeometry::Type::Motor && actuator.index == motorIndex) {
@@ -46,6 +53,9 @@ void Actuators::imageClicked(float x, float y)
                 found = true;
             }
         }
+        if (provider->setActuators(actuators)) {
+            requestImageRefresh();
+        }
         updateGeometryImage();
 
         if (found) {
@@ -75,11 +85,10 @@ void Actuators::updateGeometryImage()
 {
     GeometryImage::VehicleGeometryImageProvider* provider = GeometryImage::VehicleGeometryImageProvider::instance();
 
-    QList<ActuatorGeometry>& actuators = provider->actuators();
-    QList<ActuatorGeometry> previousActuators = actuators;
+    const QList<ActuatorGeometry> previousActuators = provider->actuators();
+    QList<ActuatorGeometry> actuators;
 
     // collect the actuators
-    actuators.clear();
     for (int mixerGroupIdx = 0; mixerGroupIdx < _mixer.groups()->count(); ++mixerGroupIdx) {
         Mixer::MixerConfigGroup* mixerGroup = _mixer.groups()->value<Mixer::MixerConfigGroup*>(mixerGroupIdx);
         for (int mixerChannelIdx = 0; mixerChannelIdx < mixerGroup->channels()->count(); ++mixerChannelIdx) {
@@ -101,11 +110,24 @@ void Actuators::updateGeometryImage()
         }
     }
 
-    _imageRefreshFlag = !_imageRefreshFlag;
-    emit imageRefreshFlagChanged();
+    // Most parameter changes do not affect the geometry, only reload the image if it actually changed
+    if (provider->setActuators(actuators)) {
+        requestImageRefresh();
+    }
 
-    _motorAssignmentEnabled = provider->numMotors() > 0;
-    emit motorAssignmentEnabledChanged();
+    bool motorAssignmentEnabled = provider->numMotors() > 0;
+    if (motorAssignmentEnabled != _motorAssignmentEnabled) {
+        _motorAssignmentEnabled = motorAssignmentEnabled;
+        emit motorAssignmentEnabledChanged();
+    }
+}
+
+void Actuators::requestImageRefresh()
+{
+    // don't restart the timer, continuous changes would otherwise never refresh
+    if (!_imageRefreshTimer.isActive()) {
+        _imageRefreshTimer.start();
+    }
 }
 
 bool Actuators::isMultirotor() const
@@ -776,12 +798,15 @@ bool Actuators::initMotorAssignment()
 void Actuators::highlightActuators(bool highlight)
 {
     GeometryImage::VehicleGeometryImageProvider* provider = GeometryImage::VehicleGeometryImageProvider::instance();
-    QList<ActuatorGeometry>& actuators = provider->actuators();
+    QList<ActuatorGeometry> actuators = provider->actuators();
     for (auto& actuator : actuators) {
         if (actuator.type == ActuatorGeometry::Type::Motor) {
             actuator.renderOptions.highlight = highlight;
         }
     }
+    if (provider->setActuators(actuators)) {
+        requestImageRefresh();
+    }
     updateGeometryImage();
 }
 
@@ -12,6 +12,7 @@
 #include <QObject>
 #include <QString>
 #include <QJsonDocument>
+#include <QTimer>
 
 #include "ActuatorOutputs.h"
 #include "ActuatorTesting.h"
@@ -106,6 +107,8 @@ private:
 
     void highlightActuators(bool highlight);
 
+    void requestImageRefresh();
+
     void updateFunctionMetadata();
 
     QSet<Fact*> _subscribedFacts{};
@@ -120,6 +123,7 @@ private:
     bool _motorAssignmentEnabled{false};
     bool _hasUnsetRequiredFunctions{false};
     bool _imageRefreshFlag{false}; ///< indicator to QML to reload the image
+    QTimer _imageRefreshTimer; ///< coalesces geometry changes to at most one image reload per display frame
     int _selectedActuatorOutput{0};
     Vehicle* _vehicle{nullptr};
     QMap<int, QString> _usedMixerLabels;
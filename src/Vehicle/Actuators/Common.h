@@ -141,6 +141,8 @@ struct ActuatorGeometry
 
     struct RenderOptions {
         bool highlight{false};
+
+        bool operator==(const RenderOptions& other) const { return highlight == other.highlight; }
     };
 
     ActuatorGeometry(Type type_=Type::Other, int index_=0, QVector3D position_={},
@@ -154,5 +156,18 @@ struct ActuatorGeometry
     SpinDirection spinDirection;
 
     RenderOptions renderOptions{};
+
+    /**
+     * @return true if the airframe drawing (arms and body) is the same, i.e. only the motors themselves need to be redrawn
+     */
+    bool sameFrame(const ActuatorGeometry& other) const {
+        return type == other.type && position == other.position;
+    }
+
+    bool operator==(const ActuatorGeometry& other) const {
+        return sameFrame(other) && index == other.index && labelIndexOffset == other.labelIndexOffset &&
+                spinDirection == other.spinDirection && renderOptions == other.renderOptions;
+    }
+    bool operator!=(const ActuatorGeometry& other) const { return !(*this == other); }
 };
 
@@ -88,15 +88,15 @@ static void generateTestGeometries(VehicleGeometryImageProvider& provider)
     for (unsigned sizeIdx = 0; sizeIdx < sizeof(sizes) / sizeof(sizes[0]); ++sizeIdx) {
         const QSize& size = sizes[sizeIdx];
         for (unsigned geometryIdx = 0; geometryIdx < sizeof(geometries) / sizeof(geometries[0]); ++geometryIdx) {
-            provider.actuators() = geometries[geometryIdx];
-            QPixmap pixmap = provider.requestPixmap("", nullptr, size);
+            provider.setActuators(geometries[geometryIdx]);
+            QImage image = provider.requestImage("", nullptr, size);
 
             QString imageFileName = QDir(QDir::currentPath()).filePath(imagePrefix + QString::number(sizeIdx)+"_"
                     +QString::number(geometryIdx)+".png");
             qWarning() << "Generating image" << imageFileName;
             QFile file(imageFileName);
             file.open(QIODevice::WriteOnly);
-            pixmap.save(&file, "PNG");
+            image.save(&file, "PNG");
         }
     }
 
@@ -104,7 +104,7 @@ static void generateTestGeometries(VehicleGeometryImageProvider& provider)
 }
 
 VehicleGeometryImageProvider::VehicleGeometryImageProvider()
-: QQuickImageProvider(QQuickImageProvider::Pixmap)
+: QQuickImageProvider(QQuickImageProvider::Image)
 {
     generateTestGeometries(*this);
 }
@@ -163,18 +163,54 @@ void VehicleGeometryImageProvider::drawAxisIndicator(QPainter& p, const QPointF&
     }
 }
 
-QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* size, const QSize& requestedSize)
+QImage VehicleGeometryImageProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
 {
+    QMutexLocker lock(&_mutex);
+
     int width = requestedSize.width();
     int height = requestedSize.height();
     if (size)
         *size = QSize(width, height);
 
-    QPixmap pixmap(width, height);
-    pixmap.fill(Qt::transparent);
+    if (_imageRevision == _revision && _image.size() == requestedSize) {
+        return _image;
+    }
 
     _actuatorImagePositions.clear();
 
+    Layout imageLayout;
+    if (!layout(requestedSize, imageLayout)) {
+        _image = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+        _image.fill(Qt::transparent);
+        _imageRevision = _revision;
+        return _image;
+    }
+
+    if (_frameLayerRevision != _frameRevision || _frameLayer.size() != requestedSize) {
+        _frameLayer = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+        _frameLayer.fill(Qt::transparent);
+        QPainter p(&_frameLayer);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.setRenderHint(QPainter::TextAntialiasing);
+        drawFrame(p, requestedSize, imageLayout);
+        _frameLayerRevision = _frameRevision;
+    }
+
+    _image = _frameLayer.copy();
+    QPainter p(&_image);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setRenderHint(QPainter::TextAntialiasing);
+    drawMotors(p, imageLayout);
+    _imageRevision = _revision;
+
+    return _image;
+}
+
+bool VehicleGeometryImageProvider::layout(const QSize& size, Layout& layout) const
+{
+    const float width = size.width();
+    const float height = size.height();
+
     // get the dimensions
     QVector3D min{1e10f, 1e10f, 1e10f};
     QVector3D max{-1e10f, -1e10f, -1e10f};
@@ -190,12 +226,12 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
     }
 
     if (_actuators.size() <= 1 || max.x() - min.x() < 0.0001f || max.y() - min.y() < 0.0001f ) {
-        return pixmap;
+        return false;
     }
 
     // separate actuators, check for coax (on top of each other)
-    QList<ActuatorGeometry> actuators;
-    QList<ActuatorGeometry> coaxActuators;
+    layout.actuators.clear();
+    layout.coaxActuators.clear();
     for (const auto& actuator : _actuators) {
         if (actuator.type == ActuatorGeometry::Type::Motor) {
             bool isCoax = false;
@@ -206,22 +242,18 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
                     }
                     QVector2D diff = actuatorBefore.position.toVector2D() - actuator.position.toVector2D();
                     if (diff.length() < 0.03f) {
-                        coaxActuators.append(actuator);
+                        layout.coaxActuators.append(actuator);
                         isCoax = true;
                         break;
                     }
                 }
             }
             if (!isCoax) {
-                actuators.append(actuator);
+                layout.actuators.append(actuator);
             }
         }
     }
 
-    QPainter p(&pixmap);
-    p.setRenderHint(QPainter::Antialiasing);
-    p.setRenderHint(QPainter::TextAntialiasing);
-
     const float axisIndicatorSize = 15.f; // font size
     const float margin = 5.f; // from image borders
 
@@ -236,41 +268,48 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
         extraOffsetX = axisIndicatorSize;
     }
 
-    const float rotorDiameter = std::min(usableWidth, usableHeight) * (_actuators.length() <= 6 ? 0.31f : 0.25f);
-    const float fontSize = rotorDiameter * 0.4f;
-    const float extraYMargin = coaxActuators.length() > 0 ? fontSize * 1.1f : 0.f;
-
-    const float scaleX = (usableWidth - rotorDiameter) / (max.y() - min.y());
-    const float scaleY = (usableHeight - extraYMargin - rotorDiameter) / (max.x() - min.x());
-    const float scale = std::min(scaleX, scaleY);
-    const float offsetX = margin + extraOffsetX + usableWidth / 2.f - (max.y() + min.y()) / 2.f * scale;
-    const float offsetY = margin + (usableHeight - extraYMargin) / 2.f + (max.x() + min.x()) / 2.f * scale;
-
-    // style
-    const QColor clockWiseColor{ 21, 158, 31, 200 };
-    const QColor counterClockWiseColor{ 78, 195, 232, 200 };
-    const QColor frameArrowColor{ 255, 68, 43, 200 };
-    const QColor frameColor{ 150, 150, 150 };
-    const float frameWidth{ 6.f };
-    const float rotorFontSize{ rotorDiameter * 0.4f };
-    const QColor rotorHighlightColor{ frameArrowColor };
-    const QColor fontColor{ _palette.text() };
-
-    auto iterateMotors = [scale, offsetX, offsetY](const QList<ActuatorGeometry> &actuators,
-            std::function<void(const ActuatorGeometry&, QPointF)> draw) {
-                for (const auto& actuator : actuators) {
-                    if (actuator.type == ActuatorGeometry::Type::Motor) {
-                        QPointF pos{
-                            offsetX + actuator.position.y()*scale,
-                            offsetY - actuator.position.x()*scale
-                        };
-                        draw(actuator, pos);
-                    }
-                }
+    layout.rotorDiameter = std::min(usableWidth, usableHeight) * (_actuators.length() <= 6 ? 0.31f : 0.25f);
+    const float fontSize = layout.rotorDiameter * 0.4f;
+    layout.extraYMargin = layout.coaxActuators.length() > 0 ? fontSize * 1.1f : 0.f;
+
+    const float scaleX = (usableWidth - layout.rotorDiameter) / (max.y() - min.y());
+    const float scaleY = (usableHeight - layout.extraYMargin - layout.rotorDiameter) / (max.x() - min.x());
+    layout.scale = std::min(scaleX, scaleY);
+    layout.offsetX = margin + extraOffsetX + usableWidth / 2.f - (max.y() + min.y()) / 2.f * layout.scale;
+    layout.offsetY = margin + (usableHeight - layout.extraYMargin) / 2.f + (max.x() + min.x()) / 2.f * layout.scale;
+    return true;
+}
+
+// style
+static const QColor clockWiseColor{ 21, 158, 31, 200 };
+static const QColor counterClockWiseColor{ 78, 195, 232, 200 };
+static const QColor frameArrowColor{ 255, 68, 43, 200 };
+static const QColor frameColor{ 150, 150, 150 };
+static const float frameWidth{ 6.f };
+
+static void iterateMotors(const QList<ActuatorGeometry> &actuators, float scale, float offsetX, float offsetY,
+        std::function<void(const ActuatorGeometry&, QPointF)> draw)
+{
+    for (const auto& actuator : actuators) {
+        if (actuator.type == ActuatorGeometry::Type::Motor) {
+            QPointF pos{
+                offsetX + actuator.position.y()*scale,
+                offsetY - actuator.position.x()*scale
             };
+            draw(actuator, pos);
+        }
+    }
+}
+
+void VehicleGeometryImageProvider::drawFrame(QPainter& p, const QSize& size, const Layout& layout)
+{
+    const float axisIndicatorSize = 15.f; // font size
+    const float offsetX = layout.offsetX;
+    const float offsetY = layout.offsetY;
+    const float rotorDiameter = layout.rotorDiameter;
 
     // draw line from center to actuators first
-    iterateMotors(actuators, [&](const ActuatorGeometry& actuator, QPointF pos) {
+    iterateMotors(layout.actuators, layout.scale, offsetX, offsetY, [&](const ActuatorGeometry& actuator, QPointF pos) {
         p.setPen(QPen{frameColor, frameWidth});
         p.drawLine(QPointF{offsetX, offsetY}, pos);
     });
@@ -291,7 +330,15 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
     };
     p.drawConvexPolygon(arrow, sizeof(arrow) / sizeof(arrow[0]));
 
-    drawAxisIndicator(p, QPointF{axisIndicatorSize / 2.f, height - axisIndicatorSize / 2.f}, axisIndicatorSize, fontColor);
+    drawAxisIndicator(p, QPointF{axisIndicatorSize / 2.f, size.height() - axisIndicatorSize / 2.f}, axisIndicatorSize, _fontColor);
+}
+
+void VehicleGeometryImageProvider::drawMotors(QPainter& p, const Layout& layout)
+{
+    const float rotorDiameter = layout.rotorDiameter;
+    const float rotorFontSize{ rotorDiameter * 0.4f };
+    const QColor rotorHighlightColor{ frameArrowColor };
+    const QColor fontColor{ _fontColor };
 
     auto drawMotor = [&](const ActuatorGeometry& actuator, QPointF pos, float yPosOffset, bool labelAtBottom) {
         p.setPen(Qt::NoPen);
@@ -304,7 +351,7 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
             arrowColor = counterClockWiseColor;
         }
         arrowColor.setAlpha(255);
-        if (_palette.globalTheme() == QGCPalette::Light) {
+        if (_lightTheme) {
             arrowColor = arrowColor.darker(200);
         } else {
             arrowColor = arrowColor.lighter(130);
@@ -374,16 +421,14 @@ QPixmap VehicleGeometryImageProvider::requestPixmap(const QString& id, QSize* si
     };
 
     // draw coax motors
-    iterateMotors(coaxActuators, [&](const ActuatorGeometry& actuator, QPointF pos) {
-        drawMotor(actuator, pos, extraYMargin, true);
+    iterateMotors(layout.coaxActuators, layout.scale, layout.offsetX, layout.offsetY, [&](const ActuatorGeometry& actuator, QPointF pos) {
+        drawMotor(actuator, pos, layout.extraYMargin, true);
     });
 
     // draw the rest of the motors
-    iterateMotors(actuators, [&](const ActuatorGeometry& actuator, QPointF pos) {
+    iterateMotors(layout.actuators, layout.scale, layout.offsetX, layout.offsetY, [&](const ActuatorGeometry& actuator, QPointF pos) {
         drawMotor(actuator, pos, 0.f, false);
     });
-
-    return pixmap;
 }
 
 VehicleGeometryImageProvider* VehicleGeometryImageProvider::instance()
@@ -395,8 +440,42 @@ VehicleGeometryImageProvider* VehicleGeometryImageProvider::instance()
     return instance;
 }
 
+QList<ActuatorGeometry> VehicleGeometryImageProvider::actuators() const
+{
+    QMutexLocker lock(&_mutex);
+    return _actuators;
+}
+
+bool VehicleGeometryImageProvider::setActuators(const QList<ActuatorGeometry>& actuators)
+{
+    const QColor fontColor = _palette.text();
+    const bool lightTheme = _palette.globalTheme() == QGCPalette::Light;
+
+    QMutexLocker lock(&_mutex);
+
+    if (actuators == _actuators && fontColor == _fontColor && lightTheme == _lightTheme) {
+        return false;
+    }
+
+    bool sameFrame = actuators.size() == _actuators.size() && fontColor == _fontColor;
+    for (int i = 0; sameFrame && i < actuators.size(); ++i) {
+        sameFrame = actuators[i].sameFrame(_actuators[i]);
+    }
+
+    _actuators = actuators;
+    _fontColor = fontColor;
+    _lightTheme = lightTheme;
+    ++_revision;
+    if (!sameFrame) {
+        ++_frameRevision;
+    }
+    return true;
+}
+
 int VehicleGeometryImageProvider::getHighlightedMotorIndexAtPos(const QPointF &position)
 {
+    QMutexLocker lock(&_mutex);
+
     int foundIdx = -1;
     for (int i = 0; i < _actuatorImagePositions.size(); ++i) {
         if (_actuatorImagePositions[i].type == ActuatorGeometry::Type::Motor) {
@@ -418,6 +497,8 @@ int VehicleGeometryImageProvider::getHighlightedMotorIndexAtPos(const QPointF &p
 
 int VehicleGeometryImageProvider::numMotors() const
 {
+    QMutexLocker lock(&_mutex);
+
     int numMotors = 0;
     for (const auto& actuator : _actuators) {
         if (actuator.type == ActuatorGeometry::Type::Motor) {
@@ -18,6 +18,8 @@
 #include <QQuickImageProvider>
 #include <QVector2D>
 #include <QPainter>
+#include <QImage>
+#include <QMutex>
 
 #include <QGCPalette.h>
 
@@ -28,6 +30,10 @@ namespace GeometryImage {
 
 /**
  * Renders an image of an airframe geometry (currently only multirotor)
+ *
+ * The frame (arms, body and axis indicator) only depends on the actuator positions and is cached as a separate layer,
+ * so highlighting or spin direction changes only redraw the motors on top of it. The last image is cached as well.
+ * Requests may come from the QML image reader thread (asynchronous Image), access to the geometry is locked.
  */
 class VehicleGeometryImageProvider : public QQuickImageProvider
 {
@@ -40,15 +46,19 @@ public:
         float radius;
     };
 
-    void drawAxisIndicator(QPainter& p, const QPointF& origin, float fontSize, const QColor& color);
-
-    QPixmap requestPixmap(const QString& id, QSize* size, const QSize& requestedSize) override;
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
 
     static VehicleGeometryImageProvider* instance();
 
     int getHighlightedMotorIndexAtPos(const QPointF& position);
 
-    QList<ActuatorGeometry>& actuators() { return _actuators; }
+    QList<ActuatorGeometry> actuators() const;
+
+    /**
+     * Set the geometry to render. Call from the GUI thread.
+     * @return true if anything changed, i.e. the image needs to be reloaded
+     */
+    bool setActuators(const QList<ActuatorGeometry>& actuators);
 
     int numMotors() const;
 
@@ -56,10 +66,36 @@ private:
     VehicleGeometryImageProvider();
     ~VehicleGeometryImageProvider() = default;
 
+    struct Layout {
+        QList<ActuatorGeometry> actuators;      ///< motors which are not coax
+        QList<ActuatorGeometry> coaxActuators;  ///< motors on top of one of the above
+        float scale;
+        float offsetX;
+        float offsetY;
+        float rotorDiameter;
+        float extraYMargin;
+    };
+
+    bool layout(const QSize& size, Layout& layout) const;
+    void drawAxisIndicator(QPainter& p, const QPointF& origin, float fontSize, const QColor& color);
+    void drawFrame(QPainter& p, const QSize& size, const Layout& layout);
+    void drawMotors(QPainter& p, const Layout& layout);
+
+    mutable QMutex       _mutex;
+
     QList<ActuatorGeometry> _actuators{};
 
     QList<ImagePosition> _actuatorImagePositions{}; ///< highlighted actuators image positions
-    QGCPalette           _palette;
+    QGCPalette           _palette;                  ///< GUI thread only, colors are copied in setActuators()
+    QColor               _fontColor{};
+    bool                 _lightTheme{false};
+
+    int                  _revision{0};              ///< bumped on any geometry change
+    int                  _frameRevision{0};         ///< bumped when the frame layer is affected
+    QImage               _frameLayer{};
+    int                  _frameLayerRevision{-1};
+    QImage               _image{};
+    int                  _imageRevision{-1};
 };
 
 } // namespace GeometryImage
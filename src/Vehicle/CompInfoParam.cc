@@ -37,6 +37,12 @@ void CompInfoParam::setJson(const QString& metadataJsonFileName)
     if (metadataJsonFileName.isEmpty()) {
         // This will fall back to using the old FirmwarePlugin mechanism for parameter meta data.
         // In this case paramter metadata is loaded through the _parameterMajorVersionKnown call which happens after parameter are downloaded
+        // Kick off loading the meta data now so it has parsed in the background by the time the parameters arrive.
+        if (compId == MAV_COMP_ID_AUTOPILOT1) {
+            int majorVersion, minorVersion;
+            QString metaDataFile = _parameterMetaDataFile(vehicle, vehicle->firmwareType(), majorVersion, minorVersion);
+            qgcApp()->toolbox()->firmwarePluginManager()->preloadParameterMetaData(vehicle->firmwarePlugin(), metaDataFile);
+        }
         return;
     }
 
@@ -292,6 +298,7 @@ void CompInfoParam::_cachePX4MetaDataFile(const QString& metaDataFile)
         QDir cacheDir = QFileInfo(settings.fileName()).dir();
         QFile cacheFile(cacheDir.filePath(QString("%1.%2.%3.xml").arg(_cachedMetaDataFilePrefix).arg(MAV_AUTOPILOT_PX4).arg(newMajorVersion)));
         qCDebug(CompInfoParamLog) << "ParameterManager::cacheMetaDataFile caching file:" << cacheFile.fileName();
+        qgcApp()->toolbox()->firmwarePluginManager()->discardParameterMetaData(cacheFile.fileName());
         QFile newFile(metaDataFile);
         newFile.copy(cacheFile.fileName());
     }
@@ -308,7 +315,7 @@ QObject* CompInfoParam::_getOpaqueParameterMetaData(void)
         int majorVersion, minorVersion;
         QString metaDataFile = _parameterMetaDataFile(vehicle, vehicle->firmwareType(), majorVersion, minorVersion);
         qCDebug(CompInfoParamLog) << "Loading meta data the old way file" << metaDataFile;
-        _opaqueParameterMetaData = vehicle->firmwarePlugin()->_loadParameterMetaData(metaDataFile);
+        _opaqueParameterMetaData = qgcApp()->toolbox()->firmwarePluginManager()->takeParameterMetaData(vehicle->firmwarePlugin(), vehicle->firmwareType(), metaDataFile);
     }
 
     return _opaqueParameterMetaData;
@@ -10,8 +10,13 @@
 #include "ComponentInformationCache.h"
 
 #include <QFile>
+#include <QSaveFile>
 #include <QDirIterator>
 #include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 
 QGC_LOGGING_CATEGORY(ComponentInformationCacheLog, "ComponentInformationCacheLog")
 
@@ -21,6 +26,13 @@ ComponentInformationCache::ComponentInformationCache(const QDir& path, int maxNu
     initializeDirectory();
 }
 
+ComponentInformationCache::~ComponentInformationCache()
+{
+    if (_indexDirty) {
+        saveIndex();
+    }
+}
+
 ComponentInformationCache& ComponentInformationCache::defaultInstance()
 {
     QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCCompInfoCache");
@@ -28,88 +40,79 @@ ComponentInformationCache& ComponentInformationCache::defaultInstance()
     return instance;
 }
 
-QString ComponentInformationCache::metaFileName(const QString& fileTag)
-{
-    return _path.filePath(fileTag+_metaExtension);
-}
-
-QString ComponentInformationCache::dataFileName(const QString& fileTag)
+QString ComponentInformationCache::contentHash(const QString& fileName)
 {
-    return _path.filePath(fileTag+_cacheExtension);
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(ComponentInformationCacheLog) << "Failed to open" << fileName << file.errorString();
+        return "";
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return "";
+    }
+    return QString::fromLatin1(hash.result().toHex());
 }
 
 QString ComponentInformationCache::access(const QString &fileTag)
 {
-    QFile meta(metaFileName(fileTag));
-    QFile data(dataFileName(fileTag));
-    if (!meta.exists() || !data.exists()) {
+    auto entry = _entries.find(fileTag);
+    if (entry == _entries.end()) {
         qCDebug(ComponentInformationCacheLog) << "Cache miss for" << fileTag;
         return "";
     }
 
     qCDebug(ComponentInformationCacheLog) << "Cache hit for" << fileTag;
 
-    // mark access
-    Meta m{};
-    AccessCounterType previousCounter = -1;
-    if (meta.open(QIODevice::ReadWrite)) {
-        if (meta.read((char*)&m, sizeof(m)) == sizeof(m)) {
-            previousCounter = m.accessCounter;
-            m.accessCounter = _nextAccessCounter;
-            meta.seek(0);
-            if (meta.write((const char*)&m, sizeof(m)) != sizeof(m)) {
-                qCWarning(ComponentInformationCacheLog) << "Meta write failed" << meta.fileName() << meta.errorString();
-            }
-        } else {
-            qCWarning(ComponentInformationCacheLog) << "Meta read failed" << meta.fileName() << meta.errorString();
-        }
-        meta.close();
-    } else {
-        qCWarning(ComponentInformationCacheLog) << "Failed to open" << meta.fileName() << meta.errorString();
-    }
-
-    _cachedFiles.remove(previousCounter);
+    // mark access, only in memory
+    _cachedFiles.remove(entry->accessCounter);
+    entry->accessCounter = _nextAccessCounter;
     _cachedFiles[_nextAccessCounter] = fileTag;
     ++_nextAccessCounter;
+    _indexDirty = true;
 
-    return data.fileName();
+    return _path.filePath(entry->dataFile);
 }
 
 QString ComponentInformationCache::insert(const QString &fileTag, const QString &fileName)
 {
-    QFile meta(metaFileName(fileTag));
-    QFile data(dataFileName(fileTag));
     QFile fileToCache(fileName);
-    if (meta.exists() || data.exists()) {
+    if (_entries.contains(fileTag)) {
         qCDebug(ComponentInformationCacheLog) << "Not inserting, entry already exists" << fileTag;
         fileToCache.remove();
-        return data.fileName();
+        return _path.filePath(_entries[fileTag].dataFile);
     }
 
-    // move the file to the cache location
-    if (!fileToCache.rename(data.fileName())) {
-        qCWarning(ComponentInformationCacheLog) << "File rename failed from:to" << fileName << data.fileName();
+    const QString hash = contentHash(fileName);
+    if (hash.isEmpty()) {
         return "";
     }
+    const QString dataFile = hash + _cacheExtension;
 
-    // write meta data
-    Meta m{};
-    m.accessCounter = _nextAccessCounter;
-    if (meta.open(QIODevice::WriteOnly)) {
-        if (meta.write((const char*)&m, sizeof(m)) != sizeof(m)) {
-            qCWarning(ComponentInformationCacheLog) << "Meta write failed" << meta.fileName() << meta.errorString();
-        }
-        meta.close();
+    if (_dataFileRefCounts.contains(dataFile)) {
+        // Identical content is already cached for another tag (other vehicle or firmware version)
+        qCDebug(ComponentInformationCacheLog) << "Sharing cached file for" << fileTag << dataFile;
+        fileToCache.remove();
     } else {
-        qCWarning(ComponentInformationCacheLog) << "Failed to open" << meta.fileName() << meta.errorString();
+        // move the file to the cache location, the rename is atomic so a partial file is never visible
+        QFile::remove(_path.filePath(dataFile));
+        if (!fileToCache.rename(_path.filePath(dataFile))) {
+            qCWarning(ComponentInformationCacheLog) << "File rename failed from:to" << fileName << _path.filePath(dataFile);
+            return "";
+        }
     }
 
     // update internal data
+    Entry entry;
+    entry.dataFile = dataFile;
+    entry.accessCounter = _nextAccessCounter;
+    _entries[fileTag] = entry;
     _cachedFiles[_nextAccessCounter++] = fileTag;
-    ++_numFiles;
+    _dataFileRefCounts[dataFile]++;
 
     removeOldEntries();
-    return data.fileName();
+    saveIndex();
+    return _path.filePath(dataFile);
 }
 
 void ComponentInformationCache::initializeDirectory()
@@ -121,72 +124,116 @@ void ComponentInformationCache::initializeDirectory()
         }
     }
 
+    loadIndex();
+
+    // Only done once at startup: remove files which are not referenced by the index (including files from
+    // older cache formats)
     QDir::Filters filters = QDir::Files | QDir::NoDotAndDotDot;
     QDirIterator it(_path.path(), filters, QDirIterator::NoIteratorFlags);
     while (it.hasNext()) {
         QString path = it.next();
-
-        if (path.endsWith(_metaExtension)) {
-            QFile meta(path);
-            QFile data(path.mid(0, path.length()-strlen(_metaExtension))+_cacheExtension);
-            bool validationFailed = false;
-            if (!data.exists()) {
-                validationFailed = true;
-            }
-
-            // read meta + validate
-            Meta m{};
-            const uint32_t expectedMagic = m.magic;
-            const uint32_t expectedVersion = m.version;
-            if (meta.open(QIODevice::ReadOnly)) {
-                if (meta.read((char*)&m, sizeof(m)) == sizeof(m)) {
-                    if (m.magic != expectedMagic || m.version != expectedVersion) {
-                        validationFailed = true;
-                    }
-                } else {
-                    validationFailed = true;
-                }
-                meta.close();
-            } else {
-                validationFailed = true;
-            }
-
-            if (validationFailed) {
-                qCWarning(ComponentInformationCacheLog) << "Validation failed, removing cache files" << path;
-                meta.remove();
-                data.remove();
-            } else {
-                // extract the tag
-                QString tag = it.fileName();
-                tag = tag.mid(0, tag.length()-strlen(_metaExtension));
-                _cachedFiles[m.accessCounter] = tag;
-
-                qCDebug(ComponentInformationCacheLog) << "Found cached file:counter" << meta.fileName() << m.accessCounter;
-
-                if (m.accessCounter >= _nextAccessCounter) {
-                    _nextAccessCounter = m.accessCounter + 1;
-                }
-            }
-
-        } else if (!path.endsWith(_cacheExtension)) {
+        QString name = it.fileName();
+        if (name != _indexFileName && !_dataFileRefCounts.contains(name)) {
+            qCDebug(ComponentInformationCacheLog) << "Removing unreferenced file" << path;
             QFile::remove(path);
         }
     }
-    _numFiles = _cachedFiles.size();
+
     removeOldEntries();
+    if (_indexDirty) {
+        saveIndex();
+    }
+}
+
+void ComponentInformationCache::loadIndex()
+{
+    QFile indexFile(_path.filePath(_indexFileName));
+    if (!indexFile.exists()) {
+        return;
+    }
+    if (!indexFile.open(QIODevice::ReadOnly)) {
+        qCWarning(ComponentInformationCacheLog) << "Failed to open" << indexFile.fileName() << indexFile.errorString();
+        return;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument   doc = QJsonDocument::fromJson(indexFile.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || doc.object()["version"].toInt() != _indexVersion) {
+        qCWarning(ComponentInformationCacheLog) << "Validation failed, discarding cache index" << indexFile.fileName() << parseError.errorString();
+        return;
+    }
+
+    for (const QJsonValue& value: doc.object()["entries"].toArray()) {
+        QJsonObject     jsonEntry   = value.toObject();
+        QString         fileTag     = jsonEntry["tag"].toString();
+        Entry           entry;
+        entry.dataFile      = jsonEntry["file"].toString();
+        entry.accessCounter = static_cast<AccessCounterType>(jsonEntry["accessCounter"].toDouble());
+
+        if (fileTag.isEmpty() || !QFile::exists(_path.filePath(entry.dataFile)) || _cachedFiles.contains(entry.accessCounter)) {
+            qCWarning(ComponentInformationCacheLog) << "Validation failed, removing cache entry" << fileTag;
+            _indexDirty = true;
+            continue;
+        }
+
+        _entries[fileTag] = entry;
+        _cachedFiles[entry.accessCounter] = fileTag;
+        _dataFileRefCounts[entry.dataFile]++;
+
+        qCDebug(ComponentInformationCacheLog) << "Found cached file:counter" << fileTag << entry.dataFile << entry.accessCounter;
+
+        if (entry.accessCounter >= _nextAccessCounter) {
+            _nextAccessCounter = entry.accessCounter + 1;
+        }
+    }
+}
+
+void ComponentInformationCache::saveIndex()
+{
+    QJsonArray jsonEntries;
+    for (auto iter = _entries.constBegin(); iter != _entries.constEnd(); ++iter) {
+        QJsonObject jsonEntry;
+        jsonEntry["tag"]            = iter.key();
+        jsonEntry["file"]           = iter->dataFile;
+        jsonEntry["accessCounter"]  = static_cast<double>(iter->accessCounter);
+        jsonEntries.append(jsonEntry);
+    }
+    QJsonObject jsonIndex;
+    jsonIndex["version"] = _indexVersion;
+    jsonIndex["entries"] = jsonEntries;
+
+    // QSaveFile replaces the index atomically, an interrupted write leaves the previous index in place
+    QSaveFile indexFile(_path.filePath(_indexFileName));
+    if (!indexFile.open(QIODevice::WriteOnly)) {
+        qCWarning(ComponentInformationCacheLog) << "Failed to open" << indexFile.fileName() << indexFile.errorString();
+        return;
+    }
+    indexFile.write(QJsonDocument(jsonIndex).toJson(QJsonDocument::Compact));
+    if (!indexFile.commit()) {
+        qCWarning(ComponentInformationCacheLog) << "Index write failed" << indexFile.fileName() << indexFile.errorString();
+        return;
+    }
+    _indexDirty = false;
+}
+
+void ComponentInformationCache::removeEntry(const QString& fileTag)
+{
+    Entry entry = _entries.take(fileTag);
+    _cachedFiles.remove(entry.accessCounter);
+
+    // The data file may be shared with other entries
+    if (--_dataFileRefCounts[entry.dataFile] <= 0) {
+        _dataFileRefCounts.remove(entry.dataFile);
+        QFile::remove(_path.filePath(entry.dataFile));
+    }
+    _indexDirty = true;
 }
 
 void ComponentInformationCache::removeOldEntries()
 {
-    while (_numFiles > _maxNumFiles) {
+    while (_entries.count() > _maxNumFiles) {
         auto iter = _cachedFiles.begin();
-        QFile meta(metaFileName(iter.value()));
-        QFile data(dataFileName(iter.value()));
-        qCDebug(ComponentInformationCacheLog) << "Removing cache entry num:counter:file" << _numFiles << iter.key() << iter.value();
-        meta.remove();
-        data.remove();
-
-        _cachedFiles.erase(iter);
-        --_numFiles;
+        qCDebug(ComponentInformationCacheLog) << "Removing cache entry num:counter:file" << _entries.count() << iter.key() << iter.value();
+        removeEntry(iter.value());
     }
 }
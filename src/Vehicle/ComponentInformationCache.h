@@ -14,15 +14,19 @@
 #include <QString>
 #include <QDir>
 #include <QMap>
+#include <QHash>
 
 #include <cstdint>
 
 Q_DECLARE_LOGGING_CATEGORY(ComponentInformationCacheLog)
 
 /**
- * Simple file cache with a maximum number of files and LRU retention policy based on last access
+ * Simple file cache with a maximum number of entries and LRU retention policy based on last access
  * Notes:
  * - fileTag defines the cache keys and the format is up to the user
+ * - files are stored by content hash, entries with identical content share a single file
+ * - the index (tag -> file, access order) is kept in memory and persisted as a single file, so lookups do not
+ *   touch the disk. It is written on insert and destruction, access order changes in between are lost on a crash.
  * - only one instance per directory must exist
  * - not thread-safe
  */
@@ -31,6 +35,7 @@ class ComponentInformationCache : public QObject
     Q_OBJECT
 public:
     ComponentInformationCache(const QDir& path, int maxNumFiles);
+    ~ComponentInformationCache();
 
     static ComponentInformationCache& defaultInstance();
 
@@ -51,27 +56,31 @@ public:
 
 private:
 
-    static constexpr const char* _metaExtension = ".meta";
+    static constexpr const char* _indexFileName = "index.json";
     static constexpr const char* _cacheExtension = ".cache";
+    static constexpr int _indexVersion = 1;
 
     using AccessCounterType = uint64_t;
 
-    struct Meta {
-        uint32_t magic{0x9a9cad0e};
-        uint32_t version{0};
+    struct Entry {
+        QString dataFile;   ///< File name within the cache directory
         AccessCounterType accessCounter{0};
     };
 
     void initializeDirectory();
     void removeOldEntries();
+    void loadIndex();
+    void saveIndex();
+    void removeEntry(const QString& fileTag);
 
-    QString metaFileName(const QString& fileTag);
-    QString dataFileName(const QString& fileTag);
+    static QString contentHash(const QString& fileName);
 
     const QDir _path;
     const int _maxNumFiles;
 
     AccessCounterType _nextAccessCounter{0};
-    int _numFiles{0};
-    QMap<AccessCounterType, QString> _cachedFiles;
+    bool _indexDirty{false};
+    QHash<QString, Entry> _entries;                     ///< Keyed by file tag
+    QMap<AccessCounterType, QString> _cachedFiles;      ///< Access order -> file tag
+    QHash<QString, int> _dataFileRefCounts;             ///< Number of entries using each data file
 };
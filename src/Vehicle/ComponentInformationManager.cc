@@ -18,15 +18,15 @@
 #include "QGCApplication.h"
 
 #include <QStandardPaths>
+#include <QLocale>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(ComponentInformationManagerLog, "ComponentInformationManagerLog")
 
 const ComponentInformationManager::StateFn ComponentInformationManager::_rgStates[]= {
     ComponentInformationManager::_stateRequestCompInfoGeneral,
     ComponentInformationManager::_stateRequestCompInfoGeneralComplete,
-    ComponentInformationManager::_stateRequestCompInfoParam,
-    ComponentInformationManager::_stateRequestCompInfoEvents,
-    ComponentInformationManager::_stateRequestCompInfoActuators,
+    ComponentInformationManager::_stateRequestCompInfoMetaData,
     ComponentInformationManager::_stateRequestAllCompInfoComplete
 };
 
@@ -46,15 +46,18 @@ const int RequestMetaDataTypeStateMachine::_cStates = sizeof(RequestMetaDataType
 
 ComponentInformationManager::ComponentInformationManager(Vehicle* vehicle)
     : _vehicle                  (vehicle)
-    , _requestTypeStateMachine  (this)
-    , _cachedFileDownload(new QGCCachedFileDownload(this, QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCCompInfoFileDownloadCache")))
     , _fileCache(ComponentInformationCache::defaultInstance())
-    , _translation(new ComponentInformationTranslation(this, _cachedFileDownload))
 {
     _compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_GENERAL]    = new CompInfoGeneral   (MAV_COMP_ID_AUTOPILOT1, vehicle, this);
     _compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_PARAMETER]  = new CompInfoParam     (MAV_COMP_ID_AUTOPILOT1, vehicle, this);
     _compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_EVENTS]     = new CompInfoEvents    (MAV_COMP_ID_AUTOPILOT1, vehicle, this);
     _compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_ACTUATORS]  = new CompInfoActuators (MAV_COMP_ID_AUTOPILOT1, vehicle, this);
+
+    for (COMP_METADATA_TYPE type: _compInfoMap[MAV_COMP_ID_AUTOPILOT1].keys()) {
+        RequestMetaDataTypeStateMachine* requestMachine = new RequestMetaDataTypeStateMachine(this);
+        requestMachine->setParent(this);
+        _requestTypeStateMachines[type] = requestMachine;
+    }
 }
 
 int ComponentInformationManager::stateCount(void) const
@@ -72,7 +75,7 @@ float ComponentInformationManager::progress() const
     if (!_active)
         return 1.f;
     // here we could compute a more fine-grained progress, based on ftp download progress
-    return _stateIndex / (float)_cStates;
+    return _completedTypeCount / (float)_compInfoMap[MAV_COMP_ID_AUTOPILOT1].count();
 }
 
 void ComponentInformationManager::advance()
@@ -85,6 +88,7 @@ void ComponentInformationManager::requestAllComponentInformation(RequestAllCompl
 {
     _requestAllCompleteFn       = requestAllCompletFn;
     _requestAllCompleteFnData   = requestAllCompleteFnData;
+    _completedTypeCount         = 0;
     start();
     emit progressUpdate(progress());
 }
@@ -92,7 +96,7 @@ void ComponentInformationManager::requestAllComponentInformation(RequestAllCompl
 void ComponentInformationManager::_stateRequestCompInfoGeneral(StateMachine* stateMachine)
 {
     ComponentInformationManager* compMgr = static_cast<ComponentInformationManager*>(stateMachine);
-    compMgr->_requestTypeStateMachine.request(compMgr->_compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_GENERAL]);
+    compMgr->_requestType(COMP_METADATA_TYPE_GENERAL);
 }
 
 void ComponentInformationManager::_stateRequestCompInfoGeneralComplete(StateMachine* stateMachine)
@@ -110,43 +114,71 @@ void ComponentInformationManager::_updateAllUri()
     }
 }
 
-void ComponentInformationManager::_stateRequestCompInfoComplete(void)
+void ComponentInformationManager::_requestType(COMP_METADATA_TYPE type)
 {
-    advance();
+    _activeTypes.insert(type);
+    _requestTypeStateMachines[type]->request(_compInfoMap[MAV_COMP_ID_AUTOPILOT1][type]);
 }
 
-void ComponentInformationManager::_stateRequestCompInfoParam(StateMachine* stateMachine)
+void ComponentInformationManager::_requestTypeComplete(COMP_METADATA_TYPE type)
 {
-    ComponentInformationManager* compMgr = static_cast<ComponentInformationManager*>(stateMachine);
+    _activeTypes.remove(type);
+    _completedTypeCount++;
 
-    if (compMgr->_isCompTypeSupported(COMP_METADATA_TYPE_PARAMETER)) {
-        compMgr->_requestTypeStateMachine.request(compMgr->_compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_PARAMETER]);
+    if (type == COMP_METADATA_TYPE_GENERAL) {
+        if (currentState() == _stateRequestCompInfoGeneral) {
+            advance();
+        }
+    } else if (currentState() == _stateRequestCompInfoMetaData && !_startingTypeRequests) {
+        if (_requiredTypesComplete()) {
+            advance();
+        } else {
+            emit progressUpdate(progress());
+        }
     } else {
-        qCDebug(ComponentInformationManagerLog) << "_stateRequestCompInfoParam skipping, not supported";
-        compMgr->advance();
+        qCDebug(ComponentInformationManagerLog) << "Background request complete" << type;
     }
 }
 
-void ComponentInformationManager::_stateRequestCompInfoEvents(StateMachine* stateMachine)
+bool ComponentInformationManager::_requiredTypesComplete(void) const
 {
-    ComponentInformationManager* compMgr = static_cast<ComponentInformationManager*>(stateMachine);
-
-    if (compMgr->_isCompTypeSupported(COMP_METADATA_TYPE_EVENTS)) {
-        compMgr->_requestTypeStateMachine.request(compMgr->_compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_EVENTS]);
-    } else {
-        qCDebug(ComponentInformationManagerLog) << "_stateRequestCompInfoEvents skipping, not supported";
-        compMgr->advance();
+    for (COMP_METADATA_TYPE type: _activeTypes) {
+        if (_isRequiredType(type)) {
+            return false;
+        }
     }
+    return true;
+}
+
+/// @return true: Type must be available before the initial connection can complete
+bool ComponentInformationManager::_isRequiredType(COMP_METADATA_TYPE type)
+{
+    // Parameter metadata must be in place before the parameters are loaded. Events and actuators metadata are
+    // only used once the vehicle is up and are picked up whenever they arrive.
+    return type == COMP_METADATA_TYPE_GENERAL || type == COMP_METADATA_TYPE_PARAMETER;
 }
 
-void ComponentInformationManager::_stateRequestCompInfoActuators(StateMachine* stateMachine)
+void ComponentInformationManager::_stateRequestCompInfoMetaData(StateMachine* stateMachine)
 {
     ComponentInformationManager* compMgr = static_cast<ComponentInformationManager*>(stateMachine);
 
-    if (compMgr->_isCompTypeSupported(COMP_METADATA_TYPE_ACTUATORS)) {
-        compMgr->_requestTypeStateMachine.request(compMgr->_compInfoMap[MAV_COMP_ID_AUTOPILOT1][COMP_METADATA_TYPE_ACTUATORS]);
-    } else {
-        qCDebug(ComponentInformationManagerLog) << "_stateRequestCompInfoActuators skipping, not supported";
+    // The other types only depend on the uris from the general metadata, so they are all requested at once. Requests
+    // may complete right away, the state only advances once all of them are started.
+    compMgr->_startingTypeRequests = true;
+    for (COMP_METADATA_TYPE type: compMgr->_compInfoMap[MAV_COMP_ID_AUTOPILOT1].keys()) {
+        if (type == COMP_METADATA_TYPE_GENERAL) {
+            continue;
+        }
+        if (compMgr->_isCompTypeSupported(type)) {
+            compMgr->_requestType(type);
+        } else {
+            qCDebug(ComponentInformationManagerLog) << "_stateRequestCompInfoMetaData skipping, not supported" << type;
+            compMgr->_completedTypeCount++;
+        }
+    }
+    compMgr->_startingTypeRequests = false;
+
+    if (compMgr->_requiredTypesComplete()) {
         compMgr->advance();
     }
 }
@@ -183,11 +215,20 @@ QString ComponentInformationManager::_getFileCacheTag(int compInfoType, uint32_t
     return QString::asprintf("%08x_%02i_%i", crc, compInfoType, (int)isTranslation);
 }
 
+/// The translated metadata only depends on the metadata content and the locale, the translation file itself is not
+/// part of the tag. Updated translations are picked up with the next metadata change.
+QString ComponentInformationManager::_getTranslatedFileCacheTag(const QString& metadataFileCacheTag, const QString& locale)
+{
+    return QStringLiteral("%1_%2").arg(metadataFileCacheTag, locale);
+}
+
 
 RequestMetaDataTypeStateMachine::RequestMetaDataTypeStateMachine(ComponentInformationManager* compMgr)
-    : _compMgr(compMgr)
+    : _compMgr              (compMgr)
+    , _cachedFileDownload   (new QGCCachedFileDownload(this))
+    , _translation          (new ComponentInformationTranslation(this, _cachedFileDownload))
 {
-
+    connect(&_inflateWatcher, &QFutureWatcherBase::finished, this, &RequestMetaDataTypeStateMachine::_inflateComplete);
 }
 
 void RequestMetaDataTypeStateMachine::request(CompInfo* compInfo)
@@ -195,6 +236,7 @@ void RequestMetaDataTypeStateMachine::request(CompInfo* compInfo)
     _compInfo   = compInfo;
     _stateIndex = -1;
     _jsonMetadataFileName.clear();
+    _jsonMetadataCacheFileTag.clear();
     _jsonTranslationFileName.clear();
 
     start();
@@ -212,7 +254,7 @@ const RequestMetaDataTypeStateMachine::StateFn* RequestMetaDataTypeStateMachine:
 
 void RequestMetaDataTypeStateMachine::statesCompleted(void) const
 {
-    _compMgr->_stateRequestCompInfoComplete();
+    _compMgr->_requestTypeComplete(_compInfo->type);
 }
 
 QString RequestMetaDataTypeStateMachine::typeToString(void)
@@ -333,39 +375,62 @@ void RequestMetaDataTypeStateMachine::_stateRequestCompInfoDeprecated(StateMachi
     }
 }
 
-QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QString& fileName)
+/// Decompresses the file if needed and stores it in the cache, then advances the state machine
+void RequestMetaDataTypeStateMachine::_processDownloadedFile(const QString& fileName)
 {
-    QString outputFileName = fileName;
-
     if (fileName.endsWith(".lzma", Qt::CaseInsensitive) || fileName.endsWith(".xz", Qt::CaseInsensitive)) {
-        outputFileName = (QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(_currentCacheFileTag));
-        if (QGCLZMA::inflateLZMAFile(fileName, outputFileName)) {
-            QFile(fileName).remove();
-        } else {
-            qCWarning(ComponentInformationManagerLog) << "Inflate of compressed json failed" << _currentCacheFileTag;
-            outputFileName.clear();
-        }
+        // Large metadata files take a noticeable time to inflate, so this is done off the gui thread
+        const QString outputFileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(_currentCacheFileTag);
+        _inflateWatcher.setFuture(QtConcurrent::run([fileName, outputFileName]() {
+            if (QGCLZMA::inflateLZMAFile(fileName, outputFileName)) {
+                QFile(fileName).remove();
+                return outputFileName;
+            }
+            return QString();
+        }));
     } else {
-        outputFileName = fileName;
+        _storeDownloadedFile(fileName);
+        advance();
     }
+}
 
-    if (_currentFileValidCrc) {
+void RequestMetaDataTypeStateMachine::_inflateComplete(void)
+{
+    const QString outputFileName = _inflateWatcher.result();
+    if (outputFileName.isEmpty()) {
+        qCWarning(ComponentInformationManagerLog) << "Inflate of compressed json failed" << _currentCacheFileTag;
+    }
+    _storeDownloadedFile(outputFileName);
+    advance();
+}
+
+void RequestMetaDataTypeStateMachine::_storeDownloadedFile(const QString& fileName)
+{
+    QString outputFileName = fileName;
+
+    if (_currentFileValidCrc && !outputFileName.isEmpty()) {
         // cache the file (this will move/remove the temp file as well)
         outputFileName = _compMgr->fileCache().insert(_currentCacheFileTag, outputFileName);
     }
-    return outputFileName;
+    if (_currentFileName) {
+        *_currentFileName = outputFileName;
+    }
 }
 
 void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
 {
+    if (fileName != _ftpDownloadFile) {
+        // Some other queued download
+        return;
+    }
+
     qCDebug(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_ftpDownloadComplete fileName:errorMsg" << fileName << errorMsg;
 
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::commandProgress, this, &RequestMetaDataTypeStateMachine::_ftpDownloadProgress);
     if (errorMsg.isEmpty()) {
-        if (_currentFileName) {
-            *_currentFileName = _downloadCompleteJsonWorker(fileName);
-        }
+        _processDownloadedFile(fileName);
+        return;
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_ftpDownloadComplete failed filename:errorMsg" << fileName << errorMsg;
@@ -376,6 +441,10 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileNa
 
 void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress)
 {
+    if (_compInfo->vehicle->ftpManager()->currentDownloadFilePath() != _ftpDownloadFile) {
+        return;
+    }
+
     int elapsedSec = _downloadStartTime.elapsed() / 1000;
     float totalDownloadTime = elapsedSec / progress;
     // abort download if it's too slow (e.g. over telemetry link) and use the fallback.
@@ -393,9 +462,8 @@ void RequestMetaDataTypeStateMachine::_httpDownloadComplete(QString remoteFile,
 
     disconnect(qobject_cast<QGCCachedFileDownload*>(sender()), &QGCCachedFileDownload::downloadComplete, this, &RequestMetaDataTypeStateMachine::_httpDownloadComplete);
     if (errorMsg.isEmpty()) {
-        if (_currentFileName) {
-            *_currentFileName = _downloadCompleteJsonWorker(localFile);
-        }
+        _processDownloadedFile(localFile);
+        return;
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_httpDownloadCompleteMetaDataJson failed remoteFile:localFile:errorMsg" << remoteFile << localFile << errorMsg;
@@ -404,51 +472,92 @@ void RequestMetaDataTypeStateMachine::_httpDownloadComplete(QString remoteFile,
     advance();
 }
 
-void RequestMetaDataTypeStateMachine::_requestFile(const QString& cacheFileTag, bool crcValid, const QString& uri, QString& outputFileName)
+void RequestMetaDataTypeStateMachine::_requestFile(const QString& cacheFileTag, bool& crcValid, const QString& uri, QString& outputFileName, bool isTranslation)
 {
     FTPManager*                         ftpManager      = _compInfo->vehicle->ftpManager();
     _currentCacheFileTag = cacheFileTag;
     _currentFileName = &outputFileName;
     _currentFileValidCrc = crcValid;
+    _currentCrcValid = &crcValid;
+    _currentURI = uri;
+    _currentIsTranslation = isTranslation;
     outputFileName.clear();
 
     if (_compInfo->available() && !uri.isEmpty()) {
-        const QString cachedFile = crcValid ? _compMgr->fileCache().access(cacheFileTag) : "";
-
-        if (cachedFile.isEmpty()) {
-            qCDebug(ComponentInformationManagerLog) << "Downloading json" << uri;
-            if (_uriIsMAVLinkFTP(uri)) {
-                connect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
-                if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, uri, QStandardPaths::writableLocation(QStandardPaths::TempLocation))) {
-                    _downloadStartTime.start();
-                    connect(ftpManager, &FTPManager::commandProgress, this, &RequestMetaDataTypeStateMachine::_ftpDownloadProgress);
-                } else {
-                    qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_requestFile FTPManager::download returned failure";
-                    disconnect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
-                    advance();
-                }
-            } else {
-                connect(_compMgr->_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this,
-                        &RequestMetaDataTypeStateMachine::_httpDownloadComplete);
-                if (_compMgr->_cachedFileDownload->download(uri, crcValid ? 0 : ComponentInformationManager::cachedFileMaxAgeSec)) {
-                    _downloadStartTime.start();
-                } else {
-                    qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_requestFile QGCCachedFileDownload::download returned failure";
-                    disconnect(_compMgr->_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this,
-                               &RequestMetaDataTypeStateMachine::_httpDownloadComplete);
-                    advance();
-                }
+        if (!crcValid && _uriIsMAVLinkFTP(uri)) {
+            // No crc was provided for the file, ask the vehicle for it so an unchanged file can come from the cache
+            connect(ftpManager, &FTPManager::calcFileCrc32Complete, this, &RequestMetaDataTypeStateMachine::_ftpCalcFileCrc32Complete);
+            if (ftpManager->calcFileCrc32(MAV_COMP_ID_AUTOPILOT1, uri, FTPManager::PriorityHigh)) {
+                return;
             }
-        } else {
-            qCDebug(ComponentInformationManagerLog) << "Using cached file" << cachedFile;
-            outputFileName = cachedFile;
-            advance();
+            disconnect(ftpManager, &FTPManager::calcFileCrc32Complete, this, &RequestMetaDataTypeStateMachine::_ftpCalcFileCrc32Complete);
         }
+        _requestFileWorker();
     } else {
         qCDebug(ComponentInformationManagerLog) << "Skipping download. Component information not available for" << _currentCacheFileTag;
         advance();
     }
+}
+
+void RequestMetaDataTypeStateMachine::_ftpCalcFileCrc32Complete(const QString& fromURI, uint32_t crc, const QString& errorMsg)
+{
+    if (fromURI != _currentURI) {
+        return;
+    }
+
+    disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::calcFileCrc32Complete, this, &RequestMetaDataTypeStateMachine::_ftpCalcFileCrc32Complete);
+    if (errorMsg.isEmpty()) {
+        qCDebug(ComponentInformationManagerLog) << "Vehicle provided crc" << fromURI << QString::number(crc, 16);
+        _currentCacheFileTag    = ComponentInformationManager::_getFileCacheTag(_compInfo->type, crc, _currentIsTranslation);
+        _currentFileValidCrc    = true;
+        *_currentCrcValid       = true;
+    } else {
+        qCDebug(ComponentInformationManagerLog) << "Vehicle crc request failed, downloading without cache" << fromURI << errorMsg;
+    }
+    _requestFileWorker();
+}
+
+void RequestMetaDataTypeStateMachine::_requestFileWorker(void)
+{
+    FTPManager*     ftpManager  = _compInfo->vehicle->ftpManager();
+    const QString   cachedFile  = _currentFileValidCrc ? _compMgr->fileCache().access(_currentCacheFileTag) : "";
+    const QString&  uri         = _currentURI;
+
+    if (!_currentIsTranslation) {
+        _jsonMetadataCacheFileTag = _currentCacheFileTag;
+    }
 
+    if (cachedFile.isEmpty()) {
+        qCDebug(ComponentInformationManagerLog) << "Downloading json" << uri;
+        if (_uriIsMAVLinkFTP(uri)) {
+            const QString toDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+            _ftpDownloadFile = FTPManager::downloadFilePath(uri, toDir);
+            connect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
+            if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, uri, toDir, QString(), true, FTPManager::PriorityHigh)) {
+                _downloadStartTime.start();
+                connect(ftpManager, &FTPManager::commandProgress, this, &RequestMetaDataTypeStateMachine::_ftpDownloadProgress);
+            } else {
+                qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_requestFile FTPManager::download returned failure";
+                disconnect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
+                advance();
+            }
+        } else {
+            connect(_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this,
+                    &RequestMetaDataTypeStateMachine::_httpDownloadComplete);
+            if (_cachedFileDownload->download(uri, _currentFileValidCrc ? 0 : ComponentInformationManager::cachedFileMaxAgeSec)) {
+                _downloadStartTime.start();
+            } else {
+                qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_requestFile QGCCachedFileDownload::download returned failure";
+                disconnect(_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this,
+                           &RequestMetaDataTypeStateMachine::_httpDownloadComplete);
+                advance();
+            }
+        }
+    } else {
+        qCDebug(ComponentInformationManagerLog) << "Using cached file" << cachedFile;
+        *_currentFileName = cachedFile;
+        advance();
+    }
 }
 
 void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJson(StateMachine* stateMachine)
@@ -459,7 +568,7 @@ void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJson(StateMachine* st
             compInfo->type, compInfo->crcMetaData(), false);
     const QString                       uri             = compInfo->uriMetaData();
     requestMachine->_jsonMetadataCrcValid               = compInfo->crcMetaDataValid();
-    requestMachine->_requestFile(fileTag, compInfo->crcMetaDataValid(), uri, requestMachine->_jsonMetadataFileName);
+    requestMachine->_requestFile(fileTag, requestMachine->_jsonMetadataCrcValid, uri, requestMachine->_jsonMetadataFileName);
 }
 
 void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJsonFallback(StateMachine* stateMachine)
@@ -476,7 +585,7 @@ void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJsonFallback(StateMac
             compInfo->type, compInfo->crcMetaDataFallback(), false);
     const QString                       uri             = compInfo->uriMetaDataFallback();
     requestMachine->_jsonMetadataCrcValid               = compInfo->crcMetaDataFallbackValid();
-    requestMachine->_requestFile(fileTag, compInfo->crcMetaDataFallbackValid(), uri, requestMachine->_jsonMetadataFileName);
+    requestMachine->_requestFile(fileTag, requestMachine->_jsonMetadataCrcValid, uri, requestMachine->_jsonMetadataFileName);
 }
 
 void RequestMetaDataTypeStateMachine::_stateRequestTranslationJson(StateMachine* stateMachine)
@@ -484,36 +593,62 @@ void RequestMetaDataTypeStateMachine::_stateRequestTranslationJson(StateMachine*
     RequestMetaDataTypeStateMachine*    requestMachine  = static_cast<RequestMetaDataTypeStateMachine*>(stateMachine);
     CompInfo*                           compInfo        = requestMachine->compInfo();
     const QString                       uri             = compInfo->uriTranslation();
-    requestMachine->_requestFile("", false, uri, requestMachine->_jsonTranslationFileName);
+    const QString                       fileTag         = ComponentInformationManager::_getFileCacheTag(compInfo->type, 0, true);
+    requestMachine->_jsonTranslationCrcValid            = false;
+    requestMachine->_jsonMetadataTranslatedFileName.clear();
+    requestMachine->_jsonMetadataTranslatedCached       = false;
+
+    // The translation of unchanged metadata comes from the cache, no need to download the translation or translate again
+    if (!uri.isEmpty() && requestMachine->_jsonMetadataCrcValid && !requestMachine->_jsonMetadataFileName.isEmpty()) {
+        const QString translatedFileTag = ComponentInformationManager::_getTranslatedFileCacheTag(requestMachine->_jsonMetadataCacheFileTag, QLocale::system().name());
+        const QString cachedFile = requestMachine->_compMgr->fileCache().access(translatedFileTag);
+        if (!cachedFile.isEmpty()) {
+            qCDebug(ComponentInformationManagerLog) << "Using cached translation" << cachedFile;
+            requestMachine->_jsonMetadataTranslatedFileName = cachedFile;
+            requestMachine->_jsonMetadataTranslatedCached   = true;
+            requestMachine->advance();
+            return;
+        }
+    }
+
+    requestMachine->_requestFile(fileTag, requestMachine->_jsonTranslationCrcValid, uri, requestMachine->_jsonTranslationFileName, true /* isTranslation */);
 }
 
 void RequestMetaDataTypeStateMachine::_stateRequestTranslate(StateMachine* stateMachine)
 {
     RequestMetaDataTypeStateMachine*    requestMachine  = static_cast<RequestMetaDataTypeStateMachine*>(stateMachine);
-    requestMachine->_jsonMetadataTranslatedFileName = "";
-    if (requestMachine->_jsonTranslationFileName.isEmpty()) {
+    if (requestMachine->_jsonMetadataTranslatedCached || requestMachine->_jsonTranslationFileName.isEmpty() || requestMachine->_jsonMetadataFileName.isEmpty()) {
+        requestMachine->advance();
+        return;
+    }
+
+    connect(requestMachine->_translation, &ComponentInformationTranslation::downloadComplete,
+            requestMachine, &RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete);
+    if (!requestMachine->_translation->downloadAndTranslate(requestMachine->_jsonTranslationFileName,
+                                                            requestMachine->_jsonMetadataFileName,
+                                                            ComponentInformationManager::cachedFileMaxAgeSec)) {
+        disconnect(requestMachine->_translation, &ComponentInformationTranslation::downloadComplete,
+                   requestMachine, &RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete);
+        qCDebug(ComponentInformationManagerLog) << "downloadAndTranslate() failed";
         requestMachine->advance();
-    } else {
-        connect(requestMachine->_compMgr->translation(), &ComponentInformationTranslation::downloadComplete,
-                requestMachine, &RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete);
-        if (!requestMachine->_compMgr->translation()->downloadAndTranslate(requestMachine->_jsonTranslationFileName,
-                                                                           requestMachine->_jsonMetadataFileName,
-                                                                           ComponentInformationManager::cachedFileMaxAgeSec)) {
-            disconnect(requestMachine->_compMgr->translation(), &ComponentInformationTranslation::downloadComplete,
-                       requestMachine, &RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete);
-            qCDebug(ComponentInformationManagerLog) << "downloadAndTranslate() failed";
-            requestMachine->advance();
-        }
     }
 }
 
 void RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete(QString translatedJsonTempFile, QString errorMsg)
 {
-    disconnect(_compMgr->translation(), &ComponentInformationTranslation::downloadComplete,
+    disconnect(_translation, &ComponentInformationTranslation::downloadComplete,
                this, &RequestMetaDataTypeStateMachine::_downloadAndTranslationComplete);
     _jsonMetadataTranslatedFileName = translatedJsonTempFile;
     if (!errorMsg.isEmpty()) {
         qCWarning(ComponentInformationManagerLog) << "Metadata translation failed:" << errorMsg;
+    } else if (_jsonMetadataCrcValid && !translatedJsonTempFile.isEmpty()) {
+        // cache the translated file (this will move/remove the temp file as well)
+        const QString fileTag = ComponentInformationManager::_getTranslatedFileCacheTag(_jsonMetadataCacheFileTag, QLocale::system().name());
+        const QString cachedFile = _compMgr->fileCache().insert(fileTag, translatedJsonTempFile);
+        if (!cachedFile.isEmpty()) {
+            _jsonMetadataTranslatedFileName = cachedFile;
+            _jsonMetadataTranslatedCached = true;
+        }
     }
     advance();
 }
@@ -527,14 +662,16 @@ void RequestMetaDataTypeStateMachine::_stateRequestComplete(StateMachine* stateM
         compInfo->setJson(requestMachine->_jsonMetadataFileName);
     } else {
         compInfo->setJson(requestMachine->_jsonMetadataTranslatedFileName);
-        QFile(requestMachine->_jsonMetadataTranslatedFileName).remove();
+        if (!requestMachine->_jsonMetadataTranslatedCached) {
+            QFile(requestMachine->_jsonMetadataTranslatedFileName).remove();
+        }
     }
 
     // if we don't have a CRC we didn't cache the file and we need to delete it
     if (!requestMachine->_jsonMetadataCrcValid && !requestMachine->_jsonMetadataFileName.isEmpty()) {
         QFile(requestMachine->_jsonMetadataFileName).remove();
     }
-    if (!requestMachine->_jsonMetadataCrcValid && !requestMachine->_jsonTranslationFileName.isEmpty()) {
+    if (!requestMachine->_jsonTranslationCrcValid && !requestMachine->_jsonTranslationFileName.isEmpty()) {
         QFile(requestMachine->_jsonTranslationFileName).remove();
     }
 
@@ -16,6 +16,8 @@
 #include "ComponentInformationTranslation.h"
 
 #include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QSet>
 
 Q_DECLARE_LOGGING_CATEGORY(ComponentInformationManagerLog)
 
@@ -25,6 +27,11 @@ class CompInfo;
 class CompInfoParam;
 class CompInfoGeneral;
 
+/// Requests the metadata json for one metadata type: uri, download (MAVLink FTP or http), translation.
+///
+/// Each type has its own machine and http download object, so the types can be requested at the same time.
+/// Decompression of downloaded files and translation are done on a worker thread, the json itself is loaded by
+/// CompInfo::setJson on the gui thread since it creates the metadata objects.
 class RequestMetaDataTypeStateMachine : public StateMachine
 {
     Q_OBJECT
@@ -44,9 +51,10 @@ public:
 private slots:
     void    _ftpDownloadComplete                (const QString& file, const QString& errorMsg);
     void    _ftpDownloadProgress                (float progress);
+    void    _ftpCalcFileCrc32Complete           (const QString& fromURI, uint32_t crc, const QString& errorMsg);
     void    _httpDownloadComplete               (QString remoteFile, QString localFile, QString errorMsg);
-    QString _downloadCompleteJsonWorker         (const QString& jsonFileName);
-    void _downloadAndTranslationComplete(QString translatedJsonTempFile, QString errorMsg);
+    void    _inflateComplete                    (void);
+    void    _downloadAndTranslationComplete     (QString translatedJsonTempFile, QString errorMsg);
 
 private:
     static void _stateRequestCompInfo           (StateMachine* stateMachine);
@@ -58,19 +66,31 @@ private:
     static void _stateRequestComplete           (StateMachine* stateMachine);
     static bool _uriIsMAVLinkFTP                (const QString& uri);
 
-    void _requestFile(const QString& cacheFileTag, bool crcValid, const QString& uri, QString& outputFileName);
+    void _requestFile           (const QString& cacheFileTag, bool& crcValid, const QString& uri, QString& outputFileName, bool isTranslation = false);
+    void _requestFileWorker     (void);
+    void _processDownloadedFile (const QString& fileName);
+    void _storeDownloadedFile   (const QString& fileName);
 
     ComponentInformationManager*    _compMgr                    = nullptr;
     CompInfo*                       _compInfo                   = nullptr;
+    QGCCachedFileDownload*          _cachedFileDownload         = nullptr;
+    ComponentInformationTranslation* _translation               = nullptr;
+    QFutureWatcher<QString>         _inflateWatcher;
     QString                         _jsonMetadataFileName;
     QString                         _jsonMetadataTranslatedFileName;
+    bool                            _jsonMetadataTranslatedCached = false;  ///< _jsonMetadataTranslatedFileName is owned by the file cache
     bool                            _jsonMetadataCrcValid       = false;
+    QString                         _jsonMetadataCacheFileTag;  ///< Cache tag of the metadata json, only meaningful if _jsonMetadataCrcValid
     QString                         _jsonTranslationFileName;
     bool                            _jsonTranslationCrcValid    = false;
 
     QString*                        _currentFileName            = nullptr;
     QString                         _currentCacheFileTag;
     bool                            _currentFileValidCrc        = false;
+    bool*                           _currentCrcValid            = nullptr;
+    QString                         _currentURI;
+    bool                            _currentIsTranslation       = false;
+    QString                         _ftpDownloadFile;           ///< Local path of the FTP download, FTPManager signals are shared with other downloads
 
     QElapsedTimer                   _downloadStartTime;
 
@@ -78,6 +98,11 @@ private:
     static const int      _cStates;
 };
 
+/// Requests the metadata for all supported types of the autopilot component.
+///
+/// General metadata is requested first since it provides the uris for the other types. All other supported types
+/// are then requested at the same time. The request completion callback is called as soon as the types needed for
+/// the initial connection (see _isRequiredType) are available, the remaining types complete in the background.
 class ComponentInformationManager : public StateMachine
 {
     Q_OBJECT
@@ -99,7 +124,6 @@ public:
     const StateFn*  rgStates    (void) const final;
 
     ComponentInformationCache& fileCache() { return _fileCache; }
-    ComponentInformationTranslation* translation() { return _translation; }
 
     float progress() const;
 
@@ -109,26 +133,31 @@ signals:
     void progressUpdate(float progress);
 
 private:
-    void _stateRequestCompInfoComplete  (void);
+    void _requestType                   (COMP_METADATA_TYPE type);
+    void _requestTypeComplete           (COMP_METADATA_TYPE type);
+    bool _requiredTypesComplete         (void) const;
     bool _isCompTypeSupported           (COMP_METADATA_TYPE type);
     void _updateAllUri                  ();
 
+    static bool _isRequiredType(COMP_METADATA_TYPE type);
+
     static QString _getFileCacheTag(int compInfoType, uint32_t crc, bool isTranslation);
+    static QString _getTranslatedFileCacheTag(const QString& metadataFileCacheTag, const QString& locale);
 
     static void _stateRequestCompInfoGeneral        (StateMachine* stateMachine);
     static void _stateRequestCompInfoGeneralComplete(StateMachine* stateMachine);
-    static void _stateRequestCompInfoParam          (StateMachine* stateMachine);
-    static void _stateRequestCompInfoEvents         (StateMachine* stateMachine);
-    static void _stateRequestCompInfoActuators      (StateMachine* stateMachine);
+    static void _stateRequestCompInfoMetaData       (StateMachine* stateMachine);
     static void _stateRequestAllCompInfoComplete    (StateMachine* stateMachine);
 
     Vehicle*                        _vehicle                    = nullptr;
-    RequestMetaDataTypeStateMachine _requestTypeStateMachine;
     RequestAllCompleteFn            _requestAllCompleteFn       = nullptr;
     void*                           _requestAllCompleteFnData   = nullptr;
-    QGCCachedFileDownload*          _cachedFileDownload         = nullptr;
     ComponentInformationCache&      _fileCache;
-    ComponentInformationTranslation* _translation               = nullptr;
+    int                             _completedTypeCount         = 0;    ///< Requested or skipped types which are complete
+    bool                            _startingTypeRequests       = false;
+
+    QMap<COMP_METADATA_TYPE, RequestMetaDataTypeStateMachine*>      _requestTypeStateMachines;
+    QSet<COMP_METADATA_TYPE>                                        _activeTypes;
 
     QMap<uint8_t /* compId */, QMap<COMP_METADATA_TYPE, CompInfo*>> _compInfoMap;
 
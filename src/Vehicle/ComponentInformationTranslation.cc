@@ -16,6 +16,8 @@
 #include <QDir>
 #include <QJsonArray>
 #include <QXmlStreamReader>
+#include <QTemporaryFile>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(ComponentInformationTranslationLog, "ComponentInformationTranslationLog")
 
@@ -23,6 +25,7 @@ ComponentInformationTranslation::ComponentInformationTranslation(QObject* parent
                                                                  QGCCachedFileDownload* cachedFileDownload)
     : QObject(parent), _cachedFileDownload(cachedFileDownload)
 {
+    connect(&_translateWatcher, &QFutureWatcherBase::finished, this, &ComponentInformationTranslation::onTranslateCompleted);
 }
 
 bool ComponentInformationTranslation::downloadAndTranslate(const QString& summaryJsonFile,
@@ -74,27 +77,48 @@ void ComponentInformationTranslation::onDownloadCompleted(QString remoteFile, QS
 {
     disconnect(_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this, &ComponentInformationTranslation::onDownloadCompleted);
 
+    if (!errorMsg.isEmpty()) {
+        emit downloadComplete(QString(), errorMsg);
+        return;
+    }
+
+    _translateWatcher.setFuture(QtConcurrent::run(&ComponentInformationTranslation::translateWorker, remoteFile, localFile, _toTranslateJsonFile));
+}
+
+void ComponentInformationTranslation::onTranslateCompleted(void)
+{
+    TranslateResult_t result = _translateWatcher.result();
+    emit downloadComplete(result.translatedJsonFile, result.errorMsg);
+}
+
+ComponentInformationTranslation::TranslateResult_t ComponentInformationTranslation::translateWorker(const QString& remoteFile, const QString& localFile, const QString& toTranslateJsonFile)
+{
+    TranslateResult_t result;
+
     QString tsFileName = localFile;
     bool deleteFile = false;
-    if (errorMsg.isEmpty()) {
 
-        // Decompress if needed
-        if (localFile.endsWith(".lzma", Qt::CaseInsensitive) || localFile.endsWith(".xz", Qt::CaseInsensitive)) {
-            tsFileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("qgc_translation_file_decompressed.ts");
-            if (QGCLZMA::inflateLZMAFile(localFile, tsFileName)) {
-                deleteFile = true;
-            } else {
-                errorMsg = "Inflate of compressed json failed, " + remoteFile;
-            }
+    // Decompress if needed
+    if (localFile.endsWith(".lzma", Qt::CaseInsensitive) || localFile.endsWith(".xz", Qt::CaseInsensitive)) {
+        // Unique name since several translations may be in progress at the same time
+        QTemporaryFile decompressedFile(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("qgc_translation_file_decompressed_XXXXXX.ts"));
+        decompressedFile.setAutoRemove(false);
+        if (decompressedFile.open()) {
+            tsFileName = decompressedFile.fileName();
+            decompressedFile.close();
+        }
+        if (QGCLZMA::inflateLZMAFile(localFile, tsFileName)) {
+            deleteFile = true;
+        } else {
+            result.errorMsg = "Inflate of compressed json failed, " + remoteFile;
         }
     }
 
     // Translate json file to new temp file
-    QString translatedJsonFilename;
-    if (errorMsg.isEmpty()) {
-        translatedJsonFilename = translateJsonUsingTS(_toTranslateJsonFile, tsFileName);
-        if (translatedJsonFilename.isEmpty()) {
-            errorMsg = "Failed to translate json file";
+    if (result.errorMsg.isEmpty()) {
+        result.translatedJsonFile = translateJsonUsingTS(toTranslateJsonFile, tsFileName);
+        if (result.translatedJsonFile.isEmpty()) {
+            result.errorMsg = "Failed to translate json file";
         }
     }
 
@@ -102,7 +126,7 @@ void ComponentInformationTranslation::onDownloadCompleted(QString remoteFile, QS
         QFile(localFile).remove();
     }
 
-    emit downloadComplete(translatedJsonFilename, errorMsg);
+    return result;
 }
 
 QString ComponentInformationTranslation::translateJsonUsingTS(const QString &toTranslateJsonFile, const QString &tsFile)
@@ -199,13 +223,13 @@ QString ComponentInformationTranslation::translateJsonUsingTS(const QString &toT
     jsonDoc.setObject(translate(translationObj, translations, jsonDoc.object()));
 
     // Write to file
-    QString translatedFileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("qgc_translated_metadata.json");
-
-    QFile translatedFile(translatedFileName);
-    if (!translatedFile.open(QFile::WriteOnly|QFile::Truncate)) {
+    QTemporaryFile translatedFile(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("qgc_translated_metadata_XXXXXX.json"));
+    translatedFile.setAutoRemove(false);
+    if (!translatedFile.open()) {
         errorString = tr("File open failed: file:error %1 %2").arg(translatedFile.fileName()).arg(translatedFile.errorString());
         return "";
     }
+    const QString translatedFileName = translatedFile.fileName();
     translatedFile.write(jsonDoc.toJson());
     translatedFile.close();
 
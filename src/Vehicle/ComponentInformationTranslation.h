@@ -11,6 +11,7 @@
 
 #include <QLoggingCategory>
 #include <QJsonDocument>
+#include <QFutureWatcher>
 
 #include "QGCLoggingCategory.h"
 #include "QGCCachedFileDownload.h"
@@ -25,6 +26,7 @@ public:
     ComponentInformationTranslation(QObject* parent, QGCCachedFileDownload* cachedFileDownload);
 
     /// Download translation file according to the currently set locale and translate the json file.
+    /// The translation itself runs on a worker thread.
     /// emits downloadComplete() when done (with a temporary file that should be deleted)
     ///     @param summaryJsonFile json file with url's to translation files (.ts)
     ///     @param toTranslateJsonFile json file to be translated
@@ -32,14 +34,25 @@ public:
     /// @return true: Asynchronous download has started, false: Download initialization failed
     bool downloadAndTranslate(const QString& summaryJsonFile, const QString& toTranslateJsonFile, int maxCacheAgeSec);
 
-    QString translateJsonUsingTS(const QString& toTranslateJsonFile, const QString& tsFile);
+    /// Thread safe
+    ///     @return Name of a new temporary file with the translated json, empty on failure
+    static QString translateJsonUsingTS(const QString& toTranslateJsonFile, const QString& tsFile);
 
 signals:
     void downloadComplete(QString translatedJsonTempFile, QString errorMsg);
 
 private slots:
     void onDownloadCompleted(QString remoteFile, QString localFile, QString errorMsg);
+    void onTranslateCompleted(void);
+
 private:
+    typedef struct {
+        QString translatedJsonFile;
+        QString errorMsg;
+    } TranslateResult_t;
+
+    static TranslateResult_t translateWorker(const QString& remoteFile, const QString& localFile, const QString& toTranslateJsonFile);
+
     QString getUrlFromSummaryJson(const QString& summaryJsonFile, const QString& locale);
 
     static QJsonObject translate(const QJsonObject& translationObj, const QHash<QString, QString>& translations, QJsonObject doc);
@@ -52,4 +65,5 @@ private:
 
     QGCCachedFileDownload* _cachedFileDownload = nullptr;
     QString _toTranslateJsonFile;
+    QFutureWatcher<TranslateResult_t> _translateWatcher;
 };
@@ -94,6 +94,7 @@ void EventHandler::handleEvents(const mavlink_message_t& message)
 void EventHandler::setMetadata(const QString &metadataJsonFileName)
 {
     if (_parser.loadDefinitionsFile(metadataJsonFileName.toStdString())) {
+        _buildModeGroups();
         if (_parser.hasDefinitions()) {
             // do we have queued events?
             for (const auto& event : _pendingEvents) {
@@ -106,13 +107,14 @@ void EventHandler::setMetadata(const QString &metadataJsonFileName)
     }
 }
 
-int EventHandler::getModeGroup(int32_t customMode)
+void EventHandler::_buildModeGroups()
 {
-    events::parser::Parser::NavigationModeGroups groups = _parser.navigationModeGroups(_compid);
-    for (auto groupIter : groups.groups) {
-        if (groupIter.second.find(customMode) != groupIter.second.end()) {
-            return groupIter.first;
+    // The parser builds the groups from the definitions on each call, which is too slow for every health report update
+    _modeGroups.clear();
+    const events::parser::Parser::NavigationModeGroups groups = _parser.navigationModeGroups(_compid);
+    for (const auto& groupIter : groups.groups) {
+        for (const auto customMode : groupIter.second) {
+            _modeGroups.insert(customMode, groupIter.first);
         }
     }
-    return -1;
 }
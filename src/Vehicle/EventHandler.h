@@ -12,6 +12,7 @@
 #include <QString>
 #include <QVector>
 #include <QTimer>
+#include <QHash>
 
 #include <functional>
 
@@ -40,7 +41,8 @@ public:
     const events::HealthAndArmingChecks::Results& healthAndArmingCheckResults() const { return _healthAndArmingChecks.results(); }
     bool healthAndArmingCheckResultsValid() const { return _healthAndArmingChecksValid; }
 
-    int getModeGroup(int32_t customMode);
+    /// @return mode group of customMode from the metadata, -1 if unknown. Looked up in a table built when the metadata is loaded.
+    int getModeGroup(int32_t customMode) const { return _modeGroups.value(customMode, -1); }
 
     bool healthAndArmingChecksSupported() const {
         const auto& protocols = _parser.supportedProtocols(_compid);
@@ -52,6 +54,7 @@ signals:
 
 private:
     void gotEvent(const mavlink_event_t& event);
+    void _buildModeGroups();
 
     events::ReceiveProtocol* _protocol{nullptr};
     QTimer _timer;
@@ -59,6 +62,7 @@ private:
     events::HealthAndArmingChecks _healthAndArmingChecks;
     bool _healthAndArmingChecksValid{false};
     QVector<mavlink_event_t> _pendingEvents; ///< stores incoming events until we have the metadata loaded
+    QHash<int32_t, int> _modeGroups; ///< custom mode -> mode group
     handle_event_f _handleEventCB;
     send_request_event_message_f _sendRequestCB;
     const uint8_t _compid;
@@ -16,6 +16,7 @@
 #include <QFile>
 #include <QDir>
 #include <string>
+#include <cstring>
 
 QGC_LOGGING_CATEGORY(FTPManagerLog, "FTPManagerLog")
 
@@ -34,15 +35,110 @@ FTPManager::FTPManager(Vehicle* vehicle)
     Q_ASSERT(sizeof(MavlinkFTP::RequestHeader) == 12);
 }
 
-bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName, bool checksize)
+bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName, bool checksize, Priority priority)
 {
-    qCDebug(FTPManagerLog) << "download fromURI:" << fromURI << "to:" << toDir << "fromCompId:" << fromCompId;
+    qCDebug(FTPManagerLog) << "download fromURI:" << fromURI << "to:" << toDir << "fromCompId:" << fromCompId << "priority:" << priority;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot download. Already in another operation";
+    QString parsedURI;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, parsedURI, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    QueuedOperation_t operation;
+    operation.download      = true;
+    operation.priority      = priority;
+    operation.fromCompId    = fromCompId;
+    operation.fromURI       = fromURI;
+    operation.toDir         = toDir;
+    operation.fileName      = fileName;
+    operation.checksize     = checksize;
+    _queueOperation(operation);
+
+    return true;
+}
+
+bool FTPManager::calcFileCrc32(uint8_t fromCompId, const QString& fromURI, Priority priority)
+{
+    qCDebug(FTPManagerLog) << "calcFileCrc32 fromURI:" << fromURI << "fromCompId:" << fromCompId << "priority:" << priority;
+
+    QString parsedURI;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, parsedURI, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
         return false;
     }
 
+    QueuedOperation_t operation;
+    operation.download      = false;
+    operation.priority      = priority;
+    operation.fromCompId    = fromCompId;
+    operation.fromURI       = fromURI;
+    operation.checksize     = false;
+    _queueOperation(operation);
+
+    return true;
+}
+
+void FTPManager::_queueOperation(const QueuedOperation_t& operation)
+{
+    // Keep the queue in priority order, first come first served within a priority
+    int index = _operationQueue.count();
+    while (index > 0 && _operationQueue[index - 1].priority < operation.priority) {
+        index--;
+    }
+    _operationQueue.insert(index, operation);
+
+    if (_rgStateMachine.isEmpty()) {
+        _startNextOperation();
+    } else {
+        qCDebug(FTPManagerLog) << "Operation queued behind operation in progress" << operation.fromURI << "queued:" << _operationQueue.count();
+    }
+}
+
+void FTPManager::_startNextOperation(void)
+{
+    while (_rgStateMachine.isEmpty() && !_operationQueue.isEmpty()) {
+        QueuedOperation_t operation = _operationQueue.takeFirst();
+
+        if (operation.download) {
+            if (!_startDownload(operation)) {
+                emit downloadComplete(downloadFilePath(operation.fromURI, operation.toDir, operation.fileName), tr("Download failed"));
+            }
+        } else {
+            static const StateFunctions_t rgCalcFileCrc32StateMachine[] = {
+                { &FTPManager::_calcFileCrc32Begin,     &FTPManager::_calcFileCrc32AckOrNak,    &FTPManager::_calcFileCrc32Timeout },
+            };
+            if (!_parseURI(operation.fromCompId, operation.fromURI, _crcPathOnVehicle, _ftpCompId)) {
+                emit calcFileCrc32Complete(operation.fromURI, 0, tr("CRC32 request failed"));
+                continue;
+            }
+            for (size_t i=0; i<sizeof(rgCalcFileCrc32StateMachine)/sizeof(rgCalcFileCrc32StateMachine[0]); i++) {
+                _rgStateMachine.append(rgCalcFileCrc32StateMachine[i]);
+            }
+            _crcURI         = operation.fromURI;
+            _crcRetryCount  = 0;
+            _startStateMachine();
+        }
+    }
+}
+
+QString FTPManager::downloadFilePath(const QString& fromURI, const QString& toDir, const QString& fileName)
+{
+    return QDir(toDir).absoluteFilePath(fileName.isEmpty() ? fromURI.section('/', -1) : fileName);
+}
+
+QString FTPManager::currentDownloadFilePath() const
+{
+    if (_rgStateMachine.isEmpty() || !_crcURI.isEmpty()) {
+        return QString();
+    }
+    return _downloadState.toDir.absoluteFilePath(_downloadState.fileName);
+}
+
+bool FTPManager::_startDownload(const QueuedOperation_t& operation)
+{
     static const StateFunctions_t rgDownloadStateMachine[] = {
         { &FTPManager::_openFileROBegin,            &FTPManager::_openFileROAckOrNak,           &FTPManager::_openFileROTimeout },
         { &FTPManager::_burstReadFileBegin,         &FTPManager::_burstReadFileAckOrNak,        &FTPManager::_burstReadFileTimeout },
@@ -50,19 +146,20 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
         { &FTPManager::_resetSessionsBegin,         &FTPManager::_resetSessionsAckOrNak,        &FTPManager::_resetSessionsTimeout },
         { &FTPManager::_downloadCompleteNoError,    nullptr,                                    nullptr },
     };
-    for (size_t i=0; i<sizeof(rgDownloadStateMachine)/sizeof(rgDownloadStateMachine[0]); i++) {
-        _rgStateMachine.append(rgDownloadStateMachine[i]);
-    }
 
     _downloadState.reset();
-    _downloadState.toDir.setPath(toDir);
-    _downloadState.checksize = checksize;
+    _downloadState.toDir.setPath(operation.toDir);
+    _downloadState.checksize = operation.checksize;
 
-    if (!_parseURI(fromCompId, fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
+    if (!_parseURI(operation.fromCompId, operation.fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
         qCWarning(FTPManagerLog) << "_parseURI failed";
         return false;
     }
 
+    for (size_t i=0; i<sizeof(rgDownloadStateMachine)/sizeof(rgDownloadStateMachine[0]); i++) {
+        _rgStateMachine.append(rgDownloadStateMachine[i]);
+    }
+
     // We need to strip off the file name from the fully qualified path. We can't use the usual QDir
     // routines because this path does not exist locally.
     int lastDirSlashIndex;
@@ -73,10 +170,10 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
     }
     lastDirSlashIndex++; // move past slash
 
-    if (fileName.isEmpty()) {
+    if (operation.fileName.isEmpty()) {
         _downloadState.fileName = _downloadState.fullPathOnVehicle.right(_downloadState.fullPathOnVehicle.size() - lastDirSlashIndex);
     } else {
-        _downloadState.fileName = fileName;
+        _downloadState.fileName = operation.fileName;
     }
 
     qCDebug(FTPManagerLog) << "_downloadState.fullPathOnVehicle:_downloadState.fileName" << _downloadState.fullPathOnVehicle << _downloadState.fileName;
@@ -88,7 +185,7 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
 
 void FTPManager::cancel()
 {
-    if (!_downloadState.inProgress()) {
+    if (_rgStateMachine.isEmpty() || !_crcURI.isEmpty() || !_downloadState.inProgress()) {
         return;
     }
 
@@ -167,6 +264,8 @@ void FTPManager::_downloadComplete(const QString& errorMsg)
     }
 
     emit downloadComplete(downloadFilePath, errorMsg);
+
+    _startNextOperation();
 }
 
 void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
@@ -375,6 +474,7 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
             return;
         }
         _downloadState.bytesWritten += ackOrNak->hdr.size;
+        emit downloadDataReceived(ackOrNak->hdr.offset, QByteArray(reinterpret_cast<const char*>(ackOrNak->data), ackOrNak->hdr.size));
         _downloadState.expectedOffset = ackOrNak->hdr.offset + ackOrNak->hdr.size;
 
         if (ackOrNak->hdr.burstComplete) {
@@ -508,6 +608,7 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
             return;
         }
         _downloadState.bytesWritten += ackOrNak->hdr.size;
+        emit downloadDataReceived(ackOrNak->hdr.offset, QByteArray(reinterpret_cast<const char*>(ackOrNak->data), ackOrNak->hdr.size));
 
         MissingData_t& missingData = _downloadState.rgMissingData.first();
         missingData.offset += ackOrNak->hdr.size;
@@ -592,6 +693,74 @@ void FTPManager::_resetSessionsTimeout(void)
     _downloadComplete(QString());
 }
 
+void FTPManager::_calcFileCrc32Begin(void)
+{
+    MavlinkFTP::Request request{};
+    request.hdr.session = 0;
+    request.hdr.opcode  = MavlinkFTP::kCmdCalcFileCRC32;
+    request.hdr.offset  = 0;
+    _fillRequestDataWithString(&request, _crcPathOnVehicle);
+    _sendRequestExpectAck(&request);
+}
+
+void FTPManager::_calcFileCrc32AckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+
+    if (requestOpCode != MavlinkFTP::kCmdCalcFileCRC32) {
+        qCDebug(FTPManagerLog) << "_calcFileCrc32AckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_calcFileCrc32AckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        return;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        if (ackOrNak->hdr.size != sizeof(uint32_t)) {
+            qCDebug(FTPManagerLog) << "_calcFileCrc32AckOrNak: Ack ack->hdr.size != sizeof(uint32_t)" << ackOrNak->hdr.size;
+            _calcFileCrc32Complete(0, tr("CRC32 request failed"));
+            return;
+        }
+        uint32_t crc;
+        memcpy(&crc, ackOrNak->data, sizeof(crc));
+        qCDebug(FTPManagerLog) << "_calcFileCrc32AckOrNak: Ack crc" << QString::number(crc, 16);
+        _calcFileCrc32Complete(crc, QString());
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        qCDebug(FTPManagerLog) << "_calcFileCrc32AckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _calcFileCrc32Complete(0, tr("CRC32 request failed") + ": " + _errorMsgFromNak(ackOrNak));
+    }
+}
+
+void FTPManager::_calcFileCrc32Timeout(void)
+{
+    if (++_crcRetryCount > _maxRetry) {
+        qCDebug(FTPManagerLog) << QString("_calcFileCrc32Timeout retries exceeded");
+        _calcFileCrc32Complete(0, tr("CRC32 request failed"));
+    } else {
+        // Must use same sequence number as previous request
+        qCDebug(FTPManagerLog) << QString("_calcFileCrc32Timeout: retrying - retryCount(%1)").arg(_crcRetryCount);
+        _expectedIncomingSeqNumber -= 2;
+        _calcFileCrc32Begin();
+    }
+}
+
+void FTPManager::_calcFileCrc32Complete(uint32_t crc, const QString& errorMsg)
+{
+    QString fromURI = _crcURI;
+
+    _ackOrNakTimeoutTimer.stop();
+    _rgStateMachine.clear();
+    _currentStateMachineIndex = -1;
+    _crcURI.clear();
+
+    emit calcFileCrc32Complete(fromURI, crc, errorMsg);
+
+    _startNextOperation();
+}
+
 void FTPManager::_emitErrorMessage(const QString& msg)
 {
     qCDebug(FTPManagerLog) << "Error:" << msg;
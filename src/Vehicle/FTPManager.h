@@ -31,6 +31,14 @@ class FTPManager : public QObject
 public:
     FTPManager(Vehicle* vehicle);
 
+    /// MAVLink FTP servers only provide a single session, so operations are run one at a time. Operations requested
+    /// while another one is in progress are queued and run in priority order, then in the order they were requested.
+    enum Priority {
+        PriorityLow,        ///< Background transfers, such as camera definition files
+        PriorityNormal,
+        PriorityHigh,       ///< Transfers which hold up the initial connection, such as parameters and component metadata
+    };
+
 	/// Downloads the specified file.
     ///     @param fromCompId Component id of the component to download from. If fromCompId is MAV_COMP_ID_ALL, then MAV_COMP_ID_AUTOPILOT1 is used.
     ///     @param fromURI    File to download from component, fully qualified path. May be in the format "mftp://[;comp=<id>]..." where the component id
@@ -42,18 +50,43 @@ public:
     ///                       and the indicated filesize from MAVFTP fileopen response is ignored.
     ///                       This is used for the APM parameter download where the filesize is wrong due to
     ///                       a dynamic file creation on the vehicle.
-    /// @return true: download has started, false: error, no download
+    ///     @param priority   (optional) Queue priority if another operation is in progress
+    /// @return true: download has started or is queued, false: error, no download
     /// Signals downloadComplete, commandError, commandProgress
-    bool download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName="", bool checksize = true);
+    bool download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName="", bool checksize = true, Priority priority = PriorityNormal);
+
+    /// Requests the CRC32 the vehicle calculates for a file. Used to check whether a cached copy of a file is still
+    /// up to date without downloading it.
+    ///     @param fromCompId Component id of the component the file is on, see download
+    ///     @param fromURI    File on component, see download
+    /// @return true: request has started or is queued, false: error, no request
+    /// Signals calcFileCrc32Complete
+    bool calcFileCrc32(uint8_t fromCompId, const QString& fromURI, Priority priority = PriorityNormal);
 
     /// Cancel the current operation
     /// This will emit downloadComplete() when done, and if there's currently a download in progress
     void cancel();
 
+    /// @return Local file path a download is saved to, the same path downloadComplete signals
+    static QString downloadFilePath(const QString& fromURI, const QString& toDir, const QString& fileName = QString());
+
+    /// @return Local file path of the download in progress, empty if no download is in progress. Since downloads
+    /// are queued, listeners of downloadDataReceived and commandProgress use this to pick out their own download.
+    QString currentDownloadFilePath() const;
+
     static const char* mavlinkFTPScheme;
 
 signals:
     void downloadComplete(const QString& file, const QString& errorMsg);
+
+    /// Signalled when a calcFileCrc32 request completes
+    ///     @param fromURI  URI as passed to calcFileCrc32
+    ///     @param errorMsg Error message, empty if no error
+    void calcFileCrc32Complete(const QString& fromURI, uint32_t crc, const QString& errorMsg);
+
+    /// Signalled for each block of file data as it is received during a download. Blocks may arrive out of order
+    /// when missing blocks are filled in.
+    void downloadDataReceived(uint32_t offset, const QByteArray& data);
     
     // Signals associated with all commands
     
@@ -85,6 +118,16 @@ private:
         uint32_t cBytesMissing;
     };
 
+    struct QueuedOperation_t {
+        bool        download;           ///< false: CRC32 calculation
+        Priority    priority;
+        uint8_t     fromCompId;
+        QString     fromURI;
+        QString     toDir;
+        QString     fileName;
+        bool        checksize;
+    };
+
     struct DownloadState_t {
         uint8_t                 sessionId;
         uint32_t                expectedOffset;         ///< offset which should be coming next
@@ -129,6 +172,13 @@ private:
     void    _resetSessionsBegin         (void);
     void    _resetSessionsAckOrNak      (const MavlinkFTP::Request* ackOrNak);
     void    _resetSessionsTimeout       (void);
+    void    _calcFileCrc32Begin         (void);
+    void    _calcFileCrc32AckOrNak      (const MavlinkFTP::Request* ackOrNak);
+    void    _calcFileCrc32Timeout       (void);
+    void    _calcFileCrc32Complete      (uint32_t crc, const QString& errorMsg);
+    void    _queueOperation             (const QueuedOperation_t& operation);
+    void    _startNextOperation         (void);
+    bool    _startDownload              (const QueuedOperation_t& operation);
     QString _errorMsgFromNak            (const MavlinkFTP::Request* nak);
     void    _sendRequestExpectAck       (MavlinkFTP::Request* request);
     void    _downloadCompleteNoError    (void) { _downloadComplete(QString()); }
@@ -148,6 +198,10 @@ private:
     uint8_t                 _ftpCompId = MAV_COMP_ID_AUTOPILOT1;
     QList<StateFunctions_t> _rgStateMachine;
     DownloadState_t         _downloadState;
+    QList<QueuedOperation_t> _operationQueue;
+    QString                 _crcURI;                    ///< URI of the calcFileCrc32 request in progress
+    QString                 _crcPathOnVehicle;
+    int                     _crcRetryCount              = 0;
     QTimer                  _ackOrNakTimeoutTimer;
     int                     _currentStateMachineIndex   = -1;
     uint16_t                _expectedIncomingSeqNumber  = 0;
@@ -120,6 +120,41 @@ void FTPManagerTest::_testLostPackets(void)
     _disconnectMockLink();
 }
 
+void FTPManagerTest::_testQueuedDownloads(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     toDir       = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    QString     firstFile   = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(1024);
+    QString     lowFile     = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(2048);
+    QString     highFile    = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(3072);
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    // Downloads requested while one is in progress are queued and run in priority order
+    QVERIFY(ftpManager->download(MAV_COMP_ID_AUTOPILOT1, firstFile, toDir));
+    QVERIFY(ftpManager->download(MAV_COMP_ID_AUTOPILOT1, lowFile, toDir, QString(), true, FTPManager::PriorityLow));
+    QVERIFY(ftpManager->download(MAV_COMP_ID_AUTOPILOT1, highFile, toDir, QString(), true, FTPManager::PriorityHigh));
+
+    for (int i=0; i<3 && spyDownloadComplete.count() < 3; i++) {
+        spyDownloadComplete.wait(10000);
+    }
+    QCOMPARE(spyDownloadComplete.count(), 3);
+
+    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    const QStringList rgExpectedFiles = { firstFile, highFile, lowFile };
+    const QList<int> rgExpectedSizes = { 1024, 3072, 2048 };
+    for (int i=0; i<rgExpectedFiles.count(); i++) {
+        QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+        QVERIFY(arguments[1].toString().isEmpty());
+        QCOMPARE(arguments[0].toString(), FTPManager::downloadFilePath(rgExpectedFiles[i], toDir));
+        _verifyFileSizeAndDelete(arguments[0].toString(), rgExpectedSizes[i]);
+    }
+
+    _disconnectMockLink();
+}
+
 void FTPManagerTest::_verifyFileSizeAndDelete(const QString& filename, int expectedSize)
 {
     QFileInfo fileInfo(filename);
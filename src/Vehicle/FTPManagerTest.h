@@ -17,6 +17,7 @@ class FTPManagerTest : public UnitTest
 
 private slots:
     void _testLostPackets           (void);
+    void _testQueuedDownloads       (void);
 
     // Overrides from UnitTest
     void cleanup(void) override;
@@ -10,6 +10,8 @@
 #include "HealthAndArmingCheckReport.h"
 #include "QGCMAVLink.h"
 
+#include <QMultiHash>
+
 #include <libevents/libs/cpp/generated/events_generated.h>
 
 HealthAndArmingCheckReport::HealthAndArmingCheckReport()
@@ -43,31 +45,67 @@ void HealthAndArmingCheckReport::update(uint8_t compid, const events::HealthAndA
         qWarning() << "Flight mode group not set";
         return;
     }
+    bool changed = !_supported;
     _supported = true;
 
-    _problemsForCurrentMode->clearAndDeleteContents();
-    _hasWarningsOrErrors = false;
+    // Problems which are still reported keep their object, so only the rows of changed checks are touched in the
+    // UI and the expanded state of the others is kept
+    QMultiHash<QString, HealthAndArmingCheckProblem*> oldProblems;
+    for (int i = 0; i < _problemsForCurrentMode->count(); i++) {
+        HealthAndArmingCheckProblem* problem = qobject_cast<HealthAndArmingCheckProblem*>(_problemsForCurrentMode->get(i));
+        oldProblems.insert(problem->message() + '\n' + problem->description() + '\n' + problem->severity(), problem);
+    }
+
+    QList<QObject*> newProblems;
+    bool hasWarningsOrErrors = false;
     for (const auto& check : results.checks(flightModeGroup)) {
         QString severity = "";
         if (events::externalLogLevel(check.log_levels) <= events::Log::Error) {
             severity = "error";
-            _hasWarningsOrErrors = true;
+            hasWarningsOrErrors = true;
         } else if (events::externalLogLevel(check.log_levels) <= events::Log::Warning) {
             severity = "warning";
-            _hasWarningsOrErrors = true;
+            hasWarningsOrErrors = true;
         }
-        QString description = QString::fromStdString(check.description);
-        _problemsForCurrentMode->append(new HealthAndArmingCheckProblem(QString::fromStdString(check.message),
-                description.replace("\n", "<br/>"), severity));
+        QString message = QString::fromStdString(check.message);
+        QString description = QString::fromStdString(check.description).replace("\n", "<br/>");
+        HealthAndArmingCheckProblem* problem = nullptr;
+        auto oldProblem = oldProblems.find(message + '\n' + description + '\n' + severity);
+        if (oldProblem != oldProblems.end()) {
+            problem = oldProblem.value();
+            oldProblems.erase(oldProblem);
+        } else {
+            problem = new HealthAndArmingCheckProblem(message, description, severity);
+        }
+        newProblems.append(problem);
+    }
+
+    if (newProblems != *_problemsForCurrentMode->objectList()) {
+        _problemsForCurrentMode->applyChanges(newProblems);
+        changed = true;
+    }
+    qDeleteAll(oldProblems);
+
+    if (hasWarningsOrErrors != _hasWarningsOrErrors) {
+        _hasWarningsOrErrors = hasWarningsOrErrors;
+        changed = true;
     }
 
-    _canArm = results.canArm(flightModeGroup);
+    const bool canArm = results.canArm(flightModeGroup);
+    bool canStartMission = _canStartMission;
+    bool canTakeoff = _canTakeoff;
     if (_missionModeGroup != -1) {
         // TODO: use results.canRun(_missionModeGroup) while armed
-        _canStartMission = results.canArm(_missionModeGroup);
+        canStartMission = results.canArm(_missionModeGroup);
     }
     if (_takeoffModeGroup != -1) {
-        _canTakeoff = results.canArm(_takeoffModeGroup);
+        canTakeoff = results.canArm(_takeoffModeGroup);
+    }
+    if (canArm != _canArm || canStartMission != _canStartMission || canTakeoff != _canTakeoff) {
+        _canArm = canArm;
+        _canStartMission = canStartMission;
+        _canTakeoff = canTakeoff;
+        changed = true;
     }
 
     const auto& healthComponents = results.healthComponents().health_components;
@@ -76,16 +114,23 @@ void HealthAndArmingCheckReport::update(uint8_t compid, const events::HealthAndA
     const auto gpsStateIter = healthComponents.find("gps");
     if (gpsStateIter != healthComponents.end()) {
         const events::HealthAndArmingChecks::HealthComponent& gpsState = gpsStateIter->second;
+        QString gpsStateColor;
         if (gpsState.health.error || gpsState.arming_check.error) {
-            _gpsState = "red";
+            gpsStateColor = "red";
         } else if (gpsState.health.warning || gpsState.arming_check.warning) {
-            _gpsState = "yellow";
+            gpsStateColor = "yellow";
         } else {
-            _gpsState = "green";
+            gpsStateColor = "green";
+        }
+        if (gpsStateColor != _gpsState) {
+            _gpsState = gpsStateColor;
+            changed = true;
         }
     }
 
-    emit updated();
+    if (changed) {
+        emit updated();
+    }
 }
 
 void HealthAndArmingCheckReport::setModeGroups(int takeoffModeGroup, int missionModeGroup)
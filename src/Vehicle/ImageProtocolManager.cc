@@ -32,8 +32,10 @@ void ImageProtocolManager::mavlinkMessageReceived(const mavlink_message_t& messa
         if (_imageHandshake.packets) {
             qCWarning(ImageProtocolManagerLog) << "DATA_TRANSMISSION_HANDSHAKE: Previous image transmission incomplete.";
         }
-        _imageBytes.clear();
         mavlink_msg_data_transmission_handshake_decode(&message, &_imageHandshake);
+        // Sized up front so packets are copied straight into place
+        _imageBytes = QByteArray(static_cast<int>(_imageHandshake.size), '\0');
+        _image = QImage();
         qCDebug(ImageProtocolManagerLog) << QStringLiteral("DATA_TRANSMISSION_HANDSHAKE: type(%1) width(%2) height (%3)").arg(_imageHandshake.type).arg(_imageHandshake.width).arg(_imageHandshake.height);
     }
         break;
@@ -54,10 +56,10 @@ void ImageProtocolManager::mavlinkMessageReceived(const mavlink_message_t& messa
             break;
         }
 
-        for (uint8_t i=0; i<_imageHandshake.payload; i++) {
-            _imageBytes[bytePosition] = encapsulatedData.data[i];
-            bytePosition++;
-        }
+        // The last packet is padded past the end of the image
+        int byteCount = qMin(static_cast<int>(_imageHandshake.payload), static_cast<int>(sizeof(encapsulatedData.data)));
+        byteCount = qMin(byteCount, _imageBytes.size() - bytePosition);
+        memcpy(_imageBytes.data() + bytePosition, encapsulatedData.data, static_cast<size_t>(byteCount));
 
         // We use the packets field to track completion
         _imageHandshake.packets--;
@@ -76,43 +78,61 @@ void ImageProtocolManager::mavlinkMessageReceived(const mavlink_message_t& messa
 
 QImage ImageProtocolManager::getImage(void)
 {
-    QImage image;
-
     if (_imageBytes.isEmpty()) {
         qCWarning(ImageProtocolManagerLog) << "getImage: Called when no image available";
     } else if (_imageHandshake.packets) {
         qCWarning(ImageProtocolManagerLog) << "getImage: Called when image is imcomplete. _imageHandshake.packets:" << _imageHandshake.packets;
-    } else {
-        switch (_imageHandshake.type) {
-        case MAVLINK_DATA_STREAM_IMG_RAW8U:
-        case MAVLINK_DATA_STREAM_IMG_RAW32U:
-        {
-            // Construct PGM header
-            QString header("P5\n%1 %2\n%3\n");
-            header = header.arg(_imageHandshake.width).arg(_imageHandshake.height).arg(255 /* image colors */);
-
-            QByteArray tmpImage(header.toStdString().c_str(), header.length());
-            tmpImage.append(_imageBytes);
-
-            if (!image.loadFromData(tmpImage, "PGM")) {
-                qCWarning(ImageProtocolManagerLog) << "getImage: IMG_RAW8U QImage::loadFromData failed";
-            }
-        }
-            break;
+    } else if (_image.isNull()) {
+        _image = _decodeImage();
+    }
 
-        case MAVLINK_DATA_STREAM_IMG_BMP:
-        case MAVLINK_DATA_STREAM_IMG_JPEG:
-        case MAVLINK_DATA_STREAM_IMG_PGM:
-        case MAVLINK_DATA_STREAM_IMG_PNG:
-            if (!image.loadFromData(_imageBytes)) {
-                qCWarning(ImageProtocolManagerLog) << "getImage: Known header QImage::loadFromData failed";
-            }
+    return _image;
+}
+
+/// Images arrive bottom up, so they are flipped here as part of decoding
+QImage ImageProtocolManager::_decodeImage(void)
+{
+    QImage image;
+
+    switch (_imageHandshake.type) {
+    case MAVLINK_DATA_STREAM_IMG_RAW8U:
+    case MAVLINK_DATA_STREAM_IMG_RAW32U:
+    {
+        // Raw 8 bit grayscale, rows are copied straight into the image
+        const int width     = _imageHandshake.width;
+        const int height    = _imageHandshake.height;
+
+        if (width <= 0 || height <= 0 || _imageBytes.size() < width * height) {
+            qCWarning(ImageProtocolManagerLog) << "getImage: IMG_RAW8U image size mismatch" << width << height << _imageBytes.size();
             break;
+        }
 
-        default:
-            qCWarning(ImageProtocolManagerLog) << "getImage: Unsupported image type:" << _imageHandshake.type;
+        image = QImage(width, height, QImage::Format_Grayscale8);
+        if (image.isNull()) {
+            qCWarning(ImageProtocolManagerLog) << "getImage: IMG_RAW8U QImage allocation failed";
             break;
         }
+        for (int row=0; row<height; row++) {
+            memcpy(image.scanLine(height - 1 - row), _imageBytes.constData() + (row * width), static_cast<size_t>(width));
+        }
+    }
+        break;
+
+    case MAVLINK_DATA_STREAM_IMG_BMP:
+    case MAVLINK_DATA_STREAM_IMG_JPEG:
+    case MAVLINK_DATA_STREAM_IMG_PGM:
+    case MAVLINK_DATA_STREAM_IMG_PNG:
+        if (image.loadFromData(_imageBytes)) {
+            // The rvalue overload flips in place instead of making a copy
+            image = std::move(image).mirrored();
+        } else {
+            qCWarning(ImageProtocolManagerLog) << "getImage: Known header QImage::loadFromData failed";
+        }
+        break;
+
+    default:
+        qCWarning(ImageProtocolManagerLog) << "getImage: Unsupported image type:" << _imageHandshake.type;
+        break;
     }
 
     return image;
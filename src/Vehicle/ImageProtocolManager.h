@@ -28,13 +28,18 @@ public:
     ImageProtocolManager(void);
 
     void    mavlinkMessageReceived  (const mavlink_message_t& message);
+
+    /// The image is decoded once per transmission, later calls return the same shared image
     QImage  getImage                (void);
 
 signals:
     void imageReady(void);
 
 private:
+    QImage  _decodeImage            (void);
+
     mavlink_data_transmission_handshake_t   _imageHandshake;
     QByteArray                              _imageBytes;
+    QImage                                  _image;
 
 };
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "InitialConnectScheduler.h"
+#include "InitialConnectStateMachine.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+QGC_LOGGING_CATEGORY(InitialConnectSchedulerLog, "InitialConnectSchedulerLog")
+
+InitialConnectScheduler::InitialConnectScheduler(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+void InitialConnectScheduler::requestStart(InitialConnectStateMachine* stateMachine)
+{
+    if (_queue.contains(stateMachine) || _running.contains(stateMachine)) {
+        return;
+    }
+
+    if (_queue.isEmpty() && _running.isEmpty()) {
+        _batchTimer.start();
+    }
+
+    Vehicle* vehicle = stateMachine->vehicle();
+    connect(vehicle, &QObject::destroyed, this, &InitialConnectScheduler::_vehicleDestroyed, Qt::UniqueConnection);
+
+    if (vehicle == qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()) {
+        _queue.prepend(stateMachine);
+    } else {
+        _queue.append(stateMachine);
+    }
+    qCDebug(InitialConnectSchedulerLog) << "requestStart vehicle:queued:running" << vehicle->id() << _queue.count() << _running.count();
+
+    _startNext();
+}
+
+void InitialConnectScheduler::prioritize(Vehicle* vehicle)
+{
+    for (int i=0; i<_queue.count(); i++) {
+        if (_queue[i]->vehicle() == vehicle) {
+            _queue.move(i, 0);
+            break;
+        }
+    }
+}
+
+void InitialConnectScheduler::_startNext(void)
+{
+    while (_running.count() < _maxConcurrent && !_queue.isEmpty()) {
+        _start(_queue.takeFirst());
+    }
+}
+
+void InitialConnectScheduler::_start(InitialConnectStateMachine* stateMachine)
+{
+    Vehicle* vehicle = stateMachine->vehicle();
+
+    StartStats_t startStats;
+    startStats.messagesReceived = vehicle->messagesReceived();
+    startStats.messagesLost     = vehicle->messagesLost();
+    _running.insert(stateMachine, startStats);
+
+    qCDebug(InitialConnectSchedulerLog) << "Starting initial connect vehicle:running:maxConcurrent" << vehicle->id() << _running.count() << _maxConcurrent;
+
+    connect(vehicle, &Vehicle::initialConnectComplete, this, &InitialConnectScheduler::_connectComplete, Qt::UniqueConnection);
+    stateMachine->start();
+}
+
+void InitialConnectScheduler::_connectComplete(void)
+{
+    Vehicle* vehicle = qobject_cast<Vehicle*>(sender());
+
+    for (auto iter = _running.begin(); iter != _running.end(); iter++) {
+        if (iter.key()->vehicle() == vehicle) {
+            StartStats_t startStats = iter.value();
+            _running.erase(iter);
+            _adapt(vehicle, startStats);
+            break;
+        }
+    }
+
+    if (_queue.isEmpty() && _running.isEmpty()) {
+        qCDebug(InitialConnectSchedulerLog) << "All vehicles connected msecs:" << _batchTimer.elapsed();
+    }
+
+    _startNext();
+}
+
+/// Additive increase, multiplicative decrease of the concurrent sequences based on the message loss seen while the
+/// vehicle was connecting
+void InitialConnectScheduler::_adapt(Vehicle* vehicle, const StartStats_t& startStats)
+{
+    uint received   = vehicle->messagesReceived() - startStats.messagesReceived;
+    uint lost       = vehicle->messagesLost() - startStats.messagesLost;
+    if (received + lost == 0) {
+        return;
+    }
+
+    double lossPercent = (100.0 * lost) / (received + lost);
+    if (lossPercent > _highLossPercent) {
+        _maxConcurrent = qMax(1, _maxConcurrent / 2);
+    } else if (lossPercent < _lowLossPercent) {
+        _maxConcurrent = qMin(_maxConcurrentLimit, _maxConcurrent + 1);
+    }
+
+    qCDebug(InitialConnectSchedulerLog) << "Initial connect complete vehicle:loss%:maxConcurrent" << vehicle->id() << lossPercent << _maxConcurrent;
+}
+
+void InitialConnectScheduler::_vehicleDestroyed(QObject* vehicle)
+{
+    // The object is already partially destroyed so only the pointer value can be used
+    for (int i=_queue.count() - 1; i>=0; i--) {
+        if (_queue[i]->vehicle() == vehicle) {
+            _queue.removeAt(i);
+        }
+    }
+    for (auto iter = _running.begin(); iter != _running.end(); ) {
+        if (iter.key()->vehicle() == vehicle) {
+            iter = _running.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+
+    _startNext();
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(InitialConnectSchedulerLog)
+
+class InitialConnectStateMachine;
+class Vehicle;
+
+/// Limits how many vehicles run their initial connect sequence at the same time.
+///
+/// Vehicles which connect together (for example when QGC is restarted during an operation) would otherwise all
+/// request their parameters, plans and component information at once over the same radio. The active vehicle is
+/// always started first. The number of concurrent sequences adapts to the link: it grows while vehicles connect with
+/// little message loss and is halved when a vehicle connects with high loss.
+class InitialConnectScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    InitialConnectScheduler(QObject* parent = nullptr);
+
+    /// Starts the state machine now or once enough running sequences have completed
+    void requestStart(InitialConnectStateMachine* stateMachine);
+
+    /// Moves the vehicle to the front of the queue
+    void prioritize(Vehicle* vehicle);
+
+    /// @return true: state machine is waiting to be started
+    bool isQueued(InitialConnectStateMachine* stateMachine) const { return _queue.contains(stateMachine); }
+
+    int maxConcurrent(void) const { return _maxConcurrent; }
+
+private slots:
+    void _connectComplete   (void);
+    void _vehicleDestroyed  (QObject* vehicle);
+
+private:
+    typedef struct {
+        uint            messagesReceived;
+        uint            messagesLost;
+    } StartStats_t;
+
+    void _startNext     (void);
+    void _start         (InitialConnectStateMachine* stateMachine);
+    void _adapt         (Vehicle* vehicle, const StartStats_t& startStats);
+
+    QList<InitialConnectStateMachine*>                  _queue;
+    QHash<InitialConnectStateMachine*, StartStats_t>    _running;
+    int                                                 _maxConcurrent = _initialConcurrent;
+    QElapsedTimer                                       _batchTimer;    ///< Time since the first vehicle of the current batch was queued
+
+    static constexpr int    _initialConcurrent      = 2;
+    static constexpr int    _maxConcurrentLimit     = 6;
+    static constexpr double _highLossPercent        = 5.0;
+    static constexpr double _lowLossPercent         = 1.0;
+};
@@ -32,6 +32,8 @@ public:
 
     void advance() override;
 
+    Vehicle* vehicle(void) const { return _vehicle; }
+
 signals:
     void progressUpdate(float progress);
 
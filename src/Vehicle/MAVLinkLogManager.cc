@@ -10,16 +10,21 @@
 #include "MAVLinkLogManager.h"
 #include "QGCApplication.h"
 #include "SettingsManager.h"
+#include "MAVLinkLogUploadDevice.h"
+#include "QGCZlib.h"
 
 #include <QQmlContext>
 #include <QQmlProperty>
 #include <QQmlEngine>
 #include <QtQml>
 #include <QSettings>
-#include <QHttpPart>
 #include <QNetworkReply>
 #include <QFile>
 #include <QFileInfo>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(MAVLinkLogManagerLog, "MAVLinkLogManagerLog")
 
@@ -37,6 +42,9 @@ static const char* kVideoURLKey             = "VideoURL";
 static const char* kWindSpeedKey            = "WindSpeed";
 static const char* kRateKey                 = "RateKey";
 static const char* kPublicLogKey            = "PublicLog";
+static const char* kCompressUploadKey       = "CompressUpload";
+static const char* kUploadRateLimitKey      = "UploadRateLimit";
+static const char* kUploadQueueKey          = "UploadQueue";
 static const char* kFeedback                = "feedback";
 static const char* kVideoURL                = "videoUrl";
 
@@ -115,11 +123,14 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
 MAVLinkLogProcessor::MAVLinkLogProcessor()
     : _fd(nullptr)
     , _written(0)
-    , _sequence(-1)
+    , _nextSequence(-1)
     , _numDrops(0)
     , _gotHeader(false)
     , _error(false)
     , _record(nullptr)
+    , _workerThread(nullptr)
+    , _ackTarget{WeakLinkInterfacePtr(), 0, 0, 0, 0}
+    , _stop(false)
 {
 }
 
@@ -133,10 +144,24 @@ MAVLinkLogProcessor::~MAVLinkLogProcessor()
 void
 MAVLinkLogProcessor::close()
 {
+    if(_workerThread) {
+        {
+            QMutexLocker locker(&_queueLock);
+            _stop = true;
+        }
+        _queueWake.wakeOne();
+        _workerThread->wait();
+        delete _workerThread;
+        _workerThread = nullptr;
+        qCDebug(MAVLinkLogManagerLog) << "Log stream closed" << _fileName << "bytes:" << _written.load() << "dropped packets:" << _numDrops.load();
+    }
     if(_fd) {
         fclose(_fd);
         _fd = nullptr;
     }
+    if(_record) {
+        _record->setSize(_written);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -159,63 +184,179 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
     if(_fd) {
         _record = new MAVLinkLogFiles(manager, _fileName, true);
         _record->setWriting(true);
-        _sequence = -1;
+        _nextSequence = -1;
+        _writeBuffer.reserve(_writeBlockSize * 2);
+        _stop = false;
+        _workerThread = QThread::create([this]() { _workerLoop(); });
+        _workerThread->start();
         return true;
     }
     return false;
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::setAckTarget(WeakLinkInterfacePtr link, uint8_t systemId, uint8_t componentId, uint8_t targetSystem, uint8_t targetComponent)
+{
+    QMutexLocker locker(&_queueLock);
+    _ackTarget = { link, systemId, componentId, targetSystem, targetComponent };
+}
+
 //-----------------------------------------------------------------------------
 bool
-MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
+MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data, bool acked)
 {
-    num_drops = 0;
-    //-- Check if a sequence is newer than the one previously received and if
-    //   there were dropped messages between the last one and this.
-    if(_sequence == -1) {
-        _sequence = seq;
-        return true;
-    }
-    if((uint16_t)_sequence == seq) {
+    if(_error) {
         return false;
     }
-    if(seq > (uint16_t)_sequence) {
-        // Account for wrap-arounds, sequence is 2 bytes
-        if((seq - _sequence) > (1 << 15)) { // Assume reordered
-            return false;
+    {
+        QMutexLocker locker(&_queueLock);
+        _queue.append({ sequence, first_message, acked, data });
+    }
+    _queueWake.wakeOne();
+
+    const quint32 written = _written;
+    if(_record && _record->size() != written) {
+        _record->setSize(written);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_workerLoop()
+{
+    QElapsedTimer   clock;
+    QList<Packet_t> packets;
+    AckTarget_t     ackTarget;
+    bool            stop = false;
+
+    clock.start();
+    while(!stop) {
+        {
+            QMutexLocker locker(&_queueLock);
+            if(_queue.isEmpty() && !_stop) {
+                // Wake up without new packets only to give up on gaps which were not filled in time
+                _queueWake.wait(&_queueLock, _reorderBuffer.isEmpty() ? ULONG_MAX : static_cast<unsigned long>(_reorderTimeoutMSecs));
+            }
+            packets.swap(_queue);
+            ackTarget   = _ackTarget;
+            stop        = _stop;
         }
-        num_drops = seq - _sequence - 1;
-        _numDrops += num_drops;
-        _sequence = seq;
-        return true;
-    } else {
-        if((_sequence - seq) > (1 << 15)) {
-            num_drops = (1 << 16) - _sequence - 1 + seq;
+
+        const qint64 nowMSecs = clock.elapsed();
+        for(const Packet_t& packet: packets) {
+            //-- Ack first, the vehicle resends acked packets (header and definitions) until it sees the ack
+            if(packet.acked) {
+                _sendAck(ackTarget, packet.sequence);
+            }
+            _reorder(packet, nowMSecs);
+        }
+        _drainReorderBuffer(nowMSecs, stop);
+
+        //-- Small writes are collected until the stream goes quiet
+        if(packets.isEmpty() || stop) {
+            _flushWriteBuffer();
+        }
+        packets.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_sendAck(const AckTarget_t& target, uint16_t sequence)
+{
+    SharedLinkInterfacePtr sharedLink = target.link.lock();
+    if(!sharedLink || !sharedLink->isConnected()) {
+        qCDebug(MAVLinkLogManagerLog) << "Log data ack: link gone!";
+        return;
+    }
+
+    mavlink_message_t       msg;
+    mavlink_logging_ack_t   ack;
+
+    memset(&ack, 0, sizeof(ack));
+    ack.sequence = sequence;
+    ack.target_component = target.targetComponent;
+    ack.target_system = target.targetSystem;
+    mavlink_msg_logging_ack_encode_chan(
+                target.systemId,
+                target.componentId,
+                sharedLink->mavlinkChannel(),
+                &msg,
+                &ack);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int len = mavlink_msg_to_send_buffer(buffer, &msg);
+    sharedLink->writeBytesThreadSafe((const char*)buffer, len, LinkInterface::writePriorityForMessage(msg.msgid), target.targetSystem);
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_reorder(const Packet_t& packet, qint64 nowMSecs)
+{
+    if(_nextSequence == -1) {
+        _nextSequence = packet.sequence;
+    }
+    //-- Sequence is 2 bytes and wraps around, take it as the nearest one to the next expected sequence
+    const qint64 sequence = _nextSequence + static_cast<int16_t>(static_cast<uint16_t>(packet.sequence - static_cast<uint16_t>(_nextSequence)));
+    if(sequence < _nextSequence || _reorderBuffer.contains(sequence)) {
+        //-- Resent packet, or one which arrived after its gap was given up on
+        return;
+    }
+    _reorderBuffer.insert(sequence, { packet.firstMessage, packet.data, nowMSecs });
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_drainReorderBuffer(qint64 nowMSecs, bool giveUpGaps)
+{
+    while(!_reorderBuffer.isEmpty()) {
+        auto it = _reorderBuffer.begin();
+        int num_drops = 0;
+        if(it.key() != _nextSequence) {
+            //-- Wait for the missing packets a little, they may just be late
+            if(!giveUpGaps && _reorderBuffer.count() < _reorderWindow && nowMSecs - it->receivedMSecs < _reorderTimeoutMSecs) {
+                break;
+            }
+            num_drops = static_cast<int>(it.key() - _nextSequence);
             _numDrops += num_drops;
-            _sequence = seq;
-            return true;
         }
-        return false;
+        _processPacket(it->firstMessage, it->data, num_drops);
+        _nextSequence = it.key() + 1;
+        _reorderBuffer.erase(it);
     }
 }
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogProcessor::_writeData(void* data, int len)
+MAVLinkLogProcessor::_writeData(const void* data, int len)
 {
     if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
-        if(!_error) {
-            _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
-        } else {
-            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
+        _writeBuffer.append(static_cast<const char*>(data), len);
+        if(_writeBuffer.size() >= _writeBlockSize) {
+            _flushWriteBuffer();
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_flushWriteBuffer()
+{
+    if(_writeBuffer.isEmpty() || _error) {
+        return;
+    }
+    const int len = _writeBuffer.size();
+    if(fwrite(_writeBuffer.constData(), 1, len, _fd) != (size_t)len) {
+        qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
+        _error = true;
+    } else {
+        _written += len;
+    }
+    _writeBuffer.resize(0);
+}
+
 //-----------------------------------------------------------------------------
 QByteArray
 MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
@@ -234,64 +375,59 @@ MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
 }
 
 //-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
-{
-    int num_drops = 0;
-    _error = false;
-    while(_checkSequence(sequence, num_drops)) {
-        //-- The first 16 bytes need special treatment (this sounds awfully brittle)
-        if(!_gotHeader) {
-            if(data.size() < 16) {
-                //-- Shouldn't happen but if it does, we might as well close shop.
-                qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
-                return false;
-            }
-            //-- Write header
-            _writeData(data.data(), 16);
-            data.remove(0, 16);
-            _gotHeader = true;
-            // What about data start offset now that we removed 16 bytes off the start?
-        }
-        if(_gotHeader && num_drops > 0) {
-            if(num_drops > 25) num_drops = 25;
-            //-- Hocus Pocus
-            //   Write a dropout message. We don't really know the actual duration,
-            //   so just use the number of drops * 10 ms
-            uint8_t bogus[] = {2, 0, 79, 0, 0};
-            bogus[3] = num_drops * 10;
-            _writeData(bogus, sizeof(bogus));
-        }
-        if(num_drops > 0) {
-            _writeUlogMessage(_ulogMessage);
-            _ulogMessage.clear();
-            //-- If no useful information in this message. Drop it.
-            if(first_message == 255) {
-                break;
-            }
-            if(first_message > 0) {
-                data.remove(0, first_message);
-                first_message = 0;
-            }
+void
+MAVLinkLogProcessor::_processPacket(uint8_t first_message, QByteArray data, int num_drops)
+{
+    //-- The first 16 bytes need special treatment (this sounds awfully brittle)
+    if(!_gotHeader) {
+        if(data.size() < 16) {
+            //-- Shouldn't happen but if it does, we might as well close shop.
+            qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
+            _error = true;
+            return;
         }
-        if(first_message == 255 && _ulogMessage.length() > 0) {
-            _ulogMessage.append(data);
-            break;
+        //-- Write header
+        _writeData(data.data(), 16);
+        data.remove(0, 16);
+        _gotHeader = true;
+        // What about data start offset now that we removed 16 bytes off the start?
+    }
+    if(_gotHeader && num_drops > 0) {
+        if(num_drops > 25) num_drops = 25;
+        //-- Hocus Pocus
+        //   Write a dropout message. We don't really know the actual duration,
+        //   so just use the number of drops * 10 ms
+        uint8_t bogus[] = {2, 0, 79, 0, 0};
+        bogus[3] = num_drops * 10;
+        _writeData(bogus, sizeof(bogus));
+    }
+    if(num_drops > 0) {
+        _writeUlogMessage(_ulogMessage);
+        _ulogMessage.clear();
+        //-- If no useful information in this message. Drop it.
+        if(first_message == 255) {
+            return;
         }
-        if(_ulogMessage.length()) {
-            _writeData(_ulogMessage.data(), _ulogMessage.length());
-            if(first_message) {
-                _writeData(data.left(first_message).data(), first_message);
-            }
-            _ulogMessage.clear();
+        if(first_message > 0) {
+            data.remove(0, first_message);
+            first_message = 0;
         }
+    }
+    if(first_message == 255 && _ulogMessage.length() > 0) {
+        _ulogMessage.append(data);
+        return;
+    }
+    if(_ulogMessage.length()) {
+        _writeData(_ulogMessage.data(), _ulogMessage.length());
         if(first_message) {
-            data.remove(0, first_message);
+            _writeData(data.left(first_message).data(), first_message);
         }
-        _ulogMessage = _writeUlogMessage(data);
-        break;
+        _ulogMessage.clear();
+    }
+    if(first_message) {
+        data.remove(0, first_message);
     }
-    return !_error;
+    _ulogMessage = _writeUlogMessage(data);
 }
 
 //-----------------------------------------------------------------------------
@@ -310,6 +446,10 @@ MAVLinkLogManager::MAVLinkLogManager(QGCApplication* app, QGCToolbox* toolbox)
     , _windSpeed(-1)
     , _publicLog(false)
     , _logginDenied(false)
+    , _compressUpload(false)
+    , _uploadRateLimit(0)
+    , _uploadRetryCount(0)
+    , _uploadDevice(nullptr)
 {
     //-- Get saved settings
     QSettings settings;
@@ -324,11 +464,19 @@ MAVLinkLogManager::MAVLinkLogManager(QGCApplication* app, QGCToolbox* toolbox)
     setWindSpeed(settings.value(kWindSpeedKey, -1).toInt());
     setRating(settings.value(kRateKey, "notset").toString());
     setPublicLog(settings.value(kPublicLogKey, true).toBool());
+    setCompressUpload(settings.value(kCompressUploadKey, false).toBool());
+    setUploadRateLimit(settings.value(kUploadRateLimitKey, 0).toInt());
+    _uploadQueue = settings.value(kUploadQueueKey).toStringList();
+
+    _uploadRetryTimer.setSingleShot(true);
+    connect(&_uploadRetryTimer, &QTimer::timeout, this, &MAVLinkLogManager::_uploadNext);
+    connect(&_compressWatcher, &QFutureWatcher<bool>::finished, this, &MAVLinkLogManager::_compressFinished);
 }
 
 //-----------------------------------------------------------------------------
 MAVLinkLogManager::~MAVLinkLogManager()
 {
+    _compressWatcher.waitForFinished();
     _logFiles.clear();
 }
 
@@ -359,6 +507,11 @@ MAVLinkLogManager::setToolbox(QGCToolbox* toolbox)
         }
         qCDebug(MAVLinkLogManagerLog) << "MAVLink logs directory:" << _logPath;
         connect(toolbox->multiVehicleManager(), &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkLogManager::_activeVehicleChanged);
+        //-- Pick up uploads which didn't finish before the last shutdown
+        if(!_uploadQueue.isEmpty()) {
+            qCDebug(MAVLinkLogManagerLog) << "Resuming log uploads:" << _uploadQueue;
+            _uploadNext();
+        }
     }
 }
 
@@ -483,6 +636,31 @@ MAVLinkLogManager::setPublicLog(bool pub)
     emit publicLogChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::setCompressUpload(bool compress)
+{
+    _compressUpload = compress;
+    QSettings settings;
+    settings.beginGroup(kMAVLinkLogGroup);
+    settings.setValue(kCompressUploadKey, compress);
+    emit compressUploadChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::setUploadRateLimit(int kBytesPerSec)
+{
+    _uploadRateLimit = qMax(0, kBytesPerSec);
+    if(_uploadDevice) {
+        _uploadDevice->setRateLimit(_uploadRateLimit * 1024);
+    }
+    QSettings settings;
+    settings.beginGroup(kMAVLinkLogGroup);
+    settings.setValue(kUploadRateLimitKey, _uploadRateLimit);
+    emit uploadRateLimitChanged();
+}
+
 //-----------------------------------------------------------------------------
 bool
 MAVLinkLogManager::uploading()
@@ -494,31 +672,136 @@ MAVLinkLogManager::uploading()
 void
 MAVLinkLogManager::uploadLog()
 {
-    if(_currentLogfile) {
-        _currentLogfile->setUploading(false);
-    }
+    //-- Selected logs are added to the upload queue, which is worked through one log at a time
     for(int i = 0; i < _logFiles.count(); i++) {
-        _currentLogfile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
-        if (_currentLogfile) {
-            if(_currentLogfile->selected()) {
-                _currentLogfile->setSelected(false);
-                if(!_currentLogfile->uploaded() && !_emailAddress.isEmpty() && !_uploadURL.isEmpty()) {
-                    _currentLogfile->setUploading(true);
-                    _currentLogfile->setProgress(0.0);
-                    QString filePath = _makeFilename(_currentLogfile->name());
-                    _sendLog(filePath);
-                    emit uploadingChanged();
-                    return;
+        MAVLinkLogFiles* pLogFile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
+        if (pLogFile) {
+            if(pLogFile->selected()) {
+                pLogFile->setSelected(false);
+                if(!pLogFile->uploaded() && !_emailAddress.isEmpty() && !_uploadURL.isEmpty() && !_uploadQueue.contains(pLogFile->name())) {
+                    _uploadQueue.append(pLogFile->name());
                 }
             }
         } else {
             qWarning() << "Internal error";
         }
     }
+    _saveUploadQueue();
+    _uploadNext();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_uploadNext()
+{
+    if(_uploadDevice || _compressWatcher.isRunning() || _uploadRetryTimer.isActive()) {
+        //-- Busy, or waiting to retry the current log
+        return;
+    }
+    if(_currentLogfile) {
+        //-- Retry, using the compressed copy if there is one
+        const QString name = _currentLogfile->name();
+        if(!_sendLog(name, _compressUpload && QFile::exists(_compressedFilename(name)))) {
+            emit failed();
+            _finishUpload();
+        }
+        return;
+    }
+    while(!_uploadQueue.isEmpty()) {
+        const QString name = _uploadQueue.first();
+        _currentLogfile = nullptr;
+        for(int i = 0; i < _logFiles.count(); i++) {
+            MAVLinkLogFiles* pLogFile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
+            if(pLogFile && pLogFile->name() == name) {
+                _currentLogfile = pLogFile;
+                break;
+            }
+        }
+        if(_currentLogfile && !_currentLogfile->uploaded() && !_currentLogfile->writing()) {
+            _currentLogfile->setUploading(true);
+            _currentLogfile->setProgress(0.0);
+            _uploadRetryCount = 0;
+            emit uploadingChanged();
+            if(_compressUpload) {
+                //-- Compressed on a worker thread, the compressed copy is kept until the upload succeeds so retries don't redo it
+                const QString compressedFile = _compressedFilename(name);
+                if(QFileInfo(compressedFile).lastModified() < QFileInfo(_makeFilename(name)).lastModified()) {
+                    QDir().mkpath(QFileInfo(compressedFile).absolutePath());
+                    QString logFile = _makeFilename(name);
+                    _compressWatcher.setFuture(QtConcurrent::run([logFile, compressedFile]() {
+                        return QGCZlib::deflateGzipFile(logFile, compressedFile);
+                    }));
+                    return;
+                }
+            }
+            if(_sendLog(name, _compressUpload)) {
+                return;
+            }
+            _currentLogfile->setUploading(false);
+            emit failed();
+        }
+        _uploadQueue.removeFirst();
+        _saveUploadQueue();
+    }
     _currentLogfile = nullptr;
     emit uploadingChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_compressFinished()
+{
+    if(!_currentLogfile) {
+        //-- Upload was canceled while compressing
+        _uploadNext();
+        return;
+    }
+    if(!_compressWatcher.result()) {
+        qCWarning(MAVLinkLogManagerLog) << "Could not compress log for upload:" << _currentLogfile->name();
+        emit failed();
+        _finishUpload();
+        return;
+    }
+    if(!_sendLog(_currentLogfile->name(), true)) {
+        emit failed();
+        _finishUpload();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_finishUpload()
+{
+    if(_currentLogfile) {
+        _currentLogfile->setUploading(false);
+        _uploadQueue.removeAll(_currentLogfile->name());
+        QFile::remove(_compressedFilename(_currentLogfile->name()));
+    }
+    _saveUploadQueue();
+    _currentLogfile = nullptr;
+    _uploadRetryCount = 0;
+    emit uploadingChanged();
+    //-- Next (if any)
+    _uploadNext();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_saveUploadQueue()
+{
+    QSettings settings;
+    settings.beginGroup(kMAVLinkLogGroup);
+    settings.setValue(kUploadQueueKey, _uploadQueue);
+    emit uploadQueueCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+QString
+MAVLinkLogManager::_compressedFilename(const QString& baseName)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/MAVLinkLogUpload/" + baseName + _ulogExtension + ".gz";
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkLogManager::_insertNewLog(MAVLinkLogFiles* newLog)
@@ -586,6 +869,9 @@ MAVLinkLogManager::_deleteLog(MAVLinkLogFiles* log)
         sgone.remove();
     }
     //-- Remove file from list and delete record
+    if(_uploadQueue.removeAll(log->name())) {
+        _saveUploadQueue();
+    }
     _logFiles.removeOne(log);
     delete log;
     emit logFilesChanged();
@@ -605,8 +891,18 @@ MAVLinkLogManager::cancelUpload()
             qWarning() << "Internal error";
         }
     }
+    //-- Queued uploads are dropped as well, the current one is aborted
+    _uploadQueue.clear();
     if(_currentLogfile) {
+        _uploadQueue.append(_currentLogfile->name());
+    }
+    _saveUploadQueue();
+    if(_uploadDevice) {
         emit abortUpload();
+    } else if(_currentLogfile) {
+        //-- Waiting to retry or still compressing, _compressFinished moves on once compression is done
+        _uploadRetryTimer.stop();
+        _finishUpload();
     }
 }
 
@@ -654,20 +950,11 @@ MAVLinkLogManager::stopLogging()
     }
 }
 
-//-----------------------------------------------------------------------------
-QHttpPart
-create_form_part(const QString& name, const QString& value)
-{
-    QHttpPart formPart;
-    formPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"%1\"").arg(name));
-    formPart.setBody(value.toUtf8());
-    return formPart;
-}
-
 //-----------------------------------------------------------------------------
 bool
-MAVLinkLogManager::_sendLog(const QString& logFile)
+MAVLinkLogManager::_sendLog(const QString& baseName, bool compressed)
 {
+    const QString logFile = compressed ? _compressedFilename(baseName) : _makeFilename(baseName);
     QString defaultDescription = _description;
     if(_description.isEmpty()) {
         qCWarning(MAVLinkLogManagerLog) << "Log description missing. Using defaults.";
@@ -686,13 +973,26 @@ MAVLinkLogManager::_sendLog(const QString& logFile)
         qCWarning(MAVLinkLogManagerLog) << "Log file missing:" << logFile;
         return false;
     }
-    QFile* file = new QFile(logFile);
-    if(!file || !file->open(QIODevice::ReadOnly)) {
-        delete file;
-        file = nullptr;
-        qCWarning(MAVLinkLogManagerLog) << "Could not open log file:" << logFile;
+    //-- Build POST request
+    MAVLinkLogUploadDevice* device = new MAVLinkLogUploadDevice();
+    device->addFormField("email",       _emailAddress);
+    device->addFormField("description", defaultDescription);
+    device->addFormField("source",      "QGroundControl");
+    device->addFormField("version",     _app->applicationVersion());
+    device->addFormField("type",        "flightreport");
+    device->addFormField("windSpeed",   QString::number(_windSpeed));
+    device->addFormField("rating",      _rating);
+    device->addFormField("public",      _publicLog ? "true" : "false");
+    //-- Optional
+    device->addFormField(kFeedback,     _feedback.isEmpty() ? QStringLiteral("None Given") : _feedback);
+    device->addFormField(kVideoURL,     _videoURL.isEmpty() ? QStringLiteral("None") : _videoURL);
+    //-- Actual Log File, the file is read straight from disk as the request goes out
+    if(!device->setFile(logFile, fi.fileName(), compressed ? QStringLiteral("application/gzip") : QStringLiteral("application/octet-stream"))) {
+        qCWarning(MAVLinkLogManagerLog) << "Could not open log file:" << logFile << device->errorString();
+        delete device;
         return false;
     }
+    device->setRateLimit(_uploadRateLimit * 1024);
     if(!_nam) {
         _nam = new QNetworkAccessManager(this);
     }
@@ -700,56 +1000,18 @@ MAVLinkLogManager::_sendLog(const QString& logFile)
     QNetworkProxy tempProxy;
     tempProxy.setType(QNetworkProxy::DefaultProxy);
     _nam->setProxy(tempProxy);
-    //-- Build POST request
-    QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-    QHttpPart emailPart = create_form_part("email", _emailAddress);
-    QHttpPart descriptionPart = create_form_part("description", _description);
-    QHttpPart sourcePart      = create_form_part("source", "QGroundControl");
-    QHttpPart versionPart     = create_form_part("version", _app->applicationVersion());
-    QHttpPart typePart        = create_form_part("type", "flightreport");
-    QHttpPart windPart        = create_form_part("windSpeed", QString::number(_windSpeed));
-    QHttpPart ratingPart      = create_form_part("rating", _rating);
-    QHttpPart publicPart      = create_form_part("public", _publicLog ? "true" : "false");
-    //-- Assemble request and POST it
-    multiPart->append(emailPart);
-    multiPart->append(descriptionPart);
-    multiPart->append(sourcePart);
-    multiPart->append(versionPart);
-    multiPart->append(typePart);
-    multiPart->append(windPart);
-    multiPart->append(ratingPart);
-    multiPart->append(publicPart);
-    //-- Optional
-    QHttpPart feedbackPart;
-    if(_feedback.isEmpty()) {
-        feedbackPart = create_form_part(kFeedback, "None Given");
-    } else {
-        feedbackPart = create_form_part(kFeedback, _feedback);
-    }
-    multiPart->append(feedbackPart);
-    QHttpPart videoPart;
-    if(_videoURL.isEmpty()) {
-        videoPart = create_form_part(kVideoURL, "None");
-    } else {
-        videoPart = create_form_part(kVideoURL, _videoURL);
-    }
-    multiPart->append(videoPart);
-    //-- Actual Log File
-    QHttpPart logPart;
-    logPart.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
-    logPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"filearg\"; filename=\"%1\"").arg(fi.fileName()));
-    logPart.setBodyDevice(file);
-    multiPart->append(logPart);
-    file->setParent(multiPart);
     QNetworkRequest request(_uploadURL);
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, true);
-    QNetworkReply* reply = _nam->post(request, multiPart);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, device->contentType());
+    request.setHeader(QNetworkRequest::ContentLengthHeader, device->size());
+    QNetworkReply* reply = _nam->post(request, device);
     connect(reply, &QNetworkReply::finished,  this, &MAVLinkLogManager::_uploadFinished);
     connect(this, &MAVLinkLogManager::abortUpload, reply, &QNetworkReply::abort);
     //connect(reply, &QNetworkReply::readyRead, this, &MAVLinkLogManager::_dataAvailable);
     connect(reply, &QNetworkReply::uploadProgress, this, &MAVLinkLogManager::_uploadProgress);
-    multiPart->setParent(reply);
-    qCDebug(MAVLinkLogManagerLog) << "Log" << fi.baseName() << "Uploading." << fi.size() << "bytes.";
+    device->setParent(reply);
+    _uploadDevice = device;
+    qCDebug(MAVLinkLogManagerLog) << "Log" << fi.baseName() << "Uploading." << fi.size() << "bytes." << (compressed ? "compressed" : "") << "attempt" << _uploadRetryCount + 1;
     _nam->setProxy(savedProxy);
     return true;
 }
@@ -783,13 +1045,17 @@ MAVLinkLogManager::_uploadFinished()
     if(!reply) {
         return;
     }
+    _uploadDevice = nullptr;
     const int http_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     QByteArray data = reply->readAll();
+    reply->deleteLater();
     if(_processUploadResponse(http_code, data)) {
         qCDebug(MAVLinkLogManagerLog) << "Log uploaded.";
         emit succeed();
         if(_deleteAfterUpload) {
             if(_currentLogfile) {
+                _uploadQueue.removeAll(_currentLogfile->name());
+                QFile::remove(_compressedFilename(_currentLogfile->name()));
                 _deleteLog(_currentLogfile);
                 _currentLogfile = nullptr;
             }
@@ -805,13 +1071,24 @@ MAVLinkLogManager::_uploadFinished()
                 }
             }
         }
-    } else {
-        qCWarning(MAVLinkLogManagerLog) << QString("Log Upload Error: %1 status: %2").arg(reply->errorString(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toString());
-        emit failed();
+        _finishUpload();
+        return;
     }
-    reply->deleteLater();
-    //-- Next (if any)
-    uploadLog();
+
+    qCWarning(MAVLinkLogManagerLog) << QString("Log Upload Error: %1 status: %2").arg(reply->errorString(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toString());
+    //-- Connection problems and server errors are retried with back off, the server has no partial uploads so a retry
+    //   sends the whole log again. Canceled uploads and rejected logs are not retried.
+    const bool transient = reply->error() != QNetworkReply::OperationCanceledError && (http_code == 0 || http_code >= 500 || http_code == 408 || http_code == 429);
+    if(transient && _currentLogfile && _uploadRetryCount < _maxUploadRetries) {
+        const int retryMSecs = qMin(_uploadRetryMSecs << _uploadRetryCount, _maxUploadRetryMSecs);
+        _uploadRetryCount++;
+        qCDebug(MAVLinkLogManagerLog) << "Retrying log upload in" << retryMSecs << "msecs";
+        _currentLogfile->setProgress(0.0);
+        _uploadRetryTimer.start(retryMSecs);
+        return;
+    }
+    emit failed();
+    _finishUpload();
 }
 
 //-----------------------------------------------------------------------------
@@ -842,6 +1119,7 @@ MAVLinkLogManager::_activeVehicleChanged(Vehicle* vehicle)
         disconnect(_vehicle, &Vehicle::armedChanged,        this, &MAVLinkLogManager::_armedChanged);
         disconnect(_vehicle, &Vehicle::mavlinkLogData,      this, &MAVLinkLogManager::_mavlinkLogData);
         disconnect(_vehicle, &Vehicle::mavCommandResult,    this, &MAVLinkLogManager::_mavCommandResult);
+        disconnect(_vehicle->vehicleLinkManager(), &VehicleLinkManager::primaryLinkChanged, this, &MAVLinkLogManager::_updateLogAckTarget);
         _vehicle = nullptr;
         //-- Stop logging (if that's the case)
         stopLogging();
@@ -855,16 +1133,18 @@ MAVLinkLogManager::_activeVehicleChanged(Vehicle* vehicle)
         connect(_vehicle, &Vehicle::armedChanged,       this, &MAVLinkLogManager::_armedChanged);
         connect(_vehicle, &Vehicle::mavlinkLogData,     this, &MAVLinkLogManager::_mavlinkLogData);
         connect(_vehicle, &Vehicle::mavCommandResult,   this, &MAVLinkLogManager::_mavCommandResult);
+        connect(_vehicle->vehicleLinkManager(), &VehicleLinkManager::primaryLinkChanged, this, &MAVLinkLogManager::_updateLogAckTarget);
         emit canStartLogChanged();
     }
 }
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogManager::_mavlinkLogData(Vehicle* /*vehicle*/, uint8_t /*target_system*/, uint8_t /*target_component*/, uint16_t sequence, uint8_t first_message, QByteArray data, bool /*acked*/)
+MAVLinkLogManager::_mavlinkLogData(Vehicle* vehicle, uint8_t /*target_system*/, uint8_t /*target_component*/, uint16_t sequence, uint8_t first_message, QByteArray data, bool acked)
 {
     if(_logProcessor && _logProcessor->valid()) {
-        if(!_logProcessor->processStreamData(sequence, first_message, data)) {
+        //-- The processor acks from its worker thread
+        if(!_logProcessor->processStreamData(sequence, first_message, data, acked)) {
             qCWarning(MAVLinkLogManagerLog) << "Error writing MAVLink log file:" << _logProcessor->fileName();
             delete _logProcessor;
             _logProcessor = nullptr;
@@ -874,6 +1154,25 @@ MAVLinkLogManager::_mavlinkLogData(Vehicle* /*vehicle*/, uint8_t /*target_system
         }
     } else {
         qCWarning(MAVLinkLogManagerLog) << "MAVLink log data received when not expected.";
+        if(acked) {
+            //-- Still ack so the vehicle doesn't keep resending it
+            vehicle->ackMavlinkLogData(sequence);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_updateLogAckTarget()
+{
+    //-- Acks go out from the processor worker thread, which can't look up the vehicle primary link itself
+    if(_logProcessor && _vehicle) {
+        MAVLinkProtocol* mavlink = qgcApp()->toolbox()->mavlinkProtocol();
+        _logProcessor->setAckTarget(_vehicle->vehicleLinkManager()->primaryLink(),
+                                    static_cast<uint8_t>(mavlink->getSystemId()),
+                                    static_cast<uint8_t>(mavlink->getComponentId()),
+                                    static_cast<uint8_t>(_vehicle->id()),
+                                    static_cast<uint8_t>(_vehicle->defaultComponentId()));
     }
 }
 
@@ -929,6 +1228,7 @@ MAVLinkLogManager::_createNewLog()
     delete _logProcessor;
     _logProcessor = new MAVLinkLogProcessor;
     if(_logProcessor->create(this, _logPath, static_cast<uint8_t>(_vehicle->id()))) {
+        _updateLogAckTarget();
         _insertNewLog(_logProcessor->record());
         emit logFilesChanged();
     } else {
@@ -12,6 +12,13 @@
 #define MAVLinkLogManager_H
 
 #include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTimer>
+#include <QFutureWatcher>
+
+#include <atomic>
 
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
@@ -21,6 +28,8 @@
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogManagerLog)
 
 class QNetworkAccessManager;
+class QThread;
+class MAVLinkLogUploadDevice;
 class MAVLinkLogManager;
 
 //-----------------------------------------------------------------------------
@@ -73,31 +82,80 @@ private:
 };
 
 //-----------------------------------------------------------------------------
+/// Writes the ULog stream of LOGGING_DATA/LOGGING_DATA_ACKED packets to a file. Packets are only queued on the
+/// calling thread. A worker thread acks them, puts them back in sequence order through a reorder buffer, accounts
+/// for the gaps which are not filled in time and writes the file in large blocks.
 class MAVLinkLogProcessor
 {
 public:
     MAVLinkLogProcessor();
     ~MAVLinkLogProcessor();
+    /// Writes out everything queued and stops the worker thread
     void                close       ();
     bool                valid       ();
     bool                create      (MAVLinkLogManager *manager, const QString path, uint8_t id);
     MAVLinkLogFiles*    record      () { return _record; }
     QString             fileName    () { return _fileName; }
-    bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
+    /// Sets where LOGGING_ACK is sent for acked packets, thread safe
+    void                setAckTarget(WeakLinkInterfacePtr link, uint8_t systemId, uint8_t componentId, uint8_t targetSystem, uint8_t targetComponent);
+    /// Queues a packet for the worker thread
+    /// @return false: Writing the file failed
+    bool                processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data, bool acked);
+    /// @return Number of packets lost so far
+    int                 numDrops    () const { return _numDrops; }
 private:
-    bool                _checkSequence(uint16_t seq, int &num_drops);
-    QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
+    typedef struct {
+        uint16_t    sequence;
+        uint8_t     firstMessage;
+        bool        acked;
+        QByteArray  data;
+    } Packet_t;
+
+    typedef struct {
+        uint8_t     firstMessage;
+        QByteArray  data;
+        qint64      receivedMSecs;
+    } BufferedPacket_t;
+
+    typedef struct {
+        WeakLinkInterfacePtr    link;
+        uint8_t                 systemId;
+        uint8_t                 componentId;
+        uint8_t                 targetSystem;
+        uint8_t                 targetComponent;
+    } AckTarget_t;
+
+    void                _workerLoop         ();
+    void                _sendAck            (const AckTarget_t& target, uint16_t sequence);
+    void                _reorder            (const Packet_t& packet, qint64 nowMSecs);
+    void                _drainReorderBuffer (qint64 nowMSecs, bool giveUpGaps);
+    void                _processPacket      (uint8_t first_message, QByteArray data, int num_drops);
+    QByteArray          _writeUlogMessage   (QByteArray &data);
+    void                _writeData          (const void* data, int len);
+    void                _flushWriteBuffer   ();
 private:
     FILE*               _fd;
-    quint32             _written;
-    int                 _sequence;
-    int                 _numDrops;
+    std::atomic<quint32> _written;         ///< Bytes written to the file
+    qint64              _nextSequence;      ///< Unwrapped sequence of the next packet to write, -1 before the first one
+    std::atomic<int>    _numDrops;
     bool                _gotHeader;
-    bool                _error;
+    std::atomic<bool>   _error;
     QByteArray          _ulogMessage;
+    QByteArray          _writeBuffer;
     QString             _fileName;
     MAVLinkLogFiles*    _record;
+
+    QMap<qint64, BufferedPacket_t>  _reorderBuffer;     ///< Key: unwrapped sequence, worker thread only
+    QThread*            _workerThread;
+    QMutex              _queueLock;
+    QWaitCondition      _queueWake;
+    QList<Packet_t>     _queue;
+    AckTarget_t         _ackTarget;
+    bool                _stop;
+
+    static const int    _reorderWindow          = 64;           ///< Gaps are given up once this many packets are waiting behind them
+    static const int    _reorderTimeoutMSecs    = 250;          ///< or the first packet after the gap has waited this long
+    static const int    _writeBlockSize         = 64 * 1024;
 };
 
 //-----------------------------------------------------------------------------
@@ -118,6 +176,9 @@ public:
     Q_PROPERTY(bool                 enableAutoStart     READ    enableAutoStart     WRITE setEnableAutoStart    NOTIFY enableAutoStartChanged)
     Q_PROPERTY(bool                 deleteAfterUpload   READ    deleteAfterUpload   WRITE setDeleteAfterUpload  NOTIFY deleteAfterUploadChanged)
     Q_PROPERTY(bool                 publicLog           READ    publicLog           WRITE setPublicLog          NOTIFY publicLogChanged)
+    Q_PROPERTY(bool                 compressUpload      READ    compressUpload      WRITE setCompressUpload     NOTIFY compressUploadChanged)
+    Q_PROPERTY(int                  uploadRateLimit     READ    uploadRateLimit     WRITE setUploadRateLimit    NOTIFY uploadRateLimitChanged)
+    Q_PROPERTY(int                  uploadQueueCount    READ    uploadQueueCount                                NOTIFY uploadQueueCountChanged)
     Q_PROPERTY(bool                 uploading           READ    uploading                                       NOTIFY uploadingChanged)
     Q_PROPERTY(bool                 logRunning          READ    logRunning                                      NOTIFY logRunningChanged)
     Q_PROPERTY(bool                 canStartLog         READ    canStartLog                                     NOTIFY canStartLogChanged)
@@ -143,6 +204,9 @@ public:
     bool        canStartLog         () { return _vehicle != nullptr && !_logginDenied; }
     bool        deleteAfterUpload   () const{ return _deleteAfterUpload; }
     bool        publicLog           () const{ return _publicLog; }
+    bool        compressUpload      () const{ return _compressUpload; }
+    int         uploadRateLimit     () const{ return _uploadRateLimit; }
+    int         uploadQueueCount    () const{ return _uploadQueue.count(); }
     int         windSpeed           () const{ return _windSpeed; }
     QString     rating              () { return _rating; }
     QString     logExtension        () { return _ulogExtension; }
@@ -160,6 +224,10 @@ public:
     void        setWindSpeed        (int speed);
     void        setRating           (QString rate);
     void        setPublicLog        (bool publicLog);
+    /// Uploads logs gzipped, the upload server must accept that
+    void        setCompressUpload   (bool compress);
+    /// Limits the upload bandwidth so it leaves room for telemetry, in KB/s, 0 for no limit
+    void        setUploadRateLimit  (int kBytesPerSec);
 
     // Override from QGCTool
     void        setToolbox          (QGCToolbox *toolbox);
@@ -185,6 +253,9 @@ signals:
     void ratingChanged              ();
     void videoURLChanged            ();
     void publicLogChanged           ();
+    void compressUploadChanged      ();
+    void uploadRateLimitChanged     ();
+    void uploadQueueCountChanged    ();
 
 private slots:
     void _uploadFinished            ();
@@ -194,9 +265,15 @@ private slots:
     void _mavlinkLogData            (Vehicle* vehicle, uint8_t target_system, uint8_t target_component, uint16_t sequence, uint8_t first_message, QByteArray data, bool acked);
     void _armedChanged              (bool armed);
     void _mavCommandResult          (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
+    void _updateLogAckTarget        ();
+    void _uploadNext                ();
+    void _compressFinished          ();
 
 private:
-    bool _sendLog                   (const QString& logFile);
+    bool _sendLog                   (const QString& logFile, bool compressed);
+    void _finishUpload              ();
+    void _saveUploadQueue           ();
+    QString _compressedFilename     (const QString& baseName);
     bool _processUploadResponse     (int http_code, QByteArray &data);
     bool _createNewLog              ();
     int  _getFirstSelected          ();
@@ -227,6 +304,17 @@ private:
     bool                    _publicLog;
     QString                 _ulogExtension;
     bool                    _logginDenied;
+    bool                    _compressUpload;
+    int                     _uploadRateLimit;
+    QStringList             _uploadQueue;           ///< Names of the logs waiting for upload, persisted across restarts
+    int                     _uploadRetryCount;
+    QTimer                  _uploadRetryTimer;
+    QFutureWatcher<bool>    _compressWatcher;
+    MAVLinkLogUploadDevice* _uploadDevice;
+
+    static const int        _maxUploadRetries       = 8;
+    static const int        _uploadRetryMSecs       = 5000;     ///< Doubles with each retry
+    static const int        _maxUploadRetryMSecs    = 5 * 60 * 1000;
 
 };
 
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogUploadDevice.h"
+
+#include <QUuid>
+#include <cstring>
+
+MAVLinkLogUploadDevice::MAVLinkLogUploadDevice(QObject* parent)
+    : QIODevice (parent)
+    , _boundary ("qgc" + QUuid::createUuid().toByteArray(QUuid::Id128))
+{
+    _resumeTimer.setSingleShot(true);
+    connect(&_resumeTimer, &QTimer::timeout, this, &QIODevice::readyRead);
+}
+
+void MAVLinkLogUploadDevice::addFormField(const QString& name, const QString& value)
+{
+    _prefix += "--" + _boundary + "\r\n";
+    _prefix += "Content-Disposition: form-data; name=\"" + name.toUtf8() + "\"\r\n\r\n";
+    _prefix += value.toUtf8() + "\r\n";
+}
+
+bool MAVLinkLogUploadDevice::setFile(const QString& fileName, const QString& uploadFileName, const QString& contentType)
+{
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        setErrorString(_file.errorString());
+        return false;
+    }
+    _fileSize = _file.size();
+
+    _prefix += "--" + _boundary + "\r\n";
+    _prefix += "Content-Type: " + contentType.toUtf8() + "\r\n";
+    _prefix += "Content-Disposition: form-data; name=\"filearg\"; filename=\"" + uploadFileName.toUtf8() + "\"\r\n\r\n";
+    _suffix = "\r\n--" + _boundary + "--\r\n";
+
+    _readPos = 0;
+    _budget = 0;
+    _budgetClock.start();
+    return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+QByteArray MAVLinkLogUploadDevice::contentType(void) const
+{
+    return "multipart/form-data; boundary=" + _boundary;
+}
+
+void MAVLinkLogUploadDevice::setRateLimit(qint64 bytesPerSec)
+{
+    _rateLimit = qMax(static_cast<qint64>(0), bytesPerSec);
+    if (_rateLimit == 0 && _resumeTimer.isActive()) {
+        _resumeTimer.stop();
+        emit readyRead();
+    }
+}
+
+qint64 MAVLinkLogUploadDevice::size(void) const
+{
+    return _prefix.size() + _fileSize + _suffix.size();
+}
+
+bool MAVLinkLogUploadDevice::seek(qint64 pos)
+{
+    // Qt seeks back to the start when a request has to be sent again, e.g. after a redirect
+    if (pos < 0 || pos > size() || !QIODevice::seek(pos)) {
+        return false;
+    }
+    _readPos = pos;
+    return true;
+}
+
+void MAVLinkLogUploadDevice::close(void)
+{
+    _resumeTimer.stop();
+    _file.close();
+    QIODevice::close();
+}
+
+qint64 MAVLinkLogUploadDevice::_readBudget(qint64 maxSize)
+{
+    if (_rateLimit == 0) {
+        return maxSize;
+    }
+
+    // Budget builds up at the rate limit, capped so an idle period doesn't turn into a burst
+    const qint64 elapsedMSecs = _budgetClock.restart();
+    const double maxBudget = qMax(static_cast<double>(_minReadSize), _rateLimit / 4.0);
+    _budget = qMin(_budget + ((elapsedMSecs * _rateLimit) / 1000.0), maxBudget);
+
+    if (_budget < _minReadSize) {
+        if (!_resumeTimer.isActive()) {
+            _resumeTimer.start(qMax(1, static_cast<int>(((_minReadSize - _budget) * 1000.0) / _rateLimit)));
+        }
+        return 0;
+    }
+    return qMin(maxSize, static_cast<qint64>(_budget));
+}
+
+qint64 MAVLinkLogUploadDevice::readData(char* data, qint64 maxSize)
+{
+    const qint64 total = size();
+    if (_readPos >= total) {
+        return -1;
+    }
+
+    const qint64 allowed = _readBudget(qMin(maxSize, total - _readPos));
+    qint64 count = 0;
+    while (count < allowed) {
+        qint64 pos = _readPos + count;
+        qint64 chunk;
+        if (pos < _prefix.size()) {
+            chunk = qMin(allowed - count, static_cast<qint64>(_prefix.size()) - pos);
+            memcpy(data + count, _prefix.constData() + pos, static_cast<size_t>(chunk));
+        } else if ((pos -= _prefix.size()) < _fileSize) {
+            if (_file.pos() != pos && !_file.seek(pos)) {
+                setErrorString(_file.errorString());
+                return -1;
+            }
+            chunk = _file.read(data + count, qMin(allowed - count, _fileSize - pos));
+            if (chunk <= 0) {
+                setErrorString(_file.errorString());
+                return -1;
+            }
+        } else {
+            pos -= _fileSize;
+            chunk = qMin(allowed - count, static_cast<qint64>(_suffix.size()) - pos);
+            memcpy(data + count, _suffix.constData() + pos, static_cast<size_t>(chunk));
+        }
+        count += chunk;
+    }
+
+    _readPos += count;
+    if (_rateLimit) {
+        _budget -= count;
+    }
+    return count;
+}
+
+qint64 MAVLinkLogUploadDevice::writeData(const char* /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QIODevice>
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/// Request body of a log upload: the multipart form fields, the log file and the closing boundary, read as one device
+/// so the file is never loaded into memory. With a rate limit set, reads stop once the budget is used up and readyRead
+/// is emitted when more may be sent, which paces the upload without blocking the thread it runs on.
+class MAVLinkLogUploadDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogUploadDevice(QObject* parent = nullptr);
+
+    void        addFormField    (const QString& name, const QString& value);
+    /// Adds the file part and opens the device, no form fields can be added after this
+    ///     @param uploadFileName   File name given to the server
+    bool        setFile         (const QString& fileName, const QString& uploadFileName, const QString& contentType);
+    /// @return Value for the Content-Type header of the request
+    QByteArray  contentType     (void) const;
+    /// @param bytesPerSec 0 for no limit
+    void        setRateLimit    (qint64 bytesPerSec);
+
+    // Overrides from QIODevice
+    bool    isSequential    (void) const override { return false; }
+    qint64  size            (void) const override;
+    bool    seek            (qint64 pos) override;
+    void    close           (void) override;
+
+protected:
+    qint64  readData        (char* data, qint64 maxSize) override;
+    qint64  writeData       (const char* data, qint64 maxSize) override;
+
+private:
+    qint64  _readBudget     (qint64 maxSize);
+
+    QByteArray      _boundary;
+    QByteArray      _prefix;                ///< Form fields and the header of the file part
+    QByteArray      _suffix;
+    QFile           _file;
+    qint64          _fileSize       = 0;
+    qint64          _readPos        = 0;
+    qint64          _rateLimit      = 0;    ///< Bytes per second, 0 for no limit
+    double          _budget         = 0;    ///< Bytes which may be read right now
+    QElapsedTimer   _budgetClock;
+    QTimer          _resumeTimer;
+
+    static const qint64 _minReadSize    = 4096; ///< Throttled reads wait until at least this much budget is available
+};
@@ -8,117 +8,85 @@
  ****************************************************************************/
 
 #include "MAVLinkStreamConfig.h"
-#include "QGCMAVLink.h"
 
 MAVLinkStreamConfig::MAVLinkStreamConfig(const SetMessageIntervalCb &messageIntervalCb)
     : _messageIntervalCb(messageIntervalCb)
 {
 }
 
-void MAVLinkStreamConfig::setHighRateRateAndAttitude()
+void MAVLinkStreamConfig::setConsumerRates(const QString& consumer, const QMap<int, int>& intervalsUSecs)
 {
-    int requestedRate = (int)(1000000.0 / 100.0); // 100 Hz in usecs (better set this a bit higher than actually needed,
-    // to give it more priority in case of exceeding link bandwidth)
-
-    _nextDesiredRates = QVector<DesiredStreamRate>{{
-        {MAVLINK_MSG_ID_ATTITUDE_QUATERNION, requestedRate},
-        {MAVLINK_MSG_ID_ATTITUDE_TARGET, requestedRate},
-    }};
-    // we could check if we're already configured as requested
-
-    setNextState(State::Configuring);
-}
-
-void MAVLinkStreamConfig::setHighRateVelAndPos()
-{
-    int requestedRate = (int)(1000000.0 / 100.0);
-    _nextDesiredRates = QVector<DesiredStreamRate>{{
-        {MAVLINK_MSG_ID_LOCAL_POSITION_NED, requestedRate},
-        {MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED, requestedRate},
-    }};
-    setNextState(State::Configuring);
+    if (intervalsUSecs.isEmpty()) {
+        if (_consumers.remove(consumer) == 0) {
+            return;
+        }
+    } else {
+        _consumers[consumer] = intervalsUSecs;
+    }
+    _update();
 }
 
-void MAVLinkStreamConfig::setHighRateAltAirspeed()
+void MAVLinkStreamConfig::restoreDefaults()
 {
-    int requestedRate = (int)(1000000.0 / 100.0);
-    _nextDesiredRates = QVector<DesiredStreamRate>{{
-        {MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, requestedRate},
-        {MAVLINK_MSG_ID_VFR_HUD, requestedRate},
-    }};
-    setNextState(State::Configuring);
+    if (!_consumers.isEmpty()) {
+        _consumers.clear();
+        _update();
+    }
 }
 
 void MAVLinkStreamConfig::gotSetMessageIntervalAck()
 {
-    switch (_state) {
-        case State::Configuring:
-            nextDesiredRate();
-            break;
-        case State::RestoringDefaults:
-            restoreNextDefault();
-            break;
-        default:
-            break;
+    if (_waitingForAck) {
+        _sendNext();
     }
 }
 
-void MAVLinkStreamConfig::setNextState(State state)
+void MAVLinkStreamConfig::_update()
 {
-    _nextState = state;
-    if (_state == State::Idle) {
-        // first restore defaults no matter what the next state is
-        _state = State::RestoringDefaults;
-        restoreNextDefault();
+    QMap<int, int> desired;
+    for (const QMap<int, int>& intervals: _consumers) {
+        for (auto it = intervals.constBegin(); it != intervals.constEnd(); ++it) {
+            if (!desired.contains(it.key()) || it.value() < desired[it.key()]) {
+                desired[it.key()] = it.value();
+            }
+        }
     }
-}
 
-void MAVLinkStreamConfig::nextDesiredRate()
-{
-    if (_nextState != State::Idle) { // allow state to be interrupted by a new request
-        _desiredRates.clear();
-        _state = State::RestoringDefaults;
-        restoreNextDefault();
-        return;
+    // Recomputed from scratch, anything still pending from before is either in here again or no longer needed
+    _pending.clear();
+    for (auto it = _applied.constBegin(); it != _applied.constEnd(); ++it) {
+        if (!desired.contains(it.key())) {
+            _pending[it.key()] = 0;
+        }
     }
-
-    if (_desiredRates.empty()) {
-        _state = State::Idle;
-        return;
+    for (auto it = desired.constBegin(); it != desired.constEnd(); ++it) {
+        if (_applied.value(it.key(), 0) != it.value()) {
+            _pending[it.key()] = it.value();
+        }
     }
-    const DesiredStreamRate& rate = _desiredRates.last();
-    _changedIds.push_back(rate.messageId);
-    _messageIntervalCb(rate.messageId, rate.rate);
-    _desiredRates.pop_back();
-}
 
-void MAVLinkStreamConfig::restoreDefaults()
-{
-    setNextState(State::RestoringDefaults);
+    if (!_waitingForAck) {
+        _sendNext();
+    }
 }
 
-void MAVLinkStreamConfig::restoreNextDefault()
+void MAVLinkStreamConfig::_sendNext()
 {
-    if (_changedIds.empty()) {
-        // do we have a pending request?
-        switch (_nextState) {
-            case State::Configuring:
-                _state = _nextState;
-                _desiredRates = _nextDesiredRates;
-                _nextDesiredRates.clear();
-                _nextState = State::Idle;
-                nextDesiredRate();
-                break;
-            case State::RestoringDefaults:
-            case State::Idle:
-                _nextState = State::Idle; // nothing to do, we just finished restoring
-                _state = State::Idle;
-                break;
-        }
+    if (_pending.isEmpty()) {
+        _waitingForAck = false;
         return;
     }
 
-    int id = _changedIds.last();
-    _messageIntervalCb(id, 0); // restore the default rate
-    _changedIds.pop_back();
+    auto            it          = _pending.begin();
+    const int       messageId   = it.key();
+    const int       interval    = it.value();
+    _pending.erase(it);
+
+    if (interval == 0) {
+        _applied.remove(messageId);
+    } else {
+        _applied[messageId] = interval;
+    }
+    _waitingForAck = true;
+    _messageIntervalCb(messageId, interval);
 }
@@ -9,15 +9,19 @@
 
 #pragma once
 
-#include <QVector>
+#include <QMap>
+#include <QString>
 
 #include <functional>
 
 /**
  * @class MAVLinkStreamConfig
- * Allows to configure a set of mavlink streams to a specific rate,
- * and restore back to default.
- * Note that only one set is active at a time.
+ * Configures mavlink stream rates for a set of consumers (tuning pages, loggers, plugins).
+ * Each message is streamed at the fastest rate any consumer asks for. Only the
+ * differences to what was last set are sent, and messages nobody asks for any more
+ * are restored back to their default rate.
+ * One SET_MESSAGE_INTERVAL is outstanding at a time since a second one to the same
+ * component can't be told apart in the ack.
  */
 class MAVLinkStreamConfig
 {
@@ -26,35 +30,26 @@ public:
 
     MAVLinkStreamConfig(const SetMessageIntervalCb& messageIntervalCb);
 
-    void setHighRateRateAndAttitude();
-    void setHighRateVelAndPos();
-    void setHighRateAltAirspeed();
+    /// Sets the message intervals a consumer needs, replacing what it asked for before
+    ///     @param intervalsUSecs   Message id to interval in usecs, empty removes the consumer
+    void setConsumerRates(const QString& consumer, const QMap<int, int>& intervalsUSecs);
 
+    void removeConsumer(const QString& consumer) { setConsumerRates(consumer, QMap<int, int>()); }
+
+    /// Removes all consumers
     void restoreDefaults();
 
+    /// Called once the last interval sent is acked, failed or timed out
     void gotSetMessageIntervalAck();
+
 private:
-    enum class State {
-        Idle,
-        RestoringDefaults,
-        Configuring
-    };
-
-    struct DesiredStreamRate {
-        int messageId;
-        int rate;
-    };
-
-    void restoreNextDefault();
-    void nextDesiredRate();
-    void setNextState(State state);
-
-    State _state{State::Idle};
-    QVector<DesiredStreamRate> _desiredRates;
-    QVector<int> _changedIds;
-
-    State _nextState{State::Idle};
-    QVector<DesiredStreamRate> _nextDesiredRates;
+    void _update();
+    void _sendNext();
+
+    QMap<QString, QMap<int, int>>   _consumers;
+    QMap<int, int>                  _applied;           ///< Intervals currently set on the vehicle, by message id
+    QMap<int, int>                  _pending;           ///< Intervals still to send, 0 restores the default
+    bool                            _waitingForAck  = false;
 
     const SetMessageIntervalCb _messageIntervalCb;
 };
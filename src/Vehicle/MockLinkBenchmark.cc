@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkBenchmark.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MAVLinkProtocol.h"
+#include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "ParameterManager.h"
+#include "Vehicle.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMap>
+#include <QTimer>
+
+#include <algorithm>
+
+MockLinkBenchmark::MockLinkBenchmark(void)
+{
+
+}
+
+void MockLinkBenchmark::cleanup(void)
+{
+    MultiVehicleManager* multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    _linkManager->disconnectAll();
+    QTRY_COMPARE_WITH_TIMEOUT(multiVehicleMgr->vehicles()->count(), 0, 10000);
+
+    UnitTest::cleanup();
+}
+
+int MockLinkBenchmark::_envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+/// @return Resident memory of the process, -1 if not known on this platform
+qint64 MockLinkBenchmark::_residentMemoryKB(void)
+{
+#ifdef Q_OS_LINUX
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QFile::ReadOnly)) {
+        while (!status.atEnd()) {
+            QByteArray line = status.readLine();
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+QJsonObject MockLinkBenchmark::_distribution(QVector<qint64> values)
+{
+    QJsonObject distribution;
+
+    distribution[QStringLiteral("count")] = values.count();
+    if (values.isEmpty()) {
+        return distribution;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](int percent) { return values[(values.count() - 1) * percent / 100]; };
+
+    qint64 sum = 0;
+    for (qint64 value: values) {
+        sum += value;
+    }
+    distribution[QStringLiteral("mean")]    = static_cast<double>(sum) / values.count();
+    distribution[QStringLiteral("p50")]     = percentile(50);
+    distribution[QStringLiteral("p95")]     = percentile(95);
+    distribution[QStringLiteral("p99")]     = percentile(99);
+    distribution[QStringLiteral("max")]     = values.last();
+
+    return distribution;
+}
+
+void MockLinkBenchmark::_throughputBenchmark(void)
+{
+    const int       vehicleCount    = _envInt("QGC_BENCHMARK_VEHICLES",         4);
+    const int       attitudeRate    = _envInt("QGC_BENCHMARK_ATTITUDE_RATE",    200);
+    const int       loadSecs        = _envInt("QGC_BENCHMARK_SECONDS",          10);
+    const int       loadRate        = _envInt("QGC_BENCHMARK_LOAD_RATE",        0);
+    const int       loadSystems     = _envInt("QGC_BENCHMARK_LOAD_SYSTEMS",     1);
+    const int       loadLoss        = _envInt("QGC_BENCHMARK_LOAD_LOSS",        0);
+    const QString   loadMix         = qEnvironmentVariable("QGC_BENCHMARK_LOAD_MIX");
+    const QString   outputFile      = qEnvironmentVariable("QGC_BENCHMARK_OUTPUT", QStringLiteral("qgcbenchmark.json"));
+
+    MultiVehicleManager*    multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    MAVLinkProtocol*        mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    // All connections are made to this context so they go away with it
+    QObject         context;
+    QElapsedTimer   syncTimer;
+    bool            measuring       = false;
+    qint64          messageCount    = 0;
+    QVector<qint64> linkToVehicleLatencies;
+    QVector<qint64> paramsReadyMSecs;
+    QVector<qint64> initialConnectMSecs;
+    QMap<Vehicle*, bool> paramsReadySeen;
+
+    connect(multiVehicleMgr, &MultiVehicleManager::vehicleAdded, &context, [&](Vehicle* vehicle) {
+        connect(vehicle->parameterManager(), &ParameterManager::parametersReadyChanged, &context, [&, vehicle](bool parametersReady) {
+            if (parametersReady && !paramsReadySeen.contains(vehicle)) {
+                paramsReadySeen[vehicle] = true;
+                paramsReadyMSecs.append(syncTimer.elapsed());
+            }
+        });
+        connect(vehicle, &Vehicle::initialConnectComplete, &context, [&]() {
+            initialConnectMSecs.append(syncTimer.elapsed());
+        });
+        connect(vehicle, &Vehicle::mavlinkMessageReceived, &context, [&](const mavlink_message_t& message) {
+            if (measuring && message.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+                mavlink_attitude_t attitude;
+                mavlink_msg_attitude_decode(&message, &attitude);
+                quint32 now = static_cast<quint32>(QDateTime::currentMSecsSinceEpoch());
+                linkToVehicleLatencies.append(static_cast<qint32>(now - attitude.time_boot_ms));
+            }
+        });
+    });
+    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, &context, [&]() {
+        if (measuring) {
+            messageCount++;
+        }
+    });
+
+    qint64 startMemoryKB = _residentMemoryKB();
+    syncTimer.start();
+
+    for (int i=0; i<vehicleCount; i++) {
+        MockConfiguration* mockConfig = new MockConfiguration(QStringLiteral("Benchmark %1").arg(i));
+        mockConfig->setDynamic          (true);
+        mockConfig->setFirmwareType     (MAV_AUTOPILOT_PX4);
+        mockConfig->setVehicleType      (MAV_TYPE_QUADROTOR);
+        mockConfig->setAttitudeRate     (attitudeRate);
+        mockConfig->setLoadRate         (loadRate);
+        mockConfig->setLoadSystemCount  (loadSystems);
+        mockConfig->setLoadLossPercent  (loadLoss);
+        if (!loadMix.isEmpty()) {
+            mockConfig->setLoadMix      (loadMix);
+        }
+        SharedLinkConfigurationPtr sharedConfig = _linkManager->addConfiguration(mockConfig);
+        QVERIFY(_linkManager->createConnectedLink(sharedConfig));
+    }
+
+    // Full sync: parameters, mission, geofence and rally point load
+    QTRY_COMPARE_WITH_TIMEOUT(initialConnectMSecs.count(), vehicleCount, _syncTimeoutMSecs);
+    const qint64 syncedMemoryKB = _residentMemoryKB();
+
+    // Load phase
+    QVector<qint64> eventLoopLags;
+    QElapsedTimer   lagTimer;
+    QTimer          lagProbe;
+    lagProbe.setInterval(_lagTimerMSecs);
+    connect(&lagProbe, &QTimer::timeout, &context, [&]() {
+        eventLoopLags.append(qMax<qint64>(0, lagTimer.restart() - _lagTimerMSecs));
+    });
+
+    QElapsedTimer loadTimer;
+    measuring = true;
+    loadTimer.start();
+    lagTimer.start();
+    lagProbe.start();
+    while (loadTimer.elapsed() < loadSecs * 1000) {
+        QTest::qWait(100);
+    }
+    lagProbe.stop();
+    measuring = false;
+    const qint64 loadMSecs = loadTimer.elapsed();
+
+    QJsonObject memory;
+    memory[QStringLiteral("startKB")]   = startMemoryKB;
+    memory[QStringLiteral("syncedKB")]  = syncedMemoryKB;
+    memory[QStringLiteral("endKB")]     = _residentMemoryKB();
+
+    QJsonObject results;
+    results[QStringLiteral("vehicles")]                     = vehicleCount;
+    results[QStringLiteral("attitudeRateHz")]               = attitudeRate;
+    results[QStringLiteral("loadRateHz")]                   = loadRate;
+    results[QStringLiteral("loadSystems")]                  = loadSystems;
+    results[QStringLiteral("loadMSecs")]                    = loadMSecs;
+    results[QStringLiteral("messagesPerSecond")]            = messageCount * 1000.0 / loadMSecs;
+    results[QStringLiteral("paramsReadyMSecs")]             = _distribution(paramsReadyMSecs);
+    results[QStringLiteral("initialConnectCompleteMSecs")]  = _distribution(initialConnectMSecs);
+    results[QStringLiteral("linkToVehicleLatencyMSecs")]    = _distribution(linkToVehicleLatencies);
+    results[QStringLiteral("eventLoopLagMSecs")]            = _distribution(eventLoopLags);
+    results[QStringLiteral("residentMemory")]               = memory;
+
+    QByteArray json = QJsonDocument(results).toJson();
+    qDebug().noquote() << json;
+
+    QFile file(outputFile);
+    QVERIFY2(file.open(QFile::WriteOnly | QFile::Truncate), qPrintable(file.errorString()));
+    file.write(json);
+}
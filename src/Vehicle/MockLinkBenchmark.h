@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QJsonObject>
+#include <QVector>
+
+/// Throughput benchmark against a set of MockLink vehicles. Standalone, run through the qgcbenchmark target or with
+/// --unittest:MockLinkBenchmark.
+///
+/// Configured through environment variables:
+///     QGC_BENCHMARK_VEHICLES          Number of MockLink vehicles (default 4)
+///     QGC_BENCHMARK_ATTITUDE_RATE     Additional ATTITUDE messages per second per vehicle (default 200)
+///     QGC_BENCHMARK_SECONDS           Length of the load phase after all vehicles are synced (default 10)
+///     QGC_BENCHMARK_LOAD_RATE         MockLink load generator messages per second per vehicle (default 0)
+///     QGC_BENCHMARK_LOAD_MIX          Load generator msgid:weight mix (default MockConfiguration::loadMix)
+///     QGC_BENCHMARK_LOAD_SYSTEMS      System ids the load generator spreads over per vehicle (default 1)
+///     QGC_BENCHMARK_LOAD_LOSS         Load generator loss percentage (default 0)
+///     QGC_BENCHMARK_OUTPUT            Json results file (default qgcbenchmark.json)
+///
+/// Results are time to parameters ready and to initial connect complete, messages per second handled, latency
+/// from MockLink send to Vehicle handled, event loop lag and resident memory growth.
+class MockLinkBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MockLinkBenchmark(void);
+
+protected:
+    void cleanup(void) final;
+
+private slots:
+    void _throughputBenchmark(void);
+
+private:
+    static int          _envInt             (const char* name, int defaultValue);
+    static qint64       _residentMemoryKB   (void);
+    static QJsonObject  _distribution       (QVector<qint64> values);
+
+    static const int _syncTimeoutMSecs  = 120 * 1000;
+    static const int _lagTimerMSecs     = 10;
+};
@@ -8,8 +8,10 @@
  ****************************************************************************/
 
 #include "MultiVehicleManager.h"
+#include "InitialConnectScheduler.h"
 #include "AutoPilotPlugin.h"
 #include "MAVLinkProtocol.h"
+#include "MAVLinkPeriodicSender.h"
 #include "UAS.h"
 #include "QGCApplication.h"
 #include "FollowMe.h"
@@ -18,6 +20,7 @@
 #include "QGCCorePlugin.h"
 #include "QGCOptions.h"
 #include "LinkManager.h"
+#include "TelemetryStreamServer.h"
 
 #if defined (__ios__) || defined(__android__)
 #include "MobileScreenMgr.h"
@@ -35,6 +38,7 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
     , _parameterReadyVehicleAvailable(false)
     , _activeVehicle(nullptr)
     , _offlineEditingVehicle(nullptr)
+    , _initialConnectScheduler(new InitialConnectScheduler(this))
     , _firmwarePluginManager(nullptr)
     , _joystickManager(nullptr)
     , _mavlinkProtocol(nullptr)
@@ -42,8 +46,6 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
 {
     QSettings settings;
     _gcsHeartbeatEnabled = settings.value(_gcsHeartbeatEnabledKey, true).toBool();
-    _gcsHeartbeatTimer.setInterval(_gcsHeartbeatRateMSecs);
-    _gcsHeartbeatTimer.setSingleShot(false);
 }
 
 void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
@@ -58,13 +60,28 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
     qmlRegisterUncreatableType<MultiVehicleManager>("QGroundControl.MultiVehicleManager", 1, 0, "MultiVehicleManager", "Reference only");
 
     connect(_mavlinkProtocol, &MAVLinkProtocol::vehicleHeartbeatInfo, this, &MultiVehicleManager::_vehicleHeartbeatInfo);
-    connect(&_gcsHeartbeatTimer, &QTimer::timeout, this, &MultiVehicleManager::_sendGCSHeartbeat);
 
     if (_gcsHeartbeatEnabled) {
-        _gcsHeartbeatTimer.start();
+        _gcsHeartbeatSendId = MAVLinkPeriodicSender::instance()->add(this, _gcsHeartbeatRateMSecs, [this]() { _sendGCSHeartbeat(); });
     }
 
     _offlineEditingVehicle = new Vehicle(Vehicle::MAV_AUTOPILOT_TRACK, Vehicle::MAV_TYPE_TRACK, _firmwarePluginManager, this);
+
+    _telemetryStreamServer = new TelemetryStreamServer(this, this);
+    AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+    connect(appSettings->telemetryStreamServer(),       &Fact::rawValueChanged, this, &MultiVehicleManager::_updateTelemetryStreamServer);
+    connect(appSettings->telemetryStreamServerPort(),   &Fact::rawValueChanged, this, &MultiVehicleManager::_updateTelemetryStreamServer);
+    _updateTelemetryStreamServer();
+}
+
+void MultiVehicleManager::_updateTelemetryStreamServer(void)
+{
+    AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+    if (appSettings->telemetryStreamServer()->rawValue().toBool()) {
+        _telemetryStreamServer->start(static_cast<quint16>(appSettings->telemetryStreamServerPort()->rawValue().toUInt()));
+    } else {
+        _telemetryStreamServer->stop();
+    }
 }
 
 void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType)
@@ -130,7 +147,13 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
         _app->showAppMessage(tr("Warning: A vehicle is using the same system id as %1: %2").arg(qgcApp()->applicationName()).arg(vehicleId));
     }
 
-    Vehicle* vehicle = new Vehicle(link, vehicleId, componentId, (MAV_AUTOPILOT)vehicleFirmwareType, (MAV_TYPE)vehicleType, _firmwarePluginManager, _joystickManager);
+    // Past _maxFullVehicles new vehicles are only monitored until they are made active
+    bool monitorOnly = _vehicles.count() >= _maxFullVehicles;
+    if (monitorOnly) {
+        qCDebug(MultiVehicleManagerLog()) << "Adding monitor only vehicle" << vehicleId;
+    }
+
+    Vehicle* vehicle = new Vehicle(link, vehicleId, componentId, (MAV_AUTOPILOT)vehicleFirmwareType, (MAV_TYPE)vehicleType, _firmwarePluginManager, _joystickManager, monitorOnly);
     connect(vehicle,                        &Vehicle::requestProtocolVersion,           this, &MultiVehicleManager::_requestProtocolVersion);
     connect(vehicle->vehicleLinkManager(),  &VehicleLinkManager::allLinksRemoved,       this, &MultiVehicleManager::_deleteVehiclePhase1);
     connect(vehicle->parameterManager(),    &ParameterManager::parametersReadyChanged,  this, &MultiVehicleManager::_vehicleParametersReadyChanged);
@@ -275,6 +298,13 @@ void MultiVehicleManager::setActiveVehicle(Vehicle* vehicle)
             emit parameterReadyVehicleAvailableChanged(false);
         }
 
+        if (vehicle && vehicle->monitorOnly()) {
+            vehicle->activateFullVehicle();
+        }
+        if (vehicle) {
+            _initialConnectScheduler->prioritize(vehicle);
+        }
+
         // See explanation in _deleteVehiclePhase1
         _vehicleBeingSetActive = vehicle;
         QTimer::singleShot(20, this, &MultiVehicleManager::_setActiveVehiclePhase2);
@@ -364,9 +394,10 @@ void MultiVehicleManager::setGcsHeartbeatEnabled(bool gcsHeartBeatEnabled)
         settings.setValue(_gcsHeartbeatEnabledKey, gcsHeartBeatEnabled);
 
         if (gcsHeartBeatEnabled) {
-            _gcsHeartbeatTimer.start();
+            _gcsHeartbeatSendId = MAVLinkPeriodicSender::instance()->add(this, _gcsHeartbeatRateMSecs, [this]() { _sendGCSHeartbeat(); });
         } else {
-            _gcsHeartbeatTimer.stop();
+            MAVLinkPeriodicSender::instance()->remove(_gcsHeartbeatSendId);
+            _gcsHeartbeatSendId = 0;
         }
     }
 }
@@ -394,7 +425,7 @@ void MultiVehicleManager::_sendGCSHeartbeat(void)
 
             uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
             int len = mavlink_msg_to_send_buffer(buffer, &message);
-            link->writeBytesThreadSafe((const char*)buffer, len);
+            link->writeBytesThreadSafe((const char*)buffer, len, LinkInterface::WritePriorityHigh);
         }
     }
 }
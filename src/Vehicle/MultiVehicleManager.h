@@ -25,6 +25,8 @@ class FollowMe;
 class JoystickManager;
 class QGCApplication;
 class MAVLinkProtocol;
+class InitialConnectScheduler;
+class TelemetryStreamServer;
 
 Q_DECLARE_LOGGING_CATEGORY(MultiVehicleManagerLog)
 
@@ -68,6 +70,8 @@ public:
 
     Vehicle* offlineEditingVehicle(void) { return _offlineEditingVehicle; }
 
+    InitialConnectScheduler* initialConnectScheduler(void) { return _initialConnectScheduler; }
+
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
@@ -94,6 +98,7 @@ private slots:
     void _vehicleHeartbeatInfo          (LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
     void _requestProtocolVersion        (unsigned version);
     void _coordinateChanged             (QGeoCoordinate coordinate);
+    void _updateTelemetryStreamServer   (void);
 
 private:
     bool _vehicleExists(int vehicleId);
@@ -103,6 +108,8 @@ private:
     Vehicle*    _activeVehicle;                     ///< Currently active vehicle from a ui perspective
     Vehicle*    _offlineEditingVehicle;             ///< Disconnected vechicle used for offline editing
 
+    InitialConnectScheduler* _initialConnectScheduler;
+
     QList<Vehicle*> _vehiclesBeingDeleted;          ///< List of Vehicles being deleted in queued phases
     Vehicle*        _vehicleBeingSetActive;         ///< Vehicle being set active in queued phases
 
@@ -114,10 +121,12 @@ private:
     JoystickManager*            _joystickManager;
     MAVLinkProtocol*            _mavlinkProtocol;
     QGeoCoordinate              _lastKnownLocation;
+    TelemetryStreamServer*      _telemetryStreamServer = nullptr;
 
-    QTimer              _gcsHeartbeatTimer;             ///< Timer to emit heartbeats
+    int                 _gcsHeartbeatSendId = 0;        ///< MAVLinkPeriodicSender id of the heartbeat send, 0 while disabled
     bool                _gcsHeartbeatEnabled;           ///< Enabled/disable heartbeat emission
     static const int    _gcsHeartbeatRateMSecs = 1000;  ///< Heartbeat rate
+    static const int    _maxFullVehicles = 8;           ///< Vehicles connected past this many are created monitor only
     static const char*  _gcsHeartbeatEnabledKey;
 };
 
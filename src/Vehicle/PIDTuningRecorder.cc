@@ -0,0 +1,453 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PIDTuningRecorder.h"
+#include "Vehicle.h"
+#include "QGCApplication.h"
+#include "MAVLinkProtocol.h"
+#include "MAVLinkMessageView.h"
+#include "QGCMemoryAccounting.h"
+
+#include <QtCharts/QXYSeries>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <limits>
+
+QGC_LOGGING_CATEGORY(PIDTuningRecorderLog, "PIDTuningRecorderLog")
+
+PIDTuningRecorder::PIDTuningRecorder(Vehicle* vehicle)
+    : QObject   (vehicle)
+    , _vehicle  (vehicle)
+{
+    connect(&_stepResponseWatcher, &QFutureWatcherBase::finished, this, &PIDTuningRecorder::_stepResponseComplete);
+    qgcApp()->toolbox()->memoryAccounting()->addSource(this, QStringLiteral("Tuning"), [this](){ return _memoryBytes(); });
+}
+
+PIDTuningRecorder::~PIDTuningRecorder()
+{
+    _stepResponseWatcher.waitForFinished();
+}
+
+void PIDTuningRecorder::setRunning(bool running)
+{
+    if (running == this->running()) {
+        return;
+    }
+
+    MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    if (running) {
+        static const int msgIds[] = { MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_ATTITUDE_QUATERNION, MAVLINK_MSG_ID_ATTITUDE_TARGET, MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS };
+        for (int msgId: msgIds) {
+            _subscriptionIds.append(mavlinkProtocol->subscribe(this, _vehicle->id(), MAVLinkProtocol::anyId, msgId,
+                                                               [this](LinkInterface* /* link */, const mavlink_message_t& message) { _handleMessage(message); }));
+        }
+    } else {
+        for (int subscriptionId: _subscriptionIds) {
+            mavlinkProtocol->unsubscribe(subscriptionId);
+        }
+        _subscriptionIds.clear();
+    }
+
+    qCDebug(PIDTuningRecorderLog) << "running" << running;
+    emit runningChanged(running);
+}
+
+void PIDTuningRecorder::clear(void)
+{
+    for (Ring_t& ring: _rings) {
+        ring.samples.clear();
+        ring.samples.squeeze();
+        ring.next = 0;
+    }
+    _firstMSecs = -1;
+    _lastMSecs  = -1;
+    _haveAttitudeQuaternion = false;
+    emit samplesChanged();
+}
+
+double PIDTuningRecorder::durationSecs(void) const
+{
+    return _firstMSecs < 0 ? 0 : (_lastMSecs - _firstMSecs) / 1000.0;
+}
+
+void PIDTuningRecorder::_handleMessage(const mavlink_message_t& message)
+{
+    if (message.compid != _vehicle->defaultComponentId()) {
+        return;
+    }
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        if (_haveAttitudeQuaternion) {
+            // Same values as ATTITUDE_QUATERNION, which is the one requested for tuning
+            return;
+        }
+        const double msecs = QGC_MAVLINK_FIELD(message, attitude, time_boot_ms);
+        _addSample(Roll,        msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, roll)));
+        _addSample(Pitch,       msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, pitch)));
+        _addSample(Yaw,         msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, yaw)));
+        _addSample(RollRate,    msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, rollspeed)));
+        _addSample(PitchRate,   msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, pitchspeed)));
+        _addSample(YawRate,     msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude, yawspeed)));
+    }
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+    {
+        _haveAttitudeQuaternion = true;
+        const double msecs = QGC_MAVLINK_FIELD(message, attitude_quaternion, time_boot_ms);
+        const float q[4] = {
+            QGC_MAVLINK_FIELD(message, attitude_quaternion, q1),
+            QGC_MAVLINK_FIELD(message, attitude_quaternion, q2),
+            QGC_MAVLINK_FIELD(message, attitude_quaternion, q3),
+            QGC_MAVLINK_FIELD(message, attitude_quaternion, q4),
+        };
+        float roll, pitch, yaw;
+        mavlink_quaternion_to_euler(q, &roll, &pitch, &yaw);
+        _addSample(Roll,        msecs, qRadiansToDegrees(roll));
+        _addSample(Pitch,       msecs, qRadiansToDegrees(pitch));
+        _addSample(Yaw,         msecs, qRadiansToDegrees(yaw));
+        _addSample(RollRate,    msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_quaternion, rollspeed)));
+        _addSample(PitchRate,   msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_quaternion, pitchspeed)));
+        _addSample(YawRate,     msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_quaternion, yawspeed)));
+    }
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE_TARGET:
+    {
+        const double    msecs       = QGC_MAVLINK_FIELD(message, attitude_target, time_boot_ms);
+        const uint8_t   typeMask    = QGC_MAVLINK_FIELD(message, attitude_target, type_mask);
+        if (!(typeMask & ATTITUDE_TARGET_TYPEMASK_ATTITUDE_IGNORE)) {
+            float q[4];
+            QGC_MAVLINK_ARRAY(message, attitude_target, q, q);
+            float roll, pitch, yaw;
+            mavlink_quaternion_to_euler(q, &roll, &pitch, &yaw);
+            _addSample(RollSetpoint,    msecs, qRadiansToDegrees(roll));
+            _addSample(PitchSetpoint,   msecs, qRadiansToDegrees(pitch));
+            _addSample(YawSetpoint,     msecs, qRadiansToDegrees(yaw));
+        }
+        if (!(typeMask & ATTITUDE_TARGET_TYPEMASK_BODY_ROLL_RATE_IGNORE)) {
+            _addSample(RollRateSetpoint,    msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_target, body_roll_rate)));
+        }
+        if (!(typeMask & ATTITUDE_TARGET_TYPEMASK_BODY_PITCH_RATE_IGNORE)) {
+            _addSample(PitchRateSetpoint,   msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_target, body_pitch_rate)));
+        }
+        if (!(typeMask & ATTITUDE_TARGET_TYPEMASK_BODY_YAW_RATE_IGNORE)) {
+            _addSample(YawRateSetpoint,     msecs, qRadiansToDegrees(QGC_MAVLINK_FIELD(message, attitude_target, body_yaw_rate)));
+        }
+    }
+        break;
+    case MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS:
+    {
+        const double    msecs   = QGC_MAVLINK_FIELD(message, actuator_output_status, time_usec) / 1000.0;
+        const uint32_t  active  = QGC_MAVLINK_FIELD(message, actuator_output_status, active);
+        float actuators[32];
+        QGC_MAVLINK_ARRAY(message, actuator_output_status, actuator, actuators);
+        for (int i = 0; i <= Actuator7 - Actuator0; i++) {
+            if (active & (1u << i)) {
+                _addSample(Actuator0 + i, msecs, actuators[i]);
+            }
+        }
+    }
+        break;
+    }
+
+    emit samplesChanged();
+}
+
+void PIDTuningRecorder::_addSample(int channel, double msecs, float value)
+{
+    if (_lastMSecs >= 0 && msecs < _lastMSecs - 1000) {
+        // Vehicle rebooted, the old samples are on another time base
+        qCDebug(PIDTuningRecorderLog) << "Vehicle time went back, clearing" << _lastMSecs << msecs;
+        clear();
+    }
+
+    if (_firstMSecs < 0) {
+        _firstMSecs = msecs;
+    }
+    _lastMSecs = qMax(_lastMSecs, msecs);
+
+    Ring_t& ring = _rings[channel];
+    if (ring.samples.count() < _maxSamples) {
+        ring.samples.append({ msecs, value });
+    } else {
+        ring.samples[ring.next] = { msecs, value };
+        if (++ring.next == _maxSamples) {
+            ring.next = 0;
+        }
+    }
+}
+
+QVector<PIDTuningRecorder::Sample_t> PIDTuningRecorder::_windowSamples(int channel, double windowSecs) const
+{
+    QVector<Sample_t> samples;
+
+    if (channel < 0 || channel >= ChannelCount) {
+        return samples;
+    }
+
+    const Ring_t&   ring        = _rings[channel];
+    const int       count       = ring.samples.count();
+    const double    windowStart = _lastMSecs - windowSecs * 1000.0;
+
+    samples.reserve(count);
+    for (int i = 0, idx = ring.next; i < count; i++) {
+        const Sample_t& sample = ring.samples[idx];
+        if (++idx == count) {
+            idx = 0;
+        }
+        if (sample.msecs >= windowStart) {
+            samples.append(sample);
+        }
+    }
+
+    return samples;
+}
+
+QVariantMap PIDTuningRecorder::updateSeries(int channel, QAbstractSeries* series, double windowSecs, int plotWidth)
+{
+    QVariantMap result;
+    QXYSeries* xySeries = qobject_cast<QXYSeries*>(series);
+
+    result[QStringLiteral("count")] = 0;
+    if (!xySeries) {
+        return result;
+    }
+
+    const QVector<Sample_t> samples     = _windowSamples(channel, windowSecs);
+    const int               columns     = qMax(plotWidth, 1);
+    const double            windowStart = _lastMSecs - windowSecs * 1000.0;
+    const double            windowSpan  = qMax(windowSecs * 1000.0, 1.0);
+    const bool              decimate    = samples.count() > columns * 2;
+
+    QVector<QPointF> points;
+    points.reserve(decimate ? columns * 2 : samples.count());
+
+    auto toPoint = [this](const Sample_t& sample) { return QPointF((sample.msecs - _firstMSecs) / 1000.0, sample.value); };
+    auto appendColumn = [&points](const QPointF& columnMin, const QPointF& columnMax) {
+        // Keep the time order of the two points so the line does not step back
+        if (columnMin.x() <= columnMax.x()) {
+            points.append(columnMin);
+            if (columnMax != columnMin) points.append(columnMax);
+        } else {
+            points.append(columnMax);
+            points.append(columnMin);
+        }
+    };
+
+    float   vmin    = std::numeric_limits<float>::max();
+    float   vmax    = std::numeric_limits<float>::lowest();
+    int     column  = -1;
+    QPointF columnMin;
+    QPointF columnMax;
+    for (const Sample_t& sample: samples) {
+        vmin = qMin(vmin, sample.value);
+        vmax = qMax(vmax, sample.value);
+        const QPointF p = toPoint(sample);
+        if (!decimate) {
+            points.append(p);
+            continue;
+        }
+        const int pointColumn = static_cast<int>((sample.msecs - windowStart) * columns / windowSpan);
+        if (pointColumn != column) {
+            if (column != -1) {
+                appendColumn(columnMin, columnMax);
+            }
+            column      = pointColumn;
+            columnMin   = p;
+            columnMax   = p;
+        } else {
+            if (p.y() < columnMin.y()) columnMin = p;
+            if (p.y() > columnMax.y()) columnMax = p;
+        }
+    }
+    if (column != -1) {
+        appendColumn(columnMin, columnMax);
+    }
+
+    xySeries->replace(points);
+
+    result[QStringLiteral("count")] = samples.count();
+    if (!samples.isEmpty()) {
+        result[QStringLiteral("min")] = vmin;
+        result[QStringLiteral("max")] = vmax;
+    }
+    return result;
+}
+
+void PIDTuningRecorder::computeStepResponse(int setpointChannel, int responseChannel, double windowSecs)
+{
+    if (_stepResponseWatcher.isRunning()) {
+        return;
+    }
+
+    const QVector<Sample_t> setpoint = _windowSamples(setpointChannel, windowSecs);
+    const QVector<Sample_t> response = _windowSamples(responseChannel, windowSecs);
+
+    _stepResponseWatcher.setFuture(QtConcurrent::run([setpoint, response]() {
+        return computeStepResponse(setpoint, response);
+    }));
+}
+
+void PIDTuningRecorder::_stepResponseComplete(void)
+{
+    const StepResponse_t result = _stepResponseWatcher.result();
+
+    _stepResponse.clear();
+    _stepResponse[QStringLiteral("steps")]              = result.steps;
+    _stepResponse[QStringLiteral("riseTimeMSecs")]      = result.riseTimeMSecs;
+    _stepResponse[QStringLiteral("overshootPercent")]   = result.overshootPercent;
+    _stepResponse[QStringLiteral("settlingTimeMSecs")]  = result.settlingTimeMSecs;
+    _stepResponse[QStringLiteral("rmsError")]           = result.rmsError;
+    emit stepResponseChanged();
+}
+
+double PIDTuningRecorder::_valueAt(const QVector<Sample_t>& samples, int& index, double msecs)
+{
+    // index only moves forward, so a pass over increasing times is linear overall
+    while (index < samples.count() - 2 && samples[index + 1].msecs <= msecs) {
+        index++;
+    }
+
+    const Sample_t& a = samples[index];
+    const Sample_t& b = samples[qMin(index + 1, samples.count() - 1)];
+    if (b.msecs <= a.msecs || msecs <= a.msecs) {
+        return a.value;
+    }
+    if (msecs >= b.msecs) {
+        return b.value;
+    }
+    return a.value + (b.value - a.value) * (msecs - a.msecs) / (b.msecs - a.msecs);
+}
+
+PIDTuningRecorder::StepResponse_t PIDTuningRecorder::computeStepResponse(const QVector<Sample_t>& setpoint, const QVector<Sample_t>& response)
+{
+    StepResponse_t result = { 0, qQNaN(), qQNaN(), qQNaN(), qQNaN() };
+
+    if (setpoint.count() < 2 || response.count() < 2) {
+        return result;
+    }
+
+    // Tracking error over the time both channels cover
+    double  errorSum    = 0;
+    int     errorCount  = 0;
+    int     spIndex     = 0;
+    for (const Sample_t& sample: response) {
+        if (sample.msecs < setpoint.first().msecs || sample.msecs > setpoint.last().msecs) {
+            continue;
+        }
+        const double error = sample.value - _valueAt(setpoint, spIndex, sample.msecs);
+        errorSum += error * error;
+        errorCount++;
+    }
+    if (errorCount) {
+        result.rmsError = qSqrt(errorSum / errorCount);
+    }
+
+    // Steps are setpoint changes of a good part of the setpoint range between two consecutive samples
+    float spMin = setpoint.first().value;
+    float spMax = spMin;
+    for (const Sample_t& sample: setpoint) {
+        spMin = qMin(spMin, sample.value);
+        spMax = qMax(spMax, sample.value);
+    }
+    const double threshold = (spMax - spMin) * _stepFraction;
+    if (threshold <= 0) {
+        return result;
+    }
+
+    QVector<int> steps;
+    for (int i = 1; i < setpoint.count(); i++) {
+        if (qAbs(setpoint[i].value - setpoint[i - 1].value) >= threshold) {
+            steps.append(i);
+        }
+    }
+
+    double  riseSum         = 0;
+    int     riseCount       = 0;
+    double  overshootSum    = 0;
+    double  settlingSum     = 0;
+    int     settlingCount   = 0;
+    int     respIndex       = 0;
+
+    for (int s = 0; s < steps.count(); s++) {
+        const double    from    = setpoint[steps[s] - 1].value;
+        const double    to      = setpoint[steps[s]].value;
+        const double    delta   = to - from;
+        const double    t0      = setpoint[steps[s]].msecs;
+        const double    tEnd    = qMin(t0 + _stepWindowMSecs, s + 1 < steps.count() ? setpoint[steps[s + 1]].msecs : std::numeric_limits<double>::max());
+
+        while (respIndex < response.count() && response[respIndex].msecs < t0) {
+            respIndex++;
+        }
+
+        double  t10         = -1;
+        double  t90         = -1;
+        double  peak        = 0;
+        double  lastOutside = t0;
+        bool    settled     = true;
+        int     count       = 0;
+        for (int i = respIndex; i < response.count() && response[i].msecs <= tEnd; i++) {
+            // Response as fraction of the step, 0 at the old setpoint and 1 at the new one
+            const double y = (response[i].value - from) / delta;
+            if (t10 < 0 && y >= 0.1) {
+                t10 = response[i].msecs;
+            }
+            if (t90 < 0 && y >= 0.9) {
+                t90 = response[i].msecs;
+            }
+            peak = qMax(peak, y);
+            if (qAbs(y - 1.0) > 0.05) {
+                lastOutside = response[i].msecs;
+                settled = false;
+            } else {
+                settled = true;
+            }
+            count++;
+        }
+
+        if (count < 3) {
+            continue;
+        }
+
+        result.steps++;
+        overshootSum += qMax(0.0, peak - 1.0) * 100.0;
+        if (t10 >= 0 && t90 >= 0) {
+            riseSum += t90 - t10;
+            riseCount++;
+        }
+        if (settled) {
+            settlingSum += lastOutside - t0;
+            settlingCount++;
+        }
+    }
+
+    if (result.steps) {
+        result.overshootPercent = overshootSum / result.steps;
+    }
+    if (riseCount) {
+        result.riseTimeMSecs = riseSum / riseCount;
+    }
+    if (settlingCount) {
+        result.settlingTimeMSecs = settlingSum / settlingCount;
+    }
+
+    return result;
+}
+
+qint64 PIDTuningRecorder::_memoryBytes(void) const
+{
+    qint64 bytes = 0;
+    for (const Ring_t& ring: _rings) {
+        bytes += static_cast<qint64>(ring.samples.capacity()) * static_cast<qint64>(sizeof(Sample_t));
+    }
+    return bytes;
+}
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+#include <QVector>
+#include <QVariantMap>
+#include <QFutureWatcher>
+#include <QtCharts/QAbstractSeries>
+
+Q_DECLARE_LOGGING_CATEGORY(PIDTuningRecorderLog)
+
+QT_CHARTS_USE_NAMESPACE
+
+class Vehicle;
+
+/// Records attitude and rate setpoints against the vehicle response for the PID tuning charts.
+///
+/// The values come straight from ATTITUDE, ATTITUDE_QUATERNION, ATTITUDE_TARGET and ACTUATOR_OUTPUT_STATUS while
+/// running, so every message is kept with its vehicle boot timestamp instead of whatever a ui timer happens to see.
+/// Each channel is a ring of the last _maxSamples samples. The charts get the samples of their time window
+/// decimated to the min and max of each pixel column. Step response metrics of a setpoint/response channel pair are
+/// computed on a worker thread.
+class PIDTuningRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    PIDTuningRecorder(Vehicle* vehicle);
+    ~PIDTuningRecorder();
+
+    enum Channel {
+        Roll = 0,               ///< deg
+        Pitch,
+        Yaw,
+        RollSetpoint,
+        PitchSetpoint,
+        YawSetpoint,
+        RollRate,               ///< deg/s
+        PitchRate,
+        YawRate,
+        RollRateSetpoint,
+        PitchRateSetpoint,
+        YawRateSetpoint,
+        Actuator0,              ///< Normalized actuator output
+        Actuator1,
+        Actuator2,
+        Actuator3,
+        Actuator4,
+        Actuator5,
+        Actuator6,
+        Actuator7,
+        ChannelCount
+    };
+    Q_ENUM(Channel)
+
+    Q_PROPERTY(bool         running         READ running        WRITE setRunning    NOTIFY runningChanged)
+    Q_PROPERTY(double       durationSecs    READ durationSecs                       NOTIFY samplesChanged)  ///< Time since the first sample, x position of the latest samples
+    Q_PROPERTY(QVariantMap  stepResponse    READ stepResponse                       NOTIFY stepResponseChanged)
+
+    /// Replaces the points of series with the samples of channel within the last windowSecs, at most two points per
+    /// pixel column of plotWidth.
+    /// @return { min, max, count } of the plotted values, count 0 if there are none
+    Q_INVOKABLE QVariantMap updateSeries(int channel, QAbstractSeries* series, double windowSecs, int plotWidth);
+
+    /// Computes the step response of response to setpoint over the last windowSecs on a worker thread, emits
+    /// stepResponseChanged when done. Ignored while a previous computation is still running.
+    Q_INVOKABLE void computeStepResponse(int setpointChannel, int responseChannel, double windowSecs);
+
+    Q_INVOKABLE void clear(void);
+
+    bool        running         (void) const { return !_subscriptionIds.isEmpty(); }
+    double      durationSecs    (void) const;
+    QVariantMap stepResponse    (void) const { return _stepResponse; }
+
+    void        setRunning      (bool running);
+
+    typedef struct {
+        double  msecs;          ///< Vehicle boot time
+        float   value;
+    } Sample_t;
+
+    typedef struct {
+        int     steps;              ///< Number of setpoint steps found, the other values are averages over them
+        double  riseTimeMSecs;      ///< 10% to 90% of the step
+        double  overshootPercent;
+        double  settlingTimeMSecs;  ///< Until the response stays within 5% of the step
+        double  rmsError;           ///< Of the response against the setpoint over the whole window
+    } StepResponse_t;
+
+    /// Thread safe
+    static StepResponse_t computeStepResponse(const QVector<Sample_t>& setpoint, const QVector<Sample_t>& response);
+
+signals:
+    void runningChanged     (bool running);
+    void samplesChanged     (void);
+    void stepResponseChanged(void);
+
+private slots:
+    void _stepResponseComplete(void);
+
+private:
+    typedef struct {
+        QVector<Sample_t>   samples;        ///< Ring of _maxSamples once full
+        int                 next = 0;       ///< Next sample is written here, oldest sample once full
+    } Ring_t;
+
+    void                _handleMessage      (const mavlink_message_t& message);
+    void                _addSample          (int channel, double msecs, float value);
+    QVector<Sample_t>   _windowSamples      (int channel, double windowSecs) const;
+    static double       _valueAt            (const QVector<Sample_t>& samples, int& index, double msecs);
+    qint64              _memoryBytes        (void) const;
+
+    Vehicle*                        _vehicle;
+    QList<int>                      _subscriptionIds;
+    Ring_t                          _rings[ChannelCount];
+    double                          _firstMSecs     = -1;
+    double                          _lastMSecs      = -1;
+    bool                            _haveAttitudeQuaternion = false;
+    QVariantMap                     _stepResponse;
+    QFutureWatcher<StepResponse_t>  _stepResponseWatcher;
+
+    static constexpr int    _maxSamples         = 250 * 180;    ///< 3 minutes at 250Hz
+    static constexpr double _stepFraction       = 0.2;          ///< Setpoint change, as fraction of its window range, which counts as a step
+    static constexpr double _stepWindowMSecs    = 2000;         ///< Longest response taken into account after a step
+};
@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PIDTuningRecorderTest.h"
+#include "PIDTuningRecorder.h"
+
+#include <QtMath>
+
+typedef QVector<PIDTuningRecorder::Sample_t> Samples_t;
+
+// Setpoint stepping from 0 to 100 at 500ms, sampled at 100Hz for 3 seconds
+static Samples_t _stepSetpoint(void)
+{
+    Samples_t samples;
+    for (int msecs = 0; msecs < 3000; msecs += 10) {
+        samples.append({ static_cast<double>(msecs), msecs < 500 ? 0.0f : 100.0f });
+    }
+    return samples;
+}
+
+void PIDTuningRecorderTest::_firstOrderStep_test(void)
+{
+    // First order response with a 100ms time constant: rise time (10-90%) is tau * ln(9), there is no overshoot and
+    // it settles within 5% after tau * ln(20)
+    const double tau = 100;
+    Samples_t response;
+    for (int msecs = 0; msecs < 3000; msecs += 10) {
+        const double value = msecs < 500 ? 0 : 100.0 * (1.0 - qExp(-(msecs - 500) / tau));
+        response.append({ static_cast<double>(msecs), static_cast<float>(value) });
+    }
+
+    const PIDTuningRecorder::StepResponse_t result = PIDTuningRecorder::computeStepResponse(_stepSetpoint(), response);
+
+    QCOMPARE(result.steps, 1);
+    QVERIFY(qAbs(result.riseTimeMSecs - tau * qLn(9)) <= 20);
+    QCOMPARE(result.overshootPercent, 0.0);
+    QVERIFY(qAbs(result.settlingTimeMSecs - tau * qLn(20)) <= 20);
+    QVERIFY(!qIsNaN(result.rmsError));
+}
+
+void PIDTuningRecorderTest::_overshootStep_test(void)
+{
+    // Underdamped response peaking at about 130% before settling
+    Samples_t response;
+    for (int msecs = 0; msecs < 3000; msecs += 10) {
+        double value = 0;
+        if (msecs >= 500) {
+            const double t = (msecs - 500) / 1000.0;
+            value = 100.0 * (1.0 - qExp(-4.0 * t) * qCos(10.0 * t));
+        }
+        response.append({ static_cast<double>(msecs), static_cast<float>(value) });
+    }
+
+    float peak = 0;
+    for (const PIDTuningRecorder::Sample_t& sample: response) {
+        peak = qMax(peak, sample.value);
+    }
+
+    const PIDTuningRecorder::StepResponse_t result = PIDTuningRecorder::computeStepResponse(_stepSetpoint(), response);
+
+    QCOMPARE(result.steps, 1);
+    QVERIFY(qAbs(result.overshootPercent - (peak - 100.0)) < 0.5);
+    QVERIFY(!qIsNaN(result.riseTimeMSecs));
+    QVERIFY(result.settlingTimeMSecs > result.riseTimeMSecs);
+}
+
+void PIDTuningRecorderTest::_noStep_test(void)
+{
+    // Constant setpoint tracked with a constant error: no steps, rms error is the offset
+    Samples_t setpoint;
+    Samples_t response;
+    for (int msecs = 0; msecs < 1000; msecs += 10) {
+        setpoint.append({ static_cast<double>(msecs), 10.0f });
+        response.append({ static_cast<double>(msecs), 12.0f });
+    }
+
+    const PIDTuningRecorder::StepResponse_t result = PIDTuningRecorder::computeStepResponse(setpoint, response);
+
+    QCOMPARE(result.steps, 0);
+    QVERIFY(qIsNaN(result.riseTimeMSecs));
+    QVERIFY(qAbs(result.rmsError - 2.0) < 1e-6);
+}
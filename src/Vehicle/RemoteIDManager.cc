@@ -13,6 +13,7 @@
 #include "RemoteIDSettings.h"
 #include "QGCQGeoCoordinate.h"
 #include "PositionManager.h"
+#include "MAVLinkPeriodicSender.h"
 
 #include <QDebug>
 
@@ -41,6 +42,8 @@ RemoteIDManager::RemoteIDManager(Vehicle* vehicle)
     , _targetSystem         (0) // By default 0 means broadcast
     , _targetComponent      (0) // By default 0 means broadcast
     , _enforceSendingSelfID (false)
+    , _nextStaticMessage    (0)
+    , _sendPhaseMsecs       (0)
 {
     _mavlink = qgcApp()->toolbox()->mavlinkProtocol();
     _settings = qgcApp()->toolbox()->settingsManager()->remoteIDSettings();
@@ -51,9 +54,8 @@ RemoteIDManager::RemoteIDManager(Vehicle* vehicle)
     _odidTimeoutTimer.setInterval(RID_TIMEOUT);
     connect(&_odidTimeoutTimer, &QTimer::timeout, this, &RemoteIDManager::_odidTimeout);
 
-    // Timer to send messages at a constant rate
-    _sendMessagesTimer.setInterval(SENDING_RATE_MSEC);
-    connect(&_sendMessagesTimer, &QTimer::timeout, this, &RemoteIDManager::_sendMessages);
+    // Spread vehicles over the send period so their messages don't all hit the links at once
+    _sendPhaseMsecs = (vehicle->id() * 97) % SENDING_RATE_MSEC;
 
     // GCS GPS position updates to track the health of the GPS data
     connect(_positionManager, &QGCPositionManager::positionInfoUpdated, this, &RemoteIDManager::_updateLastGCSPositionInfo);
@@ -63,6 +65,20 @@ RemoteIDManager::RemoteIDManager(Vehicle* vehicle)
     connect(_settings->basicIDType(), &Fact::rawValueChanged, this, &RemoteIDManager::_checkGCSBasicID);
     connect(_settings->basicIDUaType(), &Fact::rawValueChanged, this, &RemoteIDManager::_checkGCSBasicID);
 
+    // Static message snapshot is only rebuilt when the settings it comes from change
+    for (Fact* fact : { _settings->basicID(), _settings->basicIDType(), _settings->basicIDUaType(),
+                        _settings->selfIDType(), _settings->selfIDFree(), _settings->selfIDEmergency(), _settings->selfIDExtended(),
+                        _settings->operatorID(), _settings->operatorIDType() }) {
+        connect(fact, &Fact::rawValueChanged, this, &RemoteIDManager::_updateStaticMessages);
+    }
+    memset(&_basicIDMsg,    0, sizeof(_basicIDMsg));
+    memset(&_selfIDMsg,     0, sizeof(_selfIDMsg));
+    memset(&_operatorIDMsg, 0, sizeof(_operatorIDMsg));
+    for (int i = 0; i < StaticMessageCount; i++) {
+        _staticMessageDirty[i] = true;
+    }
+    _updateStaticMessages();
+
     // Assign vehicle sysid and compid. GCS must target these messages to autopilot, and autopilot will redirect them to RID device
     _targetSystem = _vehicle->id();
     _targetComponent = _vehicle->compId();
@@ -83,7 +99,9 @@ void RemoteIDManager::mavlinkMessageReceived(mavlink_message_t& message )
 void RemoteIDManager::_odidTimeout()
 {
     _commsGood = false;
-    _sendMessagesTimer.stop(); // We stop sending messages if the communication with the RID device is down
+    // We stop sending messages if the communication with the RID device is down
+    MAVLinkPeriodicSender::instance()->remove(_sendMessagesSendId);
+    _sendMessagesSendId = 0;
     emit commsGoodChanged();
     qCDebug(RemoteIDManagerLog) << "We stopped receiving heartbeat from RID device.";
 }
@@ -112,7 +130,7 @@ void RemoteIDManager::_handleArmStatus(mavlink_message_t& message)
 
     if (!_commsGood) {
         _commsGood = true;
-        _sendMessagesTimer.start();     // Start sending our messages
+        _startSending();                // Start sending our messages
         _checkGCSBasicID();             // Check if basicID is good to send 
         checkOperatorID();              // Check if OperatorID is good in case we want to send it from start because of the settings
         emit commsGoodChanged();
@@ -152,6 +170,17 @@ void RemoteIDManager::_handleArmStatus(mavlink_message_t& message)
     }
 }
 
+void RemoteIDManager::_startSending()
+{
+    // The RID device may have just come up, so it needs everything again
+    for (int i = 0; i < StaticMessageCount; i++) {
+        _staticMessageDirty[i] = true;
+    }
+    if (!_sendMessagesSendId) {
+        _sendMessagesSendId = MAVLinkPeriodicSender::instance()->add(this, SENDING_RATE_MSEC, [this]() { _sendMessages(); }, _sendPhaseMsecs);
+    }
+}
+
 // Function that sends messages periodically
 void RemoteIDManager::_sendMessages()
 {
@@ -159,108 +188,157 @@ void RemoteIDManager::_sendMessages()
     if (!_settings->enable()->rawValue().toBool()) {
         return;
     }
-    
-    // We always try to send System
-    _sendSystem();
-    
-    // only send it if the information is correct and the tickbox in settings is set
-    if (_GCSBasicIDValid && _settings->sendBasicID()->rawValue().toBool()) {
-        _sendBasicID();
+
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    SharedLinkInterfacePtr sharedLink = weakLink.lock();
+    if (!sharedLink) {
+        return;
     }
     
-    // We only send selfID if the pilot wants it or in case of a declared emergency. If an emergency is cleared
-    // we also keep sending the message, to be sure the non emergency state makes it up to the vehicle
-    if (_settings->sendSelfID()->rawValue().toBool() || _emergencyDeclared || _enforceSendingSelfID) {
-        _sendSelfIDMsg();
+    // We always try to send System
+    _sendSystem(sharedLink.get());
+
+    // Static messages which changed go out right away
+    bool staticSent[StaticMessageCount] = {};
+    bool anySent = false;
+    for (int i = 0; i < StaticMessageCount; i++) {
+        StaticMessage staticMessage = static_cast<StaticMessage>(i);
+        if (_staticMessageDirty[i] && _staticMessageEnabled(staticMessage)) {
+            _sendStaticMessage(sharedLink.get(), staticMessage);
+            staticSent[i] = anySent = true;
+        }
     }
 
-    // We only send the OperatorID if the pilot wants it or if the region we have set is europe. 
-    // To be able to send it, it needs to be filled correclty
-    if ((_settings->sendOperatorID()->rawValue().toBool() || (_settings->region()->rawValue().toInt() == Region::EU)) && _operatorIDGood) {
-        _sendOperatorID();
+    // Otherwise refresh one of them, the RID device keeps broadcasting what it got last
+    if (!anySent) {
+        for (int i = 0; i < StaticMessageCount; i++) {
+            StaticMessage staticMessage = static_cast<StaticMessage>((_nextStaticMessage + i) % StaticMessageCount);
+            if (_staticMessageEnabled(staticMessage)) {
+                _sendStaticMessage(sharedLink.get(), staticMessage);
+                staticSent[staticMessage] = true;
+                _nextStaticMessage = (staticMessage + 1) % StaticMessageCount;
+                break;
+            }
+        }
     }
 
+    // In case of a declared emergency selfID goes out every time. If an emergency is cleared
+    // we also keep sending the message, to be sure the non emergency state makes it up to the vehicle
+    if ((_emergencyDeclared || _enforceSendingSelfID) && !staticSent[SelfID]) {
+        _sendStaticMessage(sharedLink.get(), SelfID);
+    }
 }
 
-void RemoteIDManager::_sendSelfIDMsg()
+bool RemoteIDManager::_staticMessageEnabled(StaticMessage staticMessage)
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-    SharedLinkInterfacePtr sharedLink = weakLink.lock();
-
-    if (sharedLink) {
-        mavlink_message_t msg;
-
-        mavlink_msg_open_drone_id_self_id_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    _id_or_mac_unknown,
-                                                    _emergencyDeclared ? 1 : _settings->selfIDType()->rawValue().toInt(), // If emergency is delcared we send directly a 1 (1 = EMERGENCY)
-                                                    _getSelfIDDescription()); // Depending on the type of SelfID we send a different description
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+    switch (staticMessage) {
+    case BasicID:
+        // only send it if the information is correct and the tickbox in settings is set
+        return _GCSBasicIDValid && _settings->sendBasicID()->rawValue().toBool();
+    case SelfID:
+        // We only send selfID if the pilot wants it or in case of a declared emergency
+        return _settings->sendSelfID()->rawValue().toBool() || _emergencyDeclared || _enforceSendingSelfID;
+    case OperatorID:
+        // We only send the OperatorID if the pilot wants it or if the region we have set is europe. 
+        // To be able to send it, it needs to be filled correclty
+        return (_settings->sendOperatorID()->rawValue().toBool() || (_settings->region()->rawValue().toInt() == Region::EU)) && _operatorIDGood;
+    default:
+        return false;
     }
 }
 
-// We need to return the correct description for the self ID type we have selected
-const char* RemoteIDManager::_getSelfIDDescription()
+void RemoteIDManager::_sendStaticMessage(LinkInterface* link, StaticMessage staticMessage)
 {
-    QByteArray bytesFree = (_settings->selfIDFree()->rawValue().toString()).toLocal8Bit();
-    QByteArray bytesEmergency = (_settings->selfIDEmergency()->rawValue().toString()).toLocal8Bit();
-    QByteArray bytesExtended = (_settings->selfIDExtended()->rawValue().toString()).toLocal8Bit();
-
-    const char* descriptionToSend;
+    mavlink_message_t msg;
 
-    if (_emergencyDeclared) {
-        // If emergency is declared we dont care about the settings and we send emergency directly
-        descriptionToSend = bytesEmergency.data();
-    } else {
-        switch (_settings->selfIDType()->rawValue().toInt()) {
-            case 0:
-                descriptionToSend = bytesFree.data();
-                break;
-            case 1:
-                descriptionToSend = bytesEmergency.data();
-                break;
-            case 2:
-                descriptionToSend = bytesExtended.data();
-                break;
-            default:
-                descriptionToSend = bytesEmergency.data();
-        }
+    switch (staticMessage) {
+    case BasicID:
+        _basicIDMsg.target_system       = _targetSystem;
+        _basicIDMsg.target_component    = _targetComponent;
+        mavlink_msg_open_drone_id_basic_id_encode_chan(_mavlink->getSystemId(), _mavlink->getComponentId(), link->mavlinkChannel(), &msg, &_basicIDMsg);
+        break;
+    case SelfID:
+        _selfIDMsg.target_system        = _targetSystem;
+        _selfIDMsg.target_component     = _targetComponent;
+        mavlink_msg_open_drone_id_self_id_encode_chan(_mavlink->getSystemId(), _mavlink->getComponentId(), link->mavlinkChannel(), &msg, &_selfIDMsg);
+        break;
+    case OperatorID:
+        _operatorIDMsg.target_system    = _targetSystem;
+        _operatorIDMsg.target_component = _targetComponent;
+        mavlink_msg_open_drone_id_operator_id_encode_chan(_mavlink->getSystemId(), _mavlink->getComponentId(), link->mavlinkChannel(), &msg, &_operatorIDMsg);
+        break;
+    default:
+        return;
     }
-    
-    return descriptionToSend;
+
+    _vehicle->sendMessageOnLinkThreadSafe(link, msg);
+    _staticMessageDirty[staticMessage] = false;
 }
 
-void RemoteIDManager::_sendOperatorID()
+void RemoteIDManager::_updateStaticMessages()
 {
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-    SharedLinkInterfacePtr sharedLink = weakLink.lock();
-
-    if (sharedLink) {
-        mavlink_message_t msg;
-
-        QByteArray bytesOperatorID = (_settings->operatorID()->rawValue().toString()).toLocal8Bit();
-        const char* descriptionToSend = bytesOperatorID.data();
+    mavlink_open_drone_id_basic_id_t basicID;
+    memset(&basicID, 0, sizeof(basicID));
+    QByteArray bytesBasicID = _settings->basicID()->rawValue().toString().toLocal8Bit();
+    basicID.id_type = _settings->basicIDType()->rawValue().toUInt();
+    basicID.ua_type = _settings->basicIDUaType()->rawValue().toUInt();
+    // Padded with zeros if smaller, extra bytes excluded if bigger
+    memcpy(basicID.uas_id, bytesBasicID.constData(), qMin(static_cast<int>(sizeof(basicID.uas_id)), bytesBasicID.size()));
+
+    mavlink_open_drone_id_self_id_t selfID;
+    memset(&selfID, 0, sizeof(selfID));
+    QByteArray bytesSelfID = _getSelfIDDescription();
+    selfID.description_type = _emergencyDeclared ? 1 : _settings->selfIDType()->rawValue().toInt(); // If emergency is delcared we send directly a 1 (1 = EMERGENCY)
+    memcpy(selfID.description, bytesSelfID.constData(), qMin(static_cast<int>(sizeof(selfID.description)), bytesSelfID.size()));
+
+    mavlink_open_drone_id_operator_id_t operatorID;
+    memset(&operatorID, 0, sizeof(operatorID));
+    QByteArray bytesOperatorID = _settings->operatorID()->rawValue().toString().toLocal8Bit();
+    operatorID.operator_id_type = _settings->operatorIDType()->rawValue().toInt();
+    memcpy(operatorID.operator_id, bytesOperatorID.constData(), qMin(static_cast<int>(sizeof(operatorID.operator_id)), bytesOperatorID.size()));
+
+    // Target system/component are only filled in when sending, so compare without them
+    basicID.target_system       = _basicIDMsg.target_system;
+    basicID.target_component    = _basicIDMsg.target_component;
+    selfID.target_system        = _selfIDMsg.target_system;
+    selfID.target_component     = _selfIDMsg.target_component;
+    operatorID.target_system    = _operatorIDMsg.target_system;
+    operatorID.target_component = _operatorIDMsg.target_component;
+    if (memcmp(&basicID, &_basicIDMsg, sizeof(basicID)) != 0) {
+        _basicIDMsg = basicID;
+        _staticMessageDirty[BasicID] = true;
+    }
+    if (memcmp(&selfID, &_selfIDMsg, sizeof(selfID)) != 0) {
+        _selfIDMsg = selfID;
+        _staticMessageDirty[SelfID] = true;
+    }
+    if (memcmp(&operatorID, &_operatorIDMsg, sizeof(operatorID)) != 0) {
+        _operatorIDMsg = operatorID;
+        _staticMessageDirty[OperatorID] = true;
+    }
+}
 
-        mavlink_msg_open_drone_id_operator_id_pack_chan(
-                                                    _mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    _id_or_mac_unknown,
-                                                    _settings->operatorIDType()->rawValue().toInt(),
-                                                    descriptionToSend);
+// We need to return the correct description for the self ID type we have selected
+QByteArray RemoteIDManager::_getSelfIDDescription()
+{
+    if (_emergencyDeclared) {
+        // If emergency is declared we dont care about the settings and we send emergency directly
+        return _settings->selfIDEmergency()->rawValue().toString().toLocal8Bit();
+    }
 
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+    switch (_settings->selfIDType()->rawValue().toInt()) {
+        case 0:
+            return _settings->selfIDFree()->rawValue().toString().toLocal8Bit();
+        case 2:
+            return _settings->selfIDExtended()->rawValue().toString().toLocal8Bit();
+        case 1:
+        default:
+            return _settings->selfIDEmergency()->rawValue().toString().toLocal8Bit();
     }
 }
 
-void RemoteIDManager::_sendSystem()
+void RemoteIDManager::_sendSystem(LinkInterface* link)
+
 {
     QGeoCoordinate      gcsPosition;
     QGeoPositionInfo    geoPositionInfo;
@@ -322,33 +400,28 @@ void RemoteIDManager::_sendSystem()
         
     }
 
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-    SharedLinkInterfacePtr sharedLink = weakLink.lock();
-    
-    if (sharedLink) {
-        mavlink_message_t msg;
-
-        mavlink_msg_open_drone_id_system_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    _id_or_mac_unknown,
-                                                    _settings->locationType()->rawValue().toUInt(),
-                                                    _settings->classificationType()->rawValue().toUInt(),
-                                                    geoPositionInfo.isValid() ? ( gcsPosition.latitude()  * 1.0e7 ) : 0, // If position not valid, send a 0
-                                                    geoPositionInfo.isValid() ? ( gcsPosition.longitude() * 1.0e7 ) : 0, // If position not valid, send a 0
-                                                    AREA_COUNT,
-                                                    AREA_RADIUS,
-                                                    -1000.0f,
-                                                    -1000.0f,
-                                                    _settings->categoryEU()->rawValue().toUInt(),
-                                                    _settings->classEU()->rawValue().toUInt(),
-                                                    geoPositionInfo.isValid() ? gcsPosition.altitude() : 0, // If position not valid, send a 0
-                                                    _timestamp2019()), // Time stamp needs to be since 00:00:00 1/1/2019
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-    }
+    mavlink_message_t msg;
+
+    mavlink_msg_open_drone_id_system_pack_chan(_mavlink->getSystemId(),
+                                                _mavlink->getComponentId(),
+                                                link->mavlinkChannel(),
+                                                &msg,
+                                                _targetSystem,
+                                                _targetComponent,
+                                                _id_or_mac_unknown,
+                                                _settings->locationType()->rawValue().toUInt(),
+                                                _settings->classificationType()->rawValue().toUInt(),
+                                                geoPositionInfo.isValid() ? ( gcsPosition.latitude()  * 1.0e7 ) : 0, // If position not valid, send a 0
+                                                geoPositionInfo.isValid() ? ( gcsPosition.longitude() * 1.0e7 ) : 0, // If position not valid, send a 0
+                                                AREA_COUNT,
+                                                AREA_RADIUS,
+                                                -1000.0f,
+                                                -1000.0f,
+                                                _settings->categoryEU()->rawValue().toUInt(),
+                                                _settings->classEU()->rawValue().toUInt(),
+                                                geoPositionInfo.isValid() ? gcsPosition.altitude() : 0, // If position not valid, send a 0
+                                                _timestamp2019()), // Time stamp needs to be since 00:00:00 1/1/2019
+    _vehicle->sendMessageOnLinkThreadSafe(link, msg);
 }
 
 // Returns seconds elapsed since 00:00:00 1/1/2019
@@ -359,34 +432,6 @@ uint32_t RemoteIDManager::_timestamp2019()
     return ((QDateTime::currentDateTime().currentSecsSinceEpoch()) - secsSinceEpoch2019);
 }
 
-void RemoteIDManager::_sendBasicID()
-{
-    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-    SharedLinkInterfacePtr sharedLink = weakLink.lock();
-
-    if (sharedLink) {
-        mavlink_message_t msg;
-        
-        QString basicIDTemp = _settings->basicID()->rawValue().toString();
-        QByteArray ba = basicIDTemp.toLocal8Bit();
-        // To make sure the buffer is large enough to fit the message. It will add padding bytes if smaller, or exclude the extra ones if bigger 
-        ba.resize(MAVLINK_MSG_OPEN_DRONE_ID_BASIC_ID_FIELD_UAS_ID_LEN);
-
-        mavlink_msg_open_drone_id_basic_id_pack_chan(_mavlink->getSystemId(),
-                                                    _mavlink->getComponentId(),
-                                                    sharedLink->mavlinkChannel(),
-                                                    &msg,
-                                                    _targetSystem,
-                                                    _targetComponent,
-                                                    _id_or_mac_unknown,
-                                                    _settings->basicIDType()->rawValue().toUInt(),
-                                                    _settings->basicIDUaType()->rawValue().toUInt(),
-                                                    reinterpret_cast<const unsigned char*>(ba.constData())),
-
-        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-    }
-}
-
 void RemoteIDManager::_checkGCSBasicID()
 {
     QString basicID = _settings->basicID()->rawValue().toString();
@@ -418,6 +463,7 @@ void RemoteIDManager::setEmergency(bool declare)
     // this message. Otherwise, if non optimal connection quality, vehicle RID device
     // could remain in the wrong state. It is clarified to the user in remoteidsettings.qml
     _enforceSendingSelfID = true;
+    _updateStaticMessages();
 
     qCDebug(RemoteIDManagerLog) << ( declare ? "Emergency declared." : "Emergency cleared.");
 }
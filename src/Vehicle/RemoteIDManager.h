@@ -23,6 +23,11 @@ class RemoteIDSettings;
 class QGCPositionManager;
 
 // Supporting Opend Dron ID protocol
+//
+// System messages carry the operator location and are sent every SENDING_RATE_MSEC. The static messages (basic ID,
+// self ID, operator ID) are built once from the settings into a cached snapshot, sent right away when they change and
+// otherwise refreshed round robin, one per period, since the RID device keeps broadcasting the last one received.
+// Each vehicle sends at its own phase within the period so multiple vehicles don't burst the links at the same time.
 class RemoteIDManager : public QObject
 {
     Q_OBJECT
@@ -80,23 +85,28 @@ private slots:
     void _sendMessages();
     void _updateLastGCSPositionInfo(QGeoPositionInfo update);
     void _checkGCSBasicID();
+    void _updateStaticMessages();
+    void _startSending();
 
 private:
     void _handleArmStatus(mavlink_message_t& message);
 
-    // Self ID 
-    void        _sendSelfIDMsg ();
-    const char* _getSelfIDDescription();
+    enum StaticMessage {
+        BasicID,
+        SelfID,
+        OperatorID,
+        StaticMessageCount
+    };
+
+    bool        _staticMessageEnabled(StaticMessage staticMessage);
+    void        _sendStaticMessage  (LinkInterface* link, StaticMessage staticMessage);
 
-    // Operator ID
-    void        _sendOperatorID ();
+    // Self ID 
+    QByteArray  _getSelfIDDescription();
 
     // System
-    void        _sendSystem();
+    void        _sendSystem(LinkInterface* link);
     uint32_t    _timestamp2019();
-
-    // Basic ID
-    void        _sendBasicID();
     
     MAVLinkProtocol*    _mavlink;
     Vehicle*            _vehicle;
@@ -122,7 +132,15 @@ private:
     
     static const uint8_t* _id_or_mac_unknown;
 
+    // Snapshot of the static messages, target system/component are filled in when sending
+    mavlink_open_drone_id_basic_id_t    _basicIDMsg;
+    mavlink_open_drone_id_self_id_t     _selfIDMsg;
+    mavlink_open_drone_id_operator_id_t _operatorIDMsg;
+    bool        _staticMessageDirty[StaticMessageCount];    ///< Changed since last sent
+    int         _nextStaticMessage;                         ///< Round robin refresh
+    int         _sendPhaseMsecs;                            ///< Offset of this vehicle within the send period
+
     // Timers
     QTimer _odidTimeoutTimer;
-    QTimer _sendMessagesTimer;
+    int    _sendMessagesSendId = 0;                         ///< MAVLinkPeriodicSender id while sending
 };
\ No newline at end of file
@@ -46,7 +46,7 @@ void SendMavCommandWithHandlerTest::_testCaseWorker(TestCase_t& testCase)
     _mockLink->clearSendMavCommandCounts();
     vehicle->sendMavCommandWithHandler(_mavCmdResultHandler, &testCase, MAV_COMP_ID_AUTOPILOT1, testCase.command);
     QVERIFY(QTest::qWaitFor([&]() { return _handlerCalled; }, 10000));
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, testCase.command),  -1);
+    QCOMPARE(vehicle->isMavCommandPending(MAV_COMP_ID_AUTOPILOT1, testCase.command), false);
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command),                  testCase.expectedSendCount);
 
     _disconnectMockLink();
@@ -81,7 +81,7 @@ void SendMavCommandWithHandlerTest::_duplicateCommand(void)
 
     // Duplicate command response should happen immediately
     QVERIFY(_handlerCalled);
-    QVERIFY(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, testCase.command) != -1);
+    QVERIFY(vehicle->isMavCommandPending(MAV_COMP_ID_AUTOPILOT1, testCase.command));
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command), 1);
 }
 
@@ -110,7 +110,7 @@ void SendMavCommandWithHandlerTest::_compIdAllFailure(void)
     _mockLink->clearSendMavCommandCounts();
     vehicle->sendMavCommandWithHandler(_compIdAllMavCmdResultHandler, nullptr, MAV_COMP_ID_ALL, testCase.command);
     QCOMPARE(_handlerCalled,                                                            true);
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_ALL, testCase.command), -1);
+    QCOMPARE(vehicle->isMavCommandPending(MAV_COMP_ID_ALL, testCase.command), false);
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command),                          testCase.expectedSendCount);
 
     _disconnectMockLink();
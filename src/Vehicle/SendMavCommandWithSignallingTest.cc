@@ -41,7 +41,7 @@ void SendMavCommandWithSignallingTest::_testCaseWorker(TestCase_t& testCase)
     QCOMPARE(arguments.at(2).toInt(),                                       testCase.command);
     QCOMPARE(arguments.at(3).toInt(),                                       testCase.expectedCommandResult);
     QCOMPARE(arguments.at(4).value<Vehicle::MavCmdResultFailureCode_t>(),   testCase.expectedFailureCode);
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED), -1);
+    QCOMPARE(vehicle->isMavCommandPending(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED), false);
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command),              testCase.expectedSendCount);
 
     _disconnectMockLink();
@@ -77,5 +77,5 @@ void SendMavCommandWithSignallingTest::_duplicateCommand(void)
     QCOMPARE(arguments.at(3).toInt(),                                                   (int)MAV_RESULT_FAILED);
     QCOMPARE(arguments.at(4).value<Vehicle::MavCmdResultFailureCode_t>(),               Vehicle::MavCmdResultFailureDuplicateCommand);
     QCOMPARE(_mockLink->sendMavCommandCount(MockLink::MAV_CMD_MOCKLINK_NO_RESPONSE),    1);
-    QVERIFY(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_NO_RESPONSE) != -1);
+    QVERIFY(vehicle->isMavCommandPending(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_NO_RESPONSE));
 }
@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryArchive.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QTextStream>
+#include <QThread>
+
+#include <cmath>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TelemetryArchiveLog, "TelemetryArchiveLog")
+
+const char* TelemetryArchive::_magic = "QGCTARC1";
+
+bool TelemetryArchive::open(const QString& fileName, const QStringList& columns, double rateHz)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCWarning(TelemetryArchiveLog) << "Unable to create telemetry archive" << fileName << _file.errorString();
+        return false;
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version          = _version;
+    header.byteOrderMark    = _byteOrderMark;
+
+    QDataStream stream(&_file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.writeRawData(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream << rateHz << columns;
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(TelemetryArchiveLog) << "Writing telemetry archive header failed" << fileName << _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    _fileName       = fileName;
+    _columnCount    = columns.count();
+    _block.rowCount = 0;
+    _block.timestamps.resize(_rowsPerBlock);
+    _block.values.resize(_rowsPerBlock * _columnCount);
+
+    _stop           = false;
+    _writerThread   = QThread::create([this]() { _writeLoop(); });
+    _writerThread->start();
+
+    qCDebug(TelemetryArchiveLog) << "Writing telemetry archive" << fileName << "columns:" << _columnCount;
+
+    return true;
+}
+
+void TelemetryArchive::append(qint64 timestampMSecs, const QVector<double>& values)
+{
+    if (!isOpen() || values.count() != _columnCount) {
+        return;
+    }
+
+    const int row = _block.rowCount++;
+    _block.timestamps[row] = timestampMSecs;
+    for (int column=0; column<_columnCount; column++) {
+        _block.values[(column * _rowsPerBlock) + row] = values[column];
+    }
+
+    if (_block.rowCount == _rowsPerBlock) {
+        _queueBlock();
+    }
+}
+
+void TelemetryArchive::close(void)
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    if (_block.rowCount) {
+        _queueBlock();
+    }
+
+    _queueLock.lock();
+    _stop = true;
+    _queueWake.wakeOne();
+    _queueLock.unlock();
+
+    _writerThread->wait();
+    delete _writerThread;
+    _writerThread = nullptr;
+    _file.close();
+}
+
+void TelemetryArchive::_queueBlock(void)
+{
+    QMutexLocker locker(&_queueLock);
+    _queue.append(_block);
+    _queueWake.wakeOne();
+    locker.unlock();
+
+    // The queued copy shares nothing with the block we keep filling
+    _block.rowCount = 0;
+    _block.timestamps.detach();
+    _block.values.detach();
+}
+
+void TelemetryArchive::_writeLoop(void)
+{
+    QMutexLocker locker(&_queueLock);
+    while (!_stop || !_queue.isEmpty()) {
+        if (_queue.isEmpty()) {
+            _queueWake.wait(&_queueLock);
+            continue;
+        }
+        Block_t block = _queue.takeFirst();
+        locker.unlock();
+        _writeBlock(block);
+        locker.relock();
+    }
+}
+
+void TelemetryArchive::_writeBlock(const Block_t& block)
+{
+    // Only the used rows of each column are stored
+    const int   rowCount = block.rowCount;
+    QByteArray  columns;
+    columns.reserve(rowCount * static_cast<int>(sizeof(qint64) + (static_cast<size_t>(_columnCount) * sizeof(double))));
+    columns.append(reinterpret_cast<const char*>(block.timestamps.constData()), rowCount * static_cast<int>(sizeof(qint64)));
+    for (int column=0; column<_columnCount; column++) {
+        columns.append(reinterpret_cast<const char*>(block.values.constData() + (column * _rowsPerBlock)), rowCount * static_cast<int>(sizeof(double)));
+    }
+
+    const QByteArray compressed = qCompress(columns);
+
+    BlockHeader_t blockHeader;
+    blockHeader.rowCount        = static_cast<quint32>(rowCount);
+    blockHeader.compressedSize  = static_cast<quint32>(compressed.size());
+    if (_file.write(reinterpret_cast<const char*>(&blockHeader), sizeof(blockHeader)) != sizeof(blockHeader) ||
+            _file.write(compressed) != compressed.size()) {
+        qCWarning(TelemetryArchiveLog) << "Writing telemetry archive failed" << _fileName << _file.errorString();
+        return;
+    }
+    _file.flush();
+}
+
+bool TelemetryArchive::convertToCsv(const QString& archiveFileName, const QString& csvFileName, QString& errorString)
+{
+    QFile archiveFile(archiveFileName);
+    if (!archiveFile.open(QFile::ReadOnly)) {
+        errorString = tr("Unable to open telemetry archive %1: %2").arg(archiveFileName, archiveFile.errorString());
+        return false;
+    }
+
+    Header_t header;
+    if (archiveFile.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, _magic, sizeof(header.magic)) != 0 ||
+            header.version != _version ||
+            header.byteOrderMark != _byteOrderMark) {
+        errorString = tr("%1 is not a telemetry archive").arg(archiveFileName);
+        return false;
+    }
+
+    double      rateHz;
+    QStringList columnNames;
+    QDataStream schemaStream(&archiveFile);
+    schemaStream.setVersion(QDataStream::Qt_5_12);
+    schemaStream >> rateHz >> columnNames;
+    if (schemaStream.status() != QDataStream::Ok) {
+        errorString = tr("Telemetry archive %1 has a corrupt header").arg(archiveFileName);
+        return false;
+    }
+
+    QFile csvFile(csvFileName);
+    if (!csvFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        errorString = tr("Unable to create %1: %2").arg(csvFileName, csvFile.errorString());
+        return false;
+    }
+
+    QTextStream csvStream(&csvFile);
+    csvStream << "Timestamp," << columnNames.join(",") << "\n";
+
+    const int columnCount = columnNames.count();
+    while (!archiveFile.atEnd()) {
+        BlockHeader_t blockHeader;
+        if (archiveFile.read(reinterpret_cast<char*>(&blockHeader), sizeof(blockHeader)) != sizeof(blockHeader)) {
+            // A partial block at the end is from an interrupted session and is ignored
+            break;
+        }
+        const QByteArray columns = qUncompress(archiveFile.read(blockHeader.compressedSize));
+        const int rowCount = static_cast<int>(blockHeader.rowCount);
+        if (columns.size() != rowCount * static_cast<int>(sizeof(qint64) + (static_cast<size_t>(columnCount) * sizeof(double)))) {
+            qCWarning(TelemetryArchiveLog) << "Ignoring corrupt block in" << archiveFileName;
+            break;
+        }
+
+        const char* timestamps  = columns.constData();
+        const char* values      = timestamps + (rowCount * sizeof(qint64));
+        for (int row=0; row<rowCount; row++) {
+            qint64 timestampMSecs;
+            memcpy(&timestampMSecs, timestamps + (row * sizeof(qint64)), sizeof(timestampMSecs));
+            csvStream << QDateTime::fromMSecsSinceEpoch(timestampMSecs).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz"));
+            for (int column=0; column<columnCount; column++) {
+                double value;
+                memcpy(&value, values + (((column * rowCount) + row) * sizeof(double)), sizeof(value));
+                csvStream << ",";
+                if (!std::isnan(value)) {
+                    csvStream << QString::number(value, 'g', 10);
+                }
+            }
+            csvStream << "\n";
+        }
+    }
+
+    csvStream.flush();
+    if (csvStream.status() != QTextStream::Ok) {
+        errorString = tr("Writing %1 failed: %2").arg(csvFileName, csvFile.errorString());
+        return false;
+    }
+
+    return true;
+}
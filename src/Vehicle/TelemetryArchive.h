@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <QLoggingCategory>
+#include <QCoreApplication>
+
+class QThread;
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryArchiveLog)
+
+/// Columnar binary archive of vehicle telemetry.
+///
+/// The schema (one column per Fact) is fixed when the archive is opened. Samples are appended as plain values with
+/// no text formatting and are collected into blocks of _rowsPerBlock rows. Each full block is stored column by column
+/// and zlib compressed, and is compressed and written on a writer thread so the GUI thread only copies values.
+/// convertToCsv() turns an archive into the csv format QGC used to write directly.
+class TelemetryArchive
+{
+    Q_DECLARE_TR_FUNCTIONS(TelemetryArchive)
+
+public:
+    TelemetryArchive(void) = default;
+    ~TelemetryArchive() { close(); }
+
+    /// Creates the archive, replacing an existing file
+    ///     @param columns  Column names, values passed to append are in this order
+    ///     @param rateHz   Sample rate, stored for information only
+    bool open(const QString& fileName, const QStringList& columns, double rateHz);
+
+    /// Appends a row. values must have one entry per column.
+    void append(qint64 timestampMSecs, const QVector<double>& values);
+
+    /// Writes the last partial block and closes the archive
+    void close(void);
+
+    bool            isOpen      (void) const { return _writerThread != nullptr; }
+    const QString&  fileName    (void) const { return _fileName; }
+
+    /// Converts an archive to csv, with a header row of column names and the timestamp as local time
+    /// @return false: failed, errorString set
+    static bool convertToCsv(const QString& archiveFileName, const QString& csvFileName, QString& errorString);
+
+private:
+    typedef struct {
+        char    magic[8];
+        quint32 version;
+        quint32 byteOrderMark;  ///< Rejects archives written by a machine with different byte order
+    } Header_t;
+
+    typedef struct {
+        quint32 rowCount;
+        quint32 compressedSize;
+    } BlockHeader_t;
+
+    typedef struct {
+        int                 rowCount;
+        QVector<qint64>     timestamps;
+        QVector<double>     values;             ///< Column major, _rowsPerBlock values per column
+    } Block_t;
+
+    void _queueBlock    (void);
+    void _writeLoop     (void);
+    void _writeBlock    (const Block_t& block);
+
+    QString         _fileName;
+    QFile           _file;
+    int             _columnCount    = 0;
+    Block_t         _block;
+    QThread*        _writerThread   = nullptr;
+    QMutex          _queueLock;
+    QWaitCondition  _queueWake;
+    QList<Block_t>  _queue;
+    bool            _stop           = false;
+
+    static const int        _rowsPerBlock   = 100;
+    static const quint32    _version        = 1;
+    static const quint32    _byteOrderMark  = 0x01020304;
+    static const char*      _magic;
+};
@@ -0,0 +1,459 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryStreamServer.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+QGC_LOGGING_CATEGORY(TelemetryStreamServerLog, "TelemetryStreamServerLog")
+
+const char* TelemetryStreamServer::_webSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static void _appendDouble(QByteArray& json, const char* name, double value)
+{
+    json.append(",\"").append(name).append("\":");
+    if (qIsFinite(value)) {
+        json.append(QByteArray::number(value, 'g', 12));
+    } else {
+        json.append("null");
+    }
+}
+
+static void _appendInt(QByteArray& json, const char* name, qint64 value)
+{
+    json.append(",\"").append(name).append("\":").append(QByteArray::number(value));
+}
+
+static void _appendBool(QByteArray& json, const char* name, bool value)
+{
+    json.append(",\"").append(name).append("\":").append(value ? "true" : "false");
+}
+
+static void _appendString(QByteArray& json, const char* name, const char* value)
+{
+    json.append(",\"").append(name).append("\":\"");
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            json.append('\\');
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            continue;
+        }
+        json.append(*c);
+    }
+    json.append('"');
+}
+
+#define TELEMETRY_DOUBLE_FIELD(NAME)    { #NAME, [](const VehicleTelemetrySnapshot::Telemetry_t& t, QByteArray& json) { _appendDouble(json, #NAME, t.NAME); } }
+#define TELEMETRY_INT_FIELD(NAME)       { #NAME, [](const VehicleTelemetrySnapshot::Telemetry_t& t, QByteArray& json) { _appendInt(json, #NAME, t.NAME); } }
+#define TELEMETRY_BOOL_FIELD(NAME)      { #NAME, [](const VehicleTelemetrySnapshot::Telemetry_t& t, QByteArray& json) { _appendBool(json, #NAME, t.NAME); } }
+
+const TelemetryStreamServer::Field_t TelemetryStreamServer::_fields[] = {
+    TELEMETRY_DOUBLE_FIELD(latitude),
+    TELEMETRY_DOUBLE_FIELD(longitude),
+    TELEMETRY_DOUBLE_FIELD(altitudeAMSL),
+    TELEMETRY_DOUBLE_FIELD(altitudeRelative),
+    TELEMETRY_DOUBLE_FIELD(groundSpeed),
+    TELEMETRY_DOUBLE_FIELD(airSpeed),
+    TELEMETRY_DOUBLE_FIELD(climbRate),
+    TELEMETRY_DOUBLE_FIELD(roll),
+    TELEMETRY_DOUBLE_FIELD(pitch),
+    TELEMETRY_DOUBLE_FIELD(heading),
+    TELEMETRY_DOUBLE_FIELD(batteryVoltage),
+    TELEMETRY_DOUBLE_FIELD(batteryCurrent),
+    TELEMETRY_INT_FIELD(batteryPercentRemaining),
+    TELEMETRY_DOUBLE_FIELD(gpsLatitude),
+    TELEMETRY_DOUBLE_FIELD(gpsLongitude),
+    TELEMETRY_DOUBLE_FIELD(gpsHdop),
+    TELEMETRY_DOUBLE_FIELD(gpsVdop),
+    TELEMETRY_INT_FIELD(gpsFixType),
+    TELEMETRY_INT_FIELD(gpsSatellitesVisible),
+    TELEMETRY_BOOL_FIELD(armed),
+    TELEMETRY_BOOL_FIELD(flying),
+    TELEMETRY_INT_FIELD(baseMode),
+    TELEMETRY_INT_FIELD(customMode),
+    { "flightMode", [](const VehicleTelemetrySnapshot::Telemetry_t& t, QByteArray& json) { _appendString(json, "flightMode", t.flightMode); } },
+};
+
+const int TelemetryStreamServer::_fieldCount = sizeof(TelemetryStreamServer::_fields) / sizeof(TelemetryStreamServer::_fields[0]);
+
+TelemetryStreamServer::TelemetryStreamServer(MultiVehicleManager* multiVehicleManager, QObject* parent)
+    : QObject               (parent)
+    , _multiVehicleManager  (multiVehicleManager)
+{
+    static_assert(sizeof(_fields) / sizeof(_fields[0]) <= 32, "Field masks are 32 bits");
+
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded,     this, &TelemetryStreamServer::_vehicleAdded);
+    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved,   this, &TelemetryStreamServer::_vehicleRemoved);
+    for (int i=0; i<_multiVehicleManager->vehicles()->count(); i++) {
+        _vehicleAdded(_multiVehicleManager->vehicles()->value<Vehicle*>(i));
+    }
+
+    connect(&_server,   &QTcpServer::newConnection,     this, &TelemetryStreamServer::_newConnection);
+    connect(&_tickTimer, &QGCWheelTimer::timeout,       this, &TelemetryStreamServer::_tick);
+}
+
+TelemetryStreamServer::~TelemetryStreamServer()
+{
+    stop();
+}
+
+QStringList TelemetryStreamServer::fieldNames(void)
+{
+    QStringList names;
+    for (int i=0; i<_fieldCount; i++) {
+        names.append(_fields[i].name);
+    }
+    return names;
+}
+
+bool TelemetryStreamServer::start(quint16 port)
+{
+    if (_server.isListening()) {
+        if (_server.serverPort() == port) {
+            return true;
+        }
+        stop();
+    }
+
+    if (!_server.listen(QHostAddress::Any, port)) {
+        qWarning() << "Telemetry stream server could not listen on port" << port << _server.errorString();
+        return false;
+    }
+    qCDebug(TelemetryStreamServerLog) << "Listening on port" << port;
+    _tickTimer.start(_tickMSecs);
+    return true;
+}
+
+void TelemetryStreamServer::stop(void)
+{
+    _tickTimer.stop();
+    _server.close();
+    while (!_clients.isEmpty()) {
+        _closeClient(_clients.first());
+    }
+}
+
+void TelemetryStreamServer::_vehicleAdded(Vehicle* vehicle)
+{
+    _snapshots[vehicle->id()] = vehicle->telemetrySnapshot();
+}
+
+void TelemetryStreamServer::_vehicleRemoved(Vehicle* vehicle)
+{
+    _snapshots.remove(vehicle->id());
+    for (Client_t* client: _clients) {
+        client->sentPublishCounts.remove(vehicle->id());
+    }
+}
+
+void TelemetryStreamServer::_newConnection(void)
+{
+    while (QTcpSocket* socket = _server.nextPendingConnection()) {
+        Client_t* client = new Client_t();
+        client->socket          = socket;
+        client->upgraded        = false;
+        client->fieldMask       = 0xFFFFFFFF;
+        client->intervalMSecs   = _tickMSecs;
+        client->nextSendMSecs   = 0;
+        client->skippedFrames   = 0;
+        _clients.append(client);
+
+        connect(socket, &QTcpSocket::readyRead,     this, &TelemetryStreamServer::_readBytes);
+        connect(socket, &QTcpSocket::disconnected,  this, &TelemetryStreamServer::_disconnected);
+        qCDebug(TelemetryStreamServerLog) << "Client connected" << socket->peerAddress().toString() << socket->peerPort();
+    }
+}
+
+TelemetryStreamServer::Client_t* TelemetryStreamServer::_findClient(QTcpSocket* socket)
+{
+    for (Client_t* client: _clients) {
+        if (client->socket == socket) {
+            return client;
+        }
+    }
+    return nullptr;
+}
+
+void TelemetryStreamServer::_disconnected(void)
+{
+    Client_t* client = _findClient(qobject_cast<QTcpSocket*>(sender()));
+    if (client) {
+        qCDebug(TelemetryStreamServerLog) << "Client disconnected, skipped frames:" << client->skippedFrames;
+        _closeClient(client);
+    }
+}
+
+void TelemetryStreamServer::_closeClient(Client_t* client)
+{
+    // Signals are disconnected first so that closing the socket does not call back into here
+    _clients.removeOne(client);
+    client->socket->disconnect(this);
+    client->socket->disconnectFromHost();
+    client->socket->deleteLater();
+    delete client;
+}
+
+void TelemetryStreamServer::_readBytes(void)
+{
+    Client_t* client = _findClient(qobject_cast<QTcpSocket*>(sender()));
+    if (!client) {
+        return;
+    }
+
+    client->buffer.append(client->socket->readAll());
+    if (!client->upgraded && !_handshake(client)) {
+        return;
+    }
+    _processFrames(client);
+}
+
+/// Completes the WebSocket opening handshake once the whole HTTP request is in
+///     @return true: handshake done, false: waiting for more bytes or client was closed
+bool TelemetryStreamServer::_handshake(Client_t* client)
+{
+    const int headerEnd = client->buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (client->buffer.size() > _maxHandshakeBytes) {
+            _closeClient(client);
+        }
+        return false;
+    }
+
+    QByteArray key;
+    const QList<QByteArray> lines = client->buffer.left(headerEnd).split('\n');
+    for (const QByteArray& line: lines) {
+        const int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "sec-websocket-key") {
+            key = line.mid(colon + 1).trimmed();
+        }
+    }
+    client->buffer.remove(0, headerEnd + 4);
+
+    if (key.isEmpty()) {
+        client->socket->write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        _closeClient(client);
+        return false;
+    }
+
+    const QByteArray accept = QCryptographicHash::hash(key + _webSocketGuid, QCryptographicHash::Sha1).toBase64();
+    client->socket->write("HTTP/1.1 101 Switching Protocols\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Accept: " + accept + "\r\n\r\n");
+    client->upgraded = true;
+    return true;
+}
+
+/// Handles the complete frames received from the client
+///     @return false: client was closed
+bool TelemetryStreamServer::_processFrames(Client_t* client)
+{
+    while (client->buffer.size() >= 2) {
+        const uchar*    bytes   = reinterpret_cast<const uchar*>(client->buffer.constData());
+        const bool      fin     = bytes[0] & 0x80;
+        const int       opcode  = bytes[0] & 0x0F;
+        const bool      masked  = bytes[1] & 0x80;
+        qint64          length  = bytes[1] & 0x7F;
+        int             offset  = 2;
+
+        if (length == 126) {
+            if (client->buffer.size() < 4) {
+                return true;
+            }
+            length = (bytes[2] << 8) | bytes[3];
+            offset = 4;
+        } else if (length == 127) {
+            if (client->buffer.size() < 10) {
+                return true;
+            }
+            length = 0;
+            for (int i=2; i<10; i++) {
+                length = (length << 8) | bytes[i];
+            }
+            offset = 10;
+        }
+
+        // Clients must mask, and nothing a client sends here needs fragmentation or much space
+        if (!masked || !fin || length > _maxMessageBytes) {
+            qCDebug(TelemetryStreamServerLog) << "Closing client, unsupported frame" << fin << masked << length;
+            _closeClient(client);
+            return false;
+        }
+        if (client->buffer.size() < offset + 4 + length) {
+            return true;
+        }
+
+        const uchar* mask = bytes + offset;
+        QByteArray payload(client->buffer.constData() + offset + 4, static_cast<int>(length));
+        for (int i=0; i<payload.size(); i++) {
+            payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+        }
+        client->buffer.remove(0, offset + 4 + static_cast<int>(length));
+
+        switch (opcode) {
+        case 0x1:   // Text
+            _subscribe(client, payload);
+            break;
+        case 0x8:   // Close
+            _writeFrame(client, 0x8, payload.left(2));
+            _closeClient(client);
+            return false;
+        case 0x9:   // Ping
+            _writeFrame(client, 0xA, payload);
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+void TelemetryStreamServer::_subscribe(Client_t* client, const QByteArray& message)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        qCDebug(TelemetryStreamServerLog) << "Ignoring subscription which is not a json object" << error.errorString();
+        return;
+    }
+    const QJsonObject subscription = doc.object();
+
+    if (subscription.contains("fields")) {
+        client->fieldMask = 0;
+        for (const QJsonValue& value: subscription["fields"].toArray()) {
+            const QString name = value.toString();
+            int i = 0;
+            while (i < _fieldCount && name != QLatin1String(_fields[i].name)) {
+                i++;
+            }
+            if (i < _fieldCount) {
+                client->fieldMask |= 1u << i;
+            } else {
+                qCDebug(TelemetryStreamServerLog) << "Ignoring unknown field" << name;
+            }
+        }
+        if (client->fieldMask == 0) {
+            client->fieldMask = 0xFFFFFFFF;
+        }
+    }
+    if (subscription.contains("rate")) {
+        const double rateHz = subscription["rate"].toDouble();
+        client->intervalMSecs = rateHz > 0 ? qMax(static_cast<qint64>(_tickMSecs), static_cast<qint64>(1000.0 / rateHz)) : _tickMSecs;
+    }
+    if (subscription.contains("vehicles")) {
+        client->vehicleIds.clear();
+        for (const QJsonValue& value: subscription["vehicles"].toArray()) {
+            client->vehicleIds.insert(value.toInt());
+        }
+    }
+
+    // Resend the current state with the new selection
+    client->sentPublishCounts.clear();
+    client->nextSendMSecs = 0;
+}
+
+QByteArray TelemetryStreamServer::_frameHeader(int opcode, int payloadLength)
+{
+    QByteArray header;
+    header.append(static_cast<char>(0x80 | opcode));
+    if (payloadLength < 126) {
+        header.append(static_cast<char>(payloadLength));
+    } else if (payloadLength <= 0xFFFF) {
+        header.append(static_cast<char>(126));
+        header.append(static_cast<char>(payloadLength >> 8));
+        header.append(static_cast<char>(payloadLength & 0xFF));
+    } else {
+        header.append(static_cast<char>(127));
+        for (int shift=56; shift>=0; shift-=8) {
+            header.append(static_cast<char>((static_cast<quint64>(payloadLength) >> shift) & 0xFF));
+        }
+    }
+    return header;
+}
+
+void TelemetryStreamServer::_writeFrame(Client_t* client, int opcode, const QByteArray& payload)
+{
+    client->socket->write(_frameHeader(opcode, payload.size()) + payload);
+}
+
+/// @return Complete text frame with the selected fields
+QByteArray TelemetryStreamServer::_serialize(const VehicleTelemetrySnapshot::Telemetry_t& telemetry, quint32 fieldMask)
+{
+    QByteArray json;
+    json.reserve(512);
+    json.append("{\"vehicleId\":").append(QByteArray::number(telemetry.vehicleId));
+    _appendInt(json, "timestamp",       telemetry.timestampMSecs);
+    _appendInt(json, "publishCount",    static_cast<qint64>(telemetry.publishCount));
+    for (int i=0; i<_fieldCount; i++) {
+        if (fieldMask & (1u << i)) {
+            _fields[i].append(telemetry, json);
+        }
+    }
+    json.append('}');
+
+    return _frameHeader(0x1, json.size()) + json;
+}
+
+void TelemetryStreamServer::_tick(void)
+{
+    if (_clients.isEmpty()) {
+        return;
+    }
+
+    QList<VehicleTelemetrySnapshot::Telemetry_t> telemetryList;
+    for (const SharedVehicleTelemetrySnapshotPtr& snapshot: _snapshots) {
+        VehicleTelemetrySnapshot::Telemetry_t telemetry;
+        if (snapshot->read(telemetry)) {
+            telemetryList.append(telemetry);
+        }
+    }
+    if (telemetryList.isEmpty()) {
+        return;
+    }
+
+    // Frames serialized this tick, key: vehicle id << 32 | field mask. Clients with the same selection share them.
+    QHash<quint64, QByteArray> frames;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (Client_t* client: _clients) {
+        if (!client->upgraded || client->nextSendMSecs > now) {
+            continue;
+        }
+        if (client->socket->bytesToWrite() > _maxPendingBytes) {
+            // The client is behind, skip this update rather than queueing more
+            client->skippedFrames++;
+            continue;
+        }
+        client->nextSendMSecs = now + client->intervalMSecs - (_tickMSecs / 2);
+
+        for (const VehicleTelemetrySnapshot::Telemetry_t& telemetry: telemetryList) {
+            if (!client->vehicleIds.isEmpty() && !client->vehicleIds.contains(telemetry.vehicleId)) {
+                continue;
+            }
+            if (client->sentPublishCounts.value(telemetry.vehicleId) == telemetry.publishCount) {
+                continue;
+            }
+
+            const quint64 key = (static_cast<quint64>(telemetry.vehicleId) << 32) | client->fieldMask;
+            auto frame = frames.find(key);
+            if (frame == frames.end()) {
+                frame = frames.insert(key, _serialize(telemetry, client->fieldMask));
+            }
+            client->socket->write(frame.value());
+            client->sentPublishCounts[telemetry.vehicleId] = telemetry.publishCount;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QByteArray>
+#include <QLoggingCategory>
+
+#include "VehicleTelemetrySnapshot.h"
+#include "QGCTimerWheel.h"
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryStreamServerLog)
+
+class MultiVehicleManager;
+class Vehicle;
+
+/// WebSocket server streaming vehicle telemetry to external dashboards as JSON text frames.
+///
+/// Telemetry comes from the VehicleTelemetrySnapshot of each vehicle, so clients never cause any MAVLink parsing.
+/// Updates are serialized once per vehicle and field selection on each tick, and the resulting frame is shared by all
+/// clients which asked for the same fields.
+///
+/// After connecting a client may send a text message to change what it receives, all entries are optional:
+///     { "fields": [ "latitude", "longitude", "heading" ], "rate": 2, "vehicles": [ 1 ] }
+/// The defaults are all fields, the snapshot rate and all vehicles. Clients which do not keep up have updates skipped
+/// until their socket drains, they always get the newest state once they catch up.
+class TelemetryStreamServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryStreamServer(MultiVehicleManager* multiVehicleManager, QObject* parent = nullptr);
+    ~TelemetryStreamServer();
+
+    bool    start       (quint16 port);
+    void    stop        (void);
+    bool    isListening (void) const { return _server.isListening(); }
+    int     clientCount (void) const { return _clients.count(); }
+
+    /// @return Field names which can be subscribed to
+    static QStringList fieldNames(void);
+
+private slots:
+    void _vehicleAdded      (Vehicle* vehicle);
+    void _vehicleRemoved    (Vehicle* vehicle);
+    void _newConnection     (void);
+    void _readBytes         (void);
+    void _disconnected      (void);
+    void _tick              (void);
+
+private:
+    typedef struct {
+        QTcpSocket*         socket;
+        QByteArray          buffer;                 ///< Received bytes not processed yet
+        bool                upgraded;               ///< true: WebSocket handshake completed
+        quint32             fieldMask;
+        qint64              intervalMSecs;
+        qint64              nextSendMSecs;
+        QSet<int>           vehicleIds;             ///< Empty: all vehicles
+        QHash<int, quint64> sentPublishCounts;      ///< Last snapshot sent for each vehicle id
+        int                 skippedFrames;
+    } Client_t;
+
+    typedef struct {
+        const char* name;
+        void        (*append)(const VehicleTelemetrySnapshot::Telemetry_t& telemetry, QByteArray& json);
+    } Field_t;
+
+    Client_t*   _findClient         (QTcpSocket* socket);
+    bool        _handshake          (Client_t* client);
+    bool        _processFrames      (Client_t* client);
+    void        _subscribe          (Client_t* client, const QByteArray& message);
+    void        _writeFrame         (Client_t* client, int opcode, const QByteArray& payload);
+    void        _closeClient        (Client_t* client);
+    QByteArray  _serialize          (const VehicleTelemetrySnapshot::Telemetry_t& telemetry, quint32 fieldMask);
+
+    static QByteArray _frameHeader  (int opcode, int payloadLength);
+
+    MultiVehicleManager*                        _multiVehicleManager;
+    QTcpServer                                  _server;
+    QList<Client_t*>                            _clients;
+    QHash<int, SharedVehicleTelemetrySnapshotPtr> _snapshots;     ///< Key: vehicle id
+    QGCWheelTimer                               _tickTimer;
+
+    static const Field_t    _fields[];
+    static const int        _fieldCount;
+    static const int        _tickMSecs              = 100;          ///< Same as the snapshot publish rate
+    static const qint64     _maxPendingBytes        = 256 * 1024;   ///< Clients with more unsent bytes have updates skipped
+    static const int        _maxHandshakeBytes      = 8 * 1024;
+    static const int        _maxMessageBytes        = 64 * 1024;
+    static const char*      _webSocketGuid;
+};
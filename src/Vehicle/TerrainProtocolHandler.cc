@@ -10,6 +10,7 @@
 #include "TerrainProtocolHandler.h"
 #include "TerrainQuery.h"
 #include "QGCApplication.h"
+#include "MAVLinkMessageView.h"
 
 QGC_LOGGING_CATEGORY(TerrainProtocolHandlerLog, "TerrainProtocolHandlerLog")
 
@@ -18,8 +19,12 @@ TerrainProtocolHandler::TerrainProtocolHandler(Vehicle* vehicle, TerrainFactGrou
     , _vehicle          (vehicle)
     , _terrainFactGroup (terrainFactGroup)
 {
+    memset(&_currentTerrainRequest, 0, sizeof(_currentTerrainRequest));
+    memset(_blockSentMSecs, 0, sizeof(_blockSentMSecs));
+    _clock.start();
+
     _terrainDataSendTimer.setSingleShot(false);
-    _terrainDataSendTimer.setInterval(1000.0/12.0);
+    _terrainDataSendTimer.setInterval(1000 / _maxBlocksPerSec);
     connect(&_terrainDataSendTimer, &QTimer::timeout, this, &TerrainProtocolHandler::_sendNextTerrainData);
 }
 
@@ -37,121 +42,233 @@ bool TerrainProtocolHandler::mavlinkMessageReceived(const mavlink_message_t mess
     }
 }
 
-void TerrainProtocolHandler::_handleTerrainRequest(const mavlink_message_t& message)
+void TerrainProtocolHandler::_resetRequest(void)
 {
-    _terrainRequestActive = true;
-    mavlink_msg_terrain_request_decode(&message, &_currentTerrainRequest);
-    _sendNextTerrainData();
+    _pendingMask    = 0;
+    _queryMask      = 0;
+    _queuedMask     = 0;
+    _terrainBlockQueue.clear();
+    memset(_blockSentMSecs, 0, sizeof(_blockSentMSecs));
+    _requestGeneration++;
 }
 
-void TerrainProtocolHandler::_handleTerrainReport(const mavlink_message_t& message)
+void TerrainProtocolHandler::_handleTerrainRequest(const mavlink_message_t& message)
 {
-    mavlink_terrain_report_t terrainReport;
-    mavlink_msg_terrain_report_decode(&message, &terrainReport);
+    mavlink_terrain_request_t terrainRequest;
+    mavlink_msg_terrain_request_decode(&message, &terrainRequest);
 
-    _terrainFactGroup->blocksPending()->setRawValue(terrainReport.pending);
-    _terrainFactGroup->blocksLoaded()->setRawValue(terrainReport.loaded);
+    // The vehicle repeats the request with the blocks it is still missing until it has them all. A request for a
+    // different area means the previous one is no longer needed.
+    if (!_terrainRequestActive ||
+            terrainRequest.lat != _currentTerrainRequest.lat ||
+            terrainRequest.lon != _currentTerrainRequest.lon ||
+            terrainRequest.grid_spacing != _currentTerrainRequest.grid_spacing) {
+        _resetRequest();
+    }
+    _terrainRequestActive = true;
+    _currentTerrainRequest = terrainRequest;
 
-    if (TerrainProtocolHandlerLog().isDebugEnabled()) {
+    // Skip blocks which are already on their way: queued, being queried or sent very recently
+    const qint64 now = _clock.elapsed();
+    uint64_t newMask = 0;
+    for (int gridBit=0; gridBit<56; gridBit++) {
+        const uint64_t bit = 1ull << gridBit;
+        if ((terrainRequest.mask & bit) && !((_queuedMask | _queryMask) & bit) &&
+                (_blockSentMSecs[gridBit] == 0 || now - _blockSentMSecs[gridBit] > _resendHoldoffMSecs)) {
+            newMask |= bit;
+        }
+    }
+    qCDebug(TerrainProtocolHandlerLog) << "TERRAIN_REQUEST mask:new" << QString::number(terrainRequest.mask, 16) << QString::number(newMask, 16);
 
-        bool error;
-        QGeoCoordinate coord(static_cast<double>(terrainReport.lat) / 1e7, static_cast<double>(terrainReport.lon) / 1e7);
-        QList<double>   altitudes;
-        QList<QGeoCoordinate> coordinates;
-        coordinates.append(coord);
-        bool altAvailable = (TerrainAtCoordinateQuery::getAltitudesForCoordinates(coordinates, altitudes, error));
-        QString vehicleAlt = terrainReport.spacing ? QStringLiteral("%1").arg(terrainReport.terrain_height) : QStringLiteral("n/a");
-        QString qgcAlt = error ? QStringLiteral("error") :
-                                 (altAvailable ? QStringLiteral("%1").arg(altitudes[0]) : QStringLiteral("n/a"));
-        qDebug() << "TERRAIN_REPORT" << coord << QStringLiteral("Vehicle(%1) QGC(%2)").arg(vehicleAlt).arg(qgcAlt);
+    _pendingMask |= newMask;
+    _queryPendingBlocks();
+    _updateSendInterval();
+    if (!_terrainBlockQueue.isEmpty() && !_terrainDataSendTimer.isActive()) {
+        _sendNextTerrainData();
+        _terrainDataSendTimer.start();
     }
 }
 
-void TerrainProtocolHandler::_sendNextTerrainData(void)
+void TerrainProtocolHandler::_queryPendingBlocks(void)
 {
-    if (!_terrainRequestActive) {
+    // A single query outstanding at a time, blocks requested meanwhile are picked up once it completes
+    if (_pendingMask == 0 || _queryMask != 0) {
         return;
     }
 
-    QGeoCoordinate terrainRequestCoordSWCorner(static_cast<double>(_currentTerrainRequest.lat) / 1e7, static_cast<double>(_currentTerrainRequest.lon) / 1e7);
-    int spacingBetweenGrids = _currentTerrainRequest.grid_spacing * 4;
+    const uint64_t              mask        = _pendingMask;
+    const QList<QGeoCoordinate> coordinates = _blockCoordinates(mask);
+
+    // Query terrain system for altitudes. If it has them available it will return them. If not they will be queued for download.
+    bool            error = false;
+    QList<double>   altitudes;
+    if (TerrainAtCoordinateQuery::getAltitudesForCoordinates(coordinates, altitudes, error)) {
+        if (error) {
+            // Leave the blocks pending, the vehicle will request them again
+            qCWarning(TerrainProtocolHandlerLog) << "_queryPendingBlocks TerrainAtCoordinateQuery::getAltitudesForCoordinates failed";
+        } else {
+            _queueBlocks(mask, altitudes);
+        }
+        return;
+    }
+
+    // Wait for the whole area to download instead of retrying block by block
+    _queryMask = mask;
+    _pendingMask &= ~mask;
+    const int generation = _requestGeneration;
+    TerrainAtCoordinateQuery* query = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, mask, generation](bool success, QList<double> heights) {
+        if (generation != _requestGeneration) {
+            return;
+        }
+        _queryMask = 0;
+        if (success && heights.count() == qPopulationCount(mask) * 16) {
+            _queueBlocks(mask, heights);
+        } else {
+            qCWarning(TerrainProtocolHandlerLog) << "Terrain query for TERRAIN_REQUEST failed";
+            _pendingMask |= mask;
+            return;
+        }
+        _queryPendingBlocks();
+        if (!_terrainBlockQueue.isEmpty() && !_terrainDataSendTimer.isActive()) {
+            _sendNextTerrainData();
+            _terrainDataSendTimer.start();
+        }
+    });
+    query->requestData(coordinates);
+}
+
+QList<QGeoCoordinate> TerrainProtocolHandler::_blockCoordinates(uint64_t mask) const
+{
+    QGeoCoordinate  terrainRequestCoordSWCorner(static_cast<double>(_currentTerrainRequest.lat) / 1e7, static_cast<double>(_currentTerrainRequest.lon) / 1e7);
+    int             spacingBetweenGrids = _currentTerrainRequest.grid_spacing * 4;
 
     // Each TERRAIN_DATA sent to vehicle contains a 4x4 grid of heights
     // TERRAIN_REQUEST.mask has a bit for each entry in an 8x7 grid
     // gridBit = 0 refers to the the sw corner of the 8x7 grid
 
-    bool bitFound = false;
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(qPopulationCount(mask) * 16);
     for (int rowIndex=0; rowIndex<7; rowIndex++) {
         for (int colIndex=0; colIndex<8; colIndex++) {
             uint8_t gridBit = (rowIndex * 8) + colIndex;
-            uint64_t checkBit = 1ull << gridBit;
-            if (_currentTerrainRequest.mask & checkBit) {
+            if (mask & (1ull << gridBit)) {
                 // Move east and then north to generate the coordinate for sw corner of the specific gridBit
                 QGeoCoordinate swCorner = terrainRequestCoordSWCorner.atDistanceAndAzimuth(spacingBetweenGrids * colIndex, 90);
                 swCorner = swCorner.atDistanceAndAzimuth(spacingBetweenGrids * rowIndex, 0);
-                _sendTerrainData(swCorner, gridBit);
-                bitFound = true;
-                break;
+                for (int blockRow=0; blockRow<4; blockRow++) {
+                    for (int blockCol=0; blockCol<4; blockCol++) {
+                        // Move east and then north to generate the coordinate for grid point
+                        QGeoCoordinate coord = swCorner.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * blockCol, 90);
+                        coord = coord.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * blockRow, 0);
+                        coordinates.append(coord);
+                    }
+                }
             }
         }
-        if (bitFound) {
-            break;
+    }
+
+    return coordinates;
+}
+
+void TerrainProtocolHandler::_queueBlocks(uint64_t mask, const QList<double>& altitudes)
+{
+    // altitudes are in the same block order as _blockCoordinates
+    int altIndex = 0;
+    for (int gridBit=0; gridBit<56; gridBit++) {
+        const uint64_t bit = 1ull << gridBit;
+        if (mask & bit) {
+            TerrainBlock_t block;
+            block.gridBit = static_cast<uint8_t>(gridBit);
+            for (int i=0; i<16; i++) {
+                block.heights[i] = static_cast<int16_t>(altitudes[altIndex++]);
+            }
+            _terrainBlockQueue.enqueue(block);
+            _queuedMask |= bit;
         }
     }
+    _pendingMask &= ~mask;
+}
 
-    if (bitFound) {
-        // Kick timer to send next possible TERRAIN_DATA to vehicle
-        _terrainDataSendTimer.start();
+void TerrainProtocolHandler::_updateSendInterval(void)
+{
+    // Unknown capacity (network links) is sent at the full rate, slow serial links only get a share of their bandwidth
+    int blocksPerSec = _maxBlocksPerSec;
+    SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
+    if (sharedLink && sharedLink->linkConfiguration()->isHighLatency()) {
+        blocksPerSec = _minBlocksPerSec;
     } else {
+        const int capacity = _vehicle->vehicleLinkManager()->primaryLinkCapacityBytesPerSec();
+        if (capacity > 0) {
+            blocksPerSec = qBound(_minBlocksPerSec, static_cast<int>(capacity * _linkShare / _bytesPerTerrainData), _maxBlocksPerSec);
+        }
+    }
+    _terrainDataSendTimer.setInterval(1000 / blocksPerSec);
+}
+
+void TerrainProtocolHandler::_handleTerrainReport(const mavlink_message_t& message)
+{
+    const uint16_t pending = QGC_MAVLINK_FIELD(message, terrain_report, pending);
+
+    _terrainFactGroup->blocksPending()->setRawValue(pending);
+    _terrainFactGroup->blocksLoaded()->setRawValue(QGC_MAVLINK_FIELD(message, terrain_report, loaded));
+
+    // Nothing pending on the vehicle means it found the blocks elsewhere (e.g. its own cache) or no longer needs them
+    if (_terrainRequestActive && pending == 0) {
+        qCDebug(TerrainProtocolHandlerLog) << "TERRAIN_REPORT nothing pending, dropping queued blocks" << _terrainBlockQueue.count();
         _terrainRequestActive = false;
+        _terrainDataSendTimer.stop();
+        _resetRequest();
+    }
+
+    if (TerrainProtocolHandlerLog().isDebugEnabled()) {
+        mavlink_terrain_report_t terrainReport;
+        mavlink_msg_terrain_report_decode(&message, &terrainReport);
+
+        bool error;
+        QGeoCoordinate coord(static_cast<double>(terrainReport.lat) / 1e7, static_cast<double>(terrainReport.lon) / 1e7);
+        QList<double>   altitudes;
+        QList<QGeoCoordinate> coordinates;
+        coordinates.append(coord);
+        bool altAvailable = (TerrainAtCoordinateQuery::getAltitudesForCoordinates(coordinates, altitudes, error));
+        QString vehicleAlt = terrainReport.spacing ? QStringLiteral("%1").arg(terrainReport.terrain_height) : QStringLiteral("n/a");
+        QString qgcAlt = error ? QStringLiteral("error") :
+                                 (altAvailable ? QStringLiteral("%1").arg(altitudes[0]) : QStringLiteral("n/a"));
+        qDebug() << "TERRAIN_REPORT" << coord << QStringLiteral("Vehicle(%1) QGC(%2)").arg(vehicleAlt).arg(qgcAlt);
     }
 }
 
-void TerrainProtocolHandler::_sendTerrainData(const QGeoCoordinate& swCorner, uint8_t gridBit)
+void TerrainProtocolHandler::_sendNextTerrainData(void)
 {
-    QList<QGeoCoordinate> coordinates;
-    for (int rowIndex=0; rowIndex<4; rowIndex++) {
-        for (int colIndex=0; colIndex<4; colIndex++) {
-            // Move east and then north to generate the coordinate for grid point
-            QGeoCoordinate coord = swCorner.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * colIndex, 90);
-            coord = coord.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * rowIndex, 0);
-            coordinates.append(coord);
-        }
+    if (!_terrainRequestActive || _terrainBlockQueue.isEmpty()) {
+        // The request stays active so blocks which were just sent are not sent again if the vehicle repeats it
+        _terrainDataSendTimer.stop();
+        return;
     }
 
-    // Query terrain system for altitudes. If it has them available it will return them. If not they will be queued for download.
-    bool            error = false;
-    QList<double>   altitudes;
-    if (TerrainAtCoordinateQuery::getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        if (error) {
-            qCWarning(TerrainProtocolHandlerLog) << "_sendTerrainData TerrainAtCoordinateQuery::getAltitudesForCoordinates failed";
-        } else {
-            // Only clear the bit if the query succeeds. Otherwise just let it try again on the next timer tick
-            uint64_t removeBit = ~(1ull << gridBit);
-            _currentTerrainRequest.mask &= removeBit;
-            int altIndex = 0;
-            int16_t terrainData[16];
-            for (const double& altitude : altitudes) {
-                terrainData[altIndex++] = static_cast<int16_t>(altitude);
-            }
+    TerrainBlock_t block = _terrainBlockQueue.dequeue();
+    _queuedMask &= ~(1ull << block.gridBit);
+    _blockSentMSecs[block.gridBit] = qMax(_clock.elapsed(), static_cast<qint64>(1));
+    _sendTerrainData(block);
+}
 
-            WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-            if (!weakLink.expired()) {
-                mavlink_message_t       msg;
-                SharedLinkInterfacePtr  sharedLink = weakLink.lock();
-
-                mavlink_msg_terrain_data_pack_chan(
-                            qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
-                            qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                            sharedLink->mavlinkChannel(),
-                            &msg,
-                            _currentTerrainRequest.lat,
-                            _currentTerrainRequest.lon,
-                            _currentTerrainRequest.grid_spacing,
-                            gridBit,
-                            terrainData);
-                _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-            }
-        }
+void TerrainProtocolHandler::_sendTerrainData(const TerrainBlock_t& block)
+{
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    if (!weakLink.expired()) {
+        mavlink_message_t       msg;
+        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
+
+        mavlink_msg_terrain_data_pack_chan(
+                    qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
+                    qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
+                    sharedLink->mavlinkChannel(),
+                    &msg,
+                    _currentTerrainRequest.lat,
+                    _currentTerrainRequest.lon,
+                    _currentTerrainRequest.grid_spacing,
+                    block.gridBit,
+                    block.heights);
+        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
 }
@@ -15,11 +15,15 @@
 
 #include <QObject>
 #include <QGeoCoordinate>
+#include <QQueue>
+#include <QElapsedTimer>
 
 class TerrainFactGroup;
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainProtocolHandlerLog)
 
+/// Serves TERRAIN_REQUEST from the vehicle. All blocks of a request are looked up in one batched terrain query,
+/// precomputed and then streamed to the vehicle at a rate the primary link can carry.
 class TerrainProtocolHandler : public QObject
 {
     Q_OBJECT
@@ -34,13 +38,38 @@ private slots:
     void _sendNextTerrainData(void);
 
 private:
-    void _handleTerrainRequest  (const mavlink_message_t& message);
-    void _handleTerrainReport   (const mavlink_message_t& message);
-    void _sendTerrainData       (const QGeoCoordinate& swCorner, uint8_t gridBit);
+    /// One TERRAIN_DATA message worth of heights
+    typedef struct {
+        uint8_t gridBit;
+        int16_t heights[16];
+    } TerrainBlock_t;
+
+    void                    _handleTerrainRequest   (const mavlink_message_t& message);
+    void                    _handleTerrainReport    (const mavlink_message_t& message);
+    void                    _resetRequest           (void);
+    void                    _queryPendingBlocks     (void);
+    void                    _queueBlocks            (uint64_t mask, const QList<double>& altitudes);
+    QList<QGeoCoordinate>   _blockCoordinates       (uint64_t mask) const;
+    void                    _sendTerrainData        (const TerrainBlock_t& block);
+    void                    _updateSendInterval     (void);
 
     Vehicle*                    _vehicle;
     TerrainFactGroup*           _terrainFactGroup;
     bool                        _terrainRequestActive =             false;
     mavlink_terrain_request_t   _currentTerrainRequest;
     QTimer                      _terrainDataSendTimer;
+
+    uint64_t                    _pendingMask =                      0;      ///< Requested blocks which don't have heights yet
+    uint64_t                    _queryMask =                        0;      ///< Blocks in the outstanding async query
+    uint64_t                    _queuedMask =                       0;      ///< Blocks in _terrainBlockQueue
+    QQueue<TerrainBlock_t>      _terrainBlockQueue;                         ///< Precomputed blocks waiting to be sent
+    qint64                      _blockSentMSecs[56];                        ///< Last time each block of the current request was sent, 0 if never
+    int                         _requestGeneration =                0;      ///< Bumped for each new request area, discards stale query results
+    QElapsedTimer               _clock;
+
+    static const int _bytesPerTerrainData =     55;     ///< TERRAIN_DATA with MAVLink 2 framing
+    static const int _minBlocksPerSec =         2;
+    static const int _maxBlocksPerSec =         50;
+    static const int _resendHoldoffMSecs =      1000;   ///< Re-requested blocks sent more recently than this are assumed to be in flight
+    static constexpr double _linkShare =        0.25;   ///< Part of the primary link capacity terrain data may use
 };
@@ -9,12 +9,31 @@
 
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "QGCMemoryAccounting.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QtMath>
+
+#include <limits>
 
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
     , _lastAzimuth  (qQNaN())
 {
+    qgcApp()->toolbox()->memoryAccounting()->addSource(this, QStringLiteral("Trajectory"), [this](){ return memoryBytes(); });
+}
+
+qint64 TrajectoryPoints::memoryBytes(void) const
+{
+    qint64 bytes = 0;
+    for (int level = 0; level < _levelCount; level++) {
+        bytes += static_cast<qint64>(_levels[level].capacity()) * static_cast<qint64>(sizeof(Point_t));
+    }
+    return bytes;
 }
 
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
@@ -33,21 +52,136 @@ void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
                 _lastAzimuth = _lastPoint.azimuthTo(coordinate);
                 _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
+                _addPoint(coordinate, false /* replaceLast */);
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
                 _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
-                emit updateLastPoint(coordinate);
+                _addPoint(coordinate, true /* replaceLast */);
             }
         }
     } else {
         // Add the very first trajectory point to the list
         _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
-        emit pointAdded(coordinate);
+        _addPoint(coordinate, false /* replaceLast */);
+    }
+}
+
+void TrajectoryPoints::_addPoint(const QGeoCoordinate& coordinate, bool replaceLast)
+{
+    const Point_t point = _toPoint(coordinate);
+
+    for (int level=0; level<_levelCount; level++) {
+        QVector<Point_t>& points = _levels[level];
+
+        // The last point of a level follows the vehicle until it is far enough from the point before it to be kept
+        bool append;
+        if (level == 0) {
+            append = !replaceLast || points.isEmpty();
+        } else if (points.count() < 2) {
+            append = true;
+        } else {
+            append = _toCoordinate(points[points.count() - 2]).distanceTo(coordinate) > _levelTolerance(level);
+        }
+
+        if (append) {
+            points.append(point);
+        } else {
+            points.last() = point;
+        }
+
+        if (level == _displayLevel) {
+            if (append) {
+                emit pointAdded(coordinate);
+            } else {
+                emit updateLastPoint(coordinate);
+            }
+        }
+
+        if (points.count() > _maxPointsPerLevel) {
+            _dropOldPoints(level);
+        }
+    }
+}
+
+void TrajectoryPoints::_dropOldPoints(int level)
+{
+    const int dropCount = _maxPointsPerLevel / 2;
+
+    if (level == 0) {
+        _archivePoints(_levels[level].constData(), dropCount);
+    }
+    _levels[level].remove(0, dropCount);
+
+    if (level == _displayLevel) {
+        // The start of the displayed path now comes from a coarser level
+        emit pointsReset();
+    }
+}
+
+void TrajectoryPoints::_archivePoints(const Point_t* points, int count)
+{
+    if (!_archiveFile.isOpen()) {
+        QString savePath = qgcApp()->toolbox()->settingsManager()->appSettings()->telemetrySavePath();
+        if (savePath.isEmpty()) {
+            return;
+        }
+        QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
+        _archiveFile.setFileName(QDir(savePath).absoluteFilePath(QString("%1 vehicle%2.trajectory").arg(now).arg(_vehicle->id())));
+        if (!_archiveFile.open(QFile::WriteOnly | QFile::Append)) {
+            qWarning() << "Unable to open trajectory archive" << _archiveFile.fileName() << _archiveFile.errorString();
+            return;
+        }
+    }
+
+    const qint64 size = static_cast<qint64>(count) * static_cast<qint64>(sizeof(Point_t));
+    if (_archiveFile.write(reinterpret_cast<const char*>(points), size) != size) {
+        qWarning() << "Writing trajectory archive failed" << _archiveFile.fileName() << _archiveFile.errorString();
+    }
+}
+
+QVariantList TrajectoryPoints::list(void) const
+{
+    QVariantList    coordinates;
+    bool            haveLastMsecs   = false;
+    quint32         lastMsecs       = 0;
+
+    // Finer levels hold the end of the flight, coarser levels fill in the part before the point they start at
+    for (int level=_levelCount - 1; level>=_displayLevel; level--) {
+        quint32 endMsecs = std::numeric_limits<quint32>::max();
+        if (level > _displayLevel && !_levels[level - 1].isEmpty()) {
+            endMsecs = _levels[level - 1].first().msecs;
+        }
+        for (const Point_t& point: _levels[level]) {
+            if (level > _displayLevel && point.msecs >= endMsecs) {
+                break;
+            }
+            if (level == _displayLevel || !haveLastMsecs || point.msecs > lastMsecs) {
+                coordinates.append(QVariant::fromValue(_toCoordinate(point)));
+                lastMsecs = point.msecs;
+                haveLastMsecs = true;
+            }
+        }
+    }
+
+    return coordinates;
+}
+
+void TrajectoryPoints::setDisplayZoom(double zoomLevel)
+{
+    // Map resolution at the vehicle position (Web Mercator)
+    double latitude         = _lastPoint.isValid() ? _lastPoint.latitude() : 0;
+    double metersPerPixel   = 156543.03392 * qCos(qDegreesToRadians(latitude)) / qPow(2.0, zoomLevel);
+
+    // Coarsest level whose points are still within a pixel of each other
+    int level = 0;
+    while (level + 1 < _levelCount && _levelTolerance(level + 1) <= metersPerPixel) {
+        level++;
+    }
+
+    if (level != _displayLevel) {
+        _displayLevel = level;
+        emit pointsReset();
     }
 }
 
@@ -64,8 +198,34 @@ void TrajectoryPoints::stop(void)
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
+    for (int level=0; level<_levelCount; level++) {
+        _levels[level].clear();
+    }
+    _archiveFile.close();
+    _elapsed.start();
     _lastPoint = QGeoCoordinate();
     _lastAzimuth = qQNaN();
     emit pointsCleared();
 }
+
+TrajectoryPoints::Point_t TrajectoryPoints::_toPoint(const QGeoCoordinate& coordinate) const
+{
+    Point_t point;
+
+    point.latitude  = coordinate.latitude();
+    point.longitude = coordinate.longitude();
+    point.altitude  = static_cast<float>(coordinate.altitude());
+    point.msecs     = static_cast<quint32>(_elapsed.isValid() ? _elapsed.elapsed() : 0);
+
+    return point;
+}
+
+QGeoCoordinate TrajectoryPoints::_toCoordinate(const Point_t& point)
+{
+    return QGeoCoordinate(point.latitude, point.longitude, static_cast<double>(point.altitude));
+}
+
+double TrajectoryPoints::_levelTolerance(int level)
+{
+    return _distanceTolerance * qPow(_levelFactor, level);
+}
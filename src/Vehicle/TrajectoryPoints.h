@@ -12,9 +12,20 @@
 #include "QmlObjectListModel.h"
 
 #include <QGeoCoordinate>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QVector>
 
 class Vehicle;
 
+/// Path flown by a vehicle.
+///
+/// Points are stored packed at _levelCount levels of detail. Level 0 holds every point which is not colinear with
+/// the previous segment, each further level only keeps points which are _levelFactor times further apart than the
+/// level below it. The last point of each level always follows the vehicle. Each level is limited to
+/// _maxPointsPerLevel points: when it is full the older half is dropped, for level 0 it is first appended to an
+/// archive file in the telemetry save directory. The display level is picked from the map zoom and the displayed
+/// path falls back to coarser levels for the part of the flight a finer level no longer holds.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,28 +33,56 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    /// @return Points of the display level
+    Q_INVOKABLE QVariantList list(void) const;
+
+    /// Picks the display level which matches the map zoom level. Signals pointsReset if the level changes.
+    Q_INVOKABLE void setDisplayZoom(double zoomLevel);
 
     void start  (void);
     void stop   (void);
 
+    /// @return Bytes held by the point levels
+    qint64 memoryBytes(void) const;
+
 public slots:
     void clear  (void);
 
 signals:
-    void pointAdded     (QGeoCoordinate coordinate);
-    void updateLastPoint(QGeoCoordinate coordinate);
+    void pointAdded     (QGeoCoordinate coordinate);    ///< Point appended to the display level
+    void updateLastPoint(QGeoCoordinate coordinate);    ///< Last point of the display level moved
     void pointsCleared  (void);
+    void pointsReset    (void);                         ///< Display points changed other than at the end, call list() again
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
-    Vehicle*        _vehicle;
-    QVariantList    _points;
-    QGeoCoordinate  _lastPoint;
-    double          _lastAzimuth;
+    static constexpr int    _levelCount         = 5;
+    static constexpr double _levelFactor        = 4.0;
+    static constexpr int    _maxPointsPerLevel  = 20000;
+    static constexpr double _distanceTolerance  = 2.0;
+    static constexpr double _azimuthTolerance   = 1.5;
+
+    typedef struct {
+        double  latitude;
+        double  longitude;
+        float   altitude;
+        quint32 msecs;          ///< Since start
+    } Point_t;
+
+    void            _addPoint       (const QGeoCoordinate& coordinate, bool replaceLast);
+    void            _dropOldPoints  (int level);
+    void            _archivePoints  (const Point_t* points, int count);
+    Point_t         _toPoint        (const QGeoCoordinate& coordinate) const;
+    static QGeoCoordinate _toCoordinate(const Point_t& point);
+    static double   _levelTolerance (int level);
 
-    static constexpr double _distanceTolerance = 2.0;
-    static constexpr double _azimuthTolerance = 1.5;
+    Vehicle*            _vehicle;
+    QVector<Point_t>    _levels[_levelCount];
+    int                 _displayLevel   = 0;
+    QGeoCoordinate      _lastPoint;
+    double              _lastAzimuth;
+    QElapsedTimer       _elapsed;
+    QFile               _archiveFile;
 };
@@ -11,12 +11,14 @@
 #include <QDateTime>
 #include <QLocale>
 #include <QQuaternion>
+#include <QtConcurrent>
 
 #include <Eigen/Eigen>
 
 #include "Vehicle.h"
 #include "MAVLinkProtocol.h"
 #include "FirmwarePluginManager.h"
+#include "QGCTrace.h"
 #include "LinkManager.h"
 #include "FirmwarePlugin.h"
 #include "UAS.h"
@@ -45,10 +47,12 @@
 #include "TrajectoryPoints.h"
 #include "QGCGeo.h"
 #include "TerrainProtocolHandler.h"
+#include "MAVLinkMessageView.h"
 #include "ParameterManager.h"
 #include "FTPManager.h"
 #include "ComponentInformationManager.h"
 #include "InitialConnectStateMachine.h"
+#include "InitialConnectScheduler.h"
 #include "VehicleBatteryFactGroup.h"
 #include "EventHandler.h"
 #include "Actuators/Actuators.h"
@@ -56,6 +60,7 @@
 #include "MockLink.h"
 #endif
 #include "Autotune.h"
+#include "PIDTuningRecorder.h"
 #include "RemoteIDManager.h"
 
 #if defined(QGC_AIRMAP_ENABLED)
@@ -113,6 +118,7 @@ const char* Vehicle::_escStatusFactGroupName =          "escStatus";
 const char* Vehicle::_estimatorStatusFactGroupName =    "estimatorStatus";
 const char* Vehicle::_terrainFactGroupName =            "terrain";
 const char* Vehicle::_hygrometerFactGroupName =         "hygrometer";
+const char* Vehicle::_geoFenceFactGroupName =           "geoFence";
 
 // Standard connected vehicle
 Vehicle::Vehicle(LinkInterface*             link,
@@ -121,7 +127,8 @@ Vehicle::Vehicle(LinkInterface*             link,
                  MAV_AUTOPILOT              firmwareType,
                  MAV_TYPE                   vehicleType,
                  FirmwarePluginManager*     firmwarePluginManager,
-                 JoystickManager*           joystickManager)
+                 JoystickManager*           joystickManager,
+                 bool                       monitorOnly)
     : FactGroup                     (_vehicleUIUpdateRateMSecs, ":/json/Vehicle/VehicleFact.json")
     , _id                           (vehicleId)
     , _defaultComponentId           (defaultComponentId)
@@ -174,6 +181,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _estimatorStatusFactGroup     (this)
     , _hygrometerFactGroup          (this)
     , _terrainFactGroup             (this)
+    , _geoFenceFactGroup            (this)
     , _terrainProtocolHandler       (new TerrainProtocolHandler(this, &_terrainFactGroup, this))
 {
     _linkManager = _toolbox->linkManager();
@@ -184,7 +192,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
+    _subscribeToMavlinkMessages();
     connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
 
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
@@ -222,15 +230,14 @@ Vehicle::Vehicle(LinkInterface*             link,
     _autopilotPlugin->setParent(this);
 
     // PreArm Error self-destruct timer
-    connect(&_prearmErrorTimer, &QTimer::timeout, this, &Vehicle::_prearmErrorTimeout);
+    connect(&_prearmErrorTimer, &QGCWheelTimer::timeout, this, &Vehicle::_prearmErrorTimeout);
     _prearmErrorTimer.setInterval(_prearmErrorTimeoutMSecs);
     _prearmErrorTimer.setSingleShot(true);
 
     // Send MAV_CMD ack timer
-    _mavCommandResponseCheckTimer.setSingleShot(false);
-    _mavCommandResponseCheckTimer.setInterval(_mavCommandResponseCheckTimeoutMSecs);
-    _mavCommandResponseCheckTimer.start();
-    connect(&_mavCommandResponseCheckTimer, &QTimer::timeout, this, &Vehicle::_sendMavCommandResponseTimeoutCheck);
+    _mavCommandClock.start();
+    _mavCommandResponseCheckTimer.setSingleShot(true);
+    connect(&_mavCommandResponseCheckTimer, &QGCWheelTimer::timeout, this, &Vehicle::_sendMavCommandResponseTimeoutCheck);
 
     // Chunked status text timeout timer
     _chunkedStatusTextTimer.setSingleShot(true);
@@ -245,8 +252,9 @@ Vehicle::Vehicle(LinkInterface*             link,
 
     // MAV_TYPE_GENERIC is used by unit test for creating a vehicle which doesn't do the connect sequence. This
     // way we can test the methods that are used within the connect sequence.
-    if (!qgcApp()->runningUnitTests() || _vehicleType != MAV_TYPE_GENERIC) {
-        _initialConnectStateMachine->start();
+    _monitorOnly = monitorOnly;
+    if (!_monitorOnly && (!qgcApp()->runningUnitTests() || _vehicleType != MAV_TYPE_GENERIC)) {
+        _toolbox->multiVehicleManager()->initialConnectScheduler()->requestStart(_initialConnectStateMachine);
     }
 
     _firmwarePlugin->initializeVehicle(this);
@@ -260,12 +268,18 @@ Vehicle::Vehicle(LinkInterface*             link,
     connect(&_orbitTelemetryTimer, &QTimer::timeout, this, &Vehicle::_orbitTelemetryTimeout);
 
     // Create camera manager instance
-    _cameraManager = _firmwarePlugin->createCameraManager(this);
-    emit cameraManagerChanged();
+    if (!_monitorOnly) {
+        _cameraManager = _firmwarePlugin->createCameraManager(this);
+        emit cameraManagerChanged();
+    }
 
     // Start csv logger
-    connect(&_csvLogTimer, &QTimer::timeout, this, &Vehicle::_writeCsvLine);
-    _csvLogTimer.start(1000);
+    connect(&_csvLogTimer, &QGCWheelTimer::timeout, this, &Vehicle::_writeCsvLine);
+    connect(_settingsManager->appSettings()->csvTelemetryRate(), &Fact::rawValueChanged, this, &Vehicle::_updateCsvLogRate);
+    _updateCsvLogRate();
+
+    connect(&_telemetrySnapshotTimer, &QGCWheelTimer::timeout, this, &Vehicle::_publishTelemetrySnapshot);
+    _telemetrySnapshotTimer.start(_telemetrySnapshotRateMSecs);
 }
 
 // Disconnected Vehicle for offline editing
@@ -359,6 +373,8 @@ void Vehicle::_commonInit()
 {
     _firmwarePlugin = _firmwarePluginManager->firmwarePluginForAutopilot(_firmwareType, _vehicleType);
 
+    _csvSaveNotArmed.bind(_settingsManager->appSettings()->telemetrySaveNotArmed(), this);
+
     connect(_firmwarePlugin, &FirmwarePlugin::toolIndicatorsChanged, this, &Vehicle::toolIndicatorsChanged);
     connect(_firmwarePlugin, &FirmwarePlugin::modeIndicatorsChanged, this, &Vehicle::modeIndicatorsChanged);
 
@@ -366,6 +382,7 @@ void Vehicle::_commonInit()
     connect(this, &Vehicle::coordinateChanged,      this, &Vehicle::_updateDistanceToGCS);
     connect(this, &Vehicle::homePositionChanged,    this, &Vehicle::_updateDistanceHeadingToHome);
     connect(this, &Vehicle::hobbsMeterChanged,      this, &Vehicle::_updateHobbsMeter);
+    connect(this, &Vehicle::factGroupNamesChanged,  this, [this]() { _factGroupDispatchDirty = true; });
 
     connect(_toolbox->qgcPositionManager(), &QGCPositionManager::gcsPositionChanged, this, &Vehicle::_updateDistanceToGCS);
     connect(_toolbox->qgcPositionManager(), &QGCPositionManager::gcsPositionChanged, this, &Vehicle::_updateHomepoint);
@@ -397,6 +414,7 @@ void Vehicle::_commonInit()
     _objectAvoidance = new VehicleObjectAvoidance(this, this);
 
     _autotune = _firmwarePlugin->createAutotune(this);
+    _pidTuningRecorder = new PIDTuningRecorder(this);
 
     // GeoFenceManager needs to access ParameterManager so make sure to create after
     _geoFenceManager = new GeoFenceManager(this);
@@ -462,6 +480,7 @@ void Vehicle::_commonInit()
     _addFactGroup(&_estimatorStatusFactGroup,   _estimatorStatusFactGroupName);
     _addFactGroup(&_hygrometerFactGroup,        _hygrometerFactGroupName);
     _addFactGroup(&_terrainFactGroup,           _terrainFactGroupName);
+    _addFactGroup(&_geoFenceFactGroup,          _geoFenceFactGroupName);
 
     // Add firmware-specific fact groups, if provided
     QMap<QString, FactGroup*>* fwFactGroups = _firmwarePlugin->factGroups();
@@ -477,7 +496,7 @@ void Vehicle::_commonInit()
     _flightTimeFact.setRawValue(0);
     _flightTimeUpdater.setInterval(1000);
     _flightTimeUpdater.setSingleShot(false);
-    connect(&_flightTimeUpdater, &QTimer::timeout, this, &Vehicle::_updateFlightTime);
+    connect(&_flightTimeUpdater, &QGCWheelTimer::timeout, this, &Vehicle::_updateFlightTime);
 
     // Set video stream to udp if running ArduSub and Video is disabled
     if (sub() && _settingsManager->videoSettings()->videoSource()->rawValue() == VideoSettings::videoDisabled) {
@@ -501,6 +520,11 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    _closeCsv();
+
+    // Readers may still hold the snapshot, let them know it is final
+    _telemetrySnapshot->setVehicleActive(false);
+
     delete _missionManager;
     _missionManager = nullptr;
 
@@ -523,6 +547,10 @@ Vehicle::~Vehicle()
 
 void Vehicle::prepareDelete()
 {
+    if (_flowImageIndex) {
+        _toolbox->imageProvider()->clearImage(_id);
+    }
+
     if(_cameraManager) {
         // because of _cameraManager QML bindings check for nullptr won't work in the binding pipeline
         // the dangling pointer access will cause a runtime fault
@@ -604,8 +632,49 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
+/// Routes the messages for this vehicle through MAVLinkProtocol subscriptions such that the vehicle does not have to
+/// look at the traffic of every other vehicle.
+void Vehicle::_subscribeToMavlinkMessages(void)
+{
+    auto handler = [this](LinkInterface* link, const mavlink_message_t& message) { _mavlinkMessageReceived(link, message); };
+
+    _mavlink->subscribe(this, _id,  MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, handler);
+    _mavlink->subscribe(this, 0,    MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, handler);
+
+    // RADIO_STATUS from other system ids is let through by _mavlinkMessageReceived if it comes from one of our links
+    _mavlink->subscribe(this, MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, MAVLINK_MSG_ID_RADIO_STATUS,
+                        [this](LinkInterface* link, const mavlink_message_t& message) {
+        if (message.sysid != _id && message.sysid != 0) {
+            _mavlinkMessageReceived(link, message);
+        }
+    });
+}
+
+/// Only calls handleMessage on the fact groups which declared the message id in handledMessageIds
+void Vehicle::_dispatchToFactGroups(mavlink_message_t& message)
+{
+    if (_factGroupDispatchDirty) {
+        _factGroupDispatch.clear();
+        for (FactGroup* factGroup : factGroups()) {
+            for (uint32_t msgId : factGroup->handledMessageIds()) {
+                _factGroupDispatch[msgId].append(factGroup);
+            }
+        }
+        _factGroupDispatchDirty = false;
+    }
+
+    auto iter = _factGroupDispatch.constFind(message.msgid);
+    if (iter != _factGroupDispatch.constEnd()) {
+        for (FactGroup* factGroup : iter.value()) {
+            factGroup->handleMessage(this, message);
+        }
+    }
+}
+
 void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
 {
+    QGC_TRACE_SCOPE("Vehicle::_mavlinkMessageReceived");
+
     // If the link is already running at Mavlink V2 set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
     if (_maxProtoVersion != mavlinkVersion && mavlinkVersion >= 200) {
@@ -620,8 +689,11 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         }
     }
 
-    // We give the link manager first whack since it it reponsible for adding new links
-    _vehicleLinkManager->mavlinkMessageReceived(link, message);
+    // We give the link manager first whack since it it reponsible for adding new links. It also drops the copies
+    // of a message which arrive over redundant links, so they are only processed once.
+    if (!_vehicleLinkManager->mavlinkMessageReceived(link, message)) {
+        return;
+    }
 
     //-- Check link status
     _messagesReceived++;
@@ -659,6 +731,25 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         return;
     }
 
+    if (_monitorOnly) {
+        switch (message.msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_SYS_STATUS:
+        case MAVLINK_MSG_ID_BATTERY_STATUS:
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        case MAVLINK_MSG_ID_GPS_RAW_INT:
+        case MAVLINK_MSG_ID_HOME_POSITION:
+        case MAVLINK_MSG_ID_ATTITUDE:
+        case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_RADIO_STATUS:
+            break;
+        default:
+            // The rest is only needed once the vehicle is activated
+            return;
+        }
+    }
+
     if (!_terrainProtocolHandler->mavlinkMessageReceived(message)) {
         return;
     }
@@ -673,9 +764,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
 
     // Let the fact groups take a whack at the mavlink traffic
-    for (FactGroup* factGroup : factGroups()) {
-        factGroup->handleMessage(this, message);
-    }
+    _dispatchToFactGroups(message);
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
@@ -685,7 +774,7 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         _handleHeartbeat(message);
         break;
     case MAVLINK_MSG_ID_RADIO_STATUS:
-        _handleRadioStatus(message);
+        _handleRadioStatus(link, message);
         break;
     case MAVLINK_MSG_ID_RC_CHANNELS:
         _handleRCChannels(message);
@@ -1019,20 +1108,16 @@ void Vehicle::_handleVfrHud(mavlink_message_t& message)
 
 void Vehicle::_handleRangefinder(mavlink_message_t& message)
 {
-    mavlink_rangefinder_t rangefinder;
-    mavlink_msg_rangefinder_decode(&message, &rangefinder);
-    _rangeFinderDistFact.setRawValue(qIsNaN(rangefinder.distance) ? 0 : rangefinder.distance);
+    const float distance = QGC_MAVLINK_FIELD(message, rangefinder, distance);
+    _rangeFinderDistFact.setRawValue(qIsNaN(distance) ? 0 : distance);
 }
 
 
 void Vehicle::_handleNavControllerOutput(mavlink_message_t& message)
 {
-    mavlink_nav_controller_output_t navControllerOutput;
-    mavlink_msg_nav_controller_output_decode(&message, &navControllerOutput);
-
-    _altitudeTuningSetpointFact.setRawValue(_altitudeTuningFact.rawValue().toDouble() - navControllerOutput.alt_error);
-    _xTrackErrorFact.setRawValue(navControllerOutput.xtrack_error);
-    _airSpeedSetpointFact.setRawValue(_airSpeedFact.rawValue().toDouble() - navControllerOutput.aspd_error);
+    _altitudeTuningSetpointFact.setRawValue(_altitudeTuningFact.rawValue().toDouble() - QGC_MAVLINK_FIELD(message, nav_controller_output, alt_error));
+    _xTrackErrorFact.setRawValue(QGC_MAVLINK_FIELD(message, nav_controller_output, xtrack_error));
+    _airSpeedSetpointFact.setRawValue(_airSpeedFact.rawValue().toDouble() - QGC_MAVLINK_FIELD(message, nav_controller_output, aspd_error));
 }
 
 // Ignore warnings from mavlink headers for both GCC/Clang and MSVC
@@ -1087,10 +1172,7 @@ void Vehicle::_handleAttitude(mavlink_message_t& message)
         return;
     }
 
-    mavlink_attitude_t attitude;
-    mavlink_msg_attitude_decode(&message, &attitude);
-
-    _handleAttitudeWorker(attitude.roll, attitude.pitch, attitude.yaw);
+    _handleAttitudeWorker(QGC_MAVLINK_FIELD(message, attitude, roll), QGC_MAVLINK_FIELD(message, attitude, pitch), QGC_MAVLINK_FIELD(message, attitude, yaw));
 }
 
 void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
@@ -1128,20 +1210,18 @@ void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
 
 void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
 {
-    mavlink_gps_raw_int_t gpsRawInt;
-    mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
-
     _gpsRawIntMessageAvailable = true;
 
-    if (gpsRawInt.fix_type >= GPS_FIX_TYPE_3D_FIX) {
+    if (QGC_MAVLINK_FIELD(message, gps_raw_int, fix_type) >= GPS_FIX_TYPE_3D_FIX) {
         if (!_globalPositionIntMessageAvailable) {
-            QGeoCoordinate newPosition(gpsRawInt.lat  / (double)1E7, gpsRawInt.lon / (double)1E7, gpsRawInt.alt  / 1000.0);
+            const int32_t alt = QGC_MAVLINK_FIELD(message, gps_raw_int, alt);
+            QGeoCoordinate newPosition(QGC_MAVLINK_FIELD(message, gps_raw_int, lat) / (double)1E7, QGC_MAVLINK_FIELD(message, gps_raw_int, lon) / (double)1E7, alt / 1000.0);
             if (newPosition != _coordinate) {
                 _coordinate = newPosition;
                 emit coordinateChanged(_coordinate);
             }
             if (!_altitudeMessageAvailable) {
-                _altitudeAMSLFact.setRawValue(gpsRawInt.alt / 1000.0);
+                _altitudeAMSLFact.setRawValue(alt / 1000.0);
             }
         }
     }
@@ -1149,22 +1229,23 @@ void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
 
 void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
 {
-    mavlink_global_position_int_t globalPositionInt;
-    mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
+    const int32_t alt = QGC_MAVLINK_FIELD(message, global_position_int, alt);
 
     if (!_altitudeMessageAvailable) {
-        _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
-        _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
+        _altitudeRelativeFact.setRawValue(QGC_MAVLINK_FIELD(message, global_position_int, relative_alt) / 1000.0);
+        _altitudeAMSLFact.setRawValue(alt / 1000.0);
     }
 
     // ArduPilot sends bogus GLOBAL_POSITION_INT messages with lat/lat 0/0 even when it has no gps signal
     // Apparently, this is in order to transport relative altitude information.
-    if (globalPositionInt.lat == 0 && globalPositionInt.lon == 0) {
+    const int32_t lat = QGC_MAVLINK_FIELD(message, global_position_int, lat);
+    const int32_t lon = QGC_MAVLINK_FIELD(message, global_position_int, lon);
+    if (lat == 0 && lon == 0) {
         return;
     }
 
     _globalPositionIntMessageAvailable = true;
-    QGeoCoordinate newPosition(globalPositionInt.lat  / (double)1E7, globalPositionInt.lon / (double)1E7, globalPositionInt.alt  / 1000.0);
+    QGeoCoordinate newPosition(lat / (double)1E7, lon / (double)1E7, alt / 1000.0);
     if (newPosition != _coordinate) {
         _coordinate = newPosition;
         emit coordinateChanged(_coordinate);
@@ -1284,13 +1365,10 @@ void Vehicle::_handleHighLatency2(mavlink_message_t& message)
 
 void Vehicle::_handleAltitude(mavlink_message_t& message)
 {
-    mavlink_altitude_t altitude;
-    mavlink_msg_altitude_decode(&message, &altitude);
-
     // Data from ALTITUDE message takes precedence over gps messages
     _altitudeMessageAvailable = true;
-    _altitudeRelativeFact.setRawValue(altitude.altitude_relative);
-    _altitudeAMSLFact.setRawValue(altitude.altitude_amsl);
+    _altitudeRelativeFact.setRawValue(QGC_MAVLINK_FIELD(message, altitude, altitude_relative));
+    _altitudeAMSLFact.setRawValue(QGC_MAVLINK_FIELD(message, altitude, altitude_amsl));
 }
 
 void Vehicle::_setCapabilities(uint64_t capabilityBits)
@@ -1733,11 +1811,10 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
         return;
     }
 
-    mavlink_heartbeat_t heartbeat;
+    const uint8_t   baseMode    = QGC_MAVLINK_FIELD(message, heartbeat, base_mode);
+    const uint32_t  customMode  = QGC_MAVLINK_FIELD(message, heartbeat, custom_mode);
 
-    mavlink_msg_heartbeat_decode(&message, &heartbeat);
-
-    bool newArmed = heartbeat.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
+    bool newArmed = baseMode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
 
     // ArduPilot firmare has a strange case when ARMING_REQUIRE=0. This means the vehicle is always armed but the motors are not
     // really powered up until the safety button is pressed. Because of this we can't depend on the heartbeat to tell us the true
@@ -1752,28 +1829,31 @@ void Vehicle::_handleHeartbeat(mavlink_message_t& message)
         _updateArmed(newArmed);
     }
 
-    if (heartbeat.base_mode != _base_mode || heartbeat.custom_mode != _custom_mode) {
+    if (baseMode != _base_mode || customMode != _custom_mode) {
         QString previousFlightMode;
         if (_base_mode != 0 || _custom_mode != 0){
             // Vehicle is initialized with _base_mode=0 and _custom_mode=0. Don't pass this to flightMode() since it will complain about
             // bad modes while unit testing.
             previousFlightMode = flightMode();
         }
-        _base_mode   = heartbeat.base_mode;
-        _custom_mode = heartbeat.custom_mode;
+        _base_mode   = baseMode;
+        _custom_mode = customMode;
         if (previousFlightMode != flightMode()) {
             emit flightModeChanged(flightMode());
         }
     }
 }
 
-void Vehicle::_handleRadioStatus(mavlink_message_t& message)
+void Vehicle::_handleRadioStatus(LinkInterface* link, mavlink_message_t& message)
 {
 
     //-- Process telemetry status message
     mavlink_radio_status_t rstatus;
     mavlink_msg_radio_status_decode(&message, &rstatus);
 
+    // Lets the link hold back bulk traffic while the radio buffer is filling up
+    link->setRadioTxBufferThreadSafe(rstatus.txbuf);
+
     int rssi    = rstatus.rssi;
     int remrssi = rstatus.remrssi;
     int lnoise = (int)(int8_t)rstatus.noise;
@@ -1880,7 +1960,7 @@ void Vehicle::_handleRCChannels(mavlink_message_t& message)
 #pragma warning(pop, 0)
 #endif
 
-bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t message)
+bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t message, LinkInterface::WritePriority_t priority)
 {
     if (!link->isConnected()) {
         qCDebug(VehicleLog) << "sendMessageOnLinkThreadSafe" << link << "not connected!";
@@ -1894,7 +1974,10 @@ bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    link->writeBytesThreadSafe((const char*)buffer, len);
+    if (priority == LinkInterface::WritePriorityNormal) {
+        priority = LinkInterface::writePriorityForMessage(message.msgid);
+    }
+    link->writeBytesThreadSafe((const char*)buffer, len, priority, _id);
     _messagesSent++;
     emit messagesSentChanged();
 
@@ -1975,10 +2058,13 @@ bool Vehicle::xConfigMotors()
 
 QString Vehicle::formattedMessages()
 {
+    UASMessageHandler* pMh = _toolbox->uasMessageHandler();
     QString messages;
-    for(UASMessage* message: _toolbox->uasMessageHandler()->messages()) {
+    pMh->lockAccess();
+    for(UASMessage* message: pMh->messages()) {
         messages += message->getFormatedText();
     }
+    pMh->unlockAccess();
     return messages;
 }
 
@@ -2409,8 +2495,7 @@ void Vehicle::_sendQGCTimeToVehicle()
 
 void Vehicle::_imageProtocolImageReady(void)
 {
-    QImage img = _imageProtocolManager->getImage();
-    _toolbox->imageProvider()->setImage(&img, _id);
+    _toolbox->imageProvider()->setImage(_imageProtocolManager->getImage(), _id);
     _flowImageIndex++;
     emit flowImageIndexChanged();
 }
@@ -2939,19 +3024,12 @@ void Vehicle::sendMavCommandInt(int compId, MAV_CMD command, MAV_FRAME frame, bo
 
 bool Vehicle::isMavCommandPending(int targetCompId, MAV_CMD command)
 {
-    return ((-1) < _findMavCommandListEntryIndex(targetCompId, command));
+    return _mavCommandSlots.contains(_mavCommandSlotKey(targetCompId, command));
 }
 
-int Vehicle::_findMavCommandListEntryIndex(int targetCompId, MAV_CMD command)
+quint32 Vehicle::_mavCommandSlotKey(int targetCompId, MAV_CMD command)
 {
-    for (int i=0; i<_mavCommandList.count(); i++) {
-        const MavCommandListEntry_t& entry = _mavCommandList[i];
-        if (entry.targetCompId == targetCompId && entry.command == command) {
-            return i;
-        }
-    }
-
-    return -1;
+    return (static_cast<quint32>(targetCompId & 0xFF) << 16) | static_cast<quint32>(command & 0xFFFF);
 }
 
 bool Vehicle::_sendMavCommandShouldRetry(MAV_CMD command)
@@ -3010,6 +3088,7 @@ void Vehicle::_sendMavCommandWorker(bool commandInt, bool showError, MavCmdResul
         // If we send multiple versions of the same command to a component there is no way to discern which COMMAND_ACK we get back goes with which.
         // Because of this we fail in that case.
         MavCmdResultFailureCode_t failureCode = compIdAll ? MavCmdResultCommandResultOnly : MavCmdResultFailureDuplicateCommand;
+        _mavCommandStats.duplicatesRejected++;
         if (resultHandler) {
             (*resultHandler)(resultHandlerData, targetCompId, MAV_RESULT_FAILED, 0, failureCode);
         } else {
@@ -3046,21 +3125,28 @@ void Vehicle::_sendMavCommandWorker(bool commandInt, bool showError, MavCmdResul
     entry.rgParam7          = param7;
     entry.maxTries          = _sendMavCommandShouldRetry(command) ? _mavCommandMaxRetryCount : 1;
     entry.ackTimeoutMSecs   = sharedLink->linkConfiguration()->isHighLatency() ? _mavCommandAckTimeoutMSecsHighLatency : _mavCommandAckTimeoutMSecs;
-    entry.elapsedTimer.start();
 
-    _mavCommandList.append(entry);
-    _sendMavCommandFromList(_mavCommandList.count() - 1);
+    const quint32 slotKey = _mavCommandSlotKey(targetCompId, command);
+    QList<MavCommandListEntry_t>& slot = _mavCommandSlots[slotKey];
+    slot.append(entry);
+    _mavCommandStats.sent++;
+    _sendMavCommandFromList(slotKey, slot.count() - 1);
 }
 
-void Vehicle::_sendMavCommandFromList(int index)
+void Vehicle::_sendMavCommandFromList(quint32 slotKey, int index)
 {
-    MavCommandListEntry_t commandEntry = _mavCommandList[index];
+    QList<MavCommandListEntry_t>&   slot            = _mavCommandSlots[slotKey];
+    MavCommandListEntry_t           commandEntry    = slot[index];
 
     QString rawCommandName  = _toolbox->missionCommandTree()->rawName(commandEntry.command);
 
-    if (++_mavCommandList[index].tryCount > commandEntry.maxTries) {
+    if (++slot[index].tryCount > commandEntry.maxTries) {
         qCDebug(VehicleLog) << "_sendMavCommandFromList giving up after max retries" << rawCommandName;
-        _mavCommandList.removeAt(index);
+        slot.removeAt(index);
+        if (slot.isEmpty()) {
+            _mavCommandSlots.remove(slotKey);
+        }
+        _mavCommandStats.noResponse++;
         if (commandEntry.resultHandler) {
             (*commandEntry.resultHandler)(commandEntry.resultHandlerData, commandEntry.targetCompId, MAV_RESULT_FAILED, 0, MavCmdResultFailureNoResponseToCommand);
         } else {
@@ -3072,6 +3158,16 @@ void Vehicle::_sendMavCommandFromList(int index)
         return;
     }
 
+    // The first try waits for the ack timeout, further tries follow at the response check interval
+    const bool firstTry = slot[index].tryCount == 1;
+    slot[index].deadlineMSecs = _mavCommandClock.elapsed() + (firstTry ? commandEntry.ackTimeoutMSecs : _mavCommandResponseCheckTimeoutMSecs);
+    slot[index].elapsedTimer.start();
+    _mavCommandDeadlines.insert(slot[index].deadlineMSecs, slotKey);
+    _armMavCommandResponseCheckTimer();
+    if (!firstTry) {
+        _mavCommandStats.retries++;
+    }
+
     if (commandEntry.tryCount > 1 && !px4Firmware() && commandEntry.command == MAV_CMD_START_RX_PAIR) {
         // The implementation of this command comes from the IO layer and is shared across stacks. So for other firmwares
         // we aren't really sure whether they are correct or not.
@@ -3133,20 +3229,43 @@ void Vehicle::_sendMavCommandFromList(int index)
     sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
 }
 
-void Vehicle::_sendMavCommandResponseTimeoutCheck(void)
+void Vehicle::_armMavCommandResponseCheckTimer(void)
 {
-    if (_mavCommandList.isEmpty()) {
+    if (_mavCommandDeadlines.isEmpty()) {
+        _mavCommandResponseCheckTimer.stop();
         return;
     }
+    _mavCommandResponseCheckTimer.start(static_cast<int>(qMax(_mavCommandDeadlines.firstKey() - _mavCommandClock.elapsed(), static_cast<qint64>(0))));
+}
+
+void Vehicle::_sendMavCommandResponseTimeoutCheck(void)
+{
+    const qint64    now = _mavCommandClock.elapsed();
+    QList<quint32>  expiredSlotKeys;
 
-    // Walk the list backwards since _sendMavCommandFromList can remove entries
-    for (int i=_mavCommandList.count()-1; i>=0; i--) {
-        MavCommandListEntry_t& commandEntry = _mavCommandList[i];
-        if (commandEntry.elapsedTimer.elapsed() > commandEntry.ackTimeoutMSecs) {
-            // Try sending command again
-            _sendMavCommandFromList(i);
+    while (!_mavCommandDeadlines.isEmpty() && _mavCommandDeadlines.firstKey() <= now) {
+        const quint32 slotKey = _mavCommandDeadlines.take(_mavCommandDeadlines.firstKey());
+        if (!expiredSlotKeys.contains(slotKey)) {
+            expiredSlotKeys.append(slotKey);
         }
     }
+
+    for (quint32 slotKey: expiredSlotKeys) {
+        // Walk the slot backwards since _sendMavCommandFromList can remove entries. Deadlines of acked commands are
+        // still in the map, they find no entry here.
+        for (int i=_mavCommandSlots.value(slotKey).count()-1; i>=0; i--) {
+            auto slotIt = _mavCommandSlots.find(slotKey);
+            if (slotIt == _mavCommandSlots.end()) {
+                break;
+            }
+            if (i < slotIt->count() && (*slotIt)[i].deadlineMSecs <= now) {
+                // Try sending command again
+                _sendMavCommandFromList(slotKey, i);
+            }
+        }
+    }
+
+    _armMavCommandResponseCheckTimer();
 }
 
 void Vehicle::_handleCommandAck(mavlink_message_t& message)
@@ -3182,10 +3301,21 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
     }
 #endif
 
-    int entryIndex = _findMavCommandListEntryIndex(message.compid, static_cast<MAV_CMD>(ack.command));
-    bool commandInList = false;
-    if (entryIndex != -1) {
-        MavCommandListEntry_t commandEntry = _mavCommandList.takeAt(entryIndex);
+    const quint32   slotKey         = _mavCommandSlotKey(message.compid, static_cast<MAV_CMD>(ack.command));
+    auto            slotIt          = _mavCommandSlots.find(slotKey);
+    bool            commandInList   = false;
+    if (slotIt != _mavCommandSlots.end()) {
+        MavCommandListEntry_t commandEntry = slotIt->takeFirst();
+        if (slotIt->isEmpty()) {
+            _mavCommandSlots.erase(slotIt);
+        }
+
+        const qint64 rttMSecs = commandEntry.elapsedTimer.elapsed();
+        _mavCommandStats.acked++;
+        _mavCommandStats.rttAvgMSecs += (rttMSecs - _mavCommandStats.rttAvgMSecs) / _mavCommandStats.acked;
+        _mavCommandStats.rttMaxMSecs = qMax(_mavCommandStats.rttMaxMSecs, rttMSecs);
+        qCDebug(VehicleLog) << "_handleCommandAck rtt:tryCount" << rawCommandName << rttMSecs << commandEntry.tryCount;
+
         if (commandEntry.command == ack.command) {
             if (commandEntry.resultHandler) {
                 (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), ack.progress, MavCmdResultCommandResultOnly);
@@ -3218,11 +3348,6 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
     if (!commandInList) {
         qCDebug(VehicleLog) << "_handleCommandAck Ack not in list" << rawCommandName;
     }
-
-    // advance PID tuning setup/teardown
-    if (ack.command == MAV_CMD_SET_MESSAGE_INTERVAL) {
-        _mavlinkStreamConfig.gotSetMessageIntervalAck();
-    }
 }
 
 void Vehicle::_waitForMavlinkMessage(WaitForMavlinkMessageResultHandler resultHandler, void* resultHandlerData, int messageId, int timeoutMsecs)
@@ -3575,11 +3700,11 @@ void Vehicle::stopMavlinkLog()
     sendMavCommand(_defaultComponentId, MAV_CMD_LOGGING_STOP, false /* showError */);
 }
 
-void Vehicle::_ackMavlinkLogData(uint16_t sequence)
+void Vehicle::ackMavlinkLogData(uint16_t sequence)
 {
     SharedLinkInterfacePtr  sharedLink = vehicleLinkManager()->primaryLink().lock();
     if (!sharedLink) {
-        qCDebug(VehicleLog) << "_ackMavlinkLogData: primary link gone!";
+        qCDebug(VehicleLog) << "ackMavlinkLogData: primary link gone!";
         return;
     }
 
@@ -3615,12 +3740,13 @@ void Vehicle::_handleMavlinkLoggingDataAcked(mavlink_message_t& message)
 {
     mavlink_logging_data_acked_t log;
     mavlink_msg_logging_data_acked_decode(&message, &log);
-    _ackMavlinkLogData(log.sequence);
     if (static_cast<size_t>(log.length) > sizeof(log.data)) {
         qWarning() << "Invalid length for LOGGING_DATA_ACKED, discarding." << log.length;
+        ackMavlinkLogData(log.sequence);
     } else {
+        // Acked by the receiver of mavlinkLogData
         emit mavlinkLogData(this, log.target_system, log.target_component, log.sequence,
-                            log.first_message_offset, QByteArray((const char*)log.data, log.length), false);
+                            log.first_message_offset, QByteArray((const char*)log.data, log.length), true);
     }
 }
 
@@ -3773,6 +3899,12 @@ void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
             vehicleInfo.availableFlags |= ADSBVehicle::HeadingAvailable;
         }
 
+        if (adsbVehicleMsg.flags & ADSB_FLAGS_VALID_VELOCITY) {
+            vehicleInfo.horizontalVelocity = adsbVehicleMsg.hor_velocity / 100.0;
+            vehicleInfo.verticalVelocity = adsbVehicleMsg.ver_velocity / 100.0;
+            vehicleInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
+        }
+
         _toolbox->adsbVehicleManager()->adsbVehicleUpdate(vehicleInfo);
     }
 }
@@ -3922,18 +4054,24 @@ void Vehicle::setPIDTuningTelemetryMode(PIDTuningTelemetryMode mode)
     _localPositionFactGroup.setLiveUpdates(liveUpdate);
     _localPositionSetpointFactGroup.setLiveUpdates(liveUpdate);
 
+    // 100 Hz in usecs (better set this a bit higher than actually needed, to give it more priority in case of exceeding link bandwidth)
+    const int       requestedRate = static_cast<int>(1000000.0 / 100.0);
+    QMap<int, int>  intervals;
+
     switch (mode) {
     case ModeDisabled:
-        _mavlinkStreamConfig.restoreDefaults();
         break;
     case ModeRateAndAttitude:
-        _mavlinkStreamConfig.setHighRateRateAndAttitude();
+        intervals[MAVLINK_MSG_ID_ATTITUDE_QUATERNION]       = requestedRate;
+        intervals[MAVLINK_MSG_ID_ATTITUDE_TARGET]           = requestedRate;
         break;
     case ModeVelocityAndPosition:
-        _mavlinkStreamConfig.setHighRateVelAndPos();
+        intervals[MAVLINK_MSG_ID_LOCAL_POSITION_NED]        = requestedRate;
+        intervals[MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED] = requestedRate;
         break;
     case ModeAltitudeAndAirspeed:
-        _mavlinkStreamConfig.setHighRateAltAirspeed();
+        intervals[MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT]     = requestedRate;
+        intervals[MAVLINK_MSG_ID_VFR_HUD]                   = requestedRate;
         // reset the altitude offset to the current value, so the plotted value is around 0
         if (!qIsNaN(_altitudeTuningOffset)) {
             _altitudeTuningOffset += _altitudeTuningFact.rawValue().toDouble();
@@ -3942,20 +4080,76 @@ void Vehicle::setPIDTuningTelemetryMode(PIDTuningTelemetryMode mode)
         }
         break;
     }
+    _mavlinkStreamConfig.setConsumerRates(QStringLiteral("PIDTuning"), intervals);
+}
+
+void Vehicle::setStreamRates(const QString& consumer, const QMap<int, int>& intervalsUSecs)
+{
+    _mavlinkStreamConfig.setConsumerRates(consumer, intervalsUSecs);
 }
 
 void Vehicle::_setMessageInterval(int messageId, int rate)
 {
-    sendMavCommand(defaultComponentId(),
-                   MAV_CMD_SET_MESSAGE_INTERVAL,
-                   true,                        // show error
-                   messageId,
-                   rate);
+    SetMessageIntervalRequest_t* request = new SetMessageIntervalRequest_t{ this, messageId, rate };
+    sendMavCommandWithHandler(_setMessageIntervalResultHandler,
+                              request,
+                              defaultComponentId(),
+                              MAV_CMD_SET_MESSAGE_INTERVAL,
+                              messageId,
+                              rate);
+}
+
+void Vehicle::_setMessageIntervalResultHandler(void* resultHandlerData, int /*compId*/, MAV_RESULT result, uint8_t /*progress*/, MavCmdResultFailureCode_t failureCode)
+{
+    SetMessageIntervalRequest_t*    request = static_cast<SetMessageIntervalRequest_t*>(resultHandlerData);
+    Vehicle*                        vehicle = request->vehicle;
+    const int                       messageId = request->messageId;
+    const int                       rate = request->rate;
+    delete request;
+
+    if (failureCode == MavCmdResultFailureDuplicateCommand) {
+        // Someone else has a SET_MESSAGE_INTERVAL outstanding, try again once it is done
+        QTimer::singleShot(_mavCommandResponseCheckTimeoutMSecs, vehicle, [vehicle, messageId, rate]() { vehicle->_setMessageInterval(messageId, rate); });
+        return;
+    }
+    if (result != MAV_RESULT_ACCEPTED) {
+        qCWarning(VehicleLog) << "SET_MESSAGE_INTERVAL failed msgid:rate:result:failureCode" << messageId << rate << result << failureCode;
+    }
+    vehicle->_mavlinkStreamConfig.gotSetMessageIntervalAck();
 }
 
 bool Vehicle::isInitialConnectComplete() const
 {
-    return !_initialConnectStateMachine->active();
+    return !_monitorOnly && !_initialConnectStateMachine->active() && !_toolbox->multiVehicleManager()->initialConnectScheduler()->isQueued(_initialConnectStateMachine);
+}
+
+void Vehicle::activateFullVehicle(void)
+{
+    if (!_monitorOnly) {
+        return;
+    }
+
+    qCDebug(VehicleLog) << "activateFullVehicle" << _id;
+
+    _monitorOnly = false;
+    emit monitorOnlyChanged(false);
+
+    _toolbox->multiVehicleManager()->initialConnectScheduler()->requestStart(_initialConnectStateMachine);
+    if (!_cameraManager) {
+        _cameraManager = _firmwarePlugin->createCameraManager(this);
+        emit cameraManagerChanged();
+    }
+}
+
+MAVLinkMetrics* Vehicle::mavlinkMetrics()
+{
+    return _toolbox->mavlinkProtocol()->vehicleMetrics(_id);
+}
+
+void Vehicle::_updateCsvLogRate()
+{
+    int rateHz = qMax(1, _settingsManager->appSettings()->csvTelemetryRate()->rawValue().toInt());
+    _csvLogTimer.start(1000 / rateHz);
 }
 
 void Vehicle::_initializeCsv()
@@ -3966,54 +4160,131 @@ void Vehicle::_initializeCsv()
     QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
     QString fileName = QString("%1 vehicle%2.csv").arg(now).arg(_id);
     QDir saveDir(_toolbox->settingsManager()->appSettings()->telemetrySavePath());
-    _csvLogFile.setFileName(saveDir.absoluteFilePath(fileName));
-
-    if (!_csvLogFile.open(QIODevice::Append)) {
-        qCWarning(VehicleLog) << "unable to open file for csv logging, Stopping csv logging!";
-        return;
-    }
+    _csvFileName = saveDir.absoluteFilePath(fileName);
 
-    QTextStream stream(&_csvLogFile);
+    // Fact lookups are done once here, each sample only copies values. String Facts have no numeric value to archive.
     QStringList allFactNames;
-    allFactNames << factNames();
+    _csvFacts.clear();
+    for (const QString& factName: factNames()) {
+        Fact* fact = getFact(factName);
+        if (fact->type() != FactMetaData::valueTypeString) {
+            _csvFacts.append(fact);
+            allFactNames << factName;
+        }
+    }
     for (const QString& groupName: factGroupNames()) {
-        for(const QString& factName: getFactGroup(groupName)->factNames()){
-            allFactNames << QString("%1.%2").arg(groupName, factName);
+        FactGroup* factGroup = getFactGroup(groupName);
+        for(const QString& factName: factGroup->factNames()){
+            Fact* fact = factGroup->getFact(factName);
+            if (fact->type() != FactMetaData::valueTypeString) {
+                _csvFacts.append(fact);
+                allFactNames << QString("%1.%2").arg(groupName, factName);
+            }
         }
     }
+    _csvValues.resize(_csvFacts.count());
+
+    double rateHz = 1000.0 / _csvLogTimer.interval();
+    if (!_csvArchive.open(saveDir.absoluteFilePath(QString("%1 vehicle%2.qgctarc").arg(now).arg(_id)), allFactNames, rateHz)) {
+        qCWarning(VehicleLog) << "unable to open file for csv logging, Stopping csv logging!";
+        return;
+    }
     qCDebug(VehicleLog) << "Facts logged to csv:" << allFactNames;
-    stream << "Timestamp," << allFactNames.join(",") << "\n";
 }
 
 void Vehicle::_writeCsvLine()
 {
     // Only save the logs after the the vehicle gets armed, unless "Save logs even if vehicle was not armed" is checked
-    if(!_csvLogFile.isOpen() &&
-            (_armed || _toolbox->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool())){
+    if(!_csvArchive.isOpen() &&
+            (_armed || _csvSaveNotArmed)){
         _initializeCsv();
     }
 
-    if(!_csvLogFile.isOpen()){
+    if(!_csvArchive.isOpen()){
         return;
     }
 
-    QStringList allFactValues;
-    QTextStream stream(&_csvLogFile);
+    for (int i=0; i<_csvFacts.count(); i++) {
+        bool ok;
+        double value = _csvFacts[i]->cookedValue().toDouble(&ok);
+        _csvValues[i] = ok ? value : qQNaN();
+    }
+    _csvArchive.append(QDateTime::currentMSecsSinceEpoch(), _csvValues);
+}
 
-    // Write timestamp to csv file
-    allFactValues << QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz"));
-    // Write Vehicle's own facts
-    for (const QString& factName : factNames()) {
-        allFactValues << getFact(factName)->cookedValueString();
+void Vehicle::_publishTelemetrySnapshot()
+{
+    auto factValue = [](Fact* fact) {
+        bool ok;
+        double value = fact->rawValue().toDouble(&ok);
+        return ok ? value : qQNaN();
+    };
+
+    VehicleTelemetrySnapshot::Telemetry_t telemetry;
+    memset(&telemetry, 0, sizeof(telemetry));
+
+    telemetry.publishCount      = _telemetrySnapshot->publishCount() + 1;
+    telemetry.timestampMSecs    = QDateTime::currentMSecsSinceEpoch();
+    telemetry.vehicleId         = _id;
+
+    telemetry.latitude          = _coordinate.isValid() ? _coordinate.latitude() : qQNaN();
+    telemetry.longitude         = _coordinate.isValid() ? _coordinate.longitude() : qQNaN();
+    telemetry.altitudeAMSL      = factValue(&_altitudeAMSLFact);
+    telemetry.altitudeRelative  = factValue(&_altitudeRelativeFact);
+    telemetry.groundSpeed       = factValue(&_groundSpeedFact);
+    telemetry.airSpeed          = factValue(&_airSpeedFact);
+    telemetry.climbRate         = factValue(&_climbRateFact);
+
+    telemetry.roll              = factValue(&_rollFact);
+    telemetry.pitch             = factValue(&_pitchFact);
+    telemetry.heading           = factValue(&_headingFact);
+
+    VehicleBatteryFactGroup* battery = _batteryFactGroupListModel.count() ? _batteryFactGroupListModel.value<VehicleBatteryFactGroup*>(0) : nullptr;
+    if (battery) {
+        telemetry.batteryVoltage            = factValue(battery->voltage());
+        telemetry.batteryCurrent            = factValue(battery->current());
+        const double percentRemaining       = factValue(battery->percentRemaining());
+        telemetry.batteryPercentRemaining   = qIsNaN(percentRemaining) ? -1 : static_cast<int>(percentRemaining);
+    } else {
+        telemetry.batteryVoltage            = qQNaN();
+        telemetry.batteryCurrent            = qQNaN();
+        telemetry.batteryPercentRemaining   = -1;
     }
-    // write facts from Vehicle's FactGroups
-    for (const QString& groupName: factGroupNames()) {
-        for (const QString& factName : getFactGroup(groupName)->factNames()) {
-            allFactValues << getFactGroup(groupName)->getFact(factName)->cookedValueString();
-        }
+
+    telemetry.gpsLatitude           = factValue(_gpsFactGroup.lat());
+    telemetry.gpsLongitude          = factValue(_gpsFactGroup.lon());
+    telemetry.gpsHdop               = factValue(_gpsFactGroup.hdop());
+    telemetry.gpsVdop               = factValue(_gpsFactGroup.vdop());
+    telemetry.gpsFixType            = _gpsFactGroup.lock()->rawValue().toInt();
+    telemetry.gpsSatellitesVisible  = _gpsFactGroup.count()->rawValue().toInt();
+
+    telemetry.armed         = _armed;
+    telemetry.flying        = _flying;
+    telemetry.baseMode      = _base_mode;
+    telemetry.customMode    = _custom_mode;
+    qstrncpy(telemetry.flightMode, flightMode().toUtf8().constData(), sizeof(telemetry.flightMode));
+
+    _telemetrySnapshot->publish(telemetry);
+}
+
+void Vehicle::_closeCsv()
+{
+    if(!_csvArchive.isOpen()){
+        return;
     }
+    _csvArchive.close();
 
-    stream << allFactValues.join(",") << "\n";
+    // Write the csv file in the background, the archive is only kept if that fails
+    QString archiveFileName = _csvArchive.fileName();
+    QString csvFileName     = _csvFileName;
+    QtConcurrent::run([archiveFileName, csvFileName]() {
+        QString errorString;
+        if (TelemetryArchive::convertToCsv(archiveFileName, csvFileName, errorString)) {
+            QFile::remove(archiveFileName);
+        } else {
+            qCWarning(VehicleLog) << "Csv telemetry conversion failed" << errorString;
+        }
+    });
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
@@ -4101,7 +4372,7 @@ void Vehicle::_handleObstacleDistance(const mavlink_message_t& message)
 {
     mavlink_obstacle_distance_t o;
     mavlink_msg_obstacle_distance_decode(&message, &o);
-    _objectAvoidance->update(&o);
+    _objectAvoidance->update(message.compid, &o);
 }
 
 void Vehicle::updateFlightDistance(double distance)
@@ -4202,7 +4473,7 @@ void Vehicle::sendJoystickDataThreadSafe(float roll, float pitch, float yaw, flo
                 static_cast<int16_t>(newYawCommand),
                 buttons,
                 0, 0, 0, 0);
-    sendMessageOnLinkThreadSafe(sharedLink.get(), message);
+    sendMessageOnLinkThreadSafe(sharedLink.get(), message, LinkInterface::WritePriorityRealtime);
 }
 
 void Vehicle::triggerSimpleCamera()
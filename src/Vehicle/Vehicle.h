@@ -16,6 +16,8 @@
 #include <QTime>
 #include <QQueue>
 #include <QSharedPointer>
+#include <QHash>
+#include <QMap>
 
 #include "FactGroup.h"
 #include "QGCMAVLink.h"
@@ -26,6 +28,7 @@
 #include "SettingsFact.h"
 #include "QGCMapCircle.h"
 #include "TerrainFactGroup.h"
+#include "VehicleGeoFenceFactGroup.h"
 #include "SysStatusSensorInfo.h"
 #include "VehicleClockFactGroup.h"
 #include "VehicleDistanceSensorFactGroup.h"
@@ -46,6 +49,8 @@
 #include "ObstacleManager.h"
 #include "RallyPointManager.h"
 #include "FTPManager.h"
+#include "TelemetryArchive.h"
+#include "VehicleTelemetrySnapshot.h"
 #include "ImageProtocolManager.h"
 #include "HealthAndArmingCheckReport.h"
 
@@ -74,6 +79,7 @@ class LinkInterface;
 class LinkManager;
 class InitialConnectStateMachine;
 class Autotune;
+class PIDTuningRecorder;
 class RemoteIDManager;
 
 #if defined(QGC_AIRMAP_ENABLED)
@@ -107,7 +113,8 @@ public:
             MAV_AUTOPILOT           firmwareType,
             MAV_TYPE                vehicleType,
             FirmwarePluginManager*  firmwarePluginManager,
-            JoystickManager*        joystickManager);
+            JoystickManager*        joystickManager,
+            bool                    monitorOnly = false);
 
     // Pass these into the offline constructor to create an offline vehicle which tracks the offline vehicle settings
     static const MAV_AUTOPILOT    MAV_AUTOPILOT_TRACK = static_cast<MAV_AUTOPILOT>(-1);
@@ -172,6 +179,7 @@ public:
     Q_PROPERTY(QString              flightMode                  READ flightMode                 WRITE setFlightMode                 NOTIFY flightModeChanged)
     Q_PROPERTY(TrajectoryPoints*    trajectoryPoints            MEMBER _trajectoryPoints                                            CONSTANT)
     Q_PROPERTY(QmlObjectListModel*  cameraTriggerPoints         READ cameraTriggerPoints                                            CONSTANT)
+    Q_PROPERTY(MAVLinkMetrics*      mavlinkMetrics              READ mavlinkMetrics                                                 CONSTANT)
     Q_PROPERTY(float                latitude                    READ latitude                                                       NOTIFY coordinateChanged)
     Q_PROPERTY(float                longitude                   READ longitude                                                      NOTIFY coordinateChanged)
     Q_PROPERTY(bool                 messageTypeNone             READ messageTypeNone                                                NOTIFY messageTypeChanged)
@@ -259,6 +267,7 @@ public:
     Q_PROPERTY(bool                 requiresGpsFix              READ requiresGpsFix                                                 NOTIFY requiresGpsFixChanged)
     Q_PROPERTY(double               loadProgress                READ loadProgress                                                   NOTIFY loadProgressChanged)
     Q_PROPERTY(bool                 initialConnectComplete      READ isInitialConnectComplete                                       NOTIFY initialConnectComplete)
+    Q_PROPERTY(bool                 monitorOnly                 READ monitorOnly                                                    NOTIFY monitorOnlyChanged)
 
     // The following properties relate to Orbit status
     Q_PROPERTY(bool             orbitActive     READ orbitActive        NOTIFY orbitActiveChanged)
@@ -281,6 +290,7 @@ public:
     Q_PROPERTY(VehicleLinkManager*      vehicleLinkManager  READ vehicleLinkManager CONSTANT)
     Q_PROPERTY(VehicleObjectAvoidance*  objectAvoidance     READ objectAvoidance    CONSTANT)
     Q_PROPERTY(Autotune*                autotune            READ autotune           CONSTANT)
+    Q_PROPERTY(PIDTuningRecorder*       pidTuningRecorder   READ pidTuningRecorder  CONSTANT)
     Q_PROPERTY(RemoteIDManager*         remoteIDManager     READ remoteIDManager    CONSTANT)
 
     // FactGroup object model properties
@@ -324,6 +334,7 @@ public:
     Q_PROPERTY(FactGroup*           localPosition   READ localPositionFactGroup     CONSTANT)
     Q_PROPERTY(FactGroup*           localPositionSetpoint READ localPositionSetpointFactGroup CONSTANT)
     Q_PROPERTY(FactGroup*           hygrometer      READ hygrometerFactGroup        CONSTANT)
+    Q_PROPERTY(FactGroup*           geoFence        READ geoFenceFactGroup          CONSTANT)
     Q_PROPERTY(QmlObjectListModel*  batteries       READ batteries                  CONSTANT)
     Q_PROPERTY(Actuators*           actuators       READ actuators                  CONSTANT)
     Q_PROPERTY(HealthAndArmingCheckReport* healthAndArmingCheckReport READ healthAndArmingCheckReport CONSTANT)
@@ -439,6 +450,11 @@ public:
 
     Q_INVOKABLE void setPIDTuningTelemetryMode(PIDTuningTelemetryMode mode);
 
+    /// Sets the stream rates a consumer needs. Each message streams at the fastest rate any consumer asks for, rates
+    /// nobody asks for any more are restored to the vehicle default.
+    ///     @param intervalsUSecs   Message id to interval in usecs, empty removes the consumer
+    void setStreamRates(const QString& consumer, const QMap<int, int>& intervalsUSecs);
+
     Q_INVOKABLE void gimbalControlValue (double pitch, double yaw);
     Q_INVOKABLE void gimbalPitchStep    (int direction);
     Q_INVOKABLE void gimbalYawStep      (int direction);
@@ -462,6 +478,11 @@ public:
 #endif
 
     bool    isInitialConnectComplete() const;
+
+    /// A monitor only vehicle only handles the messages needed to show it on the map (heartbeat, position, attitude,
+    /// battery). It has no parameters, plan or camera manager until activateFullVehicle is called.
+    bool    monitorOnly             () const { return _monitorOnly; }
+    Q_INVOKABLE void activateFullVehicle(void);
     bool    guidedModeSupported     () const;
     bool    pauseVehicleSupported   () const;
     bool    orbitModeSupported      () const;
@@ -492,8 +513,9 @@ public:
     Q_INVOKABLE QString vehicleTypeName() const;
 
     /// Sends a message to the specified link
+    ///     @param priority Priority class, WritePriorityNormal picks the class from the message id
     /// @return true: message sent, false: Link no longer connected
-    bool sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t message);
+    bool sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t message, LinkInterface::WritePriority_t priority = LinkInterface::WritePriorityNormal);
 
     /// Sends the specified messages multiple times to the vehicle in order to attempt to
     /// guarantee that it makes it to the vehicle.
@@ -549,12 +571,15 @@ public:
     void setPrearmError(const QString& prearmError);
 
     QmlObjectListModel* cameraTriggerPoints () { return &_cameraTriggerPoints; }
+    MAVLinkMetrics*     mavlinkMetrics      ();     ///< Receive metrics for all traffic from this vehicle
 
     int  flowImageIndex() const{ return _flowImageIndex; }
 
     //-- Mavlink Logging
     void startMavlinkLog();
     void stopMavlinkLog();
+    /// Sends LOGGING_ACK for a LOGGING_DATA_ACKED packet on the primary link
+    void ackMavlinkLogData(uint16_t sequence);
 
     /// Requests the specified data stream from the vehicle
     ///     @param stream Stream which is being requested
@@ -699,8 +724,12 @@ public:
     FactGroup* estimatorStatusFactGroup     () { return &_estimatorStatusFactGroup; }
     FactGroup* terrainFactGroup             () { return &_terrainFactGroup; }
     FactGroup* hygrometerFactGroup          () { return &_hygrometerFactGroup; }
+    VehicleGeoFenceFactGroup* geoFenceFactGroup () { return &_geoFenceFactGroup; }
     QmlObjectListModel* batteries           () { return &_batteryFactGroupListModel; }
 
+    /// Typed telemetry which can be read from any thread, see VehicleTelemetrySnapshot
+    SharedVehicleTelemetrySnapshotPtr telemetrySnapshot() { return _telemetrySnapshot; }
+
     MissionManager*                 missionManager      () { return _missionManager; }
     GeoFenceManager*                geoFenceManager     () { return _geoFenceManager; }
     ObstacleManager*                obstacleManager     () { return _obstacleManager; }
@@ -712,6 +741,7 @@ public:
     ComponentInformationManager*    compInfoManager     () { return _componentInformationManager; }
     VehicleObjectAvoidance*         objectAvoidance     () { return _objectAvoidance; }
     Autotune*                       autotune            () const { return _autotune; }
+    PIDTuningRecorder*              pidTuningRecorder   () const { return _pidTuningRecorder; }
     RemoteIDManager*                remoteIDManager     () { return _remoteIDManager; }
 
     static const int cMaxRcChannels = 18;
@@ -741,6 +771,19 @@ public:
     ///
     bool isMavCommandPending(int targetCompId, MAV_CMD command);
 
+    /// Command round trip stats since the vehicle was created
+    typedef struct {
+        quint64 sent;                   ///< Commands, not counting retries
+        quint64 retries;
+        quint64 acked;
+        quint64 noResponse;             ///< Commands given up on after the last try
+        quint64 duplicatesRejected;
+        double  rttAvgMSecs;            ///< From the last try of a command to its ack
+        qint64  rttMaxMSecs;
+    } MavCommandStats_t;
+
+    const MavCommandStats_t& mavCommandStats(void) const { return _mavCommandStats; }
+
     /// Same as sendMavCommand but available from Qml.
     Q_INVOKABLE void sendCommand(int compId, int command, bool showError, double param1 = 0.0, double param2 = 0.0, double param3 = 0.0, double param4 = 0.0, double param5 = 0.0, double param6 = 0.0, double param7 = 0.0);
 
@@ -983,6 +1026,7 @@ signals:
     void gimbalDataChanged              ();
     void isROIEnabledChanged            ();
     void initialConnectComplete         ();
+    void monitorOnlyChanged             (bool monitorOnly);
 
     void sensorsParametersResetAck      (bool success);
 
@@ -1023,10 +1067,11 @@ private:
     void _loadSettings                  ();
     void _saveSettings                  ();
     void _startJoystick                 (bool start);
+    void _subscribeToMavlinkMessages    (void);
     void _handlePing                    (LinkInterface* link, mavlink_message_t& message);
     void _handleHomePosition            (mavlink_message_t& message);
     void _handleHeartbeat               (mavlink_message_t& message);
-    void _handleRadioStatus             (mavlink_message_t& message);
+    void _handleRadioStatus             (LinkInterface* link, mavlink_message_t& message);
     void _handleRCChannels              (mavlink_message_t& message);
     void _handleBatteryStatus           (mavlink_message_t& message);
     void _handleSysStatus               (mavlink_message_t& message);
@@ -1062,7 +1107,6 @@ private:
     QString _vehicleIdSpeech            ();
     void _handleMavlinkLoggingData      (mavlink_message_t& message);
     void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
-    void _ackMavlinkLogData             (uint16_t sequence);
     void _commonInit                    ();
     void _setupAutoDisarmSignalling     ();
     void _setCapabilities               (uint64_t capabilityBits);
@@ -1070,11 +1114,22 @@ private:
     bool _apmArmingNotRequired          ();
     void _initializeCsv                 ();
     void _writeCsvLine                  ();
+    void _closeCsv                      ();
+    void _updateCsvLogRate              ();
+    void _publishTelemetrySnapshot      ();
     void _flightTimerStart              ();
     void _flightTimerStop               ();
     void _chunkedStatusTextTimeout      (void);
     void _chunkedStatusTextCompleted    (uint8_t compId);
     void _setMessageInterval            (int messageId, int rate);
+
+    typedef struct {
+        Vehicle*    vehicle;
+        int         messageId;
+        int         rate;
+    } SetMessageIntervalRequest_t;
+
+    static void _setMessageIntervalResultHandler(void* resultHandlerData, int compId, MAV_RESULT result, uint8_t progress, MavCmdResultFailureCode_t failureCode);
     EventHandler& _eventHandler         (uint8_t compid);
 
     static void _rebootCommandResultHandler(void* resultHandlerData, int compId, MAV_RESULT commandResult, uint8_t progress, MavCmdResultFailureCode_t failureCode);
@@ -1093,8 +1148,16 @@ private:
     QGCToolbox*         _toolbox = nullptr;
     SettingsManager*    _settingsManager = nullptr;
 
-    QTimer              _csvLogTimer;
-    QFile               _csvLogFile;
+    QGCWheelTimer       _csvLogTimer;
+    TelemetryArchive    _csvArchive;        ///< Samples are archived while connected and converted to csv when closed
+    QList<Fact*>        _csvFacts;
+    QVector<double>     _csvValues;
+    QString             _csvFileName;
+    SettingsFactValue<bool> _csvSaveNotArmed;   ///< Checked at every csv sample while disarmed
+
+    SharedVehicleTelemetrySnapshotPtr   _telemetrySnapshot = std::make_shared<VehicleTelemetrySnapshot>();
+    QGCWheelTimer                       _telemetrySnapshotTimer;
+    static const int                    _telemetrySnapshotRateMSecs = 100;
 
     bool            _joystickEnabled = false;
 
@@ -1151,7 +1214,7 @@ private:
     QGCCameraManager* _cameraManager = nullptr;
 
     QString             _prearmError;
-    QTimer              _prearmErrorTimer;
+    QGCWheelTimer       _prearmErrorTimer;
     static const int    _prearmErrorTimeoutMSecs = 35 * 1000;   ///< Take away prearm error after 35 seconds
 
     bool                _initialPlanRequestComplete = false;
@@ -1163,6 +1226,7 @@ private:
     ComponentInformationManager*    _componentInformationManager    = nullptr;
     VehicleObjectAvoidance*         _objectAvoidance                = nullptr;
     Autotune*                       _autotune                       = nullptr;
+    PIDTuningRecorder*              _pidTuningRecorder              = nullptr;
 #if defined(QGC_AIRMAP_ENABLED)
     AirspaceVehicleManager*         _airspaceVehicleManager         = nullptr;
 #endif
@@ -1186,7 +1250,7 @@ private:
     int     _nextSendMessageMultipleIndex = 0;
 
     QElapsedTimer                   _flightTimer;
-    QTimer                          _flightTimeUpdater;
+    QGCWheelTimer                   _flightTimeUpdater;
     TrajectoryPoints*               _trajectoryPoints = nullptr;
     QmlObjectListModel              _cameraTriggerPoints;
     //QMap<QString, ADSBVehicle*>     _trafficVehicleMap;
@@ -1203,6 +1267,7 @@ private:
     uint8_t             _messageSeq = 0;
     uint8_t             _compID = 0;
     bool                _heardFrom = false;
+    bool                _monitorOnly = false;
 
     float               _curGimbalRoll  = 0.0f;
     float               _curGimbalPitch = 0.0f;
@@ -1277,6 +1342,7 @@ private:
     void*                               _waitForMavlinkMessageResultHandlerData = nullptr;
 
     void _waitForMavlinkMessageMessageReceived(const mavlink_message_t& message);
+    void _dispatchToFactGroups(mavlink_message_t& message);
 
     // requestMessage handling
     typedef struct RequestMessageInfo {
@@ -1310,20 +1376,28 @@ private:
         void*               resultHandlerData   = nullptr;
         int                 maxTries            = _mavCommandMaxRetryCount;
         int                 tryCount            = 0;
-        QElapsedTimer       elapsedTimer;
+        QElapsedTimer       elapsedTimer;                               ///< Since the last try
         int                 ackTimeoutMSecs     = _mavCommandAckTimeoutMSecs;
+        qint64              deadlineMSecs       = 0;                    ///< _mavCommandClock time of the next retry
     } MavCommandListEntry_t;
 
-    QList<MavCommandListEntry_t>    _mavCommandList;
-    QTimer                          _mavCommandResponseCheckTimer;
+    // Outstanding commands are kept in one slot per target component and command, so acks and pending checks are a
+    // hash lookup. A slot only holds more than one entry for commands which can be duplicated. Retry deadlines are
+    // kept ordered and the check timer is only armed for the earliest one.
+    QHash<quint32, QList<MavCommandListEntry_t>>    _mavCommandSlots;
+    QMultiMap<qint64, quint32>                      _mavCommandDeadlines;   ///< Deadline to slot key, stale entries are skipped
+    QElapsedTimer                                   _mavCommandClock;
+    QGCWheelTimer                                   _mavCommandResponseCheckTimer;
+    MavCommandStats_t                               _mavCommandStats = {};
     static const int                _mavCommandMaxRetryCount                = 3;
     static const int                _mavCommandResponseCheckTimeoutMSecs    = 500;
     static const int                _mavCommandAckTimeoutMSecs              = 3000;
     static const int                _mavCommandAckTimeoutMSecsHighLatency   = 120000;
 
     void _sendMavCommandWorker  (bool commandInt, bool showError, MavCmdResultHandler resultHandler, void* resultHandlerData, int compId, MAV_CMD command, MAV_FRAME frame, float param1, float param2, float param3, float param4, double param5, double param6, float param7);
-    void _sendMavCommandFromList(int index);
-    int  _findMavCommandListEntryIndex(int targetCompId, MAV_CMD command);
+    void _sendMavCommandFromList(quint32 slotKey, int index);
+    void _armMavCommandResponseCheckTimer(void);
+    static quint32 _mavCommandSlotKey(int targetCompId, MAV_CMD command);
     bool _sendMavCommandShouldRetry(MAV_CMD command);
     bool _commandCanBeDuplicated(MAV_CMD command);
 
@@ -1377,8 +1451,13 @@ private:
     VehicleEstimatorStatusFactGroup _estimatorStatusFactGroup;
     VehicleHygrometerFactGroup      _hygrometerFactGroup;
     TerrainFactGroup                _terrainFactGroup;
+    VehicleGeoFenceFactGroup        _geoFenceFactGroup;
     QmlObjectListModel              _batteryFactGroupListModel;
 
+    // Message id to the fact groups which consume it, rebuilt when fact groups are added
+    QHash<uint32_t, QList<FactGroup*>>  _factGroupDispatch;
+    bool                                _factGroupDispatchDirty = true;
+
     TerrainProtocolHandler* _terrainProtocolHandler = nullptr;
 
     MissionManager*                 _missionManager             = nullptr;
@@ -1431,6 +1510,7 @@ private:
     static const char* _escStatusFactGroupName;
     static const char* _estimatorStatusFactGroupName;
     static const char* _hygrometerFactGroupName;
+    static const char* _geoFenceFactGroupName;
     static const char* _terrainFactGroupName;
 
     static const int _vehicleUIUpdateRateMSecs      = 100;
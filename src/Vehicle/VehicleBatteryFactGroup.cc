@@ -88,6 +88,15 @@ void VehicleBatteryFactGroup::handleMessageForFactGroupCreation(Vehicle* vehicle
     }
 }
 
+QList<uint32_t> VehicleBatteryFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_HIGH_LATENCY,
+        MAVLINK_MSG_ID_HIGH_LATENCY2,
+        MAVLINK_MSG_ID_BATTERY_STATUS,
+    };
+}
+
 void VehicleBatteryFactGroup::handleMessage(Vehicle* vehicle, mavlink_message_t& message)
 {
     switch (message.msgid) {
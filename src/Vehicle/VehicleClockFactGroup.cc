@@ -28,14 +28,23 @@ VehicleClockFactGroup::VehicleClockFactGroup(QObject* parent)
     _currentTimeFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
     _currentUTCTimeFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
     _currentDateFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
+
+    _clockTimer.setInterval(1000);
+    connect(&_clockTimer, &QTimer::timeout, this, &VehicleClockFactGroup::_updateClock);
+    _clockTimer.start();
 }
 
-void VehicleClockFactGroup::_updateAllValues()
+void VehicleClockFactGroup::_updateClock()
 {
+    if (parked()) {
+        return;
+    }
+
     _currentTimeFact.setRawValue(QTime::currentTime().toString());
     _currentUTCTimeFact.setRawValue(QDateTime::currentDateTimeUtc().time().toString());
     _currentDateFact.setRawValue(QDateTime::currentDateTime().toString(QLocale::system().dateFormat(QLocale::ShortFormat)));
     _setTelemetryAvailable(true);
 
-    FactGroup::_updateAllValues();
+    // Don't wait for the scheduler, the clock should tick when the value changes
+    _updateAllValues();
 }
@@ -36,9 +36,10 @@ public:
     static const char* _settingsGroup;
 
 private slots:
-    void _updateAllValues() override;
+    void _updateClock();
 
 private:
+    QTimer          _clockTimer;
     Fact            _currentTimeFact;
     Fact            _currentUTCTimeFact;
     Fact            _currentDateFact;
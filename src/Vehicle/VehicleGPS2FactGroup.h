@@ -21,6 +21,7 @@ public:
 
     // Overrides from VehicleGPSFactGroup
     void handleMessage(Vehicle* vehicle, mavlink_message_t& message) override;
+    QList<uint32_t> handledMessageIds(void) const override;
 
 private:
     void _handleGps2Raw(mavlink_message_t& message);
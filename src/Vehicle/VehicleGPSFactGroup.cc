@@ -10,6 +10,7 @@
 #include "VehicleGPSFactGroup.h"
 #include "Vehicle.h"
 #include "QGCGeo.h"
+#include "MAVLinkMessageView.h"
 
 const char* VehicleGPSFactGroup::_latFactName =                 "lat";
 const char* VehicleGPSFactGroup::_lonFactName =                 "lon";
@@ -48,6 +49,15 @@ VehicleGPSFactGroup::VehicleGPSFactGroup(QObject* parent)
     _courseOverGroundFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
 }
 
+QList<uint32_t> VehicleGPSFactGroup::handledMessageIds(void) const
+{
+    return {
+        MAVLINK_MSG_ID_GPS_RAW_INT,
+        MAVLINK_MSG_ID_HIGH_LATENCY,
+        MAVLINK_MSG_ID_HIGH_LATENCY2,
+    };
+}
+
 void VehicleGPSFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_t& message)
 {
     switch (message.msgid) {
@@ -67,17 +77,21 @@ void VehicleGPSFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_
 
 void VehicleGPSFactGroup::_handleGpsRawInt(mavlink_message_t& message)
 {
-    mavlink_gps_raw_int_t gpsRawInt;
-    mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
+    const int32_t   lat                 = QGC_MAVLINK_FIELD(message, gps_raw_int, lat);
+    const int32_t   lon                 = QGC_MAVLINK_FIELD(message, gps_raw_int, lon);
+    const uint8_t   satellitesVisible   = QGC_MAVLINK_FIELD(message, gps_raw_int, satellites_visible);
+    const uint16_t  eph                 = QGC_MAVLINK_FIELD(message, gps_raw_int, eph);
+    const uint16_t  epv                 = QGC_MAVLINK_FIELD(message, gps_raw_int, epv);
+    const uint16_t  cog                 = QGC_MAVLINK_FIELD(message, gps_raw_int, cog);
 
-    lat()->setRawValue              (gpsRawInt.lat * 1e-7);
-    lon()->setRawValue              (gpsRawInt.lon * 1e-7);
-    mgrs()->setRawValue             (convertGeoToMGRS(QGeoCoordinate(gpsRawInt.lat * 1e-7, gpsRawInt.lon * 1e-7)));
-    count()->setRawValue            (gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
-    hdop()->setRawValue             (gpsRawInt.eph == UINT16_MAX ? qQNaN() : gpsRawInt.eph / 100.0);
-    vdop()->setRawValue             (gpsRawInt.epv == UINT16_MAX ? qQNaN() : gpsRawInt.epv / 100.0);
-    courseOverGround()->setRawValue (gpsRawInt.cog == UINT16_MAX ? qQNaN() : gpsRawInt.cog / 100.0);
-    lock()->setRawValue             (gpsRawInt.fix_type);
+    lat()->setRawValue              (lat * 1e-7);
+    lon()->setRawValue              (lon * 1e-7);
+    mgrs()->setRawValue             (convertGeoToMGRS(QGeoCoordinate(lat * 1e-7, lon * 1e-7)));
+    count()->setRawValue            (satellitesVisible == 255 ? 0 : satellitesVisible);
+    hdop()->setRawValue             (eph == UINT16_MAX ? qQNaN() : eph / 100.0);
+    vdop()->setRawValue             (epv == UINT16_MAX ? qQNaN() : epv / 100.0);
+    courseOverGround()->setRawValue (cog == UINT16_MAX ? qQNaN() : cog / 100.0);
+    lock()->setRawValue             (QGC_MAVLINK_FIELD(message, gps_raw_int, fix_type));
 }
 
 void VehicleGPSFactGroup::_handleHighLatency(mavlink_message_t& message)
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleGeoFenceFactGroup.h"
+
+const char* VehicleGeoFenceFactGroup::_distanceFactName =   "distance";
+const char* VehicleGeoFenceFactGroup::_breachTimeFactName = "breachTime";
+const char* VehicleGeoFenceFactGroup::_breachedFactName =   "breached";
+
+VehicleGeoFenceFactGroup::VehicleGeoFenceFactGroup(QObject* parent)
+    : FactGroup         (1000, ":/json/Vehicle/GeoFenceFactGroup.json", parent)
+    , _distanceFact     (0, _distanceFactName,      FactMetaData::valueTypeDouble)
+    , _breachTimeFact   (0, _breachTimeFactName,    FactMetaData::valueTypeDouble)
+    , _breachedFact     (0, _breachedFactName,      FactMetaData::valueTypeBool)
+{
+    _addFact(&_distanceFact,    _distanceFactName);
+    _addFact(&_breachTimeFact,  _breachTimeFactName);
+    _addFact(&_breachedFact,    _breachedFactName);
+
+    clearStatus();
+}
+
+void VehicleGeoFenceFactGroup::setStatus(double distance, bool breached, double breachSecs)
+{
+    _distanceFact.setRawValue(distance);
+    _breachTimeFact.setRawValue(breachSecs);
+    _breachedFact.setRawValue(breached);
+    _setTelemetryAvailable(true);
+}
+
+void VehicleGeoFenceFactGroup::clearStatus(void)
+{
+    _distanceFact.setRawValue(qQNaN());
+    _breachTimeFact.setRawValue(qQNaN());
+    _breachedFact.setRawValue(false);
+    _setTelemetryAvailable(false);
+}
@@ -0,0 +1,44 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactGroup.h"
+
+/// Position of the vehicle relative to the fence loaded on it, as computed by GeoFenceMonitor
+class VehicleGeoFenceFactGroup : public FactGroup
+{
+    Q_OBJECT
+
+public:
+    VehicleGeoFenceFactGroup(QObject* parent = nullptr);
+
+    Q_PROPERTY(Fact* distance   READ distance   CONSTANT)
+    Q_PROPERTY(Fact* breachTime READ breachTime CONSTANT)
+    Q_PROPERTY(Fact* breached   READ breached   CONSTANT)
+
+    Fact* distance      () { return &_distanceFact; }
+    Fact* breachTime    () { return &_breachTimeFact; }
+    Fact* breached      () { return &_breachedFact; }
+
+    /// @param breachSecs NaN: no breach predicted
+    void setStatus  (double distance, bool breached, double breachSecs);
+
+    /// No fence on the vehicle
+    void clearStatus(void);
+
+    static const char* _distanceFactName;
+    static const char* _breachTimeFactName;
+    static const char* _breachedFactName;
+
+private:
+    Fact _distanceFact;
+    Fact _breachTimeFact;
+    Fact _breachedFact;
+};
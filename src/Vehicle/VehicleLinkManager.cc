@@ -12,6 +12,15 @@
 #include "QGCLoggingCategory.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#ifndef NO_SERIAL_LINK
+#include "SerialLink.h"
+#if defined(QGC_GST_TAISYNC_ENABLED)
+#include "TaisyncManager.h"
+#endif
+#if defined(QGC_GST_MICROHARD_ENABLED)
+#include "MicrohardManager.h"
+#endif
+#endif
 
 QGC_LOGGING_CATEGORY(VehicleLinkManagerLog, "VehicleLinkManagerLog")
 
@@ -21,27 +30,88 @@ VehicleLinkManager::VehicleLinkManager(Vehicle* vehicle)
     , _linkMgr  (qgcApp()->toolbox()->linkManager())
 {
     connect(this,                   &VehicleLinkManager::linkNamesChanged,  this, &VehicleLinkManager::linkStatusesChanged);
-    connect(&_commLostCheckTimer,   &QTimer::timeout,                       this, &VehicleLinkManager::_commLostCheck);
+    connect(&_commLostCheckTimer,   &QGCWheelTimer::timeout,            this, &VehicleLinkManager::_commLostCheck);
 
     _commLostCheckTimer.setSingleShot(false);
     _commLostCheckTimer.setInterval(_commLostCheckTimeoutMSecs);
 }
 
-void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+bool VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
 {
     // Radio status messages come from Sik Radios directly. It doesn't indicate there is any life on the other end.
-    if (message.msgid != MAVLINK_MSG_ID_RADIO_STATUS) {
-        int linkIndex = _containsLinkIndex(link);
-        if (linkIndex == -1) {
-            _addLink(link);
+    // Each radio sends its own, so they are never copies of each other either.
+    if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
+        return true;
+    }
+
+    int linkIndex = _containsLinkIndex(link);
+    if (linkIndex == -1) {
+        _addLink(link);
+        linkIndex = _containsLinkIndex(link);
+    } else {
+        LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
+        linkInfo.heartbeatElapsedTimer.restart();
+
+        // Frame overhead: 12 bytes for mavlink 2 without signing
+        linkInfo.windowBytes += message.len + 12;
+        linkInfo.windowMessages++;
+        auto lastSequence = linkInfo.lastSequence.find(message.compid);
+        if (lastSequence != linkInfo.lastSequence.end()) {
+            linkInfo.windowLostMessages += static_cast<uint8_t>(message.seq - *lastSequence - 1);
+            *lastSequence = message.seq;
         } else {
-            LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
-            linkInfo.heartbeatElapsedTimer.restart();
-            if (_rgLinkInfo[linkIndex].commLost) {
-                _commRegainedOnLink(link);
-            }
+            linkInfo.lastSequence[message.compid] = message.seq;
+        }
+
+        if (_rgLinkInfo[linkIndex].commLost) {
+            _commRegainedOnLink(link);
+            linkIndex = _containsLinkIndex(link);
         }
     }
+
+    // Liveness above is tracked for every copy, only the first copy goes on to the vehicle
+    return linkIndex == -1 || !_isDuplicate(linkIndex, message);
+}
+
+/// The same message is recognized by its sender, sequence number, id and checksum. The checksum covers the payload
+/// so different messages which happen to share a sequence number within the window are told apart.
+bool VehicleLinkManager::_isDuplicate(int linkIndex, const mavlink_message_t& message)
+{
+    if (_rgLinkInfo.count() < 2) {
+        if (!_recentMessages.isEmpty()) {
+            _recentMessages.clear();
+            _recentMessageQueue.clear();
+        }
+        return false;
+    }
+
+    if (!_duplicateClock.isValid()) {
+        _duplicateClock.start();
+    }
+    const qint64 now = _duplicateClock.elapsed();
+    while (!_recentMessageQueue.isEmpty() && now - _recentMessageQueue.head().second > _duplicateWindowMSecs) {
+        const QPair<quint64, qint64> oldest = _recentMessageQueue.dequeue();
+        auto iter = _recentMessages.find(oldest.first);
+        if (iter != _recentMessages.end() && iter.value() == oldest.second) {
+            _recentMessages.erase(iter);
+        }
+    }
+
+    const quint64 key = (static_cast<quint64>(message.sysid)            << 56) |
+                        (static_cast<quint64>(message.compid)           << 48) |
+                        (static_cast<quint64>(message.seq)              << 40) |
+                        (static_cast<quint64>(message.msgid & 0xFFFFFF) << 16) |
+                        static_cast<quint64>(message.checksum);
+
+    LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
+    if (_recentMessages.contains(key)) {
+        linkInfo.windowDuplicates++;
+        return true;
+    }
+    _recentMessages.insert(key, now);
+    _recentMessageQueue.enqueue(qMakePair(key, now));
+    linkInfo.windowFirst++;
+    return false;
 }
 
 void VehicleLinkManager::_commRegainedOnLink(LinkInterface* link)
@@ -95,10 +165,108 @@ void VehicleLinkManager::_commRegainedOnLink(LinkInterface* link)
     }
 }
 
+int VehicleLinkManager::primaryLinkCapacityBytesPerSec(void)
+{
+    SharedLinkInterfacePtr primaryLink = _primaryLink.lock();
+    return primaryLink ? _linkCapacityBytesPerSec(primaryLink.get()) : 0;
+}
+
+int VehicleLinkManager::_linkCapacityBytesPerSec(LinkInterface* link)
+{
+#ifndef NO_SERIAL_LINK
+    SerialConfiguration* serialConfig = qobject_cast<SerialConfiguration*>(link->linkConfiguration().get());
+    if (serialConfig) {
+        // 8N1: 10 bits per byte
+        return serialConfig->baud() / 10;
+    }
+#else
+    Q_UNUSED(link);
+#endif
+    // Network links have no known capacity of their own. When a Microhard or Taisync radio is in use they are
+    // assumed to run over it and follow its signal, otherwise their telemetry is never scaled.
+    return _radioCapacityBytesPerSec();
+}
+
+int VehicleLinkManager::_radioCapacityBytesPerSec(void)
+{
+    int worstRSSI = 0;
+    auto addRSSI = [&worstRSSI](int rssi) {
+        // 0 is reported until the radio knows
+        if (rssi < 0 && (worstRSSI == 0 || rssi < worstRSSI)) {
+            worstRSSI = rssi;
+        }
+    };
+#if defined(QGC_GST_MICROHARD_ENABLED)
+    MicrohardManager* microhardManager = qgcApp()->toolbox()->microhardManager();
+    if (microhardManager && microhardManager->connected() > 0 && microhardManager->linkConnected() > 0) {
+        addRSSI(microhardManager->uplinkRSSI());
+        addRSSI(microhardManager->downlinkRSSI());
+    }
+#endif
+#if defined(QGC_GST_TAISYNC_ENABLED)
+    TaisyncManager* taisyncManager = qgcApp()->toolbox()->taisyncManager();
+    if (taisyncManager && taisyncManager->connected() && taisyncManager->linkConnected()) {
+        addRSSI(taisyncManager->uplinkRSSI());
+        addRSSI(taisyncManager->downlinkRSSI());
+    }
+#endif
+    if (worstRSSI == 0 || worstRSSI >= _radioGoodRSSI) {
+        return 0;
+    }
+    // Usable throughput drops off quickly as the radio falls back to more robust modulations
+    const double fraction = qBound(0.0, static_cast<double>(worstRSSI - _radioPoorRSSI) / (_radioGoodRSSI - _radioPoorRSSI), 1.0);
+    return static_cast<int>(_radioPoorBytesPerSec + fraction * fraction * (_radioGoodBytesPerSec - _radioPoorBytesPerSec));
+}
+
+void VehicleLinkManager::_updateLinkThroughput(void)
+{
+    for (LinkInfo_t& linkInfo: _rgLinkInfo) {
+        const quint64   totalMessages   = linkInfo.windowMessages + linkInfo.windowLostMessages;
+        const double    lossPercent     = totalMessages ? (100.0 * linkInfo.windowLostMessages) / totalMessages : 0;
+        linkInfo.rxBytesPerSec  += _throughputSmoothing * ((linkInfo.windowBytes * 1000.0 / _commLostCheckTimeoutMSecs) - linkInfo.rxBytesPerSec);
+        linkInfo.lossPercent    += _throughputSmoothing * (lossPercent - linkInfo.lossPercent);
+        linkInfo.windowBytes = linkInfo.windowMessages = linkInfo.windowLostMessages = 0;
+
+        const quint64   deliveredMessages   = linkInfo.windowFirst + linkInfo.windowDuplicates;
+        if (deliveredMessages) {
+            linkInfo.firstPercent += _throughputSmoothing * ((100.0 * linkInfo.windowFirst) / deliveredMessages - linkInfo.firstPercent);
+        }
+        linkInfo.windowFirst = linkInfo.windowDuplicates = 0;
+    }
+    if (_rgLinkInfo.count() > 1) {
+        emit linkDeliveryStatsChanged();
+    }
+
+    SharedLinkInterfacePtr  primaryLink = _primaryLink.lock();
+    int                     linkIndex   = primaryLink ? _containsLinkIndex(primaryLink.get()) : -1;
+    double                  scale       = 1.0;
+    if (linkIndex != -1) {
+        const LinkInfo_t&   linkInfo    = _rgLinkInfo[linkIndex];
+        const int           capacity    = _linkCapacityBytesPerSec(primaryLink.get());
+        scale = _telemetryScale;
+        if (capacity == 0) {
+            scale = 1.0;
+        } else if (linkInfo.rxBytesPerSec > _targetLinkUtilization * capacity || linkInfo.lossPercent > _maxLinkLossPercent) {
+            scale = qMax(_minTelemetryScale, scale * qMin(0.8, (_targetLinkUtilization * capacity) / qMax(linkInfo.rxBytesPerSec, 1.0)));
+        } else if (linkInfo.rxBytesPerSec < 0.5 * _targetLinkUtilization * capacity && linkInfo.lossPercent < _maxLinkLossPercent / 4) {
+            scale = qMin(1.0, scale * 1.25);
+        }
+        qCDebug(VehicleLinkManagerLog) << "primary link rxBytesPerSec:capacity:lossPercent:scale" << linkInfo.rxBytesPerSec << capacity << linkInfo.lossPercent << scale;
+    }
+
+    // Only real changes, every change costs a round of stream rate requests
+    if (qAbs(scale - _telemetryScale) >= 0.1 || (scale == 1.0 && _telemetryScale != 1.0)) {
+        _telemetryScale = scale;
+        emit telemetryScaleChanged(_telemetryScale);
+    }
+}
+
 void VehicleLinkManager::_commLostCheck(void)
 {
     QString switchingPrimaryLinkMessage;
 
+    _updateLinkThroughput();
+
     if (!_communicationLostEnabled) {
         return;
     }
@@ -395,6 +563,17 @@ QStringList VehicleLinkManager::linkStatuses(void) const
     return rgStatuses;
 }
 
+QVariantList VehicleLinkManager::linkFirstDeliveryPercents(void) const
+{
+    QVariantList rgPercents;
+
+    for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+        rgPercents.append(linkInfo.firstPercent);
+    }
+
+    return rgPercents;
+}
+
 bool VehicleLinkManager::primaryLinkIsPX4Flow(void) const
 {
     SharedLinkInterfacePtr sharedLink = _primaryLink.lock();
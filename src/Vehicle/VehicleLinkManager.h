@@ -14,9 +14,13 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+#include <QVariantList>
 
 #include "QGCMAVLink.h"
 #include "LinkInterface.h"
+#include "QGCTimerWheel.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VehicleLinkManagerLog)
 
@@ -41,9 +45,12 @@ public:
     Q_PROPERTY(bool             communicationLost           READ communicationLost                                              NOTIFY communicationLostChanged)
     Q_PROPERTY(bool             communicationLostEnabled    READ communicationLostEnabled   WRITE setCommunicationLostEnabled   NOTIFY communicationLostEnabledChanged)
     Q_PROPERTY(bool             autoDisconnect              MEMBER _autoDisconnect                                              NOTIFY autoDisconnectChanged)
+    Q_PROPERTY(double           telemetryScale              READ telemetryScale                                                 NOTIFY telemetryScaleChanged)
+    Q_PROPERTY(QVariantList     linkFirstDeliveryPercents   READ linkFirstDeliveryPercents                                      NOTIFY linkDeliveryStatsChanged)
 
     bool                    primaryLinkIsPX4Flow        (void) const;
-    void                    mavlinkMessageReceived      (LinkInterface* link, mavlink_message_t message);
+    /// @return false: The message is a copy of one which already came in over another link and should be dropped
+    bool                    mavlinkMessageReceived      (LinkInterface* link, mavlink_message_t message);
     bool                    containsLink                (LinkInterface* link);
     WeakLinkInterfacePtr    primaryLink                 (void) { return _primaryLink; }
     QString                 primaryLinkName             (void) const;
@@ -55,6 +62,17 @@ public:
     void                    setCommunicationLostEnabled (bool communicationLostEnabled);
     void                    closeVehicle                (void);
 
+    /// Factor (_minTelemetryScale to 1) to scale requested telemetry rates by so the primary link stays below
+    /// _targetLinkUtilization of its capacity. Always 1 for links without a known capacity.
+    double                  telemetryScale              (void) const { return _telemetryScale; }
+
+    /// @return Capacity of the primary link in bytes/sec, 0 if it is not known
+    int                     primaryLinkCapacityBytesPerSec(void);
+
+    /// Share of the messages each link delivered before any other link did, in linkNames order. Only meaningful
+    /// with more than one link.
+    QVariantList            linkFirstDeliveryPercents   (void) const;
+
 signals:
     void primaryLinkChanged             (void);
     void allLinksRemoved                (Vehicle* vehicle);
@@ -63,6 +81,8 @@ signals:
     void linkNamesChanged               (void);
     void linkStatusesChanged            (void);
     void autoDisconnectChanged          (bool autoDisconnect);
+    void telemetryScaleChanged          (double telemetryScale);
+    void linkDeliveryStatsChanged       (void);
 
 private slots:
     void _commLostCheck(void);
@@ -75,22 +95,53 @@ private:
     bool                    _updatePrimaryLink      (void);
     SharedLinkInterfacePtr  _bestActivePrimaryLink  (void);
     void                    _commRegainedOnLink     (LinkInterface*  link);
+    void                    _updateLinkThroughput   (void);
+    static int              _linkCapacityBytesPerSec(LinkInterface* link);
+    static int              _radioCapacityBytesPerSec(void);
+    bool                    _isDuplicate            (int linkIndex, const mavlink_message_t& message);
 
     typedef struct LinkInfo {
         SharedLinkInterfacePtr  link;
         bool                    commLost = false;
         QElapsedTimer           heartbeatElapsedTimer;
+        QMap<uint8_t, uint8_t>  lastSequence;               ///< By component id
+        quint64                 windowBytes         = 0;    ///< Received since the last throughput update
+        quint64                 windowMessages      = 0;
+        quint64                 windowLostMessages  = 0;
+        double                  rxBytesPerSec       = 0;    ///< Smoothed
+        double                  lossPercent         = 0;    ///< Smoothed
+        quint64                 windowFirst         = 0;    ///< Messages this link delivered before the others
+        quint64                 windowDuplicates    = 0;    ///< Messages another link already delivered
+        double                  firstPercent        = 0;    ///< Smoothed
     } LinkInfo_t;
 
     Vehicle*                _vehicle                    = nullptr;
     LinkManager*            _linkMgr                    = nullptr;
-    QTimer                  _commLostCheckTimer;
+    QGCWheelTimer           _commLostCheckTimer;
     QList<LinkInfo_t>       _rgLinkInfo;
     WeakLinkInterfacePtr    _primaryLink;
     bool                    _communicationLost          = false;
     bool                    _communicationLostEnabled   = true;
     bool                    _autoDisconnect             = false;    ///< true: Automatically disconnect vehicle when last connection goes away or lost heartbeat
+    double                  _telemetryScale             = 1.0;
+
+    // Messages seen over the last _duplicateWindowMSecs, only tracked while there is more than one link
+    QHash<quint64, qint64>          _recentMessages;        ///< Message key to time it was first seen
+    QQueue<QPair<quint64, qint64>>  _recentMessageQueue;    ///< Oldest first, for expiry
+    QElapsedTimer                   _duplicateClock;
 
     static const int _commLostCheckTimeoutMSecs     = 1000;  // Check for comm lost once a second
     static const int _heartbeatMaxElpasedMSecs      = 3500;  // No heartbeat for longer than this indicates comm loss
+    static const int _duplicateWindowMSecs          = 1000;  // Copies arriving further apart than this are not caught
+
+    static constexpr double _targetLinkUtilization  = 0.7;
+    static constexpr double _maxLinkLossPercent     = 10.0;     ///< Loss above this also scales telemetry down
+    static constexpr double _minTelemetryScale      = 0.25;
+    static constexpr double _throughputSmoothing    = 0.3;      ///< Weight of the newest second
+
+    // Microhard/Taisync radios: capacity is not limited above _radioGoodRSSI and falls off to _radioPoorBytesPerSec at _radioPoorRSSI
+    static const int _radioGoodRSSI                 = -75;      // dBm
+    static const int _radioPoorRSSI                 = -95;      // dBm
+    static const int _radioGoodBytesPerSec          = 50000;
+    static const int _radioPoorBytesPerSec          = 2000;
 };
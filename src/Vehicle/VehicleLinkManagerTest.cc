@@ -314,6 +314,52 @@ void VehicleLinkManagerTest::_highLatencyLinkTest(void)
     spyTransmissionEnabledChanged.clear();
 }
 
+void VehicleLinkManagerTest::_duplicateMessageTest(void)
+{
+    SharedLinkConfigurationPtr  mockConfig1;
+    SharedLinkInterfacePtr      mockLink1;
+    SharedLinkConfigurationPtr  mockConfig2;
+    SharedLinkInterfacePtr      mockLink2;
+
+    QSignalSpy spyVehicleCreate(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+
+    _startMockLink(1, false /*highLatency*/, false /*incrementVehicleId*/, mockConfig1, mockLink1);
+    _startMockLink(2, false /*highLatency*/, false /*incrementVehicleId*/, mockConfig2, mockLink2);
+
+    QCOMPARE(spyVehicleCreate.wait(1000),           true);
+    Vehicle* vehicle = _multiVehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    VehicleLinkManager* vehicleLinkManager = vehicle->vehicleLinkManager();
+    QVERIFY(vehicleLinkManager);
+    QSignalSpy spyVehicleInitialConnectComplete(vehicle, &Vehicle::initialConnectComplete);
+    QCOMPARE(spyVehicleInitialConnectComplete.wait(3000), true);
+    QCOMPARE(vehicleLinkManager->linkNames().count(), 2);
+
+    // DEBUG is not sent by MockLink, so the real traffic can't interfere
+    mavlink_message_t message = {};
+    message.sysid       = static_cast<uint8_t>(vehicle->id());
+    message.compid      = MAV_COMP_ID_AUTOPILOT1;
+    message.seq         = 42;
+    message.msgid       = MAVLINK_MSG_ID_DEBUG;
+    message.checksum    = 0x1234;
+
+    // First copy goes through, the copy over the other link is dropped
+    QCOMPARE(vehicleLinkManager->mavlinkMessageReceived(mockLink1.get(), message), true);
+    QCOMPARE(vehicleLinkManager->mavlinkMessageReceived(mockLink2.get(), message), false);
+    QCOMPARE(vehicleLinkManager->mavlinkMessageReceived(mockLink1.get(), message), false);
+
+    // Same sequence number but different contents is a different message
+    message.checksum = 0x4321;
+    QCOMPARE(vehicleLinkManager->mavlinkMessageReceived(mockLink2.get(), message), true);
+
+    // Once the window has passed the same message is let through again
+    message.checksum = 0x1234;
+    QTest::qWait(VehicleLinkManager::_duplicateWindowMSecs + 100);
+    QCOMPARE(vehicleLinkManager->mavlinkMessageReceived(mockLink2.get(), message), true);
+
+    QCOMPARE(vehicleLinkManager->linkFirstDeliveryPercents().count(), 2);
+}
+
 void VehicleLinkManagerTest::_startMockLink(int mockIndex, bool highLatency, bool incrementVehicleId, SharedLinkConfigurationPtr& mockConfig, SharedLinkInterfacePtr& mockLink)
 {
     MockConfiguration* pMockConfig = new MockConfiguration(QStringLiteral("Mock %1").arg(mockIndex));
@@ -14,45 +14,139 @@
 
 static const char* kColPrevParam = "CP_DIST";
 
+const int       VehicleObjectAvoidance::kSectorCount;
+constexpr qreal VehicleObjectAvoidance::kSectorDegrees;
+const uint16_t  VehicleObjectAvoidance::kUnknownDistance;
+
 //-----------------------------------------------------------------------------
 VehicleObjectAvoidance::VehicleObjectAvoidance(Vehicle *vehicle, QObject* parent)
     : QObject(parent)
     , _vehicle(vehicle)
 {
+    _sectors.fill(kUnknownDistance);
 }
 
 //-----------------------------------------------------------------------------
 void
-VehicleObjectAvoidance::update(mavlink_obstacle_distance_t* message)
+VehicleObjectAvoidance::update(int componentId, mavlink_obstacle_distance_t* message)
 {
     //-- Collect raw data
+    Sensor_t& sensor = _sensors[componentId];
     if(std::isfinite(message->increment_f) && message->increment_f > 0) {
-        _increment = static_cast<qreal>(message->increment_f);
+        sensor.increment = static_cast<qreal>(message->increment_f);
     } else {
-        _increment = static_cast<qreal>(message->increment);
+        sensor.increment = static_cast<qreal>(message->increment);
     }
-    _minDistance = message->min_distance;
-    _maxDistance = message->max_distance;
-    _angleOffset = static_cast<qreal>(message->angle_offset);
-    if(_distances.count() == 0) {
-        for(int i = 0; i < MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
-            _distances.append(static_cast<int>(message->distances[i]));
+    sensor.angleOffset  = static_cast<qreal>(message->angle_offset);
+    sensor.bodyFrame    = message->frame == MAV_FRAME_BODY_FRD;
+    sensor.minDistance  = message->min_distance;
+    sensor.maxDistance  = message->max_distance;
+    memcpy(sensor.distances.data(), message->distances, sizeof(message->distances));
+    sensor.received.start();
+
+    _fuse();
+}
+
+//-----------------------------------------------------------------------------
+/// Takes the closest distance of any sensor for each sector. A sensor bin is spread over all sectors it overlaps.
+void
+VehicleObjectAvoidance::_fuse()
+{
+    static const uint16_t kNoObstacle = kUnknownDistance - 1;
+
+    Sectors_t   sectors;
+    int         minDistance = 0;
+    int         maxDistance = 0;
+    bool        first       = true;
+    const qreal heading     = _vehicle->heading()->rawValue().toDouble();
+
+    sectors.fill(kUnknownDistance);
+    for (auto it = _sensors.begin(); it != _sensors.end(); ) {
+        if (it->received.hasExpired(_sensorTimeoutMsecs)) {
+            it = _sensors.erase(it);
+            continue;
         }
-    } else {
-        for(int i = 0; i < MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
-            _distances[i] = static_cast<int>(message->distances[i]);
+        const Sensor_t& sensor = *it++;
+        if (sensor.increment <= 0) {
+            continue;
+        }
+        minDistance = first ? sensor.minDistance : qMin(minDistance, sensor.minDistance);
+        maxDistance = first ? sensor.maxDistance : qMax(maxDistance, sensor.maxDistance);
+        first = false;
+
+        // Earth frame sensors are north aligned
+        const qreal angleOffset = sensor.angleOffset - (sensor.bodyFrame || !std::isfinite(heading) ? 0 : heading);
+        const int   binCount    = qMin(static_cast<int>(sensor.distances.size()), static_cast<int>(std::ceil(360.0 / sensor.increment)));
+        for (int bin = 0; bin < binCount; bin++) {
+            uint16_t distance = sensor.distances[bin];
+            if (distance == kUnknownDistance) {
+                continue;
+            }
+            if (distance > sensor.maxDistance) {
+                distance = kNoObstacle;
+            }
+            const qreal binCenter   = angleOffset + (sensor.increment * bin);
+            const int   firstSector = static_cast<int>(std::floor((binCenter - (sensor.increment / 2) + (kSectorDegrees / 2)) / kSectorDegrees));
+            const int   lastSector  = static_cast<int>(std::ceil((binCenter + (sensor.increment / 2) + (kSectorDegrees / 2)) / kSectorDegrees)) - 1;
+            for (int sector = firstSector; sector <= lastSector; sector++) {
+                uint16_t& fused = sectors[((sector % kSectorCount) + kSectorCount) % kSectorCount];
+                fused = qMin(fused, distance);
+            }
+        }
+    }
+    // No obstacle is relative to the fused range, otherwise a short range sensor would show obstacles to a long range one
+    for (uint16_t& fused : sectors) {
+        if (fused == kNoObstacle) {
+            fused = static_cast<uint16_t>(qMin(maxDistance + 1, static_cast<int>(kNoObstacle)));
+        }
+    }
+
+    const bool available = !first;
+    if (sectors != _sectors || minDistance != _minDistance || maxDistance != _maxDistance || available != _available) {
+        _sectors        = sectors;
+        _minDistance    = minDistance;
+        _maxDistance    = maxDistance;
+        _available      = available;
+        _gridDirty      = true;
+        emit objectAvoidanceChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QList<int>
+VehicleObjectAvoidance::distances() const
+{
+    QList<int> distances;
+    if (_available) {
+        distances.reserve(kSectorCount);
+        for (uint16_t distance : _sectors) {
+            distances.append(distance);
         }
     }
-    //-- Create a plottable grid with found objects
+    return distances;
+}
+
+//-----------------------------------------------------------------------------
+/// Create a plottable grid with found objects, only built when asked for
+void
+VehicleObjectAvoidance::_updateGrid()
+{
+    if (!_gridDirty) {
+        return;
+    }
+    _gridDirty = false;
     _objGrid.clear();
     _objDistance.clear();
+    if (!_available || _maxDistance <= 0) {
+        return;
+    }
     auto* sp = qobject_cast<VehicleSetpointFactGroup*>(_vehicle->setpointFactGroup());
-    qreal startAngle = sp->yaw()->rawValue().toDouble() + _angleOffset;
-    for(int i = 0; i < MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
-        if(_distances[i] < _maxDistance && message->distances[i] != UINT16_MAX) {
-            qreal d = static_cast<qreal>(_distances[i]);
+    qreal startAngle = sp->yaw()->rawValue().toDouble();
+    for(int i = 0; i < kSectorCount; i++) {
+        if(_sectors[i] < _maxDistance) {
+            qreal d = static_cast<qreal>(_sectors[i]);
             d = d / static_cast<qreal>(_maxDistance);
-            qreal a = (_increment * i) - startAngle;
+            qreal a = (kSectorDegrees * i) - startAngle;
             if(a < 0) a = a + 360;
             qreal rd = (M_PI / 180.0) * a;
             QPointF p = QPointF(d * cos(rd), d * sin(rd));
@@ -60,7 +154,6 @@ VehicleObjectAvoidance::update(mavlink_obstacle_distance_t* message)
             _objDistance.append(d);
         }
     }
-    emit objectAvoidanceChanged();
 }
 
 //-----------------------------------------------------------------------------
@@ -100,6 +193,7 @@ VehicleObjectAvoidance::stop()
 QPointF
 VehicleObjectAvoidance::grid(int i)
 {
+    _updateGrid();
     if(i < _objGrid.count() && i >= 0) {
         return _objGrid[i];
     }
@@ -110,6 +204,7 @@ VehicleObjectAvoidance::grid(int i)
 qreal
 VehicleObjectAvoidance::distance(int i)
 {
+    _updateGrid();
     if(i < _objDistance.count() && i >= 0) {
         return _objDistance[i];
     }
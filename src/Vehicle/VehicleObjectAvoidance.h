@@ -12,17 +12,30 @@
 #include <QObject>
 #include <QVector>
 #include <QPointF>
+#include <QMap>
+#include <QElapsedTimer>
+
+#include <array>
 
 #include "QGCMAVLink.h"
 
 class Vehicle;
 
+/// OBSTACLE_DISTANCE from all sensors of a vehicle, fused into a single map of fixed size sectors in the vehicle body
+/// frame. Sector 0 is centered on the vehicle heading, sectors go clockwise. Each sector holds the closest distance any
+/// sensor reports for it.
 class VehicleObjectAvoidance : public QObject
 {
     Q_OBJECT
 public:
     VehicleObjectAvoidance(Vehicle* vehicle, QObject* parent = nullptr);
 
+    static const int    kSectorCount        = MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN;
+    static constexpr qreal kSectorDegrees   = 360.0 / kSectorCount;
+    static const uint16_t kUnknownDistance  = UINT16_MAX;   ///< No sensor covers the sector
+
+    typedef std::array<uint16_t, kSectorCount> Sectors_t;   ///< Distances in cm, maxDistance + 1 for no obstacle
+
     Q_PROPERTY(bool             available   READ available      NOTIFY objectAvoidanceChanged)
     Q_PROPERTY(bool             enabled     READ enabled        NOTIFY objectAvoidanceChanged)
     Q_PROPERTY(QList<int>       distances   READ distances      NOTIFY objectAvoidanceChanged)
@@ -40,28 +53,47 @@ public:
     Q_INVOKABLE QPointF grid    (int i);
     Q_INVOKABLE qreal   distance(int i);
 
-    bool            available   () { return _distances.count() > 0; }
+    bool            available   () const{ return _available; }
     bool            enabled     ();
-    QList<int>      distances   () { return _distances; }
-    qreal           increment   () const{ return _increment; }
+    QList<int>      distances   () const;
+    qreal           increment   () const{ return _available ? kSectorDegrees : 0; }
     int             minDistance () const{ return _minDistance; }
     int             maxDistance () const{ return _maxDistance; }
-    qreal           angleOffset () const{ return _angleOffset; }
-    int             gridSize    () { return _objGrid.count(); }
+    qreal           angleOffset () const{ return 0; }
+    int             gridSize    () { _updateGrid(); return _objGrid.count(); }
+
+    const Sectors_t& sectors    () const { return _sectors; }
 
-    void            update      (mavlink_obstacle_distance_t* message);
+    void            update      (int componentId, mavlink_obstacle_distance_t* message);
 
 signals:
+    /// Only signalled when the fused sectors or ranges changed
     void            objectAvoidanceChanged  ();
 
 private:
-    QList<int>      _distances;
+    typedef struct {
+        std::array<uint16_t, MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN> distances;
+        qreal           increment;
+        qreal           angleOffset;
+        bool            bodyFrame;
+        int             minDistance;
+        int             maxDistance;
+        QElapsedTimer   received;
+    } Sensor_t;
+
+    void            _fuse       (void);
+    void            _updateGrid (void);
+
+    QMap<int, Sensor_t> _sensors;                   ///< Key: component id
+    Sectors_t       _sectors;
+    bool            _available      = false;
+    bool            _gridDirty      = true;
     QVector<QPointF>_objGrid;
     QVector<qreal>  _objDistance;
-    qreal           _increment      = 0;
     int             _minDistance    = 0;
     int             _maxDistance    = 0;
-    qreal           _angleOffset    = 0;
     Vehicle*        _vehicle        = nullptr;
+
+    static const int _sensorTimeoutMsecs = 1000;    ///< Sensors which stopped reporting no longer contribute
 };
 
@@ -44,6 +44,11 @@ VehicleSetpointFactGroup::VehicleSetpointFactGroup(QObject* parent)
     _yawRateFact.setRawValue(qQNaN());
 }
 
+QList<uint32_t> VehicleSetpointFactGroup::handledMessageIds(void) const
+{
+    return { MAVLINK_MSG_ID_ATTITUDE_TARGET };
+}
+
 void VehicleSetpointFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_ATTITUDE_TARGET) {
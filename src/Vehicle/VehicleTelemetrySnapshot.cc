@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleTelemetrySnapshot.h"
+
+#include <cstring>
+
+VehicleTelemetrySnapshot::VehicleTelemetrySnapshot(void)
+{
+    for (Buffer_t& buffer: _buffers) {
+        buffer.sequence.store(0, std::memory_order_relaxed);
+        memset(&buffer.telemetry, 0, sizeof(buffer.telemetry));
+    }
+}
+
+void VehicleTelemetrySnapshot::publish(const Telemetry_t& telemetry)
+{
+    // Only the writer changes _current, so it can be read relaxed here
+    const int   next    = _current.load(std::memory_order_relaxed) == 0 ? 1 : 0;
+    Buffer_t&   buffer  = _buffers[next];
+
+    // A reader still copying this buffer from before the last flip sees the sequence change and retries
+    const quint32 sequence = buffer.sequence.load(std::memory_order_relaxed);
+    buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&buffer.telemetry, &telemetry, sizeof(telemetry));
+    buffer.sequence.store(sequence + 2, std::memory_order_release);
+
+    _current.store(next, std::memory_order_release);
+    _publishCount.fetch_add(1, std::memory_order_release);
+}
+
+bool VehicleTelemetrySnapshot::read(Telemetry_t& telemetry) const
+{
+    while (true) {
+        const int current = _current.load(std::memory_order_acquire);
+        if (current < 0) {
+            return false;
+        }
+        const Buffer_t& buffer = _buffers[current];
+
+        const quint32 sequence = buffer.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            // Only possible if the writer has gone around to this buffer again, check where readers point now
+            continue;
+        }
+        memcpy(&telemetry, &buffer.telemetry, sizeof(telemetry));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buffer.sequence.load(std::memory_order_relaxed) == sequence) {
+            return true;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+/// Typed copy of the main vehicle state, published by Vehicle at a fixed rate so that plugins and other consumers can
+/// read it from any thread without going through Facts, QVariant or the GUI thread.
+///
+/// There is a single writer (Vehicle on the GUI thread) and any number of readers. Two buffers are used: the writer
+/// always fills the one readers are not pointed at and then flips them over, each buffer carries a sequence number
+/// which is odd while it is being written. Readers copy the current buffer and retry in the rare case it changed
+/// underneath them, which can only happen if a reader is held up for a whole publish interval. Neither side locks.
+///
+/// Vehicle hands out a shared pointer, so a reader may keep the snapshot after the vehicle is gone. vehicleActive
+/// tells it when that happened.
+class VehicleTelemetrySnapshot
+{
+public:
+    /// Values use MAVLink units: degrees, meters, meters/second. NaN for values the vehicle has not reported.
+    typedef struct {
+        quint64 publishCount;               ///< Incremented with each publish
+        qint64  timestampMSecs;             ///< Time of publish, msecs since epoch
+        int     vehicleId;
+
+        // Position
+        double  latitude;
+        double  longitude;
+        double  altitudeAMSL;
+        double  altitudeRelative;
+        double  groundSpeed;
+        double  airSpeed;
+        double  climbRate;
+
+        // Attitude
+        double  roll;
+        double  pitch;
+        double  heading;
+
+        // First battery
+        double  batteryVoltage;
+        double  batteryCurrent;             ///< Amps
+        int     batteryPercentRemaining;    ///< -1: not known
+
+        // GPS
+        double  gpsLatitude;
+        double  gpsLongitude;
+        double  gpsHdop;
+        double  gpsVdop;
+        int     gpsFixType;                 ///< GPS_FIX_TYPE
+        int     gpsSatellitesVisible;
+
+        // Mode
+        bool    armed;
+        bool    flying;
+        quint8  baseMode;                   ///< base_mode from HEARTBEAT
+        quint32 customMode;                 ///< custom_mode from HEARTBEAT
+        char    flightMode[32];             ///< Firmware flight mode name, UTF-8, nul terminated
+    } Telemetry_t;
+
+    static_assert(std::is_trivially_copyable<Telemetry_t>::value, "Telemetry_t is copied as plain memory");
+
+    VehicleTelemetrySnapshot(void);
+
+    /// Makes telemetry the current snapshot. Writer thread only.
+    void publish(const Telemetry_t& telemetry);
+
+    /// Copies the current snapshot, callable from any thread
+    /// @return false: nothing published yet
+    bool read(Telemetry_t& telemetry) const;
+
+    /// @return Number of snapshots published so far. Readers can poll this to find out about a new snapshot.
+    quint64 publishCount(void) const { return _publishCount.load(std::memory_order_acquire); }
+
+    /// @return false: the vehicle is gone, the snapshot will not change anymore
+    bool vehicleActive      (void) const { return _vehicleActive.load(std::memory_order_acquire); }
+    void setVehicleActive   (bool active) { _vehicleActive.store(active, std::memory_order_release); }
+
+private:
+    typedef struct {
+        std::atomic<quint32>    sequence;   ///< Odd while being written
+        Telemetry_t             telemetry;
+    } Buffer_t;
+
+    Buffer_t                _buffers[2];
+    std::atomic<int>        _current        { -1 };     ///< Buffer readers use, -1 before the first publish
+    std::atomic<quint64>    _publishCount   { 0 };
+    std::atomic<bool>       _vehicleActive  { true };
+};
+
+typedef std::shared_ptr<VehicleTelemetrySnapshot> SharedVehicleTelemetrySnapshotPtr;
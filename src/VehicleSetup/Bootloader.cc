@@ -10,7 +10,6 @@
 #include "Bootloader.h"
 #include "QGCLoggingCategory.h"
 
-#include <QFile>
 #include <QSerialPortInfo>
 #include <QDebug>
 #include <QElapsedTimer>
@@ -345,63 +344,54 @@ Error:
 
 bool Bootloader::_binProgram(const FirmwareImage* image)
 {
-    QFile firmwareFile(image->binFilename());
-    if (!firmwareFile.open(QIODevice::ReadOnly)) {
-        _errorString = tr("Unable to open firmware file %1: %2").arg(image->binFilename(), firmwareFile.errorString());
-        return false;
-    }
-    uint32_t imageSize = (uint32_t)firmwareFile.size();
-    
-    uint8_t imageBuf[PROG_MULTI_MAX];
-    uint32_t bytesSent = 0;
+    const QByteArray&   imageBytes  = image->binBytes();
+    uint32_t            imageSize   = (uint32_t)imageBytes.size();
+    uint32_t            bytesSent   = 0;
+    QList<uint32_t>     pendingAddresses;   ///< Chunks sent but not acknowledged yet
+
     _imageCRC = 0;
-    
-    Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
-    
-    while (bytesSent < imageSize) {
-        int bytesToSend = imageSize - bytesSent;
-        if (bytesToSend > (int)sizeof(imageBuf)) {
-            bytesToSend = (int)sizeof(imageBuf);
-        }
-        
-        Q_ASSERT((bytesToSend % 4) == 0);
-        
-        int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
-        if (bytesRead == -1 || bytesRead != bytesToSend) {
-            _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
-            return false;
-        }
-        
-        Q_ASSERT(bytesToSend <= 0x8F);
-        
-        bool failed = true;
-        if (_write(PROTO_PROG_MULTI) &&
-                _write((uint8_t)bytesToSend) &&
-                _write(imageBuf, bytesToSend) &&
-                _write(PROTO_EOC)) {
-            if (_getCommandResponse()) {
-                failed = false;
+
+    // The PX4 bootloader executes commands in order and answers each one with INSYNC/OK, so several program commands can be
+    // in flight. Only the responses need to be collected, in the same order, instead of waiting a round trip for each chunk.
+    while (bytesSent < imageSize || !pendingAddresses.isEmpty()) {
+        if (bytesSent < imageSize && pendingAddresses.count() < _programPipelineDepth) {
+            int bytesToSend = qMin(imageSize - bytesSent, (uint32_t)PROG_MULTI_MAX_BIN);
+
+            uint8_t chunk[PROG_MULTI_MAX_BIN];
+            memcpy(chunk, imageBytes.constData() + bytesSent, bytesToSend);
+            while (bytesToSend % 4) {
+                // Images are padded to a multiple of 4 at load, this only covers raw .bin files
+                chunk[bytesToSend++] = 0xFF;
             }
-        }
-        if (failed) {
-            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
-            return false;
-        }
 
-        bytesSent += bytesToSend;
+            if (!(_write(PROTO_PROG_MULTI) && _write((uint8_t)bytesToSend) && _write(chunk, bytesToSend) && _write(PROTO_EOC))) {
+                _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+                return false;
+            }
+            _port.flush();
+            pendingAddresses.append(bytesSent);
 
-        // Calculate the CRC now so we can test it after the board is flashed.
-        _imageCRC = QGC::crc32((uint8_t *)imageBuf, bytesToSend, _imageCRC);
+            // Calculate the CRC now so we can test it after the board is flashed.
+            _imageCRC = QGC::crc32(chunk, bytesToSend, _imageCRC);
+            bytesSent += bytesToSend;
+            continue;
+        }
 
-        emit updateProgress(bytesSent, imageSize);
+        uint32_t address = pendingAddresses.takeFirst();
+        if (!_getCommandResponse()) {
+            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(address, 8, 16, QLatin1Char('0'));
+            return false;
+        }
+        emit updateProgress(pendingAddresses.isEmpty() ? bytesSent : pendingAddresses.first(), imageSize);
     }
-    firmwareFile.close();
 
     // We calculate the CRC using the entire flash size, filling the remainder with 0xFF.
+    uint8_t fill[256];
+    memset(fill, 0xFF, sizeof(fill));
     while (bytesSent < _boardFlashSize) {
-        const uint8_t fill = 0xFF;
-        _imageCRC = QGC::crc32(&fill, 1, _imageCRC);
-        bytesSent++;
+        uint32_t fillBytes = qMin(_boardFlashSize - bytesSent, (uint32_t)sizeof(fill));
+        _imageCRC = QGC::crc32(fill, fillBytes, _imageCRC);
+        bytesSent += fillBytes;
     }
 
     return true;
@@ -511,12 +501,8 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
 {
     Q_ASSERT(image->imageIsBinFormat());
     
-    QFile firmwareFile(image->binFilename());
-    if (!firmwareFile.open(QIODevice::ReadOnly)) {
-        _errorString = tr("Unable to open firmware file %1: %2").arg(image->binFilename(), firmwareFile.errorString());
-        return false;
-    }
-    uint32_t imageSize = (uint32_t)firmwareFile.size();
+    const QByteArray&   imageBytes  = image->binBytes();
+    uint32_t            imageSize   = (uint32_t)imageBytes.size();
     
     if (!_sendCommand(PROTO_CHIP_VERIFY)) {
         return false;
@@ -536,11 +522,7 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
         
         Q_ASSERT((bytesToRead % 4) == 0);
         
-        int bytesRead = firmwareFile.read((char *)fileBuf, bytesToRead);
-        if (bytesRead == -1 || bytesRead != bytesToRead) {
-            _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
-            return false;
-        }
+        memcpy(fileBuf, imageBytes.constData() + bytesVerified, bytesToRead);
         
         Q_ASSERT(bytesToRead <= 0x8F);
         
@@ -572,8 +554,6 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
         emit updateProgress(bytesVerified, imageSize);
     }
     
-    firmwareFile.close();
-    
     return true;
 }
 
@@ -98,6 +98,7 @@ private:
         INFO_FLASH_SIZE		=   4,    ///< max firmware size in bytes
         
         PROG_MULTI_MAX		=   64,     ///< write size for PROTO_PROG_MULTI, must be multiple of 4
+        PROG_MULTI_MAX_BIN  =   252,    ///< write size for PROTO_PROG_MULTI on PX4 bootloaders (.bin images), protocol max is 255 and must be multiple of 4
         READ_MULTI_MAX		=   0x28    ///< read size for PROTO_READ_MULTI, must be multiple of 4. Sik Radio max size is 0x28
     };
     
@@ -111,6 +112,7 @@ private:
     QString     _firmwareFilename;              ///< Currently selected firmware file to flash
     QString     _errorString;                   ///< Last error
     
+    static const int _programPipelineDepth              = 4;        ///< Max PROTO_PROG_MULTI commands sent before their response is read
     static const int _eraseTimeout                      = 20000;    ///< Msecs to wait for response from erase command
     static const int _rebootTimeout                     = 10000;    ///< Msecs to wait for reboot command to cause serial port to disconnect
     static const int _verifyTimeout                     = 5000;     ///< Msecs to wait for response to PROTO_GET_CRC command
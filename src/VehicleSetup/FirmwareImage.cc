@@ -45,6 +45,8 @@ bool FirmwareImage::load(const QString& imageFilename, uint32_t boardId)
 {
     _imageSize = 0;
     _boardId = boardId;
+    _firmwareBoardId = 0;
+    _binBytes.clear();
     
     if (imageFilename.endsWith(".bin")) {
         _binFormat = true;
@@ -250,7 +252,9 @@ bool FirmwareImage::_px4Load(const QString& imageFilename)
     }
 
     uint32_t firmwareBoardId = (uint32_t)px4Json.value(_jsonBoardIdKey).toInt();
-    if (!isCompatible(_boardId, firmwareBoardId)) {
+    _firmwareBoardId = firmwareBoardId;
+    // A board id of 0 loads the image for any board, each board is then checked against firmwareBoardId before flashing
+    if (_boardId != 0 && !isCompatible(_boardId, firmwareBoardId)) {
         emit statusMessage(tr("Downloaded firmware board id does not match hardware board id: %1 != %2").arg(firmwareBoardId).arg(_boardId));
         return false;
     }
@@ -347,6 +351,7 @@ bool FirmwareImage::_px4Load(const QString& imageFilename)
     decompressFile.close();
     
     _binFilename = decompressFilename;
+    _binBytes = decompressedBytes;
     
     return true;
 }
@@ -357,15 +362,33 @@ bool FirmwareImage::_decompressJsonValue(const QJsonObject&	jsonObject,			///< J
                                          const QString&		sizeKey,			///< key which holds byte size
                                          const QString&		bytesKey,			///< key which holds compress bytes
                                          QByteArray&		decompressedBytes)	///< Returned decompressed bytes
+{
+    QString errorString;
+    if (!_decompressJsonValue(jsonObject, jsonDocBytes, sizeKey, bytesKey, decompressedBytes, errorString)) {
+        emit statusMessage(errorString);
+        return false;
+    }
+    
+    emit statusMessage(tr("Successfully decompressed %1").arg(bytesKey));
+    
+    return true;
+}
+
+bool FirmwareImage::_decompressJsonValue(const QJsonObject&	jsonObject,
+                                         const QByteArray&	jsonDocBytes,
+                                         const QString&		sizeKey,
+                                         const QString&		bytesKey,
+                                         QByteArray&		decompressedBytes,
+                                         QString&           errorString)
 {
     // Validate decompressed size key
     if (!jsonObject.contains(sizeKey)) {
-        emit statusMessage(QString("Firmware file missing %1 key").arg(sizeKey));
+        errorString = QString("Firmware file missing %1 key").arg(sizeKey);
         return false;
     }
     int decompressedSize = jsonObject.value(QString(sizeKey)).toInt();
     if (decompressedSize == 0) {
-        emit statusMessage(tr("Firmware file has invalid decompressed size for %1").arg(sizeKey));
+        errorString = tr("Firmware file has invalid decompressed size for %1").arg(sizeKey);
         return false;
     }
     
@@ -377,12 +400,12 @@ bool FirmwareImage::_decompressJsonValue(const QJsonObject&	jsonObject,			///< J
     
     QStringList parts = QString(jsonDocBytes).split(QString("\"%1\": \"").arg(bytesKey));
     if (parts.count() == 1) {
-        emit statusMessage(tr("Could not find compressed bytes for %1 in Firmware file").arg(bytesKey));
+        errorString = tr("Could not find compressed bytes for %1 in Firmware file").arg(bytesKey);
         return false;
     }
     parts = parts.last().split("\"");
     if (parts.count() == 1) {
-        emit statusMessage(tr("Incorrectly formed compressed bytes section for %1 in Firmware file").arg(bytesKey));
+        errorString = tr("Incorrectly formed compressed bytes section for %1 in Firmware file").arg(bytesKey);
         return false;
     }
     
@@ -398,19 +421,87 @@ bool FirmwareImage::_decompressJsonValue(const QJsonObject&	jsonObject,			///< J
     decompressedBytes = qUncompress(raw);
     
     if (decompressedBytes.count() == 0) {
-        emit statusMessage(tr("Firmware file has 0 length %1").arg(bytesKey));
+        errorString = tr("Firmware file has 0 length %1").arg(bytesKey);
         return false;
     }
     if (decompressedBytes.count() != decompressedSize) {
-        emit statusMessage(tr("Size for decompressed %1 does not match stored size: Expected(%1) Actual(%2)").arg(decompressedSize).arg(decompressedBytes.count()));
+        errorString = tr("Size for decompressed %1 does not match stored size: Expected(%1) Actual(%2)").arg(decompressedSize).arg(decompressedBytes.count());
         return false;
     }
     
-    emit statusMessage(tr("Successfully decompressed %1").arg(bytesKey));
-    
     return true;
 }
 
+bool FirmwareImage::decodePx4(const QByteArray& px4Bytes, uint32_t& firmwareBoardId, QByteArray& imageBytes, QByteArray& parameterXml, QByteArray& airframeXml, QString& errorString)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(px4Bytes);
+    if (doc.isNull()) {
+        errorString = tr("Supplied file is not a valid JSON document");
+        return false;
+    }
+    QJsonObject px4Json = doc.object();
+
+    QStringList requiredKeys;
+    requiredKeys << _jsonBoardIdKey << _jsonImageKey << _jsonImageSizeKey;
+    if (!JsonHelper::validateRequiredKeys(px4Json, requiredKeys, errorString)) {
+        errorString = tr("Firmware file missing required key: %1").arg(errorString);
+        return false;
+    }
+    firmwareBoardId = (uint32_t)px4Json.value(_jsonBoardIdKey).toInt();
+
+    if (!_decompressJsonValue(px4Json, px4Bytes, _jsonImageSizeKey, _jsonImageKey, imageBytes, errorString)) {
+        return false;
+    }
+    // Pad image to 4-byte boundary
+    while ((imageBytes.count() % 4) != 0) {
+        imageBytes.append(static_cast<char>(static_cast<unsigned char>(0xFF)));
+    }
+
+    // Meta data is optional
+    QString ignoredError;
+    if (!_decompressJsonValue(px4Json, px4Bytes, _jsonParamXmlSizeKey, _jsonParamXmlKey, parameterXml, ignoredError)) {
+        parameterXml.clear();
+    }
+    if (!_decompressJsonValue(px4Json, px4Bytes, _jsonAirframeXmlSizeKey, _jsonAirframeXmlKey, airframeXml, ignoredError)) {
+        airframeXml.clear();
+    }
+
+    return true;
+}
+
+bool FirmwareImage::loadDecoded(const QString& binFilename, uint32_t firmwareBoardId, uint32_t boardId, const QString& parameterXmlFilename, const QString& airframeXmlFilename)
+{
+    _imageSize = 0;
+    _boardId = boardId;
+    _firmwareBoardId = firmwareBoardId;
+    _binBytes.clear();
+    _binFormat = true;
+
+    if (_boardId != 0 && _firmwareBoardId != 0 && !isCompatible(_boardId, _firmwareBoardId)) {
+        emit statusMessage(tr("Downloaded firmware board id does not match hardware board id: %1 != %2").arg(_firmwareBoardId).arg(_boardId));
+        return false;
+    }
+
+    if (!parameterXmlFilename.isEmpty()) {
+        QString parameterFilename = QGCApplication::cachedParameterMetaDataFile();
+        QFile::remove(parameterFilename);
+        if (QFile::copy(parameterXmlFilename, parameterFilename)) {
+            CompInfoParam::_cachePX4MetaDataFile(parameterFilename);
+        } else {
+            emit statusMessage(tr("Unable to copy parameter meta data file to %1").arg(parameterFilename));
+        }
+    }
+    if (!airframeXmlFilename.isEmpty()) {
+        QString airframeFilename = QGCApplication::cachedAirframeMetaDataFile();
+        QFile::remove(airframeFilename);
+        if (!QFile::copy(airframeXmlFilename, airframeFilename)) {
+            emit statusMessage(tr("Unable to copy airframe meta data file to %1").arg(airframeFilename));
+        }
+    }
+
+    return _binLoad(binFilename);
+}
+
 uint16_t FirmwareImage::ihxBlockCount(void) const
 {
     return _ihxBlocks.count();
@@ -438,7 +529,8 @@ bool FirmwareImage::_binLoad(const QString& imageFilename)
         return false;
     }
     
-    _imageSize = (uint32_t)binFile.size();
+    _binBytes = binFile.readAll();
+    _imageSize = (uint32_t)_binBytes.size();
     
     binFile.close();
     
@@ -37,6 +37,18 @@ public:
     /// @return true: success, false: failure
     bool load(const QString& imageFilename, uint32_t boardId);
     
+    /// Loads a .bin image which FirmwareImageCache already decoded from a .px4/.apj file
+    ///     @param firmwareBoardId Board id from the original file
+    ///     @param boardId Board id that we are going to load this image onto, 0 for any board
+    ///     @param parameterXmlFilename Parameter meta data to install, empty if already installed
+    ///     @param airframeXmlFilename Airframe meta data to install, empty if already installed
+    /// @return true: success, false: failure
+    bool loadDecoded(const QString& binFilename, uint32_t firmwareBoardId, uint32_t boardId, const QString& parameterXmlFilename, const QString& airframeXmlFilename);
+
+    /// Decodes the image and meta data out of a .px4/.apj file. Has no side effects so it can run on any thread.
+    /// @return true: success, false: failure, errorString set
+    static bool decodePx4(const QByteArray& px4Bytes, uint32_t& firmwareBoardId, QByteArray& imageBytes, QByteArray& parameterXml, QByteArray& airframeXml, QString& errorString);
+
     /// Returns the number of bytes in the image.
     uint32_t imageSize(void) const { return _imageSize; }
     
@@ -45,6 +57,12 @@ public:
     
     /// @return Filename for .bin file
     QString binFilename(void) const { return _binFilename; }
+
+    /// @return Contents of the .bin file. Read once at load so several bootloader sessions can share the image.
+    const QByteArray& binBytes(void) const { return _binBytes; }
+
+    /// @return Board id the firmware was built for, 0 if the format does not specify one (.bin, .ihx)
+    uint32_t firmwareBoardId(void) const { return _firmwareBoardId; }
     
     /// @return Block count from .ihx image
     uint16_t ihxBlockCount(void) const;
@@ -57,7 +75,7 @@ public:
     bool ihxGetBlock(uint16_t index, uint16_t& address, QByteArray& bytes) const;
     
     /// @return true: actual boardId is compatible with firmware boardId
-    bool isCompatible(uint32_t boardId, uint32_t firmwareId);
+    static bool isCompatible(uint32_t boardId, uint32_t firmwareId);
 
 signals:
     void errorMessage(const QString& errorString);
@@ -77,6 +95,12 @@ private:
                               const QString&		sizeKey,
                               const QString&		bytesKey,
                               QByteArray&			decompressedBytes);
+    static bool _decompressJsonValue(const QJsonObject& jsonObject,
+                                     const QByteArray&  jsonDocBytes,
+                                     const QString&     sizeKey,
+                                     const QString&     bytesKey,
+                                     QByteArray&        decompressedBytes,
+                                     QString&           errorString);
     
     typedef struct {
         uint16_t    address;
@@ -86,6 +110,8 @@ private:
     bool                    _binFormat;
     uint32_t                _boardId;
     QString                 _binFilename;
+    QByteArray              _binBytes;
+    uint32_t                _firmwareBoardId = 0;
     QList<IntelHexBlock_t>  _ihxBlocks;
     uint32_t                _imageSize;
 
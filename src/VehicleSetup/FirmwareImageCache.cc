@@ -0,0 +1,214 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FirmwareImageCache.h"
+#include "FirmwareImage.h"
+#include "QGCCachedFileDownload.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTimer>
+#include <QFile>
+#include <QDir>
+
+static const char* _jsonImageHashKey    = "imageSha256";
+static const char* _jsonBoardIdKey      = "firmwareBoardId";
+
+FirmwareImageCache::FirmwareImageCache(QObject* parent)
+    : QObject           (parent)
+    , _cacheDir         (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCFirmwareImageCache"))
+{
+    QDir().mkpath(_cacheDir);
+}
+
+void FirmwareImageCache::fetch(const QString& url)
+{
+    if (_pending.contains(url)) {
+        qCDebug(FirmwareUpgradeLog) << "FirmwareImageCache::fetch already in progress" << url;
+        return;
+    }
+
+    if (_entries.contains(url) && !_entryAge[url].hasExpired(_maxCacheAgeSecs * 1000)) {
+        // Same image which was just prepared, for example when flashing a batch of boards
+        qCDebug(FirmwareUpgradeLog) << "FirmwareImageCache::fetch ready from memory" << url;
+        QTimer::singleShot(0, this, [this, url]() { emit ready(url); });
+        return;
+    }
+
+    _pending.insert(url);
+
+    QGCCachedFileDownload* download = new QGCCachedFileDownload(this);
+    download->setPriority(QGCDownloadScheduler::PriorityInteractive);
+    connect(download, &QGCCachedFileDownload::downloadProgress, this,       &FirmwareImageCache::downloadProgress);
+    connect(download, &QGCCachedFileDownload::downloadComplete, this,       &FirmwareImageCache::_downloadComplete);
+    connect(download, &QGCCachedFileDownload::downloadComplete, download,   &QObject::deleteLater);
+    if (!download->download(url, _maxCacheAgeSecs)) {
+        _pending.remove(url);
+        download->deleteLater();
+        emit failed(url, tr("Unable to start download of %1").arg(url));
+    }
+}
+
+FirmwareImageCache::Entry_t FirmwareImageCache::use(const QString& url)
+{
+    Entry_t entry = _entries.value(url);
+
+    // Meta data only needs to be installed once
+    _entries[url].parameterXmlFilename.clear();
+    _entries[url].airframeXmlFilename.clear();
+
+    return entry;
+}
+
+void FirmwareImageCache::_downloadComplete(QString remoteFile, QString localFile, QString errorMsg)
+{
+    if (!errorMsg.isEmpty()) {
+        _pending.remove(remoteFile);
+        emit failed(remoteFile, errorMsg);
+        return;
+    }
+
+    emit statusMessage(tr("Preparing firmware image..."));
+
+    QFutureWatcher<PrepareResult_t>* watcher = new QFutureWatcher<PrepareResult_t>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, remoteFile, watcher]() { _prepareComplete(remoteFile, watcher); });
+    watcher->setFuture(QtConcurrent::run(&FirmwareImageCache::_prepareWorker, remoteFile, localFile, _cacheDir));
+}
+
+void FirmwareImageCache::_prepareComplete(const QString& url, QFutureWatcher<PrepareResult_t>* watcher)
+{
+    PrepareResult_t result = watcher->result();
+    watcher->deleteLater();
+    _pending.remove(url);
+
+    if (!result.errorString.isEmpty()) {
+        emit failed(url, result.errorString);
+        return;
+    }
+
+    if (result.decodeSkipped) {
+        emit statusMessage(tr("Using previously decoded firmware image"));
+    }
+    _entries[url] = result.entry;
+    _entryAge[url].start();
+    emit ready(url);
+}
+
+QByteArray FirmwareImageCache::_fileHash(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    return hash.result().toHex();
+}
+
+/// Runs on a thread pool thread, must not touch the cache object
+FirmwareImageCache::PrepareResult_t FirmwareImageCache::_prepareWorker(const QString& url, const QString& localFile, const QString& cacheDir)
+{
+    PrepareResult_t result;
+
+    QString suffix = QFileInfo(QUrl(url).path()).suffix().toLower();
+    if (suffix != QLatin1String("px4") && suffix != QLatin1String("apj")) {
+        // Nothing to decode, .bin and .ihx are loaded as is
+        result.entry.imageFilename = localFile;
+        return result;
+    }
+
+    QFile file(localFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.errorString = tr("Unable to open firmware file %1, error: %2").arg(localFile, file.errorString());
+        return result;
+    }
+    QByteArray bytes = file.readAll();
+    file.close();
+
+    QDir    dir(cacheDir);
+    QString baseName        = QString(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
+    QString binFilename     = dir.filePath(baseName + QLatin1String(".bin"));
+    QString jsonFilename    = dir.filePath(baseName + QLatin1String(".json"));
+
+    result.entry.imageFilename  = binFilename;
+    result.entry.decoded        = true;
+
+    // Same download decoded before, use it if it is still intact
+    QFile jsonFile(jsonFilename);
+    if (jsonFile.open(QIODevice::ReadOnly)) {
+        QJsonObject json = QJsonDocument::fromJson(jsonFile.readAll()).object();
+        QString     imageHash = json.value(_jsonImageHashKey).toString();
+        if (!imageHash.isEmpty() && imageHash.toLatin1() == _fileHash(binFilename)) {
+            result.entry.firmwareBoardId    = static_cast<uint32_t>(json.value(_jsonBoardIdKey).toInt());
+            result.decodeSkipped            = true;
+            // Keeps it from being pruned as least recently used
+            jsonFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            return result;
+        }
+        jsonFile.close();
+        qCWarning(FirmwareUpgradeLog) << "Decoded firmware image failed validation, decoding again" << binFilename;
+    }
+
+    QByteArray imageBytes;
+    QByteArray parameterXml;
+    QByteArray airframeXml;
+    if (!FirmwareImage::decodePx4(bytes, result.entry.firmwareBoardId, imageBytes, parameterXml, airframeXml, result.errorString)) {
+        return result;
+    }
+
+    auto writeFile = [&result](const QString& filename, const QByteArray& contents) {
+        QFile outFile(filename);
+        if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || outFile.write(contents) != contents.count()) {
+            result.errorString = tr("Unable to write decoded firmware file %1, error: %2").arg(filename, outFile.errorString());
+            return false;
+        }
+        return true;
+    };
+
+    if (!writeFile(binFilename, imageBytes)) {
+        return result;
+    }
+    if (!parameterXml.isEmpty()) {
+        result.entry.parameterXmlFilename = dir.filePath(baseName + QLatin1String(".parameter.xml"));
+        if (!writeFile(result.entry.parameterXmlFilename, parameterXml)) {
+            return result;
+        }
+    }
+    if (!airframeXml.isEmpty()) {
+        result.entry.airframeXmlFilename = dir.filePath(baseName + QLatin1String(".airframe.xml"));
+        if (!writeFile(result.entry.airframeXmlFilename, airframeXml)) {
+            return result;
+        }
+    }
+
+    // Written last so a partially written entry is never used
+    QJsonObject json;
+    json[_jsonImageHashKey] = QString(QCryptographicHash::hash(imageBytes, QCryptographicHash::Sha256).toHex());
+    json[_jsonBoardIdKey]   = static_cast<int>(result.entry.firmwareBoardId);
+    if (!writeFile(jsonFilename, QJsonDocument(json).toJson())) {
+        return result;
+    }
+
+    // Drop the least recently used images
+    const QFileInfoList entries = dir.entryInfoList(QStringList(QStringLiteral("*.json")), QDir::Files, QDir::Time);
+    for (int i=_maxImageFiles; i<entries.count(); i++) {
+        QString oldBaseName = entries[i].completeBaseName();
+        for (const QString& oldFile: dir.entryList(QStringList(oldBaseName + QStringLiteral(".*")), QDir::Files)) {
+            dir.remove(oldFile);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+#include <stdint.h>
+
+class QGCCachedFileDownload;
+
+/// Downloads firmware files and keeps them ready to program.
+///
+/// Downloads go through QGCCachedFileDownload, so the HTTP cache (ETag, Last-Modified) decides whether the file is
+/// fetched again. The .px4/.apj container is then decoded in the background and the resulting .bin is stored keyed by
+/// the SHA-256 of the download, along with its own hash which is checked before it is used. Downloading the same file
+/// again therefore skips the decode, and fetching the same url again during a session skips everything.
+class FirmwareImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    FirmwareImageCache(QObject* parent = nullptr);
+
+    typedef struct {
+        QString     imageFilename;          ///< Decoded .bin for .px4/.apj, the download itself otherwise
+        bool        decoded         = false;///< true: imageFilename is a decoded .px4/.apj, load with FirmwareImage::loadDecoded
+        uint32_t    firmwareBoardId = 0;    ///< 0 when the format does not specify one
+        QString     parameterXmlFilename;   ///< Only set the first time the entry is used, empty afterwards
+        QString     airframeXmlFilename;
+    } Entry_t;
+
+    /// Starts preparing the specified firmware. Signals ready or failed once done, also when already cached.
+    /// Calling it again for a url which is still being prepared just waits for the same result.
+    void fetch(const QString& url);
+
+    /// @return Entry for a url which signalled ready. Meta data files are only returned by the first call.
+    Entry_t use(const QString& url);
+
+signals:
+    void downloadProgress   (qint64 curr, qint64 total);
+    void ready              (const QString& url);
+    void failed             (const QString& url, const QString& errorString);
+    void statusMessage      (const QString& text);
+
+private slots:
+    void _downloadComplete  (QString remoteFile, QString localFile, QString errorMsg);
+
+private:
+    typedef struct {
+        Entry_t     entry;
+        QString     errorString;
+        bool        decodeSkipped = false;
+    } PrepareResult_t;
+
+    static PrepareResult_t  _prepareWorker  (const QString& url, const QString& localFile, const QString& cacheDir);
+    static QByteArray       _fileHash       (const QString& filename);
+    void                    _prepareComplete(const QString& url, QFutureWatcher<PrepareResult_t>* watcher);
+
+    QString                         _cacheDir;
+    QHash<QString, Entry_t>         _entries;       ///< Ready entries by url
+    QHash<QString, QElapsedTimer>   _entryAge;
+    QSet<QString>                   _pending;       ///< Urls being downloaded or decoded
+
+    static const int _maxCacheAgeSecs   = 10 * 60;  ///< Within this the download cache is used without asking the server
+    static const int _maxImageFiles     = 10;       ///< Decoded images kept on disk
+};
@@ -25,6 +25,8 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkProxy>
+#include <QBuffer>
+#include <QFile>
 
 #include "zlib.h"
 
@@ -143,6 +145,21 @@ FirmwareUpgradeController::FirmwareUpgradeController(void)
     connect(_threadController, &PX4FirmwareUpgradeThreadController::flashComplete,          this, &FirmwareUpgradeController::_flashComplete);
     connect(_threadController, &PX4FirmwareUpgradeThreadController::updateProgress,         this, &FirmwareUpgradeController::_updateProgress);
     
+    _firmwareCache = new FirmwareImageCache(this);
+
+    connect(_firmwareCache, &FirmwareImageCache::ready,             this, &FirmwareUpgradeController::_firmwareCacheReady);
+    connect(_firmwareCache, &FirmwareImageCache::failed,            this, &FirmwareUpgradeController::_firmwareCacheFailed);
+    connect(_firmwareCache, &FirmwareImageCache::downloadProgress,  this, &FirmwareUpgradeController::_firmwareDownloadProgress);
+    connect(_firmwareCache, &FirmwareImageCache::statusMessage,     this, &FirmwareUpgradeController::_status);
+
+    _parallelFlasher = new ParallelFirmwareFlasher(this);
+
+    connect(_parallelFlasher, &ParallelFirmwareFlasher::boardStarted,   this, &FirmwareUpgradeController::_multiBoardStarted);
+    connect(_parallelFlasher, &ParallelFirmwareFlasher::boardStatus,    this, &FirmwareUpgradeController::_multiBoardStatus);
+    connect(_parallelFlasher, &ParallelFirmwareFlasher::boardProgress,  this, &FirmwareUpgradeController::_multiBoardProgress);
+    connect(_parallelFlasher, &ParallelFirmwareFlasher::boardFinished,  this, &FirmwareUpgradeController::_multiBoardFinished);
+    connect(_parallelFlasher, &ParallelFirmwareFlasher::idle,           this, &FirmwareUpgradeController::_multiBoardIdle);
+
     connect(&_eraseTimer, &QTimer::timeout, this, &FirmwareUpgradeController::_eraseProgressTick);
 
 #if !defined(NO_ARDUPILOT_DIALECT)
@@ -202,8 +219,9 @@ void FirmwareUpgradeController::flashFirmwareUrl(QString firmwareFlashUrl)
     if (_bootloaderFound) {
         _downloadFirmware();
     } else {
-        // We haven't found the bootloader yet. Need to wait until then to flash
+        // We haven't found the bootloader yet. Need to wait until then to flash, download in the meantime.
         _startFlashWhenBootloaderFound = true;
+        _firmwareCache->fetch(_firmwareFilename);
     }
 }
 
@@ -223,6 +241,93 @@ void FirmwareUpgradeController::cancel(void)
     _threadController->cancel();
 }
 
+void FirmwareUpgradeController::startMultiBoardFlash(const QString& firmwareFilename)
+{
+    if (_multiBoardImage) {
+        return;
+    }
+
+    LinkManager* linkMgr = qgcApp()->toolbox()->linkManager();
+    linkMgr->setConnectionsSuspended(tr("Connect not allowed during Firmware Upgrade."));
+    if (!qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()) {
+        linkMgr->disconnectAll();
+    }
+
+    // The single board search would fight over the same ports
+    cancel();
+    _threadController->stopFindBoardLoop();
+
+    // Board id 0: the image is checked against each board before it is flashed
+    FirmwareImage* image = new FirmwareImage(this);
+    connect(image, &FirmwareImage::statusMessage, this, &FirmwareUpgradeController::_status);
+    if (!image->load(firmwareFilename, 0)) {
+        delete image;
+        _errorCancel(tr("Image load failed"));
+        return;
+    }
+
+    _multiBoardImage = image;
+    _multiBoardProgressPercent.clear();
+    _appendStatusLog(tr("Flashing %1 to all boards. Plug in the boards to flash.").arg(firmwareFilename), true);
+    _parallelFlasher->start(_multiBoardImage);
+    emit multiBoardFlashActiveChanged(true);
+}
+
+void FirmwareUpgradeController::stopMultiBoardFlash(void)
+{
+    if (_multiBoardImage) {
+        if (_parallelFlasher->activeCount()) {
+            _appendStatusLog(tr("Waiting for %1 board(s) to complete").arg(_parallelFlasher->activeCount()));
+        }
+        _parallelFlasher->stop();
+    }
+}
+
+void FirmwareUpgradeController::_multiBoardStarted(const QString& portName, const QString& boardName)
+{
+    _multiBoardProgressPercent[portName] = 0;
+    _appendStatusLog(tr("%1: Found %2").arg(portName, boardName));
+}
+
+void FirmwareUpgradeController::_multiBoardStatus(const QString& portName, const QString& statusText)
+{
+    _appendStatusLog(QStringLiteral("%1: %2").arg(portName, statusText));
+}
+
+void FirmwareUpgradeController::_multiBoardProgress(const QString& portName, int curr, int total)
+{
+    if (total > 0) {
+        // Keep the log readable with many boards in flight
+        int percent = (curr * 4 / total) * 25;
+        if (percent > _multiBoardProgressPercent.value(portName)) {
+            _multiBoardProgressPercent[portName] = percent;
+            _appendStatusLog(QStringLiteral("%1: %2%").arg(portName).arg(percent));
+        }
+    }
+}
+
+void FirmwareUpgradeController::_multiBoardFinished(const QString& portName, bool success, const QString& errorString)
+{
+    _multiBoardProgressPercent.remove(portName);
+    if (success) {
+        _appendStatusLog(tr("%1: Upgrade complete").arg(portName), true);
+    } else {
+        _appendStatusLog(tr("%1: Error: %2").arg(portName, errorString), true);
+    }
+    _appendStatusLog(tr("Boards flashed: %1, failed: %2").arg(_parallelFlasher->succeededCount()).arg(_parallelFlasher->failedCount()));
+}
+
+void FirmwareUpgradeController::_multiBoardIdle(void)
+{
+    delete _multiBoardImage;
+    _multiBoardImage = nullptr;
+
+    _appendStatusLog(tr("Multi board flash stopped"), true);
+    _appendStatusLog("------------------------------------------", false);
+    emit multiBoardFlashActiveChanged(false);
+    qgcApp()->toolbox()->linkManager()->setConnectionsAllowed();
+}
+
 QStringList FirmwareUpgradeController::availableBoardsName(void)
 {
     QGCSerialPortInfo::BoardType_t boardType;
@@ -291,7 +396,12 @@ void FirmwareUpgradeController::_foundBoardInfo(int bootloaderVersion, int board
     _appendStatusLog(tr("  Flash size: %1").arg(_bootloaderBoardFlashSize));
     
     if (_startFlashWhenBootloaderFound) {
-        flash(_startFlashWhenBootloaderFoundFirmwareIdentity);
+        if (_firmwareFilename.isEmpty()) {
+            flash(_startFlashWhenBootloaderFoundFirmwareIdentity);
+        } else {
+            // Url was already known, see flashFirmwareUrl
+            _downloadFirmware();
+        }
     } else {
         if (_rgManifestFirmwareInfo.count()) {
             _buildAPMFirmwareNames();
@@ -396,10 +506,7 @@ void FirmwareUpgradeController::_downloadFirmware(void)
     _appendStatusLog(tr("Downloading firmware..."));
     _appendStatusLog(tr(" From: %1").arg(_firmwareFilename));
     
-    QGCFileDownload* downloader = new QGCFileDownload(this);
-    connect(downloader, &QGCFileDownload::downloadComplete, this, &FirmwareUpgradeController::_firmwareDownloadComplete);
-    connect(downloader, &QGCFileDownload::downloadProgress, this, &FirmwareUpgradeController::_firmwareDownloadProgress);
-    downloader->download(_firmwareFilename);
+    _firmwareCache->fetch(_firmwareFilename);
 }
 
 /// @brief Updates the progress indicator while downloading
@@ -411,37 +518,49 @@ void FirmwareUpgradeController::_firmwareDownloadProgress(qint64 curr, qint64 to
     }
 }
 
-/// @brief Called when the firmware download completes.
-void FirmwareUpgradeController::_firmwareDownloadComplete(QString /*remoteFile*/, QString localFile, QString errorMsg)
+/// @brief Called when the firmware file is downloaded and decoded, possibly ahead of the bootloader being found
+void FirmwareUpgradeController::_firmwareCacheReady(const QString& url)
 {
-    if (errorMsg.isEmpty()) {
+    if (url != _firmwareFilename || !_bootloaderFound) {
+        // Prefetched while searching for the board, flashing picks it up from the cache
+        return;
+    }
     _appendStatusLog(tr("Download complete"));
-    
+
+    FirmwareImageCache::Entry_t entry = _firmwareCache->use(url);
+
     FirmwareImage* image = new FirmwareImage(this);
     
     connect(image, &FirmwareImage::statusMessage, this, &FirmwareUpgradeController::_status);
     connect(image, &FirmwareImage::errorMessage, this, &FirmwareUpgradeController::_error);
     
-    if (!image->load(localFile, _bootloaderBoardID)) {
+    bool loaded = entry.decoded ?
+                image->loadDecoded(entry.imageFilename, entry.firmwareBoardId, _bootloaderBoardID, entry.parameterXmlFilename, entry.airframeXmlFilename) :
+                image->load(entry.imageFilename, _bootloaderBoardID);
+    if (!loaded) {
+        delete image;
         _errorCancel(tr("Image load failed"));
         return;
     }
     
-    // We can't proceed unless we have the bootloader
-    if (!_bootloaderFound) {
-        _errorCancel(tr("Bootloader not found"));
-        return;
-    }
-    
     if (_bootloaderBoardFlashSize != 0 && image->imageSize() > _bootloaderBoardFlashSize) {
         _errorCancel(tr("Image size of %1 is too large for board flash size %2").arg(image->imageSize()).arg(_bootloaderBoardFlashSize));
+        delete image;
         return;
     }
 
+    _image = image;
     _threadController->flash(image);
-    } else {
-        _errorCancel(errorMsg);
+}
+
+void FirmwareUpgradeController::_firmwareCacheFailed(const QString& url, const QString& errorString)
+{
+    if (url != _firmwareFilename || !_bootloaderFound) {
+        // Prefetch failed, it is tried again once the board is found
+        qCDebug(FirmwareUpgradeLog) << "Firmware prefetch failed" << url << errorString;
+        return;
     }
+    _errorCancel(errorString);
 }
 
 /// @brief returns firmware type as a string
@@ -699,15 +818,21 @@ void FirmwareUpgradeController::_ardupilotManifestDownloadComplete(QString remot
 
         qCDebug(FirmwareUpgradeLog) << "_ardupilotManifestDownloadFinished" << remoteFile << localFile;
 
-        QString jsonFileName(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("ArduPilot.Manifest.json"));
-        if (!QGCZlib::inflateGzipFile(localFile, jsonFileName)) {
-            qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << localFile;
-            return;
+        // The manifest is several MB once inflated, parse it straight from memory instead of a temp file
+        QFile       gzipFile(localFile);
+        QByteArray  jsonBytes;
+        {
+            QBuffer jsonBuffer(&jsonBytes);
+            jsonBuffer.open(QIODevice::WriteOnly);
+            if (!gzipFile.open(QIODevice::ReadOnly) || !QGCZlib::inflateGzip(gzipFile, jsonBuffer)) {
+                qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << localFile;
+                return;
+            }
         }
 
         QString         errorString;
         QJsonDocument   doc;
-        if (!JsonHelper::isJsonFile(jsonFileName, doc, errorString)) {
+        if (!JsonHelper::isJsonFile(jsonBytes, doc, errorString)) {
             qCWarning(FirmwareUpgradeLog) << "Json file read failed" << errorString;
             return;
         }
@@ -10,6 +10,8 @@
 #pragma once
 
 #include "PX4FirmwareUpgradeThread.h"
+#include "ParallelFirmwareFlasher.h"
+#include "FirmwareImageCache.h"
 #include "FirmwareImage.h"
 #include "Fact.h"
 
@@ -97,6 +99,7 @@ public:
     Q_PROPERTY(QStringList          apmFirmwareUrls             MEMBER _apmFirmwareUrls                                             NOTIFY apmFirmwareNamesChanged)
     Q_PROPERTY(QString              px4StableVersion            READ px4StableVersion                                               NOTIFY px4StableVersionChanged)
     Q_PROPERTY(QString              px4BetaVersion              READ px4BetaVersion                                                 NOTIFY px4BetaVersionChanged)
+    Q_PROPERTY(bool                 multiBoardFlashActive       READ multiBoardFlashActive                                          NOTIFY multiBoardFlashActiveChanged)
 
     /// TextArea for log output
     Q_PROPERTY(QQuickItem* statusLog READ statusLog WRITE setStatusLog)
@@ -121,6 +124,11 @@ public:
     Q_INVOKABLE void flashSingleFirmwareMode(FirmwareBuildType_t firmwareType);
 
     Q_INVOKABLE FirmwareVehicleType_t vehicleTypeFromFirmwareSelectionIndex(int index);
+
+    /// Flashes the specified local firmware file to every board which is plugged in until stopMultiBoardFlash is called.
+    /// Boards are flashed in parallel, this replaces the single board search started by startBoardSearch.
+    Q_INVOKABLE void startMultiBoardFlash(const QString& firmwareFilename);
+    Q_INVOKABLE void stopMultiBoardFlash (void);
     
     // overload, not exposed to qml side
     void flash(const FirmwareIdentifier& firmwareId);
@@ -143,6 +151,8 @@ public:
     QString     px4StableVersion    (void) { return _px4StableVersion; }
     QString     px4BetaVersion  (void) { return _px4BetaVersion; }
 
+    bool multiBoardFlashActive(void) const { return _multiBoardImage != nullptr; }
+
     bool pixhawkBoard(void) const { return _boardType == QGCSerialPortInfo::BoardTypePixhawk; }
     bool px4FlowBoard(void) const { return _boardType == QGCSerialPortInfo::BoardTypePX4Flow; }
 
@@ -166,10 +176,12 @@ signals:
     void px4StableVersionChanged        (const QString& px4StableVersion);
     void px4BetaVersionChanged          (const QString& px4BetaVersion);
     void downloadingFirmwareListChanged (bool downloadingFirmwareList);
+    void multiBoardFlashActiveChanged   (bool multiBoardFlashActive);
 
 private slots:
     void _firmwareDownloadProgress          (qint64 curr, qint64 total);
-    void _firmwareDownloadComplete          (QString remoteFile, QString localFile, QString errorMsg);
+    void _firmwareCacheReady                (const QString& url);
+    void _firmwareCacheFailed               (const QString& url, const QString& errorString);
     void _foundBoard                        (bool firstAttempt, const QSerialPortInfo& portInfo, int boardType, QString boardName);
     void _noBoardFound                      (void);
     void _boardGone                         (void);
@@ -185,6 +197,11 @@ private slots:
     void _px4ReleasesGithubDownloadComplete (QString remoteFile, QString localFile, QString errorMsg);
     void _ardupilotManifestDownloadComplete (QString remoteFile, QString localFile, QString errorMsg);
     void _buildAPMFirmwareNames             (void);
+    void _multiBoardStarted                 (const QString& portName, const QString& boardName);
+    void _multiBoardStatus                  (const QString& portName, const QString& statusText);
+    void _multiBoardProgress                (const QString& portName, int curr, int total);
+    void _multiBoardFinished                (const QString& portName, bool success, const QString& errorString);
+    void _multiBoardIdle                    (void);
 
 private:
     QHash<FirmwareIdentifier, QString>* _firmwareHashForBoardId(int boardId);
@@ -253,6 +270,11 @@ private:
 
     FirmwareImage*                  _image;
 
+    FirmwareImageCache*             _firmwareCache;
+    ParallelFirmwareFlasher*        _parallelFlasher;
+    FirmwareImage*                  _multiBoardImage    = nullptr;  ///< Shared by all boards flashed by _parallelFlasher
+    QMap<QString, int>              _multiBoardProgressPercent;     ///< Last progress logged for each port
+
     QString _px4StableVersion;  // Version strange for latest PX4 stable
     QString _px4BetaVersion;    // Version strange for latest PX4 beta
 
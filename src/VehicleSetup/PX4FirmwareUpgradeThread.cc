@@ -26,6 +26,7 @@ PX4FirmwareUpgradeThreadWorker::PX4FirmwareUpgradeThreadWorker(PX4FirmwareUpgrad
 {
     connect(_controller, &PX4FirmwareUpgradeThreadController::_initThreadWorker,            this, &PX4FirmwareUpgradeThreadWorker::_init);
     connect(_controller, &PX4FirmwareUpgradeThreadController::_startFindBoardLoopOnThread,  this, &PX4FirmwareUpgradeThreadWorker::_startFindBoardLoop);
+    connect(_controller, &PX4FirmwareUpgradeThreadController::_stopFindBoardLoopOnThread,   this, &PX4FirmwareUpgradeThreadWorker::_stopFindBoardLoop);
     connect(_controller, &PX4FirmwareUpgradeThreadController::_flashOnThread,               this, &PX4FirmwareUpgradeThreadWorker::_flash);
     connect(_controller, &PX4FirmwareUpgradeThreadController::_rebootOnThread,              this, &PX4FirmwareUpgradeThreadWorker::_reboot);
     connect(_controller, &PX4FirmwareUpgradeThreadController::_cancel,                      this, &PX4FirmwareUpgradeThreadWorker::_cancel);
@@ -64,6 +65,13 @@ void PX4FirmwareUpgradeThreadWorker::_startFindBoardLoop(void)
     _findBoardOnce();
 }
 
+void PX4FirmwareUpgradeThreadWorker::_stopFindBoardLoop(void)
+{
+    _findBoardTimer->stop();
+    _foundBoard = false;
+    _cancel();
+}
+
 void PX4FirmwareUpgradeThreadWorker::_findBoardOnce(void)
 {
     qCDebug(FirmwareUpgradeVerboseLog) << "_findBoardOnce";
@@ -246,6 +254,12 @@ void PX4FirmwareUpgradeThreadController::startFindBoardLoop(void)
     emit _startFindBoardLoopOnThread();
 }
 
+void PX4FirmwareUpgradeThreadController::stopFindBoardLoop(void)
+{
+    qCDebug(FirmwareUpgradeLog) << "PX4FirmwareUpgradeThreadController::stopFindBoardLoop";
+    emit _stopFindBoardLoopOnThread();
+}
+
 void PX4FirmwareUpgradeThreadController::cancel(void)
 {
     qCDebug(FirmwareUpgradeLog) << "PX4FirmwareUpgradeThreadController::cancel";
@@ -55,6 +55,7 @@ signals:
 private slots:
     void _init              (void);
     void _startFindBoardLoop(void);
+    void _stopFindBoardLoop (void);
     void _reboot            (void);
     void _flash             (void);
     void _findBoardOnce     (void);
@@ -89,6 +90,9 @@ public:
     /// @brief Begins the process of searching for a supported board connected to any serial port. This will
     /// continue until cancelFind is called. Signals foundBoard and boardGone as boards come and go.
     void startFindBoardLoop(void);
+
+    /// @brief Stops the search started by startFindBoardLoop, closing the bootloader of a found board
+    void stopFindBoardLoop(void);
     
     void cancel(void);
     
@@ -114,6 +118,7 @@ signals:
     // Internal signals to communicate with thread worker
     void _initThreadWorker          (void);
     void _startFindBoardLoopOnThread(void);
+    void _stopFindBoardLoopOnThread (void);
     void _rebootOnThread            (void);
     void _flashOnThread             (void);
     void _cancel                    (void);
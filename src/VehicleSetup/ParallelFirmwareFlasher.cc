@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParallelFirmwareFlasher.h"
+#include "Bootloader.h"
+#include "QGCLoggingCategory.h"
+
+FirmwareFlashSession::FirmwareFlashSession(const QString& portName, bool sikRadio, const FirmwareImage* image)
+    : _portName (portName)
+    , _sikRadio (sikRadio)
+    , _image    (image)
+{
+
+}
+
+void FirmwareFlashSession::run(void)
+{
+    Bootloader bootloader(_sikRadio);
+    connect(&bootloader, &Bootloader::updateProgress, this, &FirmwareFlashSession::_updateProgress);
+
+    QString errorString;
+    bool    success = _flash(&bootloader, errorString);
+    if (!success) {
+        if (errorString.isEmpty()) {
+            errorString = bootloader.errorString();
+        }
+        qCDebug(FirmwareUpgradeLog) << "FirmwareFlashSession failed" << _portName << errorString;
+        bootloader.reboot();
+    }
+    bootloader.close();
+
+    emit finished(_portName, success, errorString);
+}
+
+bool FirmwareFlashSession::_flash(Bootloader* bootloader, QString& errorString)
+{
+    uint32_t bootloaderVersion;
+    uint32_t boardId;
+    uint32_t flashSize;
+
+    if (!bootloader->open(_portName) || !bootloader->getBoardInfo(bootloaderVersion, boardId, flashSize)) {
+        return false;
+    }
+    emit status(_portName, tr("Bootloader version %1, board id %2, flash size %3").arg(bootloaderVersion).arg(boardId).arg(flashSize));
+
+    if (_image->firmwareBoardId() != 0 && !FirmwareImage::isCompatible(boardId, _image->firmwareBoardId())) {
+        errorString = tr("Firmware board id %1 does not match board id %2").arg(_image->firmwareBoardId()).arg(boardId);
+        return false;
+    }
+    if (flashSize != 0 && _image->imageSize() > flashSize) {
+        errorString = tr("Image size of %1 is too large for board flash size %2").arg(_image->imageSize()).arg(flashSize);
+        return false;
+    }
+
+    if (!bootloader->initFlashSequence()) {
+        return false;
+    }
+    emit status(_portName, tr("Erasing previous program..."));
+    if (!bootloader->erase()) {
+        return false;
+    }
+    emit status(_portName, tr("Programming new version..."));
+    if (!bootloader->program(_image)) {
+        return false;
+    }
+    emit status(_portName, tr("Verifying program..."));
+    // Board is rebooted by verify
+    return bootloader->verify(_image);
+}
+
+ParallelFirmwareFlasher::ParallelFirmwareFlasher(QObject* parent)
+    : QObject(parent)
+{
+    _scanTimer.setInterval(_scanIntervalMsecs);
+    connect(&_scanTimer, &QTimer::timeout, this, &ParallelFirmwareFlasher::_scanPorts);
+}
+
+ParallelFirmwareFlasher::~ParallelFirmwareFlasher()
+{
+    _scanTimer.stop();
+
+    // Sessions reference the image, they can't be left running. A board can't be safely interrupted in the middle of
+    // programming either, so wait for them to complete.
+    for (QThread* thread: _sessions) {
+        thread->wait();
+    }
+}
+
+void ParallelFirmwareFlasher::start(const FirmwareImage* image, int maxParallel)
+{
+    qCDebug(FirmwareUpgradeLog) << "ParallelFirmwareFlasher::start maxParallel" << maxParallel;
+
+    _image          = image;
+    _maxParallel    = qMax(maxParallel, 1);
+    _firstScan      = true;
+    _succeededCount = 0;
+    _failedCount    = 0;
+    _connectedPorts.clear();
+    _donePorts.clear();
+    _finishedAt.clear();
+    _clock.start();
+
+    _scanPorts();
+    _scanTimer.start();
+}
+
+void ParallelFirmwareFlasher::stop(void)
+{
+    qCDebug(FirmwareUpgradeLog) << "ParallelFirmwareFlasher::stop active sessions" << _sessions.count();
+
+    _scanTimer.stop();
+    if (_sessions.isEmpty()) {
+        emit idle();
+    }
+}
+
+void ParallelFirmwareFlasher::_scanPorts(void)
+{
+    QSet<QString> connectedPorts;
+
+    for (const QGCSerialPortInfo& info: QGCSerialPortInfo::availablePorts()) {
+        if (!info.canFlash()) {
+            continue;
+        }
+
+        QString portName = info.portName();
+        connectedPorts.insert(portName);
+
+        if (_sessions.contains(portName) || _donePorts.contains(portName) || _sessions.count() >= _maxParallel) {
+            continue;
+        }
+
+        // A board which was just plugged in sits in the bootloader for a few seconds. One which was already
+        // connected is only flashed if it is still in the bootloader.
+        // A flashed board comes back on the same port after its reboot, that is not a new board.
+        bool rebooting = _finishedAt.contains(portName) && _clock.elapsed() - _finishedAt[portName] < _rebootGraceMsecs;
+        bool justPluggedIn = !_firstScan && !rebooting && !_connectedPorts.contains(portName);
+        if (justPluggedIn || info.isBootloader()) {
+            QGCSerialPortInfo::BoardType_t  boardType;
+            QString                         boardName;
+            info.getBoardInfo(boardType, boardName);
+            _startSession(info, boardType, boardName);
+        }
+    }
+
+    // Once unplugged the next board on the same port needs to be flashed as well
+    _donePorts.intersect(connectedPorts);
+    _connectedPorts = connectedPorts;
+    _firstScan = false;
+}
+
+void ParallelFirmwareFlasher::_startSession(const QGCSerialPortInfo& portInfo, QGCSerialPortInfo::BoardType_t boardType, const QString& boardName)
+{
+    QString portName = portInfo.portName();
+    qCDebug(FirmwareUpgradeLog) << "ParallelFirmwareFlasher starting session" << portName << boardName;
+
+    QThread*                thread  = new QThread(this);
+    FirmwareFlashSession*   session = new FirmwareFlashSession(portName, boardType == QGCSerialPortInfo::BoardTypeSiKRadio, _image);
+    session->moveToThread(thread);
+
+    connect(thread,     &QThread::started,                  session,    &FirmwareFlashSession::run);
+    connect(session,    &FirmwareFlashSession::status,      this,       &ParallelFirmwareFlasher::boardStatus);
+    connect(session,    &FirmwareFlashSession::progress,    this,       &ParallelFirmwareFlasher::boardProgress);
+    connect(session,    &FirmwareFlashSession::finished,    this,       &ParallelFirmwareFlasher::_sessionFinished);
+    connect(session,    &FirmwareFlashSession::finished,    thread,     &QThread::quit);
+    connect(thread,     &QThread::finished,                 session,    &QObject::deleteLater);
+    connect(thread,     &QThread::finished,                 thread,     &QObject::deleteLater);
+
+    _sessions[portName] = thread;
+    emit boardStarted(portName, boardName);
+    thread->start();
+}
+
+void ParallelFirmwareFlasher::_sessionFinished(const QString& portName, bool success, const QString& errorString)
+{
+    _sessions.remove(portName);
+    _donePorts.insert(portName);
+    _finishedAt[portName] = _clock.elapsed();
+    if (success) {
+        _succeededCount++;
+    } else {
+        _failedCount++;
+    }
+    emit boardFinished(portName, success, errorString);
+
+    if (!running() && _sessions.isEmpty()) {
+        emit idle();
+    }
+}
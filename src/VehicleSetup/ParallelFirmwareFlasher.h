@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FirmwareImage.h"
+#include "QGCSerialPortInfo.h"
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMap>
+#include <QSet>
+#include <QElapsedTimer>
+
+class Bootloader;
+
+/// @brief Runs a complete bootloader session (board info, erase, program, verify, reboot) for one board. Lives on its
+///         own thread, created by ParallelFirmwareFlasher.
+class FirmwareFlashSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    FirmwareFlashSession(const QString& portName, bool sikRadio, const FirmwareImage* image);
+
+signals:
+    void status     (const QString& portName, const QString& statusText);
+    void progress   (const QString& portName, int curr, int total);
+    void finished   (const QString& portName, bool success, const QString& errorString);
+
+public slots:
+    void run(void);
+
+private slots:
+    void _updateProgress(int curr, int total) { emit progress(_portName, curr, total); }
+
+private:
+    bool _flash(Bootloader* bootloader, QString& errorString);
+
+    QString                 _portName;
+    bool                    _sikRadio;
+    const FirmwareImage*    _image;
+};
+
+/// @brief Flashes the same firmware image to every board which is plugged in while it is running. Each board gets its
+///         own FirmwareFlashSession on a separate thread so boards are programmed in parallel. The image is loaded once
+///         by the caller and shared read only between all sessions.
+class ParallelFirmwareFlasher : public QObject
+{
+    Q_OBJECT
+
+public:
+    ParallelFirmwareFlasher(QObject* parent = nullptr);
+    ~ParallelFirmwareFlasher();
+
+    /// Starts watching the serial ports for boards to flash. Boards which are already connected when this is called
+    /// are skipped unless they are sitting in the bootloader, the others need to be unplugged and plugged back in.
+    ///     @param image Loaded image, must stay valid until idle() is signalled after stop()
+    ///     @param maxParallel Maximum number of boards which are flashed at the same time
+    void start  (const FirmwareImage* image, int maxParallel = _defaultMaxParallel);
+
+    /// Stops looking for new boards. Sessions which are already running are allowed to complete.
+    void stop   (void);
+
+    bool    running         (void) const { return _scanTimer.isActive(); }
+    int     activeCount     (void) const { return _sessions.count(); }
+    int     succeededCount  (void) const { return _succeededCount; }
+    int     failedCount     (void) const { return _failedCount; }
+
+signals:
+    void boardStarted   (const QString& portName, const QString& boardName);
+    void boardStatus    (const QString& portName, const QString& statusText);
+    void boardProgress  (const QString& portName, int curr, int total);
+    void boardFinished  (const QString& portName, bool success, const QString& errorString);
+    void idle           (void); ///< Stopped and all sessions are complete
+
+private slots:
+    void _scanPorts         (void);
+    void _sessionFinished   (const QString& portName, bool success, const QString& errorString);
+
+private:
+    void _startSession(const QGCSerialPortInfo& portInfo, QGCSerialPortInfo::BoardType_t boardType, const QString& boardName);
+
+    const FirmwareImage*        _image              = nullptr;
+    int                         _maxParallel        = _defaultMaxParallel;
+    QTimer                      _scanTimer;
+    bool                        _firstScan          = true;
+    QSet<QString>               _connectedPorts;    ///< Flashable ports seen on the previous scan
+    QSet<QString>               _donePorts;         ///< Flashed (or failed) boards which have not been unplugged yet
+    QMap<QString, QThread*>     _sessions;          ///< Running sessions by port name
+    QMap<QString, qint64>       _finishedAt;        ///< _clock time each port last completed a session
+    QElapsedTimer               _clock;
+    int                         _succeededCount     = 0;
+    int                         _failedCount        = 0;
+
+    static const int _defaultMaxParallel    = 8;
+    static const int _scanIntervalMsecs     = 250;  ///< The bootloader only waits a few seconds after power up
+    static const int _rebootGraceMsecs      = 10000;
+};
@@ -21,23 +21,38 @@
 #include "HorizontalFactValueGrid.h"
 #include "InstrumentValueData.h"
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QString>
 #include <QDate>
 
 QGC_LOGGING_CATEGORY(SubtitleWriterLog, "SubtitleWriterLog")
 
-const int SubtitleWriter::_sampleRate = 1; // Sample rate in Hz for getting telemetry data, most players do weird stuff when > 1Hz
+const int SubtitleWriter::_defaultSampleRate    = 1;
+const int SubtitleWriter::_maxSampleRate        = 10;
+const int SubtitleWriter::_flushSecs            = 5;
+
+static const int nRows = 3; // number of rows used for displaying data
+static const int offsetFactor = 700; // Used to simulate a larger resolution and reduce the borders in the layout
 
 SubtitleWriter::SubtitleWriter(QObject* parent)
     : QObject(parent)
 {
-    connect(&_timer, &QTimer::timeout, this, &SubtitleWriter::_captureTelemetry);
+
 }
 
-void SubtitleWriter::startCapturingTelemetry(const QString& videoFile)
+SubtitleWriter::~SubtitleWriter()
 {
+    stopCapturingTelemetry();
+}
+
+void SubtitleWriter::startCapturingTelemetry(const QString& videoFile, int sampleRate)
+{
+    stopCapturingTelemetry();
+
     // Delete facts of last run
     _facts.clear();
+    _factInfo.clear();
+    _columnNames.clear();
 
     // Gather the facts currently displayed into _facts
     FactValueGrid* grid = new FactValueGrid();
@@ -48,17 +63,43 @@ void SubtitleWriter::startCapturingTelemetry(const QString& videoFile)
         QmlObjectListModel* list = grid->columns()->value<QmlObjectListModel*>(colIndex);
         for (int rowIndex = 0; rowIndex < list->count(); rowIndex++) {
             InstrumentValueData* value = list->value<InstrumentValueData*>(rowIndex);
-            _facts += value->fact();
+            if (value->fact()) {
+                _facts += value->fact();
+            }
         }
     }
     grid->deleteLater();
 
+    // Names, units and formatting don't change, so they are prepared once here instead of every entry
+    QStringList namesStrings;
+    for (const Fact* fact : _facts) {
+        FactInfo_t info;
+        info.name           = QStringLiteral("%1:").arg(fact->shortDescription());
+        info.units          = fact->cookedUnits();
+        info.numeric        = fact->type() == FactMetaData::valueTypeFloat || fact->type() == FactMetaData::valueTypeDouble;
+        info.decimalPlaces  = fact->decimalPlaces();
+        _factInfo.append(info);
+        namesStrings << info.name;
+    }
+
+    _valuesByColumn = static_cast<int>(ceil(_facts.length() / static_cast<double>(nRows)));
+    for (int i=0; i<nRows; i++) {
+        _columnNames.append(namesStrings.mid(i*_valuesByColumn, _valuesByColumn).join("\\N"));
+    }
+
+    _values.fill(FactValue_t(), _facts.count());
+    for (int i=0; i<_facts.count(); i++) {
+        _updateValue(i);
+        connect(_facts[i], &Fact::valueChanged, this, [this, i]() { _updateValue(i); });
+    }
+
     // One subtitle always starts where the previous ended
     _lastEndTime = QTime(0, 0);
+    _sampleRate = qBound(1, sampleRate, _maxSampleRate);
 
     QFileInfo videoFileInfo(videoFile);
     QString subtitleFilePath = QStringLiteral("%1/%2.ass").arg(videoFileInfo.path(), videoFileInfo.completeBaseName());
-    qCDebug(SubtitleWriterLog) << "Writing overlay to file:" << subtitleFilePath;
+    qCDebug(SubtitleWriterLog) << "Writing overlay to file:" << subtitleFilePath << _sampleRate << "Hz";
     _file.setFileName(subtitleFilePath);
 
     if (!_file.open(QIODevice::ReadWrite)) {
@@ -90,86 +131,148 @@ void SubtitleWriter::startCapturingTelemetry(const QString& videoFile)
     // TODO: Find a good way to input title
     //stream << QStringLiteral("Dialogue: 0,0:00:00.00,999:00:00.00,Default,,0,0,0,,{\\pos(5,35)}%1\n");
 
-    _timer.start(1000/_sampleRate);
+    stream.flush();
+
+    _stopCapture = false;
+    _captureThread = QThread::create([this]() { _captureLoop(); });
+    _captureThread->setObjectName(QStringLiteral("SubtitleWriter"));
+    _captureThread->start(QThread::LowPriority);
 }
 
 void SubtitleWriter::stopCapturingTelemetry()
 {
-    qCDebug(SubtitleWriterLog) << "Stopping writing";
-    _timer.stop();
-    _file.close();
+    for (Fact* fact : _facts) {
+        disconnect(fact, &Fact::valueChanged, this, nullptr);
+    }
+
+    if (_captureThread) {
+        qCDebug(SubtitleWriterLog) << "Stopping writing";
+        _captureLock.lock();
+        _stopCapture = true;
+        _captureWake.wakeAll();
+        _captureLock.unlock();
+        _captureThread->wait();
+        delete _captureThread;
+        _captureThread = nullptr;
+    }
+
+    if (_file.isOpen()) {
+        _file.close();
+    }
 }
 
-void SubtitleWriter::_captureTelemetry()
+/// Called on the GUI thread when a fact changes
+void SubtitleWriter::_updateValue(int index)
 {
-    static const float nRows = 3; // number of rows used for displaying data
-    static const int offsetFactor = 700; // Used to simulate a larger resolution and reduce the borders in the layout
+    const Fact* fact = _facts[index];
+
+    FactValue_t value;
+    if (_factInfo[index].numeric) {
+        value.value = fact->cookedValue().toDouble();
+    } else {
+        value.text  = fact->cookedValueString();
+    }
 
-    auto *vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    QMutexLocker lock(&_valuesLock);
+    _values[index] = value;
+}
 
-    if (!vehicle) {
-        qCWarning(SubtitleWriterLog) << "Attempting to capture fact data with no active vehicle!";
-        return;
+/// Runs on the capture thread until stopCapturingTelemetry is called. Entry times follow the elapsed time since the
+/// start of the recording, so subtitles stay in sync even if a capture runs late.
+void SubtitleWriter::_captureLoop(void)
+{
+    const int intervalMSecs = 1000 / _sampleRate;
+    const int entriesPerBlock = _sampleRate * _flushSecs;
+
+    QElapsedTimer   clock;
+    QString         block;
+    int             blockEntries        = 0;
+    qint64          nextCaptureMSecs    = 0;
+
+    clock.start();
+
+    _captureLock.lock();
+    while (!_stopCapture) {
+        const qint64 waitMSecs = nextCaptureMSecs - clock.elapsed();
+        if (waitMSecs > 0) {
+            _captureWake.wait(&_captureLock, static_cast<unsigned long>(waitMSecs));
+            continue;
+        }
+        _captureLock.unlock();
+
+        nextCaptureMSecs = qMax(nextCaptureMSecs + intervalMSecs, clock.elapsed());
+
+        // The time to start displaying this subtitle text
+        QTime start = _lastEndTime;
+
+        // The time to stop displaying this subtitle text
+        QTime end = QTime(0, 0).addMSecs(static_cast<int>(nextCaptureMSecs));
+        _lastEndTime = end;
+
+        _appendEntry(block, start, end);
+
+        if (++blockEntries >= entriesPerBlock) {
+            _file.write(block.toUtf8());
+            _file.flush();
+            block.clear();
+            blockEntries = 0;
+        }
+
+        _captureLock.lock();
     }
-    // Each list corresponds to a column in the subtitles
-    QStringList namesStrings;
-    QStringList valuesStrings;
+    _captureLock.unlock();
 
-    // Make a list of "factname:" strings and other with the values, so one can be aligned left and the other right
-    for (const Fact* fact : _facts) {
-        valuesStrings << QStringLiteral("%2 %3").arg(fact->cookedValueString())
-                                                .arg(fact->cookedUnits());
-        namesStrings << QStringLiteral("%1:").arg(fact->shortDescription());
+    _file.write(block.toUtf8());
+    _file.flush();
+}
+
+void SubtitleWriter::_appendEntry(QString& block, const QTime& start, const QTime& end)
+{
+    QVector<FactValue_t> values;
+    {
+        QMutexLocker lock(&_valuesLock);
+        values = _values;
     }
 
-    // The time to start displaying this subtitle text
-    QTime start = _lastEndTime;
+    // Make a list of value strings, so names can be aligned left and values right
+    QStringList valuesStrings;
+    for (int i=0; i<values.count(); i++) {
+        const FactInfo_t& info = _factInfo[i];
+        QString valueString;
+        if (!info.numeric) {
+            valueString = values[i].text;
+        } else if (qIsNaN(values[i].value)) {
+            valueString = QStringLiteral("--.--");
+        } else {
+            valueString = QString::number(values[i].value, 'f', info.decimalPlaces);
+        }
+        valuesStrings << QStringLiteral("%1 %2").arg(valueString, info.units);
+    }
 
-    // The time to stop displaying this subtitle text
-    QTime end = start.addMSecs(1000/_sampleRate);
-    _lastEndTime = end;
+    const QString startString   = start.toString("H:mm:ss.zzz").chopped(2);
+    const QString endString     = end.toString("H:mm:ss.zzz").chopped(2);
 
     // This splits the screen in N parts and uses the N-1 internal parts to align the subtitles to.
     // Should we try to get the resolution from the pipeline? This seems to work fine with other resolutions too.
     static const int rowWidth = (1920 + offsetFactor)/(nRows+1);
-    int nValuesByRow = ceil(_facts.length() / nRows);
-
-    QList<QStringList> dataColumns;
-    QStringList stringColumns;
 
     // These templates are used for the data columns, one right-aligned for names and one for
-    // the facts values. The arguments expected are: start time, end time, xposition, and string content.
-    QString namesLine = QStringLiteral("Dialogue: 0,%2,%3,Default,,0,0,0,,{\\an3\\pos(%1,1075)}%4\n");
-    QString valuesLine = QStringLiteral("Dialogue: 0,%2,%3,Default,,0,0,0,,{\\pos(%1,1075)}%4\n");
+    // the facts values. The arguments expected are: xposition, start time, end time, and string content.
+    static const QString namesLine = QStringLiteral("Dialogue: 0,%2,%3,Default,,0,0,0,,{\\an3\\pos(%1,1075)}%4\n");
+    static const QString valuesLine = QStringLiteral("Dialogue: 0,%2,%3,Default,,0,0,0,,{\\pos(%1,1075)}%4\n");
 
     // Split values into N columns and create a subtitle entry for each column
     for (int i=0; i<nRows; i++) {
-        QStringList currentColumnNameStrings = namesStrings.mid((i)*nValuesByRow, nValuesByRow);
-        QStringList currentColumnValueStrings = valuesStrings.mid((i)*nValuesByRow, nValuesByRow);
-
         // Fill templates for names of column i
-        QString names = namesLine.arg(-offsetFactor/2 + rowWidth*(i+1) - 10)
-                                 .arg(start.toString("H:mm:ss.zzz").chopped(2))
-                                 .arg(end.toString("H:mm:ss.zzz").chopped(2))
-                                 .arg(currentColumnNameStrings.join("\\N"));
-        stringColumns << names;
+        block += namesLine.arg(-offsetFactor/2 + rowWidth*(i+1) - 10)
+                          .arg(startString, endString, _columnNames[i]);
 
         // Fill templates for values of column i
-        QString values = valuesLine.arg(-offsetFactor/2 +rowWidth*(i+1))
-                                   .arg(start.toString("H:mm:ss.zzz").chopped(2))
-                                   .arg(end.toString("H:mm:ss.zzz").chopped(2))
-                                   .arg(currentColumnValueStrings.join("\\N"));
-        stringColumns << values;
+        block += valuesLine.arg(-offsetFactor/2 + rowWidth*(i+1))
+                           .arg(startString, endString, valuesStrings.mid(i*_valuesByColumn, _valuesByColumn).join("\\N"));
     }
 
     // Write the date to the corner
-    stringColumns << QStringLiteral("Dialogue: 0,%1,%2,Default,,0,0,0,,{\\pos(10,35)}%3\n")
-        .arg(start.toString("H:mm:ss.zzz").chopped(2))
-        .arg(end.toString("H:mm:ss.zzz").chopped(2))
-        .arg(QDateTime::currentDateTime().toString(QLocale::system().dateFormat(QLocale::ShortFormat)));
-    // Write new data
-    QTextStream stream(&_file);
-    for (const auto& i : stringColumns) {
-        stream << i;
-    }
+    block += QStringLiteral("Dialogue: 0,%1,%2,Default,,0,0,0,,{\\pos(10,35)}%3\n")
+        .arg(startString, endString, QDateTime::currentDateTime().toString(QLocale::system().dateFormat(QLocale::ShortFormat)));
 }
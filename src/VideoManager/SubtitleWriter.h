@@ -19,33 +19,68 @@
 #include "QGCLoggingCategory.h"
 #include "Fact.h"
 #include <QObject>
-#include <QTimer>
 #include <QDateTime>
 #include <QFile>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
 
 Q_DECLARE_LOGGING_CATEGORY(SubtitleWriterLog)
 
+/// Writes the telemetry bar values to a subtitle file next to a video recording.
+///
+/// Fact values are copied into a typed snapshot as they change. A capture thread formats an entry from the latest
+/// snapshot at the sample rate and writes the file in blocks, so capturing does no work on the GUI thread.
 class SubtitleWriter : public QObject
 {
     Q_OBJECT
 
 public:
     explicit SubtitleWriter(QObject* parent = nullptr);
-    ~SubtitleWriter() = default;
+    ~SubtitleWriter();
 
     // starts capturing vehicle telemetry.
-    void startCapturingTelemetry(const QString& videoFile);
+    //      sampleRate: entries per second, clamped to 1.._maxSampleRate
+    void startCapturingTelemetry(const QString& videoFile, int sampleRate = _defaultSampleRate);
     void stopCapturingTelemetry();
 
-private slots:
-    // Captures a snapshot of telemetry data from vehicle into the subtitles file.
-    void _captureTelemetry();
-
 private:
-    QTimer _timer;
-    QList<Fact*> _facts;
-    QTime _lastEndTime;
-    QFile _file;
+    // Fact properties which don't change while capturing
+    typedef struct {
+        QString name;
+        QString units;
+        bool    numeric;            ///< float/double, formatted by the capture thread
+        int     decimalPlaces;
+    } FactInfo_t;
+
+    // Latest value of a fact
+    typedef struct {
+        double  value;
+        QString text;               ///< Value string for non numeric facts
+    } FactValue_t;
+
+    void _updateValue   (int index);
+    void _captureLoop   (void);
+    void _appendEntry   (QString& block, const QTime& start, const QTime& end);
+
+    QList<Fact*>            _facts;
+    QVector<FactInfo_t>     _factInfo;
+    QVector<QString>        _columnNames;       ///< Joined names for each subtitle column
+    int                     _valuesByColumn = 0;
+    QTime                   _lastEndTime;
+    QFile                   _file;
+    int                     _sampleRate     = _defaultSampleRate;
+
+    QMutex                  _valuesLock;
+    QVector<FactValue_t>    _values;
+
+    QThread*                _captureThread  = nullptr;
+    QMutex                  _captureLock;
+    QWaitCondition          _captureWake;
+    bool                    _stopCapture    = false;
 
-    static const int _sampleRate; // Sample rate in Hz for getting telemetry data, most players do weird stuff when > 1Hz
+    static const int _defaultSampleRate;    // Sample rate in Hz for getting telemetry data, most players do weird stuff when > 1Hz
+    static const int _maxSampleRate;
+    static const int _flushSecs;            // Entries are written to the file in blocks covering this many seconds
 };
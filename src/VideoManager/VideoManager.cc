@@ -28,6 +28,8 @@
 #include "Settings/SettingsManager.h"
 #include "Vehicle.h"
 #include "QGCCameraManager.h"
+#include "VideoSyncIndex.h"
+#include "QGCMemoryAccounting.h"
 
 #if defined(QGC_GST_STREAMING)
 #include "GStreamer.h"
@@ -102,8 +104,10 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    connect(_videoSettings->tcpUrl(),        &Fact::rawValueChanged, this, &VideoManager::_tcpUrlChanged);
    connect(_videoSettings->aspectRatio(),   &Fact::rawValueChanged, this, &VideoManager::_aspectRatioChanged);
    connect(_videoSettings->lowLatencyMode(),&Fact::rawValueChanged, this, &VideoManager::_lowLatencyModeChanged);
+   connect(_videoSettings->warmRestart(),   &Fact::rawValueChanged, this, &VideoManager::_warmRestartChanged);
    MultiVehicleManager *pVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
    connect(pVehicleMgr, &MultiVehicleManager::activeVehicleChanged, this, &VideoManager::_setActiveVehicle);
+   _qualityController = new VideoQualityController(_videoSettings, this);
 
 #if defined(QGC_GST_STREAMING)
     GStreamer::blacklist(static_cast<VideoSettings::VideoDecoderOptions>(_videoSettings->forceVideoDecoder()->rawValue().toInt()));
@@ -127,7 +131,7 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         qCDebug(VideoManagerLog) << "Video 0 Start complete, status: " << status;
         if (status == VideoReceiver::STATUS_OK) {
             _videoStarted[0] = true;
-            if (_videoSink[0] != nullptr) {
+            if (_videoSink[0] != nullptr && _streamVisibility[0] != StreamHidden) {
                 qCDebug(VideoManagerLog) << "Video 0 start decoding";
                 // It is absolutely ok to have video receiver active (streaming) and decoding not active
                 // It should be handy for cases when you have many streams and want to show only some of them
@@ -170,7 +174,7 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
 
     connect(_videoReceiver[0], &VideoReceiver::recordingStarted, this, [this](){
         qCDebug(VideoManagerLog) << "Video 0 recording started";
-        _subtitleWriter.startCapturingTelemetry(_videoFile);
+        _subtitleWriter.startCapturingTelemetry(_videoFile, _videoSettings->subtitleSampleRate()->rawValue().toInt());
     });
 
     connect(_videoReceiver[0], &VideoReceiver::videoSizeChanged, this, [this](QSize size){
@@ -179,10 +183,29 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         emit videoSizeChanged();
     });
 
-    //connect(_videoReceiver, &VideoReceiver::onTakeScreenshotComplete, this, [this](VideoReceiver::STATUS status){
-    //    if (status == VideoReceiver::STATUS_OK) {
-    //    }
-    //});
+    connect(_videoReceiver[0], &VideoReceiver::decodeTimingChanged, this, [this](double decodeMSecs, double uploadMSecs, bool zeroCopy){
+        _decodeMSecs    = decodeMSecs;
+        _uploadMSecs    = uploadMSecs;
+        _zeroCopyDecode = zeroCopy;
+        emit decodeTimingChanged();
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::latencyStatsChanged, this, [this](QVariantMap stats){
+        _latencyStats = stats;
+        emit latencyStatsChanged();
+        _qualityController->receiverStats(stats);
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::streamRecovered, this, [this](double firstFrameMSecs){
+        qCDebug(VideoManagerLog) << "Video 0 recovered from dropout, first frame after" << firstFrameMSecs << "ms";
+        _recoveryMSecs = firstFrameMSecs;
+        emit recoveryMSecsChanged();
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::onTakeScreenshotComplete, this, [this](VideoReceiver::STATUS status, QString imageFile){
+        qCDebug(VideoManagerLog) << "Video 0 screenshot complete" << status << imageFile;
+        emit imageSaved(imageFile, status == VideoReceiver::STATUS_OK);
+    });
 
     // FIXME: AV: I believe _thermalVideoReceiver should be handled just like _videoReceiver in terms of event
     // and I expect that it will be changed during multiple video stream activity
@@ -190,7 +213,7 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         connect(_videoReceiver[1], &VideoReceiver::onStartComplete, this, [this](VideoReceiver::STATUS status) {
             if (status == VideoReceiver::STATUS_OK) {
                 _videoStarted[1] = true;
-                if (_videoSink[1] != nullptr) {
+                if (_videoSink[1] != nullptr && _streamVisibility[1] != StreamHidden) {
                     _videoReceiver[1]->startDecoding(_videoSink[1]);
                 }
             } else if (status == VideoReceiver::STATUS_INVALID_URL) {
@@ -207,6 +230,18 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
             _startReceiver(1);
         });
     }
+
+    for (unsigned i = 0; i < 2; i++) {
+        if (_videoReceiver[i] != nullptr) {
+            connect(_videoReceiver[i], &VideoReceiver::bufferedBytesChanged, this, [this, i](qint64 bytes){
+                _bufferedBytes[i] = bytes;
+            });
+            connect(_videoReceiver[i], &VideoReceiver::onStopComplete, this, [this, i](VideoReceiver::STATUS){
+                _bufferedBytes[i] = 0;
+            });
+        }
+    }
+    toolbox->memoryAccounting()->addSource(this, QStringLiteral("Video"), [this](){ return _bufferedBytes[0] + _bufferedBytes[1]; });
 #endif
     _updateSettings(0);
     _updateSettings(1);
@@ -254,6 +289,7 @@ void VideoManager::_cleanupOldVideos()
             qCDebug(VideoManagerLog) << "Removing old video file:" << vidList.last().filePath();
             QFile file (vidList.last().filePath());
             file.remove();
+            QFile::remove(VideoSyncIndex::indexFilename(vidList.last().filePath()));
             vidList.removeLast();
         }
     }
@@ -325,11 +361,13 @@ VideoManager::startRecording(const QString& videoFile)
     QString videoFile2 = _videoFile + "2." + ext;
     _videoFile += ext;
 
+    const unsigned segmentMinutes = _videoSettings->recordingSegmentLength()->rawValue().toUInt();
+
     if (_videoReceiver[0] && _videoStarted[0]) {
-        _videoReceiver[0]->startRecording(_videoFile, fileFormat);
+        _videoReceiver[0]->startRecording(_videoFile, fileFormat, segmentMinutes);
     }
     if (_videoReceiver[1] && _videoStarted[1]) {
-        _videoReceiver[1]->startRecording(videoFile2, fileFormat);
+        _videoReceiver[1]->startRecording(videoFile2, fileFormat, segmentMinutes);
     }
 
 #else
@@ -379,6 +417,39 @@ VideoManager::grabImage(const QString& imageFile)
 #endif
 }
 
+void
+VideoManager::setStreamVisibility(int id, StreamVisibility visibility)
+{
+    if (id < 0 || id > 1) {
+        qCDebug(VideoManagerLog) << "Unsupported receiver id" << id;
+        return;
+    }
+    if (_streamVisibility[id] == visibility) {
+        return;
+    }
+
+    qCDebug(VideoManagerLog) << "Stream visibility" << id << visibility;
+
+    StreamVisibility oldVisibility = _streamVisibility[id];
+    _streamVisibility[id] = visibility;
+
+#if defined(QGC_GST_STREAMING)
+    if (_videoReceiver[id] == nullptr) {
+        return;
+    }
+
+    _videoReceiver[id]->setDecodePriority(visibility == StreamVisible ? VideoReceiver::DECODE_PRIORITY_NORMAL : VideoReceiver::DECODE_PRIORITY_LOW);
+
+    if (visibility == StreamHidden) {
+        _videoReceiver[id]->stopDecoding();
+    } else if (oldVisibility == StreamHidden && _videoStarted[id] && _videoSink[id] != nullptr) {
+        _videoReceiver[id]->startDecoding(_videoSink[id]);
+    }
+#else
+    Q_UNUSED(oldVisibility)
+#endif
+}
+
 //-----------------------------------------------------------------------------
 double VideoManager::aspectRatio()
 {
@@ -540,6 +611,22 @@ VideoManager::_lowLatencyModeChanged()
     _restartAllVideos();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::_warmRestartChanged()
+{
+#if defined(QGC_GST_STREAMING)
+    // Only affects how the next dropout is handled, running streams are left alone
+    const bool warmRestart = _videoSettings->warmRestart()->rawValue().toBool();
+
+    for (int i = 0; i < 2; i++) {
+        if (_videoReceiver[i] != nullptr) {
+            _videoReceiver[i]->setWarmRestart(warmRestart);
+        }
+    }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 bool
 VideoManager::hasVideo()
@@ -623,7 +710,7 @@ VideoManager::_initVideo()
     if (widget != nullptr && _videoReceiver[0] != nullptr) {
         _videoSink[0] = qgcApp()->toolbox()->corePlugin()->createVideoSink(this, widget);
         if (_videoSink[0] != nullptr) {
-            if (_videoStarted[0]) {
+            if (_videoStarted[0] && _streamVisibility[0] != StreamHidden) {
                 _videoReceiver[0]->startDecoding(_videoSink[0]);
             }
         } else {
@@ -638,7 +725,7 @@ VideoManager::_initVideo()
     if (widget != nullptr && _videoReceiver[1] != nullptr) {
         _videoSink[1] = qgcApp()->toolbox()->corePlugin()->createVideoSink(this, widget);
         if (_videoSink[1] != nullptr) {
-            if (_videoStarted[1]) {
+            if (_videoStarted[1] && _streamVisibility[1] != StreamHidden) {
                 _videoReceiver[1]->startDecoding(_videoSink[1]);
             }
         } else {
@@ -841,6 +928,7 @@ VideoManager::_startReceiver(unsigned id)
         qCDebug(VideoManagerLog) << "Unsupported receiver id" << id;
     } else if (_videoReceiver[id] != nullptr/* && _videoSink[id] != nullptr*/) {
         if (!_videoUri[id].isEmpty()) {
+            _videoReceiver[id]->setWarmRestart(_videoSettings->warmRestart()->rawValue().toBool());
             _videoReceiver[id]->start(_videoUri[id], timeout, _lowLatencyStreaming[id] ? -1 : 0);
         }
     }
@@ -879,6 +967,9 @@ VideoManager::_setActiveVehicle(Vehicle* vehicle)
         }
     }
     _activeVehicle = vehicle;
+    if(_qualityController) {
+        _qualityController->setVehicle(_activeVehicle);
+    }
     if(_activeVehicle) {
         connect(_activeVehicle->vehicleLinkManager(), &VehicleLinkManager::communicationLostChanged, this, &VideoManager::_communicationLostChanged);
         if(_activeVehicle->cameraManager()) {
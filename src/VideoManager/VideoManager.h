@@ -21,6 +21,7 @@
 #include "VideoReceiver.h"
 #include "QGCToolbox.h"
 #include "SubtitleWriter.h"
+#include "VideoQualityController.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VideoManagerLog)
 
@@ -36,6 +37,13 @@ public:
     VideoManager    (QGCApplication* app, QGCToolbox* toolbox);
     virtual ~VideoManager   ();
 
+    typedef enum {
+        StreamVisible = 0,      ///< Shown in focus, every frame is decoded
+        StreamBackground,       ///< Shown but not in focus (e.g. picture in picture), keyframes only
+        StreamHidden            ///< Not shown, decoding stopped
+    } StreamVisibility;
+    Q_ENUM(StreamVisibility)
+
     Q_PROPERTY(bool             hasVideo                READ    hasVideo                                    NOTIFY hasVideoChanged)
     Q_PROPERTY(bool             isGStreamer             READ    isGStreamer                                 NOTIFY isGStreamerChanged)
     Q_PROPERTY(bool             isUvc                   READ    isUvc                                       NOTIFY isUvcChanged)
@@ -56,6 +64,11 @@ public:
     Q_PROPERTY(bool             decoding                READ    decoding                                    NOTIFY decodingChanged)
     Q_PROPERTY(bool             recording               READ    recording                                   NOTIFY recordingChanged)
     Q_PROPERTY(QSize            videoSize               READ    videoSize                                   NOTIFY videoSizeChanged)
+    Q_PROPERTY(double           decodeMSecs             READ    decodeMSecs                                 NOTIFY decodeTimingChanged)
+    Q_PROPERTY(double           uploadMSecs             READ    uploadMSecs                                 NOTIFY decodeTimingChanged)
+    Q_PROPERTY(bool             zeroCopyDecode          READ    zeroCopyDecode                              NOTIFY decodeTimingChanged)
+    Q_PROPERTY(QVariantMap      latencyStats            READ    latencyStats                                NOTIFY latencyStatsChanged)
+    Q_PROPERTY(double           recoveryMSecs           READ    recoveryMSecs                               NOTIFY recoveryMSecsChanged)
 
     virtual bool        hasVideo            ();
     virtual bool        isGStreamer         ();
@@ -88,6 +101,16 @@ public:
         return QSize((size >> 16) & 0xFFFF, size & 0xFFFF);
     }
 
+    double  decodeMSecs     (void) const { return _decodeMSecs; }
+    double  uploadMSecs     (void) const { return _uploadMSecs; }
+    bool    zeroCopyDecode  (void) const { return _zeroCopyDecode; }
+
+    /// Per stage latency of the primary stream over the last second, see VideoReceiver::latencyStatsChanged
+    QVariantMap latencyStats(void) const { return _latencyStats; }
+
+    /// Time to the first frame after the last warm restart of the primary stream, 0 if there was none
+    double recoveryMSecs(void) const { return _recoveryMSecs; }
+
 // FIXME: AV: they should be removed after finishing multiple video stream support
 // new arcitecture does not assume direct access to video receiver from QML side, even if it works for now
     virtual VideoReceiver*  videoReceiver           () { return _videoReceiver[0]; }
@@ -113,6 +136,10 @@ public:
 
     Q_INVOKABLE void grabImage(const QString& imageFile = QString());
 
+    /// Matches decoding cost to what is on screen. Streaming and recording continue regardless of visibility.
+    ///     @param id 0: primary stream, 1: thermal stream
+    Q_INVOKABLE void setStreamVisibility(int id, StreamVisibility visibility);
+
 signals:
     void hasVideoChanged            ();
     void isGStreamerChanged         ();
@@ -124,11 +151,15 @@ signals:
     void aspectRatioChanged         ();
     void autoStreamConfiguredChanged();
     void imageFileChanged           ();
+    void imageSaved                 (QString imageFile, bool success);   ///< One for each grabImage, in the order they complete
     void streamingChanged           ();
     void decodingChanged            ();
     void recordingChanged           ();
     void recordingStarted           ();
     void videoSizeChanged           ();
+    void decodeTimingChanged        ();
+    void latencyStatsChanged        ();
+    void recoveryMSecsChanged       ();
 
 protected slots:
     void _videoSourceChanged        ();
@@ -136,6 +167,7 @@ protected slots:
     void _rtspUrlChanged            ();
     void _tcpUrlChanged             ();
     void _lowLatencyModeChanged     ();
+    void _warmRestartChanged        ();
     void _updateUVC                 ();
     void _setActiveVehicle          (Vehicle* vehicle);
     void _aspectRatioChanged        ();
@@ -168,14 +200,22 @@ protected:
     // It works for now but...
     bool                    _videoStarted[2]        = { false, false };
     bool                    _lowLatencyStreaming[2] = { false, false };
+    StreamVisibility        _streamVisibility[2]    = { StreamVisible, StreamVisible };
     QAtomicInteger<bool>    _streaming              = false;
     QAtomicInteger<bool>    _decoding               = false;
     QAtomicInteger<bool>    _recording              = false;
     QAtomicInteger<quint32> _videoSize              = 0;
+    double                  _decodeMSecs            = 0;
+    double                  _uploadMSecs            = 0;
+    bool                    _zeroCopyDecode         = false;
+    QVariantMap             _latencyStats;
+    double                  _recoveryMSecs          = 0;
+    qint64                  _bufferedBytes[2]       = { 0, 0 };
     VideoSettings*          _videoSettings          = nullptr;
     QString                 _uvcVideoSourceID;
     bool                    _fullScreen             = false;
     Vehicle*                _activeVehicle          = nullptr;
+    VideoQualityController* _qualityController      = nullptr;
 };
 
 #endif
@@ -0,0 +1,244 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoQualityController.h"
+#include "VideoSettings.h"
+#include "Vehicle.h"
+#include "QGCCameraManager.h"
+#include "QGCCameraControl.h"
+
+#include <QRegularExpression>
+
+QGC_LOGGING_CATEGORY(VideoQualityControllerLog, "VideoQualityControllerLog")
+
+//-----------------------------------------------------------------------------
+VideoQualityController::VideoQualityController(VideoSettings* videoSettings, QObject* parent)
+    : QObject       (parent)
+    , _videoSettings(videoSettings)
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoQualityController::setVehicle(Vehicle* vehicle)
+{
+    if (_vehicle != vehicle) {
+        _vehicle = vehicle;
+        _reset();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoQualityController::_reset(void)
+{
+    _unhealthySeconds = 0;
+    _healthySeconds   = 0;
+    _lastCamera.clear();
+    _baselineBitrate.clear();
+    _baselineResolution.clear();
+    _lastSetBitrate.clear();
+    _lastSetResolution.clear();
+    _lastChange.invalidate();
+}
+
+//-----------------------------------------------------------------------------
+QGCCameraControl*
+VideoQualityController::_camera(void)
+{
+    if (!_vehicle || !_vehicle->cameraManager()) {
+        return nullptr;
+    }
+    return _vehicle->cameraManager()->currentCameraInstance();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoQualityController::receiverStats(const QVariantMap& stats)
+{
+    // Cumulative on the receiver side, late and lost packets together
+    const qulonglong jitterBufferLost = stats["jitterBufferLost"].toULongLong();
+    const qulonglong newLost          = jitterBufferLost >= _lastJitterBufferLost ? jitterBufferLost - _lastJitterBufferLost : 0;
+    _lastJitterBufferLost = jitterBufferLost;
+
+    QGCCameraControl* camera = _camera();
+    if (!camera) {
+        _unhealthySeconds = _healthySeconds = 0;
+        return;
+    }
+    if (!_videoSettings->adaptiveVideoQuality()->rawValue().toBool()) {
+        // Switched off while stepped down, give the user back what they selected
+        if (camera == _lastCamera) {
+            _restoreBaseline(camera->videoBitrate(),    _baselineBitrate,    _lastSetBitrate);
+            _restoreBaseline(camera->videoResolution(), _baselineResolution, _lastSetResolution);
+        }
+        _unhealthySeconds = _healthySeconds = 0;
+        return;
+    }
+    if (camera != _lastCamera) {
+        _reset();
+        _lastCamera = camera;
+    }
+
+    Fact* bitrate    = camera->videoBitrate();
+    Fact* resolution = camera->videoResolution();
+    if (!bitrate && !resolution) {
+        return;
+    }
+    if (bitrate) {
+        _trackUserChange(bitrate, _baselineBitrate, _lastSetBitrate);
+    }
+    if (resolution) {
+        _trackUserChange(resolution, _baselineResolution, _lastSetResolution);
+    }
+
+    const int   frames          = stats["total"].toMap()["count"].toInt();
+    const int   dropped         = stats["droppedFrames"].toInt();
+    const bool  framesDropped   = dropped > 0 && dropped > _maxDroppedFraction * (frames + dropped);
+    const bool  linkDegraded    = _vehicle->vehicleLinkManager()->telemetryScale() < 1.0;
+    if (framesDropped || newLost > 0 || linkDegraded) {
+        _unhealthySeconds++;
+        _healthySeconds = 0;
+    } else {
+        _healthySeconds++;
+        _unhealthySeconds = 0;
+    }
+
+    if (_lastChange.isValid() && !_lastChange.hasExpired(_minMSecsBetweenChanges)) {
+        return;
+    }
+    bool changed = false;
+    if (_unhealthySeconds >= _unhealthySecondsToStepDown) {
+        qCDebug(VideoQualityControllerLog) << "Video unhealthy: frames:dropped:lost:linkDegraded" << frames << dropped << newLost << linkDegraded;
+        changed = _stepDown(camera);
+        _unhealthySeconds = 0;
+    } else if (_healthySeconds >= _healthySecondsToStepUp) {
+        changed = _stepUp(camera);
+        _healthySeconds = 0;
+    }
+    if (changed) {
+        _lastChange.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoQualityController::_trackUserChange(Fact* fact, QVariant& baseline, QVariant& lastSet)
+{
+    if (!lastSet.isValid()) {
+        // Nothing changed by us yet, whatever is set is what the user wants
+        baseline = fact->rawValue();
+    } else if (fact->rawValue() != lastSet) {
+        qCDebug(VideoQualityControllerLog) << "User changed" << fact->name() << "to" << fact->rawValue();
+        baseline = fact->rawValue();
+        lastSet.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoQualityController::_restoreBaseline(Fact* fact, const QVariant& baseline, QVariant& lastSet)
+{
+    if (fact && lastSet.isValid() && fact->rawValue() == lastSet && baseline.isValid() && baseline != lastSet) {
+        qCDebug(VideoQualityControllerLog) << "Restoring" << fact->name() << "to" << baseline;
+        fact->setRawValue(baseline);
+    }
+    lastSet.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool
+VideoQualityController::_stepDown(QGCCameraControl* camera)
+{
+    // Bitrate first, it costs the least in picture quality
+    if (camera->videoBitrate() && _step(camera->videoBitrate(), _baselineBitrate, _lastSetBitrate, true)) {
+        return true;
+    }
+    return camera->videoResolution() && _step(camera->videoResolution(), _baselineResolution, _lastSetResolution, true);
+}
+
+//-----------------------------------------------------------------------------
+bool
+VideoQualityController::_stepUp(QGCCameraControl* camera)
+{
+    if (camera->videoResolution() && _step(camera->videoResolution(), _baselineResolution, _lastSetResolution, false)) {
+        return true;
+    }
+    return camera->videoBitrate() && _step(camera->videoBitrate(), _baselineBitrate, _lastSetBitrate, false);
+}
+
+//-----------------------------------------------------------------------------
+/// Orders enum options by what they cost on the link: pixel count for "1920x1080" style resolutions, otherwise the
+/// first number in the option string (bitrates such as "8 Mbps") and finally the raw value
+double
+VideoQualityController::_optionRank(const QString& option, const QVariant& value)
+{
+    static const QRegularExpression resolutionRegExp("(\\d+)\\s*[xX]\\s*(\\d+)");
+    static const QRegularExpression numberRegExp("(\\d+(\\.\\d+)?)");
+
+    QRegularExpressionMatch match = resolutionRegExp.match(option);
+    if (match.hasMatch()) {
+        return match.captured(1).toDouble() * match.captured(2).toDouble();
+    }
+    match = numberRegExp.match(option);
+    if (match.hasMatch()) {
+        return match.captured(1).toDouble();
+    }
+    return value.toDouble();
+}
+
+//-----------------------------------------------------------------------------
+bool
+VideoQualityController::_step(Fact* fact, const QVariant& baseline, QVariant& lastSet, bool down)
+{
+    QVariant newValue;
+
+    const QStringList   enumStrings = fact->enumStrings();
+    const QVariantList  enumValues  = fact->enumValues();
+    if (enumValues.count()) {
+        const int currentIndex  = enumValues.indexOf(fact->rawValue());
+        const int baselineIndex = enumValues.indexOf(baseline);
+        if (currentIndex < 0) {
+            return false;
+        }
+        const double currentRank  = _optionRank(enumStrings.value(currentIndex), enumValues[currentIndex]);
+        const double baselineRank = baselineIndex < 0 ? currentRank : _optionRank(enumStrings.value(baselineIndex), enumValues[baselineIndex]);
+        int     bestIndex = -1;
+        double  bestRank  = 0;
+        for (int i = 0; i < enumValues.count(); i++) {
+            const double rank = _optionRank(enumStrings.value(i), enumValues[i]);
+            // Closest option below the current one going down, closest above (but not past the user selection) going up
+            const bool candidate = down ? rank < currentRank : (rank > currentRank && rank <= baselineRank);
+            if (candidate && (bestIndex < 0 || (down ? rank > bestRank : rank < bestRank))) {
+                bestIndex = i;
+                bestRank  = rank;
+            }
+        }
+        if (bestIndex < 0) {
+            return false;
+        }
+        newValue = enumValues[bestIndex];
+    } else {
+        const bool      integral    = fact->type() != FactMetaData::valueTypeFloat && fact->type() != FactMetaData::valueTypeDouble;
+        const double    current     = fact->rawValue().toDouble();
+        double          value       = down ? qMax(fact->rawMin().toDouble(), current * _bitrateStep) : qMin(baseline.toDouble(), current / _bitrateStep);
+        if (integral) {
+            value = qRound64(value);
+        }
+        if (down ? value >= current : value <= current) {
+            return false;
+        }
+        newValue = integral ? QVariant(static_cast<qlonglong>(value)) : QVariant(value);
+    }
+
+    qCDebug(VideoQualityControllerLog) << (down ? "Lowering" : "Raising") << fact->name() << fact->rawValue() << "->" << newValue;
+    fact->setRawValue(newValue);
+    lastSet = fact->rawValue();
+    return true;
+}
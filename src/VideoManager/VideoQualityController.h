@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QVariant>
+#include <QElapsedTimer>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(VideoQualityControllerLog)
+
+class Vehicle;
+class Fact;
+class QGCCameraControl;
+class VideoSettings;
+
+/// Adapts the camera video bitrate and resolution to the health of the video and the vehicle link.
+///
+/// Fed once a second with the receiver statistics (see VideoReceiver::latencyStatsChanged). Video is unhealthy while
+/// frames are dropped, the jitter buffer loses packets or the vehicle link had to scale its telemetry down. After a few
+/// unhealthy seconds the camera CAM_VIDBITRATE is stepped down, then CAM_VIDRES once the bitrate is at its minimum.
+/// After a long healthy stretch the steps are undone in reverse order, never going above the values the user selected.
+class VideoQualityController : public QObject
+{
+    Q_OBJECT
+
+public:
+    VideoQualityController(VideoSettings* videoSettings, QObject* parent = nullptr);
+
+    void setVehicle     (Vehicle* vehicle);
+    void receiverStats  (const QVariantMap& stats);
+
+private:
+    QGCCameraControl*   _camera             (void);
+    void                _reset              (void);
+    void                _trackUserChange    (Fact* fact, QVariant& baseline, QVariant& lastSet);
+    void                _restoreBaseline    (Fact* fact, const QVariant& baseline, QVariant& lastSet);
+    bool                _step               (Fact* fact, const QVariant& baseline, QVariant& lastSet, bool down);
+    bool                _stepDown           (QGCCameraControl* camera);
+    bool                _stepUp             (QGCCameraControl* camera);
+    static double       _optionRank         (const QString& option, const QVariant& value);
+
+    VideoSettings*      _videoSettings;
+    QPointer<Vehicle>   _vehicle;
+    QPointer<QGCCameraControl> _lastCamera;
+    int                 _unhealthySeconds       = 0;
+    int                 _healthySeconds         = 0;
+    qulonglong          _lastJitterBufferLost   = 0;
+    QElapsedTimer       _lastChange;
+    QVariant            _baselineBitrate;       ///< What the user selected, never exceeded
+    QVariant            _baselineResolution;
+    QVariant            _lastSetBitrate;        ///< Last values we set, anything else came from the user
+    QVariant            _lastSetResolution;
+
+    static const int    _unhealthySecondsToStepDown = 3;
+    static const int    _healthySecondsToStepUp     = 20;
+    static const int    _minMSecsBetweenChanges     = 5000;     ///< Let the camera and the link settle first
+    static constexpr double _maxDroppedFraction     = 0.05;
+    static constexpr double _bitrateStep            = 0.7;      ///< For numeric bitrates, per step
+};
@@ -129,6 +129,22 @@ GStreamer::blacklist(VideoSettings::VideoDecoderOptions option)
         gst_object_unref(feature);
     };
 
+    // Decoder names differ between plugin versions (and MediaCodec decoders are named after the device codec), so
+    // the decoders for each option are matched by name prefix against all registered video decoders.
+    auto changeRankByPrefix = [changeRank](std::initializer_list<const char*> prefixes, uint16_t rank) {
+        GList* decoders = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO, GST_RANK_NONE);
+        for (GList* item = decoders; item != nullptr; item = item->next) {
+            const gchar* featureName = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(item->data));
+            for (const char* prefix : prefixes) {
+                if (g_str_has_prefix(featureName, prefix)) {
+                    changeRank(featureName, rank);
+                    break;
+                }
+            }
+        }
+        gst_plugin_feature_list_free(decoders);
+    };
+
     // Set rank for specific features
     changeRank("bcmdec", GST_RANK_NONE);
 
@@ -136,26 +152,25 @@ GStreamer::blacklist(VideoSettings::VideoDecoderOptions option)
         case VideoSettings::ForceVideoDecoderDefault:
             break;
         case VideoSettings::ForceVideoDecoderSoftware:
-            changeRank("avdec_h264", GST_RANK_PRIMARY + 1);
+            changeRankByPrefix({"avdec_h264", "avdec_h265"}, GST_RANK_PRIMARY + 1);
             break;
         case VideoSettings::ForceVideoDecoderVAAPI:
-            for(auto name : {"vaapimpeg2dec", "vaapimpeg4dec", "vaapih263dec", "vaapih264dec", "vaapivc1dec"}) {
-                changeRank(name, GST_RANK_PRIMARY + 1);
-            }
+            changeRankByPrefix({"vaapi", "vah264", "vah265", "vavp9", "vaav1"}, GST_RANK_PRIMARY + 1);
             break;
         case VideoSettings::ForceVideoDecoderNVIDIA:
-            for(auto name : {"nvh265dec", "nvh265sldec", "nvh264dec", "nvh264sldec"}) {
-                changeRank(name, GST_RANK_PRIMARY + 1);
-            }
+            // nvv4l2decoder is the Jetson decoder, the others are desktop NVDEC
+            changeRankByPrefix({"nvh265", "nvh264", "nvvp9", "nvav1", "nvv4l2decoder"}, GST_RANK_PRIMARY + 1);
             break;
         case VideoSettings::ForceVideoDecoderDirectX3D:
-            for(auto name : {"d3d11vp9dec", "d3d11h265dec", "d3d11h264dec"}) {
-                changeRank(name, GST_RANK_PRIMARY + 1);
-            }
+            changeRankByPrefix({"d3d11h265", "d3d11h264", "d3d11vp9", "d3d11av1"}, GST_RANK_PRIMARY + 1);
             break;
         case VideoSettings::ForceVideoDecoderVideoToolbox:
+            changeRank("vtdec_hw", GST_RANK_PRIMARY + 2);
             changeRank("vtdec", GST_RANK_PRIMARY + 1);
             break;
+        case VideoSettings::ForceVideoDecoderMediaCodec:
+            changeRankByPrefix({"amcviddec-"}, GST_RANK_PRIMARY + 1);
+            break;
         default:
             qCWarning(GStreamerLog) << "Can't handle decode option:" << option;
     }
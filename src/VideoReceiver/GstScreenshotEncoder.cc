@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GstScreenshotEncoder.h"
+#include "GstVideoReceiver.h"
+
+#include <QImage>
+#include <QImageWriter>
+#include <QFileInfo>
+
+#include <gst/video/video.h>
+
+namespace {
+
+// Converter from the stream format to RGBx, kept per pool thread and rebuilt only when the stream format changes
+class ConverterCache
+{
+public:
+    ~ConverterCache()
+    {
+        if (_converter != nullptr) {
+            gst_video_converter_free(_converter);
+            _converter = nullptr;
+        }
+    }
+
+    GstVideoConverter* converter(const GstVideoInfo* inInfo, const GstVideoInfo* outInfo)
+    {
+        if (_converter != nullptr && gst_video_info_is_equal(&_inInfo, inInfo) && gst_video_info_is_equal(&_outInfo, outInfo)) {
+            return _converter;
+        }
+
+        if (_converter != nullptr) {
+            gst_video_converter_free(_converter);
+            _converter = nullptr;
+        }
+
+        if ((_converter = gst_video_converter_new(const_cast<GstVideoInfo*>(inInfo), const_cast<GstVideoInfo*>(outInfo), nullptr)) != nullptr) {
+            _inInfo = *inInfo;
+            _outInfo = *outInfo;
+        }
+
+        return _converter;
+    }
+
+private:
+    GstVideoConverter*  _converter = nullptr;
+    GstVideoInfo        _inInfo;
+    GstVideoInfo        _outInfo;
+};
+
+thread_local ConverterCache converterCache;
+
+}
+
+QThreadPool*
+GstScreenshotEncoder::_pool(void)
+{
+    static QThreadPool* pool = [](){
+        QThreadPool* threadPool = new QThreadPool();
+        threadPool->setMaxThreadCount(_kMaxThreads);
+        return threadPool;
+    }();
+
+    return pool;
+}
+
+void
+GstScreenshotEncoder::encode(GstSample* sample, const QString& imageFile, Callback callback)
+{
+    _pool()->start([sample, imageFile, callback](){
+        const bool success = _encode(sample, imageFile);
+        gst_sample_unref(sample);
+        callback(success);
+    });
+}
+
+bool
+GstScreenshotEncoder::_encode(GstSample* sample, const QString& imageFile)
+{
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstVideoInfo inInfo;
+
+    if (buf == nullptr || caps == nullptr || !gst_video_info_from_caps(&inInfo, caps)) {
+        qCWarning(VideoReceiverLog) << "Screenshot frame has no usable video format" << imageFile;
+        return false;
+    }
+
+    const int width = GST_VIDEO_INFO_WIDTH(&inInfo);
+    const int height = GST_VIDEO_INFO_HEIGHT(&inInfo);
+
+    QImage image(width, height, QImage::Format_RGBX8888);
+
+    if (image.isNull()) {
+        qCWarning(VideoReceiverLog) << "Screenshot image allocation failed" << width << height;
+        return false;
+    }
+
+    GstVideoInfo outInfo;
+    gst_video_info_set_format(&outInfo, GST_VIDEO_FORMAT_RGBx, static_cast<guint>(width), static_cast<guint>(height));
+    GST_VIDEO_INFO_PLANE_STRIDE(&outInfo, 0) = image.bytesPerLine();
+    GST_VIDEO_INFO_SIZE(&outInfo) = static_cast<gsize>(image.sizeInBytes());
+
+    GstVideoConverter* converter = converterCache.converter(&inInfo, &outInfo);
+
+    if (converter == nullptr) {
+        qCWarning(VideoReceiverLog) << "Screenshot color conversion not supported" << gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(&inInfo));
+        return false;
+    }
+
+    // Frames in GPU memory are downloaded by the map, the decoder keeps running meanwhile since we only hold a reference
+    GstVideoFrame inFrame;
+
+    if (!gst_video_frame_map(&inFrame, &inInfo, buf, GST_MAP_READ)) {
+        qCWarning(VideoReceiverLog) << "Screenshot frame map failed" << imageFile;
+        return false;
+    }
+
+    GstBuffer* outBuf = gst_buffer_new_wrapped_full(static_cast<GstMemoryFlags>(0), image.bits(), static_cast<gsize>(image.sizeInBytes()), 0, static_cast<gsize>(image.sizeInBytes()), nullptr, nullptr);
+    GstVideoFrame outFrame;
+    bool converted = false;
+
+    if (gst_video_frame_map(&outFrame, &outInfo, outBuf, GST_MAP_WRITE)) {
+        gst_video_converter_frame(converter, &inFrame, &outFrame);
+        gst_video_frame_unmap(&outFrame);
+        converted = true;
+    }
+
+    gst_buffer_unref(outBuf);
+    outBuf = nullptr;
+
+    gst_video_frame_unmap(&inFrame);
+
+    if (!converted) {
+        qCWarning(VideoReceiverLog) << "Screenshot output map failed" << imageFile;
+        return false;
+    }
+
+    QImageWriter writer(imageFile, QFileInfo(imageFile).suffix().isEmpty() ? QByteArray("jpg") : QByteArray());
+    writer.setQuality(_kJpegQuality);
+
+    if (!writer.write(image)) {
+        qCWarning(VideoReceiverLog) << "Screenshot write failed" << imageFile << writer.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QThreadPool>
+
+#include <functional>
+
+#include <gst/gst.h>
+
+// Encodes decoded video frames to image files on a few threads shared by all receivers.
+//
+// Frames are handed over as a reference to the decoded buffer, so neither the streaming thread nor the control
+// thread waits for a screenshot. Each pool thread keeps its color converter from one frame to the next, a burst of
+// screenshots from the same stream only sets it up once.
+class GstScreenshotEncoder
+{
+public:
+    typedef std::function<void(bool success)> Callback;
+
+    // Takes ownership of sample. The callback is called from a pool thread once the file has been written, or failed.
+    // Image format is taken from the file extension, jpg if there is none.
+    static void encode(GstSample* sample, const QString& imageFile, Callback callback);
+
+private:
+    static bool         _encode(GstSample* sample, const QString& imageFile);
+    static QThreadPool* _pool(void);
+
+    static const int    _kMaxThreads    = 2;
+    static const int    _kJpegQuality   = 90;
+};
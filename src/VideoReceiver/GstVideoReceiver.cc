@@ -15,14 +15,64 @@
  */
 
 #include "GstVideoReceiver.h"
+#include "GstScreenshotEncoder.h"
 
 #include <QDebug>
 #include <QUrl>
 #include <QDateTime>
 #include <QSysInfo>
+#include <QFileInfo>
 
 QGC_LOGGING_CATEGORY(VideoReceiverLog, "VideoReceiverLog")
 
+QMutex              WorkerPool::_lock;
+QHash<Worker*, int> WorkerPool::_users;
+
+Worker*
+WorkerPool::acquire(void)
+{
+    QMutexLocker lock(&_lock);
+
+    const int maxWorkers = qBound(1, QThread::idealThreadCount(), _kMaxWorkers);
+
+    Worker* worker = nullptr;
+
+    if (_users.count() < maxWorkers) {
+        worker = new Worker();
+        worker->start();
+        _users[worker] = 0;
+    } else {
+        for (auto iter = _users.constBegin(); iter != _users.constEnd(); iter++) {
+            if (worker == nullptr || iter.value() < _users[worker]) {
+                worker = iter.key();
+            }
+        }
+    }
+
+    _users[worker] += 1;
+
+    return worker;
+}
+
+void
+WorkerPool::release(Worker* worker)
+{
+    QMutexLocker lock(&_lock);
+
+    if (!_users.contains(worker)) {
+        qCCritical(VideoReceiverLog) << "Releasing unknown worker";
+        return;
+    }
+
+    if (--_users[worker] > 0) {
+        return;
+    }
+
+    _users.remove(worker);
+    worker->shutdown();
+    delete worker;
+}
+
 //-----------------------------------------------------------------------------
 // Our pipeline look like this:
 //
@@ -42,6 +92,7 @@ GstVideoReceiver::GstVideoReceiver(QObject* parent)
     , _removingRecorder(false)
     , _source(nullptr)
     , _tee(nullptr)
+    , _decoderQueue(nullptr)
     , _decoderValve(nullptr)
     , _recorderValve(nullptr)
     , _decoder(nullptr)
@@ -52,18 +103,60 @@ GstVideoReceiver::GstVideoReceiver(QObject* parent)
     , _lastVideoFrameTime(0)
     , _resetVideoSink(true)
     , _videoSinkProbeId(0)
+    , _sourceNext(0)
+    , _decoderInNext(0)
+    , _decoderOutNext(0)
+    , _droppedFrames(0)
+    , _droppedLastFrame(false)
+    , _zeroCopy(false)
+    , _zeroCopyChecked(false)
+    , _glSinkProbeId(0)
+    , _lastDecodedFrame(nullptr)
+    , _screenshotsPending(0)
     , _udpReconnect_us(5000000)
+    , _lowLatency(false)
+    , _jitterBuffer(nullptr)
+    , _jitterBufferMSecs(0)
+    , _jitterBufferLate(0)
+    , _jitterBufferLost(0)
+    , _decodePriority(DECODE_PRIORITY_NORMAL)
+    , _keyframesOnly(false)
+    , _warmRestartEnabled(false)
+    , _waitForKeyframe(false)
+    , _recoveryStartUSecs(0)
+    , _recoveryAtDecoder(false)
+    , _slotHandler(WorkerPool::acquire())
     , _signalDepth(0)
     , _endOfStream(false)
+    , _syncIndexProbeId(0)
+    , _syncOriginPts(GST_CLOCK_TIME_NONE)
 {
-    _slotHandler.start();
+    memset(_sourceStamps, 0, sizeof(_sourceStamps));
+    memset(_decoderInStamps, 0, sizeof(_decoderInStamps));
+    memset(_decoderOutStamps, 0, sizeof(_decoderOutStamps));
+    memset(_latency, 0, sizeof(_latency));
     connect(&_watchdogTimer, &QTimer::timeout, this, &GstVideoReceiver::_watchdog);
     _watchdogTimer.start(1000);
 }
 
 GstVideoReceiver::~GstVideoReceiver(void)
 {
-    _slotHandler.shutdown();
+    // The worker may be shared, so make sure none of our tasks are still queued on it
+    _slotHandler->sync();
+    WorkerPool::release(_slotHandler);
+    _slotHandler = nullptr;
+
+    // Screenshot encodes report back to us when done
+    QMutexLocker lock(&_screenshotLock);
+
+    while (_screenshotsPending > 0) {
+        _screenshotsIdle.wait(&_screenshotLock);
+    }
+
+    if (_lastDecodedFrame != nullptr) {
+        gst_sample_unref(_lastDecodedFrame);
+        _lastDecodedFrame = nullptr;
+    }
 }
 
 void
@@ -71,7 +164,7 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 {
     if (_needDispatch()) {
         QString cachedUri = uri;
-        _slotHandler.dispatch([this, cachedUri, timeout, buffer]() {
+        _slotHandler->dispatch([this, cachedUri, timeout, buffer]() {
             start(cachedUri, timeout, buffer);
         });
         return;
@@ -96,6 +189,10 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
     _uri = uri;
     _timeout = timeout;
     _buffer = buffer;
+    _lowLatency = buffer < 0;
+    _jitterBuffer = nullptr;
+    _jitterBufferLate = 0;
+    _jitterBufferLost = 0;
 
     qCDebug(VideoReceiverLog) << "Starting" << _uri << ", buffer" << _buffer;
 
@@ -138,11 +235,25 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 
         g_object_set(_decoderValve, "drop", TRUE, nullptr);
 
+        GstPad* valveSrcPad = gst_element_get_static_pad(_decoderValve, "src");
+        gst_pad_add_probe(valveSrcPad, GST_PAD_PROBE_TYPE_BUFFER, _decodePriorityProbe, this, nullptr);
+        gst_object_unref(valveSrcPad);
+        valveSrcPad = nullptr;
+
         if((recorderQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('queue') failed";
             break;
         }
 
+        // Slow storage must never push back into the tee and stall the live view. The queue absorbs seconds of
+        // disk stalls and, if storage can't keep up at all, drops the oldest data instead of blocking.
+        g_object_set(recorderQueue,
+                     "max-size-buffers",    0,
+                     "max-size-bytes",      _kRecorderQueueBytes,
+                     "max-size-time",       static_cast<guint64>(_kRecorderQueueSecs) * GST_SECOND,
+                     "leaky",               2 /* downstream */,
+                     nullptr);
+
         if((_recorderValve = gst_element_factory_make("valve", nullptr)) == nullptr)  {
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('valve') failed";
             break;
@@ -165,31 +276,9 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
         gst_bin_add_many(GST_BIN(_pipeline), _source, _tee, decoderQueue, _decoderValve, recorderQueue, _recorderValve, nullptr);
 
         pipelineUp = true;
+        _decoderQueue = decoderQueue;
 
-        GstPad* srcPad = nullptr;
-
-        GstIterator* it;
-
-        if ((it = gst_element_iterate_src_pads(_source)) != nullptr) {
-            GValue vpad = G_VALUE_INIT;
-
-            if (gst_iterator_next(it, &vpad) == GST_ITERATOR_OK) {
-                srcPad = GST_PAD(g_value_get_object(&vpad));
-                gst_object_ref(srcPad);
-                g_value_reset(&vpad);
-            }
-
-            gst_iterator_free(it);
-            it = nullptr;
-        }
-
-        if (srcPad != nullptr) {
-            _onNewSourcePad(srcPad);
-            gst_object_unref(srcPad);
-            srcPad = nullptr;
-        } else {
-            g_signal_connect(_source, "pad-added", G_CALLBACK(_onNewPad), this);
-        }
+        _linkSource();
 
         if(!gst_element_link_many(_tee, decoderQueue, _decoderValve, nullptr)) {
             qCCritical(VideoReceiverLog) << "Unable to link decoder queue";
@@ -224,6 +313,8 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
             _pipeline = nullptr;
         }
 
+        _decoderQueue = nullptr;
+
         // If we failed before adding items to the pipeline, then clean up
         if (!pipelineUp) {
             if (_recorderValve != nullptr) {
@@ -274,7 +365,7 @@ void
 GstVideoReceiver::stop(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stop();
         });
         return;
@@ -304,7 +395,8 @@ GstVideoReceiver::stop(void)
 
                 GstMessage* msg;
 
-                if((msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR))) != nullptr) {
+                // Bounded so a stalled disk can't hang shutdown, the recording is at worst missing its tail
+                if((msg = gst_bus_timed_pop_filtered(bus, static_cast<GstClockTime>(_kRecorderStopSecs) * GST_SECOND, (GstMessageType)(GST_MESSAGE_EOS|GST_MESSAGE_ERROR))) != nullptr) {
                     if(GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
                         qCCritical(VideoReceiverLog) << "Error stopping pipeline!";
                     } else if(GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
@@ -314,7 +406,7 @@ GstVideoReceiver::stop(void)
                     gst_message_unref(msg);
                     msg = nullptr;
                 } else {
-                    qCCritical(VideoReceiverLog) << "gst_bus_timed_pop_filtered() failed";
+                    qCCritical(VideoReceiverLog) << "Timeout waiting for end of stream from recording";
                 }
             }
 
@@ -342,8 +434,16 @@ GstVideoReceiver::stop(void)
 
         _recorderValve = nullptr;
         _decoderValve = nullptr;
+        _decoderQueue = nullptr;
         _tee = nullptr;
         _source = nullptr;
+        _jitterBuffer = nullptr;
+        _recoveryStartUSecs = 0;
+        _syncIndexProbeId = 0;
+
+        _syncIndexLock.lock();
+        _syncIndex.close();
+        _syncIndexLock.unlock();
 
         _lastSourceFrameTime = 0;
 
@@ -376,7 +476,7 @@ GstVideoReceiver::startDecoding(void* sink)
     if (_needDispatch()) {
         GstElement* videoSink = GST_ELEMENT(sink);
         gst_object_ref(videoSink);
-        _slotHandler.dispatch([this, videoSink]() mutable {
+        _slotHandler->dispatch([this, videoSink]() mutable {
             startDecoding(videoSink);
             gst_object_unref(videoSink);
         });
@@ -419,6 +519,12 @@ GstVideoReceiver::startDecoding(void* sink)
     gst_object_unref(pad);
     pad = nullptr;
 
+    if ((pad = _glSinkPad(videoSink)) != nullptr) {
+        _glSinkProbeId = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _glSinkProbe, this, nullptr);
+        gst_object_unref(pad);
+        pad = nullptr;
+    }
+
     _videoSink = videoSink;
     gst_object_ref(_videoSink);
 
@@ -452,7 +558,7 @@ void
 GstVideoReceiver::stopDecoding(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stopDecoding();
         });
         return;
@@ -483,12 +589,12 @@ GstVideoReceiver::stopDecoding(void)
 }
 
 void
-GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
+GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format, unsigned segmentMinutes)
 {
     if (_needDispatch()) {
         QString cachedVideoFile = videoFile;
-        _slotHandler.dispatch([this, cachedVideoFile, format]() {
-            startRecording(cachedVideoFile, format);
+        _slotHandler->dispatch([this, cachedVideoFile, format, segmentMinutes]() {
+            startRecording(cachedVideoFile, format, segmentMinutes);
         });
         return;
     }
@@ -513,7 +619,7 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
 
     qCDebug(VideoReceiverLog) << "New video file:" << videoFile <<  "" << _uri;
 
-    if ((_fileSink = _makeFileSink(videoFile, format)) == nullptr) {
+    if ((_fileSink = _makeFileSink(videoFile, format, segmentMinutes)) == nullptr) {
         qCCritical(VideoReceiverLog) << "_makeFileSink() failed" << _uri;
         _dispatchSignal([this](){
             emit onStartRecordingComplete(STATUS_FAIL);
@@ -553,6 +659,14 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
     }
 
     gst_pad_add_probe(probepad, GST_PAD_PROBE_TYPE_BUFFER, _keyframeWatch, this, nullptr); // to drop the buffers until key frame is received
+
+    _syncIndexLock.lock();
+    _syncOriginPts = GST_CLOCK_TIME_NONE;
+    if (_syncIndex.open(videoFile)) {
+        _syncIndexProbeId = gst_pad_add_probe(probepad, GST_PAD_PROBE_TYPE_BUFFER, _syncIndexProbe, this, nullptr);
+    }
+    _syncIndexLock.unlock();
+
     gst_object_unref(probepad);
     probepad = nullptr;
 
@@ -571,7 +685,7 @@ void
 GstVideoReceiver::stopRecording(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stopRecording();
         });
         return;
@@ -606,18 +720,68 @@ GstVideoReceiver::takeScreenshot(const QString& imageFile)
 {
     if (_needDispatch()) {
         QString cachedImageFile = imageFile;
-        _slotHandler.dispatch([this, cachedImageFile]() {
+        _slotHandler->dispatch([this, cachedImageFile]() {
             takeScreenshot(cachedImageFile);
         });
         return;
     }
 
-    // FIXME: AV: record screenshot here
-    _dispatchSignal([this](){
-        emit onTakeScreenshotComplete(STATUS_NOT_IMPLEMENTED);
+    GstSample* sample = nullptr;
+    bool queueFull = false;
+
+    {
+        QMutexLocker lock(&_screenshotLock);
+
+        if (_screenshotsPending >= _kMaxPendingScreenshots) {
+            queueFull = true;
+        } else if (_lastDecodedFrame != nullptr) {
+            sample = gst_sample_ref(_lastDecodedFrame);
+            _screenshotsPending += 1;
+        }
+    }
+
+    if (sample == nullptr) {
+        qCDebug(VideoReceiverLog) << (queueFull ? "Too many screenshots pending" : "No decoded frame for screenshot") << imageFile;
+        _dispatchSignal([this, imageFile](){
+            emit onTakeScreenshotComplete(STATUS_INVALID_STATE, imageFile);
+        });
+        return;
+    }
+
+    // Encoding and writing happen on the encoder threads so bursts of screenshots don't hold up this thread
+    GstScreenshotEncoder::encode(sample, imageFile, [this, imageFile](bool success){
+        qCDebug(VideoReceiverLog) << "Screenshot" << (success ? "saved" : "failed") << imageFile;
+
+        _dispatchSignal([this, success, imageFile](){
+            emit onTakeScreenshotComplete(success ? STATUS_OK : STATUS_FAIL, imageFile);
+        });
+
+        QMutexLocker lock(&_screenshotLock);
+
+        if (--_screenshotsPending == 0) {
+            _screenshotsIdle.wakeAll();
+        }
     });
 }
 
+void
+GstVideoReceiver::setDecodePriority(DECODE_PRIORITY priority)
+{
+    // Read by the streaming thread for every buffer, so no dispatch needed
+    if (_decodePriority.fetchAndStoreOrdered(priority) != priority) {
+        qCDebug(VideoReceiverLog) << "Decode priority" << priority << _uri;
+    }
+}
+
+void
+GstVideoReceiver::setWarmRestart(bool enabled)
+{
+    // Read by the watchdog task, so no dispatch needed
+    if (_warmRestartEnabled.fetchAndStoreOrdered(enabled) != enabled) {
+        qCDebug(VideoReceiverLog) << "Warm restart" << enabled << _uri;
+    }
+}
+
 const char* GstVideoReceiver::_kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN] = {
     "matroskamux",
     "qtmux",
@@ -627,7 +791,7 @@ const char* GstVideoReceiver::_kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN] = {
 void
 GstVideoReceiver::_watchdog(void)
 {
-    _slotHandler.dispatch([this](){
+    _slotHandler->dispatch([this](){
         if(_pipeline == nullptr) {
             return;
         }
@@ -643,10 +807,20 @@ GstVideoReceiver::_watchdog(void)
             _dispatchSignal([this](){
                 emit timeout();
             });
-            stop();
+
+            // A stalled decoder below still gets the full restart, the warm restart only helps with the source
+            if (!_warmRestartEnabled.loadAcquire() || !_warmRestart()) {
+                stop();
+                return;
+            }
         }
 
+        _reportBufferedBytes();
+
         if (_decoding && !_removingDecoder) {
+            _reportLatency();
+            _adaptJitterBuffer();
+
             if (_lastVideoFrameTime == 0) {
                 _lastVideoFrameTime = now;
             }
@@ -767,6 +941,9 @@ GstVideoReceiver::_makeSource(const QString& uri)
         } else if (isRtsp) {
             if ((source = gst_element_factory_make("rtspsrc", "source")) != nullptr) {
                 g_object_set(static_cast<gpointer>(source), "location", qPrintable(uri), "latency", 17, "udp-reconnect", 1, "timeout", _udpReconnect_us, NULL);
+                if (_lowLatency) {
+                    g_object_set(static_cast<gpointer>(source), "drop-on-latency", TRUE, NULL);
+                }
             }
         } else if(isUdp264 || isUdp265 || isUdpMPEGTS || isTaisync) {
             if ((source = gst_element_factory_make("udpsrc", "source")) != nullptr) {
@@ -839,12 +1016,25 @@ GstVideoReceiver::_makeSource(const QString& uri)
         gst_element_foreach_src_pad(source, _padProbe, &probeRes);
 
         if (probeRes & 1) {
-            if (probeRes & 2 && _buffer >= 0) {
+            if (probeRes & 2) {
                 if ((buffer = gst_element_factory_make("rtpjitterbuffer", nullptr)) == nullptr) {
                     qCCritical(VideoReceiverLog) << "gst_element_factory_make('rtpjitterbuffer') failed";
                     break;
                 }
 
+                if (_lowLatency) {
+                    // Start small and let _adaptJitterBuffer() size it from the measured jitter
+                    _jitterBufferMSecs = _kLowLatencyStartMSecs;
+                    g_object_set(buffer, "latency", _jitterBufferMSecs, "drop-on-latency", TRUE, nullptr);
+                } else if (_buffer > 0) {
+                    _jitterBufferMSecs = _buffer;
+                    g_object_set(buffer, "latency", _jitterBufferMSecs, nullptr);
+                } else {
+                    g_object_get(buffer, "latency", &_jitterBufferMSecs, nullptr);
+                }
+
+                _jitterBuffer = buffer;
+
                 gst_bin_add(GST_BIN(bin), buffer);
 
                 if (!gst_element_link_many(source, buffer, parser, nullptr)) {
@@ -914,12 +1104,15 @@ GstVideoReceiver::_makeDecoder(GstCaps* caps, GstElement* videoSink)
     return decoder;
 }
 
+// Builds the recording sink. With segmentMinutes > 0 splitmuxsink rotates to a new file at the first keyframe after
+// each segment, so a crash only loses the segment being written (videoFile_000.mkv, videoFile_001.mkv...).
 GstElement*
-GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
+GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format, unsigned segmentMinutes)
 {
     GstElement* fileSink = nullptr;
     GstElement* mux = nullptr;
     GstElement* sink = nullptr;
+    GstElement* splitmux = nullptr;
     GstElement* bin = nullptr;
     bool releaseElements = true;
 
@@ -939,31 +1132,70 @@ GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
             break;
         }
 
-        g_object_set(static_cast<gpointer>(sink), "location", qPrintable(videoFile), nullptr);
+        // Write to disk in large chunks instead of once per (small) muxed buffer
+        g_object_set(static_cast<gpointer>(sink), "buffer-mode", 0 /* full */, "buffer-size", _kFileSinkBufferSize, nullptr);
 
         if ((bin = gst_bin_new("sinkbin")) == nullptr) {
             qCCritical(VideoReceiverLog) << "gst_bin_new('sinkbin') failed";
             break;
         }
 
-        GstPadTemplate* padTemplate;
+        GstPad* pad;
 
-        if ((padTemplate = gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(mux), "video_%u")) == nullptr) {
-            qCCritical(VideoReceiverLog) << "gst_element_class_get_pad_template(mux) failed";
-            break;
-        }
+        if (segmentMinutes > 0) {
+            if ((splitmux = gst_element_factory_make("splitmuxsink", nullptr)) == nullptr) {
+                qCCritical(VideoReceiverLog) << "gst_element_factory_make('splitmuxsink') failed";
+                break;
+            }
 
-        // FIXME: AV: pad handling is potentially leaking (and other similar places too!)
-        GstPad* pad;
+            QFileInfo fileInfo(videoFile);
+            QString location = fileInfo.path() + "/" + fileInfo.completeBaseName().replace("%", "%%") + "_%03d." + fileInfo.suffix();
+
+            // splitmuxsink takes ownership of mux and sink
+            g_object_set(static_cast<gpointer>(splitmux),
+                         "location",        qPrintable(location),
+                         "max-size-time",   static_cast<guint64>(segmentMinutes) * 60 * GST_SECOND,
+                         "muxer",           mux,
+                         "sink",            sink,
+                         nullptr);
+            mux = sink = nullptr;
+
+            if ((pad = gst_element_get_request_pad(splitmux, "video")) == nullptr) {
+                qCCritical(VideoReceiverLog) << "gst_element_get_request_pad(splitmux) failed";
+                gst_object_unref(splitmux);
+                splitmux = nullptr;
+                break;
+            }
 
-        if ((pad = gst_element_request_pad(mux, padTemplate, nullptr, nullptr)) == nullptr) {
-            qCCritical(VideoReceiverLog) << "gst_element_request_pad(mux) failed";
-            break;
-        }
+            gst_bin_add(GST_BIN(bin), splitmux);
+            splitmux = nullptr;
+        } else {
+            g_object_set(static_cast<gpointer>(sink), "location", qPrintable(videoFile), nullptr);
+
+            GstPadTemplate* padTemplate;
+
+            if ((padTemplate = gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(mux), "video_%u")) == nullptr) {
+                qCCritical(VideoReceiverLog) << "gst_element_class_get_pad_template(mux) failed";
+                break;
+            }
+
+            // FIXME: AV: pad handling is potentially leaking (and other similar places too!)
+            if ((pad = gst_element_request_pad(mux, padTemplate, nullptr, nullptr)) == nullptr) {
+                qCCritical(VideoReceiverLog) << "gst_element_request_pad(mux) failed";
+                break;
+            }
 
-        gst_bin_add_many(GST_BIN(bin), mux, sink, nullptr);
+            gst_bin_add_many(GST_BIN(bin), mux, sink, nullptr);
 
-        releaseElements = false;
+            releaseElements = false;
+
+            if (!gst_element_link(mux, sink)) {
+                qCCritical(VideoReceiverLog) << "gst_element_link() failed";
+                gst_object_unref(pad);
+                pad = nullptr;
+                break;
+            }
+        }
 
         GstPad* ghostpad = gst_ghost_pad_new("sink", pad);
 
@@ -972,11 +1204,6 @@ GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
         gst_object_unref(pad);
         pad = nullptr;
 
-        if (!gst_element_link(mux, sink)) {
-            qCCritical(VideoReceiverLog) << "gst_element_link() failed";
-            break;
-        }
-
         fileSink = bin;
         bin = nullptr;
     } while(0);
@@ -1001,6 +1228,111 @@ GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
     return fileSink;
 }
 
+void
+GstVideoReceiver::_linkSource(void)
+{
+    GstPad* srcPad = nullptr;
+
+    GstIterator* it;
+
+    if ((it = gst_element_iterate_src_pads(_source)) != nullptr) {
+        GValue vpad = G_VALUE_INIT;
+
+        if (gst_iterator_next(it, &vpad) == GST_ITERATOR_OK) {
+            srcPad = GST_PAD(g_value_get_object(&vpad));
+            gst_object_ref(srcPad);
+            g_value_reset(&vpad);
+        }
+
+        gst_iterator_free(it);
+        it = nullptr;
+    }
+
+    if (srcPad != nullptr) {
+        _onNewSourcePad(srcPad);
+        gst_object_unref(srcPad);
+        srcPad = nullptr;
+    } else {
+        g_signal_connect(_source, "pad-added", G_CALLBACK(_onNewPad), this);
+    }
+}
+
+// Replaces a stalled source while the tee, the decoding branch and the recording branch keep running, so a short
+// dropout doesn't cost a decoder and video sink rebuild. Only the decoding branch is flushed, the recording carries on
+// with the new source. Returns false if the pipeline has to be stopped instead.
+bool
+GstVideoReceiver::_warmRestart(void)
+{
+    if (_source == nullptr || _removingDecoder || _removingRecorder || _endOfStream) {
+        return false;
+    }
+
+    qCDebug(VideoReceiverLog) << "Warm restart" << _uri;
+
+    g_signal_handlers_disconnect_by_data(_source, this);
+    gst_element_set_state(_source, GST_STATE_NULL);
+    gst_element_unlink(_source, _tee);
+    gst_bin_remove(GST_BIN(_pipeline), _source);
+    _source = nullptr;
+    _jitterBuffer = nullptr;
+
+    if (_decoder != nullptr) {
+        // Drops whatever the decoder still holds from before the dropout, delta units from the new source reference
+        // frames it never saw, so the decoder is fed again from the next keyframe on
+        GstPad* pad;
+
+        if ((pad = gst_element_get_static_pad(_decoderQueue, "sink")) != nullptr) {
+            gst_pad_send_event(pad, gst_event_new_flush_start());
+            gst_pad_send_event(pad, gst_event_new_flush_stop(FALSE));
+            gst_object_unref(pad);
+            pad = nullptr;
+        }
+
+        _waitForKeyframe = true;
+    }
+
+    _recoveryAtDecoder = _decoder != nullptr;
+    _recoveryStartUSecs = g_get_monotonic_time();
+    _lastSourceFrameTime = 0;
+    _lastVideoFrameTime = 0;
+
+    if ((_source = _makeSource(_uri)) == nullptr) {
+        qCCritical(VideoReceiverLog) << "_makeSource() failed";
+        return false;
+    }
+
+    gst_bin_add(GST_BIN(_pipeline), _source);
+
+    _linkSource();
+
+    if (!gst_element_sync_state_with_parent(_source)) {
+        qCCritical(VideoReceiverLog) << "gst_element_sync_state_with_parent() failed";
+        return false;
+    }
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-warm-restart");
+
+    return true;
+}
+
+void
+GstVideoReceiver::_noteRecovered(void)
+{
+    const qint64 startUSecs = _recoveryStartUSecs.fetchAndStoreOrdered(0);
+
+    if (startUSecs == 0) {
+        return;
+    }
+
+    const double firstFrameMSecs = (g_get_monotonic_time() - startUSecs) / 1000.0;
+
+    qCDebug(VideoReceiverLog) << "Recovered from warm restart, first frame after" << firstFrameMSecs << "ms" << _uri;
+
+    _dispatchSignal([this, firstFrameMSecs](){
+        emit streamRecovered(firstFrameMSecs);
+    });
+}
+
 void
 GstVideoReceiver::_onNewSourcePad(GstPad* pad)
 {
@@ -1024,6 +1356,11 @@ GstVideoReceiver::_onNewSourcePad(GstPad* pad)
         return;
     }
 
+    if (_decoder != nullptr) {
+        // New source from a warm restart, the decoding branch is still in place
+        return;
+    }
+
     GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-with-new-source-pad");
 
     if (!_addDecoder(_decoderValve)) {
@@ -1043,6 +1380,9 @@ GstVideoReceiver::_onNewDecoderPad(GstPad* pad)
 
     qCDebug(VideoReceiverLog) << "_onNewDecoderPad" << _uri;
 
+    _zeroCopyChecked = false;
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _decoderOutputProbe, this, nullptr);
+
     if (!_addVideoSink(pad)) {
         qCCritical(VideoReceiverLog) << "_addVideoSink() failed";
     }
@@ -1082,6 +1422,14 @@ GstVideoReceiver::_addDecoder(GstElement* src)
     gst_caps_unref(caps);
     caps = nullptr;
 
+    GstPad* decoderSinkPad;
+
+    if ((decoderSinkPad = gst_element_get_static_pad(_decoder, "sink")) != nullptr) {
+        gst_pad_add_probe(decoderSinkPad, GST_PAD_PROBE_TYPE_BUFFER, _decoderInputProbe, this, nullptr);
+        gst_object_unref(decoderSinkPad);
+        decoderSinkPad = nullptr;
+    }
+
     gst_bin_add(GST_BIN(_pipeline), _decoder);
 
     gst_element_sync_state_with_parent(_decoder);
@@ -1173,9 +1521,45 @@ GstVideoReceiver::_addVideoSink(GstPad* pad)
 }
 
 void
-GstVideoReceiver::_noteTeeFrame(void)
+GstVideoReceiver::_noteTeeFrame(GstBuffer* buf)
 {
     _lastSourceFrameTime = QDateTime::currentSecsSinceEpoch();
+
+    if (!_recoveryAtDecoder && _recoveryStartUSecs.loadRelaxed() != 0) {
+        _noteRecovered();
+    }
+
+    if (buf == nullptr || !GST_BUFFER_PTS_IS_VALID(buf)) {
+        return;
+    }
+
+    QMutexLocker lock(&_timingLock);
+
+    _stampFrame(_sourceStamps, _sourceNext, GST_BUFFER_PTS(buf), g_get_monotonic_time());
+}
+
+// In low latency mode decoded frames which are already too old by the time they reach the video sink are dropped,
+// but never two in a row so the picture keeps updating
+bool
+GstVideoReceiver::_dropLateFrame(GstBuffer* buf)
+{
+    if (!_lowLatency || buf == nullptr || !GST_BUFFER_PTS_IS_VALID(buf)) {
+        return false;
+    }
+
+    QMutexLocker lock(&_timingLock);
+
+    gint64 sourceUSecs = _findFrameStamp(_sourceStamps, GST_BUFFER_PTS(buf), false);
+
+    if (sourceUSecs != 0 && !_droppedLastFrame && g_get_monotonic_time() - sourceUSecs > _kLateFrameMSecs * 1000) {
+        _droppedLastFrame = true;
+        _droppedFrames++;
+        return true;
+    }
+
+    _droppedLastFrame = false;
+
+    return false;
 }
 
 void
@@ -1197,6 +1581,383 @@ GstVideoReceiver::_noteEndOfStream(void)
     _endOfStream = true;
 }
 
+// Called from the recording branch streaming thread, after the recorder queue
+void
+GstVideoReceiver::_noteRecordedFrame(GstBuffer* buf)
+{
+    if (buf == nullptr || !GST_BUFFER_PTS_IS_VALID(buf)) {
+        return;
+    }
+
+    const bool keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    QMutexLocker lock(&_syncIndexLock);
+
+    if (!_syncIndex.isOpen()) {
+        return;
+    }
+
+    // Same origin as _keyframeWatch: the recording starts at the first keyframe
+    if (_syncOriginPts == GST_CLOCK_TIME_NONE) {
+        if (!keyframe) {
+            return;
+        }
+        _syncOriginPts = buf->pts;
+    }
+
+    if (buf->pts < _syncOriginPts) {
+        return;
+    }
+
+    _syncIndex.append(buf->pts - _syncOriginPts, _wallClockUSecs(buf->pts), keyframe);
+}
+
+// Live sources timestamp buffers with the pipeline running time at capture. Going back from the current running
+// time removes the time the buffer spent in the jitter buffer and recorder queue.
+quint64
+GstVideoReceiver::_wallClockUSecs(GstClockTime pts)
+{
+    gint64 nowUSecs = g_get_real_time();
+
+    GstClock* clock = gst_element_get_clock(_pipeline);
+
+    if (clock != nullptr) {
+        const GstClockTime now = gst_clock_get_time(clock);
+        const GstClockTime baseTime = gst_element_get_base_time(_pipeline);
+
+        if (now > baseTime && now - baseTime > pts) {
+            nowUSecs -= static_cast<gint64>((now - baseTime - pts) / GST_USECOND);
+        }
+
+        gst_object_unref(clock);
+        clock = nullptr;
+    }
+
+    return static_cast<quint64>(nowUSecs);
+}
+
+void
+GstVideoReceiver::_noteDecoderInput(GstBuffer* buf)
+{
+    if (!GST_BUFFER_PTS_IS_VALID(buf)) {
+        return;
+    }
+
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    const gint64 now = g_get_monotonic_time();
+
+    QMutexLocker lock(&_timingLock);
+
+    gint64 sourceUSecs = _findFrameStamp(_sourceStamps, pts, false);
+
+    if (sourceUSecs != 0) {
+        _addLatency(_latency[STAGE_QUEUE], now - sourceUSecs);
+    }
+
+    _stampFrame(_decoderInStamps, _decoderInNext, pts, now);
+}
+
+void
+GstVideoReceiver::_noteDecoderOutput(GstPad* pad, GstBuffer* buf)
+{
+    // Screenshots are taken from here, keeping a reference costs the streaming thread next to nothing
+    GstCaps* frameCaps = gst_pad_get_current_caps(pad);
+
+    if (frameCaps != nullptr) {
+        GstSample* sample = gst_sample_new(buf, frameCaps, nullptr, nullptr);
+        gst_caps_unref(frameCaps);
+        frameCaps = nullptr;
+
+        _screenshotLock.lock();
+        GstSample* previousFrame = _lastDecodedFrame;
+        _lastDecodedFrame = sample;
+        _screenshotLock.unlock();
+
+        if (previousFrame != nullptr) {
+            gst_sample_unref(previousFrame);
+            previousFrame = nullptr;
+        }
+    }
+
+    if (!_zeroCopyChecked) {
+        // Anything other than system memory means the decoder hands GPU surfaces (GL, DMABuf...) to glupload,
+        // which imports them without a copy through the CPU
+        GstCaps* caps = gst_pad_get_current_caps(pad);
+
+        if (caps != nullptr) {
+            GstCapsFeatures* features = gst_caps_get_features(caps, 0);
+            _zeroCopy = features != nullptr && !gst_caps_features_contains(features, GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY);
+            _zeroCopyChecked = true;
+            gchar* capsString = gst_caps_to_string(caps);
+            qCDebug(VideoReceiverLog) << "Decoder output caps" << capsString << "zero copy:" << _zeroCopy;
+            g_free(capsString);
+            gst_caps_unref(caps);
+            caps = nullptr;
+        }
+    }
+
+    if (_recoveryAtDecoder && _recoveryStartUSecs.loadRelaxed() != 0) {
+        _noteRecovered();
+    }
+
+    if (!GST_BUFFER_PTS_IS_VALID(buf)) {
+        return;
+    }
+
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    const gint64 now = g_get_monotonic_time();
+
+    QMutexLocker lock(&_timingLock);
+
+    gint64 decoderInUSecs = _findFrameStamp(_decoderInStamps, pts, true);
+
+    if (decoderInUSecs != 0) {
+        _addLatency(_latency[STAGE_DECODE], now - decoderInUSecs);
+    }
+
+    _stampFrame(_decoderOutStamps, _decoderOutNext, pts, now);
+}
+
+void
+GstVideoReceiver::_noteGlSinkInput(GstBuffer* buf)
+{
+    if (!GST_BUFFER_PTS_IS_VALID(buf)) {
+        return;
+    }
+
+    const GstClockTime pts = GST_BUFFER_PTS(buf);
+    const gint64 now = g_get_monotonic_time();
+
+    QMutexLocker lock(&_timingLock);
+
+    gint64 decoderOutUSecs = _findFrameStamp(_decoderOutStamps, pts, true);
+
+    if (decoderOutUSecs != 0) {
+        _addLatency(_latency[STAGE_UPLOAD], now - decoderOutUSecs);
+    }
+
+    gint64 sourceUSecs = _findFrameStamp(_sourceStamps, pts, true);
+
+    if (sourceUSecs != 0) {
+        _addLatency(_latency[STAGE_TOTAL], now - sourceUSecs);
+    }
+}
+
+void
+GstVideoReceiver::_stampFrame(FrameStamp_t* stamps, int& next, GstClockTime pts, gint64 timeUSecs)
+{
+    stamps[next].pts = pts;
+    stamps[next].timeUSecs = timeUSecs;
+    next = (next + 1) % _kFrameStampCount;
+}
+
+// @return Time the frame was stamped, 0 if the frame is not stamped
+gint64
+GstVideoReceiver::_findFrameStamp(FrameStamp_t* stamps, GstClockTime pts, bool consume)
+{
+    for (int i = 0; i < _kFrameStampCount; i++) {
+        if (stamps[i].pts == pts && stamps[i].timeUSecs != 0) {
+            gint64 timeUSecs = stamps[i].timeUSecs;
+            if (consume) {
+                stamps[i].timeUSecs = 0;
+            }
+            return timeUSecs;
+        }
+    }
+
+    return 0;
+}
+
+void
+GstVideoReceiver::_addLatency(LatencyHistogram_t& histogram, gint64 latencyUSecs)
+{
+    int bucket = 0;
+    gint64 latencyMSecs = latencyUSecs / 1000;
+
+    while (latencyMSecs > 0 && bucket < _kLatencyBucketCount - 1) {
+        latencyMSecs >>= 1;
+        bucket++;
+    }
+
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.sumUSecs += latencyUSecs;
+    histogram.maxUSecs = qMax(histogram.maxUSecs, latencyUSecs);
+}
+
+// @return Upper bound of the histogram bucket which contains the percentile
+double
+GstVideoReceiver::_latencyPercentileMSecs(const LatencyHistogram_t& histogram, double percentile)
+{
+    if (histogram.count == 0) {
+        return 0;
+    }
+
+    quint32 target = static_cast<quint32>(histogram.count * percentile);
+    quint32 cumulative = 0;
+
+    for (int i = 0; i < _kLatencyBucketCount; i++) {
+        cumulative += histogram.buckets[i];
+        if (cumulative > target) {
+            return qMin(static_cast<double>(1 << i), histogram.maxUSecs / 1000.0);
+        }
+    }
+
+    return histogram.maxUSecs / 1000.0;
+}
+
+QVariantMap
+GstVideoReceiver::_latencyStats(const LatencyHistogram_t& histogram)
+{
+    QVariantMap stats;
+    QVariantList buckets;
+
+    for (int i = 0; i < _kLatencyBucketCount; i++) {
+        buckets.append(histogram.buckets[i]);
+    }
+
+    stats["count"]      = histogram.count;
+    stats["avgMSecs"]   = histogram.count ? histogram.sumUSecs / 1000.0 / histogram.count : 0.0;
+    stats["p50MSecs"]   = _latencyPercentileMSecs(histogram, 0.5);
+    stats["p95MSecs"]   = _latencyPercentileMSecs(histogram, 0.95);
+    stats["maxMSecs"]   = histogram.maxUSecs / 1000.0;
+    stats["histogram"]  = buckets;
+
+    return stats;
+}
+
+void
+GstVideoReceiver::_reportLatency(void)
+{
+    static const char* stageNames[STAGE_COUNT] = { "queue", "decode", "upload", "total" };
+
+    QVariantMap stats;
+    double      decodeMSecs;
+    double      uploadMSecs;
+
+    {
+        QMutexLocker lock(&_timingLock);
+
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            stats[stageNames[i]] = _latencyStats(_latency[i]);
+        }
+
+        decodeMSecs = stats["decode"].toMap()["avgMSecs"].toDouble();
+        uploadMSecs = stats["upload"].toMap()["avgMSecs"].toDouble();
+
+        stats["droppedFrames"] = _droppedFrames;
+
+        memset(_latency, 0, sizeof(_latency));
+        _droppedFrames = 0;
+    }
+
+    stats["lowLatency"]         = _lowLatency;
+    stats["jitterBufferMSecs"]  = _jitterBuffer != nullptr ? _jitterBufferMSecs : 0;
+    stats["jitterBufferLost"]   = static_cast<qulonglong>(_jitterBufferLate + _jitterBufferLost);
+
+    const bool zeroCopy = _zeroCopy;
+
+    qCDebug(VideoReceiverLog) << "Latency" << stats["total"].toMap()["p50MSecs"].toDouble() << stats["total"].toMap()["p95MSecs"].toDouble()
+                              << "decode" << decodeMSecs << "upload" << uploadMSecs << "zero copy" << zeroCopy << _uri;
+
+    _dispatchSignal([this, decodeMSecs, uploadMSecs, zeroCopy, stats](){
+        emit decodeTimingChanged(decodeMSecs, uploadMSecs, zeroCopy);
+        emit latencyStatsChanged(stats);
+    });
+}
+
+// Grows the jitter buffer quickly when packets arrive too late for it and shrinks it slowly back towards a few times
+// the measured jitter
+void
+GstVideoReceiver::_adaptJitterBuffer(void)
+{
+    if (!_lowLatency || _jitterBuffer == nullptr) {
+        return;
+    }
+
+    GstStructure* stats = nullptr;
+
+    g_object_get(_jitterBuffer, "stats", &stats, nullptr);
+
+    if (stats == nullptr) {
+        return;
+    }
+
+    guint64 late = 0;
+    guint64 lost = 0;
+    guint64 avgJitterNSecs = 0;
+
+    gst_structure_get_uint64(stats, "num-late", &late);
+    gst_structure_get_uint64(stats, "num-lost", &lost);
+    gst_structure_get_uint64(stats, "avg-jitter", &avgJitterNSecs);
+    gst_structure_free(stats);
+    stats = nullptr;
+
+    const bool  gotLate     = late > _jitterBufferLate || lost > _jitterBufferLost;
+    const int   floorMSecs  = qMax(_kLowLatencyMinMSecs, static_cast<int>(avgJitterNSecs * 3 / GST_MSECOND));
+    int         latency     = _jitterBufferMSecs;
+
+    _jitterBufferLate = late;
+    _jitterBufferLost = lost;
+
+    if (gotLate) {
+        latency = qMin(_kLowLatencyMaxMSecs, latency + 10);
+    } else if (latency > floorMSecs) {
+        latency = qMax(floorMSecs, latency - 5);
+    }
+
+    if (latency != _jitterBufferMSecs) {
+        qCDebug(VideoReceiverLog) << "Jitter buffer latency" << _jitterBufferMSecs << "->" << latency << _uri;
+        _jitterBufferMSecs = latency;
+        g_object_set(_jitterBuffer, "latency", latency, nullptr);
+    }
+}
+
+// Bytes queued in the pipeline elements which report a level (queues, jitter buffer, ...) and held by the last
+// decoded frame kept for screenshots
+void
+GstVideoReceiver::_reportBufferedBytes(void)
+{
+    qint64 bytes = 0;
+
+    GstIterator* it;
+
+    if ((it = gst_bin_iterate_recurse(GST_BIN(_pipeline))) != nullptr) {
+        GValue velement = G_VALUE_INIT;
+
+        while (gst_iterator_next(it, &velement) == GST_ITERATOR_OK) {
+            GstElement* element = GST_ELEMENT(g_value_get_object(&velement));
+
+            if (g_object_class_find_property(G_OBJECT_GET_CLASS(element), "current-level-bytes") != nullptr) {
+                guint levelBytes = 0;
+                g_object_get(element, "current-level-bytes", &levelBytes, nullptr);
+                bytes += levelBytes;
+            }
+
+            g_value_reset(&velement);
+        }
+
+        gst_iterator_free(it);
+        it = nullptr;
+    }
+
+    {
+        QMutexLocker lock(&_screenshotLock);
+
+        if (_lastDecodedFrame != nullptr) {
+            GstBuffer* buf = gst_sample_get_buffer(_lastDecodedFrame);
+
+            if (buf != nullptr) {
+                bytes += static_cast<qint64>(gst_buffer_get_size(buf));
+            }
+        }
+    }
+
+    _dispatchSignal([this, bytes](){
+        emit bufferedBytesChanged(bytes);
+    });
+}
+
 // -Unlink the branch from the src pad
 // -Send an EOS event at the beginning of that branch
 bool
@@ -1273,6 +2034,26 @@ GstVideoReceiver::_shutdownDecodingBranch(void)
         _videoSinkProbeId = 0;
     }
 
+    if (_glSinkProbeId != 0) {
+        GstPad* sinkpad;
+        if ((sinkpad = _glSinkPad(_videoSink)) != nullptr) {
+            gst_pad_remove_probe(sinkpad, _glSinkProbeId);
+            gst_object_unref(sinkpad);
+            sinkpad = nullptr;
+        }
+        _glSinkProbeId = 0;
+    }
+
+    _screenshotLock.lock();
+    GstSample* lastDecodedFrame = _lastDecodedFrame;
+    _lastDecodedFrame = nullptr;
+    _screenshotLock.unlock();
+
+    if (lastDecodedFrame != nullptr) {
+        gst_sample_unref(lastDecodedFrame);
+        lastDecodedFrame = nullptr;
+    }
+
     _lastVideoFrameTime = 0;
 
     GstObject* parent;
@@ -1303,8 +2084,27 @@ GstVideoReceiver::_shutdownDecodingBranch(void)
 void
 GstVideoReceiver::_shutdownRecordingBranch(void)
 {
+    if (_syncIndexProbeId != 0) {
+        GstPad* srcpad = gst_element_get_static_pad(_recorderValve, "src");
+        if (srcpad != nullptr) {
+            gst_pad_remove_probe(srcpad, _syncIndexProbeId);
+            gst_object_unref(srcpad);
+            srcpad = nullptr;
+        }
+        _syncIndexProbeId = 0;
+    }
+
+    _syncIndexLock.lock();
+    _syncIndex.close();
+    _syncIndexLock.unlock();
+
     gst_bin_remove(GST_BIN(_pipeline), _fileSink);
-    gst_element_set_state(_fileSink, GST_STATE_NULL);
+
+    // Going to NULL waits for the file sink to flush and close the file, which can take a while on slow storage.
+    // The branch is already unlinked, so let GStreamer finish that from its own thread pool.
+    gst_element_call_async(_fileSink, [](GstElement* element, gpointer) {
+        gst_element_set_state(element, GST_STATE_NULL);
+    }, nullptr, nullptr);
     gst_object_unref(_fileSink);
     _fileSink = nullptr;
 
@@ -1324,7 +2124,7 @@ GstVideoReceiver::_shutdownRecordingBranch(void)
 bool
 GstVideoReceiver::_needDispatch(void)
 {
-    return _slotHandler.needDispatch();
+    return _slotHandler->needDispatch();
 }
 
 void
@@ -1362,14 +2162,14 @@ GstVideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
                 error = nullptr;
             }
 
-            pThis->_slotHandler.dispatch([pThis](){
+            pThis->_slotHandler->dispatch([pThis](){
                 qCDebug(VideoReceiverLog) << "Stopping because of error";
                 pThis->stop();
             });
         } while(0);
         break;
     case GST_MESSAGE_EOS:
-        pThis->_slotHandler.dispatch([pThis](){
+        pThis->_slotHandler->dispatch([pThis](){
             qCDebug(VideoReceiverLog) << "Received EOS";
             pThis->_handleEOS();
         });
@@ -1391,7 +2191,7 @@ GstVideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
             }
 
             if (GST_MESSAGE_TYPE(forward_msg) == GST_MESSAGE_EOS) {
-                pThis->_slotHandler.dispatch([pThis](){
+                pThis->_slotHandler->dispatch([pThis](){
                     qCDebug(VideoReceiverLog) << "Received branch EOS";
                     pThis->_handleEOS();
                 });
@@ -1504,11 +2304,10 @@ GstPadProbeReturn
 GstVideoReceiver::_teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
     Q_UNUSED(pad)
-    Q_UNUSED(info)
 
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
-        pThis->_noteTeeFrame();
+        pThis->_noteTeeFrame(info != nullptr ? gst_pad_probe_info_get_buffer(info) : nullptr);
     }
 
     return GST_PAD_PROBE_OK;
@@ -1518,7 +2317,6 @@ GstPadProbeReturn
 GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
     Q_UNUSED(pad)
-    Q_UNUSED(info)
 
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
@@ -1551,6 +2349,10 @@ GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer u
         }
 
         pThis->_noteVideoSinkFrame();
+
+        if (info != nullptr && pThis->_dropLateFrame(gst_pad_probe_info_get_buffer(info))) {
+            return GST_PAD_PROBE_DROP;
+        }
     }
 
     return GST_PAD_PROBE_OK;
@@ -1574,6 +2376,53 @@ GstVideoReceiver::_eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_da
     return GST_PAD_PROBE_OK;
 }
 
+GstPadProbeReturn
+GstVideoReceiver::_decodePriorityProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if (info == nullptr || user_data == nullptr) {
+        qCCritical(VideoReceiverLog) << "Invalid arguments";
+        return GST_PAD_PROBE_DROP;
+    }
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    const bool keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    if (pThis->_waitForKeyframe.loadAcquire() && pThis->_waitForKeyframe.fetchAndStoreOrdered(false)) {
+        // Resuming after a warm restart, the normal priority path below goes back to all frames on the next keyframe
+        pThis->_keyframesOnly = true;
+    }
+
+    if (pThis->_decodePriority.loadAcquire() == DECODE_PRIORITY_LOW) {
+        pThis->_keyframesOnly = true;
+    } else if (pThis->_keyframesOnly && keyframe) {
+        // Delta units since the last decoded keyframe reference frames the decoder never saw
+        pThis->_keyframesOnly = false;
+    }
+
+    if (pThis->_keyframesOnly && !keyframe) {
+        return GST_PAD_PROBE_DROP;
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_syncIndexProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if(info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        pThis->_noteRecordedFrame(gst_pad_probe_info_get_buffer(info));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
 GstPadProbeReturn
 GstVideoReceiver::_keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
@@ -1601,3 +2450,69 @@ GstVideoReceiver::_keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer us
 
     return GST_PAD_PROBE_REMOVE;
 }
+
+GstPadProbeReturn
+GstVideoReceiver::_decoderInputProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if(info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        pThis->_noteDecoderInput(gst_pad_probe_info_get_buffer(info));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_decoderOutputProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    if(info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        pThis->_noteDecoderOutput(pad, gst_pad_probe_info_get_buffer(info));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_glSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if(info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        pThis->_noteGlSinkInput(gst_pad_probe_info_get_buffer(info));
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+// Finds the sink pad of the GL sink inside the video sink bin, the point where uploaded frames are handed over for
+// rendering
+GstPad*
+GstVideoReceiver::_glSinkPad(GstElement* videoSink)
+{
+    GstPad* pad = nullptr;
+
+    if (videoSink == nullptr || !GST_IS_BIN(videoSink)) {
+        return nullptr;
+    }
+
+    GstIterator* it;
+
+    if ((it = gst_bin_iterate_sinks(GST_BIN(videoSink))) != nullptr) {
+        GValue vsink = G_VALUE_INIT;
+
+        if (gst_iterator_next(it, &vsink) == GST_ITERATOR_OK) {
+            GstElement* sink = GST_ELEMENT(g_value_get_object(&vsink));
+            pad = gst_element_get_static_pad(sink, "sink");
+            g_value_reset(&vsink);
+        }
+
+        gst_iterator_free(it);
+        it = nullptr;
+    }
+
+    return pad;
+}
@@ -20,10 +20,15 @@
 #include <QThread>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QSemaphore>
+#include <QHash>
+#include <QAtomicInteger>
 #include <QQueue>
 #include <QQuickItem>
+#include <QVariantMap>
 
 #include "VideoReceiver.h"
+#include "VideoSyncIndex.h"
 
 #include <gst/gst.h>
 
@@ -44,6 +49,17 @@ public:
         _taskQueueUpdate.wakeOne();
     }
 
+    // Waits until all tasks dispatched so far have run
+    void sync() {
+        if (needDispatch()) {
+            QSemaphore done;
+            dispatch([&done](){
+                done.release();
+            });
+            done.acquire();
+        }
+    }
+
     void shutdown() {
         if (needDispatch()) {
             dispatch([this](){
@@ -80,6 +96,23 @@ private:
     bool                _shutdown = false;
 };
 
+// Control threads shared by all receivers. Each receiver still has its tasks run in order on a single thread, but
+// N streams use at most _kMaxWorkers threads instead of one each.
+class WorkerPool
+{
+public:
+    // @return The worker with the fewest receivers, a new one is started while below the limit
+    static Worker*  acquire (void);
+    // The worker is shut down once its last receiver releases it
+    static void     release (Worker* worker);
+
+private:
+    static QMutex               _lock;
+    static QHash<Worker*, int>  _users;
+
+    static const int            _kMaxWorkers = 4;
+};
+
 class GstVideoReceiver : public VideoReceiver
 {
     Q_OBJECT
@@ -93,9 +126,11 @@ public slots:
     virtual void stop(void);
     virtual void startDecoding(void* sink);
     virtual void stopDecoding(void);
-    virtual void startRecording(const QString& videoFile, FILE_FORMAT format);
+    virtual void startRecording(const QString& videoFile, FILE_FORMAT format, unsigned segmentMinutes = 0);
     virtual void stopRecording(void);
     virtual void takeScreenshot(const QString& imageFile);
+    virtual void setDecodePriority(DECODE_PRIORITY priority);
+    virtual void setWarmRestart(bool enabled);
 
 protected slots:
     virtual void _watchdog(void);
@@ -104,15 +139,27 @@ protected slots:
 protected:
     virtual GstElement* _makeSource(const QString& uri);
     virtual GstElement* _makeDecoder(GstCaps* caps = nullptr, GstElement* videoSink = nullptr);
-    virtual GstElement* _makeFileSink(const QString& videoFile, FILE_FORMAT format);
+    virtual GstElement* _makeFileSink(const QString& videoFile, FILE_FORMAT format, unsigned segmentMinutes = 0);
 
+    virtual void _linkSource(void);
+    virtual bool _warmRestart(void);
+    virtual void _noteRecovered(void);
     virtual void _onNewSourcePad(GstPad* pad);
     virtual void _onNewDecoderPad(GstPad* pad);
     virtual bool _addDecoder(GstElement* src);
     virtual bool _addVideoSink(GstPad* pad);
-    virtual void _noteTeeFrame(void);
+    virtual void _noteTeeFrame(GstBuffer* buf);
     virtual void _noteVideoSinkFrame(void);
+    virtual bool _dropLateFrame(GstBuffer* buf);
     virtual void _noteEndOfStream(void);
+    virtual void _noteRecordedFrame(GstBuffer* buf);
+    virtual quint64 _wallClockUSecs(GstClockTime pts);
+    virtual void _noteDecoderInput(GstBuffer* buf);
+    virtual void _noteDecoderOutput(GstPad* pad, GstBuffer* buf);
+    virtual void _noteGlSinkInput(GstBuffer* buf);
+    virtual void _reportLatency(void);
+    virtual void _adaptJitterBuffer(void);
+    virtual void _reportBufferedBytes(void);
     virtual bool _unlinkBranch(GstElement* from);
     virtual void _shutdownDecodingBranch (void);
     virtual void _shutdownRecordingBranch(void);
@@ -129,7 +176,13 @@ protected:
     static GstPadProbeReturn _teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _decodePriorityProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _syncIndexProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _decoderInputProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _decoderOutputProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _glSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPad* _glSinkPad(GstElement* videoSink);
 
     bool                _streaming;
     bool                _decoding;
@@ -138,6 +191,7 @@ protected:
     bool                _removingRecorder;
     GstElement*         _source;
     GstElement*         _tee;
+    GstElement*         _decoderQueue;          // owned by the pipeline
     GstElement*         _decoderValve;
     GstElement*         _recorderValve;
     GstElement*         _decoder;
@@ -152,6 +206,58 @@ protected:
 
     QTimer              _watchdogTimer;
 
+    //-- Per stage latency, buffers are matched between stages by PTS
+    typedef struct {
+        GstClockTime    pts;
+        gint64          timeUSecs;
+    } FrameStamp_t;
+
+    typedef enum {
+        STAGE_QUEUE = 0,    // source (tee) to decoder input
+        STAGE_DECODE,       // decoder input to decoder output
+        STAGE_UPLOAD,       // decoder output to GL sink
+        STAGE_TOTAL,        // source (tee) to GL sink
+        STAGE_COUNT
+    } STAGE;
+
+    static const int    _kFrameStampCount       = 64;
+    static const int    _kLatencyBucketCount    = 12;   // bucket 0 is < 1 ms, bucket i is [2^(i-1), 2^i) ms
+
+    typedef struct {
+        quint32         buckets[_kLatencyBucketCount];
+        quint32         count;
+        gint64          sumUSecs;
+        gint64          maxUSecs;
+    } LatencyHistogram_t;
+
+    static void         _stampFrame             (FrameStamp_t* stamps, int& next, GstClockTime pts, gint64 timeUSecs);
+    static gint64       _findFrameStamp         (FrameStamp_t* stamps, GstClockTime pts, bool consume);
+    static void         _addLatency             (LatencyHistogram_t& histogram, gint64 latencyUSecs);
+    static double       _latencyPercentileMSecs (const LatencyHistogram_t& histogram, double percentile);
+    static QVariantMap  _latencyStats           (const LatencyHistogram_t& histogram);
+
+    QMutex              _timingLock;
+    FrameStamp_t        _sourceStamps[_kFrameStampCount];
+    FrameStamp_t        _decoderInStamps[_kFrameStampCount];
+    FrameStamp_t        _decoderOutStamps[_kFrameStampCount];
+    int                 _sourceNext;
+    int                 _decoderInNext;
+    int                 _decoderOutNext;
+    LatencyHistogram_t  _latency[STAGE_COUNT];
+    quint32             _droppedFrames;
+    bool                _droppedLastFrame;
+    bool                _zeroCopy;
+    bool                _zeroCopyChecked;
+    gulong              _glSinkProbeId;
+
+    //-- Latest decoded frame, referenced rather than copied, screenshots are encoded from it on GstScreenshotEncoder
+    QMutex              _screenshotLock;
+    QWaitCondition      _screenshotsIdle;
+    GstSample*          _lastDecodedFrame;
+    int                 _screenshotsPending;
+
+    static const int    _kMaxPendingScreenshots = 16;
+
     //-- RTSP UDP reconnect timeout
     uint64_t            _udpReconnect_us;
 
@@ -159,12 +265,45 @@ protected:
     unsigned            _timeout;
     int                 _buffer;
 
-    Worker              _slotHandler;
+    //-- Low latency profile: adaptive jitter buffer, late frames dropped, no sync
+    bool                _lowLatency;
+    GstElement*         _jitterBuffer;          // owned by the pipeline
+    int                 _jitterBufferMSecs;
+    guint64             _jitterBufferLate;
+    guint64             _jitterBufferLost;
+
+    static const int    _kLowLatencyStartMSecs  = 40;
+    static const int    _kLowLatencyMinMSecs    = 10;
+    static const int    _kLowLatencyMaxMSecs    = 150;
+    static const int    _kLateFrameMSecs        = 100;
+
+    //-- DECODE_PRIORITY_LOW passes only keyframes to the decoder, going back to normal waits for the next keyframe
+    QAtomicInteger<int> _decodePriority;
+    bool                _keyframesOnly;         // streaming thread only
+
+    //-- Warm restart: a stalled source is replaced while the decoding and recording branches keep running
+    QAtomicInteger<bool>    _warmRestartEnabled;
+    QAtomicInteger<bool>    _waitForKeyframe;       // set by a warm restart, picked up by _decodePriorityProbe
+    QAtomicInteger<qint64>  _recoveryStartUSecs;    // 0 - not recovering
+    bool                    _recoveryAtDecoder;     // first frame is measured at the decoder output, else at the tee
+
+    Worker*             _slotHandler;
     uint32_t            _signalDepth;
 
     bool                _endOfStream;
 
     static const char*  _kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN];
+
+    //-- Sidecar index mapping recorded PTS to wall clock time, written from the recording branch streaming thread
+    QMutex              _syncIndexLock;
+    VideoSyncIndex      _syncIndex;
+    gulong              _syncIndexProbeId;
+    GstClockTime        _syncOriginPts;         // PTS of the first recorded keyframe
+
+    static const int    _kRecorderQueueBytes    = 64 * 1024 * 1024;
+    static const int    _kRecorderQueueSecs     = 10;
+    static const int    _kRecorderStopSecs      = 5;
+    static const int    _kFileSinkBufferSize    = 4 * 1024 * 1024;
 };
 
 void* createVideoSink(void* widget);
@@ -17,6 +17,7 @@
 
 #include <QObject>
 #include <QSize>
+#include <QVariantMap>
 
 class VideoReceiver : public QObject
 {
@@ -47,6 +48,13 @@ public:
 
     Q_ENUM(STATUS)
 
+    typedef enum {
+        DECODE_PRIORITY_NORMAL = 0,
+        DECODE_PRIORITY_LOW
+    } DECODE_PRIORITY;
+
+    Q_ENUM(DECODE_PRIORITY)
+
 signals:
     void timeout(void);
     void streamingChanged(bool active);
@@ -54,6 +62,16 @@ signals:
     void recordingChanged(bool active);
     void recordingStarted(void);
     void videoSizeChanged(QSize size);
+    // decodeMSecs: average time a frame spends in the decoder
+    // uploadMSecs: average time from decoder output to the GL sink
+    // zeroCopy: decoded frames reach the GL sink in GPU memory
+    void decodeTimingChanged(double decodeMSecs, double uploadMSecs, bool zeroCopy);
+    // Per stage latency histograms (queue, decode, upload, total) and jitter buffer state over the last second
+    void latencyStatsChanged(QVariantMap stats);
+    // Emitted after a warm restart once the first frame is decoded, or received if not decoding
+    void streamRecovered(double firstFrameMSecs);
+    // Bytes held in the pipeline buffers, reported once per second while running
+    void bufferedBytesChanged(qint64 bytes);
 
     void onStartComplete(STATUS status);
     void onStopComplete(STATUS status);
@@ -61,7 +79,8 @@ signals:
     void onStopDecodingComplete(STATUS status);
     void onStartRecordingComplete(STATUS status);
     void onStopRecordingComplete(STATUS status);
-    void onTakeScreenshotComplete(STATUS status);
+    // Emitted once for every takeScreenshot, after the image has been written when status is STATUS_OK
+    void onTakeScreenshotComplete(STATUS status, QString imageFile);
 
 public slots:
     // buffer:
@@ -72,7 +91,19 @@ public slots:
     virtual void stop(void) = 0;
     virtual void startDecoding(void* sink) = 0;
     virtual void stopDecoding(void) = 0;
-    virtual void startRecording(const QString& videoFile, FILE_FORMAT format) = 0;
+    // segmentMinutes:
+    //      0 - single file
+    //      N - start a new file every N minutes (videoFile_000.ext, videoFile_001.ext...)
+    virtual void startRecording(const QString& videoFile, FILE_FORMAT format, unsigned segmentMinutes = 0) = 0;
     virtual void stopRecording(void) = 0;
     virtual void takeScreenshot(const QString& imageFile) = 0;
+    // priority:
+    //      DECODE_PRIORITY_NORMAL - decode every frame
+    //      DECODE_PRIORITY_LOW - decode keyframes only, for streams which are visible but not in focus
+    // Use stopDecoding for streams which are not visible at all, recording is not affected by either
+    virtual void setDecodePriority(DECODE_PRIORITY priority) = 0;
+    // enabled:
+    //      false - a stream timeout stops the receiver, which is then restarted from scratch
+    //      true - a source timeout only replaces the source, decoding and recording resume on the next keyframe
+    virtual void setWarmRestart(bool enabled) = 0;
 };
@@ -136,6 +136,7 @@ VideoEnabled {
 
     HEADERS += \
         $$PWD/GStreamer.h \
+        $$PWD/GstScreenshotEncoder.h \
         $$PWD/GstVideoReceiver.h \
         $$PWD/VideoReceiver.h
 
@@ -143,6 +144,7 @@ VideoEnabled {
         $$PWD/gstqgcvideosinkbin.c \
         $$PWD/gstqgc.c \
         $$PWD/GStreamer.cc \
+        $$PWD/GstScreenshotEncoder.cc \
         $$PWD/GstVideoReceiver.cc
 
     include($$PWD/../../qmlglsink.pri)
@@ -62,10 +62,10 @@ void BluetoothLink::readBytes()
 {
     if (_targetSocket) {
         while (_targetSocket->bytesAvailable() > 0) {
-            QByteArray datagram;
+            QByteArray& datagram = _receiveBuffer();
             datagram.resize(_targetSocket->bytesAvailable());
-            _targetSocket->read(datagram.data(), datagram.size());
-            emit bytesReceived(this, datagram);
+            datagram.resize(static_cast<int>(qMax(_targetSocket->read(datagram.data(), datagram.size()), static_cast<qint64>(0))));
+            _emitReceiveBuffer();
         }
     }
 }
@@ -39,6 +39,9 @@ LinkConfiguration::LinkConfiguration(LinkConfiguration* copy)
     _dynamic    = copy->isDynamic();
     _autoConnect= copy->isAutoConnect();
     _highLatency= copy->isHighLatency();
+    _signingEnabled         = copy->signingEnabled();
+    _signingKey             = copy->signingKey();
+    _signingAcceptUnsigned  = copy->signingAcceptUnsigned();
     Q_ASSERT(!_name.isEmpty());
 }
 
@@ -50,6 +53,9 @@ void LinkConfiguration::copyFrom(LinkConfiguration* source)
     _dynamic    = source->isDynamic();
     _autoConnect= source->isAutoConnect();
     _highLatency= source->isHighLatency();
+    _signingEnabled         = source->signingEnabled();
+    _signingKey             = source->signingKey();
+    _signingAcceptUnsigned  = source->signingAcceptUnsigned();
 }
 
 /*!
@@ -146,3 +152,27 @@ void LinkConfiguration::setLink(SharedLinkInterfacePtr link)
     _link = link;
     emit linkChanged();
 }
+
+void LinkConfiguration::setSigningEnabled(bool enabled)
+{
+    if (enabled != _signingEnabled) {
+        _signingEnabled = enabled;
+        emit signingChanged();
+    }
+}
+
+void LinkConfiguration::setSigningKey(const QString& key)
+{
+    if (key != _signingKey) {
+        _signingKey = key;
+        emit signingChanged();
+    }
+}
+
+void LinkConfiguration::setSigningAcceptUnsigned(bool accept)
+{
+    if (accept != _signingAcceptUnsigned) {
+        _signingAcceptUnsigned = accept;
+        emit signingChanged();
+    }
+}
@@ -33,6 +33,9 @@ public:
     Q_PROPERTY(QString          settingsURL         READ settingsURL                            CONSTANT)
     Q_PROPERTY(QString          settingsTitle       READ settingsTitle                          CONSTANT)
     Q_PROPERTY(bool             highLatency         READ isHighLatency  WRITE setHighLatency    NOTIFY highLatencyChanged)
+    Q_PROPERTY(bool             signingEnabled      READ signingEnabled         WRITE setSigningEnabled         NOTIFY signingChanged)
+    Q_PROPERTY(QString          signingKey          READ signingKey             WRITE setSigningKey             NOTIFY signingChanged)
+    Q_PROPERTY(bool             signingAcceptUnsigned READ signingAcceptUnsigned WRITE setSigningAcceptUnsigned NOTIFY signingChanged)
 
     // Property accessors
 
@@ -71,6 +74,15 @@ public:
      */
     bool isHighLatency() const{ return _highLatency; }
 
+    /// MAVLink 2 message signing. Takes effect the next time the link is connected.
+    bool    signingEnabled          () const { return _signingEnabled; }
+    QString signingKey              () const { return _signingKey; }            ///< Passphrase the secret key is derived from
+    bool    signingAcceptUnsigned   () const { return _signingAcceptUnsigned; } ///< Let unsigned incoming messages through
+
+    void setSigningEnabled          (bool enabled);
+    void setSigningKey              (const QString& key);
+    void setSigningAcceptUnsigned   (bool accept);
+
     /*!
      * Set if this is this a dynamic configuration. (decided at runtime)
     */
@@ -167,6 +179,7 @@ signals:
     void dynamicChanged     ();
     void autoConnectChanged ();
     void highLatencyChanged ();
+    void signingChanged     ();
     void linkChanged        ();
 
 protected:
@@ -177,6 +190,9 @@ private:
     bool    _dynamic;       ///< A connection added automatically and not persistent (unless it's edited).
     bool    _autoConnect;   ///< This connection is started automatically at boot
     bool    _highLatency;
+    bool    _signingEnabled         = false;
+    QString _signingKey;
+    bool    _signingAcceptUnsigned  = false;
 };
 
 typedef std::shared_ptr<LinkConfiguration>  SharedLinkConfigurationPtr;
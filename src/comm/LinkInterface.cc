@@ -9,6 +9,7 @@
 
 #include "LinkInterface.h"
 #include "LinkManager.h"
+#include "MAVLinkFrameScanner.h"
 #include "QGCApplication.h"
 
 QGC_LOGGING_CATEGORY(LinkInterfaceLog, "LinkInterfaceLog")
@@ -16,6 +17,8 @@ QGC_LOGGING_CATEGORY(LinkInterfaceLog, "LinkInterfaceLog")
 // The LinkManager is only forward declared in the header, so the static_assert is here instead.
 static_assert(LinkManager::invalidMavlinkChannel() == std::numeric_limits<uint8_t>::max(), "update LinkInterface::_mavlinkChannel");
 
+const QEvent::Type LinkInterface::_writeServiceEvent = static_cast<QEvent::Type>(QEvent::registerEventType());
+
 LinkInterface::LinkInterface(SharedLinkConfigurationPtr& config, bool isPX4Flow)
     : QThread   (0)
     , _config   (config)
@@ -24,8 +27,9 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPtr& config, bool isPX4Flow)
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     qRegisterMetaType<LinkInterface*>("LinkInterface*");
 
-    // This will cause the writeBytes calls to end up on the thread of the link
-    QObject::connect(this, &LinkInterface::_invokeWriteBytes, this, &LinkInterface::_writeBytes);
+    // Time stamps received bytes on the link thread. This is connected first so it always runs before the receiver
+    // is notified.
+    QObject::connect(this, &LinkInterface::bytesReceived, this, &LinkInterface::_recordReceiveTimestamp, Qt::DirectConnection);
 }
 
 LinkInterface::~LinkInterface()
@@ -80,9 +84,183 @@ void LinkInterface::_freeMavlinkChannel()
     _mavlinkChannel = LinkManager::invalidMavlinkChannel();
 }
 
-void LinkInterface::writeBytesThreadSafe(const char *bytes, int length)
+void LinkInterface::writeBytesThreadSafe(const char *bytes, int length, WritePriority_t priority, int vehicleId)
+{
+    QByteArray message(bytes, length);
+    if (_signing.enabled()) {
+        // Signed before queueing so time stamps follow the order the messages were written in
+        _signing.signFrame(message);
+    }
+
+    QMutexLocker locker(&_writeQueueMutex);
+
+    WriteClass_t&       writeClass  = _writeClasses[priority];
+    WriteQueueStats_t&  stats       = _writeStats[priority];
+    writeClass.vehicleQueues[vehicleId].enqueue(message);
+    writeClass.queuedMessages++;
+    stats.queuedMessages    = writeClass.queuedMessages;
+    stats.maxQueuedMessages = qMax(stats.maxQueuedMessages, stats.queuedMessages);
+
+    bool postNormal = false;
+    bool postHigh   = false;
+    if (priority == WritePriorityRealtime) {
+        postHigh = !_writeServiceHighPosted;
+        _writeServiceHighPosted = true;
+    } else {
+        postNormal = !_writeServicePosted && !_writeServiceHighPosted;
+        _writeServicePosted = true;
+    }
+    locker.unlock();
+
+    if (postHigh) {
+        _postWriteService(Qt::HighEventPriority);
+    } else if (postNormal) {
+        _postWriteService(Qt::NormalEventPriority);
+    }
+}
+
+void LinkInterface::setRadioTxBufferThreadSafe(int txBufferPercent)
+{
+    QMutexLocker locker(&_writeQueueMutex);
+    _radioTxBuffer = txBufferPercent;
+    _radioTxBufferTimer.start();
+}
+
+QVector<LinkInterface::WriteQueueStats_t> LinkInterface::writeQueueStats(void)
 {
-    emit _invokeWriteBytes(QByteArray(bytes, length));
+    QMutexLocker locker(&_writeQueueMutex);
+    return QVector<WriteQueueStats_t>(std::begin(_writeStats), std::end(_writeStats));
+}
+
+LinkInterface::WritePriority_t LinkInterface::writePriorityForMessage(uint32_t msgid)
+{
+    switch (msgid) {
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+    case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+    case MAVLINK_MSG_ID_FOLLOW_TARGET:
+        return WritePriorityRealtime;
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    case MAVLINK_MSG_ID_COMMAND_INT:
+    case MAVLINK_MSG_ID_COMMAND_ACK:
+    case MAVLINK_MSG_ID_SET_MODE:
+        return WritePriorityHigh;
+    case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+    case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+    case MAVLINK_MSG_ID_MISSION_ACK:
+    case MAVLINK_MSG_ID_LOG_REQUEST_LIST:
+    case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        return WritePriorityBulk;
+    default:
+        return WritePriorityNormal;
+    }
+}
+
+void LinkInterface::_postWriteService(Qt::EventPriority priority)
+{
+    QCoreApplication::postEvent(this, new QEvent(_writeServiceEvent), priority);
+}
+
+bool LinkInterface::event(QEvent* event)
+{
+    if (event->type() == _writeServiceEvent) {
+        _serviceWriteQueues();
+        return true;
+    }
+    return QThread::event(event);
+}
+
+void LinkInterface::_serviceWriteQueues(void)
+{
+    QByteArray  bytes;
+    bool        morePending = false;
+    bool        held        = false;
+
+    QMutexLocker locker(&_writeQueueMutex);
+
+    _writeServicePosted     = false;
+    _writeServiceHighPosted = false;
+
+    const bool radioTxBufferValid = _radioTxBufferTimer.isValid() && _radioTxBufferTimer.elapsed() < _radioTxBufferTimeoutMSecs;
+
+    for (int priority=0; priority<WritePriorityCount; priority++) {
+        WriteClass_t&       writeClass  = _writeClasses[priority];
+        WriteQueueStats_t&  stats       = _writeStats[priority];
+
+        if (writeClass.queuedMessages == 0) {
+            continue;
+        }
+        if (radioTxBufferValid &&
+                ((priority == WritePriorityBulk && _radioTxBuffer < _bulkHoldTxBuffer) ||
+                 (priority == WritePriorityNormal && _radioTxBuffer < _normalHoldTxBuffer))) {
+            held = true;
+            stats.heldPasses++;
+            continue;
+        }
+
+        // Realtime and high priority writes always go out in full
+        const bool limited = priority >= WritePriorityNormal;
+        while (writeClass.queuedMessages && (!limited || bytes.size() < _maxWriteBytesPerPass)) {
+            auto vehicleQueue = writeClass.vehicleQueues.upperBound(writeClass.lastVehicleId);
+            if (vehicleQueue == writeClass.vehicleQueues.end()) {
+                vehicleQueue = writeClass.vehicleQueues.begin();
+            }
+            const QByteArray message = vehicleQueue->dequeue();
+            writeClass.lastVehicleId = vehicleQueue.key();
+            if (vehicleQueue->isEmpty()) {
+                writeClass.vehicleQueues.erase(vehicleQueue);
+            }
+            writeClass.queuedMessages--;
+            stats.sentMessages++;
+            stats.sentBytes += static_cast<quint64>(message.size());
+            bytes.append(message);
+        }
+        stats.queuedMessages = writeClass.queuedMessages;
+        morePending |= writeClass.queuedMessages != 0;
+    }
+
+    bool postService = false;
+    if (morePending && !_writeServicePosted && !_writeServiceHighPosted) {
+        _writeServicePosted = true;
+        postService = true;
+    }
+    bool startRetry = false;
+    if (held && !morePending && !_writeRetryPending) {
+        _writeRetryPending = true;
+        startRetry = true;
+    }
+
+    if (!_writeStatsLogTimer.isValid() || _writeStatsLogTimer.elapsed() > _writeStatsLogMSecs) {
+        _writeStatsLogTimer.start();
+        for (int priority=0; priority<WritePriorityCount; priority++) {
+            const WriteQueueStats_t& stats = _writeStats[priority];
+            qCDebug(LinkInterfaceLog) << "Write queue" << priority << "queued:max" << stats.queuedMessages << stats.maxQueuedMessages
+                                      << "sent:bytes" << stats.sentMessages << stats.sentBytes << "held" << stats.heldPasses;
+        }
+    }
+
+    locker.unlock();
+
+    if (postService) {
+        _postWriteService(Qt::NormalEventPriority);
+    }
+    if (startRetry) {
+        // Check again once the radio has had a chance to report more free buffer
+        QTimer::singleShot(_writeHeldRetryMSecs, this, [this]() {
+            _writeQueueMutex.lock();
+            _writeRetryPending = false;
+            _writeQueueMutex.unlock();
+            _serviceWriteQueues();
+        });
+    }
+    if (!bytes.isEmpty()) {
+        _writeBytes(bytes);
+    }
 }
 
 void LinkInterface::addVehicleReference(void)
@@ -102,6 +280,148 @@ void LinkInterface::removeVehicleReference(void)
     }
 }
 
+void LinkInterface::enableLinkThreadDecoding(void)
+{
+    if (_linkThreadDecoding) {
+        return;
+    }
+    _linkThreadDecoding = true;
+
+    // Direct connection causes decoding to happen on the thread which emitted the bytes
+    QObject::connect(this, &LinkInterface::bytesReceived, this, &LinkInterface::_decodeReceivedBytes, Qt::DirectConnection);
+}
+
+QVector<mavlink_message_t> LinkInterface::takeReceivedMessages(int* parseErrors)
+{
+    QVector<mavlink_message_t> messages;
+
+    QMutexLocker locker(&_receivedMessagesMutex);
+    messages.swap(_receivedMessages);
+    _receivedMessages.swap(_spareReceivedMessages);
+    if (parseErrors) {
+        *parseErrors = _receivedParseErrors;
+    }
+    _receivedParseErrors = 0;
+    return messages;
+}
+
+void LinkInterface::recycleReceivedMessages(QVector<mavlink_message_t>& messages)
+{
+    // clear keeps the capacity as long as nobody else holds on to the batch
+    messages.clear();
+    if (messages.capacity() == 0 || messages.capacity() > _maxRecycledMessages) {
+        return;
+    }
+
+    QMutexLocker locker(&_receivedMessagesMutex);
+    if (messages.capacity() > _spareReceivedMessages.capacity()) {
+        _spareReceivedMessages.swap(messages);
+    }
+}
+
+QByteArray& LinkInterface::_receiveBuffer(void)
+{
+    if (_currentReceiveBuffer >= 0) {
+        return _receiveBufferPool[_currentReceiveBuffer];
+    }
+
+    if (_receiveBufferPool.isEmpty()) {
+        // One extra slot for when every pooled slab is still held downstream
+        _receiveBufferPool.resize(_receiveBufferPoolSize + 1);
+    }
+
+    // A slab is free once nobody downstream holds a copy of it anymore. The reference count is atomic, so this is safe
+    // even though receivers release their copies on other threads.
+    int index = _receiveBufferPoolSize;
+    for (int i=0; i<_receiveBufferPoolSize; i++) {
+        if (_receiveBufferPool[i].isNull() || _receiveBufferPool[i].isDetached()) {
+            index = i;
+            break;
+        }
+    }
+
+    QByteArray& buffer = _receiveBufferPool[index];
+    if (!buffer.isNull() && (!buffer.isDetached() || buffer.capacity() > _maxReceiveBufferCapacity)) {
+        buffer = QByteArray();
+    }
+    if (buffer.capacity() < _receiveBufferCapacity) {
+        // reserve also makes resize(0) keep the allocation
+        buffer.reserve(_receiveBufferCapacity);
+    }
+    buffer.resize(0);
+
+    _currentReceiveBuffer = index;
+    return buffer;
+}
+
+void LinkInterface::_emitReceiveBuffer(void)
+{
+    if (_currentReceiveBuffer < 0) {
+        return;
+    }
+    const int index = _currentReceiveBuffer;
+    _currentReceiveBuffer = -1;
+    emit bytesReceived(this, _receiveBufferPool[index]);
+}
+
+void LinkInterface::_recordReceiveTimestamp(LinkInterface* /*link*/, QByteArray /*bytes*/)
+{
+    qint64 timestampUSecs = MAVLinkMetrics::nowUSecs();
+
+    QMutexLocker locker(&_receiveTimestampsMutex);
+    if (_receiveTimestamps.count() >= _maxReceiveTimestamps) {
+        // Receiver isn't keeping up (or isn't consuming), don't grow without bounds
+        _receiveTimestamps.dequeue();
+    }
+    _receiveTimestamps.enqueue(timestampUSecs);
+}
+
+bool LinkInterface::takeReceiveTimestamp(qint64& timestampUSecs, int& queueDepth, bool allPending)
+{
+    QMutexLocker locker(&_receiveTimestampsMutex);
+
+    if (_receiveTimestamps.isEmpty()) {
+        return false;
+    }
+
+    queueDepth      = _receiveTimestamps.count();
+    timestampUSecs  = _receiveTimestamps.dequeue();
+    if (allPending) {
+        _receiveTimestamps.clear();
+    }
+    return true;
+}
+
+void LinkInterface::_configureSigning(void)
+{
+    if (_config->signingEnabled()) {
+        // The link id is only used to tell our links apart in the signature, the channel does that already
+        _signing.configure(MAVLinkSigning::keyFromPassphrase(_config->signingKey()), mavlinkChannel(), _config->signingAcceptUnsigned());
+    } else {
+        _signing.disable();
+    }
+}
+
+void LinkInterface::_decodeReceivedBytes(LinkInterface* /*link*/, QByteArray bytes)
+{
+    QMutexLocker locker(&_receivedMessagesMutex);
+
+    // Only signal when the pending list goes from empty to non-empty. Everything decoded before the receiver gets
+    // around to takeReceivedMessages is coalesced into the same delivery.
+    bool notify = _receivedMessages.isEmpty();
+    const int firstNew = _receivedMessages.count();
+    MAVLinkFrameScanner::parse(mavlinkChannel(), reinterpret_cast<const uint8_t*>(bytes.constData()), bytes.size(), _receivedMessages, nullptr, &_receivedParseErrors);
+    // Everything decoded from this buffer is verified as one batch, rejected messages never leave the link thread
+    _signing.verify(_receivedMessages, firstNew);
+    notify &= !_receivedMessages.isEmpty();
+
+    locker.unlock();
+
+    if (notify) {
+        emit messagesReceived(this);
+    }
+}
+
 void LinkInterface::_connectionRemoved(void)
 {
     if (_vehicleReferenceCount == 0) {
@@ -18,12 +18,19 @@
 #include <QSharedPointer>
 #include <QDebug>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QVector>
+#include <QQueue>
 
 #include <memory>
 
 #include "QGCMAVLink.h"
 #include "LinkConfiguration.h"
 #include "MavlinkMessagesTimer.h"
+#include "MAVLinkMetrics.h"
+#include "MAVLinkSequenceState.h"
+#include "MAVLinkSigning.h"
 
 class LinkManager;
 
@@ -45,6 +52,7 @@ public:
 
     Q_PROPERTY(bool isPX4Flow   READ isPX4Flow  CONSTANT)
     Q_PROPERTY(bool isMockLink  READ isMockLink CONSTANT)
+    Q_PROPERTY(MAVLinkMetrics* metrics READ metrics CONSTANT)
 
     // Property accessors
     bool isPX4Flow(void) const { return _isPX4Flow; }
@@ -56,6 +64,12 @@ public:
 
     SharedLinkConfigurationPtr linkConfiguration(void) { return _config; }
 
+    /// Receive metrics for this link, maintained by MAVLinkProtocol
+    MAVLinkMetrics* metrics(void) { return &_metrics; }
+
+    /// Receive sequence state for this link, only used from the MAVLinkProtocol thread
+    MAVLinkSequenceState& sequenceState(void) { return _sequenceState; }
+
     Q_INVOKABLE virtual void    disconnect  (void) = 0;
 
     virtual bool isConnected    (void) const = 0;
@@ -66,17 +80,76 @@ public:
 
     bool    decodedFirstMavlinkPacket   (void) const { return _decodedFirstMavlinkPacket; }
     bool    setDecodedFirstMavlinkPacket(bool decodedFirstMavlinkPacket) { return _decodedFirstMavlinkPacket = decodedFirstMavlinkPacket; }
-    void    writeBytesThreadSafe        (const char *bytes, int length);
+    /// Outbound priority classes. Each class is written ahead of the ones below it, writes of one vehicle keep their
+    /// order within a class.
+    typedef enum {
+        WritePriorityRealtime,      ///< Time critical streams such as MANUAL_CONTROL
+        WritePriorityHigh,          ///< Commands and heartbeats
+        WritePriorityNormal,
+        WritePriorityBulk,          ///< Transfers which can wait: FTP, mission and log transfer
+        WritePriorityCount
+    } WritePriority_t;
+
+    /// Outbound stats for one priority class
+    typedef struct {
+        int     queuedMessages;         ///< Currently waiting
+        int     maxQueuedMessages;      ///< Most ever waiting at once
+        quint64 sentMessages;
+        quint64 sentBytes;
+        quint64 heldPasses;             ///< Write passes which held the class back because the radio tx buffer was low
+    } WriteQueueStats_t;
+
+    /// Queues bytes for writing on the link thread
+    ///     @param priority     Priority class of the bytes
+    ///     @param vehicleId    Vehicle the bytes are for, vehicles sharing a link are serviced round robin within a class
+    void    writeBytesThreadSafe        (const char *bytes, int length, WritePriority_t priority = WritePriorityNormal, int vehicleId = 0);
+
+    /// Sets the free radio tx buffer in percent as reported by RADIO_STATUS. Normal and bulk writes are held back
+    /// while it is low. Ignored once no report has been received for _radioTxBufferTimeoutMSecs.
+    void    setRadioTxBufferThreadSafe  (int txBufferPercent);
+
+    /// @return Stats for each priority class, indexed by WritePriority_t
+    QVector<WriteQueueStats_t> writeQueueStats(void);
+
+    /// @return Default priority class for a message id
+    static WritePriority_t writePriorityForMessage(uint32_t msgid);
+
     void    addVehicleReference         (void);
     void    removeVehicleReference      (void);
 
+    /// Opt-in link thread decoding. Once enabled the bytes emitted through bytesReceived are decoded on the thread
+    /// which emitted them and messagesReceived is signalled once for each batch of pending messages.
+    void                        enableLinkThreadDecoding(void);
+    bool                        linkThreadDecoding      (void) const { return _linkThreadDecoding; }
+
+    /// Returns all messages decoded on the link thread since the last call, in receive order
+    ///     @param parseErrors Optional: returns the number of parse errors since the last call
+    QVector<mavlink_message_t>  takeReceivedMessages    (int* parseErrors = nullptr);
+
+    /// @return true: MAVLink 2 signing is set up, incoming messages are verified and outgoing ones signed
+    bool                        signingEnabled          (void) const { return _signing.enabled(); }
+
+    /// Returns the signature verification counts since the last call
+    MAVLinkSigning::Counts_t    takeSigningCounts       (void) { return _signing.takeCounts(); }
+
+    /// Hands a batch returned by takeReceivedMessages back once it is processed. Its storage is reused for the next
+    /// batch, so a busy link does not allocate on every delivery.
+    void                        recycleReceivedMessages (QVector<mavlink_message_t>& messages);
+
+    /// Returns the time bytesReceived was emitted for the oldest buffer not yet processed by the receiver
+    ///     @param timestampUSecs   MAVLinkMetrics::nowUSecs time stamp
+    ///     @param queueDepth       Number of buffers waiting, including this one
+    ///     @param allPending       true: consume all waiting buffers, false: consume the oldest buffer only
+    /// @return false: no buffers waiting
+    bool takeReceiveTimestamp(qint64& timestampUSecs, int& queueDepth, bool allPending);
+
 signals:
     void bytesReceived      (LinkInterface* link, QByteArray data);
+    void messagesReceived   (LinkInterface* link);  ///< Link thread decoding only: messages are available from takeReceivedMessages
     void bytesSent          (LinkInterface* link, QByteArray data);
     void connected          (void);
     void disconnected       (void);
     void communicationError (const QString& title, const QString& error);
-    void _invokeWriteBytes  (QByteArray);
 
 protected:
     // Links are only created by LinkManager so constructor is not public
@@ -84,6 +157,14 @@ protected:
 
     void _connectionRemoved(void);
 
+    /// Buffer to read received bytes into, from a small per-link pool of recycled slabs. It stays the same buffer
+    /// across calls until _emitReceiveBuffer hands it downstream. A slab is reused once every receiver of
+    /// bytesReceived has released its copy, so steady traffic reads without allocating. Link thread only.
+    QByteArray& _receiveBuffer      (void);
+
+    /// Emits bytesReceived with the current receive buffer, the next _receiveBuffer call starts a new one
+    void        _emitReceiveBuffer  (void);
+
     SharedLinkConfigurationPtr _config;
 
     ///
@@ -97,6 +178,9 @@ protected:
     virtual bool _allocateMavlinkChannel();
     virtual void _freeMavlinkChannel    ();
 
+    // Override from QObject
+    bool event(QEvent* event) override;
+
 private slots:
     virtual void _writeBytes(const QByteArray) = 0; // Not thread safe if called directly, only writeBytesThreadSafe is thread safe
 
@@ -104,10 +188,66 @@ private:
     // connect is private since all links should be created through LinkManager::createConnectedLink calls
     virtual bool _connect(void) = 0;
 
+    void _configureSigning      (void);
+    void _decodeReceivedBytes   (LinkInterface* link, QByteArray bytes);
+    void _recordReceiveTimestamp(LinkInterface* link, QByteArray bytes);
+    void _serviceWriteQueues    (void);
+    void _postWriteService      (Qt::EventPriority priority);
+
     uint8_t _mavlinkChannel             = std::numeric_limits<uint8_t>::max();
     bool    _decodedFirstMavlinkPacket  = false;
     bool    _isPX4Flow                  = false;
     int     _vehicleReferenceCount      = 0;
+    bool    _linkThreadDecoding         = false;
+
+    QMutex                      _receivedMessagesMutex;
+    QVector<mavlink_message_t>  _receivedMessages;          ///< Messages decoded on the link thread which have not been taken yet
+    QVector<mavlink_message_t>  _spareReceivedMessages;     ///< Empty, recycled storage for the next batch
+    int                         _receivedParseErrors = 0;
+    MAVLinkSigning              _signing;                   ///< Verifies on the link thread, signs in writeBytesThreadSafe
+
+    static const int _maxRecycledMessages = 1024;           ///< Larger batches are freed instead of kept around
+
+    QVector<QByteArray> _receiveBufferPool;
+    int                 _currentReceiveBuffer = -1;         ///< Index into _receiveBufferPool, -1 for none
+
+    static const int _receiveBufferPoolSize     = 8;        ///< More in flight than this and new buffers are allocated
+    static const int _receiveBufferCapacity     = 16 * 1024;
+    static const int _maxReceiveBufferCapacity  = 512 * 1024; ///< Slabs which grew larger than this are not kept
+
+    QMutex          _receiveTimestampsMutex;
+    QQueue<qint64>  _receiveTimestamps;                     ///< Link thread receive time for each buffer not processed yet
+    MAVLinkMetrics  _metrics;
+    MAVLinkSequenceState _sequenceState;
+
+    static const int _maxReceiveTimestamps = 1024;
+
+    typedef struct {
+        QMap<int, QQueue<QByteArray>>   vehicleQueues;          ///< Only vehicles with waiting writes have an entry
+        int                             lastVehicleId = -1;     ///< Round robin position
+        int                             queuedMessages = 0;
+    } WriteClass_t;
+
+    // Writes are queued on the calling thread and written by a service pass on the link thread. A pass is started by
+    // a posted event, high priority if realtime bytes are waiting so it is handled ahead of other pending events.
+    QMutex              _writeQueueMutex;
+    WriteClass_t        _writeClasses[WritePriorityCount];
+    WriteQueueStats_t   _writeStats[WritePriorityCount] = {};
+    bool                _writeServicePosted     = false;
+    bool                _writeServiceHighPosted = false;
+    bool                _writeRetryPending      = false;
+    int                 _radioTxBuffer          = 100;
+    QElapsedTimer       _radioTxBufferTimer;                ///< Started on each RADIO_STATUS report
+    QElapsedTimer       _writeStatsLogTimer;
+
+    static const int    _bulkHoldTxBuffer           = 50;   ///< Bulk writes are held below this free tx buffer percentage
+    static const int    _normalHoldTxBuffer         = 20;   ///< Normal writes are held below this free tx buffer percentage
+    static const int    _radioTxBufferTimeoutMSecs  = 5000;
+    static const int    _writeHeldRetryMSecs        = 50;
+    static const int    _maxWriteBytesPerPass       = 2048; ///< Limit for normal and bulk bytes per pass, so new realtime bytes are not stuck behind a long burst
+    static const int    _writeStatsLogMSecs         = 10000;
+
+    static const QEvent::Type _writeServiceEvent;
 
     QMap<int /* vehicle id */, MavlinkMessagesTimer*> _mavlinkMessagesTimers;
 };
@@ -56,6 +56,7 @@ const int LinkManager::_autoconnectConnectDelayMSecs =  6000;
 #else
 const int LinkManager::_autoconnectConnectDelayMSecs =  1000;
 #endif
+const int LinkManager::_serialPortFallbackScanMSecs =   10000;
 
 LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
@@ -65,6 +66,11 @@ LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     , _mavlinkChannelsUsedBitMask(1)    // We never use channel 0 to avoid sequence numbering problems
     , _autoConnectSettings(nullptr)
     , _mavlinkProtocol(nullptr)
+    #ifndef NO_SERIAL_LINK
+    , _serialPortWatcher(nullptr)
+    , _serialPortScanPending(true)
+    , _lastSerialPortScanMSecs(0)
+    #endif
     #ifndef __mobile__
     #ifndef NO_SERIAL_LINK
     , _nmeaPort(nullptr)
@@ -92,8 +98,28 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
     _autoConnectSettings = toolbox->settingsManager()->autoConnectSettings();
     _mavlinkProtocol = _toolbox->mavlinkProtocol();
 
+#ifndef NO_SERIAL_LINK
+    // Serial ports are only enumerated when the OS reports a change, or when a change to the autoconnect settings
+    // may lead to a different result. The timer still drives the network autoconnect links and the bootloader wait.
+    _serialPortWatcher = new SerialPortWatcher(this);
+    connect(_serialPortWatcher, &SerialPortWatcher::portsChanged, this, &LinkManager::_serialPortsChanged);
+    Fact* rgAutoConnectFacts[] = {
+        _autoConnectSettings->autoConnectPixhawk(),
+        _autoConnectSettings->autoConnectSiKRadio(),
+        _autoConnectSettings->autoConnectPX4Flow(),
+        _autoConnectSettings->autoConnectRTKGPS(),
+        _autoConnectSettings->autoConnectLibrePilot(),
+        _autoConnectSettings->autoConnectNmeaPort(),
+        _autoConnectSettings->autoConnectNmeaBaud(),
+    };
+    for (Fact* fact: rgAutoConnectFacts) {
+        connect(fact, &Fact::rawValueChanged, this, &LinkManager::_serialPortsChanged);
+    }
+#endif
+
+    _autoconnectClock.start();
     connect(&_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
-    _portListTimer.start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
+    _portListTimer.start(_autoconnectUpdateTimerMSecs);
 
 }
 
@@ -152,7 +178,14 @@ bool LinkManager::createConnectedLink(SharedLinkConfigurationPtr& config, bool i
         config->setLink(link);
 
         connect(link.get(), &LinkInterface::communicationError,  _app,                &QGCApplication::criticalMessageBoxOnMainThread);
-        connect(link.get(), &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+        // Signature verification runs as part of link thread decoding
+        link->_configureSigning();
+        if (_toolbox->settingsManager()->appSettings()->mavlinkDecodeOnLinkThread()->rawValue().toBool() || config->signingEnabled()) {
+            link->enableLinkThreadDecoding();
+            connect(link.get(), &LinkInterface::messagesReceived, _mavlinkProtocol,    &MAVLinkProtocol::receiveMessages);
+        } else {
+            connect(link.get(), &LinkInterface::bytesReceived,    _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+        }
         connect(link.get(), &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
         connect(link.get(), &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
@@ -207,6 +240,11 @@ void LinkManager::_linkDisconnected(void)
     disconnect(link, &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
     disconnect(link, &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
+#ifndef NO_SERIAL_LINK
+    // A board which is still plugged in should be picked up again by autoconnect
+    _serialPortScanPending = true;
+#endif
+
     link->_freeMavlinkChannel();
     for (int i=0; i<_rgLinks.count(); i++) {
         if (_rgLinks[i].get() == link) {
@@ -268,6 +306,9 @@ void LinkManager::saveLinkConfigurationList()
                 settings.setValue(root + "/type", linkConfig->type());
                 settings.setValue(root + "/auto", linkConfig->isAutoConnect());
                 settings.setValue(root + "/high_latency", linkConfig->isHighLatency());
+                settings.setValue(root + "/signing", linkConfig->signingEnabled());
+                settings.setValue(root + "/signing_key", linkConfig->signingKey());
+                settings.setValue(root + "/signing_accept_unsigned", linkConfig->signingAcceptUnsigned());
                 // Have the instance save its own values
                 linkConfig->saveSettings(settings, root);
             }
@@ -331,6 +372,9 @@ void LinkManager::loadLinkConfigurationList()
                                 //-- Have the instance load its own values
                                 link->setAutoConnect(autoConnect);
                                 link->setHighLatency(highLatency);
+                                link->setSigningEnabled(settings.value(root + "/signing", false).toBool());
+                                link->setSigningKey(settings.value(root + "/signing_key").toString());
+                                link->setSigningAcceptUnsigned(settings.value(root + "/signing_accept_unsigned", false).toBool());
                                 link->loadSettings(settings, root);
                                 addConfiguration(link);
                             }
@@ -415,11 +459,19 @@ void LinkManager::_addMAVLinkForwardingLink(void)
             UDPConfiguration* udpConfig = new UDPConfiguration(_mavlinkForwardingLinkName);
             udpConfig->setDynamic(true);
 
-            QString hostName = _toolbox->settingsManager()->appSettings()->forwardMavlinkHostName()->rawValue().toString();
-            udpConfig->addHost(hostName);
+            // A single link is used for all forwarding hosts, UDPLink writes each datagram to all of its target hosts
+            QString hostNames = _toolbox->settingsManager()->appSettings()->forwardMavlinkHostName()->rawValue().toString();
+            for (const QString& hostName: hostNames.split(",", Qt::SkipEmptyParts)) {
+                udpConfig->addHost(hostName.trimmed());
+            }
 
             SharedLinkConfigurationPtr config = addConfiguration(udpConfig);
-            createConnectedLink(config);
+            if (createConnectedLink(config)) {
+                SharedLinkInterfacePtr link = sharedLinkInterfacePointerForLink(config->link());
+                if (link) {
+                    _mavlinkProtocol->forwarder()->addDestination(link, _mavlinkProtocol->forwardingFilter());
+                }
+            }
         }
     }
 }
@@ -528,6 +580,12 @@ void LinkManager::_updateAutoConnectLinks(void)
 #endif
 
 #ifndef NO_SERIAL_LINK
+    if (!_serialPortScanRequired()) {
+        return;
+    }
+    _serialPortScanPending = false;
+    _lastSerialPortScanMSecs = _autoconnectClock.elapsed();
+
     QStringList                 currentPorts;
     QList<QGCSerialPortInfo>    portList;
 #ifdef __android__
@@ -590,6 +648,7 @@ void LinkManager::_updateAutoConnectLinks(void)
                 if (portInfo.isBootloader()) {
                     // Don't connect to bootloader
                     qCDebug(LinkManagerLog) << "Waiting for bootloader to finish" << portInfo.systemLocation();
+                    _serialPortScanPending = true;
                     continue;
                 }
                 if (_portAlreadyConnected(portInfo.systemLocation()) || _autoConnectRTKPort == portInfo.systemLocation()) {
@@ -599,8 +658,8 @@ void LinkManager::_updateAutoConnectLinks(void)
                     // are in the bootloader is flaky from a cross-platform standpoint. So by putting it on a wait list
                     // and only connect on the second pass we leave enough time for the board to boot up.
                     qCDebug(LinkManagerLog) << "Waiting for next autoconnect pass" << portInfo.systemLocation();
-                    _autoconnectPortWaitList[portInfo.systemLocation()] = 1;
-                } else if (++_autoconnectPortWaitList[portInfo.systemLocation()] * _autoconnectUpdateTimerMSecs > _autoconnectConnectDelayMSecs) {
+                    _autoconnectPortWaitList[portInfo.systemLocation()] = _autoconnectClock.elapsed();
+                } else if (_autoconnectClock.elapsed() - _autoconnectPortWaitList[portInfo.systemLocation()] >= _autoconnectConnectDelayMSecs) {
                     SerialConfiguration* pSerialConfig = nullptr;
                     _autoconnectPortWaitList.remove(portInfo.systemLocation());
                     switch (boardType) {
@@ -652,6 +711,15 @@ void LinkManager::_updateAutoConnectLinks(void)
             }
     }
 
+    // Forget ports which went away before they were connected
+    for (auto it = _autoconnectPortWaitList.begin(); it != _autoconnectPortWaitList.end(); ) {
+        if (currentPorts.contains(it.key())) {
+            ++it;
+        } else {
+            it = _autoconnectPortWaitList.erase(it);
+        }
+    }
+
 #ifndef __mobile__
     // Check for RTK GPS connection gone
     if (!_autoConnectRTKPort.isEmpty() && !currentPorts.contains(_autoConnectRTKPort)) {
@@ -664,6 +732,27 @@ void LinkManager::_updateAutoConnectLinks(void)
 #endif // NO_SERIAL_LINK
 }
 
+#ifndef NO_SERIAL_LINK
+bool LinkManager::_serialPortScanRequired(void)
+{
+    if (_serialPortScanPending || !_autoconnectPortWaitList.isEmpty() || !_serialPortWatcher->active()) {
+        return true;
+    }
+
+    // Low rate scan in case a change notification was missed
+    return _autoconnectClock.elapsed() - _lastSerialPortScanMSecs >= _serialPortFallbackScanMSecs;
+}
+#endif
+
+void LinkManager::_serialPortsChanged(void)
+{
+#ifndef NO_SERIAL_LINK
+    qCDebug(LinkManagerLog) << "Serial port list changed";
+    _serialPortScanPending = true;
+    _updateAutoConnectLinks();
+#endif
+}
+
 void LinkManager::shutdown(void)
 {
     setConnectionsSuspended(tr("Shutdown"));
@@ -856,17 +945,25 @@ void LinkManager::startAutoConnectedLinks(void)
 
 uint8_t LinkManager::allocateMavlinkChannel(void)
 {
-    // Find a mavlink channel to use for this link
-    for (uint8_t mavlinkChannel = 0; mavlinkChannel < MAVLINK_COMM_NUM_BUFFERS; mavlinkChannel++) {
-        if (!(_mavlinkChannelsUsedBitMask & 1 << mavlinkChannel)) {
+    // Find a mavlink channel to use for this link. The bit is claimed with compare-and-swap so no lock is needed.
+    uint32_t usedMask = _mavlinkChannelsUsedBitMask.load();
+    while (true) {
+        uint8_t mavlinkChannel = 0;
+        while (mavlinkChannel < MAVLINK_COMM_NUM_BUFFERS && (usedMask & (1u << mavlinkChannel))) {
+            mavlinkChannel++;
+        }
+        if (mavlinkChannel == MAVLINK_COMM_NUM_BUFFERS) {
+            break;
+        }
+        if (_mavlinkChannelsUsedBitMask.compare_exchange_weak(usedMask, usedMask | (1u << mavlinkChannel))) {
             mavlink_reset_channel_status(mavlinkChannel);
             // Start the channel on Mav 1 protocol
             mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
             mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            _mavlinkChannelsUsedBitMask |= 1 << mavlinkChannel;
             qCDebug(LinkManagerLog) << "allocateMavlinkChannel" << mavlinkChannel;
             return mavlinkChannel;
         }
+        // usedMask has been reloaded by the failed exchange, try again
     }
     qWarning(LinkManagerLog) << "allocateMavlinkChannel: all channels reserved!";
     return invalidMavlinkChannel();   // All channels reserved
@@ -878,7 +975,7 @@ void LinkManager::freeMavlinkChannel(uint8_t channel)
     if (invalidMavlinkChannel() == channel) {
         return;
     }
-    _mavlinkChannelsUsedBitMask &= ~(1 << channel);
+    _mavlinkChannelsUsedBitMask.fetch_and(~(1u << channel));
 }
 
 LogReplayLink* LinkManager::startLogReplay(const QString& logFile)
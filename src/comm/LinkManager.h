@@ -12,7 +12,9 @@
 #include <QList>
 #include <QMultiMap>
 #include <QMutex>
+#include <QElapsedTimer>
 
+#include <atomic>
 #include <limits>
 
 #include "LinkConfiguration.h"
@@ -28,6 +30,7 @@
 
 #ifndef NO_SERIAL_LINK
     #include "SerialLink.h"
+    #include "SerialPortWatcher.h"
 #endif
 
 Q_DECLARE_LOGGING_CATEGORY(LinkManagerLog)
@@ -139,6 +142,7 @@ signals:
 
 private slots:
     void _linkDisconnected  (void);
+    void _serialPortsChanged(void);
 
 private:
     QmlObjectListModel* _qmlLinkConfigurations      (void) { return &_qmlConfigurations; }
@@ -153,6 +157,7 @@ private:
 
 #ifndef NO_SERIAL_LINK
     bool                _portAlreadyConnected       (const QString& portName);
+    bool                _serialPortScanRequired     (void);
 #endif
 
     bool                                _configUpdateSuspended;                     ///< true: stop updating configuration list
@@ -160,7 +165,7 @@ private:
     bool                                _connectionsSuspended;                      ///< true: all new connections should not be allowed
     QString                             _connectionsSuspendedReason;                ///< User visible reason for suspension
     QTimer                              _portListTimer;
-    uint32_t                            _mavlinkChannelsUsedBitMask;
+    std::atomic<uint32_t>               _mavlinkChannelsUsedBitMask;
 
     AutoConnectSettings*                _autoConnectSettings;
     MAVLinkProtocol*                    _mavlinkProtocol;
@@ -170,12 +175,16 @@ private:
     QString                             _autoConnectRTKPort;
     QmlObjectListModel                  _qmlConfigurations;
 
-    QMap<QString, int>                  _autoconnectPortWaitList;               ///< key: QGCSerialPortInfo::systemLocation, value: wait count
+    QMap<QString, qint64>               _autoconnectPortWaitList;               ///< key: QGCSerialPortInfo::systemLocation, value: _autoconnectClock time port was first seen
+    QElapsedTimer                       _autoconnectClock;
     QStringList                         _commPortList;
     QStringList                         _commPortDisplayList;
 
 #ifndef NO_SERIAL_LINK
     QList<SerialLink*>                  _activeLinkCheckList;                   ///< List of links we are waiting for a vehicle to show up on
+    SerialPortWatcher*                  _serialPortWatcher;
+    bool                                _serialPortScanPending;                 ///< true: Port list may have changed since the last scan
+    qint64                              _lastSerialPortScanMSecs;               ///< _autoconnectClock time of the last scan
 #endif
 
     // NMEA GPS device for GCS position
@@ -192,6 +201,7 @@ private:
     static const char*  _mavlinkForwardingLinkName;
     static const int    _autoconnectUpdateTimerMSecs;
     static const int    _autoconnectConnectDelayMSecs;
+    static const int    _serialPortFallbackScanMSecs;
 
 };
 
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkReactorPool.h"
+
+#include <QMutexLocker>
+
+QGC_LOGGING_CATEGORY(LinkReactorPoolLog, "LinkReactorPoolLog")
+
+LinkReactorPool::LinkReactorPool(int reactorCount)
+{
+    reactorCount = qMax(1, reactorCount);
+    for (int i=0; i<reactorCount; i++) {
+        QThread* reactor = new QThread();
+        reactor->setObjectName(QStringLiteral("LinkReactor%1").arg(i));
+        _reactors.append(reactor);
+        _pinnedCounts.append(0);
+    }
+}
+
+LinkReactorPool::~LinkReactorPool()
+{
+    if (!_pinned.isEmpty()) {
+        qCWarning(LinkReactorPoolLog) << "Objects still pinned at shutdown:" << _pinned.count();
+    }
+    for (QThread* reactor: _reactors) {
+        reactor->quit();
+        reactor->wait();
+        delete reactor;
+    }
+}
+
+QThread* LinkReactorPool::pin(QObject* object)
+{
+    if (object->parent()) {
+        qCWarning(LinkReactorPoolLog) << "Can't pin object with a parent" << object;
+        return nullptr;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    if (_pinned.contains(object)) {
+        return _reactors[_pinned[object].reactorIndex];
+    }
+
+    int reactorIndex = 0;
+    for (int i=1; i<_reactors.count(); i++) {
+        if (_pinnedCounts[i] < _pinnedCounts[reactorIndex]) {
+            reactorIndex = i;
+        }
+    }
+
+    QThread* reactor = _reactors[reactorIndex];
+    if (!reactor->isRunning()) {
+        reactor->start(QThread::NormalPriority);
+    }
+
+    _pinned[object] = { reactorIndex, object->thread() };
+    _pinnedCounts[reactorIndex]++;
+    object->moveToThread(reactor);
+
+    qCDebug(LinkReactorPoolLog) << "Pinned" << object << "to" << reactor->objectName() << "objects" << _pinnedCounts[reactorIndex];
+
+    return reactor;
+}
+
+void LinkReactorPool::unpin(QObject* object, const std::function<void(void)>& stop)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _pinned.find(object);
+    if (it == _pinned.end()) {
+        return;
+    }
+    const Pinned_t pinned = it.value();
+    _pinned.erase(it);
+    _pinnedCounts[pinned.reactorIndex]--;
+
+    // Not held while waiting on the reactor, which may be pinning or unpinning something itself
+    locker.unlock();
+
+    // Moving an object is only allowed from the thread it lives on
+    auto leave = [object, &stop, &pinned]() {
+        if (stop) {
+            stop();
+        }
+        object->moveToThread(pinned.originThread);
+    };
+
+    if (QThread::currentThread() == object->thread()) {
+        leave();
+    } else {
+        QMetaObject::invokeMethod(object, leave, Qt::BlockingQueuedConnection);
+    }
+
+    qCDebug(LinkReactorPoolLog) << "Unpinned" << object << "from" << _reactors[pinned.reactorIndex]->objectName();
+}
+
+int LinkReactorPool::pinnedCount(int reactorIndex) const
+{
+    QMutexLocker locker(&_mutex);
+    return _pinnedCounts.value(reactorIndex);
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(LinkReactorPoolLog)
+
+/// Small pool of event loop threads which the socket based links run on, instead of each link having its own thread.
+///
+/// There is one reactor per core, each started the first time something is pinned to it. A link is pinned to the
+/// reactor with the fewest links while it is connected. Its socket reads, link thread decoding and write queue all
+/// run on that reactor, so there are no thread hops between them. Since a reactor is shared, nothing pinned to it
+/// may block: blocking reads belong on a thread of their own.
+///
+/// The pool is owned by QGCApplication and outlives the toolbox, so links torn down during shutdown still have their
+/// reactor.
+class LinkReactorPool
+{
+public:
+    LinkReactorPool(int reactorCount = QThread::idealThreadCount());
+    ~LinkReactorPool();
+
+    /// Moves object to the reactor with the fewest objects. object must not have a parent and must live on the
+    /// calling thread.
+    /// @return The reactor thread, nullptr if object could not be moved
+    QThread* pin(QObject* object);
+
+    /// Calls stop on the reactor of object and waits for it to return, then moves object back to the thread it was
+    /// pinned from. Can be called from any thread, does nothing if object is not pinned.
+    void unpin(QObject* object, const std::function<void(void)>& stop = std::function<void(void)>());
+
+    int reactorCount    (void) const { return _reactors.count(); }
+    int pinnedCount     (int reactorIndex) const;
+
+private:
+    typedef struct {
+        int         reactorIndex;
+        QThread*    originThread;
+    } Pinned_t;
+
+    mutable QMutex          _mutex;
+    QVector<QThread*>       _reactors;
+    QVector<int>            _pinnedCounts;
+    QHash<QObject*, Pinned_t> _pinned;
+};
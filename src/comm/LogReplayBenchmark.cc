@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayBenchmark.h"
+#include "LogReplayLink.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "MAVLinkProtocol.h"
+#include "MultiVehicleManager.h"
+#include "QGCTrace.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+int LogReplayBenchmark::run(const QString& logFile, const QString& outputFile)
+{
+    if (!QFileInfo::exists(logFile)) {
+        qWarning() << "Replay benchmark log not found" << logFile;
+        return -1;
+    }
+
+    LinkManager*            linkManager     = qgcApp()->toolbox()->linkManager();
+    MultiVehicleManager*    multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    // Span totals are only recorded while tracing is on
+    const_cast<QLoggingCategory&>(QGCTraceLog()).setEnabled(QtDebugMsg, true);
+    QGCTrace::clear();
+
+    // All connections are made to this context so they go away with it
+    QObject     context;
+    QEventLoop  loop;
+    QString     errorMsg;
+    qint64      messageCount    = 0;
+    int         vehicleCount    = 0;
+    bool        atEnd           = false;
+
+    QObject::connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, &context, [&]() {
+        messageCount++;
+    });
+    QObject::connect(multiVehicleMgr, &MultiVehicleManager::vehicleAdded, &context, [&]() {
+        vehicleCount++;
+    });
+
+    LogReplayLinkConfiguration* replayConfig = new LogReplayLinkConfiguration(QStringLiteral("Replay Benchmark"));
+    replayConfig->setLogFilename(logFile);
+    replayConfig->setDynamic(true);
+    SharedLinkConfigurationPtr sharedConfig = linkManager->addConfiguration(replayConfig);
+
+    const qint64    startCpuMSecs = _cpuMSecs();
+    QElapsedTimer   wallTimer;
+    wallTimer.start();
+
+    if (!linkManager->createConnectedLink(sharedConfig)) {
+        qWarning() << "Replay benchmark unable to start replay of" << logFile;
+        return -1;
+    }
+    LogReplayLink* link = qobject_cast<LogReplayLink*>(sharedConfig->link());
+    if (!link) {
+        qWarning() << "Replay benchmark has no replay link";
+        return -1;
+    }
+    QObject::connect(link, &LogReplayLink::playbackAtEnd, &context, [&]() {
+        atEnd = true;
+        loop.quit();
+    });
+    QObject::connect(link, &LinkInterface::communicationError, &context, [&](const QString& /*title*/, const QString& error) {
+        errorMsg = error;
+        loop.quit();
+    });
+    link->setPlaybackSpeed(0);
+
+    QTimer::singleShot(_timeoutMSecs, &loop, &QEventLoop::quit);
+    loop.exec();
+    // Messages queued to the gui thread from the last batch are part of the replay
+    QCoreApplication::processEvents();
+
+    const qint64 wallMSecs  = wallTimer.elapsed();
+    const qint64 cpuMSecs   = _cpuMSecs() - startCpuMSecs;
+
+    linkManager->disconnectAll();
+
+    if (!atEnd) {
+        qWarning() << "Replay benchmark did not complete" << (errorMsg.isEmpty() ? QStringLiteral("timeout") : errorMsg);
+        return -1;
+    }
+
+    QJsonObject results;
+    results[QStringLiteral("logFile")]              = QFileInfo(logFile).fileName();
+    results[QStringLiteral("logBytes")]             = QFileInfo(logFile).size();
+    results[QStringLiteral("wallMSecs")]            = wallMSecs;
+    results[QStringLiteral("cpuMSecs")]             = cpuMSecs;
+    results[QStringLiteral("messages")]             = messageCount;
+    results[QStringLiteral("messagesPerSecond")]    = wallMSecs > 0 ? messageCount * 1000.0 / wallMSecs : 0;
+    results[QStringLiteral("vehicles")]             = vehicleCount;
+    results[QStringLiteral("peakMemoryKB")]         = _peakMemoryKB();
+    results[QStringLiteral("spans")]                = QGCTrace::totals();
+
+    QByteArray json = QJsonDocument(results).toJson();
+    qDebug().noquote() << json;
+
+    QFile file(outputFile);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "Replay benchmark unable to write" << outputFile << file.errorString();
+        return -1;
+    }
+    file.write(json);
+    return 0;
+}
+
+/// @return User and system cpu time of the process, -1 if not known on this platform
+qint64 LogReplayBenchmark::_cpuMSecs(void)
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+    }
+#endif
+    return -1;
+}
+
+/// @return Peak resident memory of the process, -1 if not known on this platform
+qint64 LogReplayBenchmark::_peakMemoryKB(void)
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MAC
+        return usage.ru_maxrss / 1024;      // Bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QJsonObject>
+
+/// Headless benchmark which replays a tlog through LogReplayLink at maximum speed into the full Vehicle/FactGroup
+/// stack. Started from main with --replay-bench:<tlog>, results go to --replay-bench-output:<file> (default
+/// replaybench.json) as well as the console.
+///
+/// Results are wall and cpu time of the replay, messages per second, vehicles created, peak resident memory and the
+/// QGCTrace span totals per subsystem. Tracing is turned on for the run. The same log with the same build gives
+/// comparable numbers, so field logs can be used as a performance regression corpus.
+class LogReplayBenchmark
+{
+public:
+    /// @return Process exit code, 0 for a complete replay
+    static int run(const QString& logFile, const QString& outputFile);
+
+private:
+    static qint64 _cpuMSecs         (void);
+    static qint64 _peakMemoryKB     (void);
+
+    static const int _timeoutMSecs = 60 * 60 * 1000;
+};
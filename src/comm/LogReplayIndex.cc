@@ -0,0 +1,310 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogReplayIndex.h"
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(LogReplayIndexLog, "LogReplayIndexLog")
+
+const char* LogReplayIndex::_magic = "QGCTLIDX";
+
+QString LogReplayIndex::indexFilename(const QString& logFilename)
+{
+    return logFilename + QStringLiteral(".qgcidx");
+}
+
+void LogReplayIndex::clear(void)
+{
+    if (_indexMap) {
+        _indexFile.unmap(_indexMap);
+        _indexMap = nullptr;
+    }
+    if (_indexFile.isOpen()) {
+        _indexFile.close();
+    }
+    std::vector<Entry_t>().swap(_memoryEntries);
+    _entries    = nullptr;
+    _count      = 0;
+}
+
+bool LogReplayIndex::load(const QString& logFilename, const uchar* logBytes, quint64 logSize)
+{
+    clear();
+
+    qint64  logModifiedMSecs    = QFileInfo(logFilename).lastModified().toMSecsSinceEpoch();
+    QString indexFilename       = LogReplayIndex::indexFilename(logFilename);
+
+    if (_mapIndexFile(indexFilename, logSize, logModifiedMSecs)) {
+        qCDebug(LogReplayIndexLog) << "Loaded index" << indexFilename << _count;
+    } else if (_buildIndexFile(indexFilename, logBytes, logSize, logModifiedMSecs) && _mapIndexFile(indexFilename, logSize, logModifiedMSecs)) {
+        qCDebug(LogReplayIndexLog) << "Built index" << indexFilename << _count;
+    } else {
+        qCWarning(LogReplayIndexLog) << "Unable to save index, keeping it in memory" << indexFilename;
+        _buildInMemory(logBytes, logSize);
+    }
+
+    return _count > 0;
+}
+
+int LogReplayIndex::findTimestamp(quint64 timestampUSecs) const
+{
+    const Entry_t* entry = std::lower_bound(_entries, _entries + _count, timestampUSecs, [](const Entry_t& entry, quint64 timestampUSecs) {
+        return entry.timestampUSecs < timestampUSecs;
+    });
+    return static_cast<int>(entry - _entries);
+}
+
+bool LogReplayIndex::_mapIndexFile(const QString& indexFilename, quint64 logSize, qint64 logModifiedMSecs)
+{
+    Header_t header;
+
+    _indexFile.setFileName(indexFilename);
+    if (!_indexFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+
+    if (_indexFile.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, _magic, sizeof(header.magic)) != 0 ||
+            header.version != _version ||
+            header.entrySize != sizeof(Entry_t) ||
+            header.byteOrderMark != _byteOrderMark ||
+            header.logFileSize != logSize ||
+            header.logModifiedMSecs != logModifiedMSecs ||
+            header.entryCount > static_cast<quint64>(std::numeric_limits<int>::max()) ||
+            static_cast<quint64>(_indexFile.size()) != sizeof(header) + (header.entryCount * sizeof(Entry_t))) {
+        qCDebug(LogReplayIndexLog) << "Index missing or out of date" << indexFilename;
+        _indexFile.close();
+        return false;
+    }
+
+    if (header.entryCount) {
+        _indexMap = _indexFile.map(0, _indexFile.size());
+        if (!_indexMap) {
+            qCWarning(LogReplayIndexLog) << "Unable to map index" << indexFilename << _indexFile.errorString();
+            _indexFile.close();
+            return false;
+        }
+        _entries = reinterpret_cast<const Entry_t*>(_indexMap + sizeof(header));
+    }
+    _count = static_cast<int>(header.entryCount);
+
+    return true;
+}
+
+/// Writes the index to a temporary file in chunks, so the full index never has to be held in memory, then moves it
+/// into place.
+bool LogReplayIndex::_buildIndexFile(const QString& indexFilename, const uchar* logBytes, quint64 logSize, qint64 logModifiedMSecs)
+{
+    const size_t    chunkEntries    = 64 * 1024;
+    QString         tempFilename    = indexFilename + QStringLiteral(".tmp");
+    QFile           file(tempFilename);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCDebug(LogReplayIndexLog) << "Unable to create index" << tempFilename << file.errorString();
+        return false;
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version          = _version;
+    header.entrySize        = sizeof(Entry_t);
+    header.logFileSize      = logSize;
+    header.logModifiedMSecs = logModifiedMSecs;
+    header.byteOrderMark    = _byteOrderMark;
+
+    bool success = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+
+    std::vector<Entry_t> chunk;
+    chunk.reserve(chunkEntries);
+    auto writeChunk = [&]() {
+        qint64 chunkBytes = static_cast<qint64>(chunk.size() * sizeof(Entry_t));
+        success = success && file.write(reinterpret_cast<const char*>(chunk.data()), chunkBytes) == chunkBytes;
+        chunk.clear();
+    };
+
+    _scan(logBytes, logSize, [&](const Entry_t& entry) {
+        chunk.push_back(entry);
+        header.entryCount++;
+        if (chunk.size() == chunkEntries) {
+            writeChunk();
+        }
+    });
+    writeChunk();
+
+    success = success && file.seek(0) && file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+    success = success && file.flush();
+    file.close();
+
+    if (!success) {
+        qCWarning(LogReplayIndexLog) << "Writing index failed" << tempFilename << file.errorString();
+        QFile::remove(tempFilename);
+        return false;
+    }
+
+    QFile::remove(indexFilename);
+    if (!QFile::rename(tempFilename, indexFilename)) {
+        QFile::remove(tempFilename);
+        return false;
+    }
+
+    return true;
+}
+
+void LogReplayIndex::_buildInMemory(const uchar* logBytes, quint64 logSize)
+{
+    clear();
+
+    _scan(logBytes, logSize, [this](const Entry_t& entry) {
+        _memoryEntries.push_back(entry);
+    });
+    if (_memoryEntries.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        _memoryEntries.resize(static_cast<size_t>(std::numeric_limits<int>::max()));
+    }
+
+    _entries    = _memoryEntries.data();
+    _count      = static_cast<int>(_memoryEntries.size());
+}
+
+/// Walks the log record by record. Well formed records are validated in place and skipped over as a whole. After a
+/// corrupt record the stock parser is used to resync on the next good frame.
+template<typename Sink>
+void LogReplayIndex::_scan(const uchar* logBytes, quint64 logSize, Sink sink)
+{
+    // Only look up the current time once instead of once per record
+    quint64 nowUSecs    = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+    quint64 position    = 0;
+
+    while (position + _cbTimestamp < logSize) {
+        Entry_t entry;
+        quint64 frameOffset = position + _cbTimestamp;
+
+        entry.frameLength = _frameLength(&logBytes[frameOffset], logSize - frameOffset, &entry.msgId);
+        if (entry.frameLength) {
+            entry.timestampUSecs    = _parseTimestamp(&logBytes[position], nowUSecs);
+            entry.frameOffset       = frameOffset;
+            sink(entry);
+            position = frameOffset + entry.frameLength;
+            continue;
+        }
+
+        mavlink_message_t   rxMessage;
+        mavlink_status_t    rxStatus;
+        mavlink_message_t   message;
+        mavlink_status_t    status;
+        quint64             stx     = 0;
+        bool                found   = false;
+
+        memset(&rxMessage, 0, sizeof(rxMessage));
+        memset(&rxStatus, 0, sizeof(rxStatus));
+
+        for (position = frameOffset; position < logSize; position++) {
+            uint8_t result = mavlink_frame_char_buffer(&rxMessage, &rxStatus, logBytes[position], &message, &status);
+            if (rxStatus.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
+                stx = position;
+            }
+            if (result == MAVLINK_FRAMING_OK) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+
+        position++;
+        if (stx >= _cbTimestamp) {
+            // The timestamp is the record immediately preceding the frame
+            entry.timestampUSecs    = _parseTimestamp(&logBytes[stx - _cbTimestamp], nowUSecs);
+            entry.frameOffset       = stx;
+            entry.frameLength       = static_cast<quint32>(position - stx);
+            entry.msgId             = message.msgid;
+            sink(entry);
+        }
+    }
+}
+
+/// Validates a complete frame by length and CRC
+///     @return Length of the frame, 0 if there is no valid frame at this position
+quint32 LogReplayIndex::_frameLength(const uchar* frame, quint64 available, quint32* msgId)
+{
+    quint32 headerLen;
+    quint32 signatureLen = 0;
+
+    if (available < 1) {
+        return 0;
+    }
+
+    if (frame[0] == MAVLINK_STX_MAVLINK1) {
+        headerLen = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        if (available < headerLen) {
+            return 0;
+        }
+        *msgId = frame[5];
+    } else if (frame[0] == MAVLINK_STX) {
+        headerLen = MAVLINK_NUM_HEADER_BYTES;
+        if (available < headerLen) {
+            return 0;
+        }
+        uint8_t incompatFlags = frame[2];
+        if (incompatFlags & ~MAVLINK_IFLAG_SIGNED) {
+            return 0;
+        }
+        if (incompatFlags & MAVLINK_IFLAG_SIGNED) {
+            signatureLen = MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+        *msgId = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+    } else {
+        return 0;
+    }
+
+    quint32 payloadLen  = frame[1];
+    quint32 frameLen    = headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES + signatureLen;
+    if (available < frameLen) {
+        return 0;
+    }
+
+    const mavlink_msg_entry_t* msgEntry = mavlink_get_msg_entry(*msgId);
+    if (!msgEntry) {
+        return 0;
+    }
+
+    uint16_t crc = crc_calculate(&frame[1], static_cast<uint16_t>(headerLen - 1 + payloadLen));
+    crc_accumulate(msgEntry->crc_extra, &crc);
+    const uchar* ck = &frame[headerLen + payloadLen];
+    if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+        return 0;
+    }
+
+    return frameLen;
+}
+
+/// Parses a BigEndian quint64 timestamp
+/// @return A Unix timestamp in microseconds UTC
+quint64 LogReplayIndex::_parseTimestamp(const uchar* bytes, quint64 nowUSecs)
+{
+    quint64 timestamp = qFromBigEndian<quint64>(bytes);
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > nowUSecs) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QLoggingCategory>
+
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayIndexLog)
+
+/// Message index for a telemetry log (big endian uint64 timestamp in usecs followed by the raw frame, repeated).
+///
+/// The index is built with a single pass over the memory mapped log the first time a log is opened and is saved
+/// next to the log as a sidecar file (<log>.qgcidx). Later opens map the sidecar directly, so opening, seeking and
+/// log duration do not depend on the size of the log. If the sidecar can't be written the index is kept in memory.
+class LogReplayIndex
+{
+public:
+    typedef struct {
+        quint64 timestampUSecs;
+        quint64 frameOffset;    ///< Offset of the frame STX within the log
+        quint32 frameLength;
+        quint32 msgId;
+    } Entry_t;
+
+    LogReplayIndex(void) = default;
+    ~LogReplayIndex() { clear(); }
+
+    /// Loads the sidecar index for the log, building it first if it is missing or out of date
+    ///     @param logFilename  Log file name
+    ///     @param logBytes     Mapped log contents
+    ///     @param logSize      Number of bytes in logBytes
+    /// @return false: no messages found in log
+    bool load(const QString& logFilename, const uchar* logBytes, quint64 logSize);
+
+    void clear(void);
+
+    int             count           (void) const { return _count; }
+    const Entry_t&  entry           (int index) const { return _entries[index]; }
+    quint64         startTimeUSecs  (void) const { return _count ? _entries[0].timestampUSecs : 0; }
+    quint64         endTimeUSecs    (void) const { return _count ? _entries[_count - 1].timestampUSecs : 0; }
+
+    /// @return Index of the first entry with a timestamp >= timestampUSecs, count() if there is none
+    int findTimestamp(quint64 timestampUSecs) const;
+
+    static QString indexFilename(const QString& logFilename);
+
+private:
+    typedef struct {
+        char    magic[8];
+        quint32 version;
+        quint32 entrySize;
+        quint64 logFileSize;
+        qint64  logModifiedMSecs;
+        quint64 entryCount;
+        quint32 byteOrderMark;  ///< Rejects indices written by a machine with different byte order
+        quint32 reserved;
+    } Header_t;
+
+    bool _mapIndexFile  (const QString& indexFilename, quint64 logSize, qint64 logModifiedMSecs);
+    bool _buildIndexFile(const QString& indexFilename, const uchar* logBytes, quint64 logSize, qint64 logModifiedMSecs);
+    void _buildInMemory (const uchar* logBytes, quint64 logSize);
+
+    template<typename Sink>
+    static void _scan(const uchar* logBytes, quint64 logSize, Sink sink);
+
+    static quint32 _frameLength     (const uchar* frame, quint64 available, quint32* msgId);
+    static quint64 _parseTimestamp  (const uchar* bytes, quint64 nowUSecs);
+
+    QFile                   _indexFile;
+    uchar*                  _indexMap   = nullptr;
+    std::vector<Entry_t>    _memoryEntries;
+    const Entry_t*          _entries    = nullptr;
+    int                     _count      = 0;
+
+    static const quint32    _version        = 1;
+    static const quint32    _byteOrderMark  = 0x01020304;
+    static const char*      _magic;
+    static const int        _cbTimestamp    = sizeof(quint64);
+};
@@ -13,8 +13,8 @@
 #include "QGCApplication.h"
 
 #include <QFileInfo>
-#include <QtEndian>
 #include <QSignalSpy>
+#include <QPointer>
 
 const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
 
@@ -65,7 +65,6 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     : LinkInterface              (config)
     , _logReplayConfig           (qobject_cast<LogReplayLinkConfiguration*>(config.get()))
     , _connected                 (false)
-    , _mavlinkChannel            (0)
     , _logCurrentTimeUSecs       (0)
     , _logStartTimeUSecs         (0)
     , _logEndTimeUSecs           (0)
@@ -75,6 +74,11 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     , _playbackStartLogTimeUSecs (0)
     , _mavlink                   (nullptr)
     , _logFileSize               (0)
+    , _logBytes                  (nullptr)
+    , _nextLogEntry              (0)
+    , _fastForwardWaiting        (false)
+    , _fastForwardMessageCount   (0)
+    , _lastSignaledTimestampUSecs(0)
 {
     if (!_logReplayConfig) {
         qWarning() << "Internal error";
@@ -140,6 +144,7 @@ void LogReplayLink::run(void)
     exec();
     
     _readTickTimer.stop();
+    _closeLogFile();
 }
 
 void LogReplayLink::_replayError(const QString& errorMsg)
@@ -154,116 +159,11 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
     Q_UNUSED(bytes);
 }
 
-/// Parses a BigEndian quint64 timestamp
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
-{
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
-    }
-    
-    return timestamp;
-}
-
-/// Reads the next mavlink message from the log
-///     @param bytes[output] Bytes for mavlink message
-/// @return Unix timestamp in microseconds UTC for NEXT mavlink message or 0 if no message found
-quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-
-    bytes.clear();
-
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
-        mavlink_message_t message;
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message, clear any partial bytes
-            bytes.clear();
-        }
-        bytes.append(nextByte);
-
-        if (messageFound) {
-            // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-
-    return 0;
-}
-
-/// Seeks to the beginning of the next successfully parsed mavlink message in the log file.
-///     @param nextMsg[output] Parsed next message that was found
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    qint64              messageStartPos = -1;
-
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.getChar(&nextByte)) {
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
-        }
-        
-        // If we've found a message, jump back to the start of the message, grab the timestamp,
-        // and go back to the end of this file.
-        if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-    
-    return 0;
-}
-
-quint64 LogReplayLink::_findLastTimestamp(void)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
-
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
-    }
-
-    return lastTimestamp;
-}
-
 bool LogReplayLink::_loadLogFile(void)
 {
     QString errorMsg;
     QString logFilename = _logReplayConfig->logFilename();
-    QFileInfo logFileInfo;
     int logDurationSecondsTotal;
-    quint64 startTimeUSecs;
-    quint64 endTimeUSecs;
 
     if (_logFile.isOpen()) {
         errorMsg = tr("Attempt to load new log while log being played");
@@ -275,25 +175,26 @@ bool LogReplayLink::_loadLogFile(void)
         errorMsg = tr("Unable to open log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
         goto Error;
     }
-    logFileInfo.setFile(logFilename);
-    _logFileSize = logFileInfo.size();
-    
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
+    _logFileSize = static_cast<quint64>(_logFile.size());
+
+    _logBytes = _logFile.map(0, _logFile.size());
+    if (!_logBytes) {
+        errorMsg = tr("Unable to map log file: '%1', error: %2").arg(logFilename).arg(_logFile.errorString());
+        goto Error;
+    }
 
-    if (endTimeUSecs <= startTimeUSecs) {
+    // The index is built on first open and reused from its sidecar file after that
+    if (!_logIndex.load(logFilename, _logBytes, _logFileSize) || _logIndex.endTimeUSecs() <= _logIndex.startTimeUSecs()) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
         goto Error;
     }
 
     // Remember the start and end time so we can move around this _logFile with the slider.
-    _logEndTimeUSecs = endTimeUSecs;
-    _logStartTimeUSecs = startTimeUSecs;
-    _logDurationUSecs = endTimeUSecs - startTimeUSecs;
-    _logCurrentTimeUSecs = startTimeUSecs;
-
-    // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    _logEndTimeUSecs = _logIndex.endTimeUSecs();
+    _logStartTimeUSecs = _logIndex.startTimeUSecs();
+    _logDurationUSecs = _logEndTimeUSecs - _logStartTimeUSecs;
+    _logCurrentTimeUSecs = _logStartTimeUSecs;
+    _nextLogEntry = 0;
 
     logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
     
@@ -302,11 +203,22 @@ bool LogReplayLink::_loadLogFile(void)
     return true;
     
 Error:
+    _closeLogFile();
+    _replayError(errorMsg);
+    return false;
+}
+
+void LogReplayLink::_closeLogFile(void)
+{
+    _logIndex.clear();
+    _nextLogEntry = 0;
+    if (_logBytes) {
+        _logFile.unmap(const_cast<uchar*>(_logBytes));
+        _logBytes = nullptr;
+    }
     if (_logFile.isOpen()) {
         _logFile.close();
     }
-    _replayError(errorMsg);
-    return false;
 }
 
 /// This function will read the next available log entry. It will then start
@@ -315,44 +227,115 @@ Error:
 /// induce a static drift into the log file replay.
 void LogReplayLink::_readNextLogEntry(void)
 {
-    QByteArray bytes;
 
-    // Now parse MAVLink messages, grabbing their timestamps as we go. We stop once we
-    // have at least 3ms until the next one.
+    if (_nextLogEntry >= _logIndex.count()) {
+        _finishPlayback();
+        return;
+    }
+    if (_playbackSpeed <= 0) {
+        _readFastForwardBatch();
+        return;
+    }
+
+    // Now gather MAVLink messages, grabbing their timestamps as we go. We stop once we
+    // have at least 3ms until the next one. The frames gathered are sent in a single buffer.
 
     // We track what the next execution time should be in milliseconds, which we use to set
     // the next timer interrupt.
-    int timeToNextExecutionMSecs = 0;
+    int         timeToNextExecutionMSecs = 0;
+    QByteArray& bytes = _receiveBuffer();
 
     while (timeToNextExecutionMSecs < 3) {
         // Read the next mavlink message from the log
-        qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
-        emit bytesReceived(this, bytes);
-        emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+        const LogReplayIndex::Entry_t& entry = _logIndex.entry(_nextLogEntry++);
+        bytes.append(reinterpret_cast<const char*>(_logBytes + entry.frameOffset), static_cast<int>(entry.frameLength));
 
-        if (_logFile.atEnd()) {
+        if (_nextLogEntry >= _logIndex.count()) {
+            _emitReceiveBuffer();
+            emit playbackPercentCompleteChanged(100);
             _finishPlayback();
             return;
         }
 
-        _logCurrentTimeUSecs = nextTimeUSecs;
+        _logCurrentTimeUSecs = _logIndex.entry(_nextLogEntry).timestampUSecs;
 
         // Calculate how long we should wait in real time until parsing this message.
         // We pace ourselves relative to the start time of playback to fix any drift (initially set in play())
 
         quint64 currentTimeMSecs =                  (quint64)QDateTime::currentMSecsSinceEpoch();
-        quint64 desiredPlayheadMovementTimeMSecs =  ((_logCurrentTimeUSecs - _playbackStartLogTimeUSecs) / 1000) / _playbackSpeed;
+        quint64 logMovementUSecs =                  _logCurrentTimeUSecs > _playbackStartLogTimeUSecs ? _logCurrentTimeUSecs - _playbackStartLogTimeUSecs : 0;
+        quint64 desiredPlayheadMovementTimeMSecs =  (logMovementUSecs / 1000) / _playbackSpeed;
         quint64 desiredCurrentTimeMSecs =           _playbackStartTimeMSecs + desiredPlayheadMovementTimeMSecs;
 
         timeToNextExecutionMSecs = desiredCurrentTimeMSecs - currentTimeMSecs;
     }
 
+    _emitReceiveBuffer();
+    emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
     _signalCurrentLogTimeSecs();
 
     // And schedule the next execution of this function.
     _readTickTimer.start(timeToNextExecutionMSecs);
 }
 
+/// Fast forward sends the log in large batches without any pacing. Only one batch is in flight at a time: the next
+/// batch is read once the MAVLinkProtocol thread has worked through the previous one, so the receiving event queue
+/// can't grow without bounds.
+void LogReplayLink::_readFastForwardBatch(void)
+{
+    QByteArray& bytes = _receiveBuffer();
+    int         firstLogEntry = _nextLogEntry;
+
+    bytes.reserve(_fastForwardBatchBytes);
+    while (_nextLogEntry < _logIndex.count() && bytes.size() < _fastForwardBatchBytes) {
+        const LogReplayIndex::Entry_t& entry = _logIndex.entry(_nextLogEntry++);
+        bytes.append(reinterpret_cast<const char*>(_logBytes + entry.frameOffset), static_cast<int>(entry.frameLength));
+    }
+    _fastForwardMessageCount += static_cast<quint64>(_nextLogEntry - firstLogEntry);
+    _logCurrentTimeUSecs = _logIndex.entry(qMin(_nextLogEntry, _logIndex.count() - 1)).timestampUSecs;
+
+    _emitReceiveBuffer();
+
+    if (_nextLogEntry >= _logIndex.count()) {
+        _signalFastForwardProgress();
+        _finishPlayback();
+        return;
+    }
+    if (_fastForwardSignalTimer.elapsed() >= _fastForwardSignalIntervalMSecs) {
+        _signalFastForwardProgress();
+    }
+
+    // Bounce off the protocol thread, which puts us behind the batch we just sent in its event queue
+    _fastForwardWaiting = true;
+    QPointer<LogReplayLink> link(this);
+    QMetaObject::invokeMethod(qgcApp()->toolbox()->mavlinkProtocol(), [link]() {
+        if (link) {
+            QMetaObject::invokeMethod(link.data(), "_fastForwardBatchDone", Qt::QueuedConnection);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void LogReplayLink::_fastForwardBatchDone(void)
+{
+    // Playback may have been paused while the batch was in flight
+    if (_fastForwardWaiting) {
+        _fastForwardWaiting = false;
+        _readNextLogEntry();
+    }
+}
+
+void LogReplayLink::_signalFastForwardProgress(void)
+{
+    qint64 elapsedMSecs = _fastForwardSignalTimer.restart();
+    if (elapsedMSecs > 0) {
+        emit fastForwardThroughput((_fastForwardMessageCount * 1000.0) / elapsedMSecs);
+    }
+    _fastForwardMessageCount = 0;
+
+    emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
+    _signalCurrentLogTimeSecs();
+}
+
 void LogReplayLink::_play(void)
 {
     qgcApp()->toolbox()->linkManager()->setConnectionsSuspended(tr("Connect not allowed during Flight Data replay."));
@@ -361,12 +344,14 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_nextLogEntry >= _logIndex.count()) {
         _resetPlaybackToBeginning();
     }
     
     _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
+    _fastForwardMessageCount = 0;
+    _fastForwardSignalTimer.start();
     _readTickTimer.start(1);
     
     emit playbackStarted();
@@ -380,15 +365,14 @@ void LogReplayLink::_pause(void)
 #endif
     
     _readTickTimer.stop();
+    _fastForwardWaiting = false;
     
     emit playbackPaused();
 }
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
-    }
+    _nextLogEntry = 0;
     
     // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
     _playbackStartTimeMSecs = 0;
@@ -414,45 +398,19 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
         percentComplete = 100;
     }
     
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
-
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
-        _replayError(tr("Unable to seek to new position"));
+    if (_logIndex.count() == 0) {
         return;
     }
 
-    // But we do align to the next MAVLink message for consistency.
-    mavlink_message_t dummy;
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
-
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
-
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    // Binary search the index for the first message at or after the requested time
+    quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+    _nextLogEntry = qMin(_logIndex.findTimestamp(desiredTimeUSecs), _logIndex.count() - 1);
+    _logCurrentTimeUSecs = _logIndex.entry(_nextLogEntry).timestampUSecs;
+    _lastSignaledTimestampUSecs = 0;
     _signalCurrentLogTimeSecs();
 
     // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
     emit playbackPercentCompleteChanged(percentComplete);
 }
@@ -464,7 +422,12 @@ void LogReplayLink::_setPlaybackSpeed(qreal playbackSpeed)
     // Let _readNextLogEntry update to correct speed
     _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
-    _readTickTimer.start(1);
+    _fastForwardMessageCount = 0;
+    _fastForwardSignalTimer.start();
+    if (!_fastForwardWaiting) {
+        // A fast forward batch in flight picks up the new speed when it completes
+        _readTickTimer.start(1);
+    }
 }
 
 /// @brief Called when playback is complete
@@ -475,9 +438,25 @@ void LogReplayLink::_finishPlayback(void)
     emit playbackAtEnd();
 }
 
+void LogReplayLink::movePlayheadToTimestamp(quint64 timestampUSecs)
+{
+    if (_logDurationUSecs == 0) {
+        return;
+    }
+
+    quint64 relativeTimeUSecs = timestampUSecs > _logStartTimeUSecs ? timestampUSecs - _logStartTimeUSecs : 0;
+    movePlayhead((static_cast<qreal>(relativeTimeUSecs) / _logDurationUSecs) * 100);
+}
+
 void LogReplayLink::_signalCurrentLogTimeSecs(void)
 {
     emit currentLogTimeSecs((_logCurrentTimeUSecs - _logStartTimeUSecs) / 1000000);
+
+    // Video sync needs finer resolution than seconds, but not a signal for every message
+    if (_logCurrentTimeUSecs < _lastSignaledTimestampUSecs || _logCurrentTimeUSecs - _lastSignaledTimestampUSecs >= static_cast<quint64>(_timestampSignalIntervalUSecs)) {
+        _lastSignaledTimestampUSecs = _logCurrentTimeUSecs;
+        emit currentLogTimestampUSecs(_logCurrentTimeUSecs);
+    }
 }
 
 LogReplayLinkController::LogReplayLinkController(void)
@@ -486,6 +465,9 @@ LogReplayLinkController::LogReplayLinkController(void)
     , _percentComplete  (0)
     , _playheadSecs     (0)
     , _playbackSpeed    (1)
+    , _messagesPerSecond(0)
+    , _playheadTimestampUSecs(0)
+    , _videoPositionMSecs(-1)
 {
 }
 
@@ -516,6 +498,8 @@ void LogReplayLinkController::setLink(LogReplayLink* link)
         connect(_link, &LogReplayLink::playbackPercentCompleteChanged,    this, &LogReplayLinkController::_playbackPercentCompleteChanged);
         connect(_link, &LogReplayLink::currentLogTimeSecs,                this, &LogReplayLinkController::_currentLogTimeSecs);
         connect(_link, &LogReplayLink::disconnected,                      this, &LogReplayLinkController::_linkDisconnected);
+        connect(_link, &LogReplayLink::fastForwardThroughput,             this, &LogReplayLinkController::_fastForwardThroughput);
+        connect(_link, &LogReplayLink::currentLogTimestampUSecs,          this, &LogReplayLinkController::_currentLogTimestampUSecs);
 
         connect(this, &LogReplayLinkController::playbackSpeedChanged, _link, &LogReplayLink::setPlaybackSpeed);
 
@@ -581,6 +565,62 @@ void LogReplayLinkController::_linkDisconnected(void)
     setLink(nullptr);
 }
 
+void LogReplayLinkController::_fastForwardThroughput(double messagesPerSecond)
+{
+    _messagesPerSecond = messagesPerSecond;
+    emit messagesPerSecondChanged(_messagesPerSecond);
+}
+
+void LogReplayLinkController::setVideoFile(const QString& videoFile)
+{
+    if (_videoFile == videoFile) {
+        return;
+    }
+
+    _videoFile = videoFile;
+    if (_videoFile.isEmpty() || !_videoIndex.load(_videoFile)) {
+        // Without an index the video can't be synced, so don't keep the index of a previous video
+        _videoIndex.clear();
+    }
+    emit videoFileChanged();
+
+    _currentLogTimestampUSecs(_playheadTimestampUSecs);
+}
+
+qint64 LogReplayLinkController::videoPositionForTimestamp(quint64 timestampUSecs) const
+{
+    int index = _videoIndex.findFrame(timestampUSecs);
+
+    if (index < 0 || timestampUSecs > _videoIndex.endTimeUSecs() + _maxFrameGapUSecs) {
+        return -1;
+    }
+
+    return static_cast<qint64>(_videoIndex.entry(index).ptsNSecs / 1000000);
+}
+
+void LogReplayLinkController::seekToVideoPosition(qint64 positionMSecs)
+{
+    if (!_link || positionMSecs < 0) {
+        return;
+    }
+
+    int index = _videoIndex.findPts(static_cast<quint64>(positionMSecs) * 1000000);
+    if (index >= 0) {
+        _link->movePlayheadToTimestamp(_videoIndex.entry(index).timestampUSecs);
+    }
+}
+
+void LogReplayLinkController::_currentLogTimestampUSecs(quint64 timestampUSecs)
+{
+    _playheadTimestampUSecs = timestampUSecs;
+
+    qint64 positionMSecs = videoPositionForTimestamp(timestampUSecs);
+    if (_videoPositionMSecs != positionMSecs) {
+        _videoPositionMSecs = positionMSecs;
+        emit videoPositionMSecsChanged(_videoPositionMSecs);
+    }
+}
+
 QString LogReplayLinkController::_secondsToHMS(int seconds)
 {
     int secondsPart  = seconds;
@@ -10,9 +10,12 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "LogReplayIndex.h"
+#include "VideoSyncIndex.h"
 
 #include <QTimer>
 #include <QFile>
+#include <QElapsedTimer>
 
 class LinkManager;
 
@@ -57,19 +60,23 @@ public:
     virtual ~LogReplayLink();
 
     /// @return true: log is currently playing, false: log playback is paused
-    bool isPlaying(void) { return _readTickTimer.isActive(); }
+    bool isPlaying(void) { return _readTickTimer.isActive() || _fastForwardWaiting; }
 
     void play           (void) { emit _playOnThread(); }
     void pause          (void) { emit _pauseOnThread(); }
     void movePlayhead   (qreal percentComplete);
 
+    /// Moves the playhead to the first message at or after a log timestamp
+    void movePlayheadToTimestamp(quint64 timestampUSecs);
+
     // overrides from LinkInterface
     bool isConnected(void) const override { return _connected; }
     bool isLogReplay(void) override { return true; }
     void disconnect (void) override;
 
 public slots:
-    /// Sets the acceleration factor: -100: 0.01X, 0: 1.0X, 100: 100.0X
+    /// Sets the playback speed multiplier, e.g. 0.5: half speed, 2: double speed. 0 plays the log as fast as the
+    /// application can process it, with progress signals reduced to once a second.
     void setPlaybackSpeed(qreal playbackSpeed) { emit _setPlaybackSpeedOnThread(playbackSpeed); }
 
 signals:
@@ -79,6 +86,8 @@ signals:
     void playbackAtEnd                  (void);
     void playbackPercentCompleteChanged (qreal percentComplete);
     void currentLogTimeSecs             (int secs);
+    void currentLogTimestampUSecs       (quint64 timestampUSecs);   ///< Absolute playhead time, at most every _timestampSignalIntervalUSecs
+    void fastForwardThroughput          (double messagesPerSecond);
 
     // Internal signals
     void _playOnThread              (void);
@@ -93,6 +102,7 @@ private slots:
     void _play              (void);
     void _pause             (void);
     void _setPlaybackSpeed  (qreal playbackSpeed);
+    void _fastForwardBatchDone(void);
 
 private:
 
@@ -100,14 +110,13 @@ private:
     bool _connect(void) override;
 
     void    _replayError                (const QString& errorMsg);
-    quint64 _parseTimestamp             (const QByteArray& bytes);
-    quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
-    quint64 _readNextMavlinkMessage     (QByteArray& bytes);
     bool    _loadLogFile                (void);
+    void    _closeLogFile               (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
     void    _signalCurrentLogTimeSecs   (void);
+    void    _readFastForwardBatch       (void);
+    void    _signalFastForwardProgress  (void);
 
     // QThread overrides
     void run(void) override;
@@ -115,7 +124,6 @@ private:
     LogReplayLinkConfiguration* _logReplayConfig;
 
     bool    _connected;
-    uint8_t _mavlinkChannel;
     QTimer  _readTickTimer;      ///< Timer which signals a read of next log record
 
     QString _errorTitle; ///< Title for communicatorError signals
@@ -132,8 +140,18 @@ private:
     MAVLinkProtocol*    _mavlink;
     QFile               _logFile;
     quint64             _logFileSize;
-
-    static const int cbTimestamp = sizeof(quint64);
+    const uchar*        _logBytes;          ///< Memory mapped contents of _logFile
+    LogReplayIndex      _logIndex;
+    int                 _nextLogEntry;      ///< Index of the next entry in _logIndex to be played
+
+    bool                _fastForwardWaiting;        ///< true: waiting for the last fast forward batch to be processed
+    quint64             _fastForwardMessageCount;   ///< Messages sent since the last throughput signal
+    QElapsedTimer       _fastForwardSignalTimer;
+    quint64             _lastSignaledTimestampUSecs;
+
+    static const int    _fastForwardBatchBytes          = 256 * 1024;
+    static const int    _fastForwardSignalIntervalMSecs = 1000;
+    static const int    _timestampSignalIntervalUSecs   = 40000;    ///< About one video frame
 };
 
 class LogReplayLinkController : public QObject
@@ -147,6 +165,10 @@ public:
     Q_PROPERTY(QString          totalTime       MEMBER _totalTime                                   NOTIFY totalTimeChanged)
     Q_PROPERTY(QString          playheadTime    MEMBER _playheadTime                                NOTIFY playheadTimeChanged)
     Q_PROPERTY(qreal            playbackSpeed   MEMBER _playbackSpeed                               NOTIFY playbackSpeedChanged)
+    Q_PROPERTY(double           messagesPerSecond MEMBER _messagesPerSecond                         NOTIFY messagesPerSecondChanged)    ///< Fast forward throughput
+    Q_PROPERTY(QString          videoFile       READ videoFile          WRITE setVideoFile          NOTIFY videoFileChanged)            ///< Recorded video to keep in sync with the log
+    Q_PROPERTY(bool             videoSynced     READ videoSynced                                    NOTIFY videoFileChanged)            ///< true: video has a sync index
+    Q_PROPERTY(qint64           videoPositionMSecs READ videoPositionMSecs                          NOTIFY videoPositionMSecsChanged)   ///< Video position for the playhead, -1 if outside the video
 
     LogReplayLinkController(void);
 
@@ -158,6 +180,18 @@ public:
     void setIsPlaying       (bool isPlaying);
     void setPercentComplete (qreal percentComplete);
 
+    QString videoFile           (void) const { return _videoFile; }
+    bool    videoSynced         (void) const { return _videoIndex.count() > 0; }
+    qint64  videoPositionMSecs  (void) const { return _videoPositionMSecs; }
+
+    void setVideoFile(const QString& videoFile);
+
+    /// @return Video position for a log timestamp, -1 if the video has no frame for that time
+    Q_INVOKABLE qint64 videoPositionForTimestamp(quint64 timestampUSecs) const;
+
+    /// Moves the log playhead to the capture time of a video position, e.g. after seeking the video
+    Q_INVOKABLE void seekToVideoPosition(qint64 positionMSecs);
+
 signals:
     void linkChanged            (LogReplayLink* link);
     void isPlayingChanged       (bool isPlaying);
@@ -165,6 +199,9 @@ signals:
     void playheadTimeChanged    (QString playheadTime);
     void totalTimeChanged       (QString totalTime);
     void playbackSpeedChanged   (qreal playbackSpeed);
+    void messagesPerSecondChanged(double messagesPerSecond);
+    void videoFileChanged       (void);
+    void videoPositionMSecsChanged(qint64 positionMSecs);
 
 private slots:
     void _logFileStats                   (int logDurationSecs);
@@ -174,6 +211,8 @@ private slots:
     void _playbackPercentCompleteChanged (qreal percentComplete);
     void _currentLogTimeSecs             (int secs);
     void _linkDisconnected               (void);
+    void _fastForwardThroughput          (double messagesPerSecond);
+    void _currentLogTimestampUSecs       (quint64 timestampUSecs);
 
 private:
     QString _secondsToHMS(int seconds);
@@ -185,5 +224,12 @@ private:
     QString         _playheadTime;
     QString         _totalTime;
     qreal           _playbackSpeed;
+    double          _messagesPerSecond;
+    QString         _videoFile;
+    VideoSyncIndex  _videoIndex;
+    quint64         _playheadTimestampUSecs;
+    qint64          _videoPositionMSecs;
+
+    static const quint64 _maxFrameGapUSecs = 1000000;  ///< Log times further than this past the last frame are outside the video
 };
 
@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkForwarder.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(MAVLinkForwarderLog, "MAVLinkForwarderLog")
+
+MAVLinkForwarder::MAVLinkForwarder(QObject* parent)
+    : QObject(parent)
+{
+    // A zero interval single shot timer fires once control returns to the event loop
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(0);
+    connect(&_flushTimer, &QTimer::timeout, this, &MAVLinkForwarder::_flush);
+
+    _clock.start();
+}
+
+void MAVLinkForwarder::addDestination(const SharedLinkInterfacePtr& link, const Filter& filter)
+{
+    for (Destination_t& destination: _destinations) {
+        if (destination.linkKey == link.get()) {
+            destination.filter = filter;
+            destination.lastForwardMSecs.clear();
+            return;
+        }
+    }
+
+    qCDebug(MAVLinkForwarderLog) << "addDestination" << link->linkConfiguration()->name();
+
+    Destination_t destination;
+    destination.link    = link;
+    destination.linkKey = link.get();
+    destination.filter  = filter;
+    destination.pending.reserve(_maxPendingBytes);
+    _destinations.append(destination);
+}
+
+void MAVLinkForwarder::removeDestination(LinkInterface* link)
+{
+    for (int i=0; i<_destinations.count(); i++) {
+        if (_destinations[i].linkKey == link) {
+            _destinations.removeAt(i);
+            return;
+        }
+    }
+}
+
+void MAVLinkForwarder::setFilter(const Filter& filter)
+{
+    for (Destination_t& destination: _destinations) {
+        destination.filter = filter;
+        destination.lastForwardMSecs.clear();
+    }
+}
+
+QSet<int> MAVLinkForwarder::parseMsgIdList(const QString& msgIdList)
+{
+    QSet<int> msgIds;
+
+    for (const QString& msgIdString: msgIdList.split(",", Qt::SkipEmptyParts)) {
+        bool ok;
+        int msgId = msgIdString.trimmed().toInt(&ok);
+        if (ok) {
+            msgIds.insert(msgId);
+        } else {
+            qCWarning(MAVLinkForwarderLog) << "Invalid message id in list" << msgIdString;
+        }
+    }
+
+    return msgIds;
+}
+
+void MAVLinkForwarder::forward(LinkInterface* sourceLink, const mavlink_message_t& message, const uint8_t* frame, int frameLength)
+{
+    if (!_enabled || _destinations.isEmpty()) {
+        return;
+    }
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    qint64  nowMSecs = _clock.elapsed();
+
+    for (Destination_t& destination: _destinations) {
+        if (destination.linkKey == sourceLink || !_accept(destination, message, nowMSecs)) {
+            continue;
+        }
+
+        if (!frame) {
+            // On-wire bytes not available, so we have to re-serialize. This is done once for all destinations.
+            frameLength = mavlink_msg_to_send_buffer(buf, &message);
+            frame = buf;
+        }
+
+        if (destination.pending.size() + frameLength > _maxPendingBytes) {
+            _flushDestination(destination);
+        }
+        destination.pending.append(reinterpret_cast<const char*>(frame), frameLength);
+    }
+
+    if (!_flushTimer.isActive()) {
+        _flushTimer.start();
+    }
+}
+
+bool MAVLinkForwarder::_accept(Destination_t& destination, const mavlink_message_t& message, qint64 nowMSecs)
+{
+    const Filter& filter = destination.filter;
+    int msgId = static_cast<int>(message.msgid);
+
+    if (!filter.allowedMsgIds.isEmpty() && !filter.allowedMsgIds.contains(msgId)) {
+        return false;
+    }
+    if (filter.deniedMsgIds.contains(msgId)) {
+        return false;
+    }
+
+    if (filter.maxRateHz > 0) {
+        quint64 key = (static_cast<quint64>(message.sysid) << 32) | (static_cast<quint64>(message.compid) << 24) | message.msgid;
+        auto iter = destination.lastForwardMSecs.find(key);
+        if (iter != destination.lastForwardMSecs.end()) {
+            if (nowMSecs - iter.value() < static_cast<qint64>(1000.0 / filter.maxRateHz)) {
+                return false;
+            }
+            iter.value() = nowMSecs;
+        } else {
+            destination.lastForwardMSecs[key] = nowMSecs;
+        }
+    }
+
+    return true;
+}
+
+void MAVLinkForwarder::_flushDestination(Destination_t& destination)
+{
+    if (destination.pending.isEmpty()) {
+        return;
+    }
+
+    SharedLinkInterfacePtr link = destination.link.lock();
+    if (link) {
+        link->writeBytesThreadSafe(destination.pending.constData(), destination.pending.size());
+    }
+    // resize keeps the reserved capacity around for the next batch
+    destination.pending.resize(0);
+}
+
+void MAVLinkForwarder::_flush(void)
+{
+    for (int i=_destinations.count()-1; i>=0; i--) {
+        if (_destinations[i].link.expired()) {
+            qCDebug(MAVLinkForwarderLog) << "Removing expired destination";
+            _destinations.removeAt(i);
+        } else {
+            _flushDestination(_destinations[i]);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QSet>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+#include "LinkInterface.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkForwarderLog)
+
+/// Forwards incoming MAVLink traffic to one or more destination links.
+///
+/// The original on-wire bytes are reused whenever they are available. Frames for each destination are packed together
+/// and written once per event loop pass, which for UDP destinations means one datagram per pass instead of one per
+/// message. Each destination has its own message id filter and rate decimation.
+class MAVLinkForwarder : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Filter {
+        QSet<int>   allowedMsgIds;      ///< Empty: all message ids allowed
+        QSet<int>   deniedMsgIds;
+        double      maxRateHz = 0;      ///< Max forwarding rate for each sysid/compid/msgid, 0 for unlimited
+    };
+
+    MAVLinkForwarder(QObject* parent = nullptr);
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool enabled   (void) const { return _enabled; }
+
+    /// Adds or updates a forwarding destination
+    void addDestination     (const SharedLinkInterfacePtr& link, const Filter& filter);
+    void removeDestination  (LinkInterface* link);
+
+    /// Updates the filter for all destinations
+    void setFilter(const Filter& filter);
+
+    /// Parses a comma separated message id list as used by the forwarding settings
+    static QSet<int> parseMsgIdList(const QString& msgIdList);
+
+    /// Queues a message for forwarding
+    ///     @param sourceLink   Link the message arrived on, messages are never forwarded back to their source link
+    ///     @param message      Decoded message
+    ///     @param frame        Original on-wire bytes, nullptr to re-serialize from message
+    ///     @param frameLength  Number of bytes in frame
+    void forward(LinkInterface* sourceLink, const mavlink_message_t& message, const uint8_t* frame = nullptr, int frameLength = 0);
+
+private slots:
+    void _flush(void);
+
+private:
+    typedef struct {
+        WeakLinkInterfacePtr    link;
+        LinkInterface*          linkKey;
+        Filter                  filter;
+        QHash<quint64, qint64>  lastForwardMSecs;   ///< Rate decimation state, key: sysid/compid/msgid
+        QByteArray              pending;
+    } Destination_t;
+
+    bool _accept(Destination_t& destination, const mavlink_message_t& message, qint64 nowMSecs);
+    void _flushDestination(Destination_t& destination);
+
+    bool                    _enabled = false;
+    QList<Destination_t>    _destinations;
+    QTimer                  _flushTimer;
+    QElapsedTimer           _clock;
+
+    static const int _maxPendingBytes = 1400;   ///< Keeps packed UDP datagrams below the typical MTU
+};
@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameScanner.h"
+#include "QGCLoggingCategory.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QGC_FRAME_SCANNER_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+QGC_LOGGING_CATEGORY(MAVLinkFrameScannerLog, "MAVLinkFrameScannerLog")
+
+int MAVLinkFrameScanner::peekRouting(const uint8_t* bytes, int length, int& sysid, int& targetSystem)
+{
+    int headerLength    = 0;
+    int signatureLength = 0;
+    uint32_t msgid      = 0;
+
+    if (length >= MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 && bytes[0] == MAVLINK_STX_MAVLINK1) {
+        headerLength    = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        sysid           = bytes[3];
+        msgid           = bytes[5];
+    } else if (length >= MAVLINK_NUM_HEADER_BYTES && bytes[0] == MAVLINK_STX) {
+        headerLength    = MAVLINK_NUM_HEADER_BYTES;
+        signatureLength = bytes[2] & MAVLINK_IFLAG_SIGNED ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+        sysid           = bytes[5];
+        msgid           = bytes[7] | (bytes[8] << 8) | (bytes[9] << 16);
+    } else {
+        return 0;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+    if (!entry) {
+        return 0;
+    }
+
+    const int payloadLength = bytes[1];
+    targetSystem = 0;
+    if ((entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) && entry->target_system_ofs < payloadLength) {
+        // Trailing zero bytes are truncated from mavlink 2 payloads, a missing target system is a broadcast
+        if (headerLength + entry->target_system_ofs >= length) {
+            return 0;
+        }
+        targetSystem = bytes[headerLength + entry->target_system_ofs];
+    }
+
+    return headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES + signatureLength;
+}
+
+int MAVLinkFrameScanner::parse(uint8_t channel, const uint8_t* bytes, int length, QVector<mavlink_message_t>& messages, QVector<FrameSpan_t>* frames, int* parseErrors)
+{
+    mavlink_status_t*   status          = mavlink_get_channel_status(channel);
+    int                 startCount      = messages.count();
+    int                 position        = 0;
+    int                 frameStart      = -1;
+    mavlink_message_t   message;
+    mavlink_status_t    messageStatus;
+
+    while (position < length) {
+        if (status->parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+            // The stock parser ignores everything up to the next STX while idle, so we can skip it in bulk
+            position = _findStx(bytes, position, length);
+            if (position >= length) {
+                break;
+            }
+
+            int frameLength = _decodeFrame(status, &bytes[position], length - position, message);
+            if (frameLength > 0) {
+                messages.append(message);
+                if (frames) {
+                    frames->append({ position, frameLength });
+                }
+                position += frameLength;
+                continue;
+            }
+        }
+
+        // Slow path: partial frame, frame continuing from a previous buffer, or a frame the fast path does not handle.
+        // Run the stock parser until it produces a message or falls back to idle.
+        do {
+            uint8_t previousParseError = status->parse_error;
+            uint8_t result = mavlink_parse_char(channel, bytes[position], &message, &messageStatus);
+            if (parseErrors && status->parse_error != previousParseError && status->parse_error != 0) {
+                (*parseErrors)++;
+            }
+            if (status->parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
+                // A new frame starts here, this also covers a resync on STX after a bad CRC
+                frameStart = position;
+            }
+            position++;
+            if (result == MAVLINK_FRAMING_OK) {
+                messages.append(message);
+                if (frames) {
+                    frames->append({ frameStart, frameStart == -1 ? 0 : position - frameStart });
+                }
+                frameStart = -1;
+                break;
+            }
+        } while (position < length && status->parse_state > MAVLINK_PARSE_STATE_IDLE);
+    }
+
+    return messages.count() - startCount;
+}
+
+int MAVLinkFrameScanner::_findStx(const uint8_t* bytes, int start, int length)
+{
+    int i = start;
+
+#ifdef QGC_FRAME_SCANNER_SSE2
+    const __m128i stx1 = _mm_set1_epi8(static_cast<char>(MAVLINK_STX_MAVLINK1));
+    const __m128i stx2 = _mm_set1_epi8(static_cast<char>(MAVLINK_STX));
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bytes[i]));
+        int     mask    = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, stx1), _mm_cmpeq_epi8(chunk, stx2)));
+        if (mask) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            return i + static_cast<int>(bit);
+#else
+            return i + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (bytes[i] == MAVLINK_STX || bytes[i] == MAVLINK_STX_MAVLINK1) {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+/// Decodes a complete frame starting at an STX byte without going through the byte wise state machine.
+///     @return Length of frame consumed, 0 if the frame must go through the stock parser
+int MAVLinkFrameScanner::_decodeFrame(mavlink_status_t* status, const uint8_t* frame, int available, mavlink_message_t& message)
+{
+    bool    mavlink1    = frame[0] == MAVLINK_STX_MAVLINK1;
+    int     headerLen   = mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES;
+
+    if (status->signing || available < headerLen) {
+        // Signing policy (including acceptance of unsigned frames) is left to the stock parser
+        return 0;
+    }
+
+    uint8_t payloadLen = frame[1];
+    uint8_t incompatFlags = 0;
+    if (mavlink1) {
+        message.seq     = frame[2];
+        message.sysid   = frame[3];
+        message.compid  = frame[4];
+        message.msgid   = frame[5];
+    } else {
+        incompatFlags = frame[2];
+        if (incompatFlags & ~MAVLINK_IFLAG_SIGNED) {
+            // Unknown incompatibility flags: leave rejection logic to the stock parser
+            return 0;
+        }
+        message.compat_flags    = frame[3];
+        message.seq             = frame[4];
+        message.sysid           = frame[5];
+        message.compid          = frame[6];
+        message.msgid           = frame[7] | (frame[8] << 8) | (frame[9] << 16);
+    }
+
+    // Without channel signing the stock parser passes signed frames through unchecked, verification is done by
+    // MAVLinkSigning on the decoded messages
+    int signatureLen = incompatFlags & MAVLINK_IFLAG_SIGNED ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+    int frameLen = headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES + signatureLen;
+    if (available < frameLen) {
+        return 0;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    if (!entry) {
+        return 0;
+    }
+
+    uint16_t crc = crc_calculate(&frame[1], static_cast<uint16_t>(headerLen - 1 + payloadLen));
+    crc_accumulate(entry->crc_extra, &crc);
+    const uint8_t* ck = &frame[headerLen + payloadLen];
+    if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+        // Let the stock parser account for the bad CRC and resync
+        return 0;
+    }
+
+    message.magic           = frame[0];
+    message.len             = payloadLen;
+    message.incompat_flags  = incompatFlags;
+    if (mavlink1) {
+        message.compat_flags = 0;
+    }
+    message.checksum        = crc;
+    message.ck[0]           = ck[0];
+    message.ck[1]           = ck[1];
+    if (signatureLen) {
+        memcpy(message.signature, &ck[MAVLINK_NUM_CHECKSUM_BYTES], MAVLINK_SIGNATURE_BLOCK_LEN);
+    }
+    memcpy(_MAV_PAYLOAD_NON_CONST(&message), &frame[headerLen], payloadLen);
+    if (payloadLen < entry->max_msg_len) {
+        // Zero-fill truncated payloads the same way the stock parser does
+        memset(&_MAV_PAYLOAD_NON_CONST(&message)[payloadLen], 0, entry->max_msg_len - payloadLen);
+    }
+
+    // Mirror the channel status updates the stock parser makes on a successful frame
+    if (mavlink1) {
+        status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    status->parse_state     = MAVLINK_PARSE_STATE_IDLE;
+    status->msg_received    = MAVLINK_FRAMING_INCOMPLETE;
+    status->current_rx_seq  = message.seq;
+    if (status->packet_rx_success_count == 0) {
+        status->packet_rx_drop_count = 0;
+    }
+    status->packet_rx_success_count++;
+    status->parse_error     = 0;
+
+    return frameLen;
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkFrameScannerLog)
+
+/// Frame aware bulk MAVLink decoder.
+///
+/// Decodes all complete messages from a buffer in a single pass. While the channel parser is idle the scanner
+/// skips directly to the next STX marker and validates complete frames by length and CRC over the whole frame.
+/// Signatures are carried into the message, checking them is up to MAVLinkSigning. Anything else (partial frames at
+/// buffer end, channels with signing set up in the MAVLink library, bad CRCs, unknown message ids) is handed to
+/// mavlink_parse_char byte by byte, so the per-channel mavlink_status_t is left exactly as the stock parser would
+/// leave it.
+class MAVLinkFrameScanner
+{
+public:
+    /// Location of the on-wire bytes for a decoded message within the buffer passed to parse
+    typedef struct {
+        int offset;     ///< -1 if the frame started in a previous buffer
+        int length;
+    } FrameSpan_t;
+
+    /// Decodes all messages contained in bytes and appends them to messages
+    ///     @param channel      MAVLink channel for the link the bytes arrived on
+    ///     @param bytes        Raw bytes from the link
+    ///     @param length       Number of bytes
+    ///     @param messages     Decoded messages are appended here
+    ///     @param frames       Optional: a frame span for each decoded message is appended here
+    ///     @param parseErrors  Optional: incremented for each parse error reported by the parser, e.g. bad CRC
+    /// @return Number of messages appended
+    static int parse(uint8_t channel, const uint8_t* bytes, int length, QVector<mavlink_message_t>& messages, QVector<FrameSpan_t>* frames = nullptr, int* parseErrors = nullptr);
+
+    /// Reads the routing fields of the frame at the start of bytes without decoding or validating it
+    ///     @param sysid        Returns the sender system id
+    ///     @param targetSystem Returns the target system, 0 for broadcast or messages without a target system
+    /// @return On-wire length of the frame, 0 if bytes do not start with a known, complete frame header
+    static int peekRouting(const uint8_t* bytes, int length, int& sysid, int& targetSystem);
+
+private:
+    static int  _findStx        (const uint8_t* bytes, int start, int length);
+    static int  _decodeFrame    (mavlink_status_t* status, const uint8_t* frame, int available, mavlink_message_t& message);
+};
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(MAVLinkLogWriterLog, "MAVLinkLogWriterLog")
+
+MAVLinkLogWriter::MAVLinkLogWriter(QObject* parent)
+    : QThread       (parent)
+    , _ringBuffer   (_ringBufferSize)
+{
+
+}
+
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    stopWriting();
+}
+
+void MAVLinkLogWriter::startWriting(QFile* file)
+{
+    stopWriting();
+
+    _file = file;
+    _writeIndex = 0;
+    _readIndex = 0;
+    _droppedRecordCount = 0;
+    _stopRequested = false;
+    _writeFailed = false;
+
+    start(LowPriority);
+}
+
+void MAVLinkLogWriter::stopWriting(void)
+{
+    if (!_file) {
+        return;
+    }
+
+    _wakeMutex.lock();
+    _stopRequested = true;
+    _wakeCondition.wakeOne();
+    _wakeMutex.unlock();
+    wait();
+    _file = nullptr;
+
+    if (_droppedRecordCount) {
+        qCWarning(MAVLinkLogWriterLog) << "Dropped log records" << _droppedRecordCount;
+    }
+}
+
+bool MAVLinkLogWriter::writeRecord(quint64 timestampUSecs, const uint8_t* frame, int length)
+{
+    if (!_file) {
+        return false;
+    }
+    if (_writeFailed) {
+        return true;
+    }
+
+    quint64 recordLength    = sizeof(quint64) + static_cast<quint64>(length);
+    quint64 writeIndex      = _writeIndex.load(std::memory_order_relaxed);
+    quint64 readIndex       = _readIndex.load(std::memory_order_acquire);
+
+    if (_ringBufferSize - (writeIndex - readIndex) < recordLength) {
+        _droppedRecordCount++;
+        _wakeCondition.wakeOne();
+        return false;
+    }
+
+    uint8_t timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUSecs, timestamp);
+    _append(timestamp, sizeof(timestamp), writeIndex);
+    _append(frame, static_cast<quint64>(length), writeIndex + sizeof(timestamp));
+
+    _writeIndex.store(writeIndex + recordLength, std::memory_order_release);
+
+    // Only wake the writer early when a full block is ready, otherwise it picks things up on its flush interval
+    if (writeIndex + recordLength - readIndex >= _writeBlockSize) {
+        _wakeCondition.wakeOne();
+    }
+
+    return true;
+}
+
+void MAVLinkLogWriter::_append(const uint8_t* bytes, quint64 length, quint64 writeIndex)
+{
+    quint64 offset  = writeIndex & (_ringBufferSize - 1);
+    quint64 first   = qMin(length, _ringBufferSize - offset);
+
+    memcpy(&_ringBuffer[offset], bytes, first);
+    if (first < length) {
+        memcpy(&_ringBuffer[0], bytes + first, length - first);
+    }
+}
+
+/// Writes everything currently in the ring buffer to the file
+///     @return false: write failed
+bool MAVLinkLogWriter::_writePending(void)
+{
+    quint64 readIndex   = _readIndex.load(std::memory_order_relaxed);
+    quint64 writeIndex  = _writeIndex.load(std::memory_order_acquire);
+
+    while (readIndex != writeIndex) {
+        quint64 offset  = readIndex & (_ringBufferSize - 1);
+        qint64  length  = static_cast<qint64>(qMin(writeIndex - readIndex, _ringBufferSize - offset));
+
+        if (_file->write(reinterpret_cast<const char*>(&_ringBuffer[offset]), length) != length) {
+            return false;
+        }
+
+        readIndex += static_cast<quint64>(length);
+        _readIndex.store(readIndex, std::memory_order_release);
+    }
+
+    return _file->flush();
+}
+
+void MAVLinkLogWriter::run(void)
+{
+    while (true) {
+        bool stop = _stopRequested;
+
+        if (!_writePending()) {
+            qCWarning(MAVLinkLogWriterLog) << "Log write failed" << _file->errorString();
+            _writeFailed = true;
+            emit writeError(_file->errorString());
+            break;
+        }
+
+        if (stop) {
+            break;
+        }
+
+        _wakeMutex.lock();
+        if (!_stopRequested) {
+            _wakeCondition.wait(&_wakeMutex, _flushIntervalMSecs);
+        }
+        _wakeMutex.unlock();
+    }
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QLoggingCategory>
+
+#include <atomic>
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogWriterLog)
+
+/// Writes telemetry log records (big endian uint64 timestamp in usecs followed by the raw frame) on a dedicated thread.
+///
+/// Records are copied into a preallocated single producer/single consumer ring buffer without taking any locks. The
+/// writer thread drains the buffer in large sequential writes. The producer must always be the same thread (the
+/// MAVLinkProtocol thread). If the disk can't keep up and the ring fills, new records are dropped and counted rather
+/// than blocking the producer.
+class MAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogWriter(QObject* parent = nullptr);
+    ~MAVLinkLogWriter();
+
+    /// Starts writing records to the specified file which must already be open for writing. The file must not be
+    /// touched by the caller until stopWriting is called.
+    void startWriting(QFile* file);
+
+    /// Writes all remaining records to the file and stops the writer thread.
+    void stopWriting(void);
+
+    bool writing(void) const { return _file != nullptr; }
+
+    /// Queues a log record for writing. Records queued after a write error are discarded silently, since the failure
+    /// has already been reported through writeError.
+    ///     @return false: ring buffer is full and the record was dropped
+    bool writeRecord(quint64 timestampUSecs, const uint8_t* frame, int length);
+
+    /// @return Number of records dropped since startWriting due to the ring buffer being full
+    quint64 droppedRecordCount(void) const { return _droppedRecordCount; }
+
+signals:
+    /// Emitted from the writer thread if writing to the file fails. Writing stops after this.
+    void writeError(const QString& errorString);
+
+protected:
+    void run(void) override;
+
+private:
+    void _append        (const uint8_t* bytes, quint64 length, quint64 writeIndex);
+    bool _writePending  (void);
+
+    QFile*                  _file                   = nullptr;
+    std::vector<uint8_t>    _ringBuffer;
+    std::atomic<quint64>    _writeIndex             { 0 };      ///< Total bytes produced, only written by the producer
+    std::atomic<quint64>    _readIndex              { 0 };      ///< Total bytes consumed, only written by the writer thread
+    std::atomic<bool>       _stopRequested          { false };
+    std::atomic<bool>       _writeFailed            { false };
+    quint64                 _droppedRecordCount     = 0;
+
+    QMutex                  _wakeMutex;
+    QWaitCondition          _wakeCondition;
+
+    static const quint64    _ringBufferSize         = 4 * 1024 * 1024;  ///< Must be a power of 2
+    static const quint64    _writeBlockSize         = 64 * 1024;        ///< Writer wakes up early once this much is pending
+    static const int        _flushIntervalMSecs     = 250;
+
+    static_assert((_ringBufferSize & (_ringBufferSize - 1)) == 0, "_ringBufferSize must be a power of 2");
+};
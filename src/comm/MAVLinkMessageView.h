@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "QGCMAVLink.h"
+
+/// Reads single fields of a MAVLink message in place from its payload.
+///
+/// mavlink_msg_*_decode copies and zero fills the whole message struct, which is wasted work for handlers which only
+/// look at a few fields of a frequent message. The payload layout is the layout of the packed message struct, so the
+/// offset and type of a field are taken from the generated mavlink_<name>_t at compile time. Fields which lie beyond
+/// a MAVLink 2 truncated payload read as zero, exactly like the decode functions.
+///
+/// Use through the macros:
+///     int32_t lat = QGC_MAVLINK_FIELD(message, global_position_int, lat);
+///     QGC_MAVLINK_ARRAY(message, attitude_quaternion, repr_offset_q, q);
+/// The caller must have checked the message id, as for the decode functions.
+class MAVLinkMessageView
+{
+public:
+    template<typename T>
+    static T field(const mavlink_message_t& message, size_t offset)
+    {
+        static_assert(std::is_arithmetic<T>::value, "Use QGC_MAVLINK_ARRAY for array fields");
+
+        T value;
+        if (offset + sizeof(T) <= message.len) {
+            memcpy(&value, _payload(message) + offset, sizeof(T));
+        } else {
+            _copyTruncated(message, offset, &value, sizeof(T));
+        }
+        return value;
+    }
+
+    static void copy(const mavlink_message_t& message, size_t offset, void* dest, size_t size)
+    {
+        if (offset + size <= message.len) {
+            memcpy(dest, _payload(message) + offset, size);
+        } else {
+            _copyTruncated(message, offset, dest, size);
+        }
+    }
+
+private:
+    static const uint8_t* _payload(const mavlink_message_t& message)
+    {
+        return reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&message));
+    }
+
+    static void _copyTruncated(const mavlink_message_t& message, size_t offset, void* dest, size_t size)
+    {
+        size_t available = message.len > offset ? message.len - offset : 0;
+        if (available > size) {
+            available = size;
+        }
+        if (available) {
+            memcpy(dest, _payload(message) + offset, available);
+        }
+        memset(static_cast<uint8_t*>(dest) + available, 0, size - available);
+    }
+};
+
+#define QGC_MAVLINK_FIELD(message, msgName, fieldName) \
+    MAVLinkMessageView::field<decltype(mavlink_##msgName##_t::fieldName)>((message), offsetof(mavlink_##msgName##_t, fieldName))
+
+#define QGC_MAVLINK_ARRAY(message, msgName, fieldName, dest) \
+    do { \
+        static_assert(sizeof(dest) == sizeof(mavlink_##msgName##_t::fieldName), "Destination size does not match field"); \
+        MAVLinkMessageView::copy((message), offsetof(mavlink_##msgName##_t, fieldName), (dest), sizeof(dest)); \
+    } while (0)
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMetrics.h"
+
+#include <QMap>
+
+#include <chrono>
+
+MAVLinkMetrics::MAVLinkMetrics(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+qint64 MAVLinkMetrics::nowUSecs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void MAVLinkMetrics::recordBytes(int count)
+{
+    _totalBytes     += static_cast<quint64>(count);
+    _intervalBytes  += static_cast<quint64>(count);
+}
+
+void MAVLinkMetrics::recordMessage(uint32_t msgId)
+{
+    _totalMessages++;
+    _intervalMessages++;
+    _totalMessageCounts[msgId]++;
+    _intervalMessageCounts[msgId]++;
+}
+
+void MAVLinkMetrics::recordLatencyUSecs(qint64 latencyUSecs)
+{
+    int bucket = _latencyBucket(latencyUSecs);
+
+    _totalLatency[bucket]++;
+    _intervalLatency[bucket]++;
+    _totalLatencyCount++;
+    _intervalLatencyCount++;
+    _totalLatencySumUSecs += latencyUSecs;
+    _intervalLatencyMaxUSecs = qMax(_intervalLatencyMaxUSecs, latencyUSecs);
+}
+
+void MAVLinkMetrics::recordSigning(int verified, int signatureErrors, int replays, int unsignedRejected)
+{
+    _signedMessages     += static_cast<quint64>(verified);
+    _signatureErrors    += static_cast<quint64>(signatureErrors);
+    _signatureReplays   += static_cast<quint64>(replays);
+    _unsignedRejected   += static_cast<quint64>(unsignedRejected);
+}
+
+int MAVLinkMetrics::_latencyBucket(qint64 latencyUSecs)
+{
+    int bucket = 0;
+    while (latencyUSecs > 1 && bucket < _latencyBucketCount - 1) {
+        latencyUSecs >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/// @return Upper bound of the histogram bucket which contains the percentile
+double MAVLinkMetrics::_latencyPercentileMSecs(const LatencyHistogram_t& histogram, quint64 count, double percentile)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    quint64 target      = static_cast<quint64>(count * percentile);
+    quint64 cumulative  = 0;
+    for (int i=0; i<_latencyBucketCount; i++) {
+        cumulative += histogram[i];
+        if (cumulative > target) {
+            return (1ll << (i + 1)) / 1000.0;
+        }
+    }
+    return (1ll << _latencyBucketCount) / 1000.0;
+}
+
+void MAVLinkMetrics::update(qint64 elapsedMSecs)
+{
+    double seconds = elapsedMSecs > 0 ? elapsedMSecs / 1000.0 : 1.0;
+
+    _bytesPerSecond     = _intervalBytes / seconds;
+    _messagesPerSecond  = _intervalMessages / seconds;
+    _maxQueueDepth      = _intervalMaxQueueDepth;
+    _latencyP50MSecs    = _latencyPercentileMSecs(_intervalLatency, _intervalLatencyCount, 0.5);
+    _latencyP95MSecs    = _latencyPercentileMSecs(_intervalLatency, _intervalLatencyCount, 0.95);
+    _latencyMaxMSecs    = _intervalLatencyMaxUSecs / 1000.0;
+
+    _messageRates.clear();
+    for (auto iter = _intervalMessageCounts.constBegin(); iter != _intervalMessageCounts.constEnd(); iter++) {
+        _messageRates[iter.key()] = iter.value() / seconds;
+    }
+
+    _intervalBytes              = 0;
+    _intervalMessages           = 0;
+    _intervalMaxQueueDepth      = 0;
+    _intervalLatencyCount       = 0;
+    _intervalLatencyMaxUSecs    = 0;
+    _intervalLatency.fill(0);
+    _intervalMessageCounts.clear();
+
+    emit updated();
+}
+
+QVariantMap MAVLinkMetrics::messageRates(void) const
+{
+    QVariantMap rates;
+
+    for (auto iter = _messageRates.constBegin(); iter != _messageRates.constEnd(); iter++) {
+        rates[QString::number(iter.key())] = iter.value();
+    }
+
+    return rates;
+}
+
+void MAVLinkMetrics::writePrometheus(QTextStream& stream, const QList<LabeledMetrics_t>& metricsList)
+{
+    // Samples for the same metric must be grouped together, so each metric is written for all objects in turn
+
+    stream << "# TYPE qgc_mavlink_received_bytes_total counter\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        stream << "qgc_mavlink_received_bytes_total{" << metrics.first << "} " << metrics.second->_totalBytes << "\n";
+    }
+
+    stream << "# TYPE qgc_mavlink_parse_errors_total counter\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        stream << "qgc_mavlink_parse_errors_total{" << metrics.first << "} " << metrics.second->_parseErrors << "\n";
+    }
+
+    stream << "# TYPE qgc_mavlink_signed_messages_total counter\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        stream << "qgc_mavlink_signed_messages_total{" << metrics.first << "} " << metrics.second->_signedMessages << "\n";
+    }
+
+    stream << "# TYPE qgc_mavlink_signing_rejected_total counter\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        stream << "qgc_mavlink_signing_rejected_total{" << metrics.first << ",reason=\"signature\"} " << metrics.second->_signatureErrors << "\n";
+        stream << "qgc_mavlink_signing_rejected_total{" << metrics.first << ",reason=\"replay\"} " << metrics.second->_signatureReplays << "\n";
+        stream << "qgc_mavlink_signing_rejected_total{" << metrics.first << ",reason=\"unsigned\"} " << metrics.second->_unsignedRejected << "\n";
+    }
+
+    stream << "# TYPE qgc_mavlink_queue_depth_max gauge\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        stream << "qgc_mavlink_queue_depth_max{" << metrics.first << "} " << metrics.second->_maxQueueDepth << "\n";
+    }
+
+    stream << "# TYPE qgc_mavlink_received_messages_total counter\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        // Sorted by message id so the output is stable
+        QMap<uint32_t, quint64> messageCounts;
+        for (auto iter = metrics.second->_totalMessageCounts.constBegin(); iter != metrics.second->_totalMessageCounts.constEnd(); iter++) {
+            messageCounts[iter.key()] = iter.value();
+        }
+        for (auto iter = messageCounts.constBegin(); iter != messageCounts.constEnd(); iter++) {
+            stream << "qgc_mavlink_received_messages_total{" << metrics.first << ",msgid=\"" << iter.key() << "\"} " << iter.value() << "\n";
+        }
+    }
+
+    stream << "# TYPE qgc_mavlink_receive_latency_seconds histogram\n";
+    for (const LabeledMetrics_t& metrics: metricsList) {
+        quint64 cumulative = 0;
+        for (int i=0; i<_latencyBucketCount; i++) {
+            cumulative += metrics.second->_totalLatency[i];
+            stream << "qgc_mavlink_receive_latency_seconds_bucket{" << metrics.first << ",le=\"" << (1ll << (i + 1)) / 1e6 << "\"} " << cumulative << "\n";
+        }
+        stream << "qgc_mavlink_receive_latency_seconds_bucket{" << metrics.first << ",le=\"+Inf\"} " << metrics.second->_totalLatencyCount << "\n";
+        stream << "qgc_mavlink_receive_latency_seconds_sum{" << metrics.first << "} " << metrics.second->_totalLatencySumUSecs / 1e6 << "\n";
+        stream << "qgc_mavlink_receive_latency_seconds_count{" << metrics.first << "} " << metrics.second->_totalLatencyCount << "\n";
+    }
+}
+
+void MAVLinkMetrics::writeCsvHeader(QTextStream& stream)
+{
+    stream << "scope,name,bytesPerSecond,messagesPerSecond,totalBytes,totalMessages,parseErrors,maxQueueDepth,latencyP50MSecs,latencyP95MSecs,latencyMaxMSecs,signedMessages,signatureErrors,signatureReplays,unsignedRejected\n";
+}
+
+void MAVLinkMetrics::writeCsv(QTextStream& stream, const QString& scope, const QString& name) const
+{
+    QString quotedName = name;
+    quotedName.replace("\"", "\"\"");
+
+    stream << scope << ",\"" << quotedName << "\","
+           << _bytesPerSecond << "," << _messagesPerSecond << ","
+           << _totalBytes << "," << _totalMessages << "," << _parseErrors << "," << _maxQueueDepth << ","
+           << _latencyP50MSecs << "," << _latencyP95MSecs << "," << _latencyMaxMSecs << ","
+           << _signedMessages << "," << _signatureErrors << "," << _signatureReplays << "," << _unsignedRejected << "\n";
+}
@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVariantMap>
+#include <QTextStream>
+#include <QPair>
+#include <QList>
+
+#include <array>
+
+/// MAVLink receive statistics for a single link or vehicle.
+///
+/// All record methods and properties are used from the MAVLinkProtocol thread only. Interval values (rates, queue
+/// depth, latency percentiles) are recalculated each time update is called, totals accumulate for the life of the
+/// object.
+class MAVLinkMetrics : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkMetrics(QObject* parent = nullptr);
+
+    Q_PROPERTY(double   bytesPerSecond      READ bytesPerSecond     NOTIFY updated)
+    Q_PROPERTY(double   messagesPerSecond   READ messagesPerSecond  NOTIFY updated)
+    Q_PROPERTY(quint64  totalBytes          READ totalBytes         NOTIFY updated)
+    Q_PROPERTY(quint64  totalMessages       READ totalMessages      NOTIFY updated)
+    Q_PROPERTY(quint64  parseErrors         READ parseErrors        NOTIFY updated)
+    Q_PROPERTY(int      maxQueueDepth       READ maxQueueDepth      NOTIFY updated)     ///< Max buffers waiting between link and protocol thread
+    Q_PROPERTY(double   latencyP50MSecs     READ latencyP50MSecs    NOTIFY updated)     ///< Link receive to message processing complete
+    Q_PROPERTY(double   latencyP95MSecs     READ latencyP95MSecs    NOTIFY updated)
+    Q_PROPERTY(double   latencyMaxMSecs     READ latencyMaxMSecs    NOTIFY updated)
+    Q_PROPERTY(quint64  signedMessages      READ signedMessages     NOTIFY updated)     ///< Messages which passed signature verification
+    Q_PROPERTY(quint64  signatureErrors     READ signatureErrors    NOTIFY updated)     ///< Rejected: bad signature
+    Q_PROPERTY(quint64  signatureReplays    READ signatureReplays   NOTIFY updated)     ///< Rejected: time stamp too old
+    Q_PROPERTY(quint64  unsignedRejected    READ unsignedRejected   NOTIFY updated)     ///< Rejected: not signed
+
+    /// @return Map from message id to messages per second over the last interval
+    Q_INVOKABLE QVariantMap messageRates(void) const;
+
+    double  bytesPerSecond      (void) const { return _bytesPerSecond; }
+    double  messagesPerSecond   (void) const { return _messagesPerSecond; }
+    quint64 totalBytes          (void) const { return _totalBytes; }
+    quint64 totalMessages       (void) const { return _totalMessages; }
+    quint64 parseErrors         (void) const { return _parseErrors; }
+    int     maxQueueDepth       (void) const { return _maxQueueDepth; }
+    double  latencyP50MSecs     (void) const { return _latencyP50MSecs; }
+    double  latencyP95MSecs     (void) const { return _latencyP95MSecs; }
+    double  latencyMaxMSecs     (void) const { return _latencyMaxMSecs; }
+    quint64 signedMessages      (void) const { return _signedMessages; }
+    quint64 signatureErrors     (void) const { return _signatureErrors; }
+    quint64 signatureReplays    (void) const { return _signatureReplays; }
+    quint64 unsignedRejected    (void) const { return _unsignedRejected; }
+
+    void recordBytes        (int count);
+    void recordMessage      (uint32_t msgId);
+    void recordParseErrors  (int count) { _parseErrors += static_cast<quint64>(count); }
+    void recordQueueDepth   (int depth) { _intervalMaxQueueDepth = qMax(_intervalMaxQueueDepth, depth); }
+    void recordLatencyUSecs (qint64 latencyUSecs);
+    void recordSigning      (int verified, int signatureErrors, int replays, int unsignedRejected);
+
+    /// Recalculates interval values and signals updated
+    ///     @param elapsedMSecs Time since the last update
+    void update(qint64 elapsedMSecs);
+
+    /// Label set identifying a metrics object, e.g. link="UDP Link"
+    typedef QPair<QString, const MAVLinkMetrics*> LabeledMetrics_t;
+
+    /// Writes the metrics for all objects in Prometheus text exposition format
+    static void writePrometheus(QTextStream& stream, const QList<LabeledMetrics_t>& metricsList);
+
+    /// Writes a single CSV row, matching writeCsvHeader
+    void writeCsv(QTextStream& stream, const QString& scope, const QString& name) const;
+
+    static void writeCsvHeader(QTextStream& stream);
+
+    /// Timestamp from a monotonic clock which is comparable across threads
+    static qint64 nowUSecs(void);
+
+signals:
+    void updated(void);
+
+private:
+    static const int _latencyBucketCount = 25;  ///< Bucket i holds latencies in [2^i, 2^(i+1)) usecs
+
+    typedef std::array<quint64, _latencyBucketCount> LatencyHistogram_t;
+
+    static int      _latencyBucket          (qint64 latencyUSecs);
+    static double   _latencyPercentileMSecs (const LatencyHistogram_t& histogram, quint64 count, double percentile);
+
+    quint64 _totalBytes         = 0;
+    quint64 _totalMessages      = 0;
+    quint64 _parseErrors        = 0;
+    quint64 _intervalBytes      = 0;
+    quint64 _intervalMessages   = 0;
+    int     _intervalMaxQueueDepth = 0;
+    quint64 _signedMessages     = 0;
+    quint64 _signatureErrors    = 0;
+    quint64 _signatureReplays   = 0;
+    quint64 _unsignedRejected   = 0;
+
+    QHash<uint32_t, quint64>    _totalMessageCounts;
+    QHash<uint32_t, quint64>    _intervalMessageCounts;
+    QHash<uint32_t, double>     _messageRates;
+
+    LatencyHistogram_t  _totalLatency       {};
+    LatencyHistogram_t  _intervalLatency    {};
+    quint64             _totalLatencyCount  = 0;
+    quint64             _intervalLatencyCount = 0;
+    double              _totalLatencySumUSecs = 0;
+    qint64              _intervalLatencyMaxUSecs = 0;
+
+    double  _bytesPerSecond     = 0;
+    double  _messagesPerSecond  = 0;
+    int     _maxQueueDepth      = 0;
+    double  _latencyP50MSecs    = 0;
+    double  _latencyP95MSecs    = 0;
+    double  _latencyMaxMSecs    = 0;
+};
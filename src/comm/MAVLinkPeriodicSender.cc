@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkPeriodicSender.h"
+
+#include <QCoreApplication>
+
+QGC_LOGGING_CATEGORY(MAVLinkPeriodicSenderLog, "MAVLinkPeriodicSenderLog")
+
+MAVLinkPeriodicSender* MAVLinkPeriodicSender::instance(void)
+{
+    static MAVLinkPeriodicSender* sender = new MAVLinkPeriodicSender(QCoreApplication::instance());
+    return sender;
+}
+
+MAVLinkPeriodicSender::MAVLinkPeriodicSender(QObject* parent)
+    : QObject(parent)
+{
+    _clock.start();
+    _timer.setSingleShot(true);
+    _timer.setTimerType(Qt::PreciseTimer);
+    connect(&_timer, &QTimer::timeout, this, &MAVLinkPeriodicSender::_tick);
+}
+
+int MAVLinkPeriodicSender::add(QObject* context, int intervalMSecs, SendFunction send, int phaseMSecs)
+{
+    Entry_t entry;
+
+    entry.id            = _nextId++;
+    entry.context       = context;
+    entry.intervalTicks = qMax(1, (intervalMSecs + (tickMSecs / 2)) / tickMSecs);
+    entry.phaseTicks    = (phaseMSecs / tickMSecs) % entry.intervalTicks;
+    entry.send          = send;
+    _schedule(entry, _nowTick());
+    _entries.append(entry);
+
+    qCDebug(MAVLinkPeriodicSenderLog) << "add" << entry.id << "interval" << intervalMSecs << "phase" << phaseMSecs;
+
+    _startTimer();
+    return entry.id;
+}
+
+void MAVLinkPeriodicSender::remove(int id)
+{
+    const int index = _indexOf(id);
+    if (index != -1) {
+        _entries.removeAt(index);
+        if (_entries.isEmpty()) {
+            _timer.stop();
+        }
+    }
+}
+
+void MAVLinkPeriodicSender::setInterval(int id, int intervalMSecs)
+{
+    const int index = _indexOf(id);
+    if (index != -1) {
+        Entry_t& entry = _entries[index];
+        entry.intervalTicks = qMax(1, (intervalMSecs + (tickMSecs / 2)) / tickMSecs);
+        entry.phaseTicks    %= entry.intervalTicks;
+        _schedule(entry, _nowTick());
+        _startTimer();
+    }
+}
+
+int MAVLinkPeriodicSender::_indexOf(int id) const
+{
+    for (int i=0; i<_entries.count(); i++) {
+        if (_entries[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/// Sets the next send to the first multiple of the interval (plus phase) after afterTick
+void MAVLinkPeriodicSender::_schedule(Entry_t& entry, qint64 afterTick)
+{
+    if (afterTick < entry.phaseTicks) {
+        entry.nextTick = entry.phaseTicks;
+        return;
+    }
+    entry.nextTick = (((afterTick - entry.phaseTicks) / entry.intervalTicks) + 1) * entry.intervalTicks + entry.phaseTicks;
+}
+
+void MAVLinkPeriodicSender::_tick(void)
+{
+    const qint64 nowTick = _nowTick();
+
+    // Collected first since a send function may add or remove sends
+    QVector<int> dueIds;
+    for (int i=_entries.count()-1; i>=0; i--) {
+        if (!_entries[i].context) {
+            _entries.removeAt(i);
+        } else if (_entries[i].nextTick <= nowTick) {
+            dueIds.prepend(_entries[i].id);
+        }
+    }
+
+    for (int id: dueIds) {
+        int index = _indexOf(id);
+        if (index == -1 || !_entries[index].context) {
+            continue;
+        }
+        // Late ticks catch up to the schedule instead of sending a burst
+        _schedule(_entries[index], nowTick);
+        SendFunction send = _entries[index].send;
+        send();
+    }
+
+    _startTimer();
+}
+
+void MAVLinkPeriodicSender::_startTimer(void)
+{
+    if (_entries.isEmpty()) {
+        _timer.stop();
+        return;
+    }
+
+    qint64 nextTick = _entries[0].nextTick;
+    for (const Entry_t& entry: _entries) {
+        nextTick = qMin(nextTick, entry.nextTick);
+    }
+    const qint64 wakeMSecs = (nextTick * tickMSecs) - _clock.elapsed();
+    _timer.start(static_cast<int>(qMax(static_cast<qint64>(0), wakeMSecs)));
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <functional>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkPeriodicSenderLog)
+
+/// Runs the periodic outbound sends (GCS heartbeat, follow target reports, remote id, ...) from a single timer.
+///
+/// Send times are multiples of the send interval counted from a common epoch and rounded to tickMSecs, so sends with
+/// related intervals fall on the same tick. Everything due in a tick is sent back to back, which queues it on each link
+/// before the link thread services its write queue, so it goes out as one write per link instead of a wakeup and a
+/// write for each sender. The timer only wakes up when something is due. Main thread only.
+class MAVLinkPeriodicSender : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(void)> SendFunction;
+
+    static MAVLinkPeriodicSender* instance(void);
+
+    /// Adds a periodic send. The first send happens on the next due tick, not right away.
+    ///     @param context      The send is removed automatically when this object is destroyed
+    ///     @param phaseMSecs   Offset of the send within the interval, spreads sends which should not coincide
+    /// @return Id for use with remove and setInterval
+    int     add         (QObject* context, int intervalMSecs, SendFunction send, int phaseMSecs = 0);
+    void    remove      (int id);
+    void    setInterval (int id, int intervalMSecs);
+
+    static const int tickMSecs = 10;
+
+private:
+    MAVLinkPeriodicSender(QObject* parent);
+
+    typedef struct {
+        int                 id;
+        QPointer<QObject>   context;
+        qint64              intervalTicks;
+        qint64              phaseTicks;
+        qint64              nextTick;
+        SendFunction        send;
+    } Entry_t;
+
+    void    _tick           (void);
+    void    _schedule       (Entry_t& entry, qint64 afterTick);
+    void    _startTimer     (void);
+    int     _indexOf        (int id) const;
+    qint64  _nowTick        (void) const { return _clock.elapsed() / tickMSecs; }
+
+    QVector<Entry_t>    _entries;
+    QTimer              _timer;
+    QElapsedTimer       _clock;                 ///< Common epoch of all send schedules
+    int                 _nextId         = 1;
+};
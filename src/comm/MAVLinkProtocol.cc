@@ -21,6 +21,7 @@
 #include <QFileInfo>
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkFrameScanner.h"
 #include "UASInterface.h"
 #include "UASInterface.h"
 #include "UAS.h"
@@ -31,6 +32,7 @@
 #include "QGCLoggingCategory.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
+#include "QGCTrace.h"
 
 Q_DECLARE_METATYPE(mavlink_message_t)
 
@@ -39,6 +41,9 @@ QGC_LOGGING_CATEGORY(MAVLinkProtocolLog, "MAVLinkProtocolLog")
 const char* MAVLinkProtocol::_tempLogFileTemplate   = "FlightDataXXXXXX";   ///< Template for temporary log file
 const char* MAVLinkProtocol::_logFileExtension      = "mavlink";            ///< Extension for log files
 
+constexpr int MAVLinkProtocol::anyId;
+constexpr int MAVLinkProtocol::_flatMsgIdCount;
+
 /**
  * The default constructor will create a new MAVLink object sending heartbeats at
  * the MAVLINK_HEARTBEAT_DEFAULT_RATE to all connected links.
@@ -46,8 +51,6 @@ const char* MAVLinkProtocol::_logFileExtension      = "mavlink";            ///<
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , m_enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
@@ -59,12 +62,8 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
 {
-    memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
-    memset(totalLossCounter,    0, sizeof(totalLossCounter));
-    memset(runningLossPercent,  0, sizeof(runningLossPercent));
-    memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
+
+    _msgIdSubscriptions.resize(_flatMsgIdCount);
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
@@ -109,12 +108,118 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(this, &MAVLinkProtocol::saveTelemetryLog,        _app, &QGCApplication::saveTelemetryLogOnMainThread);
    connect(this, &MAVLinkProtocol::checkTelemetrySavePath,  _app, &QGCApplication::checkTelemetrySavePathOnMainThread);
 
+   connect(&_logWriter, &MAVLinkLogWriter::writeError, this, &MAVLinkProtocol::_logWriteError);
+
+   // Forwarding settings are cached instead of being queried for each message
+   AppSettings* appSettings = _app->toolbox()->settingsManager()->appSettings();
+   _forwarder.setEnabled(appSettings->forwardMavlink()->rawValue().toBool());
+   connect(appSettings->forwardMavlink(), &Fact::rawValueChanged, this, [this](QVariant value) { _forwarder.setEnabled(value.toBool()); });
+   connect(appSettings->forwardMavlinkAllowedMsgIds(),  &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateForwardingFilter);
+   connect(appSettings->forwardMavlinkDeniedMsgIds(),   &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateForwardingFilter);
+   connect(appSettings->forwardMavlinkMaxRate(),        &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateForwardingFilter);
+
+   _metricsTimer.setInterval(1000);
+   connect(&_metricsTimer, &QTimer::timeout, this, &MAVLinkProtocol::_updateMetrics);
+   _metricsElapsed.start();
+   _metricsTimer.start();
+
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
    emit versionCheckChanged(m_enable_version_check);
 }
 
+MAVLinkForwarder::Filter MAVLinkProtocol::forwardingFilter(void)
+{
+    AppSettings*                appSettings = _app->toolbox()->settingsManager()->appSettings();
+    MAVLinkForwarder::Filter    filter;
+
+    filter.allowedMsgIds    = MAVLinkForwarder::parseMsgIdList(appSettings->forwardMavlinkAllowedMsgIds()->rawValue().toString());
+    filter.deniedMsgIds     = MAVLinkForwarder::parseMsgIdList(appSettings->forwardMavlinkDeniedMsgIds()->rawValue().toString());
+    filter.maxRateHz        = appSettings->forwardMavlinkMaxRate()->rawValue().toDouble();
+
+    return filter;
+}
+
+void MAVLinkProtocol::_updateForwardingFilter(void)
+{
+    _forwarder.setFilter(forwardingFilter());
+}
+
+MAVLinkMetrics* MAVLinkProtocol::vehicleMetrics(int sysid)
+{
+    MAVLinkMetrics* metrics = _vehicleMetrics.value(sysid, nullptr);
+    if (!metrics) {
+        metrics = new MAVLinkMetrics(this);
+        _vehicleMetrics[sysid] = metrics;
+    }
+    return metrics;
+}
+
+void MAVLinkProtocol::_updateMetrics(void)
+{
+    qint64 elapsedMSecs = _metricsElapsed.restart();
+
+    for (const SharedLinkInterfacePtr& link: _linkMgr->links()) {
+        link->metrics()->update(elapsedMSecs);
+    }
+    for (MAVLinkMetrics* metrics: _vehicleMetrics) {
+        metrics->update(elapsedMSecs);
+    }
+}
+
+QString MAVLinkProtocol::metricsCsv(void)
+{
+    QString     csv;
+    QTextStream stream(&csv);
+
+    MAVLinkMetrics::writeCsvHeader(stream);
+    for (const SharedLinkInterfacePtr& link: _linkMgr->links()) {
+        link->metrics()->writeCsv(stream, QStringLiteral("link"), link->linkConfiguration()->name());
+    }
+    for (auto iter = _vehicleMetrics.constBegin(); iter != _vehicleMetrics.constEnd(); iter++) {
+        iter.value()->writeCsv(stream, QStringLiteral("vehicle"), QString::number(iter.key()));
+    }
+    stream.flush();
+
+    return csv;
+}
+
+QString MAVLinkProtocol::metricsPrometheus(void)
+{
+    QString                                 text;
+    QTextStream                             stream(&text);
+    QList<MAVLinkMetrics::LabeledMetrics_t> metricsList;
+
+    for (const SharedLinkInterfacePtr& link: _linkMgr->links()) {
+        QString name = link->linkConfiguration()->name();
+        name.replace("\\", "\\\\").replace("\"", "\\\"");
+        metricsList.append(MAVLinkMetrics::LabeledMetrics_t(QStringLiteral("link=\"%1\"").arg(name), link->metrics()));
+    }
+    for (auto iter = _vehicleMetrics.constBegin(); iter != _vehicleMetrics.constEnd(); iter++) {
+        metricsList.append(MAVLinkMetrics::LabeledMetrics_t(QStringLiteral("sysid=\"%1\"").arg(iter.key()), iter.value()));
+    }
+    MAVLinkMetrics::writePrometheus(stream, metricsList);
+    stream.flush();
+
+    return text;
+}
+
+bool MAVLinkProtocol::exportMetrics(const QString& filename)
+{
+    QFile file(filename);
+
+    if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
+        qCWarning(MAVLinkProtocolLog) << "Unable to export metrics" << filename << file.errorString();
+        return false;
+    }
+
+    bool prometheus = QFileInfo(filename).suffix() == QStringLiteral("prom");
+    file.write((prometheus ? metricsPrometheus() : metricsCsv()).toUtf8());
+
+    return true;
+}
+
 void MAVLinkProtocol::loadSettings()
 {
     // Load defaults from settings
@@ -142,13 +247,7 @@ void MAVLinkProtocol::storeSettings()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
-    for(int i = 0; i < 256; i++) {
-        firstMessage[channel][i] =  1;
-    }
+    link->sequenceState().reset();
     link->setDecodedFirstMavlinkPacket(false);
 }
 
@@ -160,28 +259,82 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 
 void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
-    uint8_t bytes_time[sizeof(quint64)];
-
     Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.writing()) {
         quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+        _writeLogRecord(time, reinterpret_cast<const uint8_t*>(b.constData()), b.size());
+    }
 
-        qToBigEndian(time,bytes_time);
+}
 
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
+void MAVLinkProtocol::logRadioStatus(int rssiDbm, int remoteRssiDbm)
+{
+    if (_logSuspendError || _logSuspendReplay || !_logWriter.writing()) {
+        return;
+    }
 
-        int len = b.count();
+    // Same scale as SiK radios (dBm = rssi / 1.9 - 127) so log viewers show them alike
+    auto toRssi = [](int dBm) -> uint8_t {
+        return dBm == 0 ? UINT8_MAX : static_cast<uint8_t>(qBound(0.0, (dBm + 127) * 1.9, 254.0));
+    };
+    mavlink_radio_status_t radioStatus;
+    memset(&radioStatus, 0, sizeof(radioStatus));
+    radioStatus.rssi        = toRssi(rssiDbm);
+    radioStatus.remrssi     = toRssi(remoteRssiDbm);
+    radioStatus.txbuf       = 100;
+    radioStatus.noise       = UINT8_MAX;
+    radioStatus.remnoise    = UINT8_MAX;
+
+    // Packed against our own status so the sequence numbers of the real links are not disturbed
+    mavlink_message_t message;
+    memcpy(_MAV_PAYLOAD_NON_CONST(&message), &radioStatus, MAVLINK_MSG_ID_RADIO_STATUS_LEN);
+    message.msgid = MAVLINK_MSG_ID_RADIO_STATUS;
+    mavlink_finalize_message_buffer(&message, getSystemId(), MAV_COMP_ID_TELEMETRY_RADIO, &_radioStatusLogStatus,
+                                    MAVLINK_MSG_ID_RADIO_STATUS_MIN_LEN, MAVLINK_MSG_ID_RADIO_STATUS_LEN, MAVLINK_MSG_ID_RADIO_STATUS_CRC);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     length = mavlink_msg_to_send_buffer(buffer, &message);
+    _writeLogRecord(static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000), buffer, length);
+}
 
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+void MAVLinkProtocol::logNamedValueInt(const QString& name, int32_t value)
+{
+    if (_logSuspendError || _logSuspendReplay || !_logWriter.writing()) {
+        return;
     }
 
+    mavlink_named_value_int_t namedValue;
+    memset(&namedValue, 0, sizeof(namedValue));
+    namedValue.time_boot_ms = static_cast<uint32_t>(qgcApp()->msecsSinceBoot());
+    namedValue.value        = value;
+    const QByteArray nameBytes = name.toLatin1().left(static_cast<int>(sizeof(namedValue.name)));
+    memcpy(namedValue.name, nameBytes.constData(), static_cast<size_t>(nameBytes.size()));
+
+    mavlink_message_t message;
+    memcpy(_MAV_PAYLOAD_NON_CONST(&message), &namedValue, MAVLINK_MSG_ID_NAMED_VALUE_INT_LEN);
+    message.msgid = MAVLINK_MSG_ID_NAMED_VALUE_INT;
+    mavlink_finalize_message_buffer(&message, getSystemId(), getComponentId(), &_namedValueLogStatus,
+                                    MAVLINK_MSG_ID_NAMED_VALUE_INT_MIN_LEN, MAVLINK_MSG_ID_NAMED_VALUE_INT_LEN, MAVLINK_MSG_ID_NAMED_VALUE_INT_CRC);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     length = mavlink_msg_to_send_buffer(buffer, &message);
+    _writeLogRecord(static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000), buffer, length);
+}
+
+void MAVLinkProtocol::_writeLogRecord(quint64 timestampUSecs, const uint8_t* frame, int length)
+{
+    if (!_logWriter.writeRecord(timestampUSecs, frame, length) && !_logDropReported) {
+        // Only report once per log, the writer keeps count of the total
+        _logDropReported = true;
+        emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging is not able to keep up with incoming data. Some messages will be missing from %1.").arg(_tempLogFile.fileName()));
+    }
+}
+
+void MAVLinkProtocol::_logWriteError(const QString& errorString)
+{
+    // If there's an error logging data, raise an alert and stop logging.
+    qCWarning(MAVLinkProtocolLog) << "Log write error" << errorString;
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _stopLogging();
+    _logSuspendError = true;
 }
 
 /**
@@ -194,6 +347,8 @@ void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
+    QGC_TRACE_SCOPE("MAVLinkProtocol::receiveBytes");
+
     // Since receiveBytes signals cross threads we can end up with signals in the queue
     // that come through after the link is disconnected. For these we just drop the data
     // since the link is closed.
@@ -203,174 +358,276 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
         return;
     }
 
-    uint8_t mavlinkChannel = link->mavlinkChannel();
+    // Decode all complete frames in the buffer in one pass, then process them in order. The message list is local
+    // since handlers of messageReceived can write to a link which in turn can call back into receiveBytes.
+    qint64  receiveTimestampUSecs   = 0;
+    int     queueDepth              = 0;
+    if (link->takeReceiveTimestamp(receiveTimestampUSecs, queueDepth, false /* allPending */)) {
+        link->metrics()->recordQueueDepth(queueDepth);
+    }
 
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+    QVector<mavlink_message_t> messages;
+    QVector<MAVLinkFrameScanner::FrameSpan_t> frames;
+    QVector<MAVLinkFrameScanner::FrameSpan_t>* framesPtr = _forwarder.enabled() ? &frames : nullptr;   // Frame spans are only needed for forwarding
+    int parseErrors = 0;
+    MAVLinkFrameScanner::parse(link->mavlinkChannel(), reinterpret_cast<const uint8_t*>(b.constData()), b.size(), messages, framesPtr, &parseErrors);
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+    link->metrics()->recordBytes(b.size());
+    link->metrics()->recordParseErrors(parseErrors);
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+    _processMessages(linkPtr, messages, receiveTimestampUSecs, &b, framesPtr);
+}
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
+/**
+ * Processes the messages which were already decoded on the link thread.
+ * @param link The interface the messages arrived on
+ * @see LinkInterface::enableLinkThreadDecoding
+ **/
 
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+void MAVLinkProtocol::receiveMessages(LinkInterface* link)
+{
+    // Same as receiveBytes: the notification may arrive after the link is gone
+    SharedLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
+    if (!linkPtr) {
+        qCDebug(MAVLinkProtocolLog) << "receiveMessages: link gone!";
+        return;
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+    // All buffers decoded so far are delivered together, latency is measured from the oldest one
+    qint64  receiveTimestampUSecs   = 0;
+    int     queueDepth              = 0;
+    if (link->takeReceiveTimestamp(receiveTimestampUSecs, queueDepth, true /* allPending */)) {
+        link->metrics()->recordQueueDepth(queueDepth);
+    }
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
+    int parseErrors = 0;
+    QVector<mavlink_message_t> messages = link->takeReceivedMessages(&parseErrors);
+    link->metrics()->recordParseErrors(parseErrors);
+    if (link->signingEnabled()) {
+        // Rejected messages are dropped on the link thread, so only the link has counts for them
+        MAVLinkSigning::Counts_t signingCounts = link->takeSigningCounts();
+        link->metrics()->recordSigning(signingCounts.verified, signingCounts.badSignature, signingCounts.replayed, signingCounts.unsignedRejected);
+    }
+
+    _processMessages(linkPtr, messages, receiveTimestampUSecs);
+    link->recycleReceivedMessages(messages);
+}
+
+void MAVLinkProtocol::_processMessages(const SharedLinkInterfacePtr& linkPtr, const QVector<mavlink_message_t>& messages, qint64 receiveTimestampUSecs, const QByteArray* bytes, const QVector<MAVLinkFrameScanner::FrameSpan_t>* frames)
+{
+    LinkInterface*  link            = linkPtr.get();
+    uint8_t         mavlinkChannel  = link->mavlinkChannel();
+    MAVLinkMetrics* linkMetrics     = link->metrics();
+
+    for (int messageIndex=0; messageIndex<messages.count(); messageIndex++) {
+        const mavlink_message_t& message = messages[messageIndex];
+        MAVLinkMetrics* messageVehicleMetrics = vehicleMetrics(message.sysid);
+
+        linkMetrics->recordMessage(message.msgid);
+        messageVehicleMetrics->recordMessage(message.msgid);
+        int frameBytes = message.len + (message.magic == MAVLINK_STX_MAVLINK1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES) + MAVLINK_NUM_CHECKSUM_BYTES;
+        messageVehicleMetrics->recordBytes(frameBytes);
+        if (!bytes) {
+            // Raw buffer not available with link thread decoding
+            linkMetrics->recordBytes(frameBytes);
+        }
 
-            // Detect if we are talking to an old radio not supporting v2
+        // Got a valid message
+        if (!link->decodedFirstMavlinkPacket()) {
+            link->setDecodedFirstMavlinkPacket(true);
             mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
+            if (message.magic != MAVLINK_STX_MAVLINK1 && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+                mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+                // Set all links to v2
+                setVersion(200);
             }
+        }
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        //-----------------------------------------------------------------
+        // MAVLink Status
+        MAVLinkSequenceState& sequenceState = link->sequenceState();
+        sequenceState.update(message.sysid, message.compid, message.seq);
+
+        //-----------------------------------------------------------------
+        // MAVLink forwarding
+        if (_forwarder.enabled()) {
+            const uint8_t*  frame       = nullptr;
+            int             frameLength = 0;
+            if (bytes && frames && (*frames)[messageIndex].offset >= 0) {
+                // Forward the original on-wire bytes
+                frame       = reinterpret_cast<const uint8_t*>(bytes->constData()) + (*frames)[messageIndex].offset;
+                frameLength = (*frames)[messageIndex].length;
             }
-#endif
+            _forwarder.forward(link, message, frame, frameLength);
+        }
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+        //-----------------------------------------------------------------
+        // Log data
+        if (!_logSuspendError && !_logSuspendReplay && _logWriter.writing()) {
+            uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+            // The uint64 time in microseconds is written in big endian format before the message.
+            // This timestamp is saved in UTC time. We are only saving in ms precision because
+            // getting more than this isn't possible with Qt without a ton of extra code.
+            quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+
+            // Queue the timestamp/message pair for the log writer thread
+            int len = mavlink_msg_to_send_buffer(buf, &message);
+            _writeLogRecord(time, buf, len);
+
+            // Check for the vehicle arming going by. This is used to trigger log save.
+            if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                mavlink_heartbeat_t state;
+                mavlink_msg_heartbeat_decode(&message, &state);
+                if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                    _vehicleWasArmed = true;
+                }
             }
+        }
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            _startLogging();
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+            _startLogging();
+            mavlink_high_latency_t highLatency;
+            mavlink_msg_high_latency_decode(&message, &highLatency);
+            // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+        } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+            _startLogging();
+            mavlink_high_latency2_t highLatency2;
+            mavlink_msg_high_latency2_decode(&message, &highLatency2);
+            emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+        }
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (1 == linkPtr.use_count()) {
-                break;
+#if 0
+        // Given the current state of SiK Radio firmwares there is no way to make the code below work.
+        // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
+        // packet even if the vehicle is sending Mavlink 2.
+
+        // Detect if we are talking to an old radio not supporting v2
+        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+        if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
+            if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
+            && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+                _radio_version_mismatch_count++;
             }
+        }
+
+        if (_radio_version_mismatch_count == 5) {
+            // Warn the user if the radio continues to send v1 while the link uses v2
+            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
+            // Set to flag warning already shown
+            _radio_version_mismatch_count = -1;
+            // Flick link back to v1
+            qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        }
+#endif
+
+        // Update MAVLink status on every 32th packet
+        if ((sequenceState.totalReceived() & 0x1F) == 0) {
+            emit mavlinkMessageStatus(message.sysid, sequenceState.totalReceived() + sequenceState.totalLost(), sequenceState.totalReceived(), sequenceState.totalLost(), sequenceState.runningLossPercent());
+        }
+
+        // Routed subscriptions first, then the broadcast signal for everyone else
+        _dispatchMessage(link, message);
+
+        // Direct connections get a reference to the decoded message, queued connections still take their own copy
+        emit messageReceived(link, message);
+
+        if (receiveTimestampUSecs) {
+            // Covers the queueing between threads as well as all the message handlers (Vehicle, FactGroups) above
+            qint64 latencyUSecs = MAVLinkMetrics::nowUSecs() - receiveTimestampUSecs;
+            linkMetrics->recordLatencyUSecs(latencyUSecs);
+            messageVehicleMetrics->recordLatencyUSecs(latencyUSecs);
+        }
+
+        // Anyone handling the message could close the connection, which deletes the link,
+        // so we check if it's expired
+        if (1 == linkPtr.use_count()) {
+            break;
+        }
+
+    }
+}
+
+int MAVLinkProtocol::subscribe(QObject* context, int sysid, int compid, int msgid, MessageHandler handler)
+{
+    Subscription_t subscription = { _nextSubscriptionId++, context, sysid, compid, handler };
+
+    if (msgid == anyId) {
+        _anyMsgIdSubscriptions[sysid].append(subscription);
+    } else if (msgid >= 0 && msgid < _flatMsgIdCount) {
+        _msgIdSubscriptions[msgid].append(subscription);
+    } else {
+        _highMsgIdSubscriptions[msgid].append(subscription);
+    }
+
+    int subscriptionId = subscription.id;
+    connect(context, &QObject::destroyed, this, [this, subscriptionId]() { unsubscribe(subscriptionId); });
+
+    return subscriptionId;
+}
+
+void MAVLinkProtocol::unsubscribe(int subscriptionId)
+{
+    for (SubscriptionList_t& subscriptions: _msgIdSubscriptions) {
+        if (_removeSubscription(subscriptions, subscriptionId)) {
+            return;
+        }
+    }
+    for (SubscriptionList_t& subscriptions: _highMsgIdSubscriptions) {
+        if (_removeSubscription(subscriptions, subscriptionId)) {
+            return;
+        }
+    }
+    for (SubscriptionList_t& subscriptions: _anyMsgIdSubscriptions) {
+        if (_removeSubscription(subscriptions, subscriptionId)) {
+            return;
+        }
+    }
+}
+
+bool MAVLinkProtocol::_removeSubscription(SubscriptionList_t& subscriptions, int subscriptionId)
+{
+    for (int i=0; i<subscriptions.count(); i++) {
+        if (subscriptions[i].id == subscriptionId) {
+            subscriptions.removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+void MAVLinkProtocol::_dispatchMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    // The lists are copied (which is cheap due to implicit sharing) since handlers are allowed to subscribe/unsubscribe
+    int msgid = static_cast<int>(message.msgid);
+    if (msgid < _flatMsgIdCount) {
+        if (!_msgIdSubscriptions[msgid].isEmpty()) {
+            _dispatchSubscriptions(SubscriptionList_t(_msgIdSubscriptions[msgid]), link, message);
+        }
+    } else if (!_highMsgIdSubscriptions.isEmpty()) {
+        _dispatchSubscriptions(_highMsgIdSubscriptions.value(msgid), link, message);
+    }
+    if (!_anyMsgIdSubscriptions.isEmpty()) {
+        _dispatchSubscriptions(_anyMsgIdSubscriptions.value(message.sysid), link, message);
+        _dispatchSubscriptions(_anyMsgIdSubscriptions.value(anyId), link, message);
+    }
+}
+
+void MAVLinkProtocol::_dispatchSubscriptions(const SubscriptionList_t& subscriptions, LinkInterface* link, const mavlink_message_t& message)
+{
+    for (const Subscription_t& subscription: subscriptions) {
+        if ((subscription.sysid == anyId || subscription.sysid == message.sysid) &&
+                (subscription.compid == anyId || subscription.compid == message.compid) &&
+                subscription.context) {
+            subscription.handler(link, message);
         }
     }
 }
@@ -420,6 +677,8 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
+        // Writer must be done with the file before we can look at it
+        _logWriter.stopWriting();
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
             _tempLogFile.remove();
@@ -464,6 +723,9 @@ void MAVLinkProtocol::_startLogging(void)
             qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile.fileName();
             emit checkTelemetrySavePath();
 
+            _logDropReported = false;
+            _logWriter.startWriting(&_tempLogFile);
+
             _logSuspendError = false;
         }
     }
@@ -16,9 +16,19 @@
 #include <QFile>
 #include <QMap>
 #include <QByteArray>
+#include <QVector>
 #include <QLoggingCategory>
+#include <QPointer>
+#include <QHash>
+#include <QElapsedTimer>
+
+#include <functional>
 
 #include "LinkInterface.h"
+#include "MAVLinkForwarder.h"
+#include "MAVLinkFrameScanner.h"
+#include "MAVLinkLogWriter.h"
+#include "MAVLinkMetrics.h"
 #include "QGCMAVLink.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
@@ -77,13 +87,56 @@ public:
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
+    typedef std::function<void(LinkInterface* link, const mavlink_message_t& message)> MessageHandler;
+
+    static constexpr int anyId = -1;    ///< Wildcard for subscribe
+
+    /// Subscribes to incoming messages matching the specified ids. This is a cheaper alternative to messageReceived
+    /// since only matching subscriptions are called, instead of every listener filtering every message.
+    ///     @param context  The subscription is removed automatically when this object is destroyed
+    ///     @param sysid    System id to match, anyId for all
+    ///     @param compid   Component id to match, anyId for all
+    ///     @param msgid    Message id to match, anyId for all
+    ///     @param handler  Called on the main thread for each matching message
+    /// @return Subscription id for use with unsubscribe
+    int subscribe(QObject* context, int sysid, int compid, int msgid, MessageHandler handler);
+
+    /// Removes a subscription returned by subscribe
+    void unsubscribe(int subscriptionId);
+
+    MAVLinkForwarder* forwarder(void) { return &_forwarder; }
+
+    /// @return Forwarding filter as specified by the application settings
+    MAVLinkForwarder::Filter forwardingFilter(void);
+
+    /// @return Receive metrics for all traffic from the specified system id
+    MAVLinkMetrics* vehicleMetrics(int sysid);
+
+    /// @return Link and vehicle metrics as CSV, one row per link/vehicle
+    QString metricsCsv(void);
+
+    /// @return Link and vehicle metrics in Prometheus text exposition format
+    QString metricsPrometheus(void);
+
+    /// Saves the metrics to a file. Files with a .prom extension are saved in Prometheus format, everything else as CSV.
+    Q_INVOKABLE bool exportMetrics(const QString& filename);
+
 public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
 
+    /** @brief Receive messages already decoded on the thread of a communication interface */
+    void receiveMessages(LinkInterface* link);
+
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
 
+    /** @brief Log RADIO_STATUS for radios which don't report it over MAVLink themselves (Microhard, Taisync). RSSI in dBm, 0 if unknown. */
+    void logRadioStatus(int rssiDbm, int remoteRssiDbm);
+
+    /** @brief Log NAMED_VALUE_INT from this application, for values of our own such as memory use. Names longer than 10 characters are cut. */
+    void logNamedValueInt(const QString& name, int32_t value);
+
     /** @brief Set the system id of this application */
     void setSystemId(int id);
 
@@ -103,14 +156,7 @@ public slots:
 
 protected:
     bool        m_enable_version_check;                         ///< Enable checking of version match of MAV and QGC
-    uint8_t     lastIndex[256][256];                            ///< Store the last received sequence ID for each system/componenet pair
-    uint8_t     firstMessage[256][256];                         ///< First message flag
-    uint64_t    totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];  ///< The total number of successfully received messages
-    uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
-    float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
 
-    mavlink_message_t _message;
-    mavlink_status_t _status;
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -121,8 +167,8 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
-    void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /** @brief Message received, direct connections get a reference to the decoded message */
+    void messageReceived(LinkInterface* link, const mavlink_message_t& message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -154,8 +200,26 @@ signals:
 
 private slots:
     void _vehicleCountChanged(void);
+    void _logWriteError(const QString& errorString);
+    void _updateForwardingFilter(void);
+    void _updateMetrics(void);
 
 private:
+    typedef struct {
+        int                 id;
+        QPointer<QObject>   context;
+        int                 sysid;
+        int                 compid;
+        MessageHandler      handler;
+    } Subscription_t;
+
+    typedef QVector<Subscription_t> SubscriptionList_t;
+
+    void _dispatchMessage           (LinkInterface* link, const mavlink_message_t& message);
+    void _dispatchSubscriptions     (const SubscriptionList_t& subscriptions, LinkInterface* link, const mavlink_message_t& message);
+    bool _removeSubscription        (SubscriptionList_t& subscriptions, int subscriptionId);
+    void _processMessages(const SharedLinkInterfacePtr& linkPtr, const QVector<mavlink_message_t>& messages, qint64 receiveTimestampUSecs, const QByteArray* bytes = nullptr, const QVector<MAVLinkFrameScanner::FrameSpan_t>* frames = nullptr);
+    void _writeLogRecord(quint64 timestampUSecs, const uint8_t* frame, int length);
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
@@ -163,12 +227,28 @@ private:
     bool _logSuspendError;      ///< true: Logging suspended due to error
     bool _logSuspendReplay;     ///< true: Logging suspended due to replay
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
+    bool _logDropReported = false;  ///< true: User has been told about dropped log records for the current log
+    mavlink_status_t _radioStatusLogStatus = {};    ///< Sequence numbers for logged RADIO_STATUS
+    mavlink_status_t _namedValueLogStatus = {};     ///< Sequence numbers for logged NAMED_VALUE_INT
 
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
+    MAVLinkLogWriter    _logWriter;              ///< Writes to _tempLogFile on its own thread
+    MAVLinkForwarder    _forwarder;
+    QTimer              _metricsTimer;
+    QElapsedTimer       _metricsElapsed;
+    QMap<int, MAVLinkMetrics*> _vehicleMetrics;  ///< Key: sysid
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
 
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
+
+    // Subscription table. Messages ids below _flatMsgIdCount index directly into _msgIdSubscriptions, the sparse high
+    // message id range goes through a hash. Wildcard message id subscriptions are keyed by system id (or anyId).
+    static constexpr int                _flatMsgIdCount         = 512;
+    int                                 _nextSubscriptionId     = 1;
+    QVector<SubscriptionList_t>         _msgIdSubscriptions;
+    QHash<int, SubscriptionList_t>      _highMsgIdSubscriptions;
+    QHash<int, SubscriptionList_t>      _anyMsgIdSubscriptions;
 };
 
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkSequenceState.h"
+
+MAVLinkSequenceState::MAVLinkSequenceState(void)
+{
+    reset();
+}
+
+void MAVLinkSequenceState::reset(void)
+{
+    _slots.assign(_initialSlotCount, Slot_t{ 0, 0, 0 });
+    _usedSlots          = 0;
+    _totalReceived      = 0;
+    _totalLost          = 0;
+    _runningLossPercent = 0;
+}
+
+/// Linear probing, the table is never more than half full so there is always a free slot to stop on
+MAVLinkSequenceState::Slot_t* MAVLinkSequenceState::_findSlot(uint16_t key)
+{
+    size_t mask     = _slots.size() - 1;
+    size_t index    = (key * 40503u) & mask;   // Fibonacci style scramble, sysid/compid values cluster heavily
+
+    while (_slots[index].used && _slots[index].key != key) {
+        index = (index + 1) & mask;
+    }
+
+    return &_slots[index];
+}
+
+void MAVLinkSequenceState::_grow(void)
+{
+    std::vector<Slot_t> oldSlots;
+    oldSlots.swap(_slots);
+    _slots.assign(oldSlots.size() * 2, Slot_t{ 0, 0, 0 });
+
+    for (const Slot_t& slot: oldSlots) {
+        if (slot.used) {
+            *_findSlot(slot.key) = slot;
+        }
+    }
+}
+
+int MAVLinkSequenceState::update(uint8_t sysid, uint8_t compid, uint8_t seq)
+{
+    uint16_t    key             = static_cast<uint16_t>((sysid << 8) | compid);
+    Slot_t*     slot            = _findSlot(key);
+    int         lostMessages    = 0;
+
+    _totalReceived++;
+
+    if (slot->used) {
+        uint8_t expectedSeq = slot->seq + 1;
+        if (seq != expectedSeq) {
+            //-- Account for overflow during packet loss
+            if (seq < expectedSeq) {
+                lostMessages = (seq + 255) - expectedSeq;
+            } else {
+                lostMessages = seq - expectedSeq;
+            }
+            _totalLost += static_cast<uint64_t>(lostMessages);
+        }
+        slot->seq = seq;
+    } else {
+        // Never seen a message for this system/component pair, nothing to compare against
+        if ((_usedSlots + 1) * 2 > static_cast<int>(_slots.size())) {
+            _grow();
+            slot = _findSlot(key);
+        }
+        *slot = Slot_t{ key, seq, 1 };
+        _usedSlots++;
+    }
+
+    // Calculate new loss ratio
+    uint64_t totalSent = _totalReceived + _totalLost;
+    float receiveLossPercent = static_cast<float>(static_cast<double>(_totalLost) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    _runningLossPercent = (receiveLossPercent * 0.5f) + (_runningLossPercent * 0.5f);
+
+    return lostMessages;
+}
@@ -0,0 +1,53 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// Receive sequence tracking for a single link.
+///
+/// The last sequence number for each sysid/compid pair seen on the link is kept in a small open addressed hash table
+/// which is sized to the number of components actually talking on the link, instead of a 256x256 table shared by all
+/// links. Must only be used from a single thread.
+class MAVLinkSequenceState
+{
+public:
+    MAVLinkSequenceState(void);
+
+    /// Records the sequence number of a received message
+    /// @return Number of messages lost from this sysid/compid since the previous message
+    int update(uint8_t sysid, uint8_t compid, uint8_t seq);
+
+    /// Forgets all sequence state and counters
+    void reset(void);
+
+    uint64_t    totalReceived       (void) const { return _totalReceived; }
+    uint64_t    totalLost           (void) const { return _totalLost; }
+    float       runningLossPercent  (void) const { return _runningLossPercent; }
+
+private:
+    typedef struct {
+        uint16_t    key;    ///< sysid << 8 | compid
+        uint8_t     seq;
+        uint8_t     used;
+    } Slot_t;
+
+    Slot_t* _findSlot   (uint16_t key);
+    void    _grow       (void);
+
+    std::vector<Slot_t> _slots;
+    int                 _usedSlots          = 0;
+    uint64_t            _totalReceived      = 0;
+    uint64_t            _totalLost          = 0;
+    float               _runningLossPercent = 0;
+
+    static const int    _initialSlotCount   = 16;   ///< Must be a power of 2
+};
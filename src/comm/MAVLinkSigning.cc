@@ -0,0 +1,495 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkSigning.h"
+#include "QGCLoggingCategory.h"
+
+#include <QDateTime>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define QGC_SIGNING_SHA_NI
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define QGC_SIGNING_SHA_NI_TARGET
+#else
+#include <cpuid.h>
+// Compiled for SHA-NI regardless of the target flags, only called once the CPU is known to support it
+#define QGC_SIGNING_SHA_NI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define QGC_SIGNING_ARMV8
+#include <arm_neon.h>
+#endif
+
+QGC_LOGGING_CATEGORY(MAVLinkSigningLog, "MAVLinkSigningLog")
+
+static const uint32_t _sha256InitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static const uint32_t _sha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t _sha256Rotr(uint32_t value, int bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static void _sha256CompressPortable(uint32_t state[8], const uint8_t* blocks, int blockCount)
+{
+    for (int block=0; block<blockCount; block++, blocks += 64) {
+        uint32_t w[64];
+        for (int i=0; i<16; i++) {
+            w[i] = (static_cast<uint32_t>(blocks[i * 4]) << 24) | (static_cast<uint32_t>(blocks[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(blocks[i * 4 + 2]) << 8) | static_cast<uint32_t>(blocks[i * 4 + 3]);
+        }
+        for (int i=16; i<64; i++) {
+            uint32_t s0 = _sha256Rotr(w[i - 15], 7) ^ _sha256Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = _sha256Rotr(w[i - 2], 17) ^ _sha256Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0];
+        uint32_t b = state[1];
+        uint32_t c = state[2];
+        uint32_t d = state[3];
+        uint32_t e = state[4];
+        uint32_t f = state[5];
+        uint32_t g = state[6];
+        uint32_t h = state[7];
+        for (int i=0; i<64; i++) {
+            uint32_t t1 = h + (_sha256Rotr(e, 6) ^ _sha256Rotr(e, 11) ^ _sha256Rotr(e, 25)) + ((e & f) ^ (~e & g)) + _sha256K[i] + w[i];
+            uint32_t t2 = (_sha256Rotr(a, 2) ^ _sha256Rotr(a, 13) ^ _sha256Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(QGC_SIGNING_SHA_NI)
+static bool _cpuHasShaNi(void)
+{
+    // SHA is cpuid leaf 7 ebx bit 29, SSSE3 and SSE4.1 are leaf 1 ecx bits 9 and 19
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    const bool sha = info[1] & (1 << 29);
+    __cpuid(info, 1);
+    const bool sse = (info[2] & (1 << 9)) && (info[2] & (1 << 19));
+#else
+    if (__get_cpuid_max(0, nullptr) < 7) {
+        return false;
+    }
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    const bool sha = ebx & (1u << 29);
+    __cpuid(1, eax, ebx, ecx, edx);
+    const bool sse = (ecx & (1u << 9)) && (ecx & (1u << 19));
+#endif
+    return sha && sse;
+}
+
+QGC_SIGNING_SHA_NI_TARGET
+static void _sha256CompressShaNi(uint32_t state[8], const uint8_t* blocks, int blockCount)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The round instructions keep the state as ABEF and CDGH
+    __m128i tmp     = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);   // CDAB
+    __m128i state1  = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);   // EFGH
+    __m128i state0  = _mm_alignr_epi8(tmp, state1, 8);                                                          // ABEF
+    state1          = _mm_blend_epi16(state1, tmp, 0xF0);                                                       // CDGH
+
+    for (int block=0; block<blockCount; block++, blocks += 64) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+
+        __m128i msg[4];
+        for (int i=0; i<4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&blocks[i * 16])), byteSwap);
+        }
+
+        // Four rounds per group. The message schedule for group n + 4 is built from the four words in flight.
+        for (int group=0; group<16; group++) {
+            const __m128i current = msg[group & 3];
+
+            __m128i roundInput = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_sha256K[group * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, roundInput);
+            if (group >= 3 && group <= 14) {
+                __m128i& next = msg[(group + 1) & 3];
+                next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(current, msg[(group + 3) & 3], 4)), current);
+            }
+            roundInput = _mm_shuffle_epi32(roundInput, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, roundInput);
+            if (group >= 1 && group <= 12) {
+                msg[(group + 3) & 3] = _mm_sha256msg1_epu32(msg[(group + 3) & 3], current);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp     = _mm_shuffle_epi32(state0, 0x1B);      // FEBA
+    state1  = _mm_shuffle_epi32(state1, 0xB1);      // DCHG
+    state0  = _mm_blend_epi16(tmp, state1, 0xF0);   // DCBA
+    state1  = _mm_alignr_epi8(state1, tmp, 8);      // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+#endif
+
+#if defined(QGC_SIGNING_ARMV8)
+static void _sha256CompressArmv8(uint32_t state[8], const uint8_t* blocks, int blockCount)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (int block=0; block<blockCount; block++, blocks += 64) {
+        const uint32x4_t abcdSave = state0;
+        const uint32x4_t efghSave = state1;
+
+        uint32x4_t msg[4];
+        for (int i=0; i<4; i++) {
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&blocks[i * 16])));
+        }
+
+        // Four rounds per group, each group's words are replaced by the ones needed four groups later
+        for (int group=0; group<16; group++) {
+            const uint32x4_t roundInput = vaddq_u32(msg[group & 3], vld1q_u32(&_sha256K[group * 4]));
+            if (group < 12) {
+                msg[group & 3] = vsha256su1q_u32(vsha256su0q_u32(msg[group & 3], msg[(group + 1) & 3]), msg[(group + 2) & 3], msg[(group + 3) & 3]);
+            }
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, roundInput);
+            state1 = vsha256h2q_u32(state1, abcd, roundInput);
+        }
+
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+/// Appends the SHA-256 padding to the message tail in buffer, which must have room for another block
+///     @param tailLength   Bytes of the message in buffer
+///     @param totalLength  Length of the whole message
+/// @return Number of blocks in buffer
+static int _sha256Pad(uint8_t* buffer, int tailLength, quint64 totalLength)
+{
+    const int blockCount = (tailLength + 1 + 8 + 63) / 64;
+    memset(&buffer[tailLength], 0, static_cast<size_t>((blockCount * 64) - tailLength));
+    buffer[tailLength] = 0x80;
+
+    const quint64 bits = totalLength * 8;
+    for (int i=0; i<8; i++) {
+        buffer[(blockCount * 64) - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    return blockCount;
+}
+
+static void _sha256Output(const uint32_t state[8], uint8_t* hash, int hashLength)
+{
+    for (int i=0; i<hashLength; i++) {
+        hash[i] = static_cast<uint8_t>(state[i / 4] >> (24 - (8 * (i % 4))));
+    }
+}
+
+MAVLinkSigning::MAVLinkSigning(void)
+{
+
+}
+
+MAVLinkSigning::CompressFunction MAVLinkSigning::_compressFunction(void)
+{
+    static const CompressFunction compress = []() -> CompressFunction {
+#if defined(QGC_SIGNING_ARMV8)
+        return _sha256CompressArmv8;
+#else
+#if defined(QGC_SIGNING_SHA_NI)
+        if (_cpuHasShaNi()) {
+            return _sha256CompressShaNi;
+        }
+#endif
+        return _sha256CompressPortable;
+#endif
+    }();
+
+    return compress;
+}
+
+const char* MAVLinkSigning::sha256Implementation(void)
+{
+    CompressFunction compress = _compressFunction();
+#if defined(QGC_SIGNING_SHA_NI)
+    if (compress == _sha256CompressShaNi) {
+        return "sha-ni";
+    }
+#endif
+#if defined(QGC_SIGNING_ARMV8)
+    if (compress == _sha256CompressArmv8) {
+        return "armv8";
+    }
+#endif
+    Q_UNUSED(compress);
+    return "portable";
+}
+
+void MAVLinkSigning::sha256(const uint8_t* data, int length, uint8_t hash[32])
+{
+    CompressFunction    compress    = _compressFunction();
+    uint32_t            state[8];
+    const int           fullBlocks  = length / 64;
+    const int           tailLength  = length - (fullBlocks * 64);
+    uint8_t             tail[128];
+
+    memcpy(state, _sha256InitialState, sizeof(state));
+    compress(state, data, fullBlocks);
+    memcpy(tail, &data[fullBlocks * 64], static_cast<size_t>(tailLength));
+    compress(state, tail, _sha256Pad(tail, tailLength, static_cast<quint64>(length)));
+    _sha256Output(state, hash, 32);
+}
+
+MAVLinkSigning::Key_t MAVLinkSigning::keyFromPassphrase(const QString& passphrase)
+{
+    Key_t       key;
+    QByteArray  bytes = passphrase.toUtf8();
+
+    sha256(reinterpret_cast<const uint8_t*>(bytes.constData()), bytes.size(), key.data());
+    return key;
+}
+
+quint64 MAVLinkSigning::nowTimestamp(void)
+{
+    static const qint64 signingEpochMSecs = 1420070400000LL;   // 1 January 2015 GMT
+
+    return static_cast<quint64>(qMax(static_cast<qint64>(0), QDateTime::currentMSecsSinceEpoch() - signingEpochMSecs)) * 100;
+}
+
+void MAVLinkSigning::configure(const Key_t& key, uint8_t linkId, bool acceptUnsigned)
+{
+    QMutexLocker locker(&_mutex);
+
+    _key            = key;
+    _linkId         = linkId;
+    _acceptUnsigned = acceptUnsigned;
+    _timestamp      = nowTimestamp();
+    _streamTimestamps.clear();
+    _enabled        = true;
+
+    qCDebug(MAVLinkSigningLog) << "Signing enabled link id:acceptUnsigned:sha256" << linkId << acceptUnsigned << sha256Implementation();
+}
+
+void MAVLinkSigning::disable(void)
+{
+    QMutexLocker locker(&_mutex);
+
+    _enabled = false;
+    _key.fill(0);
+    _streamTimestamps.clear();
+}
+
+MAVLinkSigning::Counts_t MAVLinkSigning::takeCounts(void)
+{
+    QMutexLocker locker(&_mutex);
+
+    Counts_t counts = _counts;
+    _counts = {};
+    return counts;
+}
+
+/// Signature over key, header, payload, checksum, link id and time stamp. Must be called with _mutex held.
+///     @param signatureHeader  Link id and time stamp, the first 7 bytes of the signature block
+///     @param signature        Returns the first 6 bytes of the hash
+void MAVLinkSigning::_signature(CompressFunction compress, const uint8_t* header, const uint8_t* payload, int payloadLength, const uint8_t* checksum, const uint8_t* signatureHeader, uint8_t signature[6]) const
+{
+    // The largest input (32 + 10 + 255 + 2 + 7 bytes) pads out to 5 blocks
+    uint8_t     buffer[5 * 64];
+    int         length = 0;
+    uint32_t    state[8];
+
+    memcpy(&buffer[length], _key.data(), _key.size());
+    length += static_cast<int>(_key.size());
+    memcpy(&buffer[length], header, MAVLINK_NUM_HEADER_BYTES);
+    length += MAVLINK_NUM_HEADER_BYTES;
+    memcpy(&buffer[length], payload, static_cast<size_t>(payloadLength));
+    length += payloadLength;
+    memcpy(&buffer[length], checksum, MAVLINK_NUM_CHECKSUM_BYTES);
+    length += MAVLINK_NUM_CHECKSUM_BYTES;
+    memcpy(&buffer[length], signatureHeader, 7);
+    length += 7;
+
+    memcpy(state, _sha256InitialState, sizeof(state));
+    compress(state, buffer, _sha256Pad(buffer, length, static_cast<quint64>(length)));
+    _sha256Output(state, signature, 6);
+}
+
+/// Checks a single message against the signing rules. Must be called with _mutex held.
+bool MAVLinkSigning::_verify(CompressFunction compress, const mavlink_message_t& message)
+{
+    if (!(message.incompat_flags & MAVLINK_IFLAG_SIGNED)) {
+        // Radios insert RADIO_STATUS into the stream without being able to sign it
+        if (_acceptUnsigned || message.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
+            return true;
+        }
+        _counts.unsignedRejected++;
+        return false;
+    }
+
+    const uint8_t header[MAVLINK_NUM_HEADER_BYTES] = {
+        message.magic,
+        message.len,
+        message.incompat_flags,
+        message.compat_flags,
+        message.seq,
+        message.sysid,
+        message.compid,
+        static_cast<uint8_t>(message.msgid & 0xFF),
+        static_cast<uint8_t>((message.msgid >> 8) & 0xFF),
+        static_cast<uint8_t>((message.msgid >> 16) & 0xFF),
+    };
+    uint8_t signature[6];
+    _signature(compress, header, reinterpret_cast<const uint8_t*>(_MAV_PAYLOAD(&message)), message.len, message.ck, message.signature, signature);
+    if (memcmp(signature, &message.signature[7], sizeof(signature)) != 0) {
+        _counts.badSignature++;
+        return false;
+    }
+
+    // The signature is good, now make sure it isn't a replay
+    quint64 timestamp = 0;
+    for (int i=0; i<6; i++) {
+        timestamp |= static_cast<quint64>(message.signature[1 + i]) << (8 * i);
+    }
+    const quint32 streamKey = (static_cast<quint32>(message.signature[0]) << 16) | (static_cast<quint32>(message.sysid) << 8) | message.compid;
+    auto stream = _streamTimestamps.find(streamKey);
+    if (stream == _streamTimestamps.end()) {
+        if (timestamp + _newStreamMaxAge < _timestamp || _streamTimestamps.count() >= _maxStreams) {
+            _counts.replayed++;
+            return false;
+        }
+        _streamTimestamps.insert(streamKey, timestamp);
+    } else {
+        if (timestamp <= stream.value()) {
+            _counts.replayed++;
+            return false;
+        }
+        stream.value() = timestamp;
+    }
+
+    _timestamp = qMax(_timestamp, timestamp);
+    _counts.verified++;
+    return true;
+}
+
+int MAVLinkSigning::verify(QVector<mavlink_message_t>& messages, int start)
+{
+    if (!_enabled || start >= messages.count()) {
+        return 0;
+    }
+
+    // A single lock and implementation lookup covers the whole batch
+    CompressFunction compress = _compressFunction();
+    QMutexLocker locker(&_mutex);
+
+    _timestamp = qMax(_timestamp, nowTimestamp());
+
+    int kept = start;
+    for (int i=start; i<messages.count(); i++) {
+        if (_verify(compress, messages.at(i))) {
+            if (kept != i) {
+                messages[kept] = messages.at(i);
+            }
+            kept++;
+        }
+    }
+
+    const int removed = messages.count() - kept;
+    if (removed) {
+        // Shrinking keeps the capacity, so the recycled batch storage is not lost
+        messages.resize(kept);
+        qCDebug(MAVLinkSigningLog) << "Rejected messages" << removed;
+    }
+    return removed;
+}
+
+bool MAVLinkSigning::signFrame(QByteArray& frame)
+{
+    if (!_enabled) {
+        return false;
+    }
+
+    // Only a single unsigned mavlink 2 frame can be signed, which is what each message write is
+    const int       length  = frame.size();
+    const uint8_t*  bytes   = reinterpret_cast<const uint8_t*>(frame.constData());
+    if (length < MAVLINK_NUM_HEADER_BYTES + MAVLINK_NUM_CHECKSUM_BYTES || bytes[0] != MAVLINK_STX || bytes[2] != 0 ||
+            length != MAVLINK_NUM_HEADER_BYTES + bytes[1] + MAVLINK_NUM_CHECKSUM_BYTES) {
+        return false;
+    }
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(bytes[7] | (bytes[8] << 8) | (bytes[9] << 16));
+    if (!entry) {
+        return false;
+    }
+
+    frame.resize(length + MAVLINK_SIGNATURE_BLOCK_LEN);
+    uint8_t*    out             = reinterpret_cast<uint8_t*>(frame.data());
+    const int   payloadLength   = out[1];
+    uint8_t*    checksum        = &out[MAVLINK_NUM_HEADER_BYTES + payloadLength];
+    uint8_t*    signature       = &checksum[MAVLINK_NUM_CHECKSUM_BYTES];
+
+    // The signed flag is covered by the checksum
+    out[2] |= MAVLINK_IFLAG_SIGNED;
+    uint16_t crc = crc_calculate(&out[1], static_cast<uint16_t>(MAVLINK_NUM_HEADER_BYTES - 1 + payloadLength));
+    crc_accumulate(entry->crc_extra, &crc);
+    checksum[0] = static_cast<uint8_t>(crc & 0xFF);
+    checksum[1] = static_cast<uint8_t>(crc >> 8);
+
+    QMutexLocker locker(&_mutex);
+
+    // Every message needs a newer time stamp, even several sent within the same 10 usecs
+    _timestamp = qMax(_timestamp + 1, nowTimestamp());
+    signature[0] = _linkId;
+    for (int i=0; i<6; i++) {
+        signature[1 + i] = static_cast<uint8_t>(_timestamp >> (8 * i));
+    }
+    _signature(_compressFunction(), out, &out[MAVLINK_NUM_HEADER_BYTES], payloadLength, checksum, signature, &signature[7]);
+
+    return true;
+}
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QLoggingCategory>
+
+#include <array>
+#include <atomic>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkSigningLog)
+
+/// MAVLink 2 message signing for a single link.
+///
+/// Verification runs on the link thread over each batch of decoded messages, instead of inside mavlink_parse_char on
+/// the receive path. Signatures are computed with the SHA-256 instructions of the CPU when available (SHA-NI on x86,
+/// the ARMv8 crypto extensions on ARM), with a portable implementation as fallback. Timestamps are tracked per stream
+/// (link id, system id, component id) following the rules of the MAVLink signing specification.
+class MAVLinkSigning
+{
+public:
+    typedef std::array<uint8_t, 32> Key_t;
+
+    /// Verification counts since the last takeCounts call
+    typedef struct {
+        int verified;           ///< Signed messages which passed
+        int badSignature;
+        int replayed;           ///< Timestamp not newer than the last one for the stream, or too old for a new stream
+        int unsignedRejected;
+    } Counts_t;
+
+    MAVLinkSigning(void);
+
+    /// @return Secret key for a passphrase, the SHA-256 of its UTF-8 bytes
+    static Key_t keyFromPassphrase(const QString& passphrase);
+
+    /// Computes the SHA-256 of data with the fastest implementation available on this CPU
+    static void sha256(const uint8_t* data, int length, uint8_t hash[32]);
+
+    /// @return Name of the SHA-256 implementation in use: "sha-ni", "armv8" or "portable"
+    static const char* sha256Implementation(void);
+
+    /// Enables signing
+    ///     @param linkId           Link id placed in outgoing signatures
+    ///     @param acceptUnsigned   true: Unsigned incoming messages are let through
+    void configure(const Key_t& key, uint8_t linkId, bool acceptUnsigned);
+    void disable(void);
+    bool enabled(void) const { return _enabled; }
+
+    /// Verifies the messages from index start on and removes the ones which are rejected, keeping the order of the rest
+    /// @return Number of messages removed
+    int verify(QVector<mavlink_message_t>& messages, int start = 0);
+
+    /// Signs a single, complete, unsigned MAVLink 2 frame in place. Anything else is left as is.
+    /// @return true: frame was signed
+    bool signFrame(QByteArray& frame);
+
+    /// @return Counts since the last call
+    Counts_t takeCounts(void);
+
+    /// @return Current time in signing time stamp units: 10 microseconds since 1 January 2015 GMT
+    static quint64 nowTimestamp(void);
+
+private:
+    /// SHA-256 block function: runs blockCount 64 byte blocks through state
+    typedef void (*CompressFunction)(uint32_t state[8], const uint8_t* blocks, int blockCount);
+
+    /// @return Fastest block function supported by this CPU, detected once
+    static CompressFunction _compressFunction(void);
+
+    void _signature (CompressFunction compress, const uint8_t* header, const uint8_t* payload, int payloadLength, const uint8_t* checksum, const uint8_t* signatureHeader, uint8_t signature[6]) const;
+    bool _verify    (CompressFunction compress, const mavlink_message_t& message);
+
+    mutable QMutex          _mutex;
+    std::atomic<bool>       _enabled        { false };
+    bool                    _acceptUnsigned = false;
+    uint8_t                 _linkId         = 0;
+    Key_t                   _key            {};
+    quint64                 _timestamp      = 0;    ///< Newest time stamp sent or accepted
+    QHash<quint32, quint64> _streamTimestamps;      ///< Key: link id << 16 | sysid << 8 | compid
+    Counts_t                _counts         {};
+
+    static const int        _maxStreams         = 256;          ///< New streams past this many are rejected
+    static const quint64    _newStreamMaxAge    = 6000000;      ///< A new stream may start up to a minute behind, in time stamp units
+};
@@ -13,7 +13,7 @@
 
 MavlinkMessagesTimer::MavlinkMessagesTimer(int vehicle_id, bool high_latency) :
     _active(true),
-    _timer(new QTimer),
+    _timer(new QGCWheelTimer),
     _vehicleID(vehicle_id),
     _high_latency(high_latency)
 {
@@ -27,14 +27,14 @@ void MavlinkMessagesTimer::init()
         _timer->start();
     }
     emit activeChanged(true, _vehicleID);
-    QObject::connect(_timer, &QTimer::timeout, this, &MavlinkMessagesTimer::timerTimeout);
+    QObject::connect(_timer, &QGCWheelTimer::timeout, this, &MavlinkMessagesTimer::timerTimeout);
 }
 
 
 MavlinkMessagesTimer::~MavlinkMessagesTimer()
 {
     if (_timer) {
-        QObject::disconnect(_timer, &QTimer::timeout, this, &MavlinkMessagesTimer::timerTimeout);
+        QObject::disconnect(_timer, &QGCWheelTimer::timeout, this, &MavlinkMessagesTimer::timerTimeout);
         _timer->stop();
         delete _timer;
         _timer = nullptr;
@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include <QTimer>
+#include "QGCTimerWheel.h"
 #include <QObject>
 
 /**
@@ -95,7 +95,7 @@ private slots:
 
 private:
     bool _active = false; // The state of active. Is true if the timer has not timed out.
-    QTimer* _timer = nullptr; // Single shot timer
+    QGCWheelTimer* _timer = nullptr; // Restarted on each message, which only moves its deadline
     int _vehicleID = -1; // Vehicle ID for which the heartbeat is tracked.
     bool _high_latency = false; // Indicates if the link is a high latency link or not.
 
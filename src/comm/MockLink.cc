@@ -16,6 +16,7 @@
 #include "UnitTest.h"
 #endif
 
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
 #include <QMutexLocker>
@@ -48,6 +49,13 @@ const char* MockConfiguration::_vehicleTypeKey          = "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey       = "SendStatusText";
 const char* MockConfiguration::_incrementVehicleIdKey   = "IncrementVehicleId";
 const char* MockConfiguration::_failureModeKey          = "FailureMode";
+const char* MockConfiguration::_loadRateKey             = "LoadRate";
+const char* MockConfiguration::_loadMixKey              = "LoadMix";
+const char* MockConfiguration::_loadSystemCountKey      = "LoadSystemCount";
+const char* MockConfiguration::_loadBurstMSecsKey       = "LoadBurstMSecs";
+const char* MockConfiguration::_loadLossPercentKey      = "LoadLossPercent";
+const char* MockConfiguration::_loadDuplicatePercentKey = "LoadDuplicatePercent";
+const char* MockConfiguration::_loadReorderPercentKey   = "LoadReorderPercent";
 
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED;
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED;
@@ -95,6 +103,33 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     _vehicleLongitude   = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
     _boardVendorId      = mockConfig->boardVendorId();
     _boardProductId     = mockConfig->boardProductId();
+    _attitudeRate       = mockConfig->attitudeRate();
+    _loadRate           = qMax(0, mockConfig->loadRate());
+    _loadBurstMSecs     = qMax(0, mockConfig->loadBurstMSecs());
+    _loadLossPercent    = qBound(0, mockConfig->loadLossPercent(), 100);
+    _loadDuplicatePercent = qBound(0, mockConfig->loadDuplicatePercent(), 100);
+    _loadReorderPercent = qBound(0, mockConfig->loadReorderPercent(), 100);
+    _loadRandom.seed(_vehicleSystemId);     // Same pattern on every run
+
+    for (const QString& entry: mockConfig->loadMix().split(',', Qt::SkipEmptyParts)) {
+        QStringList parts   = entry.split(':');
+        bool        ok      = false;
+        uint32_t    msgId   = parts[0].trimmed().toUInt(&ok);
+        int         weight  = parts.count() > 1 ? parts[1].trimmed().toInt() : 1;
+        if (!ok || !mavlink_get_msg_entry(msgId) || weight <= 0) {
+            qCWarning(MockLinkLog) << "Ignoring load mix entry" << entry;
+            continue;
+        }
+        _loadMix.append(QVector<uint32_t>(weight, msgId));
+    }
+    if (_loadMix.isEmpty()) {
+        _loadRate = 0;
+    }
+    for (int i=0; i<qBound(1, mockConfig->loadSystemCount(), 254); i++) {
+        // Stay within 1-254, 255 is the GCS
+        _loadSystemIds.append(static_cast<uint8_t>(((_vehicleSystemId - 1 + i) % 254) + 1));
+    }
+    _loadSequences.fill(0, _loadSystemIds.count());
 
     QObject::connect(this, &MockLink::writeBytesQueuedSignal, this, &MockLink::_writeBytesQueued, Qt::QueuedConnection);
 
@@ -276,6 +311,132 @@ void MockLink::_run500HzTasks(void)
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
         _logDownloadWorker();
+
+        if (_attitudeRate > 0) {
+            qint64 attitudeDue = _runningTime.elapsed() * _attitudeRate / 1000;
+            if (attitudeDue - _attitudeSentCount > _attitudeRate) {
+                // Don't burst out more than a second of backlog (connect, stalled thread)
+                _attitudeSentCount = attitudeDue - _attitudeRate;
+            }
+            while (_attitudeSentCount < attitudeDue) {
+                _sendAttitude();
+                _attitudeSentCount++;
+            }
+        }
+        if (_loadRate > 0) {
+            _loadGeneratorWorker();
+        }
+    }
+}
+
+void MockLink::_loadGeneratorWorker(void)
+{
+    const qint64 now = _runningTime.elapsed();
+    if (_loadBurstMSecs > 0) {
+        if (now - _loadLastBurst < _loadBurstMSecs) {
+            return;
+        }
+        _loadLastBurst = now;
+    }
+
+    qint64 loadDue = now * _loadRate / 1000;
+    const qint64 maxBacklog = qMax<qint64>(_loadRate, static_cast<qint64>(_loadRate) * _loadBurstMSecs / 1000);
+    if (loadDue - _loadSentCount > maxBacklog) {
+        // Same as attitudeRate, a stalled thread doesn't turn into an unbounded burst
+        _loadSentCount = loadDue - maxBacklog;
+    }
+
+    // Everything due this tick goes out as one chunk, as a link read would deliver it
+    QByteArray bytes;
+    while (_loadSentCount < loadDue) {
+        const int       systemIndex = static_cast<int>(_loadSentCount % _loadSystemIds.count());
+        const uint32_t  msgId       = _loadMix[static_cast<int>((_loadSentCount / _loadSystemIds.count()) % _loadMix.count())];
+        _loadSentCount++;
+
+        mavlink_message_t   msg;
+        mavlink_status_t*   status      = mavlink_get_channel_status(mavlinkChannel());
+        const uint8_t       channelSeq  = status->current_tx_seq;
+        if (systemIndex != 0) {
+            // Own sequence for the additional system ids, the vehicle id shares it with the regular messages
+            status->current_tx_seq = _loadSequences[systemIndex];
+        }
+        _packLoadMessage(msg, _loadSystemIds[systemIndex], msgId);
+        if (systemIndex != 0) {
+            _loadSequences[systemIndex] = status->current_tx_seq;
+            status->current_tx_seq = channelSeq;
+        }
+
+        if (static_cast<int>(_loadRandom.bounded(100)) < _loadLossPercent) {
+            // Sequence number was used so QGC sees the gap
+            continue;
+        }
+        _queueLoadMessage(bytes, msg);
+        if (static_cast<int>(_loadRandom.bounded(100)) < _loadDuplicatePercent) {
+            _queueLoadMessage(bytes, msg);
+        }
+    }
+    if (!bytes.isEmpty() && !_commLost) {
+        emit bytesReceived(this, bytes);
+    }
+}
+
+void MockLink::_queueLoadMessage(QByteArray& bytes, const mavlink_message_t& msg)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const int cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
+
+    if (!_loadHeldBack.isEmpty()) {
+        bytes.append(reinterpret_cast<const char*>(buffer), cBuffer);
+        bytes.append(_loadHeldBack);
+        _loadHeldBack.clear();
+    } else if (static_cast<int>(_loadRandom.bounded(100)) < _loadReorderPercent) {
+        _loadHeldBack = QByteArray(reinterpret_cast<const char*>(buffer), cBuffer);
+    } else {
+        bytes.append(reinterpret_cast<const char*>(buffer), cBuffer);
+    }
+}
+
+void MockLink::_packLoadMessage(mavlink_message_t& msg, uint8_t systemId, uint32_t msgId)
+{
+    const uint32_t  sendTime    = static_cast<uint32_t>(QDateTime::currentMSecsSinceEpoch());
+    const double    offset      = (systemId - _vehicleSystemId) * 0.0001;
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_ATTITUDE:
+        mavlink_msg_attitude_pack_chan(systemId, _vehicleComponentId, mavlinkChannel(), &msg,
+                                       sendTime,    // Send time for latency measurement
+                                       0, 0, 0, 0, 0, 0);
+        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        mavlink_msg_global_position_int_pack_chan(systemId, _vehicleComponentId, mavlinkChannel(), &msg,
+                                                  sendTime,
+                                                  static_cast<int32_t>((_vehicleLatitude + offset) * 1E7),
+                                                  static_cast<int32_t>((_vehicleLongitude + offset) * 1E7),
+                                                  static_cast<int32_t>(_vehicleAltitude * 1000),
+                                                  static_cast<int32_t>(_vehicleAltitude * 1000),
+                                                  0, 0, 0,      // vx, vy, vz
+                                                  UINT16_MAX);  // heading not known
+        break;
+    case MAVLINK_MSG_ID_VFR_HUD:
+        mavlink_msg_vfr_hud_pack_chan(systemId, _vehicleComponentId, mavlinkChannel(), &msg,
+                                      0, 0,                     // airspeed, groundspeed
+                                      0, 0,                     // heading, throttle
+                                      static_cast<float>(_vehicleAltitude),
+                                      0);                       // climb
+        break;
+    case MAVLINK_MSG_ID_HEARTBEAT:
+        mavlink_msg_heartbeat_pack_chan(systemId, _vehicleComponentId, mavlinkChannel(), &msg,
+                                        _vehicleType, _firmwareType, _mavBaseMode, _mavCustomMode, _mavState);
+        break;
+    default:
+    {
+        // Zeroed payload, enough to exercise routing and dispatch
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgId);
+        memset(&msg, 0, sizeof(msg));
+        msg.msgid = msgId;
+        mavlink_finalize_message_chan(&msg, systemId, _vehicleComponentId, mavlinkChannel(), entry->min_msg_len, entry->max_msg_len, entry->crc_extra);
+        break;
+    }
     }
 }
 
@@ -1242,6 +1403,20 @@ void MockLink::_sendHomePosition(void)
     respondWithMavlinkMessage(msg);
 }
 
+void MockLink::_sendAttitude(void)
+{
+    mavlink_message_t msg;
+
+    mavlink_msg_attitude_pack_chan(_vehicleSystemId,
+                                   _vehicleComponentId,
+                                   mavlinkChannel(),
+                                   &msg,
+                                   static_cast<uint32_t>(QDateTime::currentMSecsSinceEpoch()),  // Send time for latency measurement
+                                   0, 0, 0,                                                     // roll, pitch, yaw
+                                   0, 0, 0);                                                    // rollspeed, pitchspeed, yawspeed
+    respondWithMavlinkMessage(msg);
+}
+
 void MockLink::_sendGpsRawInt(void)
 {
     static uint64_t timeTick = 0;
@@ -1363,6 +1538,14 @@ MockConfiguration::MockConfiguration(MockConfiguration* source)
     _sendStatusText     = source->_sendStatusText;
     _incrementVehicleId = source->_incrementVehicleId;
     _failureMode        = source->_failureMode;
+    _attitudeRate       = source->_attitudeRate;
+    _loadRate           = source->_loadRate;
+    _loadMix            = source->_loadMix;
+    _loadSystemCount    = source->_loadSystemCount;
+    _loadBurstMSecs     = source->_loadBurstMSecs;
+    _loadLossPercent    = source->_loadLossPercent;
+    _loadDuplicatePercent = source->_loadDuplicatePercent;
+    _loadReorderPercent = source->_loadReorderPercent;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1380,6 +1563,14 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
     _sendStatusText     = usource->_sendStatusText;
     _incrementVehicleId = usource->_incrementVehicleId;
     _failureMode        = usource->_failureMode;
+    _attitudeRate       = usource->_attitudeRate;
+    _loadRate           = usource->_loadRate;
+    _loadMix            = usource->_loadMix;
+    _loadSystemCount    = usource->_loadSystemCount;
+    _loadBurstMSecs     = usource->_loadBurstMSecs;
+    _loadLossPercent    = usource->_loadLossPercent;
+    _loadDuplicatePercent = usource->_loadDuplicatePercent;
+    _loadReorderPercent = usource->_loadReorderPercent;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1390,6 +1581,13 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey,       _sendStatusText);
     settings.setValue(_incrementVehicleIdKey,   _incrementVehicleId);
     settings.setValue(_failureModeKey,          (int)_failureMode);
+    settings.setValue(_loadRateKey,             _loadRate);
+    settings.setValue(_loadMixKey,              _loadMix);
+    settings.setValue(_loadSystemCountKey,      _loadSystemCount);
+    settings.setValue(_loadBurstMSecsKey,       _loadBurstMSecs);
+    settings.setValue(_loadLossPercentKey,      _loadLossPercent);
+    settings.setValue(_loadDuplicatePercentKey, _loadDuplicatePercent);
+    settings.setValue(_loadReorderPercentKey,   _loadReorderPercent);
     settings.sync();
     settings.endGroup();
 }
@@ -1402,6 +1600,13 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _sendStatusText     = settings.value(_sendStatusTextKey, false).toBool();
     _incrementVehicleId = settings.value(_incrementVehicleIdKey, true).toBool();
     _failureMode        = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _loadRate           = settings.value(_loadRateKey, 0).toInt();
+    _loadMix            = settings.value(_loadMixKey, _loadMix).toString();
+    _loadSystemCount    = settings.value(_loadSystemCountKey, 1).toInt();
+    _loadBurstMSecs     = settings.value(_loadBurstMSecsKey, 0).toInt();
+    _loadLossPercent    = settings.value(_loadLossPercentKey, 0).toInt();
+    _loadDuplicatePercent = settings.value(_loadDuplicatePercentKey, 0).toInt();
+    _loadReorderPercent = settings.value(_loadReorderPercentKey, 0).toInt();
     settings.endGroup();
 }
 
@@ -14,6 +14,8 @@
 #include <QLoggingCategory>
 #include <QMap>
 #include <QMutex>
+#include <QRandomGenerator>
+#include <QVector>
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFTP.h"
@@ -36,6 +38,13 @@ public:
     Q_PROPERTY(int      vehicle             READ vehicle            WRITE setVehicle            NOTIFY vehicleChanged)
     Q_PROPERTY(bool     sendStatus          READ sendStatusText     WRITE setSendStatusText     NOTIFY sendStatusChanged)
     Q_PROPERTY(bool     incrementVehicleId  READ incrementVehicleId WRITE setIncrementVehicleId NOTIFY incrementVehicleIdChanged)
+    Q_PROPERTY(int      loadRate            READ loadRate           WRITE setLoadRate           NOTIFY loadChanged)
+    Q_PROPERTY(QString  loadMix             READ loadMix            WRITE setLoadMix            NOTIFY loadChanged)
+    Q_PROPERTY(int      loadSystemCount     READ loadSystemCount    WRITE setLoadSystemCount    NOTIFY loadChanged)
+    Q_PROPERTY(int      loadBurstMSecs      READ loadBurstMSecs     WRITE setLoadBurstMSecs     NOTIFY loadChanged)
+    Q_PROPERTY(int      loadLossPercent     READ loadLossPercent    WRITE setLoadLossPercent    NOTIFY loadChanged)
+    Q_PROPERTY(int      loadDuplicatePercent READ loadDuplicatePercent WRITE setLoadDuplicatePercent NOTIFY loadChanged)
+    Q_PROPERTY(int      loadReorderPercent  READ loadReorderPercent WRITE setLoadReorderPercent NOTIFY loadChanged)
 
     int     firmware                (void)                      { return (int)_firmwareType; }
     void    setFirmware             (int type)                  { _firmwareType = (MAV_AUTOPILOT)type; emit firmwareChanged(); }
@@ -56,6 +65,37 @@ public:
     void            setVehicleType      (MAV_TYPE vehicleType)          { _vehicleType = vehicleType; emit vehicleChanged(); }
     void            setSendStatusText   (bool sendStatusText)           { _sendStatusText = sendStatusText; emit sendStatusChanged(); }
 
+    /// Rate in Hz of additional ATTITUDE messages sent by the vehicle to load message handling. 0 for none.
+    /// time_boot_ms of these messages holds the low 32 bits of QDateTime::currentMSecsSinceEpoch at send time.
+    int             attitudeRate        (void) const                    { return _attitudeRate; }
+    void            setAttitudeRate     (int attitudeRate)              { _attitudeRate = attitudeRate; }
+
+    // Load generator. Synthesizes loadRate messages per second on top of the normal simulation, drawn from loadMix
+    // and spread round robin across loadSystemCount system ids starting at the vehicle id. Each system id has its own
+    // packet sequence so loss injection shows up in QGC link statistics like real loss would.
+
+    /// Messages per second, 0 for no load
+    int             loadRate            (void) const                    { return _loadRate; }
+    /// Comma separated msgid:weight list, for example "30:10,33:5,74:2". ATTITUDE time_boot_ms holds the send time
+    /// as for attitudeRate. Other messages than ATTITUDE, GLOBAL_POSITION_INT and VFR_HUD are sent with zeroed payload.
+    QString         loadMix             (void) const                    { return _loadMix; }
+    /// Number of system ids the load is sent from. Ids other than the vehicle id only send the load, HEARTBEAT (0)
+    /// must be in the mix for QGC to create vehicles for them.
+    int             loadSystemCount     (void) const                    { return _loadSystemCount; }
+    /// Load is released in bursts this far apart instead of evenly, 0 for even
+    int             loadBurstMSecs      (void) const                    { return _loadBurstMSecs; }
+    int             loadLossPercent     (void) const                    { return _loadLossPercent; }
+    int             loadDuplicatePercent(void) const                    { return _loadDuplicatePercent; }
+    int             loadReorderPercent  (void) const                    { return _loadReorderPercent; }     ///< Swapped with the following message
+
+    void            setLoadRate         (int rate)                      { _loadRate = rate; emit loadChanged(); }
+    void            setLoadMix          (const QString& mix)            { _loadMix = mix; emit loadChanged(); }
+    void            setLoadSystemCount  (int count)                     { _loadSystemCount = count; emit loadChanged(); }
+    void            setLoadBurstMSecs   (int msecs)                     { _loadBurstMSecs = msecs; emit loadChanged(); }
+    void            setLoadLossPercent  (int percent)                   { _loadLossPercent = percent; emit loadChanged(); }
+    void            setLoadDuplicatePercent(int percent)                { _loadDuplicatePercent = percent; emit loadChanged(); }
+    void            setLoadReorderPercent(int percent)                  { _loadReorderPercent = percent; emit loadChanged(); }
+
     typedef enum {
         FailNone,                                                   // No failures
         FailParamNoReponseToRequestList,                            // Do no respond to PARAM_REQUEST_LIST
@@ -82,6 +122,7 @@ signals:
     void vehicleChanged             (void);
     void sendStatusChanged          (void);
     void incrementVehicleIdChanged  (void);
+    void loadChanged                (void);
 
 private:
     MAV_AUTOPILOT   _firmwareType       = MAV_AUTOPILOT_PX4;
@@ -91,12 +132,27 @@ private:
     bool            _incrementVehicleId = true;
     uint16_t        _boardVendorId      = 0;
     uint16_t        _boardProductId     = 0;
+    int             _attitudeRate       = 0;
+    int             _loadRate           = 0;
+    QString         _loadMix            = QStringLiteral("30:10,33:5,74:2");
+    int             _loadSystemCount    = 1;
+    int             _loadBurstMSecs     = 0;
+    int             _loadLossPercent    = 0;
+    int             _loadDuplicatePercent = 0;
+    int             _loadReorderPercent = 0;
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _incrementVehicleIdKey;
     static const char* _failureModeKey;
+    static const char* _loadRateKey;
+    static const char* _loadMixKey;
+    static const char* _loadSystemCountKey;
+    static const char* _loadBurstMSecsKey;
+    static const char* _loadLossPercentKey;
+    static const char* _loadDuplicatePercentKey;
+    static const char* _loadReorderPercentKey;
 };
 
 class MockLink : public LinkInterface
@@ -229,6 +285,7 @@ private:
     void _setParamFloatUnionIntoMap     (int componentId, const QString& paramName, float paramFloat);
     void _sendHomePosition              (void);
     void _sendGpsRawInt                 (void);
+    void _sendAttitude                  (void);
     void _sendVibration                 (void);
     void _sendSysStatus                 (void);
     void _sendBatteryStatus             (void);
@@ -241,6 +298,9 @@ private:
     void _sendADSBVehicles              (void);
     void _moveADSBVehicle               (void);
     void _sendGeneralMetaData           (void);
+    void _loadGeneratorWorker           (void);
+    void _packLoadMessage               (mavlink_message_t& msg, uint8_t systemId, uint32_t msgId);
+    void _queueLoadMessage              (QByteArray& bytes, const mavlink_message_t& msg);
 
     static MockLink* _startMockLinkWorker(QString configName, MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType, bool sendStatusText, MockConfiguration::FailureMode_t failureMode);
     static MockLink* _startMockLink(MockConfiguration* mockConfig);
@@ -264,6 +324,22 @@ private:
     uint8_t                     _mavState;
 
     QElapsedTimer               _runningTime;
+    int                         _attitudeRate                   = 0;
+    qint64                      _attitudeSentCount              = 0;
+
+    // Load generator, see MockConfiguration::loadRate
+    int                         _loadRate                       = 0;
+    int                         _loadBurstMSecs                 = 0;
+    int                         _loadLossPercent                = 0;
+    int                         _loadDuplicatePercent           = 0;
+    int                         _loadReorderPercent             = 0;
+    qint64                      _loadSentCount                  = 0;
+    qint64                      _loadLastBurst                  = 0;
+    QVector<uint32_t>           _loadMix;                       ///< msgid repeated by weight, walked round robin
+    QVector<uint8_t>            _loadSystemIds;
+    QVector<uint8_t>            _loadSequences;                 ///< Per entry of _loadSystemIds
+    QByteArray                  _loadHeldBack;                  ///< Message being reordered
+    QRandomGenerator            _loadRandom;
     static const int32_t        _batteryMaxTimeRemaining        = 15 * 60;
     int8_t                      _battery1PctRemaining           = 100;
     int32_t                     _battery1TimeRemaining          = _batteryMaxTimeRemaining;
@@ -41,6 +41,8 @@ const QGCSerialPortInfo::BoardClassString2BoardType_t QGCSerialPortInfo::_rgBoar
 QList<QGCSerialPortInfo::BoardInfo_t>           QGCSerialPortInfo::_boardInfoList;
 QList<QGCSerialPortInfo::BoardRegExpFallback_t> QGCSerialPortInfo::_boardDescriptionFallbackList;
 QList<QGCSerialPortInfo::BoardRegExpFallback_t> QGCSerialPortInfo::_boardManufacturerFallbackList;
+QHash<quint32, int>                             QGCSerialPortInfo::_boardInfoIndexByVidPid;
+QHash<int, int>                                 QGCSerialPortInfo::_boardInfoIndexByVid;
 
 QGCSerialPortInfo::QGCSerialPortInfo(void) :
     QSerialPortInfo()
@@ -135,6 +137,19 @@ void QGCSerialPortInfo::_loadJsonData(void)
             return;
         }
 
+        // Earlier entries win, same as a front to back search of the list would
+        int index = _boardInfoList.count();
+        if (boardInfo.productId == 0) {
+            if (!_boardInfoIndexByVid.contains(boardInfo.vendorId)) {
+                _boardInfoIndexByVid[boardInfo.vendorId] = index;
+            }
+        } else {
+            quint32 vidPid = (static_cast<quint32>(boardInfo.vendorId) << 16) | static_cast<quint16>(boardInfo.productId);
+            if (!_boardInfoIndexByVidPid.contains(vidPid)) {
+                _boardInfoIndexByVidPid[vidPid] = index;
+            }
+        }
+
         _boardInfoList.append(boardInfo);
     }
 
@@ -161,7 +176,8 @@ void QGCSerialPortInfo::_loadJsonData(void)
         }
 
         BoardRegExpFallback_t boardFallback;
-        boardFallback.regExp =      fallbackObject[_jsonRegExpKey].toString();
+        boardFallback.regExp =      QRegularExpression(fallbackObject[_jsonRegExpKey].toString(), QRegularExpression::CaseInsensitiveOption);
+        boardFallback.regExp.optimize();
         boardFallback.androidOnly = fallbackObject[_jsonAndroidOnlyKey].toBool(false);
         boardFallback.boardType =   _boardClassStringToType(fallbackObject[_jsonBoardClassKey].toString());
 
@@ -188,7 +204,8 @@ void QGCSerialPortInfo::_loadJsonData(void)
         }
 
         BoardRegExpFallback_t boardFallback;
-        boardFallback.regExp =      fallbackObject[_jsonRegExpKey].toString();
+        boardFallback.regExp =      QRegularExpression(fallbackObject[_jsonRegExpKey].toString(), QRegularExpression::CaseInsensitiveOption);
+        boardFallback.regExp.optimize();
         boardFallback.androidOnly = fallbackObject[_jsonAndroidOnlyKey].toBool(false);
         boardFallback.boardType =   _boardClassStringToType(fallbackObject[_jsonBoardClassKey].toString());
 
@@ -222,14 +239,18 @@ bool QGCSerialPortInfo::getBoardInfo(QGCSerialPortInfo::BoardType_t& boardType,
         return false;
     }
 
-    for (int i=0; i<_boardInfoList.count(); i++) {
-        const BoardInfo_t& boardInfo = _boardInfoList[i];
-
-        if (vendorIdentifier() == boardInfo.vendorId && (productIdentifier() == boardInfo.productId || boardInfo.productId == 0)) {
-            boardType = boardInfo.boardType;
-            name = boardInfo.name;
-            return true;
-        }
+    // An exact vendor/product match and a match on vendor only can both exist, the one first in the json wins
+    quint32 vidPid = (static_cast<quint32>(vendorIdentifier()) << 16) | productIdentifier();
+    int     index = _boardInfoIndexByVidPid.value(vidPid, -1);
+    int     vidIndex = _boardInfoIndexByVid.value(vendorIdentifier(), -1);
+    if (vidIndex != -1 && (index == -1 || vidIndex < index)) {
+        index = vidIndex;
+    }
+    if (index != -1) {
+        const BoardInfo_t& boardInfo = _boardInfoList[index];
+        boardType = boardInfo.boardType;
+        name = boardInfo.name;
+        return true;
     }
 
     if (boardType == BoardTypeUnknown) {
@@ -238,7 +259,7 @@ bool QGCSerialPortInfo::getBoardInfo(QGCSerialPortInfo::BoardType_t& boardType,
         for (int i=0; i<_boardDescriptionFallbackList.count(); i++) {
             const BoardRegExpFallback_t& boardFallback = _boardDescriptionFallbackList[i];
 
-            if (description().contains(QRegExp(boardFallback.regExp, Qt::CaseInsensitive))) {
+            if (description().contains(boardFallback.regExp)) {
 #ifndef __android
                 if (boardFallback.androidOnly) {
                     continue;
@@ -253,7 +274,7 @@ bool QGCSerialPortInfo::getBoardInfo(QGCSerialPortInfo::BoardType_t& boardType,
         for (int i=0; i<_boardManufacturerFallbackList.count(); i++) {
             const BoardRegExpFallback_t& boardFallback = _boardManufacturerFallbackList[i];
 
-            if (manufacturer().contains(QRegExp(boardFallback.regExp, Qt::CaseInsensitive))) {
+            if (manufacturer().contains(boardFallback.regExp)) {
 #ifndef __android
                 if (boardFallback.androidOnly) {
                     continue;
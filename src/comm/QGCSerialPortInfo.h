@@ -16,6 +16,9 @@
     #include <QSerialPortInfo>
 #endif
 
+#include <QHash>
+#include <QRegularExpression>
+
 #include "QGCLoggingCategory.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCSerialPortInfoLog)
@@ -65,9 +68,9 @@ private:
     } BoardInfo_t;
 
     typedef struct {
-        QString     regExp;
-        BoardType_t boardType;
-        bool        androidOnly;
+        QRegularExpression  regExp;
+        BoardType_t         boardType;
+        bool                androidOnly;
     } BoardRegExpFallback_t;
 
     static void _loadJsonData(void);
@@ -90,5 +93,7 @@ private:
     static QList<BoardInfo_t>                   _boardInfoList;
     static QList<BoardRegExpFallback_t>         _boardDescriptionFallbackList;
     static QList<BoardRegExpFallback_t>         _boardManufacturerFallbackList;
+    static QHash<quint32, int>                  _boardInfoIndexByVidPid;    ///< key: vendorId << 16 | productId, value: First matching _boardInfoList index
+    static QHash<int, int>                      _boardInfoIndexByVid;       ///< key: vendorId, value: First _boardInfoList index which matches any product (productId 0)
 };
 
@@ -35,6 +35,10 @@ SerialLink::SerialLink(SharedLinkConfigurationPtr& config, bool isPX4Flow)
 {
     qCDebug(SerialLinkLog) << "Create SerialLink portName:baud:flowControl:parity:dataButs:stopBits" << _serialConfig->portName() << _serialConfig->baud() << _serialConfig->flowControl()
                            << _serialConfig->parity() << _serialConfig->dataBits() << _serialConfig->stopBits();
+
+    _readCoalesceTimer.setSingleShot(true);
+    _readCoalesceTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&_readCoalesceTimer, &QTimer::timeout, this, &SerialLink::_flushReadBuffer);
 }
 
 SerialLink::~SerialLink()
@@ -81,6 +85,8 @@ void SerialLink::disconnect(void)
     if (_port) {
         // This prevents stale signals from calling the link after it has been deleted
         QObject::disconnect(_port, &QIODevice::readyRead, this, &SerialLink::_readBytes);
+        _readCoalesceTimer.stop();
+        _receiveBuffer().resize(0);
         _port->close();
         _port->deleteLater();
         _port = nullptr;
@@ -237,10 +243,18 @@ void SerialLink::_readBytes(void)
     if (_port && _port->isOpen()) {
         qint64 byteCount = _port->bytesAvailable();
         if (byteCount) {
-            QByteArray buffer;
-            buffer.resize(byteCount);
-            _port->read(buffer.data(), buffer.size());
-            emit bytesReceived(this, buffer);
+            QByteArray& readBuffer = _receiveBuffer();
+            const int oldSize = readBuffer.size();
+            readBuffer.resize(oldSize + static_cast<int>(byteCount));
+            const qint64 bytesRead = _port->read(readBuffer.data() + oldSize, byteCount);
+            readBuffer.resize(oldSize + static_cast<int>(qMax(bytesRead, static_cast<qint64>(0))));
+
+            const int coalesceMSecs = _serialConfig->readCoalesceMSecs();
+            if (coalesceMSecs <= 0 || readBuffer.size() >= _maxReadSliceBytes) {
+                _flushReadBuffer();
+            } else if (!_readCoalesceTimer.isActive()) {
+                _readCoalesceTimer.start(coalesceMSecs);
+            }
         }
     } else {
         // Error occurred
@@ -249,6 +263,15 @@ void SerialLink::_readBytes(void)
     }
 }
 
+void SerialLink::_flushReadBuffer(void)
+{
+    _readCoalesceTimer.stop();
+    if (!_receiveBuffer().isEmpty()) {
+        // The next read starts a new buffer from the pool
+        _emitReceiveBuffer();
+    }
+}
+
 void SerialLink::linkError(QSerialPort::SerialPortError error)
 {
     switch (error) {
@@ -297,6 +320,7 @@ SerialConfiguration::SerialConfiguration(const QString& name) : LinkConfiguratio
     _dataBits   = 8;
     _stopBits   = 1;
     _usbDirect  = false;
+    _readCoalesceMSecs = 5;
 }
 
 SerialConfiguration::SerialConfiguration(SerialConfiguration* copy) : LinkConfiguration(copy)
@@ -309,6 +333,7 @@ SerialConfiguration::SerialConfiguration(SerialConfiguration* copy) : LinkConfig
     _portName           = copy->portName();
     _portDisplayName    = copy->portDisplayName();
     _usbDirect          = copy->_usbDirect;
+    _readCoalesceMSecs  = copy->_readCoalesceMSecs;
 }
 
 void SerialConfiguration::copyFrom(LinkConfiguration *source)
@@ -324,6 +349,7 @@ void SerialConfiguration::copyFrom(LinkConfiguration *source)
         _portName           = ssource->portName();
         _portDisplayName    = ssource->portDisplayName();
         _usbDirect          = ssource->_usbDirect;
+        _readCoalesceMSecs  = ssource->_readCoalesceMSecs;
     } else {
         qWarning() << "Internal error";
     }
@@ -386,6 +412,7 @@ void SerialConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue("parity",         _parity);
     settings.setValue("portName",       _portName);
     settings.setValue("portDisplayName",_portDisplayName);
+    settings.setValue("readCoalesceMSecs", _readCoalesceMSecs);
     settings.endGroup();
 }
 
@@ -399,6 +426,7 @@ void SerialConfiguration::loadSettings(QSettings& settings, const QString& root)
     if(settings.contains("parity"))         _parity         = settings.value("parity").toInt();
     if(settings.contains("portName"))       _portName       = settings.value("portName").toString();
     if(settings.contains("portDisplayName"))_portDisplayName= settings.value("portDisplayName").toString();
+    if(settings.contains("readCoalesceMSecs")) _readCoalesceMSecs = settings.value("readCoalesceMSecs").toInt();
     settings.endGroup();
 }
 
@@ -460,6 +488,15 @@ void SerialConfiguration::_initBaudRates()
     });
 }
 
+void SerialConfiguration::setReadCoalesceMSecs(int readCoalesceMSecs)
+{
+    // No effect on a running connection until its next read
+    if (_readCoalesceMSecs != readCoalesceMSecs) {
+        _readCoalesceMSecs = readCoalesceMSecs;
+        emit readCoalesceMSecsChanged();
+    }
+}
+
 void SerialConfiguration::setUsbDirect(bool usbDirect)
 {
     if (_usbDirect != usbDirect) {
@@ -51,6 +51,7 @@ public:
     Q_PROPERTY(QString  portName        READ portName           WRITE setPortName           NOTIFY portNameChanged)
     Q_PROPERTY(QString  portDisplayName READ portDisplayName                                NOTIFY portDisplayNameChanged)
     Q_PROPERTY(bool     usbDirect       READ usbDirect          WRITE setUsbDirect          NOTIFY usbDirectChanged)        ///< true: direct usb connection to board
+    Q_PROPERTY(int      readCoalesceMSecs READ readCoalesceMSecs WRITE setReadCoalesceMSecs NOTIFY readCoalesceMSecsChanged) ///< 0: low latency, pass on each read
 
     int  baud() const        { return _baud; }
     int  dataBits() const    { return _dataBits; }
@@ -58,6 +59,7 @@ public:
     int  stopBits() const    { return _stopBits; }
     int  parity() const      { return _parity; }         ///< QSerialPort Enums
     bool usbDirect() const   { return _usbDirect; }
+    int  readCoalesceMSecs() const { return _readCoalesceMSecs; }
 
     const QString portName          () { return _portName; }
     const QString portDisplayName   () { return _portDisplayName; }
@@ -69,6 +71,7 @@ public:
     void setParity          (int parity);               ///< QSerialPort Enums
     void setPortName        (const QString& portName);
     void setUsbDirect       (bool usbDirect);
+    void setReadCoalesceMSecs(int readCoalesceMSecs);
 
     static QStringList supportedBaudRates();
     static QString cleanPortDisplayname(const QString name);
@@ -91,6 +94,7 @@ signals:
     void portNameChanged        ();
     void portDisplayNameChanged ();
     void usbDirectChanged       (bool usbDirect);
+    void readCoalesceMSecsChanged(void);
 
 private:
     static void _initBaudRates();
@@ -103,6 +107,7 @@ private:
     QString _portName;
     QString _portDisplayName;
     bool _usbDirect;
+    int _readCoalesceMSecs;
 };
 
 class SerialLink : public LinkInterface
@@ -128,6 +133,7 @@ public slots:
 
 private slots:
     void _readBytes     (void);
+    void _flushReadBuffer(void);
 
 private:
 
@@ -148,5 +154,12 @@ private:
     QByteArray              _transmitBuffer;                ///< An internal buffer for receiving data from member functions and actually transmitting them via the serial port.
     SerialConfiguration*    _serialConfig       = nullptr;
 
+    // Reads are collected in the link receive buffer for up to readCoalesceMSecs, or until _maxReadSliceBytes are
+    // waiting, and passed on as one bytesReceived. At high baud rates this replaces a flood of small buffers and
+    // signals with a few large ones.
+    QTimer                  _readCoalesceTimer;
+
+    static const int        _maxReadSliceBytes  = 4096;
+
 };
 
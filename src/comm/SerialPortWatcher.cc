@@ -0,0 +1,212 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SerialPortWatcher.h"
+
+#include <QCoreApplication>
+#include <QDir>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <dbt.h>
+#endif
+
+#if defined(Q_OS_MACOS)
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOKitLib.h>
+#include <IOKit/serial/IOSerialKeys.h>
+#endif
+
+#ifdef __android__
+#include <QtAndroidExtras/QtAndroidExtras>
+#include <QtAndroidExtras/QAndroidJniObject>
+static const char kJniClassName[] {"org/mavlink/qgroundcontrol/QGCActivity"};
+#endif
+
+QGC_LOGGING_CATEGORY(SerialPortWatcherLog, "SerialPortWatcherLog")
+
+SerialPortWatcher* SerialPortWatcher::_instance = nullptr;
+
+SerialPortWatcher::SerialPortWatcher(QObject* parent)
+    : QObject(parent)
+{
+    _instance = this;
+
+    _settleTimer.setSingleShot(true);
+    _settleTimer.setInterval(_settleMSecs);
+    connect(&_settleTimer, &QTimer::timeout, this, &SerialPortWatcher::portsChanged);
+
+#if defined(Q_OS_WIN)
+    // WM_DEVICECHANGE is broadcast to all top level windows, no registration needed for port arrival and removal
+    QCoreApplication::instance()->installNativeEventFilter(this);
+    _active = true;
+#elif defined(Q_OS_MACOS)
+    IONotificationPortRef notifyPort = IONotificationPortCreate(MACH_PORT_NULL);
+    if (notifyPort) {
+        _ioKitNotifyPort = notifyPort;
+        CFRunLoopAddSource(CFRunLoopGetMain(), IONotificationPortGetRunLoopSource(notifyPort), kCFRunLoopDefaultMode);
+
+        // IOServiceAddMatchingNotification consumes a reference to the matching dictionary, so each call needs its own
+        io_iterator_t addedIter = 0;
+        io_iterator_t removedIter = 0;
+        kern_return_t addedResult = IOServiceAddMatchingNotification(notifyPort, kIOFirstMatchNotification, IOServiceMatching(kIOSerialBSDServiceValue), _ioKitNotification, this, &addedIter);
+        kern_return_t removedResult = IOServiceAddMatchingNotification(notifyPort, kIOTerminatedNotification, IOServiceMatching(kIOSerialBSDServiceValue), _ioKitNotification, this, &removedIter);
+        _ioKitAddedIter = addedIter;
+        _ioKitRemovedIter = removedIter;
+
+        if (addedResult == KERN_SUCCESS && removedResult == KERN_SUCCESS) {
+            // Iterators must be drained to arm the notifications. The existing ports are picked up by the first enumeration.
+            _ioKitNotification(nullptr, _ioKitAddedIter);
+            _ioKitNotification(nullptr, _ioKitRemovedIter);
+            _active = true;
+        } else {
+            qCWarning(SerialPortWatcherLog) << "IOServiceAddMatchingNotification failed" << addedResult << removedResult;
+        }
+    }
+#elif defined(__android__)
+    // Driven by the USB attach/detach broadcasts received in QGCActivity
+    _active = true;
+#elif defined(Q_OS_LINUX)
+    // Device nodes for ttyUSB/ttyACM are created and removed by udev, so a change to /dev is a change to the port list
+    connect(&_devWatcher, &QFileSystemWatcher::directoryChanged, this, &SerialPortWatcher::_portsChanged);
+    _active = _devWatcher.addPath(QStringLiteral("/dev"));
+    if (QDir(QStringLiteral("/dev/serial/by-id")).exists()) {
+        _devWatcher.addPath(QStringLiteral("/dev/serial/by-id"));
+    }
+#endif
+
+    qCDebug(SerialPortWatcherLog) << "Port change notifications" << (_active ? "active" : "not available, polling");
+}
+
+SerialPortWatcher::~SerialPortWatcher()
+{
+#if defined(Q_OS_WIN)
+    QCoreApplication::instance()->removeNativeEventFilter(this);
+#elif defined(Q_OS_MACOS)
+    if (_ioKitAddedIter) {
+        IOObjectRelease(_ioKitAddedIter);
+    }
+    if (_ioKitRemovedIter) {
+        IOObjectRelease(_ioKitRemovedIter);
+    }
+    if (_ioKitNotifyPort) {
+        IONotificationPortRef notifyPort = static_cast<IONotificationPortRef>(_ioKitNotifyPort);
+        CFRunLoopRemoveSource(CFRunLoopGetMain(), IONotificationPortGetRunLoopSource(notifyPort), kCFRunLoopDefaultMode);
+        IONotificationPortDestroy(notifyPort);
+    }
+#endif
+
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+void SerialPortWatcher::_portsChanged(void)
+{
+    // Restarting the timer coalesces the burst of notifications from a single device
+    _settleTimer.start();
+}
+
+bool SerialPortWatcher::nativeEventFilter(const QByteArray& eventType, void* message, long* result)
+{
+    Q_UNUSED(result);
+
+#if defined(Q_OS_WIN)
+    if (eventType == "windows_generic_MSG") {
+        MSG* msg = static_cast<MSG*>(message);
+        if (msg->message == WM_DEVICECHANGE) {
+            switch (msg->wParam) {
+            case DBT_DEVICEARRIVAL:
+            case DBT_DEVICEREMOVECOMPLETE:
+            case DBT_DEVNODES_CHANGED:
+                qCDebug(SerialPortWatcherLog) << "WM_DEVICECHANGE" << msg->wParam;
+                _portsChanged();
+                break;
+            default:
+                break;
+            }
+        }
+    }
+#else
+    Q_UNUSED(eventType);
+    Q_UNUSED(message);
+#endif
+
+    // Never consume the message, other filters and Qt itself may need it
+    return false;
+}
+
+#if defined(Q_OS_MACOS)
+void SerialPortWatcher::_ioKitNotification(void* refCon, unsigned int iterator)
+{
+    io_object_t service;
+    while ((service = IOIteratorNext(iterator))) {
+        IOObjectRelease(service);
+    }
+
+    // Called from the main run loop
+    SerialPortWatcher* watcher = static_cast<SerialPortWatcher*>(refCon);
+    if (watcher) {
+        qCDebug(SerialPortWatcherLog) << "IOKit serial service notification";
+        watcher->_portsChanged();
+    }
+}
+#endif
+
+#ifdef __android__
+void SerialPortWatcher::_jniUpdateAvailableSerialPorts(JNIEnv* envA, jobject thizA)
+{
+    Q_UNUSED(envA);
+    Q_UNUSED(thizA);
+
+    // Called from the Android UI thread
+    if (_instance) {
+        qCDebug(SerialPortWatcherLog) << "jniUpdateAvailableSerialPorts triggered";
+        QMetaObject::invokeMethod(_instance, [] () {
+            if (_instance) {
+                _instance->_portsChanged();
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void SerialPortWatcher::setNativeMethods(void)
+{
+    qCDebug(SerialPortWatcherLog) << "Registering Native Functions";
+
+    JNINativeMethod javaMethods[] {
+        {"nativeUpdateAvailableSerialPorts", "()V", reinterpret_cast<void *>(_jniUpdateAvailableSerialPorts)}
+    };
+
+    QAndroidJniEnvironment jniEnv;
+    if (jniEnv->ExceptionCheck()) {
+        jniEnv->ExceptionDescribe();
+        jniEnv->ExceptionClear();
+    }
+
+    jclass objectClass = jniEnv->FindClass(kJniClassName);
+    if (!objectClass) {
+        jniEnv->ExceptionClear();
+        qWarning() << "Couldn't find class:" << kJniClassName;
+        return;
+    }
+
+    jint val = jniEnv->RegisterNatives(objectClass, javaMethods, sizeof(javaMethods) / sizeof(javaMethods[0]));
+    if (val < 0) {
+        qWarning() << "Error registering methods: " << val;
+    } else {
+        qCDebug(SerialPortWatcherLog) << "Native Functions Registered";
+    }
+
+    if (jniEnv->ExceptionCheck()) {
+        jniEnv->ExceptionDescribe();
+        jniEnv->ExceptionClear();
+    }
+}
+#endif
@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QAbstractNativeEventFilter>
+
+#if defined(Q_OS_LINUX) && !defined(__android__)
+#include <QFileSystemWatcher>
+#endif
+#ifdef __android__
+#include <jni.h>
+#endif
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(SerialPortWatcherLog)
+
+/// Signals when serial ports are plugged in or removed, so the port list only needs to be enumerated when it changed.
+/// Uses the device arrival/removal notifications of the OS: WM_DEVICECHANGE on Windows, IOKit serial service
+/// notifications on macOS, changes to /dev on Linux and the USB attach/detach broadcasts on Android.
+/// Notifications arrive in bursts while a device enumerates, they are coalesced into a single portsChanged signal.
+class SerialPortWatcher : public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+
+public:
+    SerialPortWatcher(QObject* parent = nullptr);
+    ~SerialPortWatcher();
+
+    /// @return true: Port changes are signalled, false: No notifications available on this platform, ports must be polled
+    bool active(void) const { return _active; }
+
+    // Overrides from QAbstractNativeEventFilter
+    bool nativeEventFilter(const QByteArray& eventType, void* message, long* result) override;
+
+#ifdef __android__
+    static void setNativeMethods(void);
+#endif
+
+signals:
+    void portsChanged(void);
+
+private:
+    void _portsChanged(void);
+
+#if defined(Q_OS_MACOS)
+    static void _ioKitNotification(void* refCon, unsigned int iterator);
+#endif
+#ifdef __android__
+    static void _jniUpdateAvailableSerialPorts(JNIEnv* envA, jobject thizA);
+#endif
+
+    bool                    _active = false;
+    QTimer                  _settleTimer;
+#if defined(Q_OS_LINUX) && !defined(__android__)
+    QFileSystemWatcher      _devWatcher;
+#endif
+#if defined(Q_OS_MACOS)
+    void*                   _ioKitNotifyPort    = nullptr;
+    unsigned int            _ioKitAddedIter     = 0;
+    unsigned int            _ioKitRemovedIter   = 0;
+#endif
+
+    static SerialPortWatcher*   _instance;
+    static const int            _settleMSecs = 250;
+};
@@ -25,6 +25,10 @@ TCPLink::TCPLink(SharedLinkConfigurationPtr& config)
     , _socketIsConnected(false)
 {
     Q_ASSERT(_tcpConfig);
+
+    _writeCoalesceTimer.setSingleShot(true);
+    _writeCoalesceTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&_writeCoalesceTimer, &QTimer::timeout, this, &TCPLink::_flushWriteBuffer);
 }
 
 TCPLink::~TCPLink()
@@ -63,21 +67,41 @@ void TCPLink::_writeBytes(const QByteArray data)
 #endif
 
     if (_socket) {
-        _socket->write(data);
+        const int coalesceMSecs = _tcpConfig->writeCoalesceMSecs();
+        if (coalesceMSecs <= 0 && _writeBuffer.isEmpty()) {
+            _socket->write(data);
+        } else {
+            _writeBuffer.append(data);
+            if (coalesceMSecs <= 0 || _writeBuffer.size() >= _maxWriteSliceBytes) {
+                _flushWriteBuffer();
+            } else if (!_writeCoalesceTimer.isActive()) {
+                _writeCoalesceTimer.start(coalesceMSecs);
+            }
+        }
         emit bytesSent(this, data);
     }
 }
 
+void TCPLink::_flushWriteBuffer(void)
+{
+    _writeCoalesceTimer.stop();
+    if (_socket && !_writeBuffer.isEmpty()) {
+        _socket->write(_writeBuffer);
+    }
+    _writeBuffer.clear();
+}
+
 void TCPLink::_readBytes()
 {
     if (_socket) {
         qint64 byteCount = _socket->bytesAvailable();
         if (byteCount)
         {
-            QByteArray buffer;
-            buffer.resize(byteCount);
-            _socket->read(buffer.data(), buffer.size());
-            emit bytesReceived(this, buffer);
+            // One read for everything waiting, readyRead may cover several segments
+            QByteArray& buffer = _receiveBuffer();
+            buffer.resize(static_cast<int>(byteCount));
+            buffer.resize(static_cast<int>(qMax(_socket->read(buffer.data(), buffer.size()), static_cast<qint64>(0))));
+            _emitReceiveBuffer();
 #ifdef TCPLINK_READWRITE_DEBUG
             writeDebugBytes(buffer.data(), buffer.size());
 #endif
@@ -90,6 +114,7 @@ void TCPLink::disconnect(void)
     if (_socket) {
         // This prevents stale signal from calling the link after it has been deleted
         QObject::disconnect(_socket, &QIODevice::readyRead, this, &TCPLink::_readBytes);
+        _flushWriteBuffer();
         _socketIsConnected = false;
         _socket->disconnectFromHost(); // Disconnect tcp
         _socket->deleteLater(); // Make sure delete happens on correct thread
@@ -131,6 +156,16 @@ bool TCPLink::_hardwareConnect()
         _socket = nullptr;
         return false;
     }
+    _socket->setSocketOption(QAbstractSocket::LowDelayOption, _tcpConfig->noDelay() ? 1 : 0);
+    if (_tcpConfig->sendBufferSize() > 0) {
+        _socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, _tcpConfig->sendBufferSize());
+    }
+    if (_tcpConfig->receiveBufferSize() > 0) {
+        _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, _tcpConfig->receiveBufferSize());
+    }
+    qCDebug(LinkInterfaceLog) << "TCPLink connected noDelay:sendBuffer:receiveBuffer:writeCoalesce" << _tcpConfig->noDelay()
+                              << _tcpConfig->sendBufferSize() << _tcpConfig->receiveBufferSize() << _tcpConfig->writeCoalesceMSecs();
+
     _socketIsConnected = true;
     emit connected();
     return true;
@@ -165,6 +200,10 @@ TCPConfiguration::TCPConfiguration(TCPConfiguration* source) : LinkConfiguration
 {
     _port    = source->port();
     _host    = source->host();
+    _noDelay            = source->noDelay();
+    _sendBufferSize     = source->sendBufferSize();
+    _receiveBufferSize  = source->receiveBufferSize();
+    _writeCoalesceMSecs = source->writeCoalesceMSecs();
 }
 
 void TCPConfiguration::copyFrom(LinkConfiguration *source)
@@ -174,6 +213,10 @@ void TCPConfiguration::copyFrom(LinkConfiguration *source)
     Q_ASSERT(usource != nullptr);
     _port    = usource->port();
     _host = usource->host();
+    _noDelay            = usource->noDelay();
+    _sendBufferSize     = usource->sendBufferSize();
+    _receiveBufferSize  = usource->receiveBufferSize();
+    _writeCoalesceMSecs = usource->writeCoalesceMSecs();
 }
 
 void TCPConfiguration::setPort(quint16 port)
@@ -186,11 +229,47 @@ void TCPConfiguration::setHost(const QString host)
     _host = host;
 }
 
+void TCPConfiguration::setNoDelay(bool noDelay)
+{
+    if (_noDelay != noDelay) {
+        _noDelay = noDelay;
+        emit noDelayChanged();
+    }
+}
+
+void TCPConfiguration::setSendBufferSize(int sendBufferSize)
+{
+    if (_sendBufferSize != sendBufferSize) {
+        _sendBufferSize = sendBufferSize;
+        emit sendBufferSizeChanged();
+    }
+}
+
+void TCPConfiguration::setReceiveBufferSize(int receiveBufferSize)
+{
+    if (_receiveBufferSize != receiveBufferSize) {
+        _receiveBufferSize = receiveBufferSize;
+        emit receiveBufferSizeChanged();
+    }
+}
+
+void TCPConfiguration::setWriteCoalesceMSecs(int writeCoalesceMSecs)
+{
+    if (_writeCoalesceMSecs != writeCoalesceMSecs) {
+        _writeCoalesceMSecs = writeCoalesceMSecs;
+        emit writeCoalesceMSecsChanged();
+    }
+}
+
 void TCPConfiguration::saveSettings(QSettings& settings, const QString& root)
 {
     settings.beginGroup(root);
     settings.setValue("port", (int)_port);
     settings.setValue("host", _host);
+    settings.setValue("noDelay",            _noDelay);
+    settings.setValue("sendBufferSize",     _sendBufferSize);
+    settings.setValue("receiveBufferSize",  _receiveBufferSize);
+    settings.setValue("writeCoalesceMSecs", _writeCoalesceMSecs);
     settings.endGroup();
 }
 
@@ -199,5 +278,9 @@ void TCPConfiguration::loadSettings(QSettings& settings, const QString& root)
     settings.beginGroup(root);
     _port = (quint16)settings.value("port", QGC_TCP_PORT).toUInt();
     _host = settings.value("host", _host).toString();
+    _noDelay            = settings.value("noDelay",             _noDelay).toBool();
+    _sendBufferSize     = settings.value("sendBufferSize",      _sendBufferSize).toInt();
+    _receiveBufferSize  = settings.value("receiveBufferSize",   _receiveBufferSize).toInt();
+    _writeCoalesceMSecs = settings.value("writeCoalesceMSecs",  _writeCoalesceMSecs).toInt();
     settings.endGroup();
 }
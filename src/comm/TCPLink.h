@@ -13,6 +13,7 @@
 #include <QList>
 #include <QMap>
 #include <QMutex>
+#include <QTimer>
 #include <QHostAddress>
 #include <LinkInterface.h>
 #include "QGCConfig.h"
@@ -38,6 +39,10 @@ public:
 
     Q_PROPERTY(quint16 port READ port WRITE setPort NOTIFY portChanged)
     Q_PROPERTY(QString host READ host WRITE setHost NOTIFY hostChanged)
+    Q_PROPERTY(bool    noDelay              READ noDelay            WRITE setNoDelay            NOTIFY noDelayChanged)              ///< true: TCP_NODELAY, Nagle off
+    Q_PROPERTY(int     sendBufferSize       READ sendBufferSize     WRITE setSendBufferSize     NOTIFY sendBufferSizeChanged)       ///< Bytes, 0: system default
+    Q_PROPERTY(int     receiveBufferSize    READ receiveBufferSize  WRITE setReceiveBufferSize  NOTIFY receiveBufferSizeChanged)    ///< Bytes, 0: system default
+    Q_PROPERTY(int     writeCoalesceMSecs   READ writeCoalesceMSecs WRITE setWriteCoalesceMSecs NOTIFY writeCoalesceMSecsChanged)   ///< 0: write each message right away
 
     TCPConfiguration(const QString& name);
     TCPConfiguration(TCPConfiguration* source);
@@ -47,6 +52,15 @@ public:
     void                setPort     (quint16 port);
     void                setHost     (const QString host);
 
+    bool    noDelay             (void) const { return _noDelay; }
+    int     sendBufferSize      (void) const { return _sendBufferSize; }
+    int     receiveBufferSize   (void) const { return _receiveBufferSize; }
+    int     writeCoalesceMSecs  (void) const { return _writeCoalesceMSecs; }
+    void    setNoDelay          (bool noDelay);
+    void    setSendBufferSize   (int sendBufferSize);
+    void    setReceiveBufferSize(int receiveBufferSize);
+    void    setWriteCoalesceMSecs(int writeCoalesceMSecs);
+
     //LinkConfiguration overrides
     LinkType    type                (void) override                                         { return LinkConfiguration::TypeTcp; }
     void        copyFrom            (LinkConfiguration* source) override;
@@ -58,10 +72,18 @@ public:
 signals:
     void portChanged(void);
     void hostChanged(void);
+    void noDelayChanged             (void);
+    void sendBufferSizeChanged      (void);
+    void receiveBufferSizeChanged   (void);
+    void writeCoalesceMSecsChanged  (void);
 
 private:
     QString         _host;
     quint16         _port;
+    bool            _noDelay            = false;
+    int             _sendBufferSize     = 0;
+    int             _receiveBufferSize  = 0;
+    int             _writeCoalesceMSecs = 0;
 };
 
 class TCPLink : public LinkInterface
@@ -82,6 +104,7 @@ public:
 private slots:
     void _socketError   (QAbstractSocket::SocketError socketError);
     void _readBytes     (void);
+    void _flushWriteBuffer(void);
 
     // LinkInterface overrides
     void _writeBytes(const QByteArray data) override;
@@ -107,5 +130,12 @@ private:
     quint64 _bitsReceivedMax;
     quint64 _connectionStartTime;
     QMutex  _statisticsMutex;
+
+    // With writeCoalesceMSecs set, writes are collected for that long, or until _maxWriteSliceBytes are waiting, and
+    // written to the socket at once so a cellular link does not see a stream of tiny segments
+    QByteArray  _writeBuffer;
+    QTimer      _writeCoalesceTimer;
+
+    static const int _maxWriteSliceBytes = 1400;    ///< Fits a typical TCP segment
 };
 
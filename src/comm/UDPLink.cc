@@ -16,10 +16,23 @@
 #include <QNetworkInterface>
 #include <iostream>
 #include <QHostInfo>
+#include <QThread>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#endif
 
 #include "UDPLink.h"
+#include "MAVLinkFrameScanner.h"
 #include "QGC.h"
 #include "QGCApplication.h"
+#include "LinkReactorPool.h"
 #include "SettingsManager.h"
 #include "AutoConnectSettings.h"
 
@@ -65,12 +78,42 @@ static bool contains_target(const QList<UDPCLient*> list, const QHostAddress& ad
     return false;
 }
 
+#if defined(Q_OS_LINUX)
+/// @return Non-blocking IPv4 socket bound to port with SO_REUSEPORT, -1 on failure
+static int bind_reuse_port(quint16 port)
+{
+    int socket = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket < 0) {
+        return -1;
+    }
+    int one = 1;
+    ::setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+        ::close(socket);
+        return -1;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(socket);
+        return -1;
+    }
+    return socket;
+}
+#endif
+
 UDPLink::UDPLink(SharedLinkConfigurationPtr& config)
     : LinkInterface     (config)
     , _running          (false)
     , _socket           (nullptr)
     , _udpConfig        (qobject_cast<UDPConfiguration*>(config.get()))
     , _connectState     (false)
+    , _sysidPeers       (256, 0)
+    , _flushTimer       (new QTimer(this))
 #if defined(QGC_ZEROCONF_ENABLED)
     , _dnssServiceRef   (nullptr)
 #endif
@@ -83,7 +126,10 @@ UDPLink::UDPLink(SharedLinkConfigurationPtr& config)
         QHostAddress &address = allAddresses[i];
         _localAddresses.append(QHostAddress(address));
     }
-    moveToThread(this);
+    // Batched writes are flushed once the link thread has worked through its queued writes
+    _flushTimer->setSingleShot(true);
+    _flushTimer->setInterval(0);
+    QObject::connect(_flushTimer, &QTimer::timeout, this, &UDPLink::_flushWrites);
 }
 
 UDPLink::~UDPLink()
@@ -94,20 +140,38 @@ UDPLink::~UDPLink()
     // Clear client list
     qDeleteAll(_sessionTargets);
     _sessionTargets.clear();
-    quit();
-    // Wait for it to exit
-    wait();
+    _sessionTargetKeys.clear();
     this->deleteLater();
 }
 
-void UDPLink::run()
+/// Runs on the reactor once the link is pinned to it
+void UDPLink::_startOnReactor(void)
 {
+    if (!_running) {
+        // Disconnected before the reactor got to it
+        return;
+    }
     if (_hardwareConnect()) {
-        exec();
+        _startReceiveShards();
+    } else {
+        // Nothing left to run on the reactor
+        qgcApp()->linkReactorPool()->unpin(this, [this]() { _stopOnReactor(); });
     }
+}
+
+/// Runs on the reactor before the link leaves it
+void UDPLink::_stopOnReactor(void)
+{
+    _stopReceiveShards();
+    _flushWrites();
     if (_socket) {
         _deregisterZeroconf();
         _socket->close();
+        // This prevents stale signal from calling the link after it has been deleted
+        QObject::disconnect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+        delete _socket;
+        _socket = nullptr;
+        _socketClosed = true;
     }
 }
 
@@ -144,19 +208,27 @@ void UDPLink::_writeBytes(const QByteArray data)
     }
     emit bytesSent(this, data);
 
+    if (_udpConfig->batchWrites()) {
+        _queueWrite(data);
+        return;
+    }
+
     QMutexLocker locker(&_sessionTargetsMutex);
+    quint64 routedPeer = _routedPeer(data);
 
     // Send to all manually targeted systems
     for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
         UDPCLient* target = _udpConfig->targetHosts()[i];
         // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
+        if(!_isSessionTarget(target)) {
             _writeDataGram(data, target);
         }
     }
-    // Send to all connected systems
+    // Send to all connected systems, or only the one the target system is behind
     for(UDPCLient* target: _sessionTargets) {
-        _writeDataGram(data, target);
+        if (_routedToTarget(routedPeer, target)) {
+            _writeDataGram(data, target);
+        }
     }
 }
 
@@ -168,63 +240,253 @@ void UDPLink::_writeDataGram(const QByteArray data, const UDPCLient* target)
     }
 }
 
+void UDPLink::_queueWrite(const QByteArray& data)
+{
+    QMutexLocker locker(&_sessionTargetsMutex);
+    quint64 routedPeer = _routedPeer(data);
+    locker.unlock();
+
+    // Only frames going to the same peers can share a datagram
+    if (_udpConfig->packFrames() && !_pendingDatagrams.isEmpty() && _pendingRoutedPeers.last() == routedPeer && _pendingDatagrams.last().size() + data.size() <= _maxPackedDatagramSize) {
+        _pendingDatagrams.last().append(data);
+    } else {
+        _pendingDatagrams.append(data);
+        _pendingRoutedPeers.append(routedPeer);
+    }
+
+    if (_pendingDatagrams.count() >= _maxPendingDatagrams) {
+        _flushWrites();
+    } else if (!_flushTimer->isActive()) {
+        _flushTimer->start();
+    }
+}
+
+void UDPLink::_flushWrites(void)
+{
+    _flushTimer->stop();
+    if (!_socket || _pendingDatagrams.isEmpty()) {
+        _pendingDatagrams.clear();
+        _pendingRoutedPeers.clear();
+        return;
+    }
+
+    QMutexLocker locker(&_sessionTargetsMutex);
+
+    // Send to all manually targeted systems
+    for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
+        UDPCLient* target = _udpConfig->targetHosts()[i];
+        // Skip it if it's part of the session clients below
+        if(!_isSessionTarget(target)) {
+            _writeDataGrams(_pendingDatagrams, target);
+        }
+    }
+    // Send to all connected systems. Routed datagrams only go to the peer their target system is behind.
+    bool allBroadcast = !_pendingRoutedPeers.count() || std::all_of(_pendingRoutedPeers.cbegin(), _pendingRoutedPeers.cend(), [](quint64 peer) { return peer == 0; });
+    for(UDPCLient* target: _sessionTargets) {
+        if (allBroadcast) {
+            _writeDataGrams(_pendingDatagrams, target);
+            continue;
+        }
+        QList<QByteArray> targetDatagrams;
+        for (int i=0; i<_pendingDatagrams.count(); i++) {
+            if (_routedToTarget(_pendingRoutedPeers[i], target)) {
+                targetDatagrams.append(_pendingDatagrams[i]);
+            }
+        }
+        if (!targetDatagrams.isEmpty()) {
+            _writeDataGrams(targetDatagrams, target);
+        }
+    }
+
+    _pendingDatagrams.clear();
+    _pendingRoutedPeers.clear();
+}
+
+void UDPLink::_writeDataGrams(const QList<QByteArray>& datagrams, const UDPCLient* target)
+{
+#if defined(Q_OS_LINUX)
+    // A single sendmmsg call sends the whole batch instead of one syscall per datagram
+    if (target->address.protocol() == QAbstractSocket::IPv4Protocol && datagrams.count() <= _maxPendingDatagrams) {
+        struct sockaddr_in  address;
+        struct mmsghdr      messages[_maxPendingDatagrams];
+        struct iovec        iovecs[_maxPendingDatagrams];
+
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(target->port);
+        address.sin_addr.s_addr = htonl(target->address.toIPv4Address());
+
+        memset(messages, 0, sizeof(messages[0]) * static_cast<size_t>(datagrams.count()));
+        for (int i=0; i<datagrams.count(); i++) {
+            iovecs[i].iov_base                  = const_cast<char*>(datagrams[i].constData());
+            iovecs[i].iov_len                   = static_cast<size_t>(datagrams[i].size());
+            messages[i].msg_hdr.msg_name        = &address;
+            messages[i].msg_hdr.msg_namelen     = sizeof(address);
+            messages[i].msg_hdr.msg_iov         = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen      = 1;
+        }
+
+        int socket  = static_cast<int>(_socket->socketDescriptor());
+        int sent    = 0;
+        while (sent < datagrams.count()) {
+            int result = ::sendmmsg(socket, &messages[sent], static_cast<unsigned int>(datagrams.count() - sent), 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                qWarning() << "Error writing to" << target->address << target->port << strerror(errno);
+                return;
+            }
+            sent += result;
+        }
+        return;
+    }
+#endif
+
+    for (const QByteArray& datagram: datagrams) {
+        _writeDataGram(datagram, target);
+    }
+}
+
 void UDPLink::readBytes()
 {
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
     while (_socket->hasPendingDatagrams())
     {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
+        // Datagrams are read straight into a pooled buffer, several of them are sent over together
+        QByteArray& databuffer  = _receiveBuffer();
+        const int   offset      = databuffer.size();
+        const int   pending     = static_cast<int>(qMax(_socket->pendingDatagramSize(), static_cast<qint64>(0)));
+        databuffer.resize(offset + pending);
         QHostAddress sender;
         quint16 senderPort;
         // If the other end is reset then it will still report data available,
         // but will fail on the readDatagram call
-        qint64 slen = _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        qint64 slen = _socket->readDatagram(databuffer.data() + offset, pending, &sender, &senderPort);
         if (slen == -1) {
+            databuffer.resize(offset);
             break;
         }
-        databuffer.append(datagram);
+        databuffer.resize(offset + static_cast<int>(slen));
+        int sysid = -1;
+        int targetSystem;
+        MAVLinkFrameScanner::peekRouting(reinterpret_cast<const uint8_t*>(databuffer.constData()) + offset, static_cast<int>(slen), sysid, targetSystem);
         //-- Wait a bit before sending it over
         if (databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
-        }
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
+            _emitReceiveBuffer();
         }
-        QMutexLocker locker(&_sessionTargetsMutex);
-        if (!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
+        // Nearly all datagrams come from the same sender and system as the previous one
+        if (sender == _lastSender && senderPort == _lastSenderPort && sysid == _lastSysid) {
+            continue;
         }
-        locker.unlock();
+        _lastSender     = sender;
+        _lastSenderPort = senderPort;
+        _lastSysid      = sysid;
+        _addSessionTarget(sender, senderPort, sysid);
     }
     //-- Send whatever is left
-    if (databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+    if (!_receiveBuffer().isEmpty()) {
+        _emitReceiveBuffer();
+    }
+}
+
+quint64 UDPLink::_peerKey(const QHostAddress& address, quint16 port)
+{
+    // The link is bound to IPv4 only
+    return (static_cast<quint64>(address.toIPv4Address()) << 16) | port;
+}
+
+/// Thread safe, also called from the receive shard threads
+///     @param sysid System id the datagram came from, -1 if unknown. Replies to it are routed to this sender.
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort, int sysid)
+{
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    quint64 key = _peerKey(asender, senderPort);
+    QMutexLocker locker(&_sessionTargetsMutex);
+    if (!_sessionTargetKeys.contains(key)) {
+        qDebug() << "Adding target" << asender << senderPort;
+        _sessionTargets.append(new UDPCLient(asender, senderPort));
+        _sessionTargetKeys.insert(key);
+    }
+    if (sysid > 0 && sysid < _sysidPeers.count() && _sysidPeers[sysid] != key) {
+        qDebug() << "Routing system" << sysid << "to" << asender << senderPort;
+        _sysidPeers[sysid] = key;
     }
 }
 
+/// Must be called with _sessionTargetsMutex held
+/// @return _peerKey of the only session target data needs to go to, 0 to send it to all of them
+quint64 UDPLink::_routedPeer(const QByteArray& data) const
+{
+    int sysid;
+    int targetSystem;
+    int frameLength = MAVLinkFrameScanner::peekRouting(reinterpret_cast<const uint8_t*>(data.constData()), data.size(), sysid, targetSystem);
+    if (frameLength != data.size() || targetSystem <= 0 || targetSystem >= _sysidPeers.count()) {
+        // More than one frame, broadcast or unknown, everyone gets it
+        return 0;
+    }
+    return _sysidPeers[targetSystem];
+}
+
+bool UDPLink::_routedToTarget(quint64 routedPeer, const UDPCLient* target) const
+{
+    return routedPeer == 0 || routedPeer == _peerKey(target->address, target->port);
+}
+
+/// Must be called with _sessionTargetsMutex held
+bool UDPLink::_isSessionTarget(const UDPCLient* target) const
+{
+    return _sessionTargetKeys.contains(_peerKey(target->address, target->port));
+}
+
+/// Opens the additional SO_REUSEPORT sockets requested by the configuration, each with its own thread
+void UDPLink::_startReceiveShards(void)
+{
+#if defined(Q_OS_LINUX)
+    for (int i=1; i<_udpConfig->receiveThreads(); i++) {
+        int socket = bind_reuse_port(_udpConfig->localPort());
+        if (socket < 0) {
+            qWarning() << "UDP: Unable to open additional receive socket" << _udpConfig->localPort() << strerror(errno);
+            break;
+        }
+
+        QThread*         thread = new QThread();
+        UDPReceiveShard* shard  = new UDPReceiveShard(this, socket);
+        shard->moveToThread(thread);
+        QObject::connect(thread, &QThread::started,  shard, &UDPReceiveShard::start);
+        QObject::connect(thread, &QThread::finished, shard, &QObject::deleteLater);
+        thread->setObjectName(QStringLiteral("UDPReceiveShard%1").arg(i));
+        thread->start(QThread::NormalPriority);
+        _receiveShardThreads.append(thread);
+    }
+#endif
+}
+
+void UDPLink::_stopReceiveShards(void)
+{
+    for (QThread* thread: _receiveShardThreads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+    _receiveShardThreads.clear();
+}
+
 void UDPLink::disconnect(void)
 {
     _running = false;
-    quit();
-    wait();
-    if (_socket) {
-        // This prevents stale signal from calling the link after it has been deleted
-        QObject::disconnect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
-        // Make sure delete happen on correct thread
-        _socket->deleteLater();
-        _socket = nullptr;
+    qgcApp()->linkReactorPool()->unpin(this, [this]() { _stopOnReactor(); });
+    if (_socketClosed) {
+        _socketClosed = false;
         emit disconnected();
     }
     _connectState = false;
@@ -232,13 +494,17 @@ void UDPLink::disconnect(void)
 
 bool UDPLink::_connect(void)
 {
-    if (this->isRunning() || _running) {
+    if (_running) {
+        // Reconnect, the socket is opened again on the reactor
         _running = false;
-        quit();
-        wait();
+        qgcApp()->linkReactorPool()->unpin(this, [this]() { _stopOnReactor(); });
     }
     _running = true;
-    start(NormalPriority);
+    if (!qgcApp()->linkReactorPool()->pin(this)) {
+        _running = false;
+        return false;
+    }
+    QMetaObject::invokeMethod(this, &UDPLink::_startOnReactor, Qt::QueuedConnection);
     return true;
 }
 
@@ -248,10 +514,23 @@ bool UDPLink::_hardwareConnect()
         delete _socket;
         _socket = nullptr;
     }
+    _socketClosed = false;
     QHostAddress host = QHostAddress::AnyIPv4;
     _socket = new QUdpSocket(this);
     _socket->setProxy(QNetworkProxy::NoProxy);
-    _connectState = _socket->bind(host, _udpConfig->localPort(), QAbstractSocket::ReuseAddressHint | QUdpSocket::ShareAddress);
+#if defined(Q_OS_LINUX)
+    if (_udpConfig->receiveThreads() > 1) {
+        // All sockets sharing the port need SO_REUSEPORT, which QUdpSocket::bind can't set
+        int socket = bind_reuse_port(_udpConfig->localPort());
+        _connectState = socket >= 0 && _socket->setSocketDescriptor(socket, QAbstractSocket::BoundState);
+        if (socket >= 0 && !_connectState) {
+            ::close(socket);
+        }
+    } else
+#endif
+    {
+        _connectState = _socket->bind(host, _udpConfig->localPort(), QAbstractSocket::ReuseAddressHint | QUdpSocket::ShareAddress);
+    }
     if (_connectState) {
         _socket->joinMulticastGroup(QHostAddress("224.0.0.1"));
         //-- Make sure we have a large enough IO buffers
@@ -344,6 +623,9 @@ void UDPConfiguration::_copyFrom(LinkConfiguration *source)
     auto* usource = qobject_cast<UDPConfiguration*>(source);
     if (usource) {
         _localPort = usource->localPort();
+        _batchWrites = usource->batchWrites();
+        _packFrames = usource->packFrames();
+        _receiveThreads = usource->receiveThreads();
         _clearTargetHosts();
         for (int i=0; i<usource->targetHosts().count(); i++) {
             UDPCLient* target = usource->targetHosts()[i];
@@ -417,10 +699,47 @@ void UDPConfiguration::setLocalPort(quint16 port)
     _localPort = port;
 }
 
+void UDPConfiguration::setBatchWrites(bool batchWrites)
+{
+    if (_batchWrites != batchWrites) {
+        _batchWrites = batchWrites;
+        emit batchWritesChanged(_batchWrites);
+    }
+}
+
+void UDPConfiguration::setPackFrames(bool packFrames)
+{
+    if (_packFrames != packFrames) {
+        _packFrames = packFrames;
+        emit packFramesChanged(_packFrames);
+    }
+}
+
+bool UDPConfiguration::receiveThreadsSupported(void) const
+{
+#if defined(Q_OS_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UDPConfiguration::setReceiveThreads(int receiveThreads)
+{
+    receiveThreads = qBound(1, receiveThreads, _maxReceiveThreads);
+    if (_receiveThreads != receiveThreads) {
+        _receiveThreads = receiveThreads;
+        emit receiveThreadsChanged(_receiveThreads);
+    }
+}
+
 void UDPConfiguration::saveSettings(QSettings& settings, const QString& root)
 {
     settings.beginGroup(root);
     settings.setValue("port", (int)_localPort);
+    settings.setValue("batchWrites", _batchWrites);
+    settings.setValue("packFrames", _packFrames);
+    settings.setValue("receiveThreads", _receiveThreads);
     settings.setValue("hostCount", _targetHosts.size());
     for (int i=0; i<_targetHosts.size(); i++) {
         UDPCLient* target = _targetHosts.at(i);
@@ -438,6 +757,9 @@ void UDPConfiguration::loadSettings(QSettings& settings, const QString& root)
     _clearTargetHosts();
     settings.beginGroup(root);
     _localPort = (quint16)settings.value("port", acSettings->udpListenPort()->rawValue().toInt()).toUInt();
+    _batchWrites = settings.value("batchWrites", true).toBool();
+    _packFrames = settings.value("packFrames", false).toBool();
+    _receiveThreads = qBound(1, settings.value("receiveThreads", 1).toInt(), _maxReceiveThreads);
     int hostCount = settings.value("hostCount", 0).toInt();
     for (int i=0; i<hostCount; i++) {
         QString hkey = QString("host%1").arg(i);
@@ -460,3 +782,70 @@ void UDPConfiguration::_updateHostList()
     }
     emit hostListChanged();
 }
+
+UDPReceiveShard::UDPReceiveShard(UDPLink* link, qintptr socketDescriptor)
+    : _link             (link)
+    , _socketDescriptor (socketDescriptor)
+{
+}
+
+/// Called on the shard thread, the socket has to be created there
+void UDPReceiveShard::start(void)
+{
+    _socket = new QUdpSocket(this);
+    _socket->setProxy(QNetworkProxy::NoProxy);
+    if (!_socket->setSocketDescriptor(_socketDescriptor, QAbstractSocket::BoundState)) {
+        qWarning() << "UDP: Unable to use additional receive socket" << _socket->errorString();
+        return;
+    }
+#ifdef __mobile__
+    _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 128 * 1024);
+#else
+    _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 512 * 1024);
+#endif
+    QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPReceiveShard::_readBytes);
+}
+
+void UDPReceiveShard::_readBytes(void)
+{
+    if (!_buffer.isDetached()) {
+        // Receivers still hold the previous batch
+        _buffer = QByteArray();
+    }
+    if (_buffer.capacity() == 0) {
+        _buffer.reserve(16 * 1024);
+    }
+    _buffer.resize(0);
+
+    while (_socket->hasPendingDatagrams()) {
+        const int       offset  = _buffer.size();
+        const int       pending = static_cast<int>(qMax(_socket->pendingDatagramSize(), static_cast<qint64>(0)));
+        QHostAddress    sender;
+        quint16         senderPort;
+
+        _buffer.resize(offset + pending);
+        qint64 slen = _socket->readDatagram(_buffer.data() + offset, pending, &sender, &senderPort);
+        if (slen == -1) {
+            _buffer.resize(offset);
+            break;
+        }
+        _buffer.resize(offset + static_cast<int>(slen));
+        int sysid = -1;
+        int targetSystem;
+        MAVLinkFrameScanner::peekRouting(reinterpret_cast<const uint8_t*>(_buffer.constData()) + offset, static_cast<int>(slen), sysid, targetSystem);
+        if (_buffer.size() > 10 * 1024) {
+            emit _link->bytesReceived(_link, _buffer);
+            _buffer = QByteArray();
+            _buffer.reserve(16 * 1024);
+        }
+        if (sender != _lastSender || senderPort != _lastSenderPort || sysid != _lastSysid) {
+            _lastSender     = sender;
+            _lastSenderPort = senderPort;
+            _lastSysid      = sysid;
+            _link->_addSessionTarget(sender, senderPort, sysid);
+        }
+    }
+    if (_buffer.size()) {
+        emit _link->bytesReceived(_link, _buffer);
+    }
+}
@@ -17,6 +17,8 @@
 #include <QMutex>
 #include <QQueue>
 #include <QByteArray>
+#include <QTimer>
+#include <QSet>
 
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
@@ -49,12 +51,20 @@ public:
 
     Q_PROPERTY(quint16      localPort   READ localPort  WRITE setLocalPort  NOTIFY localPortChanged)
     Q_PROPERTY(QStringList  hostList    READ hostList                       NOTIFY  hostListChanged)
+    Q_PROPERTY(bool         batchWrites READ batchWrites WRITE setBatchWrites NOTIFY batchWritesChanged)  ///< true: queue writes and send them together
+    Q_PROPERTY(bool         packFrames  READ packFrames  WRITE setPackFrames  NOTIFY packFramesChanged)   ///< true: pack queued writes into shared datagrams
+    Q_PROPERTY(int          receiveThreads          READ receiveThreads WRITE setReceiveThreads NOTIFY receiveThreadsChanged)   ///< Sockets/threads reading the port, senders are spread across them
+    Q_PROPERTY(bool         receiveThreadsSupported READ receiveThreadsSupported CONSTANT)                                      ///< false: receiveThreads is ignored on this platform
 
     UDPConfiguration(const QString& name);
     UDPConfiguration(UDPConfiguration* source);
     ~UDPConfiguration();
 
     quint16 localPort   () const{ return _localPort; }
+    bool    batchWrites () const{ return _batchWrites; }
+    bool    packFrames  () const{ return _packFrames; }
+    int     receiveThreads          () const{ return _receiveThreads; }
+    bool    receiveThreadsSupported () const;
 
     /// @param[in] host Host name in standard formatt, e.g. localhost:14551 or 192.168.1.1:14551
     Q_INVOKABLE void addHost (const QString host);
@@ -67,6 +77,9 @@ public:
     Q_INVOKABLE void removeHost  (const QString host);
 
     void                    setLocalPort(quint16 port);
+    void                    setBatchWrites  (bool batchWrites);
+    void                    setPackFrames   (bool packFrames);
+    void                    setReceiveThreads(int receiveThreads);
     QStringList             hostList    (void)          { return _hostList; }
     const QList<UDPCLient*> targetHosts (void)          { return _targetHosts; }
 
@@ -81,6 +94,9 @@ public:
 signals:
     void localPortChanged   (void);
     void hostListChanged    (void);
+    void batchWritesChanged (bool batchWrites);
+    void packFramesChanged  (bool packFrames);
+    void receiveThreadsChanged(int receiveThreads);
 
 private:
     void _updateHostList    (void);
@@ -90,6 +106,39 @@ private:
     QList<UDPCLient*>   _targetHosts;
     QStringList         _hostList;
     quint16             _localPort;
+    bool                _batchWrites    = true;
+    bool                _packFrames     = false;
+    int                 _receiveThreads = 1;
+
+    static const int    _maxReceiveThreads = 16;
+};
+
+class UDPLink;
+
+/// Additional receive socket of a UDPLink, bound to the same port with SO_REUSEPORT and serviced by its own thread.
+/// The kernel hashes senders across the sockets so each shard sees a stable subset of the peers. Received bytes are
+/// emitted through the link's bytesReceived from the shard thread.
+class UDPReceiveShard : public QObject
+{
+    Q_OBJECT
+
+public:
+    UDPReceiveShard(UDPLink* link, qintptr socketDescriptor);
+
+public slots:
+    void start(void);
+
+private slots:
+    void _readBytes(void);
+
+private:
+    UDPLink*        _link;
+    qintptr         _socketDescriptor;
+    QUdpSocket*     _socket         = nullptr;
+    QByteArray      _buffer;                        ///< Reused once the receivers released the previous batch
+    QHostAddress    _lastSender;
+    quint16         _lastSenderPort = 0;
+    int             _lastSysid      = -1;
 };
 
 class UDPLink : public LinkInterface
@@ -104,9 +153,6 @@ public:
     bool isConnected(void) const override;
     void disconnect (void) override;
 
-    // QThread overrides
-    void run(void) override;
-
 public slots:
     void readBytes(void);
 
@@ -121,17 +167,45 @@ private:
 
     bool _isIpLocal         (const QHostAddress& add);
     bool _hardwareConnect   (void);
+    void _startOnReactor    (void);
+    void _stopOnReactor     (void);
     void _registerZeroconf  (uint16_t port, const std::string& regType);
     void _deregisterZeroconf(void);
     void _writeDataGram     (const QByteArray data, const UDPCLient* target);
+    void _queueWrite        (const QByteArray& data);
+    void _flushWrites       (void);
+    void _writeDataGrams    (const QList<QByteArray>& datagrams, const UDPCLient* target);
+    void _addSessionTarget  (const QHostAddress& sender, quint16 senderPort, int sysid);
+    bool _isSessionTarget   (const UDPCLient* target) const;
+    quint64 _routedPeer     (const QByteArray& data) const;
+    bool _routedToTarget    (quint64 routedPeer, const UDPCLient* target) const;
+    void _startReceiveShards(void);
+    void _stopReceiveShards (void);
+
+    static quint64 _peerKey (const QHostAddress& address, quint16 port);
+
+    friend class UDPReceiveShard;
 
     bool                _running;
     QUdpSocket*         _socket;
     UDPConfiguration*   _udpConfig;
     bool                _connectState;
+    bool                _socketClosed   = false;    ///< _stopOnReactor closed an open socket, disconnected is still to be emitted
     QList<UDPCLient*>   _sessionTargets;
+    QSet<quint64>       _sessionTargetKeys;     ///< _peerKey of each session target, for lookups without a list scan
     QMutex              _sessionTargetsMutex;
+    QList<QThread*>     _receiveShardThreads;
+    QHostAddress        _lastSender;            ///< Sender of the last datagram read, already in _sessionTargets
+    quint16             _lastSenderPort = 0;
+    int                 _lastSysid      = -1;
+    QVector<quint64>    _sysidPeers;            ///< _peerKey of the session target each system id was last heard from, 0 for unknown
     QList<QHostAddress> _localAddresses;
+    QList<QByteArray>   _pendingDatagrams;      ///< Batched writes waiting for _flushTimer
+    QList<quint64>      _pendingRoutedPeers;    ///< _routedPeer for each of _pendingDatagrams, 0 for all peers
+    QTimer*             _flushTimer;
+
+    static const int    _maxPackedDatagramSize  = 1400;     ///< Packed datagrams are kept below the typical MTU
+    static const int    _maxPendingDatagrams    = 64;       ///< Flush immediately once this many datagrams are queued
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef       _dnssServiceRef;
 #endif
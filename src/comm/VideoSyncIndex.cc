@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoSyncIndex.h"
+#include "QGCLoggingCategory.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(VideoSyncIndexLog, "VideoSyncIndexLog")
+
+const char* VideoSyncIndex::_magic = "QGCVSYNC";
+
+QString VideoSyncIndex::indexFilename(const QString& videoFilename)
+{
+    QFileInfo videoFileInfo(videoFilename);
+    return QStringLiteral("%1/%2.qgcsync").arg(videoFileInfo.path(), videoFileInfo.completeBaseName());
+}
+
+void VideoSyncIndex::clear(void)
+{
+    close();
+    std::vector<Entry_t>().swap(_entries);
+}
+
+bool VideoSyncIndex::open(const QString& videoFilename)
+{
+    clear();
+
+    QString indexFilename = VideoSyncIndex::indexFilename(videoFilename);
+
+    _file.setFileName(indexFilename);
+    if (!_file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCWarning(VideoSyncIndexLog) << "Unable to create index" << indexFilename << _file.errorString();
+        return false;
+    }
+
+    Header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version          = _version;
+    header.entrySize        = sizeof(Entry_t);
+    header.byteOrderMark    = _byteOrderMark;
+
+    if (_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+        qCWarning(VideoSyncIndexLog) << "Writing index header failed" << indexFilename << _file.errorString();
+        _file.close();
+        return false;
+    }
+
+    _pending.reserve(_pendingEntries);
+    qCDebug(VideoSyncIndexLog) << "Writing index" << indexFilename;
+
+    return true;
+}
+
+void VideoSyncIndex::append(quint64 ptsNSecs, quint64 timestampUSecs, bool keyframe)
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    Entry_t entry;
+    entry.ptsNSecs          = ptsNSecs;
+    entry.timestampUSecs    = timestampUSecs;
+    entry.flags             = keyframe ? FlagKeyframe : 0;
+    entry.reserved          = 0;
+    _pending.push_back(entry);
+
+    if (_pending.size() >= _pendingEntries) {
+        _writePending();
+    }
+}
+
+void VideoSyncIndex::close(void)
+{
+    if (_file.isOpen()) {
+        _writePending();
+        _file.close();
+    }
+}
+
+void VideoSyncIndex::_writePending(void)
+{
+    if (_pending.empty()) {
+        return;
+    }
+
+    qint64 pendingBytes = static_cast<qint64>(_pending.size() * sizeof(Entry_t));
+    if (_file.write(reinterpret_cast<const char*>(_pending.data()), pendingBytes) != pendingBytes) {
+        qCWarning(VideoSyncIndexLog) << "Writing index failed" << _file.fileName() << _file.errorString();
+    }
+    _file.flush();
+    _pending.clear();
+}
+
+bool VideoSyncIndex::load(const QString& videoFilename)
+{
+    clear();
+
+    QString indexFilename = VideoSyncIndex::indexFilename(videoFilename);
+    QFile   file(indexFilename);
+    Header_t header;
+
+    if (!file.open(QFile::ReadOnly)) {
+        qCDebug(VideoSyncIndexLog) << "No index for video" << videoFilename;
+        return false;
+    }
+
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, _magic, sizeof(header.magic)) != 0 ||
+            header.version != _version ||
+            header.entrySize != sizeof(Entry_t) ||
+            header.byteOrderMark != _byteOrderMark) {
+        qCWarning(VideoSyncIndexLog) << "Invalid index" << indexFilename;
+        return false;
+    }
+
+    // A partial entry at the end is from an interrupted recording and is ignored
+    size_t entryCount = static_cast<size_t>(file.size() - static_cast<qint64>(sizeof(header))) / sizeof(Entry_t);
+    _entries.resize(entryCount);
+
+    qint64 entryBytes = static_cast<qint64>(entryCount * sizeof(Entry_t));
+    if (entryCount && file.read(reinterpret_cast<char*>(_entries.data()), entryBytes) != entryBytes) {
+        qCWarning(VideoSyncIndexLog) << "Reading index failed" << indexFilename << file.errorString();
+        std::vector<Entry_t>().swap(_entries);
+        return false;
+    }
+
+    qCDebug(VideoSyncIndexLog) << "Loaded index" << indexFilename << entryCount;
+
+    return !_entries.empty();
+}
+
+int VideoSyncIndex::findFrame(quint64 timestampUSecs) const
+{
+    auto iter = std::upper_bound(_entries.cbegin(), _entries.cend(), timestampUSecs, [](quint64 timestampUSecs, const Entry_t& entry) {
+        return timestampUSecs < entry.timestampUSecs;
+    });
+    return static_cast<int>(iter - _entries.cbegin()) - 1;
+}
+
+int VideoSyncIndex::findKeyframe(quint64 timestampUSecs) const
+{
+    int index = findFrame(timestampUSecs);
+    while (index >= 0 && !(_entries[static_cast<size_t>(index)].flags & FlagKeyframe)) {
+        index--;
+    }
+    return index;
+}
+
+int VideoSyncIndex::findPts(quint64 ptsNSecs) const
+{
+    auto iter = std::upper_bound(_entries.cbegin(), _entries.cend(), ptsNSecs, [](quint64 ptsNSecs, const Entry_t& entry) {
+        return ptsNSecs < entry.ptsNSecs;
+    });
+    return static_cast<int>(iter - _entries.cbegin()) - 1;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QLoggingCategory>
+
+#include <vector>
+
+Q_DECLARE_LOGGING_CATEGORY(VideoSyncIndexLog)
+
+/// Frame index for a recorded video, saved next to the video as a sidecar file (<video>.qgcsync).
+///
+/// Each entry maps the presentation time of a frame within the recording to the wall clock time the frame was
+/// captured. Wall clock times are Unix usecs, the same as telemetry log timestamps, so a log position maps to a
+/// video position (and back) without decoding the video. Entries are appended while recording, so the index of an
+/// interrupted recording is still usable up to the last complete entry.
+class VideoSyncIndex
+{
+public:
+    typedef struct {
+        quint64 ptsNSecs;           ///< Presentation time from the start of the recording
+        quint64 timestampUSecs;     ///< Wall clock capture time, Unix usecs
+        quint32 flags;
+        quint32 reserved;
+    } Entry_t;
+
+    static const quint32 FlagKeyframe = 0x1;
+
+    VideoSyncIndex(void) = default;
+    ~VideoSyncIndex() { close(); }
+
+    /// Creates the sidecar for a new recording, replacing an existing one
+    bool open(const QString& videoFilename);
+
+    /// Entries must be appended in presentation order
+    void append(quint64 ptsNSecs, quint64 timestampUSecs, bool keyframe);
+
+    /// Writes any buffered entries and closes the sidecar
+    void close(void);
+
+    bool isOpen(void) const { return _file.isOpen(); }
+
+    /// Closes the sidecar and drops loaded entries
+    void clear(void);
+
+    /// Loads the sidecar for a recorded video
+    /// @return false: index missing or invalid
+    bool load(const QString& videoFilename);
+
+    int             count           (void) const { return static_cast<int>(_entries.size()); }
+    const Entry_t&  entry           (int index) const { return _entries[static_cast<size_t>(index)]; }
+    quint64         startTimeUSecs  (void) const { return _entries.empty() ? 0 : _entries.front().timestampUSecs; }
+    quint64         endTimeUSecs    (void) const { return _entries.empty() ? 0 : _entries.back().timestampUSecs; }
+
+    /// @return Index of the last frame captured at or before timestampUSecs, -1 if there is none
+    int findFrame(quint64 timestampUSecs) const;
+
+    /// @return Index of the last keyframe captured at or before timestampUSecs, -1 if there is none
+    int findKeyframe(quint64 timestampUSecs) const;
+
+    /// @return Index of the last frame with a presentation time at or before ptsNSecs, -1 if there is none
+    int findPts(quint64 ptsNSecs) const;
+
+    static QString indexFilename(const QString& videoFilename);
+
+private:
+    typedef struct {
+        char    magic[8];
+        quint32 version;
+        quint32 entrySize;
+        quint32 byteOrderMark;  ///< Rejects indices written by a machine with different byte order
+        quint32 reserved;
+    } Header_t;
+
+    void _writePending(void);
+
+    QFile                   _file;
+    std::vector<Entry_t>    _pending;
+    std::vector<Entry_t>    _entries;
+
+    static const size_t     _pendingEntries = 256;  ///< Entries are written in blocks, about 8 secs at 30 fps
+    static const quint32    _version        = 1;
+    static const quint32    _byteOrderMark  = 0x01020304;
+    static const char*      _magic;
+};
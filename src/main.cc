@@ -38,8 +38,13 @@
     #include "UnitTest.h"
 #endif
 
+#include "CmdLineOptParser.h"
+
+#ifndef __mobile__
+    #include "LogReplayBenchmark.h"
+#endif
+
 #ifdef QT_DEBUG
-    #include "CmdLineOptParser.h"
     #ifdef Q_OS_WIN
         #include <crtdbg.h>
     #endif
@@ -88,6 +93,7 @@ int WindowsCrtReportHook(int reportType, char* message, int* returnValue)
 #endif
 #if !defined(NO_SERIAL_LINK)
 #include "qserialport.h"
+#include "SerialPortWatcher.h"
 #endif
 
 static jobject _class_loader = nullptr;
@@ -186,6 +192,7 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved)
 
  #if !defined(NO_SERIAL_LINK)
     QSerialPort::setNativeMethods();
+    SerialPortWatcher::setNativeMethods();
  #endif
 
     JoystickAndroid::setNativeMethods();
@@ -365,6 +372,19 @@ int main(int argc, char *argv[])
 #endif
 #endif // QT_DEBUG
 
+#ifndef __mobile__
+    // Available in release builds as well, that is where performance numbers matter
+    bool    replayBench = false;
+    bool    replayBenchOutput = false;
+    QString replayBenchLog;
+    QString replayBenchOutputFile = QStringLiteral("replaybench.json");
+    CmdLineOpt_t rgReplayBenchOptions[] = {
+        { "--replay-bench",         &replayBench,       &replayBenchLog },
+        { "--replay-bench-output",  &replayBenchOutput, &replayBenchOutputFile },
+    };
+    ParseCmdLineOptions(argc, argv, rgReplayBenchOptions, sizeof(rgReplayBenchOptions)/sizeof(rgReplayBenchOptions[0]), false);
+#endif
+
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
     QGCApplication* app = new QGCApplication(argc, argv, runUnitTests);
     Q_CHECK_PTR(app);
@@ -409,6 +429,15 @@ int main(int argc, char *argv[])
             }
         }
     } else
+#endif
+#ifndef __mobile__
+    if (replayBench) {
+        // Headless, no qml engine or main window
+        if (!app->_initForUnitTests()) {
+            return -1;
+        }
+        exitCode = LogReplayBenchmark::run(replayBenchLog, replayBenchOutputFile);
+    } else
 #endif
     {
 
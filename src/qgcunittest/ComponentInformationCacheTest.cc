@@ -152,3 +152,36 @@ void ComponentInformationCacheTest::_multi_test()
 
     _cleanup();
 }
+
+void ComponentInformationCacheTest::_dedup_test()
+{
+    _setup();
+
+    // Same content as _tmpFiles[0] under a different tag, as for identical vehicles
+    QString duplicatePath = _tmpFilesDir + "/duplicate.txt";
+    QVERIFY(QFile::copy(_tmpFiles[0].path, duplicatePath));
+
+    {
+        ComponentInformationCache cache(_cacheDir, 2);
+        _tmpFiles[0].cachedPath = cache.insert(_tmpFiles[0].cacheTag, _tmpFiles[0].path);
+        QString duplicateCachedPath = cache.insert(_tmpFiles[1].cacheTag + "_duplicate", duplicatePath);
+        QVERIFY(!duplicateCachedPath.isEmpty());
+        QVERIFY(duplicateCachedPath == _tmpFiles[0].cachedPath);
+        QVERIFY(!QFile(duplicatePath).exists());
+
+        // Evicting one of the entries must keep the shared file
+        QVERIFY(cache.access(_tmpFiles[1].cacheTag + "_duplicate") == duplicateCachedPath);
+        _tmpFiles[2].cachedPath = cache.insert(_tmpFiles[2].cacheTag, _tmpFiles[2].path);
+        QVERIFY(cache.access(_tmpFiles[0].cacheTag) == "");
+        QVERIFY(cache.access(_tmpFiles[1].cacheTag + "_duplicate") == duplicateCachedPath);
+        QVERIFY(QFile(duplicateCachedPath).exists());
+    }
+    {
+        // Index is persisted
+        ComponentInformationCache cache(_cacheDir, 2);
+        QVERIFY(cache.access(_tmpFiles[2].cacheTag) == _tmpFiles[2].cachedPath);
+        QVERIFY(cache.access(_tmpFiles[0].cacheTag) == "");
+    }
+
+    _cleanup();
+}
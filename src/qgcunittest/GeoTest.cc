@@ -91,3 +91,64 @@ void GeoTest::_convertNedToGeoAtOrigin_test(void)
     QCOMPARE(coord.longitude(), expectedLon);
     QCOMPARE(coord.altitude(), expectedAlt);
 }
+
+void GeoTest::_localTangentFrameBatch_test(void)
+{
+    const int       count = 100;
+    QGeoCoordinate  coords[count];
+    double          x[count], y[count], z[count];
+    QGeoCoordinate  roundTrip[count];
+
+    for (int i=0; i<count; i++) {
+        coords[i] = _origin.atDistanceAndAzimuth(i * 50.0, i * 17.0, i);
+    }
+
+    LocalTangentFrame frame(_origin);
+    frame.toNed(coords, count, x, y, z);
+    frame.fromNed(x, y, z, count, roundTrip);
+
+    for (int i=0; i<count; i++) {
+        double expectedX, expectedY, expectedZ;
+        convertGeoToNed(coords[i], _origin, &expectedX, &expectedY, &expectedZ);
+        QCOMPARE(x[i], expectedX);
+        QCOMPARE(y[i], expectedY);
+        QCOMPARE(z[i], expectedZ);
+
+        QGeoCoordinate expectedCoord;
+        convertNedToGeo(x[i], y[i], z[i], _origin, &expectedCoord);
+        QCOMPARE(roundTrip[i], expectedCoord);
+        QVERIFY(roundTrip[i].distanceTo(coords[i]) < 0.01);
+    }
+}
+
+void GeoTest::_convertGeoToUTMBatch_test(void)
+{
+    const int       count = 100;
+    QGeoCoordinate  coords[count];
+    double          eastings[count], northings[count];
+
+    for (int i=0; i<count; i++) {
+        coords[i] = _origin.atDistanceAndAzimuth(i * 100.0, i * 31.0);
+    }
+
+    double originEasting, originNorthing;
+    int zone = convertGeoToUTM(_origin, originEasting, originNorthing);
+    QVERIFY(zone != 0);
+    QVERIFY(!convertGeoToUTM(coords, count, 0, false, eastings, northings));
+    QVERIFY(convertGeoToUTM(coords, count, zone, false, eastings, northings));
+
+    for (int i=0; i<count; i++) {
+        double easting, northing;
+        QCOMPARE(convertGeoToUTM(coords[i], easting, northing), zone);
+        QVERIFY(qAbs(eastings[i] - easting) < 1e-6);
+        QVERIFY(qAbs(northings[i] - northing) < 1e-6);
+    }
+
+    // Round trip through the batch reverse conversion
+    QList<QGeoCoordinate> roundTrip;
+    QVERIFY(convertUTMToGeo(eastings, northings, count, zone, false, roundTrip));
+    QCOMPARE(roundTrip.count(), count);
+    for (int i=0; i<count; i++) {
+        QVERIFY(roundTrip[i].distanceTo(coords[i]) < 0.01);
+    }
+}
@@ -33,6 +33,8 @@ private slots:
     void _convertGeoToNedAtOrigin_test(void);
     void _convertNedToGeo_test(void);
     void _convertNedToGeoAtOrigin_test(void);
+    void _localTangentFrameBatch_test(void);
+    void _convertGeoToUTMBatch_test(void);
 private:
     QGeoCoordinate _origin;
 };
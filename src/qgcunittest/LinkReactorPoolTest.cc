@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkReactorPoolTest.h"
+#include "LinkReactorPool.h"
+
+#include <QTimer>
+#include <QSignalSpy>
+
+void LinkReactorPoolTest::_pin_test(void)
+{
+    LinkReactorPool pool(2);
+    QCOMPARE(pool.reactorCount(), 2);
+
+    QObject object1;
+    QObject object2;
+    QObject object3;
+
+    // Spread across the reactors
+    QThread* reactor1 = pool.pin(&object1);
+    QThread* reactor2 = pool.pin(&object2);
+    QVERIFY(reactor1);
+    QVERIFY(reactor2);
+    QVERIFY(reactor1 != reactor2);
+    QVERIFY(reactor1 != QThread::currentThread());
+    QCOMPARE(object1.thread(), reactor1);
+    QCOMPARE(object2.thread(), reactor2);
+
+    QThread* reactor3 = pool.pin(&object3);
+    QCOMPARE(pool.pinnedCount(0) + pool.pinnedCount(1), 3);
+    QVERIFY(reactor3 == reactor1 || reactor3 == reactor2);
+
+    // Pinning again keeps the reactor
+    QCOMPARE(pool.pin(&object1), reactor1);
+    QCOMPARE(pool.pinnedCount(0) + pool.pinnedCount(1), 3);
+
+    // Objects with a parent can't be moved
+    QObject child(&object1);
+    QVERIFY(!pool.pin(&child));
+
+    pool.unpin(&object1);
+    pool.unpin(&object2);
+    pool.unpin(&object3);
+    QCOMPARE(pool.pinnedCount(0) + pool.pinnedCount(1), 0);
+}
+
+void LinkReactorPoolTest::_unpin_test(void)
+{
+    LinkReactorPool pool(1);
+
+    QObject object;
+    QThread* reactor = pool.pin(&object);
+    QVERIFY(reactor);
+
+    QThread* stopThread = nullptr;
+    pool.unpin(&object, [&stopThread]() { stopThread = QThread::currentThread(); });
+
+    // Stopped on the reactor, back where it came from
+    QCOMPARE(stopThread, reactor);
+    QCOMPARE(object.thread(), QThread::currentThread());
+    QCOMPARE(pool.pinnedCount(0), 0);
+
+    // Not pinned any more
+    int stopCount = 0;
+    pool.unpin(&object, [&stopCount]() { stopCount++; });
+    QCOMPARE(stopCount, 0);
+}
+
+void LinkReactorPoolTest::_unpinOnReactor_test(void)
+{
+    LinkReactorPool pool(1);
+
+    QObject object;
+    QThread* reactor = pool.pin(&object);
+    QVERIFY(reactor);
+
+    // A link which fails to connect unpins itself from its reactor
+    QThread* stopThread = nullptr;
+    QMetaObject::invokeMethod(&object, [&pool, &object, &stopThread]() {
+        pool.unpin(&object, [&stopThread]() { stopThread = QThread::currentThread(); });
+    }, Qt::BlockingQueuedConnection);
+
+    QCOMPARE(stopThread, reactor);
+    QCOMPARE(object.thread(), QThread::currentThread());
+    QCOMPARE(pool.pinnedCount(0), 0);
+}
+
+void LinkReactorPoolTest::_events_test(void)
+{
+    LinkReactorPool pool(1);
+
+    // Timers are serviced by the reactor the object is pinned to
+    QTimer timer;
+    QThread* reactor = pool.pin(&timer);
+    QVERIFY(reactor);
+
+    QSignalSpy spy(&timer, &QTimer::timeout);
+    QThread* timeoutThread = nullptr;
+    connect(&timer, &QTimer::timeout, &timer, [&timeoutThread]() { timeoutThread = QThread::currentThread(); }, Qt::DirectConnection);
+    QMetaObject::invokeMethod(&timer, [&timer]() { timer.start(10); });
+
+    QVERIFY(spy.wait(1000));
+    pool.unpin(&timer, [&timer]() { timer.stop(); });
+    QCOMPARE(timeoutThread, reactor);
+    QVERIFY(!timer.isActive());
+}
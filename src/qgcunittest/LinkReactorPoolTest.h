@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for LinkReactorPool
+class LinkReactorPoolTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _pin_test              (void);
+    void _unpin_test            (void);
+    void _unpinOnReactor_test   (void);
+    void _events_test           (void);
+};
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageViewTest.h"
+#include "MAVLinkMessageView.h"
+
+void MAVLinkMessageViewTest::_field_test(void)
+{
+    mavlink_message_t message;
+    mavlink_msg_global_position_int_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 123456, 473977418, 85455939, 488000, 12000, -150, 75, 10, 35999);
+
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, time_boot_ms),   static_cast<uint32_t>(123456));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, lat),            static_cast<int32_t>(473977418));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, lon),            static_cast<int32_t>(85455939));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, alt),            static_cast<int32_t>(488000));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, relative_alt),   static_cast<int32_t>(12000));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, vx),             static_cast<int16_t>(-150));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, vy),             static_cast<int16_t>(75));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, vz),             static_cast<int16_t>(10));
+    QCOMPARE(QGC_MAVLINK_FIELD(message, global_position_int, hdg),            static_cast<uint16_t>(35999));
+}
+
+void MAVLinkMessageViewTest::_truncated_test(void)
+{
+    mavlink_message_t message;
+    mavlink_msg_gps_raw_int_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 1000000, GPS_FIX_TYPE_RTK_FIXED, 473977418, 85455939, 488000, 120, 180, 250, 9000, 17, 490000, 10, 20, 30, 40, 4500);
+
+    // Shorter payloads as sent by MAVLink 2 with trailing zeros removed. The bytes past the length are left in the
+    // buffer, the view must read them as zero like the decode function does.
+    for (int len = MAVLINK_MSG_ID_GPS_RAW_INT_LEN; len >= 0; len--) {
+        message.len = static_cast<uint8_t>(len);
+
+        mavlink_gps_raw_int_t gpsRawInt;
+        mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
+
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, time_usec),          gpsRawInt.time_usec);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, lat),                gpsRawInt.lat);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, lon),                gpsRawInt.lon);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, alt),                gpsRawInt.alt);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, eph),                gpsRawInt.eph);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, epv),                gpsRawInt.epv);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, vel),                gpsRawInt.vel);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, cog),                gpsRawInt.cog);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, fix_type),           gpsRawInt.fix_type);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, satellites_visible), gpsRawInt.satellites_visible);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, alt_ellipsoid),      gpsRawInt.alt_ellipsoid);
+        QCOMPARE(QGC_MAVLINK_FIELD(message, gps_raw_int, yaw),                gpsRawInt.yaw);
+    }
+}
+
+void MAVLinkMessageViewTest::_array_test(void)
+{
+    const float reprOffset[4] = { 0.5f, -0.5f, 0.25f, 1.0f };
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_quaternion_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 1000, 1.0f, 0.0f, 0.0f, 0.0f, 0.1f, 0.2f, 0.3f, reprOffset);
+
+    float q[4];
+    QGC_MAVLINK_ARRAY(message, attitude_quaternion, repr_offset_q, q);
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(q[i], reprOffset[i]);
+    }
+
+    // Extension field cut in the middle of the second element
+    message.len = static_cast<uint8_t>(offsetof(mavlink_attitude_quaternion_t, repr_offset_q) + sizeof(float) + 2);
+    mavlink_attitude_quaternion_t attitudeQuaternion;
+    mavlink_msg_attitude_quaternion_decode(&message, &attitudeQuaternion);
+    QGC_MAVLINK_ARRAY(message, attitude_quaternion, repr_offset_q, q);
+    QCOMPARE(memcmp(q, attitudeQuaternion.repr_offset_q, sizeof(q)), 0);
+    QCOMPARE(q[0], reprOffset[0]);
+    QCOMPARE(q[2], 0.0f);
+    QCOMPARE(q[3], 0.0f);
+}
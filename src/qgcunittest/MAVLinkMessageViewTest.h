@@ -0,0 +1,23 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for MAVLinkMessageView
+class MAVLinkMessageViewTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _field_test    (void);
+    void _truncated_test(void);
+    void _array_test    (void);
+};
@@ -0,0 +1,190 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkSigningTest.h"
+#include "MAVLinkSigning.h"
+#include "MAVLinkFrameScanner.h"
+#include "LinkManager.h"
+#include "QGCApplication.h"
+
+void MAVLinkSigningTest::_sha256_test(void)
+{
+    typedef struct {
+        const char* input;
+        const char* hash;
+    } TestCase_t;
+
+    // FIPS 180-2 test vectors, the last one spans two blocks
+    static const TestCase_t rgTestCases[] = {
+        { "",       "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abc",    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    };
+
+    qDebug() << "SHA-256 implementation" << MAVLinkSigning::sha256Implementation();
+
+    for (const TestCase_t& testCase: rgTestCases) {
+        uint8_t hash[32];
+        MAVLinkSigning::sha256(reinterpret_cast<const uint8_t*>(testCase.input), static_cast<int>(strlen(testCase.input)), hash);
+        QCOMPARE(QByteArray(reinterpret_cast<const char*>(hash), sizeof(hash)).toHex(), QByteArray(testCase.hash));
+    }
+}
+
+QByteArray MAVLinkSigningTest::_heartbeatFrame(uint8_t seq)
+{
+    const uint8_t payload[] = { 0, 0, 0, 0, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, MAV_STATE_STANDBY, 3 };
+
+    QByteArray frame;
+    frame.append(static_cast<char>(MAVLINK_STX));
+    frame.append(static_cast<char>(sizeof(payload)));
+    frame.append(static_cast<char>(0));     // incompat flags
+    frame.append(static_cast<char>(0));     // compat flags
+    frame.append(static_cast<char>(seq));
+    frame.append(static_cast<char>(1));     // sysid
+    frame.append(static_cast<char>(MAV_COMP_ID_AUTOPILOT1));
+    frame.append(static_cast<char>(MAVLINK_MSG_ID_HEARTBEAT));
+    frame.append(static_cast<char>(0));
+    frame.append(static_cast<char>(0));
+    frame.append(reinterpret_cast<const char*>(payload), sizeof(payload));
+
+    uint16_t crc = crc_calculate(reinterpret_cast<const uint8_t*>(frame.constData()) + 1, static_cast<uint16_t>(frame.size() - 1));
+    crc_accumulate(mavlink_get_msg_entry(MAVLINK_MSG_ID_HEARTBEAT)->crc_extra, &crc);
+    frame.append(static_cast<char>(crc & 0xFF));
+    frame.append(static_cast<char>(crc >> 8));
+
+    return frame;
+}
+
+mavlink_message_t MAVLinkSigningTest::_decode(const QByteArray& frame)
+{
+    LinkManager*                linkManager = qgcApp()->toolbox()->linkManager();
+    uint8_t                     channel     = linkManager->allocateMavlinkChannel();
+    QVector<mavlink_message_t>  messages;
+
+    MAVLinkFrameScanner::parse(channel, reinterpret_cast<const uint8_t*>(frame.constData()), frame.size(), messages);
+    linkManager->freeMavlinkChannel(channel);
+
+    if (messages.count() != 1) {
+        return mavlink_message_t();
+    }
+    return messages[0];
+}
+
+void MAVLinkSigningTest::_signVerify_test(void)
+{
+    MAVLinkSigning sender;
+    MAVLinkSigning receiver;
+    sender.configure(MAVLinkSigning::keyFromPassphrase("secret"), 1, false);
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("secret"), 2, false);
+
+    QByteArray frame = _heartbeatFrame(0);
+    const int unsignedLength = frame.size();
+    QVERIFY(sender.signFrame(frame));
+    QCOMPARE(frame.size(), unsignedLength + MAVLINK_SIGNATURE_BLOCK_LEN);
+    QCOMPARE(frame.at(0), static_cast<char>(MAVLINK_STX));
+    QVERIFY(frame.at(2) & MAVLINK_IFLAG_SIGNED);
+
+    // Already signed frames are left alone
+    QByteArray signedFrame = frame;
+    QVERIFY(!sender.signFrame(signedFrame));
+    QCOMPARE(signedFrame, frame);
+
+    mavlink_message_t message = _decode(frame);
+    QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QVERIFY(message.incompat_flags & MAVLINK_IFLAG_SIGNED);
+    QCOMPARE(message.signature[0], static_cast<uint8_t>(1));
+
+    QVector<mavlink_message_t> messages { message };
+    QCOMPARE(receiver.verify(messages), 0);
+    QCOMPARE(messages.count(), 1);
+
+    MAVLinkSigning::Counts_t counts = receiver.takeCounts();
+    QCOMPARE(counts.verified, 1);
+    QCOMPARE(counts.badSignature, 0);
+    QCOMPARE(counts.replayed, 0);
+    QCOMPARE(counts.unsignedRejected, 0);
+
+    // Counts reset once taken
+    QCOMPARE(receiver.takeCounts().verified, 0);
+}
+
+void MAVLinkSigningTest::_replay_test(void)
+{
+    MAVLinkSigning sender;
+    MAVLinkSigning receiver;
+    sender.configure(MAVLinkSigning::keyFromPassphrase("secret"), 1, false);
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("secret"), 2, false);
+
+    QByteArray first = _heartbeatFrame(0);
+    QByteArray second = _heartbeatFrame(1);
+    QVERIFY(sender.signFrame(first));
+    QVERIFY(sender.signFrame(second));
+
+    // Second arrives first, so the first one has an older time stamp for an already known stream
+    QVector<mavlink_message_t> messages { _decode(second), _decode(first), _decode(second) };
+    QCOMPARE(receiver.verify(messages), 2);
+    QCOMPARE(messages.count(), 1);
+    QCOMPARE(messages[0].seq, static_cast<uint8_t>(1));
+
+    MAVLinkSigning::Counts_t counts = receiver.takeCounts();
+    QCOMPARE(counts.verified, 1);
+    QCOMPARE(counts.replayed, 2);
+}
+
+void MAVLinkSigningTest::_badSignature_test(void)
+{
+    MAVLinkSigning sender;
+    MAVLinkSigning receiver;
+    sender.configure(MAVLinkSigning::keyFromPassphrase("secret"), 1, false);
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("other secret"), 2, false);
+
+    QByteArray frame = _heartbeatFrame(0);
+    QVERIFY(sender.signFrame(frame));
+    mavlink_message_t message = _decode(frame);
+
+    QVector<mavlink_message_t> messages { message };
+    QCOMPARE(receiver.verify(messages), 1);
+    QCOMPARE(messages.count(), 0);
+    QCOMPARE(receiver.takeCounts().badSignature, 1);
+
+    // Right key, tampered payload
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("secret"), 2, false);
+    _MAV_PAYLOAD_NON_CONST(&message)[0] ^= 1;
+    messages = { message };
+    QCOMPARE(receiver.verify(messages), 1);
+    QCOMPARE(receiver.takeCounts().badSignature, 1);
+}
+
+void MAVLinkSigningTest::_unsigned_test(void)
+{
+    MAVLinkSigning receiver;
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("secret"), 2, false);
+
+    mavlink_message_t heartbeat = _decode(_heartbeatFrame(0));
+    mavlink_message_t radioStatus = heartbeat;
+    radioStatus.msgid = MAVLINK_MSG_ID_RADIO_STATUS;
+
+    // RADIO_STATUS is let through since radios can't sign it
+    QVector<mavlink_message_t> messages { heartbeat, radioStatus };
+    QCOMPARE(receiver.verify(messages), 1);
+    QCOMPARE(messages.count(), 1);
+    QCOMPARE(messages[0].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_RADIO_STATUS));
+    QCOMPARE(receiver.takeCounts().unsignedRejected, 1);
+
+    receiver.configure(MAVLinkSigning::keyFromPassphrase("secret"), 2, true);
+    messages = { heartbeat };
+    QCOMPARE(receiver.verify(messages), 0);
+
+    // Nothing is checked once signing is disabled
+    receiver.disable();
+    messages = { heartbeat };
+    QCOMPARE(receiver.verify(messages), 0);
+    QByteArray frame = _heartbeatFrame(0);
+    QVERIFY(!receiver.signFrame(frame));
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for MAVLinkSigning
+class MAVLinkSigningTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _sha256_test       (void);
+    void _signVerify_test   (void);
+    void _replay_test       (void);
+    void _badSignature_test (void);
+    void _unsigned_test     (void);
+
+private:
+    QByteArray          _heartbeatFrame (uint8_t seq);
+    mavlink_message_t   _decode         (const QByteArray& frame);
+};
@@ -0,0 +1,347 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PlanningBenchmark.h"
+#include "QGCApplication.h"
+#include "QGCGeo.h"
+#include "QGCMapPolygon.h"
+#include "TerrainTile.h"
+#include "TerrainQuery.h"
+#include "SurveyComplexItem.h"
+#include "PlanMasterController.h"
+#include "CameraCalc.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtMath>
+
+#include <limits>
+
+void PlanningBenchmark::_measure(const QString& name, int iterations, const std::function<void(void)>& function)
+{
+    qint64 bestNSecs = std::numeric_limits<qint64>::max();
+
+    for (int run=0; run<_runCount; run++) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i=0; i<iterations; i++) {
+            function();
+        }
+        bestNSecs = qMin(bestNSecs, timer.nsecsElapsed());
+    }
+
+    double nsecsPerIteration = static_cast<double>(bestNSecs) / iterations;
+    qDebug() << "PlanningBenchmark" << name << nsecsPerIteration << "nsecs per iteration";
+    _results[name] = nsecsPerIteration;
+}
+
+void PlanningBenchmark::cleanupTestCase(void)
+{
+    if (_results.isEmpty()) {
+        return;
+    }
+
+    QString historyFile = qEnvironmentVariable("QGC_BENCHMARK_HISTORY", QStringLiteral("qgcbenchmark_history.jsonl"));
+
+    // Compare against the previous run
+    QFile file(historyFile);
+    if (file.open(QFile::ReadOnly)) {
+        QByteArray lastLine;
+        while (!file.atEnd()) {
+            QByteArray line = file.readLine().trimmed();
+            if (!line.isEmpty()) {
+                lastLine = line;
+            }
+        }
+        file.close();
+
+        QJsonObject previousResults = QJsonDocument::fromJson(lastLine).object()[QStringLiteral("results")].toObject();
+        for (const QString& name: _results.keys()) {
+            double previous = previousResults[name].toDouble();
+            double current  = _results[name].toDouble();
+            if (previous > 0 && current > previous * (100 + _regressionPercent) / 100.0) {
+                qWarning() << "PlanningBenchmark regression" << name << "previous" << previous << "current" << current << "nsecs per iteration";
+            }
+        }
+    }
+
+    QJsonObject record;
+    record[QStringLiteral("date")]      = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    record[QStringLiteral("version")]   = qgcApp()->applicationVersion();
+    record[QStringLiteral("results")]   = _results;
+
+    if (file.open(QFile::WriteOnly | QFile::Append)) {
+        file.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    } else {
+        qWarning() << "PlanningBenchmark unable to write history" << historyFile << file.errorString();
+    }
+}
+
+/// @return Serialized terrain tile for the specified tile coordinates with a sloped surface
+QByteArray PlanningBenchmark::_terrainTileBytes(int tileX, int tileY)
+{
+    const int       gridSize    = qRound(TerrainTile::tileSizeDegrees / TerrainTile::tileValueSpacingDegrees) + 1;
+    const double    swLat       = (tileY * TerrainTile::tileSizeDegrees) - 90.0;
+    const double    swLon       = (tileX * TerrainTile::tileSizeDegrees) - 180.0;
+
+    QJsonArray carpet;
+    for (int i=0; i<gridSize; i++) {
+        QJsonArray row;
+        for (int j=0; j<gridSize; j++) {
+            row.append(100 + i + j);
+        }
+        carpet.append(row);
+    }
+
+    QJsonObject bounds;
+    bounds[QStringLiteral("sw")] = QJsonArray({ swLat, swLon });
+    bounds[QStringLiteral("ne")] = QJsonArray({ swLat + ((gridSize - 1) * TerrainTile::tileValueSpacingDegrees), swLon + ((gridSize - 1) * TerrainTile::tileValueSpacingDegrees) });
+
+    QJsonObject stats;
+    stats[QStringLiteral("min")] = 100;
+    stats[QStringLiteral("max")] = 100 + (2 * (gridSize - 1));
+    stats[QStringLiteral("avg")] = 100 + (gridSize - 1);
+
+    QJsonObject data;
+    data[QStringLiteral("bounds")]  = bounds;
+    data[QStringLiteral("stats")]   = stats;
+    data[QStringLiteral("carpet")]  = carpet;
+
+    QJsonObject root;
+    root[QStringLiteral("status")]  = QStringLiteral("success");
+    root[QStringLiteral("data")]    = data;
+
+    return TerrainTile::serializeFromAirMapJson(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+void PlanningBenchmark::_convertGeoToNedBenchmark(void)
+{
+    const QGeoCoordinate origin(47.3977419, 8.5455938, 488.0);
+    const int coordCount = 10000;
+
+    QList<QGeoCoordinate> coords;
+    for (int i=0; i<coordCount; i++) {
+        coords.append(origin.atDistanceAndAzimuth(i % 5000, (i * 7) % 360));
+    }
+
+    double sum = 0;
+    _measure(QStringLiteral("convertGeoToNed"), 100, [&]() {
+        for (const QGeoCoordinate& coord: coords) {
+            double x, y, z;
+            convertGeoToNed(coord, origin, &x, &y, &z);
+            sum += x + y;
+        }
+    });
+    QVERIFY(!qIsNaN(sum));
+}
+
+void PlanningBenchmark::_terrainTileElevationBenchmark(void)
+{
+    const int tileX = 18854;
+    const int tileY = 13739;
+
+    TerrainTile tile(_terrainTileBytes(tileX, tileY));
+    QVERIFY(tile.isValid());
+
+    const double swLat = (tileY * TerrainTile::tileSizeDegrees) - 90.0;
+    const double swLon = (tileX * TerrainTile::tileSizeDegrees) - 180.0;
+    const int coordCount = 10000;
+
+    QList<QGeoCoordinate> coords;
+    for (int i=0; i<coordCount; i++) {
+        double fraction = static_cast<double>(i) / coordCount;
+        coords.append(QGeoCoordinate(swLat + (fraction * TerrainTile::tileSizeDegrees), swLon + ((1.0 - fraction) * TerrainTile::tileSizeDegrees)));
+    }
+
+    double sum = 0;
+    _measure(QStringLiteral("TerrainTile::elevation"), 100, [&]() {
+        for (const QGeoCoordinate& coord: coords) {
+            sum += tile.elevation(coord);
+        }
+    });
+    QVERIFY(!qIsNaN(sum));
+}
+
+void PlanningBenchmark::_terrainTileManagerBenchmark(void)
+{
+    const QGeoCoordinate    start(47.3977419, 8.5455938);
+    const int               tileCount = 10;     // tileCount * tileCount tiles are loaded
+    const int               baseTileX = TerrainTileManager::_getTileX(start.longitude());
+    const int               baseTileY = TerrainTileManager::_getTileY(start.latitude());
+
+    TerrainTileManager tileManager;
+    for (int x=baseTileX; x<baseTileX+tileCount; x++) {
+        for (int y=baseTileY; y<baseTileY+tileCount; y++) {
+            TerrainTile* tile = new TerrainTile(_terrainTileBytes(x, y));
+            QVERIFY(tile->isValid());
+            tileManager._tiles.insert(TerrainTileManager::_getTileKey(x, y), tile);
+        }
+    }
+
+    // Lawnmower pattern over the loaded tiles at survey style spacing
+    const double    areaDegrees = (tileCount - 1) * TerrainTile::tileSizeDegrees;
+    const int       rowCount    = 100;
+    const int       rowPoints   = 1000;
+    QList<QGeoCoordinate> coords;
+    for (int row=0; row<rowCount; row++) {
+        double lat = start.latitude() + (areaDegrees * row / rowCount);
+        for (int i=0; i<rowPoints; i++) {
+            int column = row & 1 ? rowPoints - 1 - i : i;
+            coords.append(QGeoCoordinate(lat, start.longitude() + (areaDegrees * column / rowPoints)));
+        }
+    }
+
+    bool allAvailable = true;
+    _measure(QStringLiteral("TerrainTileManager::getAltitudesForCoordinates"), 10, [&]() {
+        QList<double>   altitudes;
+        bool            error;
+        allAvailable &= tileManager.getAltitudesForCoordinates(coords, altitudes, error) && !error;
+    });
+    QVERIFY(allAvailable);
+}
+
+void PlanningBenchmark::_terrainPathCollisionBenchmark(void)
+{
+    const QGeoCoordinate    start(47.3977419, 8.5455938);
+    const int               tileCount = 10;     // tileCount * tileCount tiles are loaded
+    const int               baseTileX = TerrainTileManager::_getTileX(start.longitude());
+    const int               baseTileY = TerrainTileManager::_getTileY(start.latitude());
+
+    TerrainTileManager tileManager;
+    for (int x=baseTileX; x<baseTileX+tileCount; x++) {
+        for (int y=baseTileY; y<baseTileY+tileCount; y++) {
+            TerrainTile* tile = new TerrainTile(_terrainTileBytes(x, y));
+            QVERIFY(tile->isValid());
+            tileManager._tiles.insert(TerrainTileManager::_getTileKey(x, y), tile);
+        }
+    }
+
+    // Terrain following plan over the loaded tiles, every third waypoint is just below the terrain
+    const double    areaDegrees     = (tileCount - 1) * TerrainTile::tileSizeDegrees;
+    const int       waypointCount   = 2000;
+    QList<QGeoCoordinate>   waypoints;
+    QList<double>           waypointAlts;
+    for (int i=0; i<waypointCount; i++) {
+        QGeoCoordinate waypoint(start.latitude() + (areaDegrees * ((i * 37) % waypointCount) / waypointCount), start.longitude() + (areaDegrees * ((i * 91) % waypointCount) / waypointCount));
+        QList<double>   altitudes;
+        bool            error;
+        QVERIFY(tileManager.getAltitudesForCoordinates({ waypoint }, altitudes, error) && !error);
+        waypoints.append(waypoint);
+        waypointAlts.append(altitudes[0] + (i % 3 == 0 ? -1 : 5));
+    }
+
+    // The pyramid check must find every collision which dense sampling finds
+    for (int i=0; i<waypointCount - 1; i += 50) {
+        bool collision;
+        QVERIFY(tileManager.pathCollision(waypoints[i], waypointAlts[i], waypoints[i + 1], waypointAlts[i + 1], collision));
+
+        const int       sampleCount = 1000;
+        QList<QGeoCoordinate> samples;
+        for (int j=0; j<=sampleCount; j++) {
+            double t = static_cast<double>(j) / sampleCount;
+            samples.append(QGeoCoordinate(waypoints[i].latitude() + ((waypoints[i + 1].latitude() - waypoints[i].latitude()) * t),
+                                          waypoints[i].longitude() + ((waypoints[i + 1].longitude() - waypoints[i].longitude()) * t)));
+        }
+        QList<double>   sampleHeights;
+        bool            error;
+        QVERIFY(tileManager.getAltitudesForCoordinates(samples, sampleHeights, error) && !error);
+        bool sampledCollision = false;
+        for (int j=0; j<=sampleCount; j++) {
+            double t = static_cast<double>(j) / sampleCount;
+            sampledCollision |= sampleHeights[j] > waypointAlts[i] + ((waypointAlts[i + 1] - waypointAlts[i]) * t);
+        }
+        QVERIFY(collision || !sampledCollision);
+    }
+
+    int collisionCount = 0;
+    _measure(QStringLiteral("TerrainTileManager::pathCollision"), 10, [&]() {
+        collisionCount = 0;
+        for (int i=0; i<waypointCount - 1; i++) {
+            bool collision;
+            tileManager.pathCollision(waypoints[i], waypointAlts[i], waypoints[i + 1], waypointAlts[i + 1], collision);
+            collisionCount += collision ? 1 : 0;
+        }
+    });
+    QVERIFY(collisionCount > 0 && collisionCount < waypointCount - 1);
+}
+
+void PlanningBenchmark::_surveyTransectsBenchmark(void)
+{
+    PlanMasterController masterController;
+    SurveyComplexItem* surveyItem = new SurveyComplexItem(&masterController, false /* flyView */, QString() /* kmlFile */);
+
+    // Irregular 5km polygon with many vertices
+    const QGeoCoordinate    center(47.633550640000003, -122.08982199);
+    const int               vertexCount = 100;
+    QList<QGeoCoordinate>   vertices;
+    for (int i=0; i<vertexCount; i++) {
+        double distance = 2500 + (i % 2 ? 300 : 0) + ((i % 7) * 50);
+        vertices.append(center.atDistanceAndAzimuth(distance, 360.0 * i / vertexCount));
+    }
+    surveyItem->surveyAreaPolygon()->appendVertices(vertices);
+    surveyItem->cameraCalc()->adjustedFootprintSide()->setRawValue(20);
+    surveyItem->cameraCalc()->adjustedFootprintFrontal()->setRawValue(20);
+    surveyItem->gridAngle()->setRawValue(17);
+
+    _measure(QStringLiteral("SurveyComplexItem::_rebuildTransectsPhase1"), 10, [&]() {
+        QMetaObject::invokeMethod(surveyItem, "_rebuildTransectsPhase1", Qt::DirectConnection);
+    });
+
+    delete surveyItem;
+}
+
+void PlanningBenchmark::_polygonOffsetBenchmark(void)
+{
+    const QGeoCoordinate    center(47.633550640000003, -122.08982199);
+    const int               vertexCount = 500;
+
+    QVariantList vertices;
+    for (int i=0; i<vertexCount; i++) {
+        vertices.append(QVariant::fromValue(center.atDistanceAndAzimuth(1000 + ((i % 5) * 20), 360.0 * i / vertexCount)));
+    }
+
+    QGCMapPolygon polygon;
+    _measure(QStringLiteral("QGCMapPolygon::offset"), 20, [&]() {
+        polygon.clear();
+        polygon.appendVertices(vertices);
+        polygon.offset(10);
+    });
+    QCOMPARE(polygon.count(), vertexCount);
+}
+
+void PlanningBenchmark::_polygonContainsBenchmark(void)
+{
+    const QGeoCoordinate    center(47.633550640000003, -122.08982199);
+    const int               vertexCount = 500;
+    const int               coordCount  = 10000;
+
+    QGCMapPolygon polygon;
+    for (int i=0; i<vertexCount; i++) {
+        polygon.appendVertex(center.atDistanceAndAzimuth(1000 + ((i % 5) * 20), 360.0 * i / vertexCount));
+    }
+
+    QList<QGeoCoordinate> coords;
+    for (int i=0; i<coordCount; i++) {
+        coords.append(center.atDistanceAndAzimuth(i % 1200, (i * 13) % 360));
+    }
+
+    int containedCount = 0;
+    _measure(QStringLiteral("QGCMapPolygon::containsCoordinate"), 20, [&]() {
+        for (const QGeoCoordinate& coord: coords) {
+            if (polygon.containsCoordinate(coord)) {
+                containedCount++;
+            }
+        }
+    });
+    QVERIFY(containedCount > 0);
+}
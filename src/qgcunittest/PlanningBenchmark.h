@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QJsonObject>
+#include <functional>
+
+/// Micro benchmarks for the geo, terrain and transect generation code used by Plan view. Standalone, run through the
+/// qgcbenchmark target or with --unittest:PlanningBenchmark.
+///
+/// Each benchmark reports the best time per iteration out of a number of runs. Results are appended as a json line to
+/// the file named by QGC_BENCHMARK_HISTORY (default qgcbenchmark_history.jsonl) and compared against the previous
+/// line in the file, a warning is output for each benchmark which got slower by more than _regressionPercent.
+class PlanningBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void cleanupTestCase(void);
+
+    void _convertGeoToNedBenchmark          (void);
+    void _terrainTileElevationBenchmark     (void);
+    void _terrainTileManagerBenchmark       (void);
+    void _terrainPathCollisionBenchmark     (void);
+    void _surveyTransectsBenchmark          (void);
+    void _polygonOffsetBenchmark            (void);
+    void _polygonContainsBenchmark          (void);
+
+private:
+    void                _measure            (const QString& name, int iterations, const std::function<void(void)>& function);
+    static QByteArray   _terrainTileBytes   (int tileX, int tileY);
+
+    QJsonObject _results;   ///< nsecs per iteration keyed by benchmark name
+
+    static const int _runCount              = 5;
+    static const int _regressionPercent     = 20;
+};
@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTimerWheelTest.h"
+#include "QGCTimerWheel.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+
+void QGCTimerWheelTest::_singleShot_test(void)
+{
+    QGCWheelTimer timer;
+    timer.setSingleShot(true);
+    timer.setInterval(50);
+
+    QSignalSpy spy(&timer, &QGCWheelTimer::timeout);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    timer.start();
+    QVERIFY(timer.isActive());
+
+    QVERIFY(spy.wait(1000));
+    QVERIFY(elapsed.elapsed() >= 50);
+    QVERIFY(!timer.isActive());
+    QCOMPARE(timer.remainingTime(), -1);
+
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+}
+
+void QGCTimerWheelTest::_repeating_test(void)
+{
+    QGCWheelTimer timer;
+    timer.setInterval(20);
+
+    QSignalSpy spy(&timer, &QGCWheelTimer::timeout);
+    timer.start();
+    QTest::qWait(250);
+    timer.stop();
+
+    QVERIFY(spy.count() >= 3);
+    QVERIFY(spy.count() <= 13);
+    QVERIFY(!timer.isActive());
+}
+
+void QGCTimerWheelTest::_restart_test(void)
+{
+    // Restarting keeps pushing the deadline out, the way a link liveness timer is restarted for every message
+    QGCWheelTimer timer;
+    timer.setSingleShot(true);
+    timer.setInterval(100);
+
+    QSignalSpy spy(&timer, &QGCWheelTimer::timeout);
+    timer.start();
+    for (int i=0; i<10; i++) {
+        QTest::qWait(30);
+        timer.start();
+    }
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(timer.remainingTime() > 50);
+
+    // Restart to an earlier deadline
+    timer.start(10);
+    QVERIFY(spy.wait(100));
+    QCOMPARE(spy.count(), 1);
+}
+
+void QGCTimerWheelTest::_stopInTimeout_test(void)
+{
+    QGCWheelTimer timer1;
+    QGCWheelTimer timer2;
+    timer1.setSingleShot(true);
+    timer2.setSingleShot(true);
+
+    // Both fire on the same tick, whichever fires first stops the other
+    int fired = 0;
+    connect(&timer1, &QGCWheelTimer::timeout, this, [&] () { fired++; timer2.stop(); });
+    connect(&timer2, &QGCWheelTimer::timeout, this, [&] () { fired++; timer1.stop(); });
+    timer1.start(20);
+    timer2.start(20);
+
+    QTest::qWait(100);
+    QCOMPARE(fired, 1);
+    QVERIFY(!timer1.isActive());
+    QVERIFY(!timer2.isActive());
+    QCOMPARE(QGCTimerWheel::instance()->activeCount(), 0);
+}
+
+void QGCTimerWheelTest::_manyTimers_test(void)
+{
+    // Intervals spread over several wheel levels, the short ones must all have fired and the long ones not
+    const int count = 500;
+    QList<QGCWheelTimer*> timers;
+    int fired = 0;
+    for (int i=0; i<count; i++) {
+        QGCWheelTimer* timer = new QGCWheelTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QGCWheelTimer::timeout, this, [&fired] () { fired++; });
+        timer->start(i % 2 ? 10 + (i % 10) * 10 : 60000 + i * 1000);
+        timers.append(timer);
+    }
+    QCOMPARE(QGCTimerWheel::instance()->activeCount(), count);
+
+    QTest::qWait(300);
+    QCOMPARE(fired, count / 2);
+    QCOMPARE(QGCTimerWheel::instance()->activeCount(), count / 2);
+
+    qDeleteAll(timers);
+    QCOMPARE(QGCTimerWheel::instance()->activeCount(), 0);
+}
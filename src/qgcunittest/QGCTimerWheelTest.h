@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for QGCTimerWheel and QGCWheelTimer
+class QGCTimerWheelTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _singleShot_test   (void);
+    void _repeating_test    (void);
+    void _restart_test      (void);
+    void _stopInTimeout_test(void);
+    void _manyTimers_test   (void);
+};
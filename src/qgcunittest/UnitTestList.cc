@@ -38,6 +38,8 @@
 #include "PlanMasterControllerTest.h"
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
+#include "GeoFenceIndexTest.h"
+#include "MissionBoundsTreeTest.h"
 #include "AudioOutputTest.h"
 #include "StructureScanComplexItemTest.h"
 #include "QGCMapPolylineTest.h"
@@ -47,10 +49,18 @@
 #include "FWLandingPatternTest.h"
 #include "RequestMessageTest.h"
 #include "FTPManagerTest.h"
+#include "PIDTuningRecorderTest.h"
 #include "MissionCommandTreeEditorTest.h"
 #include "VehicleLinkManagerTest.h"
 #include "LandingComplexItemTest.h"
 #include "InitialConnectTest.h"
+#include "MockLinkBenchmark.h"
+#include "ULogReaderTest.h"
+#include "PlanningBenchmark.h"
+#include "QGCTimerWheelTest.h"
+#include "MAVLinkSigningTest.h"
+#include "LinkReactorPoolTest.h"
+#include "MAVLinkMessageViewTest.h"
 
 UT_REGISTER_TEST(ComponentInformationCacheTest)
 UT_REGISTER_TEST(ComponentInformationTranslationTest)
@@ -64,6 +74,7 @@ UT_REGISTER_TEST(SendMavCommandWithSignallingTest)
 UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 UT_REGISTER_TEST(RequestMessageTest)
 UT_REGISTER_TEST(FTPManagerTest)
+UT_REGISTER_TEST(PIDTuningRecorderTest)
 UT_REGISTER_TEST(InitialConnectTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
@@ -80,6 +91,8 @@ UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
+UT_REGISTER_TEST(GeoFenceIndexTest)
+UT_REGISTER_TEST(MissionBoundsTreeTest)
 UT_REGISTER_TEST(AudioOutputTest)
 UT_REGISTER_TEST(StructureScanComplexItemTest)
 UT_REGISTER_TEST(CorridorScanComplexItemTest)
@@ -88,8 +101,15 @@ UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
 UT_REGISTER_TEST(LandingComplexItemTest)
+UT_REGISTER_TEST(ULogReaderTest)
+UT_REGISTER_TEST(QGCTimerWheelTest)
+UT_REGISTER_TEST(MAVLinkSigningTest)
+UT_REGISTER_TEST(LinkReactorPoolTest)
+UT_REGISTER_TEST(MAVLinkMessageViewTest)
 
 UT_REGISTER_TEST_STANDALONE(MissionCommandTreeEditorTest)
+UT_REGISTER_TEST_STANDALONE(MockLinkBenchmark)
+UT_REGISTER_TEST_STANDALONE(PlanningBenchmark)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
@@ -18,12 +18,45 @@
 #include "UASMessageHandler.h"
 #include "MultiVehicleManager.h"
 #include "Vehicle.h"
+#include "SettingsManager.h"
+#include "QGCMemoryAccounting.h"
 
-UASMessage::UASMessage(int componentid, int severity, QString text)
+#include <QDir>
+#include <QTextStream>
+
+static QString _severityText(int severity)
+{
+    switch (severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+        return QCoreApplication::translate("UASMessageHandler", " EMERGENCY:");
+    case MAV_SEVERITY_ALERT:
+        return QCoreApplication::translate("UASMessageHandler", " ALERT:");
+    case MAV_SEVERITY_CRITICAL:
+        return QCoreApplication::translate("UASMessageHandler", " Critical:");
+    case MAV_SEVERITY_ERROR:
+        return QCoreApplication::translate("UASMessageHandler", " Error:");
+    case MAV_SEVERITY_WARNING:
+        return QCoreApplication::translate("UASMessageHandler", " Warning:");
+    case MAV_SEVERITY_NOTICE:
+        return QCoreApplication::translate("UASMessageHandler", " Notice:");
+    case MAV_SEVERITY_INFO:
+        return QCoreApplication::translate("UASMessageHandler", " Info:");
+    case MAV_SEVERITY_DEBUG:
+        return QCoreApplication::translate("UASMessageHandler", " Debug:");
+    default:
+        return QString();
+    }
+}
+
+UASMessage::UASMessage(int componentid, int severity, QString text, bool multiComp)
 {
-    _compId   = componentid;
-    _severity = severity;
-    _text     = text;
+    _compId         = componentid;
+    _severity       = severity;
+    _text           = text;
+    _timestamp      = QDateTime::currentDateTime();
+    _multiComp      = multiComp;
+    _repeatCount    = 1;
 }
 
 bool UASMessage::severityIsError() const
@@ -39,6 +72,57 @@ bool UASMessage::severityIsError() const
     }
 }
 
+QString UASMessage::getFormatedText()
+{
+    if (!_formatedText.isEmpty()) {
+        return _formatedText;
+    }
+
+    // Color the output depending on the message severity. We have 3 distinct cases:
+    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
+    // 2: If we have a warning or notice, just make it bold and color it orange.
+    // 3: Otherwise color it the standard color, white.
+    QString style;
+    switch (_severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+    case MAV_SEVERITY_ALERT:
+    case MAV_SEVERITY_CRITICAL:
+    case MAV_SEVERITY_ERROR:
+        style = QString("<#E>");
+        break;
+    case MAV_SEVERITY_NOTICE:
+    case MAV_SEVERITY_WARNING:
+        style = QString("<#I>");
+        break;
+    default:
+        style = QString("<#N>");
+        break;
+    }
+
+    QString dateString = _timestamp.toString("hh:mm:ss.zzz");
+    QString compString;
+    if (_multiComp) {
+        compString = QString(" COMP:%1").arg(_compId);
+    }
+    QString repeatString;
+    if (_repeatCount > 1) {
+        repeatString = QString(" (x%1)").arg(_repeatCount);
+    }
+    _formatedText = QString("<font style=\"%1\">[%2%3]%4 %5%6</font><br/>").arg(style).arg(dateString).arg(compString).arg(_severityText(_severity)).arg(_text.toHtmlEscaped()).arg(repeatString);
+
+    return _formatedText;
+}
+
+QString UASMessage::_plainText() const
+{
+    QString repeatString;
+    if (_repeatCount > 1) {
+        repeatString = QString(" (x%1)").arg(_repeatCount);
+    }
+    return QString("[%1 COMP:%2]%3 %4%5").arg(_timestamp.toString("yyyy-MM-dd hh:mm:ss.zzz")).arg(_compId).arg(_severityText(_severity)).arg(_text).arg(repeatString);
+}
+
 UASMessageHandler::UASMessageHandler(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _activeVehicle(nullptr)
@@ -66,10 +150,24 @@ void UASMessageHandler::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager = _toolbox->multiVehicleManager();
 
    connect(_multiVehicleManager, &MultiVehicleManager::activeVehicleChanged, this, &UASMessageHandler::_activeVehicleChanged);
+   _toolbox->memoryAccounting()->addSource(this, QStringLiteral("Messages"), [this](){ return _memoryBytes(); });
    emit textMessageReceived(nullptr);
    emit textMessageCountChanged(0);
 }
 
+qint64 UASMessageHandler::_memoryBytes(void)
+{
+    qint64 bytes = 0;
+    _mutex.lock();
+    bytes += static_cast<qint64>(_messages.capacity()) * static_cast<qint64>(sizeof(UASMessage*));
+    for (const UASMessage* message: _messages) {
+        bytes += static_cast<qint64>(sizeof(UASMessage));
+        bytes += static_cast<qint64>(message->_text.capacity() + message->_formatedText.capacity()) * static_cast<qint64>(sizeof(QChar));
+    }
+    _mutex.unlock();
+    return bytes;
+}
+
 void UASMessageHandler::clearMessages()
 {
     _mutex.lock();
@@ -80,6 +178,7 @@ void UASMessageHandler::clearMessages()
     _errorCount   = 0;
     _warningCount = 0;
     _normalCount  = 0;
+    _historyFile.close();
     _mutex.unlock();
     emit textMessageCountChanged(0);
 }
@@ -110,11 +209,6 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
         return;
     }
 
-    // Color the output depending on the message severity. We have 3 distinct cases:
-    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
-    // 2: If we have a warning or notice, just make it bold and color it orange.
-    // 3: Otherwise color it the standard color, white.
-
     _mutex.lock();
 
     if (_activeComponent < 0) {
@@ -125,80 +219,52 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
         _multiComp = true;
     }
 
-    // So first determine the styling based on the severity.
-    QString style;
     switch (severity)
     {
     case MAV_SEVERITY_EMERGENCY:
     case MAV_SEVERITY_ALERT:
     case MAV_SEVERITY_CRITICAL:
     case MAV_SEVERITY_ERROR:
-        style = QString("<#E>");
         _errorCount++;
         _errorCountTotal++;
         break;
     case MAV_SEVERITY_NOTICE:
     case MAV_SEVERITY_WARNING:
-        style = QString("<#I>");
         _warningCount++;
         break;
     default:
-        style = QString("<#N>");
         _normalCount++;
         break;
     }
 
-    // And determine the text for the severitie
-    QString severityText;
-    switch (severity)
-    {
-    case MAV_SEVERITY_EMERGENCY:
-        severityText = tr(" EMERGENCY:");
-        break;
-    case MAV_SEVERITY_ALERT:
-        severityText = tr(" ALERT:");
-        break;
-    case MAV_SEVERITY_CRITICAL:
-        severityText = tr(" Critical:");
-        break;
-    case MAV_SEVERITY_ERROR:
-        severityText = tr(" Error:");
-        break;
-    case MAV_SEVERITY_WARNING:
-        severityText = tr(" Warning:");
-        break;
-    case MAV_SEVERITY_NOTICE:
-        severityText = tr(" Notice:");
-        break;
-    case MAV_SEVERITY_INFO:
-        severityText = tr(" Info:");
-        break;
-    case MAV_SEVERITY_DEBUG:
-        severityText = tr(" Debug:");
-        break;
-    default:
-        break;
+    // A message which repeats the last one is collapsed into it
+    UASMessage* lastMessage = _messages.isEmpty() ? nullptr : _messages.last();
+    if (lastMessage && lastMessage->_compId == compId && lastMessage->_severity == severity && lastMessage->_text == text &&
+            lastMessage->_timestamp.msecsTo(QDateTime::currentDateTime()) < _repeatCollapseMSecs) {
+        lastMessage->_repeatCount++;
+        lastMessage->_timestamp = QDateTime::currentDateTime();
+        lastMessage->_formatedText.clear();
+        int count = _messages.count();
+        _mutex.unlock();
+        emit textMessageCountChanged(count);
+        return;
     }
 
-    // Finally preppend the properly-styled text with a timestamp.
-    QString dateString = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
-    UASMessage* message = new UASMessage(compId, severity, text);
-    QString compString;
-    if (_multiComp) {
-        compString = QString(" COMP:%1").arg(compId);
-    }
-    message->_setFormatedText(QString("<font style=\"%1\">[%2%3]%4 %5</font><br/>").arg(style).arg(dateString).arg(compString).arg(severityText).arg(text.toHtmlEscaped()));
+    UASMessage* message = new UASMessage(compId, severity, text, _multiComp);
 
     if (message->severityIsError()) {
-        _latestError = severityText + " " + text;
+        _latestError = _severityText(severity) + " " + text;
     }
 
+    _messages.append(message);
+    if (_messages.count() > _maxMessages) {
+        _dropOldMessages();
+    }
+    int count = _messages.count();
+
     _mutex.unlock();
 
     emit textMessageReceived(message);
-
-    _messages.append(message);
-    int count = _messages.count();
     emit textMessageCountChanged(count);
 
     if (_showErrorsInToolbar && message->severityIsError()) {
@@ -206,6 +272,43 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
     }
 }
 
+/// Drops the older half of the messages, after writing them to the history file. The caller must hold _mutex.
+void UASMessageHandler::_dropOldMessages(void)
+{
+    const int dropCount = _maxMessages / 2;
+
+    _writeHistory(dropCount);
+    for (int i=0; i<dropCount; i++) {
+        delete _messages[i];
+    }
+    _messages.remove(0, dropCount);
+}
+
+void UASMessageHandler::_writeHistory(int count)
+{
+    if (!_historyFile.isOpen()) {
+        QString savePath = _toolbox->settingsManager()->appSettings()->telemetrySavePath();
+        if (savePath.isEmpty()) {
+            return;
+        }
+        QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
+        _historyFile.setFileName(QDir(savePath).absoluteFilePath(QString("%1 vehicle%2 messages.txt").arg(now).arg(_activeVehicle->id())));
+        if (!_historyFile.open(QFile::WriteOnly | QFile::Append | QFile::Text)) {
+            qWarning() << "Unable to open vehicle message history" << _historyFile.fileName() << _historyFile.errorString();
+            return;
+        }
+    }
+
+    QTextStream stream(&_historyFile);
+    for (int i=0; i<count; i++) {
+        stream << _messages[i]->_plainText() << "\n";
+    }
+    stream.flush();
+    if (stream.status() != QTextStream::Ok) {
+        qWarning() << "Writing vehicle message history failed" << _historyFile.fileName() << _historyFile.errorString();
+    }
+}
+
 int UASMessageHandler::getErrorCountTotal() {
     _mutex.lock();
     int c = _errorCountTotal;
@@ -12,6 +12,8 @@
 #include <QObject>
 #include <QVector>
 #include <QMutex>
+#include <QDateTime>
+#include <QFile>
 
 #include "QGCToolbox.h"
 
@@ -42,20 +44,29 @@ public:
     QString getText()           { return _text; }
     /**
      * @brief Get (html) formatted text (in the form: "[11:44:21.137 - COMP:50] Info: [pm] sending list")
+     *
+     * The text is only built the first time it is asked for and then cached.
      */
-    QString getFormatedText()   { return _formatedText; }
+    QString getFormatedText();
+    /**
+     * @brief Get the number of times this message was received in a row
+     */
+    int getRepeatCount() const       { return _repeatCount; }
     /**
      * @return true: This message is a of a severity which is considered an error
      */
     bool severityIsError() const;
 
 private:
-    UASMessage(int componentid, int severity, QString text);
-    void _setFormatedText(const QString formatedText) { _formatedText = formatedText; }
+    UASMessage(int componentid, int severity, QString text, bool multiComp);
+    QString _plainText() const;
     int _compId;
     int _severity;
     QString _text;
     QString _formatedText;
+    QDateTime _timestamp;       ///< Time of the last repeat
+    bool _multiComp;
+    int _repeatCount;
 };
 
 class UASMessageHandler : public QGCTool
@@ -75,7 +86,8 @@ public:
      */
     void unlockAccess() {_mutex.unlock(); }
     /**
-     * @brief Access to the message list
+     * @brief Access to the message list, oldest first. Only holds the last _maxMessages messages, older ones are
+     * written to the message history file.
      */
     const QVector<UASMessage*>& messages() { return _messages; }
     /**
@@ -121,7 +133,7 @@ public slots:
 
 signals:
     /**
-     * @brief Sent out when new message arrives
+     * @brief Sent out when new message arrives. Not sent for a repeat of the last message, which only bumps its repeat count.
      * @param message A pointer to the message. NULL if resetting (new UAS assigned)
      */
     void textMessageReceived(UASMessage* message);
@@ -135,6 +147,13 @@ private slots:
     void _activeVehicleChanged(Vehicle* vehicle);
 
 private:
+    void _dropOldMessages   (void);
+    void _writeHistory      (int count);
+    qint64 _memoryBytes     (void);
+
+    static const int        _maxMessages            = 1000;
+    static const int        _repeatCollapseMSecs    = 10000;    ///< Identical messages closer than this are collapsed into one
+
     Vehicle*                _activeVehicle;
     int                     _activeComponent;
     bool                    _multiComp;
@@ -147,5 +166,6 @@ private:
     QString                 _latestError;
     bool                    _showErrorsInToolbar;
     MultiVehicleManager*    _multiVehicleManager;
+    QFile                   _historyFile;
 };
 
@@ -406,10 +406,14 @@ ApplicationWindow {
         anchors.fill:   parent
     }
 
-    PlanView {
+    // Plan view is created in the background after the Fly view is up so it does not delay the first frame.
+    // Until it has loaded globals.planMasterControllerPlanView is null.
+    Loader {
         id:             planView
         anchors.fill:   parent
         visible:        false
+        asynchronous:   true
+        source:         "PlanView.qml"
     }
 
     Drawer {
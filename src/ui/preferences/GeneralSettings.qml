@@ -43,6 +43,7 @@ Rectangle {
     property string _mapProvider:               QGroundControl.settingsManager.flightMapSettings.mapProvider.value
     property string _mapType:                   QGroundControl.settingsManager.flightMapSettings.mapType.value
     property Fact   _followTarget:              QGroundControl.settingsManager.appSettings.followTarget
+    property Fact   _followTargetRate:          QGroundControl.settingsManager.appSettings.followTargetRate
     property real   _panelWidth:                _root.width * _internalWidthRatio
     property real   _margins:                   ScreenTools.defaultFontPixelWidth
     property var    _planViewSettings:          QGroundControl.settingsManager.planViewSettings
@@ -373,6 +374,28 @@ Rectangle {
                                     visible:                videoFileFormatLabel.visible
                                 }
 
+                                QGCLabel {
+                                    id:         videoSegmentLengthLabel
+                                    text:       qsTr("Record Segment Length")
+                                    visible:    _showSaveVideoSettings && _videoSettings.recordingSegmentLength.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.recordingSegmentLength
+                                    visible:                videoSegmentLengthLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         subtitleSampleRateLabel
+                                    text:       qsTr("Telemetry Subtitle Rate")
+                                    visible:    _showSaveVideoSettings && _videoSettings.subtitleSampleRate.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.subtitleSampleRate
+                                    visible:                subtitleSampleRateLabel.visible
+                                }
+
                                 QGCLabel {
                                     id:         maxSavedVideoStorageLabel
                                     text:       qsTr("Max Storage Usage")
@@ -397,6 +420,91 @@ Rectangle {
                                     indexModel:             false
                                 }
 
+                                QGCLabel {
+                                    id:         thermalPaletteLabel
+                                    text:       qsTr("Thermal Palette")
+                                    visible:    _isGst && _videoSettings.thermalPalette.visible
+                                }
+                                FactComboBox {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalPalette
+                                    visible:                thermalPaletteLabel.visible
+                                    indexModel:             false
+                                }
+
+                                QGCLabel {
+                                    id:         thermalSpanMinLabel
+                                    text:       qsTr("Thermal Stream Black")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalSpanMin.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalSpanMin
+                                    visible:                thermalSpanMinLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         thermalSpanMaxLabel
+                                    text:       qsTr("Thermal Stream White")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalSpanMax.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalSpanMax
+                                    visible:                thermalSpanMaxLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         thermalRangeMinLabel
+                                    text:       qsTr("Thermal Range Min")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalRangeMin.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalRangeMin
+                                    visible:                thermalRangeMinLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         thermalRangeMaxLabel
+                                    text:       qsTr("Thermal Range Max")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalRangeMax.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalRangeMax
+                                    visible:                thermalRangeMaxLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         thermalIsothermMinLabel
+                                    text:       qsTr("Isotherm Min")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalIsotherm.rawValue && _videoSettings.thermalIsothermMin.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalIsothermMin
+                                    visible:                thermalIsothermMinLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         thermalIsothermMaxLabel
+                                    text:       qsTr("Isotherm Max")
+                                    visible:    thermalPaletteLabel.visible && _videoSettings.thermalIsotherm.rawValue && _videoSettings.thermalIsothermMax.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalIsothermMax
+                                    visible:                thermalIsothermMaxLabel.visible
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    text:       qsTr("Thermal Isotherm")
+                                    fact:       _videoSettings.thermalIsotherm
+                                    visible:    thermalPaletteLabel.visible && fact.visible
+                                }
+
                                 Item { width: 1; height: 1}
                                 FactCheckBox {
                                     text:       qsTr("Disable When Disarmed")
@@ -411,6 +519,20 @@ Rectangle {
                                     visible:    !_videoAutoStreamConfig && _isGst && fact.visible
                                 }
 
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    text:       qsTr("Fast Dropout Recovery")
+                                    fact:       _videoSettings.warmRestart
+                                    visible:    _isGst && fact.visible
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    text:       qsTr("Adapt Quality To Link")
+                                    fact:       _videoSettings.adaptiveVideoQuality
+                                    visible:    _isGst && fact.visible
+                                }
+
                                 Item { width: 1; height: 1}
                                 FactCheckBox {
                                     text:       qsTr("Auto-Delete Saved Recordings")
@@ -457,6 +579,24 @@ Rectangle {
                                     Layout.preferredWidth:  _valueFieldWidth
                                     fact:                   QGroundControl.settingsManager.planViewSettings.vtolTransitionDistance
                                 }
+
+                                QGCLabel { text: qsTr("KML/SHP Import Simplification") }
+                                FactTextField {
+                                    Layout.preferredWidth:  _valueFieldWidth
+                                    fact:                   _planViewSettings.shapeImportSimplification
+                                }
+
+                                QGCLabel { text: qsTr("Fence Upload Simplification") }
+                                FactTextField {
+                                    Layout.preferredWidth:  _valueFieldWidth
+                                    fact:                   _planViewSettings.fenceUploadSimplification
+                                }
+
+                                QGCLabel { text: qsTr("Terrain Clearance Warning") }
+                                FactTextField {
+                                    Layout.preferredWidth:  _valueFieldWidth
+                                    fact:                   _planViewSettings.terrainClearanceWarning
+                                }
                             }
 
                             FactCheckBox {
@@ -469,6 +609,12 @@ Rectangle {
                                 fact:       _planViewSettings.takeoffItemNotRequired
                                 visible:    _planViewSettings.takeoffItemNotRequired.visible
                             }
+
+                            FactCheckBox {
+                                text:       qsTr("Show Terrain Shading And Clearance")
+                                fact:       _planViewSettings.showTerrainOverlay
+                                visible:    _planViewSettings.showTerrainOverlay.visible
+                            }
                         }
                     }
 
@@ -606,6 +752,15 @@ Rectangle {
                                     indexModel:             false
                                     visible:                _followTarget.visible
                                 }
+                                QGCLabel {
+                                    text:                   qsTr("GCS Position Rate")
+                                    visible:                _followTargetRate.visible && _followTarget.rawValue !== 0
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _followTargetRate
+                                    visible:                _followTargetRate.visible && _followTarget.rawValue !== 0
+                                }
                                 QGCLabel {
                                     text:                           qsTr("UI Scaling")
                                     visible:                        _appFontPointSize.visible
@@ -801,6 +956,17 @@ Rectangle {
                                 enabled:    !_disableAllDataPersistence
                                 property Fact _saveCsvTelemetry: QGroundControl.settingsManager.appSettings.saveCsvTelemetry
                             }
+                            RowLayout {
+                                visible:    _csvTelemetryRate.visible
+                                property Fact _csvTelemetryRate: QGroundControl.settingsManager.appSettings.csvTelemetryRate
+                                QGCLabel { text: qsTr("CSV log rate") }
+                                FactComboBox {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   parent._csvTelemetryRate
+                                    enabled:                promptSaveCsv.checked && !_disableAllDataPersistence
+                                    indexModel:             false
+                                }
+                            }
                         }
                     }
 
@@ -1114,6 +1280,56 @@ Rectangle {
                                 visible:                adsbGrid.adsbSettings.adsbServerPort.visible
                                 Layout.preferredWidth:  _valueFieldWidth
                             }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbDisplayRadius.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbDisplayRadius.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbDisplayRadius
+                                visible:                adsbGrid.adsbSettings.adsbDisplayRadius.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbDisplayAltitudeBand.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbDisplayAltitudeBand.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbDisplayAltitudeBand
+                                visible:                adsbGrid.adsbSettings.adsbDisplayAltitudeBand.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbConflictLookahead.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbConflictLookahead.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbConflictLookahead
+                                visible:                adsbGrid.adsbSettings.adsbConflictLookahead.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbConflictHorizontalSeparation.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbConflictHorizontalSeparation.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbConflictHorizontalSeparation
+                                visible:                adsbGrid.adsbSettings.adsbConflictHorizontalSeparation.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbConflictVerticalSeparation.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbConflictVerticalSeparation.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbConflictVerticalSeparation
+                                visible:                adsbGrid.adsbSettings.adsbConflictVerticalSeparation.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
                         }
                     }
 
@@ -212,6 +212,36 @@ Rectangle {
                                     onCheckedChanged:   editingConfig.highLatency = checked
                                 }
 
+                                QGCCheckBox {
+                                    id:                 signingCheckBox
+                                    Layout.columnSpan:  2
+                                    text:               qsTr("MAVLink 2 Signing")
+                                    checked:            editingConfig.signingEnabled
+                                    onCheckedChanged:   editingConfig.signingEnabled = checked
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Signing Key")
+                                    visible:    signingCheckBox.checked
+                                }
+                                QGCTextField {
+                                    Layout.preferredWidth:  _secondColumnWidth
+                                    Layout.fillWidth:       true
+                                    visible:                signingCheckBox.checked
+                                    text:                   editingConfig.signingKey
+                                    placeholderText:        qsTr("Enter passphrase")
+                                    echoMode:               TextInput.Password
+                                    onTextChanged:          editingConfig.signingKey = text
+                                }
+
+                                QGCCheckBox {
+                                    Layout.columnSpan:  2
+                                    visible:            signingCheckBox.checked
+                                    text:               qsTr("Accept Unsigned Messages")
+                                    checked:            editingConfig.signingAcceptUnsigned
+                                    onCheckedChanged:   editingConfig.signingAcceptUnsigned = checked
+                                }
+
                                 QGCLabel { text: qsTr("Type") }
                                 QGCComboBox {
                                     Layout.preferredWidth:  _secondColumnWidth
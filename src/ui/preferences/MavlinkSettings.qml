@@ -157,6 +157,18 @@ Rectangle {
                         }
                     }
 
+                    FactCheckBox {
+                        text:       qsTr("Decode MAVLink on link threads")
+                        fact:       QGroundControl.settingsManager.appSettings.mavlinkDecodeOnLinkThread
+                        visible:    QGroundControl.settingsManager.appSettings.mavlinkDecodeOnLinkThread.visible
+                    }
+
+                    FactCheckBox {
+                        text:       qsTr("Pipelined mission transfers")
+                        fact:       QGroundControl.settingsManager.appSettings.pipelinedPlanTransfer
+                        visible:    QGroundControl.settingsManager.appSettings.pipelinedPlanTransfer.visible
+                    }
+
                     FactCheckBox {
                         id:         mavlinkForwardingChecked
                         text:       qsTr("Enable MAVLink forwarding")
@@ -182,10 +194,85 @@ Rectangle {
                         }
 
                     }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   mavlinkForwardingAllowedField.baseline
+                            visible:            QGroundControl.settingsManager.appSettings.forwardMavlinkAllowedMsgIds.visible
+                            text:               qsTr("Allowed message ids:")
+                        }
+                        FactTextField {
+                            id:                     mavlinkForwardingAllowedField
+                            fact:                   QGroundControl.settingsManager.appSettings.forwardMavlinkAllowedMsgIds
+                            width:                  _valueWidth
+                            visible:                QGroundControl.settingsManager.appSettings.forwardMavlinkAllowedMsgIds.visible
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   mavlinkForwardingDeniedField.baseline
+                            visible:            QGroundControl.settingsManager.appSettings.forwardMavlinkDeniedMsgIds.visible
+                            text:               qsTr("Denied message ids:")
+                        }
+                        FactTextField {
+                            id:                     mavlinkForwardingDeniedField
+                            fact:                   QGroundControl.settingsManager.appSettings.forwardMavlinkDeniedMsgIds
+                            width:                  _valueWidth
+                            visible:                QGroundControl.settingsManager.appSettings.forwardMavlinkDeniedMsgIds.visible
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   mavlinkForwardingMaxRateField.baseline
+                            visible:            QGroundControl.settingsManager.appSettings.forwardMavlinkMaxRate.visible
+                            text:               qsTr("Max rate:")
+                        }
+                        FactTextField {
+                            id:                     mavlinkForwardingMaxRateField
+                            fact:                   QGroundControl.settingsManager.appSettings.forwardMavlinkMaxRate
+                            width:                  _valueWidth
+                            visible:                QGroundControl.settingsManager.appSettings.forwardMavlinkMaxRate.visible
+                            enabled:                QGroundControl.settingsManager.appSettings.forwardMavlink.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
                    QGCLabel {
                         text:       qsTr("<i> Changing the host name requires restart of application. </i>")
                         visible:    QGroundControl.settingsManager.appSettings.forwardMavlinkHostName.visible
                     }
+
+                    FactCheckBox {
+                        text:       qsTr("Enable telemetry stream server")
+                        fact:       QGroundControl.settingsManager.appSettings.telemetryStreamServer
+                        visible:    QGroundControl.settingsManager.appSettings.telemetryStreamServer.visible
+                    }
+
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   telemetryStreamServerPortField.baseline
+                            visible:            QGroundControl.settingsManager.appSettings.telemetryStreamServerPort.visible
+                            text:               qsTr("Stream server port:")
+                        }
+                        FactTextField {
+                            id:                     telemetryStreamServerPortField
+                            fact:                   QGroundControl.settingsManager.appSettings.telemetryStreamServerPort
+                            width:                  _valueWidth
+                            visible:                QGroundControl.settingsManager.appSettings.telemetryStreamServerPort.visible
+                            enabled:                QGroundControl.settingsManager.appSettings.telemetryStreamServer.rawValue
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
                 }
             }
             //-----------------------------------------------------------------
@@ -656,6 +743,38 @@ Rectangle {
                         }
                     }
                     //-----------------------------------------------------------------
+                    //-- Compressed upload
+                    QGCCheckBox {
+                        text:       qsTr("Compress logs for upload (upload server must support it)")
+                        checked:    QGroundControl.mavlinkLogManager.compressUpload
+                        enabled:    !_disableDataPersistence
+                        onClicked: {
+                            QGroundControl.mavlinkLogManager.compressUpload = checked
+                        }
+                    }
+                    //-----------------------------------------------------------------
+                    //-- Upload bandwidth limit
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   uploadRateField.baseline
+                            text:               qsTr("Upload Limit (KB/s, 0 = none):")
+                        }
+                        QGCTextField {
+                            id:         uploadRateField
+                            text:       QGroundControl.mavlinkLogManager.uploadRateLimit
+                            width:      _valueWidth
+                            enabled:    !_disableDataPersistence
+                            inputMethodHints:       Qt.ImhDigitsOnly
+                            validator:              IntValidator { bottom: 0 }
+                            anchors.verticalCenter: parent.verticalCenter
+                            onEditingFinished: {
+                                QGroundControl.mavlinkLogManager.uploadRateLimit = parseInt(text)
+                            }
+                        }
+                    }
+                    //-----------------------------------------------------------------
                     //-- Delete log after upload
                     QGCCheckBox {
                         text:       qsTr("Delete log file after uploading")
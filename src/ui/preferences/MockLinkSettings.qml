@@ -27,6 +27,8 @@ GridLayout {
     readonly property int _MAV_TYPE_FIXED_WING:         1
     readonly property int _MAV_TYPE_QUADROTOR:          2
 
+    property bool _loadEnabled: parseInt(loadRateField.text) > 0
+
     function saveSettings() {
         switch (firmwareTypeCombo.currentIndex) {
         case 0:
@@ -46,6 +48,13 @@ GridLayout {
         }
         subEditConfig.sendStatus = sendStatus.checked
         subEditConfig.incrementVehicleId = incrementVehicleId.checked
+        subEditConfig.loadRate              = parseInt(loadRateField.text)
+        subEditConfig.loadMix               = loadMixField.text
+        subEditConfig.loadSystemCount       = parseInt(loadSystemCountField.text)
+        subEditConfig.loadBurstMSecs        = parseInt(loadBurstField.text)
+        subEditConfig.loadLossPercent       = parseInt(loadLossField.text)
+        subEditConfig.loadDuplicatePercent  = parseInt(loadDuplicateField.text)
+        subEditConfig.loadReorderPercent    = parseInt(loadReorderField.text)
     }
 
     Component.onCompleted: {
@@ -100,4 +109,94 @@ GridLayout {
         model:                  [ qsTr("ArduCopter"), qsTr("ArduPlane") ]
         visible:                firmwareTypeCombo.apmFirmwareSelected
     }
+
+    QGCLabel {
+        Layout.columnSpan:  2
+        text:               qsTr("Load Generator")
+    }
+
+    QGCLabel { text: qsTr("Messages/Second") }
+    QGCTextField {
+        id:                     loadRateField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadRate.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 0 }
+    }
+
+    QGCLabel {
+        text:       qsTr("Message Mix (msgid:weight)")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadMixField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadMix
+        visible:                _loadEnabled
+    }
+
+    QGCLabel {
+        text:       qsTr("System Ids")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadSystemCountField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadSystemCount.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 1; top: 254 }
+        visible:                _loadEnabled
+    }
+
+    QGCLabel {
+        text:       qsTr("Burst Interval (ms)")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadBurstField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadBurstMSecs.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 0 }
+        visible:                _loadEnabled
+    }
+
+    QGCLabel {
+        text:       qsTr("Loss %")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadLossField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadLossPercent.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 0; top: 100 }
+        visible:                _loadEnabled
+    }
+
+    QGCLabel {
+        text:       qsTr("Duplicate %")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadDuplicateField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadDuplicatePercent.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 0; top: 100 }
+        visible:                _loadEnabled
+    }
+
+    QGCLabel {
+        text:       qsTr("Reorder %")
+        visible:    _loadEnabled
+    }
+    QGCTextField {
+        id:                     loadReorderField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.loadReorderPercent.toString()
+        inputMethodHints:       Qt.ImhDigitsOnly
+        validator:              IntValidator { bottom: 0; top: 100 }
+        visible:                _loadEnabled
+    }
 }
@@ -169,5 +169,15 @@ ColumnLayout {
             currentIndex:           Math.max(Math.min(subEditConfig.stopBits - 1, 0), 1)
             onActivated:            subEditConfig.stopBits = index + 1
         }
+
+        QGCLabel { text: qsTr("Read Latency") }
+        QGCComboBox {
+            Layout.preferredWidth:  _secondColumnWidth
+            model:                  [ qsTr("Lowest"), "2 ms", "5 ms", "10 ms", "20 ms" ]
+            currentIndex:           Math.max(_readLatencyValues.indexOf(subEditConfig.readCoalesceMSecs), 0)
+            onActivated:            subEditConfig.readCoalesceMSecs = _readLatencyValues[index]
+
+            property var _readLatencyValues: [ 0, 2, 5, 10, 20 ]
+        }
     }
 }
@@ -24,6 +24,9 @@ GridLayout {
     function saveSettings() {
         subEditConfig.host = hostField.text
         subEditConfig.port = parseInt(portField.text)
+        subEditConfig.sendBufferSize = parseInt(sendBufferField.text)
+        subEditConfig.receiveBufferSize = parseInt(receiveBufferField.text)
+        subEditConfig.writeCoalesceMSecs = parseInt(writeCoalesceField.text)
     }
 
     QGCLabel { text: qsTr("Server Address") }
@@ -40,4 +43,35 @@ GridLayout {
         text:                   subEditConfig.port.toString()
         inputMethodHints:       Qt.ImhFormattedNumbersOnly
     }
+
+    QGCCheckBox {
+        Layout.columnSpan:  2
+        text:               qsTr("Disable Nagle (TCP_NODELAY)")
+        checked:            subEditConfig.noDelay
+        onClicked:          subEditConfig.noDelay = checked
+    }
+
+    QGCLabel { text: qsTr("Write Coalescing (ms)") }
+    QGCTextField {
+        id:                     writeCoalesceField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.writeCoalesceMSecs.toString()
+        inputMethodHints:       Qt.ImhFormattedNumbersOnly
+    }
+
+    QGCLabel { text: qsTr("Send Buffer (bytes, 0: default)") }
+    QGCTextField {
+        id:                     sendBufferField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.sendBufferSize.toString()
+        inputMethodHints:       Qt.ImhFormattedNumbersOnly
+    }
+
+    QGCLabel { text: qsTr("Receive Buffer (bytes, 0: default)") }
+    QGCTextField {
+        id:                     receiveBufferField
+        Layout.preferredWidth:  _secondColumnWidth
+        text:                   subEditConfig.receiveBufferSize.toString()
+        inputMethodHints:       Qt.ImhFormattedNumbersOnly
+    }
 }
@@ -45,6 +45,33 @@ ColumnLayout {
         }
     }
 
+    QGCCheckBox {
+        text:       qsTr("Batch outgoing datagrams")
+        checked:    subEditConfig.batchWrites
+        onClicked:  subEditConfig.batchWrites = checked
+    }
+
+    QGCCheckBox {
+        text:       qsTr("Pack multiple messages into each datagram")
+        checked:    subEditConfig.packFrames
+        enabled:    subEditConfig.batchWrites
+        onClicked:  subEditConfig.packFrames = checked
+    }
+
+    RowLayout {
+        spacing:    _colSpacing
+        visible:    subEditConfig.receiveThreadsSupported
+
+        QGCLabel { text: qsTr("Receive Threads") }
+        QGCTextField {
+            id:                     receiveThreadsField
+            text:                   subEditConfig.receiveThreads.toString()
+            Layout.preferredWidth:  _secondColumnWidth
+            inputMethodHints:       Qt.ImhDigitsOnly
+            onTextChanged:          subEditConfig.receiveThreads = Math.max(1, parseInt(receiveThreadsField.text) || 1)
+        }
+    }
+
     QGCLabel { text: qsTr("Server Addresses (optional)") }
 
     Repeater {